@@ -49,6 +49,16 @@ else()
     add_definitions(-DNVALGRIND=1)
 endif()
 
+option(ENABLE_USDT "Enable USDT probes for tracing with bpftrace, SystemTap, etc" OFF)
+if (ENABLE_USDT)
+    check_include_file(sys/sdt.h HAVE_SYS_SDT_H)
+    if (NOT HAVE_SYS_SDT_H)
+        message(FATAL_ERROR
+            "ENABLE_USDT option requested but sys/sdt.h is not found "
+            "(it is shipped with systemtap-sdt-dev or systemtap-sdt-devel)")
+    endif()
+endif()
+
 option(OSS_FUZZ "Set this option to use flags by oss-fuzz" OFF)
 option(ENABLE_FUZZER "Enable fuzzing testing" OFF)
 option(FUZZING_BUILD_MODE_UNSAFE_FOR_PRODUCTION "Enable fuzzing-friendly mode" ${ENABLE_FUZZER})
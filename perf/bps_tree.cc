@@ -0,0 +1,454 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "trivia/util.h"
+
+#include <benchmark/benchmark.h>
+
+// This test contains benchmarks for BPS tree - data structure implementing
+// Tarantool memtx TREE index and vinyl tuple cache.
+//
+// Tree elements are pointers to tuples stored elsewhere in memory, and
+// the comparators dereference them and aren't inlined, like in memtx.
+// Test scenarios:
+//  - Inserts only;
+//  - Search only (by key), no misses;
+//  - Lower bound search of keys missing in the tree;
+//  - Sequence iteration;
+//  - Deletes.
+//
+// Every scenario is run for trees with different block sizes, with and
+// without hints (see BPS_TREE_ELEM_HINT in bps_tree.h), and for std::set
+// to have a baseline.
+
+// Size of a tuple. Only its first 8 bytes (key) are used by comparators,
+// the rest makes tuples spread in memory like the real ones.
+constexpr static std::size_t TUPLE_SIZE = 1 << 6;
+
+// Same dataset sizes as in the Light benchmark.
+constexpr static std::size_t TUPLE_COUNT_MIN = 10000;
+constexpr static std::size_t TUPLE_COUNT_MAX = 100 * TUPLE_COUNT_MIN;
+constexpr static std::size_t TUPLE_COUNT_MULTIPLIER = 10;
+
+////////////////////////////// Data Definitions ////////////////////////////////////////////////////////////////////////
+
+using Key_t = uint64_t;
+
+struct TupleRaw {
+	Key_t key;
+	char data[TUPLE_SIZE - sizeof(Key_t)];
+};
+
+// Tree element: a tuple pointer with a hint, like memtx_tree_data. The
+// hint is the tuple key, so comparing hints is the same as comparing
+// tuples.
+struct TreeElem {
+	const TupleRaw *tuple;
+	uint64_t hint;
+};
+
+static NOINLINE int
+elem_compare(const TreeElem &a, const TreeElem &b)
+{
+	return a.tuple->key < b.tuple->key ? -1 : a.tuple->key > b.tuple->key;
+}
+
+static NOINLINE int
+elem_compare_key(const TreeElem &a, Key_t b)
+{
+	return a.tuple->key < b ? -1 : a.tuple->key > b;
+}
+
+static inline bool
+hint_range(uint64_t hint, uint64_t *lo, uint64_t *hi)
+{
+	*lo = hint;
+	*hi = hint;
+	return true;
+}
+
+// Tuples with even keys in range [0, 2 * tuple_count) allocated in random
+// order so that neighbouring keys don't share cache lines.
+struct TupleHolder {
+	TupleHolder(std::size_t tuple_count)
+	{
+		std::vector<Key_t> keys(tuple_count);
+		for (std::size_t i = 0; i < tuple_count; ++i)
+			keys[i] = 2 * i;
+		std::shuffle(keys.begin(), keys.end(), gen);
+		storage.resize(tuple_count);
+		elems.reserve(tuple_count);
+		for (std::size_t i = 0; i < tuple_count; ++i) {
+			storage[i].key = keys[i];
+			elems.push_back({&storage[i], keys[i]});
+		}
+	}
+
+	void shuffle()
+	{
+		std::shuffle(elems.begin(), elems.end(), gen);
+	}
+
+	TupleHolder(const TupleHolder &) = delete;
+	TupleHolder(TupleHolder &&) = delete;
+
+	std::vector<TupleRaw> storage;
+	std::vector<TreeElem> elems;
+	static std::mt19937_64 gen;
+};
+
+std::mt19937_64 TupleHolder::gen{42};
+
+////////////////////////////// BPS Tree Definitions ////////////////////////////////////////////////////////////////////
+
+namespace {
+	static constexpr std::size_t bps_tree_extent_size = 16 * 1024;
+
+	void *
+	bps_tree_extent_alloc(void *)
+	{
+		return malloc(bps_tree_extent_size);
+	}
+
+	void
+	bps_tree_extent_free(void *, void *p)
+	{
+		free(p);
+	}
+}; // namespace
+
+#define BPS_TREE_NAME
+#define BPS_TREE_EXTENT_SIZE bps_tree_extent_size
+#define BPS_TREE_COMPARE(a, b, arg) elem_compare(a, b)
+#define BPS_TREE_COMPARE_KEY(a, b, arg) elem_compare_key(a, b)
+#define BPS_TREE_IS_IDENTICAL(a, b) ((a).tuple == (b).tuple)
+#define BPS_TREE_NO_DEBUG 1
+#define bps_tree_elem_t TreeElem
+#define bps_tree_key_t Key_t
+#define bps_tree_arg_t int
+
+#define BPS_TREE_NAMESPACE bps_tree_256
+#define BPS_TREE_BLOCK_SIZE 256
+#include "salad/bps_tree.h"
+#undef BPS_TREE_NAMESPACE
+#undef BPS_TREE_BLOCK_SIZE
+
+#define BPS_TREE_NAMESPACE bps_tree_512
+#define BPS_TREE_BLOCK_SIZE 512
+#include "salad/bps_tree.h"
+#undef BPS_TREE_NAMESPACE
+#undef BPS_TREE_BLOCK_SIZE
+
+#define BPS_TREE_NAMESPACE bps_tree_1024
+#define BPS_TREE_BLOCK_SIZE 1024
+#include "salad/bps_tree.h"
+#undef BPS_TREE_NAMESPACE
+#undef BPS_TREE_BLOCK_SIZE
+
+#define BPS_TREE_ELEM_HINT(a) (a).hint
+#define BPS_TREE_KEY_HINT_RANGE(a, arg, lo, hi) hint_range(a, lo, hi)
+#define BPS_TREE_ELEM_HINT_RANGE(a, arg, lo, hi) hint_range((a).hint, lo, hi)
+
+#define BPS_TREE_NAMESPACE bps_tree_256_hint
+#define BPS_TREE_BLOCK_SIZE 256
+#include "salad/bps_tree.h"
+#undef BPS_TREE_NAMESPACE
+#undef BPS_TREE_BLOCK_SIZE
+
+#define BPS_TREE_NAMESPACE bps_tree_512_hint
+#define BPS_TREE_BLOCK_SIZE 512
+#include "salad/bps_tree.h"
+#undef BPS_TREE_NAMESPACE
+#undef BPS_TREE_BLOCK_SIZE
+
+#define BPS_TREE_NAMESPACE bps_tree_1024_hint
+#define BPS_TREE_BLOCK_SIZE 1024
+#include "salad/bps_tree.h"
+#undef BPS_TREE_NAMESPACE
+#undef BPS_TREE_BLOCK_SIZE
+
+#undef BPS_TREE_ELEM_HINT
+#undef BPS_TREE_KEY_HINT_RANGE
+#undef BPS_TREE_ELEM_HINT_RANGE
+#undef BPS_TREE_NAME
+#undef BPS_TREE_EXTENT_SIZE
+#undef BPS_TREE_COMPARE
+#undef BPS_TREE_COMPARE_KEY
+#undef BPS_TREE_IS_IDENTICAL
+#undef BPS_TREE_NO_DEBUG
+#undef bps_tree_elem_t
+#undef bps_tree_key_t
+#undef bps_tree_arg_t
+
+////////////////////////////// Fixture /////////////////////////////////////////////////////////////////////////////////
+
+template<typename T>
+class TreeBench : public ::benchmark::Fixture {
+protected:
+	void
+	Fill(const std::vector<TreeElem> &elems) noexcept
+	{
+		for (const auto &e : elems)
+			tree.insert(e);
+	}
+
+	void
+	Reset()
+	{
+		tree.clear();
+	}
+
+	//////////////////////////////// BENCHMARKS ////////////////////////////////////////////////////////////////////
+
+	// Insert values in random order; the tree is empty at the benchmark start.
+	void
+	InsertRandValue(benchmark::State& state)
+	{
+		std::size_t insertion_count = 0;
+		for (auto s : state) {
+			state.PauseTiming();
+			Reset();
+			TupleHolder data(state.range(0));
+			state.ResumeTiming();
+
+			for (const auto &e : data.elems) {
+				benchmark::DoNotOptimize(tree.insert(e));
+				insertion_count++;
+			}
+		}
+		state.SetItemsProcessed(insertion_count);
+	}
+
+	// Lookup random keys; all of them are present in the tree.
+	void
+	FindRandKey(benchmark::State& state)
+	{
+		std::size_t lookup_count = 0;
+		for (auto s : state) {
+			state.PauseTiming();
+			Reset();
+			TupleHolder data(state.range(0));
+			Fill(data.elems);
+			data.shuffle();
+			state.ResumeTiming();
+
+			for (const auto &e : data.elems) {
+				benchmark::DoNotOptimize(tree.find(e.tuple->key));
+				lookup_count++;
+			}
+		}
+		state.SetItemsProcessed(lookup_count);
+	}
+
+	// Lower bound search of random keys; none of them is present in the
+	// tree so the search always goes down to a leaf.
+	void
+	LowerBoundRandKey(benchmark::State& state)
+	{
+		std::size_t lookup_count = 0;
+		for (auto s : state) {
+			state.PauseTiming();
+			Reset();
+			TupleHolder data(state.range(0));
+			Fill(data.elems);
+			data.shuffle();
+			state.ResumeTiming();
+
+			for (const auto &e : data.elems) {
+				benchmark::DoNotOptimize(
+					tree.lower_bound(e.tuple->key + 1));
+				lookup_count++;
+			}
+		}
+		state.SetItemsProcessed(lookup_count);
+	}
+
+	// Sequence iteration over the tree - starting from the first value.
+	// Measurements include iterator dereference.
+	void
+	SequenceIteration(benchmark::State& state)
+	{
+		std::size_t processed = 0;
+		for (auto s : state) {
+			state.PauseTiming();
+			Reset();
+			TupleHolder data(state.range(0));
+			Fill(data.elems);
+			state.ResumeTiming();
+
+			processed += tree.iter_all();
+		}
+		state.SetItemsProcessed(processed);
+	}
+
+	// Fill in the tree, then delete all values in random order.
+	void
+	DeleteRandValue(benchmark::State& state)
+	{
+		std::size_t processed = 0;
+		for (auto s : state) {
+			state.PauseTiming();
+			Reset();
+			TupleHolder data(state.range(0));
+			Fill(data.elems);
+			data.shuffle();
+			state.ResumeTiming();
+
+			for (const auto &e : data.elems) {
+				benchmark::DoNotOptimize(tree.erase(e));
+				processed++;
+			}
+		}
+		state.SetItemsProcessed(processed);
+	}
+
+	T tree;
+};
+
+// Wrapper of a BPS tree instantiation. The tree functions are found by
+// argument-dependent lookup in the namespace of the tree type.
+template<typename Tree>
+class BpsTree {
+public:
+	BpsTree()
+	{
+		create();
+	}
+	~BpsTree()
+	{
+		bps_tree_destroy(&tree);
+	}
+
+	// Functions return smth in order to suppress "error: invalid use of void expression".
+	int
+	insert(const TreeElem &elem)
+	{
+		return bps_tree_insert(&tree, elem, nullptr, nullptr);
+	}
+
+	int
+	erase(const TreeElem &elem)
+	{
+		return bps_tree_delete(&tree, elem);
+	}
+
+	TreeElem *
+	find(Key_t key)
+	{
+		return bps_tree_find(&tree, key);
+	}
+
+	TreeElem *
+	lower_bound(Key_t key)
+	{
+		bool exact;
+		auto itr = bps_tree_lower_bound(&tree, key, &exact);
+		return bps_tree_iterator_get_elem(&tree, &itr);
+	}
+
+	void
+	clear()
+	{
+		bps_tree_destroy(&tree);
+		create();
+	}
+
+	std::size_t
+	iter_all()
+	{
+		std::size_t processed = 0;
+		auto itr = bps_tree_first(&tree);
+		TreeElem *elem;
+		while ((elem = bps_tree_iterator_get_elem(&tree, &itr)) != nullptr) {
+			benchmark::DoNotOptimize(elem->tuple);
+			bps_tree_iterator_next(&tree, &itr);
+			processed++;
+		}
+		return processed;
+	}
+private:
+	void
+	create()
+	{
+		bps_tree_create(&tree, 0, bps_tree_extent_alloc,
+				bps_tree_extent_free, nullptr, nullptr);
+	}
+
+	Tree tree;
+};
+
+using BpsTree256 = BpsTree<bps_tree_256::bps_tree>;
+using BpsTree512 = BpsTree<bps_tree_512::bps_tree>;
+using BpsTree1024 = BpsTree<bps_tree_1024::bps_tree>;
+using BpsTree256Hint = BpsTree<bps_tree_256_hint::bps_tree>;
+using BpsTree512Hint = BpsTree<bps_tree_512_hint::bps_tree>;
+using BpsTree1024Hint = BpsTree<bps_tree_1024_hint::bps_tree>;
+
+struct TreeElemLess {
+	using is_transparent = void;
+	bool operator()(const TreeElem &a, const TreeElem &b) const
+	{
+		return elem_compare(a, b) < 0;
+	}
+	bool operator()(const TreeElem &a, Key_t b) const
+	{
+		return elem_compare_key(a, b) < 0;
+	}
+	bool operator()(Key_t a, const TreeElem &b) const
+	{
+		return elem_compare_key(b, a) > 0;
+	}
+};
+
+class STL {
+public:
+	auto insert(const TreeElem &elem) { return tree.insert(elem); }
+	auto erase(const TreeElem &elem) { return tree.erase(elem); }
+	auto find(Key_t key) { return tree.find(key); }
+	auto lower_bound(Key_t key) { return tree.lower_bound(key); }
+	void clear() { tree.clear(); }
+
+	std::size_t
+	iter_all()
+	{
+		std::size_t processed = 0;
+		for (const auto &elem : tree) {
+			benchmark::DoNotOptimize(elem.tuple);
+			processed++;
+		}
+		return processed;
+	}
+
+private:
+	std::set<TreeElem, TreeElemLess> tree;
+};
+
+#define BENCHMARK_TEMPLATE_REGISTER(METHOD_NAME, TREE_NAME) \
+	BENCHMARK_TEMPLATE_DEFINE_F(TreeBench, TREE_NAME##METHOD_NAME, TREE_NAME)(benchmark::State& state) \
+	{ TreeBench::METHOD_NAME(state); } \
+	BENCHMARK_REGISTER_F(TreeBench, TREE_NAME##METHOD_NAME)-> \
+		RangeMultiplier(TUPLE_COUNT_MULTIPLIER)-> \
+			Range(TUPLE_COUNT_MIN, TUPLE_COUNT_MAX)
+
+#define BENCHMARK_TEMPLATE_REGISTER_FOR_ALL_IMPLS(METHOD_NAME) \
+	BENCHMARK_TEMPLATE_REGISTER(METHOD_NAME, BpsTree256); \
+	BENCHMARK_TEMPLATE_REGISTER(METHOD_NAME, BpsTree512); \
+	BENCHMARK_TEMPLATE_REGISTER(METHOD_NAME, BpsTree1024); \
+	BENCHMARK_TEMPLATE_REGISTER(METHOD_NAME, BpsTree256Hint); \
+	BENCHMARK_TEMPLATE_REGISTER(METHOD_NAME, BpsTree512Hint); \
+	BENCHMARK_TEMPLATE_REGISTER(METHOD_NAME, BpsTree1024Hint); \
+	BENCHMARK_TEMPLATE_REGISTER(METHOD_NAME, STL)
+
+BENCHMARK_TEMPLATE_REGISTER_FOR_ALL_IMPLS(InsertRandValue);
+BENCHMARK_TEMPLATE_REGISTER_FOR_ALL_IMPLS(FindRandKey);
+BENCHMARK_TEMPLATE_REGISTER_FOR_ALL_IMPLS(LowerBoundRandKey);
+BENCHMARK_TEMPLATE_REGISTER_FOR_ALL_IMPLS(SequenceIteration);
+BENCHMARK_TEMPLATE_REGISTER_FOR_ALL_IMPLS(DeleteRandValue);
+
+BENCHMARK_MAIN();
+
+#include "debug_warning.h"
@@ -0,0 +1,462 @@
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "box/coll_id.h"
+#include "box/coll_id_cache.h"
+#include "box/coll_id_def.h"
+#include "box/key_def.h"
+#include "box/tuple.h"
+#include "box/tuple_format.h"
+#include "coll/coll.h"
+#include "core/decimal.h"
+#include "core/fiber.h"
+#include "core/memory.h"
+#include "core/mp_decimal.h"
+#include "core/mp_uuid.h"
+#include "core/tt_uuid.h"
+#include "msgpuck.h"
+#include "trivia/util.h"
+
+#include <benchmark/benchmark.h>
+
+/**
+ * This suite contains benchmarks of the functions that index key
+ * definitions provide: comparators, hints, hashing and key extraction.
+ * Each benchmark runs over a matrix of key definition shapes so that
+ * the effect of specializing a function for a shape can be measured.
+ *
+ * Benchmark arguments:
+ *
+ * - type: type of the key parts, see enum key_type below;
+ * - nullable: whether the key parts are nullable; if so, every eighth
+ *   key value is null;
+ * - layout: layout of the indexed fields in tuples, see enum key_layout
+ *   below;
+ * - parts: number of key parts.
+ */
+
+/** Number of distinct tuples and keys used by the benchmarks. */
+static constexpr size_t row_count = 4096;
+/**
+ * Number of distinct key part values. It's small enough so that the
+ * first key parts of compared tuples are often equal.
+ */
+static constexpr uint64_t value_count = 64;
+/** Id of the collation used by string key parts with a collation. */
+static constexpr uint32_t coll_id = 1;
+
+/** Types of the key parts. */
+enum key_type {
+	KEY_TYPE_UNSIGNED,
+	KEY_TYPE_STRING,
+	/** String compared with the case insensitive unicode collation. */
+	KEY_TYPE_STRING_COLL,
+	KEY_TYPE_DOUBLE,
+	KEY_TYPE_UUID,
+	KEY_TYPE_DECIMAL,
+	key_type_MAX,
+};
+
+/** Layouts of the indexed fields in tuples. */
+enum key_layout {
+	/** Indexed fields go first, the key definition is sequential. */
+	KEY_LAYOUT_SEQUENTIAL,
+	/** Indexed fields are interleaved with unindexed ones. */
+	KEY_LAYOUT_SPARSE,
+	/** Indexed values are stored in maps and accessed by JSON path. */
+	KEY_LAYOUT_JSON,
+	key_layout_MAX,
+};
+
+/**
+ * The environment singleton initializes the subsystems used by tuples
+ * and registers the collation used by the benchmarks.
+ */
+class Env {
+public:
+	Env(Env &other) = delete;
+	Env &operator=(Env &other) = delete;
+
+	static Env &instance()
+	{
+		static Env instance;
+		return instance;
+	}
+private:
+	Env()
+	{
+		memory_init();
+		fiber_init(fiber_c_invoke);
+		coll_init();
+		tuple_init(NULL);
+		struct coll_id_def def;
+		memset(&def, 0, sizeof(def));
+		def.id = coll_id;
+		def.name = "unicode_ci";
+		def.name_len = strlen(def.name);
+		def.base.type = COLL_TYPE_ICU;
+		def.base.icu.strength = COLL_ICU_STRENGTH_PRIMARY;
+		coll = coll_id_new(&def);
+		if (coll == NULL)
+			abort();
+		struct coll_id *replaced;
+		if (coll_id_cache_replace(coll, &replaced) != 0)
+			abort();
+	}
+	~Env()
+	{
+		coll_id_cache_delete(coll);
+		coll_id_delete(coll);
+		tuple_free();
+		coll_free();
+		fiber_free();
+		memory_free();
+	}
+
+	struct coll_id *coll;
+};
+
+/**
+ * Key definition of the shape given by the benchmark arguments together
+ * with a set of tuples and keys matching it.
+ */
+class TestKeyDef {
+public:
+	explicit TestKeyDef(const benchmark::State &state)
+	{
+		Env::instance();
+		type = (enum key_type)state.range(0);
+		is_nullable = state.range(1) != 0;
+		layout = (enum key_layout)state.range(2);
+		part_count = state.range(3);
+
+		std::vector<struct key_part_def> parts(part_count);
+		for (uint32_t i = 0; i < part_count; i++) {
+			struct key_part_def *part = &parts[i];
+			*part = key_part_def_default;
+			part->fieldno = layout == KEY_LAYOUT_SPARSE ?
+					2 * i + 1 : i;
+			part->is_nullable = is_nullable;
+			if (is_nullable)
+				part->nullable_action = ON_CONFLICT_ACTION_NONE;
+			if (layout == KEY_LAYOUT_JSON)
+				part->path = "a";
+			switch (type) {
+			case KEY_TYPE_UNSIGNED:
+				part->type = FIELD_TYPE_UNSIGNED;
+				break;
+			case KEY_TYPE_STRING:
+				part->type = FIELD_TYPE_STRING;
+				break;
+			case KEY_TYPE_STRING_COLL:
+				part->type = FIELD_TYPE_STRING;
+				part->coll_id = coll_id;
+				break;
+			case KEY_TYPE_DOUBLE:
+				part->type = FIELD_TYPE_DOUBLE;
+				break;
+			case KEY_TYPE_UUID:
+				part->type = FIELD_TYPE_UUID;
+				break;
+			case KEY_TYPE_DECIMAL:
+				part->type = FIELD_TYPE_DECIMAL;
+				break;
+			default:
+				abort();
+			}
+		}
+		def = key_def_new(parts.data(), part_count, 0);
+		if (def == NULL)
+			abort();
+		format = box_tuple_format_new(&def, 1);
+		if (format == NULL)
+			abort();
+
+		std::mt19937 gen(42);
+		std::vector<uint64_t> values(part_count);
+		for (size_t i = 0; i < row_count; i++) {
+			for (uint32_t j = 0; j < part_count; j++)
+				values[j] = gen() % value_count;
+			char buf[512];
+			char *end = encode_tuple(buf, values.data(), gen);
+			tuples[i] = box_tuple_new(format, buf, end);
+			if (tuples[i] == NULL)
+				abort();
+			tuple_ref(tuples[i]);
+			hints[i] = tuple_hint(tuples[i], def);
+			end = encode_key(buf, values.data(), gen);
+			keys[i].assign(buf, end);
+			key_hints[i] = key_hint(buf, part_count, def);
+		}
+	}
+	~TestKeyDef()
+	{
+		for (size_t i = 0; i < row_count; i++)
+			tuple_unref(tuples[i]);
+		tuple_format_unref(format);
+		key_def_delete(def);
+	}
+
+	struct key_def *def;
+	uint32_t part_count;
+	struct tuple *tuples[row_count];
+	hint_t hints[row_count];
+	std::vector<char> keys[row_count];
+	hint_t key_hints[row_count];
+private:
+	char *encode_value(char *data, uint64_t value, std::mt19937 &gen)
+	{
+		if (is_nullable && gen() % 8 == 0)
+			return mp_encode_nil(data);
+		switch (type) {
+		case KEY_TYPE_UNSIGNED:
+			return mp_encode_uint(data, value * 1000003);
+		case KEY_TYPE_STRING:
+		case KEY_TYPE_STRING_COLL: {
+			/*
+			 * Vary the case so that the collation has some work
+			 * to do. Strings have a common prefix like typical
+			 * identifiers.
+			 */
+			char str[32];
+			int len = snprintf(str, sizeof(str), "%s%08llu",
+					   gen() % 2 == 0 ? "user" : "USER",
+					   (unsigned long long)value);
+			return mp_encode_str(data, str, len);
+		}
+		case KEY_TYPE_DOUBLE:
+			return mp_encode_double(data, value * 1.5);
+		case KEY_TYPE_UUID: {
+			struct tt_uuid uuid;
+			memset(&uuid, 0, sizeof(uuid));
+			uuid.time_low = value;
+			return mp_encode_uuid(data, &uuid);
+		}
+		case KEY_TYPE_DECIMAL: {
+			decimal_t dec;
+			decimal_from_int64(&dec, value * 1000003);
+			return mp_encode_decimal(data, &dec);
+		}
+		default:
+			abort();
+		}
+	}
+	char *encode_tuple(char *data, const uint64_t *values,
+			   std::mt19937 &gen)
+	{
+		switch (layout) {
+		case KEY_LAYOUT_SEQUENTIAL:
+			data = mp_encode_array(data, part_count + 1);
+			for (uint32_t i = 0; i < part_count; i++)
+				data = encode_value(data, values[i], gen);
+			return mp_encode_str0(data, "payload");
+		case KEY_LAYOUT_SPARSE:
+			data = mp_encode_array(data, 2 * part_count + 1);
+			data = mp_encode_str0(data, "payload");
+			for (uint32_t i = 0; i < part_count; i++) {
+				data = encode_value(data, values[i], gen);
+				data = mp_encode_uint(data, 42);
+			}
+			return data;
+		case KEY_LAYOUT_JSON:
+			data = mp_encode_array(data, part_count + 1);
+			for (uint32_t i = 0; i < part_count; i++) {
+				data = mp_encode_map(data, 2);
+				data = mp_encode_str0(data, "a");
+				data = encode_value(data, values[i], gen);
+				data = mp_encode_str0(data, "b");
+				data = mp_encode_uint(data, 42);
+			}
+			return mp_encode_str0(data, "payload");
+		default:
+			abort();
+		}
+	}
+	char *encode_key(char *data, const uint64_t *values,
+			 std::mt19937 &gen)
+	{
+		data = mp_encode_array(data, part_count);
+		for (uint32_t i = 0; i < part_count; i++)
+			data = encode_value(data, values[i], gen);
+		return data;
+	}
+
+	enum key_type type;
+	bool is_nullable;
+	enum key_layout layout;
+	struct tuple_format *format;
+};
+
+/**
+ * Applies the key definition shape matrix to a benchmark. Extra argument
+ * values, if given, are appended to the matrix.
+ */
+static void
+key_def_args(benchmark::internal::Benchmark *b,
+	     const std::vector<int64_t> &extra = {})
+{
+	for (int64_t type = 0; type < key_type_MAX; type++) {
+		for (int64_t nullable = 0; nullable <= 1; nullable++) {
+			for (int64_t layout = 0; layout < key_layout_MAX;
+			     layout++) {
+				for (int64_t parts = 1; parts <= 2; parts++) {
+					if (extra.empty()) {
+						b->Args({type, nullable,
+							 layout, parts});
+						continue;
+					}
+					for (int64_t arg : extra)
+						b->Args({type, nullable,
+							 layout, parts, arg});
+				}
+			}
+		}
+	}
+}
+
+static void
+key_def_shape_args(benchmark::internal::Benchmark *b)
+{
+	b->ArgNames({"type", "nullable", "layout", "parts"});
+	key_def_args(b);
+}
+
+static void
+key_def_shape_hint_args(benchmark::internal::Benchmark *b)
+{
+	b->ArgNames({"type", "nullable", "layout", "parts", "hint"});
+	key_def_args(b, {0, 1});
+}
+
+/**
+ * Benchmark of tuple_compare(). If the hint argument is set, the tuple
+ * hints are passed to the comparator like a tree index does.
+ */
+static void
+key_def_tuple_compare(benchmark::State &state)
+{
+	TestKeyDef kd(state);
+	bool use_hints = state.range(4) != 0;
+	size_t i = 0;
+	size_t total_count = 0;
+	for (auto _ : state) {
+		if (i == row_count) {
+			total_count += i;
+			i = 0;
+		}
+		size_t j = (i + 1) % row_count;
+		hint_t hint_a = use_hints ? kd.hints[i] : HINT_NONE;
+		hint_t hint_b = use_hints ? kd.hints[j] : HINT_NONE;
+		benchmark::DoNotOptimize(tuple_compare(kd.tuples[i], hint_a,
+						       kd.tuples[j], hint_b,
+						       kd.def));
+		++i;
+	}
+	total_count += i;
+	state.SetItemsProcessed(total_count);
+}
+
+BENCHMARK(key_def_tuple_compare)->Apply(key_def_shape_hint_args);
+
+/**
+ * Benchmark of tuple_compare_with_key(). If the hint argument is set,
+ * the tuple and key hints are passed to the comparator.
+ */
+static void
+key_def_tuple_compare_with_key(benchmark::State &state)
+{
+	TestKeyDef kd(state);
+	bool use_hints = state.range(4) != 0;
+	size_t i = 0;
+	size_t total_count = 0;
+	for (auto _ : state) {
+		if (i == row_count) {
+			total_count += i;
+			i = 0;
+		}
+		size_t j = (i + 1) % row_count;
+		hint_t hint = use_hints ? kd.hints[i] : HINT_NONE;
+		hint_t key_hint = use_hints ? kd.key_hints[j] : HINT_NONE;
+		benchmark::DoNotOptimize(tuple_compare_with_key(
+			kd.tuples[i], hint, kd.keys[j].data(), kd.part_count,
+			key_hint, kd.def));
+		++i;
+	}
+	total_count += i;
+	state.SetItemsProcessed(total_count);
+}
+
+BENCHMARK(key_def_tuple_compare_with_key)->Apply(key_def_shape_hint_args);
+
+/** Benchmark of tuple_hint(). */
+static void
+key_def_tuple_hint(benchmark::State &state)
+{
+	TestKeyDef kd(state);
+	size_t i = 0;
+	size_t total_count = 0;
+	for (auto _ : state) {
+		if (i == row_count) {
+			total_count += i;
+			i = 0;
+		}
+		benchmark::DoNotOptimize(tuple_hint(kd.tuples[i], kd.def));
+		++i;
+	}
+	total_count += i;
+	state.SetItemsProcessed(total_count);
+}
+
+BENCHMARK(key_def_tuple_hint)->Apply(key_def_shape_args);
+
+/** Benchmark of tuple_hash(). */
+static void
+key_def_tuple_hash(benchmark::State &state)
+{
+	TestKeyDef kd(state);
+	size_t i = 0;
+	size_t total_count = 0;
+	for (auto _ : state) {
+		if (i == row_count) {
+			total_count += i;
+			i = 0;
+		}
+		benchmark::DoNotOptimize(tuple_hash(kd.tuples[i], kd.def));
+		++i;
+	}
+	total_count += i;
+	state.SetItemsProcessed(total_count);
+}
+
+BENCHMARK(key_def_tuple_hash)->Apply(key_def_shape_args);
+
+/** Benchmark of tuple_extract_key(). */
+static void
+key_def_tuple_extract_key(benchmark::State &state)
+{
+	TestKeyDef kd(state);
+	size_t i = 0;
+	size_t total_count = 0;
+	for (auto _ : state) {
+		if (i == row_count) {
+			total_count += i;
+			i = 0;
+			fiber_gc();
+		}
+		uint32_t size;
+		benchmark::DoNotOptimize(tuple_extract_key(
+			kd.tuples[i], kd.def, MULTIKEY_NONE, &size));
+		++i;
+	}
+	total_count += i;
+	fiber_gc();
+	state.SetItemsProcessed(total_count);
+}
+
+BENCHMARK(key_def_tuple_extract_key)->Apply(key_def_shape_args);
+
+BENCHMARK_MAIN();
+
+#include "debug_warning.h"
@@ -10,6 +10,7 @@
 -- --row_count <number>      number of rows in the test space
 -- --use_read_view           use a read view
 -- --use_scanner_api         use the column scanner API
+-- --use_batch_api           use the batch iterator API
 --
 -- NOTE: The test requires a C module. Set the BUILDDIR environment variable to
 -- the tarantool build directory if using out-of-source build.
@@ -28,6 +29,7 @@ local params = require('internal.argparse').parse(arg, {
     {'row_count', 'number'},
     {'use_read_view', 'boolean'},
     {'use_scanner_api', 'boolean'},
+    {'use_batch_api', 'boolean'},
 })
 
 local DEFAULT_ENGINE = 'memtx'
@@ -39,6 +41,7 @@ params.column_count = params.column_count or DEFAULT_COLUMN_COUNT
 params.row_count = params.row_count or DEFAULT_ROW_COUNT
 params.use_read_view = params.use_read_view or false
 params.use_scanner_api = params.use_scanner_api or false
+params.use_batch_api = params.use_batch_api or false
 
 local BUILDDIR = fio.abspath(fio.pathjoin(os.getenv('BUILDDIR') or '.'))
 local MODULEPATH = fio.pathjoin(BUILDDIR, 'perf', 'lua',
@@ -53,6 +56,8 @@ for _, func_name in ipairs({'sum'}) do
     local full_func_name
     if params.use_scanner_api then
         full_func_name = func_name .. '_scanner'
+    elseif params.use_batch_api then
+        full_func_name = func_name .. '_batch'
     else
         full_func_name = func_name .. '_iterator'
     end
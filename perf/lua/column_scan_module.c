@@ -49,6 +49,44 @@ sum_iterator_lua_func(struct lua_State *L)
 	return 1;
 }
 
+static int
+sum_batch_lua_func(struct lua_State *L)
+{
+	uint32_t space_id = luaL_checkinteger(L, 1);
+	uint32_t index_id = luaL_checkinteger(L, 2);
+	uint32_t field_no = luaL_checkinteger(L, 3);
+	char key[8];
+	char *key_end = mp_encode_array(key, 0);
+	box_iterator_t *iter = box_index_iterator(space_id, index_id, ITER_ALL,
+						  key, key_end);
+	if (iter == NULL)
+		return luaT_error(L);
+	int rc = 0;
+	uint64_t sum = 0;
+	box_tuple_t *tuples[1024];
+	uint64_t values[lengthof(tuples)];
+	while (true) {
+		uint32_t count;
+		rc = box_iterator_next_batch(iter, tuples, lengthof(tuples),
+					     &count);
+		if (rc != 0 || count == 0)
+			break;
+		rc = box_tuple_decode_column(tuples, count, field_no,
+					     BOX_COLUMN_UINT64, values, NULL);
+		for (int i = 0; i < (int)count; i++)
+			box_tuple_unref(tuples[i]);
+		if (rc != 0)
+			break;
+		for (int i = 0; i < (int)count; i++)
+			sum += values[i];
+	}
+	box_iterator_free(iter);
+	if (rc != 0)
+		return luaT_error(L);
+	luaL_pushuint64(L, sum);
+	return 1;
+}
+
 #if defined(ENABLE_READ_VIEW)
 static int
 sum_iterator_rv_lua_func(struct lua_State *L)
@@ -208,6 +246,7 @@ luaopen_column_scan_module(struct lua_State *L)
 	static const struct luaL_Reg lib[] = {
 		{"init", init_lua_func},
 		{"sum_iterator", sum_iterator_lua_func},
+		{"sum_batch", sum_batch_lua_func},
 #if defined(ENABLE_READ_VIEW)
 		{"sum_iterator_rv", sum_iterator_rv_lua_func},
 #endif /* defined(ENABLE_READ_VIEW) */
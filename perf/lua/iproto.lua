@@ -0,0 +1,348 @@
+--
+-- The test measures throughput and latency of IPROTO requests sent over
+-- the network to a separate Tarantool instance.
+--
+-- The load is open-loop: requests are sent at the configured rate no
+-- matter how fast replies arrive, and the latency of a request is counted
+-- from the time it was scheduled to be sent rather than from the time it
+-- was actually sent. This way a server stall shows up in the latency
+-- percentiles instead of being hidden by the client slowing down
+-- (coordinated omission).
+--
+-- Output format:
+-- <test-case> <value>
+--
+-- For each request type and iproto_threads value the following test cases
+-- are reported: iproto_<request>_threads_<N>_rps (replies per second) and
+-- iproto_<request>_threads_<N>_{p50,p90,p99,p999,max} (latency in
+-- microseconds).
+--
+-- Options:
+-- --pattern <string>         run only requests matching the pattern, one of
+--                            'select', 'replace', 'call'; it's possible to
+--                            specify more than one pattern separated by '|'
+-- --iproto_threads <string>  comma separated list of iproto_threads values
+--                            to test the server with, default '1,2,4'
+-- --connections <number>     number of client connections, default 16
+-- --rate <number>            total number of requests per second sent to
+--                            the server, default 100000
+-- --duration <number>        duration of a test case in seconds, default 5
+-- --warmup <number>          time in seconds not accounted in results at
+--                            the beginning of a test case, default 1
+--
+
+local clock = require('clock')
+local fiber = require('fiber')
+local fio = require('fio')
+local net = require('net.box')
+local popen = require('popen')
+local bit = require('bit')
+
+local params = require('internal.argparse').parse(arg, {
+    {'pattern', 'string'},
+    {'iproto_threads', 'string'},
+    {'connections', 'number'},
+    {'rate', 'number'},
+    {'duration', 'number'},
+    {'warmup', 'number'},
+})
+if params.pattern then
+    params.pattern = string.split(params.pattern, '|')
+end
+
+local DEFAULT_IPROTO_THREADS = '1,2,4'
+local DEFAULT_CONNECTIONS = 16
+local DEFAULT_RATE = 100000
+local DEFAULT_DURATION = 5
+local DEFAULT_WARMUP = 1
+
+-- Number of tuples in the test space.
+local KEY_COUNT = 100000
+-- Max number of requests waiting for a reply on one connection. If it's
+-- exceeded, the server can't keep up with the rate and the test fails.
+local MAX_PENDING = 100000
+
+local iproto_threads = {}
+for _, v in ipairs(string.split(params.iproto_threads or
+                                DEFAULT_IPROTO_THREADS, ',')) do
+    table.insert(iproto_threads, assert(tonumber(v)))
+end
+local connection_count = params.connections or DEFAULT_CONNECTIONS
+local rate = params.rate or DEFAULT_RATE
+local duration = params.duration or DEFAULT_DURATION
+local warmup = params.warmup or DEFAULT_WARMUP
+
+local test_dir = fio.tempdir()
+
+--
+-- Latency histogram with log-linear buckets, like HdrHistogram: values
+-- below 64 are stored exactly, larger values are rounded down to the six
+-- most significant bits, so the relative error is below 2^-5.
+--
+local function hist_new()
+    return {count = 0, max = 0, buckets = {}}
+end
+
+local function hist_add(hist, value)
+    local v = math.floor(value)
+    local shift = 0
+    while bit.rshift(v, shift) >= 64 do
+        shift = shift + 1
+    end
+    local key = shift * 64 + bit.rshift(v, shift)
+    hist.buckets[key] = (hist.buckets[key] or 0) + 1
+    hist.count = hist.count + 1
+    if v > hist.max then
+        hist.max = v
+    end
+end
+
+local function hist_merge(dst, src)
+    for key, count in pairs(src.buckets) do
+        dst.buckets[key] = (dst.buckets[key] or 0) + count
+    end
+    dst.count = dst.count + src.count
+    dst.max = math.max(dst.max, src.max)
+end
+
+-- Returns the value below which the given share of values falls.
+local function hist_percentile(hist, share)
+    local keys = {}
+    for key in pairs(hist.buckets) do
+        table.insert(keys, key)
+    end
+    table.sort(keys)
+    local threshold = hist.count * share
+    local total = 0
+    for _, key in ipairs(keys) do
+        total = total + hist.buckets[key]
+        if total >= threshold then
+            local shift = math.floor(key / 64)
+            local v = bit.lshift(key % 64 + 1, shift) - 1
+            return math.min(v, hist.max)
+        end
+    end
+    return hist.max
+end
+
+--
+-- Array of test cases.
+--
+-- A test case is represented by a table with the following mandatory fields:
+--
+-- * name: test case name
+-- * func: function sending a request asynchronously and returning
+--         the future
+--
+local TESTS = {
+    {
+        name = 'select',
+        func = function(conn, key)
+            return conn.space.perf:select({key}, {is_async = true})
+        end,
+    },
+    {
+        name = 'replace',
+        func = function(conn, key)
+            return conn.space.perf:replace({key, 'value'}, {is_async = true})
+        end,
+    },
+    {
+        name = 'call',
+        func = function(conn, key)
+            return conn:call('echo', {key}, {is_async = true})
+        end,
+    },
+}
+
+--
+-- Starts a server instance with the given number of IPROTO threads and
+-- returns its popen handle and URI.
+--
+local function server_start(thread_count)
+    local dir = fio.pathjoin(test_dir, 'server_' .. thread_count)
+    assert(fio.mkdir(dir))
+    local uri = fio.pathjoin(dir, 'server.sock')
+    local code = string.format([[
+        box.cfg({
+            listen = '%s',
+            iproto_threads = %d,
+            work_dir = '%s',
+            wal_mode = 'none',
+            log = '%s',
+        })
+        box.schema.user.grant('guest', 'super')
+        local s = box.schema.space.create('perf')
+        s:create_index('pk')
+        for i = 1, %d do
+            s:insert({i, 'value'})
+        end
+        rawset(_G, 'echo', function(...) return ... end)
+    ]], uri, thread_count, dir, fio.pathjoin(dir, 'server.log'), KEY_COUNT)
+    local ph = assert(popen.new({arg[-1], '-e', code}, {
+        stdin = 'devnull', stdout = 'devnull', stderr = 'devnull',
+    }))
+    local deadline = clock.monotonic() + 60
+    while true do
+        local conn = net.connect(uri)
+        -- The server may be not listening yet or the guest user may
+        -- have no access yet.
+        local ok, ready = pcall(conn.eval, conn,
+                                "return rawget(_G, 'echo') ~= nil")
+        ready = ok and ready
+        conn:close()
+        if ready then
+            break
+        end
+        if clock.monotonic() > deadline then
+            ph:kill()
+            ph:wait()
+            error('failed to start the server')
+        end
+        fiber.sleep(0.1)
+    end
+    return ph, uri
+end
+
+--
+-- Runs a test case against the server listening on the given URI.
+-- Returns the number of replies per second and the latency histogram.
+--
+local function bench(test, uri)
+    local func = test.func
+    local conns = {}
+    for i = 1, connection_count do
+        conns[i] = net.connect(uri, {io_thread = true})
+        assert(conns[i]:is_connected())
+    end
+    local interval = connection_count / rate
+    local start = clock.monotonic() + 0.1
+    local measure_start = start + warmup
+    local stop = measure_start + duration
+    local hists = {}
+    local reply_count = 0
+    local fibers = {}
+    for i = 1, connection_count do
+        local conn = conns[i]
+        local hist = hist_new()
+        hists[i] = hist
+        -- Requests waiting for a reply and their scheduled send times.
+        local futures, times = {}, {}
+        local head, tail = 1, 0
+        local cond = fiber.cond()
+        local is_done = false
+        local function send()
+            -- Spread the requests of the connections evenly.
+            local next_time = start + interval * (i - 1) / connection_count
+            local key = i
+            while next_time < stop do
+                local now = clock.monotonic()
+                if next_time > now then
+                    fiber.sleep(next_time - now)
+                elseif tail % 64 == 0 then
+                    -- Let the receiver run while catching up.
+                    fiber.yield()
+                end
+                if tail - head >= MAX_PENDING then
+                    error('too many pending requests, decrease the rate')
+                end
+                key = key % KEY_COUNT + 1
+                tail = tail + 1
+                futures[tail] = func(conn, key)
+                times[tail] = next_time
+                cond:signal()
+                next_time = next_time + interval
+            end
+        end
+        local sender = fiber.new(function()
+            local ok, err = pcall(send)
+            is_done = true
+            cond:signal()
+            if not ok then
+                error(err)
+            end
+        end)
+        sender:set_joinable(true)
+        local receiver = fiber.new(function()
+            while true do
+                if head > tail then
+                    if is_done then
+                        break
+                    end
+                    cond:wait()
+                else
+                    local _, err = futures[head]:wait_result()
+                    if err ~= nil then
+                        error(err)
+                    end
+                    local time = times[head]
+                    if time >= measure_start then
+                        hist_add(hist, (clock.monotonic() - time) * 1e6)
+                        reply_count = reply_count + 1
+                    end
+                    futures[head], times[head] = nil, nil
+                    head = head + 1
+                end
+            end
+        end)
+        receiver:set_joinable(true)
+        table.insert(fibers, sender)
+        table.insert(fibers, receiver)
+    end
+    for _, f in ipairs(fibers) do
+        local ok, err = f:join()
+        if not ok then
+            error(err)
+        end
+    end
+    for _, conn in ipairs(conns) do
+        conn:close()
+    end
+    local hist = hist_new()
+    for _, h in ipairs(hists) do
+        hist_merge(hist, h)
+    end
+    return reply_count / duration, hist
+end
+
+local function run()
+    for _, thread_count in ipairs(iproto_threads) do
+        local ph, uri = server_start(thread_count)
+        for _, test in ipairs(TESTS) do
+            local skip = false
+            if params.pattern then
+                skip = true
+                for _, pattern in ipairs(params.pattern) do
+                    if string.match(test.name, pattern) then
+                        skip = false
+                        break
+                    end
+                end
+            end
+            if not skip then
+                local rps, hist = bench(test, uri)
+                local prefix = string.format('iproto_%s_threads_%d_',
+                                             test.name, thread_count)
+                print(string.format('%srps %d', prefix, rps))
+                for _, p in ipairs({
+                    {'p50', 0.5}, {'p90', 0.9}, {'p99', 0.99},
+                    {'p999', 0.999},
+                }) do
+                    print(string.format('%s%s %d', prefix, p[1],
+                                        hist_percentile(hist, p[2])))
+                end
+                print(string.format('%smax %d', prefix, hist.max))
+            end
+        end
+        ph:kill()
+        ph:wait()
+    end
+end
+
+local ok, err = pcall(run)
+fio.rmtree(test_dir)
+if not ok then
+    print(err)
+    os.exit(1)
+end
+os.exit(0)
@@ -0,0 +1,290 @@
+--
+-- The test compares memtx tuple allocators (box.cfg.memtx_allocator) under
+-- churn: tuples of a space are replaced over and over with tuples of new
+-- sizes drawn from a size distribution.
+--
+-- Each test case is run in a separate Tarantool instance, because the
+-- allocator can't be changed after box.cfg(). The space is filled with the
+-- given number of keys, then the churn is run for the given number of
+-- operations. After that a checkpoint is started with a low I/O rate limit
+-- so that it keeps its read view open for a while, and the churn is run
+-- again until the checkpoint completes: tuples freed while a read view is
+-- open can't be reused, so the memory grows.
+--
+-- The size distributions are:
+--
+-- uniform   tuple size is uniform in [16, 1024] bytes
+-- bimodal   90% of tuples are [16, 64] bytes, 10% are [4096, 16384] bytes
+-- growing   each replace makes the tuple 64 bytes bigger than the previous
+--           version of the same tuple, up to 4096 bytes, then it starts from
+--           16 bytes again; models documents growing with updates
+--
+-- While the churn is running, memory usage is printed as comments (lines
+-- starting with '#'). When a test case completes, the results are printed
+-- in the format:
+--
+-- <test-case> <value>
+--
+-- where test-case is <allocator>_<distribution>_<metric>. The metrics are:
+--
+-- rps                   replaces per second
+-- items_used_ratio      box.slab.info().items_used_ratio in percent at the
+--                       end of the churn
+-- data_mb               size of the live tuples, MB
+-- rss_mb                resident set size of the process at the end of the
+--                       churn, MB (Linux only)
+-- rss_max_mb            maximal resident set size during the churn, MB
+--                       (Linux only)
+-- rss_overhead          rss_mb divided by data_mb (Linux only)
+-- read_view_rps         replaces per second while the read view is open
+-- read_view_overhead_mb max growth of box.slab.info().items_size while the
+--                       read view is open, MB
+--
+-- Options:
+-- --pattern <string>        run only test cases matching the pattern, e.g.
+--                           'small_bimodal'; it's possible to specify more
+--                           than one pattern separated by '|'
+-- --keys <number>           number of tuples in the space, default 100000
+-- --operations <number>     number of replaces, default 5000000
+-- --report_interval <number> interval of progress reports in seconds,
+--                           default 1
+-- --snap_io_rate_limit <number>
+--                           checkpoint write rate in MB per second, default 10
+--
+
+local clock = require('clock')
+local fiber = require('fiber')
+local fio = require('fio')
+local popen = require('popen')
+
+local params = require('internal.argparse').parse(arg, {
+    {'pattern', 'string'},
+    {'keys', 'number'},
+    {'operations', 'number'},
+    {'report_interval', 'number'},
+    {'snap_io_rate_limit', 'number'},
+    -- Internal options used to run a test case in a child instance.
+    {'allocator', 'string'},
+    {'distribution', 'string'},
+    {'work_dir', 'string'},
+})
+if params.pattern then
+    params.pattern = string.split(params.pattern, '|')
+end
+
+local key_count = params.keys or 100000
+local operation_count = params.operations or 5000000
+local report_interval = params.report_interval or 1
+local snap_io_rate_limit = params.snap_io_rate_limit or 10
+
+-- Number of replaces between checks of the report timer and yields.
+local BATCH_SIZE = 1000
+-- Size of a memory page, used to convert /proc/self/statm to bytes.
+local PAGE_SIZE = 4096
+local MB = 1024 * 1024
+
+local TESTS = {
+    {allocator = 'small', distribution = 'uniform'},
+    {allocator = 'small', distribution = 'bimodal'},
+    {allocator = 'small', distribution = 'growing'},
+    {allocator = 'system', distribution = 'uniform'},
+    {allocator = 'system', distribution = 'bimodal'},
+    {allocator = 'system', distribution = 'growing'},
+}
+
+--
+-- Size distributions. Each function returns the payload size of the new
+-- version of a tuple given the size of the old version (nil if the tuple
+-- doesn't exist yet).
+--
+local DISTRIBUTIONS = {
+    uniform = function()
+        return math.random(16, 1024)
+    end,
+    bimodal = function()
+        if math.random(10) == 1 then
+            return math.random(4096, 16384)
+        end
+        return math.random(16, 64)
+    end,
+    growing = function(old)
+        if old == nil then
+            return math.random(16, 4096)
+        end
+        if old + 64 > 4096 then
+            return 16
+        end
+        return old + 64
+    end,
+}
+
+-- Returns the resident set size of the process in bytes or nil.
+local function rss()
+    local f = fio.open('/proc/self/statm')
+    if f == nil then
+        return nil
+    end
+    -- Files in procfs have zero size so read with a limit.
+    local statm = f:read(4096)
+    f:close()
+    return tonumber(statm:split(' ')[2]) * PAGE_SIZE
+end
+
+local function items_used_ratio()
+    return tonumber((box.slab.info().items_used_ratio:gsub('%%', '')))
+end
+
+--
+-- Runs a test case in this instance and prints the results.
+--
+local function child()
+    local name = params.allocator .. '_' .. params.distribution
+    local next_size = DISTRIBUTIONS[params.distribution]
+    box.cfg({
+        work_dir = params.work_dir,
+        memtx_allocator = params.allocator,
+        memtx_memory = 4 * 1024 * MB,
+        wal_mode = 'none',
+        checkpoint_interval = 0,
+        snap_io_rate_limit = snap_io_rate_limit,
+        log = 'tarantool.log',
+    })
+    local space = box.schema.space.create('test')
+    space:create_index('pk')
+    -- Payload size of each tuple, indexed by key.
+    local sizes = {}
+    local data_size = 0
+    -- Cache strings of all sizes so as not to benchmark the Lua GC.
+    local payloads = setmetatable({}, {__index = function(t, size)
+        local s = string.rep('x', size)
+        rawset(t, size, s)
+        return s
+    end})
+    local function replace(key)
+        local old = sizes[key]
+        local size = next_size(old)
+        space:replace({key, payloads[size]})
+        data_size = data_size + size - (old or 0)
+        sizes[key] = size
+    end
+    for key = 1, key_count do
+        replace(key)
+    end
+
+    -- Runs the churn until the given condition returns true and calls
+    -- the given function after each batch of operations.
+    local function churn(done, on_batch)
+        local ops = 0
+        local start = clock.monotonic()
+        local last_report = start
+        while not done(ops) do
+            for _ = 1, BATCH_SIZE do
+                replace(math.random(key_count))
+            end
+            ops = ops + BATCH_SIZE
+            on_batch()
+            local now = clock.monotonic()
+            if now - last_report >= report_interval then
+                last_report = now
+                print(string.format(
+                    '# %s %.1fs: %d ops, items_used_ratio %.2f%%, ' ..
+                    'items_size %d MB, rss %s MB', name, now - start, ops,
+                    items_used_ratio(), box.slab.info().items_size / MB,
+                    rss() and math.floor(rss() / MB) or 'n/a'))
+            end
+            fiber.yield()
+        end
+        return ops / (clock.monotonic() - start)
+    end
+
+    local rss_max = rss()
+    local rps = churn(function(ops)
+        return ops >= operation_count
+    end, function()
+        local v = rss()
+        if v ~= nil and v > rss_max then
+            rss_max = v
+        end
+    end)
+    local results = {
+        {'rps', rps},
+        {'items_used_ratio', items_used_ratio()},
+        {'data_mb', data_size / MB},
+    }
+    local rss_end = rss()
+    if rss_end ~= nil then
+        table.insert(results, {'rss_mb', rss_end / MB})
+        table.insert(results, {'rss_max_mb', rss_max / MB})
+        table.insert(results, {'rss_overhead', rss_end / data_size})
+    end
+
+    -- Keep a read view open by a slow checkpoint.
+    local items_before = box.slab.info().items_size
+    local items_max = items_before
+    local checkpoint_done = false
+    fiber.create(function()
+        box.snapshot()
+        checkpoint_done = true
+    end)
+    local read_view_rps = churn(function()
+        return checkpoint_done
+    end, function()
+        items_max = math.max(items_max, box.slab.info().items_size)
+    end)
+    table.insert(results, {'read_view_rps', read_view_rps})
+    table.insert(results, {'read_view_overhead_mb',
+                           (items_max - items_before) / MB})
+
+    for _, result in ipairs(results) do
+        print(string.format('%s_%s %.2f', name, result[1], result[2]))
+    end
+end
+
+local function run()
+    for _, test in ipairs(TESTS) do
+        local name = test.allocator .. '_' .. test.distribution
+        local skip = false
+        if params.pattern then
+            skip = true
+            for _, pattern in ipairs(params.pattern) do
+                if string.match(name, pattern) then
+                    skip = false
+                    break
+                end
+            end
+        end
+        if not skip then
+            local dir = fio.tempdir()
+            local ph = assert(popen.new({
+                arg[-1], fio.abspath(arg[0]),
+                '--allocator', test.allocator,
+                '--distribution', test.distribution,
+                '--work_dir', dir,
+                '--keys', tostring(key_count),
+                '--operations', tostring(operation_count),
+                '--report_interval', tostring(report_interval),
+                '--snap_io_rate_limit', tostring(snap_io_rate_limit),
+            }, {
+                stdin = 'devnull', stdout = 'inherit', stderr = 'inherit',
+            }))
+            local status = ph:wait()
+            ph:close()
+            fio.rmtree(dir)
+            if status.exit_code ~= 0 then
+                error('test case ' .. name .. ' failed')
+            end
+        end
+    end
+end
+
+if params.allocator ~= nil then
+    child()
+    os.exit(0)
+end
+
+local ok, err = pcall(run)
+if not ok then
+    print(err)
+    os.exit(1)
+end
+os.exit(0)
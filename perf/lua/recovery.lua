@@ -0,0 +1,160 @@
+--
+-- The test measures the time it takes an instance to recover its data
+-- on startup, broken down by recovery phase (see box.info.recovery()).
+--
+-- A dataset of the given size is generated by a separate Tarantool
+-- instance: the given number of rows is inserted and checkpointed, then
+-- more rows are inserted to be replayed from the WAL. After that the
+-- instance is restarted and the recovery statistics are reported.
+--
+-- Output format:
+-- <test-case> <value>
+--
+-- The following test cases are reported, time is in seconds:
+--
+-- recovery_time                total time of local recovery
+-- recovery_snapshot_time       time spent reading the snapshot
+-- recovery_snapshot_rps        snapshot rows recovered per second
+-- recovery_pk_build_time       time spent building memtx primary keys
+-- recovery_sk_build_time       time spent building memtx secondary keys
+-- recovery_wal_time            time spent replaying the WAL
+-- recovery_wal_rps             WAL rows replayed per second
+-- recovery_vylog_time          time spent loading the vinyl metadata log
+-- recovery_vinyl_lsm_time      time spent loading vinyl LSM trees
+-- recovery_startup_time        wall time of the restarted instance process,
+--                              from spawn till exit
+--
+-- Options:
+-- --engine <string>            engine of the test space, default 'memtx'
+-- --rows <number>              number of rows in the snapshot,
+--                              default 1000000
+-- --wal_rows <number>          number of rows in the WAL, default 100000
+-- --secondary_indexes <number> number of secondary indexes, default 1
+-- --field_size <number>        size of a string field in bytes, default 100
+--
+
+local clock = require('clock')
+local fio = require('fio')
+local json = require('json')
+local popen = require('popen')
+
+local params = require('internal.argparse').parse(arg, {
+    {'engine', 'string'},
+    {'rows', 'number'},
+    {'wal_rows', 'number'},
+    {'secondary_indexes', 'number'},
+    {'field_size', 'number'},
+})
+
+local engine = params.engine or 'memtx'
+local row_count = params.rows or 1000000
+local wal_row_count = params.wal_rows or 100000
+local sk_count = params.secondary_indexes or 1
+local field_size = params.field_size or 100
+
+local test_dir = fio.tempdir()
+
+--
+-- Runs the given Lua code in a new Tarantool instance working in the test
+-- directory and returns its output.
+--
+local function run_instance(code)
+    local cfg = string.format([[
+        box.cfg({
+            work_dir = '%s',
+            log = '%s',
+            checkpoint_interval = 0,
+        })
+    ]], test_dir, fio.pathjoin(test_dir, 'tarantool.log'))
+    local ph = assert(popen.new({arg[-1], '-e', cfg .. code}, {
+        stdin = 'devnull', stdout = 'pipe', stderr = 'devnull',
+    }))
+    local output = {}
+    while true do
+        local chunk = ph:read()
+        if chunk == nil or chunk == '' then
+            break
+        end
+        table.insert(output, chunk)
+    end
+    local status = ph:wait()
+    ph:close()
+    if status.exit_code ~= 0 then
+        error('instance failed, see ' ..
+              fio.pathjoin(test_dir, 'tarantool.log'))
+    end
+    return table.concat(output)
+end
+
+local function generate()
+    run_instance(string.format([[
+        local engine, row_count, wal_row_count, sk_count, field_size =
+            '%s', %d, %d, %d, %d
+        local s = box.schema.space.create('test', {engine = engine})
+        s:create_index('pk')
+        for i = 1, sk_count do
+            s:create_index('sk' .. i, {
+                parts = {{i + 1, 'unsigned'}}, unique = false,
+            })
+        end
+        local data = string.rep('x', field_size)
+        local function insert(first, last)
+            box.begin()
+            for i = first, last do
+                local tuple = {i}
+                for j = 1, sk_count do
+                    tuple[j + 1] = (i * 7919 * j) %% 1000003
+                end
+                table.insert(tuple, data)
+                s:replace(tuple)
+                if i %% 1000 == 0 then
+                    box.commit()
+                    box.begin()
+                end
+            end
+            box.commit()
+        end
+        insert(1, row_count)
+        box.snapshot()
+        -- Update existing rows so that the space size doesn't change.
+        insert(1, wal_row_count)
+        os.exit(0)
+    ]], engine, row_count, wal_row_count, sk_count, field_size))
+end
+
+local function recover()
+    local start = clock.monotonic()
+    local output = run_instance([[
+        io.stdout:write(require('json').encode(box.info.recovery()))
+        io.stdout:flush()
+        os.exit(0)
+    ]])
+    -- Includes loading the executable and printing the statistics, which
+    -- is negligible compared to recovery of a dataset of a decent size.
+    local startup_time = clock.monotonic() - start
+    local stat = json.decode(output)
+    local function result(name, value)
+        print(string.format('recovery_%s %.3f', name, value))
+    end
+    result('time', stat.time)
+    result('snapshot_time', stat.snapshot.time)
+    result('snapshot_rps', stat.snapshot.rps)
+    result('pk_build_time', stat.memtx.pk_build_time)
+    result('sk_build_time', stat.memtx.sk_build_time)
+    result('wal_time', stat.wal.time)
+    result('wal_rps', stat.wal.rps)
+    result('vylog_time', stat.vinyl.vylog_time)
+    result('vinyl_lsm_time', stat.vinyl.lsm_time)
+    result('startup_time', startup_time)
+end
+
+local ok, err = pcall(function()
+    generate()
+    recover()
+end)
+fio.rmtree(test_dir)
+if not ok then
+    print(err)
+    os.exit(1)
+end
+os.exit(0)
@@ -0,0 +1,336 @@
+--
+-- The test measures replication performance: how fast replicas apply
+-- the stream of rows written on the master and how the replication lag
+-- behaves under a fixed write load.
+--
+-- The script runs the master itself and starts the given number of
+-- read-only replicas as separate Tarantool instances connected to it.
+-- For each test case a space is created on the master, the write load is
+-- applied to it for the given time, then the test waits for all replicas
+-- to catch up.
+--
+-- Output format:
+-- <test-case> <value>
+--
+-- For each test case the following values are reported, prefixed with
+-- replication_<engine>_<async|sync>_:
+--
+-- rps                      transactions committed on the master per second
+-- commit_{p50,p99,max}     commit latency in microseconds; for synchronous
+--                          spaces it includes waiting for the quorum to
+--                          confirm the transaction
+-- lag_avg, lag_max         downstream lag of the replicas in microseconds,
+--                          sampled every 100 ms
+-- apply_rps                rows applied per second by the slowest replica,
+--                          counted till it catches up with the master
+-- relay_cpu_avg, _max      CPU usage of a relay thread in percent (Linux
+--                          only)
+--
+-- Options:
+-- --pattern <string>    run only test cases matching the pattern, e.g.
+--                       'memtx_sync'; it's possible to specify more than
+--                       one pattern separated by '|'
+-- --replicas <number>   number of replicas, default 2
+-- --rate <number>       total number of transactions per second sent to
+--                       the master, default 20000
+-- --fibers <number>     number of writer fibers, default 100
+-- --duration <number>   duration of the write load in seconds, default 10
+--
+
+local clock = require('clock')
+local fiber = require('fiber')
+local fio = require('fio')
+local popen = require('popen')
+
+local params = require('internal.argparse').parse(arg, {
+    {'pattern', 'string'},
+    {'replicas', 'number'},
+    {'rate', 'number'},
+    {'fibers', 'number'},
+    {'duration', 'number'},
+})
+if params.pattern then
+    params.pattern = string.split(params.pattern, '|')
+end
+
+local replica_count = params.replicas or 2
+local rate = params.rate or 20000
+local fiber_count = params.fibers or 100
+local duration = params.duration or 10
+
+-- Interval between replication lag samples in seconds.
+local LAG_SAMPLE_INTERVAL = 0.1
+-- Max time to wait for replicas to start or to catch up in seconds.
+local TIMEOUT = 60
+
+local test_dir = fio.tempdir()
+local master_uri = fio.pathjoin(test_dir, 'master.sock')
+
+--
+-- Array of test cases.
+--
+-- A test case is represented by a table with the following fields:
+--
+-- * engine: engine of the test space
+-- * is_sync: whether the test space is synchronous
+--
+local TESTS = {
+    {engine = 'memtx', is_sync = false},
+    {engine = 'memtx', is_sync = true},
+    {engine = 'vinyl', is_sync = false},
+    {engine = 'vinyl', is_sync = true},
+}
+
+local function test_name(test)
+    return string.format('%s_%s', test.engine,
+                         test.is_sync and 'sync' or 'async')
+end
+
+-- Returns the given percentile of an array of samples, sorting it.
+local function percentile(samples, p)
+    if #samples == 0 then
+        return 0
+    end
+    table.sort(samples)
+    return samples[math.max(math.ceil(#samples * p), 1)]
+end
+
+local function wait_cond(what, cond)
+    local deadline = clock.monotonic() + TIMEOUT
+    while not cond() do
+        if clock.monotonic() > deadline then
+            error('timed out waiting for ' .. what)
+        end
+        fiber.sleep(0.01)
+    end
+end
+
+--
+-- Returns CPU time in seconds consumed by each relay thread of this
+-- process, indexed by the thread id. Returns an empty table if the
+-- information isn't available.
+--
+local function relay_cpu_time()
+    local result = {}
+    local tids = fio.listdir('/proc/self/task')
+    if tids == nil then
+        return result
+    end
+    for _, tid in ipairs(tids) do
+        local f = fio.open(fio.pathjoin('/proc/self/task', tid, 'stat'))
+        if f ~= nil then
+            -- Files in procfs have zero size so read with a limit.
+            local stat = f:read(4096)
+            f:close()
+            -- The thread name is enclosed in parentheses and may contain
+            -- spaces so skip it before splitting the rest of the fields.
+            local name, rest = stat:match('%((.*)%) (.*)')
+            if name ~= nil and name:startswith('relay') then
+                local fields = rest:split(' ')
+                -- utime and stime are 14th and 15th fields of the stat
+                -- file counting from pid, measured in clock ticks, which
+                -- are 1/100 of a second on all supported platforms.
+                result[tid] = (tonumber(fields[12]) +
+                               tonumber(fields[13])) / 100
+            end
+        end
+    end
+    return result
+end
+
+local function replica_start(i)
+    local dir = fio.pathjoin(test_dir, 'replica_' .. i)
+    assert(fio.mkdir(dir))
+    local code = string.format([[
+        box.cfg({
+            replication = '%s',
+            read_only = true,
+            work_dir = '%s',
+            log = '%s',
+            replication_timeout = 0.1,
+        })
+    ]], master_uri, dir, fio.pathjoin(dir, 'replica.log'))
+    return assert(popen.new({arg[-1], '-e', code}, {
+        stdin = 'devnull', stdout = 'devnull', stderr = 'devnull',
+    }))
+end
+
+--
+-- Runs a test case and returns a table with the results.
+--
+local function bench(test)
+    local space = box.schema.space.create('test', {
+        engine = test.engine,
+        is_sync = test.is_sync,
+    })
+    space:create_index('pk')
+    -- Make sure the replicas have applied DDL before starting the load.
+    local lsn = box.info.lsn
+    wait_cond('replicas to apply DDL', function()
+        for id = 2, replica_count + 1 do
+            local r = box.info.replication[id]
+            if r == nil or r.downstream == nil or
+                    r.downstream.vclock == nil or
+                    (r.downstream.vclock[1] or 0) < lsn then
+                return false
+            end
+        end
+        return true
+    end)
+
+    local lsn_before = box.info.lsn
+    local cpu_before = relay_cpu_time()
+    local start = clock.monotonic()
+    local stop = start + duration
+    local interval = fiber_count / rate
+    local latencies = {}
+    local commit_count = 0
+    local fibers = {}
+    for i = 1, fiber_count do
+        fibers[i] = fiber.new(function()
+            -- Spread the transactions of the fibers evenly.
+            local next_time = start + interval * (i - 1) / fiber_count
+            local key = i
+            while next_time < stop do
+                local now = clock.monotonic()
+                if next_time > now then
+                    fiber.sleep(next_time - now)
+                end
+                local t = clock.monotonic()
+                space:replace({key, 'value'})
+                table.insert(latencies, (clock.monotonic() - t) * 1e6)
+                commit_count = commit_count + 1
+                key = key + fiber_count
+                next_time = next_time + interval
+            end
+        end)
+        fibers[i]:set_joinable(true)
+    end
+    local lags = {}
+    local sampler = fiber.new(function()
+        while true do
+            fiber.sleep(LAG_SAMPLE_INTERVAL)
+            for id = 2, replica_count + 1 do
+                local r = box.info.replication[id]
+                if r ~= nil and r.downstream ~= nil and
+                        r.downstream.lag ~= nil then
+                    table.insert(lags, r.downstream.lag * 1e6)
+                end
+            end
+        end
+    end)
+    for _, f in ipairs(fibers) do
+        assert(f:join())
+    end
+    local write_time = clock.monotonic() - start
+    sampler:cancel()
+
+    -- Wait for each replica to catch up and compute its apply rate.
+    local lsn_after = box.info.lsn
+    local apply_rps
+    for id = 2, replica_count + 1 do
+        wait_cond('replica to catch up', function()
+            local vclock = box.info.replication[id].downstream.vclock
+            return vclock ~= nil and (vclock[1] or 0) >= lsn_after
+        end)
+        local rps = (lsn_after - lsn_before) / (clock.monotonic() - start)
+        apply_rps = apply_rps == nil and rps or math.min(apply_rps, rps)
+    end
+    local cpu_time = clock.monotonic() - start
+    local cpu_after = relay_cpu_time()
+    local cpu_sum, cpu_max, relay_count = 0, 0, 0
+    for tid, t in pairs(cpu_after) do
+        local usage = (t - (cpu_before[tid] or 0)) / cpu_time * 100
+        cpu_sum = cpu_sum + usage
+        cpu_max = math.max(cpu_max, usage)
+        relay_count = relay_count + 1
+    end
+
+    local lag_sum = 0
+    for _, lag in ipairs(lags) do
+        lag_sum = lag_sum + lag
+    end
+    space:drop()
+
+    local results = {
+        {'rps', commit_count / write_time},
+        {'commit_p50', percentile(latencies, 0.5)},
+        {'commit_p99', percentile(latencies, 0.99)},
+        {'commit_max', percentile(latencies, 1)},
+        {'lag_avg', #lags > 0 and lag_sum / #lags or 0},
+        {'lag_max', percentile(lags, 1)},
+        {'apply_rps', apply_rps},
+    }
+    if relay_count > 0 then
+        table.insert(results, {'relay_cpu_avg', cpu_sum / relay_count})
+        table.insert(results, {'relay_cpu_max', cpu_max})
+    end
+    return results
+end
+
+local function run()
+    box.cfg({
+        listen = master_uri,
+        work_dir = test_dir,
+        log = fio.pathjoin(test_dir, 'master.log'),
+        replication_timeout = 0.1,
+        replication_synchro_quorum = replica_count + 1,
+        replication_synchro_timeout = TIMEOUT,
+    })
+    box.schema.user.grant('guest', 'replication')
+
+    local replicas = {}
+    for i = 1, replica_count do
+        replicas[i] = replica_start(i)
+    end
+    local ok, err = pcall(function()
+        wait_cond('replicas to join', function()
+            for id = 2, replica_count + 1 do
+                local r = box.info.replication[id]
+                if r == nil or r.downstream == nil or
+                        r.downstream.status ~= 'follow' then
+                    return false
+                end
+            end
+            return true
+        end)
+        -- Claim the synchronous queue so that synchronous transactions
+        -- can be committed.
+        box.ctl.promote()
+
+        for _, test in ipairs(TESTS) do
+            local name = test_name(test)
+            local skip = false
+            if params.pattern then
+                skip = true
+                for _, pattern in ipairs(params.pattern) do
+                    if string.match(name, pattern) then
+                        skip = false
+                        break
+                    end
+                end
+            end
+            if not skip then
+                for _, result in ipairs(bench(test)) do
+                    print(string.format('replication_%s_%s %d', name,
+                                        result[1], result[2]))
+                end
+            end
+        end
+    end)
+    for _, ph in ipairs(replicas) do
+        ph:kill()
+        ph:wait()
+    end
+    if not ok then
+        error(err)
+    end
+end
+
+local ok, err = pcall(run)
+fio.rmtree(test_dir)
+if not ok then
+    print(err)
+    os.exit(1)
+end
+os.exit(0)
@@ -0,0 +1,611 @@
+--
+-- The test measures SQL performance on TPC-H-like and TPC-C-like
+-- workloads.
+--
+-- For each test case the schema of the workload is created in the given
+-- engine and filled with generated data, then each query of the workload
+-- is executed with box.execute() and timed. The schemas and queries are
+-- simplified versions of the TPC-H and TPC-C ones: dates are stored as day
+-- numbers, decimals as NUMBER and only a subset of the queries is run.
+--
+-- TPC-H queries are analytical: each of them is run the given number of
+-- times with the same parameters. TPC-C statements are short OLTP requests:
+-- each of them is run the given number of times with random parameters.
+--
+-- Output format:
+-- <test-case> <value>
+--
+-- For each query the following values are reported, prefixed with
+-- <tpch|tpcc>_<engine>_<query>_:
+--
+-- time      average execution time in microseconds
+-- opcodes   number of VDBE instructions executed by one run of the query,
+--           as reported by EXPLAIN ANALYZE
+--
+-- Options:
+-- --pattern <string>      run only test cases matching the pattern, e.g.
+--                         'tpch_memtx'; it's possible to specify more than
+--                         one pattern separated by '|'
+-- --scale <number>        scale factor: TPC-H data is generated with scale
+--                         factor 0.01 * scale, TPC-C data with the given
+--                         number of warehouses, default 1
+-- --tpch_iterations <number>
+--                         number of runs of each TPC-H query, default 5
+-- --tpcc_iterations <number>
+--                         number of runs of each TPC-C statement,
+--                         default 10000
+--
+
+local clock = require('clock')
+local fio = require('fio')
+
+local params = require('internal.argparse').parse(arg, {
+    {'pattern', 'string'},
+    {'scale', 'number'},
+    {'tpch_iterations', 'number'},
+    {'tpcc_iterations', 'number'},
+})
+if params.pattern then
+    params.pattern = string.split(params.pattern, '|')
+end
+
+local scale = params.scale or 1
+local tpch_iterations = params.tpch_iterations or 5
+local tpcc_iterations = params.tpcc_iterations or 10000
+
+-- Number of rows inserted in one transaction when loading data.
+local LOAD_BATCH_SIZE = 1000
+
+local test_dir = fio.tempdir()
+
+local function execute(sql, args)
+    local res, err = box.execute(sql, args)
+    if res == nil then
+        error(string.format('%s: %s', sql, err))
+    end
+    return res
+end
+
+--
+-- Inserts rows returned by the given generator function into a space
+-- until the function returns nil.
+--
+local function load(space_name, gen)
+    local space = box.space[space_name]
+    box.begin()
+    local count = 0
+    for tuple in gen do
+        space:insert(tuple)
+        count = count + 1
+        if count % LOAD_BATCH_SIZE == 0 then
+            box.commit()
+            box.begin()
+        end
+    end
+    box.commit()
+end
+
+-- Returns a generator function yielding f(i) for i = 1, n.
+local function rows(n, f)
+    local i = 0
+    return function()
+        i = i + 1
+        if i <= n then
+            return f(i)
+        end
+    end
+end
+
+local function random_string(len)
+    local chars = {}
+    for i = 1, len do
+        chars[i] = string.char(math.random(97, 122))
+    end
+    return table.concat(chars)
+end
+
+-------------------------------------------------------------------------------
+-- TPC-H
+-------------------------------------------------------------------------------
+
+local TPCH_REGIONS = {'AFRICA', 'AMERICA', 'ASIA', 'EUROPE', 'MIDDLE EAST'}
+local TPCH_SEGMENTS = {
+    'AUTOMOBILE', 'BUILDING', 'FURNITURE', 'HOUSEHOLD', 'MACHINERY',
+}
+local TPCH_TYPES = {'ECONOMY', 'LARGE', 'MEDIUM', 'PROMO', 'SMALL', 'STANDARD'}
+-- Order dates are day numbers in [0, TPCH_DAYS).
+local TPCH_DAYS = 2406
+
+local TPCH_SCHEMA = {
+    [[CREATE TABLE region (r_regionkey INTEGER PRIMARY KEY,
+                           r_name STRING)]],
+    [[CREATE TABLE nation (n_nationkey INTEGER PRIMARY KEY, n_name STRING,
+                           n_regionkey INTEGER)]],
+    [[CREATE TABLE supplier (s_suppkey INTEGER PRIMARY KEY, s_name STRING,
+                             s_nationkey INTEGER, s_acctbal NUMBER)]],
+    [[CREATE TABLE customer (c_custkey INTEGER PRIMARY KEY, c_name STRING,
+                             c_nationkey INTEGER, c_acctbal NUMBER,
+                             c_mktsegment STRING)]],
+    [[CREATE TABLE part (p_partkey INTEGER PRIMARY KEY, p_name STRING,
+                         p_type STRING, p_retailprice NUMBER)]],
+    [[CREATE TABLE orders (o_orderkey INTEGER PRIMARY KEY,
+                           o_custkey INTEGER, o_orderstatus STRING,
+                           o_totalprice NUMBER, o_orderdate INTEGER,
+                           o_shippriority INTEGER)]],
+    [[CREATE INDEX orders_custkey ON orders (o_custkey)]],
+    [[CREATE TABLE lineitem (l_orderkey INTEGER, l_linenumber INTEGER,
+                             l_partkey INTEGER, l_suppkey INTEGER,
+                             l_quantity INTEGER, l_extendedprice NUMBER,
+                             l_discount INTEGER, l_tax INTEGER,
+                             l_returnflag STRING, l_linestatus STRING,
+                             l_shipdate INTEGER,
+                             PRIMARY KEY (l_orderkey, l_linenumber))]],
+}
+
+local function tpch_load()
+    local supplier_count = math.ceil(100 * scale)
+    local customer_count = math.ceil(1500 * scale)
+    local part_count = math.ceil(2000 * scale)
+    local order_count = math.ceil(15000 * scale)
+    load('REGION', rows(#TPCH_REGIONS, function(i)
+        return {i - 1, TPCH_REGIONS[i]}
+    end))
+    load('NATION', rows(25, function(i)
+        return {i - 1, 'NATION' .. i, (i - 1) % #TPCH_REGIONS}
+    end))
+    load('SUPPLIER', rows(supplier_count, function(i)
+        return {i, 'Supplier#' .. i, math.random(0, 24),
+                math.random(-99999, 999999) / 100}
+    end))
+    load('CUSTOMER', rows(customer_count, function(i)
+        return {i, 'Customer#' .. i, math.random(0, 24),
+                math.random(-99999, 999999) / 100,
+                TPCH_SEGMENTS[math.random(#TPCH_SEGMENTS)]}
+    end))
+    local part_price = {}
+    load('PART', rows(part_count, function(i)
+        part_price[i] = (90000 + i % 20001) / 100
+        return {i, random_string(20),
+                TPCH_TYPES[math.random(#TPCH_TYPES)] .. ' ' ..
+                random_string(10), part_price[i]}
+    end))
+    local lineitems = {}
+    load('ORDERS', rows(order_count, function(i)
+        local date = math.random(0, TPCH_DAYS - 1)
+        local total = 0
+        for j = 1, math.random(1, 7) do
+            local part = math.random(part_count)
+            local quantity = math.random(1, 50)
+            local price = quantity * part_price[part]
+            local ship_date = date + math.random(1, 121)
+            total = total + price
+            table.insert(lineitems, {
+                i, j, part, math.random(supplier_count), quantity, price,
+                math.random(0, 10), math.random(0, 8),
+                ship_date < TPCH_DAYS / 2 and
+                    (math.random(2) == 1 and 'R' or 'A') or 'N',
+                ship_date < TPCH_DAYS / 2 and 'F' or 'O',
+                ship_date,
+            })
+        end
+        return {i, math.random(customer_count),
+                date < TPCH_DAYS / 2 and 'F' or 'O', total, date, 0}
+    end))
+    load('LINEITEM', rows(#lineitems, function(i)
+        return lineitems[i]
+    end))
+end
+
+--
+-- TPC-H queries. Discount and tax are stored in percent so the revenue is
+-- computed as l_extendedprice * (100 - l_discount) / 100.
+--
+local TPCH_QUERIES = {
+    -- Pricing summary report.
+    {name = 'q1', sql = [[
+        SELECT l_returnflag, l_linestatus, SUM(l_quantity),
+               SUM(l_extendedprice),
+               SUM(l_extendedprice * (100 - l_discount) / 100),
+               SUM(l_extendedprice * (100 - l_discount) / 100 *
+                   (100 + l_tax) / 100),
+               AVG(l_quantity), AVG(l_extendedprice), AVG(l_discount),
+               COUNT(*)
+        FROM lineitem
+        WHERE l_shipdate <= 2316
+        GROUP BY l_returnflag, l_linestatus
+        ORDER BY l_returnflag, l_linestatus]]},
+    -- Shipping priority.
+    {name = 'q3', sql = [[
+        SELECT l_orderkey,
+               SUM(l_extendedprice * (100 - l_discount) / 100) AS revenue,
+               o_orderdate, o_shippriority
+        FROM customer, orders, lineitem
+        WHERE c_mktsegment = 'BUILDING' AND c_custkey = o_custkey AND
+              l_orderkey = o_orderkey AND o_orderdate < 1170 AND
+              l_shipdate > 1170
+        GROUP BY l_orderkey, o_orderdate, o_shippriority
+        ORDER BY revenue DESC, o_orderdate
+        LIMIT 10]]},
+    -- Local supplier volume.
+    {name = 'q5', sql = [[
+        SELECT n_name,
+               SUM(l_extendedprice * (100 - l_discount) / 100) AS revenue
+        FROM customer, orders, lineitem, supplier, nation, region
+        WHERE c_custkey = o_custkey AND l_orderkey = o_orderkey AND
+              l_suppkey = s_suppkey AND c_nationkey = s_nationkey AND
+              s_nationkey = n_nationkey AND n_regionkey = r_regionkey AND
+              r_name = 'ASIA' AND o_orderdate >= 730 AND o_orderdate < 1095
+        GROUP BY n_name
+        ORDER BY revenue DESC]]},
+    -- Forecasting revenue change.
+    {name = 'q6', sql = [[
+        SELECT SUM(l_extendedprice * l_discount / 100) AS revenue
+        FROM lineitem
+        WHERE l_shipdate >= 730 AND l_shipdate < 1095 AND
+              l_discount BETWEEN 5 AND 7 AND l_quantity < 24]]},
+    -- Returned item reporting.
+    {name = 'q10', sql = [[
+        SELECT c_custkey, c_name,
+               SUM(l_extendedprice * (100 - l_discount) / 100) AS revenue,
+               c_acctbal, n_name
+        FROM customer, orders, lineitem, nation
+        WHERE c_custkey = o_custkey AND l_orderkey = o_orderkey AND
+              o_orderdate >= 1000 AND o_orderdate < 1092 AND
+              l_returnflag = 'R' AND c_nationkey = n_nationkey
+        GROUP BY c_custkey, c_name, c_acctbal, n_name
+        ORDER BY revenue DESC
+        LIMIT 20]]},
+    -- Promotion effect.
+    {name = 'q14', sql = [[
+        SELECT 100 * SUM(CASE WHEN p_type LIKE 'PROMO%'
+                              THEN l_extendedprice * (100 - l_discount) / 100
+                              ELSE 0 END) /
+               SUM(l_extendedprice * (100 - l_discount) / 100)
+        FROM lineitem, part
+        WHERE l_partkey = p_partkey AND l_shipdate >= 1000 AND
+              l_shipdate < 1030]]},
+    -- Large volume customer.
+    {name = 'q18', sql = [[
+        SELECT c_name, c_custkey, o_orderkey, o_orderdate, o_totalprice,
+               SUM(l_quantity)
+        FROM customer, orders, lineitem
+        WHERE o_orderkey IN (SELECT l_orderkey FROM lineitem
+                             GROUP BY l_orderkey
+                             HAVING SUM(l_quantity) > 250) AND
+              c_custkey = o_custkey AND o_orderkey = l_orderkey
+        GROUP BY c_name, c_custkey, o_orderkey, o_orderdate, o_totalprice
+        ORDER BY o_totalprice DESC, o_orderdate
+        LIMIT 100]]},
+}
+
+-------------------------------------------------------------------------------
+-- TPC-C
+-------------------------------------------------------------------------------
+
+local TPCC_DISTRICTS = 10
+local TPCC_CUSTOMERS = 300
+local TPCC_ORDERS = 300
+local TPCC_NEW_ORDERS = 90
+local TPCC_ITEMS = 10000
+local TPCC_SYLLABLES = {
+    'BAR', 'OUGHT', 'ABLE', 'PRI', 'PRES', 'ESE', 'ANTI', 'CALLY', 'ATION',
+    'EING',
+}
+
+-- Returns the customer last name for the given number in [0, 999].
+local function tpcc_last_name(n)
+    return TPCC_SYLLABLES[math.floor(n / 100) + 1] ..
+           TPCC_SYLLABLES[math.floor(n / 10) % 10 + 1] ..
+           TPCC_SYLLABLES[n % 10 + 1]
+end
+
+local TPCC_SCHEMA = {
+    [[CREATE TABLE warehouse (w_id INTEGER PRIMARY KEY, w_name STRING,
+                              w_tax NUMBER, w_ytd NUMBER)]],
+    [[CREATE TABLE district (d_w_id INTEGER, d_id INTEGER, d_name STRING,
+                             d_tax NUMBER, d_ytd NUMBER,
+                             d_next_o_id INTEGER,
+                             PRIMARY KEY (d_w_id, d_id))]],
+    [[CREATE TABLE customer (c_w_id INTEGER, c_d_id INTEGER,
+                             c_id INTEGER, c_last STRING,
+                             c_balance NUMBER, c_ytd_payment NUMBER,
+                             c_payment_cnt INTEGER,
+                             PRIMARY KEY (c_w_id, c_d_id, c_id))]],
+    [[CREATE INDEX customer_last ON customer (c_w_id, c_d_id, c_last)]],
+    [[CREATE TABLE item (i_id INTEGER PRIMARY KEY, i_name STRING,
+                         i_price NUMBER)]],
+    [[CREATE TABLE stock (s_w_id INTEGER, s_i_id INTEGER,
+                          s_quantity INTEGER, s_ytd INTEGER,
+                          s_order_cnt INTEGER,
+                          PRIMARY KEY (s_w_id, s_i_id))]],
+    [[CREATE TABLE orders (o_w_id INTEGER, o_d_id INTEGER, o_id INTEGER,
+                           o_c_id INTEGER, o_entry_d INTEGER,
+                           o_ol_cnt INTEGER,
+                           PRIMARY KEY (o_w_id, o_d_id, o_id))]],
+    [[CREATE INDEX orders_customer ON orders (o_w_id, o_d_id, o_c_id, o_id)]],
+    [[CREATE TABLE new_order (no_w_id INTEGER, no_d_id INTEGER,
+                              no_o_id INTEGER,
+                              PRIMARY KEY (no_w_id, no_d_id, no_o_id))]],
+    [[CREATE TABLE order_line (ol_w_id INTEGER, ol_d_id INTEGER,
+                               ol_o_id INTEGER, ol_number INTEGER,
+                               ol_i_id INTEGER, ol_quantity INTEGER,
+                               ol_amount NUMBER,
+                               PRIMARY KEY (ol_w_id, ol_d_id, ol_o_id,
+                                            ol_number))]],
+}
+
+local tpcc_warehouses = math.max(math.floor(scale), 1)
+
+local function tpcc_load()
+    load('WAREHOUSE', rows(tpcc_warehouses, function(w)
+        return {w, 'Warehouse#' .. w, math.random(0, 2000) / 10000, 300000}
+    end))
+    local districts = {}
+    local customers = {}
+    local orders = {}
+    local new_orders = {}
+    local order_lines = {}
+    for w = 1, tpcc_warehouses do
+        for d = 1, TPCC_DISTRICTS do
+            table.insert(districts, {w, d, 'District#' .. d,
+                                     math.random(0, 2000) / 10000, 30000,
+                                     TPCC_ORDERS + 1})
+            for c = 1, TPCC_CUSTOMERS do
+                table.insert(customers, {w, d, c,
+                                         tpcc_last_name(math.random(0, 999)),
+                                         -10, 10, 1})
+            end
+            for o = 1, TPCC_ORDERS do
+                local line_count = math.random(5, 15)
+                table.insert(orders, {w, d, o, math.random(TPCC_CUSTOMERS),
+                                      o, line_count})
+                if o > TPCC_ORDERS - TPCC_NEW_ORDERS then
+                    table.insert(new_orders, {w, d, o})
+                end
+                for l = 1, line_count do
+                    table.insert(order_lines, {w, d, o, l,
+                                               math.random(TPCC_ITEMS), 5,
+                                               math.random(1, 999999) / 100})
+                end
+            end
+        end
+    end
+    load('DISTRICT', rows(#districts, function(i) return districts[i] end))
+    load('CUSTOMER', rows(#customers, function(i) return customers[i] end))
+    load('ORDERS', rows(#orders, function(i) return orders[i] end))
+    load('NEW_ORDER', rows(#new_orders, function(i) return new_orders[i] end))
+    load('ORDER_LINE', rows(#order_lines, function(i)
+        return order_lines[i]
+    end))
+    load('ITEM', rows(TPCC_ITEMS, function(i)
+        return {i, random_string(20), math.random(100, 10000) / 100}
+    end))
+    load('STOCK', rows(tpcc_warehouses * TPCC_ITEMS, function(i)
+        return {math.floor((i - 1) / TPCC_ITEMS) + 1,
+                (i - 1) % TPCC_ITEMS + 1, math.random(10, 100), 0, 0}
+    end))
+end
+
+local function tpcc_warehouse()
+    return math.random(tpcc_warehouses)
+end
+
+local function tpcc_district()
+    return math.random(TPCC_DISTRICTS)
+end
+
+-- Order id for the inserted order lines, grows with each insertion.
+local tpcc_next_order_id = TPCC_ORDERS
+
+--
+-- TPC-C statements. The args function returns the bind parameters for the
+-- next execution of the statement.
+--
+local TPCC_QUERIES = {
+    -- New-Order: get the item price.
+    {name = 'new_order_item', sql = [[
+        SELECT i_price, i_name FROM item WHERE i_id = ?]],
+     args = function()
+        return {math.random(TPCC_ITEMS)}
+     end},
+    -- New-Order: allocate the order id.
+    {name = 'new_order_district', sql = [[
+        UPDATE district SET d_next_o_id = d_next_o_id + 1
+        WHERE d_w_id = ? AND d_id = ?]],
+     args = function()
+        return {tpcc_warehouse(), tpcc_district()}
+     end},
+    -- New-Order: update the stock of the ordered item.
+    {name = 'new_order_stock', sql = [[
+        UPDATE stock
+        SET s_quantity = CASE WHEN s_quantity >= ? + 10
+                              THEN s_quantity - ?
+                              ELSE s_quantity - ? + 91 END,
+            s_ytd = s_ytd + ?, s_order_cnt = s_order_cnt + 1
+        WHERE s_w_id = ? AND s_i_id = ?]],
+     args = function()
+        local quantity = math.random(1, 10)
+        return {quantity, quantity, quantity, quantity, tpcc_warehouse(),
+                math.random(TPCC_ITEMS)}
+     end},
+    -- New-Order: insert an order line.
+    {name = 'new_order_line', sql = [[
+        INSERT INTO order_line VALUES (?, ?, ?, ?, ?, ?, ?)]],
+     args = function()
+        tpcc_next_order_id = tpcc_next_order_id + 1
+        return {tpcc_warehouse(), tpcc_district(), tpcc_next_order_id, 1,
+                math.random(TPCC_ITEMS), 5, math.random(1, 999999) / 100}
+     end},
+    -- Payment: update the customer balance.
+    {name = 'payment_customer', sql = [[
+        UPDATE customer
+        SET c_balance = c_balance - ?, c_ytd_payment = c_ytd_payment + ?,
+            c_payment_cnt = c_payment_cnt + 1
+        WHERE c_w_id = ? AND c_d_id = ? AND c_id = ?]],
+     args = function()
+        local amount = math.random(100, 500000) / 100
+        return {amount, amount, tpcc_warehouse(), tpcc_district(),
+                math.random(TPCC_CUSTOMERS)}
+     end},
+    -- Payment: find the customer by the last name.
+    {name = 'payment_customer_by_name', sql = [[
+        SELECT c_id, c_balance FROM customer
+        WHERE c_w_id = ? AND c_d_id = ? AND c_last = ?
+        ORDER BY c_id]],
+     args = function()
+        return {tpcc_warehouse(), tpcc_district(),
+                tpcc_last_name(math.random(0, 999))}
+     end},
+    -- Order-Status: find the last order of the customer.
+    {name = 'order_status_order', sql = [[
+        SELECT o_id, o_entry_d FROM orders
+        WHERE o_w_id = ? AND o_d_id = ? AND o_c_id = ?
+        ORDER BY o_id DESC
+        LIMIT 1]],
+     args = function()
+        return {tpcc_warehouse(), tpcc_district(),
+                math.random(TPCC_CUSTOMERS)}
+     end},
+    -- Order-Status: get the lines of the order.
+    {name = 'order_status_lines', sql = [[
+        SELECT ol_i_id, ol_quantity, ol_amount FROM order_line
+        WHERE ol_w_id = ? AND ol_d_id = ? AND ol_o_id = ?]],
+     args = function()
+        return {tpcc_warehouse(), tpcc_district(),
+                math.random(TPCC_ORDERS)}
+     end},
+    -- Delivery: find the oldest new order of the district.
+    {name = 'delivery_new_order', sql = [[
+        SELECT MIN(no_o_id) FROM new_order
+        WHERE no_w_id = ? AND no_d_id = ?]],
+     args = function()
+        return {tpcc_warehouse(), tpcc_district()}
+     end},
+    -- Stock-Level: count the items of the last 20 orders with low stock.
+    {name = 'stock_level', sql = [[
+        SELECT COUNT(DISTINCT s_i_id) FROM order_line, stock
+        WHERE ol_w_id = ? AND ol_d_id = ? AND ol_o_id >= ? AND
+              ol_o_id < ? AND s_w_id = ol_w_id AND s_i_id = ol_i_id AND
+              s_quantity < ?]],
+     args = function()
+        return {tpcc_warehouse(), tpcc_district(), TPCC_ORDERS - 19,
+                TPCC_ORDERS + 1, math.random(10, 20)}
+     end},
+}
+
+-------------------------------------------------------------------------------
+
+--
+-- Array of test cases.
+--
+-- A test case is represented by a table with the following fields:
+--
+-- * workload: 'tpch' or 'tpcc'
+-- * engine: engine of the test tables
+--
+local TESTS = {
+    {workload = 'tpch', engine = 'memtx'},
+    {workload = 'tpch', engine = 'vinyl'},
+    {workload = 'tpcc', engine = 'memtx'},
+    {workload = 'tpcc', engine = 'vinyl'},
+}
+
+local WORKLOADS = {
+    tpch = {
+        schema = TPCH_SCHEMA,
+        load = tpch_load,
+        queries = TPCH_QUERIES,
+        iterations = tpch_iterations,
+    },
+    tpcc = {
+        schema = TPCC_SCHEMA,
+        load = tpcc_load,
+        queries = TPCC_QUERIES,
+        iterations = tpcc_iterations,
+    },
+}
+
+-- Returns the number of VDBE instructions executed by the query.
+local function opcode_count(query)
+    local res = execute('EXPLAIN ANALYZE ' .. query.sql,
+                        query.args and query.args())
+    local count = 0
+    for _, row in ipairs(res.rows) do
+        -- The 'count' column.
+        count = count + row[9]
+    end
+    return count
+end
+
+local function bench(test)
+    local workload = WORKLOADS[test.workload]
+    execute(string.format([[SET SESSION "sql_default_engine" = '%s']],
+                          test.engine))
+    for _, sql in ipairs(workload.schema) do
+        execute(sql)
+    end
+    math.randomseed(42)
+    workload.load()
+    local results = {}
+    for _, query in ipairs(workload.queries) do
+        -- Warm up the statement cache and the engine caches.
+        execute(query.sql, query.args and query.args())
+        local time = 0
+        for _ = 1, workload.iterations do
+            local args = query.args and query.args()
+            local start = clock.monotonic()
+            execute(query.sql, args)
+            time = time + clock.monotonic() - start
+        end
+        table.insert(results, {query.name .. '_time',
+                               time / workload.iterations * 1e6})
+        table.insert(results, {query.name .. '_opcodes', opcode_count(query)})
+    end
+    -- Drop the tables in the reverse order of creation. Indexes are dropped
+    -- together with their tables.
+    for i = #workload.schema, 1, -1 do
+        local name = workload.schema[i]:match('^CREATE TABLE ([%w_]+)')
+        if name ~= nil then
+            execute('DROP TABLE ' .. name)
+        end
+    end
+    return results
+end
+
+local function run()
+    box.cfg({
+        work_dir = test_dir,
+        log = fio.pathjoin(test_dir, 'tarantool.log'),
+        memtx_memory = 2 * 1024 * 1024 * 1024,
+        wal_mode = 'none',
+        checkpoint_interval = 0,
+    })
+    -- The analytical queries do full scans by design.
+    execute([[SET SESSION "sql_seq_scan" = true]])
+    for _, test in ipairs(TESTS) do
+        local name = string.format('%s_%s', test.workload, test.engine)
+        local skip = false
+        if params.pattern then
+            skip = true
+            for _, pattern in ipairs(params.pattern) do
+                if string.match(name, pattern) then
+                    skip = false
+                    break
+                end
+            end
+        end
+        if not skip then
+            for _, result in ipairs(bench(test)) do
+                print(string.format('%s_%s %d', name, result[1], result[2]))
+            end
+        end
+    end
+end
+
+local ok, err = pcall(run)
+fio.rmtree(test_dir)
+if not ok then
+    print(err)
+    os.exit(1)
+end
+os.exit(0)
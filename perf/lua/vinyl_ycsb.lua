@@ -0,0 +1,381 @@
+--
+-- The test runs YCSB-like workloads against a vinyl space and reports
+-- throughput, latency and LSM tree amplification.
+--
+-- First the space is loaded with the given number of records, then each
+-- selected workload is run for the given number of operations:
+--
+-- a: 50% reads, 50% updates
+-- b: 95% reads, 5% updates
+-- c: 100% reads
+-- d: 95% reads, 5% inserts, reads prefer recently inserted records
+-- e: 95% scans, 5% inserts
+-- f: 50% reads, 50% read-modify-writes
+--
+-- Keys are chosen with the zipfian distribution (or the uniform one if
+-- configured so), scrambled over the key space like in YCSB.
+--
+-- While a workload is running, per-interval throughput, latencies and
+-- dump/compaction progress are printed as comments (lines starting with
+-- '#'). When it completes, the results are printed in the format:
+--
+-- <test-case> <value>
+--
+-- where test-case is ycsb_<workload>_<metric>. The metrics are:
+--
+-- ops                   operations per second
+-- <op>_p50, _p99, _max  latency of the operation type in microseconds
+-- write_amplification   bytes written by dump and compaction per byte
+--                       written by transactions
+-- read_amplification    bytes read from disk per byte returned by reads
+-- space_amplification   disk size of the LSM tree divided by the size of
+--                       its last level
+-- dump_bandwidth        bytes dumped per second of dump time
+-- compaction_bandwidth  bytes compacted per second of compaction time
+--
+-- Options:
+-- --workload <string>       workloads to run, e.g. 'a|c', default all
+-- --records <number>        number of records loaded, default 1000000
+-- --operations <number>     number of operations per workload,
+--                           default 1000000
+-- --fields <number>         number of fields in a record, default 10
+-- --field_size <number>     size of a field in bytes, default 100
+-- --fibers <number>         number of concurrent client fibers, default 10
+-- --distribution <string>   'zipfian' or 'uniform', default 'zipfian'
+-- --report_interval <number> interval of progress reports in seconds,
+--                           default 10
+-- --vinyl_memory <number>   box.cfg.vinyl_memory, default 128 MB
+-- --vinyl_cache <number>    box.cfg.vinyl_cache, default 64 MB
+--
+
+local clock = require('clock')
+local ffi = require('ffi')
+local fiber = require('fiber')
+local fio = require('fio')
+
+local params = require('internal.argparse').parse(arg, {
+    {'workload', 'string'},
+    {'records', 'number'},
+    {'operations', 'number'},
+    {'fields', 'number'},
+    {'field_size', 'number'},
+    {'fibers', 'number'},
+    {'distribution', 'string'},
+    {'report_interval', 'number'},
+    {'vinyl_memory', 'number'},
+    {'vinyl_cache', 'number'},
+})
+
+local workloads = string.split(params.workload or 'a|b|c|d|e|f', '|')
+local record_count = params.records or 1000000
+local operation_count = params.operations or 1000000
+local field_count = params.fields or 10
+local field_size = params.field_size or 100
+local fiber_count = params.fibers or 10
+local distribution = params.distribution or 'zipfian'
+local report_interval = params.report_interval or 10
+assert(distribution == 'zipfian' or distribution == 'uniform')
+
+-- Max number of records returned by a scan.
+local SCAN_LENGTH_MAX = 100
+-- Number of records inserted in one transaction while loading.
+local LOAD_BATCH_SIZE = 100
+
+--
+-- Workload definitions: shares of operations of each type, which must sum
+-- up to 1, and the key distribution used for reads.
+--
+local WORKLOADS = {
+    a = {read = 0.5, update = 0.5},
+    b = {read = 0.95, update = 0.05},
+    c = {read = 1},
+    d = {read = 0.95, insert = 0.05, latest = true},
+    e = {scan = 0.95, insert = 0.05},
+    f = {read = 0.5, rmw = 0.5},
+}
+local OPERATIONS = {'read', 'update', 'insert', 'scan', 'rmw'}
+
+local test_dir = fio.tempdir()
+
+box.cfg({
+    work_dir = test_dir,
+    log_level = 'error',
+    vinyl_memory = params.vinyl_memory or 128 * 1024 * 1024,
+    vinyl_cache = params.vinyl_cache or 64 * 1024 * 1024,
+})
+
+--
+-- Zipfian generator of numbers in range [0, n) as described in
+-- "Quickly Generating Billion-Record Synthetic Databases" by Gray et al.
+-- and implemented in YCSB.
+--
+local ZIPFIAN_THETA = 0.99
+
+local function zipfian_new(n)
+    local zetan = 0
+    for i = 1, n do
+        zetan = zetan + 1 / math.pow(i, ZIPFIAN_THETA)
+    end
+    local zeta2 = 1 + math.pow(0.5, ZIPFIAN_THETA)
+    return {
+        n = n,
+        zetan = zetan,
+        alpha = 1 / (1 - ZIPFIAN_THETA),
+        eta = (1 - math.pow(2 / n, 1 - ZIPFIAN_THETA)) / (1 - zeta2 / zetan),
+    }
+end
+
+local function zipfian_next(z)
+    local u = math.random()
+    local uz = u * z.zetan
+    if uz < 1 then
+        return 0
+    end
+    if uz < 1 + math.pow(0.5, ZIPFIAN_THETA) then
+        return 1
+    end
+    return math.floor(z.n * math.pow(z.eta * u - z.eta + 1, z.alpha))
+end
+
+local zipfian = distribution == 'zipfian' and zipfian_new(record_count)
+
+-- Returns a rank of a key, rank 0 being the most popular.
+local function next_rank()
+    if zipfian then
+        return zipfian_next(zipfian)
+    end
+    return math.random(0, record_count - 1)
+end
+
+-- Scatters popular ranks over the key space.
+local function scramble(rank, n)
+    return tonumber(ffi.cast('uint64_t', rank) * 0x9E3779B97F4A7C15ULL % n)
+end
+
+-- Number of records in the space, grows with inserts.
+local key_count = record_count
+
+local function next_key(workload)
+    if workload.latest then
+        -- Prefer recently inserted records.
+        return math.max(key_count - 1 - next_rank(), 0)
+    end
+    return scramble(next_rank(), key_count)
+end
+
+local field_value = string.rep('x', field_size)
+
+local function make_record(key)
+    local record = {key}
+    for i = 1, field_count do
+        record[i + 1] = field_value
+    end
+    return record
+end
+
+local space = box.schema.space.create('ycsb', {engine = 'vinyl'})
+space:create_index('pk', {parts = {1, 'unsigned'}})
+local pk = space.index.pk
+
+--
+-- Functions executing operations of each type.
+--
+local EXECUTORS = {
+    read = function(workload)
+        pk:get(next_key(workload))
+    end,
+    update = function(workload)
+        local field = math.random(2, field_count + 1)
+        space:update(next_key(workload), {{'=', field, field_value}})
+    end,
+    insert = function()
+        local key = key_count
+        key_count = key_count + 1
+        space:insert(make_record(key))
+    end,
+    scan = function(workload)
+        local limit = math.random(1, SCAN_LENGTH_MAX)
+        pk:select(next_key(workload), {iterator = 'GE', limit = limit})
+    end,
+    rmw = function(workload)
+        local key = next_key(workload)
+        box.begin()
+        local tuple = pk:get(key)
+        if tuple ~= nil then
+            local field = math.random(2, field_count + 1)
+            space:replace(tuple:update({{'=', field, field_value}}))
+        end
+        box.commit()
+    end,
+}
+
+-- Returns the given percentile of an array of samples, sorting it.
+local function percentile(samples, p)
+    if #samples == 0 then
+        return 0
+    end
+    table.sort(samples)
+    return samples[math.max(math.ceil(#samples * p), 1)]
+end
+
+local function load()
+    local start = clock.monotonic()
+    local next_key_to_load = 0
+    local fibers = {}
+    for i = 1, fiber_count do
+        fibers[i] = fiber.new(function()
+            while next_key_to_load < record_count do
+                local first = next_key_to_load
+                local last = math.min(first + LOAD_BATCH_SIZE,
+                                      record_count) - 1
+                next_key_to_load = last + 1
+                box.begin()
+                for key = first, last do
+                    space:insert(make_record(key))
+                end
+                box.commit()
+            end
+        end)
+        fibers[i]:set_joinable(true)
+    end
+    for _, f in ipairs(fibers) do
+        assert(f:join())
+    end
+    local time = clock.monotonic() - start
+    print(string.format('ycsb_load_ops %d', record_count / time))
+end
+
+local function stat_snapshot()
+    local st = pk:stat()
+    local sched = box.stat.vinyl().scheduler
+    return {
+        put = st.put.bytes,
+        get = st.get.bytes,
+        disk_read = st.disk.iterator.read.bytes,
+        dump_output = st.disk.dump.output.bytes,
+        compaction_output = st.disk.compaction.output.bytes,
+        disk = st.disk.bytes,
+        last_level = st.disk.last_level.bytes,
+        dump_time = sched.dump_time,
+        sched_dump_output = sched.dump_output,
+        compaction_time = sched.compaction_time,
+        sched_compaction_output = sched.compaction_output,
+    }
+end
+
+local function ratio(a, b)
+    return b > 0 and a / b or 0
+end
+
+local function run(name)
+    local workload = assert(WORKLOADS[name], 'unknown workload ' .. name)
+    -- Cumulative distribution of operation types.
+    local cdf = {}
+    local share = 0
+    for _, op in ipairs(OPERATIONS) do
+        if workload[op] then
+            share = share + workload[op]
+            table.insert(cdf, {op = op, share = share})
+        end
+    end
+    local function next_op()
+        local u = math.random()
+        for _, entry in ipairs(cdf) do
+            if u < entry.share then
+                return entry.op
+            end
+        end
+        return cdf[#cdf].op
+    end
+    -- Latency samples in microseconds of the whole run and of the current
+    -- report interval by operation type.
+    local samples, interval_samples = {}, {}
+    for _, entry in ipairs(cdf) do
+        samples[entry.op] = {}
+        interval_samples[entry.op] = {}
+    end
+    local stat_before = stat_snapshot()
+    local start = clock.monotonic()
+    local ops_done = 0
+    local fibers = {}
+    for i = 1, fiber_count do
+        fibers[i] = fiber.new(function()
+            while ops_done < operation_count do
+                ops_done = ops_done + 1
+                local op = next_op()
+                local t = clock.monotonic()
+                EXECUTORS[op](workload)
+                local latency = (clock.monotonic() - t) * 1e6
+                table.insert(samples[op], latency)
+                table.insert(interval_samples[op], latency)
+            end
+        end)
+        fibers[i]:set_joinable(true)
+    end
+    local reporter = fiber.new(function()
+        local interval_start = start
+        local interval_ops = 0
+        local stat_prev = stat_before
+        while true do
+            fiber.sleep(report_interval)
+            local now = clock.monotonic()
+            local stat = stat_snapshot()
+            local line = {string.format(
+                '# %s %ds: %d ops/s', name, now - start,
+                (ops_done - interval_ops) / (now - interval_start))}
+            for _, entry in ipairs(cdf) do
+                local s = interval_samples[entry.op]
+                table.insert(line, string.format(
+                    '%s p50 %d p99 %d us', entry.op, percentile(s, 0.5),
+                    percentile(s, 0.99)))
+                interval_samples[entry.op] = {}
+            end
+            table.insert(line, string.format(
+                'dump %d KB compaction %d KB',
+                (stat.dump_output - stat_prev.dump_output) / 1024,
+                (stat.compaction_output - stat_prev.compaction_output) /
+                1024))
+            print(table.concat(line, ', '))
+            interval_start = now
+            interval_ops = ops_done
+            stat_prev = stat
+        end
+    end)
+    for _, f in ipairs(fibers) do
+        assert(f:join())
+    end
+    local time = clock.monotonic() - start
+    reporter:cancel()
+    local stat = stat_snapshot()
+    local function result(metric, value)
+        print(string.format('ycsb_%s_%s %s', name, metric, value))
+    end
+    result('ops', math.floor(operation_count / time))
+    for _, entry in ipairs(cdf) do
+        local s = samples[entry.op]
+        result(entry.op .. '_p50', math.floor(percentile(s, 0.5)))
+        result(entry.op .. '_p99', math.floor(percentile(s, 0.99)))
+        result(entry.op .. '_max', math.floor(percentile(s, 1)))
+    end
+    local function delta(key)
+        return stat[key] - stat_before[key]
+    end
+    result('write_amplification', string.format('%.2f', ratio(
+        delta('dump_output') + delta('compaction_output'), delta('put'))))
+    result('read_amplification', string.format('%.2f', ratio(
+        delta('disk_read'), delta('get'))))
+    result('space_amplification', string.format('%.2f', ratio(
+        stat.disk, stat.last_level)))
+    result('dump_bandwidth', math.floor(ratio(
+        delta('sched_dump_output'), delta('dump_time'))))
+    result('compaction_bandwidth', math.floor(ratio(
+        delta('sched_compaction_output'), delta('compaction_time'))))
+end
+
+load()
+for _, name in ipairs(workloads) do
+    run(name)
+end
+
+fio.rmtree(test_dir)
+os.exit(0)
@@ -0,0 +1,326 @@
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include <unistd.h>
+
+#include "crc32.h"
+#include "fiber.h"
+#include "memory.h"
+#include "random.h"
+#include "msgpuck.h"
+#include "trivia/util.h"
+#include "vclock/vclock.h"
+
+#include "iproto_constants.h"
+#include "xlog.h"
+#include "xrow.h"
+
+#include <benchmark/benchmark.h>
+
+/**
+ * This suite contains benchmarks for encoding rows and writing them to
+ * xlog files, which is what the WAL thread does for every transaction.
+ *
+ * The xlog files are written to a temporary directory created in the
+ * current working directory, so the results of the benchmarks doing
+ * disk I/O depend on the file system it is located on.
+ */
+
+/** Number of distinct rows written by the benchmarks. */
+static constexpr size_t row_count = 4096;
+/** Max size of an xlog file after which a new one is started. */
+static constexpr off_t xlog_size_max = 256 * 1024 * 1024;
+
+/**
+ * The environment singleton initializes the subsystems used by xlog and
+ * owns the temporary directory the xlog files are written to.
+ */
+class Env {
+public:
+	Env(Env &other) = delete;
+	Env &operator=(Env &other) = delete;
+
+	static Env &instance()
+	{
+		static Env instance;
+		return instance;
+	}
+	const char *dirname() const { return dir; }
+private:
+	Env()
+	{
+		memory_init();
+		fiber_init(fiber_c_invoke);
+		random_init();
+		crc32_init();
+		strcpy(dir, "./xlog_perf.XXXXXX");
+		if (mkdtemp(dir) == NULL)
+			abort();
+	}
+	~Env()
+	{
+		rmdir(dir);
+		random_free();
+		fiber_free();
+		memory_free();
+	}
+
+	char dir[PATH_MAX];
+};
+
+/**
+ * A set of DML rows with bodies of the given size. The body data is
+ * generated from a small alphabet so that it compresses like typical
+ * user data rather than like random bytes.
+ */
+class TestRows {
+public:
+	explicit TestRows(size_t body_size)
+	{
+		std::mt19937 gen(42);
+		std::uniform_int_distribution<int> dist('a', 'p');
+		std::vector<char> str(body_size);
+		for (size_t i = 0; i < row_count; i++) {
+			for (size_t j = 0; j < body_size; j++)
+				str[j] = dist(gen);
+			char *body = (char *)xmalloc(body_size + 32);
+			char *d = mp_encode_map(body, 2);
+			d = mp_encode_uint(d, IPROTO_SPACE_ID);
+			d = mp_encode_uint(d, 512);
+			d = mp_encode_uint(d, IPROTO_TUPLE);
+			d = mp_encode_array(d, 2);
+			d = mp_encode_uint(d, i);
+			d = mp_encode_str(d, str.data(), body_size);
+			struct xrow_header row;
+			memset(&row, 0, sizeof(row));
+			row.type = IPROTO_REPLACE;
+			row.replica_id = 1;
+			row.lsn = i + 1;
+			row.tm = 1700000000.0;
+			row.bodycnt = 1;
+			row.body[0].iov_base = body;
+			row.body[0].iov_len = d - body;
+			rows.push_back(row);
+		}
+	}
+	~TestRows()
+	{
+		for (auto &row : rows)
+			free(row.body[0].iov_base);
+	}
+	struct xrow_header &operator[](size_t i) { return rows[i]; }
+private:
+	std::vector<struct xrow_header> rows;
+};
+
+/**
+ * An xlog file in the temporary directory. Once the file grows above
+ * xlog_size_max, it is removed and a new one is started so that the
+ * benchmarks don't run out of disk space.
+ */
+class TestXlog {
+public:
+	explicit TestXlog(const struct xlog_opts *opts)
+	{
+		Env &env = Env::instance();
+		struct tt_uuid uuid;
+		memset(&uuid, 1, sizeof(uuid));
+		vclock_create(&vclock);
+		xdir_create(&xdir, env.dirname(), XLOG, &uuid, opts);
+		open();
+	}
+	~TestXlog()
+	{
+		close();
+		xdir_destroy(&xdir);
+	}
+	/** Writes the rows as one transaction. */
+	void write_tx(struct xrow_header **rows, size_t count)
+	{
+		xlog_tx_begin(&xlog);
+		for (size_t i = 0; i < count; i++) {
+			if (xlog_write_row(&xlog, rows[i]) < 0)
+				abort();
+		}
+		if (xlog_tx_commit(&xlog) < 0)
+			abort();
+	}
+	/** Writes the buffered data to the file and syncs it if asked. */
+	void flush(bool sync)
+	{
+		if (xlog_flush(&xlog) < 0)
+			abort();
+		if (sync && fdatasync(xlog.fd) != 0)
+			abort();
+		if (xlog.offset > xlog_size_max) {
+			close();
+			open();
+		}
+	}
+private:
+	void open()
+	{
+		if (xdir_create_xlog(&xdir, &xlog, &vclock) != 0)
+			abort();
+	}
+	void close()
+	{
+		char filename[PATH_MAX];
+		strlcpy(filename, xlog.filename, sizeof(filename));
+		if (xlog_close(&xlog) != 0)
+			abort();
+		unlink(filename);
+	}
+
+	struct xdir xdir;
+	struct xlog xlog;
+	struct vclock vclock;
+};
+
+/** Benchmark of encoding a row header. */
+static void
+row_header_encode(benchmark::State &state)
+{
+	Env::instance();
+	TestRows rows(state.range(0));
+	size_t i = 0;
+	size_t total_count = 0;
+	for (auto _ : state) {
+		if (i == row_count) {
+			total_count += i;
+			i = 0;
+			fiber_gc();
+		}
+		struct iovec iov[XROW_IOVMAX];
+		int iovcnt;
+		xrow_header_encode(&rows[i], /*sync=*/0, /*fixheader_len=*/0,
+				   iov, &iovcnt);
+		benchmark::DoNotOptimize(iov[0].iov_base);
+		++i;
+	}
+	total_count += i;
+	fiber_gc();
+	state.SetItemsProcessed(total_count);
+}
+
+BENCHMARK(row_header_encode)->Arg(16)->Arg(256);
+
+/** Benchmark of decoding a row encoded by xrow_header_encode(). */
+static void
+row_header_decode(benchmark::State &state)
+{
+	Env::instance();
+	TestRows rows(state.range(0));
+	std::vector<std::vector<char>> encoded(row_count);
+	for (size_t i = 0; i < row_count; i++) {
+		struct iovec iov[XROW_IOVMAX];
+		int iovcnt;
+		xrow_header_encode(&rows[i], /*sync=*/0, /*fixheader_len=*/0,
+				   iov, &iovcnt);
+		for (int j = 0; j < iovcnt; j++) {
+			const char *data = (const char *)iov[j].iov_base;
+			encoded[i].insert(encoded[i].end(), data,
+					  data + iov[j].iov_len);
+		}
+	}
+	fiber_gc();
+	size_t i = 0;
+	size_t total_count = 0;
+	for (auto _ : state) {
+		if (i == row_count) {
+			total_count += i;
+			i = 0;
+		}
+		struct xrow_header row;
+		const char *pos = encoded[i].data();
+		const char *end = pos + encoded[i].size();
+		if (xrow_header_decode(&row, &pos, end, true) != 0)
+			abort();
+		benchmark::DoNotOptimize(row);
+		++i;
+	}
+	total_count += i;
+	state.SetItemsProcessed(total_count);
+}
+
+BENCHMARK(row_header_decode)->Arg(16)->Arg(256);
+
+/**
+ * Benchmark of writing rows to an xlog file in transactions of the given
+ * size with or without compression. The file isn't synced, so this
+ * measures encoding, checksumming, compression and the write syscall.
+ *
+ * Arguments: body size, transaction size, compression enabled.
+ */
+static void
+xlog_write_rows(benchmark::State &state)
+{
+	struct xlog_opts opts = xlog_opts_default;
+	opts.no_compression = state.range(2) == 0;
+	TestRows rows(state.range(0));
+	size_t tx_size = state.range(1);
+	TestXlog xlog(&opts);
+	std::vector<struct xrow_header *> tx(tx_size);
+	size_t i = 0;
+	size_t total_count = 0;
+	for (auto _ : state) {
+		for (size_t j = 0; j < tx_size; j++) {
+			tx[j] = &rows[i];
+			if (++i == row_count)
+				i = 0;
+		}
+		xlog.write_tx(tx.data(), tx_size);
+		xlog.flush(/*sync=*/false);
+		total_count += tx_size;
+	}
+	state.SetItemsProcessed(total_count);
+	state.SetBytesProcessed(total_count * state.range(0));
+}
+
+BENCHMARK(xlog_write_rows)
+	->ArgNames({"body", "tx", "zstd"})
+	->ArgsProduct({{16, 256, 4096}, {1, 16}, {0, 1}});
+
+/**
+ * Benchmark of group commit: rows are written one transaction per row,
+ * like in the WAL, and the file is synced after every batch of the given
+ * size. A batch corresponds to the transactions of concurrent writers
+ * collected by the WAL thread while the previous sync was in progress,
+ * so the time per item is the commit cost of a transaction depending
+ * on the number of concurrent writers.
+ *
+ * Arguments: batch size, compression enabled.
+ */
+static void
+xlog_group_commit(benchmark::State &state)
+{
+	struct xlog_opts opts = xlog_opts_default;
+	opts.no_compression = state.range(1) == 0;
+	TestRows rows(256);
+	size_t batch_size = state.range(0);
+	TestXlog xlog(&opts);
+	size_t i = 0;
+	size_t total_count = 0;
+	for (auto _ : state) {
+		for (size_t j = 0; j < batch_size; j++) {
+			struct xrow_header *row = &rows[i];
+			xlog.write_tx(&row, 1);
+			if (++i == row_count)
+				i = 0;
+		}
+		xlog.flush(/*sync=*/true);
+		total_count += batch_size;
+	}
+	state.SetItemsProcessed(total_count);
+}
+
+BENCHMARK(xlog_group_commit)
+	->ArgNames({"batch", "zstd"})
+	->ArgsProduct({{1, 8, 64, 512}, {0, 1}})
+	->UseRealTime();
+
+BENCHMARK_MAIN();
+
+#include "debug_warning.h"
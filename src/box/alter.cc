@@ -58,6 +58,7 @@
 #include "sql.h"
 #include "space_upgrade.h"
 #include "box.h"
+#include "expire.h"
 #include "authentication.h"
 #include "node_name.h"
 
@@ -227,6 +228,12 @@ index_opts_decode(struct index_opts *opts, const char *map,
 			 "distance must be either 'euclid' or 'manhattan'");
 		return -1;
 	}
+	if (opts->hash_func == index_hash_func_MAX) {
+		diag_set(ClientError, ER_WRONG_INDEX_OPTIONS,
+			 "hash_func must be one of 'murmur', 'wyhash' "
+			 "or 'xxh3'");
+		return -1;
+	}
 	if (opts->page_size <= 0 || (opts->range_size > 0 &&
 				     opts->page_size > opts->range_size)) {
 		diag_set(ClientError, ER_WRONG_INDEX_OPTIONS,
@@ -561,6 +568,18 @@ space_def_new_from_tuple(struct tuple *tuple, uint32_t errcode,
 			 "local space can't be synchronous");
 		return NULL;
 	}
+	if (opts.expire_field < field_count &&
+	    !expire_field_type_is_supported(fields[opts.expire_field].type)) {
+		diag_set(ClientError, errcode, tt_cstr(name, name_len),
+			 "expire_field must be of type unsigned, integer, "
+			 "number, double or datetime");
+		return NULL;
+	}
+	if (opts.upsert_window < 0) {
+		diag_set(ClientError, errcode, tt_cstr(name, name_len),
+			 "upsert_window must be greater than or equal to 0");
+		return NULL;
+	}
 	if (space_opts_is_temporary(&opts) && opts.constraint_count > 0) {
 		diag_set(ClientError, ER_UNSUPPORTED, "temporary space",
 			 "constraints");
@@ -4866,6 +4885,8 @@ on_replace_dd_sequence(struct trigger * /* trigger */, void *event)
 		if (on_commit == NULL || on_rollback == NULL)
 			return -1;
 		seq->def = new_def;
+		/* Reserved values may not fit the new bounds. */
+		seq->cache_left = 0;
 		txn_stmt_on_commit(stmt, on_commit);
 		txn_stmt_on_rollback(stmt, on_rollback);
 	}
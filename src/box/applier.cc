@@ -51,6 +51,9 @@
 #include "session.h"
 #include "cfg.h"
 #include "schema.h"
+#include "space.h"
+#include "index.h"
+#include "key_def.h"
 #include "txn.h"
 #include "box.h"
 #include "xrow.h"
@@ -62,6 +65,8 @@
 #include "tt_static.h"
 #include "memory.h"
 #include "ssl_error.h"
+#include "zstd_iostream.h"
+#include "usdt.h"
 
 STRS(applier_state, applier_STATE);
 
@@ -1382,9 +1387,13 @@ applier_handle_raft_request(struct applier *applier, struct raft_request *req)
 	return box_raft_process(req, applier->instance_id);
 }
 
-static int
-apply_plain_tx(uint32_t replica_id, struct stailq *rows,
-	       bool skip_conflict, bool use_triggers)
+/**
+ * Begin a transaction and apply the given rows in it without submitting
+ * the transaction to WAL. Returns the transaction or NULL on failure,
+ * in which case the transaction is aborted.
+ */
+static struct txn *
+apply_plain_tx_rows(struct stailq *rows, bool skip_conflict)
 {
 	/*
 	 * Explicitly begin the transaction so that we can
@@ -1395,7 +1404,7 @@ apply_plain_tx(uint32_t replica_id, struct stailq *rows,
 	struct txn *txn = txn_begin();
 	struct applier_tx_row *item;
 	if (txn == NULL)
-		 return -1;
+		 return NULL;
 	txn->isolation = TXN_ISOLATION_READ_COMMITTED;
 
 	stailq_foreach_entry(item, rows, next) {
@@ -1451,7 +1460,21 @@ apply_plain_tx(uint32_t replica_id, struct stailq *rows,
 	 */
 	if ((item->row.flags & IPROTO_FLAG_WAIT_ACK) != 0)
 		box_txn_make_sync();
+	return txn;
+fail:
+	txn_abort(txn);
+	return NULL;
+}
 
+/**
+ * Submit a transaction prepared by apply_plain_tx_rows() to WAL.
+ */
+static int
+apply_plain_tx_commit(struct txn *txn, uint32_t replica_id,
+		      struct stailq *rows, bool use_triggers)
+{
+	struct applier_tx_row *item =
+		stailq_last_entry(rows, struct applier_tx_row, next);
 	if (use_triggers) {
 		/* We are ready to submit txn to wal. */
 		struct trigger *on_rollback, *on_wal_write;
@@ -1496,6 +1519,16 @@ apply_plain_tx(uint32_t replica_id, struct stailq *rows,
 	return -1;
 }
 
+static int
+apply_plain_tx(uint32_t replica_id, struct stailq *rows,
+	       bool skip_conflict, bool use_triggers)
+{
+	struct txn *txn = apply_plain_tx_rows(rows, skip_conflict);
+	if (txn == NULL)
+		return -1;
+	return apply_plain_tx_commit(txn, replica_id, rows, use_triggers);
+}
+
 /** A simpler version of applier_apply_tx() for final join stage. */
 static int
 apply_final_join_tx(uint32_t replica_id, struct stailq *rows)
@@ -1717,11 +1750,352 @@ applier_apply_tx(struct applier *applier, struct stailq *rows)
 
 	vclock_follow(&replicaset.applier.vclock, last_row->replica_id,
 		      last_row->lsn);
+	USDT_PROBE(applier_tx_applied, last_row->replica_id, last_row->lsn);
 finish:
 	latch_unlock(latch);
 	return rc;
 }
 
+/** A key modified by a transaction applied in a parallel group. */
+struct applier_tx_key {
+	/** Space identifier. */
+	uint32_t space_id;
+	/** Hash of the primary key. */
+	uint32_t hash;
+};
+
+struct applier_group;
+
+/** A transaction applied by a fiber of a parallel group. */
+struct applier_worker {
+	/** The group the transaction belongs to. */
+	struct applier_group *group;
+	/** Rows of the transaction. */
+	struct stailq *rows;
+	/** Position of the transaction in the group. */
+	int idx;
+	/**
+	 * Position of the last preceding transaction in the group that
+	 * modifies any of the keys modified by this one or -1.
+	 */
+	int dep;
+	/**
+	 * Set if the transaction may be applied before all preceding
+	 * transactions are submitted to WAL, i.e. if it only touches
+	 * spaces of engines that support yields in transactions.
+	 */
+	bool is_early;
+	/** Keys modified by the transaction. */
+	struct applier_tx_key *keys;
+	/** Number of entries in the keys array. */
+	int key_count;
+	/** The fiber applying the transaction. */
+	struct fiber *fiber;
+	/** Error that occurred while applying the transaction. */
+	struct diag diag;
+};
+
+/**
+ * A group of consecutive transactions of the same origin applied
+ * concurrently in separate fibers. A transaction waits for all preceding
+ * transactions modifying the same keys to be submitted to WAL before
+ * it starts, and the transactions are submitted to WAL strictly in
+ * the order they were received so the commit order is preserved.
+ */
+struct applier_group {
+	/** The applier the transactions were received by. */
+	struct applier *applier;
+	/** The order latch of the transactions origin, held by the group. */
+	struct latch *latch;
+	/** Identifier of the transactions origin. */
+	uint32_t replica_id;
+	/** Number of transactions that have been submitted to WAL. */
+	int done;
+	/** Set if any transaction of the group failed. */
+	bool is_failed;
+	/** Signaled when a transaction is submitted to WAL. */
+	struct fiber_cond cond;
+	/** Number of transactions in the group. */
+	int count;
+	/** Maximal number of transactions in the group. */
+	int max_count;
+	/** Transactions of the group. */
+	struct applier_worker workers[REPLICATION_APPLY_FIBERS_MAX];
+};
+
+static void
+applier_group_create(struct applier_group *group, struct applier *applier)
+{
+	group->applier = applier;
+	group->latch = NULL;
+	group->replica_id = REPLICA_ID_NIL;
+	group->done = 0;
+	group->is_failed = false;
+	fiber_cond_create(&group->cond);
+	group->count = 0;
+	group->max_count = replication_apply_fibers;
+	assert(group->max_count <= REPLICATION_APPLY_FIBERS_MAX);
+}
+
+static void
+applier_group_destroy(struct applier_group *group)
+{
+	assert(group->count == 0);
+	fiber_cond_destroy(&group->cond);
+}
+
+/**
+ * Collect the primary keys modified by a transaction. Returns false if
+ * the transaction can't be applied concurrently with others: it isn't
+ * plain DML, is synchronous, changes a system space, a space with
+ * triggers or unique secondary indexes, whose conflicts can't be
+ * detected by primary keys.
+ */
+static bool
+applier_tx_collect_keys(struct stailq *rows, struct applier_worker *worker)
+{
+	struct region *region = &fiber()->gc;
+	struct applier_tx_row *item;
+	int row_count = 0;
+	stailq_foreach_entry(item, rows, next)
+		row_count++;
+	size_t size;
+	struct applier_tx_key *keys = region_alloc_array(
+		region, typeof(*keys), row_count, &size);
+	if (keys == NULL) {
+		diag_clear(diag_get());
+		return false;
+	}
+	int key_count = 0;
+	bool is_early = true;
+	stailq_foreach_entry(item, rows, next) {
+		struct xrow_header *row = &item->row;
+		if (row->type == IPROTO_NOP)
+			continue;
+		if (!iproto_type_is_dml(row->type) ||
+		    (row->flags & IPROTO_FLAG_WAIT_ACK) != 0)
+			return false;
+		struct request *request = &item->req.dml;
+		struct space *space = space_by_id(request->space_id);
+		if (space == NULL || space_is_system(space) ||
+		    request->index_id != 0 ||
+		    space_has_before_replace_triggers(space) ||
+		    space_has_on_replace_triggers(space))
+			return false;
+		struct index *pk = space_index(space, 0);
+		if (pk == NULL)
+			return false;
+		for (uint32_t i = 1; i < space->index_count; i++) {
+			if (space->index[i]->def->opts.is_unique)
+				return false;
+		}
+		struct key_def *key_def = pk->def->key_def;
+		const char *key;
+		if (request->type == IPROTO_DELETE ||
+		    request->type == IPROTO_UPDATE) {
+			key = request->key;
+		} else {
+			key = tuple_extract_key_raw(request->tuple,
+						    request->tuple_end,
+						    key_def, MULTIKEY_NONE,
+						    NULL);
+		}
+		if (key == NULL)
+			goto invalid;
+		uint32_t part_count = mp_decode_array(&key);
+		const char *key_end;
+		if (part_count != key_def->part_count ||
+		    key_validate_parts(key_def, key, part_count, false,
+				       &key_end) != 0)
+			goto invalid;
+		keys[key_count].space_id = request->space_id;
+		keys[key_count].hash = key_hash(key, key_def);
+		key_count++;
+		if (!space_is_vinyl(space))
+			is_early = false;
+	}
+	worker->keys = keys;
+	worker->key_count = key_count;
+	worker->is_early = is_early;
+	return true;
+invalid:
+	/* Let the transaction fail when applied exclusively. */
+	diag_clear(diag_get());
+	return false;
+}
+
+/**
+ * Find the last transaction of the group modifying any of the keys
+ * modified by the given one.
+ */
+static int
+applier_group_find_dep(struct applier_group *group,
+		       struct applier_worker *worker)
+{
+	for (int i = group->count - 1; i >= 0; i--) {
+		struct applier_worker *prev = &group->workers[i];
+		for (int j = 0; j < worker->key_count; j++) {
+			struct applier_tx_key *key = &worker->keys[j];
+			for (int k = 0; k < prev->key_count; k++) {
+				if (key->space_id == prev->keys[k].space_id &&
+				    key->hash == prev->keys[k].hash)
+					return i;
+			}
+		}
+	}
+	return -1;
+}
+
+static void
+applier_group_wait(struct applier_group *group, int done)
+{
+	while (group->done < done)
+		fiber_cond_wait(&group->cond);
+}
+
+static int
+applier_worker_f(va_list ap)
+{
+	struct applier_worker *worker = va_arg(ap, struct applier_worker *);
+	struct applier_group *group = worker->group;
+	struct xrow_header *last_row = &stailq_last_entry(
+		worker->rows, struct applier_tx_row, next)->row;
+	applier_group_wait(group, worker->is_early ? worker->dep + 1 :
+				  worker->idx);
+	struct txn *txn = NULL;
+	if (!group->is_failed) {
+		txn = apply_plain_tx_rows(worker->rows,
+					  replication_skip_conflict);
+	}
+	/* Submit transactions to WAL in the order they were received. */
+	applier_group_wait(group, worker->idx);
+	if (group->is_failed) {
+		if (txn != NULL)
+			txn_abort(txn);
+		diag_clear(diag_get());
+	} else if (txn != NULL &&
+		   apply_plain_tx_commit(txn, group->applier->instance_id,
+					 worker->rows, true) == 0) {
+		vclock_follow(&replicaset.applier.vclock, last_row->replica_id,
+			      last_row->lsn);
+		USDT_PROBE(applier_tx_applied, last_row->replica_id,
+			   last_row->lsn);
+	} else {
+		group->is_failed = true;
+		diag_move(diag_get(), &worker->diag);
+	}
+	group->done++;
+	fiber_cond_broadcast(&group->cond);
+	return 0;
+}
+
+/**
+ * Wait for all transactions of the group to be submitted to WAL and
+ * release the group. Returns -1 and sets diag to the error of the first
+ * failed transaction if any.
+ */
+static int
+applier_group_flush(struct applier_group *group)
+{
+	if (group->latch == NULL) {
+		assert(group->count == 0);
+		return 0;
+	}
+	int rc = 0;
+	for (int i = 0; i < group->count; i++) {
+		struct applier_worker *worker = &group->workers[i];
+		fiber_join(worker->fiber);
+		if (rc == 0 && !diag_is_empty(&worker->diag)) {
+			diag_move(&worker->diag, diag_get());
+			rc = -1;
+		}
+		diag_destroy(&worker->diag);
+	}
+	latch_unlock(group->latch);
+	group->latch = NULL;
+	group->replica_id = REPLICA_ID_NIL;
+	group->done = 0;
+	group->is_failed = false;
+	group->count = 0;
+	return rc;
+}
+
+/**
+ * Try to apply a transaction concurrently with the other transactions
+ * of the group. Returns 1 if the transaction must be applied exclusively,
+ * in which case the group is flushed, 0 on success, -1 on error.
+ */
+static int
+applier_group_add(struct applier_group *group, struct stailq *rows)
+{
+	struct applier_tx_row *txr = stailq_first_entry(
+		rows, struct applier_tx_row, next);
+	struct xrow_header *first_row = &txr->row;
+	struct xrow_header *last_row = &stailq_last_entry(
+		rows, struct applier_tx_row, next)->row;
+	if (group->count == group->max_count ||
+	    (group->latch != NULL &&
+	     group->replica_id != first_row->replica_id)) {
+		if (applier_group_flush(group) != 0)
+			return -1;
+	}
+	struct applier_worker *worker = &group->workers[group->count];
+	if (group->max_count <= 1 ||
+	    iproto_type_is_synchro_request(first_row->type) ||
+	    !applier_tx_collect_keys(rows, worker)) {
+		if (applier_group_flush(group) != 0)
+			return -1;
+		return 1;
+	}
+	if (group->latch == NULL) {
+		/* See applier_apply_tx(). */
+		struct replica *replica = replica_by_id(first_row->replica_id);
+		group->latch = replica != NULL ? &replica->order_latch :
+			       &replicaset.applier.order_latch;
+		group->replica_id = first_row->replica_id;
+		latch_lock(group->latch);
+	}
+	if (vclock_get(&replicaset.applier.vclock,
+		       last_row->replica_id) >= last_row->lsn)
+		return 0;
+	if (vclock_get(&replicaset.applier.vclock,
+		       first_row->replica_id) >= first_row->lsn) {
+		struct xrow_header *tmp;
+		while (true) {
+			tmp = &stailq_first_entry(rows,
+						  struct applier_tx_row,
+						  next)->row;
+			if (tmp->lsn <= vclock_get(&replicaset.applier.vclock,
+						   tmp->replica_id)) {
+				stailq_shift(rows);
+			} else {
+				break;
+			}
+		}
+	}
+	applier_synchro_filter_tx(rows);
+	worker->group = group;
+	worker->rows = rows;
+	worker->idx = group->count;
+	worker->dep = applier_group_find_dep(group, worker);
+	worker->fiber = fiber_new_system("applier_worker", applier_worker_f);
+	if (worker->fiber == NULL) {
+		struct error *e = diag_last_error(diag_get());
+		error_ref(e);
+		applier_group_flush(group);
+		diag_set_error(diag_get(), e);
+		error_unref(e);
+		return -1;
+	}
+	diag_create(&worker->diag);
+	fiber_set_joinable(worker->fiber, true);
+	fiber_set_session(worker->fiber, current_session());
+	fiber_set_user(worker->fiber, effective_user());
+	group->count++;
+	fiber_start(worker->fiber, worker);
+	return 0;
+}
+
 /**
  * Notify the applier's write fiber that there are more ACKs to
  * send to master.
@@ -1895,6 +2269,14 @@ applier_process_batch(struct cmsg *base)
 	struct applier_data_msg *msg = (struct applier_data_msg *)base;
 	struct applier *applier = msg->base.applier;
 	struct applier_tx *tx;
+	int rc;
+	struct applier_group group;
+	applier_group_create(&group, applier);
+	RegionGuard region_guard(&fiber()->gc);
+	auto group_guard = make_scoped_guard([&] {
+		applier_group_flush(&group);
+		applier_group_destroy(&group);
+	});
 	stailq_foreach_entry(tx, &msg->txs, next) {
 		struct applier_tx_row *last_txr =
 			stailq_last_entry(&tx->rows, struct applier_tx_row,
@@ -1909,13 +2291,19 @@ applier_process_batch(struct cmsg *base)
 					       applier->instance_id);
 		}
 		if (last_txr->row.lsn == 0) {
+			if (applier_group_flush(&group) != 0)
+				diag_raise();
 			if (applier_process_heartbeat(applier, last_txr) != 0)
 				diag_raise();
 			if (applier_handle_raft(applier, last_txr) != 0)
 				diag_raise();
 			applier_signal_ack(applier);
 			applier_check_sync(applier);
-		} else if (applier_apply_tx(applier, &tx->rows) != 0) {
+		} else if (applier->state == APPLIER_FINAL_JOIN ||
+			   (rc = applier_group_add(&group, &tx->rows)) > 0) {
+			if (applier_apply_tx(applier, &tx->rows) != 0)
+				diag_raise();
+		} else if (rc != 0) {
 			diag_raise();
 		}
 		if (applier->state == APPLIER_FINAL_JOIN &&
@@ -1926,6 +2314,8 @@ applier_process_batch(struct cmsg *base)
 			applier_set_state(applier, APPLIER_FOLLOW);
 		}
 	}
+	if (applier_group_flush(&group) != 0)
+		diag_raise();
 
 	/* Return the message to applier thread. */
 	cmsg_init(&msg->base.base, return_route);
@@ -2382,12 +2772,33 @@ applier_subscribe(struct applier *applier)
 	strlcpy(req.instance_name, INSTANCE_NAME, NODE_NAME_SIZE_MAX);
 	req.version_id = tarantool_version_id();
 	req.is_anon = box_is_anon();
+	const char *compression = uri_param(&applier->uri, "compression", 0);
+	req.is_compressed = compression != NULL &&
+			    strcmp(compression, "zstd") == 0;
 	/*
 	 * Stop accepting local rows coming from a remote
 	 * instance as soon as local WAL starts accepting writes.
 	 */
 	req.id_filter = box_is_orphan() ? 0 : 1 << instance_id;
 	RegionGuard region_guard(&fiber()->gc);
+	/*
+	 * Ask the master to relay rows of the given user spaces only if
+	 * the replication URI has 'space' parameters.
+	 */
+	int space_count = uri_param_count(&applier->uri, "space");
+	if (space_count > 0) {
+		size_t size = mp_sizeof_array(space_count) +
+			      space_count * mp_sizeof_uint(UINT32_MAX);
+		char *buf = (char *)xregion_alloc(&fiber()->gc, size);
+		char *data = mp_encode_array(buf, space_count);
+		for (int i = 0; i < space_count; i++) {
+			const char *space = uri_param(&applier->uri, "space",
+						      i);
+			data = mp_encode_uint(data, strtoull(space, NULL, 10));
+		}
+		req.space_filter = buf;
+		req.space_filter_end = data;
+	}
 	xrow_encode_subscribe(&row, &req);
 	coio_write_xrow(io, &row);
 
@@ -2437,7 +2848,31 @@ applier_subscribe(struct applier *applier)
 			say_info("replicaset name mismatch allowed by "
 				 "'force_recovery'");
 		}
-		say_info("subscribed");
+		if (rsp.is_compressed) {
+			/*
+			 * The master may have already sent compressed data
+			 * following the response, pass it to the stream.
+			 */
+			struct iostream plain_io;
+			iostream_move(&plain_io, io);
+			if (zstd_iostream_create(io, &plain_io, ibuf->rpos,
+						 ibuf_used(ibuf)) != 0) {
+				iostream_move(io, &plain_io);
+				diag_raise();
+			}
+			ibuf_reset(ibuf);
+			say_info("subscribed with compression");
+		} else {
+			if (req.is_compressed) {
+				say_warn("the master doesn't support "
+					 "replication stream compression");
+			}
+			say_info("subscribed");
+		}
+		if (req.space_filter != NULL && rsp.space_filter == NULL) {
+			say_warn("the master doesn't support partial "
+				 "replication, receiving rows of all spaces");
+		}
 		say_info("remote vclock %s local vclock %s",
 			 vclock_to_string(&rsp.vclock),
 			 vclock_to_string(&req.vclock));
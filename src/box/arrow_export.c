@@ -0,0 +1,738 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2026, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#include "arrow_export.h"
+
+#include <assert.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "bit/bit.h"
+#include "diag.h"
+#include "error.h"
+#include "fiber.h"
+#include "field_def.h"
+#include "fio.h"
+#include "index.h"
+#include "msgpuck.h"
+#include "read_view.h"
+#include "small/ibuf.h"
+#include "small/util.h"
+#include "trivia/util.h"
+#include "tt_static.h"
+
+/*
+ * The Arrow IPC streaming format is a sequence of encapsulated messages:
+ * a schema message followed by record batch messages and terminated with
+ * an end-of-stream marker. A message consists of a continuation marker,
+ * the size of the metadata, the metadata itself, which is a Flatbuffers
+ * encoded Message table, and the message body. A record batch body holds
+ * the column buffers, each padded to 8 bytes.
+ *
+ * See https://arrow.apache.org/docs/format/Columnar.html
+ */
+
+/** Marker that starts each encapsulated message. */
+static const uint32_t arrow_continuation = 0xFFFFFFFF;
+
+enum {
+	/** MetadataVersion::V5. */
+	ARROW_METADATA_VERSION = 4,
+	/** MessageHeader union types. */
+	ARROW_HEADER_SCHEMA = 1,
+	ARROW_HEADER_RECORD_BATCH = 3,
+	/** Type union types. */
+	ARROW_TYPE_INT = 2,
+	ARROW_TYPE_FLOATING_POINT = 3,
+	ARROW_TYPE_BINARY = 4,
+	ARROW_TYPE_UTF8 = 5,
+	ARROW_TYPE_BOOL = 6,
+	/** Precision::DOUBLE. */
+	ARROW_PRECISION_DOUBLE = 2,
+	/** Alignment of message metadata and body buffers. */
+	ARROW_ALIGNMENT = 8,
+	/**
+	 * A record batch is written before it's full if the size of its
+	 * variable-length data reaches this limit. Keeps the batch memory
+	 * bounded and the value offsets, which are 32-bit, from overflow.
+	 */
+	ARROW_BATCH_DATA_MAX = 64 * 1024 * 1024,
+};
+
+/* {{{ Flatbuffers encoding */
+
+/*
+ * There are only a few tables in the Arrow metadata so instead of pulling
+ * in the Flatbuffers library, we encode them by hand, front to back: each
+ * table is written right after its vtable and the objects it refers to
+ * are written after it, because Flatbuffers offsets must point forward.
+ * Objects are addressed by their positions in the buffer, because it may
+ * be reallocated while it's written.
+ */
+
+/** Returns a pointer to the data at the given position of a buffer. */
+static inline char *
+fb_ptr(struct ibuf *b, size_t pos)
+{
+	return b->rpos + pos;
+}
+
+/** Appends zeroed bytes to a buffer and returns their position. */
+static size_t
+fb_alloc(struct ibuf *b, size_t size)
+{
+	size_t pos = ibuf_used(b);
+	if (size > 0)
+		memset(xibuf_alloc(b, size), 0, size);
+	return pos;
+}
+
+/** Pads a buffer with zeros so that its size plus @a bias is aligned. */
+static void
+fb_align(struct ibuf *b, size_t align, size_t bias)
+{
+	size_t pos = ibuf_used(b) + bias;
+	fb_alloc(b, small_align(pos, align) - pos);
+}
+
+/**
+ * Writes a vtable with the given field offsets (0 means the field is
+ * absent) followed by a zeroed table of the given size. Returns the
+ * position of the table, which is aligned to 8 bytes.
+ */
+static size_t
+fb_table(struct ibuf *b, const uint16_t *fields, uint16_t field_count,
+	 uint16_t table_size)
+{
+	uint16_t vtable_size = 4 + 2 * field_count;
+	fb_align(b, 8, vtable_size);
+	size_t vtable = fb_alloc(b, vtable_size);
+	store_u16(fb_ptr(b, vtable), vtable_size);
+	store_u16(fb_ptr(b, vtable + 2), table_size);
+	for (uint16_t i = 0; i < field_count; i++)
+		store_u16(fb_ptr(b, vtable + 4 + 2 * i), fields[i]);
+	size_t table = fb_alloc(b, table_size);
+	store_u32(fb_ptr(b, table), table - vtable);
+	return table;
+}
+
+/** Stores the offset of the object at @a target in the field at @a pos. */
+static void
+fb_store_ref(struct ibuf *b, size_t pos, size_t target)
+{
+	assert(target > pos);
+	store_u32(fb_ptr(b, pos), target - pos);
+}
+
+/**
+ * Writes a vector of @a count zeroed elements of @a elem_size bytes
+ * aligned to @a align bytes. Returns the position of the vector, which
+ * is followed by the elements.
+ */
+static size_t
+fb_vector(struct ibuf *b, uint32_t count, size_t elem_size, size_t align)
+{
+	fb_align(b, align, 4);
+	size_t vector = fb_alloc(b, 4 + count * elem_size);
+	store_u32(fb_ptr(b, vector), count);
+	return vector;
+}
+
+/** Writes a string and returns its position. */
+static size_t
+fb_string(struct ibuf *b, const char *str)
+{
+	uint32_t len = strlen(str);
+	fb_align(b, 4, 0);
+	size_t pos = fb_alloc(b, 4 + len + 1);
+	store_u32(fb_ptr(b, pos), len);
+	memcpy(fb_ptr(b, pos + 4), str, len);
+	return pos;
+}
+
+/* }}} */
+
+/** Kind of an exported column. */
+enum arrow_column_type {
+	ARROW_COLUMN_INT64,
+	ARROW_COLUMN_UINT64,
+	ARROW_COLUMN_DOUBLE,
+	ARROW_COLUMN_BOOL,
+	ARROW_COLUMN_UTF8,
+	ARROW_COLUMN_BINARY,
+	/** Binary column with raw MsgPack values. */
+	ARROW_COLUMN_MSGPACK,
+};
+
+/** Exported column, holds the buffers of the current record batch. */
+struct arrow_column {
+	/** Column name. */
+	char *name;
+	/** Column type. */
+	enum arrow_column_type type;
+	/** Validity bitmap. */
+	struct ibuf validity;
+	/**
+	 * Values of fixed-size columns, a bitmap for boolean columns,
+	 * 32-bit value offsets for variable-length columns.
+	 */
+	struct ibuf values;
+	/** Data of variable-length columns. */
+	struct ibuf data;
+	/** Number of nulls in the current record batch. */
+	int64_t null_count;
+};
+
+/** Export state, used by the export thread. */
+struct arrow_export {
+	/** Exported space. */
+	struct space_read_view *space_rv;
+	/** Output file path. */
+	const char *path;
+	/** Output file descriptor. */
+	int fd;
+	/** Max number of rows in a record batch. */
+	uint32_t batch_size;
+	/** Number of rows in the current record batch. */
+	uint32_t row_count;
+	/** Size of variable-length data in the current record batch. */
+	size_t data_size;
+	/** Number of exported rows. */
+	uint64_t total_row_count;
+	/** Number of columns. */
+	uint32_t column_count;
+	/** Columns. */
+	struct arrow_column *columns;
+	/** Body buffers of a record batch, up to three per column. */
+	struct iovec *body;
+	/** Message metadata buffer. */
+	struct ibuf meta;
+};
+
+/** Returns true if a column has variable-length values. */
+static inline bool
+arrow_column_is_varlen(const struct arrow_column *c)
+{
+	return c->type == ARROW_COLUMN_UTF8 || c->type == ARROW_COLUMN_BINARY ||
+	       c->type == ARROW_COLUMN_MSGPACK;
+}
+
+/** Returns the type of the column a space field is exported to. */
+static enum arrow_column_type
+arrow_column_type_by_field_type(enum field_type type)
+{
+	switch (type) {
+	case FIELD_TYPE_INTEGER:
+	case FIELD_TYPE_INT8:
+	case FIELD_TYPE_INT16:
+	case FIELD_TYPE_INT32:
+	case FIELD_TYPE_INT64:
+		return ARROW_COLUMN_INT64;
+	case FIELD_TYPE_UNSIGNED:
+	case FIELD_TYPE_UINT8:
+	case FIELD_TYPE_UINT16:
+	case FIELD_TYPE_UINT32:
+	case FIELD_TYPE_UINT64:
+		return ARROW_COLUMN_UINT64;
+	case FIELD_TYPE_NUMBER:
+	case FIELD_TYPE_DOUBLE:
+	case FIELD_TYPE_FLOAT32:
+	case FIELD_TYPE_FLOAT64:
+		return ARROW_COLUMN_DOUBLE;
+	case FIELD_TYPE_BOOLEAN:
+		return ARROW_COLUMN_BOOL;
+	case FIELD_TYPE_STRING:
+		return ARROW_COLUMN_UTF8;
+	case FIELD_TYPE_VARBINARY:
+		return ARROW_COLUMN_BINARY;
+	default:
+		return ARROW_COLUMN_MSGPACK;
+	}
+}
+
+/** Clears the buffers of a column to start a new record batch. */
+static void
+arrow_column_reset(struct arrow_column *c)
+{
+	ibuf_reset(&c->validity);
+	ibuf_reset(&c->values);
+	ibuf_reset(&c->data);
+	c->null_count = 0;
+	if (arrow_column_is_varlen(c))
+		store_u32(xibuf_alloc(&c->values, sizeof(uint32_t)), 0);
+}
+
+/**
+ * Appends a field to a column as the row with the given number.
+ * The field is NULL if it's missing. Returns the size of the appended
+ * variable-length data.
+ */
+static size_t
+arrow_column_append(struct arrow_column *c, uint32_t row, const char *field)
+{
+	if (row % 8 == 0) {
+		store_u8(xibuf_alloc(&c->validity, 1), 0);
+		if (c->type == ARROW_COLUMN_BOOL)
+			store_u8(xibuf_alloc(&c->values, 1), 0);
+	}
+	enum mp_type type = field != NULL ? mp_typeof(*field) : MP_NIL;
+	bool is_valid = false;
+	const char *data = NULL;
+	uint32_t len = 0;
+	switch (c->type) {
+	case ARROW_COLUMN_INT64: {
+		int64_t value = 0;
+		if (type == MP_INT) {
+			value = mp_decode_int(&field);
+			is_valid = true;
+		} else if (type == MP_UINT) {
+			uint64_t u = mp_decode_uint(&field);
+			is_valid = u <= INT64_MAX;
+			value = is_valid ? (int64_t)u : 0;
+		}
+		store_u64(xibuf_alloc(&c->values, sizeof(value)), value);
+		break;
+	}
+	case ARROW_COLUMN_UINT64: {
+		uint64_t value = 0;
+		if (type == MP_UINT) {
+			value = mp_decode_uint(&field);
+			is_valid = true;
+		}
+		store_u64(xibuf_alloc(&c->values, sizeof(value)), value);
+		break;
+	}
+	case ARROW_COLUMN_DOUBLE: {
+		double value = 0;
+		is_valid = true;
+		if (type == MP_DOUBLE)
+			value = mp_decode_double(&field);
+		else if (type == MP_FLOAT)
+			value = mp_decode_float(&field);
+		else if (type == MP_INT)
+			value = mp_decode_int(&field);
+		else if (type == MP_UINT)
+			value = mp_decode_uint(&field);
+		else
+			is_valid = false;
+		store_double(xibuf_alloc(&c->values, sizeof(value)), value);
+		break;
+	}
+	case ARROW_COLUMN_BOOL:
+		if (type == MP_BOOL) {
+			is_valid = true;
+			if (mp_decode_bool(&field))
+				c->values.wpos[-1] |= 1 << (row % 8);
+		}
+		break;
+	case ARROW_COLUMN_UTF8:
+		if (type == MP_STR) {
+			data = mp_decode_str(&field, &len);
+			is_valid = true;
+		}
+		break;
+	case ARROW_COLUMN_BINARY:
+		if (type == MP_BIN) {
+			data = mp_decode_bin(&field, &len);
+			is_valid = true;
+		}
+		break;
+	case ARROW_COLUMN_MSGPACK:
+		if (type != MP_NIL) {
+			data = field;
+			mp_next(&field);
+			len = field - data;
+			is_valid = true;
+		}
+		break;
+	default:
+		unreachable();
+	}
+	if (arrow_column_is_varlen(c)) {
+		if (len > 0)
+			memcpy(xibuf_alloc(&c->data, len), data, len);
+		store_u32(xibuf_alloc(&c->values, sizeof(uint32_t)),
+			  ibuf_used(&c->data));
+	}
+	if (is_valid)
+		c->validity.wpos[-1] |= 1 << (row % 8);
+	else
+		c->null_count++;
+	return len;
+}
+
+/**
+ * Creates the export columns from the space format data.
+ * Returns -1 and sets diag if the space has no format.
+ */
+static int
+arrow_export_create_columns(struct arrow_export *e)
+{
+	const char *data = e->space_rv->format_data;
+	uint32_t count = data != NULL ? mp_decode_array(&data) : 0;
+	if (count == 0) {
+		diag_set(IllegalParams, "space '%s' has no format",
+			 e->space_rv->name);
+		return -1;
+	}
+	e->columns = xcalloc(count, sizeof(*e->columns));
+	e->column_count = count;
+	e->body = xcalloc(3 * count, sizeof(*e->body));
+	for (uint32_t i = 0; i < count; i++) {
+		struct arrow_column *c = &e->columns[i];
+		const char *name = NULL;
+		uint32_t name_len = 0;
+		enum field_type type = FIELD_TYPE_ANY;
+		uint32_t map_size = mp_decode_map(&data);
+		for (uint32_t j = 0; j < map_size; j++) {
+			uint32_t key_len = 0;
+			const char *key = NULL;
+			if (mp_typeof(*data) == MP_STR)
+				key = mp_decode_str(&data, &key_len);
+			else
+				mp_next(&data);
+			if (key == NULL || mp_typeof(*data) != MP_STR) {
+				mp_next(&data);
+			} else if (key_len == strlen("name") &&
+				   memcmp(key, "name", key_len) == 0) {
+				name = mp_decode_str(&data, &name_len);
+			} else if (key_len == strlen("type") &&
+				   memcmp(key, "type", key_len) == 0) {
+				uint32_t len;
+				const char *str = mp_decode_str(&data, &len);
+				type = field_type_by_name(str, len);
+			} else {
+				mp_next(&data);
+			}
+		}
+		c->name = name != NULL ? xstrndup(name, name_len) :
+			  xstrdup(tt_sprintf("field%u", i + 1));
+		c->type = arrow_column_type_by_field_type(type);
+		ibuf_create(&c->validity, &cord()->slabc, 1024);
+		ibuf_create(&c->values, &cord()->slabc, 1024);
+		ibuf_create(&c->data, &cord()->slabc, 1024);
+		arrow_column_reset(c);
+	}
+	return 0;
+}
+
+/** Frees the export columns. */
+static void
+arrow_export_destroy_columns(struct arrow_export *e)
+{
+	for (uint32_t i = 0; i < e->column_count; i++) {
+		struct arrow_column *c = &e->columns[i];
+		free(c->name);
+		ibuf_destroy(&c->validity);
+		ibuf_destroy(&c->values);
+		ibuf_destroy(&c->data);
+	}
+	free(e->columns);
+	free(e->body);
+}
+
+/** Writes data to the output file. */
+static int
+arrow_export_write(struct arrow_export *e, const void *data, size_t size)
+{
+	if (size > 0 && fio_writen(e->fd, data, size) != 0) {
+		diag_set(SystemError, "failed to write file '%s'", e->path);
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * Starts message metadata: writes the root offset and the Message table.
+ * Returns the position of the header field, which must be set to the
+ * header table written next.
+ */
+static size_t
+arrow_export_begin_message(struct arrow_export *e, uint8_t header_type,
+			   int64_t body_length)
+{
+	struct ibuf *b = &e->meta;
+	ibuf_reset(b);
+	size_t root = fb_alloc(b, 4);
+	/* version, header_type, header, bodyLength */
+	static const uint16_t fields[] = {16, 18, 4, 8};
+	size_t message = fb_table(b, fields, lengthof(fields), 24);
+	fb_store_ref(b, root, message);
+	store_u16(fb_ptr(b, message + 16), ARROW_METADATA_VERSION);
+	store_u8(fb_ptr(b, message + 18), header_type);
+	store_u64(fb_ptr(b, message + 8), body_length);
+	return message + 4;
+}
+
+/**
+ * Writes a message with the metadata built in the metadata buffer and
+ * the given body buffers, each padded to 8 bytes.
+ */
+static int
+arrow_export_write_message(struct arrow_export *e, const struct iovec *body,
+			   int body_count)
+{
+	static const char padding[ARROW_ALIGNMENT];
+	struct ibuf *b = &e->meta;
+	fb_align(b, ARROW_ALIGNMENT, 0);
+	uint32_t prefix[2] = {arrow_continuation, ibuf_used(b)};
+	if (arrow_export_write(e, prefix, sizeof(prefix)) != 0 ||
+	    arrow_export_write(e, b->rpos, ibuf_used(b)) != 0)
+		return -1;
+	for (int i = 0; i < body_count; i++) {
+		size_t len = body[i].iov_len;
+		if (arrow_export_write(e, body[i].iov_base, len) != 0 ||
+		    arrow_export_write(e, padding,
+				       small_align(len, ARROW_ALIGNMENT) -
+				       len) != 0)
+			return -1;
+	}
+	return 0;
+}
+
+/** Writes the schema message. */
+static int
+arrow_export_write_schema(struct arrow_export *e)
+{
+	struct ibuf *b = &e->meta;
+	size_t header = arrow_export_begin_message(e, ARROW_HEADER_SCHEMA, 0);
+	/* endianness, fields */
+	static const uint16_t schema_fields[] = {0, 4};
+	size_t schema = fb_table(b, schema_fields, lengthof(schema_fields), 8);
+	fb_store_ref(b, header, schema);
+	size_t vector = fb_vector(b, e->column_count, 4, 4);
+	fb_store_ref(b, schema + 4, vector);
+	for (uint32_t i = 0; i < e->column_count; i++) {
+		struct arrow_column *c = &e->columns[i];
+		/* name, nullable, type_type, type, dictionary, children */
+		static const uint16_t field_fields[] = {4, 16, 17, 8, 0, 12};
+		size_t field = fb_table(b, field_fields,
+					lengthof(field_fields), 24);
+		fb_store_ref(b, vector + 4 + 4 * i, field);
+		fb_store_ref(b, field + 4, fb_string(b, c->name));
+		store_u8(fb_ptr(b, field + 16), true);
+		uint8_t type_type;
+		size_t type;
+		switch (c->type) {
+		case ARROW_COLUMN_INT64:
+		case ARROW_COLUMN_UINT64: {
+			/* bitWidth, is_signed */
+			static const uint16_t int_fields[] = {4, 8};
+			type_type = ARROW_TYPE_INT;
+			type = fb_table(b, int_fields,
+					lengthof(int_fields), 16);
+			store_u32(fb_ptr(b, type + 4), 64);
+			store_u8(fb_ptr(b, type + 8),
+				 c->type == ARROW_COLUMN_INT64);
+			break;
+		}
+		case ARROW_COLUMN_DOUBLE: {
+			/* precision */
+			static const uint16_t float_fields[] = {4};
+			type_type = ARROW_TYPE_FLOATING_POINT;
+			type = fb_table(b, float_fields,
+					lengthof(float_fields), 8);
+			store_u16(fb_ptr(b, type + 4), ARROW_PRECISION_DOUBLE);
+			break;
+		}
+		case ARROW_COLUMN_BOOL:
+			type_type = ARROW_TYPE_BOOL;
+			type = fb_table(b, NULL, 0, 4);
+			break;
+		case ARROW_COLUMN_UTF8:
+			type_type = ARROW_TYPE_UTF8;
+			type = fb_table(b, NULL, 0, 4);
+			break;
+		case ARROW_COLUMN_BINARY:
+		case ARROW_COLUMN_MSGPACK:
+			type_type = ARROW_TYPE_BINARY;
+			type = fb_table(b, NULL, 0, 4);
+			break;
+		default:
+			unreachable();
+		}
+		store_u8(fb_ptr(b, field + 17), type_type);
+		fb_store_ref(b, field + 8, type);
+		fb_store_ref(b, field + 12, fb_vector(b, 0, 4, 4));
+	}
+	return arrow_export_write_message(e, NULL, 0);
+}
+
+/** Writes the current record batch and starts a new one. */
+static int
+arrow_export_write_batch(struct arrow_export *e)
+{
+	assert(e->row_count > 0);
+	int body_count = 0;
+	int64_t body_length = 0;
+	for (uint32_t i = 0; i < e->column_count; i++) {
+		struct arrow_column *c = &e->columns[i];
+		struct ibuf *bufs[] = {&c->validity, &c->values, &c->data};
+		int count = arrow_column_is_varlen(c) ? 3 : 2;
+		for (int j = 0; j < count; j++) {
+			struct iovec *iov = &e->body[body_count++];
+			iov->iov_base = bufs[j]->rpos;
+			iov->iov_len = ibuf_used(bufs[j]);
+			body_length += small_align(iov->iov_len,
+						   ARROW_ALIGNMENT);
+		}
+	}
+	struct ibuf *b = &e->meta;
+	size_t header = arrow_export_begin_message(
+		e, ARROW_HEADER_RECORD_BATCH, body_length);
+	/* length, nodes, buffers */
+	static const uint16_t batch_fields[] = {8, 4, 16};
+	size_t batch = fb_table(b, batch_fields, lengthof(batch_fields), 24);
+	fb_store_ref(b, header, batch);
+	store_u64(fb_ptr(b, batch + 8), e->row_count);
+	/* FieldNode: length, null_count */
+	size_t nodes = fb_vector(b, e->column_count, 16, 8);
+	fb_store_ref(b, batch + 4, nodes);
+	for (uint32_t i = 0; i < e->column_count; i++) {
+		size_t node = nodes + 4 + 16 * i;
+		store_u64(fb_ptr(b, node), e->row_count);
+		store_u64(fb_ptr(b, node + 8), e->columns[i].null_count);
+	}
+	/* Buffer: offset, length */
+	size_t buffers = fb_vector(b, body_count, 16, 8);
+	fb_store_ref(b, batch + 16, buffers);
+	int64_t offset = 0;
+	for (int i = 0; i < body_count; i++) {
+		size_t buffer = buffers + 4 + 16 * i;
+		store_u64(fb_ptr(b, buffer), offset);
+		store_u64(fb_ptr(b, buffer + 8), e->body[i].iov_len);
+		offset += small_align(e->body[i].iov_len, ARROW_ALIGNMENT);
+	}
+	if (arrow_export_write_message(e, e->body, body_count) != 0)
+		return -1;
+	for (uint32_t i = 0; i < e->column_count; i++)
+		arrow_column_reset(&e->columns[i]);
+	e->total_row_count += e->row_count;
+	e->row_count = 0;
+	e->data_size = 0;
+	return 0;
+}
+
+/** Appends a tuple to the current record batch. */
+static void
+arrow_export_append(struct arrow_export *e, const char *data)
+{
+	uint32_t field_count = mp_decode_array(&data);
+	for (uint32_t i = 0; i < e->column_count; i++) {
+		const char *field = NULL;
+		if (i < field_count) {
+			field = data;
+			mp_next(&data);
+		}
+		e->data_size += arrow_column_append(&e->columns[i],
+						    e->row_count, field);
+	}
+	e->row_count++;
+}
+
+/** Scans the primary index of the space and writes record batches. */
+static int
+arrow_export_write_batches(struct arrow_export *e)
+{
+	struct index_read_view *index_rv =
+		space_read_view_index(e->space_rv, 0);
+	if (index_rv == NULL) {
+		diag_set(ClientError, ER_NO_SUCH_INDEX_ID, 0,
+			 e->space_rv->name);
+		return -1;
+	}
+	struct index_read_view_iterator it;
+	if (index_read_view_create_iterator(index_rv, ITER_ALL, NULL, 0,
+					    &it) != 0)
+		return -1;
+	struct region *region = &fiber()->gc;
+	int rc = 0;
+	while (rc == 0) {
+		size_t region_svp = region_used(region);
+		struct read_view_tuple result;
+		rc = index_read_view_iterator_next_raw(&it, &result);
+		if (rc != 0 || result.data == NULL) {
+			region_truncate(region, region_svp);
+			break;
+		}
+		assert(!result.needs_upgrade);
+		arrow_export_append(e, result.data);
+		region_truncate(region, region_svp);
+		if (e->row_count < e->batch_size &&
+		    e->data_size < ARROW_BATCH_DATA_MAX)
+			continue;
+		rc = arrow_export_write_batch(e);
+		if (rc == 0 && fiber_is_cancelled()) {
+			diag_set(FiberIsCancelled);
+			rc = -1;
+		}
+	}
+	index_read_view_iterator_destroy(&it);
+	if (rc == 0 && e->row_count > 0)
+		rc = arrow_export_write_batch(e);
+	return rc;
+}
+
+/** Export thread function. */
+static int
+arrow_export_f(va_list ap)
+{
+	struct arrow_export *e = va_arg(ap, struct arrow_export *);
+	if (arrow_export_create_columns(e) != 0)
+		return -1;
+	ibuf_create(&e->meta, &cord()->slabc, 4096);
+	int rc = -1;
+	e->fd = open(e->path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+	if (e->fd < 0) {
+		diag_set(SystemError, "failed to create file '%s'", e->path);
+		goto out;
+	}
+	const uint32_t eos[2] = {arrow_continuation, 0};
+	if (arrow_export_write_schema(e) == 0 &&
+	    arrow_export_write_batches(e) == 0 &&
+	    arrow_export_write(e, eos, sizeof(eos)) == 0)
+		rc = 0;
+	if (close(e->fd) != 0 && rc == 0) {
+		diag_set(SystemError, "failed to close file '%s'", e->path);
+		rc = -1;
+	}
+	if (rc != 0)
+		unlink(e->path);
+out:
+	ibuf_destroy(&e->meta);
+	arrow_export_destroy_columns(e);
+	return rc;
+}
+
+int
+arrow_export_space(struct space_read_view *space_rv, const char *path,
+		   uint32_t batch_size, uint64_t *row_count)
+{
+	assert(batch_size > 0);
+	struct arrow_export e;
+	memset(&e, 0, sizeof(e));
+	e.space_rv = space_rv;
+	e.path = path;
+	e.fd = -1;
+	e.batch_size = batch_size;
+	/*
+	 * Read view iterators are safe to use from another thread so
+	 * we convert tuples in a separate thread so as not to consume
+	 * tx cpu time.
+	 */
+	struct cord cord;
+	if (cord_costart(&cord, "arrow_export", arrow_export_f, &e) != 0)
+		return -1;
+	if (cord_cojoin(&cord) != 0)
+		return -1;
+	*row_count = e.total_row_count;
+	return 0;
+}
@@ -0,0 +1,42 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2026, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#pragma once
+
+#include <stdint.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+struct space_read_view;
+
+/**
+ * Writes all tuples of a space read view, in the primary index order,
+ * to a file in the Apache Arrow IPC streaming format.
+ *
+ * The columns are named and typed after the space format: integer
+ * fields are exported as 64-bit integers, numbers as doubles, strings
+ * as UTF-8 strings, booleans as booleans and varbinary fields as binary
+ * values. Fields of other types are exported as binary values holding
+ * the raw MsgPack data. All columns are nullable: missing fields and
+ * values that don't fit the column type are exported as nulls. Fields
+ * that aren't in the space format are skipped.
+ *
+ * Tuples are converted to record batches of up to @a batch_size rows in
+ * a separate thread while the calling fiber yields. The space read view
+ * must be created with read_view_opts::enable_field_names set so that
+ * it has the format data.
+ *
+ * On success returns 0 and stores the number of exported tuples in
+ * @a row_count. On failure returns -1, sets diag and removes the file.
+ */
+int
+arrow_export_space(struct space_read_view *space_rv, const char *path,
+		   uint32_t batch_size, uint64_t *row_count);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
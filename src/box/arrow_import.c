@@ -0,0 +1,651 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2026, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#include "arrow_import.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bit/bit.h"
+#include "diag.h"
+#include "error.h"
+#include "msgpuck.h"
+#include "trivia/util.h"
+#include "tt_static.h"
+
+/*
+ * See arrow_export.c for a short description of the Arrow IPC streaming
+ * format. The stream comes from the network so every offset and size
+ * read from it is checked before it's used.
+ */
+
+/** Marker that starts each encapsulated message. */
+static const uint32_t arrow_continuation = 0xFFFFFFFF;
+
+enum {
+	/** MetadataVersion::V4, the oldest supported version. */
+	ARROW_METADATA_VERSION_MIN = 3,
+	/** MessageHeader union types. */
+	ARROW_HEADER_SCHEMA = 1,
+	ARROW_HEADER_DICTIONARY_BATCH = 2,
+	ARROW_HEADER_RECORD_BATCH = 3,
+	/** Type union types. */
+	ARROW_TYPE_NULL = 1,
+	ARROW_TYPE_INT = 2,
+	ARROW_TYPE_FLOATING_POINT = 3,
+	ARROW_TYPE_BINARY = 4,
+	ARROW_TYPE_UTF8 = 5,
+	ARROW_TYPE_BOOL = 6,
+	ARROW_TYPE_LARGE_BINARY = 19,
+	ARROW_TYPE_LARGE_UTF8 = 20,
+	/** Precision enum values. */
+	ARROW_PRECISION_SINGLE = 1,
+	ARROW_PRECISION_DOUBLE = 2,
+	/** Initial size of the output buffer. */
+	ARROW_IMPORT_BUF_SIZE = 4096,
+	/** Size of the MsgPack array header of the output. */
+	ARROW_IMPORT_HEADER_SIZE = 5,
+};
+
+/* {{{ Flatbuffers decoding */
+
+/** Flatbuffers table being read. */
+struct fb_table {
+	/** Buffer the table is stored in. */
+	const char *buf;
+	/** Size of the buffer. */
+	uint32_t size;
+	/** Position of the table in the buffer. */
+	uint32_t pos;
+	/** Position of the vtable in the buffer. */
+	uint32_t vtable;
+	/** Size of the vtable. */
+	uint16_t vtable_size;
+	/** Size of the table. */
+	uint16_t table_size;
+};
+
+/**
+ * Looks up the table at the given position of a buffer and checks that
+ * the table and its vtable fit in the buffer. Returns -1 if they don't.
+ */
+static int
+fb_table_create(struct fb_table *t, const char *buf, uint32_t size,
+		uint32_t pos)
+{
+	/* The root offset is stored at 0 so a table can't be there. */
+	if (pos == 0 || size < 4 || pos > size - 4)
+		return -1;
+	int64_t vtable = (int64_t)pos - (int32_t)load_u32(buf + pos);
+	if (vtable < 0 || vtable > size - 4)
+		return -1;
+	t->buf = buf;
+	t->size = size;
+	t->pos = pos;
+	t->vtable = vtable;
+	t->vtable_size = load_u16(buf + vtable);
+	t->table_size = load_u16(buf + vtable + 2);
+	if (t->vtable_size < 4 || t->vtable_size % 2 != 0 ||
+	    t->vtable + t->vtable_size > size || t->table_size < 4 ||
+	    (uint64_t)pos + t->table_size > size)
+		return -1;
+	return 0;
+}
+
+/**
+ * Returns the offset of the field with the given id in a table or 0 if
+ * the field is absent or doesn't fit in the table.
+ */
+static uint16_t
+fb_field(const struct fb_table *t, uint16_t id, uint16_t field_size)
+{
+	uint32_t entry = 4 + 2 * id;
+	if (entry + 2 > t->vtable_size)
+		return 0;
+	uint16_t offset = load_u16(t->buf + t->vtable + entry);
+	if (offset < 4 || offset + field_size > t->table_size)
+		return 0;
+	return offset;
+}
+
+/** Reads an unsigned integer field of a table. */
+static uint64_t
+fb_uint(const struct fb_table *t, uint16_t id, uint16_t field_size,
+	uint64_t default_value)
+{
+	uint16_t offset = fb_field(t, id, field_size);
+	if (offset == 0)
+		return default_value;
+	const char *p = t->buf + t->pos + offset;
+	switch (field_size) {
+	case 1:
+		return load_u8(p);
+	case 2:
+		return load_u16(p);
+	case 4:
+		return load_u32(p);
+	case 8:
+		return load_u64(p);
+	default:
+		unreachable();
+	}
+	return default_value;
+}
+
+/**
+ * Returns the position of the object referred to by the field at the
+ * given position of a buffer or 0 if it's out of the buffer.
+ */
+static uint32_t
+fb_deref(const char *buf, uint32_t size, uint32_t pos)
+{
+	assert(pos <= size - 4);
+	uint64_t target = (uint64_t)pos + load_u32(buf + pos);
+	if (target == pos || target >= size)
+		return 0;
+	return target;
+}
+
+/**
+ * Returns the position of the object referred to by a field of a table
+ * or 0 if the field is absent or invalid.
+ */
+static uint32_t
+fb_ref(const struct fb_table *t, uint16_t id)
+{
+	uint16_t offset = fb_field(t, id, 4);
+	if (offset == 0)
+		return 0;
+	return fb_deref(t->buf, t->size, t->pos + offset);
+}
+
+/**
+ * Checks that the vector at the given position of a buffer fits in it.
+ * Returns the number of elements or -1 if it doesn't fit.
+ */
+static int64_t
+fb_vector_size(const char *buf, uint32_t size, uint32_t pos,
+	       uint32_t elem_size)
+{
+	if (pos == 0 || pos > size - 4)
+		return -1;
+	uint32_t count = load_u32(buf + pos);
+	if ((uint64_t)count * elem_size > size - pos - 4)
+		return -1;
+	return count;
+}
+
+/* }}} */
+
+/** Imported column. */
+struct arrow_import_column {
+	/** Type union type. */
+	uint8_t type;
+	/**
+	 * Size of a value of fixed-size columns or a value offset of
+	 * variable-length columns, in bytes.
+	 */
+	uint8_t width;
+	/** Set for signed integer columns. */
+	bool is_signed;
+	/** Validity bitmap of the current record batch or NULL. */
+	const char *validity;
+	/** Values or value offsets of the current record batch. */
+	const char *values;
+	/** Data of a variable-length column. */
+	const char *data;
+	/** Size of @a data. */
+	uint64_t data_size;
+};
+
+/** Import state. */
+struct arrow_import {
+	/** Number of columns, 0 until the schema is read. */
+	uint32_t column_count;
+	/** Columns. */
+	struct arrow_import_column *columns;
+	/** Output buffer. */
+	char *buf;
+	/** Size of the data in the output buffer. */
+	size_t size;
+	/** Capacity of the output buffer. */
+	size_t capacity;
+	/** Number of converted rows. */
+	uint32_t row_count;
+};
+
+/** Sets diag about an invalid stream. */
+static void
+arrow_import_error(const char *what)
+{
+	diag_set(ClientError, ER_ILLEGAL_PARAMS,
+		 tt_sprintf("invalid Arrow stream: %s", what));
+}
+
+/** Sets diag about an unsupported stream feature. */
+static void
+arrow_import_unsupported(const char *what)
+{
+	diag_set(ClientError, ER_UNSUPPORTED, "Arrow import", what);
+}
+
+/** Returns true if a column has variable-length values. */
+static inline bool
+arrow_import_column_is_varlen(const struct arrow_import_column *c)
+{
+	return c->type == ARROW_TYPE_BINARY || c->type == ARROW_TYPE_UTF8 ||
+	       c->type == ARROW_TYPE_LARGE_BINARY ||
+	       c->type == ARROW_TYPE_LARGE_UTF8;
+}
+
+/** Returns the number of body buffers of a column in a record batch. */
+static inline int
+arrow_import_column_buffer_count(const struct arrow_import_column *c)
+{
+	if (c->type == ARROW_TYPE_NULL)
+		return 0;
+	return arrow_import_column_is_varlen(c) ? 3 : 2;
+}
+
+/** Reads the type of a schema field into a column. */
+static int
+arrow_import_read_field(struct arrow_import_column *c,
+			const struct fb_table *field)
+{
+	if (fb_ref(field, 4) != 0) {
+		arrow_import_unsupported("dictionary-encoded columns");
+		return -1;
+	}
+	c->type = fb_uint(field, 2, 1, 0);
+	uint32_t type_pos = fb_ref(field, 3);
+	struct fb_table type;
+	switch (c->type) {
+	case ARROW_TYPE_NULL:
+		return 0;
+	case ARROW_TYPE_BOOL:
+		c->width = 0;
+		return 0;
+	case ARROW_TYPE_BINARY:
+	case ARROW_TYPE_UTF8:
+		c->width = sizeof(uint32_t);
+		return 0;
+	case ARROW_TYPE_LARGE_BINARY:
+	case ARROW_TYPE_LARGE_UTF8:
+		c->width = sizeof(uint64_t);
+		return 0;
+	case ARROW_TYPE_INT: {
+		if (fb_table_create(&type, field->buf, field->size,
+				    type_pos) != 0) {
+			arrow_import_error("invalid field type");
+			return -1;
+		}
+		uint32_t bit_width = fb_uint(&type, 0, 4, 0);
+		if (bit_width != 8 && bit_width != 16 && bit_width != 32 &&
+		    bit_width != 64) {
+			arrow_import_error("invalid integer bit width");
+			return -1;
+		}
+		c->width = bit_width / 8;
+		c->is_signed = fb_uint(&type, 1, 1, 0) != 0;
+		return 0;
+	}
+	case ARROW_TYPE_FLOATING_POINT:
+		if (fb_table_create(&type, field->buf, field->size,
+				    type_pos) != 0) {
+			arrow_import_error("invalid field type");
+			return -1;
+		}
+		switch (fb_uint(&type, 0, 2, 0)) {
+		case ARROW_PRECISION_SINGLE:
+			c->width = sizeof(float);
+			return 0;
+		case ARROW_PRECISION_DOUBLE:
+			c->width = sizeof(double);
+			return 0;
+		default:
+			arrow_import_unsupported("half-precision columns");
+			return -1;
+		}
+	default:
+		arrow_import_unsupported(tt_sprintf("column type %u",
+						    (unsigned)c->type));
+		return -1;
+	}
+}
+
+/** Reads a schema message and creates the columns. */
+static int
+arrow_import_read_schema(struct arrow_import *imp,
+			 const struct fb_table *schema)
+{
+	if (imp->column_count != 0) {
+		arrow_import_error("duplicate schema");
+		return -1;
+	}
+	if (fb_uint(schema, 0, 2, 0) != 0) {
+		arrow_import_unsupported("big-endian data");
+		return -1;
+	}
+	const char *buf = schema->buf;
+	uint32_t size = schema->size;
+	uint32_t fields = fb_ref(schema, 1);
+	int64_t count = fb_vector_size(buf, size, fields, 4);
+	if (count < 0) {
+		arrow_import_error("invalid schema");
+		return -1;
+	}
+	if (count == 0) {
+		arrow_import_error("schema has no fields");
+		return -1;
+	}
+	imp->columns = xcalloc(count, sizeof(*imp->columns));
+	imp->column_count = count;
+	for (uint32_t i = 0; i < count; i++) {
+		struct fb_table field;
+		uint32_t pos = fb_deref(buf, size, fields + 4 + 4 * i);
+		if (fb_table_create(&field, buf, size, pos) != 0) {
+			arrow_import_error("invalid schema field");
+			return -1;
+		}
+		if (arrow_import_read_field(&imp->columns[i], &field) != 0)
+			return -1;
+	}
+	return 0;
+}
+
+/** Returns a pointer to a chunk of at least @a size bytes of output. */
+static char *
+arrow_import_reserve(struct arrow_import *imp, size_t size)
+{
+	if (imp->size + size > imp->capacity) {
+		size_t capacity = MAX(imp->capacity, ARROW_IMPORT_BUF_SIZE);
+		while (capacity < imp->size + size)
+			capacity *= 2;
+		imp->buf = xrealloc(imp->buf, capacity);
+		imp->capacity = capacity;
+	}
+	return imp->buf + imp->size;
+}
+
+/** Converts a value of a column to MsgPack and appends it to output. */
+static int
+arrow_import_append_value(struct arrow_import *imp,
+			  const struct arrow_import_column *c, uint64_t row)
+{
+	if (c->type == ARROW_TYPE_NULL ||
+	    (c->validity != NULL &&
+	     (load_u8(c->validity + row / 8) & (1 << (row % 8))) == 0)) {
+		char *p = arrow_import_reserve(imp, mp_sizeof_nil());
+		imp->size = mp_encode_nil(p) - imp->buf;
+		return 0;
+	}
+	char *p = arrow_import_reserve(imp, 9);
+	const char *value = c->values + row * c->width;
+	switch (c->type) {
+	case ARROW_TYPE_BOOL: {
+		bool b = (load_u8(c->values + row / 8) & (1 << (row % 8))) != 0;
+		p = mp_encode_bool(p, b);
+		break;
+	}
+	case ARROW_TYPE_INT: {
+		uint64_t u;
+		int shift = 64 - 8 * c->width;
+		switch (c->width) {
+		case 1:
+			u = load_u8(value);
+			break;
+		case 2:
+			u = load_u16(value);
+			break;
+		case 4:
+			u = load_u32(value);
+			break;
+		case 8:
+			u = load_u64(value);
+			break;
+		default:
+			unreachable();
+		}
+		/* Sign-extend the value. */
+		int64_t i = c->is_signed ? (int64_t)(u << shift) >> shift : 0;
+		if (i < 0)
+			p = mp_encode_int(p, i);
+		else
+			p = mp_encode_uint(p, u);
+		break;
+	}
+	case ARROW_TYPE_FLOATING_POINT:
+		if (c->width == sizeof(float))
+			p = mp_encode_float(p, load_float(value));
+		else
+			p = mp_encode_double(p, load_double(value));
+		break;
+	default: {
+		assert(arrow_import_column_is_varlen(c));
+		const char *next = value + c->width;
+		uint64_t start = c->width == sizeof(uint32_t) ?
+				 load_u32(value) : load_u64(value);
+		uint64_t end = c->width == sizeof(uint32_t) ?
+			       load_u32(next) : load_u64(next);
+		if (start > end || end > c->data_size ||
+		    end - start > UINT32_MAX) {
+			arrow_import_error("invalid value offsets");
+			return -1;
+		}
+		uint32_t len = end - start;
+		if (c->type == ARROW_TYPE_UTF8 ||
+		    c->type == ARROW_TYPE_LARGE_UTF8) {
+			p = arrow_import_reserve(imp, mp_sizeof_str(len));
+			p = mp_encode_str(p, c->data + start, len);
+		} else {
+			p = arrow_import_reserve(imp, mp_sizeof_bin(len));
+			p = mp_encode_bin(p, c->data + start, len);
+		}
+		break;
+	}
+	}
+	imp->size = p - imp->buf;
+	return 0;
+}
+
+/** Reads a record batch message and converts its rows. */
+static int
+arrow_import_read_batch(struct arrow_import *imp,
+			const struct fb_table *batch,
+			const char *body, uint64_t body_size)
+{
+	if (imp->column_count == 0) {
+		arrow_import_error("record batch before schema");
+		return -1;
+	}
+	if (fb_ref(batch, 3) != 0) {
+		arrow_import_unsupported("compressed record batches");
+		return -1;
+	}
+	const char *buf = batch->buf;
+	uint32_t size = batch->size;
+	uint64_t length = fb_uint(batch, 0, 8, 0);
+	uint32_t nodes = fb_ref(batch, 1);
+	uint32_t buffers = fb_ref(batch, 2);
+	int64_t node_count = fb_vector_size(buf, size, nodes, 16);
+	int64_t buffer_count = fb_vector_size(buf, size, buffers, 16);
+	if (length > INT64_MAX || node_count != imp->column_count ||
+	    buffer_count < 0) {
+		arrow_import_error("invalid record batch");
+		return -1;
+	}
+	if (length > UINT32_MAX - imp->row_count) {
+		arrow_import_unsupported("more than 4294967295 rows");
+		return -1;
+	}
+	/*
+	 * A value of any column but of the null type takes at least a bit
+	 * of the body so a longer batch is invalid or consists of nulls
+	 * only. Reject it so that a small request can't make us allocate
+	 * a lot of memory.
+	 */
+	if (length / 8 > body_size) {
+		arrow_import_error("record batch is longer than its body");
+		return -1;
+	}
+	int64_t buffer_no = 0;
+	for (uint32_t i = 0; i < imp->column_count; i++) {
+		struct arrow_import_column *c = &imp->columns[i];
+		const char *node = buf + nodes + 4 + 16 * i;
+		uint64_t null_count = load_u64(node + 8);
+		if (load_u64(node) != length || null_count > length) {
+			arrow_import_error("invalid field node");
+			return -1;
+		}
+		int count = arrow_import_column_buffer_count(c);
+		if (buffer_no + count > buffer_count) {
+			arrow_import_error("missing buffers");
+			return -1;
+		}
+		const char *bufs[3] = {NULL, NULL, NULL};
+		uint64_t sizes[3] = {0, 0, 0};
+		for (int j = 0; j < count; j++) {
+			const char *b = buf + buffers + 4 + 16 * buffer_no++;
+			uint64_t offset = load_u64(b);
+			sizes[j] = load_u64(b + 8);
+			if (offset > body_size ||
+			    sizes[j] > body_size - offset) {
+				arrow_import_error("buffer out of body");
+				return -1;
+			}
+			bufs[j] = body + offset;
+		}
+		if (c->type == ARROW_TYPE_NULL)
+			continue;
+		uint64_t bitmap_size = (length + 7) / 8;
+		uint64_t values_size;
+		if (c->type == ARROW_TYPE_BOOL)
+			values_size = bitmap_size;
+		else if (arrow_import_column_is_varlen(c))
+			values_size = length > 0 ? (length + 1) * c->width : 0;
+		else
+			values_size = length * c->width;
+		if ((null_count > 0 && sizes[0] < bitmap_size) ||
+		    sizes[1] < values_size ||
+		    (length > 0 && values_size / length < c->width)) {
+			arrow_import_error("buffer too small");
+			return -1;
+		}
+		c->validity = null_count > 0 ? bufs[0] : NULL;
+		c->values = bufs[1];
+		c->data = bufs[2];
+		c->data_size = sizes[2];
+	}
+	for (uint64_t row = 0; row < length; row++) {
+		char *p = arrow_import_reserve(
+			imp, mp_sizeof_array(imp->column_count));
+		imp->size = mp_encode_array(p, imp->column_count) - imp->buf;
+		for (uint32_t i = 0; i < imp->column_count; i++) {
+			if (arrow_import_append_value(imp, &imp->columns[i],
+						      row) != 0)
+				return -1;
+		}
+	}
+	imp->row_count += length;
+	return 0;
+}
+
+/** Reads all messages of a stream. */
+static int
+arrow_import_read(struct arrow_import *imp, const char *pos, const char *end)
+{
+	while (pos < end) {
+		if (end - pos < 4)
+			goto truncated;
+		uint32_t len = load_u32(pos);
+		pos += 4;
+		if (len == arrow_continuation) {
+			if (end - pos < 4)
+				goto truncated;
+			len = load_u32(pos);
+			pos += 4;
+		}
+		/* End-of-stream marker. */
+		if (len == 0)
+			break;
+		if (len > (size_t)(end - pos))
+			goto truncated;
+		const char *meta = pos;
+		pos += len;
+		struct fb_table message, header;
+		if (len < 4 ||
+		    fb_table_create(&message, meta, len,
+				    load_u32(meta)) != 0 ||
+		    fb_table_create(&header, meta, len,
+				    fb_ref(&message, 2)) != 0) {
+			arrow_import_error("invalid message");
+			return -1;
+		}
+		if (fb_uint(&message, 0, 2, 0) < ARROW_METADATA_VERSION_MIN) {
+			arrow_import_unsupported("metadata version < V4");
+			return -1;
+		}
+		uint64_t body_size = fb_uint(&message, 3, 8, 0);
+		if (body_size > (size_t)(end - pos))
+			goto truncated;
+		const char *body = pos;
+		pos += body_size;
+		int rc;
+		switch (fb_uint(&message, 1, 1, 0)) {
+		case ARROW_HEADER_SCHEMA:
+			rc = arrow_import_read_schema(imp, &header);
+			break;
+		case ARROW_HEADER_RECORD_BATCH:
+			rc = arrow_import_read_batch(imp, &header,
+						     body, body_size);
+			break;
+		case ARROW_HEADER_DICTIONARY_BATCH:
+			arrow_import_unsupported("dictionary batches");
+			rc = -1;
+			break;
+		default:
+			arrow_import_error("unknown message type");
+			rc = -1;
+			break;
+		}
+		if (rc != 0)
+			return -1;
+	}
+	if (imp->column_count == 0) {
+		arrow_import_error("missing schema");
+		return -1;
+	}
+	return 0;
+truncated:
+	arrow_import_error("truncated message");
+	return -1;
+}
+
+int
+arrow_import_decode(const char *data, const char *data_end, char **tuples,
+		    size_t *tuples_size)
+{
+	struct arrow_import imp;
+	memset(&imp, 0, sizeof(imp));
+	/* The array header is written when the row count is known. */
+	arrow_import_reserve(&imp, ARROW_IMPORT_HEADER_SIZE);
+	imp.size = ARROW_IMPORT_HEADER_SIZE;
+	int rc = arrow_import_read(&imp, data, data_end);
+	free(imp.columns);
+	if (rc != 0) {
+		free(imp.buf);
+		return -1;
+	}
+	char *p = imp.buf;
+	*p++ = 0xdd;
+	mp_store_u32(p, imp.row_count);
+	*tuples = imp.buf;
+	*tuples_size = imp.size;
+	return 0;
+}
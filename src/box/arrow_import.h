@@ -0,0 +1,42 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2026, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+/**
+ * Decodes a stream in the Apache Arrow IPC streaming format and converts
+ * the rows of all its record batches to tuples.
+ *
+ * The i-th column of a record batch is converted to the i-th field of
+ * a tuple. Supported column types are 8 to 64-bit signed and unsigned
+ * integers, single and double precision floating point numbers,
+ * booleans, UTF-8 strings and binary values (including their large
+ * variants) and nulls. Null values are converted to MsgPack nils.
+ * Compressed record batches and dictionary-encoded columns aren't
+ * supported. The stream doesn't have to end with the end-of-stream
+ * marker.
+ *
+ * The data is read with unaligned loads so it may be stored anywhere,
+ * for example, in a network input buffer.
+ *
+ * On success returns 0 and stores a MsgPack array of the tuples, as
+ * accepted by box_insert_batch(), in @a tuples and its size in
+ * @a tuples_size. The array is allocated with malloc() and must be
+ * freed by the caller. On failure returns -1 and sets diag.
+ */
+int
+arrow_import_decode(const char *data, const char *data_end, char **tuples,
+		    size_t *tuples_size);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
@@ -34,6 +34,7 @@
 
 #include <sys/utsname.h>
 #include <spawn.h>
+#include <ctype.h>
 
 #include "lua/utils.h" /* lua_hash() */
 #include "fiber_pool.h"
@@ -54,6 +55,7 @@
 #include "schema.h"
 #include "engine.h"
 #include "memtx_engine.h"
+#include "memtx_tx.h"
 #include "memtx_space.h"
 #include "memcs_engine.h"
 #include "sysview.h"
@@ -61,6 +63,10 @@
 #include "service_engine.h"
 #include "vinyl.h"
 #include "space.h"
+#include "op_stat.h"
+#include "hot_key.h"
+#include "info/info.h"
+#include "clock.h"
 #include "index.h"
 #include "port.h"
 #include "txn.h"
@@ -76,6 +82,9 @@
 #include "authentication.h"
 #include "security.h"
 #include "path_lock.h"
+#include "expire.h"
+#include "metrics_export.h"
+#include "upsert_buffer.h"
 #include "gc.h"
 #include "sql.h"
 #include "systemd.h"
@@ -98,9 +107,11 @@
 #include "memory.h"
 #include "node_name.h"
 #include "tt_sort.h"
+#include "tt_cpu_set.h"
 #include "event.h"
 #include "func_adapter.h"
 #include "tweaks.h"
+#include "zstd_iostream.h"
 
 static char status[64] = "unconfigured";
 
@@ -491,6 +502,12 @@ box_process_rw(struct request *request, struct space *space,
 		return -1;
 	assert(iproto_type_is_dml(request->type));
 	rmean_collect(rmean_box, request->type, 1);
+	/* The space may be freed on commit, so remember its id. */
+	uint32_t space_id = space->def->id;
+	double start_time = 0;
+	bool collect_op_stat = op_stat_is_enabled;
+	if (unlikely(collect_op_stat))
+		start_time = clock_monotonic();
 	if (access_check_space(space, PRIV_W) != 0)
 		goto rollback;
 	if (txn_begin_stmt(txn, space, request->type) != 0)
@@ -499,6 +516,8 @@ box_process_rw(struct request *request, struct space *space,
 		txn_rollback_stmt(txn);
 		goto rollback;
 	}
+	if (unlikely(hot_key_sample()))
+		hot_key_collect_write(space, request, tuple);
 	if (result != NULL)
 		*result = tuple;
 
@@ -521,6 +540,13 @@ box_process_rw(struct request *request, struct space *space,
 		tuple_bless(tuple);
 		tuple_unref(tuple);
 	}
+	if (unlikely(collect_op_stat)) {
+		uint64_t bytes = (request->key_end - request->key) +
+				 (request->tuple_end - request->tuple) +
+				 (request->ops_end - request->ops);
+		op_stat_collect_write(space_id, bytes,
+				      clock_monotonic() - start_time);
+	}
 	return 0;
 
 rollback:
@@ -1263,7 +1289,36 @@ box_check_uri_set(struct uri_set *uri_set, const char *option_name)
 static int
 box_check_replication(struct uri_set *uri_set)
 {
-	return box_check_uri_set(uri_set, "replication");
+	if (box_check_uri_set(uri_set, "replication") != 0)
+		return -1;
+	for (int i = 0; i < uri_set->uri_count; i++) {
+		const char *compression = uri_param(&uri_set->uris[i],
+						    "compression", 0);
+		if (compression != NULL && strcmp(compression, "none") != 0 &&
+		    strcmp(compression, "zstd") != 0) {
+			diag_set(ClientError, ER_CFG, "replication",
+				 tt_sprintf("invalid compression: %s",
+					    compression));
+			uri_set_destroy(uri_set);
+			return -1;
+		}
+		int space_count = uri_param_count(&uri_set->uris[i], "space");
+		for (int j = 0; j < space_count; j++) {
+			const char *space = uri_param(&uri_set->uris[i],
+						      "space", j);
+			char *end;
+			unsigned long long space_id = strtoull(space, &end, 10);
+			if (!isdigit((unsigned char)*space) || *end != '\0' ||
+			    space_id >= BOX_ID_NIL) {
+				diag_set(ClientError, ER_CFG, "replication",
+					 tt_sprintf("invalid space id: %s",
+						    space));
+				uri_set_destroy(uri_set);
+				return -1;
+			}
+		}
+	}
+	return 0;
 }
 
 static int
@@ -1279,6 +1334,19 @@ box_check_replication_threads(void)
 	return 0;
 }
 
+static int
+box_check_replication_apply_fibers(void)
+{
+	int count = cfg_geti("replication_apply_fibers");
+	if (count <= 0 || count > REPLICATION_APPLY_FIBERS_MAX) {
+		diag_set(ClientError, ER_CFG, "replication_apply_fibers",
+			 tt_sprintf("must be greater than 0, less than or "
+				    "equal to %d", REPLICATION_APPLY_FIBERS_MAX));
+		return -1;
+	}
+	return count;
+}
+
 /** Check bootstrap_strategy option validity. */
 static enum bootstrap_strategy
 box_check_bootstrap_strategy(void)
@@ -1304,6 +1372,34 @@ box_check_listen(struct uri_set *uri_set)
 	return box_check_uri_set(uri_set, "listen");
 }
 
+static int
+box_check_metrics_listen(struct uri_set *uri_set)
+{
+	return box_check_uri_set(uri_set, "metrics_listen");
+}
+
+static double
+box_check_expiration_rate(void)
+{
+	double rate = cfg_getd("expiration_rate");
+	if (rate < 0) {
+		tnt_raise(ClientError, ER_CFG, "expiration_rate",
+			  "the value must be greater than or equal to 0");
+	}
+	return rate;
+}
+
+static double
+box_check_watch_notify_interval(void)
+{
+	double interval = cfg_getd("watch_notify_interval");
+	if (interval < 0) {
+		tnt_raise(ClientError, ER_CFG, "watch_notify_interval",
+			  "the value must be greater than or equal to 0");
+	}
+	return interval;
+}
+
 static double
 box_check_replication_timeout(void)
 {
@@ -1462,6 +1558,19 @@ box_check_replication_synchro_timeout(void)
 	return timeout;
 }
 
+static double
+box_check_replication_synchro_confirm_delay(void)
+{
+	double delay = cfg_getd("replication_synchro_confirm_delay");
+	if (delay < 0) {
+		diag_set(ClientError, ER_CFG,
+			 "replication_synchro_confirm_delay",
+			 "the value must be greater than or equal to zero");
+		return -1;
+	}
+	return delay;
+}
+
 static double
 box_check_replication_sync_timeout(void)
 {
@@ -1633,6 +1742,18 @@ box_check_wal_queue_max_size(void)
 	return size;
 }
 
+static int64_t
+box_check_wal_relay_buffer_size(void)
+{
+	int64_t size = cfg_geti64("wal_relay_buffer_size");
+	if (size < 0) {
+		diag_set(ClientError, ER_CFG, "wal_relay_buffer_size",
+			 "the value must be >= 0");
+		return -1;
+	}
+	return size;
+}
+
 static double
 box_check_wal_cleanup_delay(void)
 {
@@ -1646,6 +1767,18 @@ box_check_wal_cleanup_delay(void)
 	return value;
 }
 
+static double
+box_check_checkpoint_recovery_time(void)
+{
+	double value = cfg_getd("checkpoint_recovery_time");
+	if (value < 0) {
+		diag_set(ClientError, ER_CFG, "checkpoint_recovery_time",
+			 "value must be >= 0");
+		return -1;
+	}
+	return value;
+}
+
 static void
 box_check_readahead(int readahead)
 {
@@ -1677,6 +1810,36 @@ box_check_wal_max_size(int64_t wal_max_size)
 	return wal_max_size;
 }
 
+/**
+ * Validate gc_io_rate_limit, return the limit in bytes per second,
+ * 0 if there's no limit, or -1 on error.
+ */
+static double
+box_check_gc_io_rate_limit(void)
+{
+	double value = cfg_getd("gc_io_rate_limit");
+	if (value < 0) {
+		diag_set(ClientError, ER_CFG, "gc_io_rate_limit",
+			 "the value must be >= 0");
+		return -1;
+	}
+	return value * 1024 * 1024;
+}
+
+/** Validate wal_spare_files, return the number of spare files or -1. */
+static int
+box_check_wal_spare_files(void)
+{
+	int value = cfg_geti("wal_spare_files");
+	if (value < 0 || value > WAL_SPARE_COUNT_MAX) {
+		diag_set(ClientError, ER_CFG, "wal_spare_files",
+			 tt_sprintf("the value must be >= 0 and <= %d",
+				    WAL_SPARE_COUNT_MAX));
+		return -1;
+	}
+	return value;
+}
+
 /** Validate that wal_retention_period is >= 0. */
 static double
 box_check_wal_retention_period()
@@ -1801,6 +1964,27 @@ box_check_small_alloc_options(void)
 			  " to 1024 * 16 and exponent of two");
 }
 
+/**
+ * Checks a CPU list configuration parameter (tx_cpus, iproto_cpus,
+ * wal_cpus, relay_cpus) and stores the parsed CPU set in @a set.
+ * Returns 1 if the option is set, 0 if it isn't, -1 on error.
+ */
+static int
+box_check_cpus(const char *option, struct tt_cpu_set *set)
+{
+	const char *cpus = cfg_gets(option);
+	if (cpus == NULL)
+		return 0;
+	if (tt_cpu_set_parse(set, cpus) != 0) {
+		diag_set(ClientError, ER_CFG, option,
+			 tt_sprintf("must be a list of CPUs like '0-3,8' with "
+				    "CPU numbers less than %d",
+				    TT_CPU_SET_SIZE));
+		return -1;
+	}
+	return 1;
+}
+
 static int
 box_check_iproto_options(void)
 {
@@ -1812,6 +1996,14 @@ box_check_iproto_options(void)
 				     IPROTO_THREADS_MAX));
 		return -1;
 	}
+#if !defined(__linux__)
+	if (cfg_getb("iproto_reuseport")) {
+		diag_set(ClientError, ER_CFG, "iproto_reuseport",
+			 "balancing connections with SO_REUSEPORT is only "
+			 "supported on Linux");
+		return -1;
+	}
+#endif
 	return 0;
 }
 
@@ -1905,6 +2097,75 @@ box_check_memtx_sort_threads(void)
 				     " equal to %d", TT_SORT_THREADS_MAX));
 }
 
+/**
+ * Checks whether memtx_checkpoint_threads configuration parameter is
+ * correct. Returns the number of threads on success, -1 on error.
+ */
+static int
+box_check_memtx_checkpoint_threads(void)
+{
+	int num = cfg_geti("memtx_checkpoint_threads");
+	if (num <= 0 || num > MEMTX_CHECKPOINT_THREADS_MAX) {
+		diag_set(ClientError, ER_CFG, "memtx_checkpoint_threads",
+			 tt_sprintf("must be greater than 0 and less than or"
+				    " equal to %d",
+				    MEMTX_CHECKPOINT_THREADS_MAX));
+		return -1;
+	}
+	return num;
+}
+
+/**
+ * Checks whether memtx_join_threads configuration parameter is
+ * correct. Returns the number of threads on success, -1 on error.
+ */
+static int
+box_check_memtx_join_threads(void)
+{
+	int num = cfg_geti("memtx_join_threads");
+	if (num <= 0 || num > MEMTX_JOIN_THREADS_MAX) {
+		diag_set(ClientError, ER_CFG, "memtx_join_threads",
+			 tt_sprintf("must be greater than 0 and less than or"
+				    " equal to %d", MEMTX_JOIN_THREADS_MAX));
+		return -1;
+	}
+	return num;
+}
+
+/**
+ * Checks whether memtx_defrag_threshold configuration parameter is
+ * correct. Returns the threshold on success, -1 on error.
+ */
+static double
+box_check_memtx_defrag_threshold(void)
+{
+	double threshold = cfg_getd("memtx_defrag_threshold");
+	if (threshold < 0 || threshold > 1) {
+		diag_set(ClientError, ER_CFG, "memtx_defrag_threshold",
+			 "must be greater than or equal to 0 and less than or"
+			 " equal to 1");
+		return -1;
+	}
+	return threshold;
+}
+
+/**
+ * Checks whether memtx_evict_threshold configuration parameter is
+ * correct. Returns the threshold on success, -1 on error.
+ */
+static double
+box_check_memtx_evict_threshold(void)
+{
+	double threshold = cfg_getd("memtx_evict_threshold");
+	if (threshold < 0 || threshold > 1) {
+		diag_set(ClientError, ER_CFG, "memtx_evict_threshold",
+			 "must be greater than or equal to 0 and less than or"
+			 " equal to 1");
+		return -1;
+	}
+	return threshold;
+}
+
 void
 box_check_config(void)
 {
@@ -1943,8 +2204,18 @@ box_check_config(void)
 		diag_raise();
 	if (box_check_replication_synchro_timeout() < 0)
 		diag_raise();
+	if (box_check_replication_synchro_confirm_delay() < 0)
+		diag_raise();
 	if (box_check_replication_threads() < 0)
 		diag_raise();
+	if (box_check_replication_apply_fibers() < 0)
+		diag_raise();
+	struct tt_cpu_set cpus;
+	if (box_check_cpus("tx_cpus", &cpus) < 0 ||
+	    box_check_cpus("iproto_cpus", &cpus) < 0 ||
+	    box_check_cpus("wal_cpus", &cpus) < 0 ||
+	    box_check_cpus("relay_cpus", &cpus) < 0)
+		diag_raise();
 	box_check_replication_sync_timeout();
 	if (box_check_bootstrap_strategy() == BOOTSTRAP_STRATEGY_INVALID)
 		diag_raise();
@@ -1952,15 +2223,28 @@ box_check_config(void)
 		diag_raise();
 	uri_destroy(&uri);
 	box_check_readahead(cfg_geti("readahead"));
+	box_check_watch_notify_interval();
+	box_check_expiration_rate();
+	if (box_check_metrics_listen(&uri_set) != 0)
+		diag_raise();
+	uri_set_destroy(&uri_set);
 	box_check_checkpoint_count(cfg_geti("checkpoint_count"));
+	if (box_check_checkpoint_recovery_time() < 0)
+		diag_raise();
 	box_check_wal_max_size(cfg_geti64("wal_max_size"));
 	box_check_wal_mode(cfg_gets("wal_mode"));
 	if (box_check_wal_queue_max_size() < 0)
 		diag_raise();
+	if (box_check_wal_relay_buffer_size() < 0)
+		diag_raise();
 	if (box_check_wal_cleanup_delay() < 0)
 		diag_raise();
 	if (box_check_wal_retention_period() < 0)
 		diag_raise();
+	if (box_check_wal_spare_files() < 0)
+		diag_raise();
+	if (box_check_gc_io_rate_limit() < 0)
+		diag_raise();
 	if (box_check_memory_quota("memtx_memory") < 0)
 		diag_raise();
 	box_check_memtx_min_tuple_size(cfg_geti64("memtx_min_tuple_size"));
@@ -1977,6 +2261,14 @@ box_check_config(void)
 	if (box_check_txn_isolation() == txn_isolation_level_MAX)
 		diag_raise();
 	box_check_memtx_sort_threads();
+	if (box_check_memtx_checkpoint_threads() < 0)
+		diag_raise();
+	if (box_check_memtx_join_threads() < 0)
+		diag_raise();
+	if (box_check_memtx_defrag_threshold() < 0)
+		diag_raise();
+	if (box_check_memtx_evict_threshold() < 0)
+		diag_raise();
 }
 
 int
@@ -2248,6 +2540,16 @@ box_set_replication_synchro_timeout(void)
 	return 0;
 }
 
+int
+box_set_replication_synchro_confirm_delay(void)
+{
+	double value = box_check_replication_synchro_confirm_delay();
+	if (value < 0)
+		return -1;
+	replication_synchro_confirm_delay = value;
+	return 0;
+}
+
 void
 box_set_replication_sync_timeout(void)
 {
@@ -2260,6 +2562,16 @@ box_set_replication_skip_conflict(void)
 	replication_skip_conflict = cfg_geti("replication_skip_conflict");
 }
 
+int
+box_set_replication_apply_fibers(void)
+{
+	int count = box_check_replication_apply_fibers();
+	if (count < 0)
+		return -1;
+	replication_apply_fibers = count;
+	return 0;
+}
+
 /** Register on the master instance. Could be initial join or a name change. */
 static void
 box_register_on_master(void)
@@ -2713,11 +3025,7 @@ box_wait_vclock_f(struct trigger *trigger, void *event)
 	return 0;
 }
 
-/**
- * Wait until this instance's vclock reaches @a vclock or @a deadline is
- * reached.
- */
-static int
+int
 box_wait_vclock(const struct vclock *vclock, double deadline)
 {
 	if (vclock_compare_ignore0(vclock, &replicaset.vclock) <= 0)
@@ -2750,17 +3058,25 @@ int
 box_wait_linearization_point(double timeout)
 {
 	double deadline = ev_monotonic_now(loop()) + timeout;
-	struct vclock confirmed_vclock;
-	vclock_create(&confirmed_vclock);
 	/*
-	 * First find out the vclock which might be confirmed on remote
-	 * instances.
+	 * The leader holding a lease already has all the data confirmed on a
+	 * quorum, and no other leader can confirm anything until the lease
+	 * expires, so there's no need to poll the remote instances.
 	 */
-	if (box_collect_confirmed_vclock(&confirmed_vclock, deadline) != 0)
-		return -1;
-	/* Then wait until all the rows up to this vclock are received. */
-	if (box_wait_vclock(&confirmed_vclock, deadline) != 0)
-		return -1;
+	if (!box_raft_has_lease()) {
+		struct vclock confirmed_vclock;
+		vclock_create(&confirmed_vclock);
+		/*
+		 * First find out the vclock which might be confirmed on
+		 * remote instances.
+		 */
+		if (box_collect_confirmed_vclock(&confirmed_vclock,
+						 deadline) != 0)
+			return -1;
+		/* Then wait until all the rows up to it are received. */
+		if (box_wait_vclock(&confirmed_vclock, deadline) != 0)
+			return -1;
+	}
 	/*
 	 * Finally, wait until all the synchronous transactions, which should be
 	 * visible to this tx, become visible.
@@ -3116,6 +3432,60 @@ box_set_snap_io_rate_limit(void)
 			cfg_getd("snap_io_rate_limit"));
 }
 
+int
+box_set_gc_io_rate_limit(void)
+{
+	double rate = box_check_gc_io_rate_limit();
+	if (rate < 0)
+		return -1;
+	xlog_reaper_set_rate(rate);
+	return 0;
+}
+
+void
+box_set_memtx_checkpoint_threads(void)
+{
+	int num = box_check_memtx_checkpoint_threads();
+	if (num < 0)
+		diag_raise();
+	struct memtx_engine *memtx;
+	memtx = (struct memtx_engine *)engine_by_name("memtx");
+	assert(memtx != NULL);
+	memtx_engine_set_checkpoint_threads(memtx, num);
+}
+
+void
+box_set_memtx_join_threads(void)
+{
+	int num = box_check_memtx_join_threads();
+	if (num < 0)
+		diag_raise();
+	struct memtx_engine *memtx;
+	memtx = (struct memtx_engine *)engine_by_name("memtx");
+	assert(memtx != NULL);
+	memtx_engine_set_join_threads(memtx, num);
+}
+
+void
+box_set_memtx_checkpoint_compression(void)
+{
+	struct memtx_engine *memtx;
+	memtx = (struct memtx_engine *)engine_by_name("memtx");
+	assert(memtx != NULL);
+	memtx_engine_set_checkpoint_compression(memtx,
+			cfg_getb("memtx_checkpoint_compression"));
+}
+
+void
+box_set_memtx_checkpoint_direct_io(void)
+{
+	struct memtx_engine *memtx;
+	memtx = (struct memtx_engine *)engine_by_name("memtx");
+	assert(memtx != NULL);
+	memtx_engine_set_checkpoint_direct_io(memtx,
+			cfg_getb("memtx_checkpoint_direct_io"));
+}
+
 void
 box_set_memtx_memory(void)
 {
@@ -3128,6 +3498,30 @@ box_set_memtx_memory(void)
 	memtx_engine_set_memory_xc(memtx, size);
 }
 
+void
+box_set_memtx_defrag_threshold(void)
+{
+	struct memtx_engine *memtx;
+	memtx = (struct memtx_engine *)engine_by_name("memtx");
+	assert(memtx != NULL);
+	double threshold = box_check_memtx_defrag_threshold();
+	if (threshold < 0)
+		diag_raise();
+	memtx_engine_set_defrag_threshold(memtx, threshold);
+}
+
+void
+box_set_memtx_evict_threshold(void)
+{
+	struct memtx_engine *memtx;
+	memtx = (struct memtx_engine *)engine_by_name("memtx");
+	assert(memtx != NULL);
+	double threshold = box_check_memtx_evict_threshold();
+	if (threshold < 0)
+		diag_raise();
+	memtx_engine_set_evict_threshold(memtx, threshold);
+}
+
 void
 box_set_memtx_max_tuple_size(void)
 {
@@ -3175,7 +3569,23 @@ void
 box_set_checkpoint_wal_threshold(void)
 {
 	int64_t threshold = cfg_geti64("checkpoint_wal_threshold");
-	wal_set_checkpoint_threshold(threshold);
+	gc_set_checkpoint_wal_threshold(threshold);
+}
+
+int
+box_set_checkpoint_recovery_time(void)
+{
+	double recovery_time = box_check_checkpoint_recovery_time();
+	if (recovery_time < 0)
+		return -1;
+	gc_set_checkpoint_recovery_time(recovery_time);
+	return 0;
+}
+
+void
+box_set_wal_compression(void)
+{
+	wal_set_compression(cfg_getb("wal_compression"));
 }
 
 int
@@ -3188,6 +3598,16 @@ box_set_wal_queue_max_size(void)
 	return 0;
 }
 
+int
+box_set_wal_relay_buffer_size(void)
+{
+	int64_t size = box_check_wal_relay_buffer_size();
+	if (size < 0)
+		return -1;
+	wal_set_relay_buffer_size(size);
+	return 0;
+}
+
 int
 box_set_wal_cleanup_delay(void)
 {
@@ -3243,6 +3663,14 @@ box_set_vinyl_cache(void)
 	vinyl_engine_set_cache(vinyl, cfg_geti64("vinyl_cache"));
 }
 
+void
+box_set_vinyl_page_cache(void)
+{
+	struct engine *vinyl = engine_by_name("vinyl");
+	assert(vinyl != NULL);
+	vinyl_engine_set_page_cache(vinyl, cfg_geti64("vinyl_page_cache"));
+}
+
 void
 box_set_vinyl_timeout(void)
 {
@@ -3252,34 +3680,224 @@ box_set_vinyl_timeout(void)
 }
 
 void
-box_set_force_recovery(void)
+box_set_vinyl_compression_dict(void)
 {
-	box_is_force_recovery = cfg_geti("force_recovery");
+	struct engine *vinyl = engine_by_name("vinyl");
+	assert(vinyl != NULL);
+	vinyl_engine_set_compression_dict(vinyl,
+			cfg_getb("vinyl_compression_dict"));
 }
 
 void
-box_set_net_msg_max(void)
+box_set_force_recovery(void)
 {
-	int new_iproto_msg_max = cfg_geti("net_msg_max");
-	if (iproto_set_msg_max(new_iproto_msg_max) != 0)
-		diag_raise();
-	fiber_pool_set_max_size(&tx_fiber_pool,
-				new_iproto_msg_max *
-				IPROTO_FIBER_POOL_SIZE_FACTOR);
+	box_is_force_recovery = cfg_geti("force_recovery");
 }
 
-int
-box_set_prepared_stmt_cache_size(void)
+/**
+ * Controller of net_msg_max enabled with box.cfg.net_msg_max_auto.
+ *
+ * Once in a period, it checks if requests had to wait because of
+ * the limit, either in iproto threads or in the tx fiber pool. If
+ * they did and at least half of the limit is used by requests that
+ * are in progress in tx fibers at the same time, which means that
+ * the requests yield rather than just come in a burst, the limit is
+ * raised. If the limit stays underused for a while, it's lowered
+ * back, but never below the configured net_msg_max.
+ */
+static struct {
+	/** The controller fiber or NULL if it was never enabled. */
+	struct fiber *fiber;
+	/** Set if the controller is enabled. */
+	bool is_enabled;
+	/** box.cfg.net_msg_max, the lower bound of the limit. */
+	int cfg_msg_max;
+	/** The limit set by the controller. */
+	int msg_max;
+	/** iproto input stops seen at the previous period. */
+	int64_t msg_max_stops;
+	/** Fiber pool stalls seen at the previous period. */
+	int64_t stall_count;
+	/** The number of periods in a row the limit was underused. */
+	int idle_periods;
+} net_msg_max_auto;
+
+enum {
+	/** Period of the net_msg_max controller, in seconds. */
+	NET_MSG_MAX_AUTO_PERIOD = 1,
+	/** Lower the limit after so many underused periods. */
+	NET_MSG_MAX_AUTO_IDLE_PERIODS = 10,
+};
+
+/** Set the limit on iproto messages and the tx fiber pool size. */
+static int
+box_apply_net_msg_max(int msg_max)
 {
-	int cache_sz = cfg_geti("sql_cache_size");
-	if (box_check_sql_cache_size(cache_sz) != 0)
-		return -1;
-	if (sql_stmt_cache_set_size(cache_sz) != 0)
+	if (iproto_set_msg_max(msg_max) != 0)
 		return -1;
+	fiber_pool_set_max_size(&tx_fiber_pool,
+				msg_max * IPROTO_FIBER_POOL_SIZE_FACTOR);
+	net_msg_max_auto.msg_max = msg_max;
 	return 0;
 }
 
-/**
+/** A step of the net_msg_max controller. */
+static void
+net_msg_max_auto_step(void)
+{
+	struct iproto_stats stats;
+	iproto_stats_get(&stats);
+	/* Counters may go back on box.stat.reset(). */
+	int64_t stops = stats.msg_max_stops - net_msg_max_auto.msg_max_stops;
+	if (stops < 0)
+		stops = stats.msg_max_stops;
+	net_msg_max_auto.msg_max_stops = stats.msg_max_stops;
+	int64_t stalls = tx_fiber_pool.stall_count -
+			 net_msg_max_auto.stall_count;
+	net_msg_max_auto.stall_count = tx_fiber_pool.stall_count;
+	int busy = tx_fiber_pool.busy_peak;
+	tx_fiber_pool.busy_peak = tx_fiber_pool.busy;
+
+	int msg_max = net_msg_max_auto.msg_max;
+	int new_msg_max = msg_max;
+	if ((stops > 0 || stalls > 0) && busy * 2 >= msg_max) {
+		new_msg_max = MIN(msg_max + msg_max / 2,
+				  (int)IPROTO_MSG_MAX_AUTO_MAX);
+		net_msg_max_auto.idle_periods = 0;
+	} else if (busy * 4 < msg_max &&
+		   msg_max > net_msg_max_auto.cfg_msg_max) {
+		if (++net_msg_max_auto.idle_periods >=
+		    NET_MSG_MAX_AUTO_IDLE_PERIODS) {
+			new_msg_max = MAX(msg_max - msg_max / 4,
+					  net_msg_max_auto.cfg_msg_max);
+			net_msg_max_auto.idle_periods = 0;
+		}
+	} else {
+		net_msg_max_auto.idle_periods = 0;
+	}
+	if (new_msg_max == msg_max)
+		return;
+	say_info("net_msg_max_auto: changing net_msg_max from %d to %d",
+		 msg_max, new_msg_max);
+	if (box_apply_net_msg_max(new_msg_max) != 0)
+		diag_log();
+}
+
+static int
+net_msg_max_auto_f(va_list ap)
+{
+	(void)ap;
+	while (!fiber_is_cancelled()) {
+		fiber_sleep(NET_MSG_MAX_AUTO_PERIOD);
+		if (net_msg_max_auto.is_enabled)
+			net_msg_max_auto_step();
+	}
+	return 0;
+}
+
+void
+box_set_net_msg_max(void)
+{
+	int new_iproto_msg_max = cfg_geti("net_msg_max");
+	if (box_apply_net_msg_max(new_iproto_msg_max) != 0)
+		diag_raise();
+	net_msg_max_auto.cfg_msg_max = new_iproto_msg_max;
+	net_msg_max_auto.idle_periods = 0;
+}
+
+void
+box_set_net_msg_max_auto(void)
+{
+	bool is_enabled = cfg_getb("net_msg_max_auto");
+	if (is_enabled == net_msg_max_auto.is_enabled)
+		return;
+	if (!is_enabled) {
+		/* Restore the configured limit. */
+		if (box_apply_net_msg_max(net_msg_max_auto.cfg_msg_max) != 0)
+			diag_raise();
+	} else if (net_msg_max_auto.fiber == NULL) {
+		net_msg_max_auto.fiber = fiber_new_system("net_msg_max_auto",
+							  net_msg_max_auto_f);
+		if (net_msg_max_auto.fiber == NULL)
+			diag_raise();
+		fiber_wakeup(net_msg_max_auto.fiber);
+	}
+	net_msg_max_auto.is_enabled = is_enabled;
+	net_msg_max_auto.idle_periods = 0;
+}
+
+void
+box_tx_fiber_pool_stat(struct box_tx_fiber_pool_stat *stat)
+{
+	stat->size = tx_fiber_pool.size;
+	stat->busy = tx_fiber_pool.busy;
+	stat->max_size = tx_fiber_pool.max_size;
+	stat->stall_count = tx_fiber_pool.stall_count;
+	stat->stall_time = tx_fiber_pool.stall_time;
+	if (tx_fiber_pool.stall_start != 0) {
+		stat->stall_time += ev_monotonic_now(loop()) -
+				    tx_fiber_pool.stall_start;
+	}
+}
+
+void
+box_set_net_msg_max_per_connection(void)
+{
+	int msg_max = cfg_geti("net_msg_max_per_connection");
+	if (iproto_set_connection_msg_max(msg_max) != 0)
+		diag_raise();
+}
+
+void
+box_set_net_batch_delay(void)
+{
+	if (iproto_set_batch_delay(cfg_getd("net_batch_delay")) != 0)
+		diag_raise();
+}
+
+void
+box_set_watch_notify_interval(void)
+{
+	box_watcher_set_notify_interval(box_check_watch_notify_interval());
+}
+
+void
+box_set_expiration_rate(void)
+{
+	expire_set_rate(box_check_expiration_rate());
+}
+
+int
+box_set_metrics_listen(void)
+{
+	struct uri_set uri_set;
+	if (box_check_metrics_listen(&uri_set) != 0)
+		return -1;
+	int rc = metrics_export_listen(&uri_set);
+	uri_set_destroy(&uri_set);
+	return rc;
+}
+
+void
+box_set_iproto_read_view_staleness(void)
+{
+	double staleness = cfg_getd("iproto_read_view_staleness");
+	if (iproto_set_read_view_staleness(staleness) != 0)
+		diag_raise();
+}
+
+int
+box_set_prepared_stmt_cache_size(void)
+{
+	int cache_sz = cfg_geti("sql_cache_size");
+	if (box_check_sql_cache_size(cache_sz) != 0)
+		return -1;
+	if (sql_stmt_cache_set_size(cache_sz) != 0)
+		return -1;
+	return 0;
+}
+
+/**
  * Report crash information to the feedback daemon
  * (ie send it to feedback daemon).
  */
@@ -3652,14 +4270,18 @@ box_index_id_by_name(uint32_t space_id, const char *name, uint32_t len)
 	return result;
 }
 
-int
-box_process1(struct request *request, box_tuple_t **result)
+/**
+ * Find a space for a DML request and check that the space can be
+ * written to.
+ */
+static struct space *
+box_find_writable_space(uint32_t space_id)
 {
 	if (box_check_slice() != 0)
-		return -1;
-	struct space *space = space_cache_find(request->space_id);
+		return NULL;
+	struct space *space = space_cache_find(space_id);
 	if (space == NULL)
-		return -1;
+		return NULL;
 	/*
 	 * Allow to write to data-temporary and local spaces in the read-only
 	 * mode. To handle space truncation and/or ddl operations on temporary
@@ -3675,7 +4297,7 @@ box_process1(struct request *request, box_tuple_t **result)
 	    !space_is_data_temporary(space) &&
 	    !space_is_local(space) &&
 	    box_check_writable() != 0)
-		return -1;
+		return NULL;
 	if (space_is_memtx(space)) {
 		/*
 		 * Due to on_init_schema triggers set on system spaces,
@@ -3691,13 +4313,128 @@ box_process1(struct request *request, box_tuple_t **result)
 				"box.ctl.is_recovery_finished() "
 				"to check that snapshot recovery was completed");
 			diag_log();
-			return -1;
+			return NULL;
 		}
 	}
+	return space;
+}
 
+int
+box_process1(struct request *request, box_tuple_t **result)
+{
+	struct space *space = box_find_writable_space(request->space_id);
+	if (space == NULL)
+		return -1;
+	if (request->type == IPROTO_UPSERT &&
+	    space->def->opts.upsert_window > 0 && in_txn() == NULL) {
+		int rc = upsert_buffer_process(space, request);
+		if (rc <= 0) {
+			if (result != NULL)
+				*result = NULL;
+			return rc;
+		}
+		/* The space may have been altered while we yielded. */
+		space = box_find_writable_space(request->space_id);
+		if (space == NULL)
+			return -1;
+	}
 	return box_process_rw(request, space, result);
 }
 
+/**
+ * Execute an INSERT or REPLACE request for each tuple of a MsgPack
+ * array. The space lookup and the access checks are done once for
+ * the whole batch, and all the tuples are applied atomically: in one
+ * transaction, which is written to WAL as a single entry, or, if
+ * called within a transaction, rolled back to the batch start on
+ * failure.
+ */
+static int
+box_process_batch(uint16_t type, uint32_t space_id, const char *tuples,
+		  const char *tuples_end, uint32_t *count)
+{
+	assert(type == IPROTO_INSERT || type == IPROTO_REPLACE);
+	(void)tuples_end;
+	if (mp_typeof(*tuples) != MP_ARRAY) {
+		diag_set(IllegalParams, "tuples must be an array");
+		return -1;
+	}
+	struct space *space = box_find_writable_space(space_id);
+	if (space == NULL)
+		return -1;
+	uint32_t tuple_count = mp_decode_array(&tuples);
+	struct txn *txn = in_txn();
+	bool is_autocommit = txn == NULL;
+	struct txn_savepoint *svp = NULL;
+	if (is_autocommit) {
+		txn = txn_begin();
+		if (txn == NULL)
+			return -1;
+	} else {
+		svp = txn_savepoint_new(txn, NULL);
+		if (svp == NULL)
+			return -1;
+	}
+	double start_time = 0;
+	bool collect_op_stat = op_stat_is_enabled;
+	if (unlikely(collect_op_stat))
+		start_time = clock_monotonic();
+	const char *data = tuples;
+	struct request request;
+	memset(&request, 0, sizeof(request));
+	request.type = type;
+	request.space_id = space_id;
+	if (access_check_space(space, PRIV_W) != 0)
+		goto rollback;
+	for (uint32_t i = 0; i < tuple_count; i++) {
+		request.tuple = tuples;
+		mp_next(&tuples);
+		request.tuple_end = tuples;
+		assert(tuples <= tuples_end);
+		if (mp_typeof(*request.tuple) != MP_ARRAY) {
+			diag_set(ClientError, ER_TUPLE_NOT_ARRAY);
+			goto rollback;
+		}
+		struct tuple *tuple;
+		if (txn_begin_stmt(txn, space, type) != 0)
+			goto rollback;
+		if (space_execute_dml(space, txn, &request, &tuple) != 0) {
+			txn_rollback_stmt(txn);
+			goto rollback;
+		}
+		if (txn_commit_stmt(txn, &request) != 0)
+			goto rollback;
+	}
+	rmean_collect(rmean_box, type, tuple_count);
+	if (is_autocommit) {
+		if (txn_commit(txn) < 0)
+			return -1;
+	} else {
+		txn_savepoint_release(svp);
+	}
+	if (unlikely(collect_op_stat)) {
+		op_stat_collect_write(space_id, tuples - data,
+				      clock_monotonic() - start_time);
+	}
+	if (count != NULL)
+		*count = tuple_count;
+	return 0;
+rollback:
+	if (is_autocommit) {
+		txn_abort(txn);
+	} else {
+		/* Keep the batch error if the rollback fails. */
+		struct diag diag;
+		diag_create(&diag);
+		diag_move(diag_get(), &diag);
+		if (box_txn_rollback_to_savepoint(svp) == 0)
+			txn_savepoint_release(svp);
+		diag_move(&diag, diag_get());
+		diag_destroy(&diag);
+	}
+	return -1;
+}
+
 void
 box_iterator_position_pack(const char *pos, const char *pos_end,
 			   uint32_t found, const char **packed_pos,
@@ -3749,14 +4486,409 @@ box_iterator_position_unpack(const char *packed_pos,
 	return 0;
 }
 
+/** A field of tuples referenced by box_select() projection or filter. */
+struct box_select_field {
+	/** Field number or UINT32_MAX if the field is given by a path. */
+	uint32_t fieldno;
+	/** JSON path to the field, used only if fieldno is UINT32_MAX. */
+	const char *path;
+	/** Length of @path. */
+	uint32_t path_len;
+	/** Hash of @path. */
+	uint32_t path_hash;
+};
+
+/**
+ * Decodes a field given by a 0-based number or a name or JSON path.
+ * Field names are resolved to field numbers with the space dictionary
+ * so that only JSON paths are looked up per tuple. Returns -1 without
+ * setting diag if the field is invalid.
+ */
+static int
+box_select_field_decode(struct space *space, const char **data,
+			struct box_select_field *field)
+{
+	field->path = NULL;
+	switch (mp_typeof(**data)) {
+	case MP_UINT: {
+		uint64_t fieldno = mp_decode_uint(data);
+		if (fieldno >= UINT32_MAX)
+			return -1;
+		field->fieldno = fieldno;
+		return 0;
+	}
+	case MP_STR:
+		field->path = mp_decode_str(data, &field->path_len);
+		if (field->path_len == 0)
+			return -1;
+		field->path_hash = field_name_hash(field->path,
+						   field->path_len);
+		if (tuple_fieldno_by_name(space->def->dict, field->path,
+					  field->path_len, field->path_hash,
+					  &field->fieldno) == 0)
+			field->path = NULL;
+		else
+			field->fieldno = UINT32_MAX;
+		return 0;
+	default:
+		return -1;
+	}
+}
+
+/** Returns the given field of @a tuple or NULL if there's no such field. */
+static inline const char *
+box_select_field_get(const struct box_select_field *field,
+		     struct tuple *tuple)
+{
+	if (field->path == NULL)
+		return tuple_field(tuple, field->fieldno);
+	return tuple_field_raw_by_full_path(tuple_format(tuple),
+					    tuple_data(tuple),
+					    tuple_field_map(tuple),
+					    field->path, field->path_len,
+					    field->path_hash,
+					    TUPLE_INDEX_BASE);
+}
+
+/**
+ * Decodes the fields to project selected tuples to into a plan allocated
+ * on the fiber region.
+ */
+static struct box_select_field *
+box_select_fields_decode(struct space *space, const char *fields,
+			 uint32_t *field_count)
+{
+	uint32_t count = mp_decode_array(&fields);
+	if (count == 0)
+		goto error;
+	struct box_select_field *plan;
+	plan = xregion_alloc_array(&fiber()->gc, struct box_select_field,
+				   count);
+	for (uint32_t i = 0; i < count; i++) {
+		if (box_select_field_decode(space, &fields, &plan[i]) != 0)
+			goto error;
+	}
+	*field_count = count;
+	return plan;
+error:
+	diag_set(ClientError, ER_ILLEGAL_PARAMS, "fields must be a non-empty "
+		 "array of field numbers and paths");
+	return NULL;
+}
+
+/**
+ * Returns a new tuple of the runtime format that consists of the given
+ * fields of @a tuple. Missing fields are set to nil.
+ */
+static struct tuple *
+box_select_project(struct tuple *tuple, const struct box_select_field *plan,
+		   uint32_t field_count)
+{
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	const char **fields = xregion_alloc_array(region, const char *,
+						  field_count);
+	const char **fields_end = xregion_alloc_array(region, const char *,
+						      field_count);
+	size_t size = mp_sizeof_array(field_count);
+	for (uint32_t i = 0; i < field_count; i++) {
+		const char *data = box_select_field_get(&plan[i], tuple);
+		fields[i] = data;
+		if (data != NULL) {
+			mp_next(&data);
+			size += data - fields[i];
+		} else {
+			size += mp_sizeof_nil();
+		}
+		fields_end[i] = data;
+	}
+	char *buf = (char *)xregion_alloc(region, size);
+	char *pos = mp_encode_array(buf, field_count);
+	for (uint32_t i = 0; i < field_count; i++) {
+		if (fields[i] == NULL) {
+			pos = mp_encode_nil(pos);
+		} else {
+			memcpy(pos, fields[i], fields_end[i] - fields[i]);
+			pos += fields_end[i] - fields[i];
+		}
+	}
+	assert(pos == buf + size);
+	struct tuple *result = tuple_new(tuple_format_runtime, buf, pos);
+	region_truncate(region, region_svp);
+	return result;
+}
+
+enum {
+	/** Max nesting depth of a box_select() filter expression. */
+	BOX_SELECT_FILTER_DEPTH_MAX = 32,
+};
+
+/** Operation of a box_select() filter expression. */
+enum box_select_filter_op {
+	BOX_SELECT_FILTER_EQ,
+	BOX_SELECT_FILTER_NE,
+	BOX_SELECT_FILTER_LT,
+	BOX_SELECT_FILTER_LE,
+	BOX_SELECT_FILTER_GT,
+	BOX_SELECT_FILTER_GE,
+	BOX_SELECT_FILTER_IN,
+	BOX_SELECT_FILTER_AND,
+	BOX_SELECT_FILTER_OR,
+	BOX_SELECT_FILTER_NOT,
+	box_select_filter_op_MAX,
+};
+
+static const char *box_select_filter_op_strs[] = {
+	/* [BOX_SELECT_FILTER_EQ]  = */ "==",
+	/* [BOX_SELECT_FILTER_NE]  = */ "!=",
+	/* [BOX_SELECT_FILTER_LT]  = */ "<",
+	/* [BOX_SELECT_FILTER_LE]  = */ "<=",
+	/* [BOX_SELECT_FILTER_GT]  = */ ">",
+	/* [BOX_SELECT_FILTER_GE]  = */ ">=",
+	/* [BOX_SELECT_FILTER_IN]  = */ "in",
+	/* [BOX_SELECT_FILTER_AND] = */ "and",
+	/* [BOX_SELECT_FILTER_OR]  = */ "or",
+	/* [BOX_SELECT_FILTER_NOT] = */ "not",
+};
+
+static_assert(lengthof(box_select_filter_op_strs) ==
+	      box_select_filter_op_MAX,
+	      "Each filter operation must have a name");
+
+/**
+ * A compiled box_select() filter expression. It is decoded once per
+ * request so that evaluating it against a tuple doesn't involve parsing.
+ */
+struct box_select_filter {
+	/** Operation. */
+	enum box_select_filter_op op;
+	/** Field compared by a comparison or IN. */
+	struct box_select_field field;
+	/** Value of a comparison or values of IN, one after another. */
+	const char *value;
+	/** Number of values of IN or operands of AND, OR and NOT. */
+	uint32_t count;
+	/** Operands of AND, OR and NOT. */
+	struct box_select_filter **operands;
+};
+
+/** Returns true if a filter may compare the given MsgPack value. */
+static inline bool
+box_select_filter_value_is_valid(const char *value)
+{
+	if (mp_typeof(*value) == MP_EXT) {
+		int8_t ext_type;
+		const char *data = value;
+		mp_decode_extl(&data, &ext_type);
+		if (ext_type != MP_DECIMAL && ext_type != MP_UUID &&
+		    ext_type != MP_DATETIME)
+			return false;
+	}
+	return field_mp_type_is_compatible(FIELD_TYPE_SCALAR, value, true);
+}
+
+/**
+ * Compares a field with a filter value in the order of a scalar index.
+ * Nil is less than any other value.
+ */
+static inline int
+box_select_filter_compare(const char *field, const char *value)
+{
+	bool field_is_nil = mp_typeof(*field) == MP_NIL;
+	bool value_is_nil = mp_typeof(*value) == MP_NIL;
+	if (field_is_nil || value_is_nil)
+		return (int)value_is_nil - (int)field_is_nil;
+	return tuple_compare_field(field, value, FIELD_TYPE_SCALAR, NULL);
+}
+
+/**
+ * Decodes a filter expression. An expression is one of
+ *
+ *   [op, field, value], where op is ==, !=, <, <=, >, >=,
+ *   ['in', field, [value, ...]],
+ *   ['and', expr, ...], ['or', expr, ...], ['not', expr],
+ *
+ * where field is a 0-based field number or a field name or JSON path and
+ * value is a scalar. The result is allocated on the fiber region.
+ */
+static struct box_select_filter *
+box_select_filter_decode(struct space *space, const char **data, int depth)
+{
+	const char *err;
+	if (mp_typeof(**data) != MP_ARRAY) {
+		err = "expression must be an array";
+		goto error;
+	}
+	uint32_t size;
+	size = mp_decode_array(data);
+	if (size == 0 || mp_typeof(**data) != MP_STR) {
+		err = "expression must start with an operation";
+		goto error;
+	}
+	uint32_t op_len;
+	const char *op_str;
+	op_str = mp_decode_str(data, &op_len);
+	int op;
+	for (op = 0; op < box_select_filter_op_MAX; op++) {
+		const char *str = box_select_filter_op_strs[op];
+		if (strlen(str) == op_len && memcmp(str, op_str, op_len) == 0)
+			break;
+	}
+	if (op == box_select_filter_op_MAX) {
+		err = tt_sprintf("unknown operation '%.*s'",
+				 (int)op_len, op_str);
+		goto error;
+	}
+	struct box_select_filter *filter;
+	filter = xregion_alloc_object(&fiber()->gc, struct box_select_filter);
+	filter->op = (enum box_select_filter_op)op;
+	filter->value = NULL;
+	filter->count = 0;
+	filter->operands = NULL;
+	if (op == BOX_SELECT_FILTER_AND || op == BOX_SELECT_FILTER_OR ||
+	    op == BOX_SELECT_FILTER_NOT) {
+		filter->count = size - 1;
+		if (filter->count == 0 ||
+		    (op == BOX_SELECT_FILTER_NOT && filter->count != 1)) {
+			err = tt_sprintf("operation '%s' takes %s",
+					 box_select_filter_op_strs[op],
+					 op == BOX_SELECT_FILTER_NOT ?
+					 "one operand" :
+					 "at least one operand");
+			goto error;
+		}
+		if (depth >= BOX_SELECT_FILTER_DEPTH_MAX) {
+			err = "expression is too deep";
+			goto error;
+		}
+		filter->operands = xregion_alloc_array(
+			&fiber()->gc, struct box_select_filter *,
+			filter->count);
+		for (uint32_t i = 0; i < filter->count; i++) {
+			filter->operands[i] = box_select_filter_decode(
+				space, data, depth + 1);
+			if (filter->operands[i] == NULL)
+				return NULL;
+		}
+		return filter;
+	}
+	if (size != 3 ||
+	    box_select_field_decode(space, data, &filter->field) != 0)
+		goto error_operands;
+	if (op == BOX_SELECT_FILTER_IN) {
+		if (mp_typeof(**data) != MP_ARRAY)
+			goto error_operands;
+		filter->count = mp_decode_array(data);
+		filter->value = *data;
+		for (uint32_t i = 0; i < filter->count; i++) {
+			if (!box_select_filter_value_is_valid(*data))
+				goto error_operands;
+			mp_next(data);
+		}
+	} else {
+		filter->value = *data;
+		if (!box_select_filter_value_is_valid(*data))
+			goto error_operands;
+		mp_next(data);
+	}
+	return filter;
+error_operands:
+	err = tt_sprintf("operation '%s' takes a field and %s",
+			 box_select_filter_op_strs[op],
+			 op == BOX_SELECT_FILTER_IN ?
+			 "an array of scalars" : "a scalar");
+error:
+	diag_set(ClientError, ER_ILLEGAL_PARAMS,
+		 tt_sprintf("invalid filter: %s", err));
+	return NULL;
+}
+
+/** Returns true if @a tuple matches the filter expression. */
+static bool
+box_select_filter_match(const struct box_select_filter *filter,
+			struct tuple *tuple)
+{
+	switch (filter->op) {
+	case BOX_SELECT_FILTER_AND:
+		for (uint32_t i = 0; i < filter->count; i++) {
+			if (!box_select_filter_match(filter->operands[i], tuple))
+				return false;
+		}
+		return true;
+	case BOX_SELECT_FILTER_OR:
+		for (uint32_t i = 0; i < filter->count; i++) {
+			if (box_select_filter_match(filter->operands[i], tuple))
+				return true;
+		}
+		return false;
+	case BOX_SELECT_FILTER_NOT:
+		return !box_select_filter_match(filter->operands[0], tuple);
+	default:
+		break;
+	}
+	/* A missing field is compared as nil. */
+	static const char nil = 0xc0;
+	const char *field = box_select_field_get(&filter->field, tuple);
+	if (field == NULL)
+		field = &nil;
+	/* Non-scalar fields don't match any comparison. */
+	if (!box_select_filter_value_is_valid(field))
+		return false;
+	if (filter->op == BOX_SELECT_FILTER_IN) {
+		const char *value = filter->value;
+		for (uint32_t i = 0; i < filter->count; i++) {
+			if (box_select_filter_compare(field, value) == 0)
+				return true;
+			mp_next(&value);
+		}
+		return false;
+	}
+	int rc = box_select_filter_compare(field, filter->value);
+	switch (filter->op) {
+	case BOX_SELECT_FILTER_EQ:
+		return rc == 0;
+	case BOX_SELECT_FILTER_NE:
+		return rc != 0;
+	case BOX_SELECT_FILTER_LT:
+		return rc < 0;
+	case BOX_SELECT_FILTER_LE:
+		return rc <= 0;
+	case BOX_SELECT_FILTER_GT:
+		return rc > 0;
+	case BOX_SELECT_FILTER_GE:
+		return rc >= 0;
+	default:
+		unreachable();
+	}
+	return false;
+}
+
+/**
+ * Returns true if tuples selected from the space may be added to a port
+ * without referencing them, see port_c_create_borrowed(). Memtx iterators
+ * don't yield, so the tuples stay in the index until the port is dumped,
+ * unless the iterator returns new tuples, which happens on decompression
+ * and space upgrade, or frees old tuple versions, which the MVCC engine
+ * does on iteration.
+ */
+static bool
+box_select_can_borrow_tuples(struct space *space)
+{
+	return space_is_memtx(space) && !memtx_tx_manager_use_mvcc_engine &&
+	       space->upgrade == NULL && !space->format->is_compressed;
+}
+
 int
 box_select(uint32_t space_id, uint32_t index_id,
 	   int iterator, uint32_t offset, uint32_t limit,
 	   const char *key, const char *key_end,
+	   const char *fields, const char *fields_end,
+	   const char *filter, const char *filter_end,
 	   const char **packed_pos, const char **packed_pos_end,
-	   bool update_pos, struct port *port)
+	   bool update_pos, bool borrow_tuples, struct port *port)
 {
-	(void)key_end;
+	(void)fields_end;
+	(void)filter_end;
 	assert(!update_pos || (packed_pos != NULL && packed_pos_end != NULL));
 	assert(packed_pos == NULL || packed_pos_end != NULL);
 
@@ -3788,14 +4920,34 @@ box_select(uint32_t space_id, uint32_t index_id,
 					 index->def->cmp_def, key, part_count,
 					 type, &pos, &pos_end) != 0)
 		return -1;
+	struct box_select_field *plan = NULL;
+	uint32_t field_count = 0;
+	if (fields != NULL) {
+		plan = box_select_fields_decode(space, fields, &field_count);
+		if (plan == NULL)
+			return -1;
+	}
+	struct box_select_filter *expr = NULL;
+	if (filter != NULL) {
+		expr = box_select_filter_decode(space, &filter, 0);
+		if (expr == NULL)
+			return -1;
+	}
 
 	box_run_on_select(space, index, type, key_array);
+	if (unlikely(hot_key_sample()))
+		hot_key_collect(index, key_array, key_end);
 
 	ERROR_INJECT(ERRINJ_TESTING, {
 		diag_set(ClientError, ER_INJECTION, "ERRINJ_TESTING");
 		return -1;
 	});
 
+	double start_time = 0;
+	bool collect_op_stat = op_stat_is_enabled;
+	if (unlikely(collect_op_stat))
+		start_time = clock_monotonic();
+
 	struct txn *txn;
 	struct txn_ro_savepoint svp;
 	if (txn_begin_ro_stmt(space, &txn, &svp) != 0)
@@ -3810,20 +4962,49 @@ box_select(uint32_t space_id, uint32_t index_id,
 
 	int rc = 0;
 	uint32_t found = 0;
+	uint32_t scanned = 0;
 	struct tuple *tuple;
-	port_c_create(port);
-	while (found < limit) {
+	/* Projected tuples are new, so they must be referenced. */
+	if (borrow_tuples && plan == NULL &&
+	    box_select_can_borrow_tuples(space))
+		port_c_create_borrowed(port);
+	else
+		port_c_create(port);
+	if (offset > 0 && limit > 0 && expr == NULL) {
+		/* Tree indexes skip the offset without fetching tuples. */
+		uint32_t skipped;
+		rc = iterator_skip(it, offset, &skipped);
+		scanned += skipped;
+	}
+	while (rc == 0 && found < limit) {
 		rc = box_check_slice();
 		if (rc != 0)
 			break;
 		rc = iterator_next(it, &tuple);
 		if (rc != 0 || tuple == NULL)
 			break;
-		if (offset > 0) {
-			offset--;
-			continue;
+		scanned++;
+		if (expr != NULL) {
+			if (!box_select_filter_match(expr, tuple))
+				continue;
+			/* The offset is counted in matching tuples. */
+			if (offset > 0) {
+				offset--;
+				continue;
+			}
+		}
+		if (plan != NULL) {
+			tuple = box_select_project(tuple, plan, field_count);
+			if (tuple == NULL) {
+				rc = -1;
+				break;
+			}
+			tuple_ref(tuple);
+			rc = port_c_add_tuple(port, tuple);
+			tuple_unref(tuple);
+		} else {
+			rc = port_c_add_tuple(port, tuple);
 		}
-		rc = port_c_add_tuple(port, tuple);
 		if (rc != 0)
 			break;
 		found++;
@@ -3835,6 +5016,8 @@ box_select(uint32_t space_id, uint32_t index_id,
 	}
 
 	txn_end_ro_stmt(txn, &svp);
+	fiber()->storage.net.lookups++;
+	fiber()->storage.net.scanned += scanned;
 	if (rc != 0)
 		goto fail;
 
@@ -3850,6 +5033,10 @@ box_select(uint32_t space_id, uint32_t index_id,
 					   packed_pos, packed_pos_end);
 	}
 	iterator_delete(it);
+	if (unlikely(collect_op_stat)) {
+		op_stat_collect_select(space_id, index_id, scanned, found,
+				       clock_monotonic() - start_time);
+	}
 	return 0;
 fail:
 	iterator_delete(it);
@@ -3857,6 +5044,22 @@ box_select(uint32_t space_id, uint32_t index_id,
 	return -1;
 }
 
+int
+box_index_prefetch(uint32_t space_id, uint32_t index_id,
+		   const char *keys, uint32_t key_count)
+{
+	struct space *space = space_cache_find(space_id);
+	if (space == NULL)
+		return -1;
+	if (access_check_space(space, PRIV_R) != 0)
+		return -1;
+	struct index *index = index_find(space, index_id);
+	if (index == NULL)
+		return -1;
+	index_prefetch(index, keys, key_count);
+	return 0;
+}
+
 /**
  * A special wrapper for FFI - workaround for M1.
  * Use 64-bit integers beyond the 8th argument.
@@ -3866,11 +5069,13 @@ extern "C" int
 box_select_ffi(uint32_t space_id, uint32_t index_id, const char *key,
 	       const char *key_end, const char **packed_pos,
 	       const char **packed_pos_end, bool update_pos, struct port *port,
-	       int64_t iterator, uint64_t offset, uint64_t limit)
+	       int64_t iterator, uint64_t offset, uint64_t limit,
+	       const char *fields, const char *fields_end,
+	       const char *filter, const char *filter_end)
 {
 	return box_select(space_id, index_id, iterator, offset, limit, key,
-			  key_end, packed_pos, packed_pos_end, update_pos,
-			  port);
+			  key_end, fields, fields_end, filter, filter_end,
+			  packed_pos, packed_pos_end, update_pos, false, port);
 }
 
 API_EXPORT int
@@ -3901,6 +5106,22 @@ box_replace(uint32_t space_id, const char *tuple, const char *tuple_end,
 	return box_process1(&request, result);
 }
 
+API_EXPORT int
+box_insert_batch(uint32_t space_id, const char *tuples,
+		 const char *tuples_end, uint32_t *count)
+{
+	return box_process_batch(IPROTO_INSERT, space_id, tuples, tuples_end,
+				 count);
+}
+
+API_EXPORT int
+box_replace_batch(uint32_t space_id, const char *tuples,
+		  const char *tuples_end, uint32_t *count)
+{
+	return box_process_batch(IPROTO_REPLACE, space_id, tuples, tuples_end,
+				 count);
+}
+
 API_EXPORT int
 box_delete(uint32_t space_id, uint32_t index_id, const char *key,
 	   const char *key_end, box_tuple_t **result)
@@ -4067,10 +5288,24 @@ box_sequence_next(uint32_t seq_id, int64_t *result)
 	if (access_check_sequence(seq) != 0)
 		return -1;
 	int64_t value;
+	if (sequence_next_cached(seq, &value)) {
+		*result = value;
+		return 0;
+	}
 	if (sequence_next(seq, &value) != 0)
 		return -1;
-	if (sequence_data_update(seq_id, value) != 0)
+	/*
+	 * Reserve a block of values if the sequence has the cache
+	 * option set. Only do it outside a transaction: values of
+	 * the block may be handed out only once the reservation is
+	 * committed, otherwise they could be reused after restart.
+	 */
+	int64_t end = in_txn() == NULL ? sequence_cache_end(seq, value) :
+					 value;
+	if (sequence_data_update(seq_id, end) != 0)
 		return -1;
+	if (end != value)
+		sequence_cache_reserve(seq, value, end);
 	*result = value;
 	return 0;
 }
@@ -4680,6 +5915,9 @@ box_process_subscribe(struct iostream *io, const struct xrow_header *header)
 	vclock_copy(&rsp.vclock, &replicaset.vclock);
 	rsp.replicaset_uuid = REPLICASET_UUID;
 	strlcpy(rsp.replicaset_name, REPLICASET_NAME, NODE_NAME_SIZE_MAX);
+	rsp.is_compressed = req.is_compressed;
+	rsp.space_filter = req.space_filter;
+	rsp.space_filter_end = req.space_filter_end;
 	struct xrow_header row;
 	RegionGuard region_guard(&fiber()->gc);
 	xrow_encode_subscribe_response(&row, &rsp);
@@ -4693,12 +5931,33 @@ box_process_subscribe(struct iostream *io, const struct xrow_header *header)
 	row.replica_id = self->id;
 	row.sync = header->sync;
 	coio_write_xrow(io, &row);
+	/*
+	 * The rest of the stream is compressed in both directions if
+	 * the replica asked for it.
+	 */
+	struct iostream *plain_io = io;
+	struct iostream zstd_io;
+	if (rsp.is_compressed) {
+		if (zstd_iostream_create(&zstd_io, plain_io, NULL, 0) != 0)
+			diag_raise();
+		io = &zstd_io;
+	}
+	auto zstd_io_guard = make_scoped_guard([&] {
+		if (io == &zstd_io)
+			zstd_iostream_release(&zstd_io, plain_io);
+	});
 
-	say_info("subscribed replica %s at %s",
-		 tt_uuid_str(&req.instance_uuid), sio_socketname(io->fd));
+	say_info("subscribed replica %s at %s%s",
+		 tt_uuid_str(&req.instance_uuid), sio_socketname(io->fd),
+		 rsp.is_compressed ? " with compression" : "");
 	say_info("remote vclock %s local vclock %s",
 		 vclock_to_string(&req.vclock), vclock_to_string(&rsp.vclock));
+	if (req.space_filter != NULL) {
+		say_info("relaying rows of user spaces %s only",
+			 mp_str(req.space_filter));
+	}
 	uint64_t sent_raft_term = 0;
+	uint64_t sent_leader_term = 0;
 	if (req.version_id >= version_id(2, 6, 0) && !req.is_anon) {
 		/*
 		 * Send out the current raft state of the instance. Don't do
@@ -4712,6 +5971,8 @@ box_process_subscribe(struct iostream *io, const struct xrow_header *header)
 		xrow_encode_raft(&row, &fiber()->gc, &req);
 		coio_write_xrow(io, &row);
 		sent_raft_term = req.term;
+		if (req.state == RAFT_STATE_LEADER)
+			sent_leader_term = req.term;
 	}
 	/*
 	 * Replica vclock is used in gc state and recovery
@@ -4743,7 +6004,8 @@ box_process_subscribe(struct iostream *io, const struct xrow_header *header)
 	 * indefinitely).
 	 */
 	relay_subscribe(replica, io, header->sync, &req.vclock,
-			req.version_id, req.id_filter, sent_raft_term);
+			req.version_id, req.id_filter, req.space_filter,
+			sent_raft_term, sent_leader_term);
 }
 
 void
@@ -4828,9 +6090,12 @@ engine_init()
 				    cfg_gets("memtx_allocator"),
 				    cfg_getd("slab_alloc_factor"),
 				    cfg_geti("memtx_sort_threads"),
+				    cfg_getb("memtx_use_huge_pages"),
 				    box_on_indexes_built);
 	engine_register((struct engine *)memtx);
 	box_set_memtx_max_tuple_size();
+	box_set_memtx_defrag_threshold();
+	box_set_memtx_evict_threshold();
 
 	memcs_engine_register();
 
@@ -4852,7 +6117,9 @@ engine_init()
 	engine_register((struct engine *)vinyl);
 	box_set_vinyl_max_tuple_size();
 	box_set_vinyl_cache();
+	box_set_vinyl_page_cache();
 	box_set_vinyl_timeout();
+	box_set_vinyl_compression_dict();
 }
 
 /**
@@ -5159,6 +6426,18 @@ bootstrap(bool *is_bootstrap_leader)
 	}
 }
 
+/** Statistics of the last local recovery, see box_recovery_stat(). */
+static struct {
+	/** Total time of local recovery, in seconds. */
+	double time;
+	/** Time spent replaying WAL files, in seconds. */
+	double wal_time;
+	/** Number of rows replayed from WAL files. */
+	int64_t wal_rows;
+	/** Size of replayed WAL files, in bytes. */
+	int64_t wal_bytes;
+} recovery_stat;
+
 /**
  * Recover the instance from the local directory.
  * Enter hot standby if the directory is locked.
@@ -5170,6 +6449,7 @@ static void
 local_recovery(const struct vclock *checkpoint_vclock)
 {
 	assert(!tt_uuid_is_nil(&INSTANCE_UUID));
+	double recovery_start = ev_monotonic_time();
 	struct tt_uuid instance_uuid;
 	if (box_check_instance_uuid(&instance_uuid) != 0)
 		diag_raise();
@@ -5273,7 +6553,14 @@ local_recovery(const struct vclock *checkpoint_vclock)
 	box_run_on_recovery_state(RECOVERY_STATE_SNAPSHOT_RECOVERED);
 
 	engine_begin_final_recovery_xc();
+	double replay_start = ev_monotonic_time();
+	int64_t replay_row_count = wal_stream.base.row_count;
 	recover_remaining_wals(recovery, &wal_stream.base, NULL, false);
+	recovery_stat.wal_time = ev_monotonic_time() - replay_start;
+	recovery_stat.wal_rows = wal_stream.base.row_count - replay_row_count;
+	recovery_stat.wal_bytes = recovery->wal_read_size;
+	gc_set_wal_replay_rate(recovery->wal_read_size,
+			       recovery_stat.wal_time);
 	if (wal_stream_has_unfinished_tx(&wal_stream)) {
 		diag_set(XlogError, "found a not finished transaction "
 			 "in the log");
@@ -5370,9 +6657,48 @@ local_recovery(const struct vclock *checkpoint_vclock)
 	engine_end_recovery_xc();
 	if (check_global_ids_integrity() != 0)
 		diag_raise();
+	recovery_stat.time = ev_monotonic_time() - recovery_start;
 	box_run_on_recovery_state(RECOVERY_STATE_WAL_RECOVERED);
 }
 
+/** Rows processed per second or 0 if the time is unknown. */
+static double
+recovery_stat_rps(int64_t rows, double time)
+{
+	return time > 0 ? rows / time : 0;
+}
+
+void
+box_recovery_stat(struct info_handler *h)
+{
+	struct memtx_engine *memtx =
+		(struct memtx_engine *)engine_by_name("memtx");
+	const struct memtx_recovery_stat *memtx_stat = &memtx->recovery_stat;
+	info_begin(h);
+	info_append_double(h, "time", recovery_stat.time);
+	info_table_begin(h, "snapshot");
+	info_append_double(h, "time", memtx_stat->snapshot_time);
+	info_append_int(h, "rows", memtx_stat->snapshot_rows);
+	info_append_double(h, "rps",
+			   recovery_stat_rps(memtx_stat->snapshot_rows,
+					     memtx_stat->snapshot_time));
+	info_table_end(h);
+	info_table_begin(h, "wal");
+	info_append_double(h, "time", recovery_stat.wal_time);
+	info_append_int(h, "rows", recovery_stat.wal_rows);
+	info_append_int(h, "bytes", recovery_stat.wal_bytes);
+	info_append_double(h, "rps",
+			   recovery_stat_rps(recovery_stat.wal_rows,
+					     recovery_stat.wal_time));
+	info_table_end(h);
+	info_table_begin(h, "memtx");
+	info_append_double(h, "pk_build_time", memtx_stat->pk_build_time);
+	info_append_double(h, "sk_build_time", memtx_stat->sk_build_time);
+	info_table_end(h);
+	vinyl_engine_recovery_stat(engine_by_name("vinyl"), h);
+	info_end(h);
+}
+
 static void
 tx_prio_cb(struct ev_loop *loop, ev_watcher *watcher, int events)
 {
@@ -5432,6 +6758,14 @@ box_cfg_xc(void)
 	if (box_set_prepared_stmt_cache_size() != 0)
 		diag_raise();
 	box_set_net_msg_max();
+	box_set_net_msg_max_auto();
+	box_set_net_msg_max_per_connection();
+	box_set_net_batch_delay();
+	box_set_iproto_read_view_staleness();
+	box_set_watch_notify_interval();
+	box_set_expiration_rate();
+	if (box_set_metrics_listen() != 0)
+		diag_raise();
 	box_set_readahead();
 	box_set_too_long_threshold();
 	box_set_replication_timeout();
@@ -5447,8 +6781,12 @@ box_cfg_xc(void)
 		diag_raise();
 	if (box_set_replication_synchro_timeout() != 0)
 		diag_raise();
+	if (box_set_replication_synchro_confirm_delay() != 0)
+		diag_raise();
 	box_set_replication_sync_timeout();
 	box_set_replication_skip_conflict();
+	if (box_set_replication_apply_fibers() != 0)
+		diag_raise();
 	if (box_check_instance_name(cfg_instance_name) != 0)
 		diag_raise();
 	cfg_replication_anon = box_check_replication_anon();
@@ -5899,6 +7237,15 @@ static void
 box_storage_init(void)
 {
 	assert(!is_storage_initialized);
+	/*
+	 * Bind the tx thread to its CPUs before creating the engines
+	 * so that the memory it touches first, including the memtx
+	 * arena, is allocated on the NUMA nodes of these CPUs.
+	 */
+	struct tt_cpu_set cpus;
+	if (box_check_cpus("tx_cpus", &cpus) > 0 &&
+	    tt_cpu_set_bind_thread(&cpus) != 0)
+		diag_raise();
 	/* Join the cord interconnect as "tx" endpoint. */
 	fiber_pool_create(&tx_fiber_pool, "tx",
 			  IPROTO_MSG_MAX_MIN * IPROTO_FIBER_POOL_SIZE_FACTOR,
@@ -5910,12 +7257,21 @@ box_storage_init(void)
 	rmean_box = rmean_new(iproto_type_strs, IPROTO_TYPE_STAT_MAX);
 	rmean_error = rmean_new(rmean_error_strings, RMEAN_ERROR_LAST);
 
+	if (xlog_reaper_start() != 0)
+		diag_raise();
 	gc_init(on_garbage_collection);
 	engine_init();
 	schema_init();
+	expire_init();
+	metrics_export_init();
+	upsert_buffer_init();
 	replication_init(cfg_geti_default("replication_threads", 1));
+	if (box_check_cpus("relay_cpus", &cpus) > 0)
+		relay_set_cpu_set(&cpus);
 	port_init();
-	iproto_init(cfg_geti("iproto_threads"));
+	iproto_init(cfg_geti("iproto_threads"),
+		    box_check_cpus("iproto_cpus", &cpus) > 0 ? &cpus : NULL,
+		    cfg_getb("iproto_reuseport"));
 	sql_init();
 	audit_log_init();
 	security_cfg();
@@ -5924,12 +7280,25 @@ box_storage_init(void)
 		cfg_geti64("wal_max_size"));
 	enum wal_mode wal_mode = box_check_wal_mode(cfg_gets("wal_mode"));
 	double wal_retention_period = box_check_wal_retention_period_xc();
-	if (wal_init(wal_mode, cfg_gets("wal_dir"), wal_max_size,
-		     wal_retention_period, &INSTANCE_UUID,
+	int wal_spare_count = box_check_wal_spare_files();
+	if (wal_spare_count < 0)
+		diag_raise();
+	if (wal_init(wal_mode, cfg_getb("wal_sync_pipeline"),
+		     cfg_getb("wal_relay_before_sync"), cfg_gets("wal_dir"),
+		     wal_max_size, wal_retention_period, wal_spare_count,
+		     &INSTANCE_UUID,
+		     box_check_cpus("wal_cpus", &cpus) > 0 ? &cpus : NULL,
 		     on_wal_garbage_collection,
 		     on_wal_checkpoint_threshold) != 0) {
 		diag_raise();
 	}
+	/*
+	 * Must be set before the first row is written to the WAL,
+	 * because it affects the current WAL file as well.
+	 */
+	box_set_wal_compression();
+	if (box_set_wal_relay_buffer_size() != 0)
+		diag_raise();
 	is_storage_initialized = true;
 }
 
@@ -5940,10 +7309,14 @@ box_storage_free(void)
 		return;
 	iproto_free();
 	replication_free();
+	metrics_export_free();
+	expire_free();
+	upsert_buffer_free();
 	gc_free();
 	engine_free();
 	/* schema_free(); */
 	wal_free();
+	xlog_reaper_stop();
 	flightrec_free();
 	audit_log_free();
 	sql_built_in_functions_cache_free();
@@ -6013,6 +7386,7 @@ box_storage_shutdown()
 		diag_log();
 		panic("cannot gracefully shutdown client fibers");
 	}
+	upsert_buffer_shutdown();
 	replication_shutdown();
 	gc_shutdown();
 	engine_shutdown();
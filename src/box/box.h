@@ -54,6 +54,7 @@ struct space;
 struct vclock;
 struct key_def;
 struct ballot;
+struct info_handler;
 
 /**
  * Pointer to TX thread local vclock.
@@ -141,6 +142,13 @@ box_is_configured(void);
 int
 box_check_configured(void);
 
+/**
+ * Report durations and volumes of the local recovery phases
+ * (box.info.recovery()).
+ */
+void
+box_recovery_stat(struct info_handler *h);
+
 /** Check if the slice of main cord has expired. */
 int
 box_check_slice_slow(void);
@@ -321,19 +329,31 @@ int box_listen(void);
 void box_set_replication(void);
 void box_set_io_collect_interval(void);
 void box_set_snap_io_rate_limit(void);
+int box_set_gc_io_rate_limit(void);
+void box_set_memtx_checkpoint_threads(void);
+void box_set_memtx_join_threads(void);
+void box_set_memtx_checkpoint_compression(void);
+void box_set_memtx_checkpoint_direct_io(void);
 void box_set_too_long_threshold(void);
 void box_set_readahead(void);
 void box_set_checkpoint_count(void);
 void box_set_checkpoint_interval(void);
 void box_set_checkpoint_wal_threshold(void);
+int box_set_checkpoint_recovery_time(void);
+void box_set_wal_compression(void);
 int box_set_wal_queue_max_size(void);
+int box_set_wal_relay_buffer_size(void);
 int box_set_wal_cleanup_delay(void);
 void box_set_memtx_memory(void);
 void box_set_memtx_max_tuple_size(void);
+void box_set_memtx_defrag_threshold(void);
+void box_set_memtx_evict_threshold(void);
 void box_set_vinyl_memory(void);
 void box_set_vinyl_max_tuple_size(void);
 void box_set_vinyl_cache(void);
+void box_set_vinyl_page_cache(void);
 void box_set_vinyl_timeout(void);
+void box_set_vinyl_compression_dict(void);
 void box_set_force_recovery(void);
 int box_set_election_mode(void);
 int box_set_election_timeout(void);
@@ -345,13 +365,22 @@ void box_set_replication_sync_lag(void);
 void box_update_replication_synchro_quorum(void);
 int box_set_replication_synchro_quorum(void);
 int box_set_replication_synchro_timeout(void);
+int box_set_replication_synchro_confirm_delay(void);
 void box_set_replication_sync_timeout(void);
 void box_set_replication_skip_conflict(void);
+int box_set_replication_apply_fibers(void);
 void box_set_replication_anon(void);
 void box_set_instance_name(void);
 void box_set_replicaset_name(void);
 void box_set_cluster_name(void);
 void box_set_net_msg_max(void);
+void box_set_net_msg_max_auto(void);
+void box_set_net_msg_max_per_connection(void);
+void box_set_net_batch_delay(void);
+void box_set_iproto_read_view_staleness(void);
+void box_set_expiration_rate(void);
+int box_set_metrics_listen(void);
+void box_set_watch_notify_interval(void);
 int box_set_prepared_stmt_cache_size(void);
 int box_set_feedback(void);
 int box_set_txn_timeout(void);
@@ -359,6 +388,24 @@ int box_set_txn_isolation(void);
 int box_set_auth_type(void);
 int box_set_bootstrap_strategy(void);
 
+/** Statistics of the tx fiber pool. */
+struct box_tx_fiber_pool_stat {
+	/** The number of fibers in the pool. */
+	int size;
+	/** The number of fibers working on a message. */
+	int busy;
+	/** The limit on the number of fibers. */
+	int max_size;
+	/** The number of times messages waited for a free fiber. */
+	int64_t stall_count;
+	/** Total time messages waited for a free fiber, in seconds. */
+	double stall_time;
+};
+
+/** Get statistics of the tx fiber pool. */
+void
+box_tx_fiber_pool_stat(struct box_tx_fiber_pool_stat *stat);
+
 /**
  * Initialize logger on box init.
  */
@@ -384,6 +431,13 @@ box_demote(void);
 int
 box_promote_qsync(void);
 
+/**
+ * Wait until this instance's vclock reaches @a vclock or @a deadline is
+ * reached. The 0th component of @a vclock is ignored.
+ */
+int
+box_wait_vclock(const struct vclock *vclock, double deadline);
+
 /**
  * Wait for a linearization point. That is, wait until every operation that
  * might be committed on a quorum at the moment this function is called, reaches
@@ -429,6 +483,15 @@ box_make_bootstrap_leader(void);
  * If update_pos is true, packed_pos and packed_pos_end are updated to
  * position of last selected tuple. Returned position is allocated
  * on the fiber region.
+ * If fields is not NULL, it is a MsgPack array of 0-based field numbers
+ * and field names or JSON paths, and each selected tuple is replaced with
+ * a tuple of the runtime format that consists of these fields.
+ * If filter is not NULL, it is a MsgPack filter expression, and only
+ * tuples matching it are selected. The offset and the limit are applied
+ * to the matching tuples. See box_select_filter_decode() for the format.
+ * If borrow_tuples is true, tuples selected from a memtx space aren't
+ * referenced by the port, see port_c_create_borrowed(), so the caller
+ * must dump and destroy the port without yielding.
  * Pre-requesites: if update_pos is true, packed_pos and packed_pos_end must
  * not be NULL.
  */
@@ -436,8 +499,20 @@ int
 box_select(uint32_t space_id, uint32_t index_id,
 	   int iterator, uint32_t offset, uint32_t limit,
 	   const char *key, const char *key_end,
+	   const char *fields, const char *fields_end,
+	   const char *filter, const char *filter_end,
 	   const char **packed_pos, const char **packed_pos_end,
-	   bool update_pos, struct port *port);
+	   bool update_pos, bool borrow_tuples, struct port *port);
+
+/**
+ * Hint the index that the given keys are going to be selected with
+ * box_select() soon, see index_prefetch(). The keys are passed as a
+ * sequence of @a key_count MsgPack arrays. Returns -1 only if the
+ * space or the index doesn't exist or the user has no access to it.
+ */
+int
+box_index_prefetch(uint32_t space_id, uint32_t index_id,
+		   const char *keys, uint32_t key_count);
 
 /** \cond public */
 
@@ -574,6 +649,36 @@ API_EXPORT int
 box_replace(uint32_t space_id, const char *tuple, const char *tuple_end,
 	    box_tuple_t **result);
 
+/**
+ * Execute INSERT requests for each tuple of a MsgPack array.
+ *
+ * The tuples are inserted atomically. Outside of a transaction they
+ * are inserted in one transaction, which is written to WAL as one
+ * entry. Within a transaction, the tuples inserted by the batch are
+ * rolled back on failure while the rest of the transaction is kept.
+ *
+ * \param space_id space identifier
+ * \param tuples encoded array of tuples ([ tuple1, tuple2, ...])
+ * \param tuples_end end of @a tuples
+ * \param[out] count the number of inserted tuples. Can be set to NULL.
+ * \retval -1 on error (check box_error_last())
+ * \retval 0 on success
+ * \sa \code box.space[space_id]:insert_many(tuples) \endcode
+ */
+API_EXPORT int
+box_insert_batch(uint32_t space_id, const char *tuples,
+		 const char *tuples_end, uint32_t *count);
+
+/**
+ * Execute REPLACE requests for each tuple of a MsgPack array.
+ * Same as box_insert_batch() otherwise.
+ *
+ * \sa \code box.space[space_id]:replace_many(tuples) \endcode
+ */
+API_EXPORT int
+box_replace_batch(uint32_t space_id, const char *tuples,
+		  const char *tuples_end, uint32_t *count);
+
 /**
  * Execute an DELETE request.
  *
@@ -115,6 +115,18 @@ sql_stmt_schema_version_is_valid(struct Vdbe *stmt)
 	return sql_stmt_schema_version(stmt) == box_schema_version();
 }
 
+/**
+ * Return true if a statement kept after an unprepared execution
+ * may be executed again: neither the schema nor the session SQL
+ * flags it was compiled with have changed since then.
+ */
+static bool
+sql_stmt_is_reusable(struct Vdbe *stmt)
+{
+	return sql_stmt_schema_version_is_valid(stmt) &&
+	       sql_stmt_flags(stmt) == current_session()->sql_flags;
+}
+
 /**
  * Re-compile statement and refresh global prepared statement
  * cache with the newest value.
@@ -270,12 +282,18 @@ sql_prepare_and_execute(const char *sql, int len, const struct sql_bind *bind,
 			uint32_t bind_count, struct port *port,
 			struct region *region)
 {
-	struct Vdbe *stmt;
-	if (sql_stmt_compile(sql, len, NULL, &stmt, NULL) != 0)
+	struct Vdbe *stmt = sql_stmt_cache_take(sql, len);
+	if (stmt != NULL && !sql_stmt_is_reusable(stmt)) {
+		sql_stmt_finalize(stmt);
+		stmt = NULL;
+	}
+	if (stmt == NULL &&
+	    sql_stmt_compile(sql, len, NULL, &stmt, NULL) != 0)
 		return -1;
 	assert(stmt != NULL);
 	enum sql_serialization_format format = sql_column_count(stmt) > 0 ?
 					   DQL_EXECUTE : DML_EXECUTE;
+	/* The statement is kept for reuse when the port is destroyed. */
 	port_sql_create(port, stmt, format, true);
 	if (sql_bind(stmt, bind, bind_count) == 0 &&
 	    sql_execute(stmt, port, region) == 0)
@@ -0,0 +1,277 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2026, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#include "expire.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "box.h"
+#include "clock.h"
+#include "datetime.h"
+#include "diag.h"
+#include "fiber.h"
+#include "index.h"
+#include "iterator_type.h"
+#include "key_def.h"
+#include "mp_datetime.h"
+#include "msgpuck.h"
+#include "say.h"
+#include "small/region.h"
+#include "space.h"
+#include "trivia/util.h"
+#include "tuple.h"
+#include "txn.h"
+
+enum {
+	/** Max number of tuples deleted in one transaction. */
+	EXPIRE_BATCH_SIZE = 1000,
+	/** Size of the buffer for the expiration time key. */
+	EXPIRE_KEY_SIZE_MAX = 64,
+};
+
+/** Pause between two passes over expirable spaces, in seconds. */
+static const double EXPIRE_PERIOD = 1;
+
+static struct {
+	/** Fiber that deletes expired tuples. */
+	struct fiber *fiber;
+	/** Max number of tuples deleted per second, 0 if disabled. */
+	double rate;
+	/** Ids of spaces with the expire_field option set. */
+	uint32_t *space_ids;
+	/** Number of entries in space_ids. */
+	uint32_t space_count;
+	/** Capacity of space_ids. */
+	uint32_t space_capacity;
+} expire;
+
+/** Returns true if the expiration fiber may delete tuples now. */
+static inline bool
+expire_is_enabled(void)
+{
+	return expire.rate > 0 && box_is_configured() && !box_is_ro() &&
+	       !fiber_is_cancelled();
+}
+
+/**
+ * Returns the index used for looking up expired tuples of the given
+ * space or NULL if the space doesn't have a suitable index.
+ */
+static struct index *
+expire_index(struct space *space)
+{
+	uint32_t fieldno = space->def->opts.expire_field;
+	for (uint32_t i = 0; i < space->index_count; i++) {
+		struct index *index = space->index[i];
+		struct key_def *key_def = index->def->key_def;
+		struct key_part *part = &key_def->parts[0];
+		if (index->def->type == TREE && !key_def->is_multikey &&
+		    !key_def->for_func_index && part->fieldno == fieldno &&
+		    part->path == NULL &&
+		    expire_field_type_is_supported(part->type))
+			return index;
+	}
+	return NULL;
+}
+
+/**
+ * Encodes the current time as a key of an index part of the given type.
+ * Returns the end of the encoded key.
+ */
+static char *
+expire_key_encode(char *data, enum field_type type)
+{
+	double now = clock_realtime();
+	data = mp_encode_array(data, 1);
+	switch (type) {
+	case FIELD_TYPE_UNSIGNED:
+	case FIELD_TYPE_INTEGER:
+		return mp_encode_uint(data, (uint64_t)now);
+	case FIELD_TYPE_NUMBER:
+	case FIELD_TYPE_DOUBLE:
+		return mp_encode_double(data, now);
+	case FIELD_TYPE_DATETIME: {
+		struct datetime date;
+		memset(&date, 0, sizeof(date));
+		date.epoch = floor(now);
+		date.nsec = (now - date.epoch) * 1e9;
+		return mp_encode_datetime(data, &date);
+	}
+	default:
+		unreachable();
+	}
+	return data;
+}
+
+static int
+expire_collect_space(struct space *space, void *arg)
+{
+	(void)arg;
+	if (space->def->opts.expire_field == UINT32_MAX)
+		return 0;
+	if (expire.space_count == expire.space_capacity) {
+		uint32_t capacity = MAX(expire.space_capacity * 2, 16);
+		expire.space_ids = xrealloc(expire.space_ids,
+					    capacity * sizeof(uint32_t));
+		expire.space_capacity = capacity;
+	}
+	expire.space_ids[expire.space_count++] = space->def->id;
+	return 0;
+}
+
+/**
+ * Deletes up to @a limit expired tuples from the given space in one
+ * transaction. Returns the number of deleted tuples or -1 on
+ * error. Tuples are looked up and deleted in the same transaction so
+ * that a concurrent update of the expiration time can't be overwritten.
+ */
+static int
+expire_space_batch(uint32_t space_id, int limit)
+{
+	assert(limit <= EXPIRE_BATCH_SIZE);
+	struct space *space = space_by_id(space_id);
+	if (space == NULL || space->def->opts.expire_field == UINT32_MAX)
+		return 0;
+	struct index *pk = space_index(space, 0);
+	struct index *index = expire_index(space);
+	if (pk == NULL || index == NULL)
+		return 0;
+	uint32_t index_id = index->def->iid;
+	uint32_t fieldno = space->def->opts.expire_field;
+	struct key_def *pk_def = pk->def->key_def;
+
+	char key[EXPIRE_KEY_SIZE_MAX];
+	char *key_end = expire_key_encode(key,
+					  index->def->key_def->parts[0].type);
+	assert(key_end <= key + sizeof(key));
+
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	const char *pks[EXPIRE_BATCH_SIZE];
+	uint32_t pk_sizes[EXPIRE_BATCH_SIZE];
+	int count = 0;
+	if (box_txn_begin() != 0)
+		return -1;
+	box_iterator_t *it = box_index_iterator(space_id, index_id, ITER_LE,
+						key, key_end);
+	if (it == NULL)
+		goto fail;
+	while (count < limit) {
+		struct tuple *tuple;
+		if (box_iterator_next(it, &tuple) != 0) {
+			box_iterator_free(it);
+			goto fail;
+		}
+		if (tuple == NULL)
+			break;
+		/* Tuples without expiration time never expire. */
+		const char *field = tuple_field(tuple, fieldno);
+		if (field == NULL || mp_typeof(*field) == MP_NIL)
+			break;
+		pks[count] = tuple_extract_key(tuple, pk_def, MULTIKEY_NONE,
+					       &pk_sizes[count]);
+		if (pks[count] == NULL) {
+			box_iterator_free(it);
+			goto fail;
+		}
+		count++;
+	}
+	box_iterator_free(it);
+	for (int i = 0; i < count; i++) {
+		if (box_delete(space_id, 0, pks[i], pks[i] + pk_sizes[i],
+			       NULL) != 0)
+			goto fail;
+	}
+	if (box_txn_commit() != 0)
+		goto fail_committed;
+	region_truncate(region, region_svp);
+	return count;
+fail:
+	box_txn_rollback();
+fail_committed:
+	region_truncate(region, region_svp);
+	return -1;
+}
+
+/**
+ * Deletes expired tuples from the given space, sleeping between
+ * batches so as not to exceed the configured rate.
+ */
+static void
+expire_space(uint32_t space_id)
+{
+	while (expire_is_enabled()) {
+		/* Don't delete more than a second's worth of tuples at once. */
+		int limit = MIN(MAX(expire.rate, 1), EXPIRE_BATCH_SIZE);
+		int count = expire_space_batch(space_id, limit);
+		if (count < 0) {
+			say_error("failed to delete expired tuples "
+				  "from space %u: %s", space_id,
+				  diag_last_error(diag_get())->errmsg);
+			diag_clear(diag_get());
+			return;
+		}
+		if (count == 0)
+			return;
+		fiber_sleep(count / expire.rate);
+		if (count < limit)
+			return;
+	}
+}
+
+static int
+expire_f(va_list ap)
+{
+	(void)ap;
+	while (!fiber_is_cancelled()) {
+		fiber_sleep(EXPIRE_PERIOD);
+		if (!expire_is_enabled())
+			continue;
+		expire.space_count = 0;
+		if (space_foreach(expire_collect_space, NULL) != 0) {
+			diag_log();
+			diag_clear(diag_get());
+			continue;
+		}
+		/* Spaces may be dropped while we yield, look them up by id. */
+		for (uint32_t i = 0; i < expire.space_count; i++)
+			expire_space(expire.space_ids[i]);
+	}
+	return 0;
+}
+
+void
+expire_init(void)
+{
+	expire.fiber = fiber_new_system("expire", expire_f);
+	if (expire.fiber == NULL)
+		panic("failed to start the expiration fiber");
+	fiber_wakeup(expire.fiber);
+}
+
+void
+expire_free(void)
+{
+	if (expire.fiber != NULL) {
+		fiber_cancel(expire.fiber);
+		expire.fiber = NULL;
+	}
+	free(expire.space_ids);
+	expire.space_ids = NULL;
+	expire.space_count = 0;
+	expire.space_capacity = 0;
+}
+
+void
+expire_set_rate(double rate)
+{
+	assert(rate >= 0);
+	expire.rate = rate;
+}
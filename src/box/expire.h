@@ -0,0 +1,66 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2026, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#pragma once
+
+#include <stdbool.h>
+
+#include "field_def.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+/**
+ * Built-in tuple expiration.
+ *
+ * A space may name one of its fields as the tuple expiration time with
+ * the expire_field option. The field stores either the number of seconds
+ * since the Epoch or a datetime. A system fiber periodically looks up
+ * tuples whose expiration time is in the past and deletes them.
+ *
+ * To find expired tuples without a full scan, the fiber uses a TREE
+ * index whose first part is the expiration field, so a pass costs
+ * O(expired tuples) rather than O(space size). A space without such
+ * an index is skipped. Expired tuples are deleted in batches, one
+ * transaction (and hence one WAL entry) per batch, at a rate limited
+ * by box.cfg.expiration_rate. Tuples are only deleted on a writable
+ * instance, replicas receive the deletions via replication.
+ */
+
+/** Returns true if a field of the given type may store expiration time. */
+static inline bool
+expire_field_type_is_supported(enum field_type type)
+{
+	switch (type) {
+	case FIELD_TYPE_UNSIGNED:
+	case FIELD_TYPE_INTEGER:
+	case FIELD_TYPE_NUMBER:
+	case FIELD_TYPE_DOUBLE:
+	case FIELD_TYPE_DATETIME:
+		return true;
+	default:
+		return false;
+	}
+}
+
+/** Starts the expiration fiber. */
+void
+expire_init(void);
+
+/** Stops the expiration fiber. */
+void
+expire_free(void);
+
+/**
+ * Sets the max number of expired tuples deleted per second.
+ * Zero disables expiration.
+ */
+void
+expire_set_rate(double rate);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
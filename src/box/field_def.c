@@ -291,6 +291,37 @@ const uint64_t field_type_max_value[] = {
 static_assert(lengthof(field_type_max_value) == field_type_MAX,
 	      "Each field type must be present in field_type_max_value");
 
+const uint32_t field_type_mp_fixed_size[] = {
+	/* [FIELD_TYPE_ANY]       = */ 0,
+	/* [FIELD_TYPE_UNSIGNED]  = */ 0,
+	/* [FIELD_TYPE_STRING]    = */ 0,
+	/* [FIELD_TYPE_NUMBER]    = */ 0,
+	/* [FIELD_TYPE_DOUBLE]    = */ 0,
+	/* [FIELD_TYPE_INTEGER]   = */ 0,
+	/* [FIELD_TYPE_BOOLEAN]   = */ 1,
+	/* [FIELD_TYPE_VARBINARY] = */ 0,
+	/* [FIELD_TYPE_SCALAR]    = */ 0,
+	/* [FIELD_TYPE_DECIMAL]   = */ 0,
+	/* [FIELD_TYPE_UUID]      = */ 0,
+	/* [FIELD_TYPE_DATETIME]  = */ 0,
+	/* [FIELD_TYPE_INTERVAL]  = */ 0,
+	/* [FIELD_TYPE_ARRAY]     = */ 0,
+	/* [FIELD_TYPE_MAP]       = */ 0,
+	/* [FIELD_TYPE_INT8]      = */ 0,
+	/* [FIELD_TYPE_UINT8]     = */ 0,
+	/* [FIELD_TYPE_INT16]     = */ 0,
+	/* [FIELD_TYPE_UINT16]    = */ 0,
+	/* [FIELD_TYPE_INT32]     = */ 0,
+	/* [FIELD_TYPE_UINT32]    = */ 0,
+	/* [FIELD_TYPE_INT64]     = */ 0,
+	/* [FIELD_TYPE_UINT64]    = */ 0,
+	/* [FIELD_TYPE_FLOAT32]   = */ 5,
+	/* [FIELD_TYPE_FLOAT64]   = */ 9,
+};
+
+static_assert(lengthof(field_type_mp_fixed_size) == field_type_MAX, "Each "
+	      "field type must be present in field_type_mp_fixed_size");
+
 const char *on_conflict_action_strs[] = {
 	/* [ON_CONFLICT_ACTION_NONE]     = */ "none",
 	/* [ON_CONFLICT_ACTION_ROLLBACK] = */ "rollback",
@@ -104,6 +104,11 @@ extern const bool field_type_is_fixed_signed[];
 extern const bool field_type_is_fixed_unsigned[];
 extern const int64_t field_type_min_value[];
 extern const uint64_t field_type_max_value[];
+/**
+ * MsgPack size of any value of the given field type or 0 if values of
+ * the type may be encoded with different sizes.
+ */
+extern const uint32_t field_type_mp_fixed_size[];
 
 extern const char *on_conflict_action_strs[];
 
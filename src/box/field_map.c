@@ -123,3 +123,16 @@ field_map_build(struct field_map_builder *builder, char *buffer)
 	}
 	assert(extent_wptr == buffer + builder->extents_size);
 }
+
+bool
+field_map_builder_equals(struct field_map_builder *builder,
+			 const uint32_t *field_map)
+{
+	assert(builder->extents_size == 0);
+	for (int32_t i = -1; i >= -(int32_t)builder->slot_count; i--) {
+		assert(!builder->slots[i].has_extent);
+		if (load_u32(&field_map[i]) != builder->slots[i].offset)
+			return false;
+	}
+	return true;
+}
@@ -31,6 +31,7 @@
  * SUCH DAMAGE.
  */
 #include <assert.h>
+#include <stdbool.h>
 #include <stdint.h>
 #include <stddef.h>
 #include "bit/bit.h"
@@ -261,6 +262,16 @@ field_map_build_size(struct field_map_builder *builder)
 void
 field_map_build(struct field_map_builder *builder, char *buffer);
 
+/**
+ * Check if the field map constructed by the builder is equal to
+ * the given one. The builder must not have extents.
+ *
+ * @param field_map A pointer to the end of the field map.
+ */
+bool
+field_map_builder_equals(struct field_map_builder *builder,
+			 const uint32_t *field_map);
+
 #endif /* TARANTOOL_BOX_FIELD_MAP_H_INCLUDED */
 
 #if defined(__cplusplus)
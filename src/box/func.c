@@ -584,36 +584,82 @@ func_access_check(struct func *func)
 	return 0;
 }
 
+/**
+ * Change the current user id if the function is a set-definer-uid one.
+ * The original credentials to restore after the call are returned in
+ * @a orig_credentials, which is set to NULL if they weren't changed.
+ */
+static int
+func_set_owner_credentials(struct func *base,
+			   struct credentials **orig_credentials)
+{
+	*orig_credentials = NULL;
+	if (!base->def->setuid)
+		return 0;
+	/* Remember and change the current user id. */
+	if (credentials_is_empty(&base->owner_credentials)) {
+		/*
+		 * Fill the cache upon first access, since
+		 * when func is created, no user may
+		 * be around to fill it (recovery of
+		 * system spaces from a snapshot).
+		 */
+		struct user *owner = user_find(base->def->uid);
+		if (owner == NULL)
+			return -1;
+		credentials_reset(&base->owner_credentials, owner);
+	}
+	*orig_credentials = effective_user();
+	fiber_set_user(fiber(), &base->owner_credentials);
+	return 0;
+}
+
 int
 func_call_no_access_check(struct func *base, struct port *args,
 			  struct port *ret)
 {
-	/**
-	 * Change the current user id if the function is
-	 * a set-definer-uid one. If the function is not
-	 * defined, it's obviously not a setuid one.
-	 */
-	struct credentials *orig_credentials = NULL;
-	if (base->def->setuid) {
-		orig_credentials = effective_user();
-		/* Remember and change the current user id. */
-		if (credentials_is_empty(&base->owner_credentials)) {
-			/*
-			 * Fill the cache upon first access, since
-			 * when func is created, no user may
-			 * be around to fill it (recovery of
-			 * system spaces from a snapshot).
-			 */
-			struct user *owner = user_find(base->def->uid);
-			if (owner == NULL)
-				return -1;
-			credentials_reset(&base->owner_credentials, owner);
-		}
-		fiber_set_user(fiber(), &base->owner_credentials);
-	}
+	struct credentials *orig_credentials;
+	if (func_set_owner_credentials(base, &orig_credentials) != 0)
+		return -1;
 	int rc = base->vtab->call(base, args, ret);
 	/* Restore the original user */
 	if (orig_credentials)
 		fiber_set_user(fiber(), orig_credentials);
 	return rc;
 }
+
+/** Call the function for each of the given ports one by one. */
+static int
+func_call_batch_generic(struct func *base, struct port *args, uint32_t count,
+			struct func_batch_result *results)
+{
+	for (uint32_t i = 0; i < count; i++) {
+		struct port ret;
+		if (base->vtab->call(base, &args[i], &ret) != 0)
+			return -1;
+		results[i].data = port_get_msgpack(&ret, &results[i].size);
+		port_destroy(&ret);
+		if (results[i].data == NULL)
+			return -1;
+	}
+	return 0;
+}
+
+int
+func_call_batch_no_access_check(struct func *base, struct port *args,
+				uint32_t count,
+				struct func_batch_result *results)
+{
+	struct credentials *orig_credentials;
+	if (func_set_owner_credentials(base, &orig_credentials) != 0)
+		return -1;
+	int rc;
+	if (base->vtab->call_batch != NULL)
+		rc = base->vtab->call_batch(base, args, count, results);
+	else
+		rc = func_call_batch_generic(base, args, count, results);
+	/* Restore the original user */
+	if (orig_credentials)
+		fiber_set_user(fiber(), orig_credentials);
+	return rc;
+}
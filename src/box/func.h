@@ -45,10 +45,23 @@ extern "C" {
 
 struct func;
 
+/** MsgPack array of values returned by a function call. */
+struct func_batch_result {
+	const char *data;
+	uint32_t size;
+};
+
 /** Virtual method table for func object. */
 struct func_vtab {
 	/** Call function with given arguments. */
 	int (*call)(struct func *func, struct port *args, struct port *ret);
+	/**
+	 * Call function once for each of @a count argument ports,
+	 * see func_call_batch_no_access_check(). Optional: if not
+	 * set, the function is called with call() one by one.
+	 */
+	int (*call_batch)(struct func *func, struct port *args, uint32_t count,
+			  struct func_batch_result *results);
 	/** Release implementation-specific function context. */
 	void (*destroy)(struct func *func);
 };
@@ -114,6 +127,20 @@ int
 func_call_no_access_check(struct func *func, struct port *args,
 			  struct port *ret);
 
+/**
+ * Call function @a func once for each of @a count ports stored in
+ * the @a args array. On success the values returned by the i-th call
+ * are stored in @a results[i] as a MsgPack array allocated on the
+ * fiber region. Unlike calling the function @a count times, the
+ * setup common to all calls (switching credentials, creating a Lua
+ * thread) is done only once.
+ * Return 0 on success and nonzero on failure of any of the calls.
+ */
+int
+func_call_batch_no_access_check(struct func *func, struct port *args,
+				uint32_t count,
+				struct func_batch_result *results);
+
 static inline int
 func_call(struct func *func, struct port *args, struct port *ret)
 {
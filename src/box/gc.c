@@ -58,6 +58,16 @@
 #include "checkpoint_schedule.h"
 #include "txn_limbo.h"
 
+enum {
+	/**
+	 * WAL replay throughput assumed until it's measured on local
+	 * recovery, in bytes per second.
+	 */
+	GC_WAL_REPLAY_RATE_DEFAULT = 32 * 1024 * 1024,
+	/** Min size of WAL replay used to measure the throughput. */
+	GC_WAL_REPLAY_SIZE_MIN = 16 * 1024 * 1024,
+};
+
 struct gc_state gc;
 
 static int
@@ -117,6 +127,8 @@ gc_init(on_garbage_collection_f on_garbage_collection)
 	gc_tree_new(&gc.consumers);
 	fiber_cond_create(&gc.cleanup_cond);
 	checkpoint_schedule_cfg(&gc.checkpoint_schedule, 0, 0);
+	gc.checkpoint_wal_threshold = INT64_MAX;
+	gc.last_checkpoint_time = ev_monotonic_now(loop());
 
 	gc.cleanup_fiber = fiber_new_system("gc", gc_cleanup_fiber_f);
 	if (gc.cleanup_fiber == NULL)
@@ -454,6 +466,62 @@ gc_set_checkpoint_interval(double interval)
 		fiber_wakeup(gc.checkpoint_fiber);
 }
 
+/**
+ * Returns the size of WAL written since the last checkpoint that can be
+ * replayed in box.cfg.checkpoint_recovery_time or INT64_MAX if the time
+ * isn't limited.
+ */
+static int64_t
+gc_recovery_wal_threshold(void)
+{
+	if (gc.checkpoint_recovery_time <= 0)
+		return INT64_MAX;
+	double rate = gc.wal_replay_rate > 0 ? gc.wal_replay_rate :
+		      GC_WAL_REPLAY_RATE_DEFAULT;
+	double threshold = gc.checkpoint_recovery_time * rate;
+	/*
+	 * Until a checkpoint completes, the WAL written while it is in
+	 * progress has to be replayed on recovery, too, so start it
+	 * early enough for that WAL to fit in the time. Estimate the
+	 * size by the duration of the last checkpoint, but don't start
+	 * checkpoints more often than twice as needed.
+	 */
+	double reserve = gc.wal_write_rate * gc.checkpoint_duration;
+	threshold -= MIN(reserve, threshold / 2);
+	return threshold < (double)INT64_MAX ? (int64_t)threshold : INT64_MAX;
+}
+
+/** Passes the effective checkpoint WAL threshold to the WAL thread. */
+static void
+gc_update_checkpoint_wal_threshold(void)
+{
+	wal_set_checkpoint_threshold(MIN(gc.checkpoint_wal_threshold,
+					 gc_recovery_wal_threshold()));
+}
+
+void
+gc_set_checkpoint_wal_threshold(int64_t threshold)
+{
+	gc.checkpoint_wal_threshold = threshold;
+	gc_update_checkpoint_wal_threshold();
+}
+
+void
+gc_set_checkpoint_recovery_time(double recovery_time)
+{
+	gc.checkpoint_recovery_time = recovery_time;
+	gc_update_checkpoint_wal_threshold();
+}
+
+void
+gc_set_wal_replay_rate(int64_t size, double time)
+{
+	if (size < GC_WAL_REPLAY_SIZE_MIN || time <= 0)
+		return;
+	gc.wal_replay_rate = size / time;
+	say_info("WAL replay rate is %.1f MB/s", gc.wal_replay_rate / 1e6);
+}
+
 void
 gc_add_checkpoint(const struct vclock *vclock)
 {
@@ -488,6 +556,20 @@ gc_add_checkpoint(const struct vclock *vclock)
 	gc_schedule_cleanup();
 }
 
+/**
+ * Updates the checkpoint statistics used for estimating the WAL
+ * threshold, see gc_recovery_wal_threshold().
+ */
+static void
+gc_account_checkpoint(double start_time, int64_t wal_size)
+{
+	double now = ev_monotonic_now(loop());
+	gc.checkpoint_duration = now - start_time;
+	if (now > gc.last_checkpoint_time)
+		gc.wal_write_rate = wal_size / (now - gc.last_checkpoint_time);
+	gc.last_checkpoint_time = now;
+}
+
 static int
 gc_do_checkpoint(bool is_scheduled)
 {
@@ -497,6 +579,7 @@ gc_do_checkpoint(bool is_scheduled)
 
 	assert(!gc.checkpoint_is_in_progress);
 	gc.checkpoint_is_in_progress = true;
+	double start_time = ev_monotonic_now(loop());
 
 	/*
 	 * Rotate WAL and call engine callbacks to create a checkpoint
@@ -536,11 +619,15 @@ gc_do_checkpoint(bool is_scheduled)
 	 * collector state.
 	 */
 	gc_add_checkpoint(&checkpoint.vclock);
+	gc_account_checkpoint(start_time, checkpoint.wal_size);
 out:
 	if (rc != 0)
 		engine_abort_checkpoint();
 
 	gc.checkpoint_is_in_progress = false;
+	/* The threshold depends on the checkpoint duration. */
+	if (rc == 0 && gc.checkpoint_recovery_time > 0)
+		gc_update_checkpoint_wal_threshold();
 	return rc;
 }
 
@@ -179,6 +179,32 @@ struct gc_state {
 	 * a checkpoint as soon as possible despite the schedule.
 	 */
 	bool checkpoint_is_pending;
+	/**
+	 * Size of WAL written since the last checkpoint that triggers
+	 * a new checkpoint. Configured by box.cfg.checkpoint_wal_threshold.
+	 */
+	int64_t checkpoint_wal_threshold;
+	/**
+	 * Max time it may take to replay the WAL on recovery, in
+	 * seconds. Lowers the WAL threshold so that the WAL written
+	 * since the last checkpoint can be replayed in this time.
+	 * Configured by box.cfg.checkpoint_recovery_time. 0 if unset.
+	 */
+	double checkpoint_recovery_time;
+	/**
+	 * WAL replay throughput measured on local recovery, in bytes
+	 * per second. 0 if it hasn't been measured.
+	 */
+	double wal_replay_rate;
+	/**
+	 * WAL write throughput between the two last checkpoints,
+	 * in bytes per second.
+	 */
+	double wal_write_rate;
+	/** Duration of the last checkpoint, in seconds. */
+	double checkpoint_duration;
+	/** Monotonic time when the last checkpoint was completed. */
+	double last_checkpoint_time;
 };
 extern struct gc_state gc;
 
@@ -279,6 +305,31 @@ gc_set_min_checkpoint_count(int min_checkpoint_count);
 void
 gc_set_checkpoint_interval(double interval);
 
+/**
+ * Set the size of WAL written since the last checkpoint that
+ * triggers a new checkpoint.
+ */
+void
+gc_set_checkpoint_wal_threshold(int64_t threshold);
+
+/**
+ * Set the max time it may take to replay the WAL written since
+ * the last checkpoint on recovery, in seconds. The WAL size is
+ * estimated to keep within the time based on the WAL replay
+ * throughput, see gc_set_wal_replay_rate(). Setting the time to 0
+ * disables the limit.
+ */
+void
+gc_set_checkpoint_recovery_time(double recovery_time);
+
+/**
+ * Account a WAL replay of @a size bytes that took @a time seconds.
+ * Called on local recovery. Replays too small to give a reliable
+ * estimate are ignored.
+ */
+void
+gc_set_wal_replay_rate(int64_t size, double time);
+
 /**
  * Track an existing checkpoint in the garbage collector state.
  * Note, this function may trigger garbage collection to remove
@@ -0,0 +1,201 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2026, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#include "hot_key.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "diag.h"
+#include "fiber.h"
+#include "index.h"
+#include "iproto_constants.h"
+#include "key_def.h"
+#include "salad/wyhash.h"
+#include "small/region.h"
+#include "space.h"
+#include "space_cache.h"
+#include "tuple.h"
+#include "xrow.h"
+
+bool hot_key_is_enabled;
+
+uint32_t hot_key_sample_interval = 1;
+
+uint32_t hot_key_countdown = 1;
+
+void
+hot_key_stat_delete(struct hot_key_stat *stat)
+{
+	if (stat == NULL)
+		return;
+	for (uint32_t i = 0; i < stat->top_count; i++)
+		free(stat->top[i].data);
+	free(stat);
+}
+
+/**
+ * Return the statistics of an index, allocating them if needed.
+ * Statistics are not vital, so NULL is returned silently on memory
+ * error.
+ */
+static struct hot_key_stat *
+hot_key_stat_get(struct index *index)
+{
+	struct hot_key_stat *stat = index->hot_key_stat;
+	if (likely(stat != NULL))
+		return stat;
+	stat = calloc(1, sizeof(*stat));
+	if (stat == NULL)
+		return NULL;
+	stat->sample_interval = hot_key_sample_interval;
+	index->hot_key_stat = stat;
+	return stat;
+}
+
+/** Delete the statistics of the indexes of a space. */
+static int
+hot_key_clear_space(struct space *space, void *arg)
+{
+	(void)arg;
+	for (uint32_t i = 0; i < space->index_count; i++) {
+		struct index *index = space->index[i];
+		hot_key_stat_delete(index->hot_key_stat);
+		index->hot_key_stat = NULL;
+	}
+	return 0;
+}
+
+void
+hot_key_enable(uint32_t sample_interval)
+{
+	assert(sample_interval > 0);
+	/* Statistics collected with another interval can't be merged. */
+	if (sample_interval != hot_key_sample_interval)
+		hot_key_reset();
+	hot_key_sample_interval = sample_interval;
+	hot_key_countdown = sample_interval;
+	hot_key_is_enabled = true;
+}
+
+void
+hot_key_disable(void)
+{
+	hot_key_is_enabled = false;
+	hot_key_reset();
+}
+
+void
+hot_key_reset(void)
+{
+	space_foreach(hot_key_clear_space, NULL);
+}
+
+static int
+hot_key_cmp(const void *a, const void *b)
+{
+	const struct hot_key *key_a = a;
+	const struct hot_key *key_b = b;
+	if (key_a->count != key_b->count)
+		return key_a->count < key_b->count ? 1 : -1;
+	return 0;
+}
+
+void
+hot_key_stat_sort(struct hot_key_stat *stat)
+{
+	qsort(stat->top, stat->top_count, sizeof(stat->top[0]), hot_key_cmp);
+}
+
+/**
+ * Account a key with the given hash in the sketch and return the new
+ * estimate of the number of times it was sampled.
+ */
+static uint64_t
+hot_key_sketch_add(struct hot_key_stat *stat, uint64_t hash)
+{
+	/* Derive the row hashes from two halves of the hash. */
+	uint32_t h1 = hash;
+	uint32_t h2 = (hash >> 32) | 1;
+	uint32_t count = UINT32_MAX;
+	for (uint32_t i = 0; i < HOT_KEY_SKETCH_DEPTH; i++) {
+		uint32_t *counter =
+			&stat->sketch[i][(h1 + i * h2) &
+					 (HOT_KEY_SKETCH_WIDTH - 1)];
+		if (*counter < UINT32_MAX)
+			(*counter)++;
+		count = MIN(count, *counter);
+	}
+	return count;
+}
+
+void
+hot_key_collect(struct index *index, const char *key, const char *key_end)
+{
+	struct hot_key_stat *stat = hot_key_stat_get(index);
+	if (stat == NULL)
+		return;
+	uint32_t size = key_end - key;
+	uint64_t hash = wyhash(key, size, WYHASH_SEED);
+	uint64_t count = hot_key_sketch_add(stat, hash);
+	struct hot_key *coldest = NULL;
+	for (uint32_t i = 0; i < stat->top_count; i++) {
+		struct hot_key *top = &stat->top[i];
+		if (top->hash == hash && top->size == size &&
+		    memcmp(top->data, key, size) == 0) {
+			top->count = count;
+			return;
+		}
+		if (coldest == NULL || top->count < coldest->count)
+			coldest = top;
+	}
+	if (size > HOT_KEY_SIZE_MAX)
+		return;
+	if (stat->top_count < HOT_KEY_TOP_SIZE) {
+		coldest = &stat->top[stat->top_count];
+		coldest->data = NULL;
+	} else if (coldest->count >= count) {
+		return;
+	}
+	char *data = realloc(coldest->data, size);
+	if (data == NULL)
+		return;
+	memcpy(data, key, size);
+	coldest->data = data;
+	coldest->size = size;
+	coldest->hash = hash;
+	coldest->count = count;
+	if (coldest == &stat->top[stat->top_count])
+		stat->top_count++;
+}
+
+void
+hot_key_collect_write(struct space *space, struct request *request,
+		      struct tuple *tuple)
+{
+	struct index *pk = space_index(space, 0);
+	if (pk == NULL)
+		return;
+	struct key_def *pk_def = pk->def->key_def;
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	const char *key;
+	uint32_t size;
+	if (tuple != NULL) {
+		key = tuple_extract_key(tuple, pk_def, MULTIKEY_NONE, &size);
+	} else if (request->type == IPROTO_UPSERT) {
+		/* The tuple was validated by the engine. */
+		key = tuple_extract_key_raw(request->tuple, request->tuple_end,
+					    pk_def, MULTIKEY_NONE, &size);
+	} else {
+		return;
+	}
+	if (key != NULL)
+		hot_key_collect(pk, key, key + size);
+	else
+		diag_clear(diag_get());
+	region_truncate(region, region_svp);
+}
@@ -0,0 +1,132 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2026, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "trivia/util.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+struct index;
+struct request;
+struct space;
+struct tuple;
+
+/**
+ * Hot key detection.
+ *
+ * Once enabled with hot_key_enable(), every Nth get, iterator creation
+ * and write request is sampled. The key of a sampled request is hashed
+ * and accounted in a count-min sketch of the index the request targets,
+ * which estimates how many times the key was sampled in constant memory.
+ * The keys with the highest estimates are kept along with their MsgPack
+ * in a small top list: a key that isn't in the list replaces the coldest
+ * one if its estimate is greater, like in the space-saving algorithm.
+ *
+ * Iterators are accounted by their search key, so the list shows hot
+ * ranges as well. Writes are accounted to the primary index. The state
+ * is allocated on the first sample and is lost when the index is
+ * rebuilt. When disabled, a request costs a single branch.
+ */
+
+enum {
+	/** Number of the hottest keys kept per index. */
+	HOT_KEY_TOP_SIZE = 16,
+	/** Number of rows in the count-min sketch. */
+	HOT_KEY_SKETCH_DEPTH = 4,
+	/** Number of counters in a row of the sketch, a power of 2. */
+	HOT_KEY_SKETCH_WIDTH = 1024,
+	/** Keys larger than that are accounted but not listed. */
+	HOT_KEY_SIZE_MAX = 256,
+};
+
+/** A key in the top list. */
+struct hot_key {
+	/** Estimated number of times the key was sampled. */
+	uint64_t count;
+	/** Hash of the key. */
+	uint64_t hash;
+	/** Size of the key. */
+	uint32_t size;
+	/** Key MsgPack array, allocated with malloc(). */
+	char *data;
+};
+
+/** Hot key statistics of an index. */
+struct hot_key_stat {
+	/** Sample interval the statistics were collected with. */
+	uint32_t sample_interval;
+	/** Number of entries in top. */
+	uint32_t top_count;
+	/** The hottest keys, unordered. */
+	struct hot_key top[HOT_KEY_TOP_SIZE];
+	/** Count-min sketch of sampled keys. */
+	uint32_t sketch[HOT_KEY_SKETCH_DEPTH][HOT_KEY_SKETCH_WIDTH];
+};
+
+/** Set if hot keys are tracked. */
+extern bool hot_key_is_enabled;
+
+/** A request out of this many is sampled. */
+extern uint32_t hot_key_sample_interval;
+
+/** Number of requests left till the next sample. */
+extern uint32_t hot_key_countdown;
+
+/** Start tracking hot keys sampling every Nth request. */
+void
+hot_key_enable(uint32_t sample_interval);
+
+/** Stop tracking hot keys and free the statistics. */
+void
+hot_key_disable(void);
+
+/** Reset the hot key statistics of all indexes. */
+void
+hot_key_reset(void);
+
+/** Free the statistics, called on index deletion. */
+void
+hot_key_stat_delete(struct hot_key_stat *stat);
+
+/** Sort the top list of the statistics, the hottest key first. */
+void
+hot_key_stat_sort(struct hot_key_stat *stat);
+
+/** Returns true if the current request should be sampled. */
+static inline bool
+hot_key_sample(void)
+{
+	if (likely(!hot_key_is_enabled))
+		return false;
+	if (--hot_key_countdown > 0)
+		return false;
+	hot_key_countdown = hot_key_sample_interval;
+	return true;
+}
+
+/**
+ * Account a sampled request with the given key, which is a MsgPack
+ * array, to an index.
+ */
+void
+hot_key_collect(struct index *index, const char *key, const char *key_end);
+
+/**
+ * Account a sampled write request executed successfully to the primary
+ * index of a space. @a tuple is the tuple returned by the request.
+ */
+void
+hot_key_collect_write(struct space *space, struct request *request,
+		      struct tuple *tuple);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
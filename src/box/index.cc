@@ -42,6 +42,10 @@
 #include "box.h"
 #include "base64.h"
 #include "scoped_guard.h"
+#include "sql.h"
+#include "op_stat.h"
+#include "hot_key.h"
+#include "clock.h"
 
 struct rlist box_on_select = RLIST_HEAD_INITIALIZER(box_on_select);
 
@@ -312,6 +316,12 @@ box_index_get(uint32_t space_id, uint32_t index_id, const char *key,
 	if (exact_key_validate(index->def->key_def, key, part_count))
 		return -1;
 	box_run_on_select(space, index, ITER_EQ, key_array);
+	if (unlikely(hot_key_sample()))
+		hot_key_collect(index, key_array, key_end);
+	double start_time = 0;
+	bool collect_op_stat = op_stat_is_enabled;
+	if (unlikely(collect_op_stat))
+		start_time = clock_monotonic();
 	/* Start transaction in the engine. */
 	struct txn *txn;
 	struct txn_ro_savepoint svp;
@@ -323,11 +333,95 @@ box_index_get(uint32_t space_id, uint32_t index_id, const char *key,
 		return -1;
 	/* Count statistics. */
 	rmean_collect(rmean_box, IPROTO_SELECT, 1);
+	fiber()->storage.net.lookups++;
+	fiber()->storage.net.scanned += *result != NULL ? 1 : 0;
+	if (unlikely(collect_op_stat)) {
+		uint64_t found = *result != NULL ? 1 : 0;
+		op_stat_collect_select(space_id, index_id, found, found,
+				       clock_monotonic() - start_time);
+	}
 	if (*result != NULL)
 		tuple_bless(*result);
 	return 0;
 }
 
+int
+box_index_get_many(uint32_t space_id, uint32_t index_id, const char *keys,
+		   const char *keys_end, box_tuple_t **result)
+{
+	assert(keys != NULL && keys_end != NULL && result != NULL);
+	mp_tuple_assert(keys, keys_end);
+	if (box_check_slice() != 0)
+		return -1;
+	struct space *space;
+	struct index *index;
+	if (check_index(space_id, index_id, &space, &index) != 0)
+		return -1;
+	if (!index->def->opts.is_unique) {
+		diag_set(ClientError, ER_MORE_THAN_ONE_TUPLE);
+		return -1;
+	}
+	uint32_t key_count = mp_decode_array(&keys);
+	/* Validate all keys before looking up any of them. */
+	const char *key = keys;
+	for (uint32_t i = 0; i < key_count; i++) {
+		assert(mp_typeof(*key) == MP_ARRAY);
+		const char *key_array = key;
+		uint32_t part_count = mp_decode_array(&key);
+		if (exact_key_validate(index->def->key_def, key, part_count))
+			return -1;
+		box_run_on_select(space, index, ITER_EQ, key_array);
+		const char *key_end = key_array;
+		mp_next(&key_end);
+		if (unlikely(hot_key_sample()))
+			hot_key_collect(index, key_array, key_end);
+		key = key_end;
+	}
+	index_prefetch(index, keys, key_count);
+	double start_time = 0;
+	bool collect_op_stat = op_stat_is_enabled;
+	if (unlikely(collect_op_stat))
+		start_time = clock_monotonic();
+	/* Start transaction in the engine. */
+	struct txn *txn;
+	struct txn_ro_savepoint svp;
+	if (txn_begin_ro_stmt(space, &txn, &svp) != 0)
+		return -1;
+	uint64_t found = 0;
+	key = keys;
+	for (uint32_t i = 0; i < key_count; i++) {
+		uint32_t part_count = mp_decode_array(&key);
+		const char *key_end = key;
+		for (uint32_t j = 0; j < part_count; j++)
+			mp_next(&key_end);
+		struct tuple *tuple;
+		if (index_get(index, key, part_count, &tuple) != 0) {
+			txn_end_ro_stmt(txn, &svp);
+			for (uint32_t j = 0; j < i; j++) {
+				if (result[j] != NULL)
+					tuple_unref(result[j]);
+			}
+			return -1;
+		}
+		if (tuple != NULL) {
+			tuple_ref(tuple);
+			found++;
+		}
+		result[i] = tuple;
+		key = key_end;
+	}
+	txn_end_ro_stmt(txn, &svp);
+	/* Count statistics. */
+	rmean_collect(rmean_box, IPROTO_SELECT, key_count);
+	fiber()->storage.net.lookups += key_count;
+	fiber()->storage.net.scanned += found;
+	if (unlikely(collect_op_stat)) {
+		op_stat_collect_select(space_id, index_id, found, found,
+				       clock_monotonic() - start_time);
+	}
+	return 0;
+}
+
 int
 box_index_min(uint32_t space_id, uint32_t index_id, const char *key,
 	      const char *key_end, box_tuple_t **result)
@@ -475,6 +569,8 @@ box_index_iterator_after(uint32_t space_id, uint32_t index_id, int type,
 		pos_end = pos_buf + pos_buf_size;
 	}
 	box_run_on_select(space, index, itype, key_array);
+	if (unlikely(hot_key_sample()))
+		hot_key_collect(index, key_array, key_end);
 	struct txn *txn;
 	struct txn_ro_savepoint svp;
 	if (txn_begin_ro_stmt(space, &txn, &svp) != 0)
@@ -518,6 +614,21 @@ box_iterator_next(box_iterator_t *itr, box_tuple_t **result)
 	return 0;
 }
 
+int
+box_iterator_next_batch(box_iterator_t *itr, box_tuple_t **result,
+			uint32_t size, uint32_t *count)
+{
+	assert(result != NULL);
+	assert(count != NULL);
+	*count = 0;
+	if (box_check_slice() != 0)
+		return -1;
+	struct space *space = index_weak_ref_get_space(&itr->index_ref);
+	if (space == NULL)
+		return 0;
+	return iterator_next_batch(itr, result, size, count);
+}
+
 void
 box_iterator_free(box_iterator_t *it)
 {
@@ -561,9 +672,12 @@ iterator_create(struct iterator *it, struct index *index)
 	index_weak_ref_create(&it->index_ref, index);
 	it->next_internal = NULL;
 	it->next = NULL;
+	it->next_batch = generic_iterator_next_batch;
+	it->skip = generic_iterator_skip;
 	it->free = NULL;
 	it->pos_buf = NULL;
 	it->pos_buf_size = 0;
+	it->is_covering = false;
 }
 
 int
@@ -577,6 +691,29 @@ iterator_next(struct iterator *it, struct tuple **ret)
 	return it->next(it, ret);
 }
 
+int
+iterator_next_batch(struct iterator *it, struct tuple **ret,
+		    uint32_t size, uint32_t *count)
+{
+	assert(it->next_batch != NULL);
+	if (!index_weak_ref_check(&it->index_ref)) {
+		*count = 0;
+		return 0;
+	}
+	return it->next_batch(it, ret, size, count);
+}
+
+int
+iterator_skip(struct iterator *it, uint32_t count, uint32_t *skipped)
+{
+	assert(it->skip != NULL);
+	if (!index_weak_ref_check(&it->index_ref)) {
+		*skipped = 0;
+		return 0;
+	}
+	return it->skip(it, count, skipped);
+}
+
 int
 iterator_next_internal(struct iterator *it, struct tuple **ret)
 {
@@ -723,6 +860,9 @@ index_create(struct index *index, struct engine *engine,
 	/* Unusable until set to proper value during space creation. */
 	index->dense_id = UINT32_MAX;
 	rlist_create(&index->read_gaps);
+	index->sql_stat = NULL;
+	index->op_stat = NULL;
+	index->hot_key_stat = NULL;
 }
 
 void
@@ -736,6 +876,10 @@ index_delete(struct index *index)
 	 */
 	struct index_def *def = index->def;
 	memtx_tx_on_index_delete(index);
+	if (index->sql_stat != NULL)
+		sql_index_stat_delete(index->sql_stat);
+	op_stat_delete(index->op_stat);
+	hot_key_stat_delete(index->hot_key_stat);
 	index->vtab->destroy(index);
 	index_def_delete(def);
 }
@@ -888,6 +1032,15 @@ generic_index_get(struct index *index, const char *key,
 	return -1;
 }
 
+void
+generic_index_prefetch(struct index *index, const char *keys,
+		       uint32_t key_count)
+{
+	(void)index;
+	(void)keys;
+	(void)key_count;
+}
+
 int
 generic_index_replace(struct index *index, struct tuple *old_tuple,
 		      struct tuple *new_tuple, enum dup_replace_mode mode,
@@ -968,6 +1121,17 @@ generic_index_build_next(struct index *index, struct tuple *tuple)
 	return index_replace(index, NULL, tuple, DUP_INSERT, &unused, &unused);
 }
 
+int
+generic_index_build_next_batch(struct index *index, struct tuple **tuples,
+			       uint32_t count)
+{
+	for (uint32_t i = 0; i < count; i++) {
+		if (index_build_next(index, tuples[i]) != 0)
+			return -1;
+	}
+	return 0;
+}
+
 void
 generic_index_end_build(struct index *)
 {
@@ -1000,6 +1164,46 @@ exhausted_iterator_next(struct iterator *it, struct tuple **ret)
 	return 0;
 }
 
+int
+generic_iterator_next_batch(struct iterator *it, struct tuple **ret,
+			    uint32_t size, uint32_t *count)
+{
+	uint32_t n = 0;
+	while (n < size) {
+		struct tuple *tuple;
+		if (iterator_next(it, &tuple) != 0) {
+			for (uint32_t i = 0; i < n; i++)
+				tuple_unref(ret[i]);
+			*count = 0;
+			return -1;
+		}
+		if (tuple == NULL)
+			break;
+		tuple_ref(tuple);
+		ret[n++] = tuple;
+	}
+	*count = n;
+	return 0;
+}
+
+int
+generic_iterator_skip(struct iterator *it, uint32_t count, uint32_t *skipped)
+{
+	uint32_t n = 0;
+	while (n < count) {
+		struct tuple *tuple;
+		if (box_check_slice() != 0 || iterator_next(it, &tuple) != 0) {
+			*skipped = n;
+			return -1;
+		}
+		if (tuple == NULL)
+			break;
+		n++;
+	}
+	*skipped = n;
+	return 0;
+}
+
 int
 exhausted_index_read_view_iterator_next_raw(struct index_read_view_iterator *it,
 					    struct read_view_tuple *result)
@@ -52,6 +52,9 @@ struct index_read_view_iterator;
 struct index_def;
 struct key_def;
 struct info_handler;
+struct op_stat;
+struct hot_key_stat;
+struct sql_index_stat;
 
 typedef struct tuple box_tuple_t;
 typedef struct key_def box_key_def_t;
@@ -123,6 +126,25 @@ box_index_iterator(uint32_t space_id, uint32_t index_id, int type,
 int
 box_iterator_next(box_iterator_t *iterator, box_tuple_t **result);
 
+/**
+ * Retrieve up to \a size next items from the \a iterator.
+ *
+ * This is faster than calling box_iterator_next() for each item.
+ * Unlike box_iterator_next(), the returned tuples are referenced and
+ * must be unreferenced with box_tuple_unref() by the caller.
+ *
+ * \param iterator an iterator returned by box_index_iterator().
+ * \param[out] result an array of at least \a size tuples.
+ * \param size the maximal number of tuples to retrieve.
+ * \param[out] count the number of retrieved tuples. It is less than
+ *             \a size only if there is no more data.
+ * \retval -1 on error (check box_error_last() for details)
+ * \retval 0 on success. The end of data is not an error.
+ */
+int
+box_iterator_next_batch(box_iterator_t *iterator, box_tuple_t **result,
+			uint32_t size, uint32_t *count);
+
 /**
  * Destroy and deallocate iterator.
  *
@@ -188,6 +210,31 @@ int
 box_index_get(uint32_t space_id, uint32_t index_id, const char *key,
 	      const char *key_end, box_tuple_t **result);
 
+/**
+ * Get tuples from index by a batch of keys.
+ *
+ * This is faster than calling box_index_get() for each key. All keys
+ * are looked up in one read view. Unlike box_index_get(), the returned
+ * tuples are referenced and must be unreferenced with box_tuple_unref()
+ * by the caller.
+ *
+ * \param space_id space identifier
+ * \param index_id index identifier
+ * \param keys encoded MsgPack Array of keys, each of which is a MsgPack
+ *             Array ([[part1, part2, ...], ...]).
+ * \param keys_end the end of encoded \a keys
+ * \param[out] result an array of at least as many tuples as there are
+ *             keys. Its i-th element is set to the tuple matching the
+ *             i-th key or NULL if there is no such tuple.
+ * \retval -1 on error (check box_error_last())
+ * \retval 0 on success
+ * \pre keys != NULL
+ * \sa \code box.space[space_id].index[index_id]:get_many(keys) \endcode
+ */
+int
+box_index_get_many(uint32_t space_id, uint32_t index_id, const char *keys,
+		   const char *keys_end, box_tuple_t **result);
+
 /**
  * Return a first (minimal) tuple matched the provided key.
  *
@@ -324,6 +371,20 @@ struct iterator {
 	 * Returns 0 on success, -1 on error.
 	 */
 	int (*next)(struct iterator *it, struct tuple **ret);
+	/**
+	 * Iterate to up to @a size next tuples. The tuples are returned
+	 * in @ret, their number in @count, which is less than @size only
+	 * on EOF. Unlike next(), the returned tuples are referenced.
+	 * Returns 0 on success, -1 on error.
+	 */
+	int (*next_batch)(struct iterator *it, struct tuple **ret,
+			  uint32_t size, uint32_t *count);
+	/**
+	 * Skip up to @a count next tuples. The number of skipped tuples
+	 * is returned in @a skipped, which is less than @a count only on
+	 * EOF. Returns 0 on success, -1 on error.
+	 */
+	int (*skip)(struct iterator *it, uint32_t count, uint32_t *skipped);
 	/**
 	 * Get position of iterator - extracted cmp_def of last fetched
 	 * tuple with MP_ARRAY header. If iterator is exhausted,
@@ -345,6 +406,13 @@ struct iterator {
 	 * Needed for box_index_iterator_after.
 	 */
 	char *pos_buf;
+	/**
+	 * Set by the caller if it reads only the fields indexed by
+	 * the index comparison key definition. An engine may then
+	 * return tuples that have only these fields up-to-date if
+	 * it saves it some work. False by default.
+	 */
+	bool is_covering;
 };
 
 /**
@@ -366,6 +434,27 @@ iterator_create(struct iterator *it, struct index *index);
 int
 iterator_next(struct iterator *it, struct tuple **ret);
 
+/**
+ * Iterate to up to @a size next tuples, see iterator::next_batch.
+ *
+ * The tuples are returned in @ret and referenced, their number is
+ * returned in @count (less than @size only on EOF).
+ * Returns 0 on success, -1 on error.
+ */
+int
+iterator_next_batch(struct iterator *it, struct tuple **ret,
+		    uint32_t size, uint32_t *count);
+
+/**
+ * Skip up to @a count next tuples, see iterator::skip.
+ *
+ * The number of skipped tuples is returned in @a skipped (less than
+ * @a count only on EOF).
+ * Returns 0 on success, -1 on error.
+ */
+int
+iterator_skip(struct iterator *it, uint32_t count, uint32_t *skipped);
+
 /**
  * Iterate to the next tuple as is, without any transformations.
  *
@@ -560,6 +649,16 @@ struct index_vtab {
 			    uint32_t part_count, struct tuple **result);
 	int (*get)(struct index *index, const char *key,
 		   uint32_t part_count, struct tuple **result);
+	/**
+	 * Hint the index that the given keys are going to be looked
+	 * up with get() soon so that it can load them in advance in
+	 * parallel, e.g. warm up a disk cache. The keys are passed
+	 * as a sequence of @a key_count MsgPack arrays. Invalid keys
+	 * are silently skipped. The method never fails: any error is
+	 * reported by the following get() calls.
+	 */
+	void (*prefetch)(struct index *index, const char *keys,
+			 uint32_t key_count);
 	/**
 	 * Main entrance point for changing data in index. Once built and
 	 * before deletion this is the only way to insert, replace and delete
@@ -605,6 +704,13 @@ struct index_vtab {
 	 */
 	int (*reserve)(struct index *index, uint32_t size_hint);
 	int (*build_next)(struct index *index, struct tuple *tuple);
+	/**
+	 * Same as build_next, but adds @a count tuples at once.
+	 * Lets an index amortize per-tuple costs, such as calling
+	 * a functional index function, over a batch.
+	 */
+	int (*build_next_batch)(struct index *index, struct tuple **tuples,
+				uint32_t count);
 	void (*end_build)(struct index *index);
 };
 
@@ -633,6 +739,21 @@ struct index {
 	 * @sa struct gap_item_base.
 	 */
 	struct rlist read_gaps;
+	/**
+	 * Statistics collected by SQL ANALYZE or NULL if the index
+	 * hasn't been analyzed.
+	 */
+	struct sql_index_stat *sql_stat;
+	/**
+	 * Operation statistics or NULL if they aren't collected,
+	 * see op_stat.h.
+	 */
+	struct op_stat *op_stat;
+	/**
+	 * Hot key statistics or NULL if they aren't collected,
+	 * see hot_key.h.
+	 */
+	struct hot_key_stat *hot_key_stat;
 };
 
 /**
@@ -936,6 +1057,12 @@ index_get(struct index *index, const char *key,
 	return index->vtab->get(index, key, part_count, result);
 }
 
+static inline void
+index_prefetch(struct index *index, const char *keys, uint32_t key_count)
+{
+	index->vtab->prefetch(index, keys, key_count);
+}
+
 static inline int
 index_replace(struct index *index, struct tuple *old_tuple,
 	      struct tuple *new_tuple, enum dup_replace_mode mode,
@@ -1003,6 +1130,13 @@ index_build_next(struct index *index, struct tuple *tuple)
 	return index->vtab->build_next(index, tuple);
 }
 
+static inline int
+index_build_next_batch(struct index *index, struct tuple **tuples,
+		       uint32_t count)
+{
+	return index->vtab->build_next_batch(index, tuples, count);
+}
+
 static inline void
 index_end_build(struct index *index)
 {
@@ -1092,6 +1226,7 @@ int
 generic_index_get_internal(struct index *index, const char *key,
 			   uint32_t part_count, struct tuple **result);
 int generic_index_get(struct index *, const char *, uint32_t, struct tuple **);
+void generic_index_prefetch(struct index *, const char *, uint32_t);
 int generic_index_replace(struct index *, struct tuple *, struct tuple *,
 			  enum dup_replace_mode,
 			  struct tuple **, struct tuple **);
@@ -1107,6 +1242,9 @@ generic_index_create_iterator(struct index *base, enum iterator_type type,
 			      const char *key, uint32_t part_count,
 			      const char *pos);
 int generic_index_build_next(struct index *, struct tuple *);
+int
+generic_index_build_next_batch(struct index *index, struct tuple **tuples,
+			       uint32_t count);
 void generic_index_end_build(struct index *);
 int
 disabled_index_build_next(struct index *index, struct tuple *tuple);
@@ -1116,6 +1254,16 @@ disabled_index_replace(struct index *index, struct tuple *old_tuple,
 		       struct tuple **result, struct tuple **successor);
 int
 exhausted_iterator_next(struct iterator *it, struct tuple **ret);
+/** Fetches tuples one by one with iterator::next. */
+int
+generic_iterator_next_batch(struct iterator *it, struct tuple **ret,
+			    uint32_t size, uint32_t *count);
+/**
+ * Skips tuples one by one with iterator::next, checking the fiber
+ * slice periodically.
+ */
+int
+generic_iterator_skip(struct iterator *it, uint32_t count, uint32_t *skipped);
 int
 exhausted_index_read_view_iterator_next_raw(struct index_read_view_iterator *it,
 					    struct read_view_tuple *result);
@@ -65,6 +65,18 @@ enum rtree_index_distance_type {
 };
 extern const char *rtree_index_distance_type_strs[];
 
+/** Hash function used by HASH index. */
+enum index_hash_func {
+	/** PMurHash32 over the MsgPack representation of the key. */
+	INDEX_HASH_FUNC_MURMUR,
+	/** 64-bit wyhash over the decoded key values. */
+	INDEX_HASH_FUNC_WYHASH,
+	/** 64-bit XXH3 over the decoded key values. */
+	INDEX_HASH_FUNC_XXH3,
+	index_hash_func_MAX
+};
+extern const char *index_hash_func_strs[];
+
 /** Index options */
 struct index_opts {
 	/**
@@ -108,6 +120,10 @@ struct index_opts {
 	 * Use hint optimization for tree index.
 	 */
 	enum index_hint_cfg hint;
+	/**
+	 * Hash function of memtx hash index.
+	 */
+	enum index_hash_func hash_func;
 };
 
 extern const struct index_opts index_opts_default;
@@ -155,6 +171,8 @@ index_opts_cmp(const struct index_opts *o1, const struct index_opts *o2)
 		return o1->func_id - o2->func_id;
 	if (o1->hint != o2->hint)
 		return o1->hint - o2->hint;
+	if (o1->hash_func != o2->hash_func)
+		return o1->hash_func - o2->hash_func;
 	return 0;
 }
 
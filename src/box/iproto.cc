@@ -65,12 +65,18 @@
 #include "replication.h" /* instance_uuid */
 #include "iproto_constants.h"
 #include "iproto_features.h"
+#include "slow_request.h"
+#include "iproto_read_view.h"
+#include "arrow_import.h"
 #include "rmean.h"
+#include "histogram.h"
+#include "clock.h"
 #include "execute.h"
 #include "errinj.h"
 #include "tt_static.h"
 #include "trivia/util.h"
 #include "salad/stailq.h"
+#include "bit/bit.h"
 #include "txn.h"
 #include "on_shutdown.h"
 #include "flightrec.h"
@@ -79,6 +85,9 @@
 #include "box/mp_box_ctx.h"
 #include "box/tuple.h"
 #include "mpstream/mpstream.h"
+#include "tt_cpu_set.h"
+#include "usdt.h"
+#include "zstd_iostream.h"
 
 enum {
 	IPROTO_PACKET_SIZE_MAX = 2UL * 1024 * 1024 * 1024,
@@ -188,6 +197,8 @@ struct iproto_thread {
 	struct cmsg_hop misc_route[2];
 	struct cmsg_hop call_route[2];
 	struct cmsg_hop select_route[2];
+	struct cmsg_hop select_many_route[2];
+	struct cmsg_hop insert_arrow_route[2];
 	struct cmsg_hop process1_route[2];
 	struct cmsg_hop sql_route[2];
 	struct cmsg_hop join_route[2];
@@ -224,6 +235,41 @@ struct iproto_thread {
 	struct evio_service binary;
 	/** Requests count currently pending in stream queue. */
 	size_t requests_in_stream_queue;
+	/**
+	 * Maximal time parsed requests may be held in the tx pipe input
+	 * so that requests of other connections join the same batch.
+	 * Set by box.cfg.net_batch_delay, zero means no delay.
+	 */
+	double batch_delay;
+	/** Timer flushing requests held because of batch_delay. */
+	struct ev_timer batch_timer;
+	/** Trigger run on each flush of the tx pipe input. */
+	struct trigger on_tx_flush;
+	/** Timer releasing input buffers of idle connections. */
+	struct ev_timer idle_timer;
+	/** Number of connections with released input buffers. */
+	size_t idle_connection_count;
+	/** Histogram of sizes of message batches flushed to tx thread. */
+	int64_t batch_hist[IPROTO_BATCH_HIST_SIZE];
+	/** Number of times input was stopped by net_msg_max. */
+	int64_t msg_max_stops;
+	/**
+	 * Max number of requests of one connection processed at the same
+	 * time. Set by box.cfg.net_msg_max_per_connection, zero means no
+	 * limit.
+	 */
+	int connection_msg_max;
+	/**
+	 * Read view used for serving SELECT requests right in the iproto
+	 * thread or NULL. Opened and closed by the tx thread, see
+	 * iproto_read_view_f().
+	 */
+	struct iproto_read_view *read_view;
+	/**
+	 * Max age of read view data that may be returned to clients.
+	 * Set by box.cfg.iproto_read_view_staleness.
+	 */
+	double read_view_staleness;
 	/** List of all connections. */
 	struct rlist connections;
 	/** Number of connections that pending drop. */
@@ -262,6 +308,13 @@ static size_t drop_pending_thread_count;
  */
 static unsigned drop_generation;
 
+/** Fiber that publishes read views to iproto threads. */
+static struct fiber *iproto_read_view_fiber;
+/** Signaled to wake up iproto_read_view_fiber. */
+static struct fiber_cond iproto_read_view_cond;
+/** Max age of read view data. See box.cfg.iproto_read_view_staleness. */
+static double iproto_read_view_staleness;
+
 /**
  * IPROTO listen URIs. Set by box.cfg.listen.
  */
@@ -269,6 +322,15 @@ static struct uri_set iproto_uris;
 
 static struct iproto_thread *iproto_threads;
 int iproto_threads_count;
+/** CPUs IPROTO threads are bound to, box.cfg.iproto_cpus. */
+static struct tt_cpu_set iproto_cpu_set;
+/** Set if IPROTO threads are bound to iproto_cpu_set. */
+static bool iproto_cpu_set_is_set;
+/**
+ * Set if each IPROTO thread listens on its own SO_REUSEPORT socket,
+ * box.cfg.iproto_reuseport.
+ */
+static bool iproto_reuseport;
 /**
  * This binary contains all bind socket properties, like
  * address the iproto listens for. Is kept in TX to be
@@ -367,6 +429,15 @@ static bool iproto_is_shutting_down;
 enum iproto_cfg_op {
 	/** Command code to set max input for iproto thread */
 	IPROTO_CFG_MSG_MAX,
+	/**
+	 * Command code to set the delay of flushing requests to tx thread.
+	 */
+	IPROTO_CFG_BATCH_DELAY,
+	/**
+	 * Command code to set the read view used for serving SELECT
+	 * requests in iproto thread.
+	 */
+	IPROTO_CFG_READ_VIEW,
 	/**
 	 * Command code to start listen socket contained
 	 * in evio_service object
@@ -401,6 +472,11 @@ enum iproto_cfg_op {
 	 */
 	IPROTO_CFG_DROP_CONNECTIONS,
 	IPROTO_CFG_SHUTDOWN,
+	/**
+	 * Command code to set max number of requests of one connection
+	 * processed at the same time.
+	 */
+	IPROTO_CFG_CONNECTION_MSG_MAX,
 };
 
 /**
@@ -418,6 +494,16 @@ struct iproto_cfg_msg: public cbus_call_msg
 		struct iproto_stats *stats;
 		/** New iproto max message count. */
 		int iproto_msg_max;
+		/** New max message count of one connection. */
+		int connection_msg_max;
+		/** New delay of flushing requests to tx thread. */
+		double batch_delay;
+		struct {
+			/** New read view or NULL. */
+			struct iproto_read_view *rv;
+			/** Max age of the read view data. */
+			double staleness;
+		} read_view;
 		struct {
 			/** New connection IO stream. */
 			struct iostream io;
@@ -488,6 +574,12 @@ iproto_max_input_size(void)
 	return 18 * iproto_readahead;
 }
 
+/**
+ * How long a connection must not receive anything to have its input
+ * buffers released, in seconds. Also the period of the check.
+ */
+static const double IPROTO_IDLE_TIMEOUT = 1;
+
 void
 iproto_reset_input(struct ibuf *ibuf)
 {
@@ -578,6 +670,10 @@ struct iproto_msg
 	 * the buffer.
 	 */
 	const char *reqstart;
+	/** Time when the message was created by the IPROTO thread. */
+	double recv_time;
+	/** Time when the TX thread started processing the message. */
+	double accept_time;
 	/**
 	 * Position in the connection output buffer. When sending a
 	 * message to the tx thread, iproto sets it to its current
@@ -593,11 +689,31 @@ struct iproto_msg
 	 * Used by long (yielding) CALL/EVAL requests.
 	 */
 	struct cmsg discard_input;
+	/**
+	 * MsgPack array of tuples converted from the record batches of
+	 * an IPROTO_INSERT_ARROW request or NULL. Allocated with malloc()
+	 * and freed along with the message.
+	 */
+	char *arrow_tuples;
+	/** Size of @a arrow_tuples. */
+	size_t arrow_tuples_size;
 	/**
 	 * Used in "connect" msgs, true if connect trigger failed
 	 * and the connection must be closed.
 	 */
 	bool close_connection;
+	/**
+	 * Auth token of the session user and whether the session uses
+	 * the tuple extension in DML replies. Set by the tx thread when
+	 * it's done with the message, see iproto_connection::auth_token.
+	 */
+	uint8_t auth_token;
+	bool tuple_as_ext;
+	/**
+	 * Set by the tx thread if this is an IPROTO_ID request that asked
+	 * for compression, see IPROTO_FEATURE_COMPRESSION.
+	 */
+	bool start_compression;
 	/**
 	 * A stailq_entry to hold message in stream.
 	 * All messages processed in stream sequently. Before processing
@@ -788,6 +904,23 @@ struct iproto_connection
 	 * output is available (see iproto_msg::wpos).
 	 */
 	struct iproto_wpos wend;
+	/**
+	 * Output buffer for replies to requests served right in the iproto
+	 * thread, see iproto_msg_process_in_read_view(). Accessed only by
+	 * the iproto thread. Flushed after the data written by the tx
+	 * thread and recycled when fully flushed.
+	 */
+	struct obuf net_obuf;
+	/** Position in net_obuf up to which the data has been flushed. */
+	struct obuf_svp net_wpos;
+	/**
+	 * Auth token of the session user as of the last request processed
+	 * by the tx thread. Used for checking access to read view spaces.
+	 * BOX_USER_MAX if the session hasn't been created yet.
+	 */
+	uint8_t auth_token;
+	/** Set if the session uses the tuple extension in DML replies. */
+	bool tuple_as_ext;
 	/*
 	 * Size of readahead which is not parsed yet, i.e. size of
 	 * a piece of request which is not fully read. Is always
@@ -834,12 +967,28 @@ struct iproto_connection
 	 */
 	enum iproto_connection_state state;
 	struct rlist in_stop_list;
+	/** Number of requests of this connection being processed. */
+	int msg_count;
+	/**
+	 * Set if input is stopped because the connection has too many
+	 * requests in progress, see iproto_thread::connection_msg_max.
+	 * Unlike connections stopped by net_msg_max, such a connection
+	 * is resumed only when one of its own requests completes.
+	 */
+	bool is_stopped_by_connection_msg_max;
 	/**
 	 * Flag indicates, that client sent SHUT_RDWR or connection
 	 * is closed from client side. When it is set to false, we
 	 * should not write to the socket.
 	 */
 	bool can_write;
+	/**
+	 * Set if the connection must switch to compression as soon as
+	 * the reply to the IPROTO_ID request is flushed.
+	 */
+	bool is_compression_pending;
+	/** Set if the connection stream is compressed. */
+	bool is_compressed;
 	/**
 	 * Hash table that holds all streams for this connection.
 	 * This field is accesable only from iproto thread.
@@ -920,6 +1069,16 @@ struct iproto_connection
 	struct cmsg cancel_msg;
 	/** Set if connection is accepted in TX. */
 	bool is_established;
+	/**
+	 * Set on each input event, cleared by the idle timer of the iproto
+	 * thread, see iproto_connection_check_idle().
+	 */
+	bool is_active;
+	/**
+	 * Set if the input buffers were released because the connection
+	 * was idle. They are allocated again on the next read.
+	 */
+	bool is_idle;
 };
 
 /** Returns a string suitable for logging. */
@@ -981,11 +1140,32 @@ iproto_check_msg_max(struct iproto_thread *iproto_thread)
 	return request_count > (size_t) iproto_msg_max;
 }
 
+/**
+ * Return true if the connection has too many requests in progress
+ * to accept a new one.
+ */
+static inline bool
+iproto_connection_check_msg_max(struct iproto_connection *con)
+{
+	int connection_msg_max = con->iproto_thread->connection_msg_max;
+	return connection_msg_max > 0 && con->msg_count >= connection_msg_max;
+}
+
+static void
+iproto_connection_resume_connection_msg_max(struct iproto_connection *con);
+
 static inline void
 iproto_msg_delete(struct iproto_msg *msg)
 {
-	struct iproto_thread *iproto_thread = msg->connection->iproto_thread;
-	mempool_free(&msg->connection->iproto_thread->iproto_msg_pool, msg);
+	struct iproto_connection *con = msg->connection;
+	struct iproto_thread *iproto_thread = con->iproto_thread;
+	assert(con->msg_count > 0);
+	con->msg_count--;
+	free(msg->arrow_tuples);
+	mempool_free(&iproto_thread->iproto_msg_pool, msg);
+	if (con->is_stopped_by_connection_msg_max &&
+	    !iproto_connection_check_msg_max(con))
+		iproto_connection_resume_connection_msg_max(con);
 	iproto_resume(iproto_thread);
 }
 
@@ -1005,9 +1185,15 @@ iproto_msg_new(struct iproto_connection *con)
 	struct iproto_msg *msg =
 		(struct iproto_msg *)xmempool_alloc(iproto_msg_pool);
 	msg->close_connection = false;
+	msg->start_compression = false;
+	msg->auth_token = con->auth_token;
+	msg->tuple_as_ext = con->tuple_as_ext;
 	msg->connection = con;
 	msg->stream = NULL;
 	msg->fiber = NULL;
+	msg->arrow_tuples = NULL;
+	msg->recv_time = clock_monotonic();
+	con->msg_count++;
 	rmean_collect(con->iproto_thread->rmean, IPROTO_REQUESTS, 1);
 	return msg;
 }
@@ -1085,6 +1271,7 @@ iproto_connection_stop_msg_max_limit(struct iproto_connection *con)
 {
 	assert(rlist_empty(&con->in_stop_list));
 
+	con->iproto_thread->msg_max_stops++;
 	say_warn_ratelimited("stopping input on connection %s, "
 			     "net_msg_max limit is reached",
 			     iproto_connection_name(con));
@@ -1097,6 +1284,19 @@ iproto_connection_stop_msg_max_limit(struct iproto_connection *con)
 		       &con->in_stop_list);
 }
 
+/**
+ * Stop input of a connection that has too many requests in progress
+ * so that other connections of the thread get their share of
+ * net_msg_max and of the tx fiber pool.
+ */
+static inline void
+iproto_connection_stop_connection_msg_max_limit(struct iproto_connection *con)
+{
+	assert(rlist_empty(&con->in_stop_list));
+	con->is_stopped_by_connection_msg_max = true;
+	ev_io_stop(con->loop, &con->input);
+}
+
 /**
  * Send a destroy message to TX thread in case all requests are
  * finished.
@@ -1323,6 +1523,106 @@ iproto_msg_start_processing_in_stream(struct iproto_msg *msg)
 	return false;
 }
 
+/**
+ * Flushes requests staged in the tx pipe input. If net_batch_delay is set,
+ * the flush is deferred, so that requests parsed from other connections in
+ * the meantime reach the tx thread in the same batch. The input is still
+ * flushed immediately once it reaches the pipe size limit.
+ */
+static inline void
+iproto_flush_tx_pipe(struct iproto_thread *iproto_thread)
+{
+	struct cpipe *pipe = &iproto_thread->tx_pipe;
+	if (iproto_thread->batch_delay == 0 || pipe->n_input == 0) {
+		cpipe_flush_input(pipe);
+		return;
+	}
+	if (!ev_is_active(&iproto_thread->batch_timer)) {
+		ev_timer_set(&iproto_thread->batch_timer,
+			     iproto_thread->batch_delay, 0);
+		ev_timer_start(loop(), &iproto_thread->batch_timer);
+	}
+}
+
+/** Delivers requests held in the tx pipe input because of batch_delay. */
+static void
+iproto_batch_timer_cb(ev_loop *loop, ev_timer *watcher, int events)
+{
+	(void)loop;
+	(void)events;
+	struct iproto_thread *iproto_thread =
+		(struct iproto_thread *)watcher->data;
+	cpipe_deliver_now(&iproto_thread->tx_pipe);
+}
+
+/**
+ * Accounts a batch of messages flushed to the tx thread and cancels the
+ * pending deferred flush, since there's nothing left to deliver.
+ */
+static int
+iproto_on_tx_flush(struct trigger *trigger, void *event)
+{
+	struct iproto_thread *iproto_thread =
+		(struct iproto_thread *)trigger->data;
+	struct cpipe *pipe = (struct cpipe *)event;
+	assert(pipe->n_input > 0);
+	int bucket = 31 - bit_clz_u32(pipe->n_input);
+	bucket = MIN(bucket, IPROTO_BATCH_HIST_SIZE - 1);
+	iproto_thread->batch_hist[bucket]++;
+	ev_timer_stop(loop(), &iproto_thread->batch_timer);
+	return 0;
+}
+
+static void
+iproto_msg_finish_input(iproto_msg *msg);
+
+/**
+ * Try to serve a SELECT request from the read view of the iproto thread
+ * without going to the tx thread. On success, the reply is written to
+ * the connection's net_obuf and the message is freed.
+ *
+ * To preserve the order of execution of requests sent over the same
+ * connection, the request is served only if no other request of the
+ * connection is in progress. Requests of streams, requests referring
+ * to spaces and indexes by name, paginated requests, and requests
+ * sent with a schema version unknown to the read view are forwarded
+ * to the tx thread.
+ *
+ * @retval true The request was served.
+ * @retval false The request must be forwarded to the tx thread.
+ */
+static bool
+iproto_msg_process_in_read_view(struct iproto_msg *msg)
+{
+	struct iproto_connection *con = msg->connection;
+	struct iproto_thread *iproto_thread = con->iproto_thread;
+	struct iproto_read_view *rv = iproto_thread->read_view;
+	if (rv == NULL || msg->base.hop != iproto_thread->select_route ||
+	    msg->header.stream_id != 0 ||
+	    con->state != IPROTO_CONNECTION_ALIVE || !con->is_established ||
+	    con->is_in_replication || con->tuple_as_ext ||
+	    con->input_msg_count[0] + con->input_msg_count[1] != 1 ||
+	    con->long_poll_count != 0)
+		return false;
+	if (ev_monotonic_now(con->loop) - rv->base.timestamp >
+	    iproto_thread->read_view_staleness)
+		return false;
+	if (msg->header.schema_version != 0 &&
+	    msg->header.schema_version != rv->schema_version)
+		return false;
+	struct obuf *out = &con->net_obuf;
+	if (obuf_size(out) - con->net_wpos.used > iproto_max_input_size())
+		return false;
+	if (!iproto_read_view_select(rv, &msg->dml, msg->header.sync,
+				     con->auth_token, out))
+		return false;
+	iproto_msg_finish_input(msg);
+	con->msg_count--;
+	mempool_free(&iproto_thread->iproto_msg_pool, msg);
+	iproto_connection_feed_output(con);
+	return true;
+}
+
 /**
  * Enqueue all requests which were read up. If a request limit is
  * reached - stop the connection input even if not the whole batch
@@ -1346,6 +1646,11 @@ iproto_enqueue_batch(struct iproto_connection *con, struct ibuf *in)
 			cpipe_flush_input(&con->iproto_thread->tx_pipe);
 			return 0;
 		}
+		if (iproto_connection_check_msg_max(con)) {
+			iproto_connection_stop_connection_msg_max_limit(con);
+			cpipe_flush_input(&con->iproto_thread->tx_pipe);
+			return 0;
+		}
 		const char *reqstart = in->wpos - con->parse_size;
 		const char *pos = reqstart;
 		/* Read request length. */
@@ -1377,15 +1682,18 @@ iproto_enqueue_batch(struct iproto_connection *con, struct ibuf *in)
 		con->input_msg_count[msg->p_ibuf == &con->ibuf[1]]++;
 
 		iproto_msg_prepare(msg, &pos, reqend);
-		if (iproto_msg_start_processing_in_stream(msg)) {
-			cpipe_push_input(&con->iproto_thread->tx_pipe, &msg->base);
-			n_requests++;
-		}
 
 		/* Request is parsed */
 		assert(reqend > reqstart);
 		assert(con->parse_size >= (size_t) (reqend - reqstart));
 		con->parse_size -= reqend - reqstart;
+
+		if (iproto_msg_process_in_read_view(msg)) {
+			n_requests++;
+		} else if (iproto_msg_start_processing_in_stream(msg)) {
+			cpipe_push_input(&con->iproto_thread->tx_pipe, &msg->base);
+			n_requests++;
+		}
 	}
 	if (con->is_in_replication) {
 		/**
@@ -1418,7 +1726,7 @@ iproto_enqueue_batch(struct iproto_connection *con, struct ibuf *in)
 		 */
 		iproto_connection_feed_input(con);
 	}
-	cpipe_flush_input(&con->iproto_thread->tx_pipe);
+	iproto_flush_tx_pipe(con->iproto_thread);
 	return 0;
 }
 
@@ -1444,6 +1752,29 @@ iproto_connection_resume(struct iproto_connection *con)
 	}
 }
 
+/**
+ * Resume a connection stopped because it had too many requests in
+ * progress. If the thread's request limit is reached, the connection
+ * is queued for iproto_resume() instead.
+ */
+static void
+iproto_connection_resume_connection_msg_max(struct iproto_connection *con)
+{
+	assert(con->is_stopped_by_connection_msg_max);
+	assert(!iproto_connection_check_msg_max(con));
+	con->is_stopped_by_connection_msg_max = false;
+	/*
+	 * A closed connection doesn't need input while a connection
+	 * processing a replication request resumes input on its own.
+	 */
+	if (con->state != IPROTO_CONNECTION_ALIVE || con->is_in_replication)
+		return;
+	if (iproto_check_msg_max(con->iproto_thread))
+		iproto_connection_stop_msg_max_limit(con);
+	else
+		iproto_connection_resume(con);
+}
+
 /**
  * Resume as many connections as possible until a request limit is
  * reached. By design of iproto_enqueue_batch(), a paused
@@ -1480,6 +1811,11 @@ iproto_connection_on_input(ev_loop *loop, struct ev_io *watcher,
 	assert(con->state == IPROTO_CONNECTION_ALIVE);
 	assert(rlist_empty(&con->in_stop_list));
 	assert(loop == con->loop);
+	con->is_active = true;
+	if (con->is_idle) {
+		con->is_idle = false;
+		con->iproto_thread->idle_connection_count--;
+	}
 	/*
 	 * Throttle if there are too many pending requests,
 	 * otherwise we might deplete the fiber pool in tx
@@ -1489,6 +1825,10 @@ iproto_connection_on_input(ev_loop *loop, struct ev_io *watcher,
 		iproto_connection_stop_msg_max_limit(con);
 		return;
 	}
+	if (iproto_connection_check_msg_max(con)) {
+		iproto_connection_stop_connection_msg_max_limit(con);
+		return;
+	}
 
 	/* Ensure we have sufficient space for the next round.  */
 	struct ibuf *in = iproto_connection_input_buffer(con);
@@ -1533,30 +1873,14 @@ error:;
 	iproto_connection_close(con);
 }
 
-/** writev() to the socket and handle the result. */
+/**
+ * writev() the data between the given positions of an output buffer
+ * to the socket and handle the result.
+ */
 static int
-iproto_flush(struct iproto_connection *con)
+iproto_flush_obuf(struct iproto_connection *con, struct obuf *obuf,
+		  struct obuf_svp *begin, struct obuf_svp *end)
 {
-	struct obuf *obuf = con->wpos.obuf;
-	struct obuf_svp obuf_end = obuf_create_svp(obuf);
-	struct obuf_svp *begin = &con->wpos.svp;
-	struct obuf_svp *end = &con->wend.svp;
-	if (con->wend.obuf != obuf) {
-		/*
-		 * Flush the current buffer before
-		 * advancing to the next one.
-		 */
-		if (begin->used == obuf_end.used) {
-			obuf = con->wpos.obuf = con->wend.obuf;
-			obuf_svp_reset(begin);
-		} else {
-			end = &obuf_end;
-		}
-	}
-	if (begin->used == end->used) {
-		/* Nothing to do. */
-		return 1;
-	}
 	if (!con->can_write) {
 		/* Receiving end was closed. Discard the output. */
 		*begin = *end;
@@ -1606,6 +1930,97 @@ iproto_flush(struct iproto_connection *con)
 	return nwr;
 }
 
+/** Flush the output written by the tx thread. */
+static int
+iproto_flush_tx(struct iproto_connection *con)
+{
+	struct obuf *obuf = con->wpos.obuf;
+	struct obuf_svp obuf_end = obuf_create_svp(obuf);
+	struct obuf_svp *begin = &con->wpos.svp;
+	struct obuf_svp *end = &con->wend.svp;
+	if (con->wend.obuf != obuf) {
+		/*
+		 * Flush the current buffer before
+		 * advancing to the next one.
+		 */
+		if (begin->used == obuf_end.used) {
+			obuf = con->wpos.obuf = con->wend.obuf;
+			obuf_svp_reset(begin);
+		} else {
+			end = &obuf_end;
+		}
+	}
+	if (begin->used == end->used) {
+		/* Nothing to do. */
+		return 1;
+	}
+	return iproto_flush_obuf(con, obuf, begin, end);
+}
+
+/** Flush the output written by the iproto thread. */
+static int
+iproto_flush_net(struct iproto_connection *con)
+{
+	struct obuf *obuf = &con->net_obuf;
+	struct obuf_svp end = obuf_create_svp(obuf);
+	if (con->net_wpos.used == end.used) {
+		/* Nothing to do. */
+		return 1;
+	}
+	int rc = iproto_flush_obuf(con, obuf, &con->net_wpos, &end);
+	if (con->net_wpos.used == end.used) {
+		/* Everything is flushed, recycle the buffer. */
+		obuf_reset(obuf);
+		obuf_svp_reset(&con->net_wpos);
+	}
+	return rc;
+}
+
+/**
+ * Flush the connection output. Returns 1 if there's nothing to flush,
+ * 0 if some data was flushed, an iostream status if the socket isn't
+ * ready for writing.
+ */
+static int
+iproto_flush(struct iproto_connection *con)
+{
+	/*
+	 * Both buffers contain only complete replies. Don't switch to
+	 * the tx output until the iproto output is flushed so as not to
+	 * interleave replies.
+	 */
+	if (con->net_wpos.used == 0) {
+		int rc = iproto_flush_tx(con);
+		if (rc != 1)
+			return rc;
+	}
+	return iproto_flush_net(con);
+}
+
+/**
+ * Switches the connection stream to compression once the reply to the
+ * IPROTO_ID request that asked for it has been flushed. The client
+ * doesn't send anything until it receives the reply so there's no
+ * uncompressed input left to process. On failure closes the connection
+ * and returns -1.
+ */
+static int
+iproto_connection_start_compression(struct iproto_connection *con)
+{
+	assert(con->is_compression_pending);
+	con->is_compression_pending = false;
+	struct iostream plain_io;
+	iostream_move(&plain_io, &con->io);
+	if (zstd_iostream_create(&con->io, &plain_io, NULL, 0) != 0) {
+		iostream_move(&con->io, &plain_io);
+		diag_log();
+		iproto_connection_close(con);
+		return -1;
+	}
+	con->is_compressed = true;
+	return 0;
+}
+
 static void
 iproto_connection_on_output(ev_loop *loop, struct ev_io *watcher,
 			    int /* revents */)
@@ -1626,6 +2041,9 @@ iproto_connection_on_output(ev_loop *loop, struct ev_io *watcher,
 	}
 	if (ev_is_active(&con->output))
 		ev_io_stop(con->loop, &con->output);
+	if (con->is_compression_pending &&
+	    iproto_connection_start_compression(con) != 0)
+		return;
 	/*
 	 * If the out channel isn't clogged, we can read more requests.
 	 * Note, we trigger input even if we didn't write any responses
@@ -1635,6 +2053,50 @@ iproto_connection_on_output(ev_loop *loop, struct ev_io *watcher,
 	iproto_connection_feed_input(con);
 }
 
+/**
+ * Releases the memory of the buffers owned by the iproto thread if the
+ * connection hasn't received anything since the previous check and has
+ * no requests in progress. With many mostly idle clients this returns
+ * readahead-sized buffers to the thread slab cache, from which they are
+ * taken again on the next read. The output buffers are owned by the tx
+ * thread and aren't touched.
+ */
+static void
+iproto_connection_check_idle(struct iproto_connection *con)
+{
+	if (con->is_active) {
+		con->is_active = false;
+		return;
+	}
+	if (con->is_idle || con->state != IPROTO_CONNECTION_ALIVE ||
+	    con->is_in_replication || con->msg_count > 0 ||
+	    con->parse_size > 0 || ibuf_used(&con->ibuf[0]) != 0 ||
+	    ibuf_used(&con->ibuf[1]) != 0 || obuf_size(&con->net_obuf) != 0)
+		return;
+	for (int i = 0; i < 2; i++) {
+		ibuf_destroy(&con->ibuf[i]);
+		ibuf_create(&con->ibuf[i], cord_slab_cache(), iproto_readahead);
+	}
+	obuf_destroy(&con->net_obuf);
+	obuf_create(&con->net_obuf, cord_slab_cache(), iproto_readahead);
+	obuf_svp_reset(&con->net_wpos);
+	con->is_idle = true;
+	con->iproto_thread->idle_connection_count++;
+}
+
+/** Releases input buffers of the connections that became idle. */
+static void
+iproto_idle_timer_cb(ev_loop *loop, ev_timer *watcher, int events)
+{
+	(void)loop;
+	(void)events;
+	struct iproto_thread *iproto_thread =
+		(struct iproto_thread *)watcher->data;
+	struct iproto_connection *con;
+	rlist_foreach_entry(con, &iproto_thread->connections, in_connections)
+		iproto_connection_check_idle(con);
+}
+
 static struct iproto_connection *
 iproto_connection_new(struct iproto_thread *iproto_thread)
 {
@@ -1659,14 +2121,24 @@ iproto_connection_new(struct iproto_thread *iproto_thread)
 	con->tx.p_obuf = &con->obuf[0];
 	iproto_wpos_create(&con->wpos, con->tx.p_obuf);
 	iproto_wpos_create(&con->wend, con->tx.p_obuf);
+	obuf_create(&con->net_obuf, cord_slab_cache(), iproto_readahead);
+	obuf_svp_reset(&con->net_wpos);
+	con->auth_token = BOX_USER_MAX;
+	con->tuple_as_ext = false;
 	con->parse_size = 0;
 	con->can_write = true;
+	con->is_compression_pending = false;
+	con->is_compressed = false;
 	con->long_poll_count = 0;
 	con->session = NULL;
 	con->is_in_replication = false;
 	con->is_drop_pending = false;
 	con->is_established = false;
+	con->is_active = true;
+	con->is_idle = false;
 	rlist_create(&con->in_stop_list);
+	con->msg_count = 0;
+	con->is_stopped_by_connection_msg_max = false;
 	rlist_create(&con->tx.inprogress);
 	rlist_add_entry(&iproto_thread->connections, con, in_connections);
 	/* It may be very awkward to allocate at close. */
@@ -1720,6 +2192,9 @@ iproto_connection_delete(struct iproto_connection *con)
 	ibuf_destroy(&con->ibuf[1]);
 	assert(!obuf_is_initialized(&con->obuf[0]));
 	assert(!obuf_is_initialized(&con->obuf[1]));
+	obuf_destroy(&con->net_obuf);
+	if (con->is_idle)
+		con->iproto_thread->idle_connection_count--;
 
 	assert(mh_size(con->streams) == 0);
 	mh_i64ptr_delete(con->streams);
@@ -1751,6 +2226,12 @@ tx_process1(struct cmsg *msg);
 static void
 tx_process_select(struct cmsg *msg);
 
+static void
+tx_process_select_many(struct cmsg *msg);
+
+static void
+tx_process_insert_arrow(struct cmsg *msg);
+
 static void
 tx_process_sql(struct cmsg *msg);
 
@@ -1801,6 +2282,7 @@ iproto_msg_prepare(struct iproto_msg *msg, const char **pos, const char *reqend)
 	assert(*pos == reqend);
 
 	type = msg->header.type;
+	USDT_PROBE(iproto_request_received, msg, type, msg->header.sync);
 	stream_id = msg->header.stream_id;
 	request_is_not_for_stream =
 		((type > IPROTO_TYPE_STAT_MAX &&
@@ -1859,6 +2341,7 @@ iproto_msg_decode(struct iproto_msg *msg, struct cmsg_hop **route)
 {
 	uint32_t type = msg->header.type;
 	struct iproto_thread *iproto_thread = msg->connection->iproto_thread;
+	uint64_t key_map;
 	switch (type) {
 	case IPROTO_SELECT:
 	case IPROTO_INSERT:
@@ -1879,6 +2362,39 @@ iproto_msg_decode(struct iproto_msg *msg, struct cmsg_hop **route)
 		 */
 		msg->dml.header = NULL;
 		return 0;
+	case IPROTO_SELECT_MANY:
+		*route = iproto_thread->select_many_route;
+		/* The request has the same mandatory fields as SELECT. */
+		key_map = dml_request_key_map(IPROTO_SELECT);
+		if (xrow_decode_dml_iproto(&msg->header, &msg->dml,
+					   key_map) != 0)
+			return -1;
+		msg->dml.header = NULL;
+		return 0;
+	case IPROTO_INSERT_ARROW:
+		*route = iproto_thread->insert_arrow_route;
+		key_map = iproto_key_bit(IPROTO_SPACE_ID);
+		if (xrow_decode_dml_iproto(&msg->header, &msg->dml,
+					   key_map) != 0)
+			return -1;
+		if (msg->dml.arrow == NULL) {
+			diag_set(ClientError, ER_MISSING_REQUEST_FIELD,
+				 iproto_key_name(IPROTO_ARROW));
+			return -1;
+		}
+		msg->dml.header = NULL;
+		/*
+		 * Convert the record batches to tuples here so as not to
+		 * waste tx cpu time. The message may be decoded again in
+		 * tx if the request handler is overridden.
+		 */
+		free(msg->arrow_tuples);
+		msg->arrow_tuples = NULL;
+		if (arrow_import_decode(msg->dml.arrow, msg->dml.arrow_end,
+					&msg->arrow_tuples,
+					&msg->arrow_tuples_size) != 0)
+			return -1;
+		return 0;
 	case IPROTO_BEGIN:
 		*route = iproto_thread->begin_route;
 		if (xrow_decode_begin(&msg->header, &msg->begin) != 0)
@@ -1961,6 +2477,11 @@ tx_fiber_init(struct session *session, uint64_t sync)
 	 */
 	assert(rlist_empty(&f->on_stop));
 	f->storage.net.sync = sync;
+	f->storage.net.request = NULL;
+	f->storage.net.wal_time = 0;
+	f->storage.net.limbo_time = 0;
+	f->storage.net.lookups = 0;
+	f->storage.net.scanned = 0;
 	/*
 	 * We do not cleanup fiber keys at the end of each request.
 	 * This does not lead to privilege escalation as long as
@@ -2192,11 +2713,15 @@ tx_accept_msg(struct cmsg *m)
 		return msg;
 	tx_accept_wpos(msg->connection, &msg->wpos);
 	tx_fiber_init(msg->connection->session, msg->header.sync);
+	fiber()->storage.net.request = iproto_type_name(msg->header.type);
 	tx_prepare_transaction_for_request(msg);
 	msg->connection->iproto_thread->tx.requests_in_progress++;
 	rlist_add_entry(&msg->connection->tx.inprogress, msg,
 			in_inprogress);
 	msg->fiber = fiber();
+	msg->accept_time = clock_monotonic();
+	USDT_PROBE(iproto_request_dispatched, msg, msg->header.type,
+		   msg->header.sync);
 	rmean_collect(msg->connection->iproto_thread->tx.rmean,
 		      REQUESTS_IN_PROGRESS, 1);
 	flightrec_write_request(msg->reqstart, msg->len);
@@ -2240,9 +2765,132 @@ tx_check_msg(struct iproto_msg *msg)
 	return 0;
 }
 
+/**
+ * Save the session state needed by the iproto thread for serving
+ * requests without the tx thread in the message.
+ */
+static inline void
+tx_msg_save_session(struct iproto_msg *msg)
+{
+	struct session *session = msg->connection->session;
+	if (session == NULL)
+		return;
+	msg->auth_token = session->credentials.auth_token;
+	msg->tuple_as_ext =
+		iproto_features_test(&session->meta.features,
+				     IPROTO_FEATURE_DML_TUPLE_EXTENSION);
+}
+
+/** Latency of IPROTO requests by request type, see iproto_req_latency(). */
+static struct iproto_req_latency *tx_req_latency[iproto_type_MAX];
+
+struct iproto_req_latency *
+iproto_req_latency(uint32_t type)
+{
+	return type < iproto_type_MAX ? tx_req_latency[type] : NULL;
+}
+
+/**
+ * Record a request processed by the TX thread in the slow request log.
+ * @a total is the time since the request was read by IPROTO.
+ */
+static void
+tx_log_slow_request(struct iproto_msg *msg, double total)
+{
+	struct fiber *f = fiber();
+	uint32_t type = msg->header.type;
+	struct slow_request *req = slow_request_new();
+	req->time = clock_realtime();
+	req->type = type;
+	req->sync = msg->header.sync;
+	struct session *session = msg->connection->session;
+	req->session_id = session != NULL ? session->id : 0;
+	req->total = total;
+	req->queue = msg->accept_time - msg->recv_time;
+	req->wal = f->storage.net.wal_time;
+	req->limbo = f->storage.net.limbo_time;
+	req->tx = MAX(total - req->queue - req->wal - req->limbo, 0);
+	req->lookups = f->storage.net.lookups;
+	req->scanned = f->storage.net.scanned;
+	const char *func = NULL;
+	uint32_t func_len = 0;
+	switch (type) {
+	case IPROTO_SELECT:
+		req->index_id = msg->dml.index_id;
+		FALLTHROUGH;
+	case IPROTO_INSERT:
+	case IPROTO_REPLACE:
+	case IPROTO_UPDATE:
+	case IPROTO_DELETE:
+	case IPROTO_UPSERT:
+		req->space_id = msg->dml.space_id;
+		break;
+	case IPROTO_CALL:
+	case IPROTO_CALL_16:
+		func = msg->call.name;
+		func = mp_decode_str(&func, &func_len);
+		break;
+	case IPROTO_EVAL:
+		func = msg->call.expr;
+		func = mp_decode_str(&func, &func_len);
+		break;
+	default:
+		break;
+	}
+	if (func != NULL)
+		slow_request_set_func(req, func, func_len);
+	say_warn_ratelimited("slow request %s: total %.3f sec, queue %.3f, "
+			     "tx %.3f, wal %.3f, limbo %.3f, lookups %llu, "
+			     "scanned %llu", iproto_type_name(type), total,
+			     req->queue, req->tx, req->wal, req->limbo,
+			     (unsigned long long)req->lookups,
+			     (unsigned long long)req->scanned);
+}
+
+/** Account the latency of a request processed by the TX thread. */
+static void
+tx_collect_latency(struct iproto_msg *msg)
+{
+	uint32_t type = msg->header.type;
+	if (type >= iproto_type_MAX || iproto_type_name(type) == NULL)
+		return;
+	double total = clock_monotonic() - msg->recv_time;
+	if (unlikely(slow_request_sample(total)))
+		tx_log_slow_request(msg, total);
+	struct iproto_req_latency *lat = tx_req_latency[type];
+	if (lat == NULL) {
+		lat = (struct iproto_req_latency *)xmalloc(sizeof(*lat));
+		if (latency_create_fine(&lat->queue) != 0 ||
+		    latency_create_fine(&lat->tx) != 0 ||
+		    latency_create_fine(&lat->wal) != 0)
+			panic("failed to allocate request latency histogram");
+		tx_req_latency[type] = lat;
+	}
+	double wal_time = fiber()->storage.net.wal_time;
+	double tx_time = clock_monotonic() - msg->accept_time - wal_time;
+	latency_collect(&lat->queue, msg->accept_time - msg->recv_time);
+	latency_collect(&lat->tx, MAX(tx_time, 0));
+	latency_collect(&lat->wal, wal_time);
+}
+
+/** Reset the latency statistics of all request types. */
+static void
+tx_reset_latency(void)
+{
+	for (int type = 0; type < iproto_type_MAX; type++) {
+		struct iproto_req_latency *lat = tx_req_latency[type];
+		if (lat == NULL)
+			continue;
+		histogram_reset(lat->queue.histogram);
+		histogram_reset(lat->tx.histogram);
+		histogram_reset(lat->wal.histogram);
+	}
+}
+
 static inline void
 tx_end_msg(struct iproto_msg *msg, struct obuf_svp *svp)
 {
+	tx_collect_latency(msg);
 	if (msg->stream != NULL) {
 		assert(msg->stream->txn == NULL);
 		msg->stream->txn = txn_detach();
@@ -2250,6 +2898,8 @@ tx_end_msg(struct iproto_msg *msg, struct obuf_svp *svp)
 	msg->connection->iproto_thread->tx.requests_in_progress--;
 	rlist_del(&msg->in_inprogress);
 	msg->fiber = NULL;
+	fiber()->storage.net.request = NULL;
+	tx_msg_save_session(msg);
 	struct obuf *out = msg->connection->tx.p_obuf;
 	if (msg->connection->tx.p_obuf->used != svp->used)
 		/* Log response to the flight recorder. */
@@ -2294,6 +2944,22 @@ tx_inject_delay(void)
 	});
 }
 
+/**
+ * Wait until this instance reaches the vclock passed by the client in
+ * IPROTO_WAIT_VCLOCK, if any.
+ */
+static int
+tx_wait_vclock(const struct request *req)
+{
+	if (req->wait_vclock == NULL)
+		return 0;
+	struct vclock vclock;
+	if (request_decode_wait_vclock(req, &vclock) != 0)
+		return -1;
+	double timeout = req->timeout > 0 ? req->timeout : TIMEOUT_INFINITY;
+	return box_wait_vclock(&vclock, ev_monotonic_now(loop()) + timeout);
+}
+
 static void
 tx_process_begin(struct cmsg *m)
 {
@@ -2411,8 +3077,9 @@ tx_resolve_space_and_index_name(struct request *dml)
 		}
 		dml->space_id = space->def->id;
 	}
-	if ((dml->type == IPROTO_SELECT || dml->type == IPROTO_UPDATE ||
-	     dml->type == IPROTO_DELETE) && dml->index_name != NULL) {
+	if ((dml->type == IPROTO_SELECT || dml->type == IPROTO_SELECT_MANY ||
+	     dml->type == IPROTO_UPDATE || dml->type == IPROTO_DELETE) &&
+	    dml->index_name != NULL) {
 		if (space == NULL)
 			space = space_cache_find(dml->space_id);
 		if (space == NULL)
@@ -2516,6 +3183,8 @@ tx_process_select(struct cmsg *m)
 		goto error;
 
 	tx_inject_delay();
+	if (tx_wait_vclock(req) != 0)
+		goto error;
 	if (tx_resolve_space_and_index_name(&msg->dml) != 0)
 		goto error;
 	packed_pos = req->after_position;
@@ -2532,8 +3201,9 @@ tx_process_select(struct cmsg *m)
 	}
 	rc = box_select(req->space_id, req->index_id,
 			req->iterator, req->offset, req->limit,
-			req->key, req->key_end, &packed_pos, &packed_pos_end,
-			req->fetch_position, &port);
+			req->key, req->key_end, req->fields, req->fields_end,
+			req->filter, req->filter_end, &packed_pos,
+			&packed_pos_end, req->fetch_position, true, &port);
 	if (rc < 0)
 		goto error;
 
@@ -2578,6 +3248,138 @@ tx_process_select(struct cmsg *m)
 	tx_end_msg(msg, &svp);
 }
 
+/**
+ * Looks up all keys of an IPROTO_SELECT_MANY request in one go and replies
+ * with an array of tuple arrays, one per key.
+ */
+static void
+tx_process_select_many(struct cmsg *m)
+{
+	struct iproto_msg *msg = tx_accept_msg(m);
+	bool box_tuple_as_ext =
+		iproto_features_test(&msg->connection->session->meta.features,
+				     IPROTO_FEATURE_DML_TUPLE_EXTENSION);
+	struct obuf *out;
+	struct obuf_svp svp;
+	struct port port;
+
+	struct mp_box_ctx ctx;
+	struct mp_ctx *ctx_ref = NULL;
+	if (box_tuple_as_ext) {
+		mp_box_ctx_create(&ctx, NULL, NULL);
+		ctx_ref = (struct mp_ctx *)&ctx;
+	}
+	auto ctx_guard = make_scoped_guard([ctx_ref] {
+		mp_ctx_destroy(ctx_ref);
+	});
+	ctx_guard.is_active = box_tuple_as_ext;
+
+	uint32_t key_count;
+	const char *key;
+	struct request *req = &msg->dml;
+	uint32_t region_svp = region_used(&fiber()->gc);
+	if (tx_check_msg(msg) != 0)
+		goto error;
+
+	tx_inject_delay();
+	if (tx_wait_vclock(req) != 0)
+		goto error;
+	if (tx_resolve_space_and_index_name(&msg->dml) != 0)
+		goto error;
+	key = req->key;
+	key_count = mp_decode_array(&key);
+	/*
+	 * Let the engine look up all the keys in parallel before
+	 * selecting them one by one. The error, if any, will be
+	 * reported by box_select().
+	 */
+	if ((req->iterator == ITER_EQ || req->iterator == ITER_REQ) &&
+	    box_index_prefetch(req->space_id, req->index_id,
+			       key, key_count) != 0)
+		diag_clear(diag_get());
+
+	out = msg->connection->tx.p_obuf;
+	iproto_prepare_select(out, &svp);
+	for (uint32_t i = 0; i < key_count; i++) {
+		if (mp_typeof(*key) != MP_ARRAY) {
+			diag_set(ClientError, ER_ILLEGAL_PARAMS,
+				 "key must be an array");
+			goto discard;
+		}
+		const char *key_end = key;
+		mp_next(&key_end);
+		const char *packed_pos = NULL, *packed_pos_end = NULL;
+		if (box_select(req->space_id, req->index_id, req->iterator,
+			       req->offset, req->limit, key, key_end,
+			       req->fields, req->fields_end, req->filter,
+			       req->filter_end, &packed_pos, &packed_pos_end,
+			       false, true, &port) != 0)
+			goto discard;
+		uint32_t found = ((struct port_c *)&port)->size;
+		char *header = (char *)xobuf_alloc(out, mp_sizeof_array(found));
+		mp_encode_array(header, found);
+		int count = port_dump_msgpack_16_with_ctx(&port, out, ctx_ref);
+		port_destroy(&port);
+		if (count < 0)
+			goto discard;
+		key = key_end;
+	}
+	if (box_tuple_as_ext &&
+	    tuple_format_map_to_iproto_obuf(&ctx.tuple_format_map, out) != 0)
+		goto discard;
+	iproto_reply_select(out, &svp, msg->header.sync, ::schema_version,
+			    key_count, box_tuple_as_ext);
+	region_truncate(&fiber()->gc, region_svp);
+	iproto_wpos_create(&msg->wpos, out);
+	tx_end_msg(msg, &svp);
+	return;
+discard:
+	/* Discard the prepared select. */
+	obuf_rollback_to_svp(out, &svp);
+error:
+	region_truncate(&fiber()->gc, region_svp);
+	out = msg->connection->tx.p_obuf;
+	svp = obuf_create_svp(out);
+	tx_reply_error(msg);
+	tx_end_msg(msg, &svp);
+}
+
+/**
+ * Inserts the tuples converted from the record batches of an
+ * IPROTO_INSERT_ARROW request in one transaction and replies with
+ * the number of inserted tuples.
+ */
+static void
+tx_process_insert_arrow(struct cmsg *m)
+{
+	struct iproto_msg *msg = tx_accept_msg(m);
+	struct obuf *out;
+	struct obuf_svp svp;
+	uint32_t count;
+	if (tx_check_msg(msg) != 0)
+		goto error;
+	tx_inject_delay();
+	if (tx_resolve_space_and_index_name(&msg->dml) != 0)
+		goto error;
+	if (box_insert_batch(msg->dml.space_id, msg->arrow_tuples,
+			     msg->arrow_tuples + msg->arrow_tuples_size,
+			     &count) != 0)
+		goto error;
+	out = msg->connection->tx.p_obuf;
+	iproto_prepare_select(out, &svp);
+	mp_encode_uint((char *)xobuf_alloc(out, mp_sizeof_uint(count)), count);
+	iproto_reply_select(out, &svp, msg->header.sync, ::schema_version,
+			    1, false);
+	iproto_wpos_create(&msg->wpos, out);
+	tx_end_msg(msg, &svp);
+	return;
+error:
+	out = msg->connection->tx.p_obuf;
+	svp = obuf_create_svp(out);
+	tx_reply_error(msg);
+	tx_end_msg(msg, &svp);
+}
+
 static int
 tx_process_call_on_yield(struct trigger *trigger, void *event)
 {
@@ -2733,6 +3535,11 @@ tx_process_misc(struct cmsg *m)
 		break;
 	case IPROTO_ID:
 		tx_process_id(con, &msg->id);
+		msg->start_compression =
+			iproto_features_test(&msg->id.features,
+					     IPROTO_FEATURE_COMPRESSION) &&
+			iproto_features_test(&IPROTO_CURRENT_FEATURES,
+					     IPROTO_FEATURE_COMPRESSION);
 		iproto_reply_id(out, box_auth_type, msg->header.sync,
 				::schema_version);
 		break;
@@ -3204,7 +4011,7 @@ iproto_msg_finish_processing_in_stream(struct iproto_msg *msg)
 		con->iproto_thread->requests_in_stream_queue--;
 		cpipe_push_input(&con->iproto_thread->tx_pipe,
 				 &stream->current->base);
-		cpipe_flush_input(&con->iproto_thread->tx_pipe);
+		iproto_flush_tx_pipe(con->iproto_thread);
 	}
 }
 
@@ -3214,6 +4021,8 @@ net_send_msg(struct cmsg *m)
 	struct iproto_msg *msg = (struct iproto_msg *) m;
 	struct iproto_connection *con = msg->connection;
 
+	USDT_PROBE(iproto_request_replied, msg, msg->header.type,
+		   msg->header.sync);
 	iproto_msg_finish_processing_in_stream(msg);
 	if (msg->len != 0) {
 		/* Discard request (see iproto_enqueue_batch()). */
@@ -3224,6 +4033,10 @@ net_send_msg(struct cmsg *m)
 		con->long_poll_count--;
 	}
 	con->wend = msg->wpos;
+	con->auth_token = msg->auth_token;
+	con->tuple_as_ext = msg->tuple_as_ext;
+	if (msg->start_compression && !con->is_compressed)
+		con->is_compression_pending = true;
 
 	if (con->state == IPROTO_CONNECTION_ALIVE) {
 		iproto_connection_feed_output(con);
@@ -3317,6 +4130,7 @@ tx_process_connect(struct cmsg *m)
 	if (session_run_on_connect_triggers(con->session) != 0)
 		goto error;
 	iproto_wpos_create(&msg->wpos, out);
+	tx_msg_save_session(msg);
 	return;
 error:
 	tx_reply_error(msg);
@@ -3355,6 +4169,8 @@ net_send_greeting(struct cmsg *m)
 	}
 	con->is_established = true;
 	con->wend = msg->wpos;
+	con->auth_token = msg->auth_token;
+	con->tuple_as_ext = msg->tuple_as_ext;
 	/*
 	 * Connect is synchronous, so no one could have been
 	 * messing up with the connection while it was in
@@ -3413,6 +4229,14 @@ net_cord_f(va_list  ap)
 {
 	struct iproto_thread *iproto_thread =
 		va_arg(ap, struct iproto_thread *);
+	/*
+	 * Bind the thread before allocating anything so that the
+	 * connection buffers and messages it touches first are
+	 * placed on the local NUMA node.
+	 */
+	if (iproto_cpu_set_is_set &&
+	    tt_cpu_set_bind_thread(&iproto_cpu_set) != 0)
+		diag_log();
 
 	mempool_create(&iproto_thread->iproto_msg_pool, &cord()->slabc,
 		       sizeof(struct iproto_msg));
@@ -3435,12 +4259,25 @@ net_cord_f(va_list  ap)
 	/* Create a pipe to "tx" thread. */
 	cpipe_create(&iproto_thread->tx_pipe, "tx");
 	cpipe_set_max_input(&iproto_thread->tx_pipe, iproto_msg_max / 2);
+	ev_timer_init(&iproto_thread->batch_timer, iproto_batch_timer_cb, 0, 0);
+	iproto_thread->batch_timer.data = iproto_thread;
+	trigger_create(&iproto_thread->on_tx_flush, iproto_on_tx_flush,
+		       iproto_thread, NULL);
+	trigger_add(&iproto_thread->tx_pipe.on_flush,
+		    &iproto_thread->on_tx_flush);
+	ev_timer_init(&iproto_thread->idle_timer, iproto_idle_timer_cb,
+		      IPROTO_IDLE_TIMEOUT, IPROTO_IDLE_TIMEOUT);
+	iproto_thread->idle_timer.data = iproto_thread;
+	ev_timer_start(loop(), &iproto_thread->idle_timer);
 
 	/* Process incomming messages. */
 	cbus_loop(&endpoint);
 
 	cbus_endpoint_destroy(&endpoint, cbus_process);
 	cpipe_destroy(&iproto_thread->tx_pipe);
+	ev_timer_stop(loop(), &iproto_thread->batch_timer);
+	ev_timer_stop(loop(), &iproto_thread->idle_timer);
+	trigger_clear(&iproto_thread->on_tx_flush);
 	evio_service_detach(&iproto_thread->binary);
 
 	mempool_destroy(&iproto_thread->iproto_stream_pool);
@@ -3621,6 +4458,12 @@ iproto_thread_init_routes(struct iproto_thread *iproto_thread)
 	iproto_thread->select_route[0] =
 		{ tx_process_select, &iproto_thread->net_pipe };
 	iproto_thread->select_route[1] = { net_send_msg, NULL };
+	iproto_thread->select_many_route[0] =
+		{ tx_process_select_many, &iproto_thread->net_pipe };
+	iproto_thread->select_many_route[1] = { net_send_msg, NULL };
+	iproto_thread->insert_arrow_route[0] =
+		{ tx_process_insert_arrow, &iproto_thread->net_pipe };
+	iproto_thread->insert_arrow_route[1] = { net_send_msg, NULL };
 	iproto_thread->process1_route[0] =
 		{ tx_process1, &iproto_thread->net_pipe };
 	iproto_thread->process1_route[1] = { net_send_msg, NULL };
@@ -3853,10 +4696,15 @@ TRIGGER(trigger_on_change, trigger_on_change_iproto_notify);
 
 /** Initialize the iproto subsystem and start network io thread */
 void
-iproto_init(int threads_count)
+iproto_init(int threads_count, const struct tt_cpu_set *cpus, bool reuseport)
 {
 	iproto_features_init();
 
+	iproto_reuseport = reuseport;
+	iproto_cpu_set_is_set = cpus != NULL;
+	if (cpus != NULL)
+		iproto_cpu_set = *cpus;
+
 	iproto_threads_count = 0;
 	struct session_vtab iproto_session_vtab = {
 		/* .push = */ iproto_session_push,
@@ -3868,9 +4716,11 @@ iproto_init(int threads_count)
 	 * we don't need any accept functions.
 	 */
 	evio_service_create(loop(), &tx_binary, "tx_binary", NULL, NULL);
+	tx_binary.reuseport = reuseport;
 	iproto_threads = (struct iproto_thread *)
 		xcalloc(threads_count, sizeof(struct iproto_thread));
 	fiber_cond_create(&drop_finished_cond);
+	fiber_cond_create(&iproto_read_view_cond);
 
 	for (int i = 0; i < threads_count; i++, iproto_threads_count++) {
 		struct iproto_thread *iproto_thread = &iproto_threads[i];
@@ -3922,6 +4772,29 @@ iproto_fill_stat(struct iproto_thread *iproto_thread,
 		mempool_count(&iproto_thread->iproto_msg_pool);
 	cfg_msg->stats->requests_in_stream_queue =
 		iproto_thread->requests_in_stream_queue;
+	memcpy(cfg_msg->stats->batch_hist, iproto_thread->batch_hist,
+	       sizeof(iproto_thread->batch_hist));
+	cfg_msg->stats->msg_max = iproto_msg_max;
+	cfg_msg->stats->msg_max_stops = iproto_thread->msg_max_stops;
+	cfg_msg->stats->idle_connections =
+		iproto_thread->idle_connection_count;
+}
+
+/**
+ * Starts accepting connections on the sockets bound by tx in an IPROTO
+ * thread. In the reuseport mode, the first thread shares the tx sockets
+ * while the others listen on their own ones, so that each thread has
+ * a separate accept queue and the kernel balances connections between
+ * them.
+ */
+static void
+iproto_thread_attach_binary(struct iproto_thread *iproto_thread)
+{
+	if (iproto_reuseport && iproto_thread->id > 0)
+		evio_service_attach_reuseport(&iproto_thread->binary,
+					      &tx_binary);
+	else
+		evio_service_attach(&iproto_thread->binary, &tx_binary);
 }
 
 static int
@@ -3941,10 +4814,30 @@ iproto_do_cfg_f(struct cbus_call_msg *m)
 			iproto_resume(iproto_thread);
 		break;
 	}
+	case IPROTO_CFG_BATCH_DELAY:
+		iproto_thread->batch_delay = cfg_msg->batch_delay;
+		break;
+	case IPROTO_CFG_CONNECTION_MSG_MAX: {
+		iproto_thread->connection_msg_max =
+			cfg_msg->connection_msg_max;
+		struct iproto_connection *con, *tmp;
+		rlist_foreach_entry_safe(con, &iproto_thread->connections,
+					 in_connections, tmp) {
+			if (con->is_stopped_by_connection_msg_max &&
+			    !iproto_connection_check_msg_max(con))
+				iproto_connection_resume_connection_msg_max(con);
+		}
+		break;
+	}
+	case IPROTO_CFG_READ_VIEW:
+		iproto_thread->read_view = cfg_msg->read_view.rv;
+		iproto_thread->read_view_staleness =
+			cfg_msg->read_view.staleness;
+		break;
 	case IPROTO_CFG_START:
 		if (iproto_thread->is_shutting_down)
 			break;
-		evio_service_attach(binary, &tx_binary);
+		iproto_thread_attach_binary(iproto_thread);
 		break;
 	case IPROTO_CFG_SHUTDOWN:
 		iproto_thread->is_shutting_down = true;
@@ -3954,7 +4847,7 @@ iproto_do_cfg_f(struct cbus_call_msg *m)
 		break;
 	case IPROTO_CFG_RESTART:
 		evio_service_detach(binary);
-		evio_service_attach(binary, &tx_binary);
+		iproto_thread_attach_binary(iproto_thread);
 		break;
 	case IPROTO_CFG_STAT:
 		iproto_fill_stat(iproto_thread, cfg_msg);
@@ -4163,7 +5056,9 @@ iproto_listen(const struct uri_set *uri_set)
 	 * Please note, we bind sockets in main thread, and then
 	 * listen these sockets in all iproto threads! With this
 	 * implementation, we rely on the Linux kernel to distribute
-	 * incoming connections across iproto threads.
+	 * incoming connections across iproto threads. In the
+	 * reuseport mode, the threads get own sockets bound to the
+	 * same addresses, see iproto_thread_attach_binary().
 	 */
 	if (evio_service_start(&tx_binary, uri_set) != 0)
 		return -1;
@@ -4183,6 +5078,12 @@ iproto_stats_add(struct iproto_stats *total_stats,
 		thread_stats->requests_in_stream_queue;
 	total_stats->requests_in_progress +=
 		thread_stats->requests_in_progress;
+	for (int i = 0; i < IPROTO_BATCH_HIST_SIZE; i++)
+		total_stats->batch_hist[i] += thread_stats->batch_hist[i];
+	total_stats->msg_max = MAX(total_stats->msg_max,
+				   thread_stats->msg_max);
+	total_stats->msg_max_stops += thread_stats->msg_max_stops;
+	total_stats->idle_connections += thread_stats->idle_connections;
 }
 
 void
@@ -4215,7 +5116,11 @@ iproto_reset_stat(void)
 	for (int i = 0; i < iproto_threads_count; i++) {
 		rmean_cleanup(iproto_threads[i].rmean);
 		rmean_cleanup(iproto_threads[i].tx.rmean);
+		memset(iproto_threads[i].batch_hist, 0,
+		       sizeof(iproto_threads[i].batch_hist));
+		iproto_threads[i].msg_max_stops = 0;
 	}
+	tx_reset_latency();
 }
 
 int
@@ -4237,6 +5142,112 @@ iproto_set_msg_max(int new_iproto_msg_max)
 	return 0;
 }
 
+int
+iproto_set_connection_msg_max(int msg_max)
+{
+	if (msg_max < 0) {
+		diag_set(ClientError, ER_CFG, "net_msg_max_per_connection",
+			 "must be greater than or equal to 0");
+		return -1;
+	}
+	struct iproto_cfg_msg cfg_msg;
+	iproto_cfg_msg_create(&cfg_msg, IPROTO_CFG_CONNECTION_MSG_MAX);
+	cfg_msg.connection_msg_max = msg_max;
+	for (int i = 0; i < iproto_threads_count; i++)
+		iproto_do_cfg(&iproto_threads[i], &cfg_msg);
+	return 0;
+}
+
+int
+iproto_set_batch_delay(double delay)
+{
+	if (delay < 0 || delay > IPROTO_BATCH_DELAY_MAX) {
+		diag_set(ClientError, ER_CFG, "net_batch_delay",
+			 tt_sprintf("must be greater than or equal to 0 and "
+				    "less than or equal to %g",
+				    IPROTO_BATCH_DELAY_MAX));
+		return -1;
+	}
+	struct iproto_cfg_msg cfg_msg;
+	iproto_cfg_msg_create(&cfg_msg, IPROTO_CFG_BATCH_DELAY);
+	cfg_msg.batch_delay = delay;
+	for (int i = 0; i < iproto_threads_count; i++)
+		iproto_do_cfg(&iproto_threads[i], &cfg_msg);
+	return 0;
+}
+
+/** Send a read view to all iproto threads and wait until it's set. */
+static void
+iproto_publish_read_view(struct iproto_read_view *rv)
+{
+	struct iproto_cfg_msg cfg_msg;
+	iproto_cfg_msg_create(&cfg_msg, IPROTO_CFG_READ_VIEW);
+	cfg_msg.read_view.rv = rv;
+	cfg_msg.read_view.staleness = iproto_read_view_staleness;
+	for (int i = 0; i < iproto_threads_count; i++)
+		iproto_do_cfg(&iproto_threads[i], &cfg_msg);
+}
+
+/**
+ * Periodically reopens the read view used by iproto threads for serving
+ * SELECT requests so that the data returned to clients is never older
+ * than iproto_read_view_staleness.
+ *
+ * Iproto threads use a read view without yielding so once a new read
+ * view is published to all threads, the old one may be closed.
+ */
+static int
+iproto_read_view_f(va_list ap)
+{
+	(void)ap;
+	struct iproto_read_view *rv = NULL;
+	while (!fiber_is_cancelled()) {
+		struct iproto_read_view *new_rv = NULL;
+		if (iproto_read_view_staleness > 0 && box_is_configured())
+			new_rv = iproto_read_view_new();
+		if (rv != NULL || new_rv != NULL)
+			iproto_publish_read_view(new_rv);
+		if (rv != NULL)
+			iproto_read_view_delete(rv);
+		rv = new_rv;
+		if (iproto_read_view_staleness > 0) {
+			fiber_cond_wait_timeout(&iproto_read_view_cond,
+						iproto_read_view_staleness / 2);
+		} else {
+			fiber_cond_wait(&iproto_read_view_cond);
+		}
+	}
+	if (rv != NULL) {
+		iproto_publish_read_view(NULL);
+		iproto_read_view_delete(rv);
+	}
+	return 0;
+}
+
+int
+iproto_set_read_view_staleness(double staleness)
+{
+	if (staleness < 0) {
+		diag_set(ClientError, ER_CFG, "iproto_read_view_staleness",
+			 "must be greater than or equal to 0");
+		return -1;
+	}
+	iproto_read_view_staleness = staleness;
+	if (iproto_read_view_fiber == NULL) {
+		if (staleness == 0)
+			return 0;
+		iproto_read_view_fiber = fiber_new_system("iproto_read_view",
+							  iproto_read_view_f);
+		if (iproto_read_view_fiber == NULL)
+			return -1;
+		fiber_set_joinable(iproto_read_view_fiber, true);
+		fiber_start(iproto_read_view_fiber);
+		return 0;
+	}
+	fiber_cond_signal(&iproto_read_view_cond);
+	return 0;
+}
+
 int
 iproto_session_new(struct iostream *io, struct user *user, uint64_t *sid)
 {
@@ -4308,6 +5319,11 @@ int
 iproto_shutdown(double timeout)
 {
 	assert(iproto_is_shutting_down);
+	if (iproto_read_view_fiber != NULL) {
+		fiber_cancel(iproto_read_view_fiber);
+		fiber_join(iproto_read_view_fiber);
+		iproto_read_view_fiber = NULL;
+	}
 	return iproto_drop_connections(timeout);
 }
 
@@ -4342,6 +5358,7 @@ iproto_free(void)
 	}
 	mh_i32ptr_delete(tx_req_handlers);
 	fiber_cond_destroy(&drop_finished_cond);
+	fiber_cond_destroy(&iproto_read_view_cond);
 
 	/*
 	 * Here we close sockets and unlink all unix socket paths.
@@ -35,11 +35,13 @@
 #include <stdint.h>
 
 #include "box/box.h"
+#include "latency.h"
 
 struct uri_set;
 struct session;
 struct user;
 struct iostream;
+struct tt_cpu_set;
 
 #if defined(__cplusplus)
 extern "C" {
@@ -60,10 +62,21 @@ enum {
 	 * processing stops until some new fibers are freed up.
 	 */
 	IPROTO_FIBER_POOL_SIZE_FACTOR = 5,
+	/** The max value net_msg_max_auto may raise net_msg_max to. */
+	IPROTO_MSG_MAX_AUTO_MAX = 16384,
 	/** Maximum count of iproto threads. */
 	IPROTO_THREADS_MAX = 1000,
+	/**
+	 * Number of buckets in the histogram of sizes of message batches
+	 * flushed to the tx thread. Bucket i counts batches of size in
+	 * [2^i, 2^(i+1)), the last bucket counts all bigger batches.
+	 */
+	IPROTO_BATCH_HIST_SIZE = 11,
 };
 
+/** The maximal value for net_batch_delay, in seconds. */
+#define IPROTO_BATCH_DELAY_MAX 0.1
+
 struct iproto_stats {
 	/** Size of memory used for storing network buffers. */
 	size_t mem_used;
@@ -77,6 +90,14 @@ struct iproto_stats {
 	size_t requests_in_progress;
 	/** Count of requests currently pending in stream queue. */
 	size_t requests_in_stream_queue;
+	/** Histogram of sizes of message batches flushed to tx thread. */
+	int64_t batch_hist[IPROTO_BATCH_HIST_SIZE];
+	/** The current limit on the number of requests in flight. */
+	int msg_max;
+	/** Number of times input was stopped by the limit above. */
+	int64_t msg_max_stops;
+	/** Number of connections with released input buffers. */
+	size_t idle_connections;
 };
 
 extern unsigned iproto_readahead;
@@ -107,6 +128,30 @@ iproto_thread_stats_get(struct iproto_stats *stats, int thread_id);
 void
 iproto_reset_stat(void);
 
+/**
+ * Latency of IPROTO requests of one type, broken down into the
+ * processing stages. Collected in the TX thread.
+ */
+struct iproto_req_latency {
+	/**
+	 * Time from the moment the request is read by an IPROTO
+	 * thread till the TX thread starts processing it.
+	 */
+	struct latency queue;
+	/** Time spent in the TX thread, excluding WAL writes. */
+	struct latency tx;
+	/** Time spent waiting for WAL writes. */
+	struct latency wal;
+};
+
+/**
+ * Return the latency statistics of the IPROTO requests of the
+ * given type or NULL if no such request has been processed.
+ * May be called only from the TX thread.
+ */
+struct iproto_req_latency *
+iproto_req_latency(uint32_t type);
+
 /**
  * Return count of the addresses currently served by iproto.
  */
@@ -141,8 +186,13 @@ int
 iproto_override(uint32_t req_type, iproto_handler_t cb,
 		iproto_handler_destroy_t destroy, void *ctx);
 
+/**
+ * Initialize IPROTO and start its threads. If @a cpus isn't NULL,
+ * the threads are bound to the given CPUs. If @a reuseport is set,
+ * each thread listens on its own SO_REUSEPORT socket.
+ */
 void
-iproto_init(int threads_count);
+iproto_init(int threads_count, const struct tt_cpu_set *cpus, bool reuseport);
 
 int
 iproto_listen(const struct uri_set *uri_set);
@@ -150,6 +200,33 @@ iproto_listen(const struct uri_set *uri_set);
 int
 iproto_set_msg_max(int iproto_msg_max);
 
+/**
+ * Sets the max number of requests of one connection processed at the
+ * same time. A connection that reaches the limit isn't read until one
+ * of its requests completes. Zero disables the limit.
+ * Returns 0 on success, -1 on invalid value (diagnostic is set).
+ */
+int
+iproto_set_connection_msg_max(int msg_max);
+
+/**
+ * Sets the maximal time an iproto thread may hold parsed requests before
+ * sending them to the tx thread, so that requests received from different
+ * connections are delivered in one batch. Zero disables the delay.
+ * Returns 0 on success, -1 on invalid value (diagnostic is set).
+ */
+int
+iproto_set_batch_delay(double delay);
+
+/**
+ * Sets the max age of data returned by SELECT requests served right in
+ * iproto threads from a read view of spaces with the iproto_read_view
+ * option. Zero disables serving requests in iproto threads.
+ * Returns 0 on success, -1 on invalid value (diagnostic is set).
+ */
+int
+iproto_set_read_view_staleness(double staleness);
+
 /**
  * Creates a new IPROTO session over the given IO stream. Doesn't yield.
  * Set the output parameter sid to the sid of newly created session.
@@ -218,7 +218,39 @@ extern const char *iproto_flag_bit_strs[];
 	/**
 	 * Flag indicating whether the transaction is synchronous.
 	 */								\
-	 _(IS_SYNC, 0x61, MP_BOOL)
+	 _(IS_SYNC, 0x61, MP_BOOL)					\
+	/**
+	 * Compression algorithm of the replication stream requested by
+	 * a replica in SUBSCRIBE and confirmed by the master in the
+	 * response.
+	 */								\
+	_(COMPRESSION, 0x62, MP_STR)					\
+	/**
+	 * Vclock the instance must reach before executing a SELECT
+	 * request. Waiting is limited by IPROTO_TIMEOUT if it's set.
+	 */								\
+	_(WAIT_VCLOCK, 0x63, MP_MAP)					\
+	/**
+	 * Fields of tuples returned by a SELECT request: an array of
+	 * 0-based field numbers and field names or JSON paths.
+	 */								\
+	_(FIELDS, 0x64, MP_ARRAY)					\
+	/**
+	 * Filter expression of a SELECT request. Only tuples matching
+	 * it are returned.
+	 */								\
+	_(FILTER, 0x65, MP_ARRAY)					\
+	/**
+	 * Ids of the user spaces whose rows a replica needs, sent in
+	 * SUBSCRIBE and confirmed by the master in the response. Rows
+	 * of the other user spaces are replaced with NOPs.
+	 */								\
+	_(SPACE_FILTER, 0x66, MP_ARRAY)					\
+	/**
+	 * Stream in the Apache Arrow IPC streaming format holding the
+	 * record batches to insert with IPROTO_INSERT_ARROW.
+	 */								\
+	_(ARROW, 0x67, MP_BIN)
 
 #define IPROTO_KEY_MEMBER(s, v, ...) IPROTO_ ## s = v,
 
@@ -331,6 +363,18 @@ iproto_key_bit(unsigned char key)
 	_(COMMIT, 15)							\
 	/* Rollback transaction */					\
 	_(ROLLBACK, 16)							\
+	/**
+	 * SELECT request with multiple keys. IPROTO_KEY is an array of
+	 * keys, each of which is looked up as in IPROTO_SELECT. IPROTO_DATA
+	 * in the response is an array of tuple arrays, one per key.
+	 */								\
+	_(SELECT_MANY, 17)						\
+	/**
+	 * Insert the rows of the record batches of IPROTO_ARROW into
+	 * a space in one transaction. IPROTO_DATA in the response is
+	 * an array holding the number of inserted tuples.
+	 */								\
+	_(INSERT_ARROW, 18)						\
 									\
 	_(RAFT, 30)							\
 	/** PROMOTE request. */						\
@@ -595,6 +639,8 @@ request_replace_body_create(struct request_replace_body *body,
 	_(BLOOM_FILTER, 7)						\
 	/** Number of statements of each type (map). */			\
 	_(STMT_STAT, 8)							\
+	/** zstd dictionary used for compressing pages. */		\
+	_(ZSTD_DICT, 9)							\
 
 #define VY_RUN_INFO_KEY_MEMBER(s, v) VY_RUN_INFO_ ## s = v,
 
@@ -77,6 +77,14 @@ extern "C" {
 	 * tuple formats are received in IPROTO_TUPLE_FORMATS field.
 	 */								\
 	_(CALL_ARG_TUPLE_EXTENSION, 9)					\
+	/**
+	 * Connection compression support: if both the IPROTO_ID request
+	 * and the response have this feature bit set, all data sent over
+	 * the connection after the response is compressed with zstd in
+	 * both directions. A client that sets the bit must not send any
+	 * other request until it receives the response.
+	 */								\
+	_(COMPRESSION, 10)						\
 
 #define IPROTO_FEATURE_MEMBER(s, v) IPROTO_FEATURE_ ## s = v,
 
@@ -101,7 +109,7 @@ struct iproto_features {
  * `box.iproto.protocol_version` needs to be updated correspondingly.
  */
 enum {
-	IPROTO_CURRENT_VERSION = 7,
+	IPROTO_CURRENT_VERSION = 11,
 };
 
 /**
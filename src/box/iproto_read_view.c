@@ -0,0 +1,198 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2023, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#include "iproto_read_view.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "diag.h"
+#include "index.h"
+#include "index_def.h"
+#include "iterator_type.h"
+#include "msgpuck.h"
+#include "read_view.h"
+#include "schema.h"
+#include "small/obuf.h"
+#include "small/rlist.h"
+#include "space.h"
+#include "say.h"
+#include "trivia/util.h"
+#include "user.h"
+#include "xrow.h"
+
+static_assert(BOX_USER_MAX <= 64, "auth tokens must fit in a 64-bit mask");
+
+enum {
+	/**
+	 * Max number of tuples a SELECT may visit in an iproto thread.
+	 * Larger requests are forwarded to the tx thread so as not to
+	 * stall the network.
+	 */
+	IPROTO_READ_VIEW_SELECT_SCAN_MAX = 1000,
+};
+
+static bool
+iproto_read_view_filter_space(struct space *space, void *arg)
+{
+	(void)arg;
+	return space_is_memtx(space) && space->def->opts.iproto_read_view &&
+	       space->upgrade == NULL;
+}
+
+static bool
+iproto_read_view_filter_index(struct space *space, struct index *index,
+			      void *arg)
+{
+	(void)space;
+	(void)arg;
+	return index->def->type == TREE && !index->def->key_def->is_multikey &&
+	       !index->def->key_def->for_func_index;
+}
+
+/**
+ * Returns the bit mask of auth tokens of users that have read access
+ * to the given space.
+ */
+static uint64_t
+iproto_read_view_space_readers(struct space *space)
+{
+	uint64_t readers = 0;
+	for (int token = 0; token < BOX_USER_MAX; token++) {
+		struct user *user = user_find_by_token(token);
+		if (user->def == NULL)
+			continue;
+		struct credentials cr;
+		credentials_create(&cr, user);
+		if (space_access_is_granted(space, &cr, PRIV_R))
+			readers |= (uint64_t)1 << token;
+		credentials_destroy(&cr);
+	}
+	return readers;
+}
+
+struct iproto_read_view *
+iproto_read_view_new(void)
+{
+	if (!rlist_empty(&box_on_select))
+		return NULL;
+	struct iproto_read_view *rv = xmalloc(sizeof(*rv));
+	struct read_view_opts opts;
+	read_view_opts_create(&opts);
+	opts.name = "iproto";
+	opts.is_system = true;
+	opts.filter_space = iproto_read_view_filter_space;
+	opts.filter_index = iproto_read_view_filter_index;
+	opts.enable_data_temporary_spaces = true;
+	if (read_view_open(&rv->base, &opts) != 0) {
+		diag_log();
+		free(rv);
+		return NULL;
+	}
+	uint32_t space_count = 0;
+	struct space_read_view *space_rv;
+	read_view_foreach_space(space_rv, &rv->base)
+		space_count++;
+	if (space_count == 0) {
+		read_view_close(&rv->base);
+		free(rv);
+		return NULL;
+	}
+	rv->schema_version = schema_version;
+	rv->space_count = space_count;
+	rv->spaces = xmalloc(space_count * sizeof(*rv->spaces));
+	uint32_t i = 0;
+	read_view_foreach_space(space_rv, &rv->base) {
+		struct space *space = space_by_id(space_rv->id);
+		assert(space != NULL);
+		rv->spaces[i].space = space_rv;
+		rv->spaces[i].readers = iproto_read_view_space_readers(space);
+		i++;
+	}
+	return rv;
+}
+
+void
+iproto_read_view_delete(struct iproto_read_view *rv)
+{
+	read_view_close(&rv->base);
+	free(rv->spaces);
+	free(rv);
+}
+
+/** Looks up a space in an iproto read view by id. */
+static struct iproto_read_view_space *
+iproto_read_view_space(struct iproto_read_view *rv, uint32_t space_id)
+{
+	for (uint32_t i = 0; i < rv->space_count; i++) {
+		if (rv->spaces[i].space->id == space_id)
+			return &rv->spaces[i];
+	}
+	return NULL;
+}
+
+bool
+iproto_read_view_select(struct iproto_read_view *rv,
+			const struct request *request, uint64_t sync,
+			uint8_t auth_token, struct obuf *out)
+{
+	if (request->space_name != NULL || request->index_name != NULL ||
+	    request->after_position != NULL || request->after_tuple != NULL ||
+	    request->fetch_position || request->iterator > ITER_GT)
+		return false;
+	struct iproto_read_view_space *space =
+		iproto_read_view_space(rv, request->space_id);
+	if (space == NULL || auth_token >= BOX_USER_MAX ||
+	    (space->readers & ((uint64_t)1 << auth_token)) == 0)
+		return false;
+	struct index_read_view *index =
+		space_read_view_index(space->space, request->index_id);
+	if (index == NULL)
+		return false;
+	enum iterator_type type = (enum iterator_type)request->iterator;
+	const char *key = request->key;
+	uint32_t part_count = key != NULL ? mp_decode_array(&key) : 0;
+	struct index_read_view_iterator it;
+	if (key_validate(index->def, type, key, part_count) != 0 ||
+	    index_read_view_create_iterator(index, type, key, part_count,
+					    &it) != 0) {
+		diag_clear(diag_get());
+		return false;
+	}
+	struct obuf_svp svp;
+	iproto_prepare_select(out, &svp);
+	uint32_t offset = request->offset;
+	uint32_t count = 0;
+	uint32_t scanned = 0;
+	int rc = 0;
+	while (count < request->limit) {
+		if (++scanned > IPROTO_READ_VIEW_SELECT_SCAN_MAX) {
+			rc = -1;
+			break;
+		}
+		struct read_view_tuple tuple;
+		rc = index_read_view_iterator_next_raw(&it, &tuple);
+		if (rc != 0 || tuple.data == NULL)
+			break;
+		assert(!tuple.needs_upgrade);
+		if (offset > 0) {
+			offset--;
+			continue;
+		}
+		xobuf_dup(out, tuple.data, tuple.size);
+		count++;
+	}
+	index_read_view_iterator_destroy(&it);
+	if (rc != 0) {
+		diag_clear(diag_get());
+		obuf_rollback_to_svp(out, &svp);
+		return false;
+	}
+	iproto_reply_select(out, &svp, sync, rv->schema_version, count, false);
+	return true;
+}
@@ -0,0 +1,75 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2023, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "read_view.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+struct obuf;
+struct request;
+
+/** Space included into an iproto read view. */
+struct iproto_read_view_space {
+	/** Space read view. */
+	struct space_read_view *space;
+	/**
+	 * Bit mask of auth tokens of users that were granted read access
+	 * to the space at the time the read view was opened.
+	 */
+	uint64_t readers;
+};
+
+/**
+ * Read view used by iproto threads to serve SELECT requests without
+ * going to the tx thread. Includes tree indexes of memtx spaces with
+ * the iproto_read_view option set. Opened and closed in the tx thread.
+ */
+struct iproto_read_view {
+	/** Base class. */
+	struct read_view base;
+	/** Schema version at the time the read view was opened. */
+	uint64_t schema_version;
+	/** Number of entries in the spaces array. */
+	uint32_t space_count;
+	/** Spaces included into the read view. */
+	struct iproto_read_view_space *spaces;
+};
+
+/**
+ * Opens a new iproto read view. Returns NULL if there are no spaces
+ * to include or the read view can't be used, for example, because
+ * there are box.on_select triggers set. Errors are logged.
+ */
+struct iproto_read_view *
+iproto_read_view_new(void);
+
+/** Closes an iproto read view and frees it. */
+void
+iproto_read_view_delete(struct iproto_read_view *rv);
+
+/**
+ * Executes a SELECT request in a read view and encodes the reply to
+ * the given output buffer. May be called from any thread.
+ *
+ * Returns false without writing anything to the output buffer if
+ * the request can't be served from the read view (the space isn't
+ * included, access is denied, the request is invalid, etc) and
+ * should be executed in the tx thread instead. Never sets diag.
+ */
+bool
+iproto_read_view_select(struct iproto_read_view *rv,
+			const struct request *request, uint64_t sync,
+			uint8_t auth_token, struct obuf *out);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
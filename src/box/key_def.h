@@ -196,6 +196,19 @@ struct key_def {
 	tuple_hint_t tuple_hint;
 	/** @see key_hint() */
 	key_hint_t key_hint;
+	/**
+	 * Number of leading key parts that are used for computing
+	 * comparison hints. Two hints of keys that have less parts
+	 * are compared only by the bits of the present parts.
+	 */
+	uint32_t hint_part_count;
+	/**
+	 * True if tuple hints are never HINT_NONE so that hints of
+	 * all tuples are totally ordered and a search in a sorted
+	 * array of tuples can be narrowed by hints without looking
+	 * up tuple data, see key_hint_range().
+	 */
+	bool hint_is_total;
 	/**
 	 * Minimal part count which always is unique. For example,
 	 * if a secondary index is unique, then
@@ -1180,6 +1193,37 @@ key_hint(const char *key, uint32_t part_count, struct key_def *key_def)
 	return key_def->key_hint(key, part_count, key_def);
 }
 
+/**
+ * Get the range of hints that tuples equal to a key may have.
+ * Tuples with a lesser hint are less than the key while tuples
+ * with a greater hint are greater than the key.
+ * @param hint - hint of the key, see key_hint()
+ * @param part_count - number of parts in the key
+ * @param key_def - key_def used for tuple comparison
+ * @param[out] lo - min hint of a tuple equal to the key
+ * @param[out] hi - max hint of a tuple equal to the key
+ * @return - false if tuple hints can't be used to order tuples
+ *           relative to the key, see key_def::hint_is_total
+ */
+static inline bool
+key_hint_range(hint_t hint, uint32_t part_count, struct key_def *key_def,
+	       hint_t *lo, hint_t *hi)
+{
+	if (!key_def->hint_is_total || hint == HINT_NONE)
+		return false;
+	*lo = *hi = hint;
+	if (part_count < key_def->hint_part_count) {
+		assert(part_count > 0);
+		/* See key_hint_cmp(). */
+		uint32_t shift = HINT_PACKED_PART_BITS *
+				 (key_def->hint_part_count - part_count);
+		hint_t mask = (1ULL << shift) - 1;
+		*lo &= ~mask;
+		*hi |= mask;
+	}
+	return true;
+}
+
 #if defined(__cplusplus)
 } /* extern "C" */
 #endif /* defined(__cplusplus) */
@@ -42,16 +42,60 @@
 #include "tt_static.h"
 #include "tuple.h"
 
-int
-key_list_iterator_create(struct key_list_iterator *it, struct tuple *tuple,
-			 struct index_def *index_def, bool validate,
-			 struct tuple_format *format)
+/**
+ * Initialize a key list iterator over the value returned by
+ * the functional index function, which is encoded as a MsgPack
+ * array [key_data, key_data + key_data_sz).
+ */
+static int
+key_list_iterator_init(struct key_list_iterator *it, struct tuple *tuple,
+		       struct index_def *index_def, bool validate,
+		       struct tuple_format *format, const char *key_data,
+		       uint32_t key_data_sz)
 {
 	it->index_def = index_def;
 	it->validate = validate;
 	it->tuple = tuple;
 	it->format = format;
+	it->data_end = key_data + key_data_sz;
+	assert(mp_typeof(*key_data) == MP_ARRAY);
+	if (mp_decode_array(&key_data) != 1) {
+		struct space *space = space_by_id(index_def->space_id);
+		/*
+		 * Function return doesn't follow the
+		 * convention: to many values were returned.
+		 * i.e. return 1, 2
+		 */
+		diag_set(ClientError, ER_FUNC_INDEX_FORMAT, index_def->name,
+			 space ? space_name(space) : "",
+			 "to many values were returned");
+		return -1;
+	}
+	struct func *func = index_def->key_def->func_index_func;
+	if (func->def->opts.is_multikey) {
+		if (mp_typeof(*key_data) != MP_ARRAY) {
+			struct space * space = space_by_id(index_def->space_id);
+			/*
+			 * Multikey function must return an array
+			 * of keys.
+			 */
+			diag_set(ClientError, ER_FUNC_INDEX_FORMAT,
+				 index_def->name,
+				 space ? space_name(space) : "",
+				 "a multikey function mustn't return a scalar");
+			return -1;
+		}
+		(void)mp_decode_array(&key_data);
+	}
+	it->data = key_data;
+	return 0;
+}
 
+int
+key_list_iterator_create(struct key_list_iterator *it, struct tuple *tuple,
+			 struct index_def *index_def, bool validate,
+			 struct tuple_format *format)
+{
 	struct region *region = &fiber()->gc;
 	size_t region_svp = region_used(region);
 	struct func *func = index_def->key_def->func_index_func;
@@ -80,39 +124,52 @@ key_list_iterator_create(struct key_list_iterator *it, struct tuple *tuple,
 			 "can't get a value returned by function");
 		return -1;
 	}
+	if (key_list_iterator_init(it, tuple, index_def, validate, format,
+				   key_data, key_data_sz) != 0) {
+		region_truncate(region, region_svp);
+		return -1;
+	}
+	return 0;
+}
 
-	it->data_end = key_data + key_data_sz;
-	assert(mp_typeof(*key_data) == MP_ARRAY);
-	if (mp_decode_array(&key_data) != 1) {
+int
+key_list_iterator_create_batch(struct key_list_iterator *its,
+			       struct tuple **tuples, uint32_t count,
+			       struct index_def *index_def, bool validate,
+			       struct tuple_format *format)
+{
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	struct func *func = index_def->key_def->func_index_func;
+
+	struct port *in_ports = xregion_alloc_array(region, struct port, count);
+	struct func_batch_result *results =
+		xregion_alloc_array(region, struct func_batch_result, count);
+	for (uint32_t i = 0; i < count; i++) {
+		port_c_create(&in_ports[i]);
+		port_c_add_tuple(&in_ports[i], tuples[i]);
+	}
+	int rc = func_call_batch_no_access_check(func, in_ports, count,
+						 results);
+	for (uint32_t i = 0; i < count; i++)
+		port_destroy(&in_ports[i]);
+	if (rc != 0) {
+		/* Can't evaluate function. */
 		struct space *space = space_by_id(index_def->space_id);
-		/*
-		 * Function return doesn't follow the
-		 * convention: to many values were returned.
-		 * i.e. return 1, 2
-		 */
-		region_truncate(region, region_svp);
-		diag_set(ClientError, ER_FUNC_INDEX_FORMAT, index_def->name,
+		diag_add(ClientError, ER_FUNC_INDEX_FUNC, index_def->name,
 			 space ? space_name(space) : "",
-			 "to many values were returned");
+			 "can't evaluate function");
+		region_truncate(region, region_svp);
 		return -1;
 	}
-	if (func->def->opts.is_multikey) {
-		if (mp_typeof(*key_data) != MP_ARRAY) {
-			struct space * space = space_by_id(index_def->space_id);
-			/*
-			 * Multikey function must return an array
-			 * of keys.
-			 */
+	for (uint32_t i = 0; i < count; i++) {
+		if (key_list_iterator_init(&its[i], tuples[i], index_def,
+					   validate, format, results[i].data,
+					   results[i].size) != 0) {
 			region_truncate(region, region_svp);
-			diag_set(ClientError, ER_FUNC_INDEX_FORMAT,
-				 index_def->name,
-				 space ? space_name(space) : "",
-				 "a multikey function mustn't return a scalar");
 			return -1;
 		}
-		(void)mp_decode_array(&key_data);
 	}
-	it->data = key_data;
 	return 0;
 }
 
@@ -90,6 +90,23 @@ key_list_iterator_create(struct key_list_iterator *it, struct tuple *tuple,
 			 struct index_def *index_def, bool validate,
 			 struct tuple_format *format);
 
+/**
+ * Initialize @a count key list iterators, one for each of @a tuples.
+ *
+ * Same as calling key_list_iterator_create() for each tuple, but
+ * the functional index function is called for all the tuples in
+ * one batch, see func_call_batch_no_access_check(). The i-th
+ * iterator in @a its is initialized over the keys of tuples[i].
+ *
+ * @retval 0 in case of success
+ * @retval -1 on function error, validation error, memory error.
+ */
+int
+key_list_iterator_create_batch(struct key_list_iterator *its,
+			       struct tuple **tuples, uint32_t count,
+			       struct index_def *index_def, bool validate,
+			       struct tuple_format *format);
+
 /**
  * Return the next key and advance the iterator state.
  * If the iterator is exhausted, the value is set to NULL.
@@ -0,0 +1,374 @@
+-- Incrementally maintained aggregate views.
+--
+-- A view is a fully temporary memtx space that stores the result
+-- of a GROUP BY query over a source memtx space: one tuple per
+-- group consisting of the group key, the number of source tuples
+-- in the group and the requested aggregates. The view is updated
+-- from an on_replace trigger of the source space in the same
+-- transaction as the source, so a reader may get the aggregates
+-- of a group with a plain primary key lookup.
+--
+-- Since the view space is temporary, it is empty after restart,
+-- and create() should be called again to rebuild it.
+
+local trigger = require('trigger')
+
+local SUPPORTED_FUNCS = {
+    sum = true,
+    min = true,
+    max = true,
+}
+
+local NUMERIC_TYPES = {
+    number = true,
+    integer = true,
+    unsigned = true,
+    double = true,
+}
+
+local ORDERED_TYPES = {
+    number = true,
+    integer = true,
+    unsigned = true,
+    double = true,
+    string = true,
+}
+
+-- Views by name.
+local views = {}
+
+local function trigger_event(view)
+    return ('box.space[%d].on_replace'):format(view.source_id)
+end
+
+local function trigger_name(view)
+    return 'aggregate_view.' .. view.name
+end
+
+local function check_param(cond, fmt, ...)
+    if not cond then
+        box.error(box.error.ILLEGAL_PARAMS, fmt:format(...))
+    end
+end
+
+-- Returns the number and the format of a field of the source
+-- space referenced by a name or a number.
+local function source_field(source, format, field, param)
+    local fieldno
+    if type(field) == 'number' then
+        fieldno = field
+    elseif type(field) == 'string' then
+        for i, f in ipairs(format) do
+            if f.name == field then
+                fieldno = i
+                break
+            end
+        end
+    end
+    check_param(fieldno ~= nil and format[fieldno] ~= nil,
+                "%s: field '%s' is not found in the format of space '%s'",
+                param, tostring(field), source.name)
+    return fieldno, format[fieldno]
+end
+
+-- Returns the index of the source space that may be used to
+-- iterate over the tuples of a group, if any.
+local function find_group_index(source, group_by)
+    for _, index in pairs(source.index) do
+        if type(index) == 'table' or type(index) == 'cdata' then
+            local parts = index.parts
+            local match = #parts >= #group_by and index.type == 'TREE'
+            for i, fieldno in ipairs(group_by) do
+                if not match then
+                    break
+                end
+                match = parts[i].fieldno == fieldno and
+                        parts[i].path == nil
+            end
+            if match then
+                return index
+            end
+        end
+    end
+    return nil
+end
+
+local function group_key(view, tuple)
+    local key = {}
+    for i, fieldno in ipairs(view.group_by) do
+        key[i] = tuple[fieldno]
+    end
+    return key
+end
+
+-- Recomputes all MIN and MAX aggregates of a group from scratch.
+-- Called when the current minimum or maximum is removed.
+local function recompute_min_max(view, key, ops)
+    local values = {}
+    local source = box.space[view.source_id]
+    local function account(tuple)
+        for i, agg in ipairs(view.aggregates) do
+            if agg.func ~= 'sum' then
+                local v = tuple[agg.fieldno]
+                local cur = values[i]
+                if v ~= nil and (cur == nil or
+                                 (agg.func == 'min' and v < cur) or
+                                 (agg.func == 'max' and v > cur)) then
+                    values[i] = v
+                end
+            end
+        end
+    end
+    if view.group_index ~= nil then
+        local index = source.index[view.group_index]
+        for _, tuple in index:pairs(key, {iterator = 'EQ'}) do
+            account(tuple)
+        end
+    else
+        for _, tuple in source:pairs() do
+            local match = true
+            for i, fieldno in ipairs(view.group_by) do
+                if tuple[fieldno] ~= key[i] then
+                    match = false
+                    break
+                end
+            end
+            if match then
+                account(tuple)
+            end
+        end
+    end
+    for i, agg in ipairs(view.aggregates) do
+        if agg.func ~= 'sum' then
+            table.insert(ops, {'=', #view.group_by + 1 + i,
+                               values[i] == nil and box.NULL or values[i]})
+        end
+    end
+end
+
+-- Accounts a tuple inserted into the source space.
+local function view_add(view, tuple)
+    local space = box.space[view.space_id]
+    local key = group_key(view, tuple)
+    local row = space:get(key)
+    local group_size = #view.group_by
+    if row == nil then
+        local new_row = key
+        table.insert(new_row, 1)
+        for _, agg in ipairs(view.aggregates) do
+            local v = tuple[agg.fieldno]
+            if agg.func == 'sum' then
+                v = v or 0
+            end
+            table.insert(new_row, v == nil and box.NULL or v)
+        end
+        space:insert(new_row)
+        return
+    end
+    local ops = {{'+', group_size + 1, 1}}
+    for i, agg in ipairs(view.aggregates) do
+        local fieldno = group_size + 1 + i
+        local v = tuple[agg.fieldno]
+        local cur = row[fieldno]
+        -- NULL values are skipped.
+        if v == nil then
+            goto continue
+        end
+        if agg.func == 'sum' then
+            table.insert(ops, {'+', fieldno, v})
+        elseif cur == nil or (agg.func == 'min' and v < cur) or
+               (agg.func == 'max' and v > cur) then
+            table.insert(ops, {'=', fieldno, v})
+        end
+        ::continue::
+    end
+    space:update(key, ops)
+end
+
+-- Accounts a tuple deleted from the source space.
+local function view_remove(view, tuple)
+    local space = box.space[view.space_id]
+    local key = group_key(view, tuple)
+    local row = space:get(key)
+    assert(row ~= nil)
+    local group_size = #view.group_by
+    if row[group_size + 1] == 1 then
+        space:delete(key)
+        return
+    end
+    local ops = {{'-', group_size + 1, 1}}
+    local need_recompute = false
+    for i, agg in ipairs(view.aggregates) do
+        local fieldno = group_size + 1 + i
+        local v = tuple[agg.fieldno]
+        if v == nil then
+            goto continue
+        end
+        if agg.func == 'sum' then
+            table.insert(ops, {'-', fieldno, v})
+        elseif v == row[fieldno] then
+            need_recompute = true
+        end
+        ::continue::
+    end
+    if need_recompute then
+        -- The source space already has the tuple removed.
+        recompute_min_max(view, key, ops)
+    end
+    space:update(key, ops)
+end
+
+local function view_on_replace(view, old_tuple, new_tuple)
+    if old_tuple ~= nil then
+        view_remove(view, old_tuple)
+    end
+    if new_tuple ~= nil then
+        view_add(view, new_tuple)
+    end
+end
+
+local function view_attach(view)
+    local source = box.space[view.source_id]
+    local space = box.space[view.space_id]
+    -- The space is temporary, so nothing below yields, and no
+    -- source change can be missed before the trigger is set.
+    local keys = {}
+    for _, tuple in space:pairs() do
+        table.insert(keys, tuple:totable(1, #view.group_by))
+    end
+    for _, key in ipairs(keys) do
+        space:delete(key)
+    end
+    for _, tuple in source:pairs() do
+        view_add(view, tuple)
+    end
+    trigger.set(trigger_event(view), trigger_name(view),
+                function(old_tuple, new_tuple)
+                    view_on_replace(view, old_tuple, new_tuple)
+                end)
+end
+
+local function view_detach(view)
+    trigger.del(trigger_event(view), trigger_name(view))
+end
+
+--
+-- Creates an aggregate view or rebuilds an existing one.
+--
+-- opts.source     - name of the source space.
+-- opts.group_by   - non-empty array of source fields (names or
+--                   numbers) to group by, the fields can't be
+--                   nullable.
+-- opts.aggregates - array of {name = <view field name>,
+--                   func = 'sum' | 'min' | 'max',
+--                   field = <source field>}.
+--
+-- The view space format is the group_by fields, the 'count'
+-- field with the number of tuples in the group and then the
+-- aggregates. NULL values are skipped by the aggregates.
+--
+local function create(name, opts)
+    check_param(type(name) == 'string', 'name should be a string')
+    check_param(type(opts) == 'table', 'options should be a table')
+    check_param(type(opts.source) == 'string',
+                'source should be a space name')
+    local source = box.space[opts.source]
+    check_param(source ~= nil, "space '%s' does not exist", opts.source)
+    check_param(source.engine == 'memtx',
+                "space '%s' is not a memtx space", opts.source)
+    local format = source:format()
+    local group_by = opts.group_by or {}
+    local aggregates = opts.aggregates or {}
+    check_param(type(group_by) == 'table' and #group_by > 0,
+                'group_by should be a non-empty table')
+    check_param(type(aggregates) == 'table',
+                'aggregates should be a table')
+
+    local view_format = {}
+    local view = {
+        name = name,
+        source_id = source.id,
+        group_by = {},
+        aggregates = {},
+    }
+    for i, field in ipairs(group_by) do
+        local fieldno, def = source_field(source, format, field, 'group_by')
+        check_param(not def.is_nullable,
+                    "group_by: field '%s' is nullable", def.name)
+        view.group_by[i] = fieldno
+        table.insert(view_format, {name = def.name, type = def.type,
+                                   collation = def.collation})
+    end
+    table.insert(view_format, {name = 'count', type = 'unsigned'})
+    for i, agg in ipairs(aggregates) do
+        local param = ('aggregates[%d]'):format(i)
+        check_param(type(agg) == 'table' and type(agg.name) == 'string',
+                    '%s.name should be a string', param)
+        check_param(SUPPORTED_FUNCS[agg.func],
+                    "%s.func should be one of 'sum', 'min', 'max'", param)
+        local fieldno, def = source_field(source, format, agg.field,
+                                          param .. '.field')
+        local types = agg.func == 'sum' and NUMERIC_TYPES or ORDERED_TYPES
+        check_param(types[def.type], "%s: field '%s' has unsupported type",
+                    param, def.name)
+        view.aggregates[i] = {func = agg.func, fieldno = fieldno}
+        table.insert(view_format, {
+            name = agg.name,
+            type = agg.func == 'sum' and 'number' or def.type,
+            is_nullable = agg.func ~= 'sum',
+        })
+    end
+    local group_index = find_group_index(source, view.group_by)
+    view.group_index = group_index and group_index.id
+
+    if views[name] ~= nil then
+        view_detach(views[name])
+        views[name] = nil
+    end
+    local space = box.space[name]
+    if space == nil then
+        space = box.schema.space.create(name, {
+            type = 'temporary',
+            format = view_format,
+        })
+        local parts = {}
+        for i = 1, #view.group_by do
+            table.insert(parts, {i, view_format[i].type,
+                                 collation = view_format[i].collation})
+        end
+        space:create_index('primary', {parts = parts})
+    else
+        -- The view is rebuilt, e.g. after restart.
+        local space_format = space:format()
+        local match = #space_format == #view_format
+        for i = 1, #view_format do
+            match = match and space_format[i].name == view_format[i].name
+        end
+        check_param(match, "space '%s' exists and is not an aggregate " ..
+                    "view with the given options", name)
+    end
+    view.space_id = space.id
+    view_attach(view)
+    views[name] = view
+    return space
+end
+
+--
+-- Drops an aggregate view.
+--
+local function drop(name)
+    check_param(type(name) == 'string', 'name should be a string')
+    local view = views[name]
+    check_param(view ~= nil, "aggregate view '%s' does not exist", name)
+    view_detach(view)
+    views[name] = nil
+    local space = box.space[view.space_id]
+    if space ~= nil then
+        space:drop()
+    end
+end
+
+return {
+    create = create,
+    drop = drop,
+}
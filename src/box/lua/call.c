@@ -972,8 +972,62 @@ func_persistent_lua_call(struct func *base, struct port *args, struct port *ret)
 
 }
 
+/**
+ * Call a persistent Lua function for each of the given argument ports.
+ * All calls share one Lua thread and the results are encoded right
+ * away, so there's no need to create a thread and a port per call.
+ */
+static int
+func_persistent_lua_call_batch(struct func *base, struct port *args,
+			       uint32_t count,
+			       struct func_batch_result *results)
+{
+	assert(base != NULL && base->def->language == FUNC_LANGUAGE_LUA &&
+	       base->def->body != NULL);
+	assert(base->vtab == &func_persistent_lua_vtab);
+	struct func_lua *func = (struct func_lua *)base;
+	lua_State *L = luaT_newthread(tarantool_L);
+	if (L == NULL)
+		return -1;
+	int coro_ref = luaL_ref(tarantool_L, LUA_REGISTRYINDEX);
+	/* See box_process_lua(). */
+	bool has_lua_stack = fiber()->storage.lua.stack != NULL;
+	if (!has_lua_stack)
+		fiber()->storage.lua.stack = L;
+
+	struct execute_lua_ctx ctx;
+	ctx.lua_ref = func->lua_ref;
+	ctx.takes_raw_args = base->def->opts.takes_raw_args;
+	/* Encodes the values returned by a call, see port_lua_dump(). */
+	struct port ret;
+	port_lua_create(&ret, L);
+	int rc = 0;
+	for (uint32_t i = 0; i < count; i++) {
+		ctx.args = &args[i];
+		lua_rawgeti(L, LUA_REGISTRYINDEX,
+			    execute_lua_refs[HANDLER_CALL_BY_REF]);
+		lua_pushlightuserdata(L, &ctx);
+		if (luaT_call(L, 1, LUA_MULTRET) != 0) {
+			rc = -1;
+			break;
+		}
+		results[i].data = port_lua_get_msgpack(&ret, &results[i].size);
+		if (results[i].data == NULL) {
+			rc = -1;
+			break;
+		}
+		/* The encoder pops the values. */
+		assert(lua_gettop(L) == 0);
+	}
+	if (!has_lua_stack)
+		fiber()->storage.lua.stack = NULL;
+	luaL_unref(tarantool_L, LUA_REGISTRYINDEX, coro_ref);
+	return rc;
+}
+
 static struct func_vtab func_persistent_lua_vtab = {
 	.call = func_persistent_lua_call,
+	.call_batch = func_persistent_lua_call_batch,
 	.destroy = func_persistent_lua_destroy,
 };
 
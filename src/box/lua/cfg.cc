@@ -136,6 +136,58 @@ lbox_cfg_set_snap_io_rate_limit(struct lua_State *L)
 	return 0;
 }
 
+static int
+lbox_cfg_set_gc_io_rate_limit(struct lua_State *L)
+{
+	if (box_set_gc_io_rate_limit() != 0)
+		luaT_error(L);
+	return 0;
+}
+
+static int
+lbox_cfg_set_memtx_checkpoint_threads(struct lua_State *L)
+{
+	try {
+		box_set_memtx_checkpoint_threads();
+	} catch (Exception *) {
+		luaT_error(L);
+	}
+	return 0;
+}
+
+static int
+lbox_cfg_set_memtx_join_threads(struct lua_State *L)
+{
+	try {
+		box_set_memtx_join_threads();
+	} catch (Exception *) {
+		luaT_error(L);
+	}
+	return 0;
+}
+
+static int
+lbox_cfg_set_memtx_checkpoint_compression(struct lua_State *L)
+{
+	try {
+		box_set_memtx_checkpoint_compression();
+	} catch (Exception *) {
+		luaT_error(L);
+	}
+	return 0;
+}
+
+static int
+lbox_cfg_set_memtx_checkpoint_direct_io(struct lua_State *L)
+{
+	try {
+		box_set_memtx_checkpoint_direct_io();
+	} catch (Exception *) {
+		luaT_error(L);
+	}
+	return 0;
+}
+
 static int
 lbox_cfg_set_checkpoint_count(struct lua_State *L)
 {
@@ -169,6 +221,14 @@ lbox_cfg_set_checkpoint_wal_threshold(struct lua_State *L)
 	return 0;
 }
 
+static int
+lbox_cfg_set_wal_compression(struct lua_State *L)
+{
+	(void)L;
+	box_set_wal_compression();
+	return 0;
+}
+
 static int
 lbox_cfg_set_wal_queue_max_size(struct lua_State *L)
 {
@@ -177,6 +237,22 @@ lbox_cfg_set_wal_queue_max_size(struct lua_State *L)
 	return 0;
 }
 
+static int
+lbox_cfg_set_wal_relay_buffer_size(struct lua_State *L)
+{
+	if (box_set_wal_relay_buffer_size() != 0)
+		luaT_error(L);
+	return 0;
+}
+
+static int
+lbox_cfg_set_checkpoint_recovery_time(struct lua_State *L)
+{
+	if (box_set_checkpoint_recovery_time() != 0)
+		luaT_error(L);
+	return 0;
+}
+
 static int
 lbox_cfg_set_wal_cleanup_delay(struct lua_State *L)
 {
@@ -218,6 +294,28 @@ lbox_cfg_set_memtx_max_tuple_size(struct lua_State *L)
 	return 0;
 }
 
+static int
+lbox_cfg_set_memtx_defrag_threshold(struct lua_State *L)
+{
+	try {
+		box_set_memtx_defrag_threshold();
+	} catch (Exception *) {
+		luaT_error(L);
+	}
+	return 0;
+}
+
+static int
+lbox_cfg_set_memtx_evict_threshold(struct lua_State *L)
+{
+	try {
+		box_set_memtx_evict_threshold();
+	} catch (Exception *) {
+		luaT_error(L);
+	}
+	return 0;
+}
+
 static int
 lbox_cfg_set_vinyl_memory(struct lua_State *L)
 {
@@ -251,6 +349,17 @@ lbox_cfg_set_vinyl_cache(struct lua_State *L)
 	return 0;
 }
 
+static int
+lbox_cfg_set_vinyl_page_cache(struct lua_State *L)
+{
+	try {
+		box_set_vinyl_page_cache();
+	} catch (Exception *) {
+		luaT_error(L);
+	}
+	return 0;
+}
+
 static int
 lbox_cfg_set_vinyl_timeout(struct lua_State *L)
 {
@@ -262,6 +371,14 @@ lbox_cfg_set_vinyl_timeout(struct lua_State *L)
 	return 0;
 }
 
+static int
+lbox_cfg_set_vinyl_compression_dict(struct lua_State *L)
+{
+	(void)L;
+	box_set_vinyl_compression_dict();
+	return 0;
+}
+
 static int
 lbox_cfg_set_force_recovery(struct lua_State *L)
 {
@@ -281,6 +398,80 @@ lbox_cfg_set_net_msg_max(struct lua_State *L)
 	return 0;
 }
 
+static int
+lbox_cfg_set_net_msg_max_auto(struct lua_State *L)
+{
+	try {
+		box_set_net_msg_max_auto();
+	} catch (Exception *) {
+		luaT_error(L);
+	}
+	return 0;
+}
+
+static int
+lbox_cfg_set_net_msg_max_per_connection(struct lua_State *L)
+{
+	try {
+		box_set_net_msg_max_per_connection();
+	} catch (Exception *) {
+		luaT_error(L);
+	}
+	return 0;
+}
+
+static int
+lbox_cfg_set_net_batch_delay(struct lua_State *L)
+{
+	try {
+		box_set_net_batch_delay();
+	} catch (Exception *) {
+		luaT_error(L);
+	}
+	return 0;
+}
+
+static int
+lbox_cfg_set_watch_notify_interval(struct lua_State *L)
+{
+	try {
+		box_set_watch_notify_interval();
+	} catch (Exception *) {
+		luaT_error(L);
+	}
+	return 0;
+}
+
+static int
+lbox_cfg_set_expiration_rate(struct lua_State *L)
+{
+	try {
+		box_set_expiration_rate();
+	} catch (Exception *) {
+		luaT_error(L);
+	}
+	return 0;
+}
+
+static int
+lbox_cfg_set_metrics_listen(struct lua_State *L)
+{
+	if (box_set_metrics_listen() != 0)
+		luaT_error(L);
+	return 0;
+}
+
+static int
+lbox_cfg_set_iproto_read_view_staleness(struct lua_State *L)
+{
+	try {
+		box_set_iproto_read_view_staleness();
+	} catch (Exception *) {
+		luaT_error(L);
+	}
+	return 0;
+}
+
 static int
 lbox_set_prepared_stmt_cache_size(struct lua_State *L)
 {
@@ -382,6 +573,14 @@ lbox_cfg_set_replication_synchro_timeout(struct lua_State *L)
 	return 0;
 }
 
+static int
+lbox_cfg_set_replication_synchro_confirm_delay(struct lua_State *L)
+{
+	if (box_set_replication_synchro_confirm_delay() != 0)
+		luaT_error(L);
+	return 0;
+}
+
 static int
 lbox_cfg_set_replication_sync_timeout(struct lua_State *L)
 {
@@ -448,6 +647,14 @@ lbox_cfg_set_replication_skip_conflict(struct lua_State *L)
 	return 0;
 }
 
+static int
+lbox_cfg_set_replication_apply_fibers(struct lua_State *L)
+{
+	if (box_set_replication_apply_fibers() != 0)
+		luaT_error(L);
+	return 0;
+}
+
 static int
 lbox_cfg_set_feedback(struct lua_State *L)
 {
@@ -501,18 +708,30 @@ box_lua_cfg_init(struct lua_State *L)
 		{"cfg_set_io_collect_interval", lbox_cfg_set_io_collect_interval},
 		{"cfg_set_too_long_threshold", lbox_cfg_set_too_long_threshold},
 		{"cfg_set_snap_io_rate_limit", lbox_cfg_set_snap_io_rate_limit},
+		{"cfg_set_gc_io_rate_limit", lbox_cfg_set_gc_io_rate_limit},
+		{"cfg_set_memtx_checkpoint_threads", lbox_cfg_set_memtx_checkpoint_threads},
+		{"cfg_set_memtx_join_threads", lbox_cfg_set_memtx_join_threads},
+		{"cfg_set_memtx_checkpoint_compression", lbox_cfg_set_memtx_checkpoint_compression},
+		{"cfg_set_memtx_checkpoint_direct_io", lbox_cfg_set_memtx_checkpoint_direct_io},
 		{"cfg_set_checkpoint_count", lbox_cfg_set_checkpoint_count},
 		{"cfg_set_checkpoint_interval", lbox_cfg_set_checkpoint_interval},
 		{"cfg_set_checkpoint_wal_threshold", lbox_cfg_set_checkpoint_wal_threshold},
+		{"cfg_set_checkpoint_recovery_time", lbox_cfg_set_checkpoint_recovery_time},
+		{"cfg_set_wal_compression", lbox_cfg_set_wal_compression},
 		{"cfg_set_wal_queue_max_size", lbox_cfg_set_wal_queue_max_size},
+		{"cfg_set_wal_relay_buffer_size", lbox_cfg_set_wal_relay_buffer_size},
 		{"cfg_set_wal_cleanup_delay", lbox_cfg_set_wal_cleanup_delay},
 		{"cfg_set_read_only", lbox_cfg_set_read_only},
 		{"cfg_set_memtx_memory", lbox_cfg_set_memtx_memory},
 		{"cfg_set_memtx_max_tuple_size", lbox_cfg_set_memtx_max_tuple_size},
+		{"cfg_set_memtx_defrag_threshold", lbox_cfg_set_memtx_defrag_threshold},
+		{"cfg_set_memtx_evict_threshold", lbox_cfg_set_memtx_evict_threshold},
 		{"cfg_set_vinyl_memory", lbox_cfg_set_vinyl_memory},
 		{"cfg_set_vinyl_max_tuple_size", lbox_cfg_set_vinyl_max_tuple_size},
 		{"cfg_set_vinyl_cache", lbox_cfg_set_vinyl_cache},
+		{"cfg_set_vinyl_page_cache", lbox_cfg_set_vinyl_page_cache},
 		{"cfg_set_vinyl_timeout", lbox_cfg_set_vinyl_timeout},
+		{"cfg_set_vinyl_compression_dict", lbox_cfg_set_vinyl_compression_dict},
 		{"cfg_set_force_recovery", lbox_cfg_set_force_recovery},
 		{"cfg_set_election_mode", lbox_cfg_set_election_mode},
 		{"cfg_set_election_timeout", lbox_cfg_set_election_timeout},
@@ -523,13 +742,27 @@ box_lua_cfg_init(struct lua_State *L)
 		{"cfg_set_replication_sync_lag", lbox_cfg_set_replication_sync_lag},
 		{"cfg_set_replication_synchro_quorum", lbox_cfg_set_replication_synchro_quorum},
 		{"cfg_set_replication_synchro_timeout", lbox_cfg_set_replication_synchro_timeout},
+		{"cfg_set_replication_synchro_confirm_delay",
+		 lbox_cfg_set_replication_synchro_confirm_delay},
 		{"cfg_set_replication_sync_timeout", lbox_cfg_set_replication_sync_timeout},
 		{"cfg_set_replication_skip_conflict", lbox_cfg_set_replication_skip_conflict},
+		{"cfg_set_replication_apply_fibers",
+		 lbox_cfg_set_replication_apply_fibers},
 		{"cfg_set_replication_anon", lbox_cfg_set_replication_anon},
 		{"cfg_set_replicaset_name", lbox_cfg_set_replicaset_name},
 		{"cfg_set_instance_name", lbox_cfg_set_instance_name},
 		{"cfg_set_cluster_name", lbox_cfg_set_cluster_name},
 		{"cfg_set_net_msg_max", lbox_cfg_set_net_msg_max},
+		{"cfg_set_net_msg_max_auto", lbox_cfg_set_net_msg_max_auto},
+		{"cfg_set_net_msg_max_per_connection",
+		 lbox_cfg_set_net_msg_max_per_connection},
+		{"cfg_set_net_batch_delay", lbox_cfg_set_net_batch_delay},
+		{"cfg_set_watch_notify_interval",
+		 lbox_cfg_set_watch_notify_interval},
+		{"cfg_set_iproto_read_view_staleness",
+		 lbox_cfg_set_iproto_read_view_staleness},
+		{"cfg_set_expiration_rate", lbox_cfg_set_expiration_rate},
+		{"cfg_set_metrics_listen", lbox_cfg_set_metrics_listen},
 		{"cfg_set_sql_cache_size", lbox_set_prepared_stmt_cache_size},
 		{"cfg_set_feedback", lbox_cfg_set_feedback},
 		{"cfg_set_txn_timeout", lbox_cfg_set_txn_timeout},
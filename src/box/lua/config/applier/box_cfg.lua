@@ -5,6 +5,44 @@ local snapshot = require('internal.config.utils.snapshot')
 local schedule_task = fiber._internal.schedule_task
 local mkversion = require('internal.mkversion')
 
+-- Find an upstream of an anonymous replica in the fan-out tree
+-- built by the `replication.anon_fanout` option.
+--
+-- The anonymous peers are numbered in the order of their names.
+-- The first `anon_fanout` of them are connected to the
+-- non-anonymous peers, the next `anon_fanout` ones to the first
+-- anonymous peer, and so on. So every anonymous replica serves at
+-- most `anon_fanout` downstreams.
+--
+-- Returns nil if the instance should be connected to the
+-- non-anonymous peers.
+local function anon_upstream(configdata, peers)
+    local fanout = configdata:get('replication.anon_fanout',
+        {use_default = true})
+    if fanout == nil or
+            not configdata:get('replication.anon', {use_default = true}) then
+        return nil
+    end
+    local names = configdata:names()
+    local anon_peers = {}
+    local pos
+    for _, peer_name in ipairs(peers) do
+        local iconfig_def = configdata._peers[peer_name].iconfig_def
+        if instance_config:get(iconfig_def, 'replication.anon') then
+            table.insert(anon_peers, peer_name)
+            if peer_name == names.instance_name then
+                pos = #anon_peers
+            end
+        end
+    end
+    assert(pos ~= nil)
+    local parent = math.floor((pos - 1) / fanout)
+    if parent == 0 then
+        return nil
+    end
+    return anon_peers[parent]
+end
+
 local function peer_uris(configdata)
     local peers = configdata:peers()
     if #peers <= 1 then
@@ -16,6 +54,18 @@ local function peer_uris(configdata)
         'of replicaset %q of group %q'):format(names.instance_name,
         names.replicaset_name, names.group_name)
 
+    local upstream = anon_upstream(configdata, peers)
+    if upstream ~= nil then
+        local iconfig_def = configdata._peers[upstream].iconfig_def
+        local uri = instance_config:instance_uri(iconfig_def, 'peer')
+        if uri == nil then
+            error(('%s: anonymous replica %q has no iproto.advertise.peer ' ..
+                'or iproto.listen URI suitable to create a client socket'):
+                format(err_msg_prefix, upstream), 0)
+        end
+        return {uri}
+    end
+
     -- Is there a peer in our replicaset with an URI suitable to
     -- connect (except ourself)?
     local has_upstream = false
@@ -34,7 +84,8 @@ local function peer_uris(configdata)
         -- as upstreams by default.
         --
         -- A user may configure a custom data flow using
-        -- `replication.peers` option.
+        -- `replication.peers` option or let anonymous replicas
+        -- form a fan-out tree using `replication.anon_fanout`.
         if not is_anon then
             local uri = instance_config:instance_uri(iconfig_def, 'peer')
             if uri == nil then
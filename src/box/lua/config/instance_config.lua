@@ -670,6 +670,12 @@ return schema.new('instance_config', schema.record({
             box_cfg_nondynamic = true,
             default = false,
         }),
+        tx_cpus = schema.scalar({
+            type = 'string',
+            box_cfg = 'tx_cpus',
+            box_cfg_nondynamic = true,
+            default = box.NULL,
+        }),
         title = schema.scalar({
             type = 'string',
             box_cfg = 'custom_proc_title',
@@ -1062,11 +1068,48 @@ return schema.new('instance_config', schema.record({
             box_cfg_nondynamic = true,
             default = 1,
         }),
+        cpus = schema.scalar({
+            type = 'string',
+            box_cfg = 'iproto_cpus',
+            box_cfg_nondynamic = true,
+            default = box.NULL,
+        }),
+        reuseport = schema.scalar({
+            type = 'boolean',
+            box_cfg = 'iproto_reuseport',
+            box_cfg_nondynamic = true,
+            default = false,
+        }),
         net_msg_max = schema.scalar({
             type = 'integer',
             box_cfg = 'net_msg_max',
             default = 768,
         }),
+        net_msg_max_auto = schema.scalar({
+            type = 'boolean',
+            box_cfg = 'net_msg_max_auto',
+            default = false,
+        }),
+        net_msg_max_per_connection = schema.scalar({
+            type = 'integer',
+            box_cfg = 'net_msg_max_per_connection',
+            default = 0,
+        }),
+        net_batch_delay = schema.scalar({
+            type = 'number',
+            box_cfg = 'net_batch_delay',
+            default = 0,
+        }),
+        read_view_staleness = schema.scalar({
+            type = 'number',
+            box_cfg = 'iproto_read_view_staleness',
+            default = 0,
+        }),
+        watch_notify_interval = schema.scalar({
+            type = 'number',
+            box_cfg = 'watch_notify_interval',
+            default = 0,
+        }),
         readahead = schema.scalar({
             type = 'integer',
             box_cfg = 'readahead',
@@ -1127,6 +1170,11 @@ return schema.new('instance_config', schema.record({
             box_cfg_nondynamic = true,
             default = false,
         }),
+        expiration_rate = schema.scalar({
+            type = 'number',
+            box_cfg = 'expiration_rate',
+            default = 10000,
+        }),
     }),
     sql = schema.record({
         cache_size = schema.scalar({
@@ -1178,6 +1226,27 @@ return schema.new('instance_config', schema.record({
             box_cfg_nondynamic = true,
             default = box.NULL,
         }),
+        join_threads = schema.scalar({
+            type = 'integer',
+            box_cfg = 'memtx_join_threads',
+            default = 1,
+        }),
+        use_huge_pages = schema.scalar({
+            type = 'boolean',
+            box_cfg = 'memtx_use_huge_pages',
+            box_cfg_nondynamic = true,
+            default = false,
+        }),
+        defrag_threshold = schema.scalar({
+            type = 'number',
+            box_cfg = 'memtx_defrag_threshold',
+            default = 0,
+        }),
+        evict_threshold = schema.scalar({
+            type = 'number',
+            box_cfg = 'memtx_evict_threshold',
+            default = 0.9,
+        }),
     }),
     vinyl = schema.record({
         bloom_fpr = schema.scalar({
@@ -1191,6 +1260,11 @@ return schema.new('instance_config', schema.record({
             box_cfg = 'vinyl_cache',
             default = 128 * 1024 * 1024,
         }),
+        compression_dict = schema.scalar({
+            type = 'boolean',
+            box_cfg = 'vinyl_compression_dict',
+            default = false,
+        }),
         defer_deletes = schema.scalar({
             type = 'boolean',
             box_cfg = 'vinyl_defer_deletes',
@@ -1213,6 +1287,11 @@ return schema.new('instance_config', schema.record({
             box_cfg = 'vinyl_memory',
             default = 128 * 1024 * 1024,
         }),
+        page_cache = schema.scalar({
+            type = 'integer',
+            box_cfg = 'vinyl_page_cache',
+            default = 0,
+        }),
         page_size = schema.scalar({
             type = 'integer',
             box_cfg = 'vinyl_page_size',
@@ -1272,6 +1351,30 @@ return schema.new('instance_config', schema.record({
             box_cfg_nondynamic = true,
             default = 'write',
         }),
+        cpus = schema.scalar({
+            type = 'string',
+            box_cfg = 'wal_cpus',
+            box_cfg_nondynamic = true,
+            default = box.NULL,
+        }),
+        sync_pipeline = schema.scalar({
+            type = 'boolean',
+            box_cfg = 'wal_sync_pipeline',
+            box_cfg_nondynamic = true,
+            default = false,
+        }),
+        relay_before_sync = schema.scalar({
+            type = 'boolean',
+            box_cfg = 'wal_relay_before_sync',
+            box_cfg_nondynamic = true,
+            default = false,
+        }),
+        spare_files = schema.scalar({
+            type = 'integer',
+            box_cfg = 'wal_spare_files',
+            box_cfg_nondynamic = true,
+            default = 0,
+        }),
         max_size = schema.scalar({
             type = 'integer',
             box_cfg = 'wal_max_size',
@@ -1293,6 +1396,16 @@ return schema.new('instance_config', schema.record({
             box_cfg = 'wal_cleanup_delay',
             default = 4 * 3600,
         }),
+        compression = schema.scalar({
+            type = 'boolean',
+            box_cfg = 'wal_compression',
+            default = true,
+        }),
+        relay_buffer_size = schema.scalar({
+            type = 'integer',
+            box_cfg = 'wal_relay_buffer_size',
+            default = 0,
+        }),
         retention_period = enterprise_edition(schema.scalar({
             type = 'number',
             box_cfg = 'wal_retention_period',
@@ -1360,6 +1473,11 @@ return schema.new('instance_config', schema.record({
                 box_cfg = 'checkpoint_wal_threshold',
                 default = 1e18,
             }),
+            recovery_time = schema.scalar({
+                type = 'number',
+                box_cfg = 'checkpoint_recovery_time',
+                default = 0,
+            }),
         }),
         count = schema.scalar({
             type = 'integer',
@@ -1371,6 +1489,26 @@ return schema.new('instance_config', schema.record({
             box_cfg = 'snap_io_rate_limit',
             default = box.NULL,
         }),
+        gc_io_rate_limit = schema.scalar({
+            type = 'number',
+            box_cfg = 'gc_io_rate_limit',
+            default = box.NULL,
+        }),
+        threads = schema.scalar({
+            type = 'integer',
+            box_cfg = 'memtx_checkpoint_threads',
+            default = 1,
+        }),
+        compression = schema.scalar({
+            type = 'boolean',
+            box_cfg = 'memtx_checkpoint_compression',
+            default = true,
+        }),
+        direct_io = schema.scalar({
+            type = 'boolean',
+            box_cfg = 'memtx_checkpoint_direct_io',
+            default = false,
+        }),
     }),
     replication = schema.record({
         failover = schema.enum({
@@ -1436,12 +1574,34 @@ return schema.new('instance_config', schema.record({
             box_cfg = 'replication_anon',
             default = false,
         }),
+        -- Maximal number of anonymous replicas fetching data from
+        -- one anonymous replica. If set, anonymous replicas of the
+        -- replicaset are connected into a tree, so that only the
+        -- first `anon_fanout` of them fetch data from non-anonymous
+        -- instances. If not set, all anonymous replicas are
+        -- connected to non-anonymous instances.
+        anon_fanout = schema.scalar({
+            type = 'integer',
+            default = box.NULL,
+            validate = function(data, w)
+                if data < 1 then
+                    w.error('replication.anon_fanout must be positive, ' ..
+                        'got %d', data)
+                end
+            end,
+        }),
         threads = schema.scalar({
             type = 'integer',
             box_cfg = 'replication_threads',
             box_cfg_nondynamic = true,
             default = 1,
         }),
+        relay_cpus = schema.scalar({
+            type = 'string',
+            box_cfg = 'relay_cpus',
+            box_cfg_nondynamic = true,
+            default = box.NULL,
+        }),
         timeout = schema.scalar({
             type = 'number',
             box_cfg = 'replication_timeout',
@@ -1452,6 +1612,11 @@ return schema.new('instance_config', schema.record({
             box_cfg = 'replication_synchro_timeout',
             default = 5,
         }),
+        synchro_confirm_delay = schema.scalar({
+            type = 'number',
+            box_cfg = 'replication_synchro_confirm_delay',
+            default = 0,
+        }),
         connect_timeout = schema.scalar({
             type = 'number',
             box_cfg = 'replication_connect_timeout',
@@ -1478,6 +1643,11 @@ return schema.new('instance_config', schema.record({
             box_cfg = 'replication_skip_conflict',
             default = false,
         }),
+        apply_fibers = schema.scalar({
+            type = 'integer',
+            box_cfg = 'replication_apply_fibers',
+            default = 1,
+        }),
         election_mode = schema.enum({
             'off',
             'voter',
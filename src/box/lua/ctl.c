@@ -46,6 +46,7 @@
 #include "box/memtx_engine.h"
 #include "box/raft.h"
 #include "box/security.h"
+#include "vclock/vclock.h"
 
 #include "core/event.h"
 
@@ -73,6 +74,36 @@ lbox_ctl_wait_rw(struct lua_State *L)
 	return 0;
 }
 
+static int
+lbox_ctl_wait_vclock(struct lua_State *L)
+{
+	int top = lua_gettop(L);
+	if (top < 1 || top > 2 || !lua_istable(L, 1) ||
+	    (top == 2 && !lua_isnumber(L, 2)))
+		return luaL_error(L, "Usage: box.ctl.wait_vclock(vclock"
+				  "[, timeout])");
+	double timeout = top == 2 ? lua_tonumber(L, 2) : TIMEOUT_INFINITY;
+	struct vclock vclock;
+	vclock_create(&vclock);
+	lua_pushnil(L);
+	while (lua_next(L, 1) != 0) {
+		lua_Number id = lua_isnumber(L, -2) ? lua_tonumber(L, -2) : -1;
+		lua_Number lsn = lua_isnumber(L, -1) ? lua_tonumber(L, -1) : -1;
+		if (id < 0 || id >= VCLOCK_MAX || id != (uint32_t)id ||
+		    lsn < 0 || lsn != (int64_t)lsn) {
+			diag_set(IllegalParams, "vclock must be a table of "
+				 "non-negative integers indexed by replica id");
+			return luaT_error(L);
+		}
+		if (id != 0)
+			vclock_reset(&vclock, id, lsn);
+		lua_pop(L, 1);
+	}
+	if (box_wait_vclock(&vclock, ev_monotonic_now(loop()) + timeout) != 0)
+		return luaT_error(L);
+	return 0;
+}
+
 static int
 lbox_ctl_on_shutdown(struct lua_State *L)
 {
@@ -177,6 +208,7 @@ lbox_ctl_set_iproto_lockdown(struct lua_State *L)
 static const struct luaL_Reg lbox_ctl_lib[] = {
 	{"wait_ro", lbox_ctl_wait_ro},
 	{"wait_rw", lbox_ctl_wait_rw},
+	{"wait_vclock", lbox_ctl_wait_vclock},
 	{"on_shutdown", lbox_ctl_on_shutdown},
 	{"on_schema_init", lbox_ctl_on_schema_init},
 	{"on_recovery_state", lbox_ctl_on_recovery_state},
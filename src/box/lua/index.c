@@ -34,10 +34,15 @@
 #include "info/info.h"
 #include "box/box.h"
 #include "box/index.h"
+#include "box/hot_key.h"
+#include "box/space.h"
+#include "box/space_cache.h"
 #include "box/lua/tuple.h"
 #include "box/lua/misc.h"
 #include "small/region.h"
 #include "fiber.h"
+#include "msgpuck.h"
+#include "lua/msgpack.h"
 
 /** {{{ box.index Lua library: access to spaces and indexes
  */
@@ -82,6 +87,60 @@ lbox_replace(lua_State *L)
 	return rc == 0 ? luaT_pushtupleornil(L, result) : luaT_error(L);
 }
 
+typedef int
+(*box_batch_f)(uint32_t space_id, const char *tuples, const char *tuples_end,
+	       uint32_t *count);
+
+/**
+ * Common part of space:insert_many() and space:replace_many().
+ * The tuples are passed either as a Lua array of tables and tuples
+ * or as a string with an encoded MsgPack array of tuples.
+ */
+static int
+lbox_process_batch(lua_State *L, const char *name, box_batch_f batch_f)
+{
+	if (lua_gettop(L) != 2 || !lua_isnumber(L, 1))
+		return luaL_error(L, "Usage space:%s(tuples)", name);
+
+	uint32_t space_id = lua_tonumber(L, 1);
+	size_t region_svp = region_used(&fiber()->gc);
+	const char *tuples;
+	size_t tuples_len;
+	if (lua_type(L, 2) == LUA_TSTRING) {
+		tuples = lua_tolstring(L, 2, &tuples_len);
+		const char *p = tuples;
+		if (tuples_len == 0 || mp_check(&p, tuples + tuples_len) != 0 ||
+		    p != tuples + tuples_len) {
+			diag_set(IllegalParams, "tuples must be a valid "
+				 "MsgPack array");
+			return luaT_error(L);
+		}
+	} else {
+		tuples = lbox_encode_tuple_on_gc(L, 2, &tuples_len);
+		if (tuples == NULL)
+			return luaT_error(L);
+	}
+	uint32_t count;
+	int rc = batch_f(space_id, tuples, tuples + tuples_len, &count);
+	region_truncate(&fiber()->gc, region_svp);
+	if (rc != 0)
+		return luaT_error(L);
+	lua_pushinteger(L, count);
+	return 1;
+}
+
+static int
+lbox_insert_many(lua_State *L)
+{
+	return lbox_process_batch(L, "insert_many", box_insert_batch);
+}
+
+static int
+lbox_replace_many(lua_State *L)
+{
+	return lbox_process_batch(L, "replace_many", box_replace_batch);
+}
+
 static int
 lbox_index_update(lua_State *L)
 {
@@ -348,6 +407,34 @@ lbox_truncate(struct lua_State *L)
 
 /* {{{ Introspection */
 
+/**
+ * Set the hot_keys field of the index statistics table on top of
+ * the stack if hot keys are tracked, see hot_key.h.
+ */
+static void
+lbox_index_push_hot_keys(lua_State *L, uint32_t space_id, uint32_t index_id)
+{
+	struct space *space = space_by_id(space_id);
+	struct index *index = space != NULL ?
+			      space_index(space, index_id) : NULL;
+	if (index == NULL || index->hot_key_stat == NULL)
+		return;
+	struct hot_key_stat *stat = index->hot_key_stat;
+	hot_key_stat_sort(stat);
+	lua_createtable(L, stat->top_count, 0);
+	for (uint32_t i = 0; i < stat->top_count; i++) {
+		struct hot_key *key = &stat->top[i];
+		const char *data = key->data;
+		lua_createtable(L, 0, 2);
+		luamp_decode(L, luaL_msgpack_default, &data);
+		lua_setfield(L, -2, "key");
+		luaL_pushuint64(L, key->count * stat->sample_interval);
+		lua_setfield(L, -2, "count");
+		lua_rawseti(L, -2, i + 1);
+	}
+	lua_setfield(L, -2, "hot_keys");
+}
+
 static int
 lbox_index_stat(lua_State *L)
 {
@@ -361,6 +448,7 @@ lbox_index_stat(lua_State *L)
 	luaT_info_handler_create(&info, L);
 	if (box_index_stat(space_id, index_id, &info) != 0)
 		return luaT_error(L);
+	lbox_index_push_hot_keys(L, space_id, index_id);
 	return 1;
 }
 
@@ -398,6 +486,8 @@ box_lua_index_init(struct lua_State *L)
 	static const struct luaL_Reg boxlib_internal[] = {
 		{"insert", lbox_insert},
 		{"replace",  lbox_replace},
+		{"insert_many", lbox_insert_many},
+		{"replace_many", lbox_replace_many},
 		{"update", lbox_index_update},
 		{"upsert",  lbox_upsert},
 		{"delete",  lbox_index_delete},
@@ -636,6 +636,31 @@ lbox_info_vinyl(struct lua_State *L)
 	return 1;
 }
 
+static int
+lbox_info_recovery_call(struct lua_State *L)
+{
+	if (box_check_configured() != 0)
+		return luaT_error(L);
+
+	struct info_handler h;
+	luaT_info_handler_create(&h, L);
+	box_recovery_stat(&h);
+	return 1;
+}
+
+static int
+lbox_info_recovery(struct lua_State *L)
+{
+	lua_newtable(L);
+	lua_newtable(L); /* metatable */
+	lua_pushstring(L, "__call");
+	lua_pushcfunction(L, lbox_info_recovery_call);
+	lua_settable(L, -3);
+
+	lua_setmetatable(L, -2);
+	return 1;
+}
+
 static int
 lbox_info_sql_call(struct lua_State *L)
 {
@@ -707,6 +732,10 @@ lbox_info_election(struct lua_State *L)
 		}
 		lua_pushnumber(L, raft_leader_idle(raft));
 		lua_setfield(L, -2, "leader_idle");
+		double lease = box_raft_lease_expiry() -
+			       ev_monotonic_now(loop());
+		lua_pushnumber(L, lease > 0 ? lease : 0);
+		lua_setfield(L, -2, "lease");
 	}
 	return 1;
 }
@@ -778,6 +807,7 @@ static const struct luaL_Reg lbox_info_dynamic_meta[] = {
 	{"memory", lbox_info_memory},
 	{"gc", lbox_info_gc},
 	{"vinyl", lbox_info_vinyl},
+	{"recovery", lbox_info_recovery},
 	{"sql", lbox_info_sql},
 	{"listen", lbox_info_listen},
 	{"election", lbox_info_election},
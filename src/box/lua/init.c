@@ -84,6 +84,7 @@
 #include "box/lua/config/utils/expression_lexer.h"
 #include "box/lua/failover.h"
 #include "box/lua/integrity.h"
+#include "box/lua/load_csv.h"
 
 #include "mpstream/mpstream.h"
 
@@ -104,6 +105,7 @@ extern char session_lua[],
 	upgrade_lua[],
 	console_lua[],
 	merger_lua[],
+	aggregate_view_lua[],
 	iproto_lua[],
 	checks_version_lua[],
 	checks_lua[],
@@ -228,6 +230,7 @@ static const char *lua_sources[] = {
 	"box/load_cfg", NULL, load_cfg_lua,
 	"box/key_def", "key_def", key_def_lua,
 	"box/merger", "merger", merger_lua,
+	"box/aggregate_view", "aggregate_view", aggregate_view_lua,
 	"box/iproto", "iproto", iproto_lua,
 	/*
 	 * To support tarantool-only types with checks, the module
@@ -906,6 +909,7 @@ box_lua_init(struct lua_State *L)
 	box_lua_flightrec_init(L);
 	box_lua_trigger_init(L);
 	box_lua_integrity_init(L);
+	box_lua_load_csv_init(L);
 	box_lua_expression_lexer_init(L);
 	luaopen_net_box(L);
 	lua_pop(L, 1);
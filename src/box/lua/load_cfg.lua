@@ -93,7 +93,15 @@ local default_cfg = {
     slab_alloc_granularity = 8,
     slab_alloc_factor   = 1.05,
     iproto_threads      = 1,
+    iproto_reuseport    = false,
+    tx_cpus             = nil,
+    iproto_cpus         = nil,
+    wal_cpus            = nil,
+    relay_cpus          = nil,
     memtx_allocator     = "small",
+    memtx_use_huge_pages = false,
+    memtx_defrag_threshold = 0,
+    memtx_evict_threshold = 0.9,
     work_dir            = nil,
     memtx_dir           = ".",
     wal_dir             = ".",
@@ -101,6 +109,7 @@ local default_cfg = {
     vinyl_dir           = '.',
     vinyl_memory        = 128 * 1024 * 1024,
     vinyl_cache         = 128 * 1024 * 1024,
+    vinyl_page_cache    = 0,
     vinyl_max_tuple_size = 1024 * 1024,
     vinyl_read_threads  = 1,
     vinyl_write_threads = 4,
@@ -111,6 +120,7 @@ local default_cfg = {
     vinyl_range_size          = nil, -- set automatically
     vinyl_page_size           = 8 * 1024,
     vinyl_bloom_fpr           = 0.05,
+    vinyl_compression_dict    = false,
 
     log                 = log.cfg.log,
     log_nonblock        = log.cfg.nonblock,
@@ -151,12 +161,22 @@ local default_cfg = {
     io_collect_interval = nil,
     readahead           = 16320,
     snap_io_rate_limit  = nil, -- no limit
+    gc_io_rate_limit    = nil, -- no limit
+    memtx_checkpoint_threads = 1,
+    memtx_join_threads  = 1,
+    memtx_checkpoint_compression = true,
+    memtx_checkpoint_direct_io = false,
     too_long_threshold  = 0.5,
     wal_mode            = "write",
+    wal_sync_pipeline   = false,
+    wal_relay_before_sync = false,
+    wal_spare_files     = 0,
     wal_max_size        = 256 * 1024 * 1024,
     wal_dir_rescan_delay= 2,
     wal_queue_max_size  = 16 * 1024 * 1024,
+    wal_relay_buffer_size = 0,
     wal_cleanup_delay   = 4 * 3600,
+    wal_compression     = true,
     wal_retention_period = ifdef_wal_retention_period(0),
     wal_ext             = ifdef_wal_ext(nil),
     force_recovery      = false,
@@ -176,6 +196,7 @@ local default_cfg = {
     memtx_use_mvcc_engine = false,
     checkpoint_interval = 3600,
     checkpoint_wal_threshold = 1e18,
+    checkpoint_recovery_time = 0,
     checkpoint_count    = 2,
     worker_pool_threads = 4,
     election_mode       = 'off',
@@ -186,9 +207,11 @@ local default_cfg = {
     replication_sync_timeout = 0,
     replication_synchro_quorum = "N / 2 + 1",
     replication_synchro_timeout = 5,
+    replication_synchro_confirm_delay = 0,
     replication_connect_timeout = 30,
     replication_connect_quorum = nil, -- connect all
     replication_skip_conflict = false,
+    replication_apply_fibers = 1,
     replication_anon      = false,
     replication_threads   = 1,
     bootstrap_strategy    = "auto",
@@ -201,6 +224,13 @@ local default_cfg = {
     feedback_metrics_collect_interval = ifdef_feedback(60),
     feedback_metrics_limit = ifdef_feedback(1024 * 1024),
     net_msg_max           = 768,
+    net_msg_max_auto      = false,
+    net_msg_max_per_connection = 0,
+    net_batch_delay       = 0,
+    iproto_read_view_staleness = 0,
+    watch_notify_interval = 0,
+    expiration_rate       = 10000,
+    metrics_listen        = nil,
     sql_cache_size        = 5 * 1024 * 1024,
     txn_timeout           = 365 * 100 * 86400,
     txn_isolation         = "best-effort",
@@ -294,13 +324,22 @@ local template_cfg = {
     slab_alloc_granularity = 'number',
     slab_alloc_factor   = 'number',
     iproto_threads      = 'number',
+    iproto_reuseport    = 'boolean',
+    tx_cpus             = 'string',
+    iproto_cpus         = 'string',
+    wal_cpus            = 'string',
+    relay_cpus          = 'string',
     memtx_allocator     = 'string',
+    memtx_use_huge_pages = 'boolean',
+    memtx_defrag_threshold = 'number',
+    memtx_evict_threshold = 'number',
     work_dir            = 'string',
     memtx_dir            = 'string',
     wal_dir             = 'string',
     vinyl_dir           = 'string',
     vinyl_memory        = 'number',
     vinyl_cache               = 'number',
+    vinyl_page_cache          = 'number',
     vinyl_max_tuple_size      = 'number',
     vinyl_read_threads        = 'number',
     vinyl_write_threads       = 'number',
@@ -311,6 +350,7 @@ local template_cfg = {
     vinyl_range_size          = 'number',
     vinyl_page_size           = 'number',
     vinyl_bloom_fpr           = 'number',
+    vinyl_compression_dict    = 'boolean',
 
     log                 = 'string',
     log_nonblock        = 'boolean',
@@ -351,11 +391,20 @@ local template_cfg = {
     io_collect_interval = 'number',
     readahead           = 'number',
     snap_io_rate_limit  = 'number',
+    gc_io_rate_limit    = 'number',
+    memtx_checkpoint_threads = 'number',
+    memtx_join_threads  = 'number',
+    memtx_checkpoint_compression = 'boolean',
+    memtx_checkpoint_direct_io = 'boolean',
     too_long_threshold  = 'number',
     wal_mode            = 'string',
+    wal_sync_pipeline   = 'boolean',
+    wal_relay_before_sync = 'boolean',
+    wal_spare_files     = 'number',
     wal_max_size        = 'number',
     wal_dir_rescan_delay= 'number',
     wal_cleanup_delay   = 'number',
+    wal_compression     = 'boolean',
     wal_retention_period = ifdef_wal_retention_period('number'),
     wal_ext             = ifdef_wal_ext('table'),
     force_recovery      = 'boolean',
@@ -372,7 +421,9 @@ local template_cfg = {
     coredump            = 'boolean',
     checkpoint_interval = 'number',
     checkpoint_wal_threshold = 'number',
+    checkpoint_recovery_time = 'number',
     wal_queue_max_size  = 'number',
+    wal_relay_buffer_size = 'number',
     checkpoint_count    = 'number',
     read_only           = 'boolean',
     hot_standby         = 'boolean',
@@ -387,9 +438,11 @@ local template_cfg = {
     replication_sync_timeout = 'number',
     replication_synchro_quorum = 'string, number',
     replication_synchro_timeout = 'number',
+    replication_synchro_confirm_delay = 'number',
     replication_connect_timeout = 'number',
     replication_connect_quorum = 'number',
     replication_skip_conflict = 'boolean',
+    replication_apply_fibers = 'number',
     replication_anon      = 'boolean',
     replication_threads   = 'number',
     bootstrap_strategy    = 'string',
@@ -402,6 +455,13 @@ local template_cfg = {
     feedback_metrics_collect_interval = ifdef_feedback('number'),
     feedback_metrics_limit = ifdef_feedback('number'),
     net_msg_max           = 'number',
+    net_msg_max_auto      = 'boolean',
+    net_msg_max_per_connection = 'number',
+    net_batch_delay       = 'number',
+    iproto_read_view_staleness = 'number',
+    watch_notify_interval = 'number',
+    expiration_rate       = 'number',
+    metrics_listen        = 'string, number, table',
     sql_cache_size        = 'number',
     txn_timeout           = 'number',
     memtx_sort_threads    = 'number',
@@ -489,22 +549,34 @@ local dynamic_cfg = {
     readahead               = private.cfg_set_readahead,
     too_long_threshold      = private.cfg_set_too_long_threshold,
     snap_io_rate_limit      = private.cfg_set_snap_io_rate_limit,
+    gc_io_rate_limit        = private.cfg_set_gc_io_rate_limit,
+    memtx_checkpoint_threads = private.cfg_set_memtx_checkpoint_threads,
+    memtx_join_threads  = private.cfg_set_memtx_join_threads,
+    memtx_checkpoint_compression = private.cfg_set_memtx_checkpoint_compression,
+    memtx_checkpoint_direct_io = private.cfg_set_memtx_checkpoint_direct_io,
     read_only               = private.cfg_set_read_only,
     memtx_memory            = private.cfg_set_memtx_memory,
     memtx_max_tuple_size    = private.cfg_set_memtx_max_tuple_size,
+    memtx_defrag_threshold  = private.cfg_set_memtx_defrag_threshold,
+    memtx_evict_threshold   = private.cfg_set_memtx_evict_threshold,
     vinyl_memory            = private.cfg_set_vinyl_memory,
     vinyl_max_tuple_size    = private.cfg_set_vinyl_max_tuple_size,
     vinyl_cache             = private.cfg_set_vinyl_cache,
+    vinyl_page_cache        = private.cfg_set_vinyl_page_cache,
     vinyl_timeout           = private.cfg_set_vinyl_timeout,
+    vinyl_compression_dict  = private.cfg_set_vinyl_compression_dict,
     vinyl_defer_deletes     = nop,
     checkpoint_count        = private.cfg_set_checkpoint_count,
     checkpoint_interval     = private.cfg_set_checkpoint_interval,
     checkpoint_wal_threshold = private.cfg_set_checkpoint_wal_threshold,
+    checkpoint_recovery_time = private.cfg_set_checkpoint_recovery_time,
     wal_queue_max_size      = private.cfg_set_wal_queue_max_size,
+    wal_relay_buffer_size   = private.cfg_set_wal_relay_buffer_size,
     worker_pool_threads     = private.cfg_set_worker_pool_threads,
     -- do nothing, affects new replicas, which query this value on start
     wal_dir_rescan_delay    = nop,
     wal_cleanup_delay       = private.cfg_set_wal_cleanup_delay,
+    wal_compression         = private.cfg_set_wal_compression,
     wal_retention_period    = private.cfg_set_wal_retention_period,
     custom_proc_title       = function()
         require('title').update(box.cfg.custom_proc_title)
@@ -520,7 +592,10 @@ local dynamic_cfg = {
     replication_sync_timeout = private.cfg_set_replication_sync_timeout,
     replication_synchro_quorum = private.cfg_set_replication_synchro_quorum,
     replication_synchro_timeout = private.cfg_set_replication_synchro_timeout,
+    replication_synchro_confirm_delay =
+        private.cfg_set_replication_synchro_confirm_delay,
     replication_skip_conflict = private.cfg_set_replication_skip_conflict,
+    replication_apply_fibers = private.cfg_set_replication_apply_fibers,
     replication_anon        = private.cfg_set_replication_anon,
     bootstrap_strategy      = private.cfg_set_bootstrap_strategy,
     instance_uuid           = check_instance_uuid,
@@ -529,6 +604,13 @@ local dynamic_cfg = {
     replicaset_name         = private.cfg_set_replicaset_name,
     cluster_name            = private.cfg_set_cluster_name,
     net_msg_max             = private.cfg_set_net_msg_max,
+    net_msg_max_auto        = private.cfg_set_net_msg_max_auto,
+    net_msg_max_per_connection = private.cfg_set_net_msg_max_per_connection,
+    net_batch_delay         = private.cfg_set_net_batch_delay,
+    iproto_read_view_staleness = private.cfg_set_iproto_read_view_staleness,
+    watch_notify_interval   = private.cfg_set_watch_notify_interval,
+    expiration_rate         = private.cfg_set_expiration_rate,
+    metrics_listen          = private.cfg_set_metrics_listen,
     sql_cache_size          = private.cfg_set_sql_cache_size,
     txn_timeout             = private.cfg_set_txn_timeout,
     txn_isolation           = private.cfg_set_txn_isolation,
@@ -636,6 +718,7 @@ local dynamic_cfg_order = {
     replication_sync_timeout    = 150,
     replication_synchro_quorum  = 150,
     replication_synchro_timeout = 150,
+    replication_synchro_confirm_delay = 150,
     replication_connect_timeout = 150,
     replication_connect_quorum  = 150,
     -- Apply bootstrap_strategy before replication, but after
@@ -667,10 +750,14 @@ end
 local dynamic_cfg_skip_at_load = {
     memtx_memory            = true,
     memtx_max_tuple_size    = true,
+    memtx_defrag_threshold  = true,
+    memtx_evict_threshold   = true,
     vinyl_memory            = true,
     vinyl_max_tuple_size    = true,
     vinyl_cache             = true,
+    vinyl_page_cache        = true,
     vinyl_timeout           = true,
+    vinyl_compression_dict  = true,
     too_long_threshold      = true,
     election_mode           = true,
     election_timeout        = true,
@@ -683,10 +770,14 @@ local dynamic_cfg_skip_at_load = {
     replication_sync_timeout = true,
     replication_synchro_quorum = true,
     replication_synchro_timeout = true,
+    replication_synchro_confirm_delay = true,
     replication_skip_conflict = true,
+    replication_apply_fibers = true,
     replication_anon        = true,
     bootstrap_strategy      = true,
     wal_dir_rescan_delay    = true,
+    wal_compression         = true,
+    wal_relay_buffer_size   = true,
     custom_proc_title       = true,
     force_recovery          = true,
     instance_uuid           = true,
@@ -695,6 +786,13 @@ local dynamic_cfg_skip_at_load = {
     replicaset_name         = true,
     cluster_name            = true,
     net_msg_max             = true,
+    net_msg_max_auto        = true,
+    net_msg_max_per_connection = true,
+    net_batch_delay         = true,
+    iproto_read_view_staleness = true,
+    watch_notify_interval   = true,
+    expiration_rate         = true,
+    metrics_listen          = true,
     readahead               = true,
     auth_type               = true,
     auth_delay              = ifdef_security(true),
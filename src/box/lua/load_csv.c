@@ -0,0 +1,690 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2024, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#include "box/lua/load_csv.h"
+
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+
+#include <lua.h>
+#include <lauxlib.h>
+
+#include "box/box.h"
+#include "box/field_def.h"
+#include "box/space.h"
+#include "box/space_cache.h"
+#include "box/tuple_format.h"
+#include "box/txn.h"
+#include "coio_task.h"
+#include "csv/csv.h"
+#include "diag.h"
+#include "fiber.h"
+#include "fiber_cond.h"
+#include "lua/utils.h"
+#include "msgpuck.h"
+#include "trivia/util.h"
+
+enum {
+	/** Default size of a chunk read from the file at once. */
+	CSV_LOAD_CHUNK_SIZE_DEFAULT = 1024 * 1024,
+	/** Number of batches the parser may fill in advance. */
+	CSV_LOAD_BATCH_COUNT = 2,
+	/** Longest textual representation of a number that is parsed. */
+	CSV_LOAD_NUMBER_LEN_MAX = 64,
+};
+
+/** How a CSV value is converted to MsgPack. */
+enum csv_load_conv {
+	/** MP_STR. */
+	CSV_LOAD_STRING,
+	/** MP_BIN. */
+	CSV_LOAD_BINARY,
+	/** MP_UINT. */
+	CSV_LOAD_UNSIGNED,
+	/** MP_UINT or MP_INT. */
+	CSV_LOAD_INTEGER,
+	/** MP_UINT, MP_INT or MP_DOUBLE. */
+	CSV_LOAD_NUMBER,
+	/** MP_DOUBLE. */
+	CSV_LOAD_DOUBLE,
+	/** MP_FLOAT. */
+	CSV_LOAD_FLOAT,
+	/** MP_BOOL. */
+	CSV_LOAD_BOOLEAN,
+	/** A number if the value looks like one, MP_STR otherwise. */
+	CSV_LOAD_SCALAR,
+};
+
+/** Conversion rule of a field, derived from the space format. */
+struct csv_load_field {
+	/** How the value is converted. */
+	enum csv_load_conv conv;
+	/** If set, an empty value is loaded as nil. */
+	bool is_nullable;
+};
+
+/**
+ * Growable buffer allocated with malloc so that it can be filled
+ * in a coio thread and consumed in the tx thread.
+ */
+struct csv_load_buf {
+	char *data;
+	size_t size;
+	size_t capacity;
+};
+
+/** A batch of records loaded in one transaction. */
+struct csv_load_batch {
+	/** MsgPack arrays of the records, one after another. */
+	struct csv_load_buf rows;
+	/** Number of records in the batch. */
+	uint32_t row_count;
+};
+
+/**
+ * State of a CSV load. The parser part of it is only accessed by
+ * a coio thread while the tx thread waits for the parse call to
+ * complete, so no locking is needed.
+ */
+struct csv_load {
+	/** Id of the space to load the records into. */
+	uint32_t space_id;
+	/** If set, records are replaced rather than inserted. */
+	bool is_replace;
+	/** Descriptor of the file being loaded. */
+	int fd;
+	/** CSV parser. */
+	struct csv csv;
+	/** Buffer the file is read into. */
+	char *chunk;
+	/** Size of the chunk buffer. */
+	size_t chunk_size;
+	/** Conversion rules of the fields described by the format. */
+	struct csv_load_field *fields;
+	/** Number of elements in the fields array. */
+	uint32_t field_count;
+	/** Number of records at the file head left to skip. */
+	uint64_t skip_count;
+	/** Number of records parsed so far, skipped ones included. */
+	uint64_t record_count;
+	/** Encoded fields of the record being parsed. */
+	struct csv_load_buf row;
+	/** Number of fields of the record being parsed. */
+	uint32_t row_field_count;
+	/**
+	 * Set if the first field of the record being parsed is empty.
+	 * Its encoding is postponed till the second field arrives since
+	 * a record of one empty field is a blank line, which is skipped.
+	 */
+	bool first_field_is_empty;
+	/** Batch filled by the current parse call. */
+	struct csv_load_batch *batch;
+	/** Set when the whole file has been parsed. */
+	bool is_eof;
+	/** Set if parsing failed. */
+	bool is_failed;
+	/** Error number if reading the file failed, 0 otherwise. */
+	int read_errno;
+	/** Description of the parse error. */
+	char errmsg[DIAG_ERRMSG_MAX];
+	/** Batches passed from the parser fiber to the loading fiber. */
+	struct csv_load_batch batches[CSV_LOAD_BATCH_COUNT];
+	/** Number of filled batches that have not been loaded yet. */
+	int ready_count;
+	/** Number of batches filled so far. */
+	uint64_t fill_count;
+	/** Number of batches loaded so far. */
+	uint64_t load_count;
+	/** Signalled whenever a batch is filled or loaded. */
+	struct fiber_cond cond;
+	/** Fiber that drives the parser. */
+	struct fiber *parser;
+	/** Set when the parser fiber has stopped. */
+	bool parser_is_done;
+	/** Set to stop the parser fiber. */
+	bool is_stopping;
+	/** Number of records loaded into the space. */
+	uint64_t loaded_count;
+};
+
+/** Reserve @a size bytes at the end of @a buf. */
+static char *
+csv_load_buf_reserve(struct csv_load_buf *buf, size_t size)
+{
+	if (buf->size + size > buf->capacity) {
+		size_t capacity = MAX(buf->capacity * 2, (size_t)4096);
+		while (capacity < buf->size + size)
+			capacity *= 2;
+		buf->data = xrealloc(buf->data, capacity);
+		buf->capacity = capacity;
+	}
+	return buf->data + buf->size;
+}
+
+/** Mark the end of data written to a reserved area of @a buf. */
+static inline void
+csv_load_buf_advance(struct csv_load_buf *buf, char *end)
+{
+	buf->size = end - buf->data;
+	assert(buf->size <= buf->capacity);
+}
+
+/** Set the parse error unless it has already been set. */
+static void
+csv_load_fail(struct csv_load *load, const char *format, ...)
+{
+	if (load->is_failed)
+		return;
+	load->is_failed = true;
+	int len = snprintf(load->errmsg, sizeof(load->errmsg), "record %llu: ",
+			   (unsigned long long)load->record_count + 1);
+	va_list ap;
+	va_start(ap, format);
+	vsnprintf(load->errmsg + len, sizeof(load->errmsg) - len, format, ap);
+	va_end(ap);
+}
+
+/**
+ * Encode a number to @a buf according to @a conv.
+ * Returns -1 if the value is not a number of the required kind.
+ */
+static int
+csv_load_encode_number(struct csv_load_buf *buf, enum csv_load_conv conv,
+		       const char *str, size_t len)
+{
+	char tmp[CSV_LOAD_NUMBER_LEN_MAX];
+	if (len == 0 || len >= sizeof(tmp))
+		return -1;
+	memcpy(tmp, str, len);
+	tmp[len] = '\0';
+	char *end;
+	char *p = csv_load_buf_reserve(buf, mp_sizeof_double(0));
+	if (conv != CSV_LOAD_DOUBLE && conv != CSV_LOAD_FLOAT) {
+		errno = 0;
+		if (tmp[0] == '-' && conv != CSV_LOAD_UNSIGNED) {
+			long long value = strtoll(tmp, &end, 10);
+			if (*end == '\0' && errno == 0) {
+				p = value < 0 ? mp_encode_int(p, value) :
+				    mp_encode_uint(p, value);
+				goto done;
+			}
+		} else if (isdigit((unsigned char)tmp[0])) {
+			unsigned long long value = strtoull(tmp, &end, 10);
+			if (*end == '\0' && errno == 0) {
+				p = mp_encode_uint(p, value);
+				goto done;
+			}
+		}
+		if (conv == CSV_LOAD_UNSIGNED || conv == CSV_LOAD_INTEGER)
+			return -1;
+	}
+	double value = strtod(tmp, &end);
+	if (*end != '\0' || !isfinite(value))
+		return -1;
+	if (conv == CSV_LOAD_FLOAT)
+		p = mp_encode_float(p, value);
+	else
+		p = mp_encode_double(p, value);
+done:
+	csv_load_buf_advance(buf, p);
+	return 0;
+}
+
+/**
+ * Encode a CSV value to @a buf according to the conversion rule
+ * @a field. Returns NULL on success, the error description if the
+ * value can't be converted.
+ */
+static const char *
+csv_load_encode(struct csv_load_buf *buf, const struct csv_load_field *field,
+		const char *str, size_t len)
+{
+	char *p;
+	if (len == 0 && field->is_nullable) {
+		p = csv_load_buf_reserve(buf, mp_sizeof_nil());
+		csv_load_buf_advance(buf, mp_encode_nil(p));
+		return NULL;
+	}
+	switch (field->conv) {
+	case CSV_LOAD_STRING:
+		p = csv_load_buf_reserve(buf, mp_sizeof_str(len));
+		csv_load_buf_advance(buf, mp_encode_str(p, str, len));
+		return NULL;
+	case CSV_LOAD_BINARY:
+		p = csv_load_buf_reserve(buf, mp_sizeof_bin(len));
+		csv_load_buf_advance(buf, mp_encode_bin(p, str, len));
+		return NULL;
+	case CSV_LOAD_BOOLEAN:
+		p = csv_load_buf_reserve(buf, mp_sizeof_bool(false));
+		if (len == 4 && strncasecmp(str, "true", len) == 0)
+			p = mp_encode_bool(p, true);
+		else if (len == 5 && strncasecmp(str, "false", len) == 0)
+			p = mp_encode_bool(p, false);
+		else
+			return "expected boolean";
+		csv_load_buf_advance(buf, p);
+		return NULL;
+	case CSV_LOAD_SCALAR:
+		if (csv_load_encode_number(buf, CSV_LOAD_NUMBER,
+					   str, len) == 0)
+			return NULL;
+		p = csv_load_buf_reserve(buf, mp_sizeof_str(len));
+		csv_load_buf_advance(buf, mp_encode_str(p, str, len));
+		return NULL;
+	case CSV_LOAD_UNSIGNED:
+		if (csv_load_encode_number(buf, field->conv, str, len) != 0)
+			return "expected unsigned";
+		return NULL;
+	case CSV_LOAD_INTEGER:
+		if (csv_load_encode_number(buf, field->conv, str, len) != 0)
+			return "expected integer";
+		return NULL;
+	case CSV_LOAD_NUMBER:
+	case CSV_LOAD_DOUBLE:
+	case CSV_LOAD_FLOAT:
+		if (csv_load_encode_number(buf, field->conv, str, len) != 0)
+			return "expected number";
+		return NULL;
+	default:
+		unreachable();
+	}
+	return NULL;
+}
+
+/** Encode field @a fieldno of the current record. */
+static void
+csv_load_encode_field(struct csv_load *load, uint32_t fieldno,
+		      const char *str, size_t len)
+{
+	static const struct csv_load_field any = {CSV_LOAD_STRING, false};
+	const struct csv_load_field *field = fieldno < load->field_count ?
+					     &load->fields[fieldno] : &any;
+	const char *err = csv_load_encode(&load->row, field, str, len);
+	if (err != NULL)
+		csv_load_fail(load, "field %u: %s", fieldno + 1, err);
+}
+
+/** CSV parser callback invoked for each field. */
+static void
+csv_load_emit_field(void *ctx, const char *field, const char *end)
+{
+	struct csv_load *load = ctx;
+	uint32_t fieldno = load->row_field_count++;
+	if (fieldno == 0)
+		load->first_field_is_empty = field == end;
+	if (load->is_failed || load->skip_count > 0)
+		return;
+	if (fieldno == 0 && load->first_field_is_empty)
+		return;
+	if (fieldno == 1 && load->first_field_is_empty)
+		csv_load_encode_field(load, 0, "", 0);
+	csv_load_encode_field(load, fieldno, field, end - field);
+}
+
+/** CSV parser callback invoked at the end of each record. */
+static void
+csv_load_emit_row(void *ctx)
+{
+	struct csv_load *load = ctx;
+	uint32_t field_count = load->row_field_count;
+	struct csv_load_buf *row = &load->row;
+	load->row_field_count = 0;
+	if (field_count == 1 && load->first_field_is_empty) {
+		/* Blank line. */
+		row->size = 0;
+		return;
+	}
+	if (load->is_failed) {
+		row->size = 0;
+		return;
+	}
+	load->record_count++;
+	if (load->skip_count > 0) {
+		load->skip_count--;
+		row->size = 0;
+		return;
+	}
+	struct csv_load_buf *rows = &load->batch->rows;
+	char *p = csv_load_buf_reserve(rows, mp_sizeof_array(field_count) +
+					     row->size);
+	p = mp_encode_array(p, field_count);
+	memcpy(p, row->data, row->size);
+	csv_load_buf_advance(rows, p + row->size);
+	load->batch->row_count++;
+	row->size = 0;
+}
+
+/**
+ * Read the next chunk of the file and parse it into the current
+ * batch. Runs in a coio thread.
+ */
+static ssize_t
+csv_load_parse_f(va_list ap)
+{
+	struct csv_load *load = va_arg(ap, struct csv_load *);
+	ssize_t n;
+	do {
+		n = read(load->fd, load->chunk, load->chunk_size);
+	} while (n < 0 && errno == EINTR);
+	if (n < 0) {
+		load->read_errno = errno;
+		load->is_failed = true;
+		return -1;
+	}
+	if (n == 0) {
+		csv_finish_parsing(&load->csv);
+		load->is_eof = true;
+	} else {
+		csv_parse_chunk(&load->csv, load->chunk, load->chunk + n);
+	}
+	switch (csv_get_error_status(&load->csv)) {
+	case CSV_ER_OK:
+		break;
+	case CSV_ER_MEMORY_ERROR:
+		csv_load_fail(load, "out of memory");
+		break;
+	default:
+		csv_load_fail(load, "invalid CSV");
+		break;
+	}
+	return load->is_failed ? -1 : 0;
+}
+
+/**
+ * Parser fiber. Fills batches ahead of the loading fiber so that
+ * parsing of the next chunk overlaps with loading of the previous
+ * one.
+ */
+static int
+csv_load_parser_f(va_list ap)
+{
+	struct csv_load *load = va_arg(ap, struct csv_load *);
+	while (!load->is_stopping && !load->is_eof && !load->is_failed) {
+		if (load->ready_count == CSV_LOAD_BATCH_COUNT) {
+			fiber_cond_wait(&load->cond);
+			continue;
+		}
+		struct csv_load_batch *batch = &load->batches[
+			load->fill_count % CSV_LOAD_BATCH_COUNT];
+		batch->rows.size = 0;
+		batch->row_count = 0;
+		load->batch = batch;
+		if (coio_call(csv_load_parse_f, load) != 0 &&
+		    !load->is_failed) {
+			/* Failed to start the task. */
+			load->read_errno = errno;
+			load->is_failed = true;
+		}
+		/* Records parsed before an error are still loaded. */
+		load->fill_count++;
+		load->ready_count++;
+		fiber_cond_broadcast(&load->cond);
+	}
+	load->parser_is_done = true;
+	fiber_cond_broadcast(&load->cond);
+	return 0;
+}
+
+/** Load the records of @a batch into the space in one transaction. */
+static int
+csv_load_batch_load(struct csv_load *load, struct csv_load_batch *batch)
+{
+	if (batch->row_count == 0)
+		return 0;
+	if (box_txn_begin() != 0)
+		return -1;
+	const char *pos = batch->rows.data;
+	const char *end = pos + batch->rows.size;
+	while (pos < end) {
+		const char *tuple = pos;
+		mp_next(&pos);
+		int rc = load->is_replace ?
+			 box_replace(load->space_id, tuple, pos, NULL) :
+			 box_insert(load->space_id, tuple, pos, NULL);
+		if (rc != 0) {
+			box_txn_rollback();
+			return -1;
+		}
+	}
+	if (box_txn_commit() != 0)
+		return -1;
+	load->loaded_count += batch->row_count;
+	return 0;
+}
+
+/** Load batches as they are filled by the parser fiber. */
+static int
+csv_load_run(struct csv_load *load)
+{
+	int rc = 0;
+	while (true) {
+		if (load->ready_count == 0) {
+			if (load->parser_is_done)
+				break;
+			if (fiber_cond_wait(&load->cond) != 0) {
+				rc = -1;
+				break;
+			}
+			continue;
+		}
+		struct csv_load_batch *batch = &load->batches[
+			load->load_count % CSV_LOAD_BATCH_COUNT];
+		if (csv_load_batch_load(load, batch) != 0) {
+			rc = -1;
+			break;
+		}
+		load->load_count++;
+		load->ready_count--;
+		fiber_cond_broadcast(&load->cond);
+	}
+	load->is_stopping = true;
+	fiber_cond_broadcast(&load->cond);
+	fiber_join(load->parser);
+	if (rc == 0 && load->is_failed) {
+		if (load->read_errno != 0) {
+			errno = load->read_errno;
+			diag_set(SystemError, "failed to read CSV file");
+		} else {
+			diag_set(IllegalParams, "Failed to load CSV at %s",
+				 load->errmsg);
+		}
+		rc = -1;
+	}
+	return rc;
+}
+
+/**
+ * Build the field conversion rules from the space format.
+ * Returns -1 and sets diag if the format has a field of a type
+ * that can't be loaded from CSV.
+ */
+static int
+csv_load_create_fields(struct csv_load *load, struct tuple_format *format)
+{
+	uint32_t field_count = tuple_format_field_count(format);
+	load->fields = xcalloc(MAX(field_count, 1), sizeof(*load->fields));
+	load->field_count = field_count;
+	for (uint32_t i = 0; i < field_count; i++) {
+		struct tuple_field *tuple_field = tuple_format_field(format, i);
+		struct csv_load_field *field = &load->fields[i];
+		field->is_nullable = tuple_field_is_nullable(tuple_field);
+		switch (tuple_field->type) {
+		case FIELD_TYPE_ANY:
+		case FIELD_TYPE_STRING:
+			field->conv = CSV_LOAD_STRING;
+			break;
+		case FIELD_TYPE_VARBINARY:
+			field->conv = CSV_LOAD_BINARY;
+			break;
+		case FIELD_TYPE_UNSIGNED:
+		case FIELD_TYPE_UINT8:
+		case FIELD_TYPE_UINT16:
+		case FIELD_TYPE_UINT32:
+		case FIELD_TYPE_UINT64:
+			field->conv = CSV_LOAD_UNSIGNED;
+			break;
+		case FIELD_TYPE_INTEGER:
+		case FIELD_TYPE_INT8:
+		case FIELD_TYPE_INT16:
+		case FIELD_TYPE_INT32:
+		case FIELD_TYPE_INT64:
+			field->conv = CSV_LOAD_INTEGER;
+			break;
+		case FIELD_TYPE_NUMBER:
+			field->conv = CSV_LOAD_NUMBER;
+			break;
+		case FIELD_TYPE_DOUBLE:
+		case FIELD_TYPE_FLOAT64:
+			field->conv = CSV_LOAD_DOUBLE;
+			break;
+		case FIELD_TYPE_FLOAT32:
+			field->conv = CSV_LOAD_FLOAT;
+			break;
+		case FIELD_TYPE_BOOLEAN:
+			field->conv = CSV_LOAD_BOOLEAN;
+			break;
+		case FIELD_TYPE_SCALAR:
+			field->conv = CSV_LOAD_SCALAR;
+			break;
+		default:
+			diag_set(IllegalParams, "Failed to load CSV: "
+				 "field %u has type '%s' that is not supported",
+				 i + 1, field_type_strs[tuple_field->type]);
+			return -1;
+		}
+	}
+	return 0;
+}
+
+/** Free the resources of @a load. */
+static void
+csv_load_destroy(struct csv_load *load)
+{
+	for (int i = 0; i < CSV_LOAD_BATCH_COUNT; i++)
+		free(load->batches[i].rows.data);
+	free(load->row.data);
+	free(load->chunk);
+	free(load->fields);
+	csv_destroy(&load->csv);
+	fiber_cond_destroy(&load->cond);
+	close(load->fd);
+}
+
+/** Get a single character option from the options table. */
+static char
+luaT_load_csv_char_opt(struct lua_State *L, const char *name, char dflt)
+{
+	char c = dflt;
+	lua_getfield(L, 3, name);
+	if (!lua_isnil(L, -1)) {
+		size_t len;
+		const char *str = lua_tolstring(L, -1, &len);
+		if (str == NULL || len != 1)
+			luaL_error(L, "%s must be a single character", name);
+		c = str[0];
+	}
+	lua_pop(L, 1);
+	return c;
+}
+
+/**
+ * box.internal.space.load_csv(space_id, path, opts)
+ *
+ * Loads the records of a CSV file into a space and returns their
+ * number. Supported options: delimiter, quote_char, skip_head_lines,
+ * chunk_size, mode ('insert' or 'replace').
+ */
+static int
+lbox_space_load_csv(struct lua_State *L)
+{
+	if (lua_gettop(L) != 3 || !lua_isnumber(L, 1) ||
+	    !lua_isstring(L, 2) || !lua_istable(L, 3))
+		return luaL_error(L, "Usage: load_csv(space_id, path, opts)");
+	uint32_t space_id = lua_tointeger(L, 1);
+	const char *path = lua_tostring(L, 2);
+	char delimiter = luaT_load_csv_char_opt(L, "delimiter", ',');
+	char quote_char = luaT_load_csv_char_opt(L, "quote_char", '"');
+	lua_getfield(L, 3, "skip_head_lines");
+	uint64_t skip_count = lua_isnil(L, -1) ? 0 : luaL_checkuint64(L, -1);
+	lua_pop(L, 1);
+	lua_getfield(L, 3, "chunk_size");
+	uint64_t chunk_size = lua_isnil(L, -1) ? CSV_LOAD_CHUNK_SIZE_DEFAULT :
+			      luaL_checkuint64(L, -1);
+	lua_pop(L, 1);
+	if (chunk_size == 0 || chunk_size > INT32_MAX)
+		return luaL_error(L, "chunk_size must be in range [1, %d]",
+				  INT32_MAX);
+	bool is_replace = false;
+	lua_getfield(L, 3, "mode");
+	if (!lua_isnil(L, -1)) {
+		const char *mode = lua_tostring(L, -1);
+		if (mode != NULL && strcmp(mode, "replace") == 0)
+			is_replace = true;
+		else if (mode == NULL || strcmp(mode, "insert") != 0)
+			return luaL_error(L, "mode must be 'insert' or "
+					  "'replace'");
+	}
+	lua_pop(L, 1);
+
+	struct space *space = space_by_id(space_id);
+	if (space == NULL) {
+		diag_set(ClientError, ER_NO_SUCH_SPACE, int2str(space_id));
+		return luaT_error(L);
+	}
+	struct csv_load load;
+	memset(&load, 0, sizeof(load));
+	load.space_id = space_id;
+	load.is_replace = is_replace;
+	load.skip_count = skip_count;
+	load.chunk_size = chunk_size;
+	load.fd = open(path, O_RDONLY);
+	if (load.fd < 0) {
+		diag_set(SystemError, "failed to open '%s'", path);
+		return luaT_error(L);
+	}
+	csv_create(&load.csv);
+	csv_setopt(&load.csv, CSV_OPT_DELIMITER, delimiter);
+	csv_setopt(&load.csv, CSV_OPT_QUOTE, quote_char);
+	csv_setopt(&load.csv, CSV_OPT_EMIT_FIELD, csv_load_emit_field);
+	csv_setopt(&load.csv, CSV_OPT_EMIT_ROW, csv_load_emit_row);
+	csv_setopt(&load.csv, CSV_OPT_EMIT_CTX, &load);
+	fiber_cond_create(&load.cond);
+	load.chunk = xmalloc(chunk_size);
+	if (csv_load_create_fields(&load, space->format) != 0)
+		goto error;
+	load.parser = fiber_new("load_csv", csv_load_parser_f);
+	if (load.parser == NULL)
+		goto error;
+	fiber_set_joinable(load.parser, true);
+	fiber_start(load.parser, &load);
+	if (csv_load_run(&load) != 0)
+		goto error;
+	csv_load_destroy(&load);
+	luaL_pushuint64(L, load.loaded_count);
+	return 1;
+error:
+	csv_load_destroy(&load);
+	return luaT_error(L);
+}
+
+void
+box_lua_load_csv_init(struct lua_State *L)
+{
+	static const struct luaL_Reg space_internal_lib[] = {
+		{"load_csv", lbox_space_load_csv},
+		{NULL, NULL}
+	};
+	luaL_findtable(L, LUA_GLOBALSINDEX, "box.internal.space", 0);
+	luaL_setfuncs(L, space_internal_lib, 0);
+	lua_pop(L, 1);
+}
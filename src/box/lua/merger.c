@@ -434,6 +434,11 @@ static int
 luaL_merge_source_buffer_next(struct merge_source *base,
 			      struct tuple_format *format,
 			      struct tuple **out);
+static int
+luaL_merge_source_buffer_next_batch(struct merge_source *base,
+				    struct tuple_format *format,
+				    struct tuple **out, uint32_t size,
+				    uint32_t *count);
 
 /* Non-virtual methods */
 
@@ -450,6 +455,7 @@ luaL_merge_source_buffer_new(struct lua_State *L)
 	static struct merge_source_vtab merge_source_buffer_vtab = {
 		.destroy = luaL_merge_source_buffer_destroy,
 		.next = luaL_merge_source_buffer_next,
+		.next_batch = luaL_merge_source_buffer_next_batch,
 	};
 
 	struct merge_source_buffer *source = malloc(
@@ -559,41 +565,26 @@ luaL_merge_source_buffer_destroy(struct merge_source *base)
 }
 
 /**
- * next() virtual method implementation for a buffer source.
+ * Decode a next tuple from the current chunk of a buffer source.
+ * The chunk must have remaining tuples.
  *
- * @see struct merge_source_vtab
+ * Return a tuple (not refcounted) at success. Return NULL at an
+ * error and set a diag.
  */
-static int
-luaL_merge_source_buffer_next(struct merge_source *base,
-			      struct tuple_format *format,
-			      struct tuple **out)
+static struct tuple *
+luaL_merge_source_buffer_decode(struct merge_source_buffer *source,
+				struct tuple_format *format)
 {
-	struct merge_source_buffer *source = container_of(base,
-		struct merge_source_buffer, base);
-
-	/*
-	 * Handle the case when all data were processed: ask a
-	 * next chunk until a non-empty chunk is received or a
-	 * chunks iterator ends.
-	 */
-	while (source->remaining_tuple_count == 0) {
-		int rc = luaL_merge_source_buffer_fetch(source);
-		if (rc < 0)
-			return -1;
-		if (rc == 0) {
-			*out = NULL;
-			return 0;
-		}
-	}
+	assert(source->remaining_tuple_count > 0);
 	if (ibuf_used(source->buf) == 0) {
 		diag_set(IllegalParams, "Unexpected msgpack buffer end");
-		return -1;
+		return NULL;
 	}
 	const char *tuple_beg = source->buf->rpos;
 	const char *tuple_end = tuple_beg;
 	if (mp_check(&tuple_end, source->buf->wpos) != 0) {
 		diag_set(IllegalParams, "Unexpected msgpack buffer end");
-		return -1;
+		return NULL;
 	}
 	--source->remaining_tuple_count;
 	if (format == NULL)
@@ -609,13 +600,56 @@ luaL_merge_source_buffer_next(struct merge_source *base,
 			diag_set(IllegalParams,
 				 "Unexpected MsgPack extension type "
 				 "(should be MP_TUPLE)");
-			return -1;
+			return NULL;
 		}
 		/* Skip the tuple format identifier. */
 		mp_decode_uint(&tuple_beg);
 	}
 	struct tuple *tuple = tuple_new(format, tuple_beg, tuple_end);
 	ibuf_consume_before(source->buf, tuple_end);
+	return tuple;
+}
+
+/**
+ * Handle the case when all data of a buffer source were
+ * processed: ask a next chunk until a non-empty chunk is
+ * received or a chunks iterator ends.
+ *
+ * Return 1 when there are tuples to decode, 0 when there are no
+ * more data and -1 at an error (set a diag).
+ */
+static int
+luaL_merge_source_buffer_prepare(struct merge_source_buffer *source)
+{
+	while (source->remaining_tuple_count == 0) {
+		int rc = luaL_merge_source_buffer_fetch(source);
+		if (rc <= 0)
+			return rc;
+	}
+	return 1;
+}
+
+/**
+ * next() virtual method implementation for a buffer source.
+ *
+ * @see struct merge_source_vtab
+ */
+static int
+luaL_merge_source_buffer_next(struct merge_source *base,
+			      struct tuple_format *format,
+			      struct tuple **out)
+{
+	struct merge_source_buffer *source = container_of(base,
+		struct merge_source_buffer, base);
+
+	int rc = luaL_merge_source_buffer_prepare(source);
+	if (rc < 0)
+		return -1;
+	if (rc == 0) {
+		*out = NULL;
+		return 0;
+	}
+	struct tuple *tuple = luaL_merge_source_buffer_decode(source, format);
 	if (tuple == NULL)
 		return -1;
 
@@ -624,6 +658,44 @@ luaL_merge_source_buffer_next(struct merge_source *base,
 	return 0;
 }
 
+/**
+ * next_batch() virtual method implementation for a buffer source.
+ *
+ * Decodes tuples of the current chunk only, so a next chunk is
+ * requested at the same moment as with next().
+ *
+ * @see struct merge_source_vtab
+ */
+static int
+luaL_merge_source_buffer_next_batch(struct merge_source *base,
+				    struct tuple_format *format,
+				    struct tuple **out, uint32_t size,
+				    uint32_t *count)
+{
+	struct merge_source_buffer *source = container_of(base,
+		struct merge_source_buffer, base);
+
+	*count = 0;
+	int rc = luaL_merge_source_buffer_prepare(source);
+	if (rc <= 0)
+		return rc;
+	if (size > source->remaining_tuple_count)
+		size = source->remaining_tuple_count;
+	for (uint32_t i = 0; i < size; ++i) {
+		struct tuple *tuple = luaL_merge_source_buffer_decode(source,
+								      format);
+		if (tuple == NULL) {
+			for (uint32_t j = 0; j < i; ++j)
+				tuple_unref(out[j]);
+			return -1;
+		}
+		tuple_ref(tuple);
+		out[i] = tuple;
+	}
+	*count = size;
+	return 0;
+}
+
 /* Lua functions */
 
 /**
@@ -663,6 +735,11 @@ static int
 luaL_merge_source_table_next(struct merge_source *base,
 			     struct tuple_format *format,
 			     struct tuple **out);
+static int
+luaL_merge_source_table_next_batch(struct merge_source *base,
+				   struct tuple_format *format,
+				   struct tuple **out, uint32_t size,
+				   uint32_t *count);
 
 /* Non-virtual methods */
 
@@ -677,6 +754,7 @@ luaL_merge_source_table_new(struct lua_State *L)
 	static struct merge_source_vtab merge_source_table_vtab = {
 		.destroy = luaL_merge_source_table_destroy,
 		.next = luaL_merge_source_table_next,
+		.next_batch = luaL_merge_source_table_next_batch,
 	};
 
 	struct merge_source_table *source = malloc(
@@ -832,6 +910,76 @@ luaL_merge_source_table_next(struct merge_source *base,
 	return rc;
 }
 
+/**
+ * Helper for `luaL_merge_source_table_next_batch()`.
+ */
+static int
+luaL_merge_source_table_next_batch_impl(struct merge_source *base,
+					struct tuple_format *format,
+					struct tuple **out, uint32_t size,
+					uint32_t *count, struct lua_State *L)
+{
+	struct merge_source_table *source = container_of(base,
+		struct merge_source_table, base);
+
+	*count = 0;
+	/* The first tuple may require to fetch a next table. */
+	struct tuple *tuple;
+	if (luaL_merge_source_table_next_impl(base, format, &tuple, L) != 0)
+		return -1;
+	if (tuple == NULL)
+		return 0;
+	out[0] = tuple;
+	uint32_t n = 1;
+	/* Take the rest of the tuples from the current table only. */
+	lua_rawgeti(L, LUA_REGISTRYINDEX, source->ref);
+	for (; n < size; ++n) {
+		lua_pushinteger(L, source->next_idx);
+		lua_gettable(L, -2);
+		if (lua_isnil(L, -1))
+			break;
+		tuple = luaT_gettuple(L, -1, format);
+		if (tuple == NULL) {
+			for (uint32_t i = 0; i < n; ++i)
+				tuple_unref(out[i]);
+			return -1;
+		}
+		++source->next_idx;
+		lua_pop(L, 1);
+		tuple_ref(tuple);
+		out[n] = tuple;
+	}
+	*count = n;
+	return 0;
+}
+
+/**
+ * next_batch() virtual method implementation for a table source.
+ *
+ * Unlike next(), it acquires a temporary Lua state once per
+ * batch.
+ *
+ * @see struct merge_source_vtab
+ */
+static int
+luaL_merge_source_table_next_batch(struct merge_source *base,
+				   struct tuple_format *format,
+				   struct tuple **out, uint32_t size,
+				   uint32_t *count)
+{
+	int coro_ref = LUA_NOREF;
+	int top = -1;
+	struct lua_State *L = luaT_temp_luastate(&coro_ref, &top);
+	if (L == NULL) {
+		*count = 0;
+		return -1;
+	}
+	int rc = luaL_merge_source_table_next_batch_impl(base, format, out,
+							 size, count, L);
+	luaT_release_temp_luastate(L, coro_ref, top);
+	return rc;
+}
+
 /* Lua functions */
 
 /**
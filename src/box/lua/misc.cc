@@ -305,11 +305,12 @@ lbox_prepare_auth(lua_State *L)
 static int
 lbox_select(lua_State *L)
 {
-	if (lua_gettop(L) != 8 || !lua_isnumber(L, 1) || !lua_isnumber(L, 2) ||
+	if (lua_gettop(L) != 10 || !lua_isnumber(L, 1) || !lua_isnumber(L, 2) ||
 	    !lua_isnumber(L, 3) || !lua_isnumber(L, 4) || !lua_isnumber(L, 5) ||
 	    !lua_isboolean(L, 8)) {
 		return luaL_error(L, "Usage index:select(iterator, offset, "
-				  "limit, key, after, fetch_pos)");
+				  "limit, key, after, fetch_pos, fields, "
+				  "filter)");
 	}
 
 	uint32_t svp = region_used(&fiber()->gc);
@@ -327,13 +328,32 @@ lbox_select(lua_State *L)
 	const char *key = lbox_encode_tuple_on_gc(L, 6, &key_len);
 	if (key == NULL)
 		goto fail;
+	const char *fields, *fields_end;
+	fields = fields_end = NULL;
+	if (!lua_isnil(L, 9)) {
+		size_t fields_len;
+		fields = lbox_encode_tuple_on_gc(L, 9, &fields_len);
+		if (fields == NULL)
+			goto fail;
+		fields_end = fields + fields_len;
+	}
+	const char *filter, *filter_end;
+	filter = filter_end = NULL;
+	if (!lua_isnil(L, 10)) {
+		size_t filter_len;
+		filter = lbox_encode_tuple_on_gc(L, 10, &filter_len);
+		if (filter == NULL)
+			goto fail;
+		filter_end = filter + filter_len;
+	}
 	const char *packed_pos, *packed_pos_end;
 	if (lbox_index_normalize_position(L, 7, space_id, index_id,
 					  &packed_pos, &packed_pos_end) != 0)
 		goto fail;
 
 	if (box_select(space_id, index_id, iterator, offset, limit, key,
-		       key + key_len, &packed_pos, &packed_pos_end, fetch_pos,
+		       key + key_len, fields, fields_end, filter, filter_end,
+		       &packed_pos, &packed_pos_end, fetch_pos, false,
 		       &port) != 0)
 		goto fail;
 	/*
@@ -37,6 +37,7 @@
 #include <stdint.h>
 #include <sys/socket.h>
 #include <sys/types.h>
+#include <unistd.h>
 
 #include "box/authentication.h"
 #include "box/errcode.h"
@@ -51,7 +52,9 @@
 #include "box/schema_def.h"
 #include "box/mp_box_ctx.h"
 #include "box/mp_tuple.h"
+#include "box/zstd_iostream.h"
 
+#include "cbus.h"
 #include "coio.h"
 #include "fiber.h"
 #include "fiber_cond.h"
@@ -64,7 +67,9 @@
 #include "msgpuck.h"
 #include "small/ibuf.h"
 #include "small/region.h"
+#include "small/stailq.h"
 #include "mpstream/mpstream.h"
+#include "tweaks.h"
 #include "uri/uri.h"
 #include "version.h"
 
@@ -101,6 +106,9 @@ static struct iproto_features NETBOX_IPROTO_FEATURES;
 	_(UPSERT)							\
 	_(SELECT)							\
 	_(SELECT_WITH_POS)						\
+	_(SELECT_MANY)							\
+	_(GET_MANY)							\
+	_(INSERT_ARROW)							\
 	_(EXECUTE)							\
 	_(PREPARE)							\
 	_(UNPREPARE)							\
@@ -178,6 +186,87 @@ struct netbox_options {
 	 * Flag that determines is it required to fetch server schema or not.
 	 */
 	 bool fetch_schema;
+	/**
+	 * Read and frame responses in a net.box I/O thread rather than
+	 * in the worker fiber. Ignored for encrypted and compressed
+	 * connections.
+	 */
+	bool io_thread;
+	/**
+	 * Ask the server to compress the connection with zstd, see
+	 * IPROTO_FEATURE_COMPRESSION.
+	 */
+	bool compression;
+};
+
+struct netbox_io_thread;
+struct netbox_transport;
+struct netbox_io_reader;
+
+/**
+ * A batch of complete responses read by a net.box I/O thread.
+ *
+ * A batch travels between the I/O thread, which fills it, and tx,
+ * which processes it and then returns it back to the thread for
+ * reuse.
+ */
+struct netbox_io_batch {
+	/** Message used for passing the batch between threads. */
+	struct cmsg base;
+	/** Reader this batch belongs to. */
+	struct netbox_io_reader *reader;
+	/** Link in netbox_io_reader::ready. */
+	struct stailq_entry in_ready;
+	/** Received responses, each prefixed with its size. */
+	char *data;
+	/** Size of the received data. */
+	size_t size;
+	/** Size of the allocated buffer. */
+	size_t capacity;
+	/** Offset of the next response to process in tx. */
+	size_t rpos;
+	/** Set if the batch is not in the thread. Thread only. */
+	bool is_busy;
+	/**
+	 * Set if the thread stopped reading after this batch. The error
+	 * that stopped it is stored in the diagnostics area.
+	 */
+	bool is_eof;
+	/** Error that stopped the reader if is_eof is set. */
+	struct diag diag;
+};
+
+/**
+ * State of a connection whose responses are read by a net.box I/O
+ * thread. The thread reads a duplicate of the connection fd, splits
+ * the input into responses and passes them to tx in batches, while
+ * requests are still written by the worker fiber in tx.
+ */
+struct netbox_io_reader {
+	/** Transport this reader belongs to. */
+	struct netbox_transport *transport;
+	/** Thread reading the connection or NULL if never started. */
+	struct netbox_io_thread *thread;
+	/** Duplicate of the connection fd, closed by the thread. */
+	int fd;
+	/** Set while the thread reads the connection. Tx only. */
+	bool is_active;
+	/** Signalled in tx when the thread stops reading. */
+	struct fiber_cond on_stop;
+	/** Batches received by tx but not processed yet. Tx only. */
+	struct stailq ready;
+	/** Fiber reading the connection. Thread only. */
+	struct fiber *fiber;
+	/** Set when tx asked the thread to stop reading. Thread only. */
+	bool is_stopping;
+	/** Signalled in the thread when tx returns a batch. */
+	struct fiber_cond on_batch_free;
+	/** The thread fills one batch while tx processes the other. */
+	struct netbox_io_batch batches[2];
+	/** Message asking the thread to start reading. */
+	struct cmsg start_msg;
+	/** Message asking the thread to stop reading, sent back on stop. */
+	struct cmsg stop_msg;
 };
 
 /**
@@ -273,6 +362,14 @@ struct netbox_transport {
 	struct ibuf recv_buf;
 	/** Size of the last received message. */
 	size_t last_msg_size;
+	/** Reader of the connection used if io_thread is set. */
+	struct netbox_io_reader io_reader;
+	/**
+	 * Set when a request is queued to the empty send buffer. The worker
+	 * yields once before writing then so that requests queued by other
+	 * fibers in the same event loop iteration are sent with one write.
+	 */
+	bool flush_is_deferred;
 	/** Signalled when send_buf becomes empty. */
 	struct fiber_cond on_send_buf_empty;
 	/** Next request id. */
@@ -288,6 +385,14 @@ struct netbox_transport {
 	int64_t inprogress_request_count;
 };
 
+/** Requests waited for by a fiber at once (see net.box.wait_all()). */
+struct netbox_request_group {
+	/** Number of requests that haven't completed yet. */
+	int pending;
+	/** Fiber waiting for the requests. */
+	struct fiber *fiber;
+};
+
 struct netbox_request {
 	enum netbox_method method;
 	/**
@@ -350,6 +455,8 @@ struct netbox_request {
 	 * the response hasn't been received yet.
 	 */
 	struct error *error;
+	/** Group this request is waited in or NULL. */
+	struct netbox_request_group *group;
 };
 
 /*
@@ -438,6 +545,12 @@ static inline void
 netbox_request_signal(struct netbox_request *request)
 {
 	fiber_cond_broadcast(&request->cond);
+	struct netbox_request_group *group = request->group;
+	if (group != NULL && netbox_request_is_ready(request)) {
+		request->group = NULL;
+		if (--group->pending == 0)
+			fiber_wakeup(group->fiber);
+	}
 }
 
 static inline void
@@ -505,6 +618,465 @@ netbox_request_push_result(struct netbox_request *request, struct lua_State *L)
 	return 1;
 }
 
+/** Thread reading responses of net.box connections. */
+struct netbox_io_thread {
+	/** Thread handle. */
+	struct cord cord;
+	/** Endpoint of the thread. */
+	struct cbus_endpoint endpoint;
+	/** Pipe from tx to the thread. */
+	struct cpipe thread_pipe;
+	/** Pipe from the thread to tx. */
+	struct cpipe tx_pipe;
+};
+
+/**
+ * Max number of net.box I/O threads. Connections are distributed among
+ * the threads in a round-robin fashion. The threads are started on
+ * demand and never stopped.
+ */
+static uint64_t netbox_io_thread_count = 1;
+TWEAK_UINT(netbox_io_thread_count);
+
+/**
+ * If set, the worker fiber lets other fibers queue their requests before
+ * writing the send buffer (see netbox_transport::flush_is_deferred).
+ */
+static bool netbox_coalesce_writes = true;
+TWEAK_BOOL(netbox_coalesce_writes);
+
+/** Started net.box I/O threads. */
+static struct netbox_io_thread **netbox_io_threads;
+/** Number of started net.box I/O threads. */
+static uint64_t netbox_io_threads_started;
+/** Counter used for choosing a thread for a new connection. */
+static uint64_t netbox_io_thread_rr;
+/** Tx endpoint receiving messages from net.box I/O threads. */
+static struct cbus_endpoint netbox_io_tx_endpoint;
+
+static void
+netbox_io_tx_endpoint_cb(struct ev_loop *loop, ev_watcher *watcher,
+			 int events)
+{
+	(void)loop;
+	(void)events;
+	struct cbus_endpoint *endpoint = watcher->data;
+	cbus_process(endpoint);
+}
+
+/** Net.box I/O thread main function. */
+static int
+netbox_io_thread_f(va_list ap)
+{
+	struct netbox_io_thread *thread = va_arg(ap, struct netbox_io_thread *);
+	int rc = cbus_endpoint_create(&thread->endpoint, cord_name(cord()),
+				      fiber_schedule_cb, fiber());
+	assert(rc == 0);
+	(void)rc;
+	cpipe_create(&thread->tx_pipe, "net.box");
+	cbus_loop(&thread->endpoint);
+	cbus_endpoint_destroy(&thread->endpoint, cbus_process);
+	cpipe_destroy(&thread->tx_pipe);
+	return 0;
+}
+
+/**
+ * Returns a thread for a new connection, starting it if needed.
+ * On error returns NULL and sets diag.
+ */
+static struct netbox_io_thread *
+netbox_io_thread_next(void)
+{
+	uint64_t count = MAX(netbox_io_thread_count, 1);
+	uint64_t i = netbox_io_thread_rr++ % count;
+	if (i < netbox_io_threads_started)
+		return netbox_io_threads[i];
+	if (netbox_io_threads_started == 0) {
+		cbus_endpoint_create(&netbox_io_tx_endpoint, "net.box",
+				     netbox_io_tx_endpoint_cb,
+				     &netbox_io_tx_endpoint);
+	}
+	struct netbox_io_thread *thread = xmalloc(sizeof(*thread));
+	const char *name = tt_sprintf("net.box.io_%llu",
+				      (unsigned long long)
+				      netbox_io_threads_started + 1);
+	if (cord_costart(&thread->cord, name, netbox_io_thread_f,
+			 thread) != 0) {
+		free(thread);
+		return NULL;
+	}
+	cpipe_create(&thread->thread_pipe, name);
+	netbox_io_threads = xrealloc(netbox_io_threads,
+				     (netbox_io_threads_started + 1) *
+				     sizeof(*netbox_io_threads));
+	netbox_io_threads[netbox_io_threads_started++] = thread;
+	return thread;
+}
+
+static void
+netbox_io_batch_deliver_f(struct cmsg *m);
+
+static void
+netbox_io_batch_release_f(struct cmsg *m);
+
+static void
+netbox_io_reader_start_f(struct cmsg *m);
+
+static void
+netbox_io_reader_stop_f(struct cmsg *m);
+
+static void
+netbox_io_reader_stopped_f(struct cmsg *m);
+
+/** Route of a batch filled by the thread. */
+static const struct cmsg_hop netbox_io_batch_deliver_route[] = {
+	{netbox_io_batch_deliver_f, NULL},
+};
+
+/** Route of a batch returned by tx to the thread. */
+static const struct cmsg_hop netbox_io_batch_release_route[] = {
+	{netbox_io_batch_release_f, NULL},
+};
+
+static const struct cmsg_hop netbox_io_reader_start_route[] = {
+	{netbox_io_reader_start_f, NULL},
+};
+
+static const struct cmsg_hop netbox_io_reader_stop_route[] = {
+	{netbox_io_reader_stop_f, NULL},
+};
+
+static const struct cmsg_hop netbox_io_reader_stopped_route[] = {
+	{netbox_io_reader_stopped_f, NULL},
+};
+
+static void
+netbox_io_reader_create(struct netbox_io_reader *reader,
+			struct netbox_transport *transport)
+{
+	memset(reader, 0, sizeof(*reader));
+	reader->transport = transport;
+	reader->fd = -1;
+	fiber_cond_create(&reader->on_stop);
+	fiber_cond_create(&reader->on_batch_free);
+	stailq_create(&reader->ready);
+	for (int i = 0; i < (int)lengthof(reader->batches); i++) {
+		struct netbox_io_batch *batch = &reader->batches[i];
+		batch->reader = reader;
+		diag_create(&batch->diag);
+	}
+}
+
+static void
+netbox_io_reader_destroy(struct netbox_io_reader *reader)
+{
+	assert(!reader->is_active);
+	fiber_cond_destroy(&reader->on_stop);
+	fiber_cond_destroy(&reader->on_batch_free);
+	for (int i = 0; i < (int)lengthof(reader->batches); i++) {
+		struct netbox_io_batch *batch = &reader->batches[i];
+		free(batch->data);
+		diag_destroy(&batch->diag);
+	}
+}
+
+/** Passes a filled batch to tx. Called by the thread. */
+static void
+netbox_io_batch_push(struct netbox_io_batch *batch)
+{
+	assert(!batch->is_busy);
+	batch->is_busy = true;
+	cmsg_init(&batch->base, netbox_io_batch_deliver_route);
+	cpipe_push(&batch->reader->thread->tx_pipe, &batch->base);
+}
+
+/** Appends received responses to a batch. Called by the thread. */
+static void
+netbox_io_batch_append(struct netbox_io_batch *batch, const char *data,
+		       size_t size)
+{
+	if (batch->size + size > batch->capacity) {
+		batch->capacity = MAX(batch->capacity * 2, batch->size + size);
+		batch->data = xrealloc(batch->data, batch->capacity);
+	}
+	memcpy(batch->data + batch->size, data, size);
+	batch->size += size;
+}
+
+/**
+ * Waits for a batch that can be filled by the thread. Returns NULL and
+ * sets diag if the reader fiber is cancelled.
+ */
+static struct netbox_io_batch *
+netbox_io_reader_get_batch(struct netbox_io_reader *reader)
+{
+	while (true) {
+		for (int i = 0; i < (int)lengthof(reader->batches); i++) {
+			if (!reader->batches[i].is_busy)
+				return &reader->batches[i];
+		}
+		fiber_cond_wait(&reader->on_batch_free);
+		if (fiber_is_cancelled()) {
+			diag_set(FiberIsCancelled);
+			return NULL;
+		}
+	}
+}
+
+/**
+ * Finds complete responses at the beginning of the buffer. Returns
+ * their total size in @a size and the buffer size required to complete
+ * the next response in @a required. On error returns -1 and sets diag.
+ */
+static int
+netbox_io_frame(struct ibuf *buf, size_t *size, size_t *required)
+{
+	const char *data = buf->rpos;
+	const char *pos = data;
+	const char *end = buf->wpos;
+	size_t fixheader_size = mp_sizeof_uint(UINT32_MAX);
+	while (true) {
+		if ((size_t)(end - pos) < fixheader_size) {
+			*required = pos - data + fixheader_size;
+			break;
+		}
+		const char *rpos = pos;
+		uint64_t len = mp_decode_uint(&rpos);
+		size_t len_size = rpos - pos;
+		if (len > SIZE_MAX - len_size) {
+			box_error_raise(ER_NO_CONNECTION,
+					"Response size too large");
+			return -1;
+		}
+		if ((size_t)(end - pos) < len_size + len) {
+			*required = pos - data + len_size + len;
+			break;
+		}
+		pos = rpos + len;
+	}
+	*size = pos - data;
+	return 0;
+}
+
+/**
+ * Reads data from the connection until the buffer has at least @a limit
+ * bytes. Returns 0 on success. On error returns -1 and sets diag.
+ */
+static int
+netbox_io_read(struct iostream *io, struct ibuf *buf, size_t limit)
+{
+	while (ibuf_used(buf) < limit) {
+		if (ibuf_reserve(buf, NETBOX_READAHEAD) == NULL) {
+			diag_set(OutOfMemory, NETBOX_READAHEAD,
+				 "ibuf_reserve", "p");
+			return -1;
+		}
+		ssize_t rc = iostream_read(io, buf->wpos, ibuf_unused(buf));
+		if (rc == 0) {
+			box_error_raise(ER_NO_CONNECTION, "Peer closed");
+			return -1;
+		} else if (rc > 0) {
+			VERIFY(ibuf_alloc(buf, rc) != NULL);
+		} else if (rc == IOSTREAM_ERROR) {
+			struct error *e = diag_last_error(diag_get());
+			box_error_raise(ER_NO_CONNECTION, "%s", e->errmsg);
+			return -1;
+		} else {
+			coio_wait(io->fd, iostream_status_to_events(rc),
+				  TIMEOUT_INFINITY);
+			if (fiber_is_cancelled()) {
+				diag_set(FiberIsCancelled);
+				return -1;
+			}
+		}
+	}
+	return 0;
+}
+
+/** Tells tx that the thread stopped reading. Called by the thread. */
+static void
+netbox_io_reader_send_stopped(struct netbox_io_reader *reader)
+{
+	cmsg_init(&reader->stop_msg, netbox_io_reader_stopped_route);
+	cpipe_push(&reader->thread->tx_pipe, &reader->stop_msg);
+}
+
+/**
+ * Reader fiber running in the thread. Reads responses and passes them
+ * to tx until an error or until tx asks to stop.
+ */
+static int
+netbox_io_reader_f(va_list ap)
+{
+	struct netbox_io_reader *reader = va_arg(ap, struct netbox_io_reader *);
+	struct iostream io;
+	plain_iostream_create(&io, reader->fd);
+	struct ibuf buf;
+	ibuf_create(&buf, &cord()->slabc, NETBOX_READAHEAD);
+	struct netbox_io_batch *batch;
+	while (true) {
+		size_t size, required;
+		if (netbox_io_frame(&buf, &size, &required) != 0)
+			break;
+		if (size == 0) {
+			if (netbox_io_read(&io, &buf, required) != 0)
+				break;
+			continue;
+		}
+		batch = netbox_io_reader_get_batch(reader);
+		if (batch == NULL)
+			break;
+		netbox_io_batch_append(batch, buf.rpos, size);
+		ibuf_consume(&buf, size);
+		netbox_io_batch_push(batch);
+	}
+	/* Pass the error to tx unless it asked to stop. */
+	if (!reader->is_stopping) {
+		struct error *e = diag_last_error(diag_get());
+		error_ref(e);
+		batch = netbox_io_reader_get_batch(reader);
+		if (batch != NULL) {
+			diag_set_error(&batch->diag, e);
+			batch->is_eof = true;
+			netbox_io_batch_push(batch);
+		}
+		error_unref(e);
+	}
+	ibuf_destroy(&buf);
+	iostream_close(&io);
+	reader->fd = -1;
+	reader->fiber = NULL;
+	if (reader->is_stopping)
+		netbox_io_reader_send_stopped(reader);
+	return 0;
+}
+
+/** Starts the reader fiber. Called by the thread. */
+static void
+netbox_io_reader_start_f(struct cmsg *m)
+{
+	struct netbox_io_reader *reader =
+		container_of(m, struct netbox_io_reader, start_msg);
+	reader->is_stopping = false;
+	reader->fiber = fiber_new("net.box.io", netbox_io_reader_f);
+	if (reader->fiber == NULL) {
+		close(reader->fd);
+		reader->fd = -1;
+		struct netbox_io_batch *batch = &reader->batches[0];
+		diag_move(diag_get(), &batch->diag);
+		batch->is_eof = true;
+		netbox_io_batch_push(batch);
+		return;
+	}
+	fiber_start(reader->fiber, reader);
+}
+
+/** Stops the reader fiber. Called by the thread. */
+static void
+netbox_io_reader_stop_f(struct cmsg *m)
+{
+	struct netbox_io_reader *reader =
+		container_of(m, struct netbox_io_reader, stop_msg);
+	reader->is_stopping = true;
+	if (reader->fiber != NULL)
+		fiber_cancel(reader->fiber);
+	else
+		netbox_io_reader_send_stopped(reader);
+}
+
+/** Makes a batch available for filling. Called by the thread. */
+static void
+netbox_io_batch_release_f(struct cmsg *m)
+{
+	struct netbox_io_batch *batch = (struct netbox_io_batch *)m;
+	batch->is_busy = false;
+	batch->size = 0;
+	fiber_cond_signal(&batch->reader->on_batch_free);
+}
+
+/** Queues a batch for processing by the worker fiber. Called by tx. */
+static void
+netbox_io_batch_deliver_f(struct cmsg *m)
+{
+	struct netbox_io_batch *batch = (struct netbox_io_batch *)m;
+	struct netbox_io_reader *reader = batch->reader;
+	batch->rpos = 0;
+	stailq_add_tail_entry(&reader->ready, batch, in_ready);
+	if (reader->transport->worker != NULL)
+		fiber_wakeup(reader->transport->worker);
+}
+
+/** Called by tx when the thread stops reading. */
+static void
+netbox_io_reader_stopped_f(struct cmsg *m)
+{
+	struct netbox_io_reader *reader =
+		container_of(m, struct netbox_io_reader, stop_msg);
+	reader->is_active = false;
+	fiber_cond_signal(&reader->on_stop);
+}
+
+/**
+ * Makes a net.box I/O thread read responses from the given connection
+ * fd. Returns 0 on success. On error returns -1 and sets diag.
+ */
+static int
+netbox_io_reader_start(struct netbox_io_reader *reader, int fd)
+{
+	assert(!reader->is_active);
+	if (reader->thread == NULL) {
+		reader->thread = netbox_io_thread_next();
+		if (reader->thread == NULL)
+			return -1;
+	}
+	reader->fd = dup(fd);
+	if (reader->fd < 0) {
+		diag_set(SystemError, "failed to duplicate fd %d", fd);
+		return -1;
+	}
+	stailq_create(&reader->ready);
+	for (int i = 0; i < (int)lengthof(reader->batches); i++) {
+		struct netbox_io_batch *batch = &reader->batches[i];
+		batch->size = 0;
+		batch->rpos = 0;
+		batch->is_busy = false;
+		batch->is_eof = false;
+		diag_clear(&batch->diag);
+	}
+	reader->is_active = true;
+	cmsg_init(&reader->start_msg, netbox_io_reader_start_route);
+	cpipe_push(&reader->thread->thread_pipe, &reader->start_msg);
+	return 0;
+}
+
+/**
+ * Makes the thread stop reading the connection and waits for it.
+ * Batches that have not been processed yet are dropped.
+ */
+static void
+netbox_io_reader_stop(struct netbox_io_reader *reader)
+{
+	if (!reader->is_active)
+		return;
+	cmsg_init(&reader->stop_msg, netbox_io_reader_stop_route);
+	cpipe_push(&reader->thread->thread_pipe, &reader->stop_msg);
+	/* The thread always replies, so wait even if cancelled. */
+	while (reader->is_active)
+		fiber_cond_wait(&reader->on_stop);
+	stailq_create(&reader->ready);
+}
+
+/**
+ * Returns a processed batch to the thread so that it can be filled
+ * again. Called by tx.
+ */
+static void
+netbox_io_batch_release(struct netbox_io_batch *batch)
+{
+	cmsg_init(&batch->base, netbox_io_batch_release_route);
+	cpipe_push(&batch->reader->thread->thread_pipe, &batch->base);
+}
+
 static void
 netbox_options_create(struct netbox_options *opts)
 {
@@ -544,6 +1116,8 @@ netbox_transport_create(struct netbox_transport *transport)
 	ibuf_create(&transport->send_buf, &cord()->slabc, NETBOX_READAHEAD);
 	ibuf_create(&transport->recv_buf, &cord()->slabc, NETBOX_READAHEAD);
 	transport->last_msg_size = 0;
+	netbox_io_reader_create(&transport->io_reader, transport);
+	transport->flush_is_deferred = false;
 	fiber_cond_create(&transport->on_send_buf_empty);
 	transport->next_sync = 1;
 	transport->requests = mh_i64ptr_new();
@@ -563,6 +1137,7 @@ netbox_transport_destroy(struct netbox_transport *transport)
 	assert(!iostream_is_initialized(&transport->io));
 	assert(ibuf_used(&transport->send_buf) == 0);
 	assert(ibuf_used(&transport->recv_buf) == 0);
+	netbox_io_reader_destroy(&transport->io_reader);
 	fiber_cond_destroy(&transport->on_send_buf_empty);
 	struct mh_i64ptr_t *h = transport->requests;
 	assert(mh_size(h) == 0);
@@ -694,13 +1269,15 @@ netbox_encode_ping(lua_State *L, int idx, struct netbox_method_encode_ctx *ctx)
  */
 static void
 netbox_encode_id(struct lua_State *L, struct ibuf *ibuf, uint64_t sync,
-		 bool fetch_schema)
+		 bool fetch_schema, bool compression)
 {
 	struct iproto_features features = NETBOX_IPROTO_FEATURES;
 	if (fetch_schema) {
 		iproto_features_clear(&features,
 				      IPROTO_FEATURE_DML_TUPLE_EXTENSION);
 	}
+	if (compression)
+		iproto_features_set(&features, IPROTO_FEATURE_COMPRESSION);
 #ifndef NDEBUG
 	struct errinj *errinj = errinj(ERRINJ_NETBOX_FLIP_FEATURE, ERRINJ_INT);
 	if (errinj->iparam >= 0 && errinj->iparam < iproto_feature_id_MAX) {
@@ -896,13 +1473,42 @@ netbox_encode_index_id_or_name(lua_State *L, int idx, struct mpstream *stream)
 }
 
 /* Encode select request. */
+/**
+ * Encode a vclock given as a Lua table indexed by replica id as a MsgPack
+ * map. Raises a Lua error if the table isn't a valid vclock.
+ */
+static int
+netbox_encode_vclock(lua_State *L, int idx, struct mpstream *stream)
+{
+	uint32_t size = 0;
+	lua_pushnil(L);
+	while (lua_next(L, idx) != 0) {
+		if (lua_type(L, -2) != LUA_TNUMBER ||
+		    lua_type(L, -1) != LUA_TNUMBER) {
+			diag_set(IllegalParams, "wait_vclock must be a table of "
+				 "numbers indexed by replica id");
+			return -1;
+		}
+		size++;
+		lua_pop(L, 1);
+	}
+	mpstream_encode_map(stream, size);
+	lua_pushnil(L);
+	while (lua_next(L, idx) != 0) {
+		mpstream_encode_uint(stream, lua_tointeger(L, -2));
+		mpstream_encode_uint(stream, luaL_touint64(L, -1));
+		lua_pop(L, 1);
+	}
+	return 0;
+}
+
 static int
 netbox_encode_select(lua_State *L, int idx,
 		     struct netbox_method_encode_ctx *ctx)
 {
 	/*
 	 * Lua stack at idx: space_id, index_id, iterator, offset, limit, key,
-	 * after, fetch_pos.
+	 * after, fetch_pos, wait_vclock, timeout, fields, filter.
 	 */
 	size_t svp = netbox_begin_encode(ctx->stream, ctx->sync, IPROTO_SELECT,
 					 ctx->stream_id);
@@ -914,6 +1520,18 @@ netbox_encode_select(lua_State *L, int idx,
 	bool fetch_pos = lua_toboolean(L, idx + 7);
 	if (fetch_pos)
 		map_size++;
+	bool have_wait_vclock = !lua_isnoneornil(L, idx + 8);
+	bool have_timeout = have_wait_vclock && !lua_isnoneornil(L, idx + 9);
+	if (have_wait_vclock)
+		map_size++;
+	if (have_timeout)
+		map_size++;
+	bool have_fields = !lua_isnoneornil(L, idx + 10);
+	if (have_fields)
+		map_size++;
+	bool have_filter = !lua_isnoneornil(L, idx + 11);
+	if (have_filter)
+		map_size++;
 	mpstream_encode_map(ctx->stream, map_size);
 	int iterator = lua_tointeger(L, idx + 2);
 	uint32_t offset = lua_tonumber(L, idx + 3);
@@ -963,6 +1581,79 @@ netbox_encode_select(lua_State *L, int idx,
 		mpstream_encode_bool(ctx->stream, fetch_pos);
 	}
 
+	/* encode wait_vclock */
+	if (have_wait_vclock) {
+		mpstream_encode_uint(ctx->stream, IPROTO_WAIT_VCLOCK);
+		if (netbox_encode_vclock(L, idx + 8, ctx->stream) != 0)
+			return -1;
+	}
+	if (have_timeout) {
+		mpstream_encode_uint(ctx->stream, IPROTO_TIMEOUT);
+		mpstream_encode_double(ctx->stream, lua_tonumber(L, idx + 9));
+	}
+
+	/* encode fields */
+	if (have_fields) {
+		mpstream_encode_uint(ctx->stream, IPROTO_FIELDS);
+		if (luamp_encode_tuple(L, cfg, ctx->stream, idx + 10) != 0)
+			return -1;
+	}
+
+	/* encode filter */
+	if (have_filter) {
+		mpstream_encode_uint(ctx->stream, IPROTO_FILTER);
+		if (luamp_encode_tuple(L, cfg, ctx->stream, idx + 11) != 0)
+			return -1;
+	}
+
+	netbox_end_encode(ctx->stream, svp);
+	return 0;
+}
+
+/* Encode select request with multiple keys. */
+static int
+netbox_encode_select_many(lua_State *L, int idx,
+			  struct netbox_method_encode_ctx *ctx)
+{
+	/*
+	 * Lua stack at idx: space_id, index_id, iterator, offset, limit, keys.
+	 */
+	size_t svp = netbox_begin_encode(ctx->stream, ctx->sync,
+					 IPROTO_SELECT_MANY, ctx->stream_id);
+	mpstream_encode_map(ctx->stream, 6);
+	int iterator = lua_tointeger(L, idx + 2);
+	uint32_t offset = lua_tonumber(L, idx + 3);
+	uint32_t limit = lua_tonumber(L, idx + 4);
+
+	netbox_encode_space_id_or_name(L, idx, ctx->stream);
+
+	netbox_encode_index_id_or_name(L, idx + 1, ctx->stream);
+
+	/* encode iterator */
+	mpstream_encode_uint(ctx->stream, IPROTO_ITERATOR);
+	mpstream_encode_uint(ctx->stream, iterator);
+
+	/* encode offset */
+	mpstream_encode_uint(ctx->stream, IPROTO_OFFSET);
+	mpstream_encode_uint(ctx->stream, offset);
+
+	/* encode limit */
+	mpstream_encode_uint(ctx->stream, IPROTO_LIMIT);
+	mpstream_encode_uint(ctx->stream, limit);
+
+	/* encode keys */
+	mpstream_encode_uint(ctx->stream, IPROTO_KEY);
+	assert(lua_istable(L, idx + 5));
+	uint32_t key_count = lua_objlen(L, idx + 5);
+	mpstream_encode_array(ctx->stream, key_count);
+	for (uint32_t i = 1; i <= key_count; i++) {
+		lua_rawgeti(L, idx + 5, i);
+		int rc = luamp_convert_key(L, cfg, ctx->stream, lua_gettop(L));
+		lua_pop(L, 1);
+		if (rc != 0)
+			return -1;
+	}
+
 	netbox_end_encode(ctx->stream, svp);
 	return 0;
 }
@@ -1004,6 +1695,29 @@ netbox_encode_replace(lua_State *L, int idx,
 					       IPROTO_REPLACE, ctx->stream_id);
 }
 
+/* Encode insert request with record batches in the Arrow IPC format. */
+static int
+netbox_encode_insert_arrow(lua_State *L, int idx,
+			   struct netbox_method_encode_ctx *ctx)
+{
+	/* Lua stack at idx: space_id, data */
+	size_t svp = netbox_begin_encode(ctx->stream, ctx->sync,
+					 IPROTO_INSERT_ARROW, ctx->stream_id);
+	mpstream_encode_map(ctx->stream, 2);
+
+	netbox_encode_space_id_or_name(L, idx, ctx->stream);
+
+	/* encode record batches */
+	size_t len;
+	const char *data = lua_tolstring(L, idx + 1, &len);
+	mpstream_encode_uint(ctx->stream, IPROTO_ARROW);
+	mpstream_encode_binl(ctx->stream, len);
+	mpstream_memcpy(ctx->stream, data, len);
+
+	netbox_end_encode(ctx->stream, svp);
+	return 0;
+}
+
 static int
 netbox_encode_delete(lua_State *L, int idx,
 		     struct netbox_method_encode_ctx *ctx)
@@ -1140,6 +1854,15 @@ netbox_transport_connect(struct netbox_transport *transport)
 				transport->greeting.protocol);
 		goto error;
 	}
+	/*
+	 * Encrypted streams can't be shared with another thread. Neither
+	 * can compressed ones, and whether the stream is going to be
+	 * compressed isn't known until the IPROTO_ID response.
+	 */
+	if (transport->opts.io_thread && transport->io_ctx.ssl == NULL &&
+	    !transport->opts.compression &&
+	    netbox_io_reader_start(&transport->io_reader, io->fd) != 0)
+		goto error;
 	return 0;
 io_error:
 	assert(!diag_is_empty(diag_get()));
@@ -1190,30 +1913,44 @@ netbox_transport_communicate(struct netbox_transport *transport, size_t limit)
 		}
 		/* reader serviced first */
 		int events = 0;
-		while (ibuf_used(recv_buf) < limit) {
-			void *p = ibuf_reserve(recv_buf, NETBOX_READAHEAD);
-			if (p == NULL) {
-				diag_set(OutOfMemory, NETBOX_READAHEAD,
-					 "ibuf_reserve", "p");
-				return -1;
-			}
-			ssize_t rc = iostream_read(io, recv_buf->wpos,
-						   ibuf_unused(recv_buf));
-			if (rc == 0) {
-				box_error_raise(ER_NO_CONNECTION,
-						"Peer closed");
-				return -1;
-			} if (rc > 0) {
-				VERIFY(ibuf_alloc(recv_buf, rc) != NULL);
-			} else if (rc == IOSTREAM_ERROR) {
-				goto io_error;
-			} else {
-				events |= iostream_status_to_events(rc);
-				break;
+		if (transport->io_reader.is_active) {
+			/* Responses are read by the I/O thread. */
+			if (!stailq_empty(&transport->io_reader.ready))
+				return 0;
+		} else {
+			while (ibuf_used(recv_buf) < limit) {
+				void *p = ibuf_reserve(recv_buf,
+						       NETBOX_READAHEAD);
+				if (p == NULL) {
+					diag_set(OutOfMemory, NETBOX_READAHEAD,
+						 "ibuf_reserve", "p");
+					return -1;
+				}
+				ssize_t rc = iostream_read(
+					io, recv_buf->wpos,
+					ibuf_unused(recv_buf));
+				if (rc == 0) {
+					box_error_raise(ER_NO_CONNECTION,
+							"Peer closed");
+					return -1;
+				} if (rc > 0) {
+					VERIFY(ibuf_alloc(recv_buf,
+							  rc) != NULL);
+				} else if (rc == IOSTREAM_ERROR) {
+					goto io_error;
+				} else {
+					events |=
+						iostream_status_to_events(rc);
+					break;
+				}
 			}
+			if (ibuf_used(recv_buf) >= limit)
+				return 0;
+		}
+		if (transport->flush_is_deferred) {
+			transport->flush_is_deferred = false;
+			fiber_reschedule();
 		}
-		if (ibuf_used(recv_buf) >= limit)
-			return 0;
 		while (ibuf_used(send_buf) > 0) {
 			ssize_t rc = iostream_write(io, send_buf->rpos,
 						    ibuf_used(send_buf));
@@ -1228,7 +1965,15 @@ netbox_transport_communicate(struct netbox_transport *transport, size_t limit)
 				break;
 			}
 		}
-		coio_wait(io->fd, events, TIMEOUT_INFINITY);
+		/*
+		 * With the I/O thread, there may be nothing to wait for on
+		 * the fd. The worker is woken up when a new request is sent
+		 * or a batch of responses is received then.
+		 */
+		if (events != 0)
+			coio_wait(io->fd, events, TIMEOUT_INFINITY);
+		else
+			fiber_yield();
 		ERROR_INJECT_YIELD(ERRINJ_NETBOX_IO_DELAY);
 		ERROR_INJECT(ERRINJ_NETBOX_IO_ERROR, {
 			box_error_raise(ER_NO_CONNECTION, "Error injection");
@@ -1246,6 +1991,44 @@ netbox_transport_communicate(struct netbox_transport *transport, size_t limit)
 	return -1;
 }
 
+/**
+ * Sends requests and takes the next response read by the I/O thread.
+ * Returns 0 and a decoded response header on success. On error
+ * returns -1.
+ *
+ * The response data stays valid until the next call.
+ */
+static int
+netbox_transport_send_and_recv_io_thread(struct netbox_transport *transport,
+					 struct xrow_header *hdr)
+{
+	struct netbox_io_reader *reader = &transport->io_reader;
+	while (true) {
+		if (stailq_empty(&reader->ready)) {
+			if (netbox_transport_communicate(transport, 0) != 0)
+				return -1;
+			continue;
+		}
+		struct netbox_io_batch *batch = stailq_first_entry(
+			&reader->ready, struct netbox_io_batch, in_ready);
+		if (batch->rpos < batch->size) {
+			const char *bufpos = batch->data + batch->rpos;
+			const char *rpos = bufpos;
+			uint64_t len = mp_decode_uint(&rpos);
+			const char *body_end = rpos + len;
+			batch->rpos = body_end - batch->data;
+			return xrow_header_decode(hdr, &rpos, body_end,
+						  /*end_is_exact=*/true);
+		}
+		if (batch->is_eof) {
+			diag_move(&batch->diag, diag_get());
+			return -1;
+		}
+		stailq_shift(&reader->ready);
+		netbox_io_batch_release(batch);
+	}
+}
+
 /**
  * Sends and receives data over an iproto connection.
  * Returns 0 and a decoded response header on success.
@@ -1255,6 +2038,8 @@ static int
 netbox_transport_send_and_recv(struct netbox_transport *transport,
 			       struct xrow_header *hdr)
 {
+	if (transport->io_reader.is_active)
+		return netbox_transport_send_and_recv_io_thread(transport, hdr);
 	ibuf_consume(&transport->recv_buf, transport->last_msg_size);
 	while (true) {
 		size_t required;
@@ -1495,6 +2280,9 @@ netbox_encode_method(struct lua_State *L, int idx, enum netbox_method method,
 		[NETBOX_UPSERT]		= netbox_encode_upsert,
 		[NETBOX_SELECT]		= netbox_encode_select,
 		[NETBOX_SELECT_WITH_POS] = netbox_encode_select,
+		[NETBOX_SELECT_MANY]	= netbox_encode_select_many,
+		[NETBOX_GET_MANY]	= netbox_encode_select_many,
+		[NETBOX_INSERT_ARROW]	= netbox_encode_insert_arrow,
 		[NETBOX_EXECUTE]	= netbox_encode_execute,
 		[NETBOX_PREPARE]	= netbox_encode_prepare,
 		[NETBOX_UNPREPARE]	= netbox_encode_unprepare,
@@ -1748,6 +2536,94 @@ netbox_decode_select_with_pos(struct lua_State *L, const char **data,
 	}
 }
 
+/**
+ * Decodes IPROTO_DATA of an IPROTO_SELECT_MANY response, which is an array of
+ * tuple arrays, one per key, and pushes it to Lua stack. If first_only is set,
+ * each tuple array is replaced with its first tuple or box.NULL if it's empty.
+ */
+static void
+netbox_decode_data_many(struct lua_State *L, const char **data,
+			struct tuple_format *format, struct mp_box_ctx *ctx,
+			bool first_only)
+{
+	uint32_t count = mp_decode_array(data);
+	lua_createtable(L, count, 0);
+	for (uint32_t i = 0; i < count; ++i) {
+		if (!first_only) {
+			netbox_decode_data(L, data, format, ctx);
+			lua_rawseti(L, -2, i + 1);
+			continue;
+		}
+		uint32_t tuple_count = mp_decode_array(data);
+		if (tuple_count == 0) {
+			luaL_pushnull(L);
+			lua_rawseti(L, -2, i + 1);
+			continue;
+		}
+		const char *begin = *data;
+		mp_next(data);
+		struct tuple *tuple;
+		if (tuple_format_map_is_empty(&ctx->tuple_format_map))
+			tuple = box_tuple_new(format, begin, *data);
+		else
+			tuple = mp_decode_tuple(&begin, &ctx->tuple_format_map);
+		if (tuple == NULL) {
+			mp_ctx_destroy((struct mp_ctx *)ctx);
+			luaT_error(L);
+		}
+		luaT_pushtuple(L, tuple);
+		lua_rawseti(L, -2, i + 1);
+		for (uint32_t j = 1; j < tuple_count; ++j)
+			mp_next(data);
+	}
+}
+
+static void
+netbox_decode_many(struct lua_State *L, const char **data,
+		   const char *data_end, bool return_raw,
+		   struct tuple_format *format, bool first_only)
+{
+	struct response_body response_body;
+	response_body_decode(&response_body, data, data_end);
+	struct mp_box_ctx ctx;
+	mp_box_ctx_create(&ctx, NULL, response_body.tuple_formats);
+	if (return_raw) {
+		luamp_push_with_ctx(L, response_body.data,
+				    response_body.data_end,
+				    (struct mp_ctx *)&ctx);
+	} else {
+		netbox_decode_data_many(L, &response_body.data, format, &ctx,
+					first_only);
+	}
+	mp_ctx_destroy((struct mp_ctx *)&ctx);
+}
+
+/**
+ * Decodes Tarantool response body consisting of single IPROTO_DATA key into
+ * an array of tuple arrays, one per requested key, and pushes it to Lua stack.
+ */
+static void
+netbox_decode_select_many(struct lua_State *L, const char **data,
+			  const char *data_end, bool return_raw,
+			  struct tuple_format *format)
+{
+	netbox_decode_many(L, data, data_end, return_raw, format,
+			   /*first_only=*/false);
+}
+
+/**
+ * Same as netbox_decode_select_many, but decodes only the first tuple found
+ * for each key. Keys that have no match are represented by box.NULL.
+ */
+static void
+netbox_decode_get_many(struct lua_State *L, const char **data,
+		       const char *data_end, bool return_raw,
+		       struct tuple_format *format)
+{
+	netbox_decode_many(L, data, data_end, return_raw, format,
+			   /*first_only=*/true);
+}
+
 /**
  * Same as netbox_decode_select, but only decodes the first tuple of the array,
  * skipping the rest.
@@ -2040,6 +2916,9 @@ netbox_decode_method(struct lua_State *L, enum netbox_method method,
 		[NETBOX_UPSERT]		= netbox_decode_nil,
 		[NETBOX_SELECT]		= netbox_decode_select,
 		[NETBOX_SELECT_WITH_POS] = netbox_decode_select_with_pos,
+		[NETBOX_SELECT_MANY]	= netbox_decode_select_many,
+		[NETBOX_GET_MANY]	= netbox_decode_get_many,
+		[NETBOX_INSERT_ARROW]	= netbox_decode_count,
 		[NETBOX_EXECUTE]	= netbox_decode_execute,
 		[NETBOX_PREPARE]	= netbox_decode_prepare,
 		[NETBOX_UNPREPARE]	= netbox_decode_nil,
@@ -2230,6 +3109,84 @@ luaT_netbox_request_wait_result(struct lua_State *L)
 	return netbox_request_push_result(request, L);
 }
 
+/**
+ * Waits until all the given requests complete. Unlike waiting for each
+ * request in turn, the fiber is woken up only once, when the last one
+ * completes. Takes an array of requests and an optional timeout.
+ * Returns true on success, nil and an error on timeout.
+ */
+static int
+luaT_netbox_wait_all(struct lua_State *L)
+{
+	double timeout = TIMEOUT_INFINITY;
+	if (lua_type(L, 1) != LUA_TTABLE ||
+	    (!lua_isnoneornil(L, 2) &&
+	     (lua_type(L, 2) != LUA_TNUMBER ||
+	      (timeout = lua_tonumber(L, 2)) < 0)))
+		luaL_error(L, "Usage: net.box.wait_all(futures[, timeout])");
+	int count = lua_objlen(L, 1);
+	for (int i = 1; i <= count; i++) {
+		lua_rawgeti(L, 1, i);
+		struct netbox_request *request =
+			luaT_check_netbox_request(L, -1);
+		if (request->transport != NULL &&
+		    request->transport->worker == fiber()) {
+			luaL_error(L, "Synchronous requests are not allowed in "
+				   "net.box trigger");
+		}
+		lua_pop(L, 1);
+	}
+	struct netbox_request_group group = {
+		.pending = 0,
+		.fiber = fiber(),
+	};
+	/* Requests already waited in another group are waited in turn. */
+	bool has_busy = false;
+	for (int i = 1; i <= count; i++) {
+		lua_rawgeti(L, 1, i);
+		struct netbox_request *request = lua_touserdata(L, -1);
+		lua_pop(L, 1);
+		if (netbox_request_is_ready(request))
+			continue;
+		if (request->group != NULL) {
+			has_busy = true;
+			continue;
+		}
+		request->group = &group;
+		group.pending++;
+	}
+	while (group.pending > 0 && timeout > 0 && !fiber_is_cancelled()) {
+		double ts = ev_monotonic_now(loop());
+		fiber_yield_timeout(timeout);
+		timeout -= ev_monotonic_now(loop()) - ts;
+	}
+	if (group.pending > 0) {
+		for (int i = 1; i <= count; i++) {
+			lua_rawgeti(L, 1, i);
+			struct netbox_request *request = lua_touserdata(L, -1);
+			lua_pop(L, 1);
+			if (request->group == &group)
+				request->group = NULL;
+		}
+		goto timed_out;
+	}
+	for (int i = 1; has_busy && i <= count; i++) {
+		lua_rawgeti(L, 1, i);
+		struct netbox_request *request = lua_touserdata(L, -1);
+		lua_pop(L, 1);
+		while (!netbox_request_is_ready(request)) {
+			if (!netbox_request_wait(request, &timeout))
+				goto timed_out;
+		}
+	}
+	lua_pushboolean(L, true);
+	return 1;
+timed_out:
+	luaL_testcancel(L);
+	diag_set(TimedOut);
+	return luaT_push_nil_and_error(L);
+}
+
 /**
  * Makes the connection forget about the given request. When the response is
  * received, it will be ignored. It reduces the size of the requests hash table
@@ -2371,12 +3328,13 @@ luaT_netbox_request_pairs(struct lua_State *L)
  * Takes the following arguments: uri (string or table) or fd (number),
  * user (string or nil), password (string or nil), callback (function),
  * connect_timeout (number or nil), reconnect_after (number or nil),
- * fetch_schema (boolean or nil), auth_type (string or nil).
+ * fetch_schema (boolean or nil), auth_type (string or nil),
+ * io_thread (boolean or nil), compression (string or nil).
  */
 static int
 luaT_netbox_new_transport(struct lua_State *L)
 {
-	assert(lua_gettop(L) == 8);
+	assert(lua_gettop(L) == 10);
 	/* Create a transport object. */
 	struct netbox_transport *transport;
 	transport = lua_newuserdata(L, sizeof(*transport));
@@ -2422,6 +3380,17 @@ luaT_netbox_new_transport(struct lua_State *L)
 			return luaT_error(L);
 		}
 	}
+	if (!lua_isnil(L, 9))
+		opts->io_thread = lua_toboolean(L, 9);
+	if (!lua_isnil(L, 10)) {
+		const char *s = luaL_checkstring(L, 10);
+		if (strcmp(s, "zstd") == 0) {
+			opts->compression = true;
+		} else if (strcmp(s, "none") != 0) {
+			diag_set(IllegalParams, "Unknown compression: %s", s);
+			return luaT_error(L);
+		}
+	}
 	if (opts->user == NULL && opts->password != NULL) {
 		diag_set(ClientError, ER_PROC_LUA,
 			 "net.box: user is not defined");
@@ -2487,8 +3456,10 @@ luaT_netbox_transport_make_request(struct lua_State *L, int idx,
 		return -1;
 	}
 	/* Alert worker to notify it of the queued outgoing data. */
-	if (svp == 0)
+	if (svp == 0) {
+		transport->flush_is_deferred = netbox_coalesce_writes;
 		fiber_wakeup(transport->worker);
+	}
 	transport->inprogress_request_count++;
 
 	/* Initialize and register the request object. */
@@ -2513,6 +3484,7 @@ luaT_netbox_transport_make_request(struct lua_State *L, int idx,
 	request->index_ref = LUA_NOREF;
 	request->result_ref = LUA_NOREF;
 	request->error = NULL;
+	request->group = NULL;
 	netbox_request_register(request, transport);
 	return 0;
 }
@@ -2798,6 +3770,30 @@ netbox_transport_dispatch_response(struct netbox_transport *transport,
 	}
 }
 
+/**
+ * Switches the connection stream to compression after receiving the
+ * IPROTO_ID response that confirmed it. The data following the response
+ * in the receive buffer is already compressed so it's passed to the new
+ * stream. Returns 0 on success, -1 on error.
+ */
+static int
+netbox_transport_start_compression(struct netbox_transport *transport)
+{
+	assert(!transport->io_reader.is_active);
+	struct ibuf *recv_buf = &transport->recv_buf;
+	ibuf_consume(recv_buf, transport->last_msg_size);
+	transport->last_msg_size = 0;
+	struct iostream plain_io;
+	iostream_move(&plain_io, &transport->io);
+	if (zstd_iostream_create(&transport->io, &plain_io, recv_buf->rpos,
+				 ibuf_used(recv_buf)) != 0) {
+		iostream_move(&transport->io, &plain_io);
+		return -1;
+	}
+	ibuf_reset(recv_buf);
+	return 0;
+}
+
 /**
  * Performs a features request for an iproto connection.
  * If the server doesn't support the IPROTO_ID command, assumes the protocol
@@ -2818,7 +3814,8 @@ netbox_transport_do_id(struct netbox_transport *transport, struct lua_State *L)
 	if (peer_version_id < version_id(2, 10, 0))
 		goto unsupported;
 	netbox_encode_id(L, &transport->send_buf, transport->next_sync++,
-			 transport->opts.fetch_schema);
+			 transport->opts.fetch_schema,
+			 transport->opts.compression);
 	struct xrow_header hdr;
 	if (netbox_transport_send_and_recv(transport, &hdr) != 0)
 		luaT_error(L);
@@ -2831,6 +3828,10 @@ netbox_transport_do_id(struct netbox_transport *transport, struct lua_State *L)
 	}
 	if (xrow_decode_id(&hdr, &id) != 0)
 		luaT_error(L);
+	if (transport->opts.compression &&
+	    iproto_features_test(&id.features, IPROTO_FEATURE_COMPRESSION) &&
+	    netbox_transport_start_compression(transport) != 0)
+		luaT_error(L);
 out:
 	transport->features = id.features;
 	if (id.auth_type != NULL) {
@@ -3095,6 +4096,7 @@ netbox_worker_f(va_list ap)
 			/* The worker loop can only be broken by an error. */
 			assert(rc != 0);
 			(void)rc;
+			netbox_io_reader_stop(&transport->io_reader);
 			iostream_close(&transport->io);
 		}
 		if (transport->state == NETBOX_CLOSED)
@@ -3293,6 +4295,7 @@ luaopen_net_box(struct lua_State *L)
 
 	static const luaL_Reg net_box_lib[] = {
 		{ "new_transport",  luaT_netbox_new_transport },
+		{ "wait_all",       luaT_netbox_wait_all },
 		{ NULL, NULL}
 	};
 	luaT_newmodule(L, "net.box.lib", net_box_lib);
@@ -2,6 +2,7 @@
 local log      = require('log')
 local ffi      = require('ffi')
 local fiber    = require('fiber')
+local fun      = require('fun')
 local msgpack  = require('msgpack')
 local urilib   = require('uri')
 local internal = require('net.box.lib')
@@ -40,6 +41,9 @@ local REQUEST_OPTION_TYPES = {
     skip_header = "boolean",
     timeout     = "number",
     fetch_pos   = "boolean",
+    wait_vclock = "table",
+    fields      = "table",
+    filter      = "table",
     after = function(after)
         if after ~= nil and type(after) ~= "string" and type(after) ~= "table"
                 and not is_tuple(after) then
@@ -55,6 +59,22 @@ local REQUEST_OPTION_TYPES = {
     end,
 }
 
+local BATCH_OPTION_TYPES = {
+    timeout     = "number",
+}
+
+local PAIRS_OPTION_TYPES = {
+    iterator    = "string",
+    limit       = "number",
+    offset      = "number",
+    timeout     = "number",
+    batch_size  = "number",
+    after = REQUEST_OPTION_TYPES.after,
+}
+
+-- Default number of tuples fetched by one request of index:pairs().
+local PAIRS_BATCH_SIZE_DEFAULT = 1000
+
 local CONNECT_OPTION_TYPES = {
     user                        = "string",
     password                    = "string",
@@ -66,6 +86,8 @@ local CONNECT_OPTION_TYPES = {
     auth_type                   = "string",
     required_protocol_version   = "number",
     required_protocol_features  = "table",
+    io_thread                   = "boolean",
+    compression                 = "string",
     _disable_graceful_shutdown  = "boolean",
 }
 
@@ -441,7 +463,8 @@ local function new_sm(uri_or_fd, opts)
     local transport = internal.new_transport(
             uri_or_fd, user, password, weak_callback,
             opts.connect_timeout, opts.reconnect_after,
-            opts.fetch_schema, opts.auth_type)
+            opts.fetch_schema, opts.auth_type, opts.io_thread,
+            opts.compression)
     weak_refs.transport = transport
     remote._transport = transport
     remote._gc_hook = ffi.gc(ffi.new('char[1]'), function()
@@ -982,6 +1005,58 @@ function remote_methods:eval(code, args, opts)
     return unpack(res)
 end
 
+--
+-- Sends a batch of function calls and waits for all of them to complete at
+-- once. Takes an array of {func_name, args} pairs. Returns an array of call
+-- results, each packed into a table, and a map of errors of the calls that
+-- failed, indexed by call position, or nil if there were no errors.
+--
+function remote_methods:batch(calls, opts)
+    check_remote_arg(self, 'batch')
+    local usage = 'Usage: conn:batch({{func_name, args}, ...}[, opts])'
+    if type(calls) ~= 'table' then
+        error(usage, 2)
+    end
+    check_param_table(opts, BATCH_OPTION_TYPES)
+    local futures = {}
+    local pending = {}
+    local errors
+    for i, c in ipairs(calls) do
+        if type(c) ~= 'table' then
+            error(usage, 2)
+        end
+        check_call_args(c[2])
+        local future, err = self:_request_impl('CALL', {is_async = true},
+                                               nil, self._stream_id,
+                                               tostring(c[1]), c[2] or {})
+        if future ~= nil then
+            futures[i] = future
+            table.insert(pending, future)
+        else
+            errors = errors or {}
+            errors[i] = err
+        end
+    end
+    local ok, err = internal.wait_all(pending, opts and opts.timeout)
+    if not ok then
+        for _, future in ipairs(pending) do
+            future:discard()
+        end
+        box.error(err)
+    end
+    local results = {}
+    for i, future in pairs(futures) do
+        local res, err = future:result()
+        if err ~= nil then
+            errors = errors or {}
+            errors[i] = err
+        else
+            results[i] = res
+        end
+    end
+    return results, errors
+end
+
 function remote_methods:execute(query, parameters, sql_opts, netbox_opts)
     check_remote_arg(self, "execute")
     if sql_opts ~= nil then
@@ -1187,6 +1262,17 @@ space_metatable = function(remote)
                                self._stream_id, self._id_or_name, tuple)
     end
 
+    function methods:insert_arrow(data, opts)
+        check_space_arg(self, 'insert_arrow')
+        check_param_table(opts, REQUEST_OPTION_TYPES)
+        if type(data) ~= 'string' then
+            box.error(box.error.ILLEGAL_PARAMS,
+                      "Usage: space:insert_arrow(data[, opts])")
+        end
+        return remote:_request('INSERT_ARROW', opts, nil, self._stream_id,
+                               self._id_or_name, data)
+    end
+
     function methods:select(key, opts)
         check_space_arg(self, 'select')
         return check_primary_index(self):select(key, opts)
@@ -1216,6 +1302,21 @@ space_metatable = function(remote)
         return check_primary_index(self):get(key, opts)
     end
 
+    function methods:select_many(keys, opts)
+        check_space_arg(self, 'select_many')
+        return check_primary_index(self):select_many(keys, opts)
+    end
+
+    function methods:get_many(keys, opts)
+        check_space_arg(self, 'get_many')
+        return check_primary_index(self):get_many(keys, opts)
+    end
+
+    function methods:pairs(key, opts)
+        check_space_arg(self, 'pairs')
+        return check_primary_index(self):pairs(key, opts)
+    end
+
     function methods:format(format)
         if format == nil then
             return self._format
@@ -1227,6 +1328,19 @@ space_metatable = function(remote)
     return { __index = methods, __metatable = false }
 end
 
+-- Returns the vclock to wait for before executing a read request and the
+-- timeout of the wait.
+local function check_wait_vclock_opts(remote, opts)
+    if opts == nil or opts.wait_vclock == nil then
+        return nil, nil
+    end
+    if remote.peer_protocol_version < 8 then
+        return box.error(box.error.UNSUPPORTED, "Remote server",
+                         "wait_vclock")
+    end
+    return opts.wait_vclock, opts.timeout
+end
+
 index_metatable = function(remote)
     local methods = {}
 
@@ -1235,38 +1349,156 @@ index_metatable = function(remote)
         check_param_table(opts, REQUEST_OPTION_TYPES)
         local key_is_nil = (key == nil or
                             (type(key) == 'table' and #key == 0))
-        local iterator, offset, limit, _, after, fetch_pos =
+        local iterator, offset, limit, _, after, fetch_pos, fields, filter =
             check_select_opts(opts, key_is_nil)
         if (after ~= nil or fetch_pos)
                 and not remote.peer_protocol_features.pagination then
             return box.error(box.error.UNSUPPORTED, "Remote server",
                 "pagination")
         end
+        local wait_vclock, wait_timeout = check_wait_vclock_opts(remote, opts)
+        -- Projected tuples don't match the space format.
+        local format = self.space._format_cdata
+        if fields ~= nil then
+            if remote.peer_protocol_version < 9 then
+                return box.error(box.error.UNSUPPORTED, "Remote server",
+                                 "fields")
+            end
+            format = nil
+        end
+        if filter ~= nil and remote.peer_protocol_version < 10 then
+            return box.error(box.error.UNSUPPORTED, "Remote server", "filter")
+        end
 
         local res
         local method = fetch_pos and 'SELECT_WITH_POS' or 'SELECT'
-        res = (remote:_request(method, opts, self.space._format_cdata,
+        res = (remote:_request(method, opts, format,
                                self._stream_id, self.space._id_or_name,
                                self._id_or_name, iterator, offset, limit, key,
-                               after, fetch_pos))
+                               after, fetch_pos, wait_vclock, wait_timeout,
+                               fields, filter))
         if type(res) ~= 'table' or not fetch_pos or opts and opts.is_async then
             return res
         end
         return unpack(res)
     end
 
+    -- Returns an iterator over the tuples matching the key. Tuples are
+    -- fetched from the server in batches of opts.batch_size with
+    -- pagination, so the memory used on both sides doesn't depend on
+    -- the total number of tuples. The next batch is requested as soon
+    -- as the previous one is received, so that it arrives while the
+    -- caller is processing the current one.
+    function methods:pairs(key, opts)
+        check_index_arg(self, 'pairs')
+        check_param_table(opts, PAIRS_OPTION_TYPES)
+        if not remote.peer_protocol_features.pagination then
+            return box.error(box.error.UNSUPPORTED, "Remote server",
+                             "pagination")
+        end
+        local key_is_nil = (key == nil or
+                            (type(key) == 'table' and #key == 0))
+        local iterator, offset, limit, _, after =
+            check_select_opts(opts, key_is_nil)
+        local batch_size = PAIRS_BATCH_SIZE_DEFAULT
+        local timeout
+        if opts ~= nil then
+            batch_size = opts.batch_size or batch_size
+            timeout = opts.timeout
+        end
+        if batch_size <= 0 then
+            box.error(box.error.ILLEGAL_PARAMS,
+                      "batch_size must be a positive number")
+        end
+        local format = self.space._format_cdata
+        local stream_id = self._stream_id
+        local space_id = self.space._id_or_name
+        local index_id = self._id_or_name
+        local tuples, tuple_no = {}, 0
+        local future, requested
+        local function fetch(pos, skip)
+            requested = math.min(batch_size, limit)
+            future = remote:_request('SELECT_WITH_POS', {is_async = true},
+                                     format, stream_id, space_id, index_id,
+                                     iterator, skip, requested, key, pos, true)
+        end
+        if limit > 0 then
+            fetch(after, offset)
+        end
+        local function gen()
+            while true do
+                tuple_no = tuple_no + 1
+                local tuple = tuples[tuple_no]
+                if tuple ~= nil then
+                    return true, tuple
+                end
+                if future == nil then
+                    return nil
+                end
+                local res, err = future:wait_result(timeout)
+                future = nil
+                if res == nil then
+                    box.error(err)
+                end
+                local pos
+                tuples, pos = res[1], res[2]
+                tuple_no = 0
+                limit = limit - #tuples
+                if #tuples == requested and limit > 0 and pos ~= nil then
+                    fetch(pos, 0)
+                end
+            end
+        end
+        return fun.wrap(gen, nil, true)
+    end
+
     function methods:get(key, opts)
         check_index_arg(self, 'get')
         check_param_table(opts, REQUEST_OPTION_TYPES)
         if opts and opts.buffer then
             error("index:get() doesn't support `buffer` argument")
         end
+        local wait_vclock, wait_timeout = check_wait_vclock_opts(remote, opts)
         return nothing_or_data(remote:_request('GET', opts,
                                                self.space._format_cdata,
                                                self._stream_id,
                                                self.space._id_or_name,
                                                self._id_or_name, box.index.EQ,
-                                               0, 2, key, nil, false))
+                                               0, 2, key, nil, false,
+                                               wait_vclock, wait_timeout))
+    end
+
+    function methods:select_many(keys, opts)
+        check_index_arg(self, 'select_many')
+        check_param_table(opts, REQUEST_OPTION_TYPES)
+        if type(keys) ~= 'table' then
+            box.error(box.error.ILLEGAL_PARAMS,
+                      "Usage: index:select_many({key, ...}[, opts])")
+        end
+        local iterator, offset, limit, _, after, fetch_pos =
+            check_select_opts(opts, false)
+        if after ~= nil or fetch_pos then
+            box.error(box.error.UNSUPPORTED, "index:select_many()",
+                      "pagination")
+        end
+        return remote:_request('SELECT_MANY', opts, self.space._format_cdata,
+                               self._stream_id, self.space._id_or_name,
+                               self._id_or_name, iterator, offset, limit, keys)
+    end
+
+    function methods:get_many(keys, opts)
+        check_index_arg(self, 'get_many')
+        check_param_table(opts, REQUEST_OPTION_TYPES)
+        if type(keys) ~= 'table' then
+            box.error(box.error.ILLEGAL_PARAMS,
+                      "Usage: index:get_many({key, ...}[, opts])")
+        end
+        if opts and opts.buffer then
+            error("index:get_many() doesn't support `buffer` argument")
+        end
+        return remote:_request('GET_MANY', opts, self.space._format_cdata,
+                               self._stream_id, self.space._id_or_name,
+                               self._id_or_name, box.index.EQ, 0, 1, keys)
     end
 
     function methods:min(key, opts)
@@ -1340,6 +1572,7 @@ this_module = {
     connect = connect,
     new = connect, -- Tarantool < 1.7.1 compatibility,
     from_fd = from_fd,
+    wait_all = internal.wait_all,
 }
 
 function this_module.timeout(timeout, ...)
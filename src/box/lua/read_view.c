@@ -0,0 +1,561 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2026, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#include "box/lua/read_view.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <lua.h>
+#include <lauxlib.h>
+
+#include "box/arrow_export.h"
+#include "box/index.h"
+#include "box/lua/misc.h"
+#include "box/lua/tuple.h"
+#include "box/read_view.h"
+#include "box/session.h"
+#include "box/space.h"
+#include "box/tuple.h"
+#include "box/tuple_format.h"
+#include "diag.h"
+#include "fiber.h"
+#include "lua/utils.h"
+#include "msgpuck.h"
+#include "small/region.h"
+#include "small/rlist.h"
+#include "trivia/util.h"
+#include "tt_static.h"
+
+static const char *read_view_typename = "box.read_view.handle";
+static const char *read_view_iterator_typename = "box.read_view.iterator";
+
+/** User read view opened from Lua. Stored in a Lua userdata. */
+struct lua_read_view {
+	/** Database read view. */
+	struct read_view base;
+	/** Set when the read view is closed. */
+	bool is_closed;
+	/** Number of exports in progress, see lbox_read_view_export_arrow(). */
+	int export_count;
+	/**
+	 * List of iterators over this read view,
+	 * linked by lua_read_view_iterator::in_read_view.
+	 */
+	struct rlist iterators;
+};
+
+/** Iterator over a user read view. Stored in a Lua userdata. */
+struct lua_read_view_iterator {
+	/** Read view or NULL if the iterator is closed. */
+	struct lua_read_view *rv;
+	/** Lua reference to the read view userdata pinned by this iterator. */
+	int rv_ref;
+	/** Link in lua_read_view::iterators. */
+	struct rlist in_read_view;
+	/**
+	 * Copy of the search key. The index read view iterator refers
+	 * to the key so it must live as long as the iterator.
+	 */
+	char *key;
+	/** Index read view iterator. */
+	struct index_read_view_iterator base;
+};
+
+/**
+ * Only memtx spaces the current user is allowed to read are included into
+ * a user read view. Spaces with an upgrade in progress are skipped because
+ * tuples fetched from them would have to be upgraded on the fly.
+ */
+static bool
+lua_read_view_filter_space(struct space *space, void *arg)
+{
+	(void)arg;
+	return space_is_memtx(space) && space->upgrade == NULL &&
+	       space_access_is_granted(space, effective_user(), PRIV_R);
+}
+
+static bool
+lua_read_view_filter_index(struct space *space, struct index *index,
+			   void *arg)
+{
+	(void)space;
+	(void)arg;
+	return (index->def->type == TREE || index->def->type == HASH) &&
+	       !index->def->key_def->is_multikey &&
+	       !index->def->key_def->for_func_index;
+}
+
+/** Closes an iterator and unpins the read view it was created for. */
+static void
+lua_read_view_iterator_close(struct lua_State *L,
+			     struct lua_read_view_iterator *it)
+{
+	if (it->rv == NULL)
+		return;
+	index_read_view_iterator_destroy(&it->base);
+	rlist_del_entry(it, in_read_view);
+	free(it->key);
+	it->key = NULL;
+	it->rv = NULL;
+	luaL_unref(L, LUA_REGISTRYINDEX, it->rv_ref);
+	it->rv_ref = LUA_NOREF;
+}
+
+/** Closes a read view and all iterators over it. */
+static void
+lua_read_view_close(struct lua_State *L, struct lua_read_view *rv)
+{
+	if (rv->is_closed)
+		return;
+	struct lua_read_view_iterator *it, *next_it;
+	rlist_foreach_entry_safe(it, &rv->iterators, in_read_view, next_it)
+		lua_read_view_iterator_close(L, it);
+	struct space_read_view *space_rv;
+	read_view_foreach_space(space_rv, &rv->base) {
+		if (space_rv->format != NULL) {
+			tuple_format_unref(space_rv->format);
+			space_rv->format = NULL;
+		}
+	}
+	read_view_close(&rv->base);
+	rv->is_closed = true;
+}
+
+static struct lua_read_view *
+luaT_check_read_view(struct lua_State *L, int narg)
+{
+	return luaL_checkudata(L, narg, read_view_typename);
+}
+
+static struct lua_read_view_iterator *
+luaT_check_read_view_iterator(struct lua_State *L, int narg)
+{
+	return luaL_checkudata(L, narg, read_view_iterator_typename);
+}
+
+/**
+ * Looks up an index in an open read view.
+ * On error returns NULL and sets diag.
+ */
+static struct index_read_view *
+lua_read_view_index(struct lua_read_view *rv, uint32_t space_id,
+		    uint32_t index_id)
+{
+	if (rv->is_closed) {
+		diag_set(IllegalParams, "read view is closed");
+		return NULL;
+	}
+	struct space_read_view *space_rv;
+	read_view_foreach_space(space_rv, &rv->base) {
+		if (space_rv->id != space_id)
+			continue;
+		struct index_read_view *index_rv =
+			space_read_view_index(space_rv, index_id);
+		if (index_rv == NULL) {
+			diag_set(ClientError, ER_NO_SUCH_INDEX_ID, index_id,
+				 space_rv->name);
+			return NULL;
+		}
+		return index_rv;
+	}
+	diag_set(ClientError, ER_NO_SUCH_SPACE, int2str(space_id));
+	return NULL;
+}
+
+/**
+ * Checks that the given search is supported by an index read view.
+ * Tree index read views support iterators up to ITER_GT while hash
+ * index read views can only be scanned in full.
+ */
+static int
+lua_read_view_check_search(struct index_read_view *index_rv,
+			   enum iterator_type type, const char *key,
+			   uint32_t part_count)
+{
+	if (type > ITER_GT || (index_rv->def->type == HASH &&
+			       (part_count > 0 || type != ITER_ALL))) {
+		diag_set(ClientError, ER_UNSUPPORTED,
+			 tt_sprintf("%s index read view",
+				    index_type_strs[index_rv->def->type]),
+			 "requested iterator type");
+		return -1;
+	}
+	return key_validate(index_rv->def, type, key, part_count);
+}
+
+/**
+ * Pushes a tuple fetched from a read view to the Lua stack.
+ * The tuple data may be allocated on the fiber region, which is
+ * truncated to the given savepoint after the data is copied.
+ */
+static int
+lua_read_view_push_tuple(struct lua_State *L,
+			 struct index_read_view *index_rv,
+			 struct read_view_tuple *result, size_t region_svp)
+{
+	assert(!result->needs_upgrade);
+	struct tuple *tuple = tuple_new(index_rv->space->format, result->data,
+					result->data + result->size);
+	region_truncate(&fiber()->gc, region_svp);
+	if (tuple == NULL)
+		return -1;
+	luaT_pushtuple(L, tuple);
+	return 0;
+}
+
+/**
+ * Opens a user read view.
+ *
+ * Takes the read view name. Returns the read view handle, the read view
+ * info table (see lbox_push_read_view()) and an array of spaces included
+ * into the read view. Each space is represented by a table with the 'id',
+ * 'name' and 'index' fields. The latter is an array of index tables with
+ * the 'id', 'name', 'type' and 'unique' fields.
+ */
+static int
+lbox_read_view_open(struct lua_State *L)
+{
+	const char *name = luaL_checkstring(L, 1);
+	struct lua_read_view *rv = lua_newuserdata(L, sizeof(*rv));
+	rv->is_closed = true;
+	rv->export_count = 0;
+	rlist_create(&rv->iterators);
+	luaL_getmetatable(L, read_view_typename);
+	lua_setmetatable(L, -2);
+	struct read_view_opts opts;
+	read_view_opts_create(&opts);
+	opts.name = name;
+	opts.filter_space = lua_read_view_filter_space;
+	opts.filter_index = lua_read_view_filter_index;
+	opts.enable_field_names = true;
+	opts.enable_data_temporary_spaces = true;
+	if (read_view_open(&rv->base, &opts) != 0)
+		return luaT_error(L);
+	rv->is_closed = false;
+	struct space_read_view *space_rv;
+	read_view_foreach_space(space_rv, &rv->base) {
+		space_rv->format = runtime_tuple_format_new(
+			space_rv->format_data, space_rv->format_data_len,
+			/*names_only=*/true);
+		if (space_rv->format == NULL) {
+			lua_read_view_close(L, rv);
+			return luaT_error(L);
+		}
+		tuple_format_ref(space_rv->format);
+	}
+	lbox_push_read_view(L, &rv->base);
+	lua_newtable(L);
+	read_view_foreach_space(space_rv, &rv->base) {
+		lua_newtable(L);
+		lua_pushinteger(L, space_rv->id);
+		lua_setfield(L, -2, "id");
+		lua_pushstring(L, space_rv->name);
+		lua_setfield(L, -2, "name");
+		lua_newtable(L);
+		for (uint32_t i = 0; i <= space_rv->index_id_max; i++) {
+			struct index_read_view *index_rv =
+				space_read_view_index(space_rv, i);
+			if (index_rv == NULL)
+				continue;
+			lua_newtable(L);
+			lua_pushinteger(L, index_rv->def->iid);
+			lua_setfield(L, -2, "id");
+			lua_pushstring(L, index_rv->def->name);
+			lua_setfield(L, -2, "name");
+			lua_pushstring(L, index_type_strs[index_rv->def->type]);
+			lua_setfield(L, -2, "type");
+			lua_pushboolean(L, index_rv->def->opts.is_unique);
+			lua_setfield(L, -2, "unique");
+			lua_rawseti(L, -2, lua_objlen(L, -2) + 1);
+		}
+		lua_setfield(L, -2, "index");
+		lua_rawseti(L, -2, lua_objlen(L, -2) + 1);
+	}
+	return 3;
+}
+
+/**
+ * Closes a user read view. Closing a closed read view is a no-op.
+ * A read view can't be closed while it's being exported.
+ */
+static int
+lbox_read_view_close(struct lua_State *L)
+{
+	struct lua_read_view *rv = luaT_check_read_view(L, 1);
+	if (rv->export_count > 0) {
+		diag_set(IllegalParams, "read view is being exported");
+		return luaT_error(L);
+	}
+	lua_read_view_close(L, rv);
+	return 0;
+}
+
+/**
+ * Looks up a tuple by a full key in a unique index of a read view.
+ * Takes the read view handle, space id, index id and key.
+ */
+static int
+lbox_read_view_get(struct lua_State *L)
+{
+	struct lua_read_view *rv = luaT_check_read_view(L, 1);
+	uint32_t space_id = luaL_checkinteger(L, 2);
+	uint32_t index_id = luaL_checkinteger(L, 3);
+	struct index_read_view *index_rv =
+		lua_read_view_index(rv, space_id, index_id);
+	if (index_rv == NULL)
+		return luaT_error(L);
+	if (!index_rv->def->opts.is_unique) {
+		diag_set(ClientError, ER_MORE_THAN_ONE_TUPLE);
+		return luaT_error(L);
+	}
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	size_t key_len;
+	const char *key = lbox_encode_tuple_on_gc(L, 4, &key_len);
+	if (key == NULL)
+		return luaT_error(L);
+	uint32_t part_count = mp_decode_array(&key);
+	struct read_view_tuple result;
+	if (lua_read_view_check_search(index_rv, ITER_EQ, key,
+				       part_count) != 0 ||
+	    exact_key_validate(index_rv->def->key_def, key, part_count) != 0 ||
+	    index_read_view_get_raw(index_rv, key, part_count, &result) != 0) {
+		region_truncate(region, region_svp);
+		return luaT_error(L);
+	}
+	if (result.data == NULL) {
+		region_truncate(region, region_svp);
+		return 0;
+	}
+	if (lua_read_view_push_tuple(L, index_rv, &result, region_svp) != 0)
+		return luaT_error(L);
+	return 1;
+}
+
+/**
+ * Selects tuples from a read view index. Takes the read view handle,
+ * space id, index id, iterator type, key, offset and limit. Returns
+ * a Lua array of tuples.
+ */
+static int
+lbox_read_view_select(struct lua_State *L)
+{
+	struct lua_read_view *rv = luaT_check_read_view(L, 1);
+	uint32_t space_id = luaL_checkinteger(L, 2);
+	uint32_t index_id = luaL_checkinteger(L, 3);
+	int type = luaL_checkinteger(L, 4);
+	uint32_t offset = luaL_checkinteger(L, 6);
+	uint32_t limit = luaL_checkinteger(L, 7);
+	if (type < 0 || type >= iterator_type_MAX) {
+		diag_set(IllegalParams, "Invalid iterator type");
+		return luaT_error(L);
+	}
+	struct index_read_view *index_rv =
+		lua_read_view_index(rv, space_id, index_id);
+	if (index_rv == NULL)
+		return luaT_error(L);
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	size_t key_len;
+	const char *key = lbox_encode_tuple_on_gc(L, 5, &key_len);
+	if (key == NULL)
+		return luaT_error(L);
+	uint32_t part_count = mp_decode_array(&key);
+	struct index_read_view_iterator it;
+	if (lua_read_view_check_search(index_rv, type, key, part_count) != 0 ||
+	    index_read_view_create_iterator(index_rv, type, key, part_count,
+					    &it) != 0) {
+		region_truncate(region, region_svp);
+		return luaT_error(L);
+	}
+	/* The key must stay on the region while the iterator is used. */
+	size_t tuple_svp = region_used(region);
+	lua_newtable(L);
+	uint32_t count = 0;
+	int rc = 0;
+	while (count < limit) {
+		struct read_view_tuple result;
+		rc = index_read_view_iterator_next_raw(&it, &result);
+		if (rc != 0 || result.data == NULL)
+			break;
+		if (offset > 0) {
+			region_truncate(region, tuple_svp);
+			offset--;
+			continue;
+		}
+		rc = lua_read_view_push_tuple(L, index_rv, &result, tuple_svp);
+		if (rc != 0)
+			break;
+		lua_rawseti(L, -2, ++count);
+	}
+	index_read_view_iterator_destroy(&it);
+	region_truncate(region, region_svp);
+	if (rc != 0)
+		return luaT_error(L);
+	return 1;
+}
+
+/**
+ * Creates an iterator over a read view index. Takes the read view handle,
+ * space id, index id, iterator type and key. The iterator pins the read
+ * view handle so that it isn't garbage collected while the iterator is in
+ * use. The iterator is closed when the read view is closed.
+ */
+static int
+lbox_read_view_iterator(struct lua_State *L)
+{
+	struct lua_read_view *rv = luaT_check_read_view(L, 1);
+	uint32_t space_id = luaL_checkinteger(L, 2);
+	uint32_t index_id = luaL_checkinteger(L, 3);
+	int type = luaL_checkinteger(L, 4);
+	if (type < 0 || type >= iterator_type_MAX) {
+		diag_set(IllegalParams, "Invalid iterator type");
+		return luaT_error(L);
+	}
+	struct index_read_view *index_rv =
+		lua_read_view_index(rv, space_id, index_id);
+	if (index_rv == NULL)
+		return luaT_error(L);
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	size_t key_len;
+	const char *key_data = lbox_encode_tuple_on_gc(L, 5, &key_len);
+	if (key_data == NULL)
+		return luaT_error(L);
+	char *key = xmalloc(key_len);
+	memcpy(key, key_data, key_len);
+	region_truncate(region, region_svp);
+	const char *key_parts = key;
+	uint32_t part_count = mp_decode_array(&key_parts);
+	struct lua_read_view_iterator *it = lua_newuserdata(L, sizeof(*it));
+	it->rv = NULL;
+	it->rv_ref = LUA_NOREF;
+	it->key = key;
+	luaL_getmetatable(L, read_view_iterator_typename);
+	lua_setmetatable(L, -2);
+	if (lua_read_view_check_search(index_rv, type, key_parts,
+				       part_count) != 0 ||
+	    index_read_view_create_iterator(index_rv, type, key_parts,
+					    part_count, &it->base) != 0) {
+		free(it->key);
+		it->key = NULL;
+		return luaT_error(L);
+	}
+	it->rv = rv;
+	rlist_add_tail_entry(&rv->iterators, it, in_read_view);
+	lua_pushvalue(L, 1);
+	it->rv_ref = luaL_ref(L, LUA_REGISTRYINDEX);
+	return 1;
+}
+
+/**
+ * Returns the next tuple from a read view iterator or nothing if the
+ * iterator is exhausted. The iterator is closed when it's exhausted.
+ */
+static int
+lbox_read_view_iterator_next(struct lua_State *L)
+{
+	struct lua_read_view_iterator *it =
+		luaT_check_read_view_iterator(L, 1);
+	if (it->rv == NULL)
+		return 0;
+	struct index_read_view *index_rv = it->base.base.index;
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	struct read_view_tuple result;
+	if (index_read_view_iterator_next_raw(&it->base, &result) != 0) {
+		region_truncate(region, region_svp);
+		return luaT_error(L);
+	}
+	if (result.data == NULL) {
+		region_truncate(region, region_svp);
+		lua_read_view_iterator_close(L, it);
+		return 0;
+	}
+	if (lua_read_view_push_tuple(L, index_rv, &result, region_svp) != 0)
+		return luaT_error(L);
+	return 1;
+}
+
+/**
+ * Exports a space of a read view to a file in the Apache Arrow IPC
+ * streaming format, see arrow_export_space(). Takes the read view
+ * handle, space id, file path and batch size. Returns the number of
+ * exported tuples. Yields while the export is in progress.
+ */
+static int
+lbox_read_view_export_arrow(struct lua_State *L)
+{
+	struct lua_read_view *rv = luaT_check_read_view(L, 1);
+	uint32_t space_id = luaL_checkinteger(L, 2);
+	const char *path = luaL_checkstring(L, 3);
+	uint32_t batch_size = luaL_checkinteger(L, 4);
+	struct index_read_view *index_rv =
+		lua_read_view_index(rv, space_id, 0);
+	if (index_rv == NULL)
+		return luaT_error(L);
+	uint64_t row_count;
+	rv->export_count++;
+	int rc = arrow_export_space(index_rv->space, path, batch_size,
+				    &row_count);
+	rv->export_count--;
+	if (rc != 0)
+		return luaT_error(L);
+	luaL_pushuint64(L, row_count);
+	return 1;
+}
+
+static int
+lbox_read_view_gc(struct lua_State *L)
+{
+	struct lua_read_view *rv = luaT_check_read_view(L, 1);
+	lua_read_view_close(L, rv);
+	return 0;
+}
+
+static int
+lbox_read_view_iterator_gc(struct lua_State *L)
+{
+	struct lua_read_view_iterator *it =
+		luaT_check_read_view_iterator(L, 1);
+	lua_read_view_iterator_close(L, it);
+	return 0;
+}
+
+void
+box_lua_read_view_init(struct lua_State *L)
+{
+	static const struct luaL_Reg read_view_meta[] = {
+		{"__gc", lbox_read_view_gc},
+		{NULL, NULL}
+	};
+	luaL_register_type(L, read_view_typename, read_view_meta);
+
+	static const struct luaL_Reg read_view_iterator_meta[] = {
+		{"__gc", lbox_read_view_iterator_gc},
+		{NULL, NULL}
+	};
+	luaL_register_type(L, read_view_iterator_typename,
+			   read_view_iterator_meta);
+
+	static const struct luaL_Reg read_view_internal_lib[] = {
+		{"open", lbox_read_view_open},
+		{"close", lbox_read_view_close},
+		{"get", lbox_read_view_get},
+		{"select", lbox_read_view_select},
+		{"iterator", lbox_read_view_iterator},
+		{"iterator_next", lbox_read_view_iterator_next},
+		{"export_arrow", lbox_read_view_export_arrow},
+		{NULL, NULL}
+	};
+	luaL_findtable(L, LUA_GLOBALSINDEX, "box.internal.read_view", 0);
+	luaL_setfuncs(L, read_view_internal_lib, 0);
+	lua_pop(L, 1);
+}
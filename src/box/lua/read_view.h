@@ -11,14 +11,22 @@
 #include "lua/read_view_impl.h"
 #else /* !defined(ENABLE_READ_VIEW) */
 
-#define READ_VIEW_BOX_LUA_MODULES
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+extern char read_view_lua[];
+
+#define READ_VIEW_BOX_LUA_MODULES "box/read_view", NULL, read_view_lua,
 
 struct lua_State;
 
-static inline void
-box_lua_read_view_init(struct lua_State *L)
-{
-	(void)L;
-}
+/** Initialize box.internal.read_view used by box.read_view.open(). */
+void
+box_lua_read_view_init(struct lua_State *L);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
 
 #endif /* !defined(ENABLE_READ_VIEW) */
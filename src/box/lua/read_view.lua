@@ -0,0 +1,222 @@
+-- User read views.
+--
+-- A read view is a frozen image of the database at the time it was
+-- opened: changes made after that aren't visible from it. Reading
+-- from a read view doesn't block writers and doesn't need a long
+-- transaction, so it is suitable for consistent exports and analytics.
+--
+-- Only memtx spaces the current user can read are included into a read
+-- view. Of their indexes, TREE indexes support all iterators up to GT
+-- and get(), while HASH indexes may only be scanned in full. Multikey
+-- and functional indexes aren't included.
+--
+-- Selecting or iterating over a read view doesn't yield, so a long
+-- scan should yield explicitly between batches of tuples.
+
+local fun = require('fun')
+local utils = require('internal.utils')
+
+local internal = box.internal.read_view
+local check_select_opts = box.internal.check_select_opts
+local check_pairs_opts = box.internal.check_pairs_opts
+local is_tuple = box.tuple.is
+
+--
+-- Read view handles (see lua/read_view.c) by read view object.
+--
+-- A handle is closed when it's garbage collected so a read view is
+-- closed when the user drops the last reference to it.
+--
+local handles = setmetatable({}, {__mode = 'k'})
+
+local function keify(key)
+    if key == nil then
+        return {}
+    elseif type(key) == 'table' or is_tuple(key) then
+        return key
+    end
+    return {key}
+end
+
+local function check_arg(obj, obj_name, method)
+    if type(obj) ~= 'table' then
+        local fmt = 'Use %s:%s(...) instead of %s.%s(...)'
+        error(string.format(fmt, obj_name, method, obj_name, method), 3)
+    end
+end
+
+local function check_no_pagination(after, fetch_pos)
+    if after ~= nil or fetch_pos then
+        box.error(box.error.UNSUPPORTED, 'Read view', 'pagination')
+    end
+end
+
+local index_methods = {}
+
+function index_methods:get(key)
+    check_arg(self, 'index', 'get')
+    local handle = handles[self.space.read_view]
+    return internal.get(handle, self.space_id, self.id, keify(key))
+end
+
+function index_methods:select(key, opts)
+    check_arg(self, 'index', 'select')
+    key = keify(key)
+    local iterator, offset, limit, _, after, fetch_pos, fields, filter =
+        check_select_opts(opts, #key == 0)
+    check_no_pagination(after, fetch_pos)
+    if fields ~= nil then
+        box.error(box.error.UNSUPPORTED, 'Read view', 'fields')
+    end
+    if filter ~= nil then
+        box.error(box.error.UNSUPPORTED, 'Read view', 'filter')
+    end
+    local handle = handles[self.space.read_view]
+    return internal.select(handle, self.space_id, self.id, iterator, key,
+                           offset, limit)
+end
+
+local function iterator_gen(param, state) -- luacheck: no unused args
+    local tuple = internal.iterator_next(state)
+    if tuple == nil then
+        return nil
+    end
+    return state, tuple
+end
+
+function index_methods:pairs(key, opts)
+    check_arg(self, 'index', 'pairs')
+    key = keify(key)
+    local iterator, after = check_pairs_opts(opts, #key == 0)
+    check_no_pagination(after)
+    local handle = handles[self.space.read_view]
+    local state = internal.iterator(handle, self.space_id, self.id,
+                                    iterator, key)
+    return fun.wrap(iterator_gen, nil, state)
+end
+
+local index_mt = {
+    __index = index_methods,
+    __serialize = function(self)
+        return {
+            id = self.id,
+            name = self.name,
+            type = self.type,
+            unique = self.unique,
+            space_id = self.space_id,
+        }
+    end,
+}
+
+local space_methods = {}
+
+local function space_pk(space)
+    local pk = space.index[0]
+    if pk == nil then
+        box.error(box.error.NO_SUCH_INDEX_ID, 0, space.name)
+    end
+    return pk
+end
+
+function space_methods:get(key)
+    check_arg(self, 'space', 'get')
+    return space_pk(self):get(key)
+end
+
+function space_methods:select(key, opts)
+    check_arg(self, 'space', 'select')
+    return space_pk(self):select(key, opts)
+end
+
+function space_methods:pairs(key, opts)
+    check_arg(self, 'space', 'pairs')
+    return space_pk(self):pairs(key, opts)
+end
+
+--
+-- Writes all tuples of the space to a file in the Apache Arrow IPC
+-- streaming format. Columns are named and typed after the space format.
+-- Tuples are converted to record batches in a separate thread, the
+-- calling fiber yields until the export is done. Options:
+--  - 'batch_size' - max number of rows in a record batch, 65536 by
+--    default.
+--
+-- Returns the number of exported tuples.
+--
+function space_methods:export_arrow(path, opts)
+    check_arg(self, 'space', 'export_arrow')
+    if type(path) ~= 'string' then
+        box.error(box.error.ILLEGAL_PARAMS, 'path should be a string')
+    end
+    utils.check_param_table(opts, {batch_size = 'number'})
+    local batch_size = opts ~= nil and opts.batch_size or 65536
+    if batch_size <= 0 or batch_size > 0x7fffffff or
+            batch_size ~= math.floor(batch_size) then
+        box.error(box.error.ILLEGAL_PARAMS,
+                  'batch_size should be a positive integer')
+    end
+    local handle = handles[self.read_view]
+    return internal.export_arrow(handle, self.id, path, batch_size)
+end
+
+local space_mt = {
+    __index = space_methods,
+    __serialize = function(self)
+        return {id = self.id, name = self.name}
+    end,
+}
+
+--
+-- Closes a user read view. System read views can't be closed by
+-- the user, see read_view_methods:close() in schema.lua.
+--
+local read_view_close_system = box.internal.read_view_close
+
+function box.internal.read_view_close(rv)
+    local handle = handles[rv]
+    if handle == nil then
+        return read_view_close_system(rv)
+    end
+    internal.close(handle)
+end
+
+--
+-- Opens a read view. Options:
+--  - 'name' - read view name, used for introspection, 'unknown' by
+--    default.
+--
+-- Spaces of the returned read view are accessible via rv.space by name
+-- and by id, indexes via rv.space[x].index by name and by id. Indexes
+-- and spaces of a read view have get(), select() and pairs() methods
+-- with the same arguments as box.space objects.
+--
+function box.read_view.open(opts)
+    utils.check_param_table(opts, {name = 'string'})
+    local name = opts ~= nil and opts.name or 'unknown'
+    local handle, rv, spaces = internal.open(name)
+    rv.space = {}
+    for _, s in ipairs(spaces) do
+        local space = setmetatable({
+            id = s.id,
+            name = s.name,
+            index = {},
+            read_view = rv,
+        }, space_mt)
+        for _, i in ipairs(s.index) do
+            local index = setmetatable({
+                id = i.id,
+                name = i.name,
+                type = i.type,
+                unique = i.unique,
+                space_id = s.id,
+                space = space,
+            }, index_mt)
+            space.index[i.id] = index
+            space.index[i.name] = index
+        end
+        rv.space[s.id] = space
+        rv.space[s.name] = space
+    end
+    handles[rv] = handle
+    return box.internal.read_view_register(rv)
+end
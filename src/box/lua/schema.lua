@@ -62,6 +62,9 @@ ffi.cdef[[
     box_index_get(uint32_t space_id, uint32_t index_id, const char *key,
                   const char *key_end, box_tuple_t **result);
     int
+    box_index_get_many(uint32_t space_id, uint32_t index_id, const char *keys,
+                       const char *keys_end, box_tuple_t **result);
+    int
     box_index_min(uint32_t space_id, uint32_t index_id, const char *key,
                   const char *key_end, box_tuple_t **result);
     int
@@ -116,6 +119,7 @@ ffi.cdef[[
         struct port_c_entry *last;
         struct port_c_entry first_entry;
         int size;
+        bool is_borrowed;
     };
 
     void
@@ -131,7 +135,9 @@ ffi.cdef[[
                    const char *key_end, const char **packed_pos,
                    const char **packed_pos_end, bool update_pos,
                    struct port *port, int64_t iterator, uint64_t offset,
-                   uint64_t limit);
+                   uint64_t limit, const char *fields,
+                   const char *fields_end, const char *filter,
+                   const char *filter_end);
 
     enum priv_type {
         PRIV_R = 1,
@@ -745,6 +751,29 @@ local function check_space_type(space_type)
               table.concat(space_types, "', '") .. "'.")
 end
 
+-- Convert the expire_field space option, which is either a field name
+-- or a one-based field number, to a zero-based field number.
+local function normalize_expire_field(field, format)
+    if field == nil then
+        return nil
+    end
+    if type(field) == 'number' then
+        if field < 1 or field ~= math.floor(field) then
+            box.error(box.error.ILLEGAL_PARAMS,
+                      "options parameter 'expire_field' must be " ..
+                      "a positive integer or a field name")
+        end
+        return field - 1
+    end
+    for i, f in ipairs(format) do
+        if f.name == field then
+            return i - 1
+        end
+    end
+    box.error(box.error.ILLEGAL_PARAMS,
+              string.format("unknown expire_field '%s'", field))
+end
+
 box.schema.space = {}
 box.schema.space.create = function(name, options)
     check_param(name, 'name', 'string')
@@ -760,6 +789,10 @@ box.schema.space.create = function(name, options)
         temporary = 'boolean',
         is_sync = 'boolean',
         defer_deletes = 'boolean',
+        iproto_read_view = 'boolean',
+        expire_field = 'string, number',
+        cache = 'boolean',
+        upsert_window = 'number',
         constraint = 'string, table',
         foreign_key = 'table',
     }
@@ -812,6 +845,10 @@ box.schema.space.create = function(name, options)
         type = options.type,
         is_sync = options.is_sync,
         defer_deletes = options.defer_deletes and true or nil,
+        iproto_read_view = options.iproto_read_view and true or nil,
+        expire_field = normalize_expire_field(options.expire_field, format),
+        cache = options.cache and true or nil,
+        upsert_window = options.upsert_window,
         constraint = constraint,
         foreign_key = foreign_key,
     })
@@ -919,6 +956,10 @@ local alter_space_template = {
     temporary = 'boolean',
     is_sync = 'boolean',
     defer_deletes = 'boolean',
+    iproto_read_view = 'boolean',
+    expire_field = 'string, number, boolean',
+    cache = 'boolean',
+    upsert_window = 'number',
     name = 'string',
     constraint = 'string, table',
     foreign_key = 'table',
@@ -966,6 +1007,18 @@ box.schema.space.alter = function(space_id, options)
         flags.defer_deletes = options.defer_deletes
     end
 
+    if options.iproto_read_view ~= nil then
+        flags.iproto_read_view = options.iproto_read_view
+    end
+
+    if options.cache ~= nil then
+        flags.cache = options.cache
+    end
+
+    if options.upsert_window ~= nil then
+        flags.upsert_window = options.upsert_window
+    end
+
     local format
     if options.format ~= nil then
         format = normalize_format(space_id, tuple.name, options.format)
@@ -973,6 +1026,14 @@ box.schema.space.alter = function(space_id, options)
         format = tuple.format
     end
 
+    -- expire_field = false disables expiration.
+    if options.expire_field == false then
+        flags.expire_field = nil
+    elseif options.expire_field ~= nil then
+        flags.expire_field = normalize_expire_field(options.expire_field,
+                                                    format)
+    end
+
     if options.constraint ~= nil then
         if table.equals(options.constraint, {}) then
             options.constraint = nil
@@ -1447,6 +1508,7 @@ local index_options = {
     bloom_fpr = 'number',
     func = 'number, string',
     hint = 'boolean',
+    hash_func = 'string',
 }
 
 local function jsonpaths_from_idx_parts(parts)
@@ -1589,6 +1651,7 @@ box.schema.index.create = atomic_wrapper(function(space_id, name, options)
             bloom_fpr = options.bloom_fpr,
             func = options.func,
             hint = options.hint,
+            hash_func = options.hash_func,
     }
     local field_type_aliases = {
         num = 'unsigned'; -- Deprecated since 1.7.2
@@ -2414,6 +2477,105 @@ base_index_mt.get_luac = function(index, key)
     return internal.get(index.space_id, index.id, key)
 end
 
+local function check_get_many_keys(keys)
+    if type(keys) ~= 'table' then
+        box.error(box.error.ILLEGAL_PARAMS,
+                  "Usage: index:get_many({key1, key2, ...})")
+    end
+    local result = {}
+    for i = 1, #keys do
+        result[i] = keify(keys[i])
+    end
+    return result
+end
+
+base_index_mt.get_many_ffi = function(index, keys)
+    if builtin.box_read_ffi_is_disabled then
+        return base_index_mt.get_many_luac(index, keys)
+    end
+    check_index_arg(index, 'get_many')
+    keys = check_get_many_keys(keys)
+    local count = #keys
+    local result = ffi.new('box_tuple_t *[?]', count)
+    local ibuf = cord_ibuf_take()
+    local keys_mp, keys_mp_end = tuple_encode(ibuf, keys)
+    local nok = builtin.box_index_get_many(index.space_id, index.id, keys_mp,
+                                           keys_mp_end, result) ~= 0
+    cord_ibuf_put(ibuf)
+    if nok then
+        return box.error()
+    end
+    local ret = {}
+    for i = 1, count do
+        local tuple = result[i - 1]
+        if tuple ~= nil then
+            ret[i] = tuple_bless(tuple)
+            builtin.box_tuple_unref(tuple)
+        else
+            ret[i] = box.NULL
+        end
+    end
+    return ret
+end
+base_index_mt.get_many_luac = function(index, keys)
+    check_index_arg(index, 'get_many')
+    keys = check_get_many_keys(keys)
+    local ret = {}
+    for i = 1, #keys do
+        local tuple = internal.get(index.space_id, index.id, keys[i])
+        if tuple == nil then
+            tuple = box.NULL
+        end
+        ret[i] = tuple
+    end
+    return ret
+end
+
+-- Converts the fields option of select() to the form expected by
+-- box_select(), where field numbers are 0-based.
+local function check_select_fields(fields)
+    local result = {}
+    if type(fields) == 'table' then
+        for i, field in ipairs(fields) do
+            if type(field) == 'number' and field >= 1 and
+                    field == math.floor(field) then
+                result[i] = field - 1
+            elseif type(field) == 'string' then
+                result[i] = field
+            else
+                result = {}
+                break
+            end
+        end
+    end
+    if #result == 0 then
+        box.error(box.error.ILLEGAL_PARAMS, "fields must be a non-empty " ..
+                  "array of field numbers and paths")
+    end
+    return result
+end
+
+-- Converts the filter option of select() to the form expected by
+-- box_select(), where field numbers are 0-based. The expression is
+-- validated by box_select().
+local function check_select_filter(expr)
+    if type(expr) ~= 'table' then
+        return expr
+    end
+    local op = expr[1]
+    local result = {}
+    for i, v in ipairs(expr) do
+        if op == 'and' or op == 'or' or op == 'not' then
+            result[i] = i > 1 and check_select_filter(v) or v
+        elseif i == 2 and type(v) == 'number' then
+            result[i] = v - 1
+        else
+            result[i] = v
+        end
+    end
+    return result
+end
+
 local function check_select_opts(opts, key_is_nil)
     local offset = 0
     local limit = 4294967295
@@ -2421,6 +2583,8 @@ local function check_select_opts(opts, key_is_nil)
     local fullscan = false
     local after = nil
     local fetch_pos = false
+    local fields = nil
+    local filter = nil
     if opts ~= nil and type(opts) == "table" then
         if opts.offset ~= nil then
             offset = opts.offset
@@ -2441,8 +2605,14 @@ local function check_select_opts(opts, key_is_nil)
         if opts.fetch_pos ~= nil then
             fetch_pos = opts.fetch_pos
         end
+        if opts.fields ~= nil then
+            fields = check_select_fields(opts.fields)
+        end
+        if opts.filter ~= nil then
+            filter = check_select_filter(opts.filter)
+        end
     end
-    return iterator, offset, limit, fullscan, after, fetch_pos
+    return iterator, offset, limit, fullscan, after, fetch_pos, fields, filter
 end
 
 box.internal.check_select_opts = check_select_opts -- for net.box
@@ -2474,19 +2644,31 @@ base_index_mt.select_ffi = function(index, key, opts)
     local key, key_end = tuple_encode(ibuf, key)
     local key_is_nil = key + 1 >= key_end
     local new_position = nil
-    local iterator, offset, limit, fullscan, after, fetch_pos =
+    local iterator, offset, limit, fullscan, after, fetch_pos, fields, filter =
         check_select_opts(opts, key_is_nil)
     local sid = index.space_id
     if is_select_long(sid, key_is_nil, iterator, limit, offset,
                       fullscan) then
         log_long_select(box.space[sid])
     end
+    local fields_end = nil
+    if fields ~= nil then
+        fields = msgpack.encode(fields)
+        fields_end = ffi.cast('const char *', fields) + #fields
+    end
+    local filter_end = nil
+    if filter ~= nil then
+        filter = msgpack.encode(filter)
+        filter_end = ffi.cast('const char *', filter) + #filter
+    end
     local region_svp = builtin.box_region_used()
     local nok = not iterator_pos_set(index, after, ibuf)
     if not nok then
         nok = builtin.box_select_ffi(sid, index.id, key, key_end,
                                      iterator_pos, iterator_pos_end, fetch_pos,
-                                     port, iterator, offset, limit) ~= 0
+                                     port, iterator, offset, limit,
+                                     fields, fields_end,
+                                     filter, filter_end) ~= 0
     end
     if not nok and fetch_pos and iterator_pos[0] ~= nil then
         new_position = ffi.string(iterator_pos[0],
@@ -2515,7 +2697,7 @@ base_index_mt.select_luac = function(index, key, opts)
     check_index_arg(index, 'select')
     local key = keify(key)
     local key_is_nil = #key == 0
-    local iterator, offset, limit, fullscan, after, fetch_pos =
+    local iterator, offset, limit, fullscan, after, fetch_pos, fields, filter =
         check_select_opts(opts, key_is_nil)
     local sid = index.space_id
     if is_select_long(sid, key_is_nil, iterator, limit, offset,
@@ -2523,7 +2705,7 @@ base_index_mt.select_luac = function(index, key, opts)
         log_long_select(box.space[sid])
     end
     return internal.select(sid, index.id, iterator,
-        offset, limit, key, after, fetch_pos)
+        offset, limit, key, after, fetch_pos, fields, filter)
 end
 
 base_index_mt.update = function(index, key, ops)
@@ -2576,7 +2758,8 @@ base_index_mt.tuple_pos = function(index, tuple)
     return ret
 end
 
-local read_ops = {'select', 'get', 'min', 'max', 'count', 'random', 'pairs'}
+local read_ops = {'select', 'get', 'get_many', 'min', 'max', 'count', 'random',
+                  'pairs'}
 for _, op in ipairs(read_ops) do
     vinyl_index_mt[op] = base_index_mt[op..'_luac']
     memtx_index_mt[op] = base_index_mt[op..'_ffi']
@@ -2617,6 +2800,10 @@ space_mt.get = function(space, key)
     check_space_arg(space, 'get')
     return check_primary_index(space):get(key)
 end
+space_mt.get_many = function(space, keys)
+    check_space_arg(space, 'get_many')
+    return check_primary_index(space):get_many(keys)
+end
 space_mt.select = function(space, key, opts)
     check_space_arg(space, 'select')
     return check_primary_index(space):select(key, opts)
@@ -2642,6 +2829,14 @@ space_mt.replace = function(space, tuple)
     return internal.replace(space.id, tuple);
 end
 space_mt.put = space_mt.replace; -- put is an alias for replace
+space_mt.insert_many = function(space, tuples)
+    check_space_arg(space, 'insert_many')
+    return internal.insert_many(space.id, tuples)
+end
+space_mt.replace_many = function(space, tuples)
+    check_space_arg(space, 'replace_many')
+    return internal.replace_many(space.id, tuples)
+end
 space_mt.update = function(space, key, ops)
     check_space_arg(space, 'update')
     return check_primary_index(space):update(key, ops)
@@ -2692,6 +2887,19 @@ space_mt.format = function(space, format)
     check_space_arg(space, 'format')
     return box.schema.space.format(space.id, format)
 end
+space_mt.load_csv = function(space, path, opts)
+    check_space_arg(space, 'load_csv')
+    check_space_exists(space)
+    if type(path) ~= 'string' then
+        box.error(box.error.ILLEGAL_PARAMS,
+                  "Usage: space:load_csv(path[, opts])")
+    end
+    opts = opts or {}
+    check_param_table(opts, {delimiter = 'string', quote_char = 'string',
+                             skip_head_lines = 'number',
+                             chunk_size = 'number', mode = 'string'})
+    return internal.space.load_csv(space.id, path, opts)
+end
 space_mt.upgrade = function(space, ...)
     check_space_arg(space, 'upgrade')
     return box.schema.space.upgrade(space.id, ...)
@@ -239,6 +239,16 @@ lbox_slab_info(struct lua_State *L)
 	lua_pushstring(L, ratio_buf);
 	lua_settable(L, -3);
 
+	/*
+	 * How much of the arena is backed by transparent huge pages.
+	 * Reported only if box.cfg.memtx_use_huge_pages is set.
+	 */
+	if (memtx->use_huge_pages) {
+		lua_pushstring(L, "huge_pages_used");
+		luaL_pushuint64(L, memtx_engine_huge_pages_used(memtx));
+		lua_settable(L, -3);
+	}
+
 	return 1;
 }
 
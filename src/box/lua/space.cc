@@ -413,6 +413,28 @@ lbox_fillspace(struct lua_State *L, struct space *space, int i)
 		lua_settable(L, i);
 	}
 
+	if (space_is_memtx(space)) {
+		lua_pushstring(L, "iproto_read_view");
+		lua_pushboolean(L, space->def->opts.iproto_read_view);
+		lua_settable(L, i);
+
+		lua_pushstring(L, "cache");
+		lua_pushboolean(L, space->def->opts.is_cache);
+		lua_settable(L, i);
+
+		lua_pushstring(L, "upsert_window");
+		lua_pushnumber(L, space->def->opts.upsert_window);
+		lua_settable(L, i);
+	}
+
+	/* space.expire_field, one-based */
+	lua_pushstring(L, "expire_field");
+	if (space->def->opts.expire_field != UINT32_MAX)
+		lua_pushnumber(L, space->def->opts.expire_field + 1);
+	else
+		lua_pushnil(L);
+	lua_settable(L, i);
+
 	lua_getfield(L, i, "index");
 	if (lua_isnil(L, -1)) {
 		lua_pop(L, 1);
@@ -40,9 +40,15 @@
 
 #include "box/box.h"
 #include "box/iproto.h"
+#include "box/iproto_constants.h"
+#include "histogram.h"
 #include "box/engine.h"
 #include "box/vinyl.h"
 #include "box/sql.h"
+#include "box/space.h"
+#include "box/op_stat.h"
+#include "box/hot_key.h"
+#include "box/slow_request.h"
 #include "box/memtx_engine.h"
 #include "info/info.h"
 #include "lua/info.h"
@@ -68,6 +74,83 @@ inject_current_stat(struct lua_State *L, const char *name, size_t val)
 	lua_pop(L, 1);
 }
 
+/**
+ * Pushes a table describing sizes of message batches flushed from iproto
+ * threads to the tx thread: 'total' is the number of batches, 'histogram'
+ * is an array, i-th element of which is the number of batches of size in
+ * [2^(i-1), 2^i). The last element accounts all bigger batches.
+ */
+static void
+push_batch_size_stat(struct lua_State *L, struct iproto_stats *stats)
+{
+	lua_createtable(L, 0, 2);
+	int64_t total = 0;
+	lua_createtable(L, IPROTO_BATCH_HIST_SIZE, 0);
+	for (int i = 0; i < IPROTO_BATCH_HIST_SIZE; i++) {
+		total += stats->batch_hist[i];
+		lua_pushnumber(L, stats->batch_hist[i]);
+		lua_rawseti(L, -2, i + 1);
+	}
+	lua_setfield(L, -2, "histogram");
+	lua_pushnumber(L, total);
+	lua_setfield(L, -2, "total");
+}
+
+/**
+ * Pushes a table describing the limit on iproto requests in flight:
+ * 'current' is the limit, 'total' is the number of times iproto
+ * stopped reading input because the limit was reached.
+ */
+static void
+push_msg_max_stat(struct lua_State *L, struct iproto_stats *stats)
+{
+	lua_createtable(L, 0, 2);
+	lua_pushnumber(L, stats->msg_max);
+	lua_setfield(L, -2, "current");
+	lua_pushnumber(L, stats->msg_max_stops);
+	lua_setfield(L, -2, "total");
+}
+
+/**
+ * Pushes a table describing the tx fiber pool handling iproto
+ * requests: 'current' is the number of fibers working on requests,
+ * 'total' is the number of times requests waited for a free fiber,
+ * 'wait_time' is the total time they waited, 'size' and 'limit'
+ * are the number of fibers in the pool and the limit on it.
+ */
+static void
+push_tx_fibers_stat(struct lua_State *L)
+{
+	struct box_tx_fiber_pool_stat stat;
+	box_tx_fiber_pool_stat(&stat);
+	lua_createtable(L, 0, 5);
+	lua_pushnumber(L, stat.busy);
+	lua_setfield(L, -2, "current");
+	lua_pushnumber(L, stat.stall_count);
+	lua_setfield(L, -2, "total");
+	lua_pushnumber(L, stat.stall_time);
+	lua_setfield(L, -2, "wait_time");
+	lua_pushnumber(L, stat.size);
+	lua_setfield(L, -2, "size");
+	lua_pushnumber(L, stat.max_size);
+	lua_setfield(L, -2, "limit");
+}
+
+/**
+ * Pushes a table describing iproto network buffers: 'memory' is the size
+ * of memory used by them, 'idle' is the number of connections that had
+ * their input buffers released because they didn't receive anything.
+ */
+static void
+push_buffers_stat(struct lua_State *L, struct iproto_stats *stats)
+{
+	lua_createtable(L, 0, 2);
+	lua_pushnumber(L, stats->mem_used);
+	lua_setfield(L, -2, "memory");
+	lua_pushnumber(L, stats->idle_connections);
+	lua_setfield(L, -2, "idle");
+}
+
 static void
 inject_iproto_stats(struct lua_State *L, struct iproto_stats *stats)
 {
@@ -78,6 +161,12 @@ inject_iproto_stats(struct lua_State *L, struct iproto_stats *stats)
 			    stats->requests_in_progress);
 	inject_current_stat(L, "REQUESTS_IN_STREAM_QUEUE",
 			    stats->requests_in_stream_queue);
+	push_batch_size_stat(L, stats);
+	lua_setfield(L, -2, "BATCH_SIZE");
+	push_msg_max_stat(L, stats);
+	lua_setfield(L, -2, "MSG_MAX");
+	push_buffers_stat(L, stats);
+	lua_setfield(L, -2, "BUFFERS");
 }
 
 static void
@@ -200,12 +289,232 @@ lbox_stat_memtx_tx(struct lua_State *L)
 	return 1;
 }
 
+/** Push a table with percentiles of a latency counter, in seconds. */
+static void
+push_latency(struct lua_State *L, const char *name, struct latency *latency)
+{
+	lua_pushstring(L, name);
+	lua_createtable(L, 0, 3);
+	lua_pushnumber(L, latency_get_permille(latency, 500));
+	lua_setfield(L, -2, "p50");
+	lua_pushnumber(L, latency_get_permille(latency, 990));
+	lua_setfield(L, -2, "p99");
+	lua_pushnumber(L, latency_get_permille(latency, 999));
+	lua_setfield(L, -2, "p999");
+	lua_settable(L, -3);
+}
+
+/* box.stat.latency() */
+static int
+lbox_stat_latency(struct lua_State *L)
+{
+	lua_newtable(L);
+	for (uint32_t type = 0; type < iproto_type_MAX; type++) {
+		struct iproto_req_latency *lat = iproto_req_latency(type);
+		if (lat == NULL || lat->queue.histogram->total == 0)
+			continue;
+		lua_pushstring(L, iproto_type_name(type));
+		lua_createtable(L, 0, 4);
+		lua_pushstring(L, "total");
+		luaL_pushuint64(L, lat->queue.histogram->total);
+		lua_settable(L, -3);
+		push_latency(L, "queue", &lat->queue);
+		push_latency(L, "tx", &lat->tx);
+		push_latency(L, "wal", &lat->wal);
+		lua_settable(L, -3);
+	}
+	return 1;
+}
+
+/** Push the counters of operation statistics to a Lua table. */
+static void
+push_op_stat_select(struct lua_State *L, struct op_stat *stat)
+{
+	lua_pushstring(L, "select");
+	luaL_pushuint64(L, stat->select_count);
+	lua_settable(L, -3);
+	lua_pushstring(L, "scanned");
+	luaL_pushuint64(L, stat->scanned_count);
+	lua_settable(L, -3);
+	lua_pushstring(L, "returned");
+	luaL_pushuint64(L, stat->returned_count);
+	lua_settable(L, -3);
+	push_latency(L, "select_latency", &stat->select_latency);
+}
+
+static int
+lbox_stat_space_cb(struct space *space, void *arg)
+{
+	struct lua_State *L = arg;
+	if (space->op_stat == NULL)
+		return 0;
+	struct op_stat *stat = space->op_stat;
+	lua_pushstring(L, space_name(space));
+	lua_newtable(L);
+	push_op_stat_select(L, stat);
+	lua_pushstring(L, "write");
+	luaL_pushuint64(L, stat->write_count);
+	lua_settable(L, -3);
+	lua_pushstring(L, "write_bytes");
+	luaL_pushuint64(L, stat->write_bytes);
+	lua_settable(L, -3);
+	push_latency(L, "write_latency", &stat->write_latency);
+	lua_pushstring(L, "index");
+	lua_newtable(L);
+	for (uint32_t i = 0; i < space->index_count; i++) {
+		struct index *index = space->index[i];
+		if (index->op_stat == NULL)
+			continue;
+		lua_pushstring(L, index->def->name);
+		lua_newtable(L);
+		push_op_stat_select(L, index->op_stat);
+		lua_settable(L, -3);
+	}
+	lua_settable(L, -3);
+	lua_settable(L, -3);
+	return 0;
+}
+
+/* box.stat.space() */
+static int
+lbox_stat_space(struct lua_State *L)
+{
+	if (!op_stat_is_enabled) {
+		return luaL_error(L, "box.stat.space() is disabled. Enable it "
+				     "with box.stat.space_enable() first");
+	}
+	lua_newtable(L);
+	if (space_foreach(lbox_stat_space_cb, L) != 0)
+		return luaT_error(L);
+	return 1;
+}
+
+static int
+lbox_stat_space_enable(struct lua_State *L)
+{
+	(void)L;
+	op_stat_enable();
+	return 0;
+}
+
+static int
+lbox_stat_space_disable(struct lua_State *L)
+{
+	(void)L;
+	op_stat_disable();
+	return 0;
+}
+
+/* box.stat.hot_keys_enable([sample_interval]) */
+static int
+lbox_stat_hot_keys_enable(struct lua_State *L)
+{
+	lua_Integer interval = 100;
+	if (!lua_isnoneornil(L, 1)) {
+		interval = luaL_checkinteger(L, 1);
+		if (interval <= 0 || interval > UINT32_MAX) {
+			return luaL_error(L, "Usage: "
+					  "box.stat.hot_keys_enable("
+					  "[sample_interval]), sample_interval "
+					  "must be a positive integer");
+		}
+	}
+	hot_key_enable(interval);
+	return 0;
+}
+
+static int
+lbox_stat_hot_keys_disable(struct lua_State *L)
+{
+	(void)L;
+	hot_key_disable();
+	return 0;
+}
+
+/* box.stat.slow_requests_enable(threshold[, sample_interval]) */
+static int
+lbox_stat_slow_requests_enable(struct lua_State *L)
+{
+	static const char usage[] = "Usage: box.stat.slow_requests_enable("
+				    "threshold[, sample_interval]), threshold "
+				    "must be a non-negative number, "
+				    "sample_interval must be a positive integer";
+	if (lua_type(L, 1) != LUA_TNUMBER || lua_tonumber(L, 1) < 0)
+		return luaL_error(L, "%s", usage);
+	double threshold = lua_tonumber(L, 1);
+	lua_Integer interval = 1;
+	if (!lua_isnoneornil(L, 2)) {
+		interval = luaL_checkinteger(L, 2);
+		if (interval <= 0 || interval > UINT32_MAX)
+			return luaL_error(L, "%s", usage);
+	}
+	slow_request_enable(threshold, interval);
+	return 0;
+}
+
+static int
+lbox_stat_slow_requests_disable(struct lua_State *L)
+{
+	(void)L;
+	slow_request_disable();
+	return 0;
+}
+
+/* box.stat.slow_requests() */
+static int
+lbox_stat_slow_requests(struct lua_State *L)
+{
+	uint32_t count = slow_request_count();
+	lua_createtable(L, count, 0);
+	for (uint32_t i = 0; i < count; i++) {
+		const struct slow_request *req = slow_request_get(i);
+		lua_createtable(L, 0, 14);
+		lua_pushnumber(L, req->time);
+		lua_setfield(L, -2, "time");
+		lua_pushstring(L, iproto_type_name(req->type));
+		lua_setfield(L, -2, "request");
+		luaL_pushuint64(L, req->sync);
+		lua_setfield(L, -2, "sync");
+		luaL_pushuint64(L, req->session_id);
+		lua_setfield(L, -2, "session_id");
+		if (req->space_id != 0) {
+			lua_pushinteger(L, req->space_id);
+			lua_setfield(L, -2, "space_id");
+			lua_pushinteger(L, req->index_id);
+			lua_setfield(L, -2, "index_id");
+		}
+		if (req->func[0] != '\0') {
+			lua_pushstring(L, req->func);
+			lua_setfield(L, -2, "func");
+		}
+		lua_pushnumber(L, req->total);
+		lua_setfield(L, -2, "total");
+		lua_pushnumber(L, req->queue);
+		lua_setfield(L, -2, "queue");
+		lua_pushnumber(L, req->tx);
+		lua_setfield(L, -2, "tx");
+		lua_pushnumber(L, req->wal);
+		lua_setfield(L, -2, "wal");
+		lua_pushnumber(L, req->limbo);
+		lua_setfield(L, -2, "limbo");
+		luaL_pushuint64(L, req->lookups);
+		lua_setfield(L, -2, "lookups");
+		luaL_pushuint64(L, req->scanned);
+		lua_setfield(L, -2, "scanned");
+		lua_rawseti(L, -2, i + 1);
+	}
+	return 1;
+}
+
 static int
 lbox_stat_reset(struct lua_State *L)
 {
 	(void)L;
 	box_reset_stat();
 	iproto_reset_stat();
+	op_stat_reset();
+	hot_key_reset();
+	slow_request_reset();
 	return 0;
 }
 
@@ -221,10 +530,24 @@ static int
 lbox_stat_net_index(struct lua_State *L)
 {
 	const char *key = luaL_checkstring(L, -1);
+	struct iproto_stats stats;
+	if (strcmp(key, "BATCH_SIZE") == 0) {
+		iproto_stats_get(&stats);
+		push_batch_size_stat(L, &stats);
+		return 1;
+	}
+	if (strcmp(key, "MSG_MAX") == 0) {
+		iproto_stats_get(&stats);
+		push_msg_max_stat(L, &stats);
+		return 1;
+	}
+	if (strcmp(key, "TX_FIBERS") == 0) {
+		push_tx_fibers_stat(L);
+		return 1;
+	}
 	if (iproto_rmean_foreach(seek_stat_item, L) == 0)
 		return 0;
 
-	struct iproto_stats stats;
 	iproto_stats_get(&stats);
 	if (strcmp(key, "CONNECTIONS") == 0) {
 		lua_pushstring(L, "current");
@@ -261,7 +584,11 @@ lbox_stat_net_index(struct lua_State *L)
  * - STREAMS: total, rps, current;
  * - REQUESTS: total, rps, current;
  * - REQUESTS_IN_PROGRESS: total, rps, current;
- * - REQUESTS_IN_STREAM_QUEUE: total, rps, current.
+ * - REQUESTS_IN_STREAM_QUEUE: total, rps, current;
+ * - BATCH_SIZE (of messages sent to tx thread): total, histogram;
+ * - MSG_MAX (limit on requests in flight): total, current;
+ * - TX_FIBERS (tx fibers handling requests): total, current, wait_time,
+ *   size, limit.
  *
  * These fields have the following meaning:
  *
@@ -278,6 +605,8 @@ lbox_stat_net_call(struct lua_State *L)
 	struct iproto_stats stats;
 	iproto_stats_get(&stats);
 	inject_iproto_stats(L, &stats);
+	push_tx_fibers_stat(L);
+	lua_setfield(L, -2, "TX_FIBERS");
 	return 1;
 }
 
@@ -365,6 +694,15 @@ box_lua_stat_init(struct lua_State *L)
 {
 	static const struct luaL_Reg statlib [] = {
 		{"vinyl", lbox_stat_vinyl},
+		{"latency", lbox_stat_latency},
+		{"space", lbox_stat_space},
+		{"space_enable", lbox_stat_space_enable},
+		{"space_disable", lbox_stat_space_disable},
+		{"hot_keys_enable", lbox_stat_hot_keys_enable},
+		{"hot_keys_disable", lbox_stat_hot_keys_disable},
+		{"slow_requests", lbox_stat_slow_requests},
+		{"slow_requests_enable", lbox_stat_slow_requests_enable},
+		{"slow_requests_disable", lbox_stat_slow_requests_disable},
 		{"reset", lbox_stat_reset},
 		{"sql", lbox_stat_sql},
 		{NULL, NULL}
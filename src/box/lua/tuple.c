@@ -46,6 +46,7 @@
 #include "box/errcode.h"
 #include "json/json.h"
 #include "mpstream/mpstream.h"
+#include "mpstream/mp_json.h"
 
 /** {{{ box.tuple Lua library
  *
@@ -309,6 +310,41 @@ lbox_tuple_new(lua_State *L)
 	return 1;
 }
 
+/**
+ * Create a tuple from a JSON document directly, without decoding it
+ * to a Lua table first: box.tuple.new_from_json(json, [format]).
+ */
+static int
+lbox_tuple_new_from_json(struct lua_State *L)
+{
+	size_t len;
+	const char *json = luaL_checklstring(L, 1, &len);
+	struct tuple_format *format;
+	if (lua_isnoneornil(L, 2))
+		format = box_tuple_format_default();
+	else
+		format = luaT_check_tuple_format(L, 2);
+	struct tuple *tuple = NULL;
+	struct ibuf *buf = cord_ibuf_take();
+	struct mpstream stream;
+	mpstream_init(&stream, buf, ibuf_reserve_cb, ibuf_alloc_cb,
+		      luamp_error, L);
+	if (mpstream_encode_json(&stream, json, len) != 0)
+		goto cleanup;
+	mpstream_flush(&stream);
+	if (mp_typeof(*buf->buf) != MP_ARRAY) {
+		diag_set(ClientError, ER_TUPLE_NOT_ARRAY);
+		goto cleanup;
+	}
+	tuple = box_tuple_new(format, buf->buf, buf->buf + ibuf_used(buf));
+cleanup:
+	cord_ibuf_put(buf);
+	if (tuple == NULL)
+		return luaT_error(L);
+	luaT_pushtuple(L, tuple);
+	return 1;
+}
+
 static int
 lbox_tuple_gc(struct lua_State *L)
 {
@@ -554,6 +590,26 @@ lbox_tuple_to_map(struct lua_State *L)
 	return 1;
 }
 
+/** Encode a tuple as a JSON array without converting it to Lua. */
+static int
+lbox_tuple_to_json(struct lua_State *L)
+{
+	struct tuple *tuple = luaT_checktuple(L, 1);
+	const char *data = tuple_data(tuple);
+	struct ibuf *buf = cord_ibuf_take();
+	struct mpstream stream;
+	mpstream_init(&stream, buf, ibuf_reserve_cb, ibuf_alloc_cb,
+		      luamp_error, L);
+	int rc = mpstream_encode_mp_as_json(&stream, &data);
+	mpstream_flush(&stream);
+	if (rc == 0)
+		lua_pushlstring(L, buf->buf, ibuf_used(buf));
+	cord_ibuf_put(buf);
+	if (rc != 0)
+		return luaT_error(L);
+	return 1;
+}
+
 /**
  * Tuple transforming function.
  *
@@ -763,8 +819,10 @@ static const struct luaL_Reg lbox_tuple_meta[] = {
 	{"slice", lbox_tuple_slice},
 	{"transform", lbox_tuple_transform},
 	{"tuple_to_map", lbox_tuple_to_map},
+	{"tuple_to_json", lbox_tuple_to_json},
 	{"tuple_field_by_path", lbox_tuple_field_by_path},
 	{"new", lbox_tuple_new},
+	{"new_from_json", lbox_tuple_new_from_json},
 	{"info", lbox_tuple_info},
 	{NULL, NULL}
 };
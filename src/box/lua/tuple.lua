@@ -6,6 +6,7 @@ local fun = require('fun')
 local buffer = require('buffer')
 local compat = require('compat')
 local utils = require('internal.utils')
+local table_new = require('table.new')
 
 local internal = box.internal
 local cord_ibuf_take = buffer.internal.cord_ibuf_take
@@ -78,6 +79,13 @@ local NEW_OPTION_TYPES = {
     end
 }
 
+local function normalize_format(format)
+    if box.tuple.format.is(format) then
+        return format
+    end
+    return box.tuple.format.new(format)
+end
+
 local new_tuple = function(...)
     if compat.box_tuple_new_vararg:is_old() then
         return internal.tuple.new{...}
@@ -90,13 +98,19 @@ local new_tuple = function(...)
     if options == nil then
         return internal.tuple.new(tuple)
     end
-    local format
-    if box.tuple.format.is(options.format) then
-        format = options.format
-    else
-        format = box.tuple.format.new(options.format)
+    return internal.tuple.new(tuple, normalize_format(options.format))
+end
+
+local new_tuple_from_json = function(json, options)
+    if type(json) ~= 'string' then
+        error("Usage: box.tuple.new_from_json(json[, options])", 2)
+    end
+    check_param_table(options, NEW_OPTION_TYPES)
+    if options == nil then
+        return internal.tuple.new_from_json(json)
     end
-    return internal.tuple.new(tuple, format)
+    return internal.tuple.new_from_json(json,
+                                        normalize_format(options.format))
 end
 
 local is_tuple = function(tuple)
@@ -216,31 +230,31 @@ end
 
 local function tuple_totable(tuple, i, j)
     tuple_check(tuple, "tuple:totable([from[, to]])");
-    local it = tuple_iterator(tuple)
-    builtin.box_tuple_rewind(it)
-    local field
     if i ~= nil then
         if i < 1 then
             error('tuple.totable: invalid second argument')
         end
-        field = builtin.box_tuple_seek(it, i - 1)
     else
         i = 1
-        field = builtin.box_tuple_next(it)
     end
+    local field_count = builtin.box_tuple_field_count(tuple)
     if j ~= nil then
         if j <= 0 then
             error('tuple.totable: invalid third argument')
         end
+        j = math.min(j, field_count)
     else
-        j = 4294967295
+        j = field_count
     end
-    local ret = {}
-    while field ~= nil and i <= j do
-        local val = msgpackffi.decode_unchecked(field)
-        table.insert(ret, val)
-        i = i + 1
-        field = builtin.box_tuple_next(it)
+    -- Sequential box_tuple_field() calls continue decoding from the
+    -- previous field, so this is as cheap as using an iterator.
+    local ret = table_new(math.max(j - i + 1, 0), 0)
+    for n = i, j do
+        local field = builtin.box_tuple_field(tuple, n - 1)
+        if field == nil then
+            break
+        end
+        ret[n - i + 1] = (msgpackffi.decode_unchecked(field))
     end
     return setmetatable(ret, msgpackffi.array_mt)
 end
@@ -333,6 +347,7 @@ local methods = {
     ["upsert"]      = tuple_upsert;
     ["bsize"]       = tuple_bsize;
     ["tomap"]       = internal.tuple.tuple_to_map;
+    ["tojson"]      = internal.tuple.tuple_to_json;
     ["info"]        = internal.tuple.info;
 }
 
@@ -393,6 +408,7 @@ ffi.metatype(tuple_iterator_t, {
 internal.tuple.slice = nil
 internal.tuple.transform = nil
 internal.tuple.tuple_to_map = nil
+internal.tuple.tuple_to_json = nil
 internal.tuple.tostring = nil
 
 -- internal api for box.select and iterators
@@ -404,6 +420,7 @@ internal.tuple.encode = tuple_encode
 -- new() needs a wrapper in Lua, because format normalization needs to be done
 -- in Lua.
 box.tuple.new = new_tuple
+box.tuple.new_from_json = new_tuple_from_json
 
 -- is() is implemented in Lua, because then it is
 -- easy to be JITed.
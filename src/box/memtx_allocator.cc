@@ -232,3 +232,18 @@ memtx_allocators_stats(struct memtx_allocator_stats *stats)
 	memtx_allocator_stats_create(stats);
 	foreach_memtx_allocator<memtx_allocator_add_stats>(*stats);
 }
+
+struct memtx_allocator_reset_stats {
+	/** Resets allocator statistics. */
+	template<typename Allocator>
+	void invoke()
+	{
+		Allocator::reset_stats();
+	}
+};
+
+void
+memtx_allocators_reset_stats()
+{
+	foreach_memtx_allocator<memtx_allocator_reset_stats>();
+}
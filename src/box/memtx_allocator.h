@@ -182,6 +182,11 @@ struct memtx_allocator_stats {
 	size_t used_total;
 	/** Size of memory held for read views. */
 	size_t used_rv;
+	/**
+	 * Max size of memory held for read views since the statistics
+	 * were reset.
+	 */
+	size_t used_rv_max;
 	/** Size of memory freed on demand. */
 	size_t used_gc;
 };
@@ -191,6 +196,7 @@ memtx_allocator_stats_create(struct memtx_allocator_stats *stats)
 {
 	stats->used_total = 0;
 	stats->used_rv = 0;
+	stats->used_rv_max = 0;
 	stats->used_gc = 0;
 }
 
@@ -201,6 +207,7 @@ memtx_allocator_stats_add(struct memtx_allocator_stats *dst,
 {
 	dst->used_total += src->used_total;
 	dst->used_rv += src->used_rv;
+	dst->used_rv_max += src->used_rv_max;
 	dst->used_gc += src->used_gc;
 }
 
@@ -235,6 +242,14 @@ class MemtxAllocator {
 		}
 	}
 
+	/**
+	 * Resets the statistics that are accumulated over time.
+	 */
+	static void reset_stats()
+	{
+		stats.used_rv_max = stats.used_rv;
+	}
+
 	/**
 	 * Sets read_view_reuse_interval. Useful for testing.
 	 */
@@ -285,6 +300,18 @@ class MemtxAllocator {
 		::free(rv);
 	}
 
+	/**
+	 * Returns true if there's at least one open read view.
+	 */
+	static bool has_read_views()
+	{
+		for (int type = 0; type < memtx_tuple_rv_type_MAX; type++) {
+			if (!rlist_empty(&read_views[type]))
+				return true;
+		}
+		return false;
+	}
+
 	/**
 	 * Allocate a tuple of the given size.
 	 */
@@ -327,6 +354,8 @@ class MemtxAllocator {
 			free(memtx_tuple, size);
 		} else {
 			stats.used_rv += size;
+			if (stats.used_rv > stats.used_rv_max)
+				stats.used_rv_max = stats.used_rv;
 			memtx_tuple_rv_add(rv, memtx_tuple, size);
 		}
 	}
@@ -480,6 +509,10 @@ memtx_allocators_close_read_view(memtx_allocators_read_view rv);
 void
 memtx_allocators_stats(struct memtx_allocator_stats *stats);
 
+/** Resets accumulated statistics of all MemtxAllocators. */
+void
+memtx_allocators_reset_stats();
+
 template<class F, class...Arg>
 static void
 foreach_memtx_allocator(Arg&&...arg)
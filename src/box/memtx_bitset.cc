@@ -510,6 +510,7 @@ static const struct index_vtab memtx_bitset_index_vtab = {
 	/* .count = */ memtx_bitset_index_count,
 	/* .get_internal = */ generic_index_get_internal,
 	/* .get = */ generic_index_get,
+	/* .prefetch = */ generic_index_prefetch,
 	/* .replace = */ memtx_bitset_index_replace,
 	/* .create_iterator = */ memtx_bitset_index_create_iterator,
 	/* .create_read_view = */ generic_index_create_read_view,
@@ -519,6 +520,7 @@ static const struct index_vtab memtx_bitset_index_vtab = {
 	/* .begin_build = */ generic_index_begin_build,
 	/* .reserve = */ generic_index_reserve,
 	/* .build_next = */ generic_index_build_next,
+	/* .build_next_batch = */ generic_index_build_next_batch,
 	/* .end_build = */ generic_index_end_build,
 };
 
@@ -35,6 +35,7 @@
 #include <small/mempool.h>
 
 #include "fiber.h"
+#include "cbus.h"
 #include "errinj.h"
 #include "coio_task.h"
 #include "info/info.h"
@@ -46,6 +47,7 @@
 #include "xrow.h"
 #include "xstream.h"
 #include "bootstrap.h"
+#include "box.h"
 #include "replication.h"
 #include "schema.h"
 #include "space.h"
@@ -62,7 +64,12 @@
 #include "memtx_space_upgrade.h"
 #include "tt_sort.h"
 #include "assoc.h"
+#include "tt_pthread.h"
+#include "bit/bit.h"
 
+#include <inttypes.h>
+#include <stdio.h>
+#include <sys/mman.h>
 #include <type_traits>
 
 /* sync snapshot every 16MB */
@@ -88,11 +95,19 @@ static inline struct tuple *
 memtx_tuple_new_raw_impl(struct tuple_format *format, const char *data,
 			 const char *end, bool validate);
 
+struct tuple *
+(*memtx_tuple_clone)(struct tuple *tuple);
+
+template <class ALLOC>
+static struct tuple *
+memtx_tuple_clone_impl(struct tuple *tuple);
+
 template <class ALLOC>
 static void
 memtx_alloc_init(void)
 {
 	memtx_tuple_new_raw = memtx_tuple_new_raw_impl<ALLOC>;
+	memtx_tuple_clone = memtx_tuple_clone_impl<ALLOC>;
 }
 
 static int
@@ -108,6 +123,11 @@ memtx_end_build_primary_key(struct space *space, void *param)
 	return 0;
 }
 
+enum {
+	/** Number of tuples passed to index_build_next_batch() at once. */
+	MEMTX_BUILD_BATCH_SIZE = 1024,
+};
+
 /**
  * Build memtx secondary index based on the contents of primary index.
  */
@@ -133,18 +153,33 @@ memtx_build_secondary_index(struct index *index, struct index *pk)
 	if (it == NULL)
 		return -1;
 
+	/*
+	 * Tuples are passed to the index in batches so that it can
+	 * amortize per-tuple costs, e.g. of calling the function of
+	 * a functional index.
+	 */
+	struct tuple **batch = (struct tuple **)xmalloc(
+		MEMTX_BUILD_BATCH_SIZE * sizeof(*batch));
+	uint32_t batch_size = 0;
 	int rc = 0;
 	while (true) {
 		struct tuple *tuple;
 		rc = iterator_next_internal(it, &tuple);
 		if (rc != 0)
 			break;
+		if (tuple != NULL)
+			batch[batch_size++] = tuple;
+		if (batch_size == MEMTX_BUILD_BATCH_SIZE ||
+		    (tuple == NULL && batch_size > 0)) {
+			rc = index_build_next_batch(index, batch, batch_size);
+			if (rc != 0)
+				break;
+			batch_size = 0;
+		}
 		if (tuple == NULL)
 			break;
-		rc = index_build_next(index, tuple);
-		if (rc != 0)
-			break;
 	}
+	free(batch);
 	iterator_delete(it);
 	if (rc != 0)
 		return -1;
@@ -153,6 +188,65 @@ memtx_build_secondary_index(struct index *index, struct index *pk)
 	return 0;
 }
 
+static int
+memtx_build_secondary_index_f(va_list ap)
+{
+	struct index *index = va_arg(ap, struct index *);
+	struct index *pk = va_arg(ap, struct index *);
+	return memtx_build_secondary_index(index, pk);
+}
+
+/**
+ * Build all secondary indexes of a space. Each index is built by its own
+ * fiber so that while one index is sorted by worker threads, keys of
+ * another one are collected in tx.
+ */
+static int
+memtx_build_secondary_indexes(struct space *space)
+{
+	struct index *pk = space->index[0];
+	uint32_t count = space->index_count - 1;
+	if (count == 1)
+		return memtx_build_secondary_index(space->index[1], pk);
+
+	struct fiber **fibers = (struct fiber **)xcalloc(count,
+							 sizeof(*fibers));
+	struct diag diag;
+	diag_create(&diag);
+	uint32_t started = 0;
+	for (; started < count; started++) {
+		struct index *index = space->index[started + 1];
+		char name[FIBER_NAME_MAX];
+		snprintf(name, sizeof(name), "build.%s", index->def->name);
+		struct fiber *f = fiber_new_system(
+			name, memtx_build_secondary_index_f);
+		if (f == NULL) {
+			diag_move(diag_get(), &diag);
+			break;
+		}
+		fiber_set_joinable(f, true);
+		fiber_start(f, index, pk);
+		fibers[started] = f;
+	}
+	/* Keep the first error. */
+	for (uint32_t i = 0; i < started; i++) {
+		if (fiber_join(fibers[i]) == 0)
+			continue;
+		if (diag_is_empty(&diag))
+			diag_move(diag_get(), &diag);
+		else
+			diag_log();
+	}
+	free(fibers);
+	int rc = 0;
+	if (!diag_is_empty(&diag)) {
+		diag_move(&diag, diag_get());
+		rc = -1;
+	}
+	diag_destroy(&diag);
+	return rc;
+}
+
 /**
  * Secondary indexes are built in bulk after all data is
  * recovered. This function enables secondary keys on a space.
@@ -177,11 +271,8 @@ memtx_build_secondary_keys(struct space *space, void *param)
 				 space_name(space));
 		}
 
-		for (uint32_t j = 1; j < space->index_count; j++) {
-			if (memtx_build_secondary_index(space->index[j],
-							pk) < 0)
-				return -1;
-		}
+		if (memtx_build_secondary_indexes(space) != 0)
+			return -1;
 
 		if (n_tuples > 0) {
 			say_info("Space '%s': done", space_name(space));
@@ -201,14 +292,15 @@ memtx_engine_free(struct engine *engine)
 	mempool_destroy(&memtx->index_extent_pool);
 	slab_cache_destroy(&memtx->index_slab_cache);
 	/*
-	 * The last blessed tuple may refer to a memtx tuple, which would
-	 * become inaccessible once we destroyed the arena, so we need to
-	 * clear it first.
+	 * The last blessed tuple and the tuple cached by box_tuple_field()
+	 * may refer to a memtx tuple, which would become inaccessible once
+	 * we destroyed the arena, so we need to clear them first.
 	 */
 	if (box_tuple_last != NULL) {
 		tuple_unref(box_tuple_last);
 		box_tuple_last = NULL;
 	}
+	tuple_field_cache_reset();
 	/*
 	 * The order is vital: allocator destroy should take place before
 	 * slab cache destroy!
@@ -218,6 +310,8 @@ memtx_engine_free(struct engine *engine)
 	tuple_arena_destroy(&memtx->arena);
 
 	xdir_destroy(&memtx->snap_dir);
+	if (memtx->checkpoint_layout != NULL)
+		checkpoint_layout_delete(memtx->checkpoint_layout);
 	tuple_format_unref(memtx->func_key_format);
 	free(memtx);
 }
@@ -247,30 +341,36 @@ static int
 memtx_engine_recover_snapshot_row(struct xrow_header *row,
 				  enum snapshot_recovery_state *state);
 
-int
-memtx_engine_recover_snapshot(struct memtx_engine *memtx,
-			      const struct vclock *vclock)
-{
-	/* Process existing snapshot */
-	say_info("recovery start");
-	int64_t signature = vclock_sum(vclock);
-	const char *filename = xdir_format_filename(&memtx->snap_dir,
-						    signature, NONE);
-
-	say_info("recovering from `%s'", filename);
-	struct xlog_cursor cursor;
-	if (xlog_cursor_open(&cursor, filename) < 0)
-		return -1;
+/**
+ * Recovers one decoded INSERT request from snapshot.
+ *
+ * @retval -1 error, diagnostic set
+ * @retval 0 success
+ */
+static int
+memtx_engine_recover_snapshot_request(struct request *request,
+				      enum snapshot_recovery_state *state);
 
+/**
+ * Recovers all rows from the main snapshot file opened with @a cursor.
+ *
+ * @retval -1 error, diagnostic set
+ * @retval 0 success
+ */
+static int
+memtx_engine_recover_snapshot_file(struct memtx_engine *memtx,
+				   struct xlog_cursor *cursor,
+				   int64_t signature,
+				   enum snapshot_recovery_state *state,
+				   uint64_t *row_count)
+{
 	int rc;
 	struct xrow_header row;
-	uint64_t row_count = 0;
 	bool force_recovery = false;
-	enum snapshot_recovery_state state = SNAPSHOT_RECOVERY_NOT_STARTED;
-	while ((rc = xlog_cursor_next(&cursor, &row, force_recovery)) == 0) {
+	while ((rc = xlog_cursor_next(cursor, &row, force_recovery)) == 0) {
 		row.lsn = signature;
-		rc = memtx_engine_recover_snapshot_row(&row, &state);
-		if (state == DONE_RECOVERING_SYSTEM_SPACES)
+		rc = memtx_engine_recover_snapshot_row(&row, state);
+		if (*state == DONE_RECOVERING_SYSTEM_SPACES)
 			force_recovery = memtx->force_recovery;
 		if (rc < 0) {
 			if (!force_recovery)
@@ -278,14 +378,13 @@ memtx_engine_recover_snapshot(struct memtx_engine *memtx,
 			say_error("can't apply row: ");
 			diag_log();
 		}
-		++row_count;
-		if (row_count % 100000 == 0) {
+		++*row_count;
+		if (*row_count % 100000 == 0) {
 			say_info_ratelimited("%.1fM rows processed",
-					     row_count / 1e6);
+					     *row_count / 1e6);
 			fiber_yield_timeout(0);
 		}
 	}
-	xlog_cursor_close(&cursor, false);
 	if (rc < 0)
 		return -1;
 
@@ -294,12 +393,359 @@ memtx_engine_recover_snapshot(struct memtx_engine *memtx,
 	 * marker - such snapshots are very likely corrupted and
 	 * should not be trusted.
 	 */
-	if (!xlog_cursor_is_eof(&cursor)) {
+	if (!xlog_cursor_is_eof(cursor)) {
+		if (!memtx->force_recovery)
+			panic("snapshot `%s' has no EOF marker", cursor->name);
+		else
+			say_error("snapshot `%s' has no EOF marker",
+				  cursor->name);
+	}
+	return 0;
+}
+
+enum {
+	/** Max number of rows decoded by a partition reader in one go. */
+	SNAPSHOT_PARTITION_BATCH_SIZE = 1024,
+};
+
+struct snapshot_partition_recovery;
+
+/**
+ * Snapshot partition reader. Partition files are read, decoded and
+ * validated by reader threads, one per partition, while tx fibers apply
+ * decoded rows to spaces. Since partitions contain disjoint sets of user
+ * spaces, they are applied concurrently.
+ */
+struct snapshot_partition_reader {
+	/** Recovery this reader belongs to. */
+	struct snapshot_partition_recovery *recovery;
+	/** Reader thread. */
+	struct cord cord;
+	/** Pipe from tx to the reader thread. */
+	struct cpipe reader_pipe;
+	/** Pipe from the reader thread to tx. */
+	struct cpipe tx_pipe;
+	/** Message used for calls to the reader thread. */
+	struct cbus_call_msg msg;
+	/** Tx fiber applying rows read from the partition. */
+	struct fiber *fiber;
+	/** Partition file name. */
+	char filename[PATH_MAX];
+	/**
+	 * Partition file cursor. Opened and accessed only by the reader
+	 * thread, because the cursor buffers use the thread slab cache.
+	 */
+	struct xlog_cursor cursor;
+	/** Set if the cursor is open. */
+	bool cursor_is_open;
+	/** Set if the last row has been read from the partition. */
+	bool is_eof;
+	/** Region the row bodies of the current batch are copied to. */
+	struct region region;
+	/** Headers of the rows of the current batch. */
+	struct xrow_header rows[SNAPSHOT_PARTITION_BATCH_SIZE];
+	/** Requests decoded from the rows of the current batch. */
+	struct request requests[SNAPSHOT_PARTITION_BATCH_SIZE];
+	/** Number of rows in the current batch. */
+	int batch_size;
+};
+
+/** State shared by all readers of a partitioned snapshot. */
+struct snapshot_partition_recovery {
+	/** Memtx engine. */
+	struct memtx_engine *memtx;
+	/** The vclock of the snapshot. */
+	const struct vclock *vclock;
+	/** Set if a partition failed to recover. */
+	bool is_failed;
+	/** Number of rows recovered so far. */
+	uint64_t *row_count;
+};
+
+/** Partition reader thread function. */
+static int
+snapshot_partition_reader_f(va_list ap)
+{
+	struct snapshot_partition_reader *reader =
+		va_arg(ap, struct snapshot_partition_reader *);
+	struct cbus_endpoint endpoint;
+
+	region_create(&reader->region, cord_slab_cache());
+	cpipe_create(&reader->tx_pipe, "tx_prio");
+	cbus_endpoint_create(&endpoint, cord_name(cord()),
+			     fiber_schedule_cb, fiber());
+	cbus_loop(&endpoint);
+	cbus_endpoint_destroy(&endpoint, cbus_process);
+	cpipe_destroy(&reader->tx_pipe);
+	if (reader->cursor_is_open)
+		xlog_cursor_close(&reader->cursor, false);
+	region_destroy(&reader->region);
+	return 0;
+}
+
+/** Opens the partition file. Called in the reader thread. */
+static int
+snapshot_partition_open_cb(struct cbus_call_msg *base)
+{
+	struct snapshot_partition_reader *reader =
+		container_of(base, struct snapshot_partition_reader, msg);
+	if (xlog_cursor_openmap(&reader->cursor, reader->filename) < 0)
+		return -1;
+	reader->cursor_is_open = true;
+	/*
+	 * A partition that hasn't changed since an older snapshot is
+	 * a link to the partition file of that snapshot.
+	 */
+	int cmp = vclock_compare(&reader->cursor.meta.vclock,
+				 reader->recovery->vclock);
+	if (cmp != 0 && cmp != -1) {
+		diag_set(XlogError, "snapshot partition `%s' doesn't "
+			 "match the snapshot vclock", reader->filename);
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * Reads, decodes and validates the next batch of rows from the partition
+ * file. Called in the reader thread.
+ */
+static int
+snapshot_partition_read_cb(struct cbus_call_msg *base)
+{
+	struct snapshot_partition_reader *reader =
+		container_of(base, struct snapshot_partition_reader, msg);
+	bool force_recovery = reader->recovery->memtx->force_recovery;
+	int64_t signature = vclock_sum(reader->recovery->vclock);
+	region_free(&reader->region);
+	reader->batch_size = 0;
+	while (reader->batch_size < SNAPSHOT_PARTITION_BATCH_SIZE) {
+		struct xrow_header *row = &reader->rows[reader->batch_size];
+		int rc = xlog_cursor_next(&reader->cursor, row,
+					  force_recovery);
+		if (rc < 0)
+			return -1;
+		if (rc > 0) {
+			reader->is_eof = true;
+			break;
+		}
+		row->lsn = signature;
+		assert(row->bodycnt == 1); /* always 1 for read */
+		/*
+		 * The row body points to the cursor buffer, which is reused
+		 * when the next transaction is read, so copy it.
+		 */
+		size_t size = row->body[0].iov_len;
+		void *body = region_alloc(&reader->region, size);
+		if (body == NULL) {
+			diag_set(OutOfMemory, size, "region_alloc", "body");
+			return -1;
+		}
+		memcpy(body, row->body[0].iov_base, size);
+		row->body[0].iov_base = body;
+
+		struct request *request = &reader->requests[reader->batch_size];
+		if (row->type != IPROTO_INSERT) {
+			/* Partitions store only user space data. */
+			diag_set(ClientError, ER_UNKNOWN_REQUEST_TYPE,
+				 (uint32_t)row->type);
+			rc = -1;
+		} else {
+			rc = xrow_decode_dml(row, request,
+					     dml_request_key_map(row->type));
+		}
+		const char *data = request->tuple;
+		if (rc == 0 && mp_check(&data, request->tuple_end) != 0) {
+			diag_set(ClientError, ER_INVALID_MSGPACK,
+				 "snapshot row tuple");
+			rc = -1;
+		}
+		if (rc != 0) {
+			if (!force_recovery)
+				return -1;
+			say_error("can't decode row: ");
+			diag_log();
+			continue;
+		}
+		reader->batch_size++;
+	}
+	return 0;
+}
+
+/** Applies rows read from a partition file. Runs in a tx fiber. */
+static int
+snapshot_partition_recover_f(va_list ap)
+{
+	struct snapshot_partition_reader *reader =
+		va_arg(ap, struct snapshot_partition_reader *);
+	struct snapshot_partition_recovery *recovery = reader->recovery;
+	struct memtx_engine *memtx = recovery->memtx;
+	/* Partitions are recovered after system spaces. */
+	enum snapshot_recovery_state state = DONE_RECOVERING_SYSTEM_SPACES;
+	say_info("recovering from `%s'", reader->filename);
+	if (cbus_call(&reader->reader_pipe, &reader->tx_pipe, &reader->msg,
+		      snapshot_partition_open_cb) != 0)
+		goto fail;
+	while (!reader->is_eof) {
+		if (cbus_call(&reader->reader_pipe, &reader->tx_pipe,
+			      &reader->msg, snapshot_partition_read_cb) != 0)
+			goto fail;
+		/* Stop if another partition failed to recover. */
+		if (recovery->is_failed)
+			return 0;
+		for (int i = 0; i < reader->batch_size; i++) {
+			struct request *request = &reader->requests[i];
+			if (memtx_engine_recover_snapshot_request(
+					request, &state) != 0) {
+				if (!memtx->force_recovery)
+					goto fail;
+				say_error("can't apply row: ");
+				diag_log();
+			}
+			if (++*recovery->row_count % 100000 == 0) {
+				say_info_ratelimited("%.1fM rows processed",
+						*recovery->row_count / 1e6);
+			}
+		}
+	}
+	/* See memtx_engine_recover_snapshot_file(). */
+	if (!xlog_cursor_is_eof(&reader->cursor)) {
 		if (!memtx->force_recovery)
-			panic("snapshot `%s' has no EOF marker", cursor.name);
+			panic("snapshot `%s' has no EOF marker",
+			      reader->filename);
 		else
-			say_error("snapshot `%s' has no EOF marker", cursor.name);
+			say_error("snapshot `%s' has no EOF marker",
+				  reader->filename);
+	}
+	return 0;
+fail:
+	recovery->is_failed = true;
+	return -1;
+}
+
+/** Stops partition reader threads. */
+static void
+snapshot_partition_stop_readers(struct snapshot_partition_reader *readers,
+				uint32_t count)
+{
+	for (uint32_t i = 0; i < count; i++) {
+		struct snapshot_partition_reader *reader = &readers[i];
+		cbus_stop_loop(&reader->reader_pipe);
+		cpipe_destroy(&reader->reader_pipe);
+	}
+	for (uint32_t i = 0; i < count; i++) {
+		if (cord_join(&readers[i].cord) != 0)
+			panic_syserror("failed to join snapshot reader thread");
+	}
+}
+
+/**
+ * Recovers snapshot partition files written if memtx_checkpoint_threads
+ * was greater than 1. Partitions store only user spaces so they are
+ * recovered after the main snapshot file. Each partition is read by its
+ * own thread and applied by its own tx fiber.
+ */
+static int
+memtx_engine_recover_snapshot_partitions(struct memtx_engine *memtx,
+					 const struct vclock *vclock,
+					 uint32_t partition_count,
+					 uint64_t *row_count)
+{
+	int64_t signature = vclock_sum(vclock);
+	struct snapshot_partition_recovery recovery;
+	recovery.memtx = memtx;
+	recovery.vclock = vclock;
+	recovery.is_failed = false;
+	recovery.row_count = row_count;
+
+	struct snapshot_partition_reader *readers =
+		(struct snapshot_partition_reader *)xcalloc(
+			partition_count, sizeof(*readers));
+	uint32_t reader_count = 0;
+	int rc = 0;
+	for (; reader_count < partition_count; reader_count++) {
+		struct snapshot_partition_reader *reader =
+			&readers[reader_count];
+		reader->recovery = &recovery;
+		strlcpy(reader->filename,
+			xdir_format_partition_filename(&memtx->snap_dir,
+						       signature,
+						       reader_count + 1, NONE),
+			sizeof(reader->filename));
+		char name[FIBER_NAME_MAX];
+		snprintf(name, sizeof(name), "snapshot.reader.%u",
+			 (unsigned)reader_count + 1);
+		if (cord_costart(&reader->cord, name,
+				 snapshot_partition_reader_f, reader) != 0) {
+			rc = -1;
+			break;
+		}
+		cpipe_create(&reader->reader_pipe, name);
+	}
+
+	uint32_t fiber_count = 0;
+	for (; rc == 0 && fiber_count < reader_count; fiber_count++) {
+		struct snapshot_partition_reader *reader = &readers[fiber_count];
+		char name[FIBER_NAME_MAX];
+		snprintf(name, sizeof(name), "snapshot.recovery.%u",
+			 (unsigned)fiber_count + 1);
+		reader->fiber = fiber_new_system(name,
+						 snapshot_partition_recover_f);
+		if (reader->fiber == NULL) {
+			recovery.is_failed = true;
+			rc = -1;
+			break;
+		}
+		fiber_set_joinable(reader->fiber, true);
+		fiber_start(reader->fiber, reader);
+	}
+
+	/* Keep the first error. */
+	struct diag diag;
+	diag_create(&diag);
+	if (rc != 0)
+		diag_move(diag_get(), &diag);
+	for (uint32_t i = 0; i < fiber_count; i++) {
+		if (fiber_join(readers[i].fiber) != 0) {
+			rc = -1;
+			if (diag_is_empty(&diag))
+				diag_move(diag_get(), &diag);
+			else
+				diag_log();
+		}
 	}
+	snapshot_partition_stop_readers(readers, reader_count);
+	free(readers);
+	if (rc != 0)
+		diag_move(&diag, diag_get());
+	diag_destroy(&diag);
+	return rc;
+}
+
+int
+memtx_engine_recover_snapshot(struct memtx_engine *memtx,
+			      const struct vclock *vclock)
+{
+	/* Process existing snapshot */
+	say_info("recovery start");
+	int64_t signature = vclock_sum(vclock);
+	const char *filename = xdir_format_filename(&memtx->snap_dir,
+						    signature, NONE);
+
+	say_info("recovering from `%s'", filename);
+	struct xlog_cursor cursor;
+	if (xlog_cursor_openmap(&cursor, filename) < 0)
+		return -1;
+
+	double start = ev_monotonic_time();
+	uint64_t row_count = 0;
+	enum snapshot_recovery_state state = SNAPSHOT_RECOVERY_NOT_STARTED;
+	int rc = memtx_engine_recover_snapshot_file(memtx, &cursor, signature,
+						    &state, &row_count);
+	uint32_t partition_count = cursor.meta.partition_count;
+	xlog_cursor_close(&cursor, false);
+	if (rc < 0)
+		return -1;
 
 	/*
 	 * Snapshot entries are ordered by the space id, it means that if there
@@ -310,6 +756,13 @@ memtx_engine_recover_snapshot(struct memtx_engine *memtx,
 		return -1;
 	}
 
+	if (partition_count > 0 &&
+	    memtx_engine_recover_snapshot_partitions(memtx, vclock,
+						     partition_count,
+						     &row_count) != 0)
+		return -1;
+	memtx->recovery_stat.snapshot_rows = row_count;
+	memtx->recovery_stat.snapshot_time = ev_monotonic_time() - start;
 	return 0;
 }
 
@@ -381,13 +834,21 @@ memtx_engine_recover_snapshot_row(struct xrow_header *row,
 		return -1;
 	}
 	struct request request;
-	RegionGuard region_guard(&fiber()->gc);
 	if (xrow_decode_dml(row, &request, dml_request_key_map(row->type)) != 0)
 		return -1;
-	bool is_system_space_request = space_id_is_system(request.space_id);
+	return memtx_engine_recover_snapshot_request(&request, state);
+}
+
+static int
+memtx_engine_recover_snapshot_request(struct request *request,
+				      enum snapshot_recovery_state *state)
+{
+	assert(request->type == IPROTO_INSERT);
+	RegionGuard region_guard(&fiber()->gc);
+	bool is_system_space_request = space_id_is_system(request->space_id);
 	if (snapshot_recovery_state_update(state, is_system_space_request) != 0)
 		return -1;
-	struct space *space = space_cache_find(request.space_id);
+	struct space *space = space_cache_find(request->space_id);
 	if (space == NULL)
 		goto log_request;
 	/* memtx snapshot must contain only memtx spaces */
@@ -399,13 +860,13 @@ memtx_engine_recover_snapshot_row(struct xrow_header *row,
 	txn = txn_begin();
 	if (txn == NULL)
 		goto log_request;
-	if (txn_begin_stmt(txn, space, request.type) != 0)
+	if (txn_begin_stmt(txn, space, request->type) != 0)
 		goto rollback;
 	/* no access checks here - applier always works with admin privs */
 	struct tuple *unused;
-	if (space_execute_dml(space, txn, &request, &unused) != 0)
+	if (space_execute_dml(space, txn, request, &unused) != 0)
 		goto rollback_stmt;
-	if (txn_commit_stmt(txn, &request) != 0)
+	if (txn_commit_stmt(txn, request) != 0)
 		goto rollback;
 	/*
 	 * Snapshot rows are confirmed by definition. They don't need to go to
@@ -418,7 +879,7 @@ memtx_engine_recover_snapshot_row(struct xrow_header *row,
 rollback:
 	txn_abort(txn);
 log_request:
-	say_error("error at request: %s", request_str(&request));
+	say_error("error at request: %s", request_str(request));
 	return -1;
 }
 
@@ -444,6 +905,22 @@ memtx_engine_begin_initial_recovery(struct engine *engine,
 	return 0;
 }
 
+/**
+ * Builds secondary keys of all spaces after recovery of the primary
+ * keys and switches the engine to the normal operation mode.
+ */
+static int
+memtx_engine_build_secondary_keys(struct memtx_engine *memtx)
+{
+	double start = ev_monotonic_time();
+	memtx->state = MEMTX_OK;
+	if (space_foreach(memtx_build_secondary_keys, memtx) != 0)
+		return -1;
+	memtx->on_indexes_built_cb();
+	memtx->recovery_stat.sk_build_time = ev_monotonic_time() - start;
+	return 0;
+}
+
 static int
 memtx_engine_begin_final_recovery(struct engine *engine)
 {
@@ -453,7 +930,9 @@ memtx_engine_begin_final_recovery(struct engine *engine)
 
 	assert(memtx->state == MEMTX_INITIAL_RECOVERY);
 	/* End of the fast path: loaded the primary key. */
+	double start = ev_monotonic_time();
 	space_foreach(memtx_end_build_primary_key, memtx);
+	memtx->recovery_stat.pk_build_time = ev_monotonic_time() - start;
 
 	/* Complete space initialization. */
 	int rc = space_foreach(space_on_initial_recovery_complete, NULL);
@@ -478,10 +957,8 @@ memtx_engine_begin_final_recovery(struct engine *engine)
 		 * to detect and discard duplicates in
 		 * unique keys.
 		 */
-		memtx->state = MEMTX_OK;
-		if (space_foreach(memtx_build_secondary_keys, memtx) != 0)
+		if (memtx_engine_build_secondary_keys(memtx) != 0)
 			return -1;
-		memtx->on_indexes_built_cb();
 	}
 	return 0;
 }
@@ -497,10 +974,8 @@ memtx_engine_begin_hot_standby(struct engine *engine)
 	 */
 	if (memtx->state != MEMTX_OK) {
 		assert(memtx->state == MEMTX_FINAL_RECOVERY);
-		memtx->state = MEMTX_OK;
-		if (space_foreach(memtx_build_secondary_keys, memtx) != 0)
+		if (memtx_engine_build_secondary_keys(memtx) != 0)
 			return -1;
-		memtx->on_indexes_built_cb();
 	}
 	return 0;
 }
@@ -517,10 +992,8 @@ memtx_engine_end_recovery(struct engine *engine)
 	 */
 	if (memtx->state != MEMTX_OK) {
 		assert(memtx->state == MEMTX_FINAL_RECOVERY);
-		memtx->state = MEMTX_OK;
-		if (space_foreach(memtx_build_secondary_keys, memtx) != 0)
+		if (memtx_engine_build_secondary_keys(memtx) != 0)
 			return -1;
-		memtx->on_indexes_built_cb();
 	}
 	xdir_remove_temporary_files(&memtx->snap_dir);
 
@@ -646,8 +1119,14 @@ memtx_engine_rollback_statement(struct engine *engine, struct txn *txn,
 	if (space->upgrade != NULL && new_tuple != NULL)
 		memtx_space_upgrade_untrack_tuple(space->upgrade, new_tuple);
 
-	if (memtx_tx_manager_use_mvcc_engine)
+	if (memtx_tx_manager_use_mvcc_engine) {
+		/*
+		 * A prepared statement may have been written to a
+		 * snapshot, so the space must not be considered clean.
+		 */
+		memtx_space_mark_dirty(space);
 		return memtx_tx_history_rollback_stmt(stmt);
+	}
 
 	if (memtx_space->replace == memtx_space_replace_all_keys)
 		index_count = space->index_count;
@@ -766,6 +1245,69 @@ checkpoint_write_tuple(struct xlog *l, uint32_t space_id, uint32_t group_id,
 	return checkpoint_write_row(l, &row);
 }
 
+struct checkpoint;
+
+/**
+ * Snapshot partition. If memtx_checkpoint_threads > 1, user space
+ * data is split between several partition files, each written by
+ * its own thread. The main snapshot file stores system spaces and
+ * the number of partitions, see xlog_meta::partition_count.
+ */
+struct checkpoint_partition {
+	/** Checkpoint this partition belongs to. */
+	struct checkpoint *ckpt;
+	/** Partition number, starting from 1. */
+	uint32_t id;
+	/** Partition writer thread. */
+	struct cord cord;
+	/** New partition file. */
+	struct xlog snap;
+	/** Read views of user spaces written to this partition. */
+	struct space_read_view **spaces;
+	/** Number of entries in the spaces array. */
+	uint32_t space_count;
+	/** Total size of the spaces, used for balancing partitions. */
+	size_t bsize;
+	/**
+	 * Set if none of the partition spaces has changed since the
+	 * last snapshot so the partition file of that snapshot can be
+	 * linked instead of writing a new one.
+	 */
+	bool is_clean;
+};
+
+/** A space of a snapshot partition, see struct checkpoint_layout. */
+struct checkpoint_layout_space {
+	/** Space id. */
+	uint32_t id;
+	/** Partition number, starting from 1. */
+	uint32_t partition;
+};
+
+/**
+ * Partitions of a committed snapshot. Used for placing spaces
+ * to the same partitions on the next checkpoint so that the
+ * files of partitions that haven't changed can be reused.
+ */
+struct checkpoint_layout {
+	/** Signature of the snapshot. */
+	int64_t signature;
+	/**
+	 * Value of memtx_engine::space_version when the snapshot read
+	 * view was opened. Spaces with greater versions have changed
+	 * since the snapshot.
+	 */
+	uint64_t space_version;
+	/** Number of partitions of the snapshot. */
+	uint32_t partition_count;
+	/** Number of spaces in each partition. */
+	uint32_t *partition_sizes;
+	/** Spaces of the snapshot partitions, sorted by id. */
+	struct checkpoint_layout_space *spaces;
+	/** Number of entries in the spaces array. */
+	uint32_t space_count;
+};
+
 struct checkpoint {
 	/** Database read view written to the snapshot file. */
 	struct read_view rv;
@@ -777,6 +1319,22 @@ struct checkpoint {
 	struct xdir dir;
 	/** New snapshot file. */
 	struct xlog snap;
+	/** Partitions of the snapshot, may be empty. */
+	struct checkpoint_partition *partitions;
+	/** Number of entries in the partitions array. */
+	uint32_t partition_count;
+	/** Memory for partition space arrays. */
+	struct space_read_view **space_buf;
+	/**
+	 * Signature of the snapshot the files of clean partitions are
+	 * linked from, see checkpoint_partition::is_clean.
+	 */
+	int64_t base_signature;
+	/**
+	 * Value of memtx_engine::space_version when the read view was
+	 * opened.
+	 */
+	uint64_t space_version;
 	/** Raft request to be written to the snapshot file. */
 	struct raft_request raft;
 	/** Synchro request to be written to the snapshot file. */
@@ -852,29 +1410,247 @@ is_tuple_temporary(const char *data, uint32_t space_id,
 	}
 }
 
-static struct checkpoint *
-checkpoint_new(const char *snap_dirname, uint64_t snap_io_rate_limit)
+/** Returns the size of the space the given read view was created for. */
+static size_t
+checkpoint_space_bsize(struct space_read_view *space_rv)
 {
-	struct checkpoint *ckpt = (struct checkpoint *)malloc(sizeof(*ckpt));
-	if (ckpt == NULL) {
-		diag_set(OutOfMemory, sizeof(*ckpt), "malloc",
-			 "struct checkpoint");
-		return NULL;
+	struct space *space = space_by_id(space_rv->id);
+	return space != NULL ? space_bsize(space) : 0;
+}
+
+/** Comparator used for sorting spaces by size in descending order. */
+static int
+checkpoint_space_cmp_bsize(const void *a, const void *b)
+{
+	size_t size_a = checkpoint_space_bsize(*(struct space_read_view **)a);
+	size_t size_b = checkpoint_space_bsize(*(struct space_read_view **)b);
+	return size_a < size_b ? 1 : size_a > size_b ? -1 : 0;
+}
+
+/** Comparator used for sorting and looking up layout spaces by id. */
+static int
+checkpoint_layout_space_cmp(const void *a, const void *b)
+{
+	uint32_t id_a = ((const struct checkpoint_layout_space *)a)->id;
+	uint32_t id_b = ((const struct checkpoint_layout_space *)b)->id;
+	return id_a < id_b ? -1 : id_a > id_b ? 1 : 0;
+}
+
+/** Creates the layout of a committed partitioned checkpoint. */
+static struct checkpoint_layout *
+checkpoint_layout_new(struct checkpoint *ckpt)
+{
+	struct checkpoint_layout *layout = (struct checkpoint_layout *)
+		xcalloc(1, sizeof(*layout));
+	layout->signature = vclock_sum(&ckpt->vclock);
+	layout->space_version = ckpt->space_version;
+	layout->partition_count = ckpt->partition_count;
+	assert(layout->partition_count > 0);
+	layout->partition_sizes = (uint32_t *)
+		xcalloc(ckpt->partition_count,
+			sizeof(*layout->partition_sizes));
+	uint32_t space_count = 0;
+	for (uint32_t i = 0; i < ckpt->partition_count; i++) {
+		layout->partition_sizes[i] = ckpt->partitions[i].space_count;
+		space_count += ckpt->partitions[i].space_count;
 	}
-	struct read_view_opts rv_opts;
-	read_view_opts_create(&rv_opts);
-	rv_opts.name = "checkpoint";
-	rv_opts.is_system = true;
-	rv_opts.filter_space = checkpoint_space_filter;
-	rv_opts.filter_index = primary_index_filter;
-	if (read_view_open(&ckpt->rv, &rv_opts) != 0) {
-		free(ckpt);
-		return NULL;
+	layout->spaces = (struct checkpoint_layout_space *)
+		xcalloc(space_count, sizeof(*layout->spaces));
+	uint32_t k = 0;
+	for (uint32_t i = 0; i < ckpt->partition_count; i++) {
+		struct checkpoint_partition *part = &ckpt->partitions[i];
+		for (uint32_t j = 0; j < part->space_count; j++) {
+			layout->spaces[k].id = part->spaces[j]->id;
+			layout->spaces[k].partition = part->id;
+			k++;
+		}
+	}
+	assert(k == space_count);
+	layout->space_count = space_count;
+	qsort(layout->spaces, space_count, sizeof(*layout->spaces),
+	      checkpoint_layout_space_cmp);
+	return layout;
+}
+
+static void
+checkpoint_layout_delete(struct checkpoint_layout *layout)
+{
+	free(layout->partition_sizes);
+	free(layout->spaces);
+	free(layout);
+}
+
+/**
+ * Returns the number of the partition the space was written to or 0
+ * if the space wasn't written to any partition of the snapshot.
+ */
+static uint32_t
+checkpoint_layout_find(const struct checkpoint_layout *layout,
+		       uint32_t space_id)
+{
+	struct checkpoint_layout_space key;
+	key.id = space_id;
+	const struct checkpoint_layout_space *found =
+		(const struct checkpoint_layout_space *)
+		bsearch(&key, layout->spaces, layout->space_count,
+			sizeof(*layout->spaces), checkpoint_layout_space_cmp);
+	return found != NULL ? found->partition : 0;
+}
+
+/**
+ * Returns true if the space the given read view was created for hasn't
+ * changed since the snapshot described by @a layout.
+ */
+static bool
+checkpoint_space_is_clean(struct space_read_view *space_rv,
+			  const struct checkpoint_layout *layout)
+{
+	struct space *space = space_by_id(space_rv->id);
+	if (space == NULL || !space_is_memtx(space))
+		return false;
+	struct memtx_space *memtx_space = (struct memtx_space *)space;
+	return memtx_space->version <= layout->space_version;
+}
+
+/**
+ * Splits user spaces of the checkpoint read view between at most
+ * @a thread_count partitions. Spaces are assigned greedily, the
+ * biggest first, each to the partition with the least total size
+ * so that partition writers finish at about the same time.
+ * Partitions are not created if there are no user spaces.
+ *
+ * If @a layout is not NULL and has the same number of partitions,
+ * spaces written to the last snapshot keep their partitions. Then
+ * partitions that consist of the same spaces, none of which has
+ * changed since the last snapshot, are marked clean.
+ */
+static void
+checkpoint_create_partitions(struct checkpoint *ckpt, int thread_count,
+			     const struct checkpoint_layout *layout)
+{
+	uint32_t space_count = 0;
+	struct space_read_view *space_rv;
+	read_view_foreach_space(space_rv, &ckpt->rv) {
+		if (!space_id_is_system(space_rv->id))
+			space_count++;
+	}
+	if (space_count == 0)
+		return;
+	struct space_read_view **spaces = (struct space_read_view **)
+		xcalloc(space_count, sizeof(*spaces));
+	uint32_t i = 0;
+	read_view_foreach_space(space_rv, &ckpt->rv) {
+		if (!space_id_is_system(space_rv->id))
+			spaces[i++] = space_rv;
+	}
+	assert(i == space_count);
+	qsort(spaces, space_count, sizeof(*spaces),
+	      checkpoint_space_cmp_bsize);
+
+	uint32_t part_count = MIN((uint32_t)thread_count, space_count);
+	if (layout != NULL && layout->partition_count != part_count)
+		layout = NULL;
+	struct checkpoint_partition *parts = (struct checkpoint_partition *)
+		xcalloc(part_count, sizeof(*parts));
+	for (i = 0; i < part_count; i++) {
+		parts[i].ckpt = ckpt;
+		parts[i].id = i + 1;
+		parts[i].is_clean = layout != NULL;
+		xlog_clear(&parts[i].snap);
+	}
+	/*
+	 * Count spaces of each partition first, then lay the space
+	 * arrays out in one buffer.
+	 */
+	uint32_t *assignment = (uint32_t *)xcalloc(space_count,
+						   sizeof(*assignment));
+	for (i = 0; i < space_count; i++) {
+		uint32_t min = 0;
+		uint32_t prev = layout != NULL ?
+			checkpoint_layout_find(layout, spaces[i]->id) : 0;
+		if (prev > 0) {
+			min = prev - 1;
+			if (!checkpoint_space_is_clean(spaces[i], layout))
+				parts[min].is_clean = false;
+		} else {
+			for (uint32_t j = 1; j < part_count; j++) {
+				if (parts[j].bsize < parts[min].bsize)
+					min = j;
+			}
+			parts[min].is_clean = false;
+		}
+		assignment[i] = min;
+		parts[min].bsize += checkpoint_space_bsize(spaces[i]);
+		parts[min].space_count++;
+	}
+	for (i = 0; i < part_count && layout != NULL; i++) {
+		/* Some spaces of the partition have been dropped. */
+		if (parts[i].space_count != layout->partition_sizes[i])
+			parts[i].is_clean = false;
+	}
+	ckpt->space_buf = (struct space_read_view **)
+		xcalloc(space_count, sizeof(*ckpt->space_buf));
+	struct space_read_view **buf = ckpt->space_buf;
+	for (i = 0; i < part_count; i++) {
+		parts[i].spaces = buf;
+		buf += parts[i].space_count;
+		parts[i].space_count = 0;
+	}
+	/* Preserve the space id order within each partition. */
+	read_view_foreach_space(space_rv, &ckpt->rv) {
+		if (space_id_is_system(space_rv->id))
+			continue;
+		for (i = 0; i < space_count; i++) {
+			if (spaces[i] == space_rv)
+				break;
+		}
+		assert(i < space_count);
+		struct checkpoint_partition *part = &parts[assignment[i]];
+		part->spaces[part->space_count++] = space_rv;
+	}
+	free(assignment);
+	free(spaces);
+	ckpt->partitions = parts;
+	ckpt->partition_count = part_count;
+	if (layout != NULL)
+		ckpt->base_signature = layout->signature;
+}
+
+static struct checkpoint *
+checkpoint_new(const char *snap_dirname, uint64_t snap_io_rate_limit,
+	       int thread_count, bool compression, bool direct_io,
+	       const struct checkpoint_layout *layout,
+	       uint64_t space_version)
+{
+	struct checkpoint *ckpt = (struct checkpoint *)xcalloc(1,
+							       sizeof(*ckpt));
+	struct read_view_opts rv_opts;
+	read_view_opts_create(&rv_opts);
+	rv_opts.name = "checkpoint";
+	rv_opts.is_system = true;
+	rv_opts.filter_space = checkpoint_space_filter;
+	rv_opts.filter_index = primary_index_filter;
+	if (read_view_open(&ckpt->rv, &rv_opts) != 0) {
+		free(ckpt);
+		return NULL;
+	}
+	ckpt->base_signature = -1;
+	ckpt->space_version = space_version;
+	if (thread_count > 1)
+		checkpoint_create_partitions(ckpt, thread_count, layout);
+	if (ckpt->partition_count > 0) {
+		/*
+		 * Partitions are written concurrently so share the
+		 * rate limit between them.
+		 */
+		snap_io_rate_limit /= ckpt->partition_count;
 	}
 	struct xlog_opts opts = xlog_opts_default;
 	opts.rate_limit = snap_io_rate_limit;
 	opts.sync_interval = SNAP_SYNC_INTERVAL;
 	opts.free_cache = true;
+	opts.no_compression = !compression;
+	opts.direct_io = direct_io;
 	xdir_create(&ckpt->dir, snap_dirname, SNAP, &INSTANCE_UUID, &opts);
 	xlog_clear(&ckpt->snap);
 	vclock_create(&ckpt->vclock);
@@ -890,6 +1666,8 @@ checkpoint_delete(struct checkpoint *ckpt)
 {
 	read_view_close(&ckpt->rv);
 	xdir_destroy(&ckpt->dir);
+	free(ckpt->partitions);
+	free(ckpt->space_buf);
 	free(ckpt);
 }
 
@@ -981,15 +1759,180 @@ checkpoint_write_invalid_system_row(struct xlog *l)
 }
 #endif /* NDEBUG */
 
+/**
+ * Writes all tuples of the given space read view to the snapshot file.
+ * @a temp_space_ids is used for filtering out temporary space metadata,
+ * see is_tuple_temporary().
+ */
 static int
-checkpoint_f(va_list ap)
+checkpoint_write_space(struct xlog *snap, struct space_read_view *space_rv,
+		       struct mh_i32_t *temp_space_ids)
 {
 #ifdef NDEBUG
 	enum { YIELD_LOOPS = 1000 };
 #else
 	enum { YIELD_LOOPS = 10 };
 #endif
+	FiberGCChecker gc_check;
+	struct index_read_view *index_rv = space_read_view_index(space_rv, 0);
+	assert(index_rv != NULL);
+	struct index_read_view_iterator it;
+	if (index_read_view_create_iterator(index_rv, ITER_ALL,
+					    NULL, 0, &it) != 0)
+		return -1;
+	int rc;
+	unsigned int loops = 0;
+	while (true) {
+		RegionGuard region_guard(&fiber()->gc);
+		struct read_view_tuple result;
+		rc = index_read_view_iterator_next_raw(&it, &result);
+		if (rc != 0 || result.data == NULL)
+			break;
+		if (temp_space_ids != NULL &&
+		    is_tuple_temporary(result.data, space_rv->id,
+				       temp_space_ids))
+			continue;
+		rc = checkpoint_write_tuple(snap, space_rv->id,
+					    space_rv->group_id,
+					    result.data, result.size);
+		if (rc != 0)
+			break;
+		/* Yield to make thread cancellable. */
+		if (++loops % YIELD_LOOPS == 0)
+			fiber_sleep(0);
+		if (fiber_is_cancelled()) {
+			diag_set(FiberIsCancelled);
+			rc = -1;
+			break;
+		}
+	}
+	index_read_view_iterator_destroy(&it);
+	return rc;
+}
+
+/** Snapshot partition writer thread function. */
+static int
+checkpoint_partition_f(va_list ap)
+{
+	struct checkpoint_partition *part =
+		va_arg(ap, struct checkpoint_partition *);
+	struct checkpoint *ckpt = part->ckpt;
+	struct xlog *snap = &part->snap;
+	assert(!xlog_is_open(snap));
+	if (part->is_clean) {
+		assert(ckpt->base_signature >= 0);
+		if (xdir_link_partition_xlog(&ckpt->dir, snap, &ckpt->vclock,
+					     part->id,
+					     ckpt->base_signature) == 0) {
+			say_info("reusing snapshot partition `%s'",
+				 snap->filename);
+			return 0;
+		}
+		/* Fall back on writing the partition from scratch. */
+		diag_log();
+	}
+	if (xdir_create_partition_xlog(&ckpt->dir, snap, &ckpt->vclock,
+				       part->id) != 0) {
+		xlog_clear(snap);
+		return -1;
+	}
+	say_info("saving snapshot partition `%s'", snap->filename);
+	for (uint32_t i = 0; i < part->space_count; i++) {
+		if (checkpoint_write_space(snap, part->spaces[i], NULL) != 0)
+			goto fail;
+	}
+	if (xlog_close(snap) != 0)
+		goto fail;
+	return 0;
+fail:
+	xlog_discard(snap);
+	return -1;
+}
+
+/** Cancels a partition writer thread. */
+static void
+checkpoint_partition_cancel(struct checkpoint_partition *part)
+{
+	ev_async_send(part->cord.loop, &part->cord.cancel_event);
+}
+
+/**
+ * Waits for the first @a count partition writer threads to complete.
+ * If @a cancel is set, the threads are cancelled first. If a thread
+ * fails, the rest are cancelled, because the checkpoint can't succeed
+ * anyway. Returns -1 and sets diag to the first error if any of the
+ * threads failed.
+ */
+static int
+checkpoint_join_partitions(struct checkpoint *ckpt, uint32_t count,
+			   bool cancel)
+{
+	if (cancel) {
+		for (uint32_t i = 0; i < count; i++)
+			checkpoint_partition_cancel(&ckpt->partitions[i]);
+	}
+	struct diag diag;
+	diag_create(&diag);
+	for (uint32_t i = 0; i < count; i++) {
+		if (cord_cojoin(&ckpt->partitions[i].cord) == 0)
+			continue;
+		if (!diag_is_empty(&diag)) {
+			diag_log();
+			continue;
+		}
+		diag_move(diag_get(), &diag);
+		for (uint32_t j = i + 1; j < count; j++)
+			checkpoint_partition_cancel(&ckpt->partitions[j]);
+	}
+	int rc = 0;
+	if (!diag_is_empty(&diag)) {
+		diag_move(&diag, diag_get());
+		rc = -1;
+	}
+	diag_destroy(&diag);
+	return rc;
+}
+
+/**
+ * Cancels and joins the first @a count partition writer threads on
+ * checkpoint failure. The current diagnostics is preserved, errors
+ * of the partition writers are logged.
+ */
+static void
+checkpoint_cancel_partitions(struct checkpoint *ckpt, uint32_t count)
+{
+	struct diag diag;
+	diag_create(&diag);
+	diag_move(diag_get(), &diag);
+	if (checkpoint_join_partitions(ckpt, count, true) != 0)
+		diag_log();
+	diag_move(&diag, diag_get());
+	diag_destroy(&diag);
+}
+
+/**
+ * Starts partition writer threads. On failure, the threads that have
+ * already been started are cancelled and joined.
+ */
+static int
+checkpoint_start_partitions(struct checkpoint *ckpt)
+{
+	for (uint32_t i = 0; i < ckpt->partition_count; i++) {
+		struct checkpoint_partition *part = &ckpt->partitions[i];
+		char name[FIBER_NAME_MAX];
+		snprintf(name, sizeof(name), "snapshot.%u", (unsigned)part->id);
+		if (cord_costart(&part->cord, name, checkpoint_partition_f,
+				 part) != 0) {
+			checkpoint_cancel_partitions(ckpt, i);
+			return -1;
+		}
+	}
+	return 0;
+}
 
+static int
+checkpoint_f(va_list ap)
+{
 	int rc = 0;
 	struct checkpoint *ckpt = va_arg(ap, struct checkpoint *);
 
@@ -1003,9 +1946,14 @@ checkpoint_f(va_list ap)
 		ckpt->touch = false;
 	}
 
+	ERROR_INJECT(ERRINJ_SNAP_SKIP_ALL_ROWS, {
+		/* Write an empty snapshot without partitions. */
+		ckpt->partition_count = 0;
+	});
 	struct xlog *snap = &ckpt->snap;
 	assert(!xlog_is_open(snap));
-	if (xdir_create_xlog(&ckpt->dir, snap, &ckpt->vclock) != 0) {
+	if (xdir_create_partitioned_xlog(&ckpt->dir, snap, &ckpt->vclock,
+					 ckpt->partition_count) != 0) {
 		/*
 		 * We call memtx_engine_abort_checkpoint on failure to discard
 		 * an incomplete xlog file. Clear the xlog object so that it's
@@ -1016,6 +1964,7 @@ checkpoint_f(va_list ap)
 	}
 
 	struct mh_i32_t *temp_space_ids;
+	bool partitions_started = false;
 
 	say_info("saving snapshot `%s'", snap->filename);
 	ERROR_INJECT_WHILE(ERRINJ_SNAP_WRITE_DELAY, {
@@ -1029,54 +1978,31 @@ checkpoint_f(va_list ap)
 	struct space_read_view *space_rv;
 	temp_space_ids = mh_i32_new();
 	read_view_foreach_space(space_rv, &ckpt->rv) {
-		FiberGCChecker gc_check;
 		bool skip = false;
 		ERROR_INJECT(ERRINJ_SNAP_SKIP_DDL_ROWS, {
 			skip = space_id_is_system(space_rv->id);
 		});
 		if (skip)
 			continue;
-		struct index_read_view *index_rv =
-			space_read_view_index(space_rv, 0);
-		assert(index_rv != NULL);
-		struct index_read_view_iterator it;
-		if (index_read_view_create_iterator(index_rv, ITER_ALL,
-						    NULL, 0, &it) != 0) {
-			rc = -1;
-			break;
-		}
-		unsigned int loops = 0;
-		while (true) {
-			RegionGuard region_guard(&fiber()->gc);
-			struct read_view_tuple result;
-			rc = index_read_view_iterator_next_raw(&it, &result);
-			if (rc != 0 || result.data == NULL)
-				break;
-			if (is_tuple_temporary(result.data,
-					       space_rv->id,
-					       temp_space_ids))
-				continue;
-			rc = checkpoint_write_tuple(snap, space_rv->id,
-						    space_rv->group_id,
-						    result.data, result.size);
-			if (rc != 0)
-				break;
-			/* Yield to make thread cancellable. */
-			if (++loops % YIELD_LOOPS == 0)
-				fiber_sleep(0);
-			if (fiber_is_cancelled()) {
-				diag_set(FiberIsCancelled);
-				rc = -1;
-				break;
-			}
-		}
-		index_read_view_iterator_destroy(&it);
+		/*
+		 * User spaces are written to partitions in parallel
+		 * once all system spaces are written.
+		 */
+		if (ckpt->partition_count > 0 &&
+		    !space_id_is_system(space_rv->id))
+			continue;
+		rc = checkpoint_write_space(snap, space_rv, temp_space_ids);
 		if (rc != 0)
 			break;
 	}
 	mh_i32_delete(temp_space_ids);
 	if (rc != 0)
 		goto fail;
+	if (ckpt->partition_count > 0) {
+		if (checkpoint_start_partitions(ckpt) != 0)
+			goto fail;
+		partitions_started = true;
+	}
 	ERROR_INJECT(ERRINJ_SNAP_WRITE_CORRUPTED_INSERT_ROW, {
 		if (checkpoint_write_corrupted_insert_row(snap) != 0)
 			goto fail;
@@ -1099,11 +2025,19 @@ checkpoint_f(va_list ap)
 		goto fail;
 	goto done;
 done:
+	if (partitions_started) {
+		partitions_started = false;
+		if (checkpoint_join_partitions(ckpt, ckpt->partition_count,
+					       false) != 0)
+			goto fail;
+	}
 	if (xlog_close(snap) != 0)
 		goto fail;
 	say_info("done");
 	return 0;
 fail:
+	if (partitions_started)
+		checkpoint_cancel_partitions(ckpt, ckpt->partition_count);
 	xlog_discard(snap);
 	return -1;
 }
@@ -1116,7 +2050,12 @@ memtx_engine_begin_checkpoint(struct engine *engine, bool is_scheduled)
 
 	assert(memtx->checkpoint == NULL);
 	memtx->checkpoint = checkpoint_new(memtx->snap_dir.dirname,
-					   memtx->snap_io_rate_limit);
+					   memtx->snap_io_rate_limit,
+					   memtx->checkpoint_threads,
+					   memtx->checkpoint_compression,
+					   memtx->checkpoint_direct_io,
+					   memtx->checkpoint_layout,
+					   memtx->space_version);
 	if (memtx->checkpoint == NULL)
 		return -1;
 	return 0;
@@ -1154,8 +2093,18 @@ memtx_engine_wait_checkpoint(struct engine *engine,
 static ssize_t
 memtx_engine_commit_checkpoint_f(va_list ap)
 {
-	struct xlog *xlog = va_arg(ap, typeof(xlog));
-	if (xlog_materialize(xlog) != 0) {
+	struct checkpoint *ckpt = va_arg(ap, typeof(ckpt));
+	/*
+	 * Materialize partitions first: a snapshot file without
+	 * .inprogress suffix must always be complete.
+	 */
+	for (uint32_t i = 0; i < ckpt->partition_count; i++) {
+		if (xlog_materialize(&ckpt->partitions[i].snap) != 0) {
+			diag_log();
+			panic("failed to commit snapshot partition");
+		}
+	}
+	if (xlog_materialize(&ckpt->snap) != 0) {
 		diag_log();
 		panic("failed to commit snapshot");
 	}
@@ -1174,8 +2123,7 @@ memtx_engine_commit_checkpoint(struct engine *engine,
 
 	if (!memtx->checkpoint->touch) {
 		ERROR_INJECT_YIELD(ERRINJ_SNAP_COMMIT_DELAY);
-		coio_call(memtx_engine_commit_checkpoint_f,
-			  &memtx->checkpoint->snap);
+		coio_call(memtx_engine_commit_checkpoint_f, memtx->checkpoint);
 	}
 
 	struct vclock last;
@@ -1185,6 +2133,16 @@ memtx_engine_commit_checkpoint(struct engine *engine,
 		xdir_add_vclock(&memtx->snap_dir, &memtx->checkpoint->vclock);
 	}
 
+	if (!memtx->checkpoint->touch) {
+		if (memtx->checkpoint_layout != NULL)
+			checkpoint_layout_delete(memtx->checkpoint_layout);
+		memtx->checkpoint_layout = NULL;
+		if (memtx->checkpoint->partition_count > 0) {
+			memtx->checkpoint_layout =
+				checkpoint_layout_new(memtx->checkpoint);
+		}
+	}
+
 	checkpoint_delete(memtx->checkpoint);
 	memtx->checkpoint = NULL;
 }
@@ -1192,8 +2150,10 @@ memtx_engine_commit_checkpoint(struct engine *engine,
 static ssize_t
 memtx_engine_abort_checkpoint_f(va_list ap)
 {
-	struct xlog *xlog = va_arg(ap, typeof(xlog));
-	xlog_discard(xlog);
+	struct checkpoint *ckpt = va_arg(ap, typeof(ckpt));
+	for (uint32_t i = 0; i < ckpt->partition_count; i++)
+		xlog_discard(&ckpt->partitions[i].snap);
+	xlog_discard(&ckpt->snap);
 	return 0;
 }
 
@@ -1205,7 +2165,7 @@ memtx_engine_abort_checkpoint(struct engine *engine)
 	assert(memtx->checkpoint != NULL);
 	assert(!xlog_is_open(&memtx->checkpoint->snap));
 
-	coio_call(memtx_engine_abort_checkpoint_f, &memtx->checkpoint->snap);
+	coio_call(memtx_engine_abort_checkpoint_f, memtx->checkpoint);
 	checkpoint_delete(memtx->checkpoint);
 	memtx->checkpoint = NULL;
 }
@@ -1218,6 +2178,19 @@ memtx_engine_collect_garbage(struct engine *engine, const struct vclock *vclock)
 			     XDIR_GC_ASYNC);
 }
 
+/** Argument of memtx_engine_backup_partition_cb(). */
+struct memtx_backup_ctx {
+	engine_backup_cb *cb;
+	void *cb_arg;
+};
+
+static int
+memtx_engine_backup_partition_cb(const char *filename, void *arg)
+{
+	struct memtx_backup_ctx *ctx = (struct memtx_backup_ctx *)arg;
+	return ctx->cb(filename, ctx->cb_arg);
+}
+
 static int
 memtx_engine_backup(struct engine *engine, const struct vclock *vclock,
 		    engine_backup_cb cb, void *cb_arg)
@@ -1225,13 +2198,81 @@ memtx_engine_backup(struct engine *engine, const struct vclock *vclock,
 	struct memtx_engine *memtx = (struct memtx_engine *)engine;
 	const char *filename = xdir_format_filename(&memtx->snap_dir,
 						    vclock_sum(vclock), NONE);
-	return cb(filename, cb_arg);
+	if (cb(filename, cb_arg) != 0)
+		return -1;
+	struct memtx_backup_ctx ctx = { cb, cb_arg };
+	return xdir_foreach_partition(&memtx->snap_dir, vclock_sum(vclock),
+				      memtx_engine_backup_partition_cb, &ctx);
 }
 
+struct memtx_join_ctx;
+
+/**
+ * A batch of user space tuples read by a join partition thread. Each
+ * tuple is stored prefixed with its space id and size.
+ */
+struct memtx_join_chunk {
+	/** Link in memtx_join_ctx::chunks. */
+	struct stailq_entry in_queue;
+	/** Size of the stored data. */
+	size_t size;
+	/** Size of the data allocation. */
+	size_t capacity;
+	/** Stored tuples. */
+	char data[0];
+};
+
+/**
+ * Join partition. If memtx_join_threads > 1, user spaces are split
+ * between several partitions, each read by its own thread, while the
+ * join thread sends the tuples read by them to the replica.
+ */
+struct memtx_join_partition {
+	/** Join this partition belongs to. */
+	struct memtx_join_ctx *ctx;
+	/** Partition reader thread. */
+	struct cord cord;
+	/** Read views of user spaces read by this partition. */
+	struct space_read_view **spaces;
+	/** Number of entries in the spaces array. */
+	uint32_t space_count;
+	/** Total size of the spaces, used for balancing partitions. */
+	size_t bsize;
+};
+
 struct memtx_join_ctx {
 	/** Database read view sent to the replica. */
 	struct read_view rv;
 	struct xstream *stream;
+	/** Number of partition threads, see memtx_join_threads. */
+	int thread_count;
+	/** Partitions of the join, may be empty. */
+	struct memtx_join_partition *partitions;
+	/** Number of entries in the partitions array. */
+	uint32_t partition_count;
+	/** Memory for partition space arrays. */
+	struct space_read_view **space_buf;
+	/** Protects the fields below. */
+	pthread_mutex_t mutex;
+	/** Signaled when a chunk is pushed or a partition completes. */
+	pthread_cond_t cond_not_empty;
+	/** Signaled when a chunk is popped or the join is aborted. */
+	pthread_cond_t cond_not_full;
+	/** Chunks read by partitions, not sent yet. */
+	struct stailq chunks;
+	/** Number of entries in the chunks list. */
+	int chunk_count;
+	/** Number of partitions that are still reading. */
+	uint32_t active_partitions;
+	/** Set if the join failed and the partitions must stop. */
+	bool is_aborted;
+};
+
+enum {
+	/** Size of a chunk read by a join partition. */
+	MEMTX_JOIN_CHUNK_SIZE = 256 * 1024,
+	/** Max number of chunks waiting to be sent per partition. */
+	MEMTX_JOIN_CHUNKS_PER_PARTITION = 4,
 };
 
 /** Space filter for replica join. */
@@ -1247,7 +2288,7 @@ memtx_join_space_filter(struct space *space, void *arg)
 static int
 memtx_engine_prepare_join(struct engine *engine, void **arg)
 {
-	(void)engine;
+	struct memtx_engine *memtx = (struct memtx_engine *)engine;
 	struct memtx_join_ctx *ctx =
 		(struct memtx_join_ctx *)malloc(sizeof(*ctx));
 	if (ctx == NULL) {
@@ -1265,181 +2306,970 @@ memtx_engine_prepare_join(struct engine *engine, void **arg)
 		free(ctx);
 		return -1;
 	}
-	*arg = ctx;
+	ctx->thread_count = memtx->join_threads;
+	ctx->partitions = NULL;
+	ctx->partition_count = 0;
+	ctx->space_buf = NULL;
+	tt_pthread_mutex_init(&ctx->mutex, NULL);
+	tt_pthread_cond_init(&ctx->cond_not_empty, NULL);
+	tt_pthread_cond_init(&ctx->cond_not_full, NULL);
+	stailq_create(&ctx->chunks);
+	ctx->chunk_count = 0;
+	ctx->active_partitions = 0;
+	ctx->is_aborted = false;
+	*arg = ctx;
+	return 0;
+}
+
+/**
+ * Splits user spaces of the join read view between partitions so that
+ * the partitions have roughly the same size. Must be called in tx,
+ * because the space sizes are looked up in the space cache.
+ */
+static void
+memtx_join_assign_partitions(struct memtx_join_ctx *ctx)
+{
+	uint32_t space_count = 0;
+	struct space_read_view *space_rv;
+	read_view_foreach_space(space_rv, &ctx->rv) {
+		if (!space_id_is_system(space_rv->id))
+			space_count++;
+	}
+	uint32_t part_count = MIN((uint32_t)ctx->thread_count, space_count);
+	if (part_count <= 1)
+		return;
+	struct space_read_view **spaces = (struct space_read_view **)
+		xcalloc(space_count, sizeof(*spaces));
+	uint32_t i = 0;
+	read_view_foreach_space(space_rv, &ctx->rv) {
+		if (!space_id_is_system(space_rv->id))
+			spaces[i++] = space_rv;
+	}
+	assert(i == space_count);
+	qsort(spaces, space_count, sizeof(*spaces),
+	      checkpoint_space_cmp_bsize);
+	struct memtx_join_partition *parts = (struct memtx_join_partition *)
+		xcalloc(part_count, sizeof(*parts));
+	uint32_t *assignment = (uint32_t *)xcalloc(space_count,
+						   sizeof(*assignment));
+	for (i = 0; i < space_count; i++) {
+		uint32_t min = 0;
+		for (uint32_t j = 1; j < part_count; j++) {
+			if (parts[j].bsize < parts[min].bsize)
+				min = j;
+		}
+		assignment[i] = min;
+		parts[min].bsize += checkpoint_space_bsize(spaces[i]);
+		parts[min].space_count++;
+	}
+	ctx->space_buf = (struct space_read_view **)
+		xcalloc(space_count, sizeof(*ctx->space_buf));
+	struct space_read_view **buf = ctx->space_buf;
+	for (i = 0; i < part_count; i++) {
+		parts[i].ctx = ctx;
+		parts[i].spaces = buf;
+		buf += parts[i].space_count;
+		parts[i].space_count = 0;
+	}
+	for (i = 0; i < space_count; i++) {
+		struct memtx_join_partition *part = &parts[assignment[i]];
+		part->spaces[part->space_count++] = spaces[i];
+	}
+	free(assignment);
+	free(spaces);
+	ctx->partitions = parts;
+	ctx->partition_count = part_count;
+}
+
+static int
+memtx_join_send_tuple(struct xstream *stream, uint32_t space_id,
+		      const char *data, size_t size)
+{
+	struct request_replace_body body;
+	request_replace_body_create(&body, space_id);
+
+	struct xrow_header row;
+	memset(&row, 0, sizeof(row));
+	row.type = IPROTO_INSERT;
+
+	row.bodycnt = 2;
+	row.body[0].iov_base = &body;
+	row.body[0].iov_len = sizeof(body);
+	row.body[1].iov_base = (char *)data;
+	row.body[1].iov_len = size;
+
+	return xstream_write(stream, &row);
+}
+
+/**
+ * Passes a chunk read by a partition to the join thread. Waits if too
+ * many chunks are queued. Returns -1 if the join has been aborted.
+ */
+static int
+memtx_join_push_chunk(struct memtx_join_ctx *ctx,
+		      struct memtx_join_chunk *chunk)
+{
+	int max_chunk_count = ctx->partition_count *
+			      MEMTX_JOIN_CHUNKS_PER_PARTITION;
+	tt_pthread_mutex_lock(&ctx->mutex);
+	while (ctx->chunk_count >= max_chunk_count && !ctx->is_aborted)
+		tt_pthread_cond_wait(&ctx->cond_not_full, &ctx->mutex);
+	bool is_aborted = ctx->is_aborted;
+	if (!is_aborted) {
+		stailq_add_tail_entry(&ctx->chunks, chunk, in_queue);
+		ctx->chunk_count++;
+		tt_pthread_cond_signal(&ctx->cond_not_empty);
+	}
+	tt_pthread_mutex_unlock(&ctx->mutex);
+	if (is_aborted) {
+		free(chunk);
+		diag_set(FiberIsCancelled);
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * Takes the next chunk read by partitions. Returns NULL if all
+ * partitions have completed and all chunks have been taken or if
+ * the join has been aborted.
+ */
+static struct memtx_join_chunk *
+memtx_join_pop_chunk(struct memtx_join_ctx *ctx)
+{
+	struct memtx_join_chunk *chunk = NULL;
+	tt_pthread_mutex_lock(&ctx->mutex);
+	while (stailq_empty(&ctx->chunks) && ctx->active_partitions > 0 &&
+	       !ctx->is_aborted)
+		tt_pthread_cond_wait(&ctx->cond_not_empty, &ctx->mutex);
+	if (!stailq_empty(&ctx->chunks) && !ctx->is_aborted) {
+		chunk = stailq_shift_entry(&ctx->chunks,
+					   struct memtx_join_chunk, in_queue);
+		ctx->chunk_count--;
+		tt_pthread_cond_signal(&ctx->cond_not_full);
+	}
+	tt_pthread_mutex_unlock(&ctx->mutex);
+	return chunk;
+}
+
+/** Stops partitions and frees the chunks that haven't been sent. */
+static void
+memtx_join_abort(struct memtx_join_ctx *ctx)
+{
+	tt_pthread_mutex_lock(&ctx->mutex);
+	ctx->is_aborted = true;
+	tt_pthread_cond_broadcast(&ctx->cond_not_full);
+	struct memtx_join_chunk *chunk, *tmp;
+	stailq_foreach_entry_safe(chunk, tmp, &ctx->chunks, in_queue)
+		free(chunk);
+	stailq_create(&ctx->chunks);
+	ctx->chunk_count = 0;
+	tt_pthread_mutex_unlock(&ctx->mutex);
+}
+
+/** Sends all tuples of the given chunk to the replica. */
+static int
+memtx_join_send_chunk(struct xstream *stream, struct memtx_join_chunk *chunk)
+{
+	const char *pos = chunk->data;
+	const char *end = chunk->data + chunk->size;
+	while (pos < end) {
+		uint32_t space_id = load_u32(pos);
+		uint32_t size = load_u32(pos + sizeof(uint32_t));
+		pos += 2 * sizeof(uint32_t);
+		if (memtx_join_send_tuple(stream, space_id, pos, size) != 0)
+			return -1;
+		pos += size;
+	}
+	return 0;
+}
+
+/**
+ * Reads all tuples of the given space. If @a stream is set, sends them
+ * to the replica right away, otherwise passes them to the join thread
+ * in chunks.
+ */
+static int
+memtx_join_space(struct memtx_join_ctx *ctx, struct space_read_view *space_rv,
+		 struct xstream *stream, struct mh_i32_t *temp_space_ids,
+		 struct memtx_join_chunk **chunk)
+{
+	FiberGCChecker gc_check;
+	struct index_read_view *index_rv =
+		space_read_view_index(space_rv, 0);
+	assert(index_rv != NULL);
+	struct index_read_view_iterator it;
+	if (index_read_view_create_iterator(index_rv, ITER_ALL,
+					    NULL, 0, &it) != 0)
+		return -1;
+	int rc;
+	while (true) {
+		RegionGuard region_guard(&fiber()->gc);
+		struct read_view_tuple result;
+		rc = index_read_view_iterator_next_raw(&it, &result);
+		if (rc != 0 || result.data == NULL)
+			break;
+		if (temp_space_ids != NULL &&
+		    is_tuple_temporary(result.data, space_rv->id,
+				       temp_space_ids))
+			continue;
+		if (stream != NULL) {
+			rc = memtx_join_send_tuple(stream, space_rv->id,
+						   result.data, result.size);
+			if (rc != 0)
+				break;
+			continue;
+		}
+		size_t size = 2 * sizeof(uint32_t) + result.size;
+		if (*chunk != NULL && (*chunk)->capacity - (*chunk)->size < size) {
+			rc = memtx_join_push_chunk(ctx, *chunk);
+			*chunk = NULL;
+			if (rc != 0)
+				break;
+		}
+		if (*chunk == NULL) {
+			size_t capacity = MAX((size_t)MEMTX_JOIN_CHUNK_SIZE,
+					      size);
+			*chunk = (struct memtx_join_chunk *)
+				xmalloc(sizeof(**chunk) + capacity);
+			(*chunk)->size = 0;
+			(*chunk)->capacity = capacity;
+		}
+		char *pos = (*chunk)->data + (*chunk)->size;
+		store_u32(pos, space_rv->id);
+		store_u32(pos + sizeof(uint32_t), result.size);
+		memcpy(pos + 2 * sizeof(uint32_t), result.data, result.size);
+		(*chunk)->size += size;
+	}
+	index_read_view_iterator_destroy(&it);
+	return rc;
+}
+
+/** Join partition reader thread function. */
+static int
+memtx_join_partition_f(va_list ap)
+{
+	struct memtx_join_partition *part =
+		va_arg(ap, struct memtx_join_partition *);
+	struct memtx_join_ctx *ctx = part->ctx;
+	struct memtx_join_chunk *chunk = NULL;
+	int rc = 0;
+	for (uint32_t i = 0; i < part->space_count && rc == 0; i++) {
+		rc = memtx_join_space(ctx, part->spaces[i], NULL, NULL,
+				      &chunk);
+	}
+	if (chunk != NULL) {
+		if (rc == 0)
+			rc = memtx_join_push_chunk(ctx, chunk);
+		else
+			free(chunk);
+	}
+	tt_pthread_mutex_lock(&ctx->mutex);
+	ctx->active_partitions--;
+	/* Stop the other partitions, the join has failed anyway. */
+	if (rc != 0)
+		ctx->is_aborted = true;
+	tt_pthread_cond_signal(&ctx->cond_not_empty);
+	tt_pthread_cond_broadcast(&ctx->cond_not_full);
+	tt_pthread_mutex_unlock(&ctx->mutex);
+	return rc;
+}
+
+/**
+ * Starts partition reader threads and sends the tuples read by them to
+ * the replica. Returns -1 and sets diag to the first error if sending
+ * or any of the partitions failed.
+ */
+static int
+memtx_join_partitions(struct memtx_join_ctx *ctx)
+{
+	uint32_t started = 0;
+	int rc = 0;
+	ctx->active_partitions = ctx->partition_count;
+	for (; started < ctx->partition_count; started++) {
+		struct memtx_join_partition *part = &ctx->partitions[started];
+		char name[FIBER_NAME_MAX];
+		snprintf(name, sizeof(name), "join.%u", (unsigned)started + 1);
+		if (cord_costart(&part->cord, name, memtx_join_partition_f,
+				 part) != 0) {
+			rc = -1;
+			break;
+		}
+	}
+	if (rc != 0) {
+		/* Account the partitions that haven't been started. */
+		tt_pthread_mutex_lock(&ctx->mutex);
+		ctx->active_partitions -= ctx->partition_count - started;
+		tt_pthread_mutex_unlock(&ctx->mutex);
+		memtx_join_abort(ctx);
+	}
+	struct memtx_join_chunk *chunk;
+	while (rc == 0 && (chunk = memtx_join_pop_chunk(ctx)) != NULL) {
+		rc = memtx_join_send_chunk(ctx->stream, chunk);
+		free(chunk);
+		if (rc != 0)
+			memtx_join_abort(ctx);
+	}
+	struct diag diag;
+	diag_create(&diag);
+	if (rc != 0)
+		diag_move(diag_get(), &diag);
+	for (uint32_t i = 0; i < started; i++) {
+		if (cord_cojoin(&ctx->partitions[i].cord) == 0)
+			continue;
+		memtx_join_abort(ctx);
+		/*
+		 * Partitions stopped by the abort fail with FiberIsCancelled,
+		 * prefer the error that caused the abort.
+		 */
+		if (diag_is_empty(&diag) ||
+		    diag_last_error(&diag)->type == &type_FiberIsCancelled) {
+			diag_clear(&diag);
+			diag_move(diag_get(), &diag);
+		} else {
+			diag_clear(diag_get());
+		}
+	}
+	/* Chunks may be left if a partition failed. */
+	memtx_join_abort(ctx);
+	rc = 0;
+	if (!diag_is_empty(&diag)) {
+		diag_move(&diag, diag_get());
+		rc = -1;
+	}
+	diag_destroy(&diag);
+	return rc;
+}
+
+static int
+memtx_join_f(va_list ap)
+{
+	int rc = 0;
+	struct memtx_join_ctx *ctx = va_arg(ap, struct memtx_join_ctx *);
+	struct mh_i32_t *temp_space_ids = mh_i32_new();
+	struct space_read_view *space_rv;
+	read_view_foreach_space(space_rv, &ctx->rv) {
+		/* User spaces are sent by partitions, if any. */
+		if (ctx->partition_count > 0 &&
+		    !space_id_is_system(space_rv->id))
+			continue;
+		rc = memtx_join_space(ctx, space_rv, ctx->stream,
+				      temp_space_ids, NULL);
+		if (rc != 0)
+			break;
+	}
+	mh_i32_delete(temp_space_ids);
+	if (rc == 0 && ctx->partition_count > 0)
+		rc = memtx_join_partitions(ctx);
+	return rc;
+}
+
+static int
+memtx_engine_join(struct engine *engine, void *arg, struct xstream *stream)
+{
+	(void)engine;
+	struct memtx_join_ctx *ctx = (struct memtx_join_ctx *)arg;
+	ctx->stream = stream;
+	memtx_join_assign_partitions(ctx);
+	/*
+	 * Memtx snapshot iterators are safe to use from another
+	 * thread and so we do so as not to consume too much of
+	 * precious tx cpu time while a new replica is joining.
+	 */
+	struct cord cord;
+	if (cord_costart(&cord, "initial_join", memtx_join_f, ctx) != 0)
+		return -1;
+	int res = cord_cojoin(&cord);
+	xstream_reset(stream);
+	return res;
+}
+
+static void
+memtx_engine_complete_join(struct engine *engine, void *arg)
+{
+	(void)engine;
+	struct memtx_join_ctx *ctx = (struct memtx_join_ctx *)arg;
+	read_view_close(&ctx->rv);
+	free(ctx->partitions);
+	free(ctx->space_buf);
+	tt_pthread_cond_destroy(&ctx->cond_not_full);
+	tt_pthread_cond_destroy(&ctx->cond_not_empty);
+	tt_pthread_mutex_destroy(&ctx->mutex);
+	free(ctx);
+}
+
+static void
+memtx_engine_memory_stat(struct engine *engine, struct engine_memory_stat *stat)
+{
+	struct memtx_engine *memtx = (struct memtx_engine *)engine;
+	struct memtx_allocator_stats data_stats;
+	memtx_allocators_stats(&data_stats);
+	stat->data += data_stats.used_total;
+	stat->index += (size_t)memtx->index_extent_stats.extent_count *
+							MEMTX_EXTENT_SIZE;
+}
+
+static void
+memtx_engine_reset_stat(struct engine *engine)
+{
+	(void)engine;
+	memtx_allocators_reset_stats();
+}
+
+static const struct engine_vtab memtx_engine_vtab = {
+	/* .free = */ memtx_engine_free,
+	/* .shutdown = */ generic_engine_shutdown,
+	/* .create_space = */ memtx_engine_create_space,
+	/* .create_read_view = */ memtx_engine_create_read_view,
+	/* .prepare_join = */ memtx_engine_prepare_join,
+	/* .join = */ memtx_engine_join,
+	/* .complete_join = */ memtx_engine_complete_join,
+	/* .begin = */ memtx_engine_begin,
+	/* .begin_statement = */ generic_engine_begin_statement,
+	/* .prepare = */ memtx_engine_prepare,
+	/* .commit = */ memtx_engine_commit,
+	/* .rollback_statement = */ memtx_engine_rollback_statement,
+	/* .rollback = */ generic_engine_rollback,
+	/* .switch_to_ro = */ generic_engine_switch_to_ro,
+	/* .bootstrap = */ memtx_engine_bootstrap,
+	/* .begin_initial_recovery = */ memtx_engine_begin_initial_recovery,
+	/* .begin_final_recovery = */ memtx_engine_begin_final_recovery,
+	/* .begin_hot_standby = */ memtx_engine_begin_hot_standby,
+	/* .end_recovery = */ memtx_engine_end_recovery,
+	/* .begin_checkpoint = */ memtx_engine_begin_checkpoint,
+	/* .wait_checkpoint = */ memtx_engine_wait_checkpoint,
+	/* .commit_checkpoint = */ memtx_engine_commit_checkpoint,
+	/* .abort_checkpoint = */ memtx_engine_abort_checkpoint,
+	/* .collect_garbage = */ memtx_engine_collect_garbage,
+	/* .backup = */ memtx_engine_backup,
+	/* .memory_stat = */ memtx_engine_memory_stat,
+	/* .reset_stat = */ memtx_engine_reset_stat,
+	/* .check_space_def = */ generic_engine_check_space_def,
+};
+
+/**
+ * Run one iteration of garbage collection. Set @stop if
+ * there is no more objects to free.
+ */
+static void
+memtx_engine_run_gc(struct memtx_engine *memtx, bool *stop)
+{
+	*stop = stailq_empty(&memtx->gc_queue);
+	if (*stop)
+		return;
+
+	struct memtx_gc_task *task = stailq_first_entry(&memtx->gc_queue,
+					struct memtx_gc_task, link);
+	bool task_done;
+	task->vtab->run(task, &task_done);
+	if (task_done) {
+		stailq_shift(&memtx->gc_queue);
+		task->vtab->free(task);
+	}
+}
+
+static int
+memtx_engine_gc_f(va_list va)
+{
+	struct memtx_engine *memtx = va_arg(va, struct memtx_engine *);
+	while (!fiber_is_cancelled()) {
+		FiberGCChecker gc_check;
+		bool stop;
+		ERROR_INJECT_YIELD(ERRINJ_MEMTX_DELAY_GC);
+		memtx_engine_run_gc(memtx, &stop);
+		if (stop) {
+			fiber_yield_timeout(TIMEOUT_INFINITY);
+			continue;
+		}
+		/*
+		 * Yield after each iteration so as not to block
+		 * tx thread for too long.
+		 */
+		fiber_sleep(0);
+	}
+	return 0;
+}
+
+enum {
+	/** Max number of tuples moved in one defragmentation step. */
+	MEMTX_DEFRAG_BATCH_SIZE = 100,
+};
+
+/** How often the defragmentation fiber checks the tuple arena, seconds. */
+static const double MEMTX_DEFRAG_CHECK_INTERVAL = 1;
+
+/**
+ * Returns true if the tuple arena is fragmented enough to start
+ * a defragmentation pass. Returns the size of memory used by tuples
+ * in @a used.
+ */
+static bool
+memtx_engine_needs_defrag(struct memtx_engine *memtx, size_t *used)
+{
+	struct allocator_stats stats;
+	memset(&stats, 0, sizeof(stats));
+	SmallAlloc::stats(&stats, stats_noop_cb, NULL);
+	*used = stats.small.used;
+	return memtx->defrag_threshold > 0 && memtx->state == MEMTX_OK &&
+	       stats.small.used < memtx->defrag_threshold * stats.small.total;
+}
+
+/**
+ * Returns true if tuples of the given space may be moved. We don't touch
+ * spaces with functional indexes, because that would require recomputing
+ * functional keys, spaces that are being upgraded and spaces with internal
+ * on_replace triggers, which are set on system spaces and on spaces with
+ * an index build or a format check in progress.
+ */
+static bool
+memtx_space_may_defrag(struct memtx_engine *memtx, struct space *space)
+{
+	if (space->engine != (struct engine *)memtx ||
+	    space->index_count == 0 || space->upgrade != NULL ||
+	    !rlist_empty(&space->on_replace))
+		return false;
+	for (uint32_t i = 0; i < space->index_count; i++) {
+		if (space->index[i]->def->key_def->for_func_index)
+			return false;
+	}
+	return true;
+}
+
+/**
+ * Moves a tuple to a new place in the tuple arena and replaces it in all
+ * indexes of the space. The caller must hold a reference to the tuple.
+ *
+ * The small allocator takes memory from the partially used slab with
+ * the lowest address so a copy is kept only if it was placed lower than
+ * the original tuple. This way tuples flow from the sparsely used slabs
+ * at the top of each pool to the bottom ones, and the top slabs, once
+ * emptied, are returned to the slab cache.
+ */
+static int
+memtx_engine_defrag_tuple(struct memtx_engine *memtx, struct space *space,
+			  struct tuple *old_tuple)
+{
+	/*
+	 * A tuple referenced by anyone but the primary index and the caller
+	 * (e.g. an iterator, a transaction statement or a Lua variable) or
+	 * managed by the transaction manager must stay where it is.
+	 */
+	if (!tuple_ref_count_is(old_tuple, 2) ||
+	    tuple_has_flag(old_tuple, TUPLE_IS_DIRTY) ||
+	    tuple_is_compressed(old_tuple))
+		return 0;
+	struct small_alloc_info alloc_info;
+	SmallAlloc::get_alloc_info(old_tuple, tuple_size(old_tuple),
+				   &alloc_info);
+	if (alloc_info.is_large)
+		return 0;
+	if (memtx_index_extent_reserve(memtx,
+				       RESERVE_EXTENTS_BEFORE_REPLACE) != 0)
+		return -1;
+	uint32_t bsize;
+	const char *data = tuple_data_range(old_tuple, &bsize);
+	struct tuple *new_tuple = memtx_tuple_new_raw(tuple_format(old_tuple),
+						      data, data + bsize,
+						      false);
+	if (new_tuple == NULL)
+		return -1;
+	if ((uintptr_t)new_tuple > (uintptr_t)old_tuple) {
+		tuple_delete(new_tuple);
+		return 0;
+	}
+	uint32_t i;
+	for (i = 0; i < space->index_count; i++) {
+		struct tuple *unused;
+		if (index_replace(space->index[i], old_tuple, new_tuple,
+				  DUP_REPLACE, &unused, &unused) != 0)
+			goto rollback;
+	}
+	memtx_space_update_tuple_stat(space, old_tuple, new_tuple);
+	/* Pass the primary index reference to the copy. */
+	tuple_ref(new_tuple);
+	tuple_unref(old_tuple);
+	return 0;
+rollback:
+	for (; i > 0; i--) {
+		struct tuple *unused;
+		struct index *index = space->index[i - 1];
+		/* Rollback must not fail. */
+		if (index_replace(index, new_tuple, old_tuple,
+				  DUP_INSERT, &unused, &unused) != 0) {
+			diag_log();
+			unreachable();
+			panic("failed to rollback change");
+		}
+	}
+	tuple_delete(new_tuple);
+	return -1;
+}
+
+/**
+ * Does one step of defragmentation of a space: moves up to
+ * MEMTX_DEFRAG_BATCH_SIZE tuples following the primary key stored
+ * in @a key (from the beginning of the space if it's NULL) and updates
+ * the key. Sets @a done if the end of the space was reached.
+ */
+static int
+memtx_engine_defrag_step(struct memtx_engine *memtx, struct space *space,
+			 char **key, bool *done)
+{
+	struct index *pk = space->index[0];
+	struct key_def *cmp_def = pk->def->key_def;
+	struct iterator *it = index_create_iterator(
+		pk, *key != NULL ? ITER_GT : ITER_ALL, *key,
+		*key != NULL ? cmp_def->part_count : 0);
+	if (it == NULL)
+		return -1;
+	/*
+	 * Replacing tuples invalidates the iterator so first collect
+	 * the batch, then move the tuples.
+	 */
+	struct tuple *batch[MEMTX_DEFRAG_BATCH_SIZE];
+	uint32_t count = 0;
+	struct tuple *tuple;
+	int rc = 0;
+	while (count < MEMTX_DEFRAG_BATCH_SIZE &&
+	       (rc = iterator_next_internal(it, &tuple)) == 0 &&
+	       tuple != NULL) {
+		tuple_ref(tuple);
+		batch[count++] = tuple;
+	}
+	iterator_delete(it);
+	*done = count < MEMTX_DEFRAG_BATCH_SIZE;
+	if (rc == 0 && !*done) {
+		struct region *region = &fiber()->gc;
+		size_t region_svp = region_used(region);
+		uint32_t key_size;
+		const char *last_key = tuple_extract_key(
+			batch[count - 1], cmp_def, MULTIKEY_NONE, &key_size);
+		if (last_key != NULL) {
+			*key = (char *)xrealloc(*key, key_size);
+			memcpy(*key, last_key, key_size);
+		} else {
+			rc = -1;
+		}
+		region_truncate(region, region_svp);
+	}
+	for (uint32_t i = 0; i < count; i++) {
+		if (rc == 0 && memtx_engine_defrag_tuple(memtx, space,
+							 batch[i]) != 0)
+			rc = -1;
+		tuple_unref(batch[i]);
+	}
+	return rc;
+}
+
+/** Ids of spaces to be processed by a defragmentation pass. */
+struct memtx_defrag_space_ids {
+	/** Array of space ids. */
+	uint32_t *ids;
+	/** Number of entries in the array. */
+	uint32_t count;
+	/** Number of entries allocated for the array. */
+	uint32_t capacity;
+};
+
+/** space_foreach() callback that collects ids of memtx spaces. */
+static int
+memtx_engine_defrag_collect_space(struct space *space, void *arg)
+{
+	struct memtx_defrag_space_ids *ids =
+		(struct memtx_defrag_space_ids *)arg;
+	if (!space_is_memtx(space))
+		return 0;
+	if (ids->count == ids->capacity) {
+		ids->capacity = MAX(ids->capacity * 2, 16);
+		ids->ids = (uint32_t *)xrealloc(ids->ids, ids->capacity *
+						sizeof(*ids->ids));
+	}
+	ids->ids[ids->count++] = space_id(space);
+	return 0;
+}
+
+/**
+ * Does a defragmentation pass over all memtx spaces, yielding after each
+ * step. The pass is paused while there are open read views, because tuples
+ * visible from a read view aren't freed until it's closed. A space is
+ * skipped if the space cache changes while it's being processed.
+ */
+static void
+memtx_engine_defrag(struct memtx_engine *memtx)
+{
+	/* The space cache may change on yield so iterate over space ids. */
+	struct memtx_defrag_space_ids ids;
+	memset(&ids, 0, sizeof(ids));
+	space_foreach(memtx_engine_defrag_collect_space, &ids);
+	char *key = NULL;
+	for (uint32_t i = 0; i < ids.count; i++) {
+		uint32_t cache_version = space_cache_version;
+		bool done = false;
+		free(key);
+		key = NULL;
+		while (!done) {
+			while (MemtxAllocator<SmallAlloc>::has_read_views() &&
+			       !fiber_is_cancelled())
+				fiber_sleep(MEMTX_DEFRAG_CHECK_INTERVAL);
+			if (fiber_is_cancelled() ||
+			    memtx->defrag_threshold == 0)
+				goto out;
+			if (space_cache_version != cache_version)
+				break;
+			struct space *space = space_by_id(ids.ids[i]);
+			if (space == NULL ||
+			    !memtx_space_may_defrag(memtx, space))
+				break;
+			if (memtx_engine_defrag_step(memtx, space, &key,
+						     &done) != 0) {
+				/* Most likely out of memory, retry later. */
+				diag_clear(diag_get());
+				goto out;
+			}
+			fiber_sleep(0);
+		}
+	}
+out:
+	free(key);
+	free(ids.ids);
+}
+
+/**
+ * Defragmentation fiber. Periodically checks the ratio of memory used by
+ * tuples to memory held by the tuple allocator and runs a defragmentation
+ * pass if it's below box.cfg.memtx_defrag_threshold. A pass isn't repeated
+ * until the amount of memory used by tuples changes, because it wouldn't
+ * move anything.
+ */
+static int
+memtx_engine_defrag_f(va_list va)
+{
+	struct memtx_engine *memtx = va_arg(va, struct memtx_engine *);
+	size_t last_used = 0;
+	while (!fiber_is_cancelled()) {
+		FiberGCChecker gc_check;
+		size_t used;
+		if (memtx_engine_needs_defrag(memtx, &used) &&
+		    used != last_used) {
+			memtx_engine_defrag(memtx);
+			memtx_engine_needs_defrag(memtx, &last_used);
+		}
+		fiber_sleep(MEMTX_DEFRAG_CHECK_INTERVAL);
+	}
 	return 0;
 }
 
-static int
-memtx_join_send_tuple(struct xstream *stream, uint32_t space_id,
-		      const char *data, size_t size)
-{
-	struct request_replace_body body;
-	request_replace_body_create(&body, space_id);
+enum {
+	/** Max number of tuples looked at in one eviction step. */
+	MEMTX_EVICT_BATCH_SIZE = 100,
+};
 
-	struct xrow_header row;
-	memset(&row, 0, sizeof(row));
-	row.type = IPROTO_INSERT;
+/** How often the eviction fiber checks memory usage, seconds. */
+static const double MEMTX_EVICT_CHECK_INTERVAL = 0.1;
 
-	row.bodycnt = 2;
-	row.body[0].iov_base = &body;
-	row.body[0].iov_len = sizeof(body);
-	row.body[1].iov_base = (char *)data;
-	row.body[1].iov_len = size;
+/**
+ * Once started, eviction goes on until memory usage drops this much
+ * below box.cfg.memtx_evict_threshold, so that it isn't restarted on
+ * every insertion.
+ */
+static const double MEMTX_EVICT_HYSTERESIS = 0.05;
 
-	return xstream_write(stream, &row);
+/**
+ * Returns true if both the memtx quota and the memory actually used
+ * by tuples and indexes exceed the given share of box.cfg.memtx_memory.
+ * The quota alone isn't enough, because slabs freed by the allocator
+ * aren't returned to the quota.
+ */
+static bool
+memtx_engine_needs_evict(struct memtx_engine *memtx, double threshold)
+{
+	if (memtx->evict_threshold == 0 || memtx->state != MEMTX_OK ||
+	    !box_is_configured() || box_is_ro())
+		return false;
+	double limit = threshold * quota_total(&memtx->quota);
+	if (quota_used(&memtx->quota) < limit)
+		return false;
+	struct allocator_stats stats;
+	memset(&stats, 0, sizeof(stats));
+	allocators_stats(&stats);
+	struct mempool_stats index_stats;
+	mempool_stats(&memtx->index_extent_pool, &index_stats);
+	return stats.small.used + stats.sys.used +
+	       index_stats.totals.used >= limit;
 }
 
+/** space_foreach() callback that collects ids of memtx cache spaces. */
 static int
-memtx_join_f(va_list ap)
+memtx_engine_evict_collect_space(struct space *space, void *arg)
+{
+	if (!space_is_memtx(space) || !space->def->opts.is_cache)
+		return 0;
+	return memtx_engine_defrag_collect_space(space, arg);
+}
+
+/**
+ * Does one step of the CLOCK sweep over a cache space: looks at up to
+ * MEMTX_EVICT_BATCH_SIZE tuples following the primary key stored in
+ * @a key (from the beginning of the space if it's NULL) and updates the
+ * key. A tuple read since the previous sweep loses its reference bit,
+ * other tuples are deleted in one transaction. Sets @a done if the end
+ * of the space was reached. Returns the number of evicted tuples or -1.
+ */
+static int
+memtx_engine_evict_step(struct space *space, char **key, bool *done)
 {
+	struct index *pk = space->index[0];
+	struct key_def *cmp_def = pk->def->key_def;
+	struct iterator *it = index_create_iterator(
+		pk, *key != NULL ? ITER_GT : ITER_ALL, *key,
+		*key != NULL ? cmp_def->part_count : 0);
+	if (it == NULL)
+		return -1;
+	struct region *region = &fiber()->gc;
+	RegionGuard region_guard(region);
+	const char *victims[MEMTX_EVICT_BATCH_SIZE];
+	uint32_t victim_sizes[MEMTX_EVICT_BATCH_SIZE];
+	int victim_count = 0;
+	uint32_t count = 0;
+	struct tuple *tuple, *last = NULL;
 	int rc = 0;
-	struct memtx_join_ctx *ctx = va_arg(ap, struct memtx_join_ctx *);
-	struct mh_i32_t *temp_space_ids = mh_i32_new();
-	struct space_read_view *space_rv;
-	read_view_foreach_space(space_rv, &ctx->rv) {
-		FiberGCChecker gc_check;
-		struct index_read_view *index_rv =
-			space_read_view_index(space_rv, 0);
-		assert(index_rv != NULL);
-		struct index_read_view_iterator it;
-		if (index_read_view_create_iterator(index_rv, ITER_ALL,
-						    NULL, 0, &it) != 0) {
+	while (count < MEMTX_EVICT_BATCH_SIZE &&
+	       (rc = iterator_next_internal(it, &tuple)) == 0 &&
+	       tuple != NULL) {
+		count++;
+		last = tuple;
+		/* Tuples managed by the transaction manager are skipped. */
+		if (tuple_has_flag(tuple, TUPLE_IS_DIRTY))
+			continue;
+		if (tuple_has_flag(tuple, TUPLE_IS_ACCESSED)) {
+			tuple_clear_flag(tuple, TUPLE_IS_ACCESSED);
+			continue;
+		}
+		victims[victim_count] = tuple_extract_key(
+			tuple, cmp_def, MULTIKEY_NONE,
+			&victim_sizes[victim_count]);
+		if (victims[victim_count] == NULL) {
 			rc = -1;
 			break;
 		}
-		while (true) {
-			RegionGuard region_guard(&fiber()->gc);
-			struct read_view_tuple result;
-			rc = index_read_view_iterator_next_raw(&it, &result);
-			if (rc != 0 || result.data == NULL)
-				break;
-			if (is_tuple_temporary(result.data,
-					       space_rv->id,
-					       temp_space_ids))
-				continue;
-			rc = memtx_join_send_tuple(ctx->stream, space_rv->id,
-						   result.data, result.size);
-			if (rc != 0)
-				break;
+		victim_count++;
+	}
+	*done = count < MEMTX_EVICT_BATCH_SIZE;
+	if (rc == 0 && !*done) {
+		uint32_t key_size;
+		const char *last_key = tuple_extract_key(last, cmp_def,
+							 MULTIKEY_NONE,
+							 &key_size);
+		if (last_key != NULL) {
+			*key = (char *)xrealloc(*key, key_size);
+			memcpy(*key, last_key, key_size);
+		} else {
+			rc = -1;
 		}
-		index_read_view_iterator_destroy(&it);
-		if (rc != 0)
-			break;
 	}
-	mh_i32_delete(temp_space_ids);
-	return rc;
-}
-
-static int
-memtx_engine_join(struct engine *engine, void *arg, struct xstream *stream)
-{
-	(void)engine;
-	struct memtx_join_ctx *ctx = (struct memtx_join_ctx *)arg;
-	ctx->stream = stream;
+	iterator_delete(it);
+	if (rc != 0)
+		return -1;
+	if (victim_count == 0)
+		return 0;
 	/*
-	 * Memtx snapshot iterators are safe to use from another
-	 * thread and so we do so as not to consume too much of
-	 * precious tx cpu time while a new replica is joining.
+	 * Victims are deleted with regular DELETE statements so that
+	 * the eviction is persisted and replicated.
 	 */
-	struct cord cord;
-	if (cord_costart(&cord, "initial_join", memtx_join_f, ctx) != 0)
+	uint32_t id = space_id(space);
+	if (box_txn_begin() != 0)
 		return -1;
-	int res = cord_cojoin(&cord);
-	xstream_reset(stream);
-	return res;
-}
-
-static void
-memtx_engine_complete_join(struct engine *engine, void *arg)
-{
-	(void)engine;
-	struct memtx_join_ctx *ctx = (struct memtx_join_ctx *)arg;
-	read_view_close(&ctx->rv);
-	free(ctx);
-}
-
-static void
-memtx_engine_memory_stat(struct engine *engine, struct engine_memory_stat *stat)
-{
-	struct memtx_engine *memtx = (struct memtx_engine *)engine;
-	struct memtx_allocator_stats data_stats;
-	memtx_allocators_stats(&data_stats);
-	stat->data += data_stats.used_total;
-	stat->index += (size_t)memtx->index_extent_stats.extent_count *
-							MEMTX_EXTENT_SIZE;
+	for (int i = 0; i < victim_count; i++) {
+		if (box_delete(id, 0, victims[i],
+			       victims[i] + victim_sizes[i], NULL) != 0) {
+			box_txn_rollback();
+			return -1;
+		}
+	}
+	if (box_txn_commit() != 0)
+		return -1;
+	return victim_count;
 }
 
-static const struct engine_vtab memtx_engine_vtab = {
-	/* .free = */ memtx_engine_free,
-	/* .shutdown = */ generic_engine_shutdown,
-	/* .create_space = */ memtx_engine_create_space,
-	/* .create_read_view = */ memtx_engine_create_read_view,
-	/* .prepare_join = */ memtx_engine_prepare_join,
-	/* .join = */ memtx_engine_join,
-	/* .complete_join = */ memtx_engine_complete_join,
-	/* .begin = */ memtx_engine_begin,
-	/* .begin_statement = */ generic_engine_begin_statement,
-	/* .prepare = */ memtx_engine_prepare,
-	/* .commit = */ memtx_engine_commit,
-	/* .rollback_statement = */ memtx_engine_rollback_statement,
-	/* .rollback = */ generic_engine_rollback,
-	/* .switch_to_ro = */ generic_engine_switch_to_ro,
-	/* .bootstrap = */ memtx_engine_bootstrap,
-	/* .begin_initial_recovery = */ memtx_engine_begin_initial_recovery,
-	/* .begin_final_recovery = */ memtx_engine_begin_final_recovery,
-	/* .begin_hot_standby = */ memtx_engine_begin_hot_standby,
-	/* .end_recovery = */ memtx_engine_end_recovery,
-	/* .begin_checkpoint = */ memtx_engine_begin_checkpoint,
-	/* .wait_checkpoint = */ memtx_engine_wait_checkpoint,
-	/* .commit_checkpoint = */ memtx_engine_commit_checkpoint,
-	/* .abort_checkpoint = */ memtx_engine_abort_checkpoint,
-	/* .collect_garbage = */ memtx_engine_collect_garbage,
-	/* .backup = */ memtx_engine_backup,
-	/* .memory_stat = */ memtx_engine_memory_stat,
-	/* .reset_stat = */ generic_engine_reset_stat,
-	/* .check_space_def = */ generic_engine_check_space_def,
-};
-
 /**
- * Run one iteration of garbage collection. Set @stop if
- * there is no more objects to free.
+ * Evicts tuples from cache spaces until memory usage drops below the
+ * eviction threshold. The CLOCK hand, which is the current space and
+ * the primary key of the last tuple looked at in it, is preserved
+ * between calls so that every tuple gets a fair chance to be accessed.
  */
 static void
-memtx_engine_run_gc(struct memtx_engine *memtx, bool *stop)
+memtx_engine_evict(struct memtx_engine *memtx, uint32_t *hand_space_id,
+		   char **hand_key)
 {
-	*stop = stailq_empty(&memtx->gc_queue);
-	if (*stop)
-		return;
-
-	struct memtx_gc_task *task = stailq_first_entry(&memtx->gc_queue,
-					struct memtx_gc_task, link);
-	bool task_done;
-	task->vtab->run(task, &task_done);
-	if (task_done) {
-		stailq_shift(&memtx->gc_queue);
-		task->vtab->free(task);
+	/* The space cache may change on yield so iterate over space ids. */
+	struct memtx_defrag_space_ids ids;
+	memset(&ids, 0, sizeof(ids));
+	space_foreach(memtx_engine_evict_collect_space, &ids);
+	if (ids.count == 0)
+		goto out;
+	uint32_t i;
+	for (i = 0; i < ids.count; i++) {
+		if (ids.ids[i] == *hand_space_id)
+			break;
+	}
+	if (i == ids.count) {
+		i = 0;
+		free(*hand_key);
+		*hand_key = NULL;
+	}
+	/* Stop if a whole round didn't free anything. */
+	for (uint32_t idle_steps = 0; idle_steps <= ids.count * 2;) {
+		if (fiber_is_cancelled() ||
+		    !memtx_engine_needs_evict(memtx, memtx->evict_threshold -
+					      MEMTX_EVICT_HYSTERESIS))
+			break;
+		*hand_space_id = ids.ids[i];
+		struct space *space = space_by_id(ids.ids[i]);
+		bool done = true;
+		int evicted = 0;
+		if (space != NULL && space->def->opts.is_cache &&
+		    space->index_count > 0) {
+			evicted = memtx_engine_evict_step(space, hand_key,
+							  &done);
+			if (evicted < 0) {
+				diag_log();
+				diag_clear(diag_get());
+				break;
+			}
+		}
+		if (evicted > 0)
+			idle_steps = 0;
+		else if (done)
+			idle_steps++;
+		if (done) {
+			free(*hand_key);
+			*hand_key = NULL;
+			i = (i + 1) % ids.count;
+		}
+		fiber_sleep(0);
 	}
+out:
+	free(ids.ids);
 }
 
+/**
+ * Eviction fiber. Periodically checks memtx memory usage and evicts
+ * rarely accessed tuples from cache spaces if it exceeds the share of
+ * box.cfg.memtx_memory set by box.cfg.memtx_evict_threshold.
+ */
 static int
-memtx_engine_gc_f(va_list va)
+memtx_engine_evict_f(va_list va)
 {
 	struct memtx_engine *memtx = va_arg(va, struct memtx_engine *);
+	uint32_t hand_space_id = 0;
+	char *hand_key = NULL;
 	while (!fiber_is_cancelled()) {
 		FiberGCChecker gc_check;
-		bool stop;
-		ERROR_INJECT_YIELD(ERRINJ_MEMTX_DELAY_GC);
-		memtx_engine_run_gc(memtx, &stop);
-		if (stop) {
-			fiber_yield_timeout(TIMEOUT_INFINITY);
-			continue;
-		}
-		/*
-		 * Yield after each iteration so as not to block
-		 * tx thread for too long.
-		 */
-		fiber_sleep(0);
+		if (memtx_engine_needs_evict(memtx, memtx->evict_threshold))
+			memtx_engine_evict(memtx, &hand_space_id, &hand_key);
+		fiber_sleep(MEMTX_EVICT_CHECK_INTERVAL);
 	}
+	free(hand_key);
 	return 0;
 }
 
@@ -1471,11 +3301,77 @@ memtx_tuple_validate(struct tuple_format *format, struct tuple *tuple)
 	return rc;
 }
 
+/**
+ * Advise the kernel to back the memtx arena with transparent huge
+ * pages. Random accesses to tuples and index extents scattered over
+ * a big arena cause a lot of TLB misses, and one huge page TLB entry
+ * covers 512 regular pages.
+ *
+ * The arena is mapped by the small library, so we can't map it with
+ * MAP_HUGETLB. Instead, we mark the mapping with MADV_HUGEPAGE, which
+ * makes the kernel allocate huge pages on fault (or collapse regular
+ * pages later in khugepaged) as long as transparent huge pages are
+ * enabled in the "always" or "madvise" mode.
+ */
+static void
+memtx_engine_advise_huge_pages(struct memtx_engine *memtx)
+{
+#ifdef MADV_HUGEPAGE
+	if (madvise(memtx->arena.arena, memtx->arena.prealloc,
+		    MADV_HUGEPAGE) != 0) {
+		say_syserror("failed to enable transparent huge pages "
+			     "for memtx tuple arena");
+		return;
+	}
+	memtx->use_huge_pages = true;
+	say_info("enabled transparent huge pages for memtx tuple arena");
+#else
+	(void)memtx;
+	say_warn("transparent huge pages are not supported on this "
+		 "platform, ignoring memtx_use_huge_pages");
+#endif
+}
+
+size_t
+memtx_engine_huge_pages_used(struct memtx_engine *memtx)
+{
+	if (!memtx->use_huge_pages)
+		return 0;
+	/*
+	 * The arena may be split into several mappings by the kernel
+	 * (e.g. because of madvise(MADV_DONTDUMP) done by the small
+	 * library), so sum AnonHugePages of all mappings that belong
+	 * to it.
+	 */
+	FILE *f = fopen("/proc/self/smaps", "r");
+	if (f == NULL)
+		return 0;
+	uintptr_t arena_begin = (uintptr_t)memtx->arena.arena;
+	uintptr_t arena_end = arena_begin + memtx->arena.prealloc;
+	bool in_arena = false;
+	size_t used = 0;
+	char line[256];
+	while (fgets(line, sizeof(line), f) != NULL) {
+		uintptr_t begin, end;
+		size_t kb;
+		if (sscanf(line, "%" SCNxPTR "-%" SCNxPTR " ",
+			   &begin, &end) == 2) {
+			in_arena = begin < arena_end && end > arena_begin;
+		} else if (in_arena &&
+			   sscanf(line, "AnonHugePages: %zu kB", &kb) == 1) {
+			used += kb * 1024;
+		}
+	}
+	fclose(f);
+	return used;
+}
+
 struct memtx_engine *
 memtx_engine_new(const char *snap_dirname, bool force_recovery,
 		 uint64_t tuple_arena_max_size, uint32_t objsize_min,
 		 bool dontdump, unsigned granularity,
 		 const char *allocator, float alloc_factor, int sort_threads,
+		 bool use_huge_pages,
 		 memtx_on_indexes_built_cb on_indexes_built)
 {
 	int64_t snap_signature;
@@ -1525,6 +3421,14 @@ memtx_engine_new(const char *snap_dirname, bool force_recovery,
 	memtx->gc_fiber = fiber_new_system("memtx.gc", memtx_engine_gc_f);
 	if (memtx->gc_fiber == NULL)
 		goto fail;
+	memtx->defrag_fiber = fiber_new_system("memtx.defrag",
+					       memtx_engine_defrag_f);
+	if (memtx->defrag_fiber == NULL)
+		goto fail;
+	memtx->evict_fiber = fiber_new_system("memtx.evict",
+					      memtx_engine_evict_f);
+	if (memtx->evict_fiber == NULL)
+		goto fail;
 
 	/*
 	 * Currently we have two quota consumers: tuple and index allocators.
@@ -1569,6 +3473,8 @@ memtx_engine_new(const char *snap_dirname, bool force_recovery,
 	quota_init(&memtx->quota, tuple_arena_max_size);
 	tuple_arena_create(&memtx->arena, &memtx->quota, tuple_arena_max_size,
 			   SLAB_SIZE, dontdump, "memtx");
+	if (use_huge_pages)
+		memtx_engine_advise_huge_pages(memtx);
 	slab_cache_create(&memtx->slab_cache, &memtx->arena);
 	float actual_alloc_factor;
 	allocator_settings alloc_settings;
@@ -1593,6 +3499,10 @@ memtx_engine_new(const char *snap_dirname, bool force_recovery,
 
 	memtx->state = MEMTX_INITIALIZED;
 	memtx->max_tuple_size = MAX_TUPLE_SIZE;
+	memtx->checkpoint_threads = 1;
+	memtx->join_threads = 1;
+	memtx->checkpoint_compression = true;
+	memtx->checkpoint_direct_io = false;
 	memtx->force_recovery = force_recovery;
 	if (sort_threads == 0) {
 		char *ompnum_str = getenv_safe("OMP_NUM_THREADS", NULL, 0);
@@ -1636,6 +3546,8 @@ memtx_engine_new(const char *snap_dirname, bool force_recovery,
 	memtx->on_indexes_built_cb = on_indexes_built;
 
 	fiber_start(memtx->gc_fiber, memtx);
+	fiber_start(memtx->defrag_fiber, memtx);
+	fiber_start(memtx->evict_fiber, memtx);
 	return memtx;
 fail:
 	xdir_destroy(&memtx->snap_dir);
@@ -1719,6 +3631,7 @@ memtx_engine_stat_data(struct memtx_engine *memtx, struct info_handler *h)
 	info_table_begin(h, "data");
 	info_append_int(h, "total", stats.used_total);
 	info_append_int(h, "read_view", stats.used_rv);
+	info_append_int(h, "read_view_max", stats.used_rv_max);
 	info_append_int(h, "garbage", stats.used_gc);
 	info_table_end(h); /* data */
 }
@@ -1760,6 +3673,49 @@ memtx_engine_set_snap_io_rate_limit(struct memtx_engine *memtx, double limit)
 	memtx->snap_io_rate_limit = limit * 1024 * 1024;
 }
 
+void
+memtx_engine_set_checkpoint_threads(struct memtx_engine *memtx, int count)
+{
+	assert(count > 0);
+	memtx->checkpoint_threads = count;
+}
+
+void
+memtx_engine_set_join_threads(struct memtx_engine *memtx, int count)
+{
+	assert(count > 0);
+	memtx->join_threads = count;
+}
+
+void
+memtx_engine_set_checkpoint_compression(struct memtx_engine *memtx,
+					bool enable)
+{
+	memtx->checkpoint_compression = enable;
+}
+
+void
+memtx_engine_set_checkpoint_direct_io(struct memtx_engine *memtx, bool enable)
+{
+	memtx->checkpoint_direct_io = enable;
+}
+
+void
+memtx_engine_set_defrag_threshold(struct memtx_engine *memtx,
+				  double threshold)
+{
+	memtx->defrag_threshold = threshold;
+	fiber_wakeup(memtx->defrag_fiber);
+}
+
+void
+memtx_engine_set_evict_threshold(struct memtx_engine *memtx,
+				 double threshold)
+{
+	memtx->evict_threshold = threshold;
+	fiber_wakeup(memtx->evict_fiber);
+}
+
 int
 memtx_engine_set_memory(struct memtx_engine *memtx, size_t size)
 {
@@ -1782,6 +3738,14 @@ memtx_engine_set_max_tuple_size(struct memtx_engine *memtx, size_t max_size)
 	memtx->max_tuple_size = max_size;
 }
 
+enum {
+	/**
+	 * Only tuples not bigger than this may use the shared field map:
+	 * the field map of a bigger tuple is negligible compared to its data.
+	 */
+	MEMTX_SHARED_FIELD_MAP_MAX_TUPLE_SIZE = 1024,
+};
+
 template<class ALLOC>
 static struct tuple *
 memtx_tuple_new_raw_impl(struct tuple_format *format, const char *data,
@@ -1797,14 +3761,21 @@ memtx_tuple_new_raw_impl(struct tuple_format *format, const char *data,
 	uint32_t data_offset, field_map_size;
 	char *raw;
 	bool make_compact;
+	bool has_shared_field_map = false;
 	if (tuple_field_map_create(format, data, validate, &builder) != 0)
 		goto end;
-	field_map_size = field_map_build_size(&builder);
+	tuple_len = end - data;
+	if (tuple_len <= MEMTX_SHARED_FIELD_MAP_MAX_TUPLE_SIZE &&
+	    tuple_format_share_field_map(format, &builder)) {
+		has_shared_field_map = true;
+		field_map_size = 0;
+	} else {
+		field_map_size = field_map_build_size(&builder);
+	}
 	data_offset = sizeof(struct tuple) + field_map_size;
 	if (tuple_check_data_offset(data_offset) != 0)
 		goto end;
 
-	tuple_len = end - data;
 	assert(tuple_len <= UINT32_MAX); /* bsize is UINT32_MAX */
 	total = sizeof(struct tuple) + field_map_size + tuple_len;
 
@@ -1840,13 +3811,55 @@ memtx_tuple_new_raw_impl(struct tuple_format *format, const char *data,
 		tuple_set_flag(tuple, TUPLE_IS_TEMPORARY);
 	tuple_format_ref(format);
 	raw = (char *) tuple + data_offset;
-	field_map_build(&builder, raw - field_map_size);
+	if (has_shared_field_map)
+		tuple_set_flag(tuple, TUPLE_HAS_SHARED_FIELD_MAP);
+	else
+		field_map_build(&builder, raw - field_map_size);
 	memcpy(raw, data, tuple_len);
 end:
 	region_truncate(region, region_svp);
 	return tuple;
 }
 
+template<class ALLOC>
+static struct tuple *
+memtx_tuple_clone_impl(struct tuple *tuple)
+{
+	struct tuple_format *format = tuple_format(tuple);
+	struct memtx_engine *memtx = (struct memtx_engine *)format->engine;
+	size_t total = tuple_size(tuple);
+	struct tuple *new_tuple;
+	ERROR_INJECT(ERRINJ_TUPLE_ALLOC, {
+		diag_set(OutOfMemory, total, "slab allocator", "memtx_tuple");
+		return NULL;
+	});
+	if (unlikely(total > memtx->max_tuple_size)) {
+		diag_set(ClientError, ER_MEMTX_MAX_TUPLE_SIZE, total);
+		error_log(diag_last_error(diag_get()));
+		return NULL;
+	}
+	while ((new_tuple = MemtxAllocator<ALLOC>::alloc_tuple(total)) == NULL) {
+		bool stop;
+		memtx_engine_run_gc(memtx, &stop);
+		if (stop)
+			break;
+	}
+	if (new_tuple == NULL) {
+		diag_set(OutOfMemory, total, "slab allocator", "memtx_tuple");
+		return NULL;
+	}
+	memcpy(new_tuple, tuple, total);
+	tuple_create(new_tuple, 0, tuple_format_id(format),
+		     tuple_data_offset(tuple), tuple_bsize(tuple),
+		     tuple_is_compact(tuple));
+	if (tuple_has_flag(tuple, TUPLE_IS_TEMPORARY))
+		tuple_set_flag(new_tuple, TUPLE_IS_TEMPORARY);
+	if (tuple_has_flag(tuple, TUPLE_HAS_SHARED_FIELD_MAP))
+		tuple_set_flag(new_tuple, TUPLE_HAS_SHARED_FIELD_MAP);
+	tuple_format_ref(format);
+	return new_tuple;
+}
+
 template<class ALLOC>
 static inline struct tuple *
 memtx_tuple_new(struct tuple_format *format, const char *data, const char *end)
@@ -2013,6 +4026,8 @@ memtx_index_def_change_requires_rebuild(struct index *index,
 		return true;
 	if (old_def->opts.hint != new_def->opts.hint)
 		return true;
+	if (old_def->opts.hash_func != new_def->opts.hash_func)
+		return true;
 
 	const struct key_def *old_cmp_def, *new_cmp_def;
 	if (index_depends_on_pk(index)) {
@@ -2030,6 +4045,10 @@ memtx_index_def_change_requires_rebuild(struct index *index,
 	 */
 	if (old_cmp_def->part_count != new_cmp_def->part_count)
 		return true;
+	/* Tuple hints depend on the number of key parts packed in them. */
+	if (old_def->type == TREE &&
+	    old_cmp_def->hint_part_count != new_cmp_def->hint_part_count)
+		return true;
 
 	for (uint32_t i = 0; i < new_cmp_def->part_count; i++) {
 		const struct key_part *old_part = &old_cmp_def->parts[i];
@@ -2055,6 +4074,10 @@ int
 memtx_prepare_result_tuple(struct space *space, struct tuple **result)
 {
 	if (*result != NULL) {
+		/* Mark the tuple as recently used for the eviction fiber. */
+		if (unlikely(space != NULL && space->def->opts.is_cache &&
+			     !tuple_has_flag(*result, TUPLE_IS_ACCESSED)))
+			tuple_set_flag(*result, TUPLE_IS_ACCESSED);
 		*result = memtx_tuple_decompress(*result);
 		if (*result == NULL)
 			return -1;
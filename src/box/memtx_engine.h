@@ -109,21 +109,70 @@ enum memtx_reserve_extents_num {
  * allocated for each iterator (except rtree index iterator that
  * is significantly bigger so has own pool).
  */
-#define MEMTX_ITERATOR_SIZE (184)
+#define MEMTX_ITERATOR_SIZE (192)
 
 typedef void
 (*memtx_on_indexes_built_cb)(void);
 
+/** Statistics of memtx local recovery, see box.info.recovery(). */
+struct memtx_recovery_stat {
+	/** Number of rows read from the snapshot. */
+	int64_t snapshot_rows;
+	/**
+	 * Time spent reading the snapshot, in seconds. Includes decoding
+	 * rows, allocating tuples and inserting them into primary keys,
+	 * as well as recovery of vinyl indexes defined in the snapshot.
+	 */
+	double snapshot_time;
+	/** Time spent completing the bulk build of primary keys. */
+	double pk_build_time;
+	/** Time spent building secondary keys. */
+	double sk_build_time;
+};
+
 struct memtx_engine {
 	struct engine base;
 	/** Engine recovery state, see enum memtx_recovery_state description. */
 	enum memtx_recovery_state state;
 	/** Non-zero if there is a checkpoint (snapshot) in progress. */
 	struct checkpoint *checkpoint;
+	/**
+	 * Partitions of the last snapshot created by this instance,
+	 * used for reusing the files of unchanged partitions. NULL if
+	 * no snapshot has been created since startup.
+	 */
+	struct checkpoint_layout *checkpoint_layout;
+	/**
+	 * Counter incremented on each change of memtx space data, see
+	 * memtx_space::version.
+	 */
+	uint64_t space_version;
 	/** The directory where to store snapshots. */
 	struct xdir snap_dir;
 	/** Limit disk usage of checkpointing (bytes per second). */
 	uint64_t snap_io_rate_limit;
+	/**
+	 * Number of threads writing user space data on checkpoint,
+	 * box.cfg.memtx_checkpoint_threads. If greater than 1, user
+	 * spaces are split between snapshot partition files.
+	 */
+	int checkpoint_threads;
+	/**
+	 * Number of threads reading user space data on initial join
+	 * of a replica, box.cfg.memtx_join_threads.
+	 */
+	int join_threads;
+	/**
+	 * If this flag is cleared, snapshot files are written without
+	 * compression, box.cfg.memtx_checkpoint_compression.
+	 */
+	bool checkpoint_compression;
+	/**
+	 * If this flag is set, snapshot files are written with direct
+	 * I/O bypassing the page cache,
+	 * box.cfg.memtx_checkpoint_direct_io.
+	 */
+	bool checkpoint_direct_io;
 	/** Skip invalid snapshot records if this flag is set. */
 	bool force_recovery;
 	/**
@@ -131,6 +180,8 @@ struct memtx_engine {
 	 * data.
 	 */
 	memtx_on_indexes_built_cb on_indexes_built_cb;
+	/** Statistics of local recovery. */
+	struct memtx_recovery_stat recovery_stat;
 	/** Common quota for tuples and indexes. */
 	struct quota quota;
 	/**
@@ -140,6 +191,11 @@ struct memtx_engine {
 	 * is reflected in box.slab.info(), @sa lua/slab.c.
 	 */
 	struct slab_arena arena;
+	/**
+	 * Set if the arena is backed by transparent huge pages,
+	 * box.cfg.memtx_use_huge_pages.
+	 */
+	bool use_huge_pages;
 	/** Slab cache for allocating tuples. */
 	struct slab_cache slab_cache;
 	/** Slab cache for allocating index extents. */
@@ -177,6 +233,28 @@ struct memtx_engine {
 	 * memtx_gc_task::link.
 	 */
 	struct stailq gc_queue;
+	/**
+	 * Defragmentation fiber. Moves tuples out of sparsely used slabs,
+	 * see memtx_engine_defrag_f().
+	 */
+	struct fiber *defrag_fiber;
+	/**
+	 * Ratio of memory used by tuples to memory held by the tuple
+	 * allocator below which the defragmentation is started,
+	 * box.cfg.memtx_defrag_threshold. Zero disables defragmentation.
+	 */
+	double defrag_threshold;
+	/**
+	 * Eviction fiber. Deletes rarely accessed tuples from cache
+	 * spaces, see memtx_engine_evict_f().
+	 */
+	struct fiber *evict_fiber;
+	/**
+	 * Share of box.cfg.memtx_memory used by tuples and indexes above
+	 * which the eviction is started, box.cfg.memtx_evict_threshold.
+	 * Zero disables eviction.
+	 */
+	double evict_threshold;
 	/**
 	 * Format used for allocating functional index keys.
 	 */
@@ -222,8 +300,17 @@ memtx_engine_new(const char *snap_dirname, bool force_recovery,
 		 uint64_t tuple_arena_max_size, uint32_t objsize_min,
 		 bool dontdump, unsigned granularity,
 		 const char *allocator, float alloc_factor, int threads_num,
+		 bool use_huge_pages,
 		 memtx_on_indexes_built_cb on_indexes_built);
 
+/**
+ * Return the size of the memtx arena memory backed by transparent
+ * huge pages, in bytes. Returns 0 if box.cfg.memtx_use_huge_pages
+ * is unset or the size can't be determined.
+ */
+size_t
+memtx_engine_huge_pages_used(struct memtx_engine *memtx);
+
 /**
  * Memtx engine statistics (box.stat.memtx()).
  */
@@ -237,6 +324,51 @@ memtx_engine_recover_snapshot(struct memtx_engine *memtx,
 void
 memtx_engine_set_snap_io_rate_limit(struct memtx_engine *memtx, double limit);
 
+/**
+ * Set the number of threads used for writing snapshot partitions.
+ * Takes effect on the next checkpoint.
+ */
+void
+memtx_engine_set_checkpoint_threads(struct memtx_engine *memtx, int count);
+
+/**
+ * Set the number of threads used for reading user spaces on initial
+ * join of a replica. Takes effect on the next join.
+ */
+void
+memtx_engine_set_join_threads(struct memtx_engine *memtx, int count);
+
+/**
+ * Enable or disable compression of snapshot files.
+ * Takes effect on the next checkpoint.
+ */
+void
+memtx_engine_set_checkpoint_compression(struct memtx_engine *memtx,
+					bool enable);
+
+/**
+ * Enable or disable direct I/O for snapshot files.
+ * Takes effect on the next checkpoint.
+ */
+void
+memtx_engine_set_checkpoint_direct_io(struct memtx_engine *memtx, bool enable);
+
+/**
+ * Set the tuple arena usage ratio below which the defragmentation fiber
+ * starts moving tuples. Zero disables defragmentation.
+ */
+void
+memtx_engine_set_defrag_threshold(struct memtx_engine *memtx,
+				  double threshold);
+
+/**
+ * Set the share of memtx memory above which the eviction fiber starts
+ * deleting tuples from cache spaces. Zero disables eviction.
+ */
+void
+memtx_engine_set_evict_threshold(struct memtx_engine *memtx,
+				 double threshold);
+
 int
 memtx_engine_set_memory(struct memtx_engine *memtx, size_t size);
 
@@ -251,6 +383,12 @@ enum {
 	MEMTX_SLAB_SIZE = 4 * 1024 * 1024
 };
 
+/** Max value of box.cfg.memtx_checkpoint_threads. */
+enum { MEMTX_CHECKPOINT_THREADS_MAX = 64 };
+
+/** Max value of box.cfg.memtx_join_threads. */
+enum { MEMTX_JOIN_THREADS_MAX = 64 };
+
 /**
  * Allocate and return new memtx tuple. Data validation depends
  * on @a validate value. On error returns NULL and set diag.
@@ -259,6 +397,14 @@ extern struct tuple *
 (*memtx_tuple_new_raw)(struct tuple_format *format, const char *data,
 		       const char *end, bool validate);
 
+/**
+ * Allocate and return a byte-for-byte copy of the given memtx tuple,
+ * including its field map. The copy is not referenced. On error returns
+ * NULL and sets diag.
+ */
+extern struct tuple *
+(*memtx_tuple_clone)(struct tuple *tuple);
+
 /**
  * Allocate a block of size MEMTX_EXTENT_SIZE for memtx index
  * @ctx must point to memtx engine
@@ -362,14 +508,15 @@ memtx_engine_new_xc(const char *snap_dirname, bool force_recovery,
 		    uint64_t tuple_arena_max_size, uint32_t objsize_min,
 		    bool dontdump, unsigned granularity,
 		    const char *allocator, float alloc_factor,
-		    int sort_threads,
+		    int sort_threads, bool use_huge_pages,
 		    memtx_on_indexes_built_cb on_indexes_built)
 {
 	struct memtx_engine *memtx;
 	memtx = memtx_engine_new(snap_dirname, force_recovery,
 				 tuple_arena_max_size, objsize_min, dontdump,
 				 granularity, allocator, alloc_factor,
-				 sort_threads, on_indexes_built);
+				 sort_threads, use_huge_pages,
+				 on_indexes_built);
 	if (memtx == NULL)
 		diag_raise();
 	return memtx;
@@ -40,6 +40,7 @@
 #include "space.h"
 #include "schema.h" /* space_by_id(), space_cache_find() */
 #include "errinj.h"
+#include "tuple_hash.h"
 #include "trivia/config.h"
 
 #include <small/mempool.h>
@@ -81,8 +82,48 @@ struct memtx_hash_index {
 	struct light_index_core hash_table;
 	struct memtx_gc_task gc_task;
 	struct light_index_iterator gc_iterator;
+	/** Tuple hash function, see index_opts::hash_func. */
+	tuple_hash_t tuple_hash;
+	/** Key hash function, see index_opts::hash_func. */
+	key_hash_t key_hash;
 };
 
+/** Sets the hash functions of the index according to its definition. */
+static void
+memtx_hash_index_set_hash_func(struct memtx_hash_index *index)
+{
+	struct key_def *key_def = index->base.def->key_def;
+	switch (index->base.def->opts.hash_func) {
+	case INDEX_HASH_FUNC_MURMUR:
+		index->tuple_hash = key_def->tuple_hash;
+		index->key_hash = key_def->key_hash;
+		break;
+	case INDEX_HASH_FUNC_WYHASH:
+		key_def_get_wyhash_func(key_def, &index->tuple_hash,
+					&index->key_hash);
+		break;
+	case INDEX_HASH_FUNC_XXH3:
+		key_def_get_xxh3_func(key_def, &index->tuple_hash,
+				      &index->key_hash);
+		break;
+	default:
+		unreachable();
+	}
+}
+
+static inline uint32_t
+memtx_hash_index_tuple_hash(struct memtx_hash_index *index,
+			    struct tuple *tuple)
+{
+	return index->tuple_hash(tuple, index->base.def->key_def);
+}
+
+static inline uint32_t
+memtx_hash_index_key_hash(struct memtx_hash_index *index, const char *key)
+{
+	return index->key_hash(key, index->base.def->key_def);
+}
+
 /* {{{ MemtxHash Iterators ****************************************/
 
 struct hash_iterator {
@@ -269,6 +310,7 @@ memtx_hash_index_update_def(struct index *base)
 {
 	struct memtx_hash_index *index = (struct memtx_hash_index *)base;
 	index->hash_table.common.arg = index->base.def->key_def;
+	memtx_hash_index_set_hash_func(index);
 }
 
 static ssize_t
@@ -328,6 +370,43 @@ memtx_hash_index_count(struct index *base, enum iterator_type type,
 	return generic_index_count(base, type, key, part_count);
 }
 
+/**
+ * Batched lookups are dominated by cache misses, so we prefetch the
+ * hash table records of all the keys first and then the tuples the
+ * records point to, so that the misses of different keys overlap.
+ */
+static void
+memtx_hash_index_prefetch(struct index *base, const char *keys,
+			  uint32_t key_count)
+{
+	struct memtx_hash_index *index = (struct memtx_hash_index *)base;
+	struct key_def *key_def = base->def->key_def;
+	RegionGuard region_guard(&fiber()->gc);
+	uint32_t *hashes = xregion_alloc_array(&fiber()->gc, uint32_t,
+					       key_count);
+	uint32_t hash_count = 0;
+	for (uint32_t i = 0; i < key_count; i++) {
+		const char *key = keys;
+		mp_next(&keys);
+		if (mp_typeof(*key) != MP_ARRAY)
+			continue;
+		uint32_t part_count = mp_decode_array(&key);
+		if (part_count != key_def->part_count ||
+		    exact_key_validate(key_def, key, part_count) != 0) {
+			diag_clear(diag_get());
+			continue;
+		}
+		hashes[hash_count] = memtx_hash_index_key_hash(index, key);
+		light_index_prefetch(&index->hash_table, hashes[hash_count]);
+		hash_count++;
+	}
+	for (uint32_t i = 0; i < hash_count; i++) {
+		struct tuple *tuple;
+		if (light_index_peek(&index->hash_table, hashes[i], &tuple))
+			__builtin_prefetch(tuple);
+	}
+}
+
 static int
 memtx_hash_index_get_internal(struct index *base, const char *key,
 			      uint32_t part_count, struct tuple **result)
@@ -341,7 +420,7 @@ memtx_hash_index_get_internal(struct index *base, const char *key,
 	struct space *space = space_by_id(base->def->space_id);
 	struct txn *txn = in_txn();
 	*result = NULL;
-	uint32_t h = key_hash(key, base->def->key_def);
+	uint32_t h = memtx_hash_index_key_hash(index, key);
 	uint32_t k = light_index_find_key(&index->hash_table, h, key);
 	if (k != light_index_end) {
 		struct tuple *tuple = light_index_get(&index->hash_table, k);
@@ -369,7 +448,7 @@ memtx_hash_index_replace(struct index *base, struct tuple *old_tuple,
 	*successor = NULL;
 
 	if (new_tuple) {
-		uint32_t h = tuple_hash(new_tuple, base->def->key_def);
+		uint32_t h = memtx_hash_index_tuple_hash(index, new_tuple);
 		struct tuple *dup_tuple = NULL;
 		uint32_t pos = light_index_replace(hash_table, h, new_tuple,
 						   &dup_tuple);
@@ -418,7 +497,7 @@ memtx_hash_index_replace(struct index *base, struct tuple *old_tuple,
 	}
 
 	if (old_tuple) {
-		uint32_t h = tuple_hash(old_tuple, base->def->key_def);
+		uint32_t h = memtx_hash_index_tuple_hash(index, old_tuple);
 		int res = light_index_delete_value(hash_table, h, old_tuple);
 		assert(res == 0); (void) res;
 	}
@@ -467,7 +546,8 @@ memtx_hash_index_create_iterator(struct index *base, enum iterator_type type,
 
 		if (part_count != 0) {
 			light_index_iterator_key(&index->hash_table, &it->iterator,
-					key_hash(key, base->def->key_def), key);
+					memtx_hash_index_key_hash(index, key),
+					key);
 			it->base.next_internal = hash_iterator_gt;
 		} else {
 			light_index_iterator_begin(&index->hash_table, &it->iterator);
@@ -489,7 +569,7 @@ memtx_hash_index_create_iterator(struct index *base, enum iterator_type type,
 	case ITER_EQ:
 		assert(part_count > 0);
 		light_index_iterator_key(&index->hash_table, &it->iterator,
-				key_hash(key, base->def->key_def), key);
+				memtx_hash_index_key_hash(index, key), key);
 		it->base.next_internal = hash_iterator_eq;
 		if (it->iterator.slotpos == light_index_end)
 /********MVCC TRANSACTION MANAGER STORY GARBAGE COLLECTION BOUND START*********/
@@ -676,6 +756,7 @@ static const struct index_vtab memtx_hash_index_vtab = {
 	/* .count = */ memtx_hash_index_count,
 	/* .get_internal = */ memtx_hash_index_get_internal,
 	/* .get = */ memtx_index_get,
+	/* .prefetch = */ memtx_hash_index_prefetch,
 	/* .replace = */ memtx_hash_index_replace,
 	/* .create_iterator = */ memtx_hash_index_create_iterator,
 	/* .create_read_view = */ memtx_hash_index_create_read_view,
@@ -685,6 +766,7 @@ static const struct index_vtab memtx_hash_index_vtab = {
 	/* .begin_build = */ generic_index_begin_build,
 	/* .reserve = */ generic_index_reserve,
 	/* .build_next = */ generic_index_build_next,
+	/* .build_next_batch = */ generic_index_build_next_batch,
 	/* .end_build = */ generic_index_end_build,
 };
 
@@ -700,6 +782,7 @@ memtx_hash_index_new(struct memtx_engine *memtx, struct index_def *def)
 			   MEMTX_EXTENT_SIZE, memtx_index_extent_alloc,
 			   memtx_index_extent_free, memtx,
 			   &memtx->index_extent_stats);
+	memtx_hash_index_set_hash_func(index);
 	return &index->base;
 }
 
@@ -50,6 +50,8 @@ struct memtx_rtree_index {
 	struct index base;
 	unsigned dimension;
 	struct rtree tree;
+	/** Records collected by build_next() for bulk loading. */
+	struct rtree_bulk build;
 };
 
 /* {{{ Utilities. *************************************************/
@@ -176,6 +178,7 @@ static void
 memtx_rtree_index_destroy(struct index *base)
 {
 	struct memtx_rtree_index *index = (struct memtx_rtree_index *)base;
+	rtree_bulk_destroy(&index->build);
 	rtree_destroy(&index->tree);
 	free(index);
 }
@@ -289,15 +292,56 @@ memtx_rtree_index_reserve(struct index *base, uint32_t size_hint)
          * on rtree, because there is no error handling in the
          * rtree lib.
          */
-	(void)size_hint;
 	ERROR_INJECT(ERRINJ_INDEX_RESERVE, {
 		diag_set(OutOfMemory, MEMTX_EXTENT_SIZE, "mempool", "new slab");
 		return -1;
 	});
+	struct memtx_rtree_index *index = (struct memtx_rtree_index *)base;
+	/* Non-zero size hint is only passed on index build. */
+	if (size_hint > 0 &&
+	    rtree_bulk_reserve(&index->tree, &index->build, size_hint) != 0) {
+		diag_set(OutOfMemory, size_hint * index->tree.page_branch_size,
+			 "memtx_rtree_index", "reserve");
+		return -1;
+	}
 	struct memtx_engine *memtx = (struct memtx_engine *)base->engine;
 	return memtx_index_extent_reserve(memtx, RESERVE_EXTENTS_BEFORE_REPLACE);
 }
 
+static int
+memtx_rtree_index_build_next(struct index *base, struct tuple *tuple)
+{
+	struct memtx_rtree_index *index = (struct memtx_rtree_index *)base;
+	struct rtree_rect rect;
+	if (extract_rectangle(&rect, tuple, base->def) != 0)
+		return -1;
+	if (rtree_bulk_add(&index->tree, &index->build, &rect, tuple) != 0) {
+		diag_set(OutOfMemory, index->tree.page_branch_size,
+			 "memtx_rtree_index", "build_next");
+		return -1;
+	}
+	/*
+	 * The rtree library has no error handling so reserve extents for
+	 * all pages the tree is going to be built of in advance. Take
+	 * into account extents used by matras internally.
+	 */
+	size_t pages = rtree_bulk_page_count(&index->tree,
+					     index->build.count);
+	size_t extents = DIV_ROUND_UP(pages * index->tree.page_size,
+				      MEMTX_EXTENT_SIZE);
+	extents += extents / (MEMTX_EXTENT_SIZE / sizeof(void *)) +
+		   RESERVE_EXTENTS_BEFORE_REPLACE;
+	struct memtx_engine *memtx = (struct memtx_engine *)base->engine;
+	return memtx_index_extent_reserve(memtx, (int)extents);
+}
+
+static void
+memtx_rtree_index_end_build(struct index *base)
+{
+	struct memtx_rtree_index *index = (struct memtx_rtree_index *)base;
+	rtree_bulk_load(&index->tree, &index->build);
+}
+
 /** Implementation of create_iterator for memtx rtree index. */
 static struct iterator *
 memtx_rtree_index_create_iterator(struct index *base, enum iterator_type type,
@@ -399,6 +443,7 @@ static const struct index_vtab memtx_rtree_index_vtab = {
 	/* .count = */ memtx_rtree_index_count,
 	/* .get_internal = */ memtx_rtree_index_get_internal,
 	/* .get = */ memtx_index_get,
+	/* .prefetch = */ generic_index_prefetch,
 	/* .replace = */ memtx_rtree_index_replace,
 	/* .create_iterator = */ memtx_rtree_index_create_iterator,
 	/* .create_read_view = */ generic_index_create_read_view,
@@ -407,8 +452,9 @@ static const struct index_vtab memtx_rtree_index_vtab = {
 	/* .reset_stat = */ generic_index_reset_stat,
 	/* .begin_build = */ generic_index_begin_build,
 	/* .reserve = */ memtx_rtree_index_reserve,
-	/* .build_next = */ generic_index_build_next,
-	/* .end_build = */ generic_index_end_build,
+	/* .build_next = */ memtx_rtree_index_build_next,
+	/* .build_next_batch = */ generic_index_build_next_batch,
+	/* .end_build = */ memtx_rtree_index_end_build,
 };
 
 struct index *
@@ -448,5 +494,6 @@ memtx_rtree_index_new(struct memtx_engine *memtx, struct index_def *def)
 	rtree_init(&index->tree, index->dimension, distance_type,
 		   MEMTX_EXTENT_SIZE, memtx_index_extent_alloc,
 		   memtx_index_extent_free, memtx, &memtx->index_extent_stats);
+	rtree_bulk_create(&index->build);
 	return &index->base;
 }
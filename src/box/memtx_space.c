@@ -81,6 +81,15 @@ memtx_space_bsize(struct space *space)
 
 /* {{{ DML */
 
+void
+memtx_space_mark_dirty(struct space *space)
+{
+	assert(space->vtab->destroy == &memtx_space_destroy);
+	struct memtx_engine *memtx = (struct memtx_engine *)space->engine;
+	struct memtx_space *memtx_space = (struct memtx_space *)space;
+	memtx_space->version = ++memtx->space_version;
+}
+
 void
 memtx_space_update_tuple_stat(struct space *space, struct tuple *old_tuple,
 			      struct tuple *new_tuple)
@@ -125,6 +134,7 @@ memtx_space_update_tuple_stat(struct space *space, struct tuple *old_tuple,
 		else
 			stat->waste_size = 0;
 	}
+	memtx_space_mark_dirty(space);
 }
 
 /**
@@ -484,6 +494,17 @@ memtx_space_execute_delete(struct space *space, struct txn *txn,
 	return 0;
 }
 
+/** Checks if the space has a functional index. */
+static bool
+memtx_space_has_func_index(struct space *space)
+{
+	for (uint32_t i = 0; i < space->index_count; i++) {
+		if (space->index[i]->def->key_def->for_func_index)
+			return true;
+	}
+	return false;
+}
+
 static int
 memtx_space_execute_update(struct space *space, struct txn *txn,
 			   struct request *request, struct tuple **result)
@@ -514,16 +535,36 @@ memtx_space_execute_update(struct space *space, struct txn *txn,
 	struct tuple_format *format = space->format;
 	const char *old_data = tuple_data_range(prepared, &bsize);
 	size_t region_svp = region_used(&fiber()->gc);
-	const char *new_data =
-		xrow_update_execute(request->tuple, request->tuple_end,
-				    old_data, old_data + bsize, format,
-				    &new_size, request->index_base, NULL);
-	if (new_data == NULL)
-		return -1;
-
-	struct tuple *new_tuple =
-		space->format->vtab.tuple_new(format, new_data,
-					      new_data + new_size);
+	struct tuple *new_tuple = NULL;
+	struct xrow_update_patch *patches;
+	uint32_t patch_count;
+	if (tuple_format(prepared) == format &&
+	    !memtx_space_has_func_index(space) &&
+	    xrow_update_prepare_in_place(request->tuple, request->tuple_end,
+					 old_data, old_data + bsize, format,
+					 request->index_base, &patches,
+					 &patch_count)) {
+		/*
+		 * The update doesn't change field offsets so we can copy
+		 * the tuple along with its field map and patch it.
+		 */
+		new_tuple = memtx_tuple_clone(prepared);
+		if (new_tuple != NULL) {
+			xrow_update_apply_patches(patches, patch_count,
+						  (char *)tuple_data(new_tuple));
+		}
+	} else {
+		region_truncate(&fiber()->gc, region_svp);
+		const char *new_data =
+			xrow_update_execute(request->tuple, request->tuple_end,
+					    old_data, old_data + bsize, format,
+					    &new_size, request->index_base,
+					    NULL);
+		if (new_data == NULL)
+			return -1;
+		new_tuple = space->format->vtab.tuple_new(format, new_data,
+							  new_data + new_size);
+	}
 	region_truncate(&fiber()->gc, region_svp);
 	if (new_tuple == NULL)
 		return -1;
@@ -735,6 +776,28 @@ memtx_space_ephemeral_rowid_next(struct space *space, uint64_t *rowid)
 	return 0;
 }
 
+static void
+memtx_space_ephemeral_begin_build(struct space *space)
+{
+	struct memtx_space *memtx_space = (struct memtx_space *)space;
+	assert(space->def->opts.is_ephemeral);
+	assert(index_size(space->index[0]) == 0);
+	assert(memtx_space->replace == memtx_space_replace_all_keys);
+	index_begin_build(space->index[0]);
+	memtx_space->replace = memtx_space_replace_build_next;
+}
+
+static void
+memtx_space_ephemeral_end_build(struct space *space)
+{
+	struct memtx_space *memtx_space = (struct memtx_space *)space;
+	assert(space->def->opts.is_ephemeral);
+	if (memtx_space->replace != memtx_space_replace_build_next)
+		return;
+	index_end_build(space->index[0]);
+	memtx_space->replace = memtx_space_replace_all_keys;
+}
+
 /* }}} DML */
 
 /* {{{ DDL */
@@ -757,6 +820,13 @@ memtx_space_check_index_def(struct space *space, struct index_def *index_def)
 			return -1;
 		}
 	}
+	if (index_def->type != HASH &&
+	    index_def->opts.hash_func != INDEX_HASH_FUNC_MURMUR) {
+		diag_set(ClientError, ER_MODIFY_INDEX, index_def->name,
+			 space_name(space),
+			 "hash_func is only reasonable with memtx hash index");
+		return -1;
+	}
 	switch (index_def->type) {
 	case HASH:
 		if (! index_def->opts.is_unique) {
@@ -1234,6 +1304,259 @@ memtx_build_on_replace(struct trigger *trigger, void *event)
 	return 0;
 }
 
+/** A change made to a space while an index is being bulk built. */
+struct memtx_ddl_change {
+	/** Tuple removed from the space, referenced. */
+	struct tuple *old_tuple;
+	/** Tuple added to the space, referenced. */
+	struct tuple *new_tuple;
+};
+
+/** State of a bulk index build, see memtx_space_bulk_build_index(). */
+struct memtx_bulk_build_state {
+	/** The index being built. */
+	struct index *index;
+	/** New format to be enforced. */
+	struct tuple_format *format;
+	/**
+	 * The last tuple appended to the index, NULL if none.
+	 * Changes to tuples after it aren't logged.
+	 */
+	struct tuple *cursor;
+	/** Set when all tuples were appended, all changes are logged. */
+	bool is_scan_done;
+	/** Primary key key_def to compare new tuples with cursor. */
+	struct key_def *cmp_def;
+	/** Changes to apply to the index once it's built, in order. */
+	struct memtx_ddl_change *log;
+	/** Number of entries in the log. */
+	size_t log_size;
+	/** Number of entries allocated for the log. */
+	size_t log_capacity;
+	struct diag diag;
+	int rc;
+};
+
+/** Appends a change to the log of a bulk index build. */
+static int
+memtx_bulk_build_log(struct memtx_bulk_build_state *state,
+		     struct tuple *old_tuple, struct tuple *new_tuple)
+{
+	if (state->log_size == state->log_capacity) {
+		size_t capacity = MAX(2 * state->log_capacity, 64);
+		struct memtx_ddl_change *log =
+			realloc(state->log, capacity * sizeof(*log));
+		if (log == NULL) {
+			diag_set(OutOfMemory, capacity * sizeof(*log),
+				 "realloc", "log");
+			return -1;
+		}
+		state->log = log;
+		state->log_capacity = capacity;
+	}
+	struct memtx_ddl_change *change = &state->log[state->log_size++];
+	change->old_tuple = old_tuple;
+	change->new_tuple = new_tuple;
+	if (old_tuple != NULL)
+		tuple_ref(old_tuple);
+	if (new_tuple != NULL)
+		tuple_ref(new_tuple);
+	return 0;
+}
+
+/*
+ * On_rollback trigger with the bulk index build state and the statement
+ * used to log the reverse change.
+ */
+struct bulk_build_on_rollback {
+	struct trigger base;
+	struct memtx_bulk_build_state *state;
+	struct txn_stmt *stmt;
+};
+
+static int
+memtx_bulk_build_on_replace_rollback(struct trigger *trigger, void *event)
+{
+	(void)event;
+	struct bulk_build_on_rollback *on_rollback =
+		(struct bulk_build_on_rollback *)trigger;
+	struct memtx_bulk_build_state *state = on_rollback->state;
+	struct txn_stmt *stmt = on_rollback->stmt;
+	if (state->rc != 0)
+		return 0;
+	state->rc = memtx_bulk_build_log(state, stmt->new_tuple,
+					 stmt->old_tuple);
+	if (state->rc != 0)
+		diag_move(diag_get(), &state->diag);
+	return 0;
+}
+
+static int
+memtx_bulk_build_on_replace(struct trigger *trigger, void *event)
+{
+	struct txn *txn = event;
+	struct memtx_bulk_build_state *state = trigger->data;
+	struct txn_stmt *stmt = txn_current_stmt(txn);
+	if (state->rc != 0)
+		return 0;
+	struct tuple *cmp_tuple = stmt->new_tuple != NULL ? stmt->new_tuple :
+							    stmt->old_tuple;
+	/*
+	 * Tuples after the cursor will be appended when the scan
+	 * continues.
+	 */
+	if (!state->is_scan_done &&
+	    (state->cursor == NULL ||
+	     tuple_compare(state->cursor, HINT_NONE, cmp_tuple, HINT_NONE,
+			   state->cmp_def) < 0))
+		return 0;
+	if (stmt->new_tuple != NULL &&
+	    memtx_tuple_validate(state->format, stmt->new_tuple) != 0) {
+		state->rc = -1;
+		diag_move(diag_get(), &state->diag);
+		return 0;
+	}
+	struct bulk_build_on_rollback *on_rollback = NULL;
+	struct errinj *inj = errinj(ERRINJ_BUILD_INDEX_ON_ROLLBACK_ALLOC,
+				    ERRINJ_BOOL);
+	if (inj == NULL || inj->bparam == false) {
+		on_rollback = region_aligned_alloc(
+			&in_txn()->region, sizeof(*on_rollback),
+			alignof(struct bulk_build_on_rollback));
+	}
+	if (on_rollback == NULL) {
+		diag_set(OutOfMemory, sizeof(*on_rollback),
+			 "region_aligned_alloc", "on_rollback");
+		diag_move(diag_get(), &state->diag);
+		state->rc = -1;
+		return 0;
+	}
+	state->rc = memtx_bulk_build_log(state, stmt->old_tuple,
+					 stmt->new_tuple);
+	if (state->rc != 0) {
+		diag_move(diag_get(), &state->diag);
+		return 0;
+	}
+	on_rollback->state = state;
+	on_rollback->stmt = stmt;
+	trigger_create(&on_rollback->base, memtx_bulk_build_on_replace_rollback,
+		       NULL, NULL);
+	txn_stmt_on_rollback(stmt, &on_rollback->base);
+	return 0;
+}
+
+/**
+ * Builds a non-unique secondary index of a non-empty space.
+ *
+ * Unlike memtx_space_build_index(), which inserts tuples into the new
+ * index one by one, tuples are appended to the index build array like
+ * on recovery. The array is then sorted in several threads and turned
+ * into the tree at once, see memtx_tree_index_end_build(). It's much
+ * faster than random inserts into a large tree.
+ *
+ * The scan yields like memtx_space_build_index() does, and the sort
+ * yields while waiting for the sort threads. Changes made to tuples
+ * that were already appended are logged by an on_replace trigger in
+ * the meantime, along with their rollbacks, and applied to the built
+ * index at the end without yielding. The index is non-unique, so its
+ * entries are distinct and removed tuples may stay in the array till
+ * then.
+ */
+static int
+memtx_space_bulk_build_index(struct space *src_space, struct index *pk,
+			     struct index *new_index,
+			     struct tuple_format *new_format)
+{
+	assert(new_index->def->iid != 0);
+	assert(!new_index->def->opts.is_unique);
+	struct iterator *it = index_create_iterator(pk, ITER_ALL, NULL, 0);
+	if (it == NULL)
+		return -1;
+	/* See the comment in memtx_space_build_index(). */
+	bool can_yield = pk->def->type != HASH;
+	struct memtx_engine *memtx = (struct memtx_engine *)src_space->engine;
+	struct memtx_bulk_build_state state;
+	memset(&state, 0, sizeof(state));
+	state.index = new_index;
+	state.format = new_format;
+	state.cmp_def = pk->def->key_def;
+	diag_create(&state.diag);
+	struct trigger on_replace;
+	trigger_create(&on_replace, memtx_bulk_build_on_replace, &state, NULL);
+	trigger_add(&src_space->on_replace, &on_replace);
+
+	index_begin_build(new_index);
+	int rc = index_reserve(new_index, index_size(pk));
+	struct tuple *tuple;
+	size_t count = 0;
+	struct key_def *key_def = new_index->def->key_def;
+	while (rc == 0 && (rc = iterator_next_internal(it, &tuple)) == 0 &&
+	       tuple != NULL) {
+		if (!tuple_format_is_compatible_with_key_def(tuple_format(tuple),
+							     key_def)) {
+			rc = -1;
+			break;
+		}
+		rc = memtx_tuple_validate(new_format, tuple);
+		if (rc != 0)
+			break;
+		rc = index_build_next(new_index, tuple);
+		if (rc != 0)
+			break;
+		state.cursor = tuple;
+		if (!can_yield)
+			continue;
+		ERROR_INJECT_DOUBLE(ERRINJ_BUILD_INDEX_TIMEOUT, inj->dparam > 0,
+				    thread_sleep(inj->dparam));
+		tuple_ref(state.cursor);
+		if (++count % MEMTX_DDL_YIELD_LOOPS == 0 &&
+		    memtx->state == MEMTX_OK)
+			fiber_sleep(0);
+		ERROR_INJECT_YIELD(ERRINJ_BUILD_INDEX_DELAY);
+		tuple_unref(state.cursor);
+		if (fiber_is_cancelled()) {
+			diag_set(FiberIsCancelled);
+			rc = -1;
+			break;
+		}
+		if (state.rc != 0) {
+			rc = -1;
+			diag_move(&state.diag, diag_get());
+			break;
+		}
+	}
+	iterator_delete(it);
+	/* The cursor may be freed once we yield. */
+	state.is_scan_done = true;
+	if (rc == 0) {
+		/* May yield while sorting. */
+		index_end_build(new_index);
+		if (state.rc != 0) {
+			rc = -1;
+			diag_move(&state.diag, diag_get());
+		}
+	}
+	for (size_t i = 0; rc == 0 && i < state.log_size; i++) {
+		struct memtx_ddl_change *change = &state.log[i];
+		struct tuple *unused;
+		struct tuple *successor;
+		rc = index_replace(new_index, change->old_tuple,
+				   change->new_tuple, DUP_REPLACE_OR_INSERT,
+				   &unused, &successor);
+	}
+	for (size_t i = 0; i < state.log_size; i++) {
+		struct memtx_ddl_change *change = &state.log[i];
+		if (change->old_tuple != NULL)
+			tuple_unref(change->old_tuple);
+		if (change->new_tuple != NULL)
+			tuple_unref(change->new_tuple);
+	}
+	free(state.log);
+	diag_destroy(&state.diag);
+	trigger_clear(&on_replace);
+	return rc;
+}
+
 static int
 memtx_space_build_index(struct space *src_space, struct index *new_index,
 			struct tuple_format *new_format,
@@ -1268,6 +1591,12 @@ memtx_space_build_index(struct space *src_space, struct index *new_index,
 	if (txn_check_singlestatement(txn, "index build") != 0)
 		return -1;
 
+	if (new_index->def->iid != 0 && !new_index->def->opts.is_unique &&
+	    !new_index->def->key_def->for_func_index) {
+		return memtx_space_bulk_build_index(src_space, pk, new_index,
+						    new_format);
+	}
+
 	/* Now deal with any kind of add index during normal operation. */
 	struct iterator *it = index_create_iterator(pk, ITER_ALL, NULL, 0);
 	if (it == NULL)
@@ -1442,6 +1771,8 @@ static const struct space_vtab memtx_space_vtab = {
 	/* .ephemeral_replace = */ memtx_space_ephemeral_replace,
 	/* .ephemeral_delete = */ memtx_space_ephemeral_delete,
 	/* .ephemeral_rowid_next = */ memtx_space_ephemeral_rowid_next,
+	/* .ephemeral_begin_build = */ memtx_space_ephemeral_begin_build,
+	/* .ephemeral_end_build = */ memtx_space_ephemeral_end_build,
 	/* .init_system_space = */ memtx_init_system_space,
 	/* .init_ephemeral_space = */ memtx_init_ephemeral_space,
 	/* .check_index_def = */ memtx_space_check_index_def,
@@ -1495,5 +1826,6 @@ memtx_space_new(struct memtx_engine *memtx,
 	memset(&memtx_space->tuple_stat, 0, sizeof(memtx_space->tuple_stat));
 	memtx_space->rowid = 0;
 	memtx_space->replace = memtx_space_replace_no_keys;
+	memtx_space->version = ++memtx->space_version;
 	return (struct space *)memtx_space;
 }
@@ -62,8 +62,21 @@ struct memtx_space {
 	 */
 	int (*replace)(struct space *, struct tuple *, struct tuple *,
 		       enum dup_replace_mode, struct tuple **);
+	/**
+	 * Value of memtx_engine::space_version at the last change of
+	 * the space data. Used by checkpoint to find out if the space
+	 * has changed since the last snapshot.
+	 */
+	uint64_t version;
 };
 
+/**
+ * Mark the space data as changed since the last snapshot, see
+ * memtx_space::version.
+ */
+void
+memtx_space_mark_dirty(struct space *space);
+
 /**
  * Update memory usage statistics of a space by subtracting old tuple's sizes
  * and adding new tuple's sizes. Used also for rollback by swapping old and new
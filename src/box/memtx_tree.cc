@@ -120,6 +120,7 @@ memtx_tree_data_is_equal(const struct memtx_tree_data_common *a,
 			       (b)->part_count, (b)->hint, arg)
 #define BPS_TREE_IS_IDENTICAL(a, b) memtx_tree_data_is_equal(&a, &b)
 #define BPS_TREE_NO_DEBUG 1
+#define BPS_INNER_CARD
 #define bps_tree_arg_t struct key_def *
 
 #define BPS_TREE_NAMESPACE NS_NO_HINT
@@ -135,12 +136,20 @@ memtx_tree_data_is_equal(const struct memtx_tree_data_common *a,
 #define BPS_TREE_NAMESPACE NS_USE_HINT
 #define bps_tree_elem_t struct memtx_tree_data<true>
 #define bps_tree_key_t struct memtx_tree_key_data<true> *
+#define BPS_TREE_ELEM_HINT(a) (a).hint
+#define BPS_TREE_KEY_HINT_RANGE(a, arg, lo, hi)\
+	key_hint_range((a)->hint, (a)->part_count, arg, lo, hi)
+#define BPS_TREE_ELEM_HINT_RANGE(a, arg, lo, hi)\
+	key_hint_range((&a)->hint, (arg)->part_count, arg, lo, hi)
 
 #include "salad/bps_tree.h"
 
 #undef BPS_TREE_NAMESPACE
 #undef bps_tree_elem_t
 #undef bps_tree_key_t
+#undef BPS_TREE_ELEM_HINT
+#undef BPS_TREE_KEY_HINT_RANGE
+#undef BPS_TREE_ELEM_HINT_RANGE
 
 #undef BPS_TREE_NAME
 #undef BPS_TREE_BLOCK_SIZE
@@ -149,6 +158,7 @@ memtx_tree_data_is_equal(const struct memtx_tree_data_common *a,
 #undef BPS_TREE_COMPARE_KEY
 #undef BPS_TREE_IS_IDENTICAL
 #undef BPS_TREE_NO_DEBUG
+#undef BPS_INNER_CARD
 #undef bps_tree_arg_t
 
 using namespace NS_NO_HINT;
@@ -803,6 +813,191 @@ tree_iterator_start(struct iterator *iterator, struct tuple **ret)
 	       iterator->next_internal(iterator, ret);
 }
 
+enum {
+	/**
+	 * How many tuples ahead of the current one are prefetched when
+	 * a batch of tuples is fetched from the tree.
+	 */
+	MEMTX_TREE_PREFETCH_DISTANCE = 8,
+};
+
+/**
+ * Implementation of iterator::next_batch. Forward range iterators walk
+ * the tree directly, updating the last fetched tuple once per batch
+ * and prefetching the tuples that follow in the current tree leaf.
+ * If the returned tuples need to be clarified by the transaction
+ * manager, converted before being returned to the user or marked as
+ * accessed for eviction, the tuples are fetched one by one.
+ */
+template <bool USE_HINT>
+static int
+tree_iterator_next_batch(struct iterator *iterator, struct tuple **ret,
+			 uint32_t size, uint32_t *count)
+{
+	uint32_t n = 0;
+	if (iterator->next_internal == tree_iterator_start<USE_HINT>) {
+		/* Position the iterator the regular way first. */
+		if (generic_iterator_next_batch(iterator, ret, 1, &n) != 0)
+			return -1;
+	}
+	struct space *space;
+	struct index *index_base;
+	index_weak_ref_get_checked(&iterator->index_ref, &space, &index_base);
+	struct memtx_tree_index<USE_HINT> *index =
+		(struct memtx_tree_index<USE_HINT> *)index_base;
+	struct tree_iterator<USE_HINT> *it = get_tree_iterator<USE_HINT>(iterator);
+	if (n < size &&
+	    iterator->next_internal == tree_iterator_next<USE_HINT> &&
+	    !memtx_tx_manager_use_mvcc_engine &&
+	    (space == NULL ||
+	     (space->upgrade == NULL && !space->def->opts.is_cache))) {
+		memtx_tree_t<USE_HINT> *tree = &index->tree;
+		assert(it->last.tuple != NULL);
+		struct memtx_tree_data<USE_HINT> *check =
+			memtx_tree_iterator_get_elem(tree, &it->tree_iterator);
+		if (check == NULL ||
+		    !memtx_tree_data_is_equal(check, &it->last)) {
+			it->tree_iterator = memtx_tree_upper_bound_elem(
+					tree, it->last, NULL);
+		} else {
+			memtx_tree_iterator_next(tree, &it->tree_iterator);
+		}
+		struct memtx_tree_data<USE_HINT> *last = NULL;
+		/* Number of elements following res already prefetched. */
+		size_t prefetched = 0;
+		while (true) {
+			size_t leaf_count;
+			struct memtx_tree_data<USE_HINT> *res =
+				memtx_tree_iterator_get_leaf_elems(
+					tree, &it->tree_iterator, &leaf_count);
+			if (res == NULL) {
+				iterator->next_internal =
+					exhausted_iterator_next;
+				break;
+			}
+			/*
+			 * Tuples are scattered in memory, so load the ones
+			 * following in the same leaf in advance to overlap
+			 * the cache misses.
+			 */
+			size_t ahead = MIN(leaf_count - 1,
+					   MEMTX_TREE_PREFETCH_DISTANCE);
+			for (; prefetched < ahead; prefetched++)
+				__builtin_prefetch(res[prefetched + 1].tuple);
+			/* Compressed tuples are handled below. */
+			if (tuple_is_compressed(res->tuple))
+				break;
+			tuple_ref(res->tuple);
+			ret[n++] = res->tuple;
+			last = res;
+			if (n == size)
+				break;
+			if (prefetched > 0)
+				prefetched--;
+			memtx_tree_iterator_next(tree, &it->tree_iterator);
+		}
+		if (last != NULL)
+			tree_iterator_set_last(it, last);
+	}
+	if (n < size) {
+		uint32_t tail;
+		if (generic_iterator_next_batch(iterator, ret + n, size - n,
+						&tail) != 0) {
+			for (uint32_t i = 0; i < n; i++)
+				tuple_unref(ret[i]);
+			*count = 0;
+			return -1;
+		}
+		n += tail;
+	}
+	*count = n;
+	return 0;
+}
+
+/**
+ * Implementation of iterator::skip. Without the transaction manager
+ * all tuples stored in the tree are visible, so the iterator is moved
+ * by the offset of the last fetched tuple in the tree instead of
+ * fetching the skipped tuples one by one.
+ */
+template <bool USE_HINT>
+static int
+tree_iterator_skip(struct iterator *iterator, uint32_t count,
+		   uint32_t *skipped)
+{
+	uint32_t n = 0;
+	if (count > 0 &&
+	    iterator->next_internal == tree_iterator_start<USE_HINT>) {
+		/* Position the iterator the regular way first. */
+		if (generic_iterator_skip(iterator, 1, &n) != 0) {
+			*skipped = 0;
+			return -1;
+		}
+	}
+	bool is_forward = iterator->next_internal ==
+				tree_iterator_next<USE_HINT> ||
+			  iterator->next_internal ==
+				tree_iterator_next_equal<USE_HINT>;
+	bool is_reverse = iterator->next_internal ==
+				tree_iterator_prev<USE_HINT> ||
+			  iterator->next_internal ==
+				tree_iterator_prev_equal<USE_HINT>;
+	if (n == count || memtx_tx_manager_use_mvcc_engine ||
+	    (!is_forward && !is_reverse)) {
+		uint32_t tail = 0;
+		int rc = generic_iterator_skip(iterator, count - n, &tail);
+		*skipped = n + tail;
+		return rc;
+	}
+	struct index *index_base =
+		index_weak_ref_get_index_checked(&iterator->index_ref);
+	struct memtx_tree_index<USE_HINT> *index =
+		(struct memtx_tree_index<USE_HINT> *)index_base;
+	struct tree_iterator<USE_HINT> *it = get_tree_iterator<USE_HINT>(iterator);
+	memtx_tree_t<USE_HINT> *tree = &index->tree;
+	assert(it->last.tuple != NULL);
+	/*
+	 * The last fetched tuple may have been deleted from the tree,
+	 * in this case its successor is found.
+	 */
+	bool exact;
+	size_t offset;
+	memtx_tree_lower_bound_elem_get_offset(tree, it->last, &exact,
+					       &offset);
+	/* Range [begin, end) of offsets of the tuples to skip. */
+	size_t begin, end;
+	if (is_forward) {
+		begin = exact ? offset + 1 : offset;
+		end = memtx_tree_size(tree);
+		if (iterator->next_internal ==
+		    tree_iterator_next_equal<USE_HINT>) {
+			memtx_tree_upper_bound_get_offset(tree, &it->key_data,
+							  NULL, &end);
+		}
+		end = MIN(end, begin + (count - n));
+	} else {
+		end = offset;
+		begin = 0;
+		if (iterator->next_internal ==
+		    tree_iterator_prev_equal<USE_HINT>) {
+			memtx_tree_lower_bound_get_offset(tree, &it->key_data,
+							  NULL, &begin);
+		}
+		begin = MAX(begin, end > count - n ? end - (count - n) : 0);
+	}
+	if (begin < end) {
+		it->tree_iterator = memtx_tree_iterator_at(
+			tree, is_forward ? end - 1 : begin);
+		struct memtx_tree_data<USE_HINT> *res =
+			memtx_tree_iterator_get_elem(tree, &it->tree_iterator);
+		assert(res != NULL);
+		tree_iterator_set_last(it, res);
+		n += end - begin;
+	}
+	*skipped = n;
+	return 0;
+}
+
 /* }}} */
 
 /* {{{ MemtxTree  **********************************************************/
@@ -877,6 +1072,13 @@ memtx_tree_index_destroy(struct index *base)
 		(struct memtx_tree_index<USE_HINT> *)base;
 	struct memtx_engine *memtx = (struct memtx_engine *)base->engine;
 	if (base->def->iid == 0) {
+		/*
+		 * The index may be dropped before a bulk load completes,
+		 * see memtx_space_ephemeral_begin_build(). The collected
+		 * tuples are referenced by memtx_space_replace_build_next().
+		 */
+		for (size_t i = 0; i < index->build_array_size; i++)
+			tuple_unref(index->build_array[i].tuple);
 		/*
 		 * Primary index. We need to free all tuples stored
 		 * in the index, which may take a while. Schedule a
@@ -977,7 +1179,50 @@ memtx_tree_index_count(struct index *base, enum iterator_type type,
 {
 	if (type == ITER_ALL)
 		return memtx_tree_index_size<USE_HINT>(base); /* optimization */
-	return generic_index_count(base, type, key, part_count);
+	/*
+	 * Without the transaction manager all tuples stored in the tree
+	 * are visible so the count can be calculated from the offsets of
+	 * the range bounds in O(log(N)).
+	 */
+	if (memtx_tx_manager_use_mvcc_engine || type > ITER_GT)
+		return generic_index_count(base, type, key, part_count);
+	struct memtx_tree_index<USE_HINT> *index =
+		(struct memtx_tree_index<USE_HINT> *)base;
+	memtx_tree_t<USE_HINT> *tree = &index->tree;
+	size_t size = memtx_tree_size(tree);
+	if (part_count == 0)
+		return size;
+	struct memtx_tree_key_data<USE_HINT> key_data;
+	key_data.key = key;
+	key_data.part_count = part_count;
+	if (USE_HINT) {
+		struct key_def *cmp_def = memtx_tree_cmp_def(tree);
+		key_data.set_hint(key_hint(key, part_count, cmp_def));
+	}
+	size_t lower = 0;
+	size_t upper = 0;
+	if (type != ITER_GT && type != ITER_LE)
+		memtx_tree_lower_bound_get_offset(tree, &key_data, NULL,
+						  &lower);
+	if (type != ITER_GE && type != ITER_LT)
+		memtx_tree_upper_bound_get_offset(tree, &key_data, NULL,
+						  &upper);
+	switch (type) {
+	case ITER_EQ:
+	case ITER_REQ:
+		return upper - lower;
+	case ITER_GE:
+		return size - lower;
+	case ITER_GT:
+		return size - upper;
+	case ITER_LT:
+		return lower;
+	case ITER_LE:
+		return upper;
+	default:
+		unreachable();
+	}
+	return 0;
 }
 
 template <bool USE_HINT>
@@ -1634,6 +1879,8 @@ memtx_tree_index_create_iterator(struct index *base, enum iterator_type type,
 	it->pool = &memtx->iterator_pool;
 	it->base.next_internal = tree_iterator_start<USE_HINT>;
 	it->base.next = memtx_iterator_next;
+	it->base.next_batch = tree_iterator_next_batch<USE_HINT>;
+	it->base.skip = tree_iterator_skip<USE_HINT>;
 	it->base.free = tree_iterator_free<USE_HINT>;
 	if (base->def->key_def->for_func_index) {
 		assert(USE_HINT);
@@ -1736,17 +1983,18 @@ memtx_tree_index_build_array_append(struct memtx_tree_index<USE_HINT> *index,
 	return 0;
 }
 
+/**
+ * Tuples are appended to the build_array as is, their hints are calculated
+ * and excluded tuples are filtered out on end_build, possibly in several
+ * threads, see memtx_tree_index_build_array_prepare().
+ */
 template <bool USE_HINT>
 static int
 memtx_tree_index_build_next(struct index *base, struct tuple *tuple)
 {
-	if (tuple_key_is_excluded(tuple, base->def->key_def, MULTIKEY_NONE))
-		return 0;
 	struct memtx_tree_index<USE_HINT> *index =
 		(struct memtx_tree_index<USE_HINT> *)base;
-	struct key_def *cmp_def = memtx_tree_cmp_def(&index->tree);
-	return memtx_tree_index_build_array_append(index, tuple,
-						   tuple_hint(tuple, cmp_def));
+	return memtx_tree_index_build_array_append(index, tuple, HINT_NONE);
 }
 
 static int
@@ -1803,6 +2051,106 @@ memtx_tree_func_index_build_next(struct index *base, struct tuple *tuple)
 	return -1;
 }
 
+/**
+ * Counts keys of all the tuples first so that the build_array is grown
+ * at most once per batch.
+ */
+static int
+memtx_tree_index_build_next_batch_multikey(struct index *base,
+					   struct tuple **tuples,
+					   uint32_t count)
+{
+	struct memtx_tree_index<true> *index = (struct memtx_tree_index<true> *)base;
+	struct key_def *cmp_def = memtx_tree_cmp_def(&index->tree);
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	uint32_t *multikey_counts = xregion_alloc_array(region, uint32_t,
+							count);
+	size_t total = index->build_array_size;
+	for (uint32_t i = 0; i < count; i++) {
+		multikey_counts[i] = tuple_multikey_count(tuples[i], cmp_def);
+		total += multikey_counts[i];
+	}
+	if (total > index->build_array_alloc_size) {
+		size_t alloc_size = MAX(total, index->build_array_alloc_size +
+			DIV_ROUND_UP(index->build_array_alloc_size, 2));
+		struct memtx_tree_data<true> *tmp =
+			(struct memtx_tree_data<true> *)realloc(
+				index->build_array, alloc_size * sizeof(*tmp));
+		if (tmp == NULL) {
+			diag_set(OutOfMemory, alloc_size * sizeof(*tmp),
+				 "memtx_tree_index", "build_next");
+			region_truncate(region, region_svp);
+			return -1;
+		}
+		index->build_array = tmp;
+		index->build_array_alloc_size = alloc_size;
+	}
+	for (uint32_t i = 0; i < count; i++) {
+		struct tuple *tuple = tuples[i];
+		for (uint32_t multikey_idx = 0;
+		     multikey_idx < multikey_counts[i]; multikey_idx++) {
+			if (tuple_key_is_excluded(tuple, base->def->key_def,
+						  multikey_idx))
+				continue;
+			struct memtx_tree_data<true> *elem =
+				&index->build_array[index->build_array_size++];
+			elem->tuple = tuple;
+			elem->set_hint(multikey_idx);
+		}
+	}
+	assert(index->build_array_size <= index->build_array_alloc_size);
+	region_truncate(region, region_svp);
+	return 0;
+}
+
+/**
+ * Calls the index function for all the tuples of the batch at once,
+ * see key_list_iterator_create_batch().
+ */
+static int
+memtx_tree_func_index_build_next_batch(struct index *base,
+				       struct tuple **tuples, uint32_t count)
+{
+	struct memtx_engine *memtx = (struct memtx_engine *)base->engine;
+	struct memtx_tree_index<true> *index =
+		(struct memtx_tree_index<true> *)base;
+	struct index_def *index_def = index->base.def;
+	assert(index_def->key_def->for_func_index);
+
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+
+	struct key_list_iterator *its =
+		xregion_alloc_array(region, struct key_list_iterator, count);
+	if (key_list_iterator_create_batch(its, tuples, count, index_def,
+					   false, memtx->func_key_format) != 0) {
+		region_truncate(region, region_svp);
+		return -1;
+	}
+
+	struct tuple *key;
+	uint32_t insert_idx = index->build_array_size;
+	for (uint32_t i = 0; i < count; i++) {
+		while (key_list_iterator_next(&its[i], &key) == 0 &&
+		       key != NULL) {
+			if (memtx_tree_index_build_array_append(
+					index, tuples[i], (hint_t)key) != 0)
+				goto error;
+			tuple_ref(key);
+		}
+		assert(key == NULL);
+	}
+	region_truncate(region, region_svp);
+	return 0;
+error:
+	for (uint32_t i = insert_idx; i < index->build_array_size; i++) {
+		tuple_unref((struct tuple *)index->build_array[i].hint);
+	}
+	region_truncate(region, region_svp);
+	return -1;
+}
+
 /**
  * Process build_array of specified index and remove duplicates
  * of equal tuples (in terms of index's cmp_def and have same
@@ -1844,6 +2192,116 @@ memtx_tree_index_build_array_deduplicate(
 	index->build_array_size = w_idx + 1;
 }
 
+enum {
+	/**
+	 * If the build_array is smaller, hints are calculated in the caller
+	 * thread.
+	 */
+	MEMTX_TREE_BUILD_NOSPAWN_THRESHOLD = 16 * 1024,
+};
+
+/**
+ * Calculates hints of the build_array elements in the range [begin, end)
+ * and replaces tuples excluded from the index with NULL.
+ */
+template <bool USE_HINT>
+static void
+memtx_tree_index_build_array_prepare_range(
+	struct memtx_tree_index<USE_HINT> *index, size_t begin, size_t end)
+{
+	struct key_def *key_def = index->base.def->key_def;
+	struct key_def *cmp_def = memtx_tree_cmp_def(&index->tree);
+	for (size_t i = begin; i < end; i++) {
+		struct memtx_tree_data<USE_HINT> *elem = &index->build_array[i];
+		if (tuple_key_is_excluded(elem->tuple, key_def,
+					  MULTIKEY_NONE)) {
+			elem->tuple = NULL;
+			continue;
+		}
+		if (USE_HINT)
+			elem->set_hint(tuple_hint(elem->tuple, cmp_def));
+	}
+}
+
+/** Thread preparing a part of the build_array. */
+template <bool USE_HINT>
+struct memtx_tree_build_worker {
+	/** The worker cord. */
+	struct cord cord;
+	/** Index being built. */
+	struct memtx_tree_index<USE_HINT> *index;
+	/** Begin of the build_array part processed by this thread. */
+	size_t begin;
+	/** End of the build_array part processed by this thread. */
+	size_t end;
+};
+
+template <bool USE_HINT>
+static int
+memtx_tree_build_worker_f(va_list ap)
+{
+	struct memtx_tree_build_worker<USE_HINT> *worker =
+		va_arg(ap, struct memtx_tree_build_worker<USE_HINT> *);
+	memtx_tree_index_build_array_prepare_range<USE_HINT>(
+		worker->index, worker->begin, worker->end);
+	return 0;
+}
+
+/**
+ * Calculates hints and filters out excluded tuples of the build_array
+ * filled by memtx_tree_index_build_next(). Large arrays are split into
+ * equal parts processed by @a thread_count threads.
+ */
+template <bool USE_HINT>
+static void
+memtx_tree_index_build_array_prepare(struct memtx_tree_index<USE_HINT> *index,
+				     int thread_count)
+{
+	struct key_def *key_def = index->base.def->key_def;
+	if (!USE_HINT && !key_def->has_exclude_null)
+		return;
+	size_t size = index->build_array_size;
+	if (size < MEMTX_TREE_BUILD_NOSPAWN_THRESHOLD || thread_count <= 1) {
+		memtx_tree_index_build_array_prepare_range<USE_HINT>(
+			index, 0, size);
+	} else {
+		struct memtx_tree_build_worker<USE_HINT> *workers =
+			(struct memtx_tree_build_worker<USE_HINT> *)xcalloc(
+				thread_count, sizeof(*workers));
+		size_t part_size = DIV_ROUND_UP(size, thread_count);
+		for (int i = 0; i < thread_count; i++) {
+			struct memtx_tree_build_worker<USE_HINT> *worker =
+				&workers[i];
+			char name[FIBER_NAME_MAX];
+			snprintf(name, sizeof(name), "build.worker.%d", i);
+			worker->index = index;
+			worker->begin = MIN(size, i * part_size);
+			worker->end = MIN(size, worker->begin + part_size);
+			if (cord_costart(&worker->cord, name,
+					 memtx_tree_build_worker_f<USE_HINT>,
+					 worker) != 0) {
+				diag_log();
+				panic("cord_start failed");
+			}
+		}
+		for (int i = 0; i < thread_count; i++) {
+			if (cord_cojoin(&workers[i].cord) != 0) {
+				diag_log();
+				panic("cord_cojoin failed");
+			}
+		}
+		free(workers);
+	}
+	if (!key_def->has_exclude_null)
+		return;
+	size_t w_idx = 0;
+	for (size_t r_idx = 0; r_idx < size; r_idx++) {
+		if (index->build_array[r_idx].tuple != NULL)
+			index->build_array[w_idx++] = index->build_array[r_idx];
+	}
+	index->build_array_size = w_idx;
+}
+
 template <bool USE_HINT>
 static void
 memtx_tree_index_end_build(struct index *base)
@@ -1852,6 +2310,11 @@ memtx_tree_index_end_build(struct index *base)
 		(struct memtx_tree_index<USE_HINT> *)base;
 	struct key_def *cmp_def = memtx_tree_cmp_def(&index->tree);
 	struct memtx_engine *memtx = (struct memtx_engine *)base->engine;
+	struct key_def *key_def = base->def->key_def;
+	if (!key_def->is_multikey && !key_def->for_func_index) {
+		memtx_tree_index_build_array_prepare<USE_HINT>(
+			index, memtx->sort_threads);
+	}
 	tt_sort(index->build_array, index->build_array_size,
 		sizeof(index->build_array[0]), memtx_tree_qcompare<USE_HINT>,
 		cmp_def, memtx->sort_threads);
@@ -1930,22 +2393,37 @@ tree_read_view_free(struct index_read_view *base)
 # include "memtx_tree_read_view.cc"
 #else /* !defined(ENABLE_READ_VIEW) */
 
+/** Implementation of get_raw index_read_view callback. */
 template <bool USE_HINT>
 static int
 tree_read_view_get_raw(struct index_read_view *rv,
 		       const char *key, uint32_t part_count,
 		       struct read_view_tuple *result)
 {
-	(void)rv;
-	(void)key;
-	(void)part_count;
-	(void)result;
-	unreachable();
-	return 0;
+	struct tree_read_view<USE_HINT> *tree_rv =
+		(struct tree_read_view<USE_HINT> *)rv;
+	struct key_def *cmp_def = rv->def->cmp_def;
+	struct memtx_tree_key_data<USE_HINT> key_data;
+	key_data.key = key;
+	key_data.part_count = part_count;
+	if (USE_HINT)
+		key_data.set_hint(key_hint(key, part_count, cmp_def));
+	struct memtx_tree_data<USE_HINT> *res =
+		memtx_tree_view_find(&tree_rv->tree_view, &key_data);
+	if (res == NULL) {
+		*result = read_view_tuple_none();
+		return 0;
+	}
+	return memtx_prepare_read_view_tuple(res->tuple, rv, &tree_rv->cleaner,
+					     result);
 }
 
-/** Implementation of next_raw index_read_view_iterator callback. */
-template <bool USE_HINT>
+/**
+ * Implementation of next_raw index_read_view_iterator callback.
+ * IS_REVERSE is set for iterators moving from greater keys to lesser ones,
+ * IS_EQ is set for iterators returning only tuples that match the key.
+ */
+template <bool USE_HINT, bool IS_REVERSE, bool IS_EQ>
 static int
 tree_read_view_iterator_next_raw(struct index_read_view_iterator *iterator,
 				 struct read_view_tuple *result)
@@ -1959,14 +2437,26 @@ tree_read_view_iterator_next_raw(struct index_read_view_iterator *iterator,
 		struct memtx_tree_data<USE_HINT> *res =
 			memtx_tree_view_iterator_get_elem(&rv->tree_view,
 							  &it->tree_iterator);
-
+		if (res != NULL && IS_EQ &&
+		    tuple_compare_with_key(res->tuple, res->hint,
+					   it->key_data.key,
+					   it->key_data.part_count,
+					   it->key_data.hint,
+					   rv->base.def->key_def) != 0)
+			res = NULL;
 		if (res == NULL) {
+			it->base.next_raw =
+				exhausted_index_read_view_iterator_next_raw;
 			*result = read_view_tuple_none();
 			return 0;
 		}
-
-		memtx_tree_view_iterator_next(&rv->tree_view,
-					      &it->tree_iterator);
+		it->last = res;
+		if (IS_REVERSE)
+			memtx_tree_view_iterator_prev(&rv->tree_view,
+						      &it->tree_iterator);
+		else
+			memtx_tree_view_iterator_next(&rv->tree_view,
+						      &it->tree_iterator);
 		if (memtx_prepare_read_view_tuple(res->tuple, &rv->base,
 						  &rv->cleaner, result) != 0)
 			return -1;
@@ -1975,7 +2465,10 @@ tree_read_view_iterator_next_raw(struct index_read_view_iterator *iterator,
 	}
 }
 
-/** Positions the iterator to the given key. */
+/**
+ * Positions the iterator to the given key. Pagination isn't supported so
+ * the position must be NULL.
+ */
 template <bool USE_HINT>
 static int
 tree_read_view_iterator_start(struct tree_read_view_iterator<USE_HINT> *it,
@@ -1983,26 +2476,88 @@ tree_read_view_iterator_start(struct tree_read_view_iterator<USE_HINT> *it,
 			      const char *key, uint32_t part_count,
 			      const char *pos)
 {
-	assert(type == ITER_ALL);
-	assert(key == NULL);
-	assert(part_count == 0);
+	assert(part_count == 0 || key != NULL);
 	assert(pos == NULL);
-	(void)type;
-	(void)key;
-	(void)part_count;
 	(void)pos;
 	struct tree_read_view<USE_HINT> *rv =
 		(struct tree_read_view<USE_HINT> *)it->base.index;
-	it->base.next_raw = tree_read_view_iterator_next_raw<USE_HINT>;
-	it->tree_iterator = memtx_tree_view_first(&rv->tree_view);
+	if (type > ITER_GT) {
+		diag_set(UnsupportedIndexFeature, rv->base.def,
+			 "requested iterator type");
+		return -1;
+	}
+	if (part_count == 0) {
+		/*
+		 * If no key is specified, downgrade equality
+		 * iterators to a full range.
+		 */
+		type = iterator_type_is_reverse(type) ? ITER_LE : ITER_GE;
+		key = NULL;
+	}
+	if (type == ITER_ALL)
+		type = ITER_GE;
+	bool is_reverse = iterator_type_is_reverse(type);
+	it->key_data.key = key;
+	it->key_data.part_count = part_count;
+	if (USE_HINT) {
+		it->key_data.set_hint(key_hint(key, part_count,
+					       rv->base.def->cmp_def));
+	}
+	if (key == NULL) {
+		it->tree_iterator = is_reverse ?
+				    memtx_tree_view_last(&rv->tree_view) :
+				    memtx_tree_view_first(&rv->tree_view);
+	} else {
+		/*
+		 * Same as in tree_iterator_start(): reverse iterators step
+		 * back from the found position.
+		 */
+		bool unused;
+		if (type == ITER_EQ || type == ITER_GE || type == ITER_LT) {
+			it->tree_iterator = memtx_tree_view_lower_bound(
+				&rv->tree_view, &it->key_data, &unused);
+		} else {
+			it->tree_iterator = memtx_tree_view_upper_bound(
+				&rv->tree_view, &it->key_data, &unused);
+		}
+		if (is_reverse)
+			memtx_tree_view_iterator_prev(&rv->tree_view,
+						      &it->tree_iterator);
+	}
+	switch (type) {
+	case ITER_EQ:
+		it->base.next_raw =
+			tree_read_view_iterator_next_raw<USE_HINT, false, true>;
+		break;
+	case ITER_REQ:
+		it->base.next_raw =
+			tree_read_view_iterator_next_raw<USE_HINT, true, true>;
+		break;
+	case ITER_GE:
+	case ITER_GT:
+		it->base.next_raw =
+			tree_read_view_iterator_next_raw<USE_HINT, false, false>;
+		break;
+	case ITER_LE:
+	case ITER_LT:
+		it->base.next_raw =
+			tree_read_view_iterator_next_raw<USE_HINT, true, false>;
+		break;
+	default:
+		unreachable();
+	}
 	return 0;
 }
 
+/**
+ * The read view owns a copy of the index definition so it's safe to use its
+ * comparison definition even if the index is altered or dropped.
+ */
 template <bool USE_HINT>
 static void
 tree_read_view_reset_key_def(struct tree_read_view<USE_HINT> *rv)
 {
-	rv->tree_view.common.arg = NULL;
+	rv->tree_view.common.arg = rv->base.def->cmp_def;
 }
 
 #endif /* !defined(ENABLE_READ_VIEW) */
@@ -2116,6 +2671,7 @@ static const struct index_vtab memtx_tree_disabled_index_vtab = {
 	/* .count = */ generic_index_count,
 	/* .get_internal = */ generic_index_get_internal,
 	/* .get = */ generic_index_get,
+	/* .prefetch = */ generic_index_prefetch,
 	/* .replace = */ disabled_index_replace,
 	/* .create_iterator = */ generic_index_create_iterator,
 	/* .create_read_view = */ generic_index_create_read_view,
@@ -2125,6 +2681,7 @@ static const struct index_vtab memtx_tree_disabled_index_vtab = {
 	/* .begin_build = */ generic_index_begin_build,
 	/* .reserve = */ generic_index_reserve,
 	/* .build_next = */ disabled_index_build_next,
+	/* .build_next_batch = */ generic_index_build_next_batch,
 	/* .end_build = */ generic_index_end_build,
 };
 
@@ -2176,6 +2733,7 @@ get_memtx_tree_index_vtab(void)
 		/* .count = */ memtx_tree_index_count<USE_HINT>,
 		/* .get_internal */ memtx_tree_index_get_internal<USE_HINT>,
 		/* .get = */ memtx_index_get,
+		/* .prefetch = */ generic_index_prefetch,
 		/* .replace = */ is_mk ? memtx_tree_index_replace_multikey :
 				 is_func ? memtx_tree_func_index_replace :
 				 memtx_tree_index_replace<USE_HINT>,
@@ -2191,6 +2749,10 @@ get_memtx_tree_index_vtab(void)
 		/* .build_next = */ is_mk ? memtx_tree_index_build_next_multikey :
 				    is_func ? memtx_tree_func_index_build_next :
 				    memtx_tree_index_build_next<USE_HINT>,
+		/* .build_next_batch = */
+			is_mk ? memtx_tree_index_build_next_batch_multikey :
+			is_func ? memtx_tree_func_index_build_next_batch :
+			generic_index_build_next_batch,
 		/* .end_build = */ memtx_tree_index_end_build<USE_HINT>,
 	};
 	return &vtab;
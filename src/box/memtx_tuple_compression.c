@@ -0,0 +1,194 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2024, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#include "memtx_tuple_compression.h"
+
+#include "error.h"
+#include "fiber.h"
+#include "memtx_engine.h"
+#include "mp_compression.h"
+#include "mp_extension_types.h"
+#include "msgpuck.h"
+#include "small/region.h"
+#include "trivia/util.h"
+#include "tuple_format.h"
+
+enum {
+	/**
+	 * Fields smaller than this are never compressed: the zstd frame
+	 * header alone would eat all the gain.
+	 */
+	MEMTX_TUPLE_COMPRESSION_MIN_FIELD_SIZE = 32,
+};
+
+/** Checks if the MsgPack value is a compressed field. */
+static inline bool
+mp_is_compressed(const char *data)
+{
+	if (mp_typeof(*data) != MP_EXT)
+		return false;
+	int8_t ext_type;
+	mp_decode_extl(&data, &ext_type);
+	return ext_type == MP_COMPRESSION;
+}
+
+/**
+ * Returns the type the given top-level field [field, field + size) should
+ * be compressed with or COMPRESSION_TYPE_NONE if it should be stored as is.
+ */
+static inline enum compression_type
+memtx_tuple_field_compression_type(struct tuple_format *format,
+				   uint32_t fieldno, const char *field,
+				   size_t size)
+{
+	if (fieldno >= tuple_format_field_count(format) ||
+	    size < MEMTX_TUPLE_COMPRESSION_MIN_FIELD_SIZE ||
+	    mp_is_compressed(field))
+		return COMPRESSION_TYPE_NONE;
+	return tuple_format_field(format, fieldno)->compression_type;
+}
+
+struct tuple *
+memtx_tuple_compress(struct tuple *tuple)
+{
+	struct tuple_format *format = tuple_format(tuple);
+	assert(format->is_compressed);
+	uint32_t data_size;
+	const char *data = tuple_data_range(tuple, &data_size);
+	const char *pos = data;
+	uint32_t field_count = mp_decode_array(&pos);
+	/* The first pass computes the upper bound of the new tuple size. */
+	size_t bound = mp_sizeof_array(field_count);
+	bool has_compressed_fields = false;
+	for (uint32_t i = 0; i < field_count; i++) {
+		const char *field = pos;
+		mp_next(&pos);
+		size_t size = pos - field;
+		enum compression_type type =
+			memtx_tuple_field_compression_type(format, i, field,
+							   size);
+		if (type != COMPRESSION_TYPE_NONE) {
+			has_compressed_fields = true;
+			bound += MAX(size, mp_compress_bound(size));
+		} else {
+			bound += size;
+		}
+	}
+	if (!has_compressed_fields)
+		return tuple;
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	char *buf = xregion_alloc(region, bound);
+	char *buf_end = mp_encode_array(buf, field_count);
+	pos = data;
+	mp_decode_array(&pos);
+	for (uint32_t i = 0; i < field_count; i++) {
+		const char *field = pos;
+		mp_next(&pos);
+		size_t size = pos - field;
+		enum compression_type type =
+			memtx_tuple_field_compression_type(format, i, field,
+							   size);
+		if (type != COMPRESSION_TYPE_NONE) {
+			char *end = mp_compress(buf_end, field, size, type);
+			if (end == NULL) {
+				region_truncate(region, region_svp);
+				return NULL;
+			}
+			/* Keep the field as is if compression didn't help. */
+			if ((size_t)(end - buf_end) < size) {
+				buf_end = end;
+				continue;
+			}
+		}
+		memcpy(buf_end, field, size);
+		buf_end += size;
+	}
+	assert((size_t)(buf_end - buf) <= bound);
+	struct tuple *result = memtx_tuple_new_raw(format, buf, buf_end,
+						   false);
+	region_truncate(region, region_svp);
+	return result;
+}
+
+const char *
+memtx_tuple_decompress_raw(const char *tuple, const char *tuple_end,
+			   uint32_t *p_size)
+{
+	const char *pos = tuple;
+	uint32_t field_count = mp_decode_array(&pos);
+	/* The first pass computes the size of the decompressed tuple. */
+	size_t size = mp_sizeof_array(field_count);
+	bool has_compressed_fields = false;
+	for (uint32_t i = 0; i < field_count; i++) {
+		const char *field = pos;
+		mp_next(&pos);
+		if (!mp_is_compressed(field)) {
+			size += pos - field;
+			continue;
+		}
+		has_compressed_fields = true;
+		size_t field_size = mp_decompress(&field, NULL, 0);
+		if (field_size == 0)
+			return NULL;
+		size += field_size;
+	}
+	assert(pos == tuple_end);
+	(void)tuple_end;
+	if (!has_compressed_fields) {
+		*p_size = tuple_end - tuple;
+		return tuple;
+	}
+	if (size > UINT32_MAX) {
+		diag_set(ClientError, ER_SLAB_ALLOC_MAX, size);
+		return NULL;
+	}
+	struct region *region = &fiber()->gc;
+	char *buf = xregion_alloc(region, size);
+	char *buf_end = mp_encode_array(buf, field_count);
+	pos = tuple;
+	mp_decode_array(&pos);
+	for (uint32_t i = 0; i < field_count; i++) {
+		const char *field = pos;
+		mp_next(&pos);
+		if (!mp_is_compressed(field)) {
+			memcpy(buf_end, field, pos - field);
+			buf_end += pos - field;
+			continue;
+		}
+		size_t field_size = mp_decompress(&field, buf_end,
+						  buf + size - buf_end);
+		if (field_size == 0)
+			return NULL;
+		buf_end += field_size;
+	}
+	assert(buf_end == buf + size);
+	*p_size = size;
+	return buf;
+}
+
+struct tuple *
+memtx_tuple_decompress(struct tuple *tuple)
+{
+	if (!tuple_is_compressed(tuple))
+		return tuple;
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	uint32_t data_size;
+	const char *data = tuple_data_range(tuple, &data_size);
+	uint32_t size;
+	const char *raw = memtx_tuple_decompress_raw(data, data + data_size,
+						     &size);
+	if (raw == NULL) {
+		region_truncate(region, region_svp);
+		return NULL;
+	}
+	if (raw == data)
+		return tuple;
+	struct tuple *result = memtx_tuple_new_raw(tuple_format(tuple), raw,
+						   raw + size, false);
+	region_truncate(region, region_svp);
+	return result;
+}
@@ -17,28 +17,34 @@
 extern "C" {
 #endif
 
-static inline struct tuple *
-memtx_tuple_compress(struct tuple *tuple)
-{
-        (void)tuple;
-        unreachable();
-        return NULL;
-}
-
-static inline struct tuple *
-memtx_tuple_decompress(struct tuple *tuple)
-{
-	assert(!tuple_is_compressed(tuple));
-	return tuple;
-}
-
-static inline const char *
+/**
+ * Returns a copy of the tuple with the fields marked for compression in
+ * the tuple format compressed and encoded in the MP_COMPRESSION MsgPack
+ * extension. Fields that are too small or don't shrink are left as is.
+ * If no field was compressed, returns the tuple itself. The tuple must not
+ * contain compressed fields. Returns NULL on error.
+ */
+struct tuple *
+memtx_tuple_compress(struct tuple *tuple);
+
+/**
+ * Returns a copy of the tuple with all compressed fields decompressed or
+ * the tuple itself if it doesn't contain compressed fields. Returns NULL
+ * on error.
+ */
+struct tuple *
+memtx_tuple_decompress(struct tuple *tuple);
+
+/**
+ * Decompresses all compressed fields of the MsgPack array [tuple,
+ * tuple_end). If there are no compressed fields, returns @a tuple,
+ * otherwise the decompressed data is allocated on the fiber region.
+ * Returns the size of the decompressed data in @a p_size. Returns
+ * NULL on error.
+ */
+const char *
 memtx_tuple_decompress_raw(const char *tuple, const char *tuple_end,
-			   uint32_t *p_size)
-{
-	*p_size = tuple_end - tuple;
-	return tuple;
-}
+			   uint32_t *p_size);
 
 #if defined(__cplusplus)
 } /* extern "C" */
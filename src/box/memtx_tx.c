@@ -107,7 +107,8 @@ struct memtx_story {
 	 */
 	struct rlist reader_list;
 	/**
-	 * Link in tx_manager::all_stories
+	 * Link in tx_manager::all_stories or, if the story is retained
+	 * only by read views, in tx_manager::read_view_stories.
 	 */
 	struct rlist in_all_stories;
 	/**
@@ -568,6 +569,20 @@ struct tx_manager
 	struct memtx_tx_stats retained_tuple_stats[MEMTX_TX_STORY_STATUS_MAX];
 	/** Iterator that sequentially traverses all memtx_story objects. */
 	struct rlist *traverse_all_stories;
+	/**
+	 * Stories that can't be deleted only because they may be visible
+	 * from a read view. They are excluded from the traversal so that
+	 * GC steps aren't wasted on them while the read view is open and
+	 * are returned back all at once when the lowest read view PSN
+	 * passes read_view_stories_psn.
+	 */
+	struct rlist read_view_stories;
+	/**
+	 * Min PSN such that all changes made by transactions with lower
+	 * PSNs are invisible from read views for some story from
+	 * read_view_stories. INT64_MAX if the list is empty.
+	 */
+	int64_t read_view_stories_psn;
 	/** The list containing all transactions. */
 	struct rlist all_txs;
 	/** Accumulated number of GC steps that should be done. */
@@ -616,6 +631,8 @@ memtx_tx_manager_init()
 	rlist_create(&txm.all_stories);
 	rlist_create(&txm.all_txs);
 	txm.traverse_all_stories = &txm.all_stories;
+	rlist_create(&txm.read_view_stories);
+	txm.read_view_stories_psn = INT64_MAX;
 	txm.must_do_gc_steps = 0;
 	memset(&txm.story_stats, 0, sizeof(txm.story_stats));
 }
@@ -1495,12 +1512,63 @@ memtx_tx_story_full_unlink_story_gc_step(struct memtx_story *story)
 	}
 }
 
+/**
+ * Lowest read view PSN.
+ * Default value is txn_next_psn because if it is not so some
+ * stories (stories produced by last txn at least) will be marked as
+ * potentially in read view even though there are no txns in read view.
+ */
+static int64_t
+memtx_tx_lowest_rv_psn(void)
+{
+	if (rlist_empty(&txm.read_view_txs))
+		return txn_next_psn;
+	struct txn *txn = rlist_first_entry(&txm.read_view_txs, struct txn,
+					    in_read_view_txs);
+	assert(txn->rv_psn != 0);
+	return txn->rv_psn;
+}
+
+/**
+ * Return the stories retained by read views back to the traversal if
+ * some of them may be not visible from read views anymore. The stories
+ * are inserted right at the traversal position so that they are checked
+ * by the next GC steps. Returns the number of GC steps required to check
+ * all of them.
+ */
+static size_t
+memtx_tx_story_gc_release_read_view_stories(int64_t lowest_rv_psn)
+{
+	if (lowest_rv_psn <= txm.read_view_stories_psn)
+		return 0;
+	assert(!rlist_empty(&txm.read_view_stories));
+	struct rlist *first = rlist_first(&txm.read_view_stories);
+	rlist_splice_tail(txm.traverse_all_stories, &txm.read_view_stories);
+	txm.traverse_all_stories = first;
+	txm.read_view_stories_psn = INT64_MAX;
+	return txm.story_stats[MEMTX_TX_STORY_READ_VIEW].count;
+}
+
+/**
+ * Exclude a story that can't be deleted only because it may be visible
+ * from a read view from the traversal until the read view is closed.
+ */
+static void
+memtx_tx_story_gc_park_read_view_story(struct memtx_story *story)
+{
+	memtx_tx_story_set_status(story, MEMTX_TX_STORY_READ_VIEW);
+	rlist_del(&story->in_all_stories);
+	rlist_add_tail(&txm.read_view_stories, &story->in_all_stories);
+	txm.read_view_stories_psn = MIN(txm.read_view_stories_psn,
+					MAX(story->add_psn, story->del_psn));
+}
+
 /**
  * Run one step of a crawler that traverses all stories and removes no more
  * used stories.
  */
-void
-memtx_tx_story_gc_step()
+static void
+memtx_tx_story_gc_step_impl(int64_t lowest_rv_psn)
 {
 	if (txm.traverse_all_stories == &txm.all_stories) {
 		/* We came to the head of the list. */
@@ -1508,21 +1576,6 @@ memtx_tx_story_gc_step()
 		return;
 	}
 
-	/*
-	 * Lowest read view PSN.
-	 * Default value is txn_next_psn because if it is not so some
-	 * stories (stories produced by last txn at least) will be marked as
-	 * potentially in read view even though there are no txns in read view.
-	 */
-	int64_t lowest_rv_psn = txn_next_psn;
-	if (!rlist_empty(&txm.read_view_txs)) {
-		struct txn *txn =
-			rlist_first_entry(&txm.read_view_txs, struct txn,
-					  in_read_view_txs);
-		assert(txn->rv_psn != 0);
-		lowest_rv_psn = txn->rv_psn;
-	}
-
 	struct memtx_story *story =
 		rlist_entry(txm.traverse_all_stories, struct memtx_story,
 			    in_all_stories);
@@ -1540,8 +1593,8 @@ memtx_tx_story_gc_step()
 	}
 	if (story->add_psn >= lowest_rv_psn ||
 	    story->del_psn >= lowest_rv_psn) {
-		memtx_tx_story_set_status(story, MEMTX_TX_STORY_READ_VIEW);
 		/* The story can be used by a read view. */
+		memtx_tx_story_gc_park_read_view_story(story);
 		return;
 	}
 	for (uint32_t i = 0; i < story->index_count; i++) {
@@ -1584,11 +1637,22 @@ memtx_tx_story_gc_step()
 	memtx_tx_story_delete(story);
 }
 
+void
+memtx_tx_story_gc_step()
+{
+	int64_t lowest_rv_psn = memtx_tx_lowest_rv_psn();
+	memtx_tx_story_gc_release_read_view_stories(lowest_rv_psn);
+	memtx_tx_story_gc_step_impl(lowest_rv_psn);
+}
+
 void
 memtx_tx_story_gc()
 {
+	int64_t lowest_rv_psn = memtx_tx_lowest_rv_psn();
+	txm.must_do_gc_steps +=
+		memtx_tx_story_gc_release_read_view_stories(lowest_rv_psn);
 	for (size_t i = 0; i < txm.must_do_gc_steps; i++)
-		memtx_tx_story_gc_step();
+		memtx_tx_story_gc_step_impl(lowest_rv_psn);
 	txm.must_do_gc_steps = 0;
 }
 
@@ -36,9 +36,6 @@
 #include <stdint.h>
 #include <stdlib.h>
 
-#define HEAP_FORWARD_DECLARATION
-#include "salad/heap.h"
-
 #include "diag.h"             /* diag_set() */
 #include "box/tuple.h"        /* tuple_ref(), tuple_unref(),
 				 tuple_validate() */
@@ -49,45 +46,52 @@
 
 /* {{{ Merger */
 
+enum {
+	/**
+	 * Max number of tuples a merger fetches from a source
+	 * at once, see merge_source_next_batch().
+	 */
+	MERGER_BATCH_SIZE = 16,
+};
+
 /**
- * Holds a source to fetch next tuples and a last fetched tuple to
- * compare the node against other nodes.
- *
- * The main reason why this structure is separated from a merge
- * source is that a heap node can not be a member of several
- * heaps.
- *
- * The second reason is that it allows to encapsulate all heap
- * related logic inside this compilation unit, without any traces
- * in externally visible structures.
+ * Holds a source to fetch next tuples, a last fetched tuple to
+ * compare the node against other nodes and tuples fetched from
+ * the source in advance.
  */
-struct merger_heap_node {
+struct merger_node {
 	/* A source of tuples. */
 	struct merge_source *source;
 	/*
 	 * A last fetched (refcounted) tuple to compare against
-	 * other nodes.
+	 * other nodes. NULL if the source is exhausted.
 	 */
 	struct tuple *tuple;
-	/* An anchor to make the structure a merger heap node. */
-	struct heap_node in_merger;
+	/*
+	 * Refcounted tuples fetched from the source, but not
+	 * consumed yet: [batch_pos, batch_count).
+	 */
+	struct tuple *batch[MERGER_BATCH_SIZE];
+	uint32_t batch_pos;
+	uint32_t batch_count;
 };
 
-static bool
-merge_source_less(const heap_t *heap, const struct merger_heap_node *left,
-		  const struct merger_heap_node *right);
-#define HEAP_NAME merger_heap
-#define HEAP_LESS merge_source_less
-#define heap_value_t struct merger_heap_node
-#define heap_value_attr in_merger
-#include "salad/heap.h"
-#undef HEAP_NAME
-#undef HEAP_LESS
-#undef heap_value_t
-#undef heap_value_attr
-
 /**
- * Holds a heap, parameters of a merge process and utility fields.
+ * Holds a tree of sources, parameters of a merge process and
+ * utility fields.
+ *
+ * Sources are merged with a tournament tree of losers. The tree
+ * is stored in an array: tree[1] is the root and tree[i] has
+ * children 2i and 2i + 1. Leaves correspond to nodes and have
+ * implicit positions: the node i is the leaf node_count + i.
+ * Each inner vertex stores the index of the node that lost the
+ * match played at the vertex, while tree[0] stores the index of
+ * the overall winner, i.e. the node with the next output tuple.
+ *
+ * When the winner node advances to its next tuple, it replays
+ * the matches on the path from its leaf to the root, which costs
+ * exactly log2(node_count) comparisons, while sifting a binary
+ * heap costs up to twice as many.
  */
 struct merger {
 	/* A merger is a source. */
@@ -95,22 +99,19 @@ struct merger {
 	/*
 	 * Whether a merge process started.
 	 *
-	 * The merger postpones charging of heap nodes until a
-	 * first output tuple is acquired.
+	 * The merger postpones charging of nodes until a first
+	 * output tuple is acquired.
 	 */
 	bool started;
 	/* A key_def to compare tuples. */
 	struct key_def *key_def;
 	/* A format to acquire compatible tuples from sources. */
 	struct tuple_format *format;
-	/*
-	 * A heap of sources (of nodes that contains a source to
-	 * be exact).
-	 */
-	heap_t heap;
-	/* An array of heap nodes. */
+	/* An array of nodes. */
 	uint32_t node_count;
-	struct merger_heap_node *nodes;
+	struct merger_node *nodes;
+	/* A tree of losers, node_count entries. */
+	uint32_t *tree;
 	/* Ascending (false) / descending (true) order. */
 	bool reverse;
 };
@@ -118,75 +119,112 @@ struct merger {
 /* Helpers */
 
 /**
- * Data comparing function to construct a heap of sources.
+ * Return true if the node with index @a left has to be output
+ * before the node with index @a right. An exhausted node goes
+ * after all other nodes.
  */
-static bool
-merge_source_less(const heap_t *heap, const struct merger_heap_node *left,
-		  const struct merger_heap_node *right)
+static inline bool
+merger_node_less(struct merger *merger, uint32_t left, uint32_t right)
 {
-	assert(left->tuple != NULL);
-	assert(right->tuple != NULL);
-	struct merger *merger = container_of(heap, struct merger, heap);
-	int cmp = tuple_compare(left->tuple, HINT_NONE, right->tuple, HINT_NONE,
+	struct tuple *left_tuple = merger->nodes[left].tuple;
+	struct tuple *right_tuple = merger->nodes[right].tuple;
+	if (left_tuple == NULL || right_tuple == NULL)
+		return right_tuple == NULL && left_tuple != NULL;
+	int cmp = tuple_compare(left_tuple, HINT_NONE, right_tuple, HINT_NONE,
 				merger->key_def);
-	return merger->reverse ? cmp >= 0 : cmp < 0;
+	return merger->reverse ? cmp > 0 : cmp < 0;
 }
 
 /**
- * Initialize a new merger heap node.
+ * Initialize a new merger node.
  */
 static void
-merger_heap_node_create(struct merger_heap_node *node,
-			struct merge_source *source)
+merger_node_create(struct merger_node *node, struct merge_source *source)
 {
 	node->source = source;
 	merge_source_ref(node->source);
 	node->tuple = NULL;
-	heap_node_create(&node->in_merger);
+	node->batch_pos = 0;
+	node->batch_count = 0;
 }
 
 /**
- * Free a merger heap node.
+ * Free a merger node.
  */
 static void
-merger_heap_node_delete(struct merger_heap_node *node)
+merger_node_delete(struct merger_node *node)
 {
 	merge_source_unref(node->source);
 	if (node->tuple != NULL)
 		tuple_unref(node->tuple);
+	for (uint32_t i = node->batch_pos; i < node->batch_count; ++i)
+		tuple_unref(node->batch[i]);
 }
 
 /**
- * The helper to add a new heap node to a merger heap.
- *
- * Return -1 at an error and set a diag.
+ * Store a next tuple of the source in node->tuple. The tuple is
+ * taken from the tuples fetched in advance if there are any,
+ * otherwise a next batch is fetched from the source.
  *
- * Otherwise store a next tuple in node->tuple, add the node to
- * merger->heap and return 0.
+ * Return 0 at success. Return -1 at an error and set a diag,
+ * node->tuple is left intact in this case.
  */
 static int
-merger_add_heap_node(struct merger *merger, struct merger_heap_node *node)
+merger_node_next(struct merger *merger, struct merger_node *node)
 {
-	struct tuple *tuple = NULL;
-
-	/* Acquire a next tuple. */
-	struct merge_source *source = node->source;
-	if (merge_source_next(source, merger->format, &tuple) != 0)
-		return -1;
-
-	/* Don't add an empty source to a heap. */
-	if (tuple == NULL)
-		return 0;
-
-	node->tuple = tuple;
+	if (node->batch_pos == node->batch_count) {
+		node->batch_pos = 0;
+		node->batch_count = 0;
+		if (merge_source_next_batch(node->source, merger->format,
+					    node->batch, MERGER_BATCH_SIZE,
+					    &node->batch_count) != 0)
+			return -1;
+		if (node->batch_count == 0) {
+			node->tuple = NULL;
+			return 0;
+		}
+	}
+	node->tuple = node->batch[node->batch_pos++];
+	return 0;
+}
 
-	/* Add a node to a heap. */
-	if (merger_heap_insert(&merger->heap, node) != 0) {
-		diag_set(OutOfMemory, 0, "malloc", "merger->heap");
-		return -1;
+/**
+ * Play the matches of the subtree rooted at the vertex @a pos,
+ * store the losers in the tree and return the winner.
+ */
+static uint32_t
+merger_tree_build(struct merger *merger, uint32_t pos)
+{
+	if (pos >= merger->node_count)
+		return pos - merger->node_count;
+	uint32_t left = merger_tree_build(merger, 2 * pos);
+	uint32_t right = merger_tree_build(merger, 2 * pos + 1);
+	if (merger_node_less(merger, right, left)) {
+		merger->tree[pos] = left;
+		return right;
 	}
+	merger->tree[pos] = right;
+	return left;
+}
 
-	return 0;
+/**
+ * Replay the matches of the node with index @a winner, which
+ * has just advanced to its next tuple, on the path from its leaf
+ * to the root and update the overall winner.
+ */
+static void
+merger_tree_update(struct merger *merger, uint32_t winner)
+{
+	uint32_t *tree = merger->tree;
+	for (uint32_t pos = (merger->node_count + winner) / 2; pos > 0;
+	     pos /= 2) {
+		if (merger_node_less(merger, tree[pos], winner)) {
+			uint32_t loser = winner;
+			winner = tree[pos];
+			tree[pos] = loser;
+		}
+	}
+	tree[0] = winner;
 }
 
 /* Virtual methods declarations */
@@ -210,20 +248,26 @@ static int
 merger_set_sources(struct merger *merger, struct merge_source **sources,
 		   uint32_t source_count)
 {
-	const size_t nodes_size = sizeof(struct merger_heap_node) *
-		source_count;
-	struct merger_heap_node *nodes = malloc(nodes_size);
+	const size_t nodes_size = sizeof(struct merger_node) * source_count;
+	struct merger_node *nodes = malloc(nodes_size);
 	if (nodes == NULL) {
-		diag_set(OutOfMemory, nodes_size, "malloc",
-			 "merger heap nodes");
+		diag_set(OutOfMemory, nodes_size, "malloc", "merger nodes");
+		return -1;
+	}
+	const size_t tree_size = sizeof(uint32_t) * source_count;
+	uint32_t *tree = malloc(tree_size);
+	if (tree == NULL) {
+		diag_set(OutOfMemory, tree_size, "malloc", "merger tree");
+		free(nodes);
 		return -1;
 	}
 
 	for (uint32_t i = 0; i < source_count; ++i)
-		merger_heap_node_create(&nodes[i], sources[i]);
+		merger_node_create(&nodes[i], sources[i]);
 
 	merger->node_count = source_count;
 	merger->nodes = nodes;
+	merger->tree = tree;
 	return 0;
 }
 
@@ -262,15 +306,14 @@ merger_new(struct key_def *key_def, struct merge_source **sources,
 	merger->started = false;
 	merger->key_def = key_def;
 	merger->format = format;
-	merger_heap_create(&merger->heap);
 	merger->node_count = 0;
 	merger->nodes = NULL;
+	merger->tree = NULL;
 	merger->reverse = reverse;
 
 	if (merger_set_sources(merger, sources, source_count) != 0) {
 		key_def_delete(merger->key_def);
 		tuple_format_unref(merger->format);
-		merger_heap_destroy(&merger->heap);
 		free(merger);
 		return NULL;
 	}
@@ -287,14 +330,12 @@ merger_delete(struct merge_source *base)
 
 	key_def_delete(merger->key_def);
 	tuple_format_unref(merger->format);
-	merger_heap_destroy(&merger->heap);
 
 	for (uint32_t i = 0; i < merger->node_count; ++i)
-		merger_heap_node_delete(&merger->nodes[i]);
-
-	if (merger->nodes != NULL)
-		free(merger->nodes);
+		merger_node_delete(&merger->nodes[i]);
 
+	free(merger->nodes);
+	free(merger->tree);
 	free(merger);
 }
 
@@ -304,27 +345,32 @@ merger_next(struct merge_source *base, struct tuple_format *format,
 {
 	struct merger *merger = container_of(base, struct merger, base);
 
+	if (merger->node_count == 0) {
+		*out = NULL;
+		return 0;
+	}
+
 	/*
-	 * Fetch a first tuple for each source and add all heap
-	 * nodes to a merger heap.
+	 * Fetch a first tuple for each source and play the
+	 * initial tournament.
 	 */
 	if (!merger->started) {
 		for (uint32_t i = 0; i < merger->node_count; ++i) {
-			struct merger_heap_node *node = &merger->nodes[i];
-			if (merger_add_heap_node(merger, node) != 0)
+			if (merger_node_next(merger, &merger->nodes[i]) != 0)
 				return -1;
 		}
+		merger->tree[0] = merger_tree_build(merger, 1);
 		merger->started = true;
 	}
 
 	/* Get a next tuple. */
-	struct merger_heap_node *node = merger_heap_top(&merger->heap);
-	if (node == NULL) {
+	uint32_t winner = merger->tree[0];
+	struct merger_node *node = &merger->nodes[winner];
+	struct tuple *tuple = node->tuple;
+	if (tuple == NULL) {
 		*out = NULL;
 		return 0;
 	}
-	struct tuple *tuple = node->tuple;
-	assert(tuple != NULL);
 
 	/* Validate the tuple. */
 	if (format != NULL && tuple_validate(format, tuple) != 0)
@@ -335,15 +381,9 @@ merger_next(struct merge_source *base, struct tuple_format *format,
 	 * *out as refcounted tuple, so we don't unreference it
 	 * here.
 	 */
-	struct merge_source *source = node->source;
-	if (merge_source_next(source, merger->format, &node->tuple) != 0)
+	if (merger_node_next(merger, node) != 0)
 		return -1;
-
-	/* Update a heap. */
-	if (node->tuple == NULL)
-		merger_heap_delete(&merger->heap, node);
-	else
-		merger_heap_update(&merger->heap, node);
+	merger_tree_update(merger, winner);
 
 	*out = tuple;
 	return 0;
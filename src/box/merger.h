@@ -69,6 +69,24 @@ struct merge_source_vtab {
 	 */
 	int (*next)(struct merge_source *base, struct tuple_format *format,
 		    struct tuple **out);
+	/**
+	 * Get up to @a size next tuples (refcounted) from a
+	 * source and store their number in @a count.
+	 *
+	 * A source may return less than @a size tuples even if
+	 * it is not exhausted, e.g. to avoid fetching a next
+	 * chunk of data, but zero @a count means that there are
+	 * no more tuples.
+	 *
+	 * The method is optional: if it is NULL, next() is used
+	 * to fetch one tuple at a time.
+	 *
+	 * Return 0 at success. In case of an error set a diag,
+	 * set @a count to zero and return -1.
+	 */
+	int (*next_batch)(struct merge_source *base,
+			  struct tuple_format *format, struct tuple **out,
+			  uint32_t size, uint32_t *count);
 };
 
 /**
@@ -118,6 +136,25 @@ merge_source_next(struct merge_source *source, struct tuple_format *format,
 	return source->vtab->next(source, format, out);
 }
 
+/**
+ * @see merge_source_vtab
+ */
+static inline int
+merge_source_next_batch(struct merge_source *source,
+			struct tuple_format *format, struct tuple **out,
+			uint32_t size, uint32_t *count)
+{
+	assert(size > 0);
+	if (source->vtab->next_batch != NULL)
+		return source->vtab->next_batch(source, format, out, size,
+						count);
+	*count = 0;
+	if (source->vtab->next(source, format, out) != 0)
+		return -1;
+	*count = *out != NULL ? 1 : 0;
+	return 0;
+}
+
 /**
  * Initialize a base merge source structure.
  */
@@ -0,0 +1,649 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2026, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#include "metrics_export.h"
+
+#include <assert.h>
+#include <ctype.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/uio.h>
+
+#include "applier.h"
+#include "box.h"
+#include "cbus.h"
+#include "coio.h"
+#include "diag.h"
+#include "engine.h"
+#include "evio.h"
+#include "fiber.h"
+#include "fiber_cond.h"
+#include "index.h"
+#include "iostream.h"
+#include "iproto.h"
+#include "replication.h"
+#include "rmean.h"
+#include "say.h"
+#include "schema_def.h"
+#include "small/ibuf.h"
+#include "small/rlist.h"
+#include "space.h"
+#include "trivia/util.h"
+#include "uri/uri.h"
+#include "vclock/vclock.h"
+
+extern struct rmean *rmean_box;
+extern struct rmean *rmean_error;
+
+enum {
+	/** Max size of an HTTP request head. */
+	METRICS_REQUEST_SIZE_MAX = 8192,
+	/** Initial size of a client buffer. */
+	METRICS_BUF_SIZE = 16384,
+	/** Max length of a metric name. */
+	METRICS_NAME_MAX = 128,
+	/** Label offset used for samples without a label. */
+	METRICS_NO_LABEL = UINT32_MAX,
+};
+
+/** Pause between two snapshots, in seconds. */
+static const double METRICS_PERIOD = 1;
+
+/** Timeout of a client read or write, in seconds. */
+static const double METRICS_IO_TIMEOUT = 10;
+
+/** Content type of the Prometheus text exposition format. */
+static const char METRICS_CONTENT_TYPE[] = "text/plain; version=0.0.4";
+
+enum metrics_type {
+	METRICS_COUNTER,
+	METRICS_GAUGE,
+};
+
+static const char *metrics_type_strs[] = {
+	[METRICS_COUNTER] = "counter",
+	[METRICS_GAUGE] = "gauge",
+};
+
+/** A value of a metric with at most one label. */
+struct metrics_sample {
+	/** Metric type. */
+	enum metrics_type type;
+	/** Offset of the metric name in the snapshot strings. */
+	uint32_t name;
+	/** Offset of the label name or METRICS_NO_LABEL. */
+	uint32_t label_name;
+	/** Offset of the label value, unused without a label. */
+	uint32_t label_value;
+	/** Metric value. */
+	double value;
+};
+
+/**
+ * Metric values taken in the tx thread and passed to the metrics
+ * thread. Samples of the same metric go one after another. Once sent,
+ * a snapshot is never modified so the metrics thread may read it
+ * without synchronization.
+ */
+struct metrics_snapshot {
+	/** Message used for passing the snapshot to the metrics thread. */
+	struct cmsg base;
+	/** Array of samples. */
+	struct metrics_sample *samples;
+	/** Number of entries in samples. */
+	uint32_t sample_count;
+	/** Capacity of samples. */
+	uint32_t sample_capacity;
+	/** Zero-terminated names and label values used by samples. */
+	char *strings;
+	/** Size of strings. */
+	uint32_t strings_size;
+	/** Capacity of strings. */
+	uint32_t strings_capacity;
+};
+
+/** A connection to the metrics HTTP endpoint. */
+struct metrics_client {
+	/** Connection stream. */
+	struct iostream io;
+	/** Fiber serving the connection. */
+	struct fiber *fiber;
+	/** Link in metrics::clients. */
+	struct rlist in_clients;
+};
+
+static struct {
+	/** Fiber that takes snapshots in the tx thread. */
+	struct fiber *fiber;
+	/** Set if the metrics thread has been started. */
+	bool is_started;
+	/** Set if the metrics thread listens for scrapes. */
+	bool is_listening;
+	/** Metrics thread. */
+	struct cord cord;
+	/** Pipe from the tx thread to the metrics thread. */
+	struct cpipe metrics_pipe;
+	/*
+	 * The members below are accessed only by the metrics thread.
+	 */
+	/** Pipe from the metrics thread to the tx thread. */
+	struct cpipe tx_pipe;
+	/** Service accepting scrape connections. */
+	struct evio_service service;
+	/** Last received snapshot or NULL. */
+	struct metrics_snapshot *snapshot;
+	/** List of connected clients. */
+	struct rlist clients;
+	/** Signaled when a client disconnects. */
+	struct fiber_cond clients_cond;
+} metrics;
+
+static void
+metrics_snapshot_delete(struct metrics_snapshot *snap)
+{
+	free(snap->samples);
+	free(snap->strings);
+	free(snap);
+}
+
+/** Copies a string to the snapshot and returns its offset. */
+static uint32_t
+metrics_snapshot_add_string(struct metrics_snapshot *snap, const char *str)
+{
+	uint32_t size = strlen(str) + 1;
+	if (snap->strings_size + size > snap->strings_capacity) {
+		uint32_t capacity = MAX(snap->strings_capacity * 2, 1024);
+		capacity = MAX(capacity, snap->strings_size + size);
+		snap->strings = xrealloc(snap->strings, capacity);
+		snap->strings_capacity = capacity;
+	}
+	uint32_t offset = snap->strings_size;
+	memcpy(snap->strings + offset, str, size);
+	snap->strings_size += size;
+	return offset;
+}
+
+/**
+ * Appends a sample to the snapshot. A sample without a label is added
+ * if @a label_name is NULL.
+ */
+static void
+metrics_snapshot_add(struct metrics_snapshot *snap, enum metrics_type type,
+		     const char *name, const char *label_name,
+		     const char *label_value, double value)
+{
+	if (snap->sample_count == snap->sample_capacity) {
+		uint32_t capacity = MAX(snap->sample_capacity * 2, 64);
+		snap->samples = xrealloc(snap->samples,
+					 capacity * sizeof(*snap->samples));
+		snap->sample_capacity = capacity;
+	}
+	struct metrics_sample *sample = &snap->samples[snap->sample_count++];
+	sample->type = type;
+	sample->name = metrics_snapshot_add_string(snap, name);
+	sample->label_name = METRICS_NO_LABEL;
+	sample->label_value = METRICS_NO_LABEL;
+	if (label_name != NULL) {
+		sample->label_name = metrics_snapshot_add_string(snap,
+								 label_name);
+		sample->label_value = metrics_snapshot_add_string(snap,
+								  label_value);
+	}
+	sample->value = value;
+}
+
+/** Converts a string to lower case in place. */
+static void
+metrics_str_tolower(char *str)
+{
+	for (; *str != '\0'; str++)
+		*str = tolower((unsigned char)*str);
+}
+
+/** An rmean_foreach() callback that adds box.stat() counters. */
+static int
+metrics_collect_box_stat(const char *name, int rps, int64_t total,
+			 void *ctx)
+{
+	(void)rps;
+	struct metrics_snapshot *snap = ctx;
+	/* Skip the same items as box.stat(). */
+	if (strcmp(name, "OK") == 0 || strcmp(name, "CALL_16") == 0 ||
+	    strcmp(name, "NOP") == 0)
+		return 0;
+	char operation[METRICS_NAME_MAX];
+	snprintf(operation, sizeof(operation), "%s", name);
+	metrics_str_tolower(operation);
+	metrics_snapshot_add(snap, METRICS_COUNTER, "tnt_stats_op_total",
+			     "operation", operation, total);
+	return 0;
+}
+
+/** An iproto_rmean_foreach() callback that adds box.stat.net() counters. */
+static int
+metrics_collect_net_stat(const char *name, int rps, int64_t total,
+			 void *ctx)
+{
+	(void)rps;
+	struct metrics_snapshot *snap = ctx;
+	char metric[METRICS_NAME_MAX];
+	snprintf(metric, sizeof(metric), "tnt_net_%s_total", name);
+	metrics_str_tolower(metric);
+	metrics_snapshot_add(snap, METRICS_COUNTER, metric, NULL, NULL, total);
+	return 0;
+}
+
+/** A space_foreach() callback that adds the number of tuples in a space. */
+static int
+metrics_collect_space_len(struct space *space, void *ctx)
+{
+	struct metrics_snapshot *snap = ctx;
+	if (space->def->id <= BOX_SYSTEM_ID_MAX)
+		return 0;
+	struct index *pk = space_index(space, 0);
+	ssize_t len = pk != NULL ? index_size(pk) : 0;
+	metrics_snapshot_add(snap, METRICS_GAUGE, "tnt_space_len",
+			     "name", space->def->name, MAX(len, 0));
+	return 0;
+}
+
+/** A space_foreach() callback that adds the size of data in a space. */
+static int
+metrics_collect_space_bsize(struct space *space, void *ctx)
+{
+	struct metrics_snapshot *snap = ctx;
+	if (space->def->id <= BOX_SYSTEM_ID_MAX)
+		return 0;
+	metrics_snapshot_add(snap, METRICS_GAUGE, "tnt_space_bsize",
+			     "name", space->def->name, space_bsize(space));
+	return 0;
+}
+
+/** Adds replication metrics to the snapshot. */
+static void
+metrics_collect_replication(struct metrics_snapshot *snap)
+{
+	char id[16];
+	if (instance_id != REPLICA_ID_NIL) {
+		metrics_snapshot_add(snap, METRICS_GAUGE, "tnt_info_lsn",
+				     NULL, NULL,
+				     vclock_get(box_vclock, instance_id));
+	}
+	replicaset_foreach(replica) {
+		if (replica->id == REPLICA_ID_NIL)
+			continue;
+		snprintf(id, sizeof(id), "%u", replica->id);
+		metrics_snapshot_add(snap, METRICS_GAUGE, "tnt_replication_lsn",
+				     "id", id,
+				     vclock_get(&replicaset.vclock,
+						replica->id));
+	}
+	replicaset_foreach(replica) {
+		struct applier *applier = replica->applier;
+		if (replica->id == REPLICA_ID_NIL || applier == NULL ||
+		    applier->fiber == NULL)
+			continue;
+		snprintf(id, sizeof(id), "%u", replica->id);
+		metrics_snapshot_add(snap, METRICS_GAUGE, "tnt_replication_lag",
+				     "id", id, applier->lag);
+	}
+}
+
+/**
+ * Takes a snapshot of core metrics. Doesn't yield, so all values are
+ * consistent with each other.
+ */
+static struct metrics_snapshot *
+metrics_snapshot_take(void)
+{
+	struct metrics_snapshot *snap = xcalloc(1, sizeof(*snap));
+	rmean_foreach(rmean_box, metrics_collect_box_stat, snap);
+	rmean_foreach(rmean_error, metrics_collect_box_stat, snap);
+	iproto_rmean_foreach(metrics_collect_net_stat, snap);
+
+	struct engine_memory_stat mem;
+	engine_memory_stat(&mem);
+	metrics_snapshot_add(snap, METRICS_GAUGE, "tnt_info_memory_data",
+			     NULL, NULL, mem.data);
+	metrics_snapshot_add(snap, METRICS_GAUGE, "tnt_info_memory_index",
+			     NULL, NULL, mem.index);
+	metrics_snapshot_add(snap, METRICS_GAUGE, "tnt_info_memory_cache",
+			     NULL, NULL, mem.cache);
+	metrics_snapshot_add(snap, METRICS_GAUGE, "tnt_info_memory_tx",
+			     NULL, NULL, mem.tx);
+
+	/* Samples of the same metric must be adjacent. */
+	space_foreach(metrics_collect_space_len, snap);
+	space_foreach(metrics_collect_space_bsize, snap);
+
+	metrics_collect_replication(snap);
+	return snap;
+}
+
+/** Replaces the current snapshot in the metrics thread. */
+static void
+metrics_snapshot_set_f(struct cmsg *msg)
+{
+	struct metrics_snapshot *snap = (struct metrics_snapshot *)msg;
+	if (metrics.snapshot != NULL)
+		metrics_snapshot_delete(metrics.snapshot);
+	metrics.snapshot = snap;
+}
+
+/** Sends a snapshot to the metrics thread. */
+static void
+metrics_snapshot_publish(struct metrics_snapshot *snap)
+{
+	static const struct cmsg_hop route[] = {
+		{metrics_snapshot_set_f, NULL},
+	};
+	cmsg_init(&snap->base, route);
+	cpipe_push(&metrics.metrics_pipe, &snap->base);
+}
+
+static int
+metrics_f(va_list ap)
+{
+	(void)ap;
+	while (!fiber_is_cancelled()) {
+		fiber_sleep(METRICS_PERIOD);
+		if (!metrics.is_listening || fiber_is_cancelled())
+			continue;
+		metrics_snapshot_publish(metrics_snapshot_take());
+	}
+	return 0;
+}
+
+/** Appends formatted output to a buffer. */
+static void CFORMAT(printf, 2, 3)
+metrics_buf_printf(struct ibuf *buf, const char *format, ...)
+{
+	va_list ap;
+	while (true) {
+		va_start(ap, format);
+		int len = vsnprintf(buf->wpos, ibuf_unused(buf), format, ap);
+		va_end(ap);
+		assert(len >= 0);
+		if ((size_t)len < ibuf_unused(buf)) {
+			buf->wpos += len;
+			return;
+		}
+		xibuf_reserve(buf, len + 1);
+	}
+}
+
+/** Appends a label value escaped as required by Prometheus. */
+static void
+metrics_buf_add_label_value(struct ibuf *buf, const char *value)
+{
+	for (; *value != '\0'; value++) {
+		switch (*value) {
+		case '\\':
+			metrics_buf_printf(buf, "\\\\");
+			break;
+		case '"':
+			metrics_buf_printf(buf, "\\\"");
+			break;
+		case '\n':
+			metrics_buf_printf(buf, "\\n");
+			break;
+		default:
+			*(char *)xibuf_alloc(buf, 1) = *value;
+			break;
+		}
+	}
+}
+
+/** Encodes a snapshot in the Prometheus text exposition format. */
+static void
+metrics_snapshot_encode(const struct metrics_snapshot *snap,
+			struct ibuf *buf)
+{
+	const char *prev_name = NULL;
+	for (uint32_t i = 0; i < snap->sample_count; i++) {
+		const struct metrics_sample *sample = &snap->samples[i];
+		const char *name = snap->strings + sample->name;
+		if (prev_name == NULL || strcmp(name, prev_name) != 0) {
+			metrics_buf_printf(buf, "# TYPE %s %s\n", name,
+					   metrics_type_strs[sample->type]);
+			prev_name = name;
+		}
+		metrics_buf_printf(buf, "%s", name);
+		if (sample->label_name != METRICS_NO_LABEL) {
+			metrics_buf_printf(buf, "{%s=\"",
+					   snap->strings + sample->label_name);
+			metrics_buf_add_label_value(
+				buf, snap->strings + sample->label_value);
+			metrics_buf_printf(buf, "\"}");
+		}
+		metrics_buf_printf(buf, " %.17g\n", sample->value);
+	}
+}
+
+/** Sends an HTTP response and returns -1 on failure. */
+static int
+metrics_client_reply(struct metrics_client *client, const char *status,
+		     const char *body, size_t body_size)
+{
+	char head[256];
+	int head_size = snprintf(head, sizeof(head),
+				 "HTTP/1.1 %s\r\n"
+				 "Content-Type: %s\r\n"
+				 "Content-Length: %zu\r\n"
+				 "Connection: close\r\n"
+				 "\r\n", status, METRICS_CONTENT_TYPE,
+				 body_size);
+	assert(head_size > 0 && (size_t)head_size < sizeof(head));
+	struct iovec iov[2] = {
+		{.iov_base = head, .iov_len = head_size},
+		{.iov_base = (char *)body, .iov_len = body_size},
+	};
+	if (coio_writev_timeout(&client->io, iov, lengthof(iov),
+				head_size + body_size,
+				METRICS_IO_TIMEOUT) < 0)
+		return -1;
+	return 0;
+}
+
+/** Sends an HTTP error response with the status as the body. */
+static int
+metrics_client_reply_error(struct metrics_client *client, const char *status)
+{
+	char body[64];
+	int body_size = snprintf(body, sizeof(body), "%s\n", status);
+	return metrics_client_reply(client, status, body, body_size);
+}
+
+/**
+ * Reads an HTTP request and replies to it. Only GET requests of
+ * "/metrics" or "/" are served, the connection is closed after the
+ * reply.
+ */
+static int
+metrics_client_serve(struct metrics_client *client, struct ibuf *buf)
+{
+	const char *head_end;
+	while ((head_end = memmem(buf->rpos, ibuf_used(buf),
+				  "\r\n\r\n", 4)) == NULL) {
+		if (ibuf_used(buf) >= METRICS_REQUEST_SIZE_MAX)
+			return metrics_client_reply_error(client,
+							  "400 Bad Request");
+		xibuf_reserve(buf, METRICS_REQUEST_SIZE_MAX);
+		ssize_t n = coio_read_ahead_timeout(&client->io, buf->wpos, 1,
+						    ibuf_unused(buf),
+						    METRICS_IO_TIMEOUT);
+		if (n < 0)
+			return -1;
+		if (n == 0)
+			return 0;
+		buf->wpos += n;
+	}
+	const char *method = buf->rpos;
+	if (head_end - method < 4 || memcmp(method, "GET ", 4) != 0)
+		return metrics_client_reply_error(client,
+						  "405 Method Not Allowed");
+	const char *path = method + 4;
+	const char *path_end = memchr(path, ' ', head_end - path);
+	if (path_end == NULL)
+		return metrics_client_reply_error(client, "400 Bad Request");
+	const char *query = memchr(path, '?', path_end - path);
+	if (query != NULL)
+		path_end = query;
+	size_t path_len = path_end - path;
+	if (!(path_len == 1 && path[0] == '/') &&
+	    !(path_len == strlen("/metrics") &&
+	      memcmp(path, "/metrics", path_len) == 0))
+		return metrics_client_reply_error(client, "404 Not Found");
+	/*
+	 * Encode the whole snapshot without yielding: it may be
+	 * replaced and freed once we yield.
+	 */
+	ibuf_reset(buf);
+	if (metrics.snapshot != NULL)
+		metrics_snapshot_encode(metrics.snapshot, buf);
+	return metrics_client_reply(client, "200 OK", buf->rpos,
+				    ibuf_used(buf));
+}
+
+static int
+metrics_client_f(va_list ap)
+{
+	struct metrics_client *client = va_arg(ap, struct metrics_client *);
+	struct ibuf buf;
+	ibuf_create(&buf, &cord()->slabc, METRICS_BUF_SIZE);
+	if (metrics_client_serve(client, &buf) != 0 && !fiber_is_cancelled())
+		diag_log();
+	ibuf_destroy(&buf);
+	iostream_close(&client->io);
+	rlist_del_entry(client, in_clients);
+	free(client);
+	fiber_cond_signal(&metrics.clients_cond);
+	return 0;
+}
+
+static void
+metrics_on_accept_cb(struct evio_service *service, struct iostream *io,
+		     struct sockaddr *addr, socklen_t addrlen)
+{
+	(void)service;
+	(void)addr;
+	(void)addrlen;
+	struct fiber *f = fiber_new("metrics_client", metrics_client_f);
+	if (f == NULL) {
+		diag_log();
+		iostream_close(io);
+		return;
+	}
+	struct metrics_client *client = xmalloc(sizeof(*client));
+	iostream_move(&client->io, io);
+	client->fiber = f;
+	rlist_add_entry(&metrics.clients, client, in_clients);
+	fiber_start(f, client);
+}
+
+/** Main function of the metrics thread. */
+static int
+metrics_cord_f(va_list ap)
+{
+	(void)ap;
+	rlist_create(&metrics.clients);
+	fiber_cond_create(&metrics.clients_cond);
+	evio_service_create(loop(), &metrics.service, "metrics",
+			    metrics_on_accept_cb, NULL);
+
+	struct cbus_endpoint endpoint;
+	cbus_endpoint_create(&endpoint, "metrics", fiber_schedule_cb, fiber());
+	cpipe_create(&metrics.tx_pipe, "tx");
+
+	cbus_loop(&endpoint);
+
+	evio_service_stop(&metrics.service);
+	struct metrics_client *client;
+	rlist_foreach_entry(client, &metrics.clients, in_clients)
+		fiber_cancel(client->fiber);
+	while (!rlist_empty(&metrics.clients))
+		fiber_cond_wait(&metrics.clients_cond);
+	fiber_cond_destroy(&metrics.clients_cond);
+
+	cbus_endpoint_destroy(&endpoint, cbus_process);
+	cpipe_destroy(&metrics.tx_pipe);
+	if (metrics.snapshot != NULL) {
+		metrics_snapshot_delete(metrics.snapshot);
+		metrics.snapshot = NULL;
+	}
+	return 0;
+}
+
+struct metrics_listen_msg {
+	struct cbus_call_msg base;
+	/** URIs to listen on. */
+	const struct uri_set *uri_set;
+};
+
+static int
+metrics_listen_f(struct cbus_call_msg *base)
+{
+	struct metrics_listen_msg *msg = (struct metrics_listen_msg *)base;
+	evio_service_stop(&metrics.service);
+	if (msg->uri_set->uri_count == 0)
+		return 0;
+	return evio_service_start(&metrics.service, msg->uri_set);
+}
+
+int
+metrics_export_listen(const struct uri_set *uri_set)
+{
+	if (!metrics.is_started) {
+		if (uri_set->uri_count == 0)
+			return 0;
+		if (cord_costart(&metrics.cord, "metrics", metrics_cord_f,
+				 NULL) != 0)
+			return -1;
+		cpipe_create(&metrics.metrics_pipe, "metrics");
+		metrics.is_started = true;
+	}
+	metrics.is_listening = false;
+	struct metrics_listen_msg msg;
+	msg.uri_set = uri_set;
+	if (cbus_call(&metrics.metrics_pipe, &metrics.tx_pipe, &msg.base,
+		      metrics_listen_f) != 0)
+		return -1;
+	metrics.is_listening = uri_set->uri_count > 0;
+	/* Don't make the first scrape wait for a snapshot. */
+	if (metrics.is_listening && metrics.fiber != NULL)
+		fiber_wakeup(metrics.fiber);
+	return 0;
+}
+
+void
+metrics_export_init(void)
+{
+	metrics.fiber = fiber_new_system("metrics", metrics_f);
+	if (metrics.fiber == NULL)
+		panic("failed to start the metrics fiber");
+	fiber_wakeup(metrics.fiber);
+}
+
+void
+metrics_export_free(void)
+{
+	if (metrics.fiber != NULL) {
+		fiber_cancel(metrics.fiber);
+		metrics.fiber = NULL;
+	}
+	metrics.is_listening = false;
+	if (!metrics.is_started)
+		return;
+	cbus_stop_loop(&metrics.metrics_pipe);
+	cpipe_destroy(&metrics.metrics_pipe);
+	if (cord_join(&metrics.cord) != 0)
+		panic_syserror("metrics cord join failed");
+	metrics.is_started = false;
+}
@@ -0,0 +1,48 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2026, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#pragma once
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+struct uri_set;
+
+/**
+ * Built-in metrics export.
+ *
+ * A system fiber running in the tx thread takes a snapshot of core
+ * counters (request and error statistics, network statistics, memory
+ * usage, user space sizes, replication lag) once a second and sends
+ * it to the metrics thread in a cbus message. The metrics thread keeps
+ * the last received snapshot and serves it over HTTP in the Prometheus
+ * text exposition format. Scrapes are thus handled without involving
+ * the tx thread, which only pays for taking snapshots, and that is
+ * done without yielding or calling Lua.
+ *
+ * The metrics thread is started on the first call to
+ * metrics_export_listen() with a non-empty URI set.
+ */
+
+/** Starts the snapshot fiber. */
+void
+metrics_export_init(void);
+
+/** Stops the snapshot fiber and the metrics thread. */
+void
+metrics_export_free(void);
+
+/**
+ * Makes the metrics thread listen on the given URIs for scrapes.
+ * An empty URI set stops listening. Returns -1 and sets diag on
+ * failure.
+ */
+int
+metrics_export_listen(const struct uri_set *uri_set);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
@@ -0,0 +1,158 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2024, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#include "op_stat.h"
+
+#include <stdlib.h>
+
+#include "histogram.h"
+#include "space.h"
+#include "space_cache.h"
+#include "index.h"
+
+bool op_stat_is_enabled;
+
+/** Allocate statistics, return NULL on memory error. */
+static struct op_stat *
+op_stat_new(void)
+{
+	struct op_stat *stat = calloc(1, sizeof(*stat));
+	if (stat == NULL)
+		return NULL;
+	if (latency_create_fine(&stat->select_latency) != 0) {
+		free(stat);
+		return NULL;
+	}
+	if (latency_create_fine(&stat->write_latency) != 0) {
+		latency_destroy(&stat->select_latency);
+		free(stat);
+		return NULL;
+	}
+	return stat;
+}
+
+void
+op_stat_delete(struct op_stat *stat)
+{
+	if (stat == NULL)
+		return;
+	latency_destroy(&stat->select_latency);
+	latency_destroy(&stat->write_latency);
+	free(stat);
+}
+
+/**
+ * Return the statistics of a space or an index stored at @a ptr,
+ * allocating them if needed. Statistics are not vital, so NULL is
+ * returned silently on memory error.
+ */
+static struct op_stat *
+op_stat_get(struct op_stat **ptr)
+{
+	if (likely(*ptr != NULL))
+		return *ptr;
+	*ptr = op_stat_new();
+	return *ptr;
+}
+
+/** Reset the statistics stored at @a ptr or delete them. */
+static void
+op_stat_clear(struct op_stat **ptr, bool is_delete)
+{
+	struct op_stat *stat = *ptr;
+	if (stat == NULL)
+		return;
+	if (is_delete) {
+		op_stat_delete(stat);
+		*ptr = NULL;
+		return;
+	}
+	stat->select_count = 0;
+	stat->scanned_count = 0;
+	stat->returned_count = 0;
+	stat->write_count = 0;
+	stat->write_bytes = 0;
+	histogram_reset(stat->select_latency.histogram);
+	histogram_reset(stat->write_latency.histogram);
+}
+
+/** Reset or delete the statistics of a space and its indexes. */
+static int
+op_stat_clear_space(struct space *space, void *arg)
+{
+	bool is_delete = *(bool *)arg;
+	op_stat_clear(&space->op_stat, is_delete);
+	for (uint32_t i = 0; i < space->index_count; i++)
+		op_stat_clear(&space->index[i]->op_stat, is_delete);
+	return 0;
+}
+
+void
+op_stat_enable(void)
+{
+	op_stat_is_enabled = true;
+}
+
+void
+op_stat_disable(void)
+{
+	op_stat_is_enabled = false;
+	bool is_delete = true;
+	space_foreach(op_stat_clear_space, &is_delete);
+}
+
+void
+op_stat_reset(void)
+{
+	bool is_delete = false;
+	space_foreach(op_stat_clear_space, &is_delete);
+}
+
+/** Account a select request in the statistics stored at @a ptr. */
+static void
+op_stat_account_select(struct op_stat **ptr, uint64_t scanned,
+		       uint64_t returned, double time)
+{
+	struct op_stat *stat = op_stat_get(ptr);
+	if (stat == NULL)
+		return;
+	stat->select_count++;
+	stat->scanned_count += scanned;
+	stat->returned_count += returned;
+	latency_collect(&stat->select_latency, time);
+}
+
+void
+op_stat_collect_select(uint32_t space_id, uint32_t index_id,
+		       uint64_t scanned, uint64_t returned, double time)
+{
+	/* Could be disabled while the request was in progress. */
+	if (!op_stat_is_enabled)
+		return;
+	struct space *space = space_by_id(space_id);
+	if (space == NULL)
+		return;
+	op_stat_account_select(&space->op_stat, scanned, returned, time);
+	struct index *index = space_index(space, index_id);
+	if (index != NULL)
+		op_stat_account_select(&index->op_stat, scanned, returned,
+				       time);
+}
+
+void
+op_stat_collect_write(uint32_t space_id, uint64_t bytes, double time)
+{
+	if (!op_stat_is_enabled)
+		return;
+	struct space *space = space_by_id(space_id);
+	if (space == NULL)
+		return;
+	struct op_stat *stat = op_stat_get(&space->op_stat);
+	if (stat == NULL)
+		return;
+	stat->write_count++;
+	stat->write_bytes += bytes;
+	latency_collect(&stat->write_latency, time);
+}
@@ -0,0 +1,81 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2024, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "latency.h"
+#include "trivia/util.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+struct space;
+struct index;
+
+/**
+ * Operation statistics of a space or an index. Collected only if
+ * enabled with op_stat_enable(), because they cost a hash lookup
+ * and two clock readings per request. Allocated on the first
+ * operation after enabling. Note that an index keeps its statistics
+ * only until it's rebuilt, and a space until it's altered.
+ */
+struct op_stat {
+	/** Number of select and get requests. */
+	uint64_t select_count;
+	/** Number of tuples read by select requests, including skipped. */
+	uint64_t scanned_count;
+	/** Number of tuples returned by select requests. */
+	uint64_t returned_count;
+	/** Number of write requests. Not collected for indexes. */
+	uint64_t write_count;
+	/** Total size of the write requests bodies, in bytes. */
+	uint64_t write_bytes;
+	/** Latency of select requests. */
+	struct latency select_latency;
+	/** Latency of write requests, including WAL writes. */
+	struct latency write_latency;
+};
+
+/** Set if the operation statistics are collected. */
+extern bool op_stat_is_enabled;
+
+/** Start collecting the operation statistics. */
+void
+op_stat_enable(void);
+
+/** Stop collecting the operation statistics and free them. */
+void
+op_stat_disable(void);
+
+/** Reset the operation statistics of all spaces and indexes. */
+void
+op_stat_reset(void);
+
+/** Free the statistics, called on space or index deletion. */
+void
+op_stat_delete(struct op_stat *stat);
+
+/**
+ * Account a select request to the space and index with the given
+ * ids, if they still exist.
+ */
+void
+op_stat_collect_select(uint32_t space_id, uint32_t index_id,
+		       uint64_t scanned, uint64_t returned, double time);
+
+/**
+ * Account a write request of the given size to the space with the
+ * given id, if it still exists.
+ */
+void
+op_stat_collect_write(uint32_t space_id, uint64_t bytes, double time);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
@@ -51,18 +51,20 @@ enum {
 };
 
 static inline void
-port_c_destroy_entry(struct port_c_entry *pe)
+port_c_destroy_entry(struct port_c *port, struct port_c_entry *pe)
 {
 	/*
 	 * See port_c_add_*() for algorithm of how and where to
 	 * store data, to understand why it is freed differently.
 	 */
-	if (pe->mp_size == 0)
-		tuple_unref(pe->tuple);
-	else if (pe->mp_size <= PORT_ENTRY_SIZE)
+	if (pe->mp_size == 0) {
+		if (!port->is_borrowed)
+			tuple_unref(pe->tuple);
+	} else if (pe->mp_size <= PORT_ENTRY_SIZE) {
 		mempool_free(&port_entry_pool, pe->mp);
-	else
+	} else {
 		free(pe->mp);
+	}
 	if (pe->mp_format != NULL)
 		tuple_format_unref(pe->mp_format);
 }
@@ -74,7 +76,7 @@ port_c_destroy(struct port *base)
 	struct port_c_entry *pe = port->first;
 	if (pe == NULL)
 		return;
-	port_c_destroy_entry(pe);
+	port_c_destroy_entry(port, pe);
 	/*
 	 * Port->first is skipped, it is pointing at
 	 * port_c.first_entry, and is freed together with the
@@ -84,7 +86,7 @@ port_c_destroy(struct port *base)
 	while (pe != NULL) {
 		struct port_c_entry *cur = pe;
 		pe = pe->next;
-		port_c_destroy_entry(cur);
+		port_c_destroy_entry(port, cur);
 		mempool_free(&port_entry_pool, cur);
 	}
 }
@@ -122,7 +124,8 @@ port_c_add_tuple(struct port *base, struct tuple *tuple)
 	/* 0 mp_size means the entry stores a tuple. */
 	pe->mp_size = 0;
 	pe->tuple = tuple;
-	tuple_ref(tuple);
+	if (!port->is_borrowed)
+		tuple_ref(tuple);
 	return 0;
 }
 
@@ -349,6 +352,14 @@ port_c_create(struct port *base)
 	port->first = NULL;
 	port->last = NULL;
 	port->size = 0;
+	port->is_borrowed = false;
+}
+
+void
+port_c_create_borrowed(struct port *base)
+{
+	port_c_create(base);
+	((struct port_c *)base)->is_borrowed = true;
 }
 
 void
@@ -149,6 +149,11 @@ struct port_c {
 	struct port_c_entry *last;
 	struct port_c_entry first_entry;
 	int size;
+	/**
+	 * Set if tuples added to the port aren't referenced,
+	 * see port_c_create_borrowed().
+	 */
+	bool is_borrowed;
 };
 
 static_assert(sizeof(struct port_c) <= sizeof(struct port),
@@ -158,6 +163,18 @@ static_assert(sizeof(struct port_c) <= sizeof(struct port),
 void
 port_c_create(struct port *base);
 
+/**
+ * Create a C port object that doesn't reference tuples added to it.
+ * Referencing a tuple writes to its header, so filling a port with
+ * the result of a wide scan dirties a cache line per tuple even though
+ * the tuples are only read. A borrowed tuple stays alive only as long
+ * as it's stored in a memtx index and the fiber doesn't yield, so such
+ * a port may only be used for tuples read from memtx indexes, and it
+ * must be dumped and destroyed without yielding.
+ */
+void
+port_c_create_borrowed(struct port *base);
+
 /** Append a tuple to the port. Tuple is referenced. */
 int
 port_c_add_tuple(struct port *port, struct tuple *tuple);
@@ -661,6 +661,56 @@ box_raft_election_fencing_resume(void)
 	box_raft_election_fencing_paused = false;
 }
 
+/** Compare lease times in descending order. */
+static int
+box_raft_lease_time_cmp(const void *a, const void *b)
+{
+	double ta = *(const double *)a;
+	double tb = *(const double *)b;
+	return ta < tb ? 1 : ta > tb ? -1 : 0;
+}
+
+double
+box_raft_lease_expiry(void)
+{
+	struct raft *raft = box_raft();
+	if (!raft->is_enabled || raft->state != RAFT_STATE_LEADER ||
+	    box_election_fencing_mode != ELECTION_FENCING_MODE_STRICT ||
+	    box_raft_election_fencing_paused || txn_limbo_is_ro(&txn_limbo))
+		return 0;
+	int quorum = raft->election_quorum;
+	if (quorum <= 1)
+		return 0;
+	double times[VCLOCK_MAX];
+	int count = 0;
+	replicaset_foreach(replica) {
+		if (replica->id == REPLICA_ID_NIL ||
+		    replica->id == instance_id || replica->anon ||
+		    relay_get_state(replica->relay) != RELAY_FOLLOW)
+			continue;
+		double time = relay_leader_ack_time(replica->relay, raft->term);
+		if (time > 0)
+			times[count++] = time;
+	}
+	/* The leader itself is a part of the quorum. */
+	if (count < quorum - 1)
+		return 0;
+	qsort(times, count, sizeof(times[0]), box_raft_lease_time_cmp);
+	/*
+	 * A follower doesn't start elections during the death timeout, which
+	 * is 4 replication timeouts on non-leader nodes, since it heard from
+	 * the leader last time. One replication timeout is subtracted to
+	 * tolerate clock drift and event loop delays.
+	 */
+	return times[quorum - 2] + replication_timeout * 3;
+}
+
+bool
+box_raft_has_lease(void)
+{
+	return box_raft_lease_expiry() > ev_monotonic_now(loop());
+}
+
 void
 box_raft_on_wal_error_f(struct watcher *watcher)
 {
@@ -152,6 +152,25 @@ box_raft_set_election_fencing_mode(enum election_fencing_mode mode);
 void
 box_raft_election_fencing_pause(void);
 
+/**
+ * Return the monotonic time when the leader lease of this instance expires or
+ * 0 if the instance doesn't hold a lease.
+ *
+ * The lease is held by the leader in the strict fencing mode and is renewed by
+ * heartbeats acked by a quorum of followers. Every such follower knows the
+ * leader and won't start new elections for the death timeout since the
+ * heartbeat was sent, so until the lease expires no other leader can be
+ * elected and the leader can serve linearizable reads locally. Strict fencing
+ * makes the leader resign once the quorum is lost, before the followers start
+ * elections. Assumes that replication_timeout is the same on all instances.
+ */
+double
+box_raft_lease_expiry(void);
+
+/** Check if this instance holds a valid leader lease. */
+bool
+box_raft_has_lease(void);
+
 void
 box_raft_init(void);
 
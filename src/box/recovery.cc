@@ -113,6 +113,8 @@ recovery_new(const char *wal_dirname, bool force_recovery,
 
 	r->watcher = NULL;
 	rlist_create(&r->on_close_log);
+	r->buf_file_signature = -1;
+	r->wal_read_size = 0;
 
 	guard.is_active = false;
 	return r;
@@ -207,6 +209,8 @@ recovery_open_log(struct recovery *r, const struct vclock *vclock)
 	 */
 	if (vclock_compare(&r->vclock, vclock) < 0)
 		vclock_copy(&r->vclock, vclock);
+	/* Skip the rows that would be skipped by recover_row() anyway. */
+	xlog_cursor_seek_vclock(&r->cursor, &r->vclock);
 	return;
 
 gap_error:
@@ -236,6 +240,57 @@ recovery_delete(struct recovery *r)
 	free(r);
 }
 
+/**
+ * Feed a row read from the WAL to the stream unless it has already
+ * been recovered. @is_sending_tx is set if the row isn't the last
+ * row of a transaction.
+ */
+static void
+recover_row(struct recovery *r, struct xstream *stream,
+	    struct xrow_header *row, bool *is_sending_tx)
+{
+	/*
+	 * All rows in xlog files have an assigned replica
+	 * id. The only exception are local rows, which
+	 * are signed with a zero replica id.
+	 */
+	assert(row->replica_id != 0 || row->group_id == GROUP_LOCAL);
+	int64_t current_lsn = vclock_get(&r->vclock, row->replica_id);
+	if (row->lsn <= current_lsn) {
+		/*
+		 * Skip the already applied row, if it is not needed to
+		 * preserve transaction boundaries (is not the last row
+		 * of a currently recovered transaction). Otherwise,
+		 * replace it with a NOP, so that the transaction end
+		 * flag reaches the receiver, but the data isn't
+		 * recovered twice.
+		 */
+		if (!*is_sending_tx || !row->is_commit)
+			return; /* already applied, skip */
+		row->type = IPROTO_NOP;
+		row->bodycnt = 0;
+		row->body[0].iov_base = NULL;
+		row->body[0].iov_len = 0;
+	} else {
+		/*
+		 * We can promote the vclock either before or
+		 * after xstream_write(): it only makes any impact
+		 * in case of forced recovery, when we skip the
+		 * failed row anyway.
+		 */
+		vclock_follow_xrow(&r->vclock, row);
+	}
+	*is_sending_tx = !row->is_commit;
+	if (xstream_write(stream, row) != 0) {
+		if (!r->wal_dir.force_recovery)
+			diag_raise();
+
+		say_error("skipping row {%u: %lld}",
+			  (unsigned)row->replica_id, (long long)row->lsn);
+		diag_log();
+	}
+}
+
 /**
  * Read all rows in a file starting from the last position.
  * Advance the position. If end of file is reached,
@@ -249,6 +304,10 @@ recover_xlog(struct recovery *r, struct xstream *stream,
 {
 	struct xrow_header row;
 	bool is_sending_tx = false;
+	off_t start_pos = xlog_cursor_pos(&r->cursor);
+	auto size_guard = make_scoped_guard([&] {
+		r->wal_read_size += xlog_cursor_pos(&r->cursor) - start_pos;
+	});
 	while (xlog_cursor_next_xc(&r->cursor, &row,
 				   r->wal_dir.force_recovery) == 0) {
 		if (++stream->row_count % WAL_ROWS_PER_YIELD == 0) {
@@ -270,46 +329,7 @@ recover_xlog(struct recovery *r, struct xstream *stream,
 		    r->vclock.signature >= stop_vclock->signature)
 			return;
 
-		/*
-		 * All rows in xlog files have an assigned replica
-		 * id. The only exception are local rows, which
-		 * are signed with a zero replica id.
-		 */
-		assert(row.replica_id != 0 || row.group_id == GROUP_LOCAL);
-		int64_t current_lsn = vclock_get(&r->vclock, row.replica_id);
-		if (row.lsn <= current_lsn) {
-			/*
-			 * Skip the already applied row, if it is not needed to
-			 * preserve transaction boundaries (is not the last row
-			 * of a currently recovered transaction). Otherwise,
-			 * replace it with a NOP, so that the transaction end
-			 * flag reaches the receiver, but the data isn't
-			 * recovered twice.
-			 */
-			if (!is_sending_tx || !row.is_commit)
-				continue; /* already applied, skip */
-			row.type = IPROTO_NOP;
-			row.bodycnt = 0;
-			row.body[0].iov_base = NULL;
-			row.body[0].iov_len = 0;
-		} else {
-			/*
-			 * We can promote the vclock either before or
-			 * after xstream_write(): it only makes any impact
-			 * in case of forced recovery, when we skip the
-			 * failed row anyway.
-			 */
-			vclock_follow_xrow(&r->vclock, &row);
-		}
-		is_sending_tx = !row.is_commit;
-		if (xstream_write(stream, &row) != 0) {
-			if (!r->wal_dir.force_recovery)
-				diag_raise();
-
-			say_error("skipping row {%u: %lld}",
-				  (unsigned)row.replica_id, (long long)row.lsn);
-			diag_log();
-		}
+		recover_row(r, stream, &row, &is_sending_tx);
 	}
 }
 
@@ -380,6 +400,51 @@ recover_remaining_wals(struct recovery *r, struct xstream *stream,
 		tnt_raise(XlogGapError, &r->vclock, stop_vclock);
 }
 
+bool
+recover_from_wal_buf(struct recovery *r, struct xstream *stream,
+		     struct ibuf *buf)
+{
+	ibuf_reset(buf);
+	if (wal_buf_read(&r->vclock, buf) != 0)
+		return false;
+	if (xlog_cursor_is_open(&r->cursor)) {
+		/*
+		 * The rest of the current WAL file is going to be read
+		 * from the buffer. Close it and make the next call to
+		 * recover_remaining_wals() look up the WAL file to read
+		 * from by the recovery vclock, like the first one.
+		 */
+		r->buf_file_signature = vclock_sum(&r->cursor.meta.vclock);
+		xlog_cursor_close(&r->cursor, false);
+		r->cursor.state = XLOG_CURSOR_NEW;
+	}
+	bool is_sending_tx = false;
+	while (ibuf_used(buf) > 0) {
+		struct wal_buf_batch *batch = (struct wal_buf_batch *)buf->rpos;
+		const char *data = (const char *)(batch + 1);
+		const char *data_end = data + batch->size;
+		buf->rpos = (char *)data_end;
+		if (batch->file_signature != r->buf_file_signature) {
+			/*
+			 * All rows of the previous WAL file have been
+			 * read, which is equivalent to closing it.
+			 */
+			if (r->buf_file_signature >= 0)
+				trigger_run_xc(&r->on_close_log, NULL);
+			r->buf_file_signature = batch->file_signature;
+		}
+		while (data < data_end) {
+			struct xrow_header row;
+			xrow_header_decode_xc(&row, &data, data_end,
+					      /*end_is_exact=*/false);
+			if (++stream->row_count % WAL_ROWS_PER_YIELD == 0)
+				xstream_yield(stream);
+			recover_row(r, stream, &row, &is_sending_tx);
+		}
+	}
+	return true;
+}
+
 void
 recovery_finalize(struct recovery *r)
 {
@@ -56,6 +56,13 @@ struct recovery {
 	struct fiber *watcher;
 	/** List of triggers invoked when the current WAL is closed. */
 	struct rlist on_close_log;
+	/**
+	 * Signature of the WAL file the rows last read from the WAL
+	 * buffer were written to or -1, see recover_from_wal_buf().
+	 */
+	int64_t buf_file_signature;
+	/** Size of WAL files read by recovery so far, in bytes. */
+	int64_t wal_read_size;
 };
 
 struct recovery *
@@ -104,4 +111,18 @@ void
 recover_remaining_wals(struct recovery *r, struct xstream *stream,
 		       const struct vclock *stop_vclock, bool scan_dir);
 
+/**
+ * Read the rows following the recovery vclock from the buffer of rows
+ * recently written to WAL, see wal_buf_read(), bypassing WAL files.
+ * @buf is used for copying the rows out of the WAL buffer. Invokes
+ * on_close_log triggers when the rows of a WAL file are over, like
+ * recover_remaining_wals().
+ *
+ * Returns false if the rows aren't in the buffer and so have to be
+ * read from files with recover_remaining_wals().
+ */
+bool
+recover_from_wal_buf(struct recovery *r, struct xstream *stream,
+		     struct ibuf *buf);
+
 #endif /* TARANTOOL_RECOVERY_H_INCLUDED */
@@ -40,6 +40,7 @@
 #include "memory.h"
 #include "say.h"
 
+#include "assoc.h"
 #include "coio.h"
 #include "coio_task.h"
 #include "engine.h"
@@ -47,6 +48,7 @@
 #include "iostream.h"
 #include "iproto_constants.h"
 #include "recovery.h"
+#include "schema_def.h"
 #include "replication.h"
 #include "trigger.h"
 #include "vclock/vclock.h"
@@ -57,8 +59,11 @@
 #include "wal.h"
 #include "txn_limbo.h"
 #include "raft.h"
+#include "tt_cpu_set.h"
+#include "usdt.h"
 
 #include <stdlib.h>
+#include <msgpuck.h>
 
 /**
  * Cbus message to send status updates from relay to tx thread.
@@ -76,6 +81,10 @@ struct relay_status_msg {
 	double txn_lag;
 	/** Last vclock sync received in replica's response. */
 	uint64_t vclock_sync;
+	/** Raft term of the last leader heartbeat acked by the replica. */
+	uint64_t lease_term;
+	/** Time when the last leader heartbeat acked by the replica was sent. */
+	double lease_time;
 };
 
 /**
@@ -106,6 +115,10 @@ struct relay_raft_msg {
 	struct relay *relay;
 };
 
+enum {
+	/** Size of the buffer used for writing initial join rows. */
+	RELAY_JOIN_BUF_SIZE = 128 * 1024,
+};
 
 /** State of a replication relay. */
 struct relay {
@@ -121,6 +134,20 @@ struct relay {
 	struct recovery *r;
 	/** Xstream argument to recovery */
 	struct xstream stream;
+	/**
+	 * Initial join rows that haven't been written to the socket yet,
+	 * see relay_send_initial_join_row(). Allocated on demand.
+	 */
+	char *join_buf;
+	/** Size of the data stored in join_buf. */
+	size_t join_buf_used;
+	/** A buffer for rows read from the WAL buffer. */
+	struct ibuf wal_buf;
+	/**
+	 * Set if the last rows were read from the WAL buffer rather
+	 * than from WAL files.
+	 */
+	bool is_reading_wal_buf;
 	/** A region used to save rows when collecting transactions. */
 	struct lsregion lsregion;
 	/** A monotonically growing identifier for lsregion allocations. */
@@ -146,6 +173,28 @@ struct relay {
 	 * Raft term (from tx thread) and PROMOTE (from WAL) dispatch.
 	 */
 	uint64_t sent_raft_term;
+	/**
+	 * The Raft term in which the replica was told that this instance is
+	 * the leader, 0 if it wasn't or the leadership was lost since then.
+	 */
+	uint64_t sent_leader_term;
+	/**
+	 * A leader heartbeat awaiting an ack from the replica. Once acked,
+	 * it proves that the replica has heard from the leader at the time
+	 * the heartbeat was sent, so it extends the leader lease.
+	 */
+	struct {
+		/** Sync of the heartbeat, 0 if there's no heartbeat pending. */
+		uint64_t vclock_sync;
+		/** Raft term of the heartbeat. */
+		uint64_t term;
+		/** Time when the heartbeat was sent. */
+		double time;
+	} lease_probe;
+	/** Raft term of the last acked leader heartbeat. */
+	uint64_t lease_term;
+	/** Time when the last acked leader heartbeat was sent. */
+	double lease_time;
 	/**
 	 * A filter of replica ids whose rows should be ignored.
 	 * Each set filter bit corresponds to a replica id whose
@@ -153,6 +202,13 @@ struct relay {
 	 * is passed by the replica on subscribe.
 	 */
 	uint32_t id_filter;
+	/**
+	 * Ids of the user spaces whose rows should be relayed or NULL
+	 * if rows of all spaces should be. Rows of the other user spaces
+	 * are relayed as NOPs. The set is passed by the replica on
+	 * subscribe.
+	 */
+	struct mh_i32_t *space_filter;
 	/**
 	 * Local vclock at the moment of subscribe, used to check
 	 * dataset on the other side and send missing data rows if any.
@@ -208,6 +264,10 @@ struct relay {
 		double txn_lag;
 		/** Known vclock sync received in response from replica. */
 		uint64_t vclock_sync;
+		/** Raft term of the last acked leader heartbeat. */
+		uint64_t lease_term;
+		/** Time when the last acked leader heartbeat was sent. */
+		double lease_time;
 		/**
 		 * True if the relay is ready to accept messages via the cbus.
 		 */
@@ -263,15 +323,38 @@ relay_txn_lag(const struct relay *relay)
 	return relay->tx.txn_lag;
 }
 
+double
+relay_leader_ack_time(const struct relay *relay, uint64_t term)
+{
+	return relay->tx.lease_term == term ? relay->tx.lease_time : 0;
+}
+
 static void
 relay_send(struct relay *relay, struct xrow_header *packet);
 static void
 relay_send_initial_join_row(struct xstream *stream, struct xrow_header *row);
 
+/** Write initial join rows buffered by relay_send_initial_join_row(). */
+static void
+relay_flush_initial_join(struct relay *relay);
+
 /** Process a single row from the WAL stream. */
 static void
 relay_process_row(struct xstream *stream, struct xrow_header *row);
 
+/** CPUs relay threads are bound to, box.cfg.relay_cpus. */
+static struct tt_cpu_set relay_cpu_set;
+/** Set if relay threads are bound to relay_cpu_set. */
+static bool relay_cpu_set_is_set;
+
+void
+relay_set_cpu_set(const struct tt_cpu_set *cpus)
+{
+	relay_cpu_set_is_set = cpus != NULL;
+	if (cpus != NULL)
+		relay_cpu_set = *cpus;
+}
+
 struct relay *
 relay_new(struct replica *replica)
 {
@@ -344,6 +427,10 @@ relay_start(struct relay *relay, struct iostream *io, uint64_t sync,
 	relay->sync = sync;
 	relay->state = RELAY_FOLLOW;
 	relay->sent_raft_term = sent_raft_term;
+	relay->sent_leader_term = 0;
+	relay->lease_probe.vclock_sync = 0;
+	relay->lease_term = 0;
+	relay->lease_time = 0;
 	relay->need_new_vclock_sync = false;
 	relay->last_row_time = ev_monotonic_now(loop());
 	relay->tx_seen_time = relay->last_row_time;
@@ -394,6 +481,8 @@ relay_stop(struct relay *relay)
 	relay->txn_lag = 0;
 	relay->tx.txn_lag = 0;
 	relay->tx.vclock_sync = 0;
+	relay->tx.lease_term = 0;
+	relay->tx.lease_time = 0;
 }
 
 void
@@ -403,6 +492,7 @@ relay_delete(struct relay *relay)
 		relay_stop(relay);
 	fiber_cond_destroy(&relay->reader_cond);
 	diag_destroy(&relay->diag);
+	free(relay->join_buf);
 	TRASH(relay);
 	free(relay);
 }
@@ -507,6 +597,7 @@ relay_initial_join(struct iostream *io, uint64_t sync, struct vclock *vclock,
 
 	/* Send read view to the replica. */
 	engine_join_xc(&ctx, &relay->stream);
+	relay_flush_initial_join(relay);
 }
 
 int
@@ -595,6 +686,8 @@ tx_status_update(struct cmsg *msg)
 	vclock_copy(&relay->tx.vclock, &status->vclock);
 	relay->tx.txn_lag = status->txn_lag;
 	relay->tx.vclock_sync = status->vclock_sync;
+	relay->tx.lease_term = status->lease_term;
+	relay->tx.lease_time = status->lease_time;
 
 	struct replication_ack ack;
 	ack.source = status->relay->replica->id;
@@ -723,8 +816,19 @@ relay_process_wal_event(struct wal_watcher *watcher, unsigned events)
 		return;
 	}
 	try {
+		if (recover_from_wal_buf(relay->r, &relay->stream,
+					 &relay->wal_buf)) {
+			relay->is_reading_wal_buf = true;
+			return;
+		}
+		/*
+		 * WAL files may have been rotated while we were reading
+		 * the WAL buffer so rescan the WAL directory.
+		 */
 		recover_remaining_wals(relay->r, &relay->stream, NULL,
-				       (events & WAL_EVENT_ROTATE) != 0);
+				       (events & WAL_EVENT_ROTATE) != 0 ||
+				       relay->is_reading_wal_buf);
+		relay->is_reading_wal_buf = false;
 	} catch (Exception *e) {
 		relay_set_error(relay, e);
 		fiber_cancel(fiber());
@@ -768,6 +872,21 @@ relay_reader_f(va_list ap)
 			    vclock_get(&status_msg->vclock, instance_id) <
 			    vclock_get(&last_recv_ack->vclock, instance_id))
 				relay->txn_lag = ev_now(loop()) - xrow.tm;
+			if (relay->lease_probe.vclock_sync != 0 &&
+			    last_recv_ack->vclock_sync >=
+			    relay->lease_probe.vclock_sync) {
+				relay->lease_term = relay->lease_probe.term;
+				relay->lease_time = relay->lease_probe.time;
+				relay->lease_probe.vclock_sync = 0;
+			}
+			/*
+			 * Forward the ack to tx right away rather than let
+			 * the relay fiber do it, because the latter may be
+			 * busy sending a big backlog of rows, while the ack
+			 * may confirm synchronous transactions the limbo is
+			 * waiting for.
+			 */
+			relay_check_status_needs_update(relay);
 			fiber_cond_signal(&relay->reader_cond);
 		}
 	} catch (Exception *e) {
@@ -799,6 +918,13 @@ relay_send_heartbeat(struct relay *relay)
 			row.tm = ev_now(loop());
 		row.replica_id = instance_id;
 		relay->last_heartbeat_time = ev_monotonic_now(loop());
+		if (relay->sent_leader_term != 0 &&
+		    relay->lease_probe.vclock_sync == 0) {
+			relay->lease_probe.vclock_sync =
+				relay->last_sent_ack.vclock_sync;
+			relay->lease_probe.term = relay->sent_leader_term;
+			relay->lease_probe.time = relay->last_heartbeat_time;
+		}
 		relay_send(relay, &row);
 		relay->need_new_vclock_sync = false;
 	} catch (Exception *e) {
@@ -940,7 +1066,8 @@ relay_check_status_needs_update(struct relay *relay)
 	double tx_idle = ev_monotonic_now(loop()) - relay->tx_seen_time;
 	if (vclock_sum(&status_msg->vclock) ==
 	    vclock_sum(send_vclock) && tx_idle <= replication_timeout &&
-	    status_msg->vclock_sync == last_recv_ack->vclock_sync)
+	    status_msg->vclock_sync == last_recv_ack->vclock_sync &&
+	    status_msg->lease_time == relay->lease_time)
 		return;
 	static const struct cmsg_hop route[] = {
 		{tx_status_update, NULL}
@@ -951,6 +1078,8 @@ relay_check_status_needs_update(struct relay *relay)
 	status_msg->relay = relay;
 	status_msg->term = last_recv_ack->term;
 	status_msg->vclock_sync = last_recv_ack->vclock_sync;
+	status_msg->lease_term = relay->lease_term;
+	status_msg->lease_time = relay->lease_time;
 	cpipe_push(&relay->tx_pipe, &status_msg->msg);
 }
 
@@ -964,6 +1093,9 @@ relay_subscribe_f(va_list ap)
 {
 	struct relay *relay = va_arg(ap, struct relay *);
 
+	if (relay_cpu_set_is_set &&
+	    tt_cpu_set_bind_thread(&relay_cpu_set) != 0)
+		diag_log();
 	relay_cord_init(relay);
 
 	cbus_endpoint_create(&relay->tx_endpoint,
@@ -977,6 +1109,9 @@ relay_subscribe_f(va_list ap)
 			     tt_sprintf("relay_wal_%p", relay),
 			     fiber_schedule_cb, fiber());
 
+	ibuf_create(&relay->wal_buf, &cord()->slabc, 16 * 1024);
+	relay->is_reading_wal_buf = false;
+
 	/*
 	 * Setup garbage collection trigger.
 	 * Not needed for anonymous replicas, since they
@@ -1055,6 +1190,7 @@ relay_subscribe_f(va_list ap)
 		    relay_thread_on_stop, relay, cbus_process);
 	cbus_endpoint_destroy(&relay->wal_endpoint, cbus_process);
 	cbus_endpoint_destroy(&relay->tx_endpoint, cbus_process);
+	ibuf_destroy(&relay->wal_buf);
 
 	relay_exit(relay);
 
@@ -1074,7 +1210,8 @@ relay_subscribe_f(va_list ap)
 void
 relay_subscribe(struct replica *replica, struct iostream *io, uint64_t sync,
 		struct vclock *replica_clock, uint32_t replica_version_id,
-		uint32_t replica_id_filter, uint64_t sent_raft_term)
+		uint32_t replica_id_filter, const char *space_filter,
+		uint64_t sent_raft_term, uint64_t sent_leader_term)
 {
 	assert(replica->anon || replica->id != REPLICA_ID_NIL);
 	struct relay *relay = replica->relay;
@@ -1104,6 +1241,7 @@ relay_subscribe(struct replica *replica, struct iostream *io, uint64_t sync,
 		sent_raft_term = UINT64_MAX;
 	relay_start(relay, io, sync, relay_process_row,
 		    relay_yield_and_send_heartbeat, sent_raft_term);
+	relay->sent_leader_term = sent_leader_term;
 	replica_on_relay_follow(replica);
 	auto relay_guard = make_scoped_guard([=] {
 		relay_stop(relay);
@@ -1120,6 +1258,21 @@ relay_subscribe(struct replica *replica, struct iostream *io, uint64_t sync,
 	relay->version_id = replica_version_id;
 
 	relay->id_filter |= replica_id_filter;
+	assert(relay->space_filter == NULL);
+	if (space_filter != NULL) {
+		relay->space_filter = mh_i32_new();
+		uint32_t count = mp_decode_array(&space_filter);
+		for (uint32_t i = 0; i < count; i++) {
+			uint32_t space_id = mp_decode_uint(&space_filter);
+			mh_i32_put(relay->space_filter, &space_id, NULL, NULL);
+		}
+	}
+	auto space_filter_guard = make_scoped_guard([=] {
+		if (relay->space_filter != NULL) {
+			mh_i32_delete(relay->space_filter);
+			relay->space_filter = NULL;
+		}
+	});
 
 	struct cord cord;
 	int rc = cord_costart(&cord, "subscribe", relay_subscribe_f, relay);
@@ -1137,6 +1290,7 @@ relay_send(struct relay *relay, struct xrow_header *packet)
 	packet->sync = relay->sync;
 	relay->last_row_time = ev_monotonic_now(loop());
 	coio_write_xrow(relay->io, packet);
+	USDT_PROBE(relay_row_sent, relay, packet->lsn);
 
 	struct errinj *inj = errinj(ERRINJ_RELAY_TIMEOUT, ERRINJ_DOUBLE);
 	if (inj != NULL && inj->dparam > 0)
@@ -1151,8 +1305,56 @@ relay_send_initial_join_row(struct xstream *stream, struct xrow_header *row)
 	 * Ignore replica local requests as we don't need to promote
 	 * vclock while sending a snapshot.
 	 */
-	if (row->group_id != GROUP_LOCAL)
-		relay_send(relay, row);
+	if (row->group_id == GROUP_LOCAL)
+		return;
+	/*
+	 * Initial join consists of lots of small rows so we collect
+	 * them in a buffer instead of writing each row to the socket
+	 * with a separate system call.
+	 */
+	ERROR_INJECT_YIELD(ERRINJ_RELAY_SEND_DELAY);
+	row->sync = relay->sync;
+	relay->last_row_time = ev_monotonic_now(loop());
+	RegionGuard region_guard(&fiber()->gc);
+	int iovcnt;
+	struct iovec iov[XROW_IOVMAX];
+	xrow_to_iovec(row, iov, &iovcnt);
+	size_t size = 0;
+	for (int i = 0; i < iovcnt; i++)
+		size += iov[i].iov_len;
+	if (relay->join_buf_used + size > RELAY_JOIN_BUF_SIZE)
+		relay_flush_initial_join(relay);
+	if (size > RELAY_JOIN_BUF_SIZE) {
+		if (coio_writev(relay->io, iov, iovcnt, 0) < 0)
+			diag_raise();
+	} else {
+		if (relay->join_buf == NULL)
+			relay->join_buf = (char *)xmalloc(RELAY_JOIN_BUF_SIZE);
+		for (int i = 0; i < iovcnt; i++) {
+			memcpy(relay->join_buf + relay->join_buf_used,
+			       iov[i].iov_base, iov[i].iov_len);
+			relay->join_buf_used += iov[i].iov_len;
+		}
+	}
+	struct errinj *inj = errinj(ERRINJ_RELAY_TIMEOUT, ERRINJ_DOUBLE);
+	if (inj != NULL && inj->dparam > 0) {
+		/* Make the rows visible to the replica one by one. */
+		relay_flush_initial_join(relay);
+		fiber_sleep(inj->dparam);
+	}
+}
+
+static void
+relay_flush_initial_join(struct relay *relay)
+{
+	if (relay->join_buf_used == 0)
+		return;
+	ssize_t rc = coio_write_timeout(relay->io, relay->join_buf,
+					relay->join_buf_used,
+					TIMEOUT_INFINITY);
+	relay->join_buf_used = 0;
+	if (rc < 0)
+		diag_raise();
 }
 
 /**
@@ -1169,6 +1371,16 @@ relay_raft_msg_push(struct cmsg *base)
 	try {
 		relay_send(msg->relay, &row);
 		msg->relay->sent_raft_term = msg->req.term;
+		/*
+		 * Heartbeats sent after this message prove that the replica
+		 * knows the leader, so they can extend the leader lease.
+		 */
+		if (msg->req.state == RAFT_STATE_LEADER) {
+			msg->relay->sent_leader_term = msg->req.term;
+		} else {
+			msg->relay->sent_leader_term = 0;
+			msg->relay->lease_probe.vclock_sync = 0;
+		}
 	} catch (Exception *e) {
 		relay_set_error(msg->relay, e);
 		fiber_cancel(fiber());
@@ -1208,6 +1420,48 @@ relay_push_raft(struct relay *relay, const struct raft_request *req)
 	relay_push_raft_msg(relay);
 }
 
+/**
+ * Returns the id of the space a DML row is for or BOX_ID_NIL if the row
+ * body doesn't have it. IPROTO_SPACE_ID usually goes first in WAL rows,
+ * so this is cheaper than decoding the whole request.
+ */
+static uint32_t
+relay_row_space_id(const struct xrow_header *packet)
+{
+	if (packet->bodycnt == 0)
+		return BOX_ID_NIL;
+	const char *d = (const char *)packet->body[0].iov_base;
+	if (mp_typeof(*d) != MP_MAP)
+		return BOX_ID_NIL;
+	uint32_t size = mp_decode_map(&d);
+	for (uint32_t i = 0; i < size; i++) {
+		if (mp_typeof(*d) != MP_UINT) {
+			mp_next(&d); /* key */
+			mp_next(&d); /* value */
+			continue;
+		}
+		if (mp_decode_uint(&d) != IPROTO_SPACE_ID) {
+			mp_next(&d);
+			continue;
+		}
+		if (mp_typeof(*d) != MP_UINT)
+			return BOX_ID_NIL;
+		uint64_t space_id = mp_decode_uint(&d);
+		return space_id < BOX_ID_NIL ? space_id : BOX_ID_NIL;
+	}
+	return BOX_ID_NIL;
+}
+
+/** Returns true if rows of the given space should be relayed. */
+static inline bool
+relay_space_is_relayed(struct relay *relay, uint32_t space_id)
+{
+	if (space_id <= BOX_SYSTEM_ID_MAX || space_id == BOX_ID_NIL)
+		return true;
+	struct mh_i32_t *h = relay->space_filter;
+	return mh_i32_find(h, space_id, NULL) != mh_end(h);
+}
+
 /** Check if a row should be sent to a remote replica. */
 static bool
 relay_filter_row(struct relay *relay, struct xrow_header *packet)
@@ -1252,6 +1506,16 @@ relay_filter_row(struct relay *relay, struct xrow_header *packet)
 		packet->type = IPROTO_NOP;
 		packet->group_id = GROUP_DEFAULT;
 		packet->bodycnt = 0;
+	} else if (is_subscribe && relay->space_filter != NULL &&
+		   packet->type != IPROTO_NOP &&
+		   iproto_type_is_dml(packet->type) &&
+		   !relay_space_is_relayed(relay, relay_row_space_id(packet))) {
+		/*
+		 * The replica doesn't need rows of this space, but it still
+		 * has to receive the LSN for the sake of vclock convergence.
+		 */
+		packet->type = IPROTO_NOP;
+		packet->bodycnt = 0;
 	}
 
 	/*
@@ -1308,12 +1572,30 @@ relay_save_row(struct relay *relay, struct xrow_header *packet)
 	rlist_add_tail_entry(&relay->current_tx, tx_row, in_tx);
 }
 
-/** Send a full transaction to the replica. */
+/**
+ * Check if rows must be sent one by one, because the relay is slowed
+ * down by error injections.
+ */
+static bool
+relay_send_row_by_row(void)
+{
+	struct errinj *inj = errinj(ERRINJ_RELAY_TIMEOUT, ERRINJ_DOUBLE);
+	if (inj != NULL && inj->dparam > 0)
+		return true;
+	inj = errinj(ERRINJ_RELAY_SEND_DELAY, ERRINJ_BOOL);
+	return inj != NULL && inj->bparam;
+}
+
+/**
+ * Send a full transaction to the replica. The rows are written to
+ * the socket with a single system call. Their bodies are sent as is
+ * from where the recovery has read them, only headers are encoded.
+ */
 static void
 relay_send_tx(struct relay *relay)
 {
 	struct relay_row *item;
-
+	int row_count = 0;
 	rlist_foreach_entry(item, &relay->current_tx, in_tx) {
 		struct xrow_header *packet = &item->row;
 
@@ -1325,7 +1607,27 @@ relay_send_tx(struct relay *relay)
 			say_warn("injected broken lsn: %lld",
 				 (long long) packet->lsn);
 		}
-		relay_send(relay, packet);
+		row_count++;
+	}
+	if (row_count == 1 || relay_send_row_by_row()) {
+		rlist_foreach_entry(item, &relay->current_tx, in_tx)
+			relay_send(relay, &item->row);
+	} else {
+		RegionGuard region_guard(&fiber()->gc);
+		struct iovec *iov = xregion_alloc_array(
+			&fiber()->gc, struct iovec, row_count * XROW_IOVMAX);
+		int iovcnt = 0;
+		rlist_foreach_entry(item, &relay->current_tx, in_tx) {
+			struct xrow_header *packet = &item->row;
+			packet->sync = relay->sync;
+			int row_iovcnt;
+			xrow_to_iovec(packet, iov + iovcnt, &row_iovcnt);
+			iovcnt += row_iovcnt;
+		}
+		relay->last_row_time = ev_monotonic_now(loop());
+		if (coio_writev(relay->io, iov, iovcnt, 0) < 0)
+			diag_raise();
+		USDT_PROBE(relay_tx_sent, relay, row_count);
 	}
 
 	rlist_create(&relay->current_tx);
@@ -41,6 +41,7 @@ struct iostream;
 struct relay;
 struct replica;
 struct tt_uuid;
+struct tt_cpu_set;
 struct vclock;
 
 enum relay_state {
@@ -58,6 +59,13 @@ enum relay_state {
 	RELAY_STOPPED,
 };
 
+/**
+ * Bind threads of relays started after this call to the given CPUs,
+ * box.cfg.relay_cpus.
+ */
+void
+relay_set_cpu_set(const struct tt_cpu_set *cpus);
+
 /** Create a relay which is not running. object. */
 struct relay *
 relay_new(struct replica *replica);
@@ -96,6 +104,15 @@ relay_last_row_time(const struct relay *relay);
 double
 relay_txn_lag(const struct relay *relay);
 
+/**
+ * Returns the time when the last leader heartbeat acked by the replica was
+ * sent or 0 if no heartbeat sent in Raft term @a term was acked. Only the
+ * heartbeats sent after the replica was told that this instance is the leader
+ * are accounted.
+ */
+double
+relay_leader_ack_time(const struct relay *relay, uint64_t term);
+
 /**
  * Makes the relay issue a new vclock sync request and returns the sync to wait
  * for.
@@ -140,11 +157,18 @@ relay_final_join(struct replica *replica, struct iostream *io, uint64_t sync,
 /**
  * Subscribe a replica to updates.
  *
+ * @param space_filter      MsgPack array of ids of the user spaces whose
+ *                          rows should be relayed, NULL to relay all
+ * @param sent_raft_term    the Raft term sent to the replica on subscribe
+ * @param sent_leader_term  the Raft term in which the replica was told on
+ *                          subscribe that this instance is the leader, 0 if
+ *                          it wasn't
  * @return none.
  */
 void
 relay_subscribe(struct replica *replica, struct iostream *io, uint64_t sync,
 		struct vclock *replica_vclock, uint32_t replica_version_id,
-		uint32_t replica_id_filter, uint64_t sent_raft_term);
+		uint32_t replica_id_filter, const char *space_filter,
+		uint64_t sent_raft_term, uint64_t sent_leader_term);
 
 #endif /* TARANTOOL_REPLICATION_RELAY_H_INCLUDED */
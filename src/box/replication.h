@@ -101,6 +101,8 @@ static const int REPLICATION_CONNECT_QUORUM_ALL = INT_MAX;
 
 enum { REPLICATION_THREADS_MAX = 1000 };
 
+enum { REPLICATION_APPLY_FIBERS_MAX = 64 };
+
 enum bootstrap_strategy {
 	BOOTSTRAP_STRATEGY_INVALID = -1,
 	BOOTSTRAP_STRATEGY_AUTO,
@@ -196,6 +198,13 @@ extern int replication_synchro_quorum;
  */
 extern double replication_synchro_timeout;
 
+/**
+ * Time in seconds which the master node waits before writing a
+ * CONFIRM entry for synchronous transactions gathered a quorum, so
+ * that one CONFIRM covers more transactions.
+ */
+extern double replication_synchro_confirm_delay;
+
 /**
  * Max time to wait for appliers to synchronize before entering
  * the orphan mode.
@@ -211,6 +220,12 @@ extern bool replication_skip_conflict;
 /** How many threads to use for decoding incoming replication stream. */
 extern int replication_threads;
 
+/**
+ * Maximal number of transactions of the replication stream applied
+ * concurrently in separate fibers.
+ */
+extern int replication_apply_fibers;
+
 /**
  * A list of triggers fired once quorum of "healthy" connections is acquired.
  */
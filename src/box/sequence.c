@@ -153,6 +153,7 @@ sequence_reset(struct sequence *seq)
 	uint32_t pos = light_sequence_find_key(&sequence_data_index, hash, key);
 	if (pos != light_sequence_end)
 		light_sequence_delete(&sequence_data_index, pos);
+	seq->cache_left = 0;
 }
 
 int
@@ -163,6 +164,7 @@ sequence_set(struct sequence *seq, int64_t value)
 	struct sequence_data new_data, old_data;
 	new_data.id = key;
 	new_data.value = value;
+	seq->cache_left = 0;
 	if (light_sequence_replace(&sequence_data_index, hash,
 				   new_data, &old_data) != light_sequence_end)
 		return 0;
@@ -257,6 +259,74 @@ sequence_next(struct sequence *seq, int64_t *result)
 	goto done;
 }
 
+/**
+ * Return true if the block of values reserved for the sequence
+ * isn't exhausted and the stored sequence value hasn't changed
+ * since the block was reserved.
+ */
+static bool
+sequence_cache_is_valid(struct sequence *seq)
+{
+	if (seq->cache_left == 0)
+		return false;
+	uint32_t key = seq->def->id;
+	uint32_t hash = sequence_hash(key);
+	uint32_t pos = light_sequence_find_key(&sequence_data_index, hash, key);
+	if (pos == light_sequence_end)
+		return false;
+	struct sequence_data data = light_sequence_get(&sequence_data_index,
+						       pos);
+	return data.value == seq->cache_end;
+}
+
+bool
+sequence_next_cached(struct sequence *seq, int64_t *result)
+{
+	if (!sequence_cache_is_valid(seq))
+		return false;
+	seq->cache_value += seq->def->step;
+	seq->cache_left--;
+	assert(seq->cache_value >= seq->def->min &&
+	       seq->cache_value <= seq->def->max);
+	*result = seq->cache_value;
+	return true;
+}
+
+/** Return the absolute value of the sequence step. */
+static inline uint64_t
+sequence_step_abs(struct sequence_def *def)
+{
+	return def->step > 0 ? (uint64_t)def->step :
+	       (uint64_t)0 - (uint64_t)def->step;
+}
+
+int64_t
+sequence_cache_end(struct sequence *seq, int64_t value)
+{
+	struct sequence_def *def = seq->def;
+	if (def->cache <= 1)
+		return value;
+	/* Number of values left until the bound in the step direction. */
+	uint64_t left = def->step > 0 ?
+			(uint64_t)def->max - (uint64_t)value :
+			(uint64_t)value - (uint64_t)def->min;
+	uint64_t count = MIN((uint64_t)def->cache - 1,
+			     left / sequence_step_abs(def));
+	/* Unsigned arithmetic to avoid overflow, the result fits. */
+	return (int64_t)((uint64_t)value + count * (uint64_t)def->step);
+}
+
+void
+sequence_cache_reserve(struct sequence *seq, int64_t value, int64_t end)
+{
+	uint64_t size = seq->def->step > 0 ?
+			(uint64_t)end - (uint64_t)value :
+			(uint64_t)value - (uint64_t)end;
+	seq->cache_value = value;
+	seq->cache_end = end;
+	seq->cache_left = size / sequence_step_abs(seq->def);
+}
+
 int
 access_check_sequence(struct sequence *seq)
 {
@@ -432,5 +502,8 @@ sequence_get_value(struct sequence *seq, int64_t *result)
 	struct sequence_data data = light_sequence_get(&sequence_data_index,
 						       pos);
 	*result = data.value;
+	/* Values reserved for box_sequence_next() aren't handed out yet. */
+	if (sequence_cache_is_valid(seq))
+		*result = seq->cache_value;
 	return 0;
 }
@@ -64,7 +64,10 @@ struct sequence_def {
 	int64_t max;
 	/** Initial sequence value. */
 	int64_t start;
-	/** Number of values to preallocate. Not implemented yet. */
+	/**
+	 * Number of values reserved at once by box_sequence_next(),
+	 * see sequence::cache_end. Values <= 1 disable reservation.
+	 */
 	int64_t cache;
 	/**
 	 * If this flag is set, the sequence will wrap
@@ -82,6 +85,20 @@ struct sequence {
 	struct sequence_def *def;
 	/** Set if the sequence is automatically generated. */
 	bool is_generated;
+	/**
+	 * If the sequence has the cache option set, box_sequence_next()
+	 * advances the stored sequence value by a block of values at
+	 * once and hands out the values of the block from memory, so
+	 * that it doesn't write a row to _sequence_data on each call.
+	 * The block is valid as long as the stored value equals
+	 * @cache_end, i.e. until the sequence is changed in any other
+	 * way.
+	 */
+	int64_t cache_end;
+	/** Last value handed out from the reserved block. */
+	int64_t cache_value;
+	/** Number of values left in the reserved block. */
+	int64_t cache_left;
 	/** Cached runtime access information. */
 	struct access access[BOX_USER_MAX];
 };
@@ -152,6 +169,31 @@ sequence_update(struct sequence *seq, int64_t value);
 int
 sequence_next(struct sequence *seq, int64_t *result);
 
+/**
+ * Take the next value from the block reserved by
+ * sequence_cache_reserve(). Returns false if the block
+ * is exhausted or isn't valid anymore.
+ */
+bool
+sequence_next_cached(struct sequence *seq, int64_t *result);
+
+/**
+ * Return the last value of the block of values to reserve for
+ * the sequence starting with @a value, which was just returned by
+ * sequence_next(). The block is limited by the cache option and by
+ * the sequence bounds. Returns @a value if reservation is disabled.
+ */
+int64_t
+sequence_cache_end(struct sequence *seq, int64_t value);
+
+/**
+ * Start handing out values of the block reserved after
+ * @a value up to @a end, see sequence_cache_end(). Must be
+ * called after @a end has been stored as the sequence value.
+ */
+void
+sequence_cache_reserve(struct sequence *seq, int64_t value, int64_t end);
+
 /**
  * Check whether or not the current user can be granted
  * access to the sequence.
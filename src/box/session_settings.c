@@ -280,6 +280,7 @@ static const struct index_vtab session_settings_index_vtab = {
 	/* .count = */ generic_index_count,
 	/* .get_internal = */ generic_index_get_internal,
 	/* .get = */ session_settings_index_get,
+	/* .prefetch = */ generic_index_prefetch,
 	/* .replace = */ generic_index_replace,
 	/* .create_iterator = */ session_settings_index_create_iterator,
 	/* .create_read_view = */ generic_index_create_read_view,
@@ -289,6 +290,7 @@ static const struct index_vtab session_settings_index_vtab = {
 	/* .begin_build = */ generic_index_begin_build,
 	/* .reserve = */ generic_index_reserve,
 	/* .build_next = */ generic_index_build_next,
+	/* .build_next_batch = */ generic_index_build_next_batch,
 	/* .end_build = */ generic_index_end_build,
 };
 
@@ -427,6 +429,8 @@ const struct space_vtab session_settings_space_vtab = {
 	/* .ephemeral_replace = */ generic_space_ephemeral_replace,
 	/* .ephemeral_delete = */ generic_space_ephemeral_delete,
 	/* .ephemeral_rowid_next = */ generic_space_ephemeral_rowid_next,
+	/* .ephemeral_begin_build = */ generic_space_ephemeral_begin_build,
+	/* .ephemeral_end_build = */ generic_space_ephemeral_end_build,
 	/* .init_system_space = */ generic_init_system_space,
 	/* .init_ephemeral_space = */ generic_init_ephemeral_space,
 	/* .check_index_def = */ generic_space_check_index_def,
@@ -0,0 +1,79 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2026, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#include "slow_request.h"
+
+#include <assert.h>
+#include <string.h>
+
+#include "fiber.h"
+
+double slow_request_threshold = TIMEOUT_INFINITY;
+
+uint32_t slow_request_sample_interval = 1;
+
+uint32_t slow_request_countdown = 1;
+
+static struct {
+	/** Ring buffer of records. */
+	struct slow_request records[SLOW_REQUEST_LOG_SIZE];
+	/** Number of records ever written since the last reset. */
+	uint64_t written;
+} slow_request_log;
+
+void
+slow_request_enable(double threshold, uint32_t sample_interval)
+{
+	assert(threshold >= 0);
+	assert(sample_interval > 0);
+	slow_request_threshold = threshold;
+	slow_request_sample_interval = sample_interval;
+	slow_request_countdown = sample_interval;
+}
+
+void
+slow_request_disable(void)
+{
+	slow_request_threshold = TIMEOUT_INFINITY;
+	slow_request_reset();
+}
+
+void
+slow_request_reset(void)
+{
+	slow_request_log.written = 0;
+}
+
+struct slow_request *
+slow_request_new(void)
+{
+	uint64_t i = slow_request_log.written++ % SLOW_REQUEST_LOG_SIZE;
+	struct slow_request *req = &slow_request_log.records[i];
+	memset(req, 0, sizeof(*req));
+	return req;
+}
+
+void
+slow_request_set_func(struct slow_request *req, const char *func,
+		      uint32_t len)
+{
+	len = MIN(len, SLOW_REQUEST_FUNC_MAX - 1);
+	memcpy(req->func, func, len);
+	req->func[len] = '\0';
+}
+
+uint32_t
+slow_request_count(void)
+{
+	return MIN(slow_request_log.written, SLOW_REQUEST_LOG_SIZE);
+}
+
+const struct slow_request *
+slow_request_get(uint32_t i)
+{
+	assert(i < slow_request_count());
+	uint64_t first = slow_request_log.written - slow_request_count();
+	return &slow_request_log.records[(first + i) % SLOW_REQUEST_LOG_SIZE];
+}
@@ -0,0 +1,129 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2026, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "trivia/util.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+/**
+ * Slow request log.
+ *
+ * Once enabled with slow_request_enable(), every Nth IPROTO request
+ * that takes longer than the threshold is recorded in a ring buffer
+ * along with the breakdown of its time by processing stage and a short
+ * summary of the request. The oldest records are overwritten when the
+ * buffer is full. The stage times are collected for every request
+ * anyway, see iproto_req_latency, so when the log is disabled a request
+ * costs a single comparison.
+ */
+
+enum {
+	/** Number of records kept in the log. */
+	SLOW_REQUEST_LOG_SIZE = 256,
+	/** Max length of a function name or expression in a record. */
+	SLOW_REQUEST_FUNC_MAX = 64,
+};
+
+/** A record of the slow request log. */
+struct slow_request {
+	/** Time the request completed at, since the Epoch. */
+	double time;
+	/** IPROTO request type. */
+	uint32_t type;
+	/** Space id of a DML or SELECT request, 0 otherwise. */
+	uint32_t space_id;
+	/** Index id of a SELECT request, 0 otherwise. */
+	uint32_t index_id;
+	/** Request sync. */
+	uint64_t sync;
+	/** Id of the session that sent the request. */
+	uint64_t session_id;
+	/**
+	 * Function name of a CALL request or expression of an EVAL
+	 * request, possibly truncated. Empty for other requests.
+	 */
+	char func[SLOW_REQUEST_FUNC_MAX];
+	/** Time from reading the request till sending the response. */
+	double total;
+	/** Time in the IPROTO to TX queue. */
+	double queue;
+	/** Time spent in the TX thread, excluding the waits below. */
+	double tx;
+	/** Time spent waiting for WAL writes. */
+	double wal;
+	/** Time spent waiting for synchronous replication quorum. */
+	double limbo;
+	/** Number of index lookups and iterators opened by the request. */
+	uint64_t lookups;
+	/** Number of tuples read by the request, including skipped. */
+	uint64_t scanned;
+};
+
+/** Requests taking longer than that are logged, in seconds. */
+extern double slow_request_threshold;
+
+/** A slow request out of this many is logged. */
+extern uint32_t slow_request_sample_interval;
+
+/** Number of slow requests left till the next sample. */
+extern uint32_t slow_request_countdown;
+
+/**
+ * Start logging slow requests: one out of @a sample_interval requests
+ * taking longer than @a threshold seconds.
+ */
+void
+slow_request_enable(double threshold, uint32_t sample_interval);
+
+/** Stop logging slow requests and clear the log. */
+void
+slow_request_disable(void);
+
+/** Clear the slow request log. */
+void
+slow_request_reset(void);
+
+/** Returns true if a request that took @a time seconds should be logged. */
+static inline bool
+slow_request_sample(double time)
+{
+	if (likely(time < slow_request_threshold))
+		return false;
+	if (--slow_request_countdown > 0)
+		return false;
+	slow_request_countdown = slow_request_sample_interval;
+	return true;
+}
+
+/**
+ * Returns a zeroed record to fill, overwriting the oldest one if the
+ * log is full.
+ */
+struct slow_request *
+slow_request_new(void);
+
+/** Sets the function name or expression of a record, truncating it. */
+void
+slow_request_set_func(struct slow_request *req, const char *func,
+		      uint32_t len);
+
+/** Returns the number of records in the log. */
+uint32_t
+slow_request_count(void);
+
+/** Returns the i-th record in the log, the oldest first. */
+const struct slow_request *
+slow_request_get(uint32_t i);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
@@ -53,16 +53,17 @@
 #include "tuple_constraint_func.h"
 #include "tuple_constraint_fkey.h"
 #include "field_default_func.h"
+#include "op_stat.h"
 #include "wal_ext.h"
 #include "coll_id_cache.h"
 #include "func_adapter.h"
 #include "lua/utils.h"
 #include "core/mp_ctx.h"
 
-int
-access_check_space(struct space *space, user_access_t access)
+bool
+space_access_is_granted(struct space *space, struct credentials *cr,
+			user_access_t access)
 {
-	struct credentials *cr = effective_user();
 	/* Any space access also requires global USAGE privilege. */
 	access |= PRIV_U;
 	/*
@@ -79,12 +80,20 @@ access_check_space(struct space *space, user_access_t access)
 	 */
 	space_access &= ~entity_access_get(SC_SPACE)[cr->auth_token].effective;
 
-	if (space_access &&
-	    /* Check for missing USAGE access, ignore owner rights. */
-	    (space_access & PRIV_U ||
-	     /* Check for missing specific access, respect owner rights. */
-	    (space->def->uid != cr->uid &&
-	     space_access & ~space->access[cr->auth_token].effective))) {
+	return !space_access ||
+	       /* Check for missing USAGE access, ignore owner rights. */
+	       (!(space_access & PRIV_U) &&
+		/* Check for missing specific access, respect owner rights. */
+		(space->def->uid == cr->uid ||
+		 !(space_access & ~space->access[cr->auth_token].effective)));
+}
+
+int
+access_check_space(struct space *space, user_access_t access)
+{
+	struct credentials *cr = effective_user();
+	if (!space_access_is_granted(space, cr, access)) {
+		access |= PRIV_U;
 		/*
 		 * Report access violation. Throw "no such user"
 		 * error if there is no user with this id.
@@ -724,6 +733,7 @@ space_delete(struct space *space)
 	assert(space->sql_triggers == NULL);
 	assert(rlist_empty(&space->space_cache_pin_list));
 	luaL_unref(tarantool_L, LUA_REGISTRYINDEX, space->lua_ref);
+	op_stat_delete(space->op_stat);
 	space->vtab->destroy(space);
 }
 
@@ -1409,6 +1419,18 @@ generic_space_ephemeral_rowid_next(struct space *space, uint64_t *rowid)
 	return 0;
 }
 
+void
+generic_space_ephemeral_begin_build(struct space *space)
+{
+	(void)space;
+}
+
+void
+generic_space_ephemeral_end_build(struct space *space)
+{
+	(void)space;
+}
+
 void
 generic_init_system_space(struct space *space)
 {
@@ -56,6 +56,7 @@ struct tuple;
 struct tuple_format;
 struct space_upgrade;
 struct space_wal_ext;
+struct op_stat;
 
 struct space_vtab {
 	/** Free a space instance. */
@@ -76,6 +77,18 @@ struct space_vtab {
 	int (*ephemeral_delete)(struct space *, const char *);
 
 	int (*ephemeral_rowid_next)(struct space *, uint64_t *);
+	/**
+	 * Switch an empty ephemeral space to bulk load: tuples passed
+	 * to ephemeral_replace() are only collected and get indexed
+	 * all at once by ephemeral_end_build(). The space must not be
+	 * read in between.
+	 */
+	void (*ephemeral_begin_build)(struct space *);
+	/**
+	 * Index the tuples collected since ephemeral_begin_build().
+	 * Does nothing if the space isn't in bulk load. May yield.
+	 */
+	void (*ephemeral_end_build)(struct space *);
 
 	void (*init_system_space)(struct space *);
 	/**
@@ -284,6 +297,11 @@ struct space {
 	 * this object in sync. For more information see #9120.
 	 */
 	int lua_ref;
+	/**
+	 * Operation statistics or NULL if they aren't collected,
+	 * see op_stat.h.
+	 */
+	struct op_stat *op_stat;
 };
 
 /** Space alter statement. */
@@ -543,6 +561,14 @@ space_index_def(struct space *space, int n);
 const char *
 index_name_by_id(struct space *space, uint32_t id);
 
+/**
+ * Check whether or not the given credentials grant the requested
+ * access to the space. Unlike access_check_space(), doesn't set diag.
+ */
+bool
+space_access_is_granted(struct space *space, struct credentials *cr,
+			user_access_t access);
+
 /**
  * Check whether or not the current user can be granted
  * the requested access to the space.
@@ -606,6 +632,18 @@ space_ephemeral_delete(struct space *space, const char *key)
 	return space->vtab->ephemeral_delete(space, key);
 }
 
+static inline void
+space_ephemeral_begin_build(struct space *space)
+{
+	space->vtab->ephemeral_begin_build(space);
+}
+
+static inline void
+space_ephemeral_end_build(struct space *space)
+{
+	space->vtab->ephemeral_end_build(space);
+}
+
 /**
  * Generic implementation of space_vtab::swap_index
  * that simply swaps the two indexes in index maps.
@@ -768,6 +806,8 @@ size_t generic_space_bsize(struct space *);
 int generic_space_ephemeral_replace(struct space *, const char *, const char *);
 int generic_space_ephemeral_delete(struct space *, const char *);
 int generic_space_ephemeral_rowid_next(struct space *, uint64_t *);
+void generic_space_ephemeral_begin_build(struct space *);
+void generic_space_ephemeral_end_build(struct space *);
 void generic_init_system_space(struct space *);
 void generic_init_ephemeral_space(struct space *);
 int generic_space_check_index_def(struct space *, struct index_def *);
@@ -45,6 +45,10 @@ const struct space_opts space_opts_default = {
 	/* .view = */ false,
 	/* .is_sync = */ false,
 	/* .defer_deletes = */ false,
+	/* .iproto_read_view = */ false,
+	/* .expire_field = */ UINT32_MAX,
+	/* .is_cache = */ false,
+	/* .upsert_window = */ 0,
 	/* .sql        = */ NULL,
 	/* .constraint_def = */ NULL,
 	/* .constraint_count = */ 0,
@@ -97,6 +101,11 @@ const struct opt_def space_opts_reg[] = {
 	OPT_DEF("view", OPT_BOOL, struct space_opts, is_view),
 	OPT_DEF("is_sync", OPT_BOOL, struct space_opts, is_sync),
 	OPT_DEF("defer_deletes", OPT_BOOL, struct space_opts, defer_deletes),
+	OPT_DEF("iproto_read_view", OPT_BOOL, struct space_opts,
+		iproto_read_view),
+	OPT_DEF("expire_field", OPT_UINT32, struct space_opts, expire_field),
+	OPT_DEF("cache", OPT_BOOL, struct space_opts, is_cache),
+	OPT_DEF("upsert_window", OPT_FLOAT, struct space_opts, upsert_window),
 	OPT_DEF("sql", OPT_STRPTR, struct space_opts, sql),
 	OPT_DEF_CUSTOM("constraint", space_opts_parse_constraint),
 	OPT_DEF_CUSTOM("foreign_key", space_opts_parse_foreign_key),
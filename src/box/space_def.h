@@ -112,6 +112,32 @@ struct space_opts {
 	 * which should speed up writes, but may also slow down reads.
 	 */
 	bool defer_deletes;
+	/**
+	 * If this flag is set for a memtx space, the space is included into
+	 * the read view that is periodically published to iproto threads so
+	 * that they can serve SELECT requests without going to the tx thread.
+	 * See box.cfg.iproto_read_view_staleness.
+	 */
+	bool iproto_read_view;
+	/**
+	 * Number of the field storing the tuple expiration time or
+	 * UINT32_MAX if tuples of the space don't expire. A tuple is
+	 * deleted by the expiration fiber once the time stored in this
+	 * field is in the past, see expire.h.
+	 */
+	uint32_t expire_field;
+	/**
+	 * If this flag is set for a memtx space, rarely accessed tuples of
+	 * the space are deleted when memtx memory is close to the limit,
+	 * see box.cfg.memtx_evict_threshold.
+	 */
+	bool is_cache;
+	/**
+	 * If positive, upserts to a memtx space made outside transactions
+	 * are buffered for up to this many seconds, and upserts to the same
+	 * key are merged, see upsert_buffer.h.
+	 */
+	double upsert_window;
 	/** SQL statement that produced this space. */
 	char *sql;
 	/** Array of constraints. Can be NULL if constraints_count == 0. */
@@ -363,7 +363,16 @@ sql_ephemeral_space_new(const struct sql_space_info *info)
 		parts[i].nullable_action = ON_CONFLICT_ACTION_NONE;
 		parts[i].is_nullable = true;
 		parts[i].exclude_null = false;
-		parts[i].sort_order = SORT_ORDER_ASC;
+		/*
+		 * Parts sorted like the first one are ascending and the
+		 * rest are descending, so VDBE reads the index backwards
+		 * if the first part is sorted in descending order.
+		 */
+		if (info->sort_orders != NULL &&
+		    info->sort_orders[i] != info->sort_orders[0])
+			parts[i].sort_order = SORT_ORDER_DESC;
+		else
+			parts[i].sort_order = SORT_ORDER_ASC;
 		parts[i].path = NULL;
 		enum field_type type = info->types[j];
 		parts[i].type = type;
@@ -866,6 +875,7 @@ static int
 cursor_seek(BtCursor *pCur, int *pRes)
 {
 	/* Close existing iterator, if any */
+	sql_cursor_batch_clear(pCur);
 	if (pCur->iter) {
 		box_iterator_free(pCur->iter);
 		pCur->iter = NULL;
@@ -891,6 +901,7 @@ cursor_seek(BtCursor *pCur, int *pRes)
 		pCur->eState = CURSOR_INVALID;
 		return -1;
 	}
+	it->is_covering = (pCur->curFlags & BTCF_Covering) != 0;
 	pCur->iter = it;
 	pCur->eState = CURSOR_VALID;
 
@@ -913,12 +924,31 @@ cursor_advance(BtCursor *pCur, int *pRes)
 	assert(pCur->iter != NULL);
 
 	struct tuple *tuple;
-	if (iterator_next(pCur->iter, &tuple) != 0)
-		return -1;
+	if ((pCur->curFlags & BTCF_Batch) != 0) {
+		/*
+		 * Tuples in the batch are already referenced, so
+		 * the reference is passed to last_tuple as is.
+		 */
+		if (pCur->batch_pos == pCur->batch_count) {
+			pCur->batch_pos = 0;
+			pCur->batch_count = 0;
+			if (iterator_next_batch(pCur->iter, pCur->batch,
+						SQL_CURSOR_BATCH_SIZE,
+						&pCur->batch_count) != 0)
+				return -1;
+		}
+		tuple = NULL;
+		if (pCur->batch_pos < pCur->batch_count)
+			tuple = pCur->batch[pCur->batch_pos++];
+	} else {
+		if (iterator_next(pCur->iter, &tuple) != 0)
+			return -1;
+		if (tuple != NULL)
+			box_tuple_ref(tuple);
+	}
 	if (pCur->last_tuple)
 		box_tuple_unref(pCur->last_tuple);
 	if (tuple) {
-		box_tuple_ref(tuple);
 		*pRes = 0;
 	} else {
 		pCur->eState = CURSOR_INVALID;
@@ -1371,9 +1401,216 @@ index_field_tuple_est(const struct index_def *idx_def, uint32_t field)
 	if (field == idx_def->key_def->part_count &&
 	    idx_def->opts.is_unique)
 		return 0;
+	const struct sql_index_stat *stat = sql_index_stat_by_def(idx_def);
+	if (stat != NULL)
+		return stat->tuple_log_est[field];
 	return default_tuple_est[field + 1 >= 6 ? 6 : field];
 }
 
+const struct sql_index_stat *
+sql_index_stat_by_def(const struct index_def *idx_def)
+{
+	struct space *space = space_by_id(idx_def->space_id);
+	if (space == NULL)
+		return NULL;
+	struct index *index = space_index(space, idx_def->iid);
+	if (index == NULL || index->def != idx_def)
+		return NULL;
+	return index->sql_stat;
+}
+
+uint32_t
+sql_index_stat_sample_count_in_range(const struct sql_index_stat *stat,
+				     const struct index_def *idx_def,
+				     const char *lower, bool lower_incl,
+				     const char *upper, bool upper_incl)
+{
+	struct coll *coll = idx_def->key_def->parts[0].coll;
+	uint32_t count = 0;
+	const char *sample = stat->samples;
+	for (uint32_t i = 0; i < stat->sample_count; i++) {
+		int cmp_lower = lower == NULL ? 1 :
+				tuple_compare_field(sample, lower,
+						    FIELD_TYPE_SCALAR, coll);
+		int cmp_upper = upper == NULL ? -1 :
+				tuple_compare_field(sample, upper,
+						    FIELD_TYPE_SCALAR, coll);
+		if ((cmp_lower > 0 || (cmp_lower == 0 && lower_incl)) &&
+		    (cmp_upper < 0 || (cmp_upper == 0 && upper_incl)))
+			count++;
+		mp_next(&sample);
+	}
+	return count;
+}
+
+void
+sql_index_stat_delete(struct sql_index_stat *stat)
+{
+	free(stat->samples);
+	free(stat);
+}
+
+enum {
+	/** Max number of values in the histogram of an index. */
+	SQL_INDEX_STAT_SAMPLE_MAX = 128,
+	/** How often to yield while ANALYZE scans an index. */
+	SQL_INDEX_STAT_YIELD_LOOPS = 1000,
+};
+
+/**
+ * Scan the index and collect the statistics used by the planner:
+ * the number of distinct values of each key prefix, the number of
+ * NULLs in the first key part and an equi-depth histogram of the
+ * first key part. Replaces the old statistics of the index.
+ */
+static int
+sql_index_analyze(struct index *index)
+{
+	struct key_def *key_def = index->def->key_def;
+	uint32_t part_count = key_def->part_count;
+	uint64_t *distinct = xcalloc(part_count + 1, sizeof(*distinct));
+	uint64_t step = index_size(index) / SQL_INDEX_STAT_SAMPLE_MAX + 1;
+	uint64_t tuple_count = 0;
+	uint64_t null_count = 0;
+	uint32_t sample_count = 0;
+	size_t samples_size = 0;
+	size_t samples_capacity = 0;
+	char *samples = NULL;
+	char *prev_key = NULL;
+	size_t prev_key_capacity = 0;
+	struct sql_index_stat *stat;
+	struct tuple *tuple;
+	int rc = -1;
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	struct iterator *it = index_create_iterator(index, ITER_ALL, NULL, 0);
+	if (it == NULL)
+		goto out;
+	while (true) {
+		if (iterator_next(it, &tuple) != 0)
+			goto out;
+		if (tuple == NULL)
+			break;
+		uint32_t key_size;
+		const char *key = tuple_extract_key(tuple, key_def,
+						    MULTIKEY_NONE, &key_size);
+		if (key == NULL)
+			goto out;
+		const char *key_end = key + key_size;
+		mp_decode_array(&key);
+		/* Find the number of leading key parts equal to prev. */
+		uint32_t equal = 0;
+		if (tuple_count > 0) {
+			while (equal < part_count &&
+			       key_compare(prev_key, equal + 1, HINT_NONE,
+					   key, equal + 1, HINT_NONE,
+					   key_def) == 0)
+				equal++;
+		}
+		for (uint32_t i = equal + 1; i <= part_count; i++)
+			distinct[i]++;
+		if (mp_typeof(*key) == MP_NIL) {
+			null_count++;
+		} else if (tuple_count % step == 0) {
+			const char *value_end = key;
+			mp_next(&value_end);
+			size_t value_size = value_end - key;
+			if (samples_size + value_size > samples_capacity) {
+				samples_capacity = MAX(samples_capacity * 2,
+						       samples_size +
+						       value_size);
+				samples = xrealloc(samples, samples_capacity);
+			}
+			memcpy(samples + samples_size, key, value_size);
+			samples_size += value_size;
+			sample_count++;
+		}
+		if ((size_t)(key_end - key) > prev_key_capacity) {
+			prev_key_capacity = key_end - key;
+			prev_key = xrealloc(prev_key, prev_key_capacity);
+		}
+		memcpy(prev_key, key, key_end - key);
+		region_truncate(region, region_svp);
+		/*
+		 * Yielding would abort a memtx transaction so ANALYZE
+		 * run in a transaction scans the index in one go.
+		 */
+		if (++tuple_count % SQL_INDEX_STAT_YIELD_LOOPS == 0 &&
+		    in_txn() == NULL)
+			fiber_sleep(0);
+	}
+	/* The index could be dropped while we yielded. */
+	if (!index_weak_ref_check(&it->index_ref)) {
+		rc = 0;
+		goto out;
+	}
+	stat = xmalloc(sizeof(*stat) +
+		       (part_count + 1) * sizeof(*stat->tuple_log_est));
+	stat->tuple_count = tuple_count;
+	stat->null_count = null_count;
+	stat->tuple_log_est = (int16_t *)(stat + 1);
+	stat->tuple_log_est[0] = sqlLogEst(tuple_count);
+	for (uint32_t i = 1; i <= part_count; i++) {
+		LogEst est = stat->tuple_log_est[0] -
+			     sqlLogEst(MAX(distinct[i], 1));
+		stat->tuple_log_est[i] = MIN(MAX(est, 0),
+					     stat->tuple_log_est[i - 1]);
+	}
+	stat->samples = samples;
+	stat->sample_count = sample_count;
+	samples = NULL;
+	if (index->sql_stat != NULL)
+		sql_index_stat_delete(index->sql_stat);
+	index->sql_stat = stat;
+	rc = 0;
+out:
+	if (it != NULL)
+		iterator_delete(it);
+	region_truncate(region, region_svp);
+	free(prev_key);
+	free(samples);
+	free(distinct);
+	return rc;
+}
+
+int
+sql_analyze_space(uint32_t space_id, bool is_silent)
+{
+	struct space *space = space_by_id(space_id);
+	if (space == NULL) {
+		if (is_silent)
+			return 0;
+		diag_set(ClientError, ER_NO_SUCH_SPACE, int2str(space_id));
+		return -1;
+	}
+	if (is_silent &&
+	    !space_access_is_granted(space, effective_user(), PRIV_R))
+		return 0;
+	if (access_check_space(space, PRIV_R) != 0)
+		return -1;
+	for (uint32_t i = 0; i < space->index_count; i++) {
+		struct index *index = space->index[i];
+		/*
+		 * Only TREE indexes keep tuples ordered, which is
+		 * needed to count distinct keys in one pass.
+		 */
+		if (index->def->type != TREE ||
+		    index->def->key_def->is_multikey ||
+		    index->def->key_def->for_func_index)
+			continue;
+		index_ref(index);
+		int rc = sql_index_analyze(index);
+		index_unref(index);
+		if (rc != 0)
+			return -1;
+		/* The space could be altered while we yielded. */
+		space = space_by_id(space_id);
+		if (space == NULL)
+			break;
+	}
+	return 0;
+}
+
 /** Drop tuple or field constraint. */
 static int
 sql_constraint_drop(uint32_t space_id, const char *name, const char *prefix)
@@ -407,6 +407,40 @@ func_sql_expr_check_fields(const struct func *base,
 uint32_t
 sql_default_session_flags(void);
 
+/**
+ * Statistics of a TREE index collected by ANALYZE. Used by the SQL
+ * planner to estimate the number of tuples selected by a condition.
+ * The statistics aren't updated as the index changes, ANALYZE has to
+ * be rerun for that.
+ */
+struct sql_index_stat {
+	/** Number of tuples in the index. */
+	uint64_t tuple_count;
+	/** Number of tuples having NULL in the first key part. */
+	uint64_t null_count;
+	/**
+	 * Logarithmic estimates (see sqlLogEst()): tuple_log_est[0] is
+	 * the number of tuples in the index, tuple_log_est[i] is the
+	 * average number of tuples having the same values of the first
+	 * i key parts, i.e. tuple_count divided by the number of
+	 * distinct values of the prefix.
+	 */
+	int16_t *tuple_log_est;
+	/**
+	 * Equi-depth histogram of the first key part: values of the
+	 * first key part taken from tuples evenly spaced in the index
+	 * order, encoded in MsgPack one after another. NULLs are never
+	 * sampled so the histogram describes non-NULL values only.
+	 */
+	char *samples;
+	/** Number of values stored in samples. */
+	uint32_t sample_count;
+};
+
+/** Free index statistics collected by ANALYZE. */
+void
+sql_index_stat_delete(struct sql_index_stat *stat);
+
 #ifdef FUZZING_BUILD_MODE_UNSAFE_FOR_PRODUCTION
 /**
  * Entrypoint for fuzzing SQL engine.
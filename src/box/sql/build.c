@@ -3782,3 +3782,48 @@ sql_emit_show_create_table_all(struct Parse *parse)
 	sqlVdbeAddOp2(v, OP_Next, cursor, addr2);
 	sqlVdbeJumpHere(v, addr1);
 }
+
+/** Emit VDBE instructions for "ANALYZE table_name;" statement. */
+void
+sql_emit_analyze_one(struct Parse *parse, struct Token *name)
+{
+	const struct space *space = sql_space_by_token(name);
+	if (space == NULL) {
+		const char *name_str = sql_tt_name_from_token(name);
+		diag_set(ClientError, ER_NO_SUCH_SPACE, name_str);
+		parse->is_aborted = true;
+		return;
+	}
+	if (space->def->opts.is_view) {
+		const char *err_msg =
+			tt_sprintf("can not analyze space '%s' because space "
+				   "is a view", space->def->name);
+		diag_set(ClientError, ER_SQL_EXECUTE, err_msg);
+		parse->is_aborted = true;
+		return;
+	}
+	struct Vdbe *v = sqlGetVdbe(parse);
+	int space_id_reg = ++parse->nMem;
+	sqlVdbeAddOp2(v, OP_Integer, space->def->id, space_id_reg);
+	sqlVdbeAddOp2(v, OP_Analyze, space_id_reg, 0);
+}
+
+/** Emit VDBE instructions for "ANALYZE;" statement. */
+void
+sql_emit_analyze_all(struct Parse *parse)
+{
+	struct Vdbe *v = sqlGetVdbe(parse);
+	int cursor = parse->nTab++;
+	int space_reg = ++parse->nMem;
+	int key_reg = ++parse->nMem;
+	sqlVdbeAddOp2(v, OP_OpenSpace, space_reg, BOX_VSPACE_ID);
+	sqlVdbeAddOp3(v, OP_IteratorOpen, cursor, 0, space_reg);
+	sqlVdbeAddOp2(v, OP_Integer, BOX_SYSTEM_ID_MAX, key_reg);
+	int addr1 = sqlVdbeAddOp4Int(v, OP_SeekGT, cursor, 0, key_reg, 1);
+	int space_id_reg = ++parse->nMem;
+	int addr2 = sqlVdbeAddOp3(v, OP_Column, cursor, BOX_SPACE_FIELD_ID,
+				  space_id_reg);
+	sqlVdbeAddOp2(v, OP_Analyze, space_id_reg, 1);
+	sqlVdbeAddOp2(v, OP_Next, cursor, addr2);
+	sqlVdbeJumpHere(v, addr1);
+}
@@ -33,9 +33,19 @@
 #include "tarantoolInt.h"
 #include "box/tuple.h"
 
+void
+sql_cursor_batch_clear(struct BtCursor *cursor)
+{
+	for (uint32_t i = cursor->batch_pos; i < cursor->batch_count; i++)
+		tuple_unref(cursor->batch[i]);
+	cursor->batch_pos = 0;
+	cursor->batch_count = 0;
+}
+
 void
 sql_cursor_cleanup(struct BtCursor *cursor)
 {
+	sql_cursor_batch_clear(cursor);
 	if (cursor->iter)
 		iterator_delete(cursor->iter);
 	if (cursor->last_tuple)
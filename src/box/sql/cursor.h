@@ -34,6 +34,14 @@
 
 typedef struct BtCursor BtCursor;
 
+enum {
+	/**
+	 * Number of tuples a batched cursor fetches from the
+	 * iterator at once, see BTCF_Batch.
+	 */
+	SQL_CURSOR_BATCH_SIZE = 32,
+};
+
 /*
  * A cursor contains a particular entry either from Tarantrool or
  * Sorter. Tarantool cursor is able to point to ordinary table or
@@ -50,6 +58,14 @@ struct BtCursor {
 	enum iterator_type iter_type;
 	struct tuple *last_tuple;
 	char *key;		/* Saved key that was cursor last known position */
+	/**
+	 * Tuples fetched from the iterator in advance, but not
+	 * consumed yet: [batch_pos, batch_count). Each of them is
+	 * referenced. Used only if BTCF_Batch is set.
+	 */
+	struct tuple *batch[SQL_CURSOR_BATCH_SIZE];
+	uint32_t batch_pos;
+	uint32_t batch_count;
 };
 
 void sqlCursorZero(BtCursor *);
@@ -75,6 +91,10 @@ sqlCursorPayload(BtCursor *, u32 offset, u32 amt, void *);
 void
 sql_cursor_cleanup(struct BtCursor *cursor);
 
+/** Release the tuples prefetched by a batched cursor. */
+void
+sql_cursor_batch_clear(struct BtCursor *cursor);
+
 #ifndef NDEBUG
 int sqlCursorIsValid(BtCursor *);
 #endif
@@ -85,6 +105,8 @@ int sqlCursorIsValidNN(BtCursor *);
  */
 #define BTCF_TaCursor     0x80	/* Tarantool cursor, pTaCursor valid */
 #define BTCF_TEphemCursor 0x40	/* Tarantool cursor to ephemeral table  */
+#define BTCF_Batch        0x20	/* Fetch tuples in batches, see batch */
+#define BTCF_Covering     0x10	/* Only index key fields are read */
 
 /*
  * Potential values for BtCursor.eState.
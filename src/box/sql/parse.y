@@ -116,6 +116,7 @@ ecmd ::= SEMI. {
 explain ::= .
 explain ::= EXPLAIN.              { pParse->explain = 1; }
 explain ::= EXPLAIN QUERY PLAN.   { pParse->explain = 2; }
+explain ::= EXPLAIN ANALYZE.      { pParse->explain = 3; }
 cmdx ::= cmd.
 
 // Define operator precedence early so that this is the first occurrence
@@ -1514,6 +1515,15 @@ cmd ::= SHOW CREATE TABLE. {
   sql_emit_show_create_table_all(pParse);
 }
 
+//////////////////////////// The ANALYZE command ///////////////////////////
+// ANALYZE is not a cmd so that EXPLAIN ANALYZE is not ambiguous.
+ecmd ::= ANALYZE nm(X) SEMI. {
+  sql_emit_analyze_one(pParse, &X);
+}
+ecmd ::= ANALYZE SEMI. {
+  sql_emit_analyze_all(pParse);
+}
+
 //////////////////////////// The CREATE TRIGGER command /////////////////////
 
 cmd ::= createkw trigger_decl(A) BEGIN trigger_cmd_list(S) END(Z). {
@@ -375,7 +375,7 @@ port_sql_destroy(struct port *base)
 	port_c_vtab.destroy(base);
 	struct port_sql *port_sql = (struct port_sql *)base;
 	if (port_sql->do_finalize)
-		sql_stmt_finalize(((struct port_sql *)base)->stmt);
+		sql_stmt_cache_put(port_sql->stmt);
 }
 
 const struct port_vtab port_sql_vtab = {
@@ -50,6 +50,8 @@ struct port_sql {
 	/**
 	 * There's no need in clean-up in case of PREPARE request:
 	 * statement remains in cache and will be deleted later.
+	 * Otherwise the statement is owned by the port and is
+	 * kept for reuse on destruction, see sql_stmt_cache_put().
 	 */
 	bool do_finalize;
 };
@@ -119,6 +119,10 @@ sql_stmt_compile(const char *zSql, int nBytes, struct Vdbe *pReprepare,
 			/* 21 */ "integer",
 			/* 22 */ "detail",
 			/* 23 */ "text",
+			/* 24 */ "count",
+			/* 25 */ "integer",
+			/* 26 */ "time",
+			/* 27 */ "integer",
 		};
 
 		int name_first, name_count;
@@ -129,9 +133,12 @@ sql_stmt_compile(const char *zSql, int nBytes, struct Vdbe *pReprepare,
 			name_first = 0;
 			name_count = 8;
 		}
-		sqlVdbeSetNumCols(sParse.pVdbe, name_count);
-		for (int i = 0; i < name_count; i++) {
-			int name_index = 2 * i + name_first;
+		int col_count = name_count + (sParse.explain == 3 ? 2 : 0);
+		sqlVdbeSetNumCols(sParse.pVdbe, col_count);
+		for (int i = 0; i < col_count; i++) {
+			/* EXPLAIN ANALYZE adds "count" and "time". */
+			int name_index = i < name_count ? 2 * i + name_first :
+					 2 * i + 8;
 			vdbe_metadata_set_col_name(sParse.pVdbe, i,
 						   azColName[name_index]);
 			vdbe_metadata_set_col_type(sParse.pVdbe, i,
@@ -238,8 +238,14 @@ sql_space_info_new_for_sorting(struct Parse *parser, struct ExprList *order_by,
 		info->coll_ids[k] = coll_id;
 		info->sort_orders[k] = order_by->a[k + start].sort_order;
 	}
-	if (has_rowid)
+	if (has_rowid) {
+		/*
+		 * Rows with equal keys are kept in the insertion order
+		 * relative to the sorting direction of the first part.
+		 */
+		info->sort_orders[k] = info->sort_orders[0];
 		info->types[k++] = FIELD_TYPE_INTEGER;
+	}
 	assert(k == (int)part_count);
 	for (int i = 0; i < list->nExpr; ++i) {
 		if (list->a[i].u.x.iOrderByCol != 0)
@@ -343,20 +349,6 @@ sqlSelectDestInit(SelectDest * pDest, int eDest, int iParm, int reg_eph)
 	pDest->nSdst = 0;
 }
 
-static bool
-is_same_sorting_direction(const struct ExprList *expr_list)
-{
-	if(expr_list == NULL)
-		return true;
-	enum sort_order reference_order = expr_list->a[0].sort_order;
-	for (int i = 1; i < expr_list->nExpr; i++) {
-		assert(expr_list->a[i].sort_order != SORT_ORDER_UNDEF);
-		if (expr_list->a[i].sort_order != reference_order)
-			return false;
-	}
-	return true;
-}
-
 /*
  * Allocate a new Select structure and return a pointer to that
  * structure.
@@ -1021,6 +1013,15 @@ pushOntoSorter(Parse * pParse,		/* Parser context */
 				pParse->is_aborted = true;
 				return;
 			}
+			/*
+			 * The space is sorted by the parts that follow the
+			 * ones satisfied by the loop, so the direction is
+			 * set by the first of them.
+			 */
+			if (info->sort_orders[0] == SORT_ORDER_DESC)
+				pSort->sortFlags |= SORTFLAG_DESC;
+			else
+				pSort->sortFlags &= ~SORTFLAG_DESC;
 			sqlVdbeChangeP4(v, pSort->addrSortIndex, (char *)info,
 					P4_DYNAMIC);
 		}
@@ -5894,12 +5895,11 @@ sqlSelect(Parse * pParse,		/* The parser context */
 	}
 	computeLimitRegisters(pParse, p, iEnd);
 	/*
-	 * At the moment we don't have iterators where the fields are sorted in
-	 * a different order. Because of this, we have to sort all the data and
-	 * select only the required number of rows.
+	 * Without LIMIT all the rows have to be sorted, so use the sorter.
+	 * Otherwise keep only the top LIMIT+OFFSET rows in the ephemeral
+	 * space, see pushOntoSorter().
 	 */
-	if (sSort.addrSortIndex >= 0 &&
-	    (p->iLimit == 0 || !is_same_sorting_direction(sSort.pOrderBy))) {
+	if (sSort.addrSortIndex >= 0 && p->iLimit == 0) {
 		struct VdbeOp *op = sqlVdbeGetOp(v, sSort.addrSortIndex);
 		struct sql_key_info *key_info =
 			sql_key_info_new_from_space_info(op->p4.space_info);
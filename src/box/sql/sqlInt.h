@@ -410,6 +410,10 @@ sql_column_span(struct Vdbe *v, int n);
 uint64_t
 sql_stmt_schema_version(const struct Vdbe *stmt);
 
+/** Return session SQL flags the VDBE was compiled with. */
+uint32_t
+sql_stmt_flags(const struct Vdbe *stmt);
+
 int
 sql_initialize(void);
 
@@ -1226,6 +1230,24 @@ struct UnpackedRecord {
 int16_t
 index_field_tuple_est(const struct index_def *idx, uint32_t field);
 
+/**
+ * Return the statistics collected by ANALYZE for the index with
+ * the given definition or NULL if the index hasn't been analyzed.
+ */
+const struct sql_index_stat *
+sql_index_stat_by_def(const struct index_def *idx_def);
+
+/**
+ * Return the number of histogram samples of the index that fall
+ * in the given range of the first key part. NULL bound means that
+ * the range is unbounded on that side.
+ */
+uint32_t
+sql_index_stat_sample_count_in_range(const struct sql_index_stat *stat,
+				     const struct index_def *idx_def,
+				     const char *lower, bool lower_incl,
+				     const char *upper, bool upper_incl);
+
 #ifdef DEFAULT_TUPLE_COUNT
 #undef DEFAULT_TUPLE_COUNT
 #endif
@@ -2150,6 +2172,9 @@ struct Parse {
 #define OPFLAG_SYSTEMSP      0x20	/* OP_Open**: set if space pointer
 					 * points to system space.
 					 */
+#define OPFLAG_COVERING      0x40	/* OP_IteratorOpen: only index key
+					 * fields are read
+					 */
 
 /**
  * Prepare vdbe P5 flags for OP_{IdxInsert, IdxReplace, Update}
@@ -2677,6 +2702,14 @@ sql_emit_show_create_table_one(struct Parse *parse, struct Token *name);
 void
 sql_emit_show_create_table_all(struct Parse *parse);
 
+/** Emit VDBE instructions for "ANALYZE table_name;" statement. */
+void
+sql_emit_analyze_one(struct Parse *parse, struct Token *name);
+
+/** Emit VDBE instructions for "ANALYZE;" statement. */
+void
+sql_emit_analyze_all(struct Parse *parse);
+
 /** Generate a CREATE TABLE statement for the space with the given ID. */
 void
 sql_show_create_table(uint32_t space_id, struct Mem *ret, struct Mem *err);
@@ -4198,7 +4231,12 @@ struct sql_space_info {
 	 * consists of all fields in sequential order.
 	 */
 	uint32_t *parts;
-	/** Sort order of index. */
+	/**
+	 * Sort orders of the key parts. The ephemeral space index is
+	 * built so that iterating it forwards gives the order of the first
+	 * part and backwards gives the reverse order, see
+	 * sql_ephemeral_space_new().
+	 */
 	enum sort_order *sort_orders;
 	/** Number of fields of ephemetal space. */
 	uint32_t field_count;
@@ -94,6 +94,18 @@ sql_delete_by_key(struct space *space, uint32_t iid, char *key,
 
 int tarantoolsqlClearTable(struct space *space, uint32_t *tuple_count);
 
+/**
+ * Collect statistics used by the planner for all TREE indexes of
+ * the space, see struct sql_index_stat. May yield.
+ *
+ * @param space_id Space identifier.
+ * @param is_silent Skip the space instead of failing if it doesn't
+ *        exist or the current user can't read it.
+ * @retval 0 on success, -1 otherwise.
+ */
+int
+sql_analyze_space(uint32_t space_id, bool is_silent);
+
 /**
  * Rename the table in _space.
  * @param space_id Table's space identifier.
@@ -40,6 +40,7 @@
  * commenting and indentation practices when changing or adding code.
  */
 #include "box/box.h"
+#include "clock.h"
 #include "box/error.h"
 #include "box/txn.h"
 #include "box/tuple.h"
@@ -296,7 +297,8 @@ vdbe_field_ref_fetch_data(struct vdbe_field_ref *field_ref, uint32_t fieldno)
 	const char *field_begin;
 	const struct tuple_field *field = vdbe_field_ref_fetch_field(field_ref,
 								     fieldno);
-	if (field != NULL && field->offset_slot != TUPLE_OFFSET_SLOT_NIL) {
+	if (field != NULL && (field->offset_slot != TUPLE_OFFSET_SLOT_NIL ||
+			      field->fixed_offset >= 0)) {
 		field_begin = tuple_field(field_ref->tuple, fieldno);
 	} else {
 		uint32_t prev = vdbe_field_ref_closest_slotno(field_ref,
@@ -355,6 +357,31 @@ vdbe_field_ref_fetch(struct vdbe_field_ref *field_ref, uint32_t fieldno,
 	return 0;
 }
 
+/**
+ * Finish timing the opcode being executed by EXPLAIN ANALYZE and
+ * start timing the opcode at address @a pc of the main program.
+ */
+static inline void
+vdbe_op_stat_begin(struct Vdbe *p, int pc)
+{
+	uint64_t now = clock_monotonic64();
+	if (p->op_stat_current != NULL)
+		p->op_stat_current->time += now - p->op_stat_start;
+	p->op_stat_current = &p->op_stat[pc];
+	p->op_stat_current->count++;
+	p->op_stat_start = now;
+}
+
+/** Finish timing the opcode being executed by EXPLAIN ANALYZE. */
+static inline void
+vdbe_op_stat_end(struct Vdbe *p)
+{
+	if (p->op_stat_current == NULL)
+		return;
+	p->op_stat_current->time += clock_monotonic64() - p->op_stat_start;
+	p->op_stat_current = NULL;
+}
+
 /*
  * Execute as much of a VDBE program as we can.
  * This is the core of sql_step().
@@ -381,7 +408,7 @@ int sqlVdbeExec(Vdbe *p)
 	assert(p->magic==VDBE_MAGIC_RUN);  /* sql_step() verifies this */
 	assert(!p->is_aborted);
 	p->iCurrentTime = 0;
-	assert(p->explain==0);
+	assert(p->explain == 0 || p->explain == 3);
 	p->pResultSet = 0;
 #ifdef SQL_DEBUG
 	if (p->pc == 0 &&
@@ -416,6 +443,9 @@ int sqlVdbeExec(Vdbe *p)
 
 		assert(pOp>=aOp && pOp<&aOp[p->nOp]);
 
+		if (unlikely(p->op_stat != NULL) && p->pFrame == NULL)
+			vdbe_op_stat_begin(p, pOp - aOp);
+
 		/* Only allow tracing if SQL_DEBUG is defined.
 		 */
 #ifdef SQL_DEBUG
@@ -2429,6 +2459,9 @@ case OP_TTransaction: {
  * id in P2. Give the new cursor an identifier of P1. The P1 values need not be
  * contiguous but all P1 values should be small integers. It is an error for P1
  * to be negative.
+ *
+ * If P5 has OPFLAG_COVERING set, only the fields of the index
+ * comparison key are read from the cursor.
  */
 case OP_IteratorOpen: {
 	struct VdbeCursor *cur = p->apCsr[pOp->p1];
@@ -2464,6 +2497,23 @@ case OP_IteratorOpen: {
 	cur->key_def = index->def->key_def;
 	cur->nullRow = 1;
 	cur->uc.pCursor->hints = pOp->p5 & OPFLAG_SEEKEQ;
+	/*
+	 * Read-only statements scanning a memtx space fetch
+	 * tuples in batches to amortize the cost of iterator
+	 * positioning. A statement that modifies data must see
+	 * its own changes, so it iterates tuple by tuple. So do
+	 * equality lookups, which usually return a single tuple.
+	 */
+	if (!p->changeCntOn && space->def->id != 0 &&
+	    space_is_memtx(space) && (pOp->p5 & OPFLAG_SEEKEQ) == 0)
+		bt_cur->curFlags |= BTCF_Batch;
+	/*
+	 * A tuple fetched by a covering cursor may lack fields
+	 * not indexed by the index, so it must not be used to
+	 * modify data.
+	 */
+	if (!p->changeCntOn && (pOp->p5 & OPFLAG_COVERING) != 0)
+		bt_cur->curFlags |= BTCF_Covering;
 	break;
 }
 
@@ -3004,6 +3054,39 @@ case OP_NextIdEphemeral: {
 	break;
 }
 
+/* Opcode: EphemeralBeginBuild P1 * * * *
+ * Synopsis: begin_build(space[P1])
+ *
+ * Switch the empty ephemeral space stored in register P1 to bulk
+ * load: tuples inserted with OP_IdxInsert are only collected and
+ * get indexed all at once by OP_EphemeralEndBuild. The space must
+ * not be read until then.
+ *
+ * Indexing may yield, which would abort a memtx transaction, so
+ * within a transaction this opcode is a no-op and the tuples are
+ * inserted one by one as usual.
+ */
+case OP_EphemeralBeginBuild: {
+	struct space *space = (struct space *)p->aMem[pOp->p1].u.p;
+	assert(space->def->id == 0);
+	if (in_txn() == NULL)
+		space_ephemeral_begin_build(space);
+	break;
+}
+
+/* Opcode: EphemeralEndBuild P1 * * * *
+ * Synopsis: end_build(space[P1])
+ *
+ * Index the tuples collected since OP_EphemeralBeginBuild in the
+ * ephemeral space stored in register P1. May yield.
+ */
+case OP_EphemeralEndBuild: {
+	struct space *space = (struct space *)p->aMem[pOp->p1].u.p;
+	assert(space->def->id == 0);
+	space_ephemeral_end_build(space);
+	break;
+}
+
 /* Opcode: FCopy P1 P2 P3 * *
  * Synopsis: reg[P2@cur_frame]= reg[P1@root_frame(OPFLAG_SAME_FRAME)]
  *
@@ -4458,6 +4541,21 @@ case OP_ShowCreateTable: {
 	break;
 }
 
+/**
+ * Opcode: Analyze P1 P2 * * *
+ * Synopsis: analyze(space_by_id(r[P1]))
+ *
+ * Collect statistics used by the planner for the indexes of the
+ * space with the identifier from register P1. If P2 is not 0, the
+ * space is skipped if it doesn't exist or can't be read by the
+ * current user.
+ */
+case OP_Analyze: {
+	if (sql_analyze_space(aMem[pOp->p1].u.i, pOp->p2 != 0) != 0)
+		goto abort_due_to_error;
+	break;
+}
+
 /* Opcode: Noop * * * * *
  *
  * Do nothing.  This instruction is often useful as a jump
@@ -4517,6 +4615,8 @@ default: {          /* This is really OP_Noop and OP_Explain */
 	/* This is the only way out of this procedure. */
 vdbe_return:
 	assert(rc == 0 || rc == -1 || rc == SQL_ROW || rc == SQL_DONE);
+	if (unlikely(p->op_stat != NULL))
+		vdbe_op_stat_end(p);
 	return rc;
 
 	/* Jump to here if a string or blob larger than SQL_MAX_LENGTH
@@ -215,6 +215,14 @@ struct sql_column_metadata {
 	char *span;
 };
 
+/** Execution statistics of an opcode collected by EXPLAIN ANALYZE. */
+struct vdbe_op_stat {
+	/** Number of times the opcode was executed. */
+	uint64_t count;
+	/** Total time spent executing the opcode, in nanoseconds. */
+	uint64_t time;
+};
+
 /*
  * An instance of the virtual machine.  This structure contains the complete
  * state of the virtual machine.
@@ -287,6 +295,8 @@ struct Vdbe {
 	bft expired:1;		/* True if the VM needs to be recompiled */
 	bft doingRerun:1;	/* True if rerunning after an auto-reprepare */
 	bft explain:2;		/* True if EXPLAIN present on SQL command */
+	/** True if EXPLAIN ANALYZE has executed the statement. */
+	bft is_analyzed:1;
 	bft changeCntOn:1;	/* True to update the change-counter */
 	bft runOnlyOnce:1;	/* Automatically expire on reset */
 	/**
@@ -304,6 +314,16 @@ struct Vdbe {
 	uint32_t sql_flags;
 	/* Anonymous savepoint for aborts only */
 	struct txn_savepoint *anonymous_savepoint;
+	/**
+	 * Statistics of the main program opcodes if this is
+	 * EXPLAIN ANALYZE, NULL otherwise. Time spent in trigger
+	 * programs is accounted to the invoking OP_Program.
+	 */
+	struct vdbe_op_stat *op_stat;
+	/** Statistics of the opcode being executed or NULL. */
+	struct vdbe_op_stat *op_stat_current;
+	/** Time when the opcode being executed was started. */
+	uint64_t op_stat_start;
 };
 
 /*
@@ -331,6 +351,18 @@ void sqlVdbePrintOp(FILE *, int, Op *);
 int sqlVdbeExec(Vdbe *);
 int sqlVdbeList(Vdbe *);
 
+/**
+ * Run the program of an EXPLAIN ANALYZE statement to completion,
+ * discarding the rows it returns and collecting per-opcode
+ * statistics, then prepare the VM for listing the program with
+ * sqlVdbeList().
+ *
+ * @retval 0 Success.
+ * @retval -1 The statement failed, see diag.
+ */
+int
+sqlVdbeAnalyze(struct Vdbe *p);
+
 int sqlVdbeHalt(Vdbe *);
 
 const char *sqlOpcodeName(int);
@@ -126,7 +126,9 @@ sqlStep(Vdbe * p)
 		db->nVdbeActive++;
 		p->pc = 0;
 	}
-	if (p->explain) {
+	if (p->explain == 3 && !p->is_analyzed && sqlVdbeAnalyze(p) != 0) {
+		rc = -1;
+	} else if (p->explain) {
 		rc = sqlVdbeList(p);
 	} else {
 		db->nVdbeExec++;
@@ -224,6 +226,12 @@ sql_stmt_schema_version(const struct Vdbe *v)
 	return v->schema_ver;
 }
 
+uint32_t
+sql_stmt_flags(const struct Vdbe *v)
+{
+	return v->sql_flags;
+}
+
 static size_t
 sql_metadata_size(const struct sql_column_metadata *metadata)
 {
@@ -1118,6 +1118,11 @@ sqlVdbeFrameDelete(VdbeFrame * p)
  *
  * When p->explain==1, first the main program is listed, then each of
  * the trigger subprograms are listed one by one.
+ *
+ * p->explain==3 is used to implement EXPLAIN ANALYZE. It lists
+ * instructions as p->explain==1 does, adding the number of times each
+ * instruction of the main program was executed and the time spent
+ * on it. See sqlVdbeAnalyze().
  */
 int
 sqlVdbeList(Vdbe * p)
@@ -1137,7 +1142,8 @@ sqlVdbeList(Vdbe * p)
 	 * the result, result columns may become dynamic if the user calls
 	 * sql_column_text16(), causing a translation to UTF-16 encoding.
 	 */
-	releaseMemArray(pMem, 8);
+	int nResColumn = p->explain == 2 ? 4 : p->explain == 3 ? 10 : 8;
+	releaseMemArray(pMem, nResColumn);
 	p->pResultSet = 0;
 
 	/* When the number of output rows reaches nRow, that means the
@@ -1148,14 +1154,15 @@ sqlVdbeList(Vdbe * p)
 	 * encountered, but p->pc will eventually catch up to nRow.
 	 */
 	nRow = p->nOp;
-	if (p->explain == 1) {
+	if (p->explain != 2) {
 		/* The first 8 memory cells are used for the result set.  So we will
 		 * commandeer the 9th cell to use as storage for an array of pointers
 		 * to trigger subprograms.  The VDBE is guaranteed to have at least 9
-		 * cells.
+		 * cells. EXPLAIN ANALYZE uses 10 cells for the result set and the
+		 * 11th one for subprograms.
 		 */
-		assert(p->nMem > 9);
-		pSub = &p->aMem[9];
+		assert(p->nMem > nResColumn + 1);
+		pSub = &p->aMem[nResColumn + 1];
 		if (mem_is_bin(pSub)) {
 			/* On the first call to sql_step(), pSub will hold a NULL.  It is
 			 * initialized to a BLOB by the P4_SUBPROGRAM processing logic below
@@ -1176,7 +1183,10 @@ sqlVdbeList(Vdbe * p)
 	} else {
 		char *zP4;
 		Op *pOp;
+		struct vdbe_op_stat *op_stat = NULL;
 		if (i < p->nOp) {
+			if (p->op_stat != NULL)
+				op_stat = &p->op_stat[i];
 			/* The output line number is small enough that we are still in the
 			 * main program.
 			 */
@@ -1192,7 +1202,7 @@ sqlVdbeList(Vdbe * p)
 			}
 			pOp = &apSub[j]->aOp[i];
 		}
-		if (p->explain == 1) {
+		if (p->explain != 2) {
 			assert(i >= 0);
 			mem_set_uint(pMem, i);
 
@@ -1246,7 +1256,7 @@ sqlVdbeList(Vdbe * p)
 		}
 		pMem++;
 
-		if (p->explain == 1) {
+		if (p->explain != 2) {
 			buf = sql_xmalloc(4);
 			sql_snprintf(3, buf, "%.2x", pOp->p5);
 			mem_set_str0_allocated(pMem, buf);
@@ -1260,14 +1270,52 @@ sqlVdbeList(Vdbe * p)
 			mem_set_null(pMem);
 #endif
 		}
+		if (p->explain == 3) {
+			pMem++;
+			if (op_stat != NULL) {
+				mem_set_uint(pMem, op_stat->count);
+				pMem++;
+				mem_set_uint(pMem, op_stat->time);
+			} else {
+				mem_set_null(pMem);
+				pMem++;
+				mem_set_null(pMem);
+			}
+		}
 
-		p->nResColumn = 8 - 4 * (p->explain - 1);
+		p->nResColumn = nResColumn;
 		p->pResultSet = &p->aMem[1];
 		rc = SQL_ROW;
 	}
 	return rc;
 }
 
+int
+sqlVdbeAnalyze(struct Vdbe *p)
+{
+	assert(p->explain == 3 && !p->is_analyzed);
+	assert(p->op_stat != NULL);
+	struct sql *db = sql_get();
+	int rc;
+	db->nVdbeExec++;
+	while ((rc = sqlVdbeExec(p)) == SQL_ROW)
+		;
+	db->nVdbeExec--;
+	if (rc != SQL_DONE)
+		return -1;
+	/*
+	 * The program has halted: make the VM look like it has
+	 * just started listing, as it does for EXPLAIN.
+	 */
+	assert(p->magic == VDBE_MAGIC_HALT);
+	p->magic = VDBE_MAGIC_RUN;
+	p->is_analyzed = 1;
+	p->pc = 0;
+	db->nVdbeActive++;
+	mem_set_null(&p->aMem[11]);
+	return 0;
+}
+
 #ifdef SQL_DEBUG
 /*
  * Print the SQL that was used to generate a VDBE program.
@@ -1355,6 +1403,10 @@ sqlVdbeRewind(Vdbe * p)
 
 	p->pc = -1;
 	p->is_aborted = false;
+	p->is_analyzed = 0;
+	if (p->op_stat != NULL)
+		memset(p->op_stat, 0, p->nOp * sizeof(p->op_stat[0]));
+	p->op_stat_current = NULL;
 	p->ignoreRaised = 0;
 	p->errorAction = ON_CONFLICT_ACTION_ABORT;
 	p->nChange = 0;
@@ -1425,6 +1477,12 @@ sqlVdbeMakeReady(Vdbe * p,	/* The VDBE */
 	if (pParse->explain && nMem < 10) {
 		nMem = 10;
 	}
+	if (pParse->explain == 3) {
+		/* See sqlVdbeList(). */
+		if (nMem < 12)
+			nMem = 12;
+		p->op_stat = sql_xmalloc0(p->nOp * sizeof(p->op_stat[0]));
+	}
 	p->expired = 0;
 
 	/* Memory for registers, parameters, cursor, etc, is allocated in one or two
@@ -1985,6 +2043,7 @@ sqlVdbeClearObject(struct Vdbe *p)
 		sql_xfree(p->pFree);
 	}
 	vdbeFreeOpArray(p->aOp, p->nOp);
+	sql_xfree(p->op_stat);
 	sql_xfree(p->zSql);
 }
 
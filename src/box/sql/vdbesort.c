@@ -154,6 +154,7 @@
 #include "sqlInt.h"
 #include "mem.h"
 #include "vdbeInt.h"
+#include "msgpuck/msgpuck.h"
 
 /*
  * Hard-coded maximum amount of data to accumulate in memory before flushing
@@ -422,13 +423,31 @@ struct PmaWriter {
  */
 struct SorterRecord {
 	int nVal;		/* Size of the record in bytes */
+	int prefix_class;	/* One of SORTER_PREFIX_* constants */
 	union {
 		SorterRecord *pNext;	/* Pointer to next record in list */
 		int iNext;	/* Offset within aMemory of next record */
 	} u;
+	/*
+	 * Normalized prefix of the first key part: two records of
+	 * the same prefix class with different prefixes compare as
+	 * their prefixes do, so vdbeSorterMerge() doesn't need to
+	 * decode the records.
+	 */
+	uint64_t key_prefix;
 	/* The data for the record immediately follows this header */
 };
 
+/* Possible values of SorterRecord.prefix_class */
+enum {
+	/* The first key part can't be normalized. */
+	SORTER_PREFIX_NONE = 0,
+	/* An integer in range [INT64_MIN, INT64_MAX]. */
+	SORTER_PREFIX_INT,
+	/* First 8 bytes of a string compared without collation. */
+	SORTER_PREFIX_STR,
+};
+
 /* Return a pointer to the buffer containing the record data for SorterRecord
  * object p. Should be used as if:
  *
@@ -1002,6 +1021,56 @@ vdbeSortAllocUnpacked(SortSubtask * pTask)
 	return 0;
 }
 
+/*
+ * Compute the normalized prefix of the first part of a sorter key.
+ * The prefixes of two keys of the same class compare as unsigned
+ * integers in the same order the keys do, unless they are equal.
+ *
+ * @param key_def Definition of the sorter key.
+ * @param key MsgPack array with the key.
+ * @param[out] prefix Normalized prefix.
+ *
+ * @retval Class of the prefix, see SORTER_PREFIX_* constants.
+ */
+static int
+vdbeSorterKeyPrefix(const struct key_def *key_def, const char *key,
+		    uint64_t *prefix)
+{
+	if (key_def->part_count == 0 || mp_decode_array(&key) == 0)
+		return SORTER_PREFIX_NONE;
+	int prefix_class;
+	switch (mp_typeof(*key)) {
+	case MP_INT:
+		*prefix = (uint64_t)mp_decode_int(&key) ^ (1ULL << 63);
+		prefix_class = SORTER_PREFIX_INT;
+		break;
+	case MP_UINT: {
+		uint64_t u = mp_decode_uint(&key);
+		if (u > INT64_MAX)
+			return SORTER_PREFIX_NONE;
+		*prefix = u ^ (1ULL << 63);
+		prefix_class = SORTER_PREFIX_INT;
+		break;
+	}
+	case MP_STR: {
+		if (key_def->parts[0].coll != NULL)
+			return SORTER_PREFIX_NONE;
+		uint32_t len = mp_decode_strl(&key);
+		uint64_t value = 0;
+		for (uint32_t i = 0; i < MIN(len, 8u); i++)
+			value |= (uint64_t)(uint8_t)key[i] << (56 - 8 * i);
+		*prefix = value;
+		prefix_class = SORTER_PREFIX_STR;
+		break;
+	}
+	default:
+		return SORTER_PREFIX_NONE;
+	}
+	if (key_def->parts[0].sort_order != SORT_ORDER_ASC)
+		*prefix = ~*prefix;
+	return prefix_class;
+}
+
 /*
  * Merge the two sorted lists p1 and p2 into a single list.
  */
@@ -1018,9 +1087,14 @@ vdbeSorterMerge(SortSubtask * pTask,	/* Calling thread context */
 	assert(p1 != 0 && p2 != 0);
 	for (;;) {
 		int res;
-		res =
-		    pTask->xCompare(pTask, &bCached, SRVAL(p1),
-				    SRVAL(p2));
+		if (p1->prefix_class != SORTER_PREFIX_NONE &&
+		    p1->prefix_class == p2->prefix_class &&
+		    p1->key_prefix != p2->key_prefix) {
+			res = p1->key_prefix < p2->key_prefix ? -1 : 1;
+		} else {
+			res = pTask->xCompare(pTask, &bCached, SRVAL(p1),
+					      SRVAL(p2));
+		}
 
 		if (res <= 0) {
 			*pp = p1;
@@ -1459,6 +1533,8 @@ sqlVdbeSorterWrite(const VdbeCursor * pCsr,	/* Sorter cursor */
 
 	memcpy(SRVAL(pNew), pVal->z, pVal->n);
 	pNew->nVal = pVal->n;
+	pNew->prefix_class = vdbeSorterKeyPrefix(pSorter->key_def, pVal->z,
+						 &pNew->key_prefix);
 	pSorter->list.pList = pNew;
 
 	return rc;
@@ -45,6 +45,7 @@
 #include "whereInt.h"
 #include "box/coll_id_cache.h"
 #include "box/schema.h"
+#include "msgpuck/msgpuck.h"
 
 /** Increase the memory allocation for p->aLTerm[] to be at least n. */
 static void
@@ -919,6 +920,12 @@ constructAutomaticIndex(Parse * pParse,			/* The parsing context */
 	sqlExprCachePush(pParse);
 	assert(pWC->pWInfo->pTabList->a[pLevel->iFrom].fg.viaCoroutine == 0);
 	int cursor = pLevel->iTabCur;
+	/*
+	 * The index is filled in one go and isn't read until then,
+	 * so it is cheaper to collect the tuples and sort them once
+	 * than to insert them into the tree one by one.
+	 */
+	sqlVdbeAddOp1(v, OP_EphemeralBeginBuild, reg_eph);
 	addrTop = sqlVdbeAddOp1(v, OP_Rewind, cursor);
 	regRecord = sqlGetTempReg(pParse);
 	vdbe_emit_ephemeral_index_tuple(pParse, idx_def->key_def, cursor,
@@ -927,6 +934,7 @@ constructAutomaticIndex(Parse * pParse,			/* The parsing context */
 	sqlVdbeAddOp2(v, OP_Next, cursor, addrTop + 1);
 	sqlVdbeChangeP5(v, SQL_STMTSTATUS_AUTOINDEX);
 	sqlVdbeJumpHere(v, addrTop);
+	sqlVdbeAddOp1(v, OP_EphemeralEndBuild, reg_eph);
 	sqlReleaseTempReg(pParse, regRecord);
 	sqlReleaseTempReg(pParse, reg_eph);
 	sqlExprCachePop(pParse);
@@ -961,6 +969,120 @@ whereRangeAdjust(WhereTerm * pTerm, LogEst nNew)
 	return nRet;
 }
 
+/**
+ * Encode the value of a numeric or string literal in MsgPack on
+ * the region. Return NULL if the expression isn't such a literal.
+ */
+static const char *
+where_literal_to_mp(struct Expr *expr, struct region *region)
+{
+	if (expr == NULL)
+		return NULL;
+	bool is_neg = false;
+	if (expr->op == TK_UMINUS) {
+		is_neg = true;
+		expr = expr->pLeft;
+	}
+	char *buf;
+	switch (expr->op) {
+	case TK_INTEGER: {
+		int64_t value;
+		if ((expr->flags & EP_IntValue) != 0) {
+			value = expr->u.iValue;
+		} else {
+			const char *z = expr->u.zToken;
+			bool unused;
+			if ((z[0] == '0' && (z[1] == 'x' || z[1] == 'X')) ||
+			    sql_atoi64(z, &value, &unused, strlen(z)) != 0)
+				return NULL;
+		}
+		uint64_t u = value;
+		if (!is_neg || u == 0) {
+			buf = xregion_alloc(region, mp_sizeof_uint(u));
+			mp_encode_uint(buf, u);
+		} else {
+			if (u > INT64_MAX)
+				return NULL;
+			buf = xregion_alloc(region, mp_sizeof_int(-value));
+			mp_encode_int(buf, -value);
+		}
+		return buf;
+	}
+	case TK_FLOAT: {
+		double value;
+		sqlAtoF(expr->u.zToken, &value, sqlStrlen30(expr->u.zToken));
+		if (is_neg)
+			value = -value;
+		buf = xregion_alloc(region, mp_sizeof_double(value));
+		mp_encode_double(buf, value);
+		return buf;
+	}
+	case TK_STRING: {
+		if (is_neg)
+			return NULL;
+		uint32_t len = strlen(expr->u.zToken);
+		buf = xregion_alloc(region, mp_sizeof_str(len));
+		mp_encode_str(buf, expr->u.zToken, len);
+		return buf;
+	}
+	default:
+		return NULL;
+	}
+}
+
+/**
+ * Encode the value a column is compared with by the given term
+ * in MsgPack on the region. Return NULL if the value isn't known
+ * at compile time or the term has an explicit likelihood.
+ */
+static const char *
+where_term_value_to_mp(struct WhereTerm *term, struct region *region)
+{
+	if (term->truthProb <= 0 || (term->wtFlags & TERM_VNULL) != 0 ||
+	    term->pExpr->pLeft == NULL ||
+	    term->pExpr->pLeft->op != TK_COLUMN_REF)
+		return NULL;
+	return where_literal_to_mp(term->pExpr->pRight, region);
+}
+
+/**
+ * Estimate the number of rows with the first key part in the range
+ * given by the lower and upper bound terms using the histogram
+ * collected by ANALYZE. Either of the terms may be NULL, in which
+ * case the range is unbounded on that side. On success return true
+ * and set @a nOut to the estimate.
+ */
+static bool
+where_histogram_est(struct index_def *idx_def, struct WhereTerm *lower,
+		    struct WhereTerm *upper, LogEst *nOut)
+{
+	const struct sql_index_stat *stat = sql_index_stat_by_def(idx_def);
+	if (stat == NULL || stat->sample_count == 0)
+		return false;
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	const char *lower_mp = lower == NULL ? NULL :
+			       where_term_value_to_mp(lower, region);
+	const char *upper_mp = upper == NULL ? NULL :
+			       where_term_value_to_mp(upper, region);
+	if ((lower != NULL && lower_mp == NULL) ||
+	    (upper != NULL && upper_mp == NULL)) {
+		region_truncate(region, region_svp);
+		return false;
+	}
+	bool lower_incl = lower != NULL &&
+			  (lower->eOperator & (WO_GE | WO_EQ)) != 0;
+	bool upper_incl = upper != NULL &&
+			  (upper->eOperator & (WO_LE | WO_EQ)) != 0;
+	uint32_t count = sql_index_stat_sample_count_in_range(
+		stat, idx_def, lower_mp, lower_incl, upper_mp, upper_incl);
+	region_truncate(region, region_svp);
+	/* Each sample stands for the same share of non-NULL rows. */
+	*nOut = sqlLogEst(stat->tuple_count - stat->null_count) +
+		sqlLogEst(MAX(count, 1)) - sqlLogEst(stat->sample_count);
+	return true;
+}
+
 /*
  * This function is used to estimate the number of rows that will be visited
  * by scanning an index for a range of values. The range may have an upper
@@ -996,10 +1118,12 @@ whereRangeAdjust(WhereTerm * pTerm, LogEst nNew)
  * rows in the index. Assuming no error occurs, *pnOut is adjusted (reduced)
  * to account for the range constraints pLower and pUpper.
  *
- * In the absence of _sql_stat4 ANALYZE data, or if such data cannot be
- * used, a single range inequality reduces the search space by a factor of 4.
- * and a pair of constraints (x>? AND x<?) reduces the expected number of
- * rows visited by a factor of 64.
+ * If the range constrains the first column of an index analyzed by
+ * ANALYZE and both bounds are literals, the estimate is taken from
+ * the histogram of the index. Otherwise, a single range inequality
+ * reduces the search space by a factor of 4, and a pair of
+ * constraints (x>? AND x<?) reduces the expected number of rows
+ * visited by a factor of 64.
  */
 static int
 whereRangeScanEst(struct WhereTerm *pLower, struct WhereTerm *pUpper,
@@ -1009,6 +1133,11 @@ whereRangeScanEst(struct WhereTerm *pLower, struct WhereTerm *pUpper,
 	int nOut = pLoop->nOut;
 	LogEst nNew;
 	assert(pUpper == 0 || (pUpper->wtFlags & TERM_VNULL) == 0);
+	if (pLoop->nEq == 0 &&
+	    where_histogram_est(pLoop->index_def, pLower, pUpper, &nNew)) {
+		pLoop->nOut = MAX(MIN(nNew, nOut), 0);
+		return rc;
+	}
 	nNew = whereRangeAdjust(pLower, nOut);
 	nNew = whereRangeAdjust(pUpper, nNew);
 
@@ -1700,6 +1829,34 @@ whereRangeVectorLen(Parse * pParse,	/* Parsing context */
 	return i;
 }
 
+/**
+ * Estimate the number of rows matching an equality or IS NULL term
+ * on the first column of an index analyzed by ANALYZE. A value that
+ * occurs in more than one histogram bucket is frequent enough to be
+ * estimated from the histogram, other values get the average number
+ * of rows per distinct value. On success return true and set
+ * @a nOut to the estimate.
+ */
+static bool
+where_stat_eq_est(struct index_def *idx_def, struct WhereTerm *term,
+		  LogEst *nOut)
+{
+	const struct sql_index_stat *stat = sql_index_stat_by_def(idx_def);
+	if (stat == NULL || term->truthProb <= 0)
+		return false;
+	if ((term->eOperator & WO_ISNULL) != 0) {
+		*nOut = sqlLogEst(MAX(stat->null_count, 1));
+		return true;
+	}
+	LogEst est;
+	if (!where_histogram_est(idx_def, term, term, &est))
+		return false;
+	LogEst bucket_est = sqlLogEst(stat->tuple_count - stat->null_count) -
+			    sqlLogEst(stat->sample_count);
+	*nOut = est > bucket_est ? est : stat->tuple_log_est[1];
+	return true;
+}
+
 /*
  * We have so far matched pBuilder->pNew->nEq terms of the
  * index pIndex. Try to match one more.
@@ -1770,6 +1927,7 @@ whereLoopAddBtreeIndex(WhereLoopBuilder * pBuilder,	/* The WhereLoop factory */
 		u16 eOp = pTerm->eOperator;	/* Shorthand for pTerm->eOperator */
 		LogEst rCostIdx;
 		LogEst nOutUnadjusted;	/* nOut before IN() and WHERE adjustments */
+		LogEst nStatOut;	/* Estimate based on ANALYZE statistics */
 		int nIn = 0;
 		int nRecValid = pBuilder->nRecValid;
 		uint32_t j = probe->key_def->parts[saved_nEq].fieldno;
@@ -1915,6 +2073,10 @@ whereLoopAddBtreeIndex(WhereLoopBuilder * pBuilder,	/* The WhereLoop factory */
 				assert((eOp & WO_IN) || nIn == 0);
 				pNew->nOut += pTerm->truthProb;
 				pNew->nOut -= nIn;
+			} else if (nEq == 1 && (eOp & (WO_EQ | WO_ISNULL)) != 0 &&
+				   where_stat_eq_est(probe, pTerm, &nStatOut)) {
+				pNew->nOut += nStatOut -
+					      index_field_tuple_est(probe, 0);
 			} else {
 				pNew->nOut +=
 					(index_field_tuple_est(probe, nEq) -
@@ -3426,6 +3588,35 @@ where_loop_builder_shortcut(struct WhereLoopBuilder *builder)
 	return 0;
 }
 
+/**
+ * Check if all the columns of a table used by the query are
+ * fields of the comparison key of the given index. If so, there's
+ * no need to fetch full tuples while scanning the index, which
+ * saves a primary key lookup per row for vinyl secondary indexes.
+ *
+ * @param item Table the index belongs to.
+ * @param idx_def Index definition.
+ * @retval true if the index is covering.
+ */
+static bool
+where_index_is_covering(const struct SrcList_item *item,
+			const struct index_def *idx_def)
+{
+	if ((item->colUsed & MASKBIT(BMS - 1)) != 0 ||
+	    idx_def->key_def->for_func_index)
+		return false;
+	const struct key_def *cmp_def = idx_def->cmp_def;
+	if (cmp_def->is_multikey)
+		return false;
+	Bitmask covered = 0;
+	for (uint32_t i = 0; i < cmp_def->part_count; ++i) {
+		const struct key_part *part = &cmp_def->parts[i];
+		if (part->path == NULL && part->fieldno < BMS - 1)
+			covered |= MASKBIT(part->fieldno);
+	}
+	return (item->colUsed & ~covered) == 0;
+}
+
 /*
  * Generate the beginning of the loop used for WHERE clause processing.
  * The return value is a pointer to an opaque structure that contains
@@ -3904,14 +4095,29 @@ sqlWhereBegin(Parse * pParse,	/* The parser context */
 				struct space *space = space_by_id(space_id);
 				vdbe_emit_open_cursor(pParse, iIndexCur,
 						      idx_def->iid, space);
+				u16 p5 = 0;
 				if ((pLoop->wsFlags & WHERE_CONSTRAINT) != 0
 				    && (pLoop->
 					wsFlags & (WHERE_COLUMN_RANGE |
 						   WHERE_SKIPSCAN)) == 0
 				    && (pWInfo->
 					wctrlFlags & WHERE_ORDERBY_MIN) == 0) {
-					sqlVdbeChangeP5(v, OPFLAG_SEEKEQ);	/* Hint to COMDB2 */
+					p5 |= OPFLAG_SEEKEQ;	/* Hint to COMDB2 */
 				}
+				/*
+				 * Only vinyl benefits from covering
+				 * indexes: memtx indexes store full
+				 * tuples anyway.
+				 */
+				if (idx_def->iid != 0 &&
+				    space_is_vinyl(space) &&
+				    pWInfo->eOnePass == ONEPASS_OFF &&
+				    (wctrlFlags & WHERE_OR_SUBCLAUSE) == 0 &&
+				    where_index_is_covering(pTabItem,
+							    idx_def))
+					p5 |= OPFLAG_COVERING;
+				if (p5 != 0)
+					sqlVdbeChangeP5(v, p5);
 				VdbeComment((v, "%s", idx_def->name));
 			}
 		}
@@ -178,7 +178,8 @@ sqlWhereExplainOneScan(Parse * pParse,	/* Parse context */
 			   (WHERE_ORDERBY_MIN | WHERE_ORDERBY_MAX)) != 0);
 	struct SrcList_item *pItem = &pTabList->a[pLevel->iFrom];
 	assert(pItem->zName != NULL || pItem->pSelect != NULL);
-	if (pParse->explain == 0 && !is_search && pItem->fg.disallow_scan &&
+	if ((pParse->explain == 0 || pParse->explain == 3) && !is_search &&
+	    pItem->fg.disallow_scan &&
 	    (pParse->sql_flags & SQL_SeqScan) == 0) {
 		const char *obj = pItem->zName == NULL ? "subselect" :
 				  tt_sprintf("'%s'", pItem->zName);
@@ -35,9 +35,15 @@
 #include "execute.h"
 #include "diag.h"
 #include "info/info.h"
+#include "sql/sqlInt.h"
+#include "tweaks.h"
 
 static struct sql_stmt_cache sql_stmt_cache;
 
+/** Max number of statements kept for unprepared executions. */
+static uint64_t sql_stmt_reuse_count_max = 64;
+TWEAK_UINT(sql_stmt_reuse_count_max);
+
 void
 sql_stmt_cache_init(void)
 {
@@ -45,6 +51,9 @@ sql_stmt_cache_init(void)
 	sql_stmt_cache.mem_quota = 0;
 	sql_stmt_cache.mem_used = 0;
 	rlist_create(&sql_stmt_cache.gc_queue);
+	sql_stmt_cache.reuse_hash = mh_i32ptr_new();
+	rlist_create(&sql_stmt_cache.reuse_lru);
+	sql_stmt_cache.reuse_count = 0;
 }
 
 void
@@ -286,3 +295,75 @@ sql_stmt_cache_set_size(size_t size)
 	sql_stmt_cache.mem_quota = size;
 	return 0;
 }
+
+/** Remove a reusable statement from the cache and finalize it. */
+static void
+sql_stmt_reuse_entry_delete(struct stmt_reuse_entry *entry)
+{
+	struct sql_stmt_cache *cache = &sql_stmt_cache;
+	const char *sql_str = sql_stmt_query_str(entry->stmt);
+	uint32_t stmt_id = sql_stmt_calculate_id(sql_str, strlen(sql_str));
+	mh_int_t i = mh_i32ptr_find(cache->reuse_hash, stmt_id, NULL);
+	assert(i != mh_end(cache->reuse_hash));
+	mh_i32ptr_del(cache->reuse_hash, i, NULL);
+	rlist_del(&entry->in_lru);
+	cache->reuse_count--;
+	sql_stmt_finalize(entry->stmt);
+	TRASH(entry);
+	free(entry);
+}
+
+struct Vdbe *
+sql_stmt_cache_take(const char *sql_str, uint32_t len)
+{
+	struct sql_stmt_cache *cache = &sql_stmt_cache;
+	uint32_t stmt_id = sql_stmt_calculate_id(sql_str, len);
+	mh_int_t i = mh_i32ptr_find(cache->reuse_hash, stmt_id, NULL);
+	if (i == mh_end(cache->reuse_hash))
+		return NULL;
+	struct stmt_reuse_entry *entry = mh_i32ptr_node(cache->reuse_hash,
+							i)->val;
+	struct Vdbe *stmt = entry->stmt;
+	const char *stmt_sql_str = sql_stmt_query_str(stmt);
+	/* Different SQL texts may have the same id. */
+	if (strlen(stmt_sql_str) != len ||
+	    memcmp(stmt_sql_str, sql_str, len) != 0)
+		return NULL;
+	mh_i32ptr_del(cache->reuse_hash, i, NULL);
+	rlist_del(&entry->in_lru);
+	cache->reuse_count--;
+	TRASH(entry);
+	free(entry);
+	return stmt;
+}
+
+void
+sql_stmt_cache_put(struct Vdbe *stmt)
+{
+	struct sql_stmt_cache *cache = &sql_stmt_cache;
+	const char *sql_str = sql_stmt_query_str(stmt);
+	if (sql_str == NULL || sql_stmt_reuse_count_max == 0) {
+		sql_stmt_finalize(stmt);
+		return;
+	}
+	uint32_t stmt_id = sql_stmt_calculate_id(sql_str, strlen(sql_str));
+	if (mh_i32ptr_find(cache->reuse_hash, stmt_id, NULL) !=
+	    mh_end(cache->reuse_hash)) {
+		sql_stmt_finalize(stmt);
+		return;
+	}
+	sql_stmt_reset(stmt);
+	sql_unbind(stmt);
+	sql_reset_autoinc_id_list(stmt);
+	struct stmt_reuse_entry *entry = xmalloc(sizeof(*entry));
+	entry->stmt = stmt;
+	const struct mh_i32ptr_node_t id_node = { stmt_id, entry };
+	mh_i32ptr_put(cache->reuse_hash, &id_node, NULL, NULL);
+	rlist_add_entry(&cache->reuse_lru, entry, in_lru);
+	cache->reuse_count++;
+	while (cache->reuse_count > sql_stmt_reuse_count_max) {
+		entry = rlist_last_entry(&cache->reuse_lru,
+					 struct stmt_reuse_entry, in_lru);
+		sql_stmt_reuse_entry_delete(entry);
+	}
+}
@@ -57,6 +57,17 @@ struct stmt_cache_entry {
 	uint32_t refs;
 };
 
+/**
+ * Statement left after an unprepared execution, so that the next
+ * execution of the same SQL text can skip parsing and planning.
+ */
+struct stmt_reuse_entry {
+	/** Statement itself, reset and ready to be executed. */
+	struct Vdbe *stmt;
+	/** Link in sql_stmt_cache::reuse_lru. */
+	struct rlist in_lru;
+};
+
 /**
  * Global prepared statements holder.
  */
@@ -81,6 +92,16 @@ struct sql_stmt_cache {
 	 * times.
 	 */
 	struct stmt_cache_entry *last_found;
+	/**
+	 * Query id -> struct stmt_reuse_entry hash. These
+	 * statements aren't referenced by sessions and don't
+	 * count towards mem_quota.
+	 */
+	struct mh_i32ptr_t *reuse_hash;
+	/** Statements kept for reuse, most recently used first. */
+	struct rlist reuse_lru;
+	/** Number of statements kept for reuse. */
+	uint32_t reuse_count;
 };
 
 /**
@@ -141,6 +162,24 @@ sql_stmt_cache_insert(struct Vdbe *stmt);
 struct Vdbe *
 sql_stmt_cache_find(uint32_t stmt_id);
 
+/**
+ * Take a statement compiled from the given SQL text by one of
+ * the previous unprepared executions out of the cache. The
+ * caller owns the statement and should check that it hasn't
+ * expired. Returns NULL if there's no such statement.
+ */
+struct Vdbe *
+sql_stmt_cache_take(const char *sql_str, uint32_t len);
+
+/**
+ * Reset a statement after an unprepared execution and keep it
+ * for reuse, evicting the least recently used one if there
+ * are too many. The statement is finalized if there's already
+ * one with the same SQL text.
+ */
+void
+sql_stmt_cache_put(struct Vdbe *stmt);
+
 
 /** Set prepared cache size limit. */
 int
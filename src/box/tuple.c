@@ -436,6 +436,7 @@ tuple_free(void)
 		tuple_unref(box_tuple_last);
 		box_tuple_last = NULL;
 	}
+	tuple_field_cache_reset();
 
 	mempool_destroy(&tuple_iterator_pool);
 	small_alloc_destroy(&runtime_alloc);
@@ -724,11 +725,76 @@ box_tuple_format(box_tuple_t *tuple)
 	return tuple_format(tuple);
 }
 
+/**
+ * Position of the field last looked up with box_tuple_field() by
+ * decoding the tuple. Lets accesses to growing field numbers, like
+ * tuple[i] in a Lua loop, continue from the previous field instead
+ * of decoding the tuple from the beginning every time. The tuple is
+ * referenced so that its memory can't be reused while it's cached.
+ */
+static struct {
+	/** Cached tuple or NULL. */
+	struct tuple *tuple;
+	/** Number of fields in the tuple. */
+	uint32_t field_count;
+	/** Number of the cached field. */
+	uint32_t fieldno;
+	/** Cached field. */
+	const char *field;
+} box_tuple_field_cache;
+
+void
+tuple_field_cache_reset(void)
+{
+	if (box_tuple_field_cache.tuple != NULL) {
+		tuple_unref(box_tuple_field_cache.tuple);
+		box_tuple_field_cache.tuple = NULL;
+	}
+}
+
+/** True if the field can be found without decoding the tuple. */
+static inline bool
+tuple_field_is_direct(struct tuple_format *format, uint32_t fieldno)
+{
+	if (fieldno >= format->index_field_count)
+		return false;
+	if (fieldno == 0)
+		return true;
+	struct tuple_field *field = tuple_format_field(format, fieldno);
+	return field->offset_slot != TUPLE_OFFSET_SLOT_NIL ||
+	       field->fixed_offset >= 0;
+}
+
 const char *
 box_tuple_field(box_tuple_t *tuple, uint32_t fieldno)
 {
 	assert(tuple != NULL);
-	return tuple_field(tuple, fieldno);
+	if (tuple_field_is_direct(tuple_format(tuple), fieldno) ||
+	    !cord_is_main())
+		return tuple_field(tuple, fieldno);
+	ERROR_INJECT(ERRINJ_TUPLE_FIELD, return NULL);
+	const char *field;
+	uint32_t skip;
+	if (box_tuple_field_cache.tuple == tuple &&
+	    fieldno >= box_tuple_field_cache.fieldno) {
+		field = box_tuple_field_cache.field;
+		skip = fieldno - box_tuple_field_cache.fieldno;
+	} else {
+		if (box_tuple_field_cache.tuple != tuple) {
+			tuple_ref(tuple);
+			tuple_field_cache_reset();
+			box_tuple_field_cache.tuple = tuple;
+		}
+		field = tuple_data(tuple);
+		box_tuple_field_cache.field_count = mp_decode_array(&field);
+		skip = fieldno;
+	}
+	if (fieldno >= box_tuple_field_cache.field_count)
+		return NULL;
+	mp_next_n(&field, skip);
+	box_tuple_field_cache.fieldno = fieldno;
+	box_tuple_field_cache.field = field;
+	return field;
 }
 
 const char *
@@ -749,6 +815,75 @@ box_tuple_field_by_path(box_tuple_t *tuple, const char *path,
 					    index_base);
 }
 
+int
+box_tuple_decode_column(box_tuple_t *const *tuples, uint32_t count,
+			uint32_t fieldno, enum box_column_type type,
+			void *values, bool *nulls)
+{
+	assert(tuples != NULL || count == 0);
+	assert(values != NULL || count == 0);
+	enum field_type expected;
+	switch (type) {
+	case BOX_COLUMN_INT64:
+		expected = FIELD_TYPE_INTEGER;
+		break;
+	case BOX_COLUMN_UINT64:
+		expected = FIELD_TYPE_UNSIGNED;
+		break;
+	case BOX_COLUMN_DOUBLE:
+		expected = FIELD_TYPE_NUMBER;
+		break;
+	default:
+		diag_set(IllegalParams, "unknown column type");
+		return -1;
+	}
+	for (uint32_t i = 0; i < count; i++) {
+		const char *field = tuple_field(tuples[i], fieldno);
+		bool is_null = field == NULL || mp_typeof(*field) == MP_NIL;
+		if (nulls != NULL)
+			nulls[i] = is_null;
+		/* Fields without a value are invalid unless nulls are set. */
+		int rc = is_null && nulls == NULL ? -1 : 0;
+		switch (type) {
+		case BOX_COLUMN_INT64: {
+			int64_t *out = (int64_t *)values + i;
+			*out = 0;
+			if (rc == 0 && !is_null)
+				rc = mp_read_int64(&field, out);
+			break;
+		}
+		case BOX_COLUMN_UINT64: {
+			uint64_t *out = (uint64_t *)values + i;
+			*out = 0;
+			if (rc != 0 || is_null)
+				break;
+			if (mp_typeof(*field) == MP_UINT)
+				*out = mp_decode_uint(&field);
+			else
+				rc = -1;
+			break;
+		}
+		case BOX_COLUMN_DOUBLE: {
+			double *out = (double *)values + i;
+			*out = 0;
+			if (rc == 0 && !is_null)
+				rc = mp_read_double(&field, out);
+			break;
+		}
+		}
+		if (rc != 0) {
+			enum mp_type actual = is_null ? MP_NIL :
+					      mp_typeof(*field);
+			diag_set(ClientError, ER_FIELD_TYPE,
+				 int2str(fieldno + TUPLE_INDEX_BASE),
+				 field_type_strs[expected],
+				 mp_type_strs[actual]);
+			return -1;
+		}
+	}
+	return 0;
+}
+
 typedef struct tuple_iterator box_tuple_iterator_t;
 
 box_tuple_iterator_t *
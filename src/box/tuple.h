@@ -37,6 +37,7 @@
 #include "tt_static.h"
 #include "tt_uuid.h"
 #include "tuple_format.h"
+#include "mp_util.h"
 
 #if defined(__cplusplus)
 extern "C" {
@@ -60,6 +61,13 @@ tuple_init(field_name_hash_f hash);
 void
 tuple_free(void);
 
+/**
+ * Drop the field position cached by box_tuple_field() along with
+ * the reference to its tuple.
+ */
+void
+tuple_field_cache_reset(void);
+
 /**
  * Initialize tuples arena.
  * @param arena[out] Arena to initialize.
@@ -187,6 +195,39 @@ box_tuple_format(box_tuple_t *tuple);
 const char *
 box_tuple_field(box_tuple_t *tuple, uint32_t fieldno);
 
+/**
+ * Types of values decoded by box_tuple_decode_column().
+ */
+enum box_column_type {
+	/** int64_t, decoded from an integer field. */
+	BOX_COLUMN_INT64,
+	/** uint64_t, decoded from an unsigned field. */
+	BOX_COLUMN_UINT64,
+	/** double, decoded from a double, float or integer field. */
+	BOX_COLUMN_DOUBLE,
+};
+
+/**
+ * Decode a field of each of the given tuples into an array of values of
+ * the given type. Useful for processing tuples fetched with
+ * box_iterator_next_batch().
+ *
+ * \param tuples an array of tuples
+ * \param count the number of tuples
+ * \param fieldno zero-based index in MsgPack array
+ * \param type the type of the values, see enum box_column_type
+ * \param[out] values an array of \a count values of the \a type
+ * \param[out] nulls an array of \a count flags set for tuples that
+ *             don't have the field or have nil in it (the value is
+ *             set to 0 for them) or NULL if such tuples are invalid
+ * \retval -1 if a field can't be decoded (check box_error_last())
+ * \retval 0 on success
+ */
+int
+box_tuple_decode_column(box_tuple_t *const *tuples, uint32_t count,
+			uint32_t fieldno, enum box_column_type type,
+			void *values, bool *nulls);
+
 /**
  * Return a raw tuple field in the MsgPack format pointed by
  * a JSON path.
@@ -403,6 +444,18 @@ enum tuple_flag {
 	 * immediately while a snapshot is in progress.
 	 */
 	TUPLE_IS_TEMPORARY = 2,
+	/**
+	 * The tuple doesn't store the field map. Instead it uses the field
+	 * map shared by tuples of the same format with the same field
+	 * offsets, see tuple_format::shared_field_map.
+	 */
+	TUPLE_HAS_SHARED_FIELD_MAP = 3,
+	/**
+	 * The tuple belongs to a memtx space in the cache mode and was read
+	 * since the eviction fiber last looked at it (the CLOCK reference
+	 * bit). Such a tuple gets a second chance instead of being evicted.
+	 */
+	TUPLE_IS_ACCESSED = 4,
 	tuple_flag_MAX,
 };
 
@@ -639,6 +692,18 @@ tuple_is_unreferenced(struct tuple *tuple)
 	return tuple->local_refs == 0;
 }
 
+/**
+ * Check whether the tuple has exactly @a count references. Tuples with
+ * references uploaded to the external storage are known to have more than
+ * TUPLE_LOCAL_REF_MAX references, see tuple_upload_refs().
+ */
+static inline bool
+tuple_ref_count_is(struct tuple *tuple, uint8_t count)
+{
+	return tuple->local_refs == count &&
+	       !tuple_has_flag(tuple, TUPLE_HAS_UPLOADED_REFS);
+}
+
 /** Check that the tuple is in compact mode. */
 static inline bool
 tuple_is_compact(struct tuple *tuple)
@@ -852,6 +917,8 @@ tuple_validate(struct tuple_format *format, struct tuple *tuple)
 static inline const uint32_t *
 tuple_field_map(struct tuple *tuple)
 {
+	if (unlikely(tuple_has_flag(tuple, TUPLE_HAS_SHARED_FIELD_MAP)))
+		return tuple_format(tuple)->shared_field_map;
 	return (const uint32_t *) tuple_data(tuple);
 }
 
@@ -911,6 +978,24 @@ tuple_field_go_to_index(const char **field, uint64_t index);
 int
 tuple_field_go_to_key(const char **field, const char *key, int len);
 
+/**
+ * Get a field stored at a fixed offset (see tuple_field::fixed_offset).
+ * @param tuple A pointer to MessagePack array.
+ * @param fieldno The index of the field.
+ * @param fixed_offset The offset of the field from the first field.
+ * @retval Field data if the field exists or NULL.
+ */
+static inline const char *
+tuple_field_raw_fixed(const char *tuple, uint32_t fieldno,
+		      int32_t fixed_offset)
+{
+	assert(fixed_offset >= 0);
+	uint32_t field_count = mp_decode_array(&tuple);
+	if (unlikely(fieldno >= field_count))
+		return NULL;
+	return tuple + fixed_offset;
+}
+
 /**
  * Get tuple field by field index, relative JSON path and
  * multikey_idx.
@@ -960,8 +1045,13 @@ tuple_field_raw_by_path(struct tuple_format *format, const char *tuple,
 		if (path != NULL && field == NULL)
 			goto parse;
 		offset_slot = field->offset_slot;
-		if (offset_slot == TUPLE_OFFSET_SLOT_NIL)
+		if (offset_slot == TUPLE_OFFSET_SLOT_NIL) {
+			if (field->fixed_offset >= 0) {
+				return tuple_field_raw_fixed(tuple, fieldno,
+							     field->fixed_offset);
+			}
 			goto parse;
+		}
 		if (offset_slot_hint != NULL) {
 			*offset_slot_hint = offset_slot;
 			/*
@@ -997,8 +1087,7 @@ tuple_field_raw_by_path(struct tuple_format *format, const char *tuple,
 		field_count = mp_decode_array(&tuple);
 		if (unlikely(fieldno >= field_count))
 			return NULL;
-		for (uint32_t k = 0; k < fieldno; k++)
-			mp_next(&tuple);
+		mp_next_n(&tuple, fieldno);
 		if (path != NULL &&
 		    unlikely(tuple_go_to_path(&tuple, path, path_len,
 					      index_base, multikey_idx) != 0))
@@ -1033,8 +1122,13 @@ tuple_field_raw(struct tuple_format *format, const char *tuple,
 		struct json_token *token = format->fields.root.children[field_no];
 		field = json_tree_entry(token, struct tuple_field, token);
 		offset_slot = field->offset_slot;
-		if (offset_slot == TUPLE_OFFSET_SLOT_NIL)
+		if (offset_slot == TUPLE_OFFSET_SLOT_NIL) {
+			if (field->fixed_offset >= 0) {
+				return tuple_field_raw_fixed(tuple, field_no,
+							     field->fixed_offset);
+			}
 			goto parse;
+		}
 		offset = field_map_get_offset(field_map, offset_slot,
 					      MULTIKEY_NONE);
 		if (offset == 0)
@@ -1046,8 +1140,7 @@ tuple_field_raw(struct tuple_format *format, const char *tuple,
 		uint32_t field_count = mp_decode_array(&tuple);
 		if (unlikely(field_no >= field_count))
 			return NULL;
-		for ( ; field_no > 0; field_no--)
-			mp_next(&tuple);
+		mp_next_n(&tuple, field_no);
 	}
 	return tuple;
 }
@@ -242,15 +242,28 @@ mp_compare_double_any_number(double lhs, const char *rhs,
 static int
 mp_compare_decimal(const char *lhs, const char *rhs)
 {
+	int8_t ext_type;
+	uint32_t lhs_len = mp_decode_extl(&lhs, &ext_type);
+	assert(ext_type == MP_DECIMAL);
+	uint32_t rhs_len = mp_decode_extl(&rhs, &ext_type);
+	assert(ext_type == MP_DECIMAL);
+	(void)ext_type;
+	/* Most decimals fit in int64, compare them without decNumber. */
+	int64_t lhs_coef, rhs_coef;
+	int32_t lhs_scale, rhs_scale;
+	if (decimal_unpack_int64(lhs, lhs_len, &lhs_coef, &lhs_scale) &&
+	    decimal_unpack_int64(rhs, rhs_len, &rhs_coef, &rhs_scale)) {
+		return decimal_compare_int64(lhs_coef, lhs_scale,
+					     rhs_coef, rhs_scale);
+	}
 	decimal_t lhs_dec, rhs_dec;
 	decimal_t *ret;
-	ret = mp_decode_decimal(&lhs, &lhs_dec);
+	ret = decimal_unpack(&lhs, lhs_len, &lhs_dec);
 	assert(ret != NULL);
-	ret = mp_decode_decimal(&rhs, &rhs_dec);
+	ret = decimal_unpack(&rhs, rhs_len, &rhs_dec);
 	assert(ret != NULL);
 	(void)ret;
 	return decimal_compare(&lhs_dec, &rhs_dec);
-
 }
 
 /**
@@ -332,6 +345,9 @@ mp_compare_number_with_type(const char *lhs, enum mp_type lhs_type,
 	assert(mp_classof(rhs_type) == MP_CLASS_NUMBER ||
 	       mp_extension_class(rhs) == MP_CLASS_NUMBER);
 
+	/* Only decimals are extensions of the number class. */
+	if (lhs_type == MP_EXT && rhs_type == MP_EXT)
+		return mp_compare_decimal(lhs, rhs);
 	/*
 	 * Test decimals first, so that we don't have to
 	 * account for them in other comparators.
@@ -636,6 +652,30 @@ key_part_hint(struct key_part *part, hint_t hint)
 	return is_asc ? hint : HINT_MAX - hint;
 }
 
+/*
+ * Compare hints of two keys or a tuple and a key given that the keys
+ * have at least the given number of parts.
+ *
+ * If a hint packs more leading key parts than the key has (see
+ * key_def::hint_part_count), only the bits of the parts present in
+ * the key are compared because a tuple matching the key prefix may
+ * have any values of the rest of the parts.
+ */
+static inline int
+key_hint_cmp(hint_t hint_a, hint_t hint_b, uint32_t part_count,
+	     struct key_def *key_def)
+{
+	if (part_count < key_def->hint_part_count &&
+	    hint_a != HINT_NONE && hint_b != HINT_NONE) {
+		assert(part_count > 0);
+		uint32_t shift = HINT_PACKED_PART_BITS *
+				 (key_def->hint_part_count - part_count);
+		hint_a >>= shift;
+		hint_b >>= shift;
+	}
+	return hint_cmp(hint_a, hint_b);
+}
+
 /*
  * Implements the field comparison logic. If the key we use is not nullable
  * then a simple call to tuple_compare_field is used.
@@ -821,7 +861,9 @@ tuple_compare_with_key_slowpath(struct tuple *tuple, hint_t tuple_hint,
 	assert(!is_multikey || (tuple_hint != HINT_NONE &&
 		key_hint == HINT_NONE));
 	int rc = 0;
-	if (!is_multikey && (rc = hint_cmp(tuple_hint, key_hint)) != 0)
+	if (!is_multikey &&
+	    (rc = key_hint_cmp(tuple_hint, key_hint, part_count,
+			       key_def)) != 0)
 		return rc;
 	struct key_part *part = key_def->parts;
 	struct tuple_format *format = tuple_format(tuple);
@@ -932,7 +974,7 @@ tuple_compare_with_key_sequential(struct tuple *tuple, hint_t tuple_hint,
 	assert(key_def_is_sequential(key_def));
 	assert(is_nullable == key_def->is_nullable);
 	assert(has_optional_parts == key_def->has_optional_parts);
-	int rc = hint_cmp(tuple_hint, key_hint);
+	int rc = key_hint_cmp(tuple_hint, key_hint, part_count, key_def);
 	if (rc != 0)
 		return rc;
 	const char *tuple_key = tuple_data(tuple);
@@ -971,13 +1013,13 @@ key_compare(const char *key_a, uint32_t part_count_a, hint_t key_a_hint,
 	    const char *key_b, uint32_t part_count_b, hint_t key_b_hint,
 	    struct key_def *key_def)
 {
-	int rc = hint_cmp(key_a_hint, key_b_hint);
-	if (rc != 0)
-		return rc;
 	assert(part_count_a <= key_def->part_count);
 	assert(part_count_b <= key_def->part_count);
 	uint32_t part_count = MIN(part_count_a, part_count_b);
 	assert(part_count <= key_def->part_count);
+	int rc = key_hint_cmp(key_a_hint, key_b_hint, part_count, key_def);
+	if (rc != 0)
+		return rc;
 	bool unused;
 	if (! key_def->is_nullable) {
 		if (key_def_has_desc_parts(key_def)) {
@@ -1083,6 +1125,21 @@ field_compare<FIELD_TYPE_STRING>(const char **field_a, const char **field_b)
 	return r;
 }
 
+template <>
+inline int
+field_compare<FIELD_TYPE_INTEGER>(const char **field_a, const char **field_b)
+{
+	return mp_compare_integer_with_type(*field_a, mp_typeof(**field_a),
+					    *field_b, mp_typeof(**field_b));
+}
+
+template <>
+inline int
+field_compare<FIELD_TYPE_NUMBER>(const char **field_a, const char **field_b)
+{
+	return mp_compare_number(*field_a, *field_b);
+}
+
 template <int TYPE>
 static inline int
 field_compare_and_next(const char **field_a, const char **field_b);
@@ -1114,6 +1171,29 @@ field_compare_and_next<FIELD_TYPE_STRING>(const char **field_a,
 	return r;
 }
 
+template <>
+inline int
+field_compare_and_next<FIELD_TYPE_INTEGER>(const char **field_a,
+					   const char **field_b)
+{
+	int r = mp_compare_integer_with_type(*field_a, mp_typeof(**field_a),
+					     *field_b, mp_typeof(**field_b));
+	mp_next(field_a);
+	mp_next(field_b);
+	return r;
+}
+
+template <>
+inline int
+field_compare_and_next<FIELD_TYPE_NUMBER>(const char **field_a,
+					  const char **field_b)
+{
+	int r = mp_compare_number(*field_a, *field_b);
+	mp_next(field_a);
+	mp_next(field_b);
+	return r;
+}
+
 /* Tuple comparator */
 namespace /* local symbols */ {
 
@@ -1228,18 +1308,88 @@ struct comparator_signature {
 static const comparator_signature cmp_arr[] = {
 	COMPARATOR(0, FIELD_TYPE_UNSIGNED)
 	COMPARATOR(0, FIELD_TYPE_STRING)
+	COMPARATOR(0, FIELD_TYPE_INTEGER)
+	COMPARATOR(0, FIELD_TYPE_NUMBER)
 	COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_UNSIGNED)
 	COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_UNSIGNED)
+	COMPARATOR(0, FIELD_TYPE_INTEGER , 1, FIELD_TYPE_UNSIGNED)
+	COMPARATOR(0, FIELD_TYPE_NUMBER  , 1, FIELD_TYPE_UNSIGNED)
 	COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_STRING)
 	COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_STRING)
+	COMPARATOR(0, FIELD_TYPE_INTEGER , 1, FIELD_TYPE_STRING)
+	COMPARATOR(0, FIELD_TYPE_NUMBER  , 1, FIELD_TYPE_STRING)
+	COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_INTEGER)
+	COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_INTEGER)
+	COMPARATOR(0, FIELD_TYPE_INTEGER , 1, FIELD_TYPE_INTEGER)
+	COMPARATOR(0, FIELD_TYPE_NUMBER  , 1, FIELD_TYPE_INTEGER)
+	COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_NUMBER)
+	COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_NUMBER)
+	COMPARATOR(0, FIELD_TYPE_INTEGER , 1, FIELD_TYPE_NUMBER)
+	COMPARATOR(0, FIELD_TYPE_NUMBER  , 1, FIELD_TYPE_NUMBER)
 	COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_UNSIGNED)
 	COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_UNSIGNED)
+	COMPARATOR(0, FIELD_TYPE_INTEGER , 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_UNSIGNED)
+	COMPARATOR(0, FIELD_TYPE_NUMBER  , 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_UNSIGNED)
 	COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_UNSIGNED)
 	COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_UNSIGNED)
+	COMPARATOR(0, FIELD_TYPE_INTEGER , 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_UNSIGNED)
+	COMPARATOR(0, FIELD_TYPE_NUMBER  , 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_UNSIGNED)
+	COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_INTEGER , 2, FIELD_TYPE_UNSIGNED)
+	COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_INTEGER , 2, FIELD_TYPE_UNSIGNED)
+	COMPARATOR(0, FIELD_TYPE_INTEGER , 1, FIELD_TYPE_INTEGER , 2, FIELD_TYPE_UNSIGNED)
+	COMPARATOR(0, FIELD_TYPE_NUMBER  , 1, FIELD_TYPE_INTEGER , 2, FIELD_TYPE_UNSIGNED)
+	COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_NUMBER  , 2, FIELD_TYPE_UNSIGNED)
+	COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_NUMBER  , 2, FIELD_TYPE_UNSIGNED)
+	COMPARATOR(0, FIELD_TYPE_INTEGER , 1, FIELD_TYPE_NUMBER  , 2, FIELD_TYPE_UNSIGNED)
+	COMPARATOR(0, FIELD_TYPE_NUMBER  , 1, FIELD_TYPE_NUMBER  , 2, FIELD_TYPE_UNSIGNED)
 	COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_STRING)
 	COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_STRING)
+	COMPARATOR(0, FIELD_TYPE_INTEGER , 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_STRING)
+	COMPARATOR(0, FIELD_TYPE_NUMBER  , 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_STRING)
 	COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_STRING)
 	COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_STRING)
+	COMPARATOR(0, FIELD_TYPE_INTEGER , 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_STRING)
+	COMPARATOR(0, FIELD_TYPE_NUMBER  , 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_STRING)
+	COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_INTEGER , 2, FIELD_TYPE_STRING)
+	COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_INTEGER , 2, FIELD_TYPE_STRING)
+	COMPARATOR(0, FIELD_TYPE_INTEGER , 1, FIELD_TYPE_INTEGER , 2, FIELD_TYPE_STRING)
+	COMPARATOR(0, FIELD_TYPE_NUMBER  , 1, FIELD_TYPE_INTEGER , 2, FIELD_TYPE_STRING)
+	COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_NUMBER  , 2, FIELD_TYPE_STRING)
+	COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_NUMBER  , 2, FIELD_TYPE_STRING)
+	COMPARATOR(0, FIELD_TYPE_INTEGER , 1, FIELD_TYPE_NUMBER  , 2, FIELD_TYPE_STRING)
+	COMPARATOR(0, FIELD_TYPE_NUMBER  , 1, FIELD_TYPE_NUMBER  , 2, FIELD_TYPE_STRING)
+	COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_INTEGER)
+	COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_INTEGER)
+	COMPARATOR(0, FIELD_TYPE_INTEGER , 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_INTEGER)
+	COMPARATOR(0, FIELD_TYPE_NUMBER  , 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_INTEGER)
+	COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_INTEGER)
+	COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_INTEGER)
+	COMPARATOR(0, FIELD_TYPE_INTEGER , 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_INTEGER)
+	COMPARATOR(0, FIELD_TYPE_NUMBER  , 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_INTEGER)
+	COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_INTEGER , 2, FIELD_TYPE_INTEGER)
+	COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_INTEGER , 2, FIELD_TYPE_INTEGER)
+	COMPARATOR(0, FIELD_TYPE_INTEGER , 1, FIELD_TYPE_INTEGER , 2, FIELD_TYPE_INTEGER)
+	COMPARATOR(0, FIELD_TYPE_NUMBER  , 1, FIELD_TYPE_INTEGER , 2, FIELD_TYPE_INTEGER)
+	COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_NUMBER  , 2, FIELD_TYPE_INTEGER)
+	COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_NUMBER  , 2, FIELD_TYPE_INTEGER)
+	COMPARATOR(0, FIELD_TYPE_INTEGER , 1, FIELD_TYPE_NUMBER  , 2, FIELD_TYPE_INTEGER)
+	COMPARATOR(0, FIELD_TYPE_NUMBER  , 1, FIELD_TYPE_NUMBER  , 2, FIELD_TYPE_INTEGER)
+	COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_NUMBER)
+	COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_NUMBER)
+	COMPARATOR(0, FIELD_TYPE_INTEGER , 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_NUMBER)
+	COMPARATOR(0, FIELD_TYPE_NUMBER  , 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_NUMBER)
+	COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_NUMBER)
+	COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_NUMBER)
+	COMPARATOR(0, FIELD_TYPE_INTEGER , 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_NUMBER)
+	COMPARATOR(0, FIELD_TYPE_NUMBER  , 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_NUMBER)
+	COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_INTEGER , 2, FIELD_TYPE_NUMBER)
+	COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_INTEGER , 2, FIELD_TYPE_NUMBER)
+	COMPARATOR(0, FIELD_TYPE_INTEGER , 1, FIELD_TYPE_INTEGER , 2, FIELD_TYPE_NUMBER)
+	COMPARATOR(0, FIELD_TYPE_NUMBER  , 1, FIELD_TYPE_INTEGER , 2, FIELD_TYPE_NUMBER)
+	COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_NUMBER  , 2, FIELD_TYPE_NUMBER)
+	COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_NUMBER  , 2, FIELD_TYPE_NUMBER)
+	COMPARATOR(0, FIELD_TYPE_INTEGER , 1, FIELD_TYPE_NUMBER  , 2, FIELD_TYPE_NUMBER)
+	COMPARATOR(0, FIELD_TYPE_NUMBER  , 1, FIELD_TYPE_NUMBER  , 2, FIELD_TYPE_NUMBER)
 };
 
 #undef COMPARATOR
@@ -1271,6 +1421,21 @@ field_compare_with_key<FIELD_TYPE_STRING>(const char **field, const char **key)
 	return r;
 }
 
+template <>
+inline int
+field_compare_with_key<FIELD_TYPE_INTEGER>(const char **field, const char **key)
+{
+	return mp_compare_integer_with_type(*field, mp_typeof(**field),
+					    *key, mp_typeof(**key));
+}
+
+template <>
+inline int
+field_compare_with_key<FIELD_TYPE_NUMBER>(const char **field, const char **key)
+{
+	return mp_compare_number(*field, *key);
+}
+
 template <int TYPE>
 static inline int
 field_compare_with_key_and_next(const char **field_a, const char **field_b);
@@ -1302,6 +1467,29 @@ field_compare_with_key_and_next<FIELD_TYPE_STRING>(const char **field_a,
 	return r;
 }
 
+template <>
+inline int
+field_compare_with_key_and_next<FIELD_TYPE_INTEGER>(const char **field_a,
+						    const char **field_b)
+{
+	int r = mp_compare_integer_with_type(*field_a, mp_typeof(**field_a),
+					     *field_b, mp_typeof(**field_b));
+	mp_next(field_a);
+	mp_next(field_b);
+	return r;
+}
+
+template <>
+inline int
+field_compare_with_key_and_next<FIELD_TYPE_NUMBER>(const char **field_a,
+						   const char **field_b)
+{
+	int r = mp_compare_number(*field_a, *field_b);
+	mp_next(field_a);
+	mp_next(field_b);
+	return r;
+}
+
 /* Tuple with key comparator */
 namespace /* local symbols */ {
 
@@ -1365,7 +1553,8 @@ struct TupleCompareWithKey
 		/* Part count can be 0 in wildcard searches. */
 		if (part_count == 0)
 			return 0;
-		int rc = hint_cmp(tuple_hint, key_hint);
+		int rc = key_hint_cmp(tuple_hint, key_hint, part_count,
+				      key_def);
 		if (rc != 0)
 			return rc;
 		struct tuple_format *format = tuple_format(tuple);
@@ -1388,7 +1577,8 @@ struct TupleCompareWithKey<0, 0, TYPE, MORE_TYPES...>
 		/* Part count can be 0 in wildcard searches. */
 		if (part_count == 0)
 			return 0;
-		int rc = hint_cmp(tuple_hint, key_hint);
+		int rc = key_hint_cmp(tuple_hint, key_hint, part_count,
+				      key_def);
 		if (rc != 0)
 			return rc;
 		struct tuple_format *format = tuple_format(tuple);
@@ -1414,17 +1604,85 @@ struct comparator_with_key_signature
 static const comparator_with_key_signature cmp_wk_arr[] = {
 	KEY_COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_UNSIGNED)
 	KEY_COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_UNSIGNED)
+	KEY_COMPARATOR(0, FIELD_TYPE_INTEGER , 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_UNSIGNED)
+	KEY_COMPARATOR(0, FIELD_TYPE_NUMBER  , 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_UNSIGNED)
 	KEY_COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_UNSIGNED)
 	KEY_COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_UNSIGNED)
+	KEY_COMPARATOR(0, FIELD_TYPE_INTEGER , 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_UNSIGNED)
+	KEY_COMPARATOR(0, FIELD_TYPE_NUMBER  , 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_UNSIGNED)
+	KEY_COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_INTEGER , 2, FIELD_TYPE_UNSIGNED)
+	KEY_COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_INTEGER , 2, FIELD_TYPE_UNSIGNED)
+	KEY_COMPARATOR(0, FIELD_TYPE_INTEGER , 1, FIELD_TYPE_INTEGER , 2, FIELD_TYPE_UNSIGNED)
+	KEY_COMPARATOR(0, FIELD_TYPE_NUMBER  , 1, FIELD_TYPE_INTEGER , 2, FIELD_TYPE_UNSIGNED)
+	KEY_COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_NUMBER  , 2, FIELD_TYPE_UNSIGNED)
+	KEY_COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_NUMBER  , 2, FIELD_TYPE_UNSIGNED)
+	KEY_COMPARATOR(0, FIELD_TYPE_INTEGER , 1, FIELD_TYPE_NUMBER  , 2, FIELD_TYPE_UNSIGNED)
+	KEY_COMPARATOR(0, FIELD_TYPE_NUMBER  , 1, FIELD_TYPE_NUMBER  , 2, FIELD_TYPE_UNSIGNED)
 	KEY_COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_STRING)
 	KEY_COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_STRING)
+	KEY_COMPARATOR(0, FIELD_TYPE_INTEGER , 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_STRING)
+	KEY_COMPARATOR(0, FIELD_TYPE_NUMBER  , 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_STRING)
 	KEY_COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_STRING)
 	KEY_COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_STRING)
+	KEY_COMPARATOR(0, FIELD_TYPE_INTEGER , 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_STRING)
+	KEY_COMPARATOR(0, FIELD_TYPE_NUMBER  , 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_STRING)
+	KEY_COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_INTEGER , 2, FIELD_TYPE_STRING)
+	KEY_COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_INTEGER , 2, FIELD_TYPE_STRING)
+	KEY_COMPARATOR(0, FIELD_TYPE_INTEGER , 1, FIELD_TYPE_INTEGER , 2, FIELD_TYPE_STRING)
+	KEY_COMPARATOR(0, FIELD_TYPE_NUMBER  , 1, FIELD_TYPE_INTEGER , 2, FIELD_TYPE_STRING)
+	KEY_COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_NUMBER  , 2, FIELD_TYPE_STRING)
+	KEY_COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_NUMBER  , 2, FIELD_TYPE_STRING)
+	KEY_COMPARATOR(0, FIELD_TYPE_INTEGER , 1, FIELD_TYPE_NUMBER  , 2, FIELD_TYPE_STRING)
+	KEY_COMPARATOR(0, FIELD_TYPE_NUMBER  , 1, FIELD_TYPE_NUMBER  , 2, FIELD_TYPE_STRING)
+	KEY_COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_INTEGER)
+	KEY_COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_INTEGER)
+	KEY_COMPARATOR(0, FIELD_TYPE_INTEGER , 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_INTEGER)
+	KEY_COMPARATOR(0, FIELD_TYPE_NUMBER  , 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_INTEGER)
+	KEY_COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_INTEGER)
+	KEY_COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_INTEGER)
+	KEY_COMPARATOR(0, FIELD_TYPE_INTEGER , 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_INTEGER)
+	KEY_COMPARATOR(0, FIELD_TYPE_NUMBER  , 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_INTEGER)
+	KEY_COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_INTEGER , 2, FIELD_TYPE_INTEGER)
+	KEY_COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_INTEGER , 2, FIELD_TYPE_INTEGER)
+	KEY_COMPARATOR(0, FIELD_TYPE_INTEGER , 1, FIELD_TYPE_INTEGER , 2, FIELD_TYPE_INTEGER)
+	KEY_COMPARATOR(0, FIELD_TYPE_NUMBER  , 1, FIELD_TYPE_INTEGER , 2, FIELD_TYPE_INTEGER)
+	KEY_COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_NUMBER  , 2, FIELD_TYPE_INTEGER)
+	KEY_COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_NUMBER  , 2, FIELD_TYPE_INTEGER)
+	KEY_COMPARATOR(0, FIELD_TYPE_INTEGER , 1, FIELD_TYPE_NUMBER  , 2, FIELD_TYPE_INTEGER)
+	KEY_COMPARATOR(0, FIELD_TYPE_NUMBER  , 1, FIELD_TYPE_NUMBER  , 2, FIELD_TYPE_INTEGER)
+	KEY_COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_NUMBER)
+	KEY_COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_NUMBER)
+	KEY_COMPARATOR(0, FIELD_TYPE_INTEGER , 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_NUMBER)
+	KEY_COMPARATOR(0, FIELD_TYPE_NUMBER  , 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_NUMBER)
+	KEY_COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_NUMBER)
+	KEY_COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_NUMBER)
+	KEY_COMPARATOR(0, FIELD_TYPE_INTEGER , 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_NUMBER)
+	KEY_COMPARATOR(0, FIELD_TYPE_NUMBER  , 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_NUMBER)
+	KEY_COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_INTEGER , 2, FIELD_TYPE_NUMBER)
+	KEY_COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_INTEGER , 2, FIELD_TYPE_NUMBER)
+	KEY_COMPARATOR(0, FIELD_TYPE_INTEGER , 1, FIELD_TYPE_INTEGER , 2, FIELD_TYPE_NUMBER)
+	KEY_COMPARATOR(0, FIELD_TYPE_NUMBER  , 1, FIELD_TYPE_INTEGER , 2, FIELD_TYPE_NUMBER)
+	KEY_COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_NUMBER  , 2, FIELD_TYPE_NUMBER)
+	KEY_COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_NUMBER  , 2, FIELD_TYPE_NUMBER)
+	KEY_COMPARATOR(0, FIELD_TYPE_INTEGER , 1, FIELD_TYPE_NUMBER  , 2, FIELD_TYPE_NUMBER)
+	KEY_COMPARATOR(0, FIELD_TYPE_NUMBER  , 1, FIELD_TYPE_NUMBER  , 2, FIELD_TYPE_NUMBER)
 
 	KEY_COMPARATOR(1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_UNSIGNED)
 	KEY_COMPARATOR(1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_UNSIGNED)
+	KEY_COMPARATOR(1, FIELD_TYPE_INTEGER , 2, FIELD_TYPE_UNSIGNED)
+	KEY_COMPARATOR(1, FIELD_TYPE_NUMBER  , 2, FIELD_TYPE_UNSIGNED)
 	KEY_COMPARATOR(1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_STRING)
 	KEY_COMPARATOR(1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_STRING)
+	KEY_COMPARATOR(1, FIELD_TYPE_INTEGER , 2, FIELD_TYPE_STRING)
+	KEY_COMPARATOR(1, FIELD_TYPE_NUMBER  , 2, FIELD_TYPE_STRING)
+	KEY_COMPARATOR(1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_INTEGER)
+	KEY_COMPARATOR(1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_INTEGER)
+	KEY_COMPARATOR(1, FIELD_TYPE_INTEGER , 2, FIELD_TYPE_INTEGER)
+	KEY_COMPARATOR(1, FIELD_TYPE_NUMBER  , 2, FIELD_TYPE_INTEGER)
+	KEY_COMPARATOR(1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_NUMBER)
+	KEY_COMPARATOR(1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_NUMBER)
+	KEY_COMPARATOR(1, FIELD_TYPE_INTEGER , 2, FIELD_TYPE_NUMBER)
+	KEY_COMPARATOR(1, FIELD_TYPE_NUMBER  , 2, FIELD_TYPE_NUMBER)
 };
 
 #undef KEY_COMPARATOR
@@ -1579,7 +1837,8 @@ func_index_compare_with_key(struct tuple *tuple, hint_t tuple_hint,
  * For simplicity we construct it using the first key part only;
  * other key parts don't participate in hint construction. As a
  * consequence, tuple hints are useless if the first key part
- * doesn't differ among indexed tuples.
+ * doesn't differ among indexed tuples. An exception is made for
+ * keys starting with two integer parts, see below.
  *
  * Hint class stores one of mp_class enum values corresponding
  * to the field type. We store it in upper bits of a hint so
@@ -1619,6 +1878,22 @@ func_index_compare_with_key(struct tuple *tuple, hint_t tuple_hint,
  *  - For a field containing NULL, the value is 0, and we rely on
  *    mp_class comparison rules for arranging nullable fields.
  *
+ * If the first two key parts are non-nullable ascending integer
+ * fields, both of them are packed in a hint instead, so that
+ * composite keys like (tenant_id, timestamp) can be compared
+ * without looking up the tuple data:
+ *
+ *     [      first part       |      second part      ]
+ *      <-- HINT_PACKED_PART_BITS --> <-- HINT_PACKED_PART_BITS -->
+ *
+ * Each part is stored as the number minus the minimal (negative)
+ * integer that fits in HINT_PACKED_PART_BITS. If the first part
+ * doesn't fit, we store the min or the max value for it and zero
+ * for the second part, because the hints of tuples that differ in
+ * the first part must not be ordered by the second part. A hint of
+ * a key that has only the first part is compared with the first
+ * part bits of a tuple hint (see key_hint_cmp()).
+ *
  * Note: comparison hint only makes sense for non-multikey
  * indexes.
  */
@@ -1662,6 +1937,22 @@ func_index_compare_with_key(struct tuple *tuple, hint_t tuple_hint,
 #define HINT_VALUE_NSEC_SHIFT	(sizeof(int32_t) * CHAR_BIT - HINT_VALUE_NSEC_BITS)
 #define HINT_VALUE_NSEC_MAX	((1ULL << HINT_VALUE_NSEC_BITS) - 1)
 
+/** Number of key parts packed in a hint. */
+#define HINT_PACKED_PART_COUNT	2
+
+/** Max value of a key part stored in a packed hint. */
+#define HINT_PACKED_PART_MAX	((1ULL << HINT_PACKED_PART_BITS) - 1)
+
+/**
+ * Max and min signed integer numbers that fit in a key part of
+ * a packed hint.
+ */
+#define HINT_PACKED_PART_INT_MAX ((1LL << (HINT_PACKED_PART_BITS - 1)) - 1)
+#define HINT_PACKED_PART_INT_MIN (-(1LL << (HINT_PACKED_PART_BITS - 1)))
+
+static_assert(HINT_PACKED_PART_BITS * HINT_PACKED_PART_COUNT == HINT_BITS,
+	      "packed key parts must fill a tuple hint");
+
 /*
  * HINT_CLASS_BITS should be big enough to store any mp_class value.
  * Note, ((1 << HINT_CLASS_BITS) - 1) is reserved for HINT_NONE.
@@ -1739,6 +2030,30 @@ hint_decimal(decimal_t *dec)
 	return hint_create(MP_CLASS_NUMBER, val);
 }
 
+/**
+ * Calculate the hint of a packed decimal. Gives the same result as
+ * hint_decimal(), but doesn't unpack the decimal if it fits in int64.
+ */
+static inline hint_t
+hint_decimal_raw(const char *data, uint32_t len)
+{
+	int64_t coef;
+	int32_t scale;
+	if (!decimal_unpack_int64(data, len, &coef, &scale)) {
+		decimal_t dec;
+		return hint_decimal(decimal_unpack(&data, len, &dec));
+	}
+	uint64_t val = 0;
+	int64_t num;
+	if (decimal_int64_to_int64(coef, scale, &num) &&
+	    num >= HINT_VALUE_INT_MIN && num <= HINT_VALUE_INT_MAX) {
+		val = num - HINT_VALUE_INT_MIN;
+	} else if (coef > 0) {
+		val = HINT_VALUE_MAX;
+	}
+	return hint_create(MP_CLASS_NUMBER, val);
+}
+
 static inline hint_t
 hint_uuid_raw(const char *data)
 {
@@ -1888,10 +2203,7 @@ field_hint_number(const char *field)
 		uint32_t len = mp_decode_extl(&field, &ext_type);
 		switch (ext_type) {
 		case MP_DECIMAL:
-		{
-			decimal_t dec;
-			return hint_decimal(decimal_unpack(&field, len, &dec));
-		}
+			return hint_decimal_raw(field, len);
 		default:
 			unreachable();
 		}
@@ -1910,10 +2222,7 @@ field_hint_decimal(const char *field)
 	uint32_t len = mp_decode_extl(&field, &ext_type);
 	switch (ext_type) {
 	case MP_DECIMAL:
-	{
-		decimal_t dec;
-		return hint_decimal(decimal_unpack(&field, len, &dec));
-	}
+		return hint_decimal_raw(field, len);
 	default:
 		unreachable();
 	}
@@ -1986,10 +2295,7 @@ field_hint_scalar(const char *field, struct coll *coll)
 		uint32_t len = mp_decode_extl(&field, &ext_type);
 		switch (ext_type) {
 		case MP_DECIMAL:
-		{
-			decimal_t dec;
-			return hint_decimal(decimal_unpack(&field, len, &dec));
-		}
+			return hint_decimal_raw(field, len);
 		case MP_UUID:
 			return hint_uuid_raw(field);
 		case MP_DATETIME:
@@ -2077,6 +2383,98 @@ tuple_hint(struct tuple *tuple, struct key_def *key_def)
 	return key_part_hint<has_desc_parts>(key_def->parts, h);
 }
 
+/**
+ * Return the value of an integer key part stored in a packed hint.
+ * Zero and HINT_PACKED_PART_MAX mean that the number doesn't fit.
+ */
+static inline uint64_t
+hint_packed_part(const char *field)
+{
+	switch (mp_typeof(*field)) {
+	case MP_UINT:
+	{
+		uint64_t u = mp_decode_uint(&field);
+		return u >= (uint64_t)HINT_PACKED_PART_INT_MAX ?
+		       HINT_PACKED_PART_MAX : u - HINT_PACKED_PART_INT_MIN;
+	}
+	case MP_INT:
+	{
+		int64_t i = mp_decode_int(&field);
+		return i <= HINT_PACKED_PART_INT_MIN ?
+		       0 : i - HINT_PACKED_PART_INT_MIN;
+	}
+	default:
+		unreachable();
+	}
+	return 0;
+}
+
+static inline hint_t
+hint_packed(uint64_t first, uint64_t second)
+{
+	assert(first <= HINT_PACKED_PART_MAX);
+	assert(second <= HINT_PACKED_PART_MAX);
+	/*
+	 * The first part doesn't fit so tuples with the same hint may
+	 * differ in it. Don't let the second part affect the order.
+	 * Note, this also guarantees that we never return HINT_NONE.
+	 */
+	if (first == 0 || first == HINT_PACKED_PART_MAX)
+		second = 0;
+	return (hint_t)(first << HINT_PACKED_PART_BITS | second);
+}
+
+static hint_t
+key_hint_packed(const char *key, uint32_t part_count, struct key_def *key_def)
+{
+	assert(key_def->hint_part_count == HINT_PACKED_PART_COUNT);
+	(void)key_def;
+	if (part_count == 0)
+		return HINT_NONE;
+	uint64_t first = hint_packed_part(key);
+	uint64_t second = 0;
+	if (part_count > 1) {
+		mp_next(&key);
+		second = hint_packed_part(key);
+	}
+	return hint_packed(first, second);
+}
+
+static hint_t
+tuple_hint_packed(struct tuple *tuple, struct key_def *key_def)
+{
+	assert(key_def->hint_part_count == HINT_PACKED_PART_COUNT);
+	const char *field = tuple_field_by_part(tuple, &key_def->parts[0],
+						MULTIKEY_NONE);
+	uint64_t first = hint_packed_part(field);
+	field = tuple_field_by_part(tuple, &key_def->parts[1], MULTIKEY_NONE);
+	uint64_t second = hint_packed_part(field);
+	return hint_packed(first, second);
+}
+
+/** Check if a key part can be stored in a packed hint. */
+static bool
+key_part_can_be_packed_in_hint(const struct key_part *part)
+{
+	if (key_part_is_nullable(part) || part->sort_order == SORT_ORDER_DESC)
+		return false;
+	switch (part->type) {
+	case FIELD_TYPE_UNSIGNED:
+	case FIELD_TYPE_UINT8:
+	case FIELD_TYPE_UINT16:
+	case FIELD_TYPE_UINT32:
+	case FIELD_TYPE_UINT64:
+	case FIELD_TYPE_INTEGER:
+	case FIELD_TYPE_INT8:
+	case FIELD_TYPE_INT16:
+	case FIELD_TYPE_INT32:
+	case FIELD_TYPE_INT64:
+		return true;
+	default:
+		return false;
+	}
+}
+
 static hint_t
 key_hint_stub(const char *key, uint32_t part_count, struct key_def *key_def)
 {
@@ -2134,14 +2532,46 @@ key_def_set_hint_func(struct key_def *def)
 		key_def_set_hint_func<type, false>(def);
 }
 
+/**
+ * Return true if tuple hints of the given field type are never
+ * HINT_NONE, see key_def::hint_is_total.
+ */
+static bool
+field_type_hint_is_total(enum field_type type)
+{
+	switch (type) {
+	case FIELD_TYPE_NUMBER:
+	case FIELD_TYPE_DOUBLE:
+	case FIELD_TYPE_SCALAR:
+	case FIELD_TYPE_FLOAT32:
+	case FIELD_TYPE_FLOAT64:
+		/* Infinity and NaN don't have hints, see hint_double(). */
+		return false;
+	default:
+		return true;
+	}
+}
+
 static void
 key_def_set_hint_func(struct key_def *def)
 {
+	def->hint_part_count = 1;
+	def->hint_is_total = false;
 	if (def->is_multikey || def->for_func_index) {
 		def->key_hint = key_hint_stub;
 		def->tuple_hint = tuple_hint_stub;
 		return;
 	}
+	if (def->part_count >= HINT_PACKED_PART_COUNT &&
+	    key_part_can_be_packed_in_hint(&def->parts[0]) &&
+	    key_part_can_be_packed_in_hint(&def->parts[1])) {
+		def->hint_part_count = HINT_PACKED_PART_COUNT;
+		def->hint_is_total = true;
+		def->key_hint = key_hint_packed;
+		def->tuple_hint = tuple_hint_packed;
+		return;
+	}
+	def->hint_is_total = field_type_hint_is_total(def->parts->type);
 	switch (def->parts->type) {
 	case FIELD_TYPE_BOOLEAN:
 		key_def_set_hint_func<FIELD_TYPE_BOOLEAN>(def);
@@ -2216,6 +2646,30 @@ key_def_set_hint_func(struct key_def *def)
 
 /* }}} tuple_hint */
 
+/**
+ * Returns the field type a key part is compared as by the pre-compiled
+ * comparators: fixed size integer types are compared exactly like their
+ * arbitrary size counterparts so they share the same comparators.
+ */
+static inline uint32_t
+key_part_compare_type(const struct key_part *part)
+{
+	switch (part->type) {
+	case FIELD_TYPE_UINT8:
+	case FIELD_TYPE_UINT16:
+	case FIELD_TYPE_UINT32:
+	case FIELD_TYPE_UINT64:
+		return FIELD_TYPE_UNSIGNED;
+	case FIELD_TYPE_INT8:
+	case FIELD_TYPE_INT16:
+	case FIELD_TYPE_INT32:
+	case FIELD_TYPE_INT64:
+		return FIELD_TYPE_INTEGER;
+	default:
+		return part->type;
+	}
+}
+
 static void
 key_def_set_compare_func_fast(struct key_def *def)
 {
@@ -2237,7 +2691,8 @@ key_def_set_compare_func_fast(struct key_def *def)
 		uint32_t i = 0;
 		for (; i < def->part_count; i++)
 			if (def->parts[i].fieldno != cmp_arr[k].p[i * 2] ||
-			    def->parts[i].type != cmp_arr[k].p[i * 2 + 1])
+			    key_part_compare_type(&def->parts[i]) !=
+			    cmp_arr[k].p[i * 2 + 1])
 				break;
 		if (i == def->part_count && cmp_arr[k].p[i * 2] == UINT32_MAX) {
 			cmp = cmp_arr[k].f;
@@ -2248,7 +2703,8 @@ key_def_set_compare_func_fast(struct key_def *def)
 		uint32_t i = 0;
 		for (; i < def->part_count; i++) {
 			if (def->parts[i].fieldno != cmp_wk_arr[k].p[i * 2] ||
-			    def->parts[i].type != cmp_wk_arr[k].p[i * 2 + 1])
+			    key_part_compare_type(&def->parts[i]) !=
+			    cmp_wk_arr[k].p[i * 2 + 1])
 				break;
 		}
 		if (i == def->part_count) {
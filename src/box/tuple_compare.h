@@ -70,6 +70,12 @@ typedef uint64_t hint_t;
 #define HINT_NONE ((hint_t)(UINT64_MAX))
 #define HINT_MAX  ((hint_t)(UINT64_MAX - 1))
 
+/**
+ * Number of bits taken by a key part in a hint that packs several
+ * leading key parts, see key_def::hint_part_count.
+ */
+#define HINT_PACKED_PART_BITS	32
+
 /**
  * Compare two tuple hints.
  *
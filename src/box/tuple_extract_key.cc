@@ -312,11 +312,13 @@ tuple_extract_key_slowpath_raw(const char *data, const char *data_end,
 			key_buf += null_count * mp_sizeof_nil();
 			continue;
 		}
-		while (current_fieldno < fieldno) {
+		if (current_fieldno < fieldno) {
 			/* search first field of key in tuple raw data */
 			field = field_end;
+			mp_next_n(&field, fieldno - current_fieldno - 1);
+			field_end = field;
 			mp_next(&field_end);
-			current_fieldno++;
+			current_fieldno = fieldno;
 		}
 
 		/*
@@ -327,9 +329,10 @@ tuple_extract_key_slowpath_raw(const char *data, const char *data_end,
 			null_count = end_fieldno - field_count + 1;
 			field_end = data_end;
 		} else {
-			while (current_fieldno < end_fieldno) {
-				mp_next(&field_end);
-				current_fieldno++;
+			if (current_fieldno < end_fieldno) {
+				mp_next_n(&field_end,
+					  end_fieldno - current_fieldno);
+				current_fieldno = end_fieldno;
 			}
 		}
 		const char *src = field;
@@ -553,8 +556,7 @@ tuple_validate_key_parts_raw(struct key_def *key_def, const char *tuple)
 		field = NULL;
 		if (part->fieldno < field_count) {
 			field = tuple;
-			for (uint32_t k = 0; k < part->fieldno; k++)
-				mp_next(&field);
+			mp_next_n(&field, part->fieldno);
 			if (part->path != NULL &&
 			    tuple_go_to_path(&field, part->path,
 					     part->path_len, TUPLE_INDEX_BASE,
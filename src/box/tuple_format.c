@@ -47,6 +47,15 @@ struct tuple_format **tuple_formats;
 static intptr_t recycled_format_ids = FORMAT_ID_NIL;
 
 static uint32_t formats_size = 0, formats_capacity = 0;
+/**
+ * Tables of tuple formats replaced on growth. They aren't freed until
+ * the subsystem is destroyed, because threads other than tx may look
+ * up formats of read view tuples concurrently (see iproto_read_view).
+ * The table capacity is doubled on growth so there may be at most
+ * as many retired tables as bits in the format id.
+ */
+static struct tuple_format **retired_formats[16];
+static int retired_formats_count = 0;
 static uint64_t formats_epoch = 0;
 
 /**
@@ -115,6 +124,8 @@ tuple_format_cmp(const struct tuple_format *format1,
 		if (field_a->is_key_part != field_b->is_key_part)
 			return (int)field_a->is_key_part -
 				(int)field_b->is_key_part;
+		if (field_a->fixed_offset != field_b->fixed_offset)
+			return field_a->fixed_offset - field_b->fixed_offset;
 		if (field_a->compression_type != field_b->compression_type)
 			return (int)field_a->compression_type -
 			       (int)field_b->compression_type;
@@ -206,6 +217,7 @@ tuple_field_new(void)
 	field->token.type = JSON_TOKEN_END;
 	field->type = FIELD_TYPE_ANY;
 	field->offset_slot = TUPLE_OFFSET_SLOT_NIL;
+	field->fixed_offset = -1;
 	field->coll_id = COLL_NONE;
 	field->nullable_action = ON_CONFLICT_ACTION_NONE;
 	field->multikey_required_fields = NULL;
@@ -410,7 +422,8 @@ tuple_format_add_field(struct tuple_format *format, uint32_t fieldno,
 	 * simply accessible, so we don't store an offset for it.
 	 */
 	if (parent->offset_slot == TUPLE_OFFSET_SLOT_NIL &&
-	    is_sequential == false && (fieldno > 0 || path != NULL)) {
+	    is_sequential == false && (fieldno > 0 || path != NULL) &&
+	    (path != NULL || parent->fixed_offset < 0)) {
 		*current_slot = *current_slot - 1;
 		parent->offset_slot = *current_slot;
 	}
@@ -493,6 +506,27 @@ tuple_format_use_key_part(struct tuple_format *format, uint32_t field_count,
  * Extract all available type info from keys and field
  * definitions.
  */
+/**
+ * Checks if the top-level field @a fieldno is indexed as a whole
+ * by any of the given keys.
+ */
+static bool
+tuple_format_fieldno_is_key_part(struct key_def *const *keys,
+				 uint16_t key_count, uint32_t fieldno)
+{
+	for (uint16_t key_no = 0; key_no < key_count; key_no++) {
+		const struct key_def *key_def = keys[key_no];
+		if (key_def->for_func_index)
+			continue;
+		for (uint32_t i = 0; i < key_def->part_count; i++) {
+			const struct key_part *part = &key_def->parts[i];
+			if (part->fieldno == fieldno && part->path == NULL)
+				return true;
+		}
+	}
+	return false;
+}
+
 static int
 tuple_format_create(struct tuple_format *format, struct key_def *const *keys,
 		    uint16_t key_count, const struct field_def *fields,
@@ -562,6 +596,26 @@ tuple_format_create(struct tuple_format *format, struct key_def *const *keys,
 		}
 	}
 
+	/*
+	 * Fields following required fields of a fixed MsgPack size are
+	 * stored at the same offset in all tuples. Such fields can be
+	 * accessed without an offset slot so we don't allocate one for
+	 * them in tuple_format_add_field(), which saves field map memory.
+	 *
+	 * The preceding fields must be indexed, because Vinyl replaces
+	 * non-indexed fields with nil in surrogate statements.
+	 */
+	int32_t fixed_offset = 0;
+	for (uint32_t i = 0; i < field_count; i++) {
+		struct tuple_field *field = tuple_format_field(format, i);
+		field->fixed_offset = fixed_offset;
+		uint32_t size = field_type_mp_fixed_size[field->type];
+		if (size == 0 || tuple_field_is_nullable(field) ||
+		    !tuple_format_fieldno_is_key_part(keys, key_count, i))
+			break;
+		fixed_offset += size;
+	}
+
 	int current_slot = 0;
 
 	/*
@@ -668,15 +722,21 @@ tuple_format_register(struct tuple_format *format)
 						formats_capacity * 2 : 16;
 			struct tuple_format **formats;
 			formats = (struct tuple_format **)
-				realloc(tuple_formats, new_capacity *
-						       sizeof(tuple_formats[0]));
+				malloc(new_capacity * sizeof(tuple_formats[0]));
 			if (formats == NULL) {
 				diag_set(OutOfMemory,
 					 sizeof(struct tuple_format), "malloc",
 					 "tuple_formats");
 				return -1;
 			}
-
+			if (tuple_formats != NULL) {
+				memcpy(formats, tuple_formats, formats_capacity *
+				       sizeof(tuple_formats[0]));
+				assert(retired_formats_count <
+				       (int)lengthof(retired_formats));
+				retired_formats[retired_formats_count++] =
+					tuple_formats;
+			}
 			formats_capacity = new_capacity;
 			tuple_formats = formats;
 		}
@@ -806,6 +866,10 @@ tuple_format_destroy(struct tuple_format *format)
 		format->constraint[i].destroy(&format->constraint[i]);
 	free(format->constraint);
 	free(format->data);
+	if (format->shared_field_map != NULL) {
+		free((char *)format->shared_field_map -
+		     format->field_map_size);
+	}
 }
 
 /**
@@ -884,6 +948,8 @@ tuple_format_new(struct tuple_format_vtab *vtab, void *engine,
 	format->is_reusable = is_reusable;
 	/* This flag is set in `tuple_format_create` function. */
 	format->is_compressed = false;
+	format->shared_field_map = NULL;
+	format->shared_field_map_is_used = false;
 	format->exact_field_count = exact_field_count;
 	format->epoch = ++formats_epoch;
 	if (format_data != NULL) {
@@ -1250,6 +1316,35 @@ tuple_field_map_create(struct tuple_format *format, const char *tuple,
 	return entry.data == NULL ? 0 : -1;
 }
 
+/** @sa declaration for details. */
+bool
+tuple_format_share_field_map(struct tuple_format *format,
+			     struct field_map_builder *builder)
+{
+	if (format->field_map_size == 0 || builder->extents_size > 0)
+		return false;
+	assert(field_map_build_size(builder) == format->field_map_size);
+	if (format->shared_field_map == NULL) {
+		char *buf = xmalloc(format->field_map_size);
+		format->shared_field_map =
+			(uint32_t *)(buf + format->field_map_size);
+	} else if (field_map_builder_equals(builder,
+					    format->shared_field_map)) {
+		format->shared_field_map_is_used = true;
+		return true;
+	} else if (format->shared_field_map_is_used) {
+		return false;
+	}
+	/*
+	 * Nobody has used the shared map yet so we may replace it with
+	 * the map of the new tuple in the hope that the following tuples
+	 * will have the same field offsets.
+	 */
+	field_map_build(builder, (char *)format->shared_field_map -
+				 format->field_map_size);
+	return false;
+}
+
 uint32_t
 tuple_format_min_field_count(struct key_def * const *keys, uint16_t key_count,
 			     const struct field_def *space_fields,
@@ -1301,6 +1396,9 @@ tuple_format_free()
 		}
 	}
 	free(tuple_formats);
+	for (int i = 0; i < retired_formats_count; i++)
+		free(retired_formats[i]);
+	retired_formats_count = 0;
 	mh_tuple_format_delete(tuple_formats_hash);
 }
 
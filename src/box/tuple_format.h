@@ -135,6 +135,14 @@ struct tuple_field {
 	 * field map is negative.
 	 */
 	int32_t offset_slot;
+	/**
+	 * Offset of the field from the beginning of the first field
+	 * of a tuple if all the preceding fields are required and have
+	 * a fixed MsgPack size (see field_type_mp_fixed_size()) so the
+	 * field is stored at the same offset in all tuples. Such fields
+	 * don't need an offset slot. -1 if the offset is not fixed.
+	 */
+	int32_t fixed_offset;
 	/** True if this field is used by an index. */
 	bool is_key_part;
 	/** True if this field is used by multikey index. */
@@ -266,6 +274,19 @@ struct tuple_format {
 	 * \sa struct field_map_builder
 	 */
 	uint16_t field_map_size;
+	/**
+	 * Field map shared by tuples of this format that have the same
+	 * field offsets, see TUPLE_HAS_SHARED_FIELD_MAP. Points to the
+	 * end of the map like tuple_field_map(). NULL if not allocated.
+	 */
+	uint32_t *shared_field_map;
+	/**
+	 * Set if tuple_format::shared_field_map has ever been used by
+	 * a tuple. Until then, the map may be replaced with another one.
+	 * After that, it's immutable, because deleted tuples may still be
+	 * accessed from read views.
+	 */
+	bool shared_field_map_is_used;
 	/**
 	 * If not set (== 0), any tuple in the space can have any number of
 	 * fields. If set, each tuple must have exactly this number of fields.
@@ -552,6 +573,16 @@ int
 tuple_field_map_create(struct tuple_format *format, const char *tuple,
 		       bool validate, struct field_map_builder *builder);
 
+/**
+ * Check if a new tuple with the field map constructed by @a builder
+ * may use the shared field map of the format instead of storing its
+ * own copy. If it may not, the field map may become the new shared
+ * map candidate.
+ */
+bool
+tuple_format_share_field_map(struct tuple_format *format,
+			     struct field_map_builder *builder);
+
 /**
  * Initialize tuple format subsystem.
  */
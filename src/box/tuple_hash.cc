@@ -33,6 +33,13 @@
 #include "tuple.h"
 #include <PMurHash.h>
 #include "coll/coll.h"
+#include "salad/wyhash.h"
+/*
+ * XXH3 is inlined into the key hash functions. This also makes them
+ * independent of the symbol namespace the xxhash library is built with.
+ */
+#define XXH_INLINE_ALL
+#include "xxHash/xxhash.h"
 #include <math.h>
 
 /* Tuple and key hasher */
@@ -474,3 +481,298 @@ key_hash_slowpath(const char *key, struct key_def *key_def)
 
 	return PMurHash32_Result(h, carry, total_size);
 }
+
+/* {{{ 64-bit hashes */
+
+/*
+ * The functions below are parametrized by a hasher providing two
+ * primitives: hash_u64(val, seed) that hashes a 64-bit integer and
+ * hash(data, size, seed) that hashes a byte string. The key hash is
+ * chained through the parts, with the hash of the previous parts used
+ * as the seed of the next one.
+ */
+
+/** wyhash primitives. */
+struct wyhash_hasher {
+	static const uint64_t seed = WYHASH_SEED;
+
+	static inline uint64_t
+	hash_u64(uint64_t val, uint64_t seed)
+	{
+		return wyhash_u64(val, seed);
+	}
+
+	static inline uint64_t
+	hash(const void *data, size_t size, uint64_t seed)
+	{
+		return wyhash(data, size, seed);
+	}
+};
+
+/** XXH3 primitives. */
+struct xxh3_hasher {
+	static const uint64_t seed = 0;
+
+	static inline uint64_t
+	hash_u64(uint64_t val, uint64_t seed)
+	{
+		return XXH3_64bits_withSeed(&val, sizeof(val), seed);
+	}
+
+	static inline uint64_t
+	hash(const void *data, size_t size, uint64_t seed)
+	{
+		return XXH3_64bits_withSeed(data, size, seed);
+	}
+};
+
+/** Hashes an integer field encoded as MP_UINT or MP_INT. */
+template <class Hasher>
+static inline uint64_t
+field_hash64_int(uint64_t h, const char **field)
+{
+	uint64_t val = mp_typeof(**field) == MP_UINT ?
+		       mp_decode_uint(field) : (uint64_t)mp_decode_int(field);
+	return Hasher::hash_u64(val, h);
+}
+
+/**
+ * Hashes a floating point value. Integral values are hashed as integers
+ * so that they have the same hash as equal MP_UINT and MP_INT values.
+ */
+template <class Hasher>
+static inline uint64_t
+field_hash64_double(uint64_t h, double val)
+{
+	double iptr;
+	if (isfinite(val) && modf(val, &iptr) == 0 &&
+	    val >= -exp2(63) && val < exp2(64)) {
+		if (val >= 0)
+			return Hasher::hash_u64((uint64_t)val, h);
+		return Hasher::hash_u64((uint64_t)(int64_t)val, h);
+	}
+	uint64_t bits;
+	memcpy(&bits, &val, sizeof(bits));
+	return Hasher::hash_u64(bits, h);
+}
+
+/**
+ * Hashes a key field and advances @a field to the next one. The hash of
+ * the previous fields of the key is passed in @a h.
+ */
+template <class Hasher>
+static uint64_t
+field_hash64(uint64_t h, const char **field, enum field_type type,
+	     struct coll *coll)
+{
+	const char *f = *field;
+	if (type == FIELD_TYPE_DOUBLE) {
+		/*
+		 * Values of double fields are compared as doubles so hash
+		 * them as doubles, see tuple_hash_field().
+		 */
+		double val;
+		if (mp_read_double_lossy(&f, &val) == -1)
+			unreachable();
+		mp_next(field);
+		return field_hash64_double<Hasher>(h, val);
+	}
+	switch (mp_typeof(**field)) {
+	case MP_UINT:
+	case MP_INT:
+		return field_hash64_int<Hasher>(h, field);
+	case MP_FLOAT:
+		return field_hash64_double<Hasher>(h, mp_decode_float(field));
+	case MP_DOUBLE:
+		return field_hash64_double<Hasher>(h, mp_decode_double(field));
+	case MP_STR: {
+		uint32_t size;
+		f = mp_decode_str(field, &size);
+		if (coll != NULL) {
+			uint32_t ch = HASH_SEED;
+			uint32_t carry = 0;
+			size = coll->hash(f, size, &ch, &carry, coll);
+			return Hasher::hash_u64(
+				PMurHash32_Result(ch, carry, size), h);
+		}
+		return Hasher::hash(f, size, h);
+	}
+	default:
+		/* Values of other types are hashed as is, including nil. */
+		mp_next(field);
+		return Hasher::hash(f, *field - f, h);
+	}
+}
+
+template <class Hasher>
+static inline uint64_t
+field_hash64_null(uint64_t h)
+{
+	const char null = 0xc0;
+	return Hasher::hash(&null, 1, h);
+}
+
+/** Folds a 64-bit hash to the 32-bit value returned by key_hash(). */
+static inline uint32_t
+hash64_result(uint64_t h)
+{
+	return (uint32_t)(h ^ (h >> 32));
+}
+
+/**
+ * Hashes a key consisting only of integer fields. Doesn't need to
+ * look at the field types.
+ */
+template <class Hasher>
+static uint32_t
+key_hash64_int(const char *key, struct key_def *key_def)
+{
+	uint64_t h = Hasher::seed;
+	for (uint32_t i = 0; i < key_def->part_count; i++)
+		h = field_hash64_int<Hasher>(h, &key);
+	return hash64_result(h);
+}
+
+/** Tuple counterpart of key_hash64_int(). */
+template <class Hasher, bool is_sequential>
+static uint32_t
+tuple_hash64_int(struct tuple *tuple, struct key_def *key_def)
+{
+	assert(!key_def->is_multikey);
+	assert(!key_def->has_json_paths);
+	assert(!key_def->has_optional_parts);
+	struct tuple_format *format = tuple_format(tuple);
+	const char *tuple_raw = tuple_data(tuple);
+	const uint32_t *field_map = tuple_field_map(tuple);
+	const char *field = tuple_field_raw(format, tuple_raw, field_map,
+					   key_def->parts[0].fieldno);
+	uint64_t h = Hasher::seed;
+	for (uint32_t i = 0; i < key_def->part_count; i++) {
+		if (!is_sequential && i > 0) {
+			field = tuple_field_raw(format, tuple_raw, field_map,
+						key_def->parts[i].fieldno);
+		}
+		h = field_hash64_int<Hasher>(h, &field);
+	}
+	return hash64_result(h);
+}
+
+template <class Hasher>
+static uint32_t
+key_hash64_slowpath(const char *key, struct key_def *key_def)
+{
+	uint64_t h = Hasher::seed;
+	for (struct key_part *part = key_def->parts;
+	     part < key_def->parts + key_def->part_count; part++)
+		h = field_hash64<Hasher>(h, &key, part->type, part->coll);
+	return hash64_result(h);
+}
+
+template <class Hasher, bool has_optional_parts, bool has_json_paths>
+static uint32_t
+tuple_hash64_slowpath(struct tuple *tuple, struct key_def *key_def)
+{
+	assert(has_json_paths == key_def->has_json_paths);
+	assert(has_optional_parts == key_def->has_optional_parts);
+	assert(!key_def->is_multikey);
+	assert(!key_def->for_func_index);
+	uint64_t h = Hasher::seed;
+	struct tuple_format *format = tuple_format(tuple);
+	const char *tuple_raw = tuple_data(tuple);
+	const uint32_t *field_map = tuple_field_map(tuple);
+	const char *end = (char *)tuple + tuple_size(tuple);
+	const char *field = NULL;
+	for (uint32_t i = 0; i < key_def->part_count; i++) {
+		struct key_part *part = &key_def->parts[i];
+		/*
+		 * Fields of sequential parts are hashed one after another
+		 * without looking them up in the tuple.
+		 */
+		if (i == 0 || has_json_paths ||
+		    part[-1].fieldno + 1 != part->fieldno) {
+			if (has_json_paths) {
+				field = tuple_field_raw_by_part(
+					format, tuple_raw, field_map, part,
+					MULTIKEY_NONE);
+			} else {
+				field = tuple_field_raw(format, tuple_raw,
+							field_map,
+							part->fieldno);
+			}
+		}
+		if (has_optional_parts && (field == NULL || field >= end))
+			h = field_hash64_null<Hasher>(h);
+		else
+			h = field_hash64<Hasher>(h, &field, part->type,
+						 part->coll);
+	}
+	return hash64_result(h);
+}
+
+template <class Hasher>
+static void
+key_def_get_hash64_func(struct key_def *key_def, tuple_hash_t *tuple_hash,
+			key_hash_t *key_hash)
+{
+	bool is_int = !key_def->is_nullable && !key_def->has_json_paths;
+	bool is_sequential = true;
+	for (uint32_t i = 0; i < key_def->part_count && is_int; i++) {
+		struct key_part *part = &key_def->parts[i];
+		switch (part->type) {
+		case FIELD_TYPE_UNSIGNED:
+		case FIELD_TYPE_INTEGER:
+		case FIELD_TYPE_UINT8:
+		case FIELD_TYPE_UINT16:
+		case FIELD_TYPE_UINT32:
+		case FIELD_TYPE_UINT64:
+		case FIELD_TYPE_INT8:
+		case FIELD_TYPE_INT16:
+		case FIELD_TYPE_INT32:
+		case FIELD_TYPE_INT64:
+			break;
+		default:
+			is_int = false;
+			break;
+		}
+		if (i > 0 && part[-1].fieldno + 1 != part->fieldno)
+			is_sequential = false;
+	}
+	if (is_int) {
+		*tuple_hash = is_sequential ?
+			      tuple_hash64_int<Hasher, true> :
+			      tuple_hash64_int<Hasher, false>;
+		*key_hash = key_hash64_int<Hasher>;
+		return;
+	}
+	if (key_def->has_optional_parts) {
+		if (key_def->has_json_paths)
+			*tuple_hash = tuple_hash64_slowpath<Hasher, true, true>;
+		else
+			*tuple_hash = tuple_hash64_slowpath<Hasher, true,
+							    false>;
+	} else {
+		if (key_def->has_json_paths)
+			*tuple_hash = tuple_hash64_slowpath<Hasher, false,
+							    true>;
+		else
+			*tuple_hash = tuple_hash64_slowpath<Hasher, false,
+							    false>;
+	}
+	*key_hash = key_hash64_slowpath<Hasher>;
+}
+
+void
+key_def_get_wyhash_func(struct key_def *key_def, tuple_hash_t *tuple_hash,
+			key_hash_t *key_hash)
+{
+	key_def_get_hash64_func<wyhash_hasher>(key_def, tuple_hash, key_hash);
+}
+
+void
+key_def_get_xxh3_func(struct key_def *key_def, tuple_hash_t *tuple_hash,
+		      key_hash_t *key_hash)
+{
+	key_def_get_hash64_func<xxh3_hasher>(key_def, tuple_hash, key_hash);
+}
+
+/* }}} 64-bit hashes */
@@ -30,12 +30,12 @@
  * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
  * SUCH DAMAGE.
  */
+#include "key_def.h"
+
 #if defined(__cplusplus)
 extern "C" {
 #endif /* defined(__cplusplus) */
 
-struct key_def;
-
 /**
  * Initialize tuple_hash() and key_hash() function for the key_def
  * @param key_def key definition
@@ -43,6 +43,28 @@ struct key_def;
 void
 key_def_set_hash_func(struct key_def *def);
 
+/**
+ * Get tuple_hash() and key_hash() functions for the key_def which
+ * compute hashes with wyhash instead of PMurHash32. Unlike the default
+ * hash functions they don't hash MsgPack bytes so the hashes don't
+ * depend on the value encoding, but they depend on the host byte order
+ * and so must never be persisted.
+ * @param key_def key definition
+ * @param[out] tuple_hash tuple hash function
+ * @param[out] key_hash key hash function
+ */
+void
+key_def_get_wyhash_func(struct key_def *def, tuple_hash_t *tuple_hash,
+			key_hash_t *key_hash);
+
+/**
+ * Same as key_def_get_wyhash_func(), but the hashes are computed
+ * with XXH3.
+ */
+void
+key_def_get_xxh3_func(struct key_def *def, tuple_hash_t *tuple_hash,
+		      key_hash_t *key_hash);
+
 #if defined(__cplusplus)
 } /* extern "C" */
 #endif /* defined(__cplusplus) */
@@ -42,6 +42,8 @@
 #include "session.h"
 #include "wal_ext.h"
 #include "rmean.h"
+#include "clock.h"
+#include "usdt.h"
 
 double too_long_threshold;
 
@@ -541,6 +543,7 @@ txn_begin(void)
 	txn_set_flags(txn, TXN_CAN_YIELD);
 	memtx_tx_register_txn(txn);
 	rmean_collect(rmean_box, IPROTO_BEGIN, 1);
+	USDT_PROBE(txn_begin, txn->id);
 	return txn;
 }
 
@@ -751,6 +754,7 @@ txn_complete_fail(struct txn *txn)
 	}
 	if (txn_event_on_rollback_run_triggers(txn) != 0)
 		diag_log();
+	USDT_PROBE(txn_rollback, txn->id, txn->signature);
 	txn_free_or_wakeup(txn);
 	rmean_collect(rmean_box, IPROTO_ROLLBACK, 1);
 }
@@ -783,6 +787,7 @@ txn_complete_success(struct txn *txn)
 	}
 	if (txn_event_on_commit_run_triggers(txn) != 0)
 		diag_log();
+	USDT_PROBE(txn_commit, txn->id, txn->signature);
 	txn_free_or_wakeup(txn);
 	rmean_collect(rmean_box, IPROTO_COMMIT, 1);
 }
@@ -1118,7 +1123,10 @@ txn_commit(struct txn *txn)
 	}
 
 	fiber_set_txn(fiber(), NULL);
-	if (journal_write(req) != 0)
+	double wal_start = clock_monotonic();
+	int write_rc = journal_write(req);
+	fiber()->storage.net.wal_time += clock_monotonic() - wal_start;
+	if (write_rc != 0)
 		goto rollback_io;
 	if (req->res < 0) {
 		diag_set_journal_res(req->res);
@@ -1136,7 +1144,10 @@ txn_commit(struct txn *txn)
 			txn_limbo_ack(&txn_limbo, txn_limbo.owner_id,
 				      limbo_entry->lsn);
 		}
+		double limbo_start = clock_monotonic();
 		int rc = txn_limbo_wait_complete(&txn_limbo, limbo_entry);
+		fiber()->storage.net.limbo_time +=
+			clock_monotonic() - limbo_start;
 		if (rc < 0) {
 			if (fiber_is_cancelled()) {
 				txn->fiber = NULL;
@@ -48,6 +48,8 @@ txn_limbo_create(struct txn_limbo *limbo)
 	limbo->owner_id = REPLICA_ID_NIL;
 	fiber_cond_create(&limbo->wait_cond);
 	vclock_create(&limbo->vclock);
+	limbo->ack_lsn_count = 0;
+	limbo->is_confirm_in_progress = false;
 	vclock_create(&limbo->promote_term_map);
 	vclock_create(&limbo->confirmed_vclock);
 	limbo->promote_greatest_term = 0;
@@ -167,7 +169,6 @@ txn_limbo_append(struct txn_limbo *limbo, uint32_t id, struct txn *txn)
 	}
 	e->txn = txn;
 	e->lsn = -1;
-	e->ack_count = 0;
 	e->is_commit = false;
 	e->is_rollback = false;
 	rlist_add_tail_entry(&limbo->queue, e, in_queue);
@@ -237,20 +238,13 @@ txn_limbo_assign_local_lsn(struct txn_limbo *limbo,
 	assert(entry->lsn == -1);
 	assert(lsn > 0);
 
-	entry->lsn = lsn;
 	/*
 	 * The entry just got its LSN after a WAL write. It could
-	 * happen that this LSN was already ACKed by some
-	 * replicas. Update the ACK counter to take them into
-	 * account.
+	 * happen that this LSN was already ACKed by some replicas.
+	 * They are accounted in the limbo vclock so nothing else
+	 * needs to be done.
 	 */
-	struct vclock_iterator iter;
-	vclock_iterator_init(&iter, &limbo->vclock);
-	int ack_count = 0;
-	vclock_foreach(&iter, vc)
-		ack_count += vc.lsn >= lsn;
-	assert(ack_count >= entry->ack_count);
-	entry->ack_count = ack_count;
+	entry->lsn = lsn;
 }
 
 void
@@ -645,13 +639,134 @@ txn_limbo_read_demote(struct txn_limbo *limbo, int64_t lsn)
 	return txn_limbo_read_promote(limbo, REPLICA_ID_NIL, lsn);
 }
 
+/**
+ * Updates the sorted array of ACKed LSNs after the ACKed LSN of some
+ * instance has grown from @a prev_lsn to @a lsn.
+ */
+static void
+txn_limbo_update_ack_lsns(struct txn_limbo *limbo, int64_t prev_lsn,
+			  int64_t lsn)
+{
+	assert(lsn > prev_lsn);
+	int64_t *lsns = limbo->ack_lsns;
+	/* Position of the old LSN, or the end if it wasn't ACKed. */
+	int old_pos = limbo->ack_lsn_count;
+	if (prev_lsn > 0) {
+		int lo = 0, hi = limbo->ack_lsn_count;
+		while (lo < hi) {
+			int mid = lo + (hi - lo) / 2;
+			if (lsns[mid] > prev_lsn)
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+		assert(lo < limbo->ack_lsn_count && lsns[lo] == prev_lsn);
+		old_pos = lo;
+	} else {
+		assert(limbo->ack_lsn_count < VCLOCK_MAX);
+		limbo->ack_lsn_count++;
+	}
+	/* The new position is before the old one, since the LSN grew. */
+	int lo = 0, hi = old_pos;
+	while (lo < hi) {
+		int mid = lo + (hi - lo) / 2;
+		if (lsns[mid] >= lsn)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	memmove(&lsns[lo + 1], &lsns[lo], (old_pos - lo) * sizeof(*lsns));
+	lsns[lo] = lsn;
+}
+
+/**
+ * Returns the LSN of the last synchronous transaction in the queue
+ * which has gathered a quorum of ACKs, or -1 if there is no such
+ * transaction.
+ */
+static int64_t
+txn_limbo_quorum_lsn(struct txn_limbo *limbo)
+{
+	int quorum = replication_synchro_quorum;
+	if (quorum <= 0 || quorum > limbo->ack_lsn_count)
+		return -1;
+	int64_t ack_lsn = limbo->ack_lsns[quorum - 1];
+	int64_t confirm_lsn = -1;
+	struct txn_limbo_entry *e;
+	rlist_foreach_entry(e, &limbo->queue, in_queue) {
+		/*
+		 * Entries without LSN are always in the end of the queue, so
+		 * the loop visits only the entries being confirmed.
+		 */
+		if (e->lsn > ack_lsn || e->lsn == -1)
+			break;
+		/*
+		 * Sync transactions need to collect acks. Async
+		 * transactions are automatically committed right
+		 * after all the previous sync transactions are.
+		 */
+		if (txn_has_flag(e->txn, TXN_WAIT_ACK))
+			confirm_lsn = e->lsn;
+	}
+	return confirm_lsn;
+}
+
+/**
+ * Confirms all the synchronous transactions which have gathered a
+ * quorum. If a CONFIRM is being written by another fiber, it will
+ * confirm them when done. Otherwise, waits for
+ * replication_synchro_confirm_delay to collect more ACKs into the same
+ * CONFIRM entry and writes CONFIRM entries until no transaction with a
+ * quorum is left.
+ */
+static void
+txn_limbo_confirm(struct txn_limbo *limbo)
+{
+	if (limbo->is_confirm_in_progress)
+		return;
+	if (txn_limbo_quorum_lsn(limbo) <= limbo->confirmed_lsn)
+		return;
+	limbo->is_confirm_in_progress = true;
+	if (replication_synchro_confirm_delay > 0)
+		fiber_sleep(replication_synchro_confirm_delay);
+	while (true) {
+		/* The limbo state could change while the fiber yielded. */
+		if (limbo->owner_id != instance_id ||
+		    txn_limbo_is_frozen(limbo) || limbo->is_in_rollback)
+			break;
+		int64_t confirm_lsn = txn_limbo_quorum_lsn(limbo);
+		if (confirm_lsn <= limbo->confirmed_lsn)
+			break;
+		txn_limbo_write_confirm(limbo, confirm_lsn);
+		txn_limbo_read_confirm(limbo, confirm_lsn);
+	}
+	limbo->is_confirm_in_progress = false;
+}
+
 void
 txn_limbo_ack(struct txn_limbo *limbo, uint32_t replica_id, int64_t lsn)
 {
-	if (rlist_empty(&limbo->queue))
-		return;
 	if (txn_limbo_is_frozen(limbo))
 		return;
+	/*
+	 * One of the reasons why can happen - the remote instance is not
+	 * read-only and wrote something under its own insance_id. For qsync
+	 * that most likely means that the remote instance decided to take over
+	 * the limbo ownership, and the current node is going to become a
+	 * replica very soon.
+	 */
+	int64_t prev_lsn = vclock_get(&limbo->vclock, replica_id);
+	if (lsn <= prev_lsn)
+		return;
+	/*
+	 * The ACKed LSNs are tracked even when the queue is empty so that
+	 * the transactions added later account the ACKs received before
+	 * their WAL write has completed.
+	 */
+	vclock_follow(&limbo->vclock, replica_id, lsn);
+	txn_limbo_update_ack_lsns(limbo, prev_lsn, lsn);
+	if (rlist_empty(&limbo->queue))
+		return;
 	assert(!txn_limbo_is_ro(limbo));
 	/*
 	 * If limbo is currently writing a rollback, it means that the whole
@@ -666,42 +781,7 @@ txn_limbo_ack(struct txn_limbo *limbo, uint32_t replica_id, int64_t lsn)
 	if (limbo->is_in_rollback)
 		return;
 	assert(limbo->owner_id != REPLICA_ID_NIL);
-	int64_t prev_lsn = vclock_get(&limbo->vclock, replica_id);
-	/*
-	 * One of the reasons why can happen - the remote instance is not
-	 * read-only and wrote something under its own insance_id. For qsync
-	 * that most likely means that the remote instance decided to take over
-	 * the limbo ownership, and the current node is going to become a
-	 * replica very soon.
-	 */
-	if (lsn == prev_lsn)
-		return;
-	vclock_follow(&limbo->vclock, replica_id, lsn);
-	struct txn_limbo_entry *e;
-	int64_t confirm_lsn = -1;
-	rlist_foreach_entry(e, &limbo->queue, in_queue) {
-		assert(e->ack_count <= VCLOCK_MAX);
-		if (e->lsn > lsn)
-			break;
-		/*
-		 * Sync transactions need to collect acks. Async
-		 * transactions are automatically committed right
-		 * after all the previous sync transactions are.
-		 */
-		if (!txn_has_flag(e->txn, TXN_WAIT_ACK)) {
-			continue;
-		} else if (e->lsn <= prev_lsn) {
-			continue;
-		} else if (++e->ack_count < replication_synchro_quorum) {
-			continue;
-		} else {
-			confirm_lsn = e->lsn;
-		}
-	}
-	if (confirm_lsn == -1 || confirm_lsn <= limbo->confirmed_lsn)
-		return;
-	txn_limbo_write_confirm(limbo, confirm_lsn);
-	txn_limbo_read_confirm(limbo, confirm_lsn);
+	txn_limbo_confirm(limbo);
 }
 
 /**
@@ -1241,23 +1321,8 @@ txn_limbo_on_parameters_change(struct txn_limbo *limbo)
 {
 	if (rlist_empty(&limbo->queue) || txn_limbo_is_frozen(limbo))
 		return;
-	struct txn_limbo_entry *e;
-	int64_t confirm_lsn = -1;
-	rlist_foreach_entry(e, &limbo->queue, in_queue) {
-		assert(e->ack_count <= VCLOCK_MAX);
-		if (!txn_has_flag(e->txn, TXN_WAIT_ACK)) {
-			continue;
-		} else if (e->ack_count < replication_synchro_quorum) {
-			continue;
-		} else {
-			confirm_lsn = e->lsn;
-			assert(confirm_lsn > 0);
-		}
-	}
-	if (confirm_lsn > limbo->confirmed_lsn && !limbo->is_in_rollback) {
-		txn_limbo_write_confirm(limbo, confirm_lsn);
-		txn_limbo_read_confirm(limbo, confirm_lsn);
-	}
+	if (!limbo->is_in_rollback)
+		txn_limbo_confirm(limbo);
 	/*
 	 * Wakeup all the others - timed out will rollback. Also
 	 * there can be non-transactional waiters, such as CONFIRM
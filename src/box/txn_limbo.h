@@ -57,11 +57,6 @@ struct txn_limbo_entry {
 	 * written to WAL yet.
 	 */
 	int64_t lsn;
-	/**
-	 * Number of ACKs. Or in other words - how many replicas
-	 * confirmed receipt of the transaction.
-	 */
-	int ack_count;
 	/**
 	 * Result flags. Only one of them can be true. But both
 	 * can be false if the transaction is still waiting for
@@ -131,6 +126,21 @@ struct txn_limbo {
 	 * transactions, created on the limbo's owner node.
 	 */
 	struct vclock vclock;
+	/**
+	 * Non-zero components of the vclock above sorted in descending
+	 * order. The LSN at position N - 1 is the biggest LSN acknowledged
+	 * by at least N instances, so the biggest LSN gathered a quorum is
+	 * found without walking the queue on each ACK.
+	 */
+	int64_t ack_lsns[VCLOCK_MAX];
+	/** Number of entries in the ack_lsns array. */
+	int ack_lsn_count;
+	/**
+	 * Set while a fiber is writing CONFIRM entries to WAL. ACKs
+	 * received meanwhile are covered by the next CONFIRM written by
+	 * the same fiber instead of writing a CONFIRM per ACK.
+	 */
+	bool is_confirm_in_progress;
 	/**
 	 * Latest terms received with PROMOTE entries from remote instances.
 	 * Limbo uses them to filter out the transactions coming not from the
@@ -0,0 +1,457 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2026, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#include "upsert_buffer.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "assoc.h"
+#include "box.h"
+#include "diag.h"
+#include "fiber.h"
+#include "fiber_cond.h"
+#include "index.h"
+#include "key_def.h"
+#include "msgpuck.h"
+#include "say.h"
+#include "small/region.h"
+#include "small/rlist.h"
+#include "space.h"
+#include "trivia/util.h"
+#include "tuple.h"
+#include "txn.h"
+#include "xrow.h"
+#include "xrow_update.h"
+
+enum {
+	/** Max number of operations in a buffered upsert. */
+	UPSERT_BUFFER_OPS_MAX = 8,
+	/** Max number of upserts executed in one transaction. */
+	UPSERT_BUFFER_BATCH_SIZE = 1000,
+};
+
+/** Increment of a tuple field. */
+struct upsert_buffer_op {
+	/** Zero-based field number. */
+	uint32_t fieldno;
+	/** Value added to the field. */
+	int64_t delta;
+};
+
+/** Upsert waiting to be executed, possibly merged from a few ones. */
+struct upsert_buffer_entry {
+	/** Link in upsert_buffer::queue. */
+	struct rlist in_queue;
+	/** Space id. */
+	uint32_t space_id;
+	/** Hash of the space id and the key. */
+	uint32_t hash;
+	/** Tuple inserted if there's no tuple with the same key. */
+	char *tuple;
+	/** Size of the tuple. */
+	uint32_t tuple_size;
+	/** Number of entries in ops. */
+	uint32_t op_count;
+	/** Increments applied if there's a tuple with the same key. */
+	struct upsert_buffer_op ops[UPSERT_BUFFER_OPS_MAX];
+	/** Size of the key. */
+	uint32_t key_size;
+	/** Primary key extracted from the tuple, without array header. */
+	char key[0];
+};
+
+/** Key of the upsert buffer hash table. */
+struct upsert_buffer_key {
+	uint32_t space_id;
+	uint32_t hash;
+	const char *key;
+	uint32_t key_size;
+};
+
+static inline bool
+upsert_buffer_key_equal(const struct upsert_buffer_key *key,
+			const struct upsert_buffer_entry *entry)
+{
+	return key->space_id == entry->space_id &&
+	       key->key_size == entry->key_size &&
+	       memcmp(key->key, entry->key, key->key_size) == 0;
+}
+
+#define mh_name _upsert_buffer
+#define mh_key_t struct upsert_buffer_key *
+#define mh_node_t struct upsert_buffer_entry *
+#define mh_arg_t int
+#define mh_hash(a, arg) ((*(a))->hash)
+#define mh_hash_key(a, arg) ((a)->hash)
+#define mh_cmp(a, b, arg) ((*(a)) != (*(b)))
+#define mh_cmp_key(a, b, arg) (!upsert_buffer_key_equal((a), *(b)))
+#define MH_SOURCE
+#include "salad/mhash.h"
+
+static struct {
+	/** Fiber that executes buffered upserts. */
+	struct fiber *fiber;
+	/** Signaled when the deadline moves closer. */
+	struct fiber_cond cond;
+	/** Buffered upserts by space id and key. */
+	struct mh_upsert_buffer_t *hash;
+	/** Buffered upserts in the order they were added. */
+	struct rlist queue;
+	/** Time when buffered upserts must be executed, fiber_clock(). */
+	double deadline;
+} upsert_buffer;
+
+/**
+ * Decodes upsert operations if they're all additions or subtractions of
+ * integers to distinct top-level fields that aren't indexed by the given
+ * primary key. Returns the number of decoded operations or -1 otherwise.
+ */
+static int
+upsert_buffer_decode_ops(const char *ops, int index_base,
+			 struct key_def *pk_def, struct upsert_buffer_op *out)
+{
+	uint32_t op_count = mp_decode_array(&ops);
+	if (op_count == 0 || op_count > UPSERT_BUFFER_OPS_MAX)
+		return -1;
+	for (uint32_t i = 0; i < op_count; i++) {
+		if (mp_typeof(*ops) != MP_ARRAY || mp_decode_array(&ops) != 3 ||
+		    mp_typeof(*ops) != MP_STR)
+			return -1;
+		uint32_t len;
+		const char *opcode = mp_decode_str(&ops, &len);
+		if (len != 1 || (*opcode != '+' && *opcode != '-'))
+			return -1;
+		if (mp_typeof(*ops) != MP_UINT)
+			return -1;
+		uint64_t fieldno = mp_decode_uint(&ops);
+		if (fieldno < (uint64_t)index_base ||
+		    fieldno - index_base >= UINT32_MAX)
+			return -1;
+		fieldno -= index_base;
+		if (key_def_find_by_fieldno(pk_def, fieldno) != NULL)
+			return -1;
+		int64_t delta;
+		if (mp_read_int64(&ops, &delta) != 0 || delta == INT64_MIN)
+			return -1;
+		out[i].fieldno = fieldno;
+		out[i].delta = *opcode == '+' ? delta : -delta;
+		for (uint32_t j = 0; j < i; j++) {
+			if (out[j].fieldno == out[i].fieldno)
+				return -1;
+		}
+	}
+	return op_count;
+}
+
+/**
+ * Adds increments to the ones of the entry and stores the result in @a out.
+ * Returns the number of resulting increments or -1 if there are too many
+ * of them or a sum overflows.
+ */
+static int
+upsert_buffer_entry_merge_ops(struct upsert_buffer_entry *entry,
+			      const struct upsert_buffer_op *ops,
+			      uint32_t op_count, struct upsert_buffer_op *out)
+{
+	uint32_t out_count = entry->op_count;
+	memcpy(out, entry->ops, out_count * sizeof(out[0]));
+	for (uint32_t i = 0; i < op_count; i++) {
+		uint32_t j;
+		for (j = 0; j < out_count; j++) {
+			if (out[j].fieldno == ops[i].fieldno)
+				break;
+		}
+		if (j == out_count) {
+			if (out_count == UPSERT_BUFFER_OPS_MAX)
+				return -1;
+			out[out_count++] = ops[i];
+			continue;
+		}
+		int64_t a = out[j].delta;
+		int64_t b = ops[i].delta;
+		if ((b > 0 && a > INT64_MAX - b) ||
+		    (b < 0 && a < INT64_MIN - b))
+			return -1;
+		out[j].delta = a + b;
+	}
+	return out_count;
+}
+
+/**
+ * Applies the operations of an upsert request to the buffered tuple.
+ * Returns false if they can't be applied or the result isn't valid,
+ * in which case the entry is left intact.
+ */
+static bool
+upsert_buffer_entry_merge_tuple(struct upsert_buffer_entry *entry,
+				struct space *space, struct request *request)
+{
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	uint32_t size;
+	const char *data = xrow_upsert_execute(
+		request->ops, request->ops_end, entry->tuple,
+		entry->tuple + entry->tuple_size, space->format, &size,
+		request->index_base, false, NULL);
+	if (data == NULL || tuple_validate_raw(space->format, data) != 0) {
+		diag_clear(diag_get());
+		region_truncate(region, region_svp);
+		return false;
+	}
+	if (size != entry->tuple_size)
+		entry->tuple = xrealloc(entry->tuple, size);
+	memcpy(entry->tuple, data, size);
+	entry->tuple_size = size;
+	region_truncate(region, region_svp);
+	return true;
+}
+
+/** Executes a buffered upsert in the current transaction, if any. */
+static int
+upsert_buffer_entry_execute(struct upsert_buffer_entry *entry)
+{
+	char ops[UPSERT_BUFFER_OPS_MAX * 32];
+	char *ops_end = mp_encode_array(ops, entry->op_count);
+	for (uint32_t i = 0; i < entry->op_count; i++) {
+		ops_end = mp_encode_array(ops_end, 3);
+		ops_end = mp_encode_str(ops_end, "+", 1);
+		ops_end = mp_encode_uint(ops_end, entry->ops[i].fieldno);
+		int64_t delta = entry->ops[i].delta;
+		if (delta >= 0)
+			ops_end = mp_encode_uint(ops_end, delta);
+		else
+			ops_end = mp_encode_int(ops_end, delta);
+	}
+	assert(ops_end <= ops + sizeof(ops));
+	return box_upsert(entry->space_id, 0, entry->tuple,
+			  entry->tuple + entry->tuple_size, ops, ops_end,
+			  0, NULL);
+}
+
+static void
+upsert_buffer_entry_delete(struct upsert_buffer_entry *entry)
+{
+	free(entry->tuple);
+	free(entry);
+}
+
+/** Removes an entry from the hash table and the queue. */
+static void
+upsert_buffer_detach(struct upsert_buffer_entry *entry)
+{
+	struct mh_upsert_buffer_t *h = upsert_buffer.hash;
+	mh_int_t i = mh_upsert_buffer_get(h, &entry, 0);
+	assert(i != mh_end(h));
+	mh_upsert_buffer_del(h, i, 0);
+	rlist_del_entry(entry, in_queue);
+}
+
+/**
+ * Executes an upsert removed from the buffer in the current transaction
+ * and deletes it. Errors are logged.
+ */
+static void
+upsert_buffer_entry_flush(struct upsert_buffer_entry *entry)
+{
+	if (upsert_buffer_entry_execute(entry) != 0) {
+		say_error("failed to execute buffered upsert to space %u: %s",
+			  entry->space_id,
+			  diag_last_error(diag_get())->errmsg);
+		diag_clear(diag_get());
+	}
+	upsert_buffer_entry_delete(entry);
+}
+
+/**
+ * Executes all buffered upserts, one transaction per batch. Upserts
+ * buffered while we wait for WAL are executed on the next call.
+ */
+static void
+upsert_buffer_flush(void)
+{
+	RLIST_HEAD(queue);
+	rlist_splice(&queue, &upsert_buffer.queue);
+	mh_upsert_buffer_clear(upsert_buffer.hash);
+	upsert_buffer.deadline = TIMEOUT_INFINITY;
+	while (!rlist_empty(&queue)) {
+		if (box_txn_begin() != 0)
+			goto fail;
+		for (int i = 0; i < UPSERT_BUFFER_BATCH_SIZE &&
+				!rlist_empty(&queue); i++) {
+			struct upsert_buffer_entry *entry = rlist_shift_entry(
+				&queue, struct upsert_buffer_entry, in_queue);
+			upsert_buffer_entry_flush(entry);
+		}
+		if (box_txn_commit() != 0)
+			goto fail;
+	}
+	return;
+fail:
+	say_error("failed to execute buffered upserts: %s",
+		  diag_last_error(diag_get())->errmsg);
+	diag_clear(diag_get());
+	box_txn_rollback();
+	struct upsert_buffer_entry *entry, *tmp;
+	rlist_foreach_entry_safe(entry, &queue, in_queue, tmp)
+		upsert_buffer_entry_delete(entry);
+}
+
+static int
+upsert_buffer_f(va_list ap)
+{
+	(void)ap;
+	while (!fiber_is_cancelled()) {
+		double timeout = upsert_buffer.deadline - fiber_clock();
+		if (timeout > 0) {
+			fiber_cond_wait_timeout(&upsert_buffer.cond, timeout);
+			continue;
+		}
+		upsert_buffer_flush();
+	}
+	return 0;
+}
+
+int
+upsert_buffer_process(struct space *space, struct request *request)
+{
+	assert(request->type == IPROTO_UPSERT);
+	assert(in_txn() == NULL);
+	assert(space->def->opts.upsert_window > 0);
+	if (access_check_space(space, PRIV_W) != 0)
+		return -1;
+	struct index *pk = index_find_unique(space, 0);
+	if (pk == NULL)
+		return -1;
+	struct key_def *pk_def = pk->def->key_def;
+	struct upsert_buffer_op ops[UPSERT_BUFFER_OPS_MAX];
+	int op_count = upsert_buffer_decode_ops(request->ops,
+						request->index_base,
+						pk_def, ops);
+	if (tuple_validate_raw(space->format, request->tuple) != 0)
+		return -1;
+
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	uint32_t key_size;
+	const char *key = tuple_extract_key_raw(request->tuple,
+						request->tuple_end, pk_def,
+						MULTIKEY_NONE, &key_size);
+	if (key == NULL)
+		return -1;
+	const char *key_end = key + key_size;
+	mp_decode_array(&key);
+	key_size = key_end - key;
+	uint32_t space_id = space->def->id;
+	struct upsert_buffer_key k = {
+		.space_id = space_id,
+		.hash = mh_strn_hash(key, key_size) ^ space_id,
+		.key = key,
+		.key_size = key_size,
+	};
+	struct mh_upsert_buffer_t *h = upsert_buffer.hash;
+	mh_int_t i = mh_upsert_buffer_find(h, &k, 0);
+	struct upsert_buffer_entry *entry = i != mh_end(h) ?
+		*mh_upsert_buffer_node(h, i) : NULL;
+	int rc = 0;
+	if (entry != NULL) {
+		struct upsert_buffer_op merged[UPSERT_BUFFER_OPS_MAX];
+		int merged_count = op_count < 0 ? -1 :
+			upsert_buffer_entry_merge_ops(entry, ops, op_count,
+						      merged);
+		if (merged_count > 0 &&
+		    upsert_buffer_entry_merge_tuple(entry, space, request)) {
+			memcpy(entry->ops, merged,
+			       merged_count * sizeof(merged[0]));
+			entry->op_count = merged_count;
+			goto out;
+		}
+		/*
+		 * Execute the buffered upsert before this one to keep
+		 * upserts to the key in order.
+		 */
+		upsert_buffer_detach(entry);
+		if (box_txn_begin() != 0) {
+			upsert_buffer_entry_delete(entry);
+			rc = -1;
+			goto out;
+		}
+		upsert_buffer_entry_flush(entry);
+		if (box_txn_commit() != 0) {
+			box_txn_rollback();
+			rc = -1;
+			goto out;
+		}
+		rc = 1;
+		goto out;
+	}
+	if (op_count < 0) {
+		rc = 1;
+		goto out;
+	}
+	entry = xmalloc(sizeof(*entry) + key_size);
+	entry->space_id = space_id;
+	entry->hash = k.hash;
+	entry->tuple_size = request->tuple_end - request->tuple;
+	entry->tuple = xmalloc(entry->tuple_size);
+	memcpy(entry->tuple, request->tuple, entry->tuple_size);
+	entry->op_count = op_count;
+	memcpy(entry->ops, ops, op_count * sizeof(ops[0]));
+	entry->key_size = key_size;
+	memcpy(entry->key, key, key_size);
+	mh_upsert_buffer_put(h, &entry, NULL, 0);
+	rlist_add_tail_entry(&upsert_buffer.queue, entry, in_queue);
+	double deadline = fiber_clock() + space->def->opts.upsert_window;
+	if (deadline < upsert_buffer.deadline) {
+		upsert_buffer.deadline = deadline;
+		fiber_cond_signal(&upsert_buffer.cond);
+	}
+out:
+	region_truncate(region, region_svp);
+	return rc;
+}
+
+void
+upsert_buffer_init(void)
+{
+	upsert_buffer.hash = mh_upsert_buffer_new();
+	rlist_create(&upsert_buffer.queue);
+	fiber_cond_create(&upsert_buffer.cond);
+	upsert_buffer.deadline = TIMEOUT_INFINITY;
+	upsert_buffer.fiber = fiber_new_system("upsert_buffer",
+					       upsert_buffer_f);
+	if (upsert_buffer.fiber == NULL)
+		panic("failed to start the upsert buffer fiber");
+	fiber_wakeup(upsert_buffer.fiber);
+}
+
+void
+upsert_buffer_shutdown(void)
+{
+	if (upsert_buffer.hash != NULL)
+		upsert_buffer_flush();
+}
+
+void
+upsert_buffer_free(void)
+{
+	if (upsert_buffer.fiber != NULL) {
+		fiber_cancel(upsert_buffer.fiber);
+		upsert_buffer.fiber = NULL;
+	}
+	if (upsert_buffer.hash == NULL)
+		return;
+	struct upsert_buffer_entry *entry, *tmp;
+	rlist_foreach_entry_safe(entry, &upsert_buffer.queue, in_queue, tmp)
+		upsert_buffer_entry_delete(entry);
+	rlist_create(&upsert_buffer.queue);
+	mh_upsert_buffer_delete(upsert_buffer.hash);
+	upsert_buffer.hash = NULL;
+	fiber_cond_destroy(&upsert_buffer.cond);
+}
@@ -0,0 +1,63 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2026, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#pragma once
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+struct space;
+struct request;
+
+/**
+ * Write-combining buffer for upserts.
+ *
+ * Counter workloads issue a lot of upserts that increment fields of a few
+ * hot tuples. Executed one by one, each of them costs a transaction, a
+ * tuple rebuild and a WAL row. A memtx space may opt in to combining such
+ * upserts with the upsert_window option.
+ *
+ * An upsert to such a space made outside a transaction is validated and
+ * then kept in memory instead of being executed, if all its operations
+ * add integers to top-level fields that aren't indexed by the primary
+ * key. Subsequent upserts of this kind to the same key are merged into
+ * the buffered one: the deltas are summed up and the operations are
+ * applied to the buffered tuple, which is inserted if the key turns out
+ * to be missing. A system fiber executes all buffered upserts as soon as
+ * the oldest of them has been waiting for upsert_window seconds, in one
+ * transaction per batch.
+ *
+ * The durability is thus relaxed: an acknowledged upsert may be lost on
+ * crash, reads don't see buffered upserts, and other writes to the space
+ * aren't ordered with them. Errors that happen when a buffered upsert is
+ * executed are logged like for vinyl upserts. An upsert that can't be
+ * merged is executed right away after the buffered upsert for its key,
+ * so upserts to a key are still applied in order.
+ */
+
+/** Starts the fiber that executes buffered upserts. */
+void
+upsert_buffer_init(void);
+
+/** Executes all buffered upserts. */
+void
+upsert_buffer_shutdown(void);
+
+/** Stops the fiber and drops all buffered upserts. */
+void
+upsert_buffer_free(void);
+
+/**
+ * Tries to buffer an UPSERT request to a space with the upsert_window
+ * option. Must be called outside a transaction. Returns 0 if the request
+ * was buffered, 1 if it must be executed as usual, -1 on error.
+ */
+int
+upsert_buffer_process(struct space *space, struct request *request);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
@@ -51,6 +51,36 @@ static struct user_map user_map_nil;
 
 struct mh_i32ptr_t *user_registry;
 
+/**
+ * Map: user name -> struct user. Contains both users and roles.
+ * Authentication looks up users by name on every request, so it's
+ * faster than a lookup in the _user space name index.
+ */
+static struct mh_strnptr_t *user_by_name;
+
+/** Add a user to the name map. */
+static void
+user_by_name_put(struct user *user)
+{
+	const char *name = user->def->name;
+	uint32_t len = strlen(name);
+	struct mh_strnptr_node_t node = {
+		name, len, mh_strn_hash(name, len), user
+	};
+	mh_strnptr_put(user_by_name, &node, NULL, NULL);
+}
+
+/** Remove a user from the name map. */
+static void
+user_by_name_del(struct user *user)
+{
+	const char *name = user->def->name;
+	mh_int_t k = mh_strnptr_find_str(user_by_name, name, strlen(name));
+	if (k != mh_end(user_by_name) &&
+	    mh_strnptr_node(user_by_name, k)->val == user)
+		mh_strnptr_del(user_by_name, k, NULL);
+}
+
 enum {
 	USER_ACCESS_FULL = (user_access_t)~0,
 };
@@ -558,9 +588,11 @@ user_cache_replace(struct user_def *def)
 		struct mh_i32ptr_node_t node = { def->uid, user };
 		mh_i32ptr_put(user_registry, &node, NULL, NULL);
 	} else {
+		user_by_name_del(user);
 		user_def_delete(user->def);
 	}
 	user->def = def;
+	user_by_name_put(user);
 	return user;
 }
 
@@ -575,6 +607,7 @@ user_cache_delete(uint32_t uid)
 		auth_token_put(user->auth_token);
 		assert(user_map_is_empty(&user->roles));
 		assert(user_map_is_empty(&user->users));
+		user_by_name_del(user);
 		user_destroy(user);
 		/*
 		 * Sic: we don't have to remove a deleted
@@ -616,12 +649,11 @@ user_find_by_token(uint8_t auth_token)
 struct user *
 user_find_by_name(const char *name, uint32_t len)
 {
-	uint32_t uid;
-	if (schema_find_id(BOX_USER_ID, 2, name, len, &uid) != 0)
-		return NULL;
-	if (uid != BOX_ID_NIL) {
-		struct user *user = user_by_id(uid);
-		if (user != NULL && user->def->type == SC_USER)
+	mh_int_t k = mh_strnptr_find_str(user_by_name, name, len);
+	if (k != mh_end(user_by_name)) {
+		struct user *user = (struct user *)
+			mh_strnptr_node(user_by_name, k)->val;
+		if (user->def->type == SC_USER)
 			return user;
 	}
 	diag_set(ClientError, ER_NO_SUCH_USER,
@@ -636,6 +668,7 @@ user_cache_init(void)
 	/** Mark all tokens as unused. */
 	memset(tokens, 0xFF, sizeof(tokens));
 	user_registry = mh_i32ptr_new();
+	user_by_name = mh_strnptr_new();
 	access_lua_call_registry = mh_strnptr_new();
 	/*
 	 * Solve a chicken-egg problem:
@@ -691,6 +724,10 @@ user_cache_free(void)
 		mh_i32ptr_delete(user_registry);
 		user_registry = NULL;
 	}
+	if (user_by_name != NULL) {
+		mh_strnptr_delete(user_by_name);
+		user_by_name = NULL;
+	}
 	if (access_lua_call_registry != NULL) {
 		struct mh_strnptr_t *h = access_lua_call_registry;
 		mh_int_t i;
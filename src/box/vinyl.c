@@ -130,6 +130,15 @@ struct vy_env {
 	double timeout;
 	/** Try to recover corrupted data if set. */
 	bool force_recovery;
+	/** Statistics of local recovery, see box.info.recovery(). */
+	struct {
+		/** Time spent loading the metadata log, in seconds. */
+		double vylog_time;
+		/** Time spent loading LSM trees from disk, in seconds. */
+		double lsm_time;
+		/** Number of LSM trees loaded from disk. */
+		int64_t lsm_count;
+	} recovery_stat;
 };
 
 /** Mask passed to vy_gc(). */
@@ -260,6 +269,7 @@ vy_info_append_regulator(struct vy_env *env, struct info_handler *h)
 	info_append_int(h, "write_rate", r->write_rate);
 	info_append_int(h, "dump_bandwidth", r->dump_bandwidth);
 	info_append_int(h, "dump_watermark", r->dump_watermark);
+	info_append_double(h, "time_to_throttle", r->time_to_throttle);
 	info_append_int(h, "rate_limit", vy_quota_get_rate_limit(r->quota,
 							VY_QUOTA_CONSUMER_TX));
 	info_append_int(h, "blocked_writers", r->quota->n_blocked);
@@ -303,6 +313,18 @@ vy_info_append_memory(struct vy_env *env, struct info_handler *h)
 	info_table_end(h); /* memory */
 }
 
+static void
+vy_info_append_page_cache(struct vy_env *env, struct info_handler *h)
+{
+	struct vy_page_cache *cache = &env->run_env.page_cache;
+	info_table_begin(h, "page_cache");
+	info_append_int(h, "memory", cache->mem_used);
+	info_append_int(h, "pages", cache->page_count);
+	info_append_int(h, "hit", cache->hit);
+	info_append_int(h, "miss", cache->miss);
+	info_table_end(h); /* page_cache */
+}
+
 static void
 vy_info_append_disk(struct vy_env *env, struct info_handler *h)
 {
@@ -322,11 +344,23 @@ vinyl_engine_stat(struct engine *engine, struct info_handler *h)
 	vy_info_append_tx(env, h);
 	vy_info_append_memory(env, h);
 	vy_info_append_disk(env, h);
+	vy_info_append_page_cache(env, h);
 	vy_info_append_scheduler(env, h);
 	vy_info_append_regulator(env, h);
 	info_end(h);
 }
 
+void
+vinyl_engine_recovery_stat(struct engine *engine, struct info_handler *h)
+{
+	struct vy_env *env = vy_env(engine);
+	info_table_begin(h, "vinyl");
+	info_append_double(h, "vylog_time", env->recovery_stat.vylog_time);
+	info_append_double(h, "lsm_time", env->recovery_stat.lsm_time);
+	info_append_int(h, "lsm_count", env->recovery_stat.lsm_count);
+	info_table_end(h);
+}
+
 static void
 vy_info_append_stmt_counter(struct info_handler *h, const char *name,
 			    const struct vy_stmt_counter *count)
@@ -523,6 +557,9 @@ vinyl_engine_reset_stat(struct engine *engine)
 	struct vy_tx_manager *xm = env->xm;
 	memset(&xm->stat, 0, sizeof(xm->stat));
 
+	env->run_env.page_cache.hit = 0;
+	env->run_env.page_cache.miss = 0;
+
 	vy_scheduler_reset_stat(&env->scheduler);
 	vy_regulator_reset_stat(&env->regulator);
 }
@@ -593,6 +630,14 @@ vinyl_engine_check_space_def(struct space_def *def)
 			 "engine does not support data-temporary spaces");
 		return -1;
 	}
+	if (def->opts.is_cache) {
+		diag_set(ClientError, ER_UNSUPPORTED, "Vinyl", "cache mode");
+		return -1;
+	}
+	if (def->opts.upsert_window > 0) {
+		diag_set(ClientError, ER_UNSUPPORTED, "Vinyl", "upsert_window");
+		return -1;
+	}
 	return 0;
 }
 
@@ -678,6 +723,12 @@ vinyl_space_check_index_def(struct space *space, struct index_def *index_def)
 			 "hint is only reasonable with memtx tree index");
 		return -1;
 	}
+	if (index_def->opts.hash_func != INDEX_HASH_FUNC_MURMUR) {
+		diag_set(ClientError, ER_MODIFY_INDEX, index_def->name,
+			 space_name(space),
+			 "hash_func is only reasonable with memtx hash index");
+		return -1;
+	}
 
 	struct key_def *key_def = index_def->key_def;
 
@@ -763,19 +814,23 @@ vinyl_index_open(struct index *index)
 			return -1;
 		break;
 	case VINYL_INITIAL_RECOVERY_LOCAL:
-	case VINYL_FINAL_RECOVERY_LOCAL:
+	case VINYL_FINAL_RECOVERY_LOCAL: {
 		/*
 		 * Local WAL replay or recovery from snapshot.
 		 * In either case the index directory should
 		 * have already been created, so try to load
 		 * the index files from it.
 		 */
+		double start = ev_monotonic_time();
 		if (vy_lsm_recover(lsm, env->recovery, &env->run_env,
 				   vclock_sum(env->recovery_vclock),
 				   env->status == VINYL_INITIAL_RECOVERY_LOCAL,
 				   env->force_recovery) != 0)
 			return -1;
+		env->recovery_stat.lsm_time += ev_monotonic_time() - start;
+		env->recovery_stat.lsm_count++;
 		break;
+	}
 	case VINYL_HOT_STANDBY:
 		/* See the comment to vinyl_engine_begin_hot_standby(). */
 		diag_set(ClientError, ER_UNSUPPORTED, "Vinyl",
@@ -967,6 +1022,12 @@ vinyl_index_def_change_requires_rebuild(struct index *index,
 	 */
 	if (old_cmp_def->part_count != new_cmp_def->part_count)
 		return true;
+	/*
+	 * Statements stored in memory have hints that depend on
+	 * the number of key parts packed in a hint.
+	 */
+	if (old_cmp_def->hint_part_count != new_cmp_def->hint_part_count)
+		return true;
 
 	for (uint32_t i = 0; i < new_cmp_def->part_count; i++) {
 		const struct key_part *old_part = &old_cmp_def->parts[i];
@@ -2808,6 +2869,20 @@ vinyl_engine_set_snap_io_rate_limit(struct engine *engine, double limit)
 	vy_regulator_reset_dump_bandwidth(&env->regulator, limit_in_bytes);
 }
 
+void
+vinyl_engine_set_page_cache(struct engine *engine, size_t quota)
+{
+	struct vy_env *env = vy_env(engine);
+	vy_run_env_set_page_cache_quota(&env->run_env, quota);
+}
+
+void
+vinyl_engine_set_compression_dict(struct engine *engine, bool enable)
+{
+	struct vy_env *env = vy_env(engine);
+	env->run_env.use_compression_dict = enable;
+}
+
 /** }}} Environment */
 
 /* {{{ Checkpoint */
@@ -2903,10 +2978,12 @@ vinyl_engine_begin_initial_recovery(struct engine *engine,
 	assert(e->status == VINYL_OFFLINE);
 	if (recovery_vclock != NULL) {
 		e->recovery_vclock = recovery_vclock;
+		double start = ev_monotonic_time();
 		e->recovery = vy_log_begin_recovery(recovery_vclock,
 						    e->force_recovery);
 		if (e->recovery == NULL)
 			return -1;
+		e->recovery_stat.vylog_time = ev_monotonic_time() - start;
 		/*
 		 * We can't schedule any background tasks until
 		 * local recovery is complete, because they would
@@ -3704,6 +3781,53 @@ vinyl_iterator_primary_next(struct iterator *base, struct tuple **ret)
 	return -1;
 }
 
+/**
+ * Return true if a secondary index iterator may return tuples read
+ * from the secondary index without looking them up in the primary
+ * index. This is possible if the caller only needs the fields indexed
+ * by the secondary index and the secondary index can't contain stale
+ * tuples, i.e. DELETE statements aren't deferred.
+ */
+static bool
+vinyl_iterator_is_covering(struct vinyl_iterator *it)
+{
+	if (!it->base.is_covering)
+		return false;
+	struct vy_lsm *lsm = it->iterator.lsm;
+	if (lsm->cmp_def->has_json_paths || lsm->cmp_def->is_multikey)
+		return false;
+	struct space *space = space_by_id(lsm->space_id);
+	return space != NULL && !space->def->opts.defer_deletes;
+}
+
+/**
+ * Get a tuple by a tuple read from a secondary index without
+ * looking it up in the primary index, see vinyl_iterator_is_covering().
+ * A key read from disk is converted to a tuple that has all fields
+ * not indexed by the secondary index set to NULL. A tuple read from
+ * memory or cache is returned as is: its unindexed fields may be
+ * outdated, because an UPDATE that doesn't touch the secondary index
+ * isn't written to it.
+ */
+static int
+vy_get_covering_tuple(struct vy_lsm *lsm, struct vy_entry entry,
+		      struct vy_entry *result)
+{
+	assert(lsm->index_id > 0);
+	if (!vy_stmt_is_key(entry.stmt)) {
+		tuple_ref(entry.stmt);
+		*result = entry;
+		return 0;
+	}
+	struct tuple *stmt = vy_stmt_new_surrogate_replace(
+		lsm->mem_format, entry.stmt, lsm->cmp_def);
+	if (stmt == NULL)
+		return -1;
+	result->stmt = stmt;
+	result->hint = vy_stmt_hint(stmt, lsm->cmp_def);
+	return 0;
+}
+
 static int
 vinyl_iterator_secondary_next(struct iterator *base, struct tuple **ret)
 {
@@ -3735,13 +3859,19 @@ vinyl_iterator_secondary_next(struct iterator *base, struct tuple **ret)
 		*ret = NULL;
 		goto out;
 	}
-	ERROR_INJECT_YIELD(ERRINJ_VY_DELAY_PK_LOOKUP);
-	/* Get the full tuple from the primary index. */
-	if (vy_get_by_secondary_tuple(lsm, it->tx, vy_tx_read_view(it->tx),
-				      partial, &entry) != 0)
-		goto fail;
-	if (entry.stmt == NULL)
-		goto next;
+	if (vinyl_iterator_is_covering(it)) {
+		if (vy_get_covering_tuple(lsm, partial, &entry) != 0)
+			goto fail;
+	} else {
+		ERROR_INJECT_YIELD(ERRINJ_VY_DELAY_PK_LOOKUP);
+		/* Get the full tuple from the primary index. */
+		if (vy_get_by_secondary_tuple(lsm, it->tx,
+					      vy_tx_read_view(it->tx),
+					      partial, &entry) != 0)
+			goto fail;
+		if (entry.stmt == NULL)
+			goto next;
+	}
 	vy_read_iterator_cache_add(&it->iterator, entry);
 	vinyl_iterator_account_read(it, start_time, entry.stmt);
 	vinyl_iterator_update_pos(it, entry);
@@ -3912,6 +4042,125 @@ vinyl_index_get(struct index *index, const char *key,
 	return 0;
 }
 
+/**
+ * Max number of fibers looking up keys passed to index.prefetch().
+ * Each fiber blocks on one disk read at a time so this is how many
+ * reads a batch may have in flight in the reader threads.
+ */
+enum { VY_PREFETCH_FIBERS_MAX = 16 };
+
+/** Keys looked up by the fibers started by vinyl_index_prefetch(). */
+struct vy_prefetch {
+	/** LSM tree to look up the keys in. */
+	struct vy_lsm *lsm;
+	/** Read view to look up the keys in. */
+	const struct vy_read_view **rv;
+	/** Keys to look up, each is a MsgPack array. */
+	const char **keys;
+	/** Number of keys in the array. */
+	uint32_t key_count;
+	/** Index of the next key to look up. */
+	uint32_t next_key;
+};
+
+/**
+ * Look up keys from the prefetch batch until there's none left.
+ * A looked up statement is added to the cache by vy_get() so the
+ * following index.get() for the same key doesn't hit the disk.
+ */
+static void
+vy_prefetch_run(struct vy_prefetch *prefetch)
+{
+	while (prefetch->next_key < prefetch->key_count &&
+	       !fiber_is_cancelled()) {
+		const char *key = prefetch->keys[prefetch->next_key++];
+		uint32_t part_count = mp_decode_array(&key);
+		struct tuple *result;
+		if (vy_get_by_raw_key(prefetch->lsm, NULL, prefetch->rv,
+				      key, part_count, &result) != 0) {
+			/* The error will be reported by index.get(). */
+			diag_clear(diag_get());
+			continue;
+		}
+		if (result != NULL)
+			tuple_unref(result);
+	}
+}
+
+static int
+vy_prefetch_f(va_list ap)
+{
+	struct vy_prefetch *prefetch = va_arg(ap, struct vy_prefetch *);
+	vy_prefetch_run(prefetch);
+	return 0;
+}
+
+static void
+vinyl_index_prefetch(struct index *index, const char *keys,
+		     uint32_t key_count)
+{
+	struct vy_lsm *lsm = vy_lsm(index);
+	struct vy_env *env = vy_env(index->engine);
+	if (!index->def->opts.is_unique || key_count < 2)
+		return;
+	struct key_def *key_def = index->def->key_def;
+	size_t region_svp = region_used(&fiber()->gc);
+	struct vy_prefetch prefetch;
+	prefetch.lsm = lsm;
+	prefetch.rv = &env->xm->p_global_read_view;
+	prefetch.keys = xregion_alloc_array(&fiber()->gc, const char *,
+					    key_count);
+	prefetch.key_count = 0;
+	prefetch.next_key = 0;
+	for (uint32_t i = 0; i < key_count; i++) {
+		const char *key = keys;
+		mp_next(&keys);
+		if (mp_typeof(*key) != MP_ARRAY)
+			continue;
+		const char *parts = key;
+		uint32_t part_count = mp_decode_array(&parts);
+		if (part_count != key_def->part_count ||
+		    exact_key_validate(key_def, parts, part_count) != 0) {
+			diag_clear(diag_get());
+			continue;
+		}
+		prefetch.keys[prefetch.key_count++] = key;
+	}
+	/*
+	 * The calling fiber looks up keys, too, so start one fiber
+	 * less than the number of lookups we want in flight.
+	 */
+	uint32_t fiber_count = MIN(prefetch.key_count,
+				   (uint32_t)VY_PREFETCH_FIBERS_MAX);
+	fiber_count = fiber_count > 0 ? fiber_count - 1 : 0;
+	struct fiber **fibers = xregion_alloc_array(&fiber()->gc,
+						    struct fiber *,
+						    MAX(fiber_count, 1));
+	/*
+	 * Make sure the LSM tree isn't deleted while we are
+	 * reading from it.
+	 */
+	vy_lsm_ref(lsm);
+	uint32_t started = 0;
+	for (; started < fiber_count; started++) {
+		struct fiber *f = fiber_new_system("vinyl.prefetch",
+						   vy_prefetch_f);
+		if (f == NULL) {
+			/* Fall back on fewer fibers. */
+			diag_clear(diag_get());
+			break;
+		}
+		fiber_set_joinable(f, true);
+		fiber_start(f, &prefetch);
+		fibers[started] = f;
+	}
+	vy_prefetch_run(&prefetch);
+	for (uint32_t i = 0; i < started; i++)
+		fiber_join(fibers[i]);
+	vy_lsm_unref(lsm);
+	region_truncate(&fiber()->gc, region_svp);
+}
+
 /*** }}} Cursor */
 
 /* {{{ Index build */
@@ -4669,6 +4918,8 @@ static const struct space_vtab vinyl_space_vtab = {
 	/* .ephemeral_replace = */ generic_space_ephemeral_replace,
 	/* .ephemeral_delete = */ generic_space_ephemeral_delete,
 	/* .ephemeral_rowid_next = */ generic_space_ephemeral_rowid_next,
+	/* .ephemeral_begin_build = */ generic_space_ephemeral_begin_build,
+	/* .ephemeral_end_build = */ generic_space_ephemeral_end_build,
 	/* .init_system_space = */ generic_init_system_space,
 	/* .init_ephemeral_space = */ generic_init_ephemeral_space,
 	/* .check_index_def = */ vinyl_space_check_index_def,
@@ -4702,6 +4953,7 @@ static const struct index_vtab vinyl_index_vtab = {
 	/* .count = */ generic_index_count,
 	/* .get_internal = */ generic_index_get_internal,
 	/* .get = */ vinyl_index_get,
+	/* .prefetch = */ vinyl_index_prefetch,
 	/* .replace = */ generic_index_replace,
 	/* .create_iterator = */ vinyl_index_create_iterator,
 	/* .create_read_view = */ generic_index_create_read_view,
@@ -4711,5 +4963,6 @@ static const struct index_vtab vinyl_index_vtab = {
 	/* .begin_build = */ generic_index_begin_build,
 	/* .reserve = */ generic_index_reserve,
 	/* .build_next = */ generic_index_build_next,
+	/* .build_next_batch = */ generic_index_build_next_batch,
 	/* .end_build = */ generic_index_end_build,
 };
@@ -51,6 +51,12 @@ vinyl_engine_new(const char *dir, size_t memory,
 void
 vinyl_engine_stat(struct engine *engine, struct info_handler *handler);
 
+/**
+ * Vinyl local recovery statistics (box.info.recovery().vinyl).
+ */
+void
+vinyl_engine_recovery_stat(struct engine *engine, struct info_handler *h);
+
 /**
  * Update vinyl cache size.
  */
@@ -88,6 +94,19 @@ vinyl_engine_set_too_long_threshold(struct engine *engine,
 void
 vinyl_engine_set_snap_io_rate_limit(struct engine *engine, double limit);
 
+/**
+ * Update the max size of memory used for caching decompressed
+ * run pages.
+ */
+void
+vinyl_engine_set_page_cache(struct engine *engine, size_t quota);
+
+/**
+ * Enable or disable zstd dictionaries for compressing runs.
+ */
+void
+vinyl_engine_set_compression_dict(struct engine *engine, bool enable);
+
 #ifdef __cplusplus
 } /* extern "C" */
 
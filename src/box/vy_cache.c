@@ -47,6 +47,12 @@ enum {
 	/* Flag in cache node that means that there are no values in DB
 	 * that greater than the current and less than the previous */
 	VY_CACHE_RIGHT_LINKED = 2,
+	/* Flag in cache node that means that the node has been read
+	 * since it was added and so is linked in the hot LRU list */
+	VY_CACHE_HOT = 4,
+	/* Max share of the quota that may be occupied by hot nodes,
+	 * in percents, see vy_cache_env::cache_hot_lru */
+	VY_CACHE_HOT_QUOTA_PERCENT = 75,
 	/* Max number of deletes that are made by cleanup action per one
 	 * cache operation */
 	VY_CACHE_CLEANUP_MAX_STEPS = 10,
@@ -56,7 +62,9 @@ void
 vy_cache_env_create(struct vy_cache_env *e, struct slab_cache *slab_cache)
 {
 	rlist_create(&e->cache_lru);
+	rlist_create(&e->cache_hot_lru);
 	e->mem_used = 0;
+	e->hot_mem_used = 0;
 	e->mem_quota = 0;
 	mempool_create(&e->cache_node_mempool, slab_cache,
 		       sizeof(struct vy_cache_node));
@@ -117,12 +125,30 @@ vy_cache_node_delete(struct vy_cache_env *env, struct vy_cache_node *node)
 				     node->entry.stmt);
 	assert(env->mem_used >= vy_cache_node_size(node));
 	env->mem_used -= vy_cache_node_size(node);
+	if (node->flags & VY_CACHE_HOT) {
+		assert(env->hot_mem_used >= vy_cache_node_size(node));
+		env->hot_mem_used -= vy_cache_node_size(node);
+	}
 	tuple_unref(node->entry.stmt);
 	rlist_del(&node->in_lru);
 	TRASH(node);
 	mempool_free(&env->cache_node_mempool, node);
 }
 
+/**
+ * Account a read of a cache node: move it to the head of the hot
+ * LRU list.
+ */
+static void
+vy_cache_node_touch(struct vy_cache_env *env, struct vy_cache_node *node)
+{
+	if (!(node->flags & VY_CACHE_HOT)) {
+		node->flags |= VY_CACHE_HOT;
+		env->hot_mem_used += vy_cache_node_size(node);
+	}
+	rlist_move(&env->cache_hot_lru, &node->in_lru);
+}
+
 static void *
 vy_cache_tree_page_alloc(void *ctx)
 {
@@ -175,7 +201,14 @@ vy_cache_destroy(struct vy_cache *cache)
 static void
 vy_cache_gc_step(struct vy_cache_env *env)
 {
+	/*
+	 * Evict nodes that haven't been read since they were added
+	 * first unless hot nodes take more than their share.
+	 */
 	struct rlist *lru = &env->cache_lru;
+	if (rlist_empty(lru) || env->hot_mem_used >
+	    env->mem_quota / 100 * VY_CACHE_HOT_QUOTA_PERCENT)
+		lru = &env->cache_hot_lru;
 	struct vy_cache_node *node =
 		rlist_last_entry(lru, struct vy_cache_node, in_lru);
 	struct vy_cache *cache = node->cache;
@@ -431,6 +464,7 @@ vy_cache_get(struct vy_cache *cache, struct vy_entry key)
 		vy_cache_tree_find(&cache->cache_tree, key);
 	if (node == NULL)
 		return vy_entry_none();
+	vy_cache_node_touch(cache->env, *node);
 	return (*node)->entry;
 }
 
@@ -623,6 +657,22 @@ vy_cache_iterator_step(struct vy_cache_iterator *itr)
 	return vy_cache_iterator_is_stop(itr, node);
 }
 
+/**
+ * Account a read of the cache node at the current iterator position,
+ * see vy_cache_node_touch().
+ */
+static void
+vy_cache_iterator_touch(struct vy_cache_iterator *itr)
+{
+	struct vy_cache_tree *tree = &itr->cache->cache_tree;
+	if (vy_cache_tree_iterator_is_invalid(&itr->curr_pos))
+		return;
+	struct vy_cache_node *node =
+		*vy_cache_tree_iterator_get_elem(tree, &itr->curr_pos);
+	if (node->entry.stmt == itr->curr.stmt)
+		vy_cache_node_touch(itr->cache->env, node);
+}
+
 /**
  * Return true if the given statement is visible from the iterator
  * read view.
@@ -739,6 +789,7 @@ vy_cache_iterator_next(struct vy_cache_iterator *itr,
 	if (itr->curr.stmt != NULL) {
 		vy_stmt_counter_acct_tuple(&itr->cache->stat.get,
 					   itr->curr.stmt);
+		vy_cache_iterator_touch(itr);
 		return vy_history_append_stmt(history, itr->curr);
 	}
 	return 0;
@@ -770,6 +821,7 @@ vy_cache_iterator_skip(struct vy_cache_iterator *itr, struct vy_entry last,
 	if (itr->curr.stmt != NULL) {
 		vy_stmt_counter_acct_tuple(&itr->cache->stat.get,
 					   itr->curr.stmt);
+		vy_cache_iterator_touch(itr);
 		return vy_history_append_stmt(history, itr->curr);
 	}
 	return 0;
@@ -849,6 +901,7 @@ vy_cache_iterator_restore(struct vy_cache_iterator *itr, struct vy_entry last,
 	if (itr->curr.stmt != NULL) {
 		vy_stmt_counter_acct_tuple(&itr->cache->stat.get,
 					   itr->curr.stmt);
+		vy_cache_iterator_touch(itr);
 		if (vy_history_append_stmt(history, itr->curr) != 0)
 			return -1;
 	}
@@ -115,8 +115,22 @@ vy_cache_tree_key_cmp(struct vy_cache_node *a, struct vy_entry b,
  * Environment of the cache
  */
 struct vy_cache_env {
-	/** Common LRU list of read cache. The first element is the newest */
+	/**
+	 * Common LRU list of cache nodes that haven't been read since
+	 * they were added to the cache. The first element is the newest.
+	 */
 	struct rlist cache_lru;
+	/**
+	 * Common LRU list of cache nodes that have been read at least
+	 * once. The first element is the most recently read. Nodes are
+	 * evicted from this list only if it takes more than its share
+	 * of the quota (see VY_CACHE_HOT_QUOTA_PERCENT) so that a scan
+	 * that adds a lot of nodes that are never read again (e.g. an
+	 * analytical query) can't evict the working set.
+	 */
+	struct rlist cache_hot_lru;
+	/** Size of memory occupied by nodes in the hot list. */
+	size_t hot_mem_used;
 	/** Common mempool for vy_cache_node struct */
 	struct mempool cache_node_mempool;
 	/** Size of memory occupied by cached tuples */
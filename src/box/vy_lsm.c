@@ -463,6 +463,182 @@ vy_lsm_recover_range(struct vy_lsm *lsm,
 	return range;
 }
 
+enum {
+	/** Max number of threads loading run files of an LSM tree. */
+	VY_LSM_RECOVER_THREADS_MAX = 8,
+	/** Min number of runs worth loading by a separate thread. */
+	VY_LSM_RECOVER_RUNS_PER_THREAD = 8,
+};
+
+/** Thread loading index files of a subset of runs of an LSM tree. */
+struct vy_lsm_run_loader {
+	/** Thread. */
+	struct cord cord;
+	/** LSM tree the runs belong to. */
+	struct vy_lsm *lsm;
+	/** Runs to load. */
+	struct vy_run **runs;
+	/** Set for each run that failed to load. */
+	bool *is_failed;
+	/** Range of runs loaded by this thread. */
+	int begin, end;
+	/** Set if failed runs should be skipped rather than fail the load. */
+	bool force_recovery;
+};
+
+static int
+vy_lsm_run_loader_f(va_list ap)
+{
+	struct vy_lsm_run_loader *loader =
+		va_arg(ap, struct vy_lsm_run_loader *);
+	struct vy_lsm *lsm = loader->lsm;
+	for (int i = loader->begin; i < loader->end; i++) {
+		if (vy_run_recover(loader->runs[i], lsm->env->path,
+				   lsm->space_id, lsm->index_id,
+				   lsm->cmp_def) == 0)
+			continue;
+		if (!loader->force_recovery)
+			return -1;
+		loader->is_failed[i] = true;
+	}
+	return 0;
+}
+
+static int
+vy_run_recovery_info_cmp(const void *a, const void *b)
+{
+	const struct vy_run_recovery_info *run_a =
+		*(const struct vy_run_recovery_info **)a;
+	const struct vy_run_recovery_info *run_b =
+		*(const struct vy_run_recovery_info **)b;
+	return run_a->id < run_b->id ? -1 : run_a->id > run_b->id;
+}
+
+/**
+ * Loads the index files of all runs referenced by slices of the given
+ * LSM tree in parallel threads, then adds the runs to the LSM tree the
+ * same way vy_lsm_recover_run() does, so that the following recovery of
+ * ranges finds them already loaded. Does nothing if there are too few
+ * runs to bother. Page indexes, bloom filters and keys are allocated
+ * with malloc() so they may be decoded outside the tx thread. The tx
+ * thread is blocked while the threads work, as on sequential recovery.
+ */
+static int
+vy_lsm_recover_runs(struct vy_lsm *lsm, struct vy_lsm_recovery_info *lsm_info,
+		    struct vy_run_env *run_env, bool force_recovery)
+{
+	int count = 0, capacity = 0;
+	struct vy_run_recovery_info **infos = NULL;
+	struct vy_range_recovery_info *range_info;
+	rlist_foreach_entry(range_info, &lsm_info->ranges, in_lsm) {
+		struct vy_slice_recovery_info *slice_info;
+		rlist_foreach_entry(slice_info, &range_info->slices, in_range) {
+			struct vy_run_recovery_info *run_info = slice_info->run;
+			if (run_info->data != NULL || run_info->is_dropped ||
+			    run_info->is_incomplete)
+				continue;
+			if (count == capacity) {
+				capacity = MAX(capacity * 2, 16);
+				infos = xrealloc(infos,
+						 capacity * sizeof(*infos));
+			}
+			infos[count++] = run_info;
+		}
+	}
+	/* A run may be referenced by several slices. */
+	qsort(infos, count, sizeof(*infos), vy_run_recovery_info_cmp);
+	int unique_count = 0;
+	for (int i = 0; i < count; i++) {
+		if (unique_count == 0 || infos[unique_count - 1] != infos[i])
+			infos[unique_count++] = infos[i];
+	}
+	count = unique_count;
+	int thread_count = MIN(count / VY_LSM_RECOVER_RUNS_PER_THREAD,
+			       VY_LSM_RECOVER_THREADS_MAX);
+	if (thread_count < 2) {
+		free(infos);
+		return 0;
+	}
+
+	int rc = 0;
+	struct vy_run **runs = xcalloc(count, sizeof(*runs));
+	bool *is_failed = xcalloc(count, sizeof(*is_failed));
+	struct vy_lsm_run_loader *loaders =
+		xcalloc(thread_count, sizeof(*loaders));
+	int part_size = DIV_ROUND_UP(count, thread_count);
+	int started = 0;
+	/* Keep the first error. */
+	struct diag diag;
+	diag_create(&diag);
+	for (int i = 0; i < count; i++) {
+		runs[i] = vy_run_new(run_env, infos[i]->id);
+		if (runs[i] == NULL) {
+			rc = -1;
+			goto out;
+		}
+		runs[i]->dump_lsn = infos[i]->dump_lsn;
+		runs[i]->dump_count = infos[i]->dump_count;
+	}
+
+	for (; started < thread_count; started++) {
+		struct vy_lsm_run_loader *loader = &loaders[started];
+		loader->lsm = lsm;
+		loader->runs = runs;
+		loader->is_failed = is_failed;
+		loader->begin = MIN(count, started * part_size);
+		loader->end = MIN(count, loader->begin + part_size);
+		loader->force_recovery = force_recovery;
+		char name[FIBER_NAME_MAX];
+		snprintf(name, sizeof(name), "vinyl.load.%d", started);
+		if (cord_costart(&loader->cord, name, vy_lsm_run_loader_f,
+				 loader) != 0) {
+			rc = -1;
+			break;
+		}
+	}
+	if (rc != 0)
+		diag_move(diag_get(), &diag);
+	for (int i = 0; i < started; i++) {
+		if (cord_join(&loaders[i].cord) != 0) {
+			rc = -1;
+			if (diag_is_empty(&diag))
+				diag_move(diag_get(), &diag);
+			else
+				diag_clear(diag_get());
+		}
+	}
+	if (rc != 0) {
+		diag_move(&diag, diag_get());
+		goto out;
+	}
+	for (int i = 0; i < count; i++) {
+		struct vy_run *run = runs[i];
+		if (is_failed[i] &&
+		    vy_run_rebuild_index(run, lsm->env->path,
+					 lsm->space_id, lsm->index_id,
+					 lsm->cmp_def, lsm->key_def,
+					 lsm->disk_format, &lsm->opts) != 0) {
+			rc = -1;
+			goto out;
+		}
+		/* See vy_lsm_recover_run(). */
+		vy_lsm_add_run(lsm, run);
+		infos[i]->data = run;
+		runs[i] = NULL;
+	}
+out:
+	diag_destroy(&diag);
+	for (int i = 0; i < count; i++) {
+		if (runs[i] != NULL)
+			vy_run_unref(runs[i]);
+	}
+	free(loaders);
+	free(is_failed);
+	free(runs);
+	free(infos);
+	return rc;
+}
+
 int
 vy_lsm_recover(struct vy_lsm *lsm, struct vy_recovery *recovery,
 		 struct vy_run_env *run_env, int64_t lsn,
@@ -570,14 +746,14 @@ vy_lsm_recover(struct vy_lsm *lsm, struct vy_recovery *recovery,
 	 */
 	lsm->dump_lsn = lsm_info->dump_lsn;
 
-	int rc = 0;
+	int rc = vy_lsm_recover_runs(lsm, lsm_info, run_env, force_recovery);
 	struct vy_range_recovery_info *range_info;
 	rlist_foreach_entry(range_info, &lsm_info->ranges, in_lsm) {
+		if (rc != 0)
+			break;
 		if (vy_lsm_recover_range(lsm, range_info, run_env,
-					 force_recovery) == NULL) {
+					 force_recovery) == NULL)
 			rc = -1;
-			break;
-		}
 	}
 
 	/*
@@ -1039,32 +1215,37 @@ vy_lsm_find_range_intersection(struct vy_lsm *lsm,
 	return 0;
 }
 
-bool
-vy_lsm_split_range(struct vy_lsm *lsm, struct vy_range *range)
+/**
+ * Split a range in @split_key_count + 1 parts by the given keys,
+ * which must be sorted in ascending order and lie strictly inside
+ * the range. Return true on success.
+ */
+static bool
+vy_lsm_split_range_by_keys(struct vy_lsm *lsm, struct vy_range *range,
+			   const char **split_keys_raw, int split_key_count)
 {
-	struct tuple_format *key_format = lsm->env->key_format;
+	assert(split_key_count > 0);
+	assert(split_key_count < VY_RANGE_SUBCOMPACTION_PARTS_MAX);
 
-	const char *split_key_raw;
-	if (!vy_range_needs_split(range, vy_lsm_range_size(lsm),
-				  &split_key_raw))
-		return false;
+	struct tuple_format *key_format = lsm->env->key_format;
 
-	/* Split a range in two parts. */
-	const int n_parts = 2;
-	struct vy_range *parts[2] = { NULL, NULL };
+	int n_parts = split_key_count + 1;
+	struct vy_range *parts[VY_RANGE_SUBCOMPACTION_PARTS_MAX];
+	memset(parts, 0, sizeof(parts));
 	/*
 	 * Determine new ranges' boundaries.
 	 */
-	struct vy_entry split_key;
-	split_key = vy_entry_key_from_msgpack(key_format, lsm->cmp_def,
-					      split_key_raw);
-	if (split_key.stmt == NULL)
-		goto fail;
-
-	struct vy_entry keys[3];
+	struct vy_entry keys[VY_RANGE_SUBCOMPACTION_PARTS_MAX + 1];
+	memset(keys, 0, sizeof(keys));
 	keys[0] = range->begin;
-	keys[1] = split_key;
-	keys[2] = range->end;
+	keys[n_parts] = range->end;
+	for (int i = 0; i < split_key_count; i++) {
+		keys[i + 1] = vy_entry_key_from_msgpack(key_format,
+							lsm->cmp_def,
+							split_keys_raw[i]);
+		if (keys[i + 1].stmt == NULL)
+			goto fail;
+	}
 
 	/*
 	 * Allocate new ranges and create slices of
@@ -1129,21 +1310,26 @@ vy_lsm_split_range(struct vy_lsm *lsm, struct vy_range *range)
 	}
 	lsm->range_tree_version++;
 
-	say_info("%s: split range %s by key %s", vy_lsm_name(lsm),
-		 vy_range_str(range), tuple_str(split_key.stmt));
+	for (int i = 1; i < n_parts; i++) {
+		say_info("%s: split range %s by key %s", vy_lsm_name(lsm),
+			 vy_range_str(range), tuple_str(keys[i].stmt));
+	}
 
 	rlist_foreach_entry(slice, &range->slices, in_range)
 		vy_slice_wait_pinned(slice);
 	vy_range_delete(range);
-	tuple_unref(split_key.stmt);
+	for (int i = 1; i < n_parts; i++)
+		tuple_unref(keys[i].stmt);
 	return true;
 fail:
 	for (int i = 0; i < n_parts; i++) {
 		if (parts[i] != NULL)
 			vy_range_delete(parts[i]);
 	}
-	if (split_key.stmt != NULL)
-		tuple_unref(split_key.stmt);
+	for (int i = 1; i < n_parts; i++) {
+		if (keys[i].stmt != NULL)
+			tuple_unref(keys[i].stmt);
+	}
 
 	diag_log();
 	say_error("%s: failed to split range %s",
@@ -1151,6 +1337,32 @@ vy_lsm_split_range(struct vy_lsm *lsm, struct vy_range *range)
 	return false;
 }
 
+bool
+vy_lsm_split_range(struct vy_lsm *lsm, struct vy_range *range)
+{
+	const char *split_key_raw;
+	if (!vy_range_needs_split(range, vy_lsm_range_size(lsm),
+				  &split_key_raw))
+		return false;
+	/* Split a range in two parts. */
+	return vy_lsm_split_range_by_keys(lsm, range, &split_key_raw, 1);
+}
+
+bool
+vy_lsm_split_range_for_compaction(struct vy_lsm *lsm, struct vy_range *range,
+				  int max_parts)
+{
+	const char *split_keys_raw[VY_RANGE_SUBCOMPACTION_PARTS_MAX];
+	max_parts = MIN(max_parts, (int)VY_RANGE_SUBCOMPACTION_PARTS_MAX);
+	int n_parts = vy_range_needs_subcompaction(range,
+						   vy_lsm_range_size(lsm),
+						   max_parts, split_keys_raw);
+	if (n_parts == 0)
+		return false;
+	return vy_lsm_split_range_by_keys(lsm, range, split_keys_raw,
+					  n_parts - 1);
+}
+
 bool
 vy_lsm_coalesce_range(struct vy_lsm *lsm, struct vy_range *range)
 {
@@ -586,6 +586,17 @@ vy_lsm_find_range_intersection(struct vy_lsm *lsm,
 bool
 vy_lsm_split_range(struct vy_lsm *lsm, struct vy_range *range);
 
+/**
+ * Split a range that is about to be compacted in up to @max_parts
+ * parts of approximately equal size if compacting it in one go is
+ * going to take long, return true if the range was split. The parts
+ * can then be compacted by different worker threads in parallel.
+ * Like vy_lsm_split_range(), this is a metadata-only operation.
+ */
+bool
+vy_lsm_split_range_for_compaction(struct vy_lsm *lsm, struct vy_range *range,
+				  int max_parts);
+
 /**
  * Coalesce a range with one or more its neighbors if it is too small,
  * return true if the range was coalesced. We coalesce ranges by
@@ -515,6 +515,77 @@ vy_range_needs_split(struct vy_range *range, int64_t range_size,
 	return true;
 }
 
+/**
+ * We only split a range for compaction if compacting it is going to
+ * take long, i.e. the compaction input is at least as big as the
+ * target range size, and there are idle workers to compact the parts.
+ *
+ * The size of each part is estimated by the size of the oldest run,
+ * like in vy_range_needs_split(), and must be greater than a third of
+ * the target range size. Two such parts are too big to be coalesced
+ * by vy_range_needs_coalesce() so the split doesn't oscillate.
+ */
+int
+vy_range_needs_subcompaction(struct vy_range *range, int64_t range_size,
+			     int max_parts, const char **split_keys)
+{
+	assert(max_parts <= VY_RANGE_SUBCOMPACTION_PARTS_MAX);
+
+	/* The range hasn't been merged yet - too early to split it. */
+	if (range->n_compactions < 1 || max_parts < 2)
+		return 0;
+
+	struct vy_slice *slice;
+	int64_t input_size = 0;
+	int n = range->compaction_priority;
+	rlist_foreach_entry(slice, &range->slices, in_range) {
+		input_size += slice->count.bytes;
+		if (--n == 0)
+			break;
+	}
+	/* Compaction of the range is going to be fast anyway. */
+	if (input_size < range_size)
+		return 0;
+
+	/* Find the oldest run. */
+	assert(!rlist_empty(&range->slices));
+	slice = rlist_last_entry(&range->slices, struct vy_slice, in_range);
+
+	int64_t part_count = slice->count.bytes / (range_size / 3 + 1);
+	int64_t page_count = slice->last_page_no - slice->first_page_no + 1;
+	part_count = MIN(part_count, page_count);
+	part_count = MIN(part_count, max_parts);
+	if (part_count < 2)
+		return 0;
+
+	/*
+	 * Split the oldest run in parts having the same number of
+	 * pages. Like in vy_range_needs_split(), we take the min key
+	 * of a page for a split key and skip keys that would make
+	 * a part empty.
+	 */
+	struct vy_page_info *prev_page = vy_run_page_info(slice->run,
+						slice->first_page_no);
+	int key_count = 0;
+	for (int i = 1; i < part_count; i++) {
+		struct vy_page_info *page = vy_run_page_info(slice->run,
+				slice->first_page_no + page_count * i /
+				part_count);
+		if (vy_key_compare(prev_page->min_key, prev_page->min_key_hint,
+				   page->min_key, page->min_key_hint,
+				   range->cmp_def) >= 0)
+			continue;
+		if (slice->begin.stmt != NULL &&
+		    vy_entry_compare_with_raw_key(slice->begin, page->min_key,
+						  page->min_key_hint,
+						  range->cmp_def) >= 0)
+			continue;
+		split_keys[key_count++] = page->min_key;
+		prev_page = page;
+	}
+	return key_count > 0 ? key_count + 1 : 0;
+}
+
 /**
  * Check if a range should be coalesced with one or more its neighbors.
  * If it should, return true and set @p_first and @p_last to the first
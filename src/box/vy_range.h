@@ -266,6 +266,26 @@ bool
 vy_range_needs_split(struct vy_range *range, int64_t range_size,
 		     const char **p_split_key);
 
+/** Max number of parts a range may be split in for compaction. */
+enum { VY_RANGE_SUBCOMPACTION_PARTS_MAX = 4 };
+
+/**
+ * Check if a range should be split in parts before compaction so
+ * that the parts can be compacted by different workers in parallel.
+ *
+ * @param range             The range.
+ * @param range_size        Target range size.
+ * @param max_parts         Max number of parts, must not be greater
+ *                          than VY_RANGE_SUBCOMPACTION_PARTS_MAX.
+ * @param[out] split_keys   Keys to split the range by.
+ *
+ * @retval                  Number of parts the range should be split
+ *                          in; 0 if it shouldn't be split.
+ */
+int
+vy_range_needs_subcompaction(struct vy_range *range, int64_t range_size,
+			     int max_parts, const char **split_keys);
+
 /**
  * Check if a range needs to be coalesced with adjacent
  * ranges in a range tree.
@@ -689,6 +689,17 @@ vy_read_iterator_add_disk(struct vy_read_iterator *itr)
 	 * format in vy_mem.
 	 */
 	rlist_foreach_entry(slice, &itr->curr_range->slices, in_range) {
+		/*
+		 * Run iterators check the bloom filter for ITER_EQ, but
+		 * ITER_REQ is passed to them as ITER_LE, which can't be
+		 * checked, so skip runs that don't have the key here.
+		 */
+		struct tuple_bloom *bloom = slice->run->info.bloom;
+		if (itr->iterator_type == ITER_REQ && bloom != NULL &&
+		    !vy_bloom_maybe_has(bloom, itr->key, lsm->key_def)) {
+			lsm->stat.disk.iterator.bloom_hit++;
+			continue;
+		}
 		struct vy_read_src *sub_src = vy_read_iterator_add_src(itr);
 		vy_run_iterator_open(&sub_src->run_iterator,
 				     &lsm->stat.disk.iterator, slice,
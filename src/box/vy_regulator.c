@@ -148,6 +148,16 @@ vy_regulator_update_write_rate(struct vy_regulator *regulator)
 				VY_WRITE_RATE_AVG_WIN);
 	rate_avg = (1 - weight) * rate_avg + weight * rate_curr;
 
+	/*
+	 * Smooth the change of the average write rate over the same
+	 * window to get its trend (double exponential smoothing).
+	 */
+	double trend_curr = ((double)rate_avg - regulator->write_rate) /
+			    VY_REGULATOR_TIMER_PERIOD;
+	regulator->write_rate_trend = (1 - weight) *
+				      regulator->write_rate_trend +
+				      weight * trend_curr;
+
 	regulator->write_rate = rate_avg;
 	if (regulator->write_rate_max < rate_curr)
 		regulator->write_rate_max = rate_curr;
@@ -177,6 +187,21 @@ vy_regulator_update_dump_watermark(struct vy_regulator *regulator)
 	 * long stalls.
 	 */
 	size_t write_rate = regulator->write_rate_max * 3 / 2;
+	/*
+	 * If the write rate is growing, the max observed write rate
+	 * may be exceeded by the time dump completes so forecast the
+	 * write rate by then, assuming that dump takes as long as it
+	 * takes to dump the memory used at the current watermark.
+	 */
+	if (regulator->write_rate_trend > 0) {
+		double dump_duration =
+			(double)MIN(regulator->dump_watermark, quota->limit) /
+			(regulator->dump_bandwidth + 1);
+		double write_rate_forecast = (regulator->write_rate +
+			regulator->write_rate_trend * dump_duration) * 3 / 2;
+		if (write_rate_forecast > write_rate)
+			write_rate = MIN(write_rate_forecast, (double)SIZE_MAX);
+	}
 	regulator->dump_watermark =
 			(double)quota->limit * regulator->dump_bandwidth /
 			(regulator->dump_bandwidth + write_rate + 1);
@@ -189,6 +214,56 @@ vy_regulator_update_dump_watermark(struct vy_regulator *regulator)
 					quota->limit / 2);
 }
 
+/**
+ * Forecast the time left until memory usage reaches the limit
+ * given the current write rate and its trend, i.e. find the least
+ * positive t satisfying
+ *
+ *   used + write_rate * t + write_rate_trend * t^2 / 2 = limit
+ */
+static void
+vy_regulator_update_time_to_throttle(struct vy_regulator *regulator)
+{
+	struct vy_quota *quota = regulator->quota;
+	double mem_left = (quota->used < quota->limit ?
+			   quota->limit - quota->used : 0);
+	double rate = regulator->write_rate;
+	double trend = regulator->write_rate_trend;
+	double t = INFINITY;
+	if (mem_left == 0) {
+		t = 0;
+	} else if (trend > 0) {
+		t = (sqrt(rate * rate + 2 * trend * mem_left) - rate) / trend;
+	} else if (trend < 0) {
+		/* The write rate may drop to 0 before the limit is hit. */
+		double d = rate * rate + 2 * trend * mem_left;
+		if (rate > 0 && d >= 0)
+			t = (rate - sqrt(d)) / -trend;
+	} else if (rate > 0) {
+		t = mem_left / rate;
+	}
+	regulator->time_to_throttle = t;
+}
+
+/**
+ * Trigger memory dump if the forecast says that the memory limit
+ * is going to be hit before the memory used now can be dumped.
+ * This starts dump early on a burst of writes, before memory usage
+ * reaches the watermark computed from the write rate observed so far.
+ */
+static void
+vy_regulator_check_time_to_throttle(struct vy_regulator *regulator)
+{
+	struct vy_quota *quota = regulator->quota;
+	/* See the comment to vy_regulator_update_dump_watermark(). */
+	if (quota->used < quota->limit / 2)
+		return;
+	double dump_duration = (double)quota->used /
+			       (regulator->dump_bandwidth + 1);
+	if (regulator->time_to_throttle < dump_duration * 3 / 2)
+		vy_regulator_trigger_dump(regulator);
+}
+
 static void
 vy_regulator_timer_cb(ev_loop *loop, ev_timer *timer, int events)
 {
@@ -199,7 +274,9 @@ vy_regulator_timer_cb(ev_loop *loop, ev_timer *timer, int events)
 
 	vy_regulator_update_write_rate(regulator);
 	vy_regulator_update_dump_watermark(regulator);
+	vy_regulator_update_time_to_throttle(regulator);
 	vy_regulator_check_dump_watermark(regulator);
+	vy_regulator_check_time_to_throttle(regulator);
 }
 
 void
@@ -230,6 +307,7 @@ vy_regulator_create(struct vy_regulator *regulator, struct vy_quota *quota,
 	regulator->timer.data = regulator;
 	regulator->dump_bandwidth = VY_DUMP_BANDWIDTH_DEFAULT;
 	regulator->dump_watermark = SIZE_MAX;
+	regulator->time_to_throttle = INFINITY;
 }
 
 void
@@ -80,6 +80,20 @@ struct vy_regulator {
 	 * memory dump was triggered, in bytes per second.
 	 */
 	size_t write_rate_max;
+	/**
+	 * Trend of @write_rate, i.e. how fast the average write rate
+	 * grows, in bytes per second squared. Used for forecasting
+	 * the write rate so as to start memory dump early enough if
+	 * the write rate is growing.
+	 */
+	double write_rate_trend;
+	/**
+	 * Forecast time left until memory usage reaches the limit and
+	 * transactions are throttled, in seconds, given the current
+	 * write rate and its trend. Infinity if memory usage isn't
+	 * growing.
+	 */
+	double time_to_throttle;
 	/**
 	 * Amount of memory that was used when the timer was
 	 * executed last time. Needed to update @write_rate.
@@ -31,6 +31,7 @@
 #include "vy_run.h"
 
 #include <zstd.h>
+#include <zdict.h>
 
 #include "fiber.h"
 #include "fiber_cond.h"
@@ -58,6 +59,17 @@ static const uint64_t vy_run_info_key_map = (1 << VY_RUN_INFO_MIN_KEY) |
 					    (1 << VY_RUN_INFO_MAX_LSN) |
 					    (1 << VY_RUN_INFO_PAGE_COUNT);
 
+enum {
+	/** Max size of a zstd dictionary trained for a run. */
+	VY_RUN_ZDICT_SIZE = 8 * 1024,
+	/**
+	 * Size of statement data a dictionary is trained on. zstd
+	 * recommends sampling about 100 times the dictionary size.
+	 * Runs smaller than this are written without a dictionary.
+	 */
+	VY_RUN_ZDICT_SAMPLE_SIZE = 64 * VY_RUN_ZDICT_SIZE,
+};
+
 /** xlog meta type for .run files */
 #define XLOG_META_TYPE_RUN "RUN"
 
@@ -85,6 +97,11 @@ struct vy_run_reader {
 	struct cpipe reader_pipe;
 	/** Pipe from the reader thread to tx. */
 	struct cpipe tx_pipe;
+	/**
+	 * Number of read requests sent to the thread and not
+	 * completed yet. Accessed only from tx.
+	 */
+	int task_count;
 };
 
 /** Cbus task for vinyl page read. */
@@ -177,6 +194,135 @@ vy_run_env_stop_readers(struct vy_run_env *env)
 	free(env->reader_pool);
 }
 
+static void
+vy_page_delete(struct vy_page *page);
+
+static inline void
+vy_page_ref(struct vy_page *page)
+{
+	assert(page->refs > 0);
+	page->refs++;
+}
+
+static inline void
+vy_page_unref(struct vy_page *page)
+{
+	assert(page->refs > 0);
+	if (--page->refs == 0)
+		vy_page_delete(page);
+}
+
+/* {{{ Page cache */
+
+/** Size of memory accounted to a page stored in the page cache. */
+static inline size_t
+vy_page_cache_page_size(struct vy_page *page)
+{
+	return sizeof(*page) + page->unpacked_size +
+	       page->row_count * sizeof(uint32_t);
+}
+
+/** Remove a page from the cache and drop the reference to it. */
+static void
+vy_page_cache_evict(struct vy_page_cache *cache, struct vy_page *page)
+{
+	struct vy_run *run = page->run;
+	assert(run != NULL);
+	assert(run->cached_pages[page->page_no] == page);
+	run->cached_pages[page->page_no] = NULL;
+	page->run = NULL;
+	rlist_del_entry(page, in_cache);
+	assert(cache->mem_used >= vy_page_cache_page_size(page));
+	assert(cache->page_count > 0);
+	cache->mem_used -= vy_page_cache_page_size(page);
+	cache->page_count--;
+	vy_page_unref(page);
+}
+
+/** Evict least recently used pages until the cache fits in the quota. */
+static void
+vy_page_cache_gc(struct vy_page_cache *cache)
+{
+	while (cache->mem_used > cache->quota) {
+		assert(!rlist_empty(&cache->lru));
+		struct vy_page *page = rlist_first_entry(&cache->lru,
+							 struct vy_page,
+							 in_cache);
+		vy_page_cache_evict(cache, page);
+	}
+}
+
+/**
+ * Look up a page of a run in the cache. Returns NULL if the page
+ * isn't cached. The returned page isn't referenced.
+ */
+static struct vy_page *
+vy_page_cache_get(struct vy_run *run, uint32_t page_no)
+{
+	struct vy_page_cache *cache = &run->env->page_cache;
+	if (cache->quota == 0)
+		return NULL;
+	struct vy_page *page = NULL;
+	if (run->cached_pages != NULL)
+		page = run->cached_pages[page_no];
+	if (page == NULL) {
+		cache->miss++;
+		return NULL;
+	}
+	cache->hit++;
+	rlist_move_tail_entry(&cache->lru, page, in_cache);
+	return page;
+}
+
+/** Add a page of a run to the cache. */
+static void
+vy_page_cache_put(struct vy_run *run, struct vy_page *page)
+{
+	struct vy_page_cache *cache = &run->env->page_cache;
+	assert(page->run == NULL);
+	if (vy_page_cache_page_size(page) > cache->quota)
+		return;
+	if (run->cached_pages == NULL) {
+		run->cached_pages = calloc(run->info.page_count,
+					   sizeof(*run->cached_pages));
+		/* The cache is optional, ignore allocation errors. */
+		if (run->cached_pages == NULL)
+			return;
+	}
+	assert(run->cached_pages[page->page_no] == NULL);
+	run->cached_pages[page->page_no] = page;
+	page->run = run;
+	vy_page_ref(page);
+	rlist_add_tail_entry(&cache->lru, page, in_cache);
+	cache->mem_used += vy_page_cache_page_size(page);
+	cache->page_count++;
+	vy_page_cache_gc(cache);
+}
+
+/** Evict all cached pages of a run. */
+static void
+vy_page_cache_drop_run(struct vy_run *run)
+{
+	if (run->cached_pages == NULL)
+		return;
+	for (uint32_t page_no = 0; page_no < run->info.page_count; page_no++) {
+		struct vy_page *page = run->cached_pages[page_no];
+		if (page != NULL)
+			vy_page_cache_evict(&run->env->page_cache, page);
+	}
+	free(run->cached_pages);
+	run->cached_pages = NULL;
+}
+
+void
+vy_run_env_set_page_cache_quota(struct vy_run_env *env, size_t quota)
+{
+	env->page_cache.quota = quota;
+	vy_page_cache_gc(&env->page_cache);
+}
+
+/* }}} Page cache */
+
 /**
  * Initialize vinyl run environment
  */
@@ -184,6 +330,7 @@ void
 vy_run_env_create(struct vy_run_env *env, int read_threads)
 {
 	memset(env, 0, sizeof(*env));
+	rlist_create(&env->page_cache.lru);
 	env->reader_pool_size = read_threads;
 	tt_pthread_key_create(&env->zdctx_key, vy_free_zdctx);
 	mempool_create(&env->read_task_pool, cord_slab_cache(),
@@ -199,6 +346,7 @@ vy_run_env_destroy(struct vy_run_env *env)
 {
 	if (env->reader_pool != NULL)
 		vy_run_env_stop_readers(env);
+	vy_run_env_set_page_cache_quota(env, 0);
 	mempool_destroy(&env->read_task_pool);
 	tt_pthread_key_delete(env->zdctx_key);
 }
@@ -225,13 +373,30 @@ vy_run_env_coio_call(struct vy_run_env *env, struct cbus_call_msg *msg,
 	if (env->reader_pool == NULL)
 		return func(msg);
 
-	/* Pick a reader thread. */
-	struct vy_run_reader *reader;
-	reader = &env->reader_pool[env->next_reader++];
-	env->next_reader %= env->reader_pool_size;
+	/*
+	 * Pick the least loaded reader thread. A read blocks the thread
+	 * until it completes so sending it to a thread that is busy with
+	 * another read would make it wait even if other threads are idle.
+	 * Start looking from the thread following the last used one so
+	 * that idle threads are used in turn.
+	 */
+	struct vy_run_reader *reader = NULL;
+	for (int i = 0; i < env->reader_pool_size; i++) {
+		struct vy_run_reader *r = &env->reader_pool[
+			(env->next_reader + i) % env->reader_pool_size];
+		if (reader == NULL || r->task_count < reader->task_count)
+			reader = r;
+		if (reader->task_count == 0)
+			break;
+	}
+	env->next_reader = (reader - env->reader_pool + 1) %
+			   env->reader_pool_size;
 
 	/* Post the task to the reader thread. */
-	if (cbus_call(&reader->reader_pipe, &reader->tx_pipe, msg, func) != 0)
+	reader->task_count++;
+	int rc = cbus_call(&reader->reader_pipe, &reader->tx_pipe, msg, func);
+	reader->task_count--;
+	if (rc != 0)
 		return -1;
 
 	if (fiber_is_cancelled()) {
@@ -294,6 +459,7 @@ vy_run_new(struct vy_run_env *env, int64_t id)
 static void
 vy_run_clear(struct vy_run *run)
 {
+	vy_page_cache_drop_run(run);
 	if (run->page_info != NULL) {
 		uint32_t page_no;
 		for (page_no = 0; page_no < run->info.page_count; ++page_no)
@@ -311,6 +477,11 @@ vy_run_clear(struct vy_run *run)
 	run->info.min_key = NULL;
 	free(run->info.max_key);
 	run->info.max_key = NULL;
+	free(run->info.zdict);
+	run->info.zdict = NULL;
+	run->info.zdict_size = 0;
+	ZSTD_freeDDict(run->zddict);
+	run->zddict = NULL;
 }
 
 void
@@ -688,6 +859,16 @@ vy_run_info_decode(struct vy_run_info *run_info,
 		case VY_RUN_INFO_STMT_STAT:
 			vy_stmt_stat_decode(&run_info->stmt_stat, &pos);
 			break;
+		case VY_RUN_INFO_ZSTD_DICT:
+			tmp = mp_decode_bin(&pos, &run_info->zdict_size);
+			run_info->zdict = malloc(run_info->zdict_size);
+			if (run_info->zdict == NULL) {
+				diag_set(OutOfMemory, run_info->zdict_size,
+					 "malloc", "zstd dictionary");
+				return -1;
+			}
+			memcpy(run_info->zdict, tmp, run_info->zdict_size);
+			break;
 		default:
 			mp_next(&pos); /* unknown key, ignore */
 			break;
@@ -731,6 +912,9 @@ vy_page_new(const struct vy_page_info *page_info)
 		free(page);
 		return NULL;
 	}
+	page->refs = 1;
+	page->run = NULL;
+	rlist_create(&page->in_cache);
 	return page;
 }
 
@@ -788,6 +972,62 @@ vy_page_stmt(struct vy_page *page, uint32_t stmt_no,
 	return entry;
 }
 
+/**
+ * Compare a statement stored in the page with a key without decoding
+ * the statement into a tuple. Works only for sequential key definitions
+ * without optional parts, see vy_page_can_compare_raw().
+ *
+ * @retval 0 Success, the comparison result is returned in @a cmp.
+ * @retval -1 Error decoding the statement.
+ */
+static int
+vy_page_compare_raw(struct vy_page *page, uint32_t stmt_no,
+		    const char *key, uint32_t key_part_count,
+		    struct key_def *cmp_def, int *cmp)
+{
+	struct xrow_header xrow;
+	if (vy_page_xrow(page, stmt_no, &xrow) != 0)
+		return -1;
+	struct request request;
+	uint64_t key_map = dml_request_key_map(xrow.type);
+	key_map &= ~(1ULL << IPROTO_SPACE_ID); /* space_id is optional */
+	if (xrow_decode_dml(&xrow, &request, key_map) != 0)
+		return -1;
+	const char *data;
+	switch (request.type) {
+	case IPROTO_DELETE:
+		data = request.key;
+		break;
+	case IPROTO_INSERT:
+	case IPROTO_REPLACE:
+	case IPROTO_UPSERT:
+		data = request.tuple;
+		break;
+	default:
+		diag_set(ClientError, ER_INVALID_RUN_FILE,
+			 tt_sprintf("Can't decode statement: "
+				    "unknown request type %u",
+				    (unsigned)request.type));
+		return -1;
+	}
+	uint32_t part_count = mp_decode_array(&data);
+	part_count = MIN(part_count, cmp_def->part_count);
+	*cmp = key_compare(data, part_count, HINT_NONE,
+			   key, key_part_count, HINT_NONE, cmp_def);
+	return 0;
+}
+
+/**
+ * Return true if vy_page_find_key() may compare page statements with
+ * the given key in place, without allocating a tuple for each probe.
+ */
+static inline bool
+vy_page_can_compare_raw(struct vy_entry key, struct key_def *cmp_def)
+{
+	return vy_stmt_is_key(key.stmt) && !cmp_def->is_multikey &&
+	       !cmp_def->has_optional_parts && key_def_is_sequential(cmp_def);
+}
+
 /**
  * Binary search in page
  * In terms of STL, makes lower_bound for EQ,GE,LT and upper_bound for GT,LE
@@ -806,6 +1046,25 @@ vy_page_find_key(struct vy_page *page, struct vy_entry key,
 	/* for upper bound we change zero comparison result to -1 */
 	int zero_cmp = (iterator_type == ITER_GT ||
 			iterator_type == ITER_LE ? -1 : 0);
+	if (vy_page_can_compare_raw(key, cmp_def)) {
+		const char *key_data = tuple_data(key.stmt);
+		uint32_t key_part_count = mp_decode_array(&key_data);
+		while (beg != end) {
+			uint32_t mid = beg + (end - beg) / 2;
+			int cmp;
+			if (vy_page_compare_raw(page, mid, key_data,
+						key_part_count, cmp_def,
+						&cmp) != 0)
+				return end;
+			cmp = cmp ? cmp : zero_cmp;
+			*equal_key = *equal_key || cmp == 0;
+			if (cmp < 0)
+				beg = mid + 1;
+			else
+				end = mid;
+		}
+		return end;
+	}
 	while (beg != end) {
 		uint32_t mid = beg + (end - beg) / 2;
 		struct vy_entry fnd_key = vy_page_stmt(page, mid, cmp_def,
@@ -824,20 +1083,84 @@ vy_page_find_key(struct vy_page *page, struct vy_entry key,
 	return end;
 }
 
+/** Max number of pages a run iterator may read ahead. */
+enum { VY_RUN_READAHEAD_MAX = 8 };
+
+/**
+ * A page read ahead by a run iterator in a separate fiber so that
+ * the read overlaps with processing of the pages read before it.
+ */
+struct vy_page_readahead {
+	/** Link in vy_run_iterator::readahead. */
+	struct rlist in_iterator;
+	/** Run the page is read from. Referenced. */
+	struct vy_run *run;
+	/** Number of the page in the run. */
+	uint32_t page_no;
+	/** The page. Owned by this object until the read is consumed. */
+	struct vy_page *page;
+	/** Set when the fiber reading the page is done. */
+	bool is_done;
+	/** Set if the read failed. The page is re-read then. */
+	bool is_failed;
+	/**
+	 * Set if the iterator doesn't need the page anymore. The fiber
+	 * reading the page frees this object when it's done then.
+	 */
+	bool is_abandoned;
+	/** Signaled when the fiber reading the page is done. */
+	struct fiber_cond done_cond;
+};
+
+static void
+vy_page_readahead_delete(struct vy_page_readahead *ra)
+{
+	if (ra->page != NULL)
+		vy_page_delete(ra->page);
+	vy_run_unref(ra->run);
+	fiber_cond_destroy(&ra->done_cond);
+	free(ra);
+}
+
+/**
+ * Drop a page read ahead by an iterator.
+ * If the page is being read, it will be freed when the read completes.
+ */
+static void
+vy_page_readahead_abandon(struct vy_page_readahead *ra)
+{
+	rlist_del_entry(ra, in_iterator);
+	if (ra->is_done)
+		vy_page_readahead_delete(ra);
+	else
+		ra->is_abandoned = true;
+}
+
+/** Drop all pages read ahead by an iterator. */
+static void
+vy_run_iterator_abandon_readahead(struct vy_run_iterator *itr)
+{
+	struct vy_page_readahead *ra, *next;
+	rlist_foreach_entry_safe(ra, &itr->readahead, in_iterator, next)
+		vy_page_readahead_abandon(ra);
+	itr->readahead_window = 0;
+}
+
 /**
  * End iteration and free cached data.
  */
 static void
 vy_run_iterator_stop(struct vy_run_iterator *itr)
 {
+	vy_run_iterator_abandon_readahead(itr);
 	if (itr->curr.stmt != NULL) {
 		tuple_unref(itr->curr.stmt);
 		itr->curr = vy_entry_none();
 	}
 	if (itr->curr_page != NULL) {
-		vy_page_delete(itr->curr_page);
+		vy_page_unref(itr->curr_page);
 		if (itr->prev_page != NULL)
-			vy_page_delete(itr->prev_page);
+			vy_page_unref(itr->prev_page);
 		itr->curr_page = itr->prev_page = NULL;
 	}
 }
@@ -926,7 +1249,8 @@ vy_page_read(struct vy_page *page, const struct vy_page_info *page_info,
 	const char *data_end = data + readen;
 	char *rows = page->data;
 	char *rows_end = rows + page_info->unpacked_size;
-	if (xlog_tx_decode(data, data_end, rows, rows_end, zdctx) != 0)
+	if (xlog_tx_decode(data, data_end, rows, rows_end, zdctx,
+			   run->zddict) != 0)
 		goto error;
 
 	struct xrow_header xrow;
@@ -997,6 +1321,140 @@ vy_page_read_cb(struct cbus_call_msg *base)
 	return 0;
 }
 
+static int
+vy_page_readahead_f(va_list ap)
+{
+	struct vy_page_readahead *ra = va_arg(ap, struct vy_page_readahead *);
+	struct vy_run_env *env = ra->run->env;
+	int rc = -1;
+	struct vy_page_read_task *task = mempool_alloc(&env->read_task_pool);
+	if (task != NULL) {
+		task->run = ra->run;
+		task->page_info = vy_run_page_info(ra->run, ra->page_no);
+		task->page = ra->page;
+		task->key = vy_entry_none();
+		task->pos_in_page = 0;
+		task->equal_found = false;
+		rc = vy_run_env_coio_call(env, &task->base, vy_page_read_cb);
+		mempool_free(&env->read_task_pool, task);
+	}
+	if (rc != 0) {
+		/* The page will be re-read by the iterator. */
+		diag_clear(diag_get());
+	}
+	ra->is_done = true;
+	ra->is_failed = rc != 0;
+	if (ra->is_abandoned)
+		vy_page_readahead_delete(ra);
+	else
+		fiber_cond_broadcast(&ra->done_cond);
+	return 0;
+}
+
+/** Start reading a page ahead of a sequential scan. */
+static void
+vy_run_iterator_readahead_page(struct vy_run_iterator *itr, uint32_t page_no)
+{
+	struct vy_run *run = itr->slice->run;
+	struct vy_page_readahead *ra = malloc(sizeof(*ra));
+	if (ra == NULL)
+		return;
+	ra->page = vy_page_new(vy_run_page_info(run, page_no));
+	if (ra->page == NULL) {
+		diag_clear(diag_get());
+		free(ra);
+		return;
+	}
+	ra->page->page_no = page_no;
+	ra->page_no = page_no;
+	ra->run = run;
+	vy_run_ref(run);
+	ra->is_done = false;
+	ra->is_failed = false;
+	ra->is_abandoned = false;
+	fiber_cond_create(&ra->done_cond);
+	struct fiber *f = fiber_new_system("vinyl.readahead",
+					   vy_page_readahead_f);
+	if (f == NULL) {
+		diag_clear(diag_get());
+		vy_page_readahead_delete(ra);
+		return;
+	}
+	rlist_add_tail_entry(&itr->readahead, ra, in_iterator);
+	fiber_start(f, ra);
+}
+
+/**
+ * Called after a run iterator loads a page. If the page follows the
+ * previously loaded one in the scan direction, start reading the next
+ * pages of the slice ahead in background fibers so that the reads are
+ * performed by the reader threads in parallel. The number of pages to
+ * read ahead doubles on each sequential load, up to
+ * VY_RUN_READAHEAD_MAX. A random access stops reading ahead.
+ */
+static void
+vy_run_iterator_readahead(struct vy_run_iterator *itr, uint32_t page_no,
+			  uint32_t prev_page_no, bool is_sequential)
+{
+	struct vy_slice *slice = itr->slice;
+	int dir = iterator_direction(itr->iterator_type);
+	if (!is_sequential ||
+	    (int64_t)page_no != (int64_t)prev_page_no + dir) {
+		vy_run_iterator_abandon_readahead(itr);
+		return;
+	}
+	/* Reading ahead is pointless for blocking I/O. */
+	if (slice->run->env->reader_pool == NULL)
+		return;
+	itr->readahead_window = itr->readahead_window == 0 ? 1 :
+		MIN(itr->readahead_window * 2, (uint32_t)VY_RUN_READAHEAD_MAX);
+	/* Drop pages that are behind the current one. */
+	struct vy_page_readahead *ra, *next;
+	int64_t last_page_no = page_no;
+	rlist_foreach_entry_safe(ra, &itr->readahead, in_iterator, next) {
+		if (((int64_t)ra->page_no - page_no) * dir <= 0)
+			vy_page_readahead_abandon(ra);
+		else
+			last_page_no = ra->page_no;
+	}
+	for (int64_t no = last_page_no + dir;
+	     (no - page_no) * dir <= itr->readahead_window &&
+	     no >= slice->first_page_no && no <= slice->last_page_no;
+	     no += dir)
+		vy_run_iterator_readahead_page(itr, no);
+}
+
+/**
+ * Take a page read ahead by a run iterator. Waits for the read to
+ * complete if it's still in progress. Returns NULL if the page isn't
+ * read ahead or the read failed.
+ */
+static struct vy_page *
+vy_run_iterator_take_readahead(struct vy_run_iterator *itr, uint32_t page_no)
+{
+	struct vy_page_readahead *ra;
+	rlist_foreach_entry(ra, &itr->readahead, in_iterator) {
+		if (ra->page_no == page_no)
+			break;
+	}
+	if (&ra->in_iterator == &itr->readahead)
+		return NULL;
+	while (!ra->is_done) {
+		if (fiber_cond_wait(&ra->done_cond) != 0) {
+			vy_page_readahead_abandon(ra);
+			return NULL;
+		}
+	}
+	rlist_del_entry(ra, in_iterator);
+	struct vy_page *page = NULL;
+	if (!ra->is_failed) {
+		page = ra->page;
+		ra->page = NULL;
+	}
+	vy_page_readahead_delete(ra);
+	return page;
+}
+
 /**
  * Read a page from disk given its number.
  * The function caches two most recently read pages.
@@ -1032,8 +1490,32 @@ vy_run_iterator_load_page(struct vy_run_iterator *itr, uint32_t page_no,
 		return 0;
 	}
 
-	/* Allocate buffers */
+	bool is_sequential = itr->curr_page != NULL;
+	uint32_t prev_page_no = is_sequential ? itr->curr_page->page_no : 0;
 	struct vy_page_info *page_info = vy_run_page_info(slice->run, page_no);
+
+	/* Check the page cache */
+	page = vy_page_cache_get(slice->run, page_no);
+	if (page != NULL) {
+		vy_page_ref(page);
+		if (key.stmt != NULL)
+			*pos_in_page = vy_page_find_key(page, key, itr->cmp_def,
+							itr->format, iterator_type,
+							equal_found);
+		goto out_cached;
+	}
+
+	/* Check pages read ahead */
+	page = vy_run_iterator_take_readahead(itr, page_no);
+	if (page != NULL) {
+		if (key.stmt != NULL)
+			*pos_in_page = vy_page_find_key(page, key, itr->cmp_def,
+							itr->format, iterator_type,
+							equal_found);
+		goto out;
+	}
+
+	/* Allocate buffers */
 	page = vy_page_new(page_info);
 	if (page == NULL)
 		return -1;
@@ -1066,19 +1548,27 @@ vy_run_iterator_load_page(struct vy_run_iterator *itr, uint32_t page_no,
 		vy_page_delete(page);
 		return -1;
 	}
-
-	/* Update cache */
-	if (itr->prev_page != NULL)
-		vy_page_delete(itr->prev_page);
-	itr->prev_page = itr->curr_page;
-	itr->curr_page = page;
 	page->page_no = page_no;
-
+	/*
+	 * Don't let a scan wash out the page cache: cache only pages
+	 * loaded on a random access.
+	 */
+	if (!is_sequential)
+		vy_page_cache_put(slice->run, page);
+out:
 	/* Update read statistics. */
 	itr->stat->read.rows += page_info->row_count;
 	itr->stat->read.bytes += page_info->unpacked_size;
 	itr->stat->read.bytes_compressed += page_info->size;
 	itr->stat->read.pages++;
+out_cached:
+	/* Update cache */
+	if (itr->prev_page != NULL)
+		vy_page_unref(itr->prev_page);
+	itr->prev_page = itr->curr_page;
+	itr->curr_page = page;
+
+	vy_run_iterator_readahead(itr, page_no, prev_page_no, is_sequential);
 
 	*result = page;
 	return 0;
@@ -1484,6 +1974,8 @@ vy_run_iterator_open(struct vy_run_iterator *itr,
 	itr->curr_pos.page_no = slice->run->info.page_count;
 	itr->curr_page = NULL;
 	itr->prev_page = NULL;
+	rlist_create(&itr->readahead);
+	itr->readahead_window = 0;
 	itr->search_started = false;
 
 	/*
@@ -1657,6 +2149,28 @@ vy_run_acct_page(struct vy_run *run, struct vy_page_info *page)
 	run->count.pages++;
 }
 
+/**
+ * Create a decompression dictionary from the raw dictionary stored
+ * in the run info, if any. The raw dictionary is freed, because it
+ * isn't needed anymore.
+ */
+static int
+vy_run_load_zdict(struct vy_run *run)
+{
+	if (run->info.zdict == NULL)
+		return 0;
+	assert(run->zddict == NULL);
+	run->zddict = ZSTD_createDDict(run->info.zdict, run->info.zdict_size);
+	if (run->zddict == NULL) {
+		diag_set(OutOfMemory, run->info.zdict_size, "zstd",
+			 "dictionary");
+		return -1;
+	}
+	free(run->info.zdict);
+	run->info.zdict = NULL;
+	return 0;
+}
+
 int
 vy_run_recover(struct vy_run *run, const char *dir,
 	       uint32_t space_id, uint32_t iid, struct key_def *cmp_def)
@@ -1706,7 +2220,8 @@ vy_run_recover(struct vy_run *run, const char *dir,
 		goto fail_close;
 	}
 
-	if (vy_run_info_decode(&run->info, &xrow, path) != 0)
+	if (vy_run_info_decode(&run->info, &xrow, path) != 0 ||
+	    vy_run_load_zdict(run) != 0)
 		goto fail_close;
 
 	/* Allocate buffer for page info. */
@@ -1992,6 +2507,8 @@ vy_run_info_encode(const struct vy_run_info *run_info,
 	uint32_t key_count = 6;
 	if (run_info->bloom != NULL)
 		key_count++;
+	if (run_info->zdict != NULL)
+		key_count++;
 
 	size_t size = mp_sizeof_map(key_count);
 	size += mp_sizeof_uint(VY_RUN_INFO_MIN_KEY) + min_key_size;
@@ -2007,6 +2524,9 @@ vy_run_info_encode(const struct vy_run_info *run_info,
 			tuple_bloom_size(run_info->bloom);
 	size += mp_sizeof_uint(VY_RUN_INFO_STMT_STAT) +
 		vy_stmt_stat_sizeof(&run_info->stmt_stat);
+	if (run_info->zdict != NULL)
+		size += mp_sizeof_uint(VY_RUN_INFO_ZSTD_DICT) +
+			mp_sizeof_bin(run_info->zdict_size);
 
 	char *pos = region_alloc(&fiber()->gc, size);
 	if (pos == NULL) {
@@ -2035,6 +2555,11 @@ vy_run_info_encode(const struct vy_run_info *run_info,
 	}
 	pos = mp_encode_uint(pos, VY_RUN_INFO_STMT_STAT);
 	pos = vy_stmt_stat_encode(&run_info->stmt_stat, pos);
+	if (run_info->zdict != NULL) {
+		pos = mp_encode_uint(pos, VY_RUN_INFO_ZSTD_DICT);
+		pos = mp_encode_bin(pos, run_info->zdict,
+				    run_info->zdict_size);
+	}
 	xrow->body->iov_len = (void *)pos - xrow->body->iov_base;
 	xrow->bodycnt = 1;
 	xrow->type = VY_INDEX_RUN_INFO;
@@ -2123,6 +2648,8 @@ vy_run_writer_create(struct vy_run_writer *writer, struct vy_run *run,
 	writer->page_size = page_size;
 	writer->bloom_fpr = bloom_fpr;
 	writer->no_compression = no_compression;
+	writer->is_sampling = !no_compression &&
+			      run->env->use_compression_dict;
 	if (bloom_fpr < 1) {
 		writer->bloom = tuple_bloom_builder_new(key_def->part_count);
 		if (writer->bloom == NULL)
@@ -2161,6 +2688,7 @@ vy_run_writer_create_xlog(struct vy_run_writer *writer)
 	opts.no_compression = writer->no_compression;
 	if (xlog_create(&writer->data_xlog, path, 0, &meta, &opts) != 0)
 		return -1;
+	writer->data_xlog.zcdict = writer->zcdict;
 	return 0;
 }
 
@@ -2277,8 +2805,8 @@ vy_run_writer_end_page(struct vy_run_writer *writer)
 	return 0;
 }
 
-int
-vy_run_writer_append_stmt(struct vy_run_writer *writer, struct vy_entry entry)
+static int
+vy_run_writer_write_stmt(struct vy_run_writer *writer, struct vy_entry entry)
 {
 	int rc = -1;
 	size_t region_svp = region_used(&fiber()->gc);
@@ -2299,6 +2827,141 @@ vy_run_writer_append_stmt(struct vy_run_writer *writer, struct vy_entry entry)
 	return rc;
 }
 
+/**
+ * Train a zstd dictionary on the data of the buffered statements.
+ * If there isn't enough data to train on, the run is written without
+ * a dictionary.
+ *
+ * @retval -1 Memory error.
+ * @retval  0 Success.
+ */
+static int
+vy_run_writer_train_zdict(struct vy_run_writer *writer)
+{
+	struct vy_run *run = writer->run;
+	size_t sizes_size = writer->sample_count * sizeof(size_t);
+	size_t *sizes = malloc(sizes_size);
+	char *samples = malloc(writer->sample_size);
+	char *zdict = malloc(VY_RUN_ZDICT_SIZE);
+	if (sizes == NULL || samples == NULL || zdict == NULL) {
+		diag_set(OutOfMemory, sizes_size + writer->sample_size +
+			 VY_RUN_ZDICT_SIZE, "malloc", "zstd dictionary");
+		goto fail;
+	}
+	char *pos = samples;
+	for (uint32_t i = 0; i < writer->sample_count; i++) {
+		struct tuple *stmt = writer->samples[i].stmt;
+		sizes[i] = tuple_bsize(stmt);
+		memcpy(pos, tuple_data(stmt), sizes[i]);
+		pos += sizes[i];
+	}
+	assert(pos == samples + writer->sample_size);
+	size_t zdict_size = ZDICT_trainFromBuffer(zdict, VY_RUN_ZDICT_SIZE,
+						  samples, sizes,
+						  writer->sample_count);
+	free(samples);
+	samples = NULL;
+	free(sizes);
+	sizes = NULL;
+	if (ZDICT_isError(zdict_size)) {
+		say_warn("failed to train zstd dictionary for run %lld: %s",
+			 (long long)run->id, ZDICT_getErrorName(zdict_size));
+		free(zdict);
+		return 0;
+	}
+	writer->zcdict = ZSTD_createCDict(zdict, zdict_size,
+					  XLOG_COMPRESSION_LEVEL_DEFAULT);
+	run->zddict = ZSTD_createDDict(zdict, zdict_size);
+	if (writer->zcdict == NULL || run->zddict == NULL) {
+		diag_set(OutOfMemory, zdict_size, "zstd", "dictionary");
+		goto fail;
+	}
+	run->info.zdict = zdict;
+	run->info.zdict_size = zdict_size;
+	return 0;
+fail:
+	ZSTD_freeCDict(writer->zcdict);
+	writer->zcdict = NULL;
+	ZSTD_freeDDict(run->zddict);
+	run->zddict = NULL;
+	free(zdict);
+	free(samples);
+	free(sizes);
+	return -1;
+}
+
+/** Release the statements buffered for dictionary training. */
+static void
+vy_run_writer_free_samples(struct vy_run_writer *writer)
+{
+	for (uint32_t i = 0; i < writer->sample_count; i++)
+		vy_stmt_unref_if_possible(writer->samples[i].stmt);
+	free(writer->samples);
+	writer->samples = NULL;
+	writer->sample_count = 0;
+	writer->sample_capacity = 0;
+	writer->sample_size = 0;
+}
+
+/**
+ * Stop buffering statements: train a dictionary if @a train is set
+ * and write the buffered statements to the run.
+ *
+ * @retval -1 Memory or IO error.
+ * @retval  0 Success.
+ */
+static int
+vy_run_writer_flush_samples(struct vy_run_writer *writer, bool train)
+{
+	assert(writer->is_sampling);
+	writer->is_sampling = false;
+	int rc = train ? vy_run_writer_train_zdict(writer) : 0;
+	for (uint32_t i = 0; rc == 0 && i < writer->sample_count; i++)
+		rc = vy_run_writer_write_stmt(writer, writer->samples[i]);
+	vy_run_writer_free_samples(writer);
+	return rc;
+}
+
+/**
+ * Buffer a statement to train a dictionary on. Once enough data
+ * is buffered, trains the dictionary and writes all buffered
+ * statements to the run.
+ *
+ * @retval -1 Memory or IO error.
+ * @retval  0 Success.
+ */
+static int
+vy_run_writer_add_sample(struct vy_run_writer *writer, struct vy_entry entry)
+{
+	if (writer->sample_count >= writer->sample_capacity) {
+		uint32_t capacity = writer->sample_capacity > 0 ?
+				    writer->sample_capacity * 2 : 256;
+		size_t size = capacity * sizeof(*writer->samples);
+		struct vy_entry *samples = realloc(writer->samples, size);
+		if (samples == NULL) {
+			diag_set(OutOfMemory, size, "realloc",
+				 "struct vy_entry");
+			return -1;
+		}
+		writer->samples = samples;
+		writer->sample_capacity = capacity;
+	}
+	vy_stmt_ref_if_possible(entry.stmt);
+	writer->samples[writer->sample_count++] = entry;
+	writer->sample_size += tuple_bsize(entry.stmt);
+	if (writer->sample_size < VY_RUN_ZDICT_SAMPLE_SIZE)
+		return 0;
+	return vy_run_writer_flush_samples(writer, true);
+}
+
+int
+vy_run_writer_append_stmt(struct vy_run_writer *writer, struct vy_entry entry)
+{
+	if (writer->is_sampling)
+		return vy_run_writer_add_sample(writer, entry);
+	return vy_run_writer_write_stmt(writer, entry);
+}
+
 /**
  * Destroy a run writer.
  * @param writer Writer to destroy.
@@ -2308,8 +2971,10 @@ vy_run_writer_destroy(struct vy_run_writer *writer)
 {
 	if (writer->last.stmt != NULL)
 		vy_stmt_unref_if_possible(writer->last.stmt);
+	vy_run_writer_free_samples(writer);
 	if (xlog_is_open(&writer->data_xlog))
 		xlog_discard(&writer->data_xlog);
+	ZSTD_freeCDict(writer->zcdict);
 	if (writer->bloom != NULL)
 		tuple_bloom_builder_delete(writer->bloom);
 	ibuf_destroy(&writer->row_index_buf);
@@ -2321,6 +2986,10 @@ vy_run_writer_commit(struct vy_run_writer *writer)
 	int rc = -1;
 	size_t region_svp = region_used(&fiber()->gc);
 
+	if (writer->is_sampling &&
+	    vy_run_writer_flush_samples(writer, false) != 0)
+		goto out;
+
 	if (ibuf_used(&writer->row_index_buf) != 0 &&
 	    vy_run_writer_end_page(writer) != 0)
 		goto out;
@@ -2369,6 +3038,10 @@ vy_run_writer_commit(struct vy_run_writer *writer)
 			       writer->space_id, writer->iid) != 0)
 		goto out;
 
+	/* The dictionary was loaded to run->zddict on training. */
+	free(run->info.zdict);
+	run->info.zdict = NULL;
+
 	vy_run_writer_destroy(writer);
 	rc = 0;
 out:
@@ -2574,7 +3247,8 @@ vy_run_remove_files_f(va_list ap)
 	for (int type = 0; type < vy_file_MAX; type++) {
 		vy_run_snprint_path(path, sizeof(path), dir,
 				    space_id, iid, run_id, type);
-		if (!xlog_remove_file(path, XLOG_RM_VERBOSE))
+		if (!xlog_remove_file(path, XLOG_RM_VERBOSE |
+				      XLOG_RM_THROTTLE))
 			ret = -1;
 	}
 	/* Remove the root directory if it's empty. */
@@ -52,21 +52,53 @@ extern "C" {
 struct vy_history;
 struct vy_run_reader;
 
+/**
+ * Cache of decompressed run pages shared by all run iterators.
+ * Cached pages are linked in an LRU list and looked up by the run
+ * they belong to and the page number, see vy_run::cached_pages.
+ * Only pages loaded on a random access, such as a point lookup or
+ * iterator positioning, are added to the cache so that a scan
+ * doesn't wash out hot pages. The cache is only accessed from
+ * the tx thread.
+ */
+struct vy_page_cache {
+	/** Max size of memory used by cached pages, 0 if disabled. */
+	size_t quota;
+	/** Size of memory used by cached pages. */
+	size_t mem_used;
+	/** Number of cached pages. */
+	uint32_t page_count;
+	/** Cached pages, least recently used first. */
+	struct rlist lru;
+	/** Number of lookups that found a page in the cache. */
+	int64_t hit;
+	/** Number of lookups that didn't find a page in the cache. */
+	int64_t miss;
+};
+
 /** Part of vinyl environment for run read/write */
 struct vy_run_env {
 	/** Write rate limit, in bytes per second. */
 	uint64_t snap_io_rate_limit;
+	/**
+	 * If set, compressed runs are written with a zstd dictionary
+	 * trained on the run data, see vy_run_writer::samples.
+	 */
+	bool use_compression_dict;
 	/** Mempool for struct vy_page_read_task */
 	struct mempool read_task_pool;
 	/** Key for thread-local ZSTD context */
 	pthread_key_t zdctx_key;
+	/** Cache of decompressed run pages. */
+	struct vy_page_cache page_cache;
 	/** Pool of threads used for reading run files. */
 	struct vy_run_reader *reader_pool;
 	/** Number of threads in the reader pool. */
 	int reader_pool_size;
 	/**
-	 * Index of the reader thread in the pool to be used for
-	 * processing the next read request.
+	 * Index of the reader thread in the pool to start looking
+	 * for an idle thread from when processing the next read
+	 * request.
 	 */
 	int next_reader;
 	/**
@@ -94,6 +126,14 @@ struct vy_run_info {
 	struct tuple_bloom *bloom;
 	/** Statement statistics. */
 	struct vy_stmt_stat stmt_stat;
+	/**
+	 * zstd dictionary used for compressing the run pages or NULL.
+	 * Freed once the dictionary is loaded to vy_run::zddict and
+	 * there's no need to encode it anymore.
+	 */
+	char *zdict;
+	/** Size of the zstd dictionary. */
+	uint32_t zdict_size;
 };
 
 /**
@@ -128,6 +168,16 @@ struct vy_run {
 	struct vy_page_info *page_info;
 	/** Run data file. */
 	int fd;
+	/**
+	 * Dictionary for decompressing the run pages or NULL if
+	 * the pages were compressed without a dictionary.
+	 */
+	ZSTD_DDict *zddict;
+	/**
+	 * Pages of this run stored in the page cache, indexed by
+	 * page number. Allocated when the first page is cached.
+	 */
+	struct vy_page **cached_pages;
 	/** Unique ID of this run. */
 	int64_t id;
 	/** Number of statements in this run. */
@@ -284,6 +334,16 @@ struct vy_run_iterator {
 	 */
 	struct vy_page *curr_page;
 	struct vy_page *prev_page;
+	/**
+	 * Pages that are being read or have been read ahead of
+	 * a sequential scan, linked by vy_page_readahead::in_iterator.
+	 */
+	struct rlist readahead;
+	/**
+	 * Number of pages to read ahead. Doubles on each page loaded
+	 * in the scan direction and drops to 0 on a random access.
+	 */
+	uint32_t readahead_window;
 	/** Is false until first .._get or .._next_.. method is called */
 	bool search_started;
 };
@@ -302,6 +362,16 @@ struct vy_page {
 	uint32_t *row_index;
 	/** Pointer to the page data. */
 	char *data;
+	/**
+	 * Number of references to the page: a page is referenced by
+	 * the page cache and by each run iterator that keeps it as its
+	 * current or previous page. The page is freed once it hits 0.
+	 */
+	int refs;
+	/** Run the page belongs to if it's cached, otherwise NULL. */
+	struct vy_run *run;
+	/** Link in vy_page_cache::lru. */
+	struct rlist in_cache;
 };
 
 /**
@@ -335,6 +405,13 @@ vy_run_env_destroy(struct vy_run_env *env);
 void
 vy_run_env_enable_coio(struct vy_run_env *env);
 
+/**
+ * Set the max size of memory used by the page cache, evicting
+ * pages if the cache is over the new limit. 0 disables the cache.
+ */
+void
+vy_run_env_set_page_cache_quota(struct vy_run_env *env, size_t quota);
+
 /**
  * Return the size of a run bloom filter.
  */
@@ -629,6 +706,26 @@ struct vy_run_writer {
 	uint32_t page_info_capacity;
 	/** Don't use compression while writing xlog files. */
 	bool no_compression;
+	/**
+	 * Small statements compress poorly, because every page is
+	 * compressed from scratch. To improve the ratio, the writer
+	 * may buffer the first statements of a run, train a zstd
+	 * dictionary on their data, and compress all pages with it.
+	 *
+	 * If this flag is set, appended statements are buffered in
+	 * @samples until their total size reaches the sample limit.
+	 */
+	bool is_sampling;
+	/** Statements buffered to train the dictionary on. */
+	struct vy_entry *samples;
+	/** Number of statements in @samples. */
+	uint32_t sample_count;
+	/** Capacity of @samples. */
+	uint32_t sample_capacity;
+	/** Total size of data of the statements in @samples. */
+	size_t sample_size;
+	/** Compression dictionary built from @samples or NULL. */
+	ZSTD_CDict *zcdict;
 	/** Xlog to write data. */
 	struct xlog data_xlog;
 	/** Bloom filter false positive rate. */
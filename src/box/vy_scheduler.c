@@ -59,6 +59,7 @@
 #include "vy_run.h"
 #include "vy_write_iterator.h"
 #include "trivia/util.h"
+#include "usdt.h"
 
 /* Min and max values for vy_scheduler::timeout. */
 #define VY_SCHEDULER_TIMEOUT_MIN	1
@@ -397,6 +398,19 @@ vy_worker_pool_get(struct vy_worker_pool *pool)
 	return worker;
 }
 
+/**
+ * Return the number of idle workers in a pool.
+ */
+static int
+vy_worker_pool_idle_count(struct vy_worker_pool *pool)
+{
+	int count = 0;
+	struct vy_worker *worker;
+	stailq_foreach_entry(worker, &pool->idle_workers, in_idle)
+		count++;
+	return count;
+}
+
 /**
  * Put a worker back to the pool it was allocated from once
  * it's done its job.
@@ -1309,6 +1323,7 @@ vy_task_dump_complete(struct vy_task *task)
 	scheduler->dump_task_count--;
 
 	say_info("%s: dump completed", vy_lsm_name(lsm));
+	USDT_PROBE(vinyl_dump_stop, lsm->space_id, lsm->index_id, 1);
 
 	vy_scheduler_complete_dump(scheduler);
 	return 0;
@@ -1338,6 +1353,7 @@ vy_task_dump_abort(struct vy_task *task)
 	struct error *e = diag_last_error(&task->diag);
 	error_log(e);
 	say_error("%s: dump failed", vy_lsm_name(lsm));
+	USDT_PROBE(vinyl_dump_stop, lsm->space_id, lsm->index_id, 0);
 
 	vy_run_discard(task->new_run);
 
@@ -1463,6 +1479,7 @@ vy_task_dump_new(struct vy_scheduler *scheduler, struct vy_worker *worker,
 	scheduler->dump_task_count++;
 
 	say_info("%s: dump started", vy_lsm_name(lsm));
+	USDT_PROBE(vinyl_dump_start, lsm->space_id, lsm->index_id);
 	*p_task = task;
 	return 0;
 
@@ -1649,6 +1666,7 @@ vy_task_compaction_complete(struct vy_task *task)
 
 	say_info("%s: completed compacting range %s",
 		 vy_lsm_name(lsm), vy_range_str(range));
+	USDT_PROBE(vinyl_compaction_stop, lsm->space_id, lsm->index_id, 1);
 	return 0;
 }
 
@@ -1666,6 +1684,7 @@ vy_task_compaction_abort(struct vy_task *task)
 	error_log(e);
 	say_error("%s: failed to compact range %s",
 		  vy_lsm_name(lsm), vy_range_str(range));
+	USDT_PROBE(vinyl_compaction_stop, lsm->space_id, lsm->index_id, 0);
 
 	vy_run_discard(task->new_run);
 
@@ -1688,8 +1707,16 @@ vy_task_compaction_new(struct vy_scheduler *scheduler, struct vy_worker *worker,
 	assert(range != NULL);
 	assert(range->compaction_priority > 1);
 
+	/*
+	 * If there are idle workers, split a big range so that its
+	 * parts are compacted in parallel. The worker assigned to
+	 * this task isn't accounted as idle so add one to the count.
+	 */
+	int max_parts = 1 + vy_worker_pool_idle_count(
+					&scheduler->compaction_pool);
 	if (vy_lsm_split_range(lsm, range) ||
-	    vy_lsm_coalesce_range(lsm, range)) {
+	    vy_lsm_coalesce_range(lsm, range) ||
+	    vy_lsm_split_range_for_compaction(lsm, range, max_parts)) {
 		vy_scheduler_update_lsm(scheduler, lsm);
 		return 0;
 	}
@@ -1762,6 +1789,7 @@ vy_task_compaction_new(struct vy_scheduler *scheduler, struct vy_worker *worker,
 	say_info("%s: started compacting range %s, runs %d/%d",
 		 vy_lsm_name(lsm), vy_range_str(range),
                  range->compaction_priority, range->slice_count);
+	USDT_PROBE(vinyl_compaction_start, lsm->space_id, lsm->index_id);
 	*p_task = task;
 	return 0;
 
@@ -523,6 +523,54 @@ vy_stmt_new_surrogate_delete_raw(struct tuple_format *format,
 	return stmt;
 }
 
+struct tuple *
+vy_stmt_new_surrogate_replace(struct tuple_format *format,
+			      struct tuple *key, struct key_def *cmp_def)
+{
+	assert(vy_stmt_is_key(key));
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	const char *key_data = tuple_data(key);
+	uint32_t part_count = mp_decode_array(&key_data);
+	assert(part_count > 0 && part_count <= cmp_def->part_count);
+	assert(!cmp_def->has_json_paths);
+	uint32_t field_count = 0;
+	for (uint32_t i = 0; i < part_count; i++)
+		field_count = MAX(field_count, cmp_def->parts[i].fieldno + 1);
+	const char **fields = xregion_alloc_array(region, const char *,
+						   field_count);
+	memset(fields, 0, field_count * sizeof(*fields));
+	const char *pos = key_data;
+	uint32_t bsize = mp_sizeof_array(field_count) + field_count;
+	for (uint32_t i = 0; i < part_count; i++) {
+		uint32_t fieldno = cmp_def->parts[i].fieldno;
+		const char *field = pos;
+		mp_next(&pos);
+		if (fields[fieldno] != NULL)
+			continue;
+		fields[fieldno] = field;
+		bsize += pos - field - mp_sizeof_nil();
+	}
+	char *data = xregion_alloc(region, bsize);
+	char *data_end = mp_encode_array(data, field_count);
+	for (uint32_t i = 0; i < field_count; i++) {
+		if (fields[i] == NULL) {
+			data_end = mp_encode_nil(data_end);
+			continue;
+		}
+		const char *field_end = fields[i];
+		mp_next(&field_end);
+		memcpy(data_end, fields[i], field_end - fields[i]);
+		data_end += field_end - fields[i];
+	}
+	assert(data_end == data + bsize);
+	struct tuple *stmt = vy_stmt_new_replace(format, data, data_end);
+	if (stmt != NULL)
+		vy_stmt_set_lsn(stmt, vy_stmt_lsn(key));
+	region_truncate(region, region_svp);
+	return stmt;
+}
+
 struct tuple *
 vy_stmt_extract_key(struct tuple *stmt, struct key_def *key_def,
 		    struct tuple_format *format, int multikey_idx)
@@ -512,6 +512,29 @@ vy_stmt_new_surrogate_delete(struct tuple_format *format, struct tuple *tuple)
 	return vy_stmt_new_surrogate_delete_raw(format, data, data + size);
 }
 
+/**
+ * Create a surrogate REPLACE from a key statement read from
+ * a secondary index run using @a format. The key parts are
+ * placed in their tuple fields, all other fields are set to
+ * MessagePack NIL.
+ *
+ * Example:
+ * key:           {a4, a2}
+ * index cmp_def: {4, 2}
+ * result:        {null, a2, null, a4}
+ *
+ * @param format  Target tuple format.
+ * @param key     Key statement.
+ * @param cmp_def Key definition of the secondary index,
+ *                must not have JSON paths.
+ *
+ * @retval not NULL Success.
+ * @retval     NULL Memory error.
+ */
+struct tuple *
+vy_stmt_new_surrogate_replace(struct tuple_format *format,
+			      struct tuple *key, struct key_def *cmp_def);
+
 /**
  * Create the REPLACE statement from raw MessagePack data.
  * @param format Format of a tuple for offsets generating.
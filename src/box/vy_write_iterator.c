@@ -34,30 +34,19 @@
 #include "vy_upsert.h"
 #include "fiber.h"
 
-#define HEAP_FORWARD_DECLARATION
-#include "salad/heap.h"
-
 /**
  * Merge source of a write iterator. Represents a mem or a run.
  */
 struct vy_write_src {
 	/* Link in vy_write_iterator::src_list */
 	struct rlist in_src_list;
-	/* Node in vy_write_iterator::src_heap */
-	struct heap_node heap_node;
-	/* Current tuple in the source (with minimal key and maximal LSN) */
-	struct vy_entry entry;
 	/**
-	 * If this flag is set, this is a so called "virtual"
-	 * source. A virtual source does not stand for any mem or
-	 * run, but represents a delimiter between the current key
-	 * and the next one. There is a special rule used by the
-	 * write iterator heap when comparing with a virtual
-	 * source. Such source is greater than any source with
-	 * the same key and less than any source with a greater
-	 * key, regardless of LSN.
+	 * Current tuple in the source (with minimal key and maximal
+	 * LSN) or none if the source is exhausted or stopped.
 	 */
-	bool is_end_of_key;
+	struct vy_entry entry;
+	/** Set if iteration in the source has been started. */
+	bool is_started;
 	/** An iterator over the source */
 	union {
 		struct vy_slice_stream slice_stream;
@@ -66,15 +55,6 @@ struct vy_write_src {
 	};
 };
 
-static bool
-heap_less(heap_t *heap, struct vy_write_src *src1, struct vy_write_src *src2);
-
-#define HEAP_NAME vy_source_heap
-#define HEAP_LESS heap_less
-#define heap_value_t struct vy_write_src
-#define heap_value_attr heap_node
-#include "salad/heap.h"
-
 /**
  * A sequence of versions of a key, sorted by LSN in ascending order.
  * (history->entry.stmt.lsn < history->next->entry.stmt.lsn).
@@ -169,8 +149,26 @@ struct vy_write_iterator {
 	struct vy_stmt_stream base;
 	/* List of all sources of the iterator */
 	struct rlist src_list;
-	/* A heap to order the sources, newest LSN at heap top. */
-	heap_t src_heap;
+	/**
+	 * Sources that had statements when the iteration was
+	 * started. These are the leaves of the loser tree.
+	 */
+	struct vy_write_src **srcs;
+	/** Number of entries in @srcs. */
+	int src_count;
+	/**
+	 * Loser tree (tournament tree) that orders the sources,
+	 * newest LSN of the least key first. For n sources, nodes
+	 * 1..n-1 are internal and nodes n..2n-1 are leaves, the
+	 * parent of node i is node i/2. Each internal node stores
+	 * the index in @srcs of the source that lost the match at
+	 * this node, the winner goes up. tree[0] stores the
+	 * overall winner. When the winner advances, only the matches
+	 * on the path from its leaf to the root are replayed, which
+	 * takes exactly one comparison per tree level, while a heap
+	 * needs two. Exhausted sources lose all matches.
+	 */
+	int *tree;
 	/** Index key definition used to store statements on disk. */
 	struct key_def *cmp_def;
 	/* There is no LSM tree level older than the one we're writing to. */
@@ -219,26 +217,28 @@ struct vy_write_iterator {
 };
 
 /**
- * Comparator of the heap. Put newer LSNs first, unless
- * it's a virtual source (is_end_of_key).
+ * Comparator of the loser tree. Returns true if the source with
+ * index @a i in vy_write_iterator::srcs goes before the source with
+ * index @a j. Puts the least key first, then newer LSNs first.
+ * Exhausted sources go last.
  */
 static bool
-heap_less(heap_t *heap, struct vy_write_src *src1, struct vy_write_src *src2)
+vy_write_iterator_src_less(struct vy_write_iterator *stream, int i, int j)
 {
-	struct vy_write_iterator *stream =
-		container_of(heap, struct vy_write_iterator, src_heap);
+	struct vy_write_src *src1 = stream->srcs[i];
+	struct vy_write_src *src2 = stream->srcs[j];
+	if (src1->entry.stmt == NULL)
+		return false;
+	if (src2->entry.stmt == NULL)
+		return true;
 
 	int cmp = vy_entry_compare(src1->entry, src2->entry, stream->cmp_def);
 	if (cmp != 0)
 		return cmp < 0;
 
-	/**
-	 * Keys are equal, order by LSN, descending.
-	 * Virtual sources use 0 for LSN, so they are ordered
-	 * last automatically.
-	 */
-	int64_t lsn1 = src1->is_end_of_key  ? 0 : vy_stmt_lsn(src1->entry.stmt);
-	int64_t lsn2 = src2->is_end_of_key  ? 0 : vy_stmt_lsn(src2->entry.stmt);
+	/* Keys are equal, order by LSN, descending. */
+	int64_t lsn1 = vy_stmt_lsn(src1->entry.stmt);
+	int64_t lsn2 = vy_stmt_lsn(src2->entry.stmt);
 	if (lsn1 != lsn2)
 		return lsn1 > lsn2;
 
@@ -254,6 +254,53 @@ heap_less(heap_t *heap, struct vy_write_src *src1, struct vy_write_src *src2)
 
 }
 
+/**
+ * Play the matches of the subtree rooted at the given node of the
+ * loser tree, storing losers in internal nodes. Returns the index
+ * of the winner source.
+ */
+static int
+vy_write_iterator_build_tree(struct vy_write_iterator *stream, int node)
+{
+	if (node >= stream->src_count)
+		return node - stream->src_count;
+	int winner = vy_write_iterator_build_tree(stream, 2 * node);
+	int loser = vy_write_iterator_build_tree(stream, 2 * node + 1);
+	if (vy_write_iterator_src_less(stream, loser, winner))
+		SWAP(winner, loser);
+	stream->tree[node] = loser;
+	return winner;
+}
+
+/**
+ * Replay the matches on the path from the leaf of the source with
+ * the given index to the root after the source was advanced.
+ */
+static void
+vy_write_iterator_replay(struct vy_write_iterator *stream, int winner)
+{
+	for (int node = (stream->src_count + winner) / 2; node > 0;
+	     node /= 2) {
+		if (vy_write_iterator_src_less(stream, stream->tree[node],
+					       winner))
+			SWAP(stream->tree[node], winner);
+	}
+	stream->tree[0] = winner;
+}
+
+/**
+ * Return the source with the least key and the newest LSN or NULL
+ * if all sources are exhausted.
+ */
+static inline struct vy_write_src *
+vy_write_iterator_top(struct vy_write_iterator *stream)
+{
+	if (stream->src_count == 0)
+		return NULL;
+	struct vy_write_src *src = stream->srcs[stream->tree[0]];
+	return src->entry.stmt != NULL ? src : NULL;
+}
+
 /**
  * Allocate a source and add it to a write iterator.
  * @param stream - the write iterator.
@@ -268,9 +315,8 @@ vy_write_iterator_new_src(struct vy_write_iterator *stream)
 			 "malloc", "vinyl write stream");
 		return NULL;
 	}
-	heap_node_create(&res->heap_node);
 	res->entry = vy_entry_none();
-	res->is_end_of_key = false;
+	res->is_started = false;
 	rlist_add(&stream->src_list, &res->in_src_list);
 	return res;
 }
@@ -282,16 +328,33 @@ vy_write_iterator_delete_src(struct vy_write_iterator *stream,
 			     struct vy_write_src *src)
 {
 	(void)stream;
-	assert(!src->is_end_of_key);
 	if (src->stream.iface->close != NULL)
 		src->stream.iface->close(&src->stream);
 	rlist_del(&src->in_src_list);
 	free(src);
 }
 
+/**
+ * Stop iteration in a source. The source loses all matches
+ * in the loser tree from now on.
+ */
+static void
+vy_write_iterator_remove_src(struct vy_write_iterator *stream,
+			   struct vy_write_src *src)
+{
+	(void)stream;
+	src->entry = vy_entry_none();
+	if (!src->is_started)
+		return; /* already removed */
+	src->is_started = false;
+	if (src->stream.iface->stop != NULL)
+		src->stream.iface->stop(&src->stream);
+}
+
 /**
  * Start iteration in the given source, retrieve the first tuple,
- * and add the source to the write iterator heap.
+ * and add the source to the write iterator sources if it isn't
+ * empty.
  *
  * @return 0 - success, not 0 - error.
  */
@@ -304,35 +367,14 @@ vy_write_iterator_add_src(struct vy_write_iterator *stream,
 		if (rc != 0)
 			return rc;
 	}
+	src->is_started = true;
 	int rc = src->stream.iface->next(&src->stream, &src->entry);
-	if (rc != 0 || src->entry.stmt == NULL)
-		goto stop;
-
-	rc = vy_source_heap_insert(&stream->src_heap, src);
-	if (rc != 0) {
-		diag_set(OutOfMemory, sizeof(void *),
-			 "malloc", "vinyl write stream heap");
-		goto stop;
+	if (rc != 0 || src->entry.stmt == NULL) {
+		vy_write_iterator_remove_src(stream, src);
+		return rc;
 	}
+	stream->srcs[stream->src_count++] = src;
 	return 0;
-stop:
-	if (src->stream.iface->stop != NULL)
-		src->stream.iface->stop(&src->stream);
-	return rc;
-}
-
-/**
- * Remove a source from the heap and stop iteration.
- */
-static void
-vy_write_iterator_remove_src(struct vy_write_iterator *stream,
-			   struct vy_write_src *src)
-{
-	if (heap_node_is_stray(&src->heap_node))
-		return; /* already removed */
-	vy_source_heap_delete(&stream->src_heap, src);
-	if (src->stream.iface->stop != NULL)
-		src->stream.iface->stop(&src->stream);
 }
 
 static const struct vy_stmt_stream_iface vy_slice_stream_iface;
@@ -383,7 +425,6 @@ vy_write_iterator_new(struct key_def *cmp_def, bool is_primary,
 	assert(count == 0);
 
 	stream->base.iface = &vy_slice_stream_iface;
-	vy_source_heap_create(&stream->src_heap);
 	rlist_create(&stream->src_list);
 	stream->cmp_def = cmp_def;
 	stream->is_primary = is_primary;
@@ -405,6 +446,20 @@ vy_write_iterator_start(struct vy_stmt_stream *vstream)
 	assert(vstream->iface->start == vy_write_iterator_start);
 	struct vy_write_iterator *stream = (struct vy_write_iterator *)vstream;
 	struct vy_write_src *src;
+	assert(stream->srcs == NULL);
+	int count = 0;
+	rlist_foreach_entry(src, &stream->src_list, in_src_list)
+		count++;
+	if (count > 0) {
+		stream->srcs = malloc(count * sizeof(*stream->srcs));
+		stream->tree = malloc(count * sizeof(*stream->tree));
+		if (stream->srcs == NULL || stream->tree == NULL) {
+			diag_set(OutOfMemory, count * (sizeof(*stream->srcs) +
+						       sizeof(*stream->tree)),
+				 "malloc", "vinyl write stream tree");
+			return -1;
+		}
+	}
 	rlist_foreach_entry(src, &stream->src_list, in_src_list) {
 		if (vy_write_iterator_add_src(stream, src) != 0)
 			goto fail;
@@ -418,6 +473,8 @@ vy_write_iterator_start(struct vy_stmt_stream *vstream)
 		}
 #endif
 	}
+	if (stream->src_count > 0)
+		stream->tree[0] = vy_write_iterator_build_tree(stream, 1);
 	return 0;
 fail:
 	rlist_foreach_entry(src, &stream->src_list, in_src_list)
@@ -465,7 +522,8 @@ vy_write_iterator_close(struct vy_stmt_stream *vstream)
 	struct vy_write_src *src, *tmp;
 	rlist_foreach_entry_safe(src, &stream->src_list, in_src_list, tmp)
 		vy_write_iterator_delete_src(stream, src);
-	vy_source_heap_destroy(&stream->src_heap);
+	free(stream->srcs);
+	free(stream->tree);
 	free(stream);
 }
 
@@ -509,15 +567,15 @@ vy_write_iterator_new_slice(struct vy_stmt_stream *vstream,
 static NODISCARD int
 vy_write_iterator_merge_step(struct vy_write_iterator *stream)
 {
-	struct vy_write_src *src = vy_source_heap_top(&stream->src_heap);
-	assert(src != NULL);
+	int winner = stream->tree[0];
+	struct vy_write_src *src = stream->srcs[winner];
+	assert(src->entry.stmt != NULL);
 	int rc = src->stream.iface->next(&src->stream, &src->entry);
 	if (rc != 0)
 		return rc;
-	if (src->entry.stmt != NULL)
-		vy_source_heap_update(&stream->src_heap, src);
-	else
+	if (src->entry.stmt == NULL)
 		vy_write_iterator_remove_src(stream, src);
+	vy_write_iterator_replay(stream, winner);
 	return 0;
 }
 
@@ -676,30 +734,17 @@ vy_write_iterator_build_history(struct vy_write_iterator *stream,
 	*is_first_insert = false;
 	assert(stream->stmt_i == -1);
 	assert(stream->deferred_delete.stmt == NULL);
-	struct vy_write_src *src = vy_source_heap_top(&stream->src_heap);
+	struct vy_write_src *src = vy_write_iterator_top(stream);
 	if (src == NULL)
 		return 0; /* no more data */
-	/* Search must have been started already. */
-	assert(src->entry.stmt != NULL);
 	/*
-	 * A virtual source instance which represents the end on
-	 * the current key in the source heap. It is greater
-	 * than any statement on the current key and less than
-	 * any statement on the next key.
-	 * The moment we get this source from the heap we know
-	 * that there are no statements that there are no more
-	 * statements for the current key.
+	 * The current key. The moment the top source has a different
+	 * key we know that there are no more statements for the
+	 * current key.
 	 */
-	struct vy_write_src end_of_key_src;
-	end_of_key_src.is_end_of_key = true;
-	end_of_key_src.entry = src->entry;
-	int rc = vy_source_heap_insert(&stream->src_heap, &end_of_key_src);
-	if (rc) {
-		diag_set(OutOfMemory, sizeof(void *),
-			 "malloc", "vinyl write stream heap");
-		return rc;
-	}
-	vy_stmt_ref_if_possible(src->entry.stmt);
+	struct vy_entry key = src->entry;
+	vy_stmt_ref_if_possible(key.stmt);
+	int rc = 0;
 	/*
 	 * For each pair (merge_until_lsn, current_rv_lsn] build
 	 * a history in the corresponding read view.
@@ -795,10 +840,9 @@ vy_write_iterator_build_history(struct vy_write_iterator *stream,
 		rc = vy_write_iterator_merge_step(stream);
 		if (rc != 0)
 			break;
-		src = vy_source_heap_top(&stream->src_heap);
-		assert(src != NULL);
-		assert(src->entry.stmt != NULL);
-		if (src->is_end_of_key)
+		src = vy_write_iterator_top(stream);
+		if (src == NULL ||
+		    vy_entry_compare(src->entry, key, stream->cmp_def) != 0)
 			break;
 	}
 
@@ -813,8 +857,7 @@ vy_write_iterator_build_history(struct vy_write_iterator *stream,
 		stream->deferred_delete = vy_entry_none();
 	}
 
-	vy_source_heap_delete(&stream->src_heap, &end_of_key_src);
-	vy_stmt_unref_if_possible(end_of_key_src.entry.stmt);
+	vy_stmt_unref_if_possible(key.stmt);
 	return rc;
 }
 
@@ -1109,7 +1152,7 @@ vy_write_iterator_next(struct vy_stmt_stream *vstream, struct vy_entry *ret)
 		 * DELETE or it consisted only from optimized
 		 * updates. Then try to get the next key.
 		 */
-		if (count != 0 || stream->src_heap.size == 0)
+		if (count != 0 || vy_write_iterator_top(stream) == NULL)
 			break;
 	}
 	/* Again try to get the statement, after calling next_key(). */
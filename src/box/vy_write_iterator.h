@@ -49,7 +49,7 @@
  *
  * The sources supply statements in ascending order of the
  * key and descending order of LSN (newest changes first).
- * A heap is used to preserve descending order of LSNs
+ * A loser tree is used to preserve descending order of LSNs
  * in the output.
  *
  * There may be many statements for the same key, forming
@@ -81,7 +81,7 @@
  * The following optimizations are applicable, all aiming at
  * purging unnecessary statements from the output. The
  * optimizations are applied while reading the statements from
- * the heap, from newest LSN to oldest.
+ * the loser tree, from newest LSN to oldest.
  *
  * ---------------------------------------------------------------
  * Optimization #1: when merging the last level of the LSM tree,
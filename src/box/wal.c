@@ -30,7 +30,10 @@
  */
 #include "wal.h"
 
+#include "small/ibuf.h"
+#include "tt_pthread.h"
 #include "fiber.h"
+#include "fiber_cond.h"
 #include "fio.h"
 #include "errinj.h"
 #include "error.h"
@@ -41,9 +44,12 @@
 #include "vy_log.h"
 #include "cbus.h"
 #include "coio_task.h"
+#include "coio_file.h"
 #include "replication.h"
 #include "iproto_constants.h"
 #include "watcher.h"
+#include "tt_cpu_set.h"
+#include "usdt.h"
 
 enum {
 	/**
@@ -57,6 +63,9 @@ enum {
 	WAL_FALLOCATE_LEN = 1024 * 1024,
 };
 
+/** Delay before retrying to create a spare WAL file after failure. */
+static const double WAL_SPARE_RETRY_DELAY = 10;
+
 const char *wal_mode_STRS[WAL_MODE_MAX] = {
 	[WAL_NONE]	= "none",
 	[WAL_WRITE]	= "write",
@@ -79,6 +88,41 @@ wal_write_none_async(struct journal *, struct journal_entry *);
 static int
 wal_write_none(struct journal *, struct journal_entry *);
 
+/**
+ * An entry of the buffer of rows recently written to WAL. Stores
+ * rows of a batch encoded as in xlog files.
+ */
+struct wal_buf_entry {
+	/** Link in wal_buf::entries. */
+	struct stailq_entry in_buf;
+	/** Vclock of the last row of the entry. */
+	struct vclock vclock;
+	/** Signature of the WAL file the rows were written to. */
+	int64_t file_signature;
+	/** Size of the encoded rows. */
+	size_t size;
+	/** Encoded rows. */
+	char data[0];
+};
+
+/**
+ * Buffer of rows recently written to WAL. Filled by the WAL thread
+ * after each write and read by relays, which makes it unnecessary
+ * for relays that are caught up to read and decode WAL files.
+ */
+struct wal_buf {
+	/** Protects the buffer from concurrent access by relays. */
+	pthread_rwlock_t lock;
+	/** Max size of buffered rows, wal_relay_buffer_size. */
+	size_t max_size;
+	/** Size of buffered rows. */
+	size_t size;
+	/** Vclock preceding the first buffered row. */
+	struct vclock vclock;
+	/** Buffered entries, oldest first. */
+	struct stailq entries;
+};
+
 /*
  * WAL writer - maintain a Write Ahead Log for every change
  * in the data state.
@@ -116,6 +160,45 @@ struct wal_writer
 	int64_t wal_max_size;
 	/** Another one - wal_mode */
 	enum wal_mode wal_mode;
+	/**
+	 * Set by wal_sync_pipeline in the 'fsync' mode. If set, batches
+	 * are written without syncing and synced by sync_fiber, so the
+	 * next batch may be written while the previous one is synced.
+	 * Batches are sent back to tx in order once they are synced.
+	 */
+	bool is_sync_pipelined;
+	/**
+	 * Set by wal_relay_before_sync if is_sync_pipelined is set.
+	 * If set, watchers are notified about a batch once it's written
+	 * rather than synced, so relays send it to replicas while it's
+	 * being synced locally.
+	 */
+	bool is_relay_before_sync;
+	/** CPUs the WAL thread is bound to, box.cfg.wal_cpus. */
+	struct tt_cpu_set cpu_set;
+	/** Set if the WAL thread is bound to cpu_set. */
+	bool cpu_set_is_set;
+	/** Batches written to disk and waiting for sync. */
+	struct stailq sync_queue;
+	/** Set while sync_fiber is syncing the current WAL file. */
+	bool is_sync_in_progress;
+	/** Fiber syncing written batches if is_sync_pipelined is set. */
+	struct fiber *sync_fiber;
+	/** Signaled when a batch is added to sync_queue. */
+	struct fiber_cond sync_queue_cond;
+	/** Signaled when sync_fiber is done with a bunch of batches. */
+	struct fiber_cond sync_done_cond;
+	/** Number of spare WAL files to keep, box.cfg.wal_spare_files. */
+	int spare_count;
+	/** Set for each spare file slot that has a file ready for use. */
+	bool spare_is_ready[WAL_SPARE_COUNT_MAX];
+	/**
+	 * Fiber creating spare WAL files, see wal_spare_f(). Started on
+	 * the first rotation, i.e. once the instance owns the WAL dir.
+	 */
+	struct fiber *spare_fiber;
+	/** Signaled when a spare WAL file is used up. */
+	struct fiber_cond spare_cond;
 	/** wal_dir, from the configuration file. */
 	struct xdir wal_dir;
 	/** 'wal' thread doing the writes. */
@@ -174,6 +257,8 @@ struct wal_writer
 	 * Used for replication relays.
 	 */
 	struct rlist watchers;
+	/** Rows recently written to WAL, read by relays. */
+	struct wal_buf buf;
 };
 
 struct wal_msg {
@@ -225,10 +310,20 @@ static struct cmsg_hop wal_request_route[] = {
 	{tx_complete_batch, NULL},
 };
 
+/**
+ * Route of batches used if the sync is pipelined. A batch is sent
+ * back to tx by the sync fiber, see wal_sync_queue_f().
+ */
+static struct cmsg_hop wal_pipelined_request_route[] = {
+	{wal_write_to_disk, NULL},
+	{tx_complete_batch, NULL},
+};
+
 static void
 wal_msg_create(struct wal_msg *batch)
 {
-	cmsg_init(&batch->base, wal_request_route);
+	cmsg_init(&batch->base, wal_writer_singleton.is_sync_pipelined ?
+		  wal_pipelined_request_route : wal_request_route);
 	batch->approx_len = 0;
 	stailq_create(&batch->commit);
 	stailq_create(&batch->rollback);
@@ -238,7 +333,9 @@ wal_msg_create(struct wal_msg *batch)
 static struct wal_msg *
 wal_msg(struct cmsg *msg)
 {
-	return msg->route == wal_request_route ? (struct wal_msg *) msg : NULL;
+	return msg->route == wal_request_route ||
+	       msg->route == wal_pipelined_request_route ?
+	       (struct wal_msg *) msg : NULL;
 }
 
 /** Write a request to a log in a single transaction. */
@@ -418,14 +515,25 @@ tx_notify_checkpoint(struct cmsg *msg)
  */
 static void
 wal_writer_create(struct wal_writer *writer, enum wal_mode wal_mode,
+		  bool is_sync_pipelined, bool is_relay_before_sync,
 		  const char *wal_dirname, int64_t wal_max_size,
-		  double wal_retention_period,
+		  double wal_retention_period, int spare_count,
 		  const struct tt_uuid *instance_uuid,
 		  wal_on_garbage_collection_f on_garbage_collection,
 		  wal_on_checkpoint_threshold_f on_checkpoint_threshold)
 {
 	writer->wal_mode = wal_mode;
 	writer->wal_max_size = wal_max_size;
+	writer->is_sync_pipelined = is_sync_pipelined && wal_mode == WAL_FSYNC;
+	writer->is_relay_before_sync = is_relay_before_sync &&
+				       writer->is_sync_pipelined;
+	stailq_create(&writer->sync_queue);
+	writer->is_sync_in_progress = false;
+	writer->sync_fiber = NULL;
+	assert(spare_count >= 0 && spare_count <= WAL_SPARE_COUNT_MAX);
+	writer->spare_count = wal_mode == WAL_NONE ? 0 : spare_count;
+	memset(writer->spare_is_ready, 0, sizeof(writer->spare_is_ready));
+	writer->spare_fiber = NULL;
 
 	journal_create(&writer->base,
 		       wal_mode == WAL_NONE ?
@@ -435,6 +543,7 @@ wal_writer_create(struct wal_writer *writer, enum wal_mode wal_mode,
 
 	struct xlog_opts opts = xlog_opts_default;
 	opts.sync_is_async = true;
+	opts.build_index = true;
 	xdir_create(&writer->wal_dir, wal_dirname, XLOG, instance_uuid, &opts);
 	/*
 	 * wal_retention_period must be set before gc is woken up.
@@ -442,8 +551,14 @@ wal_writer_create(struct wal_writer *writer, enum wal_mode wal_mode,
 	 */
 	xdir_set_retention_period(&writer->wal_dir, wal_retention_period);
 	xlog_clear(&writer->current_wal);
-	if (wal_mode == WAL_FSYNC)
-		writer->wal_dir.open_wflags |= O_SYNC;
+	/*
+	 * Use O_DSYNC if available so that each batch is written and
+	 * synced with a single write without flushing metadata that
+	 * isn't needed to read the data back, like modification time.
+	 * With the pipelined sync, the data is synced by sync_fiber.
+	 */
+	if (wal_mode == WAL_FSYNC && !writer->is_sync_pipelined)
+		writer->wal_dir.open_wflags |= WAL_SYNC_FLAG;
 
 	stailq_create(&writer->rollback);
 	writer->is_in_rollback = false;
@@ -456,17 +571,53 @@ wal_writer_create(struct wal_writer *writer, enum wal_mode wal_mode,
 	vclock_create(&writer->checkpoint_vclock);
 	rlist_create(&writer->watchers);
 
+	tt_pthread_rwlock_init(&writer->buf.lock, NULL);
+	writer->buf.max_size = 0;
+	writer->buf.size = 0;
+	vclock_create(&writer->buf.vclock);
+	stailq_create(&writer->buf.entries);
+
 	writer->on_garbage_collection = on_garbage_collection;
 	writer->on_checkpoint_threshold = on_checkpoint_threshold;
 
 	mempool_create(&writer->msg_pool, &cord()->slabc,
 		       sizeof(struct wal_msg));
+	fiber_cond_create(&writer->sync_queue_cond);
+	fiber_cond_create(&writer->sync_done_cond);
+	fiber_cond_create(&writer->spare_cond);
+}
+
+/**
+ * Evict the oldest entries from the WAL buffer until its size fits
+ * in the limit. The buffer must be locked for writing.
+ */
+static void
+wal_buf_trim(struct wal_buf *buf)
+{
+	while (buf->size > buf->max_size) {
+		struct wal_buf_entry *entry = stailq_shift_entry(
+			&buf->entries, struct wal_buf_entry, in_buf);
+		vclock_copy(&buf->vclock, &entry->vclock);
+		buf->size -= entry->size;
+		free(entry);
+	}
 }
 
 /** Destroy a WAL writer structure. */
 static void
 wal_writer_destroy(struct wal_writer *writer)
 {
+	/*
+	 * The lock isn't destroyed, because relays may still be
+	 * running at exit.
+	 */
+	tt_pthread_rwlock_wrlock(&writer->buf.lock);
+	writer->buf.max_size = 0;
+	wal_buf_trim(&writer->buf);
+	tt_pthread_rwlock_unlock(&writer->buf.lock);
+	fiber_cond_destroy(&writer->sync_queue_cond);
+	fiber_cond_destroy(&writer->sync_done_cond);
+	fiber_cond_destroy(&writer->spare_cond);
 	xdir_destroy(&writer->wal_dir);
 }
 
@@ -544,17 +695,23 @@ wal_open(struct wal_writer *writer)
 }
 
 int
-wal_init(enum wal_mode wal_mode, const char *wal_dirname,
-	 int64_t wal_max_size, double wal_retention_period,
+wal_init(enum wal_mode wal_mode, bool is_sync_pipelined,
+	 bool is_relay_before_sync, const char *wal_dirname,
+	 int64_t wal_max_size, double wal_retention_period, int spare_count,
 	 const struct tt_uuid *instance_uuid,
+	 const struct tt_cpu_set *cpus,
 	 wal_on_garbage_collection_f on_garbage_collection,
 	 wal_on_checkpoint_threshold_f on_checkpoint_threshold)
 {
 	/* Initialize the state. */
 	struct wal_writer *writer = &wal_writer_singleton;
-	wal_writer_create(writer, wal_mode, wal_dirname, wal_max_size,
-			  wal_retention_period, instance_uuid,
+	wal_writer_create(writer, wal_mode, is_sync_pipelined,
+			  is_relay_before_sync, wal_dirname, wal_max_size,
+			  wal_retention_period, spare_count, instance_uuid,
 			  on_garbage_collection, on_checkpoint_threshold);
+	writer->cpu_set_is_set = cpus != NULL;
+	if (cpus != NULL)
+		writer->cpu_set = *cpus;
 
 	/* Start WAL thread. */
 	if (cord_costart(&writer->cord, "wal", wal_writer_f, NULL) != 0)
@@ -609,6 +766,20 @@ wal_free(void)
 	wal_writer_destroy(writer);
 }
 
+/**
+ * Wait until all written batches are synced and sent back to tx.
+ * Called by the WAL thread before closing the current WAL file and
+ * before replying to requests that expect all previous writes to be
+ * complete. No-op unless the sync is pipelined.
+ */
+static void
+wal_sync_queue_drain(struct wal_writer *writer)
+{
+	while (!stailq_empty(&writer->sync_queue) ||
+	       writer->is_sync_in_progress)
+		fiber_cond_wait(&writer->sync_done_cond);
+}
+
 struct wal_vclock_msg {
     struct cbus_call_msg base;
     struct vclock vclock;
@@ -619,6 +790,7 @@ wal_sync_f(struct cbus_call_msg *data)
 {
 	struct wal_vclock_msg *msg = (struct wal_vclock_msg *) data;
 	struct wal_writer *writer = &wal_writer_singleton;
+	wal_sync_queue_drain(writer);
 	if (writer->is_in_rollback) {
 		/* We're rolling back a failed write. */
 		diag_set(ClientError, ER_CASCADE_ROLLBACK);
@@ -674,6 +846,7 @@ wal_begin_checkpoint_f(struct cbus_call_msg *data)
 {
 	struct wal_checkpoint *msg = (struct wal_checkpoint *) data;
 	struct wal_writer *writer = &wal_writer_singleton;
+	wal_sync_queue_drain(writer);
 	if (writer->is_in_rollback) {
 		/*
 		 * We're rolling back a failed write and so
@@ -787,6 +960,186 @@ wal_set_checkpoint_threshold(int64_t threshold)
 		  wal_set_checkpoint_threshold_f);
 }
 
+struct wal_set_compression_msg {
+	struct cbus_call_msg base;
+	bool is_enabled;
+};
+
+static int
+wal_set_compression_f(struct cbus_call_msg *data)
+{
+	struct wal_writer *writer = &wal_writer_singleton;
+	struct wal_set_compression_msg *msg;
+	msg = (struct wal_set_compression_msg *)data;
+	writer->wal_dir.opts.no_compression = !msg->is_enabled;
+	/*
+	 * Apply the new setting to the current WAL file as well.
+	 * It's safe, because every write is a self-contained block
+	 * which is either compressed or not.
+	 */
+	writer->current_wal.opts.no_compression = !msg->is_enabled;
+	return 0;
+}
+
+void
+wal_set_compression(bool is_enabled)
+{
+	struct wal_writer *writer = &wal_writer_singleton;
+	if (writer->wal_mode == WAL_NONE)
+		return;
+	struct wal_set_compression_msg msg;
+	msg.is_enabled = is_enabled;
+	cbus_call(&writer->wal_pipe, &writer->tx_prio_pipe, &msg.base,
+		  wal_set_compression_f);
+}
+
+struct wal_set_relay_buffer_size_msg {
+	struct cbus_call_msg base;
+	size_t size;
+};
+
+static int
+wal_set_relay_buffer_size_f(struct cbus_call_msg *data)
+{
+	struct wal_writer *writer = &wal_writer_singleton;
+	struct wal_set_relay_buffer_size_msg *msg;
+	msg = (struct wal_set_relay_buffer_size_msg *)data;
+	tt_pthread_rwlock_wrlock(&writer->buf.lock);
+	writer->buf.max_size = msg->size;
+	wal_buf_trim(&writer->buf);
+	tt_pthread_rwlock_unlock(&writer->buf.lock);
+	return 0;
+}
+
+void
+wal_set_relay_buffer_size(int64_t size)
+{
+	struct wal_writer *writer = &wal_writer_singleton;
+	if (writer->wal_mode == WAL_NONE)
+		return;
+	struct wal_set_relay_buffer_size_msg msg;
+	msg.size = size;
+	cbus_call(&writer->wal_pipe, &writer->tx_prio_pipe, &msg.base,
+		  wal_set_relay_buffer_size_f);
+}
+
+/**
+ * Encode rows of journal entries written to the current WAL file
+ * into a new WAL buffer entry. Returns NULL on memory allocation
+ * error.
+ */
+static struct wal_buf_entry *
+wal_buf_entry_new(struct wal_writer *writer, struct stailq *entries)
+{
+	struct journal_entry *entry;
+	int row_count = 0;
+	stailq_foreach_entry(entry, entries, fifo)
+		row_count += entry->n_rows;
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	struct iovec *iov = xregion_alloc_array(region, struct iovec,
+						row_count * XROW_IOVMAX);
+	int iovcnt = 0;
+	size_t size = 0;
+	stailq_foreach_entry(entry, entries, fifo) {
+		for (int i = 0; i < entry->n_rows; i++) {
+			int row_iovcnt;
+			xrow_header_encode(entry->rows[i], /*sync=*/0,
+					   /*fixheader_len=*/0, iov + iovcnt,
+					   &row_iovcnt);
+			for (int j = iovcnt; j < iovcnt + row_iovcnt; j++)
+				size += iov[j].iov_len;
+			iovcnt += row_iovcnt;
+		}
+	}
+	struct wal_buf_entry *buf_entry =
+		(struct wal_buf_entry *)malloc(sizeof(*buf_entry) + size);
+	if (buf_entry == NULL) {
+		say_warn("failed to allocate WAL buffer entry");
+		region_truncate(region, region_svp);
+		return NULL;
+	}
+	char *data = buf_entry->data;
+	for (int i = 0; i < iovcnt; i++) {
+		memcpy(data, iov[i].iov_base, iov[i].iov_len);
+		data += iov[i].iov_len;
+	}
+	region_truncate(region, region_svp);
+	vclock_copy(&buf_entry->vclock, &writer->vclock);
+	buf_entry->file_signature =
+		vclock_sum(&writer->current_wal.meta.vclock);
+	buf_entry->size = size;
+	return buf_entry;
+}
+
+/**
+ * Append rows of journal entries written to the current WAL file to
+ * the WAL buffer. @vclock is the vclock preceding the first row.
+ */
+static void
+wal_buf_append(struct wal_writer *writer, struct stailq *entries,
+	       const struct vclock *vclock, size_t approx_len)
+{
+	struct wal_buf *buf = &writer->buf;
+	if (buf->max_size == 0)
+		return;
+	/*
+	 * Don't bother encoding a batch that doesn't fit in the
+	 * buffer: it would be evicted right away.
+	 */
+	struct wal_buf_entry *buf_entry = NULL;
+	if (approx_len <= buf->max_size)
+		buf_entry = wal_buf_entry_new(writer, entries);
+	tt_pthread_rwlock_wrlock(&buf->lock);
+	if (buf_entry != NULL) {
+		if (stailq_empty(&buf->entries))
+			vclock_copy(&buf->vclock, vclock);
+		stailq_add_tail_entry(&buf->entries, buf_entry, in_buf);
+		buf->size += buf_entry->size;
+		wal_buf_trim(buf);
+	} else {
+		/*
+		 * Drop all buffered rows so as not to leave a gap
+		 * in the buffer.
+		 */
+		size_t max_size = buf->max_size;
+		buf->max_size = 0;
+		wal_buf_trim(buf);
+		buf->max_size = max_size;
+	}
+	tt_pthread_rwlock_unlock(&buf->lock);
+}
+
+int
+wal_buf_read(const struct vclock *vclock, struct ibuf *out)
+{
+	struct wal_buf *buf = &wal_writer_singleton.buf;
+	int rc = -1;
+	tt_pthread_rwlock_rdlock(&buf->lock);
+	/*
+	 * An empty buffer may lag behind WAL files if it was just
+	 * enabled so the rows are read from files in this case.
+	 */
+	if (stailq_empty(&buf->entries) ||
+	    vclock_compare_ignore0(&buf->vclock, vclock) > 0)
+		goto out;
+	struct wal_buf_entry *entry;
+	stailq_foreach_entry(entry, &buf->entries, in_buf) {
+		/* Skip entries that have already been read. */
+		if (vclock_compare_ignore0(&entry->vclock, vclock) <= 0)
+			continue;
+		struct wal_buf_batch *batch = (struct wal_buf_batch *)
+			xibuf_alloc(out, sizeof(*batch) + entry->size);
+		batch->file_signature = entry->file_signature;
+		batch->size = entry->size;
+		memcpy(batch + 1, entry->data, entry->size);
+	}
+	rc = 0;
+out:
+	tt_pthread_rwlock_unlock(&buf->lock);
+	return rc;
+}
+
 void
 wal_set_queue_max_size(int64_t size)
 {
@@ -895,6 +1248,145 @@ wal_collect_garbage(const struct vclock *vclock)
 static void
 wal_notify_watchers(struct wal_writer *writer, unsigned events);
 
+/* {{{ Spare WAL files. */
+
+/**
+ * Formats the path of the spare WAL file in the given slot. The name
+ * has the .inprogress suffix so that spare files are never mistaken
+ * for WAL files and are removed along with other temporary files.
+ */
+static void
+wal_spare_path(struct wal_writer *writer, int slot, char *buf, size_t size)
+{
+	snprintf(buf, size, "%s/spare-%d%s%s", writer->wal_dir.dirname,
+		 slot, writer->wal_dir.filename_ext, inprogress_suffix);
+}
+
+static ssize_t
+wal_create_spare_cb(va_list ap)
+{
+	const char *path = va_arg(ap, const char *);
+	size_t size = va_arg(ap, size_t);
+	return xlog_create_spare(path, size);
+}
+
+/**
+ * Spare fiber of the WAL thread. Keeps box.cfg.wal_spare_files empty
+ * files with wal_max_size bytes of disk space preallocated so that on
+ * rotation a new WAL file is created with rename() and doesn't need
+ * fallocate() until it's full. The files are created in the coio
+ * thread pool not to stall writes.
+ */
+static int
+wal_spare_f(va_list ap)
+{
+	(void)ap;
+	struct wal_writer *writer = &wal_writer_singleton;
+	char path[PATH_MAX];
+	/* Remove the files left by a previous run with more slots. */
+	for (int i = writer->spare_count; i < WAL_SPARE_COUNT_MAX; i++) {
+		wal_spare_path(writer, i, path, sizeof(path));
+		if (coio_unlink(path) != 0 && errno != ENOENT)
+			say_syserror("failed to remove %s", path);
+	}
+	while (!fiber_is_cancelled()) {
+		int i = 0;
+		while (i < writer->spare_count && writer->spare_is_ready[i])
+			i++;
+		if (i == writer->spare_count) {
+			fiber_cond_wait(&writer->spare_cond);
+			continue;
+		}
+		wal_spare_path(writer, i, path, sizeof(path));
+		if (coio_call(wal_create_spare_cb, path,
+			      (size_t)writer->wal_max_size) != 0) {
+			diag_log();
+			fiber_sleep(WAL_SPARE_RETRY_DELAY);
+			continue;
+		}
+		writer->spare_is_ready[i] = true;
+	}
+	return 0;
+}
+
+/** Starts the spare fiber unless it's already running or disabled. */
+static void
+wal_spare_start(struct wal_writer *writer)
+{
+	if (writer->spare_count == 0 || writer->spare_fiber != NULL)
+		return;
+	writer->spare_fiber = fiber_new_system("wal_spare", wal_spare_f);
+	if (writer->spare_fiber == NULL) {
+		diag_log();
+		writer->spare_count = 0;
+		return;
+	}
+	fiber_set_joinable(writer->spare_fiber, true);
+	fiber_start(writer->spare_fiber);
+}
+
+/**
+ * Removes a spare file that is ready for use to free disk space.
+ * Returns false if there's no such file.
+ */
+static bool
+wal_spare_remove(struct wal_writer *writer)
+{
+	for (int i = 0; i < writer->spare_count; i++) {
+		if (!writer->spare_is_ready[i])
+			continue;
+		writer->spare_is_ready[i] = false;
+		char path[PATH_MAX];
+		wal_spare_path(writer, i, path, sizeof(path));
+		if (unlink(path) != 0 && errno != ENOENT)
+			say_syserror("failed to remove %s", path);
+		return true;
+	}
+	return false;
+}
+
+/** Stops the spare fiber and removes the spare files. */
+static void
+wal_spare_stop(struct wal_writer *writer)
+{
+	if (writer->spare_fiber == NULL)
+		return;
+	fiber_cancel(writer->spare_fiber);
+	fiber_join(writer->spare_fiber);
+	writer->spare_fiber = NULL;
+	while (wal_spare_remove(writer))
+		;
+}
+
+/**
+ * Creates a new WAL file for the current vclock, from a spare file if
+ * there's one ready.
+ */
+static int
+wal_create_xlog(struct wal_writer *writer)
+{
+	wal_spare_start(writer);
+	for (int i = 0; i < writer->spare_count; i++) {
+		if (!writer->spare_is_ready[i])
+			continue;
+		writer->spare_is_ready[i] = false;
+		fiber_cond_signal(&writer->spare_cond);
+		char path[PATH_MAX];
+		wal_spare_path(writer, i, path, sizeof(path));
+		if (xdir_create_xlog_from_spare(&writer->wal_dir,
+						&writer->current_wal,
+						&writer->vclock, path,
+						writer->wal_max_size) == 0)
+			return 0;
+		diag_log();
+		break;
+	}
+	return xdir_create_xlog(&writer->wal_dir, &writer->current_wal,
+				&writer->vclock);
+}
+
+/* }}} Spare WAL files. */
+
 /**
  * If there is no current WAL, try to open it, and close the
  * previous WAL. We close the previous WAL only after opening
@@ -918,6 +1410,8 @@ wal_opt_rotate(struct wal_writer *writer)
 	 */
 	if (xlog_is_open(&writer->current_wal) &&
 	    writer->current_wal.offset >= writer->wal_max_size) {
+		/* Make sure all the written data is synced, see above. */
+		wal_sync_queue_drain(writer);
 		xdir_set_retention_vclock(
 			&writer->wal_dir, &writer->current_wal.meta.vclock);
 		wal_xlog_close(&writer->current_wal);
@@ -926,8 +1420,7 @@ wal_opt_rotate(struct wal_writer *writer)
 	if (xlog_is_open(&writer->current_wal))
 		return 0;
 
-	if (xdir_create_xlog(&writer->wal_dir, &writer->current_wal,
-			     &writer->vclock) != 0)
+	if (wal_create_xlog(writer) != 0)
 		return -1;
 	/*
 	 * Keep track of the new WAL vclock. Required for garbage
@@ -988,6 +1481,9 @@ wal_fallocate(struct wal_writer *writer, size_t len)
 	}
 	if (errno != ENOSPC)
 		goto error;
+	/* Spare files are the first to go, they hold no data. */
+	if (wal_spare_remove(writer))
+		goto retry;
 	if (!xdir_has_garbage(&writer->wal_dir, gc_lsn))
 		goto error;
 
@@ -1103,6 +1599,37 @@ wal_assign_lsn(struct vclock *vclock_diff, struct vclock *base,
 	(*end)->is_commit = true;
 }
 
+enum {
+	/**
+	 * Batches smaller than this are written with the best
+	 * compression level. Such a batch means that the WAL thread
+	 * keeps up with the load, so extra CPU time is affordable.
+	 */
+	WAL_COMPRESSION_SMALL_BATCH = 64 * 1024,
+	/**
+	 * Batches bigger than this are written with the fastest
+	 * compression level. Such a batch means that transactions
+	 * pile up in the queue while the WAL thread is busy.
+	 */
+	WAL_COMPRESSION_BIG_BATCH = 1024 * 1024,
+};
+
+/**
+ * Selects zstd compression level for a WAL batch. The batch size is
+ * used as a measure of the WAL queue depth, because a batch contains
+ * all transactions that were submitted while the previous batch was
+ * being written.
+ */
+static int
+wal_compression_level(size_t batch_len)
+{
+	if (batch_len < WAL_COMPRESSION_SMALL_BATCH)
+		return XLOG_COMPRESSION_LEVEL_DEFAULT + 2;
+	if (batch_len < WAL_COMPRESSION_BIG_BATCH)
+		return XLOG_COMPRESSION_LEVEL_DEFAULT;
+	return 1;
+}
+
 static void
 wal_write_to_disk(struct cmsg *msg)
 {
@@ -1115,6 +1642,10 @@ wal_write_to_disk(struct cmsg *msg)
 	if (stailq_empty(&wal_msg->commit))
 		panic("Attempted to write an empty batch to WAL");
 
+	/* The vclock preceding the batch, for the WAL buffer. */
+	struct vclock vclock_start;
+	vclock_copy(&vclock_start, &writer->vclock);
+
 	/*
 	 * Track all vclock changes made by this batch into
 	 * vclock_diff variable and then apply it into writers'
@@ -1171,6 +1702,7 @@ wal_write_to_disk(struct cmsg *msg)
 	 */
 
 	struct xlog *l = &writer->current_wal;
+	l->opts.compression_level = wal_compression_level(wal_msg->approx_len);
 
 	/*
 	 * Iterate over requests (transactions)
@@ -1201,6 +1733,7 @@ wal_write_to_disk(struct cmsg *msg)
 	writer->checkpoint_wal_size += rc;
 	last_committed = stailq_last(&wal_msg->commit);
 	vclock_merge(&writer->vclock, &vclock_diff);
+	USDT_PROBE(wal_batch_written, wal_msg, vclock_sum(&writer->vclock));
 
 	/*
 	 * Notify TX if the checkpoint threshold has been exceeded.
@@ -1258,10 +1791,73 @@ wal_write_to_disk(struct cmsg *msg)
 	} else {
 		assert(err_code == JOURNAL_ENTRY_ERR_UNKNOWN);
 	}
+	if (!stailq_empty(&wal_msg->commit)) {
+		wal_buf_append(writer, &wal_msg->commit, &vclock_start,
+			       wal_msg->approx_len);
+	}
+	if (writer->is_sync_pipelined) {
+		/*
+		 * The batch is sent to tx once the data is synced.
+		 * Watchers are notified then too, unless relays may
+		 * send the data before it's synced.
+		 */
+		stailq_add_tail_entry(&writer->sync_queue, msg, fifo);
+		fiber_cond_signal(&writer->sync_queue_cond);
+		if (writer->is_relay_before_sync)
+			wal_notify_watchers(writer, WAL_EVENT_WRITE);
+		return;
+	}
 	wal_notify_watchers(writer, WAL_EVENT_WRITE);
 	ERROR_INJECT_SLEEP(ERRINJ_RELAY_FASTER_THAN_TX);
 }
 
+/**
+ * Sync fiber of the WAL thread used if the sync is pipelined. Syncs
+ * the current WAL file and sends all batches written before the sync
+ * back to tx, in order. While the file is being synced, the WAL thread
+ * keeps writing new batches so that they can be synced at once on the
+ * next iteration, which makes groups larger when the disk is slow.
+ */
+static int
+wal_sync_queue_f(va_list ap)
+{
+	(void)ap;
+	struct wal_writer *writer = &wal_writer_singleton;
+	while (!fiber_is_cancelled()) {
+		if (stailq_empty(&writer->sync_queue)) {
+			fiber_cond_wait(&writer->sync_queue_cond);
+			continue;
+		}
+		struct stailq queue;
+		stailq_create(&queue);
+		stailq_concat(&queue, &writer->sync_queue);
+		writer->is_sync_in_progress = true;
+		/*
+		 * The WAL file can't be closed while the sync is in
+		 * progress, see wal_sync_queue_drain(). A failed sync
+		 * leaves the page cache in unknown state so the written
+		 * data can't be either acknowledged or rolled back.
+		 */
+		struct xlog *l = &writer->current_wal;
+		if (xlog_is_open(l) && coio_fdatasync(l->fd) < 0)
+			panic_syserror("failed to sync WAL file '%s'",
+				       l->filename);
+		writer->is_sync_in_progress = false;
+		USDT_PROBE(wal_batch_synced, vclock_sum(&writer->vclock));
+		while (!stailq_empty(&queue)) {
+			struct cmsg *msg = stailq_shift_entry(&queue,
+							      struct cmsg,
+							      fifo);
+			msg->hop++;
+			cpipe_push(&writer->tx_prio_pipe, msg);
+		}
+		if (!writer->is_relay_before_sync)
+			wal_notify_watchers(writer, WAL_EVENT_WRITE);
+		fiber_cond_broadcast(&writer->sync_done_cond);
+	}
+	return 0;
+}
+
 /** WAL writer main loop.  */
 static int
 wal_writer_f(va_list ap)
@@ -1269,6 +1865,10 @@ wal_writer_f(va_list ap)
 	(void) ap;
 	struct wal_writer *writer = &wal_writer_singleton;
 
+	if (writer->cpu_set_is_set &&
+	    tt_cpu_set_bind_thread(&writer->cpu_set) != 0)
+		diag_log();
+
 	/** Initialize eio in this thread */
 	coio_enable();
 
@@ -1281,8 +1881,26 @@ wal_writer_f(va_list ap)
 	 */
 	cpipe_create(&writer->tx_prio_pipe, "tx_prio");
 
+	if (writer->is_sync_pipelined) {
+		writer->sync_fiber = fiber_new_system("wal_sync",
+						      wal_sync_queue_f);
+		if (writer->sync_fiber == NULL)
+			panic("failed to start WAL sync fiber");
+		fiber_set_joinable(writer->sync_fiber, true);
+		fiber_start(writer->sync_fiber);
+	}
+
 	cbus_loop(&endpoint);
 
+	wal_spare_stop(writer);
+
+	if (writer->sync_fiber != NULL) {
+		wal_sync_queue_drain(writer);
+		fiber_cancel(writer->sync_fiber);
+		fiber_join(writer->sync_fiber);
+		writer->sync_fiber = NULL;
+	}
+
 	/*
 	 * Create a new empty WAL on shutdown so that we don't
 	 * have to rescan the last WAL to find the instance vclock.
@@ -1379,6 +1997,7 @@ wal_write_async(struct journal *journal, struct journal_entry *entry)
 #ifndef NDEBUG
 	++errinj(ERRINJ_WAL_WRITE_COUNT, ERRINJ_INT)->iparam;
 #endif
+	USDT_PROBE(wal_entry_submit, entry, entry->n_rows, entry->approx_len);
 	cpipe_flush_input(&writer->wal_pipe);
 	return 0;
 
@@ -30,6 +30,7 @@
  * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
  * SUCH DAMAGE.
  */
+#include <stdbool.h>
 #include <stdint.h>
 #include <sys/types.h>
 #include "small/rlist.h"
@@ -38,8 +39,10 @@
 #include "vclock/vclock.h"
 
 struct fiber;
+struct ibuf;
 struct wal_writer;
 struct tt_uuid;
+struct tt_cpu_set;
 
 enum wal_mode {
 	/**
@@ -69,6 +72,8 @@ enum {
 	 * loop for the whole recovery stage.
 	 */
 	WAL_ROWS_PER_YIELD = 1 << 15,
+	/** Max number of spare WAL files, box.cfg.wal_spare_files. */
+	WAL_SPARE_COUNT_MAX = 16,
 };
 
 /** String constants for the supported modes. */
@@ -104,11 +109,24 @@ typedef void (*wal_on_checkpoint_threshold_f)(void);
 
 /**
  * Start WAL thread and initialize WAL writer.
+ *
+ * If is_sync_pipelined is set and the mode is WAL_FSYNC, a batch of
+ * requests written to disk is synced in background while the next
+ * batch is being written. If is_relay_before_sync is set too, relays
+ * are notified about a batch once it's written rather than synced.
+ *
+ * If spare_count isn't 0, the WAL thread keeps that many empty WAL
+ * files with wal_max_size bytes of disk space preallocated, so that
+ * a new WAL file can be created by renaming a spare one.
+ *
+ * If cpus isn't NULL, the WAL thread is bound to the given CPUs.
  */
 int
-wal_init(enum wal_mode wal_mode, const char *wal_dirname,
-	 int64_t wal_max_size, double wal_retention_period,
+wal_init(enum wal_mode wal_mode, bool is_sync_pipelined,
+	 bool is_relay_before_sync, const char *wal_dirname,
+	 int64_t wal_max_size, double wal_retention_period, int spare_count,
 	 const struct tt_uuid *instance_uuid,
+	 const struct tt_cpu_set *cpus,
 	 wal_on_garbage_collection_f on_garbage_collection,
 	 wal_on_checkpoint_threshold_f on_checkpoint_threshold);
 
@@ -260,6 +278,43 @@ wal_commit_checkpoint(struct wal_checkpoint *checkpoint);
 void
 wal_set_checkpoint_threshold(int64_t threshold);
 
+/**
+ * Enable or disable zstd compression of WAL writes. The new setting
+ * applies to the current WAL file starting from the next write.
+ */
+void
+wal_set_compression(bool is_enabled);
+
+/**
+ * Set the max size of the buffer of rows recently written to WAL,
+ * which relays read instead of WAL files, see wal_buf_read().
+ * Zero disables the buffer.
+ */
+void
+wal_set_relay_buffer_size(int64_t size);
+
+/** Header of a batch of rows copied by wal_buf_read(). */
+struct wal_buf_batch {
+	/** Signature of the WAL file the rows were written to. */
+	int64_t file_signature;
+	/** Size of the encoded rows following the header. */
+	size_t size;
+};
+
+/**
+ * Copy rows written to WAL after @vclock from the buffer of recently
+ * written rows to @out. The rows are copied in batches, each starting
+ * with struct wal_buf_batch followed by rows encoded as in xlog files.
+ * A batch may also contain rows preceding @vclock, which should be
+ * skipped by the reader. May be called from any thread.
+ *
+ * Returns 0 on success, -1 if the buffer is disabled or some rows
+ * following @vclock have already been evicted from it. In the latter
+ * case the rows have to be read from WAL files.
+ */
+int
+wal_buf_read(const struct vclock *vclock, struct ibuf *out);
+
 /**
  * Set the pending write limit in bytes. Once the limit is reached, new
  * writes are blocked until some previous writes succeed.
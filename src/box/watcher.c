@@ -50,8 +50,10 @@ watchable_node_new(struct watchable *watchable,
 	node->data = NULL;
 	node->data_end = NULL;
 	node->version = 0;
+	node->notify_time = -TIMEOUT_INFINITY;
 	rlist_create(&node->all_watchers);
 	rlist_create(&node->idle_watchers);
+	rlist_create(&node->in_delayed);
 	return node;
 }
 
@@ -63,6 +65,7 @@ watchable_node_delete(struct watchable_node *node)
 {
 	assert(rlist_empty(&node->all_watchers));
 	assert(rlist_empty(&node->idle_watchers));
+	rlist_del_entry(node, in_delayed);
 	free(node->data);
 	TRASH(node);
 	free(node);
@@ -172,21 +175,63 @@ watchable_schedule_watcher(struct watchable *watchable,
 
 /**
  * Schedules all idle watchers registered for the given node for execution.
+ *
+ * If the node watchers were notified less than watchable::notify_interval
+ * ago, the notification is delayed till the interval expires. Updates that
+ * happen meanwhile are coalesced: watchers will see only the latest data.
  */
 static void
 watchable_schedule_node(struct watchable *watchable,
 			struct watchable_node *node)
 {
 	assert(node->watchable == watchable);
+	if (rlist_empty(&node->idle_watchers))
+		return;
+	if (!rlist_empty(&node->in_delayed))
+		return;
+	double now = fiber_clock();
+	if (now < node->notify_time + watchable->notify_interval) {
+		rlist_add_tail_entry(&watchable->delayed_nodes, node,
+				     in_delayed);
+		watchable_wakeup_worker(watchable);
+		return;
+	}
+	node->notify_time = now;
 	/*
 	 * Always append to the list tail to guarantee that all watchers
 	 * eventually run no matter how often nodes are updated.
 	 */
-	if (!rlist_empty(&node->idle_watchers)) {
+	rlist_splice_tail(&watchable->pending_watchers, &node->idle_watchers);
+	watchable_wakeup_worker(watchable);
+}
+
+/**
+ * Schedules watchers of delayed nodes whose notification interval has
+ * expired. Returns the time left till the next delayed notification or
+ * TIMEOUT_INFINITY if there are no delayed nodes.
+ */
+static double
+watchable_schedule_delayed(struct watchable *watchable)
+{
+	double timeout = TIMEOUT_INFINITY;
+	if (rlist_empty(&watchable->delayed_nodes))
+		return timeout;
+	double now = fiber_clock();
+	struct watchable_node *node, *next_node;
+	rlist_foreach_entry_safe(node, &watchable->delayed_nodes,
+				 in_delayed, next_node) {
+		double deadline = node->notify_time +
+				  watchable->notify_interval;
+		if (now < deadline) {
+			timeout = MIN(timeout, deadline - now);
+			continue;
+		}
+		rlist_del_entry(node, in_delayed);
+		node->notify_time = now;
 		rlist_splice_tail(&watchable->pending_watchers,
 				  &node->idle_watchers);
-		watchable_wakeup_worker(watchable);
 	}
+	return timeout;
 }
 
 /**
@@ -267,10 +312,12 @@ watcher_ack(struct watcher *watcher)
 		return;
 	}
 	assert(watcher->version <= node->version);
-	if (watcher->version == node->version) {
+	if (watcher->version == node->version ||
+	    !rlist_empty(&node->in_delayed)) {
 		/*
-		 * There were no updates while the watcher was running.
-		 * Add it to the list of idle watchers.
+		 * There were no updates while the watcher was running or
+		 * the node notification is delayed. Add it to the list of
+		 * idle watchers.
 		 */
 		rlist_add_tail_entry(&node->idle_watchers, watcher,
 				     in_idle_or_pending);
@@ -353,9 +400,10 @@ watchable_worker_f(va_list ap)
 	assert(watchable->worker == fiber());
 	while (!fiber_is_cancelled()) {
 		fiber_check_gc();
+		double timeout = watchable_schedule_delayed(watchable);
 		if (!watchable_run(watchable)) {
 			/* No more watchers to run, wait... */
-			fiber_yield();
+			fiber_yield_timeout(timeout);
 		}
 	}
 	return 0;
@@ -366,6 +414,8 @@ watchable_create(struct watchable *watchable)
 {
 	watchable->node_by_key = mh_strnptr_new();
 	rlist_create(&watchable->pending_watchers);
+	watchable->notify_interval = 0;
+	rlist_create(&watchable->delayed_nodes);
 	watchable->worker = NULL;
 	watchable->is_shutdown = false;
 }
@@ -480,6 +530,15 @@ box_watch_once(const char *key, size_t key_len, const char **end)
 	return node->data;
 }
 
+void
+box_watcher_set_notify_interval(double interval)
+{
+	box_watchable.notify_interval = interval;
+	/* Let the worker reschedule delayed notifications. */
+	if (!rlist_empty(&box_watchable.delayed_nodes))
+		watchable_wakeup_worker(&box_watchable);
+}
+
 void
 box_watcher_init(void)
 {
@@ -126,6 +126,16 @@ struct watchable_node {
 	 * Linked by watcher::in_idle_or_pending.
 	 */
 	struct rlist idle_watchers;
+	/**
+	 * Time when idle watchers were last scheduled for execution on
+	 * a data update, see watchable::notify_interval.
+	 */
+	double notify_time;
+	/**
+	 * Link in watchable::delayed_nodes. Empty list head if the node
+	 * notification isn't delayed.
+	 */
+	struct rlist in_delayed;
 	/** Length of the notification key name. */
 	size_t key_len;
 	/**
@@ -152,6 +162,20 @@ struct watchable {
 	 * Linked by watcher::in_idle_or_pending.
 	 */
 	struct rlist pending_watchers;
+	/**
+	 * Minimal interval between two notifications about updates of
+	 * the same key, in seconds. If the data is updated more often,
+	 * the notification is delayed till the interval expires, and
+	 * watchers receive only the latest data. Zero means no limit.
+	 */
+	double notify_interval;
+	/**
+	 * List of nodes which were updated but whose notification is
+	 * delayed because of notify_interval.
+	 *
+	 * Linked by watchable_node::in_delayed.
+	 */
+	struct rlist delayed_nodes;
 	/** Background fiber that runs watcher callbacks. */
 	struct fiber *worker;
 	/** Set if watchable shutdown is started. */
@@ -281,6 +305,13 @@ box_broadcast_fmt(const char *key, const char *format, ...);
 const char *
 box_watch_once(const char *key, size_t key_len, const char **end);
 
+/**
+ * Sets the minimal interval between two notifications about updates of
+ * the same key, in seconds. Zero disables the limit.
+ */
+void
+box_watcher_set_notify_interval(double interval);
+
 void
 box_watcher_init(void);
 
@@ -32,6 +32,8 @@
 #include <dirent.h>
 #include <fcntl.h>
 #include <ctype.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include "fiber.h"
 #include "exception.h"
@@ -39,6 +41,7 @@
 #include "fio.h"
 #include <tarantool_eio.h>
 #include <msgpuck.h>
+#include <small/util.h>
 
 #include "coio_task.h"
 #include "tt_static.h"
@@ -49,6 +52,9 @@
 #include "salad/grp_alloc.h"
 #include "trivia/util.h"
 #include "retention_period.h"
+#include "memory.h"
+#include "clock.h"
+#include "tt_pthread.h"
 
 /*
  * FALLOC_FL_KEEP_SIZE flag has existed since fallocate() was
@@ -90,6 +96,11 @@ enum {
 	 * Maybe this should be a configuration option.
 	 */
 	XLOG_TX_COMPRESS_THRESHOLD = 2 * 1024,
+	/**
+	 * Alignment of file offsets, lengths and buffers used for
+	 * direct I/O.
+	 */
+	XLOG_DIO_ALIGN = 4096,
 };
 
 const struct xlog_opts xlog_opts_default = {
@@ -98,6 +109,9 @@ const struct xlog_opts xlog_opts_default = {
 	.free_cache = false,
 	.sync_is_async = false,
 	.no_compression = false,
+	.compression_level = XLOG_COMPRESSION_LEVEL_DEFAULT,
+	.direct_io = false,
+	.build_index = false,
 };
 
 /* {{{ struct xlog_meta */
@@ -116,6 +130,7 @@ enum {
 #define VCLOCK_KEY "VClock"
 #define VERSION_KEY "Version"
 #define PREV_VCLOCK_KEY "PrevVClock"
+#define PARTITIONS_KEY "Partitions"
 
 static const char v13[] = "0.13";
 static const char v12[] = "0.12";
@@ -136,6 +151,7 @@ xlog_meta_create(struct xlog_meta *meta, const char *filetype,
 		vclock_copy(&meta->prev_vclock, prev_vclock);
 	else
 		vclock_clear(&meta->prev_vclock);
+	meta->partition_count = 0;
 }
 
 /**
@@ -169,6 +185,10 @@ xlog_meta_format(const struct xlog_meta *meta, char *buf, int size)
 		SNPRINT(total, snprintf, buf, size, PREV_VCLOCK_KEY ": %s\n",
 			vclock_to_string(&meta->prev_vclock));
 	}
+	if (meta->partition_count > 0) {
+		SNPRINT(total, snprintf, buf, size, PARTITIONS_KEY ": %u\n",
+			(unsigned)meta->partition_count);
+	}
 	SNPRINT(total, snprintf, buf, size, "\n");
 	assert(total > 0);
 	return total;
@@ -310,6 +330,18 @@ xlog_meta_parse(struct xlog_meta *meta, const char **data,
 			 */
 			if (parse_vclock(val, val_end, &meta->prev_vclock) != 0)
 				return -1;
+		} else if (xlog_meta_key_equal(key, key_end, PARTITIONS_KEY)) {
+			/*
+			 * Partitions: <count>
+			 */
+			char *count_end;
+			unsigned long count = strtoul(val, &count_end, 10);
+			if (count_end != val_end || count > UINT32_MAX) {
+				diag_set(XlogError,
+					 "can't parse partition count");
+				return -1;
+			}
+			meta->partition_count = count;
 		} else if (xlog_meta_key_equal(key, key_end, VERSION_KEY)) {
 			/* Ignore Version: for now */
 		} else {
@@ -326,6 +358,186 @@ xlog_meta_parse(struct xlog_meta *meta, const char **data,
 
 /* struct xlog }}} */
 
+/* {{{ xlog seek index */
+
+/*
+ * The seek index of an xlog file is stored in a sidecar file
+ * named after the xlog file with the ".index" suffix appended.
+ * The sidecar starts with a magic string followed by a sequence
+ * of MsgPack entries [offset, {replica_id: lsn}], one per about
+ * XLOG_INDEX_STEP bytes of the xlog file. An entry means that
+ * a block starts at the given offset and the vclock of all rows
+ * stored in the file before it is less than or equal to the given
+ * vclock. Entries are appended while the xlog is written so that
+ * the current WAL file can be indexed, too. A torn tail entry is
+ * ignored by readers.
+ */
+
+enum {
+	/** Min distance between seek index entries, in bytes. */
+	XLOG_INDEX_STEP = 8 * 1024 * 1024,
+	/** Max size of a seek index entry. */
+	XLOG_INDEX_ENTRY_MAX = 16 + VCLOCK_MAX * 10,
+	/** Max size of a seek index file we agree to load. */
+	XLOG_INDEX_SIZE_MAX = 1024 * 1024,
+};
+
+static const char xlog_index_magic[] = "XLOG INDEX 1\n";
+
+/** Returns the name of the seek index file of an xlog file. */
+static const char *
+xlog_index_filename(const char *filename)
+{
+	return tt_snprintf(PATH_MAX, "%s.index", filename);
+}
+
+/**
+ * Creates the seek index file of a newly created xlog file.
+ * An existing index file, which may have been left from another
+ * xlog file with the same name, is truncated. Failures are only
+ * logged, because the index is optional.
+ */
+static void
+xlog_index_create(struct xlog *l)
+{
+	assert(l->index_fd < 0);
+	const char *filename = xlog_index_filename(l->filename);
+	int fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+		      0644);
+	if (fd < 0) {
+		say_syserror("failed to create seek index '%s'", filename);
+		return;
+	}
+	if (fio_writen(fd, xlog_index_magic,
+		       strlen(xlog_index_magic)) < 0) {
+		say_error("failed to write seek index '%s'", filename);
+		close(fd);
+		return;
+	}
+	l->index_fd = fd;
+	l->index_offset = l->offset;
+	vclock_create(&l->index_vclock);
+	vclock_create(&l->index_buf_vclock);
+}
+
+/** Closes the seek index file of an xlog, if any. */
+static void
+xlog_index_close(struct xlog *l)
+{
+	if (l->index_fd >= 0) {
+		close(l->index_fd);
+		l->index_fd = -1;
+	}
+}
+
+/**
+ * Appends an entry pointing to the current end of an xlog file to
+ * its seek index. On failure, stops writing the index: the entries
+ * that have been appended so far remain valid.
+ */
+static void
+xlog_index_add(struct xlog *l)
+{
+	assert(l->index_fd >= 0);
+	char buf[XLOG_INDEX_ENTRY_MAX];
+	char *data = buf;
+	data = mp_encode_array(data, 2);
+	data = mp_encode_uint(data, l->offset);
+	data = mp_encode_map(data, vclock_size(&l->index_vclock));
+	struct vclock_iterator it;
+	vclock_iterator_init(&it, &l->index_vclock);
+	vclock_foreach(&it, replica) {
+		data = mp_encode_uint(data, replica.id);
+		data = mp_encode_uint(data, replica.lsn);
+	}
+	assert(data <= buf + sizeof(buf));
+	if (fio_writen(l->index_fd, buf, data - buf) < 0) {
+		say_error("failed to write seek index of '%s'",
+			  l->filename);
+		xlog_index_close(l);
+		return;
+	}
+	l->index_offset = l->offset;
+}
+
+/** Decodes a seek index entry. Returns -1 if it's malformed. */
+static int
+xlog_index_decode_entry(const char **data, const char *end,
+			off_t *offset, struct vclock *vclock)
+{
+	const char *p = *data;
+	if (mp_check(&p, end) != 0 || mp_typeof(**data) != MP_ARRAY ||
+	    mp_decode_array(data) != 2 || mp_typeof(**data) != MP_UINT)
+		return -1;
+	uint64_t value = mp_decode_uint(data);
+	if (value > INT64_MAX || mp_typeof(**data) != MP_MAP)
+		return -1;
+	*offset = value;
+	vclock_create(vclock);
+	uint32_t size = mp_decode_map(data);
+	for (uint32_t i = 0; i < size; i++) {
+		if (mp_typeof(**data) != MP_UINT)
+			return -1;
+		uint64_t id = mp_decode_uint(data);
+		if (id >= VCLOCK_MAX || mp_typeof(**data) != MP_UINT)
+			return -1;
+		uint64_t lsn = mp_decode_uint(data);
+		if (lsn > INT64_MAX)
+			return -1;
+		vclock_reset(vclock, id, lsn);
+	}
+	return 0;
+}
+
+/**
+ * Looks up the seek index of an xlog file for the offset of the
+ * last block such that all the rows preceding it are less than or
+ * equal to @a vclock. Returns 0 if there's no such block or the
+ * index can't be read.
+ */
+static off_t
+xlog_index_lookup(const char *filename, const struct vclock *vclock)
+{
+	const char *index_filename = xlog_index_filename(filename);
+	int fd = open(index_filename, O_RDONLY | O_CLOEXEC);
+	if (fd < 0) {
+		if (errno != ENOENT)
+			say_syserror("failed to open seek index '%s'",
+				     index_filename);
+		return 0;
+	}
+	off_t offset = 0;
+	char *buf = NULL;
+	struct stat st;
+	if (fstat(fd, &st) < 0 || st.st_size > XLOG_INDEX_SIZE_MAX)
+		goto out;
+	buf = xmalloc(st.st_size + 1);
+	ssize_t size = fio_pread(fd, buf, st.st_size, 0);
+	size_t magic_len = strlen(xlog_index_magic);
+	if (size < (ssize_t)magic_len ||
+	    memcmp(buf, xlog_index_magic, magic_len) != 0)
+		goto out;
+	const char *data = buf + magic_len;
+	const char *end = buf + size;
+	while (data < end) {
+		off_t entry_offset;
+		struct vclock entry_vclock;
+		if (xlog_index_decode_entry(&data, end, &entry_offset,
+					    &entry_vclock) != 0)
+			break;
+		/* Entries are ordered, so stop at the first mismatch. */
+		if (vclock_compare(&entry_vclock, vclock) > 0)
+			break;
+		offset = entry_offset;
+	}
+out:
+	free(buf);
+	close(fd);
+	return offset;
+}
+
+/* }}} */
+
 /* {{{ struct xdir */
 
 void
@@ -683,12 +895,46 @@ xdir_format_filename(struct xdir *dir, int64_t signature,
 					      inprogress_suffix : "");
 }
 
+const char *
+xdir_format_partition_filename(struct xdir *dir, int64_t signature,
+			       uint32_t partition, enum log_suffix suffix)
+{
+	return tt_snprintf(PATH_MAX, "%s/%020lld.%u%s%s",
+			   dir->dirname, (long long)signature,
+			   (unsigned)partition, dir->filename_ext,
+			   suffix == INPROGRESS ? inprogress_suffix : "");
+}
+
+int
+xdir_foreach_partition(struct xdir *dir, int64_t signature,
+		       int (*cb)(const char *filename, void *arg), void *arg)
+{
+	for (uint32_t partition = 1; ; partition++) {
+		const char *filename = xdir_format_partition_filename(
+					dir, signature, partition, NONE);
+		if (access(filename, F_OK) != 0)
+			return 0;
+		int rc = cb(filename, arg);
+		if (rc != 0)
+			return rc;
+	}
+}
+
+/** Callback for removing partition files in xdir_collect_garbage(). */
+static int
+xdir_remove_partition_cb(const char *filename, void *arg)
+{
+	unsigned rm_flags = *(unsigned *)arg;
+	xlog_remove_file(filename, rm_flags);
+	return 0;
+}
+
 void
 xdir_collect_garbage(struct xdir *dir, int64_t signature, unsigned flags)
 {
 	unsigned rm_flags = XLOG_RM_VERBOSE;
 	if (flags & XDIR_GC_ASYNC)
-		rm_flags |= XLOG_RM_ASYNC;
+		rm_flags |= XLOG_RM_ASYNC | XLOG_RM_THROTTLE;
 
 	struct vclock retention_vclock;
 	retention_index_get(&dir->index, &retention_vclock);
@@ -713,6 +959,15 @@ xdir_collect_garbage(struct xdir *dir, int64_t signature, unsigned flags)
 		const char *filename =
 			xdir_format_filename(dir, vclock_sum(vclock), NONE);
 		xlog_remove_file(filename, rm_flags);
+		if (dir->opts.build_index) {
+			xlog_remove_file(xlog_index_filename(filename),
+					 rm_flags & XLOG_RM_ASYNC);
+		}
+		if (dir->type == SNAP) {
+			xdir_foreach_partition(dir, vclock_sum(vclock),
+					       xdir_remove_partition_cb,
+					       &rm_flags);
+		}
 		vclockset_remove(&dir->index, vclock);
 		free(vclock);
 		if (flags & XDIR_GC_REMOVE_ONE)
@@ -814,6 +1069,7 @@ xlog_init(struct xlog *xlog, const struct xlog_opts *opts)
 	xlog->opts = *opts;
 	xlog->sync_time = ev_monotonic_time();
 	xlog->is_autocommit = true;
+	xlog->index_fd = -1;
 	obuf_create(&xlog->obuf, &cord()->slabc, XLOG_TX_AUTOCOMMIT_THRESHOLD);
 	obuf_create(&xlog->zbuf, &cord()->slabc, XLOG_TX_AUTOCOMMIT_THRESHOLD);
 	if (!opts->no_compression) {
@@ -832,6 +1088,7 @@ xlog_clear(struct xlog *l)
 {
 	memset(l, 0, sizeof(*l));
 	l->fd = -1;
+	l->index_fd = -1;
 }
 
 /**
@@ -848,11 +1105,67 @@ xlog_free(struct xlog *xlog)
 	obuf_destroy(&xlog->zbuf);
 	ZSTD_freeCCtx(xlog->zctx);
 	xlog->zctx = NULL;
+	xlog_index_close(xlog);
+	if (xlog->dio_buf != NULL) {
+		slab_unmap(&runtime, xlog->dio_buf);
+		xlog->dio_buf = NULL;
+	}
 }
 
-int
-xlog_create(struct xlog *xlog, const char *name, int flags,
-	    const struct xlog_meta *meta, const struct xlog_opts *opts)
+/**
+ * Switches a newly created xlog file to direct I/O. The file must
+ * contain only the meta, which is passed in @meta_buf: its last
+ * incomplete block is copied to the direct I/O buffer so that it
+ * can be rewritten along with the first written rows.
+ *
+ * If the file system doesn't support direct I/O, the xlog falls
+ * back on buffered writes.
+ */
+static int
+xlog_enable_direct_io(struct xlog *xlog, const char *meta_buf, int meta_len)
+{
+#ifdef O_DIRECT
+	assert(xlog->dio_buf == NULL);
+	int flags = fcntl(xlog->fd, F_GETFL);
+	if (flags < 0 || fcntl(xlog->fd, F_SETFL, flags | O_DIRECT) < 0) {
+		if (errno != EINVAL) {
+			diag_set(SystemError, "failed to enable direct I/O "
+				 "for file '%s'", xlog->filename);
+			return -1;
+		}
+		say_warn("%s: direct I/O is not supported, "
+			 "proceeding without it", xlog->filename);
+		xlog->opts.direct_io = false;
+		return 0;
+	}
+	xlog->dio_buf = (char *)slab_map(&runtime);
+	if (xlog->dio_buf == NULL) {
+		diag_set(OutOfMemory, runtime.slab_size, "runtime arena",
+			 "direct I/O buffer");
+		return -1;
+	}
+	assert(runtime.slab_size % XLOG_DIO_ALIGN == 0);
+	xlog->dio_tail_len = meta_len % XLOG_DIO_ALIGN;
+	memcpy(xlog->dio_buf, meta_buf + meta_len - xlog->dio_tail_len,
+	       xlog->dio_tail_len);
+	return 0;
+#else /* !defined(O_DIRECT) */
+	(void)meta_buf;
+	(void)meta_len;
+	xlog->opts.direct_io = false;
+	return 0;
+#endif /* !defined(O_DIRECT) */
+}
+
+/**
+ * Creates a new xlog file. If @a spare isn't NULL, the file is
+ * created by renaming the spare file of @a spare_size preallocated
+ * bytes, see xlog_create_spare().
+ */
+static int
+xlog_create_impl(struct xlog *xlog, const char *name, int flags,
+		 const struct xlog_meta *meta, const struct xlog_opts *opts,
+		 const char *spare, size_t spare_size)
 {
 	char meta_buf[XLOG_META_LEN_MAX];
 	int meta_len;
@@ -881,7 +1194,23 @@ xlog_create(struct xlog *xlog, const char *name, int flags,
 		goto err;
 	}
 
-	flags |= O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC;
+	flags |= O_RDWR | O_CLOEXEC;
+	if (spare != NULL) {
+		/* rename() silently replaces the target, check it first. */
+		if (access(xlog->filename, F_OK) == 0) {
+			errno = EEXIST;
+			diag_set(SystemError, "file '%s' already exists",
+				 xlog->filename);
+			goto err_open;
+		}
+		if (rename(spare, xlog->filename) != 0) {
+			diag_set(SystemError, "failed to rename '%s' to '%s'",
+				 spare, xlog->filename);
+			goto err_open;
+		}
+	} else {
+		flags |= O_CREAT | O_EXCL;
+	}
 
 	/*
 	 * Open the <lsn>.<suffix>.inprogress file.
@@ -915,6 +1244,11 @@ xlog_create(struct xlog *xlog, const char *name, int flags,
 	}
 
 	xlog->offset = meta_len; /* first log starts after meta */
+	if (spare_size > (size_t)meta_len)
+		xlog->allocated = spare_size - meta_len;
+	if (opts->direct_io &&
+	    xlog_enable_direct_io(xlog, meta_buf, meta_len) != 0)
+		goto err_write;
 	return 0;
 err_write:
 	close(xlog->fd);
@@ -926,6 +1260,49 @@ xlog_create(struct xlog *xlog, const char *name, int flags,
 	return -1;
 }
 
+int
+xlog_create(struct xlog *xlog, const char *name, int flags,
+	    const struct xlog_meta *meta, const struct xlog_opts *opts)
+{
+	return xlog_create_impl(xlog, name, flags, meta, opts, NULL, 0);
+}
+
+int
+xlog_create_spare(const char *filename, size_t size)
+{
+	if (mkdirpath(filename) != 0) {
+		diag_set(SystemError, "failed to create path '%s'", filename);
+		return -1;
+	}
+	int fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+		      0644);
+	if (fd < 0) {
+		diag_set(SystemError, "failed to create file '%s'", filename);
+		return -1;
+	}
+#ifdef HAVE_FALLOCATE
+	/* Keep the file size, see xlog_fallocate(). */
+	if (fallocate(fd, FALLOC_FL_KEEP_SIZE, 0, size) != 0 &&
+	    errno != ENOSYS && errno != EOPNOTSUPP) {
+		diag_set(SystemError, "%s: can't allocate disk space",
+			 filename);
+		goto err;
+	}
+#else
+	(void)size;
+#endif /* HAVE_FALLOCATE */
+	if (fsync(fd) != 0) {
+		diag_set(SystemError, "%s: fsync failed", filename);
+		goto err;
+	}
+	close(fd);
+	return 0;
+err:
+	close(fd);
+	unlink(filename);
+	return -1;
+}
+
 int
 xlog_open(struct xlog *xlog, const char *name, const struct xlog_opts *opts)
 {
@@ -940,6 +1317,14 @@ xlog_open(struct xlog *xlog, const char *name, const struct xlog_opts *opts)
 
 	strlcpy(xlog->filename, name, sizeof(xlog->filename));
 
+	/*
+	 * The seek index is only written for newly created files.
+	 * Remove the stale one, because the file tail may have
+	 * been lost.
+	 */
+	if (opts->build_index)
+		xlog_remove_file(xlog_index_filename(name), 0);
+
 	xlog->fd = open(xlog->filename, O_RDWR | O_CLOEXEC);
 	if (xlog->fd < 0) {
 		say_syserror("open, [%s]", name);
@@ -1022,13 +1407,19 @@ xdir_touch_xlog(struct xdir *dir, const struct vclock *vclock)
  * In case of error, writes a message to the error log
  * and sets errno.
  */
-int
-xdir_create_xlog(struct xdir *dir, struct xlog *xlog,
-		 const struct vclock *vclock)
+/**
+ * Creates a new xlog file in the directory, from the spare file if
+ * @a spare isn't NULL, see xlog_create_impl().
+ */
+static int
+xdir_create_xlog_impl(struct xdir *dir, struct xlog *xlog,
+		      const struct vclock *vclock, uint32_t partition_count,
+		      const char *spare, size_t spare_size)
 {
 	int64_t signature = vclock_sum(vclock);
 	assert(signature >= 0);
 	assert(!tt_uuid_is_nil(dir->instance_uuid));
+	assert(partition_count == 0 || dir->type == SNAP);
 
 	/*
 	 * For WAL dir: store vclock of the previous xlog file
@@ -1041,10 +1432,11 @@ xdir_create_xlog(struct xdir *dir, struct xlog *xlog,
 	struct xlog_meta meta;
 	xlog_meta_create(&meta, dir->filetype, dir->instance_uuid,
 			 vclock, prev_vclock);
+	meta.partition_count = partition_count;
 
 	const char *filename = xdir_format_filename(dir, signature, NONE);
-	if (xlog_create(xlog, filename, dir->open_wflags, &meta,
-			&dir->opts) != 0)
+	if (xlog_create_impl(xlog, filename, dir->open_wflags, &meta,
+			     &dir->opts, spare, spare_size) != 0)
 		return -1;
 
 	/* Rename xlog file */
@@ -1053,6 +1445,86 @@ xdir_create_xlog(struct xdir *dir, struct xlog *xlog,
 		return -1;
 	}
 
+	if (xlog->opts.build_index && !xlog->is_inprogress)
+		xlog_index_create(xlog);
+	return 0;
+}
+
+int
+xdir_create_xlog(struct xdir *dir, struct xlog *xlog,
+		 const struct vclock *vclock)
+{
+	return xdir_create_xlog_impl(dir, xlog, vclock, 0, NULL, 0);
+}
+
+int
+xdir_create_xlog_from_spare(struct xdir *dir, struct xlog *xlog,
+			    const struct vclock *vclock,
+			    const char *spare, size_t spare_size)
+{
+	assert(dir->type == XLOG);
+	return xdir_create_xlog_impl(dir, xlog, vclock, 0, spare, spare_size);
+}
+
+int
+xdir_create_partitioned_xlog(struct xdir *dir, struct xlog *xlog,
+			     const struct vclock *vclock,
+			     uint32_t partition_count)
+{
+	return xdir_create_xlog_impl(dir, xlog, vclock, partition_count,
+				     NULL, 0);
+}
+
+int
+xdir_create_partition_xlog(struct xdir *dir, struct xlog *xlog,
+			   const struct vclock *vclock, uint32_t partition)
+{
+	assert(dir->type == SNAP);
+	assert(partition > 0);
+	int64_t signature = vclock_sum(vclock);
+	assert(signature >= 0);
+
+	struct xlog_meta meta;
+	xlog_meta_create(&meta, dir->filetype, dir->instance_uuid,
+			 vclock, NULL);
+
+	const char *filename = xdir_format_partition_filename(dir, signature,
+							      partition, NONE);
+	return xlog_create(xlog, filename, dir->open_wflags, &meta,
+			   &dir->opts);
+}
+
+int
+xdir_link_partition_xlog(struct xdir *dir, struct xlog *xlog,
+			 const struct vclock *vclock, uint32_t partition,
+			 int64_t base_signature)
+{
+	assert(dir->type == SNAP);
+	assert(partition > 0);
+	int64_t signature = vclock_sum(vclock);
+	assert(signature > base_signature);
+
+	char base_filename[PATH_MAX];
+	strlcpy(base_filename, xdir_format_partition_filename(
+			dir, base_signature, partition, NONE),
+		sizeof(base_filename));
+	const char *filename = xdir_format_partition_filename(dir, signature,
+							      partition, NONE);
+	if (access(filename, F_OK) == 0) {
+		errno = EEXIST;
+		diag_set(SystemError, "file '%s' already exists", filename);
+		return -1;
+	}
+	xlog_clear(xlog);
+	xlog->is_inprogress = true;
+	snprintf(xlog->filename, sizeof(xlog->filename), "%s%s",
+		 filename, inprogress_suffix);
+	if (link(base_filename, xlog->filename) != 0) {
+		diag_set(SystemError, "failed to link '%s' to '%s'",
+			 base_filename, xlog->filename);
+		xlog_clear(xlog);
+		return -1;
+	}
 	return 0;
 }
 
@@ -1091,6 +1563,87 @@ xlog_fallocate(struct xlog *log, size_t len)
 #endif /* HAVE_FALLOCATE */
 }
 
+/**
+ * Writes data at the current xlog offset with direct I/O.
+ *
+ * The data is appended to the incomplete block stored in the
+ * direct I/O buffer and written in aligned chunks. The last chunk
+ * is padded with zeros so the file size may exceed the offset of
+ * the end of the written data; the file is truncated when the EOF
+ * marker is written. The incomplete block at the end of the data
+ * is kept in the buffer for the next write.
+ *
+ * Returns 0 on success. On failure, sets diag and returns -1.
+ */
+static int
+xlog_write_direct(struct xlog *log, const struct iovec *iov, int iovcnt)
+{
+	assert(log->dio_buf != NULL);
+	size_t buf_size = runtime.slab_size;
+	off_t pos = log->offset - log->dio_tail_len;
+	size_t len = log->dio_tail_len;
+	bool tail_lost = false;
+	for (int i = 0; i < iovcnt; i++) {
+		const char *data = (const char *)iov[i].iov_base;
+		size_t size = iov[i].iov_len;
+		while (size > 0) {
+			size_t chunk = MIN(size, buf_size - len);
+			memcpy(log->dio_buf + len, data, chunk);
+			data += chunk;
+			size -= chunk;
+			len += chunk;
+			if (len < buf_size)
+				continue;
+			if (fio_pwriten(log->fd, log->dio_buf, len, pos) < 0)
+				goto error;
+			pos += len;
+			len = 0;
+			tail_lost = true;
+		}
+	}
+	size_t aligned_len = small_align(len, XLOG_DIO_ALIGN);
+	memset(log->dio_buf + len, 0, aligned_len - len);
+	if (aligned_len > 0 &&
+	    fio_pwriten(log->fd, log->dio_buf, aligned_len, pos) < 0)
+		goto error;
+	log->dio_tail_len = len % XLOG_DIO_ALIGN;
+	memmove(log->dio_buf, log->dio_buf + len - log->dio_tail_len,
+		log->dio_tail_len);
+	return 0;
+error:
+	diag_set(SystemError, "failed to write to '%s' file", log->filename);
+	if (tail_lost) {
+		/*
+		 * The incomplete block was overwritten in the buffer,
+		 * reread it from the file.
+		 */
+		off_t tail_pos = log->offset - log->dio_tail_len;
+		if (fio_pread(log->fd, log->dio_buf, XLOG_DIO_ALIGN,
+			      tail_pos) < (ssize_t)log->dio_tail_len)
+			panic_syserror("failed to restore xlog tail "
+				       "after write error");
+	}
+	return -1;
+}
+
+/**
+ * Writes data at the current xlog offset.
+ *
+ * Returns 0 on success. On failure, sets diag and returns -1.
+ */
+static int
+xlog_writev(struct xlog *log, const struct iovec *iov, int iovcnt)
+{
+	if (log->dio_buf != NULL)
+		return xlog_write_direct(log, iov, iovcnt);
+	if (fio_writevn(log->fd, (struct iovec *)iov, iovcnt) < 0) {
+		diag_set(SystemError, "failed to write to '%s' file",
+			 log->filename);
+		return -1;
+	}
+	return 0;
+}
+
 /**
  * Write a sequence of uncompressed xrow objects.
  *
@@ -1141,12 +1694,8 @@ xlog_tx_write_plain(struct xlog *log)
 		return -1;
 	});
 
-	ssize_t written = fio_writevn(log->fd, log->obuf.iov, log->obuf.pos + 1);
-	if (written < 0) {
-		diag_set(SystemError, "failed to write to '%s' file",
-			 log->filename);
+	if (xlog_writev(log, log->obuf.iov, log->obuf.pos + 1) != 0)
 		return -1;
-	}
 	return obuf_size(&log->obuf);
 }
 
@@ -1165,10 +1714,24 @@ xlog_tx_write_zstd(struct xlog *log)
 			 "compression buffer");
 		goto error;
 	}
+	/*
+	 * The context is missing if compression was enabled after
+	 * the xlog had been created, see xlog_opts::no_compression.
+	 */
+	if (log->zctx == NULL) {
+		log->zctx = ZSTD_createCCtx();
+		if (log->zctx == NULL) {
+			diag_set(ClientError, ER_COMPRESSION,
+				 "failed to create context");
+			goto error;
+		}
+	}
 	uint32_t crc32c = 0;
 	struct iovec *iov;
-	/* 3 is compression level. */
-	ZSTD_compressBegin(log->zctx, 3);
+	if (log->zcdict != NULL)
+		ZSTD_compressBegin_usingCDict(log->zctx, log->zcdict);
+	else
+		ZSTD_compressBegin(log->zctx, log->opts.compression_level);
 	size_t offset = XLOG_FIXHEADER_SIZE;
 	for (iov = log->obuf.iov; iov->iov_len; ++iov) {
 		/* Estimate max output buffer size. */
@@ -1234,14 +1797,9 @@ xlog_tx_write_zstd(struct xlog *log)
 		goto error;
 	});
 
-	ssize_t written;
-	written = fio_writevn(log->fd, log->zbuf.iov,
-			      log->zbuf.pos + 1);
-	if (written < 0) {
-		diag_set(SystemError, "failed to write to '%s' file",
-			 log->filename);
+	if (xlog_writev(log, log->zbuf.iov, log->zbuf.pos + 1) != 0)
 		goto error;
-	}
+	ssize_t written = obuf_size(&log->zbuf);
 	obuf_reset(&log->zbuf);
 	return written;
 error:
@@ -1262,6 +1820,9 @@ xlog_tx_write(struct xlog *log)
 {
 	if (obuf_size(&log->obuf) == XLOG_FIXHEADER_SIZE)
 		return 0;
+	if (log->index_fd >= 0 &&
+	    log->offset - log->index_offset >= XLOG_INDEX_STEP)
+		xlog_index_add(log);
 	ssize_t written;
 
 	if (!log->opts.no_compression &&
@@ -1286,6 +1847,7 @@ xlog_tx_write(struct xlog *log)
 		    ftruncate(log->fd, log->offset) != 0)
 			panic_syserror("failed to truncate xlog after write error");
 		log->allocated = 0;
+		vclock_copy(&log->index_buf_vclock, &log->index_vclock);
 		return -1;
 	}
 	if (log->allocated > (size_t)written)
@@ -1295,6 +1857,8 @@ xlog_tx_write(struct xlog *log)
 	log->offset += written;
 	log->rows += log->tx_rows;
 	log->tx_rows = 0;
+	if (log->index_fd >= 0)
+		vclock_copy(&log->index_vclock, &log->index_buf_vclock);
 	if ((log->opts.sync_interval && log->offset >=
 	    (off_t)(log->synced_size + log->opts.sync_interval)) ||
 	    (log->opts.rate_limit && log->offset >=
@@ -1390,6 +1954,11 @@ xlog_write_row(struct xlog *log, const struct xrow_header *packet)
 	region_truncate(&fiber()->gc, region_svp);
 	assert(iovcnt <= XROW_IOVMAX);
 	log->tx_rows++;
+	if (log->index_fd >= 0 && packet->lsn >
+	    vclock_get(&log->index_buf_vclock, packet->replica_id)) {
+		vclock_follow(&log->index_buf_vclock, packet->replica_id,
+			      packet->lsn);
+	}
 
 	size_t row_size = obuf_size(&log->obuf) - page_offset;
 	if (log->is_autocommit &&
@@ -1438,6 +2007,7 @@ xlog_tx_rollback(struct xlog *log)
 	log->is_autocommit = true;
 	log->tx_rows = 0;
 	obuf_reset(&log->obuf);
+	vclock_copy(&log->index_buf_vclock, &log->index_vclock);
 }
 
 /**
@@ -1514,6 +2084,21 @@ xlog_write_eof(struct xlog *l)
 		return -1;
 	}
 
+	if (l->dio_buf != NULL) {
+		struct iovec iov = {
+			.iov_base = (void *)&eof_marker,
+			.iov_len = sizeof(eof_marker),
+		};
+		if (xlog_write_direct(l, &iov, 1) != 0)
+			return -1;
+		/* Cut off the padding of the last block. */
+		if (ftruncate(l->fd, l->offset + sizeof(eof_marker)) < 0) {
+			diag_set(SystemError, "failed to truncate file '%s'",
+				 l->filename);
+			return -1;
+		}
+		return 0;
+	}
 	if (fio_writen(l->fd, &eof_marker, sizeof(eof_marker)) < 0) {
 		diag_set(SystemError, "failed to write to file '%s'",
 			 l->filename);
@@ -1531,6 +2116,16 @@ xlog_close_reuse_fd(struct xlog *l, int *fd)
 		rc = xlog_write_eof(l);
 	if (rc == 0)
 		rc = xlog_sync(l);
+#ifdef O_DIRECT
+	/* The caller may want to append to the file with write(). */
+	if (l->dio_buf != NULL &&
+	    (fcntl(l->fd, F_SETFL, fcntl(l->fd, F_GETFL) & ~O_DIRECT) < 0 ||
+	     lseek(l->fd, 0, SEEK_END) < 0) && rc == 0) {
+		diag_set(SystemError, "failed to disable direct I/O "
+			 "for file '%s'", l->filename);
+		rc = -1;
+	}
+#endif /* defined(O_DIRECT) */
 	*fd = l->fd;
 	l->fd = -1;
 	xlog_free(l);
@@ -1571,8 +2166,37 @@ enum {
 	 */
 	XLOG_READ_AHEAD_MIN = XLOG_TX_AUTOCOMMIT_THRESHOLD,
 	XLOG_READ_AHEAD_MAX = 8 * 1024 * 1024,
+	/**
+	 * Size of the file range ahead of the read position that the kernel
+	 * is asked to load into the page cache asynchronously.
+	 */
+	XLOG_PREFETCH_SIZE = 4 * XLOG_READ_AHEAD_MAX,
 };
 
+/**
+ * Asks the kernel to read the file ahead of the cursor in background so
+ * that disk reads overlap with processing of the rows read so far, e.g.
+ * application of WAL rows on recovery, and the following reads find the
+ * data in the page cache. The advice is renewed when the read position
+ * gets halfway through the previously requested range.
+ */
+static void
+xlog_cursor_prefetch(struct xlog_cursor *cursor)
+{
+#ifdef HAVE_POSIX_FADVISE
+	if (cursor->read_offset + XLOG_PREFETCH_SIZE / 2 <
+	    cursor->prefetch_offset)
+		return;
+	off_t offset = MAX(cursor->read_offset, cursor->prefetch_offset);
+	/* The advice is best effort, ignore errors. */
+	(void)posix_fadvise(cursor->fd, offset, XLOG_PREFETCH_SIZE,
+			    POSIX_FADV_WILLNEED);
+	cursor->prefetch_offset = offset + XLOG_PREFETCH_SIZE;
+#else
+	(void)cursor;
+#endif /* HAVE_POSIX_FADVISE */
+}
+
 /**
  * Ensure that at least count bytes are in read buffer
  *
@@ -1585,8 +2209,8 @@ xlog_cursor_ensure(struct xlog_cursor *cursor, size_t count)
 {
 	if (ibuf_used(&cursor->rbuf) >= count)
 		return 0;
-	/* in-memory mode */
-	if (cursor->fd < 0)
+	/* in-memory or mapped mode */
+	if (cursor->fd < 0 || cursor->map != NULL)
 		return 1;
 
 	size_t to_load = count - ibuf_used(&cursor->rbuf);
@@ -1632,6 +2256,7 @@ xlog_cursor_ensure(struct xlog_cursor *cursor, size_t count)
 		cursor->read_ahead = XLOG_READ_AHEAD_MIN;
 	}
 	cursor->read_offset += readen;
+	xlog_cursor_prefetch(cursor);
 	return ibuf_used(&cursor->rbuf) >= count ? 0: 1;
 }
 
@@ -1756,7 +2381,8 @@ xlog_fixheader_decode(struct xlog_fixheader *fixheader,
 
 int
 xlog_tx_decode(const char *data, const char *data_end,
-	       char *rows, char *rows_end, ZSTD_DStream *zdctx)
+	       char *rows, char *rows_end, ZSTD_DStream *zdctx,
+	       const ZSTD_DDict *zddict)
 {
 	/* Decode fixheader */
 	struct xlog_fixheader fixheader;
@@ -1795,7 +2421,8 @@ xlog_tx_decode(const char *data, const char *data_end,
 
 	/* Decompress zstd rows */
 	assert(fixheader.magic == zrow_marker);
-	ZSTD_initDStream(zdctx);
+	ZSTD_DCtx_reset(zdctx, ZSTD_reset_session_only);
+	ZSTD_DCtx_refDDict(zdctx, zddict);
 	int rc = xlog_cursor_decompress(&rows, rows_end, &data, data_end,
 					zdctx);
 	if (rc < 0) {
@@ -1846,17 +2473,15 @@ xlog_tx_cursor_create(struct xlog_tx_cursor *tx_cursor,
 	ibuf_create(&tx_cursor->rows, &cord()->slabc,
 		    XLOG_TX_AUTOCOMMIT_THRESHOLD);
 	if (fixheader.magic == row_marker) {
-		void *dst = ibuf_alloc(&tx_cursor->rows, fixheader.len);
-		if (dst == NULL) {
-			diag_set(OutOfMemory, fixheader.len,
-				 "runtime", "xlog rows buffer");
-			ibuf_destroy(&tx_cursor->rows);
-			return -1;
-		}
-		memcpy(dst, rpos, fixheader.len);
+		/*
+		 * The caller keeps the source data until the tx cursor is
+		 * destroyed, so decode rows in place instead of copying.
+		 */
+		tx_cursor->rpos = rpos;
+		tx_cursor->end = rpos + fixheader.len;
 		*data = (char *)rpos + fixheader.len;
 		assert(*data <= data_end);
-		tx_cursor->size = ibuf_used(&tx_cursor->rows);
+		tx_cursor->size = fixheader.len;
 		return 0;
 	};
 
@@ -1879,6 +2504,8 @@ xlog_tx_cursor_create(struct xlog_tx_cursor *tx_cursor,
 
 	*data = rpos;
 	assert(*data <= data_end);
+	tx_cursor->rpos = tx_cursor->rows.rpos;
+	tx_cursor->end = tx_cursor->rows.wpos;
 	tx_cursor->size = ibuf_used(&tx_cursor->rows);
 	return 0;
 }
@@ -1887,16 +2514,15 @@ int
 xlog_tx_cursor_next_row(struct xlog_tx_cursor *tx_cursor,
 		        struct xrow_header *xrow)
 {
-	if (ibuf_used(&tx_cursor->rows) == 0)
+	if (tx_cursor->rpos == tx_cursor->end)
 		return 1;
 	/* Return row from xlog tx buffer */
-	int rc = xrow_header_decode(xrow,
-				    (const char **)&tx_cursor->rows.rpos,
-				    (const char *)tx_cursor->rows.wpos, false);
+	int rc = xrow_header_decode(xrow, &tx_cursor->rpos, tx_cursor->end,
+				    false);
 	if (rc != 0) {
 		diag_set(XlogError, "can't parse row");
 		/* Discard remaining row data */
-		ibuf_reset(&tx_cursor->rows);
+		tx_cursor->rpos = tx_cursor->end;
 		return -1;
 	}
 
@@ -1907,10 +2533,10 @@ int
 xlog_tx_cursor_next_row_raw(struct xlog_tx_cursor *tx_cursor,
 			    const char ***data, const char **end)
 {
-	if (ibuf_used(&tx_cursor->rows) == 0)
+	if (tx_cursor->rpos == tx_cursor->end)
 		return 1;
-	*data = (const char **)&tx_cursor->rows.rpos;
-	*end = (const char *)tx_cursor->rows.wpos;
+	*data = &tx_cursor->rpos;
+	*end = tx_cursor->end;
 	return 0;
 }
 
@@ -1949,6 +2575,29 @@ xlog_cursor_find_tx_magic(struct xlog_cursor *i)
 	return 0;
 }
 
+enum {
+	/** Size of consumed file data released by a mapped cursor at once. */
+	XLOG_CURSOR_MAP_RELEASE_SIZE = 16 * 1024 * 1024,
+};
+
+/**
+ * Releases pages of a mapped file that precede the read position,
+ * so that the cursor doesn't keep the whole file resident.
+ */
+static void
+xlog_cursor_release_map(struct xlog_cursor *i)
+{
+	assert(i->map != NULL);
+	size_t pos = i->rbuf.rpos - i->map;
+	if (pos - i->map_released < XLOG_CURSOR_MAP_RELEASE_SIZE)
+		return;
+	size_t page_size = small_getpagesize();
+	size_t end = pos / page_size * page_size;
+	if (madvise(i->map + i->map_released, end - i->map_released,
+		    MADV_DONTNEED) == 0)
+		i->map_released = end;
+}
+
 int
 xlog_cursor_next_tx(struct xlog_cursor *i)
 {
@@ -1958,6 +2607,8 @@ xlog_cursor_next_tx(struct xlog_cursor *i)
 		i->state = XLOG_CURSOR_ACTIVE;
 		xlog_tx_cursor_destroy(&i->tx_cursor);
 	}
+	if (i->map != NULL)
+		xlog_cursor_release_map(i);
 	/* load at least magic to check eof */
 	rc = xlog_cursor_ensure(i, sizeof(log_magic_t));
 	if (rc < 0)
@@ -2097,6 +2748,21 @@ xlog_cursor_openfd(struct xlog_cursor *i, int fd, const char *name)
 	return -1;
 }
 
+void
+xlog_cursor_seek_vclock(struct xlog_cursor *i, const struct vclock *vclock)
+{
+	assert(i->state == XLOG_CURSOR_ACTIVE);
+	/* Seeking is only supported for files read with pread(). */
+	if (i->fd < 0 || i->map != NULL)
+		return;
+	off_t offset = xlog_index_lookup(i->name, vclock);
+	if (offset <= xlog_cursor_pos(i))
+		return;
+	ibuf_reset(&i->rbuf);
+	i->read_offset = offset;
+	i->prefetch_offset = offset;
+}
+
 int
 xlog_cursor_open(struct xlog_cursor *i, const char *name)
 {
@@ -2113,6 +2779,79 @@ xlog_cursor_open(struct xlog_cursor *i, const char *name)
 	return 0;
 }
 
+int
+xlog_cursor_openmap(struct xlog_cursor *i, const char *name)
+{
+	int fd = open(name, O_RDONLY);
+	if (fd < 0) {
+		diag_set(SystemError, "failed to open '%s' file", name);
+		return -1;
+	}
+	struct stat st;
+	if (fstat(fd, &st) < 0) {
+		diag_set(SystemError, "failed to stat '%s' file", name);
+		close(fd);
+		return -1;
+	}
+	/* Nothing to map, let the regular reader report the error. */
+	if (st.st_size == 0) {
+		int rc = xlog_cursor_openfd(i, fd, name);
+		if (rc < 0)
+			close(fd);
+		return rc;
+	}
+	/*
+	 * The mapping is private and writable so that in-place
+	 * modifications (e.g. by error injections) are copied on write
+	 * and never reach the file.
+	 */
+	char *map = (char *)mmap(NULL, st.st_size, PROT_READ | PROT_WRITE,
+				 MAP_PRIVATE, fd, 0);
+	if (map == MAP_FAILED) {
+		diag_set(SystemError, "failed to map '%s' file", name);
+		close(fd);
+		return -1;
+	}
+	(void)madvise(map, st.st_size, MADV_SEQUENTIAL);
+
+	memset(i, 0, sizeof(*i));
+	i->fd = fd;
+	i->map = map;
+	i->map_size = st.st_size;
+	/*
+	 * The read buffer never allocates memory in the mapped mode,
+	 * it just points to the file data.
+	 */
+	ibuf_create(&i->rbuf, &cord()->slabc,
+		    XLOG_TX_AUTOCOMMIT_THRESHOLD << 1);
+	i->rbuf.rpos = map;
+	i->rbuf.wpos = map + i->map_size;
+	i->read_offset = i->map_size;
+	int rc;
+	rc = xlog_meta_parse(&i->meta,
+			     (const char **)&i->rbuf.rpos,
+			     (const char *)i->rbuf.wpos);
+	if (rc < 0)
+		goto error;
+	if (rc > 0) {
+		diag_set(XlogError, "Unexpected end of file, run with 'force_recovery = true'");
+		goto error;
+	}
+	snprintf(i->name, sizeof(i->name), "%s", name);
+	i->zdctx = ZSTD_createDStream();
+	if (i->zdctx == NULL) {
+		diag_set(ClientError, ER_DECOMPRESSION,
+			 "failed to create context");
+		goto error;
+	}
+	i->state = XLOG_CURSOR_ACTIVE;
+	return 0;
+error:
+	munmap(map, i->map_size);
+	close(fd);
+	return -1;
+}
+
 int
 xlog_cursor_openmem(struct xlog_cursor *i, const char *data, size_t size,
 		    const char *name)
@@ -2161,7 +2900,12 @@ xlog_cursor_close(struct xlog_cursor *i, bool reuse_fd)
 	if (i->fd >= 0 && !reuse_fd)
 		close(i->fd);
 	assert(i->rbuf.slabc == &cord()->slabc);
-	ibuf_destroy(&i->rbuf);
+	if (i->map != NULL) {
+		munmap(i->map, i->map_size);
+		i->map = NULL;
+	} else {
+		ibuf_destroy(&i->rbuf);
+	}
 	if (i->state == XLOG_CURSOR_TX)
 		xlog_tx_cursor_destroy(&i->tx_cursor);
 	ZSTD_freeDStream(i->zdctx);
@@ -2177,6 +2921,197 @@ xlog_cursor_close(struct xlog_cursor *i, bool reuse_fd)
 
 /* {{{ xlog_remove_file */
 
+enum {
+	/** Size of a chunk freed by the reaper in one step. */
+	XLOG_REAPER_STEP = 4 * 1024 * 1024,
+};
+
+/** A file unlinked but not yet truncated by the reaper. */
+struct xlog_reaper_file {
+	/** Link in xlog_reaper::queue. */
+	struct stailq_entry in_queue;
+	/** Open descriptor of the file. */
+	int fd;
+	/** Size of the file left to truncate. */
+	off_t size;
+};
+
+/**
+ * File reaper.
+ *
+ * Freeing all extents of a big file at once may stall concurrent
+ * writes to the same file system, WAL syncs in particular. So when
+ * the rate limit is set, xlog_remove_file() called with
+ * XLOG_RM_THROTTLE unlinks a big file but keeps it open, and the
+ * reaper thread truncates the file in steps at the given rate before
+ * closing it. The file is gone from the directory right away.
+ */
+static struct {
+	/** Protects all the members below. */
+	pthread_mutex_t mutex;
+	/** Signaled on new files, rate change and stop. */
+	pthread_cond_t cond;
+	/** Files to truncate, the first one is being truncated. */
+	struct stailq queue;
+	/** Rate limit in bytes per second, 0 if there's no limit. */
+	double rate;
+	/** Set if the reaper thread is running. */
+	bool is_running;
+	/** Set when the reaper thread is told to stop. */
+	bool is_stopping;
+	/** Reaper thread. */
+	struct cord cord;
+} xlog_reaper = {
+	.mutex = PTHREAD_MUTEX_INITIALIZER,
+	.cond = PTHREAD_COND_INITIALIZER,
+};
+
+/** Closes a file without truncating it and frees its descriptor. */
+static void
+xlog_reaper_file_delete(struct xlog_reaper_file *file)
+{
+	close(file->fd);
+	free(file);
+}
+
+/** Reaper thread routine. */
+static void *
+xlog_reaper_f(void *arg)
+{
+	(void)arg;
+	/* Time when the next step may be done. */
+	double next_step_time = 0;
+	tt_pthread_mutex_lock(&xlog_reaper.mutex);
+	while (!xlog_reaper.is_stopping) {
+		if (stailq_empty(&xlog_reaper.queue)) {
+			tt_pthread_cond_wait(&xlog_reaper.cond,
+					     &xlog_reaper.mutex);
+			continue;
+		}
+		struct xlog_reaper_file *file = stailq_first_entry(
+			&xlog_reaper.queue, struct xlog_reaper_file, in_queue);
+		double now = clock_realtime();
+		if (xlog_reaper.rate > 0 && file->size > 0 &&
+		    now < next_step_time) {
+			struct timespec ts;
+			ts.tv_sec = (time_t)next_step_time;
+			ts.tv_nsec = (next_step_time - ts.tv_sec) * 1e9;
+			tt_pthread_cond_timedwait(&xlog_reaper.cond,
+						  &xlog_reaper.mutex, &ts);
+			continue;
+		}
+		if (xlog_reaper.rate == 0 || file->size == 0) {
+			stailq_shift(&xlog_reaper.queue);
+			tt_pthread_mutex_unlock(&xlog_reaper.mutex);
+			xlog_reaper_file_delete(file);
+			tt_pthread_mutex_lock(&xlog_reaper.mutex);
+			continue;
+		}
+		/* Only this thread touches the first file, drop the lock. */
+		off_t step = MIN(file->size, (off_t)XLOG_REAPER_STEP);
+		next_step_time = now + step / xlog_reaper.rate;
+		tt_pthread_mutex_unlock(&xlog_reaper.mutex);
+		file->size -= step;
+		if (ftruncate(file->fd, file->size) != 0) {
+			say_syserror("failed to truncate removed file");
+			file->size = 0;
+		}
+		tt_pthread_mutex_lock(&xlog_reaper.mutex);
+	}
+	/* Free the space left at once, there's no one to stall now. */
+	while (!stailq_empty(&xlog_reaper.queue)) {
+		xlog_reaper_file_delete(stailq_shift_entry(
+			&xlog_reaper.queue, struct xlog_reaper_file, in_queue));
+	}
+	tt_pthread_mutex_unlock(&xlog_reaper.mutex);
+	return NULL;
+}
+
+int
+xlog_reaper_start(void)
+{
+	assert(!xlog_reaper.is_running);
+	stailq_create(&xlog_reaper.queue);
+	xlog_reaper.is_stopping = false;
+	if (cord_start(&xlog_reaper.cord, "reaper", xlog_reaper_f,
+		       NULL) != 0)
+		return -1;
+	tt_pthread_mutex_lock(&xlog_reaper.mutex);
+	xlog_reaper.is_running = true;
+	tt_pthread_mutex_unlock(&xlog_reaper.mutex);
+	return 0;
+}
+
+void
+xlog_reaper_stop(void)
+{
+	if (!xlog_reaper.is_running)
+		return;
+	tt_pthread_mutex_lock(&xlog_reaper.mutex);
+	xlog_reaper.is_running = false;
+	xlog_reaper.is_stopping = true;
+	tt_pthread_cond_signal(&xlog_reaper.cond);
+	tt_pthread_mutex_unlock(&xlog_reaper.mutex);
+	if (cord_join(&xlog_reaper.cord) != 0)
+		panic_syserror("failed to join the reaper thread");
+}
+
+void
+xlog_reaper_set_rate(double rate)
+{
+	assert(rate >= 0);
+	tt_pthread_mutex_lock(&xlog_reaper.mutex);
+	xlog_reaper.rate = rate;
+	tt_pthread_cond_signal(&xlog_reaper.cond);
+	tt_pthread_mutex_unlock(&xlog_reaper.mutex);
+}
+
+/**
+ * Opens a file that is about to be removed so that the reaper can
+ * truncate it after it's unlinked. Returns NULL if the file should be
+ * just unlinked: the reaper isn't running, there's no rate limit, the
+ * file is small or can't be opened.
+ */
+static struct xlog_reaper_file *
+xlog_reaper_open(const char *filename)
+{
+	tt_pthread_mutex_lock(&xlog_reaper.mutex);
+	bool is_throttled = xlog_reaper.is_running && xlog_reaper.rate > 0;
+	tt_pthread_mutex_unlock(&xlog_reaper.mutex);
+	if (!is_throttled)
+		return NULL;
+	int fd = open(filename, O_WRONLY | O_CLOEXEC);
+	if (fd < 0)
+		return NULL;
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size <= XLOG_REAPER_STEP) {
+		close(fd);
+		return NULL;
+	}
+	struct xlog_reaper_file *file = xmalloc(sizeof(*file));
+	file->fd = fd;
+	file->size = st.st_size;
+	return file;
+}
+
+/**
+ * Passes an unlinked file to the reaper. If the reaper was stopped
+ * after the file was opened, closes the file right away.
+ */
+static void
+xlog_reaper_push(struct xlog_reaper_file *file)
+{
+	tt_pthread_mutex_lock(&xlog_reaper.mutex);
+	if (xlog_reaper.is_running) {
+		stailq_add_tail_entry(&xlog_reaper.queue, file, in_queue);
+		tt_pthread_cond_signal(&xlog_reaper.cond);
+		file = NULL;
+	}
+	tt_pthread_mutex_unlock(&xlog_reaper.mutex);
+	if (file != NULL)
+		xlog_reaper_file_delete(file);
+}
+
 /** xlog_remove_file() coio task. */
 struct xlog_remove_file_task {
 	/** Base class. */
@@ -2210,13 +3145,24 @@ xlog_remove_file_impl_f xlog_remove_file_impl = xlog_remove_file_impl_default;
 static bool
 xlog_remove_file_blocking(const char *filename, unsigned flags)
 {
+	struct xlog_reaper_file *file = NULL;
+	if ((flags & XLOG_RM_THROTTLE) != 0)
+		file = xlog_reaper_open(filename);
 	bool existed;
 	if (xlog_remove_file_impl(filename, &existed) != 0) {
+		if (file != NULL)
+			xlog_reaper_file_delete(file);
 		diag_log();
 		diag_clear(diag_get());
 		say_error("error while removing %s", filename);
 		return false;
 	}
+	if (file != NULL) {
+		if (existed)
+			xlog_reaper_push(file);
+		else
+			xlog_reaper_file_delete(file);
+	}
 	if (existed && (flags & XLOG_RM_VERBOSE) != 0)
 		say_info("removed %s", filename);
 	return true;
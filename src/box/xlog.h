@@ -80,8 +80,41 @@ struct xlog_opts {
 	 *
 	 * This option is useful for xlog files that are intended
 	 * to be read frequently, e.g. L1 run files in Vinyl.
+	 *
+	 * The flag may be changed on an open xlog. It affects the
+	 * writes that follow the change.
 	 */
 	bool no_compression;
+	/**
+	 * zstd compression level. Like no_compression, it may be
+	 * changed on an open xlog.
+	 */
+	int compression_level;
+	/**
+	 * If this flag is set, the xlog file is written with O_DIRECT
+	 * bypassing the page cache. Falls back on buffered writes if
+	 * the file system doesn't support direct I/O.
+	 *
+	 * The file size may exceed the size of written data by up to
+	 * one block until the xlog is closed so this option must only
+	 * be used for files that aren't read while being written,
+	 * e.g. memtx snapshots.
+	 */
+	bool direct_io;
+	/**
+	 * If this flag is set, a sparse seek index is written to
+	 * a sidecar file along with a newly created xlog file, see
+	 * xlog_cursor_seek_vclock().
+	 *
+	 * This option is useful for WAL files, which are reread
+	 * from the middle by relays and on recovery.
+	 */
+	bool build_index;
+};
+
+enum {
+	/** zstd compression level used by default. */
+	XLOG_COMPRESSION_LEVEL_DEFAULT = 3,
 };
 
 extern const struct xlog_opts xlog_opts_default;
@@ -230,6 +263,30 @@ const char *
 xdir_format_filename(struct xdir *dir, int64_t signature,
 		     enum log_suffix suffix);
 
+/**
+ * Return a name of a snapshot partition file based on vector
+ * clock sum, partition number (starting from 1) and a suffix
+ * (.inprogress or not). A partition file name looks like
+ * <signature>.<partition>.snap so partitions are never indexed
+ * by xdir_scan() as separate files.
+ */
+const char *
+xdir_format_partition_filename(struct xdir *dir, int64_t signature,
+			       uint32_t partition, enum log_suffix suffix);
+
+/**
+ * Call @a cb for each existing partition file of the snapshot
+ * with the given signature, in order of partition numbers.
+ * Stops at the first missing partition or if @a cb returns
+ * non-zero.
+ *
+ * @retval 0 if all the partitions were iterated
+ * @retval the last value returned by @a cb otherwise
+ */
+int
+xdir_foreach_partition(struct xdir *dir, int64_t signature,
+		       int (*cb)(const char *filename, void *arg), void *arg);
+
 /**
  * Return true if the given directory index has files whose
  * signature is less than specified.
@@ -260,7 +317,8 @@ xdir_has_garbage(struct xdir *dir, int64_t signature)
 enum {
 	/**
 	 * Delete files in coio threads so as not to block
-	 * the caller thread.
+	 * the caller thread. Disk space is freed at the rate
+	 * set with xlog_reaper_set_rate().
 	 */
 	XDIR_GC_ASYNC = 1 << 0,
 	/**
@@ -367,6 +425,13 @@ struct xlog_meta {
 	 * directory for missing WALs.
 	 */
 	struct vclock prev_vclock;
+	/**
+	 * Text file header: number of partition files the
+	 * snapshot data is split into. Zero means that all
+	 * the data is stored in this file.
+	 * @sa xdir_format_partition_filename().
+	 */
+	uint32_t partition_count;
 };
 
 /**
@@ -439,16 +504,40 @@ struct xlog {
 	struct obuf obuf;
 	/** The context of zstd compression */
 	ZSTD_CCtx *zctx;
+	/**
+	 * If set, compression uses this dictionary instead of
+	 * opts.compression_level. Set by the user, who owns it.
+	 */
+	ZSTD_CDict *zcdict;
 	/**
 	 * Compressed output buffer
 	 */
 	struct obuf zbuf;
+	/**
+	 * Aligned buffer used for direct I/O, see xlog_opts::direct_io.
+	 * Starts with the last incomplete block of the file, which is
+	 * rewritten with the next write.
+	 */
+	char *dio_buf;
+	/** Length of the incomplete block stored in @dio_buf. */
+	size_t dio_tail_len;
 	/**
 	 * Synced file size
 	 */
 	uint64_t synced_size;
 	/** Time when xlog wast synced last time */
 	double sync_time;
+	/**
+	 * Seek index file handle or -1 if the index isn't written,
+	 * see xlog_opts::build_index.
+	 */
+	int index_fd;
+	/** File offset of the last block recorded in the seek index. */
+	off_t index_offset;
+	/** Vclock of the rows written to the file. */
+	struct vclock index_vclock;
+	/** Vclock of the rows written to the file or buffered. */
+	struct vclock index_buf_vclock;
 };
 
 /**
@@ -482,6 +571,64 @@ int
 xdir_create_xlog(struct xdir *dir, struct xlog *xlog,
 		 const struct vclock *vclock);
 
+/**
+ * Same as xdir_create_xlog(), but instead of creating a new file,
+ * renames the spare file @a spare that has @a spare_size bytes of
+ * disk space preallocated, see xlog_create_spare(). The spare file
+ * must be on the same file system as the directory. On failure the
+ * spare file may be left as is or consumed.
+ *
+ * @retval 0 if OK
+ * @retval -1 if error
+ */
+int
+xdir_create_xlog_from_spare(struct xdir *dir, struct xlog *xlog,
+			    const struct vclock *vclock,
+			    const char *spare, size_t spare_size);
+
+/**
+ * Create a new snapshot file whose data is split into
+ * @a partition_count partitions. The number of partitions
+ * is stored in the file meta so that recovery knows how
+ * many partition files it has to read.
+ *
+ * @retval 0 if OK
+ * @retval -1 if error
+ */
+int
+xdir_create_partitioned_xlog(struct xdir *dir, struct xlog *xlog,
+			     const struct vclock *vclock,
+			     uint32_t partition_count);
+
+/**
+ * Create a new snapshot partition file. The file is always
+ * created with the .inprogress suffix, see xlog_materialize().
+ *
+ * @param partition     partition number, starting from 1
+ *
+ * @retval 0 if OK
+ * @retval -1 if error
+ */
+int
+xdir_create_partition_xlog(struct xdir *dir, struct xlog *xlog,
+			   const struct vclock *vclock, uint32_t partition);
+
+/**
+ * Create a new snapshot partition file as a hard link to the file
+ * @a partition of the snapshot with signature @a base_signature.
+ * Used when the partition data hasn't changed since that snapshot.
+ * Like xdir_create_partition_xlog(), the new file has the
+ * .inprogress suffix, but it isn't open: the xlog object may only
+ * be passed to xlog_materialize() or xlog_discard().
+ *
+ * @retval 0 if OK
+ * @retval -1 if error
+ */
+int
+xdir_link_partition_xlog(struct xdir *dir, struct xlog *xlog,
+			 const struct vclock *vclock, uint32_t partition,
+			 int64_t base_signature);
+
 /**
  * Create new xlog writer based on fd.
  * @param fd            file descriptor
@@ -498,6 +645,18 @@ int
 xlog_create(struct xlog *xlog, const char *name, int flags,
 	    const struct xlog_meta *meta, const struct xlog_opts *opts);
 
+/**
+ * Create an empty file @a filename with @a size bytes of disk space
+ * preallocated and sync it, so that it can be turned into a new xlog
+ * file later without allocating disk space on the write path, see
+ * xdir_create_xlog_from_spare(). The existing file is overwritten.
+ *
+ * @retval 0 success
+ * @retval -1 error
+ */
+int
+xlog_create_spare(const char *filename, size_t size);
+
 /**
  * Open an existing xlog file for appending.
  * @param xlog          xlog descriptor
@@ -643,8 +802,15 @@ xlog_discard(struct xlog *l);
  */
 struct xlog_tx_cursor
 {
-	/** rows buffer */
+	/**
+	 * Buffer for decompressed rows. Rows of an uncompressed tx are
+	 * decoded right from the source data and aren't copied here.
+	 */
 	struct ibuf rows;
+	/** Position of the next row to decode. */
+	const char *rpos;
+	/** End of the tx rows. */
+	const char *end;
 	/** tx size */
 	size_t size;
 };
@@ -706,7 +872,7 @@ xlog_tx_cursor_next_row_raw(struct xlog_tx_cursor *cursor,
 static inline off_t
 xlog_tx_cursor_pos(struct xlog_tx_cursor *tx_cursor)
 {
-	return tx_cursor->size - ibuf_used(&tx_cursor->rows);
+	return tx_cursor->size - (tx_cursor->end - tx_cursor->rpos);
 }
 
 /**
@@ -717,13 +883,15 @@ xlog_tx_cursor_pos(struct xlog_tx_cursor *tx_cursor)
  * @param data_end the end of @a data buffer
  * @param[out] rows a buffer to store decoded rows
  * @param[out] rows_end the end of @a rows buffer
+ * @param zdctx zstd decompression context
+ * @param zddict dictionary the data was compressed with or NULL
  * @retval  0 success
  * @retval -1 error, check diag
  */
 int
 xlog_tx_decode(const char *data, const char *data_end,
 	       char *rows, char *rows_end,
-	       ZSTD_DStream *zdctx);
+	       ZSTD_DStream *zdctx, const ZSTD_DDict *zddict);
 
 /* }}} */
 
@@ -764,10 +932,21 @@ struct xlog_cursor {
 	size_t read_ahead;
 	/** file read position */
 	off_t read_offset;
+	/** end of the file range the kernel was asked to read ahead */
+	off_t prefetch_offset;
 	/** cursor for current tx */
 	struct xlog_tx_cursor tx_cursor;
 	/** ZSTD context for decompression */
 	ZSTD_DStream *zdctx;
+	/**
+	 * File mapping if the cursor was opened with xlog_cursor_openmap(),
+	 * NULL otherwise. If set, the read buffer points to the mapping.
+	 */
+	char *map;
+	/** Size of the file mapping. */
+	size_t map_size;
+	/** Size of the mapping prefix already released to the OS. */
+	size_t map_released;
 };
 
 /**
@@ -814,6 +993,19 @@ xlog_cursor_openfd(struct xlog_cursor *cursor, int fd, const char *name);
 int
 xlog_cursor_open(struct xlog_cursor *cursor, const char *name);
 
+/**
+ * Open cursor from file mapped into memory. Unlike xlog_cursor_open(),
+ * file data isn't copied to the read buffer, and rows of uncompressed
+ * transactions point directly to the mapping. Memory of the consumed
+ * part of the file is released to the OS while the cursor advances.
+ * @param cursor cursor
+ * @param name file name
+ * @retval 0 succes
+ * @retval -1 error, check diag
+ */
+int
+xlog_cursor_openmap(struct xlog_cursor *cursor, const char *name);
+
 /**
  * Open cursor from memory
  * @param cursor cursor
@@ -894,6 +1086,20 @@ xlog_cursor_next(struct xlog_cursor *cursor,
 int
 xlog_cursor_find_tx_magic(struct xlog_cursor *i);
 
+/**
+ * Skip the part of the file that contains only rows preceding
+ * @a vclock (that is, rows whose LSNs don't exceed the matching
+ * components of @a vclock), using the seek index written along
+ * with the file, see xlog_opts::build_index. The cursor must be
+ * at a transaction boundary, e.g. just opened.
+ *
+ * This is an optimization: if there's no index or it's broken,
+ * the cursor position is left unchanged.
+ */
+void
+xlog_cursor_seek_vclock(struct xlog_cursor *cursor,
+			const struct vclock *vclock);
+
 /**
  * Cursor xlog position
  *
@@ -945,6 +1151,11 @@ enum {
 	XLOG_RM_VERBOSE = 1 << 0,
 	/** Remove file asynchronously. */
 	XLOG_RM_ASYNC = 1 << 1,
+	/**
+	 * Free disk space at the rate set with xlog_reaper_set_rate().
+	 * The file is unlinked right away but is truncated in background.
+	 */
+	XLOG_RM_THROTTLE = 1 << 2,
 };
 
 typedef int
@@ -974,6 +1185,30 @@ extern xlog_remove_file_impl_f xlog_remove_file_impl;
 bool
 xlog_remove_file(const char *filename, unsigned flags);
 
+/**
+ * Starts the reaper thread that frees disk space of files removed
+ * with XLOG_RM_THROTTLE. Until it's started, such files are removed
+ * as usual.
+ *
+ * Returns 0 on success. On failure sets diag and returns -1.
+ */
+int
+xlog_reaper_start(void);
+
+/**
+ * Stops the reaper thread. The disk space of the files it hasn't
+ * truncated yet is freed at once.
+ */
+void
+xlog_reaper_stop(void);
+
+/**
+ * Sets the rate at which the reaper frees disk space, in bytes per
+ * second. 0 means no limit. May be called from any thread.
+ */
+void
+xlog_reaper_set_rate(double rate);
+
 /** }}} */
 
 #if defined(__cplusplus)
@@ -158,24 +158,37 @@ xrow_header_decode(struct xrow_header *header, const char **pos,
 		   const char *end, bool end_is_exact)
 {
 	memset(header, 0, sizeof(struct xrow_header));
-	const char *tmp = *pos;
 	const char * const start = *pos;
-	if (mp_check(&tmp, end) != 0)
-		goto bad_header;
-	if (mp_typeof(**pos) != MP_MAP)
+	/*
+	 * The header is validated while it is decoded rather than with
+	 * a separate mp_check() pass: values of known keys are scalars
+	 * so it's enough to check that they fit in the buffer, and only
+	 * values of unknown keys need a full check.
+	 */
+	if (*pos >= end || mp_typeof(**pos) != MP_MAP ||
+	    mp_check_map(*pos, end) > 0)
 		goto bad_header;
 	header->header = start;
-	header->header_end = tmp;
 	bool has_tsn = false;
 	uint32_t flags = 0;
 
 	uint32_t size = mp_decode_map(pos);
 	for (uint32_t i = 0; i < size; i++) {
-		if (mp_typeof(**pos) != MP_UINT)
+		if (*pos >= end || mp_typeof(**pos) != MP_UINT ||
+		    mp_check_uint(*pos, end) > 0)
 			goto bad_header;
 		uint64_t key = mp_decode_uint(pos);
-		if (key < iproto_key_MAX &&
-		    iproto_key_type[key] != mp_typeof(**pos))
+		if (*pos >= end)
+			goto bad_header;
+		enum mp_type type = mp_typeof(**pos);
+		if (key < iproto_key_MAX && iproto_key_type[key] != type)
+			goto bad_header;
+		/*
+		 * Values of all known keys are either unsigned integers
+		 * or doubles, see iproto_key_type.
+		 */
+		if ((type == MP_UINT && mp_check_uint(*pos, end) > 0) ||
+		    (type == MP_DOUBLE && mp_check_double(*pos, end) > 0))
 			goto bad_header;
 		switch (key) {
 		case IPROTO_REQUEST_TYPE:
@@ -212,10 +225,12 @@ xrow_header_decode(struct xrow_header *header, const char **pos,
 			break;
 		default:
 			/* unknown header */
-			mp_next(pos);
+			if (mp_check(pos, end) != 0)
+				goto bad_header;
 		}
 	}
 	assert(*pos <= end);
+	header->header_end = *pos;
 	if (!has_tsn) {
 		/*
 		 * Transaction id is not set so it is a single statement
@@ -983,6 +998,27 @@ xrow_decode_dml_internal(struct xrow_header *row, struct request *request,
 			request->index_name =
 				mp_decode_str(&value, &request->index_name_len);
 			break;
+		case IPROTO_WAIT_VCLOCK:
+			request->wait_vclock = value;
+			request->wait_vclock_end = data;
+			break;
+		case IPROTO_TIMEOUT:
+			request->timeout = mp_decode_double(&value);
+			break;
+		case IPROTO_FIELDS:
+			request->fields = value;
+			request->fields_end = data;
+			break;
+		case IPROTO_FILTER:
+			request->filter = value;
+			request->filter_end = data;
+			break;
+		case IPROTO_ARROW: {
+			uint32_t len;
+			request->arrow = mp_decode_bin(&value, &len);
+			request->arrow_end = request->arrow + len;
+			break;
+		}
 		default:
 			break;
 		}
@@ -999,6 +1035,32 @@ xrow_decode_dml_internal(struct xrow_header *row, struct request *request,
 	return 0;
 }
 
+int
+request_decode_wait_vclock(const struct request *request,
+			   struct vclock *vclock)
+{
+	assert(request->wait_vclock != NULL);
+	const char *data = request->wait_vclock;
+	vclock_create(vclock);
+	uint32_t size = mp_decode_map(&data);
+	for (uint32_t i = 0; i < size; i++) {
+		if (mp_typeof(*data) != MP_UINT)
+			goto error;
+		uint64_t id = mp_decode_uint(&data);
+		if (mp_typeof(*data) != MP_UINT)
+			goto error;
+		uint64_t lsn = mp_decode_uint(&data);
+		if (id >= VCLOCK_MAX || lsn > INT64_MAX)
+			goto error;
+		if (id != 0)
+			vclock_reset(vclock, id, lsn);
+	}
+	return 0;
+error:
+	diag_set(ClientError, ER_INVALID_MSGPACK, "invalid wait vclock");
+	return -1;
+}
+
 static int
 request_snprint(char *buf, int size, const struct request *request)
 {
@@ -2062,6 +2124,11 @@ struct replication_request {
 	uint32_t *version_id;
 	/** IPROTO_REPLICA_ANON. */
 	bool *is_anon;
+	/** IPROTO_COMPRESSION. */
+	bool *is_compressed;
+	/** IPROTO_SPACE_FILTER. */
+	const char **space_filter;
+	const char **space_filter_end;
 };
 
 /** Encode a replication request template. */
@@ -2074,6 +2141,8 @@ xrow_encode_replication_request(struct xrow_header *row,
 	size_t size = XROW_BODY_LEN_MAX;
 	if (req->vclock != NULL)
 		size += mp_sizeof_vclock_ignore0(req->vclock);
+	if (req->space_filter != NULL && *req->space_filter != NULL)
+		size += *req->space_filter_end - *req->space_filter;
 	char *buf = xregion_alloc(&fiber()->gc, size);
 	/* Skip one byte for future map header. */
 	char *data = buf + 1;
@@ -2113,6 +2182,18 @@ xrow_encode_replication_request(struct xrow_header *row,
 		data = mp_encode_uint(data, IPROTO_REPLICA_ANON);
 		data = mp_encode_bool(data, *req->is_anon);
 	}
+	if (req->is_compressed != NULL && *req->is_compressed) {
+		++map_size;
+		data = mp_encode_uint(data, IPROTO_COMPRESSION);
+		data = mp_encode_str0(data, "zstd");
+	}
+	if (req->space_filter != NULL && *req->space_filter != NULL) {
+		++map_size;
+		size_t len = *req->space_filter_end - *req->space_filter;
+		data = mp_encode_uint(data, IPROTO_SPACE_FILTER);
+		memcpy(data, *req->space_filter, len);
+		data += len;
+	}
 	if (req->id_filter != NULL) {
 		++map_size;
 		uint32_t id_filter = *req->id_filter;
@@ -2227,6 +2308,41 @@ xrow_decode_replication_request(const struct xrow_header *row,
 			}
 			*req->is_anon = mp_decode_bool(&d);
 			break;
+		case IPROTO_COMPRESSION: {
+			if (req->is_compressed == NULL)
+				goto skip;
+			if (mp_typeof(*d) != MP_STR) {
+				xrow_on_decode_err(row, ER_INVALID_MSGPACK,
+						   "invalid COMPRESSION");
+				return -1;
+			}
+			uint32_t len;
+			const char *str = mp_decode_str(&d, &len);
+			/* Unknown algorithms are ignored. */
+			*req->is_compressed = len == strlen("zstd") &&
+					      memcmp(str, "zstd", len) == 0;
+			break;
+		}
+		case IPROTO_SPACE_FILTER: {
+			if (req->space_filter == NULL)
+				goto skip;
+			const char *filter = d;
+			if (mp_typeof(*d) != MP_ARRAY) {
+space_filter_decode_err:	xrow_on_decode_err(row, ER_INVALID_MSGPACK,
+						   "invalid SPACE_FILTER");
+				return -1;
+			}
+			uint32_t len = mp_decode_array(&d);
+			for (uint32_t i = 0; i < len; ++i) {
+				if (mp_typeof(*d) != MP_UINT)
+					goto space_filter_decode_err;
+				if (mp_decode_uint(&d) > UINT32_MAX)
+					goto space_filter_decode_err;
+			}
+			*req->space_filter = filter;
+			*req->space_filter_end = d;
+			break;
+		}
 		case IPROTO_ID_FILTER:
 			if (req->id_filter == NULL)
 				goto skip;
@@ -2292,6 +2408,9 @@ xrow_encode_subscribe(struct xrow_header *row,
 		.is_anon = &cast->is_anon,
 		.id_filter = &cast->id_filter,
 		.version_id = &cast->version_id,
+		.is_compressed = &cast->is_compressed,
+		.space_filter = &cast->space_filter,
+		.space_filter_end = &cast->space_filter_end,
 	};
 	xrow_encode_replication_request(row, &base_req, IPROTO_SUBSCRIBE);
 }
@@ -2310,6 +2429,9 @@ xrow_decode_subscribe(const struct xrow_header *row,
 		.version_id = &req->version_id,
 		.is_anon = &req->is_anon,
 		.id_filter = &req->id_filter,
+		.is_compressed = &req->is_compressed,
+		.space_filter = &req->space_filter,
+		.space_filter_end = &req->space_filter_end,
 	};
 	return xrow_decode_replication_request(row, &base_req);
 }
@@ -2557,6 +2679,9 @@ xrow_encode_subscribe_response(struct xrow_header *row,
 		.replicaset_uuid = &cast->replicaset_uuid,
 		.replicaset_name = cast->replicaset_name,
 		.vclock = &cast->vclock,
+		.is_compressed = &cast->is_compressed,
+		.space_filter = &cast->space_filter,
+		.space_filter_end = &cast->space_filter_end,
 	};
 	xrow_encode_replication_request(row, &base_req, IPROTO_OK);
 }
@@ -2570,6 +2695,9 @@ xrow_decode_subscribe_response(const struct xrow_header *row,
 		.replicaset_uuid = &rsp->replicaset_uuid,
 		.replicaset_name = rsp->replicaset_name,
 		.vclock = &rsp->vclock,
+		.is_compressed = &rsp->is_compressed,
+		.space_filter = &rsp->space_filter,
+		.space_filter_end = &rsp->space_filter_end,
 	};
 	return xrow_decode_replication_request(row, &base_req);
 }
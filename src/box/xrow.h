@@ -233,6 +233,24 @@ struct request {
 	const char *index_name;
 	/** Length of @index_name. */
 	uint32_t index_name_len;
+	/** Vclock to wait for before executing the request or NULL. */
+	const char *wait_vclock;
+	/** End of @wait_vclock. */
+	const char *wait_vclock_end;
+	/** Timeout of waiting for @wait_vclock, 0 if not set. */
+	double timeout;
+	/** Fields to project selected tuples to or NULL. */
+	const char *fields;
+	/** End of @fields. */
+	const char *fields_end;
+	/** Filter expression of selected tuples or NULL. */
+	const char *filter;
+	/** End of @filter. */
+	const char *filter_end;
+	/** Arrow IPC stream of IPROTO_INSERT_ARROW or NULL. */
+	const char *arrow;
+	/** End of @arrow. */
+	const char *arrow_end;
 };
 
 /**
@@ -240,6 +258,16 @@ struct request {
 const char *
 request_str(const struct request *request);
 
+/**
+ * Decode the vclock passed in IPROTO_WAIT_VCLOCK of a request.
+ * The 0th component is ignored.
+ * @retval 0 on success
+ * @retval -1 on error, diag is set
+ */
+int
+request_decode_wait_vclock(const struct request *request,
+			   struct vclock *vclock);
+
 /**
  * Decode DML request from a given MessagePack map.
  * @param row request header.
@@ -617,6 +645,15 @@ struct subscribe_request {
 	uint32_t version_id;
 	/** Flag whether the replica is anon. */
 	bool is_anon;
+	/** Flag whether the replica requests a compressed stream. */
+	bool is_compressed;
+	/**
+	 * MsgPack array of ids of the user spaces whose rows the replica
+	 * needs or NULL if it needs all of them.
+	 */
+	const char *space_filter;
+	/** End of the space_filter array. */
+	const char *space_filter_end;
 };
 
 /** Encode SUBSCRIBE request. */
@@ -637,6 +674,15 @@ struct subscribe_response {
 	char replicaset_name[NODE_NAME_SIZE_MAX];
 	/** Master's vclock. */
 	struct vclock vclock;
+	/** Flag whether the master compresses the stream. */
+	bool is_compressed;
+	/**
+	 * The space filter of the request if the master applies it,
+	 * NULL otherwise.
+	 */
+	const char *space_filter;
+	/** End of the space_filter array. */
+	const char *space_filter_end;
 };
 
 /** Encode SUBSCRIBE response. */
@@ -36,6 +36,7 @@
 #include "diag.h"
 #include <msgpuck/msgpuck.h>
 #include "column_mask.h"
+#include "mp_extension_types.h"
 #include "fiber.h"
 #include "xrow_update_field.h"
 #include "tuple_format.h"
@@ -381,3 +382,128 @@ xrow_upsert_execute(const char *expr,const char *expr_end,
 	region_truncate(&fiber()->gc, region_svp);
 	return NULL;
 }
+
+/**
+ * Calculate the new value of the field @a field of the type described
+ * by @a format_field (NULL if the field isn't in the format) updated
+ * with @a op. Returns NULL if the value can't be stored in place.
+ */
+static const char *
+xrow_update_op_do_in_place(struct xrow_update_op *op,
+			   struct tuple_field *format_field,
+			   const char *field, uint32_t size)
+{
+	const char *value;
+	uint32_t value_size;
+	switch (op->opcode) {
+	case '=': {
+		value = op->arg.set.value;
+		value_size = op->arg.set.length;
+		if (value_size != size)
+			return NULL;
+		if (mp_typeof(*value) == MP_EXT) {
+			int8_t ext_type;
+			const char *data = value;
+			mp_decode_extl(&data, &ext_type);
+			if (ext_type == MP_COMPRESSION)
+				return NULL;
+		}
+		break;
+	}
+	case '+':
+	case '-':
+	case '&':
+	case '^':
+	case '|': {
+		struct xrow_update_scalar scalar;
+		xrow_update_mp_read_scalar(&field, &scalar);
+		int rc = op->opcode == '+' || op->opcode == '-' ?
+			 xrow_update_op_do_arith(op, &scalar) :
+			 xrow_update_op_do_bit(op, &scalar);
+		if (rc != 0)
+			return NULL;
+		uint32_t bound = xrow_update_scalar_sizeof(&scalar);
+		char *buf = xregion_alloc(&fiber()->gc, bound);
+		struct json_token *this_node = format_field != NULL ?
+					       &format_field->token : NULL;
+		value_size = xrow_update_store_scalar(&scalar, this_node, buf,
+						      buf + bound);
+		if (value_size != size)
+			return NULL;
+		value = buf;
+		break;
+	}
+	default:
+		return NULL;
+	}
+	if (format_field != NULL &&
+	    !field_mp_type_is_compatible(format_field->type, value,
+					 tuple_field_is_nullable(format_field)))
+		return NULL;
+	return value;
+}
+
+bool
+xrow_update_prepare_in_place(const char *expr, const char *expr_end,
+			     const char *old_data, const char *old_data_end,
+			     struct tuple_format *format, int index_base,
+			     struct xrow_update_patch **p_patches,
+			     uint32_t *p_patch_count)
+{
+	(void)old_data_end;
+	if (format->constraint_count > 0 || format->is_compressed)
+		return false;
+	struct xrow_update update;
+	xrow_update_init(&update, index_base);
+	const char *data = old_data;
+	uint32_t field_count = mp_decode_array(&data);
+	struct diag *diag = diag_get();
+	if (xrow_update_read_ops(&update, expr, expr_end, format->dict,
+				 field_count) != 0) {
+		diag_clear(diag);
+		return false;
+	}
+	struct xrow_update_patch *patches =
+		xregion_alloc_array(&fiber()->gc, typeof(patches[0]),
+				    update.op_count);
+	for (uint32_t i = 0; i < update.op_count; i++) {
+		struct xrow_update_op *op = &update.ops[i];
+		if (!op->is_for_root)
+			return false;
+		int32_t field_no = op->field_no >= 0 ? op->field_no :
+				   (int32_t)field_count + op->field_no;
+		if (field_no < 0 || (uint32_t)field_no >= field_count)
+			return false;
+		struct tuple_field *format_field = NULL;
+		if ((uint32_t)field_no < tuple_format_field_count(format)) {
+			format_field = tuple_format_field(format, field_no);
+			if (format_field->is_key_part ||
+			    !json_token_is_leaf(&format_field->token) ||
+			    format_field->constraint_count > 0 ||
+			    tuple_field_has_default(format_field) ||
+			    tuple_field_type_is_fixed_int(format_field->type))
+				return false;
+		}
+		const char *field = data;
+		mp_next_n(&field, field_no);
+		const char *field_end = field;
+		mp_next(&field_end);
+		struct xrow_update_patch *patch = &patches[i];
+		patch->offset = field - old_data;
+		patch->size = field_end - field;
+		for (uint32_t j = 0; j < i; j++) {
+			/* Let the slow path report the double update. */
+			if (patches[j].offset == patch->offset)
+				return false;
+		}
+		patch->value = xrow_update_op_do_in_place(op, format_field,
+							  field, patch->size);
+		if (patch->value == NULL) {
+			diag_clear(diag);
+			return false;
+		}
+	}
+	*p_patches = patches;
+	*p_patch_count = update.op_count;
+	return true;
+}
@@ -33,6 +33,7 @@
 
 #include <stddef.h>
 #include <stdbool.h>
+#include <string.h>
 #include "trivia/util.h"
 #include "xrow_update_field.h"
 
@@ -120,6 +121,50 @@ xrow_upsert_execute(const char *expr, const char *expr_end,
 		    int index_base, bool suppress_error,
 		    uint64_t *column_mask);
 
+/** A new value of a top-level tuple field of the same MsgPack size. */
+struct xrow_update_patch {
+	/** Offset of the field in the tuple MsgPack data. */
+	uint32_t offset;
+	/** Size of the field. */
+	uint32_t size;
+	/** New MsgPack value of the field. */
+	const char *value;
+};
+
+/**
+ * Check if update operations may be applied to the tuple without
+ * rebuilding it and calculate new values of the updated fields if so.
+ * It's possible if all the operations are assignments, arithmetic or
+ * bitwise operations on top-level fields that don't change the MsgPack
+ * size of the fields. The updated fields must not be indexed and must
+ * not have constraints or default values, and the tuple format must not
+ * have tuple constraints, so that the result doesn't need validation
+ * except for the field type check done here.
+ *
+ * The patches are allocated on the fiber region. Should be applied with
+ * xrow_update_apply_patches() to a copy of the tuple data.
+ *
+ * If the operations can't be applied in place, including the case when
+ * they fail, returns false and doesn't set diag: the caller is supposed
+ * to fall back on xrow_update_execute(), which reports errors.
+ */
+bool
+xrow_update_prepare_in_place(const char *expr, const char *expr_end,
+			     const char *old_data, const char *old_data_end,
+			     struct tuple_format *format, int index_base,
+			     struct xrow_update_patch **p_patches,
+			     uint32_t *p_patch_count);
+
+/** Applies patches prepared by xrow_update_prepare_in_place(). */
+static inline void
+xrow_update_apply_patches(const struct xrow_update_patch *patches,
+			  uint32_t patch_count, char *data)
+{
+	for (uint32_t i = 0; i < patch_count; i++)
+		memcpy(data + patches[i].offset, patches[i].value,
+		       patches[i].size);
+}
+
 #if defined(__cplusplus)
 } /* extern "C" */
 #endif /* defined(__cplusplus) */
@@ -33,6 +33,7 @@
 #include "fiber.h"
 #include "schema_def.h"
 #include "tuple_format.h"
+#include "mp_util.h"
 
 /**
  * Make sure @a op contains a valid field number to where the
@@ -117,8 +118,7 @@ xrow_update_array_item_split(struct region *region,
 	const char *field = prev->tail_data;
 	const char *range_end = prev->tail_data + prev->tail_size;
 
-	for (uint32_t i = 1; i < offset; ++i)
-		mp_next(&field);
+	mp_next_n(&field, offset - 1);
 
 	prev->tail_size = field - prev->tail_data;
 	const char *field_end = field;
@@ -197,8 +197,7 @@ xrow_update_array_create_with_child(struct xrow_update_field *field,
 		xrow_update_alloc(region, sizeof(*item));
 	const char *end = first_field_end;
 	if (field_no > 0) {
-		for (int32_t i = 1; i < field_no; ++i)
-			mp_next(&end);
+		mp_next_n(&end, field_no - 1);
 		xrow_update_array_item_create(item, XUPDATE_NOP, first_field,
 					      first_field_end - first_field,
 					      end - first_field_end);
@@ -212,8 +211,8 @@ xrow_update_array_create_with_child(struct xrow_update_field *field,
 		mp_next(&first_field_end);
 		end = first_field_end;
 	}
-	for (uint32_t i = field_no + 1; i < field_count; ++i)
-		mp_next(&end);
+	if (field_no + 1 < (int32_t)field_count)
+		mp_next_n(&end, field_count - field_no - 1);
 	item->field = *child;
 	xrow_update_array_item_create(item, child->type, first_field,
 				      first_field_end - first_field,
@@ -0,0 +1,252 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2023, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#include "zstd_iostream.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/uio.h>
+#include <zstd.h>
+
+#include "diag.h"
+#include "error.h"
+#include "iostream.h"
+#include "trivia/util.h"
+
+struct zstd_iostream {
+	/** The underlying stream. */
+	struct iostream inner;
+	/** Compression context, persists across writes. */
+	ZSTD_CStream *cstream;
+	/** Decompression context, persists across reads. */
+	ZSTD_DStream *dstream;
+	/** Compressed data to be written to the underlying stream. */
+	char *wbuf;
+	/** Size of the wbuf allocation. */
+	size_t wbuf_capacity;
+	/** Position of the first unwritten byte in wbuf. */
+	size_t wbuf_pos;
+	/** End of the compressed data in wbuf. */
+	size_t wbuf_end;
+	/** Size of the uncompressed data stored in wbuf. */
+	size_t wbuf_input_size;
+	/** Compressed data read from the underlying stream. */
+	char *rbuf;
+	/** Size of the rbuf allocation. */
+	size_t rbuf_capacity;
+	/** Position of the first undecompressed byte in rbuf. */
+	size_t rbuf_pos;
+	/** End of the compressed data in rbuf. */
+	size_t rbuf_end;
+};
+
+static const struct iostream_vtab zstd_iostream_vtab;
+
+/** Makes sure there are at least @a size free bytes at the buffer end. */
+static int
+zstd_iostream_reserve(char **buf, size_t *capacity, size_t used, size_t size)
+{
+	if (*capacity - used >= size)
+		return 0;
+	size_t new_capacity = MAX(*capacity * 2, used + size);
+	char *new_buf = realloc(*buf, new_capacity);
+	if (new_buf == NULL) {
+		diag_set(OutOfMemory, new_capacity, "realloc", "zstd buffer");
+		return -1;
+	}
+	*buf = new_buf;
+	*capacity = new_capacity;
+	return 0;
+}
+
+static void
+zstd_iostream_free(struct zstd_iostream *zio)
+{
+	ZSTD_freeCStream(zio->cstream);
+	ZSTD_freeDStream(zio->dstream);
+	free(zio->wbuf);
+	free(zio->rbuf);
+	free(zio);
+}
+
+static void
+zstd_iostream_destroy(struct iostream *io)
+{
+	struct zstd_iostream *zio = io->data;
+	iostream_destroy(&zio->inner);
+	zstd_iostream_free(zio);
+}
+
+static ssize_t
+zstd_iostream_read(struct iostream *io, void *buf, size_t count)
+{
+	struct zstd_iostream *zio = io->data;
+	if (count == 0)
+		return 0;
+	while (true) {
+		ZSTD_inBuffer input = {zio->rbuf, zio->rbuf_end, zio->rbuf_pos};
+		ZSTD_outBuffer output = {buf, count, 0};
+		size_t rc = ZSTD_decompressStream(zio->dstream, &output,
+						  &input);
+		if (ZSTD_isError(rc)) {
+			diag_set(ClientError, ER_DECOMPRESSION,
+				 ZSTD_getErrorName(rc));
+			return IOSTREAM_ERROR;
+		}
+		zio->rbuf_pos = input.pos;
+		if (zio->rbuf_pos == zio->rbuf_end)
+			zio->rbuf_pos = zio->rbuf_end = 0;
+		if (output.pos > 0)
+			return output.pos;
+		/* All buffered data is consumed, read more. */
+		if (zio->rbuf_end == zio->rbuf_capacity && zio->rbuf_pos > 0) {
+			zio->rbuf_end -= zio->rbuf_pos;
+			memmove(zio->rbuf, zio->rbuf + zio->rbuf_pos,
+				zio->rbuf_end);
+			zio->rbuf_pos = 0;
+		}
+		if (zstd_iostream_reserve(&zio->rbuf, &zio->rbuf_capacity,
+					  zio->rbuf_end,
+					  ZSTD_DStreamInSize()) != 0)
+			return IOSTREAM_ERROR;
+		ssize_t n = iostream_read(&zio->inner,
+					  zio->rbuf + zio->rbuf_end,
+					  zio->rbuf_capacity - zio->rbuf_end);
+		if (n <= 0)
+			return n;
+		zio->rbuf_end += n;
+	}
+}
+
+/**
+ * Writes the compressed data pending in wbuf to the underlying stream.
+ * On success returns the size of the uncompressed data.
+ */
+static ssize_t
+zstd_iostream_flush(struct zstd_iostream *zio)
+{
+	while (zio->wbuf_pos < zio->wbuf_end) {
+		ssize_t n = iostream_write(&zio->inner,
+					   zio->wbuf + zio->wbuf_pos,
+					   zio->wbuf_end - zio->wbuf_pos);
+		if (n < 0)
+			return n;
+		zio->wbuf_pos += n;
+	}
+	ssize_t size = zio->wbuf_input_size;
+	zio->wbuf_pos = zio->wbuf_end = 0;
+	zio->wbuf_input_size = 0;
+	return size;
+}
+
+static ssize_t
+zstd_iostream_writev(struct iostream *io, const struct iovec *iov, int iovcnt)
+{
+	struct zstd_iostream *zio = io->data;
+	/* The previous write is being retried. */
+	if (zio->wbuf_input_size > 0)
+		return zstd_iostream_flush(zio);
+	size_t size = 0;
+	for (int i = 0; i < iovcnt; i++)
+		size += iov[i].iov_len;
+	if (size == 0)
+		return 0;
+	for (int i = 0; i < iovcnt; i++) {
+		ZSTD_inBuffer input = {iov[i].iov_base, iov[i].iov_len, 0};
+		ZSTD_EndDirective mode = i == iovcnt - 1 ? ZSTD_e_flush :
+					 ZSTD_e_continue;
+		while (true) {
+			if (zstd_iostream_reserve(&zio->wbuf,
+						  &zio->wbuf_capacity,
+						  zio->wbuf_end,
+						  ZSTD_CStreamOutSize()) != 0)
+				goto fail;
+			ZSTD_outBuffer output = {zio->wbuf, zio->wbuf_capacity,
+						 zio->wbuf_end};
+			size_t rc = ZSTD_compressStream2(zio->cstream, &output,
+							 &input, mode);
+			zio->wbuf_end = output.pos;
+			if (ZSTD_isError(rc)) {
+				diag_set(ClientError, ER_COMPRESSION,
+					 ZSTD_getErrorName(rc));
+				goto fail;
+			}
+			if (mode == ZSTD_e_flush ? rc == 0 :
+			    input.pos == input.size)
+				break;
+		}
+	}
+	zio->wbuf_input_size = size;
+	return zstd_iostream_flush(zio);
+fail:
+	/* The compression context may be broken, don't reuse it. */
+	zio->wbuf_pos = zio->wbuf_end = 0;
+	return IOSTREAM_ERROR;
+}
+
+static ssize_t
+zstd_iostream_write(struct iostream *io, const void *buf, size_t count)
+{
+	struct iovec iov = {(void *)buf, count};
+	return zstd_iostream_writev(io, &iov, 1);
+}
+
+static const struct iostream_vtab zstd_iostream_vtab = {
+	/* .destroy = */ zstd_iostream_destroy,
+	/* .read = */ zstd_iostream_read,
+	/* .write = */ zstd_iostream_write,
+	/* .writev = */ zstd_iostream_writev,
+};
+
+int
+zstd_iostream_create(struct iostream *io, struct iostream *inner,
+		     const char *data, size_t size)
+{
+	struct zstd_iostream *zio = calloc(1, sizeof(*zio));
+	if (zio == NULL) {
+		diag_set(OutOfMemory, sizeof(*zio), "calloc", "zstd_iostream");
+		return -1;
+	}
+	zio->cstream = ZSTD_createCStream();
+	zio->dstream = ZSTD_createDStream();
+	if (zio->cstream == NULL || zio->dstream == NULL) {
+		diag_set(OutOfMemory, 0, "ZSTD_createCStream", "zstd stream");
+		goto fail;
+	}
+	size_t rc = ZSTD_initDStream(zio->dstream);
+	if (ZSTD_isError(rc)) {
+		diag_set(ClientError, ER_DECOMPRESSION, ZSTD_getErrorName(rc));
+		goto fail;
+	}
+	if (size > 0) {
+		if (zstd_iostream_reserve(&zio->rbuf, &zio->rbuf_capacity, 0,
+					  size) != 0)
+			goto fail;
+		memcpy(zio->rbuf, data, size);
+		zio->rbuf_end = size;
+	}
+	iostream_move(&zio->inner, inner);
+	io->vtab = &zstd_iostream_vtab;
+	io->data = zio;
+	io->fd = zio->inner.fd;
+	io->flags = zio->inner.flags;
+#ifndef NDEBUG
+	io->owner = NULL;
+#endif
+	return 0;
+fail:
+	zstd_iostream_free(zio);
+	return -1;
+}
+
+void
+zstd_iostream_release(struct iostream *io, struct iostream *inner)
+{
+	assert(io->vtab == &zstd_iostream_vtab);
+	struct zstd_iostream *zio = io->data;
+	iostream_move(inner, &zio->inner);
+	zstd_iostream_free(zio);
+	iostream_clear(io);
+}
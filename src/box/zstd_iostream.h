@@ -0,0 +1,47 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2023, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#pragma once
+
+#include <stddef.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+struct iostream;
+
+/**
+ * Creates an IO stream that compresses all data written to the given one
+ * and decompresses all data read from it with zstd. The compression
+ * context persists across writes so that the compression ratio of a
+ * stream of small packets, e.g. replication rows, is close to the one
+ * of the whole stream. Each write is flushed so that the peer can
+ * decompress it without waiting for more data.
+ *
+ * The underlying stream is moved to the new one. The data read from
+ * the underlying stream before switching to compression can be passed
+ * in @a data and @a size.
+ *
+ * Like an SSL stream, a write that returned IOSTREAM_WANT_READ or
+ * IOSTREAM_WANT_WRITE must be retried with the same arguments.
+ *
+ * On success returns 0. On failure returns -1, sets diag, and leaves
+ * the underlying stream intact.
+ */
+int
+zstd_iostream_create(struct iostream *io, struct iostream *inner,
+		     const char *data, size_t size);
+
+/**
+ * Destroys a zstd IO stream and moves the underlying stream back to
+ * @a inner. Data pending in the compression buffers is discarded.
+ */
+void
+zstd_iostream_release(struct iostream *io, struct iostream *inner);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
@@ -258,6 +258,80 @@ curl_env_create(struct curl_env *env, long max_conns, long max_total_conns)
 	return -1;
 }
 
+/** Unsupported by the libcurl version the binary was built with. */
+static int
+curl_env_unsupported(const char *option)
+{
+	diag_set(IllegalParams, "%s is not supported by libcurl %s",
+		 option, LIBCURL_VERSION);
+	return -1;
+}
+
+int
+curl_env_set_multiplexing(struct curl_env *env, long max_streams)
+{
+#if LIBCURL_VERSION_NUM >= 0x072b00
+	curl_multi_setopt(env->multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+	env->is_multiplexed = true;
+#else
+	return curl_env_unsupported("HTTP/2 multiplexing");
+#endif
+	if (max_streams == 0)
+		return 0;
+#if LIBCURL_VERSION_NUM >= 0x074300
+	curl_multi_setopt(env->multi, CURLMOPT_MAX_CONCURRENT_STREAMS,
+			  max_streams);
+	return 0;
+#else
+	return curl_env_unsupported("max_concurrent_streams");
+#endif
+}
+
+int
+curl_env_set_max_host_conns(struct curl_env *env, long max_host_conns)
+{
+#if LIBCURL_VERSION_NUM >= 0x071e00
+	curl_multi_setopt(env->multi, CURLMOPT_MAX_HOST_CONNECTIONS,
+			  max_host_conns);
+	return 0;
+#else
+	(void)env;
+	(void)max_host_conns;
+	return curl_env_unsupported("max_host_connections");
+#endif
+}
+
+/**
+ * Share handle used by all environments that share connections.
+ * All of them live in the TX thread, so no locking is needed.
+ */
+static CURLSH *curl_share;
+
+int
+curl_env_set_shared(struct curl_env *env)
+{
+#if LIBCURL_VERSION_NUM >= 0x073900
+	if (curl_share == NULL) {
+		curl_share = curl_share_init();
+		if (curl_share == NULL) {
+			diag_set(OutOfMemory, 0, "curl", "share");
+			return -1;
+		}
+		curl_share_setopt(curl_share, CURLSHOPT_SHARE,
+				  CURL_LOCK_DATA_CONNECT);
+		curl_share_setopt(curl_share, CURLSHOPT_SHARE,
+				  CURL_LOCK_DATA_DNS);
+		curl_share_setopt(curl_share, CURLSHOPT_SHARE,
+				  CURL_LOCK_DATA_SSL_SESSION);
+	}
+	env->share = curl_share;
+	return 0;
+#else
+	(void)env;
+	return curl_env_unsupported("share_connections");
+#endif
+}
+
 void
 curl_env_finish(struct curl_env *env)
 {
@@ -336,6 +410,12 @@ CURLMcode
 curl_request_start(struct curl_request *curl_request, struct curl_env *env)
 {
 	CURLMcode mcode;
+	if (env->share != NULL)
+		curl_easy_setopt(curl_request->easy, CURLOPT_SHARE, env->share);
+#if LIBCURL_VERSION_NUM >= 0x072b00
+	if (env->is_multiplexed)
+		curl_easy_setopt(curl_request->easy, CURLOPT_PIPEWAIT, 1L);
+#endif
 	curl_request->in_progress = true;
 	mcode = curl_multi_add_handle(env->multi, curl_request->easy);
 	curl_diag_set_merror(mcode);
@@ -60,6 +60,17 @@ struct curl_env {
 	struct ev_timer timer_event;
 	/** Statistics. */
 	struct curl_stat stat;
+	/**
+	 * Set if requests should wait for a connection that can be
+	 * multiplexed over HTTP/2 instead of opening a new one.
+	 */
+	bool is_multiplexed;
+	/**
+	 * Share handle holding the connection cache, DNS cache and
+	 * TLS sessions common to all environments, or NULL if the
+	 * environment uses its own ones.
+	 */
+	CURLSH *share;
 };
 
 /**
@@ -104,6 +115,35 @@ struct curl_request {
 int
 curl_env_create(struct curl_env *env, long max_conns, long max_total_conns);
 
+/**
+ * Multiplex requests over HTTP/2 connections, with at most
+ * @a max_streams concurrent streams per connection. Zero means the
+ * libcurl default.
+ * @retval 0 on success
+ * @retval -1 on error, check diag
+ */
+int
+curl_env_set_multiplexing(struct curl_env *env, long max_streams);
+
+/**
+ * Limit the number of connections to a single host.
+ * @retval 0 on success
+ * @retval -1 on error, check diag
+ */
+int
+curl_env_set_max_host_conns(struct curl_env *env, long max_host_conns);
+
+/**
+ * Make requests of the environment use the connection cache, the
+ * DNS cache and the TLS session cache shared by all environments
+ * that enabled this, so that keep-alive connections opened by one
+ * HTTP client can be reused by another.
+ * @retval 0 on success
+ * @retval -1 on error, check diag
+ */
+int
+curl_env_set_shared(struct curl_env *env);
+
 /**
  * Destroy HTTP client environment
  * @param env pointer to a structure to destroy
@@ -464,6 +464,40 @@ httpc_set_accept_encoding(struct httpc_request *req, const char *encoding)
 #endif
 }
 
+int
+httpc_set_http_version(struct httpc_request *req, const char *version)
+{
+	long value;
+	if (strcmp(version, "1.0") == 0) {
+		value = CURL_HTTP_VERSION_1_0;
+	} else if (strcmp(version, "1.1") == 0) {
+		value = CURL_HTTP_VERSION_1_1;
+#if LIBCURL_VERSION_NUM >= 0x072100
+	} else if (strcmp(version, "2") == 0) {
+		value = CURL_HTTP_VERSION_2_0;
+#endif
+#if LIBCURL_VERSION_NUM >= 0x072f00
+	} else if (strcmp(version, "2tls") == 0) {
+		value = CURL_HTTP_VERSION_2TLS;
+#endif
+#if LIBCURL_VERSION_NUM >= 0x073100
+	} else if (strcmp(version, "2-prior-knowledge") == 0) {
+		value = CURL_HTTP_VERSION_2_PRIOR_KNOWLEDGE;
+#endif
+	} else {
+		diag_set(IllegalParams, "Unsupported HTTP version: %s",
+			 version);
+		return -1;
+	}
+	if (curl_easy_setopt(req->curl_request.easy, CURLOPT_HTTP_VERSION,
+			     value) != CURLE_OK) {
+		diag_set(IllegalParams, "HTTP version %s is not supported "
+			 "by libcurl", version);
+		return -1;
+	}
+	return 0;
+}
+
 /**
  * The callback to call after a CURL request is completed.
  */
@@ -439,6 +439,21 @@ httpc_set_follow_location(struct httpc_request *req, long follow);
 void
 httpc_set_accept_encoding(struct httpc_request *req, const char *encoding);
 
+/**
+ * Set the HTTP protocol version to use for the request: "1.0",
+ * "1.1", "2" (HTTP/2, falling back to HTTP/1.1 if the server does
+ * not support it), "2tls" (HTTP/2 over TLS only) or
+ * "2-prior-knowledge" (HTTP/2 without an upgrade from HTTP/1.1).
+ *
+ * @param req     request
+ * @param version version name
+ * @retval  0 on success
+ * @retval -1 on error, check diag
+ * @see https://curl.se/libcurl/c/CURLOPT_HTTP_VERSION.html
+ */
+int
+httpc_set_http_version(struct httpc_request *req, const char *version);
+
 /**
  * Enable a chunked io interface for the request. It allows to
  * send and receive data via chunks.
@@ -69,6 +69,35 @@ latency_create(struct latency *latency)
 	return 0;
 }
 
+int
+latency_create_fine(struct latency *latency)
+{
+	enum {
+		/** Number of buckets per power of 2. */
+		SUB_BUCKETS = 8,
+		/** Max bucket is 2^MAX_SHIFT us, about 16 seconds. */
+		MAX_SHIFT = 24,
+	};
+	static int64_t buckets[SUB_BUCKETS * (MAX_SHIFT - 2)];
+	static size_t n_buckets;
+	if (n_buckets == 0) {
+		for (int64_t v = 1; v <= SUB_BUCKETS; v++)
+			buckets[n_buckets++] = v;
+		for (int shift = 3; shift < MAX_SHIFT; shift++) {
+			int64_t step = (int64_t)1 << (shift - 3);
+			for (int i = 1; i <= SUB_BUCKETS; i++) {
+				assert(n_buckets < lengthof(buckets));
+				buckets[n_buckets++] =
+					((int64_t)1 << shift) + i * step;
+			}
+		}
+	}
+	latency->histogram = histogram_new(buckets, n_buckets);
+	if (latency->histogram == NULL)
+		return -1;
+	return 0;
+}
+
 void
 latency_destroy(struct latency *latency)
 {
@@ -95,3 +124,10 @@ latency_get(struct latency *latency, int pct)
 	int64_t value_usec = histogram_percentile(latency->histogram, pct);
 	return (double)value_usec / USEC_PER_SEC;
 }
+
+double
+latency_get_permille(struct latency *latency, int permille)
+{
+	int64_t value_usec = histogram_permille(latency->histogram, permille);
+	return (double)value_usec / USEC_PER_SEC;
+}
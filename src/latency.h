@@ -51,6 +51,16 @@ struct latency {
 int
 latency_create(struct latency *latency);
 
+/**
+ * Initialize a latency counter with a fine bucket grid: every
+ * power of 2 microseconds is split in 8 buckets, so percentiles
+ * are precise within 12.5%, like in HDR histograms. Unlike
+ * latency_create(), the counter has no observations initially.
+ * Return 0 on success, -1 on OOM.
+ */
+int
+latency_create_fine(struct latency *latency);
+
 /**
  * Destroy a latency counter.
  */
@@ -77,4 +87,11 @@ latency_collect(struct latency *latency, double value);
 double
 latency_get(struct latency *latency, int pct);
 
+/**
+ * Same as latency_get(), but takes the percentile in per mille,
+ * e.g. 999 for the 99.9th percentile.
+ */
+double
+latency_get_permille(struct latency *latency, int permille);
+
 #endif /* TARANTOOL_LATENCY_H_INCLUDED */
@@ -58,11 +58,16 @@ enum {
 	BITSET_PAGE_DATA_SIZE = 160
 };
 
-#if defined(ENABLE_AVX)
-typedef __m256i tt_bitset_word_t;
+/*
+ * Page operations are written in terms of generic vector types so that
+ * the compiler emits the widest SIMD instructions available on the target
+ * (AVX2, SSE2 or NEON) without using platform-specific intrinsics.
+ */
+#if defined(__AVX2__)
+typedef uint64_t tt_bitset_word_t __attribute__((vector_size(32)));
 #define BITSET_PAGE_DATA_ALIGNMENT 32
-#elif defined(ENABLE_SSE2)
-typedef __m128i tt_bitset_word_t;
+#elif defined(__SSE2__) || defined(__ARM_NEON)
+typedef uint64_t tt_bitset_word_t __attribute__((vector_size(16)));
 #define BITSET_PAGE_DATA_ALIGNMENT 16
 #elif defined(__x86_64__)
 typedef uint64_t tt_bitset_word_t;
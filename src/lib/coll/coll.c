@@ -80,6 +80,14 @@ coll_icu_cmp(const char *s, size_t slen, const char *t, size_t tlen,
 	     const struct coll *coll)
 {
 	assert(coll->collator != NULL);
+	/*
+	 * Identical strings collate equal whatever the collation is.
+	 * Check it first, because tree lookups end up comparing the
+	 * search key with an equal tuple field and the comparison is
+	 * much cheaper than setting up the ICU iterators.
+	 */
+	if (slen == tlen && memcmp(s, t, slen) == 0)
+		return 0;
 
 	UErrorCode status = U_ZERO_ERROR;
 
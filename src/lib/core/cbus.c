@@ -31,6 +31,7 @@
 #include "cbus.h"
 
 #include <limits.h>
+#include <pmatomic.h>
 #include "fiber.h"
 #include "trigger.h"
 
@@ -87,6 +88,40 @@ static void
 cpipe_flush_cb(ev_loop * /* loop */, struct ev_async *watcher,
 	       int /* events */);
 
+/**
+ * Push all messages of @a input to the endpoint queue and empty
+ * @a input. The messages are linked in the reverse order, so that
+ * the stack of the endpoint has the last sent message on top.
+ *
+ * @retval true if the endpoint queue was empty
+ */
+static bool
+cbus_endpoint_push(struct cbus_endpoint *endpoint, struct stailq *input)
+{
+	assert(!stailq_empty(input));
+	stailq_reverse(input);
+	struct stailq_entry *first = stailq_first(input);
+	struct stailq_entry_ptr *last = input->last;
+	struct stailq_entry *head = pm_atomic_load(&endpoint->output);
+	do {
+		last->value = head;
+	} while (!pm_atomic_compare_exchange_weak(&endpoint->output,
+						  &head, first));
+	stailq_create(input);
+	return head == NULL;
+}
+
+void
+cbus_endpoint_fetch(struct cbus_endpoint *endpoint, struct stailq *output)
+{
+	struct stailq input;
+	stailq_create(&input);
+	input.first.value = pm_atomic_exchange(&endpoint->output, NULL);
+	/* Restore the order in which the messages were sent. */
+	stailq_reverse(&input);
+	stailq_concat(output, &input);
+}
+
 void
 cpipe_create(struct cpipe *pipe, const char *consumer)
 {
@@ -149,11 +184,11 @@ cpipe_destroy(struct cpipe *pipe)
 	 * delivered.
 	 */
 	tt_pthread_mutex_lock(&endpoint->mutex);
+	/* Add the pipe shutdown message as the last one. */
+	stailq_add_tail_entry(&pipe->input, poison, msg.fifo);
 	/* Flush input */
-	stailq_concat(&endpoint->output, &pipe->input);
+	cbus_endpoint_push(endpoint, &pipe->input);
 	pipe->n_input = 0;
-	/* Add the pipe shutdown message as the last one. */
-	stailq_add_tail_entry(&endpoint->output, poison, msg.fifo);
 	/* Count statistics */
 	rmean_collect(cbus.stats, CBUS_STAT_EVENTS, 1);
 	/*
@@ -215,7 +250,7 @@ cbus_endpoint_create(struct cbus_endpoint *endpoint, const char *name,
 	endpoint->n_pipes = 0;
 	fiber_cond_create(&endpoint->cond);
 	tt_pthread_mutex_init(&endpoint->mutex, NULL);
-	stailq_create(&endpoint->output);
+	endpoint->output = NULL;
 	ev_async_init(&endpoint->async,
 		      (void (*)(ev_loop *, struct ev_async *, int)) fetch_cb);
 	endpoint->async.data = fetch_data;
@@ -249,14 +284,15 @@ cbus_endpoint_destroy(struct cbus_endpoint *endpoint,
 	while (true) {
 		if (process_cb)
 			process_cb(endpoint);
-		if (endpoint->n_pipes == 0 && stailq_empty(&endpoint->output))
+		if (endpoint->n_pipes == 0 &&
+		    pm_atomic_load(&endpoint->output) == NULL)
 			break;
 		 fiber_cond_wait(&endpoint->cond);
 	}
 
 	/*
-	 * Pipe flush func can still lock mutex, so just lock and unlock
-	 * it.
+	 * cpipe_destroy() can still hold the mutex while it
+	 * notifies the consumer, so just lock and unlock it.
 	 */
 	tt_pthread_mutex_lock(&endpoint->mutex);
 	tt_pthread_mutex_unlock(&endpoint->mutex);
@@ -279,14 +315,7 @@ cpipe_flush_cb(ev_loop *loop, struct ev_async *watcher, int events)
 
 	trigger_run(&pipe->on_flush, pipe);
 	/* Trigger task processing when the queue becomes non-empty. */
-	bool output_was_empty;
-
-	tt_pthread_mutex_lock(&endpoint->mutex);
-	output_was_empty = stailq_empty(&endpoint->output);
-	/** Flush input */
-	stailq_concat(&endpoint->output, &pipe->input);
-	tt_pthread_mutex_unlock(&endpoint->mutex);
-
+	bool output_was_empty = cbus_endpoint_push(endpoint, &pipe->input);
 	pipe->n_input = 0;
 	if (output_was_empty) {
 		/* Count statistics */
@@ -30,6 +30,7 @@
  */
 #include "coio_file.h"
 #include "coio_task.h"
+#include "coio_uring.h"
 #include "fiber.h"
 #include "say.h"
 #include "fio.h"
@@ -147,6 +148,8 @@ coio_wait_done(eio_req *req, struct coio_file_task *eio)
 int
 coio_file_open(const char *path, int flags, mode_t mode)
 {
+	if (coio_uring_is_ready())
+		return coio_uring_open(path, flags, mode);
 	INIT_COEIO_FILE(eio);
 	eio_req *req = eio_open(path, flags, mode, 0,
 				coio_complete, &eio);
@@ -156,6 +159,8 @@ coio_file_open(const char *path, int flags, mode_t mode)
 int
 coio_file_close(int fd)
 {
+	if (coio_uring_is_ready())
+		return coio_uring_close(fd);
 	INIT_COEIO_FILE(eio);
 	eio_req *req = eio_close(fd, 0, coio_complete, &eio);
 	return coio_wait_done(req, &eio);
@@ -175,10 +180,15 @@ coio_pwrite(int fd, const void *buf, size_t count, off_t offset)
 			chunk = 1;
 		});
 
-		req = eio_write(fd, (char *)buf + pos, chunk,
-				offset + pos, EIO_PRI_DEFAULT,
-				coio_complete, &eio);
-		res = coio_wait_done(req, &eio);
+		if (coio_uring_is_ready()) {
+			res = coio_uring_write(fd, (char *)buf + pos, chunk,
+					       offset + pos);
+		} else {
+			req = eio_write(fd, (char *)buf + pos, chunk,
+					offset + pos, EIO_PRI_DEFAULT,
+					coio_complete, &eio);
+			res = coio_wait_done(req, &eio);
+		}
 		if (res < 0) {
 			pos = -1;
 			break;
@@ -193,6 +203,8 @@ coio_pwrite(int fd, const void *buf, size_t count, off_t offset)
 ssize_t
 coio_pread(int fd, void *buf, size_t count, off_t offset)
 {
+	if (coio_uring_is_ready())
+		return coio_uring_read(fd, buf, count, offset);
 	INIT_COEIO_FILE(eio);
 	eio_req *req = eio_read(fd, buf, count,
 				offset, 0, coio_complete, &eio);
@@ -243,9 +255,17 @@ coio_write(int fd, const void *buf, size_t count)
 		eio.write.count	= left;
 		eio.write.fd	= fd;
 
-		req = eio_custom(coio_do_write, EIO_PRI_DEFAULT,
-				 coio_complete, &eio);
-		res = coio_wait_done(req, &eio);
+		if (coio_uring_is_ready()) {
+			ERROR_INJECT(ERRINJ_COIO_WRITE_CHUNK, {
+				eio.write.count = 1;
+			});
+			res = coio_uring_write(fd, eio.write.buf,
+					       eio.write.count, -1);
+		} else {
+			req = eio_custom(coio_do_write, EIO_PRI_DEFAULT,
+					 coio_complete, &eio);
+			res = coio_wait_done(req, &eio);
+		}
 		if (res < 0) {
 			pos = -1;
 			break;
@@ -268,6 +288,8 @@ coio_do_read(eio_req *req)
 ssize_t
 coio_read(int fd, void *buf, size_t count)
 {
+	if (coio_uring_is_ready())
+		return coio_uring_read(fd, buf, count, -1);
 	INIT_COEIO_FILE(eio);
 	eio.read.buf = buf;
 	eio.read.count = count;
@@ -312,6 +334,8 @@ coio_do_lstat(eio_req *req)
 int
 coio_lstat(const char *pathname, struct stat *buf)
 {
+	if (coio_uring_is_ready())
+		return coio_uring_stat(-1, pathname, true, buf);
 	INIT_COEIO_FILE(eio);
 	eio.lstat.pathname = pathname;
 	eio.lstat.buf = buf;
@@ -331,6 +355,8 @@ coio_do_stat(eio_req *req)
 int
 coio_stat(const char *pathname, struct stat *buf)
 {
+	if (coio_uring_is_ready())
+		return coio_uring_stat(-1, pathname, false, buf);
 	INIT_COEIO_FILE(eio);
 	eio.lstat.pathname = pathname;
 	eio.lstat.buf = buf;
@@ -350,6 +376,8 @@ coio_do_fstat(eio_req *req)
 int
 coio_fstat(int fd, struct stat *stat)
 {
+	if (coio_uring_is_ready())
+		return coio_uring_stat(fd, NULL, false, stat);
 	INIT_COEIO_FILE(eio);
 	eio.fstat.fd = fd;
 	eio.fstat.buf = stat;
@@ -535,6 +563,8 @@ coio_sync(void)
 int
 coio_fsync(int fd)
 {
+	if (coio_uring_is_ready())
+		return coio_uring_fsync(fd, false);
 	INIT_COEIO_FILE(eio);
 	eio_req *req = eio_fsync(fd, 0, coio_complete, &eio);
 	return coio_wait_done(req, &eio);
@@ -543,6 +573,8 @@ coio_fsync(int fd)
 int
 coio_fdatasync(int fd)
 {
+	if (coio_uring_is_ready())
+		return coio_uring_fsync(fd, true);
 	INIT_COEIO_FILE(eio);
 	eio_req *req = eio_fdatasync(fd, 0, coio_complete, &eio);
 	return coio_wait_done(req, &eio);
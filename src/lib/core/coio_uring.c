@@ -0,0 +1,527 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2024, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#include "coio_uring.h"
+
+#include <stdint.h>
+
+#include "trivia/config.h"
+#include "trivia/util.h"
+#include "tweaks.h"
+
+/**
+ * If set, cords that called coio_uring_enable() submit file I/O
+ * to io_uring. Otherwise, they use the coio thread pool.
+ */
+static bool coio_use_io_uring = true;
+TWEAK_BOOL(coio_use_io_uring);
+
+#if defined(HAVE_IO_URING)
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/sysmacros.h>
+#include <unistd.h>
+#include <linux/io_uring.h>
+
+#include "fiber.h"
+#include "say.h"
+
+enum {
+	/** Size of the submission queue. */
+	COIO_URING_ENTRIES = 256,
+	/** Max size of a single read or write, as in the kernel. */
+	COIO_URING_RW_MAX = 0x7ffff000,
+};
+
+/** An io_uring instance of a cord. */
+struct coio_uring {
+	/** io_uring file descriptor. */
+	int fd;
+	/** Submission queue ring, shared with the kernel. */
+	void *sq_ring;
+	size_t sq_ring_size;
+	unsigned *sq_head;
+	unsigned *sq_tail;
+	unsigned sq_mask;
+	unsigned *sq_array;
+	/** Submission queue entries. */
+	struct io_uring_sqe *sqes;
+	size_t sqes_size;
+	/** Completion queue ring, may be the same as sq_ring. */
+	void *cq_ring;
+	size_t cq_ring_size;
+	unsigned *cq_head;
+	unsigned *cq_tail;
+	unsigned cq_mask;
+	struct io_uring_cqe *cqes;
+	/** Size of the completion queue. */
+	unsigned cq_entries;
+	/** Size of the submission queue. */
+	unsigned sq_entries;
+	/** Number of queued requests not passed to the kernel yet. */
+	unsigned to_submit;
+	/**
+	 * Number of requests not completed yet. Never exceeds
+	 * the size of the completion queue, so it can't overflow.
+	 */
+	unsigned in_flight;
+	/** Event loop of the cord that owns the instance. */
+	struct ev_loop *loop;
+	/** Fires when the completion queue isn't empty. */
+	struct ev_io input;
+	/**
+	 * Submits queued requests before the event loop blocks,
+	 * so that requests of all fibers that ran in one loop
+	 * iteration are submitted with a single system call.
+	 */
+	struct ev_prepare flush;
+};
+
+/** A request waited for by a fiber. */
+struct coio_uring_req {
+	/** The fiber to wake up on completion. */
+	struct fiber *fiber;
+	/** Result of the request: a value or a negated errno. */
+	int result;
+	/** Set on completion. */
+	bool done;
+};
+
+/** The io_uring instance of the current cord. */
+static __thread struct coio_uring *coio_uring;
+
+/** Complete a request and wake up its fiber. */
+static void
+coio_uring_complete(struct coio_uring *ring, struct coio_uring_req *req,
+		    int result)
+{
+	assert(ring->in_flight > 0);
+	ring->in_flight--;
+	req->result = result;
+	req->done = true;
+	fiber_wakeup(req->fiber);
+}
+
+/**
+ * Fail all requests that the kernel didn't take from the
+ * submission queue.
+ */
+static void
+coio_uring_fail_queued(struct coio_uring *ring, int error)
+{
+	unsigned head = __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+	unsigned tail = *ring->sq_tail;
+	for (unsigned i = head; i != tail; i++) {
+		struct io_uring_sqe *sqe =
+			&ring->sqes[ring->sq_array[i & ring->sq_mask]];
+		coio_uring_complete(ring, (struct coio_uring_req *)
+				    (uintptr_t)sqe->user_data, -error);
+	}
+	__atomic_store_n(ring->sq_tail, head, __ATOMIC_RELEASE);
+	ring->to_submit = 0;
+}
+
+/** Pass all queued requests to the kernel. */
+static void
+coio_uring_submit(struct coio_uring *ring)
+{
+	while (ring->to_submit > 0) {
+		int rc = syscall(__NR_io_uring_enter, ring->fd,
+				 ring->to_submit, 0, 0, NULL, 0);
+		if (rc < 0 && errno == EINTR)
+			continue;
+		if (rc <= 0) {
+			int error = rc < 0 ? errno : EAGAIN;
+			say_syserror("io_uring_enter");
+			coio_uring_fail_queued(ring, error);
+			return;
+		}
+		assert((unsigned)rc <= ring->to_submit);
+		ring->to_submit -= rc;
+	}
+}
+
+static void
+coio_uring_flush_cb(struct ev_loop *loop, struct ev_prepare *watcher,
+		    int events)
+{
+	(void)events;
+	struct coio_uring *ring = (struct coio_uring *)watcher->data;
+	ev_prepare_stop(loop, watcher);
+	coio_uring_submit(ring);
+}
+
+static void
+coio_uring_input_cb(struct ev_loop *loop, struct ev_io *watcher, int events)
+{
+	(void)loop;
+	(void)events;
+	struct coio_uring *ring = (struct coio_uring *)watcher->data;
+	unsigned head = *ring->cq_head;
+	unsigned tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+	for (; head != tail; head++) {
+		struct io_uring_cqe *cqe = &ring->cqes[head & ring->cq_mask];
+		coio_uring_complete(ring, (struct coio_uring_req *)
+				    (uintptr_t)cqe->user_data, cqe->res);
+	}
+	__atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+}
+
+/** Get a zeroed submission queue entry for a new request. */
+static struct io_uring_sqe *
+coio_uring_get_sqe(struct coio_uring *ring)
+{
+	if (ring->to_submit == ring->sq_entries)
+		coio_uring_submit(ring);
+	unsigned tail = *ring->sq_tail;
+	unsigned index = tail & ring->sq_mask;
+	struct io_uring_sqe *sqe = &ring->sqes[index];
+	memset(sqe, 0, sizeof(*sqe));
+	ring->sq_array[index] = index;
+	return sqe;
+}
+
+/**
+ * Queue a request filled in the entry returned by the last
+ * coio_uring_get_sqe() and wait for its completion.
+ */
+static int
+coio_uring_wait(struct coio_uring *ring, struct io_uring_sqe *sqe)
+{
+	struct coio_uring_req req = {
+		.fiber = fiber(),
+		.result = 0,
+		.done = false,
+	};
+	sqe->user_data = (uintptr_t)&req;
+	__atomic_store_n(ring->sq_tail, *ring->sq_tail + 1, __ATOMIC_RELEASE);
+	ring->to_submit++;
+	ring->in_flight++;
+	assert(ring->in_flight <= ring->cq_entries);
+	if (!ev_is_active(&ring->flush))
+		ev_prepare_start(ring->loop, &ring->flush);
+	while (!req.done)
+		fiber_yield();
+	if (req.result < 0) {
+		errno = -req.result;
+		return -1;
+	}
+	return req.result;
+}
+
+/** Check that the kernel supports all the operations we need. */
+static bool
+coio_uring_probe(int fd)
+{
+	static const int ops[] = {
+		IORING_OP_OPENAT, IORING_OP_CLOSE, IORING_OP_READ,
+		IORING_OP_WRITE, IORING_OP_FSYNC, IORING_OP_STATX,
+	};
+	size_t size = sizeof(struct io_uring_probe) +
+		      IORING_OP_LAST * sizeof(struct io_uring_probe_op);
+	struct io_uring_probe *probe = xcalloc(1, size);
+	bool ok = syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE,
+			  probe, IORING_OP_LAST) == 0;
+	for (size_t i = 0; ok && i < lengthof(ops); i++) {
+		ok = ops[i] < probe->ops_len &&
+		     (probe->ops[ops[i]].flags & IO_URING_OP_SUPPORTED) != 0;
+	}
+	free(probe);
+	return ok;
+}
+
+void
+coio_uring_enable(void)
+{
+	assert(coio_uring == NULL);
+	if (!coio_use_io_uring)
+		return;
+	struct io_uring_params params;
+	memset(&params, 0, sizeof(params));
+	int fd = syscall(__NR_io_uring_setup, COIO_URING_ENTRIES, &params);
+	if (fd < 0) {
+		say_verbose("io_uring is not available: %s", strerror(errno));
+		return;
+	}
+	if ((params.features & IORING_FEAT_RW_CUR_POS) == 0 ||
+	    !coio_uring_probe(fd)) {
+		say_verbose("io_uring is not available: "
+			    "required operations are not supported");
+		close(fd);
+		return;
+	}
+	struct coio_uring *ring = xcalloc(1, sizeof(*ring));
+	ring->fd = fd;
+	ring->sq_ring_size = params.sq_off.array +
+			     params.sq_entries * sizeof(unsigned);
+	ring->cq_ring_size = params.cq_off.cqes +
+			     params.cq_entries * sizeof(struct io_uring_cqe);
+	bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+	if (single_mmap) {
+		ring->sq_ring_size = MAX(ring->sq_ring_size,
+					 ring->cq_ring_size);
+		ring->cq_ring_size = ring->sq_ring_size;
+	}
+	ring->sq_ring = mmap(NULL, ring->sq_ring_size, PROT_READ | PROT_WRITE,
+			     MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+	if (ring->sq_ring == MAP_FAILED)
+		goto fail_sq;
+	if (single_mmap) {
+		ring->cq_ring = ring->sq_ring;
+	} else {
+		ring->cq_ring = mmap(NULL, ring->cq_ring_size,
+				     PROT_READ | PROT_WRITE,
+				     MAP_SHARED | MAP_POPULATE, fd,
+				     IORING_OFF_CQ_RING);
+		if (ring->cq_ring == MAP_FAILED)
+			goto fail_cq;
+	}
+	ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+	ring->sqes = mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE,
+			  MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+	if (ring->sqes == MAP_FAILED)
+		goto fail_sqes;
+
+	char *sq = ring->sq_ring;
+	ring->sq_head = (unsigned *)(sq + params.sq_off.head);
+	ring->sq_tail = (unsigned *)(sq + params.sq_off.tail);
+	ring->sq_mask = *(unsigned *)(sq + params.sq_off.ring_mask);
+	ring->sq_array = (unsigned *)(sq + params.sq_off.array);
+	ring->sq_entries = params.sq_entries;
+	char *cq = ring->cq_ring;
+	ring->cq_head = (unsigned *)(cq + params.cq_off.head);
+	ring->cq_tail = (unsigned *)(cq + params.cq_off.tail);
+	ring->cq_mask = *(unsigned *)(cq + params.cq_off.ring_mask);
+	ring->cqes = (struct io_uring_cqe *)(cq + params.cq_off.cqes);
+	ring->cq_entries = params.cq_entries;
+
+	ring->loop = loop();
+	ev_io_init(&ring->input, coio_uring_input_cb, fd, EV_READ);
+	ring->input.data = ring;
+	ev_io_start(ring->loop, &ring->input);
+	ev_prepare_init(&ring->flush, coio_uring_flush_cb);
+	ring->flush.data = ring;
+	coio_uring = ring;
+	say_verbose("using io_uring for file I/O");
+	return;
+fail_sqes:
+	if (!single_mmap)
+		munmap(ring->cq_ring, ring->cq_ring_size);
+fail_cq:
+	munmap(ring->sq_ring, ring->sq_ring_size);
+fail_sq:
+	say_syserror("io_uring mmap");
+	close(fd);
+	free(ring);
+}
+
+void
+coio_uring_disable(void)
+{
+	struct coio_uring *ring = coio_uring;
+	if (ring == NULL)
+		return;
+	coio_uring = NULL;
+	ev_io_stop(ring->loop, &ring->input);
+	ev_prepare_stop(ring->loop, &ring->flush);
+	munmap(ring->sqes, ring->sqes_size);
+	if (ring->cq_ring != ring->sq_ring)
+		munmap(ring->cq_ring, ring->cq_ring_size);
+	munmap(ring->sq_ring, ring->sq_ring_size);
+	close(ring->fd);
+	free(ring);
+}
+
+bool
+coio_uring_is_ready(void)
+{
+	struct coio_uring *ring = coio_uring;
+	return ring != NULL && coio_use_io_uring &&
+	       ring->in_flight < ring->cq_entries;
+}
+
+int
+coio_uring_open(const char *path, int flags, mode_t mode)
+{
+	struct coio_uring *ring = coio_uring;
+	struct io_uring_sqe *sqe = coio_uring_get_sqe(ring);
+	sqe->opcode = IORING_OP_OPENAT;
+	sqe->fd = AT_FDCWD;
+	sqe->addr = (uintptr_t)path;
+	sqe->len = mode;
+	sqe->open_flags = flags;
+	return coio_uring_wait(ring, sqe);
+}
+
+int
+coio_uring_close(int fd)
+{
+	struct coio_uring *ring = coio_uring;
+	struct io_uring_sqe *sqe = coio_uring_get_sqe(ring);
+	sqe->opcode = IORING_OP_CLOSE;
+	sqe->fd = fd;
+	return coio_uring_wait(ring, sqe);
+}
+
+ssize_t
+coio_uring_read(int fd, void *buf, size_t count, off_t offset)
+{
+	struct coio_uring *ring = coio_uring;
+	struct io_uring_sqe *sqe = coio_uring_get_sqe(ring);
+	sqe->opcode = IORING_OP_READ;
+	sqe->fd = fd;
+	sqe->addr = (uintptr_t)buf;
+	sqe->len = MIN(count, (size_t)COIO_URING_RW_MAX);
+	sqe->off = offset;
+	return coio_uring_wait(ring, sqe);
+}
+
+ssize_t
+coio_uring_write(int fd, const void *buf, size_t count, off_t offset)
+{
+	struct coio_uring *ring = coio_uring;
+	struct io_uring_sqe *sqe = coio_uring_get_sqe(ring);
+	sqe->opcode = IORING_OP_WRITE;
+	sqe->fd = fd;
+	sqe->addr = (uintptr_t)buf;
+	sqe->len = MIN(count, (size_t)COIO_URING_RW_MAX);
+	sqe->off = offset;
+	return coio_uring_wait(ring, sqe);
+}
+
+int
+coio_uring_fsync(int fd, bool datasync)
+{
+	struct coio_uring *ring = coio_uring;
+	struct io_uring_sqe *sqe = coio_uring_get_sqe(ring);
+	sqe->opcode = IORING_OP_FSYNC;
+	sqe->fd = fd;
+	sqe->fsync_flags = datasync ? IORING_FSYNC_DATASYNC : 0;
+	return coio_uring_wait(ring, sqe);
+}
+
+int
+coio_uring_stat(int fd, const char *path, bool nofollow, struct stat *buf)
+{
+	struct coio_uring *ring = coio_uring;
+	struct statx stx;
+	struct io_uring_sqe *sqe = coio_uring_get_sqe(ring);
+	sqe->opcode = IORING_OP_STATX;
+	if (path == NULL) {
+		sqe->fd = fd;
+		sqe->addr = (uintptr_t)"";
+		sqe->statx_flags = AT_EMPTY_PATH;
+	} else {
+		sqe->fd = AT_FDCWD;
+		sqe->addr = (uintptr_t)path;
+		sqe->statx_flags = nofollow ? AT_SYMLINK_NOFOLLOW : 0;
+	}
+	sqe->len = STATX_BASIC_STATS;
+	sqe->off = (uintptr_t)&stx;
+	if (coio_uring_wait(ring, sqe) < 0)
+		return -1;
+	memset(buf, 0, sizeof(*buf));
+	buf->st_dev = makedev(stx.stx_dev_major, stx.stx_dev_minor);
+	buf->st_ino = stx.stx_ino;
+	buf->st_mode = stx.stx_mode;
+	buf->st_nlink = stx.stx_nlink;
+	buf->st_uid = stx.stx_uid;
+	buf->st_gid = stx.stx_gid;
+	buf->st_rdev = makedev(stx.stx_rdev_major, stx.stx_rdev_minor);
+	buf->st_size = stx.stx_size;
+	buf->st_blksize = stx.stx_blksize;
+	buf->st_blocks = stx.stx_blocks;
+	buf->st_atim.tv_sec = stx.stx_atime.tv_sec;
+	buf->st_atim.tv_nsec = stx.stx_atime.tv_nsec;
+	buf->st_mtim.tv_sec = stx.stx_mtime.tv_sec;
+	buf->st_mtim.tv_nsec = stx.stx_mtime.tv_nsec;
+	buf->st_ctim.tv_sec = stx.stx_ctime.tv_sec;
+	buf->st_ctim.tv_nsec = stx.stx_ctime.tv_nsec;
+	return 0;
+}
+
+#else /* !defined(HAVE_IO_URING) */
+
+void
+coio_uring_enable(void)
+{
+}
+
+void
+coio_uring_disable(void)
+{
+}
+
+bool
+coio_uring_is_ready(void)
+{
+	return false;
+}
+
+int
+coio_uring_open(const char *path, int flags, mode_t mode)
+{
+	(void)path;
+	(void)flags;
+	(void)mode;
+	unreachable();
+	return -1;
+}
+
+int
+coio_uring_close(int fd)
+{
+	(void)fd;
+	unreachable();
+	return -1;
+}
+
+ssize_t
+coio_uring_read(int fd, void *buf, size_t count, off_t offset)
+{
+	(void)fd;
+	(void)buf;
+	(void)count;
+	(void)offset;
+	unreachable();
+	return -1;
+}
+
+ssize_t
+coio_uring_write(int fd, const void *buf, size_t count, off_t offset)
+{
+	(void)fd;
+	(void)buf;
+	(void)count;
+	(void)offset;
+	unreachable();
+	return -1;
+}
+
+int
+coio_uring_fsync(int fd, bool datasync)
+{
+	(void)fd;
+	(void)datasync;
+	unreachable();
+	return -1;
+}
+
+int
+coio_uring_stat(int fd, const char *path, bool nofollow, struct stat *buf)
+{
+	(void)fd;
+	(void)path;
+	(void)nofollow;
+	(void)buf;
+	unreachable();
+	return -1;
+}
+
+#endif /* !defined(HAVE_IO_URING) */
@@ -0,0 +1,76 @@
+#pragma once
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2024, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#include <stdbool.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+/**
+ * File I/O submitted to the kernel through io_uring from the
+ * cord event loop, without a round trip to the coio thread pool.
+ * A fiber that issues a request yields until the request is
+ * complete, exactly like with coio_file functions.
+ *
+ * Only the cords that called coio_uring_enable() use io_uring,
+ * and only if the build and the kernel support all the needed
+ * operations.
+ * The functions below must be called only if coio_uring_is_ready()
+ * returned true, and they follow the conventions of the matching
+ * system calls: on failure they return -1 and set errno.
+ */
+
+/**
+ * Set up an io_uring instance for the current cord. If io_uring
+ * is not supported by the kernel, or is disabled, does nothing.
+ */
+void
+coio_uring_enable(void);
+
+/** Destroy the io_uring instance of the current cord, if any. */
+void
+coio_uring_disable(void);
+
+/**
+ * Return true if the current cord may submit a request to
+ * io_uring right now.
+ */
+bool
+coio_uring_is_ready(void);
+
+/** open(2). */
+int
+coio_uring_open(const char *path, int flags, mode_t mode);
+
+/** close(2). */
+int
+coio_uring_close(int fd);
+
+/** pread(2), or read(2) if @a offset is -1. */
+ssize_t
+coio_uring_read(int fd, void *buf, size_t count, off_t offset);
+
+/** pwrite(2), or write(2) if @a offset is -1. */
+ssize_t
+coio_uring_write(int fd, const void *buf, size_t count, off_t offset);
+
+/** fsync(2), or fdatasync(2) if @a datasync is set. */
+int
+coio_uring_fsync(int fd, bool datasync);
+
+/**
+ * stat(2) of @a path, lstat(2) if @a nofollow is set, or
+ * fstat(2) of @a fd if @a path is NULL.
+ */
+int
+coio_uring_stat(int fd, const char *path, bool nofollow, struct stat *buf);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
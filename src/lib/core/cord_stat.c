@@ -0,0 +1,351 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2024, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#include "cord_stat.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <string.h>
+#include <time.h>
+
+#include "clock.h"
+#include "diag.h"
+#include "fiber.h"
+#include "say.h"
+#include "trivia/util.h"
+#include "tt_pthread.h"
+
+/** Period of the load calculation, in nanoseconds. */
+static const uint64_t CORD_STAT_LOAD_PERIOD = 1000000000;
+
+/**
+ * Signal sent by the watchdog to a blocked cord to collect the
+ * backtrace of the fiber that blocks it.
+ */
+#if defined(__linux__) && defined(ENABLE_BACKTRACE)
+#define CORD_WATCHDOG_SIGNAL (SIGRTMIN + 4)
+#endif
+
+enum cord_stall_state {
+	/** No stall is detected. */
+	CORD_STALL_NONE,
+	/** The watchdog detected a stall and requested a backtrace. */
+	CORD_STALL_DETECTED,
+	/** The cord collected the backtrace, the stall is to be logged. */
+	CORD_STALL_CAPTURED,
+};
+
+/** All cords with an event loop, protected by the mutex. */
+static RLIST_HEAD(cord_registry);
+static pthread_mutex_t cord_registry_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static struct {
+	/** The watchdog thread. */
+	pthread_t thread;
+	/** Set while the watchdog thread is running. */
+	bool is_running;
+	/** Set to stop the watchdog thread, protected by the mutex. */
+	bool is_stopping;
+	/** Stall threshold, in nanoseconds. */
+	uint64_t threshold;
+	/** Signaled to wake up the watchdog thread on stop. */
+	pthread_cond_t cond;
+} cord_watchdog = {
+	.cond = PTHREAD_COND_INITIALIZER,
+};
+
+/** Log the stall detected by the watchdog once it's over. */
+static void
+cord_stat_report_stall(struct cord *cord, uint64_t now)
+{
+	struct cord_stat *stat = &cord->stat;
+	double duration = (double)(now - stat->stall_start) / 1e9;
+	if (stat->stall_fid == 0) {
+		say_warn("a fiber blocked the event loop of cord '%s' "
+			 "for %.3f sec", cord->name, duration);
+	} else {
+		struct fiber *f = stat->stall_fid == FIBER_ID_SCHED ?
+				  &cord->sched : fiber_find(stat->stall_fid);
+		say_warn("fiber '%s' (%llu) blocked the event loop of "
+			 "cord '%s' for %.3f sec",
+			 f != NULL ? fiber_name(f) : "<dead>",
+			 (unsigned long long)stat->stall_fid, cord->name,
+			 duration);
+	}
+#ifdef ENABLE_BACKTRACE
+	char buf[4096];
+	if (stat->stall_bt.frame_count > 0 &&
+	    backtrace_snprint(buf, sizeof(buf), &stat->stall_bt) > 0)
+		say_warn("the fiber was blocked at:\n%s", buf);
+#endif
+	__atomic_store_n(&stat->stalls, stat->stalls + 1, __ATOMIC_RELAXED);
+}
+
+/** Called before the event loop waits for events. */
+static void
+cord_stat_prepare_cb(struct ev_loop *loop, struct ev_prepare *watcher,
+		     int revents)
+{
+	(void)loop;
+	(void)watcher;
+	(void)revents;
+	struct cord *cord = cord();
+	struct cord_stat *stat = &cord->stat;
+	uint64_t now = clock_monotonic64();
+	uint64_t busy = now - stat->iteration_start;
+	__atomic_store_n(&stat->busy, stat->busy + busy, __ATOMIC_RELAXED);
+	stat->period_busy += busy;
+	if (now - stat->period_start >= CORD_STAT_LOAD_PERIOD) {
+		uint64_t load = stat->period_busy * 1000 /
+				(now - stat->period_start);
+		__atomic_store_n(&stat->load, load, __ATOMIC_RELAXED);
+		stat->period_start = now;
+		stat->period_busy = 0;
+	}
+	if (__atomic_load_n(&stat->stall_state, __ATOMIC_ACQUIRE) ==
+	    CORD_STALL_CAPTURED) {
+		cord_stat_report_stall(cord, now);
+		__atomic_store_n(&stat->stall_state, CORD_STALL_NONE,
+				 __ATOMIC_RELEASE);
+	}
+	stat->poll_start = now;
+	__atomic_store_n(&stat->is_idle, true, __ATOMIC_RELAXED);
+}
+
+/** Called after the event loop waited for events. */
+static void
+cord_stat_check_cb(struct ev_loop *loop, struct ev_check *watcher,
+		   int revents)
+{
+	(void)loop;
+	(void)watcher;
+	(void)revents;
+	struct cord_stat *stat = &cord()->stat;
+	uint64_t now = clock_monotonic64();
+	__atomic_store_n(&stat->is_idle, false, __ATOMIC_RELAXED);
+	__atomic_store_n(&stat->idle, stat->idle + now - stat->poll_start,
+			 __ATOMIC_RELAXED);
+	stat->iteration_start = now;
+}
+
+#ifdef CORD_WATCHDOG_SIGNAL
+/**
+ * Runs in the thread of a blocked cord, on the stack of the fiber
+ * that blocks it, so the backtrace shows where the fiber spins.
+ */
+static void
+cord_watchdog_signal_handler(int signum)
+{
+	(void)signum;
+	int errsv = errno;
+	struct cord *cord = cord_ptr;
+	if (cord == NULL || __atomic_load_n(&cord->stat.stall_state,
+					     __ATOMIC_ACQUIRE) !=
+			    CORD_STALL_DETECTED)
+		goto out;
+	cord->stat.stall_fid = cord->fiber->fid;
+	/* Skip the signal handler and the signal trampoline. */
+	backtrace_collect(&cord->stat.stall_bt, NULL, 2);
+	__atomic_store_n(&cord->stat.stall_state, CORD_STALL_CAPTURED,
+			 __ATOMIC_RELEASE);
+out:
+	errno = errsv;
+}
+
+/** Install the signal handler, called once. */
+static void
+cord_watchdog_install_handler(void)
+{
+	struct sigaction sa;
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = cord_watchdog_signal_handler;
+	sa.sa_flags = SA_RESTART;
+	sigemptyset(&sa.sa_mask);
+	if (sigaction(CORD_WATCHDOG_SIGNAL, &sa, NULL) != 0)
+		say_syserror("sigaction");
+}
+#endif /* defined(CORD_WATCHDOG_SIGNAL) */
+
+void
+cord_stat_start(struct cord *cord)
+{
+	assert(cord == cord());
+	struct cord_stat *stat = &cord->stat;
+	memset(stat, 0, sizeof(*stat));
+	if (cord->loop == NULL)
+		return;
+	uint64_t now = clock_monotonic64();
+	stat->iteration_start = now;
+	stat->period_start = now;
+	ev_prepare_init(&stat->prepare, cord_stat_prepare_cb);
+	ev_set_priority(&stat->prepare, EV_MINPRI);
+	ev_prepare_start(cord->loop, &stat->prepare);
+	ev_check_init(&stat->check, cord_stat_check_cb);
+	ev_set_priority(&stat->check, EV_MAXPRI);
+	ev_check_start(cord->loop, &stat->check);
+	/* The watchers must not keep the event loop running. */
+	ev_unref(cord->loop);
+	ev_unref(cord->loop);
+#ifdef CORD_WATCHDOG_SIGNAL
+	/* Threads other than the main one block all signals. */
+	sigset_t set;
+	sigemptyset(&set);
+	sigaddset(&set, CORD_WATCHDOG_SIGNAL);
+	pthread_sigmask(SIG_UNBLOCK, &set, NULL);
+#endif
+	tt_pthread_mutex_lock(&cord_registry_mutex);
+	rlist_add_tail_entry(&cord_registry, stat, in_registry);
+	stat->is_registered = true;
+	tt_pthread_mutex_unlock(&cord_registry_mutex);
+}
+
+void
+cord_stat_stop(struct cord *cord)
+{
+	assert(cord == cord());
+	struct cord_stat *stat = &cord->stat;
+	if (!stat->is_registered)
+		return;
+	tt_pthread_mutex_lock(&cord_registry_mutex);
+	rlist_del_entry(stat, in_registry);
+	stat->is_registered = false;
+	tt_pthread_mutex_unlock(&cord_registry_mutex);
+	ev_ref(cord->loop);
+	ev_ref(cord->loop);
+	ev_prepare_stop(cord->loop, &stat->prepare);
+	ev_check_stop(cord->loop, &stat->check);
+}
+
+int
+cord_stat_foreach(cord_stat_cb cb, void *arg)
+{
+	int rc = 0;
+	tt_pthread_mutex_lock(&cord_registry_mutex);
+	struct cord_stat *stat;
+	rlist_foreach_entry(stat, &cord_registry, in_registry) {
+		struct cord *cord = container_of(stat, struct cord, stat);
+		struct cord_stat_info info;
+		info.name = cord->name;
+		info.busy = __atomic_load_n(&stat->busy, __ATOMIC_RELAXED) /
+			    1e9;
+		info.idle = __atomic_load_n(&stat->idle, __ATOMIC_RELAXED) /
+			    1e9;
+		info.load = __atomic_load_n(&stat->load, __ATOMIC_RELAXED) /
+			    1e3;
+		info.csw = __atomic_load_n(&stat->csw, __ATOMIC_RELAXED);
+		info.stalls = __atomic_load_n(&stat->stalls, __ATOMIC_RELAXED);
+		rc = cb(&info, arg);
+		if (rc != 0)
+			break;
+	}
+	tt_pthread_mutex_unlock(&cord_registry_mutex);
+	return rc;
+}
+
+/** Check if a cord is blocked by a fiber, called under the lock. */
+static void
+cord_watchdog_check(struct cord *cord, uint64_t now)
+{
+	struct cord_stat *stat = &cord->stat;
+	uint64_t csw = __atomic_load_n(&stat->csw, __ATOMIC_RELAXED);
+	if (csw != stat->watchdog_csw ||
+	    __atomic_load_n(&stat->is_idle, __ATOMIC_RELAXED)) {
+		stat->watchdog_csw = csw;
+		stat->watchdog_time = now;
+		return;
+	}
+	if (now - stat->watchdog_time < cord_watchdog.threshold)
+		return;
+	int state = CORD_STALL_NONE;
+	if (!__atomic_compare_exchange_n(&stat->stall_state, &state,
+					 CORD_STALL_DETECTED, false,
+					 __ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+		return;
+	stat->stall_start = stat->watchdog_time;
+#ifdef CORD_WATCHDOG_SIGNAL
+	pthread_kill(cord->id, CORD_WATCHDOG_SIGNAL);
+#else
+	/* No backtrace, report the stall as soon as it's over. */
+	stat->stall_fid = 0;
+	__atomic_store_n(&stat->stall_state, CORD_STALL_CAPTURED,
+			 __ATOMIC_RELEASE);
+#endif
+}
+
+static void *
+cord_watchdog_f(void *arg)
+{
+	(void)arg;
+	tt_pthread_setname("watchdog");
+	tt_pthread_mutex_lock(&cord_registry_mutex);
+	while (!cord_watchdog.is_stopping) {
+		/* Check a few times per threshold to detect stalls early. */
+		uint64_t period = cord_watchdog.threshold / 4;
+		struct timespec ts;
+		clock_gettime(CLOCK_REALTIME, &ts);
+		uint64_t deadline = ts.tv_sec * 1000000000ULL + ts.tv_nsec +
+				    period;
+		ts.tv_sec = deadline / 1000000000ULL;
+		ts.tv_nsec = deadline % 1000000000ULL;
+		pthread_cond_timedwait(&cord_watchdog.cond,
+				       &cord_registry_mutex, &ts);
+		if (cord_watchdog.is_stopping)
+			break;
+		uint64_t now = clock_monotonic64();
+		struct cord_stat *stat;
+		rlist_foreach_entry(stat, &cord_registry, in_registry) {
+			cord_watchdog_check(container_of(stat, struct cord,
+							 stat), now);
+		}
+	}
+	tt_pthread_mutex_unlock(&cord_registry_mutex);
+	return NULL;
+}
+
+int
+cord_watchdog_enable(double threshold)
+{
+	if (threshold <= 0) {
+		diag_set(IllegalParams, "threshold must be positive");
+		return -1;
+	}
+	tt_pthread_mutex_lock(&cord_registry_mutex);
+	cord_watchdog.threshold = threshold * 1e9;
+	tt_pthread_mutex_unlock(&cord_registry_mutex);
+	if (cord_watchdog.is_running)
+		return 0;
+#ifdef CORD_WATCHDOG_SIGNAL
+	static pthread_once_t once = PTHREAD_ONCE_INIT;
+	pthread_once(&once, cord_watchdog_install_handler);
+#endif
+	cord_watchdog.is_stopping = false;
+	if (tt_pthread_create(&cord_watchdog.thread, NULL,
+			      cord_watchdog_f, NULL) != 0) {
+		diag_set(SystemError, "failed to create watchdog thread");
+		return -1;
+	}
+	cord_watchdog.is_running = true;
+	return 0;
+}
+
+void
+cord_watchdog_disable(void)
+{
+	if (!cord_watchdog.is_running)
+		return;
+	tt_pthread_mutex_lock(&cord_registry_mutex);
+	cord_watchdog.is_stopping = true;
+	tt_pthread_cond_signal(&cord_watchdog.cond);
+	tt_pthread_mutex_unlock(&cord_registry_mutex);
+	tt_pthread_join(cord_watchdog.thread, NULL);
+	cord_watchdog.is_running = false;
+}
+
+bool
+cord_watchdog_is_enabled(void)
+{
+	return cord_watchdog.is_running;
+}
@@ -0,0 +1,138 @@
+#pragma once
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2024, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <tarantool_ev.h>
+
+#include "backtrace.h"
+#include "small/rlist.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+struct cord;
+
+/**
+ * Event loop statistics of a cord and the state of the stall
+ * watchdog for it.
+ *
+ * The counters are updated by the cord thread on every event loop
+ * iteration and are read by other threads, so they are accessed
+ * atomically. The watchdog fields are protected by the registry
+ * mutex.
+ */
+struct cord_stat {
+	/** Time spent handling events, in nanoseconds. */
+	uint64_t busy;
+	/** Time spent waiting for events, in nanoseconds. */
+	uint64_t idle;
+	/** Share of busy time over the last complete period, permille. */
+	uint64_t load;
+	/** Number of context switches. */
+	uint64_t csw;
+	/** Number of times a fiber blocked the cord for too long. */
+	uint64_t stalls;
+	/** Set while the event loop waits for events. */
+	bool is_idle;
+	/** Set if the cord is in the registry. */
+	bool is_registered;
+	/** Time the current event loop iteration started. */
+	uint64_t iteration_start;
+	/** Time the event loop started waiting for events. */
+	uint64_t poll_start;
+	/** Start of the current period of the load calculation. */
+	uint64_t period_start;
+	/** Busy time within the current period. */
+	uint64_t period_busy;
+	/** Watcher called before waiting for events. */
+	struct ev_prepare prepare;
+	/** Watcher called after waiting for events. */
+	struct ev_check check;
+	/** Link in the registry of cords. */
+	struct rlist in_registry;
+	/** Number of context switches seen by the watchdog. */
+	uint64_t watchdog_csw;
+	/** Time the watchdog saw the last context switch. */
+	uint64_t watchdog_time;
+	/** See enum cord_stall_state. */
+	int stall_state;
+	/** Time the current stall started. */
+	uint64_t stall_start;
+	/** Id of the fiber that blocks the cord. */
+	uint64_t stall_fid;
+#ifdef ENABLE_BACKTRACE
+	/** Backtrace of the fiber that blocks the cord. */
+	struct backtrace stall_bt;
+#endif
+};
+
+/** Event loop statistics of a cord, as reported to the user. */
+struct cord_stat_info {
+	/** Name of the cord. */
+	const char *name;
+	/** Time spent handling events, in seconds. */
+	double busy;
+	/** Time spent waiting for events, in seconds. */
+	double idle;
+	/** Share of busy time over the last second. */
+	double load;
+	/** Number of context switches. */
+	uint64_t csw;
+	/** Number of times a fiber blocked the cord for too long. */
+	uint64_t stalls;
+};
+
+/**
+ * Start collecting the event loop statistics of the current cord
+ * and register it for the watchdog. Does nothing if the cord has
+ * no event loop.
+ */
+void
+cord_stat_start(struct cord *cord);
+
+/** Unregister the current cord and stop collecting its statistics. */
+void
+cord_stat_stop(struct cord *cord);
+
+/** Account a context switch in the current cord. */
+static inline void
+cord_stat_on_csw(struct cord_stat *stat)
+{
+	__atomic_store_n(&stat->csw, stat->csw + 1, __ATOMIC_RELAXED);
+}
+
+typedef int
+(*cord_stat_cb)(const struct cord_stat_info *info, void *arg);
+
+/**
+ * Call @a cb for each running cord. Iteration stops if @a cb
+ * returns non-zero, the value is returned then.
+ */
+int
+cord_stat_foreach(cord_stat_cb cb, void *arg);
+
+/**
+ * Start the watchdog thread that logs a warning, with a backtrace
+ * if possible, when a fiber keeps any cord busy for longer than
+ * @a threshold seconds without yielding. If the watchdog is already
+ * running, only updates the threshold.
+ */
+int
+cord_watchdog_enable(double threshold);
+
+/** Stop the watchdog thread. */
+void
+cord_watchdog_disable(void);
+
+/** True if the watchdog thread is running. */
+bool
+cord_watchdog_is_enabled(void);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
@@ -531,3 +531,128 @@ decimal_unpack(const char **data, uint32_t len, decimal_t *dec)
 	}
 	return res;
 }
+
+/** Powers of 10 that fit in int64. */
+static const int64_t decimal_pow10[] = {
+	1LL, 10LL, 100LL, 1000LL, 10000LL, 100000LL, 1000000LL, 10000000LL,
+	100000000LL, 1000000000LL, 10000000000LL, 100000000000LL,
+	1000000000000LL, 10000000000000LL, 100000000000000LL,
+	1000000000000000LL, 10000000000000000LL, 100000000000000000LL,
+	1000000000000000000LL,
+};
+
+/**
+ * Multiply a coefficient with at most DECIMAL_INT64_MAX_DIGITS digits
+ * by 10^n. Returns false on overflow.
+ */
+static bool
+decimal_int64_mul_pow10(int64_t *coef, int32_t n)
+{
+	assert(n >= 0);
+	if (*coef == 0)
+		return true;
+	if (n >= (int32_t)lengthof(decimal_pow10))
+		return false;
+	int64_t p = decimal_pow10[n];
+	if (*coef > INT64_MAX / p || *coef < -INT64_MAX / p)
+		return false;
+	*coef *= p;
+	return true;
+}
+
+bool
+decimal_unpack_int64(const char *data, uint32_t len, int64_t *coef,
+		     int32_t *scale)
+{
+	assert(len > 0);
+	const char *end = data + len;
+	enum mp_type type = mp_typeof(*data);
+	if (type == MP_UINT) {
+		if (mp_check_uint(data, end) > 0)
+			return false;
+		uint64_t value = mp_decode_uint(&data);
+		if (value > DECIMAL_MAX_DIGITS)
+			return false;
+		*scale = value;
+	} else if (type == MP_INT) {
+		if (mp_check_int(data, end) > 0)
+			return false;
+		int64_t value = mp_decode_int(&data);
+		if (value <= -DECIMAL_MAX_DIGITS)
+			return false;
+		*scale = value;
+	} else {
+		return false;
+	}
+	if (data == end)
+		return false;
+	/*
+	 * BCD digits, two per byte, followed by the sign nibble. See
+	 * decimal_pack().
+	 */
+	uint32_t nibble_count = 2 * (end - data) - 1;
+	int64_t value = 0;
+	int digits = 0;
+	for (uint32_t i = 0; i < nibble_count; i++) {
+		uint8_t byte = data[i / 2];
+		uint8_t digit = i % 2 == 0 ? byte >> 4 : byte & 0x0f;
+		if (digit > 9)
+			return false;
+		if (value == 0 && digit == 0)
+			continue;
+		if (++digits > DECIMAL_INT64_MAX_DIGITS)
+			return false;
+		value = value * 10 + digit;
+	}
+	/* Same limit as decimal_precision() checked by decimal_unpack(). */
+	if (*scale < 0 && digits - *scale > DECIMAL_MAX_DIGITS)
+		return false;
+	uint8_t sign = end[-1] & 0x0f;
+	if (sign <= 9)
+		return false;
+	/* 0x0d is written for negative values, 0x0b is also accepted. */
+	*coef = sign == 0x0d || sign == 0x0b ? -value : value;
+	return true;
+}
+
+int
+decimal_compare_int64(int64_t lhs_coef, int32_t lhs_scale,
+		      int64_t rhs_coef, int32_t rhs_scale)
+{
+	int lhs_sign = (lhs_coef > 0) - (lhs_coef < 0);
+	int rhs_sign = (rhs_coef > 0) - (rhs_coef < 0);
+	if (lhs_sign != rhs_sign)
+		return lhs_sign < rhs_sign ? -1 : 1;
+	if (lhs_sign == 0)
+		return 0;
+	/*
+	 * Bring the coefficients to the same scale. If one of them
+	 * overflows, its magnitude exceeds 10^18, so it is greater than
+	 * the magnitude of the other one.
+	 */
+	if (lhs_scale < rhs_scale) {
+		if (!decimal_int64_mul_pow10(&lhs_coef, rhs_scale - lhs_scale))
+			return lhs_sign;
+	} else if (lhs_scale > rhs_scale) {
+		if (!decimal_int64_mul_pow10(&rhs_coef, lhs_scale - rhs_scale))
+			return -rhs_sign;
+	}
+	return (lhs_coef > rhs_coef) - (lhs_coef < rhs_coef);
+}
+
+bool
+decimal_int64_to_int64(int64_t coef, int32_t scale, int64_t *num)
+{
+	if (scale <= 0) {
+		if (!decimal_int64_mul_pow10(&coef, -scale))
+			return false;
+		*num = coef;
+	} else if (scale < (int32_t)lengthof(decimal_pow10)) {
+		/* Division rounds towards zero. */
+		*num = coef / decimal_pow10[scale];
+	} else {
+		/* The coefficient is less than 10^18 by magnitude. */
+		*num = 0;
+	}
+	return true;
+}
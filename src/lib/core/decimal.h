@@ -282,6 +282,45 @@ decimal_pack(char *data, const decimal_t *dec);
 decimal_t *
 decimal_unpack(const char **data, uint32_t len, decimal_t *dec);
 
+/**
+ * Decimals with up to this many significant digits have a fast path
+ * that works with a scaled int64 coefficient instead of decNumber.
+ */
+enum { DECIMAL_INT64_MAX_DIGITS = 18 };
+
+/**
+ * Using a packed representation of size \a len pointed to by \a data,
+ * unpack it to an integer coefficient and a scale, so that the value is
+ * \a coef * 10^-\a scale. This is several times cheaper than
+ * decimal_unpack(), but works only for values that have at most
+ * DECIMAL_INT64_MAX_DIGITS significant digits.
+ *
+ * @return false if the value has more digits or its encoding is
+ *         incorrect, in which case decimal_unpack() must be used.
+ *         true otherwise.
+ */
+bool
+decimal_unpack_int64(const char *data, uint32_t len, int64_t *coef,
+		     int32_t *scale);
+
+/**
+ * Compare two decimals unpacked with decimal_unpack_int64().
+ *
+ * @return the same as decimal_compare() for the decimals.
+ */
+int
+decimal_compare_int64(int64_t lhs_coef, int32_t lhs_scale,
+		      int64_t rhs_coef, int32_t rhs_scale);
+
+/**
+ * Convert a decimal unpacked with decimal_unpack_int64() to an integer
+ * rounding towards zero, like decimal_to_int64() does.
+ *
+ * @return false if the integer doesn't fit in int64, true otherwise.
+ */
+bool
+decimal_int64_to_int64(int64_t coef, int32_t scale, int64_t *num);
+
 #if defined(__cplusplus)
 } /* extern "C" */
 #endif /* defined(__cplusplus) */
@@ -57,6 +57,11 @@ struct evio_service_entry {
 	struct ev_io ev;
 	/** Pointer to the root evio_service, which contains this object */
 	struct evio_service *service;
+	/**
+	 * Set if the acceptor socket was created by this entry on attach
+	 * and so must be closed on detach.
+	 */
+	bool owns_fd;
 };
 
 static int
@@ -148,6 +153,23 @@ evio_setsockopt_server(int fd, int family, int type)
 	return 0;
 }
 
+/**
+ * Set SO_REUSEPORT so that several sockets can listen on the same address.
+ * Linux balances incoming connections between such sockets.
+ */
+static int
+evio_setsockopt_reuseport(int fd)
+{
+#ifdef SO_REUSEPORT
+	int on = 1;
+	return sio_setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on));
+#else
+	(void)fd;
+	diag_set(IllegalParams, "SO_REUSEPORT is not supported");
+	return -1;
+#endif
+}
+
 static inline const char *
 evio_service_name(struct evio_service *service)
 {
@@ -254,6 +276,10 @@ evio_service_entry_bind_addr(struct evio_service_entry *entry)
 				   SOCK_STREAM) != 0)
 		goto error;
 
+	if (entry->service->reuseport && entry->addr.sa_family != AF_UNIX &&
+	    evio_setsockopt_reuseport(fd) != 0)
+		goto error;
+
 	if (sio_bind(fd, &entry->addr, entry->addr_len) != 0)
 		goto error;
 
@@ -312,6 +338,7 @@ evio_service_entry_create(struct evio_service_entry *entry,
 	ev_io_set(&entry->ev, -1, 0);
 	entry->ev.data = entry;
 	entry->service = service;
+	entry->owns_fd = false;
 }
 
 /**
@@ -377,6 +404,9 @@ evio_service_entry_detach(struct evio_service_entry *entry)
 		ev_io_stop(entry->service->loop, &entry->ev);
 		entry->addr_len = 0;
 	}
+	if (entry->owns_fd && close(entry->ev.fd) < 0)
+		say_error("Failed to close socket: %s", tt_strerror(errno));
+	entry->owns_fd = false;
 	ev_io_set(&entry->ev, -1, 0);
 	uri_destroy(&entry->uri);
 }
@@ -385,6 +415,7 @@ evio_service_entry_detach(struct evio_service_entry *entry)
 static void
 evio_service_entry_stop(struct evio_service_entry *entry)
 {
+	assert(!entry->owns_fd);
 	int service_fd = entry->ev.fd;
 	evio_service_entry_detach(entry);
 	if (service_fd < 0)
@@ -402,9 +433,10 @@ evio_service_entry_stop(struct evio_service_entry *entry)
 	}
 }
 
+/** Start accepting connections on @a fd for the @a src entry address. */
 static void
-evio_service_entry_attach(struct evio_service_entry *dst,
-			 const struct evio_service_entry *src)
+evio_service_entry_attach_fd(struct evio_service_entry *dst,
+			     const struct evio_service_entry *src, int fd)
 {
 	assert(!ev_is_active(&dst->ev));
 	uri_destroy(&dst->uri);
@@ -412,10 +444,51 @@ evio_service_entry_attach(struct evio_service_entry *dst,
 	dst->addrstorage = src->addrstorage;
 	dst->addr_len = src->addr_len;
 	iostream_ctx_copy(&dst->io_ctx, &src->io_ctx);
-	ev_io_set(&dst->ev, src->ev.fd, EV_READ);
+	ev_io_set(&dst->ev, fd, EV_READ);
 	ev_io_start(dst->service->loop, &dst->ev);
 }
 
+static void
+evio_service_entry_attach(struct evio_service_entry *dst,
+			 const struct evio_service_entry *src)
+{
+	evio_service_entry_attach_fd(dst, src, src->ev.fd);
+}
+
+/**
+ * Create a socket listening on the address of the @a src entry, which must
+ * be bound with SO_REUSEPORT, and attach it to @a dst. Falls back on sharing
+ * the @a src socket on failure.
+ */
+static void
+evio_service_entry_attach_reuseport(struct evio_service_entry *dst,
+				    const struct evio_service_entry *src)
+{
+	if (src->addr.sa_family == AF_UNIX)
+		goto share;
+	int fd = sio_socket(src->addr.sa_family, SOCK_STREAM, IPPROTO_TCP);
+	if (fd < 0)
+		goto error;
+	if (evio_setsockopt_server(fd, src->addr.sa_family,
+				   SOCK_STREAM) != 0 ||
+	    evio_setsockopt_reuseport(fd) != 0 ||
+	    sio_bind(fd, &src->addr, src->addr_len) != 0 ||
+	    sio_listen(fd) != 0) {
+		close(fd);
+		goto error;
+	}
+	evio_service_entry_attach_fd(dst, src, fd);
+	dst->owns_fd = true;
+	return;
+error:
+	say_warn("%s: failed to listen on %s with SO_REUSEPORT: %s",
+		 evio_service_name(dst->service),
+		 sio_strfaddr(&src->addr, src->addr_len),
+		 diag_last_error(diag_get())->errmsg);
+share:
+	evio_service_entry_attach(dst, src);
+}
+
 /** Recreate the IO stream contexts from the service entry URI. */
 static int
 evio_service_entry_reload_uri(struct evio_service_entry *entry)
@@ -485,6 +558,19 @@ evio_service_attach(struct evio_service *dst, const struct evio_service *src)
 		evio_service_entry_attach(&dst->entries[i], &src->entries[i]);
 }
 
+void
+evio_service_attach_reuseport(struct evio_service *dst,
+			      const struct evio_service *src)
+{
+	assert(dst->entry_count == 0);
+	assert(src->reuseport);
+	evio_service_create_entries(dst, src->entry_count);
+	for (int i = 0; i < src->entry_count; i++) {
+		evio_service_entry_attach_reuseport(&dst->entries[i],
+						    &src->entries[i]);
+	}
+}
+
 void
 evio_service_detach(struct evio_service *service)
 {
@@ -88,6 +88,13 @@ struct evio_service {
         evio_accept_f on_accept;
         void *on_accept_param;
         ev_loop *loop;
+        /**
+         * If set, TCP sockets are bound with SO_REUSEPORT so that
+         * evio_service_attach_reuseport() can add more sockets
+         * listening on the same addresses. Must be set before
+         * the service is started.
+         */
+        bool reuseport;
 };
 
 /**
@@ -127,6 +134,18 @@ evio_service_stop(struct evio_service *service);
 void
 evio_service_attach(struct evio_service *dst, const struct evio_service *src);
 
+/**
+ * Like evio_service_attach(), but instead of sharing the TCP acceptor
+ * sockets of @a src, creates own sockets listening on the same addresses
+ * with SO_REUSEPORT, so that the kernel balances incoming connections
+ * between the services. @a src must be started with the reuseport flag.
+ * UNIX sockets are shared. If a socket can't be created, the one of @a src
+ * is shared and a warning is logged. The own sockets are closed on detach.
+ */
+void
+evio_service_attach_reuseport(struct evio_service *dst,
+			      const struct evio_service *src);
+
 /**
  * Reload service URIs.
  *
@@ -46,6 +46,8 @@
 #include "clock.h"
 #include "tt_sigaction.h"
 #include "tt_static.h"
+#include "tweaks.h"
+#include "usdt.h"
 
 extern void cord_on_yield(void);
 
@@ -293,6 +295,7 @@ static inline void
 clock_set_on_csw(struct fiber *caller)
 {
 	caller->csw++;
+	cord_stat_on_csw(&cord()->stat);
 
 	if (!fiber_top_enabled)
 		return;
@@ -466,9 +469,14 @@ cord_reset_slice(struct fiber *f)
 	cord()->slice = new_slice;
 }
 
+uint64_t fiber_custom_stack_cache_size = 16 * 1024 * 1024;
+TWEAK_UINT(fiber_custom_stack_cache_size);
+
 /**
  * True if a fiber with `fiber_flags` can be reused.
  * A fiber can not be reused if it is somehow non-standard.
+ * Fibers with a custom stack size are kept in a separate
+ * cache, see cord->dead_custom.
  */
 static bool
 fiber_is_reusable(uint32_t fiber_flags)
@@ -508,6 +516,7 @@ fiber_call_impl(struct fiber *callee)
 	if (cord_is_main())
 		cord_reset_slice(callee);
 
+	USDT_PROBE(fiber_switch, caller->fid, callee->fid);
 	ASAN_START_SWITCH_FIBER(asan_state, 1,
 				callee->stack,
 				callee->stack_size);
@@ -857,6 +866,7 @@ fiber_yield_impl(MAYBE_UNUSED bool will_switch_back)
 	cord->fiber = callee;
 	callee->flags = (callee->flags & ~FIBER_IS_READY) | FIBER_IS_RUNNING;
 
+	USDT_PROBE(fiber_switch, caller->fid, callee->fid);
 	ASAN_START_SWITCH_FIBER(asan_state, will_switch_back, callee->stack,
 				callee->stack_size);
 	coro_transfer(&caller->ctx, &callee->ctx);
@@ -1069,10 +1079,15 @@ fiber_recycle(struct fiber *fiber)
 	region_set_callbacks(&fiber->gc, NULL, NULL, NULL);
 #endif
 	region_free(&fiber->gc);
+	struct cord *cord = cord();
 	if (fiber_is_reusable(fiber->flags)) {
-		rlist_move_entry(&cord()->dead, fiber, link);
+		rlist_move_entry(&cord->dead, fiber, link);
+	} else if (cord->dead_custom_size + fiber->stack_size <=
+		   fiber_custom_stack_cache_size) {
+		rlist_move_entry(&cord->dead_custom, fiber, link);
+		cord->dead_custom_size += fiber->stack_size;
 	} else {
-		cord_add_garbage(cord(), fiber);
+		cord_add_garbage(cord, fiber);
 	}
 }
 
@@ -1542,6 +1557,102 @@ fiber_gc_checker_init(struct fiber *fiber)
 #endif
 }
 
+/**
+ * Allocate a new fiber with a new stack. The fiber is not linked to
+ * any list of the cord.
+ */
+static struct fiber *
+fiber_alloc(struct cord *cord, const struct fiber_attr *fiber_attr)
+{
+	struct fiber *fiber = (struct fiber *)
+		mempool_alloc(&cord->fiber_mempool);
+	if (fiber == NULL) {
+		diag_set(OutOfMemory, sizeof(struct fiber),
+			 "fiber pool", "fiber");
+		return NULL;
+	}
+	memset(fiber, 0, sizeof(struct fiber));
+	fiber->storage.lua.storage_ref = FIBER_LUA_NOREF;
+	fiber->storage.lua.fid_ref = FIBER_LUA_NOREF;
+
+	double start = clock_monotonic();
+	if (fiber_stack_create(fiber, fiber_attr, &cord->slabc)) {
+		mempool_free(&cord->fiber_mempool, fiber);
+		return NULL;
+	}
+	fiber->stack_size_requested = fiber_attr->stack_size;
+	coro_create(&fiber->ctx, fiber_loop, NULL,
+		    fiber->stack, fiber->stack_size);
+	cord->create_stat.create_time += clock_monotonic() - start;
+	cord->create_stat.created++;
+
+	region_create(&fiber->gc, &cord->slabc);
+
+	rlist_create(&fiber->state);
+	rlist_create(&fiber->wake);
+	rlist_create(&fiber->link);
+	diag_create(&fiber->diag);
+	fiber_reset(fiber);
+	return fiber;
+}
+
+/**
+ * Take a dead fiber suitable for the given attributes from the caches
+ * of the cord. A fiber with a custom stack is reused only if its stack
+ * is not less than requested and not more than twice as large, to
+ * avoid wasting big stacks on small fibers. Returns NULL if there is
+ * no such fiber.
+ */
+static struct fiber *
+cord_take_dead_fiber(struct cord *cord, const struct fiber_attr *fiber_attr)
+{
+	if (fiber_is_reusable(fiber_attr->flags)) {
+		if (rlist_empty(&cord->dead))
+			return NULL;
+		return rlist_first_entry(&cord->dead, struct fiber, link);
+	}
+	size_t size = fiber_attr->stack_size;
+	struct fiber *fiber, *best = NULL;
+	rlist_foreach_entry(fiber, &cord->dead_custom, link) {
+		if (fiber->stack_size_requested < size ||
+		    fiber->stack_size_requested / 2 > size)
+			continue;
+		if (best == NULL ||
+		    fiber->stack_size_requested < best->stack_size_requested)
+			best = fiber;
+		if (best->stack_size_requested == size)
+			break;
+	}
+	if (best != NULL) {
+		assert(cord->dead_custom_size >= best->stack_size);
+		cord->dead_custom_size -= best->stack_size;
+	}
+	return best;
+}
+
+int
+fiber_prewarm(const struct fiber_attr *fiber_attr, int count)
+{
+	struct cord *cord = cord();
+	for (int i = 0; i < count; i++) {
+		struct fiber *fiber = fiber_alloc(cord, fiber_attr);
+		if (fiber == NULL)
+			return i;
+		/*
+		 * The fiber was never started, but its context starts
+		 * from fiber_loop() like that of a recycled fiber.
+		 */
+		fiber->flags = fiber_attr->flags | FIBER_IS_DEAD;
+		if (fiber_is_reusable(fiber->flags)) {
+			rlist_add_entry(&cord->dead, fiber, link);
+		} else {
+			rlist_add_entry(&cord->dead_custom, fiber, link);
+			cord->dead_custom_size += fiber->stack_size;
+		}
+	}
+	return count;
+}
+
 struct fiber *
 fiber_new_ex(const char *name, const struct fiber_attr *fiber_attr,
 	     fiber_func f)
@@ -1556,36 +1667,15 @@ fiber_new_ex(const char *name, const struct fiber_attr *fiber_attr,
 		return NULL;
 	}
 
-	if (fiber_is_reusable(fiber_attr->flags) && !rlist_empty(&cord->dead)) {
-		fiber = rlist_first_entry(&cord->dead, struct fiber, link);
+	fiber = cord_take_dead_fiber(cord, fiber_attr);
+	if (fiber != NULL) {
 		rlist_move_entry(&cord->alive, fiber, link);
 		assert(fiber_is_dead(fiber));
+		cord->create_stat.reused++;
 	} else {
-		fiber = (struct fiber *)
-			mempool_alloc(&cord->fiber_mempool);
-		if (fiber == NULL) {
-			diag_set(OutOfMemory, sizeof(struct fiber),
-				 "fiber pool", "fiber");
-			return NULL;
-		}
-		memset(fiber, 0, sizeof(struct fiber));
-		fiber->storage.lua.storage_ref = FIBER_LUA_NOREF;
-		fiber->storage.lua.fid_ref = FIBER_LUA_NOREF;
-
-		if (fiber_stack_create(fiber, fiber_attr, &cord()->slabc)) {
-			mempool_free(&cord->fiber_mempool, fiber);
+		fiber = fiber_alloc(cord, fiber_attr);
+		if (fiber == NULL)
 			return NULL;
-		}
-		coro_create(&fiber->ctx, fiber_loop, NULL,
-			    fiber->stack, fiber->stack_size);
-
-		region_create(&fiber->gc, &cord->slabc);
-
-		rlist_create(&fiber->state);
-		rlist_create(&fiber->wake);
-		diag_create(&fiber->diag);
-		fiber_reset(fiber);
-
 		rlist_add_entry(&cord->alive, fiber, link);
 	}
 	fiber->flags = fiber_attr->flags;
@@ -1687,6 +1777,8 @@ fiber_delete_all(struct cord *cord)
 	cord_collect_garbage(cord);
 	cord_delete_fibers_in_list(cord, &cord->alive);
 	cord_delete_fibers_in_list(cord, &cord->dead);
+	cord_delete_fibers_in_list(cord, &cord->dead_custom);
+	cord->dead_custom_size = 0;
 	cord_delete_fibers_in_list(cord, &cord->ready);
 }
 
@@ -1847,6 +1939,9 @@ cord_create(struct cord *cord, const char *name)
 	rlist_create(&cord->alive);
 	rlist_create(&cord->ready);
 	rlist_create(&cord->dead);
+	rlist_create(&cord->dead_custom);
+	cord->dead_custom_size = 0;
+	memset(&cord->create_stat, 0, sizeof(cord->create_stat));
 	cord->garbage = NULL;
 	cord->fiber_registry = mh_i64ptr_new();
 
@@ -1900,6 +1995,7 @@ cord_create(struct cord *cord, const char *name)
 	cord->shutdown_fiber = NULL;
 	cord->client_fiber_count = 0;
 	cord->is_shutdown = false;
+	cord_stat_start(cord);
 }
 
 void
@@ -1927,7 +2023,7 @@ void
 cord_exit(struct cord *cord)
 {
 	assert(cord == cord());
-	(void)cord;
+	cord_stat_stop(cord);
 	trigger_free_in_thread();
 	signal_stack_free();
 }
@@ -45,6 +45,7 @@
 #include "salad/stailq.h"
 #include "clock_lowres.h"
 #include "backtrace.h"
+#include "cord_stat.h"
 #include "exception.h"
 
 #include <coro/coro.h>
@@ -635,6 +636,11 @@ struct fiber {
 #endif
 	/** Coro stack size. */
 	size_t stack_size;
+	/**
+	 * Stack size requested on the fiber creation. Used to find a
+	 * suitable dead fiber with a custom stack for reuse.
+	 */
+	size_t stack_size_requested;
 	/** Fiber's custom slice if fiber has it, zero otherwise. */
 	struct fiber_slice max_slice;
 	/** Valgrind stack id. */
@@ -743,6 +749,29 @@ struct fiber {
 		 */
 		struct {
 			uint64_t sync;
+			/**
+			 * Type name of the IPROTO request served by
+			 * the fiber, or NULL. Used by the sampling
+			 * profiler.
+			 */
+			const char *request;
+			/**
+			 * Time the fiber spent waiting for WAL writes
+			 * while serving the current IPROTO request.
+			 */
+			double wal_time;
+			/**
+			 * Time the fiber spent waiting for synchronous
+			 * replication quorum while serving the current
+			 * IPROTO request.
+			 */
+			double limbo_time;
+			/**
+			 * Number of index lookups and tuples read while
+			 * serving the current IPROTO request.
+			 */
+			uint64_t lookups;
+			uint64_t scanned;
 		} net;
 	} storage;
 	/** An object to wait for incoming message or a reader. */
@@ -772,6 +801,22 @@ struct cord_on_exit;
  * thread. Each cord consists of fibers to implement cooperative multitasking
  * model.
  */
+/** Statistics of fiber creation in a cord. */
+struct fiber_create_stat {
+	/** Number of fibers created with a new stack. */
+	uint64_t created;
+	/** Number of fibers taken from the caches of dead fibers. */
+	uint64_t reused;
+	/** Total time spent on the creation of new stacks, in seconds. */
+	double create_time;
+};
+
+/**
+ * Max total size of stacks of dead fibers with a custom stack size
+ * kept in a cord for reuse. Zero disables the cache.
+ */
+extern uint64_t fiber_custom_stack_cache_size;
+
 struct cord {
 	/** The fiber that is currently being executed. */
 	struct fiber *fiber;
@@ -804,6 +849,17 @@ struct cord {
 	 * pthread or by some other dying pthread. Same here with fibers.
 	 */
 	struct fiber *garbage;
+	/**
+	 * A cache of dead fibers with a custom stack size. Unlike the
+	 * fibers in the dead list, they are reused only by fibers with
+	 * a close stack size, and their total stack size is limited by
+	 * fiber_custom_stack_cache_size.
+	 */
+	struct rlist dead_custom;
+	/** Total stack size of the fibers in the dead_custom list. */
+	size_t dead_custom_size;
+	/** Statistics of fiber creation. */
+	struct fiber_create_stat create_stat;
 	/** A watcher to have a single async event for all ready fibers.
 	 * This technique is necessary to be able to suspend
 	 * a single fiber on a few watchers (for example,
@@ -858,6 +914,8 @@ struct cord {
 	struct fiber *shutdown_fiber;
 	/** Whether shutdown is started. */
 	bool is_shutdown;
+	/** Event loop statistics, see cord_stat.h. */
+	struct cord_stat stat;
 
 };
 
@@ -969,6 +1027,16 @@ cord_is_main(void);
 void
 cord_collect_garbage(struct cord *cord);
 
+/**
+ * Create @a count fibers with the given attributes in advance and put
+ * them to the cache of dead fibers of the current cord, so that the
+ * following fiber_new_ex() calls take them without allocating stacks.
+ * Returns the number of created fibers, which is less than @a count
+ * only on allocation failure, with the diag set.
+ */
+int
+fiber_prewarm(const struct fiber_attr *fiber_attr, int count);
+
 /**
  * Return slab_cache suitable to use with tarantool/small library
  */
@@ -29,41 +29,53 @@
  * SUCH DAMAGE.
  */
 #include "fiber_pool.h"
+#include "trigger.h"
+/**
+ * Wakes up an idle fiber to handle the rest of the queue when a fiber
+ * of the pool yields while handling a message.
+ */
+static int
+fiber_pool_on_yield(struct trigger *trigger, void *event)
+{
+	(void)event;
+	struct fiber_pool *pool = (struct fiber_pool *)trigger->data;
+	if (!stailq_empty(&pool->output) && !rlist_empty(&pool->idle))
+		fiber_wakeup(rlist_first_entry(&pool->idle, struct fiber,
+					       state));
+	return 0;
+}
+
 /**
  * Main function of the fiber invoked to handle all outstanding
  * tasks in a queue.
+ *
+ * Messages that don't yield are handled one after another without
+ * switching fibers. Another fiber is woken up to handle the queue
+ * only when handling of a message yields, see fiber_pool_on_yield().
  */
 static int
 fiber_pool_f(va_list ap)
 {
 	struct fiber_pool *pool = va_arg(ap, struct fiber_pool *);
-	struct cord *cord = cord();
 	struct fiber *f = fiber();
 	struct ev_loop *loop = pool->consumer;
 	struct stailq *output = &pool->output;
 	struct cmsg *msg;
 	ev_tstamp last_active_at = ev_monotonic_now(loop);
+	struct trigger on_yield;
+	trigger_create(&on_yield, fiber_pool_on_yield, pool, NULL);
+	trigger_add(&f->on_yield, &on_yield);
 	pool->size++;
 restart:
 	msg = NULL;
 	while (!stailq_empty(output) && !fiber_is_cancelled()) {
 		 msg = stailq_shift_entry(output, struct cmsg, fifo);
-
-		if (f->caller == &cord->sched && ! stailq_empty(output) &&
-		    ! rlist_empty(&pool->idle)) {
-			/*
-			 * Activate a "backup" fiber for the next
-			 * message in the queue.
-			 */
-			f->caller = rlist_shift_entry(&pool->idle,
-						      struct fiber,
-						      state);
-			f->caller->flags |= FIBER_IS_READY;
-			assert(f->caller->caller == &cord->sched);
-		}
+		if (++pool->busy > pool->busy_peak)
+			pool->busy_peak = pool->busy;
 		fiber_set_system(fiber(), false);
 		cmsg_deliver(msg);
 		fiber_set_system(fiber(), true);
+		pool->busy--;
 		fiber_check_gc();
 		/*
 		 * Normally fibers die after their function
@@ -76,6 +88,11 @@ fiber_pool_f(va_list ap)
 		 */
 		fiber_on_stop(f);
 	}
+	if (pool->stall_start != 0 && stailq_empty(output)) {
+		/* All waiting messages have got a fiber. */
+		pool->stall_time += ev_monotonic_now(loop) - pool->stall_start;
+		pool->stall_start = 0;
+	}
 	/** Put the current fiber into a fiber cache. */
 	if (!fiber_is_cancelled() && (msg != NULL ||
 	    ev_monotonic_now(loop) - last_active_at < pool->idle_timeout)) {
@@ -92,6 +109,7 @@ fiber_pool_f(va_list ap)
 
 		goto restart;
 	}
+	trigger_clear(&on_yield);
 	pool->size--;
 	fiber_cond_signal(&pool->worker_cond);
 
@@ -157,6 +175,10 @@ fiber_pool_cb(ev_loop *loop, struct ev_watcher *watcher, int events)
 			 */
 			say_warn("fiber pool size %d reached on endpoint %s",
 				 pool->max_size, pool->endpoint.name);
+			if (pool->stall_start == 0) {
+				pool->stall_start = ev_monotonic_now(loop);
+				pool->stall_count++;
+			}
 			break;
 		}
 	}
@@ -181,6 +203,11 @@ fiber_pool_create(struct fiber_pool *pool, const char *name, int max_pool_size,
 	ev_timer_again(loop(), &pool->idle_timer);
 	pool->size = 0;
 	pool->max_size = max_pool_size;
+	pool->busy = 0;
+	pool->busy_peak = 0;
+	pool->stall_count = 0;
+	pool->stall_time = 0;
+	pool->stall_start = 0;
 	stailq_create(&pool->output);
 	fiber_cond_create(&pool->worker_cond);
 	/* Join fiber pool to cbus */
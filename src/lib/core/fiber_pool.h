@@ -56,6 +56,23 @@ struct fiber_pool {
 		int size;
 		/** The limit on the number of fibers working on tasks. */
 		int max_size;
+		/** The number of fibers working on a message now. */
+		int busy;
+		/**
+		 * The max value of busy since the last reset by the
+		 * pool user. Fibers that yield in the middle of a
+		 * message add up here.
+		 */
+		int busy_peak;
+		/**
+		 * The number of times messages had to wait for a
+		 * fiber because the pool size limit was reached.
+		 */
+		int64_t stall_count;
+		/** Total time messages waited for a fiber, in seconds. */
+		double stall_time;
+		/** When the current stall started or 0. */
+		double stall_start;
 		/**
 		 * Fibers in leave the pool if they have nothing to do
 		 * for longer than this.
@@ -0,0 +1,237 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2024, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#include "mp_compression.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zstd.h>
+
+#include "diag.h"
+#include "mp_extension_types.h"
+#include "msgpuck.h"
+#include "tt_pthread.h"
+
+enum {
+	/** Max size of a MsgPack extension header, see mp_encode_extl(). */
+	MP_EXT_HEADER_SIZE_MAX = 6,
+};
+
+/**
+ * zstd contexts are expensive to create so we cache them in thread-local
+ * variables. Tuples are compressed in the tx thread, but they may be
+ * decompressed in any thread (e.g. by a checkpoint thread), so the contexts
+ * are freed with the thread, like vy_run_env::zdctx_key.
+ */
+static pthread_once_t mp_zstd_once = PTHREAD_ONCE_INIT;
+static pthread_key_t mp_zstd_cctx_key;
+static pthread_key_t mp_zstd_dctx_key;
+
+static void
+mp_zstd_free_cctx(void *arg)
+{
+	ZSTD_freeCCtx(arg);
+}
+
+static void
+mp_zstd_free_dctx(void *arg)
+{
+	ZSTD_freeDCtx(arg);
+}
+
+static void
+mp_zstd_create_keys(void)
+{
+	tt_pthread_key_create(&mp_zstd_cctx_key, mp_zstd_free_cctx);
+	tt_pthread_key_create(&mp_zstd_dctx_key, mp_zstd_free_dctx);
+}
+
+/** Returns the zstd compression context of the current thread. */
+static ZSTD_CCtx *
+mp_zstd_cctx(void)
+{
+	tt_pthread_once(&mp_zstd_once, mp_zstd_create_keys);
+	ZSTD_CCtx *cctx = tt_pthread_getspecific(mp_zstd_cctx_key);
+	if (cctx == NULL) {
+		cctx = ZSTD_createCCtx();
+		if (cctx == NULL) {
+			diag_set(OutOfMemory, sizeof(cctx), "ZSTD_createCCtx",
+				 "cctx");
+			return NULL;
+		}
+		tt_pthread_setspecific(mp_zstd_cctx_key, cctx);
+	}
+	return cctx;
+}
+
+/** Returns the zstd decompression context of the current thread. */
+static ZSTD_DCtx *
+mp_zstd_dctx(void)
+{
+	tt_pthread_once(&mp_zstd_once, mp_zstd_create_keys);
+	ZSTD_DCtx *dctx = tt_pthread_getspecific(mp_zstd_dctx_key);
+	if (dctx == NULL) {
+		dctx = ZSTD_createDCtx();
+		if (dctx == NULL) {
+			diag_set(OutOfMemory, sizeof(dctx), "ZSTD_createDCtx",
+				 "dctx");
+			return NULL;
+		}
+		tt_pthread_setspecific(mp_zstd_dctx_key, dctx);
+	}
+	return dctx;
+}
+
+size_t
+mp_compress_bound(size_t src_size)
+{
+	return MP_EXT_HEADER_SIZE_MAX + mp_sizeof_uint(compression_type_MAX) +
+	       mp_sizeof_uint(src_size) + ZSTD_compressBound(src_size);
+}
+
+char *
+mp_compress(char *dst, const char *src, size_t src_size,
+	    enum compression_type type)
+{
+	assert(type == COMPRESSION_TYPE_ZSTD);
+	ZSTD_CCtx *cctx = mp_zstd_cctx();
+	if (cctx == NULL)
+		return NULL;
+	/*
+	 * The extension header size depends on the data size so write
+	 * the data first and then move it right after the header.
+	 */
+	char *data = dst + MP_EXT_HEADER_SIZE_MAX;
+	char *pos = mp_encode_uint(data, type);
+	pos = mp_encode_uint(pos, src_size);
+	size_t frame_size = ZSTD_compressCCtx(cctx, pos,
+					      ZSTD_compressBound(src_size),
+					      src, src_size,
+					      ZSTD_CLEVEL_DEFAULT);
+	if (ZSTD_isError(frame_size)) {
+		diag_set(IllegalParams, "failed to compress data: %s",
+			 ZSTD_getErrorName(frame_size));
+		return NULL;
+	}
+	uint32_t len = pos + frame_size - data;
+	char *end = mp_encode_extl(dst, MP_COMPRESSION, len);
+	memmove(end, data, len);
+	return end + len;
+}
+
+/**
+ * Decodes the MP_COMPRESSION extension data. Returns the decompressed
+ * value size and the compressed frame in @a frame and @a frame_size.
+ * On error returns 0 and sets diag.
+ */
+static size_t
+mp_compression_unpack(const char *data, uint32_t len,
+		      const char **frame, size_t *frame_size)
+{
+	const char *end = data + len;
+	if (data == end || mp_typeof(*data) != MP_UINT ||
+	    mp_check_uint(data, end) > 0)
+		goto error;
+	uint64_t type = mp_decode_uint(&data);
+	if (type != COMPRESSION_TYPE_ZSTD || data == end ||
+	    mp_typeof(*data) != MP_UINT || mp_check_uint(data, end) > 0)
+		goto error;
+	uint64_t size = mp_decode_uint(&data);
+	if (size == 0 || size > UINT32_MAX)
+		goto error;
+	*frame = data;
+	*frame_size = end - data;
+	return size;
+error:
+	diag_set(IllegalParams, "invalid compressed data");
+	return 0;
+}
+
+/**
+ * Decompresses the frame to @a dst, which must be exactly @a dst_size
+ * bytes long. Returns 0 on success, -1 on error.
+ */
+static int
+mp_compression_decompress_frame(const char *frame, size_t frame_size,
+				char *dst, size_t dst_size)
+{
+	ZSTD_DCtx *dctx = mp_zstd_dctx();
+	if (dctx == NULL)
+		return -1;
+	size_t size = ZSTD_decompressDCtx(dctx, dst, dst_size,
+					  frame, frame_size);
+	if (ZSTD_isError(size) || size != dst_size) {
+		diag_set(IllegalParams, "invalid compressed data");
+		return -1;
+	}
+	return 0;
+}
+
+size_t
+mp_decompress(const char **src, char *dst, size_t dst_size)
+{
+	const char *data = *src;
+	int8_t ext_type;
+	uint32_t len = mp_decode_extl(&data, &ext_type);
+	assert(ext_type == MP_COMPRESSION);
+	(void)ext_type;
+	const char *frame;
+	size_t frame_size;
+	size_t size = mp_compression_unpack(data, len, &frame, &frame_size);
+	if (size == 0 || size > dst_size)
+		return size;
+	if (mp_compression_decompress_frame(frame, frame_size,
+					    dst, size) != 0)
+		return 0;
+	*src = data + len;
+	return size;
+}
+
+/**
+ * Decompresses the MP_COMPRESSION extension data to a buffer allocated
+ * with malloc(). Returns NULL on error.
+ */
+static char *
+mp_compression_decompress_to_buf(const char **data, uint32_t len)
+{
+	const char *frame;
+	size_t frame_size;
+	size_t size = mp_compression_unpack(*data, len, &frame, &frame_size);
+	if (size == 0)
+		return NULL;
+	char *buf = malloc(size);
+	if (buf == NULL)
+		return NULL;
+	if (mp_compression_decompress_frame(frame, frame_size,
+					    buf, size) != 0) {
+		free(buf);
+		return NULL;
+	}
+	*data += len;
+	return buf;
+}
+
+int
+mp_snprint_compression(char *buf, int size, const char **data, uint32_t len)
+{
+	char *value = mp_compression_decompress_to_buf(data, len);
+	if (value == NULL)
+		return -1;
+	int rc = mp_snprint(buf, size, value);
+	free(value);
+	return rc;
+}
+
+int
+mp_fprint_compression(FILE *file, const char **data, uint32_t len)
+{
+	char *value = mp_compression_decompress_to_buf(data, len);
+	if (value == NULL)
+		return -1;
+	int rc = mp_fprint(file, value);
+	free(value);
+	return rc;
+}
@@ -20,48 +20,56 @@
 extern "C" {
 #endif
 
-static inline char *
+/*
+ * A compressed MsgPack value is stored in the MP_COMPRESSION extension.
+ * The extension data is:
+ *
+ *   <compression type: MP_UINT> <decompressed size: MP_UINT> <frame>
+ *
+ * where frame is the value compressed with the given algorithm.
+ */
+
+/**
+ * Returns the max size of the MP_COMPRESSION extension that may be
+ * written by mp_compress() for a value of the given size.
+ */
+size_t
+mp_compress_bound(size_t src_size);
+
+/**
+ * Compresses the MsgPack value [src, src + src_size) and encodes it in
+ * the MP_COMPRESSION extension. The @a dst buffer must be at least
+ * mp_compress_bound(src_size) bytes long. Returns a pointer past
+ * the written data. On error returns NULL and sets diag.
+ */
+char *
 mp_compress(char *dst, const char *src, size_t src_size,
-	    enum compression_type type)
-{
-        (void)dst;
-        (void)src;
-        (void)src_size;
-        (void)type;
-        unreachable();
-        return NULL;
-}
+	    enum compression_type type);
 
-static inline size_t
-mp_decompress(const char **src, char *dst, size_t dst_size)
-{
-        (void)src;
-        (void)dst;
-        (void)dst_size;
-        unreachable();
-        return 0;
-}
+/**
+ * Decompresses the MsgPack value encoded in the MP_COMPRESSION extension
+ * at @a src and returns its size. If the size is greater than @a dst_size,
+ * nothing is written and @a src isn't advanced, so the function may be
+ * called with zero @a dst_size to figure out the size of the buffer.
+ * Otherwise, the value is written to @a dst and @a src is advanced past
+ * the extension. On error returns 0 and sets diag.
+ */
+size_t
+mp_decompress(const char **src, char *dst, size_t dst_size);
 
-static inline int
-mp_snprint_compression(char *buf, int size, const char **data, uint32_t len)
-{
-        (void)buf;
-        (void)size;
-        (void)data;
-        (void)len;
-        unreachable();
-        return -1;
-}
+/**
+ * Prints the decompressed value of the MP_COMPRESSION extension data of
+ * the given length, see mp_snprint().
+ */
+int
+mp_snprint_compression(char *buf, int size, const char **data, uint32_t len);
 
-static inline int
-mp_fprint_compression(FILE *file, const char **data, uint32_t len)
-{
-        (void)file;
-        (void)data;
-        (void)len;
-        unreachable();
-        return -1;
-}
+/**
+ * Prints the decompressed value of the MP_COMPRESSION extension data of
+ * the given length, see mp_fprint().
+ */
+int
+mp_fprint_compression(FILE *file, const char **data, uint32_t len);
 
 #if defined(__cplusplus)
 } /* extern "C" */
@@ -4,14 +4,112 @@
  *
  * Copyright 2021, Tarantool AUTHORS, please see AUTHORS file.
  */
+#include <assert.h>
 #include <stdarg.h>
 #include <stddef.h>
+#include <stdint.h>
+
+#include "msgpuck.h"
+#include "trivia/config.h"
+#include "trivia/util.h"
+
+/*
+ * Reading a whole aligned block can't cross a page boundary, but it may
+ * read bytes past the end of an allocation, which memory checkers would
+ * report, so vectorized skipping is disabled for such builds.
+ */
+#if !defined(ENABLE_ASAN) && defined(NVALGRIND)
+# if defined(__SSE2__)
+#  include <emmintrin.h>
+#  define MP_NEXT_N_SSE2 1
+# elif defined(__ARM_NEON) && defined(__aarch64__)
+#  include <arm_neon.h>
+#  define MP_NEXT_N_NEON 1
+# endif
+#endif
 
 #if defined(__cplusplus)
 extern "C"
 {
 #endif /* defined(__cplusplus) */
 
+#if defined(MP_NEXT_N_SSE2) || defined(MP_NEXT_N_NEON)
+
+/** Size of a block of MsgPack data checked at once by mp_next_n(). */
+enum { MP_NEXT_N_BLOCK_SIZE = 16 };
+
+/**
+ * Returns a bit mask of single-byte values (positive and negative
+ * fixints, nil and booleans) in the 16-byte aligned block that contains
+ * @a data. The lowest bit corresponds to the first byte of the block.
+ */
+static inline uint32_t
+mp_single_byte_mask(const char *data)
+{
+	const char *block = (const char *)((uintptr_t)data &
+					   ~(uintptr_t)(MP_NEXT_N_BLOCK_SIZE - 1));
+#if defined(MP_NEXT_N_SSE2)
+	__m128i bytes = _mm_load_si128((const __m128i *)block);
+	/* 0x00..0x7f and 0xe0..0xff are fixints. */
+	__m128i fixint = _mm_cmpgt_epi8(bytes, _mm_set1_epi8(-33));
+	/* 0xc0 is nil, 0xc2 and 0xc3 are booleans, 0xc1 is never used. */
+	__m128i other = _mm_cmpeq_epi8(_mm_and_si128(bytes,
+						     _mm_set1_epi8(-4)),
+				       _mm_set1_epi8(-64));
+	return (uint32_t)_mm_movemask_epi8(_mm_or_si128(fixint, other));
+#else /* defined(MP_NEXT_N_NEON) */
+	int8x16_t bytes = vld1q_s8((const int8_t *)block);
+	uint8x16_t fixint = vcgtq_s8(bytes, vdupq_n_s8(-33));
+	uint8x16_t other = vceqq_s8(vandq_s8(bytes, vdupq_n_s8(-4)),
+				    vdupq_n_s8(-64));
+	uint8x16_t single = vorrq_u8(fixint, other);
+	/* Emulate movemask: keep one bit per byte and add them up. */
+	static const uint8_t bits[MP_NEXT_N_BLOCK_SIZE] = {
+		1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128,
+	};
+	uint8x16_t masked = vandq_u8(single, vld1q_u8(bits));
+	uint32_t lo = vaddv_u8(vget_low_u8(masked));
+	uint32_t hi = vaddv_u8(vget_high_u8(masked));
+	return lo | (hi << 8);
+#endif
+}
+
+#endif /* defined(MP_NEXT_N_SSE2) || defined(MP_NEXT_N_NEON) */
+
+/**
+ * Skip @a count MsgPack values. Equivalent to calling mp_next() @a count
+ * times, but runs of single-byte values are skipped up to 16 at a time,
+ * which speeds up field lookups in tuples with many small integer fields.
+ * The data must contain at least @a count values.
+ */
+static inline void
+mp_next_n(const char **data, uint32_t count)
+{
+#if defined(MP_NEXT_N_SSE2) || defined(MP_NEXT_N_NEON)
+	while (count > 0) {
+		int8_t c = (int8_t)**data;
+		if (c < -32 && (c & -4) != -64) {
+			/* Not a single-byte value. */
+			mp_next(data);
+			count--;
+			continue;
+		}
+		uint32_t offset = (uintptr_t)*data &
+				  (MP_NEXT_N_BLOCK_SIZE - 1);
+		uint32_t mask = mp_single_byte_mask(*data) >> offset;
+		/* Number of single-byte values starting at data. */
+		uint32_t run = __builtin_ctz(~mask);
+		assert(run > 0);
+		run = MIN(run, count);
+		*data += run;
+		count -= run;
+	}
+#else
+	for (; count > 0; count--)
+		mp_next(data);
+#endif
+}
+
 struct region;
 
 /**
@@ -0,0 +1,350 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2024, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#include "sampler.h"
+
+#ifdef ENABLE_BACKTRACE
+
+#include <errno.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif /* defined(__linux__) */
+
+#include "assoc.h"
+#include "backtrace.h"
+#include "diag.h"
+#include "fiber.h"
+#include "trivia/util.h"
+
+#if defined(__linux__) && !defined(sigev_notify_thread_id)
+#define sigev_notify_thread_id _sigev_un._tid
+#endif
+
+enum {
+	/** Number of samples the ring buffer can hold. */
+	SAMPLER_RING_SIZE = 512,
+	/** Max length of a collapsed stack. */
+	SAMPLER_STACK_LEN_MAX = 4096,
+	/**
+	 * Number of innermost frames to skip: the signal handler
+	 * and the signal trampoline.
+	 */
+	SAMPLER_SKIP_FRAMES = 2,
+};
+
+/** How often the ring buffer is drained, in seconds. */
+static const double SAMPLER_DRAIN_PERIOD = 0.1;
+
+/** A sample saved by the signal handler. */
+struct sampler_sample {
+	/** Id of the running fiber. */
+	uint64_t fid;
+	/** Type of the IPROTO request served by the fiber, or NULL. */
+	const char *request;
+	/** C backtrace of the fiber. */
+	struct backtrace bt;
+};
+
+struct sampler {
+	/** Timer that sends SIGPROF to the cord thread. */
+	timer_t timer;
+	/** Timer that drains the ring buffer in the event loop. */
+	struct ev_timer drain_timer;
+	/** Collapsed stack -> number of samples. */
+	struct mh_strnu32_t *stacks;
+	/** Statistics. */
+	struct sampler_stat stat;
+	/**
+	 * Ring buffer positions. The tail is advanced only by the
+	 * signal handler, the head - only from the event loop of
+	 * the same thread.
+	 */
+	volatile uint64_t head;
+	volatile uint64_t tail;
+	/** Number of samples lost by the signal handler. */
+	volatile uint64_t lost;
+	struct sampler_sample ring[SAMPLER_RING_SIZE];
+};
+
+/** Profiler of the current cord, NULL if disabled. */
+static __thread struct sampler *volatile sampler;
+
+/** Set when the SIGPROF handler is installed. */
+static bool sampler_handler_is_installed;
+
+/**
+ * SIGPROF handler. Runs in the thread of the profiled cord, so it
+ * may only access the thread-local profiler without locks.
+ */
+static void
+sampler_signal_handler(int signum)
+{
+	(void)signum;
+	int errsv = errno;
+	struct sampler *s = sampler;
+	if (s == NULL || cord_ptr == NULL)
+		goto out;
+	if (s->tail - s->head >= SAMPLER_RING_SIZE) {
+		s->lost++;
+		goto out;
+	}
+	struct sampler_sample *sample = &s->ring[s->tail % SAMPLER_RING_SIZE];
+	struct fiber *f = cord_ptr->fiber;
+	sample->fid = f->fid;
+	sample->request = f->storage.net.request;
+	backtrace_collect(&sample->bt, NULL, SAMPLER_SKIP_FRAMES);
+	__atomic_signal_fence(__ATOMIC_RELEASE);
+	s->tail++;
+out:
+	errno = errsv;
+}
+
+/** Append a formatted string to a collapsed stack. */
+static void
+sampler_stack_append(char *buf, int *len, const char *format, ...)
+{
+	int size = SAMPLER_STACK_LEN_MAX - *len;
+	if (size <= 0)
+		return;
+	va_list ap;
+	va_start(ap, format);
+	int n = vsnprintf(buf + *len, size, format, ap);
+	va_end(ap);
+	if (n > 0)
+		*len += MIN(n, size - 1);
+}
+
+/** Account a sample in the collapsed stack table. */
+static void
+sampler_account(struct sampler *s, const struct sampler_sample *sample)
+{
+	char buf[SAMPLER_STACK_LEN_MAX];
+	int len = 0;
+	struct fiber *f = sample->fid == FIBER_ID_SCHED ?
+			  &cord()->sched : fiber_find(sample->fid);
+	if (f != NULL) {
+		sampler_stack_append(buf, &len, "%s", fiber_name(f));
+	} else {
+		sampler_stack_append(buf, &len, "fiber %llu",
+				     (unsigned long long)sample->fid);
+	}
+	if (sample->request != NULL)
+		sampler_stack_append(buf, &len, ";%s", sample->request);
+	for (int i = sample->bt.frame_count - 1; i >= 0; i--) {
+		uintptr_t offset;
+		const char *name = backtrace_frame_resolve(
+			&sample->bt.frames[i], &offset);
+		sampler_stack_append(buf, &len, ";%s",
+				     name != NULL ? name : "??");
+	}
+	s->stat.samples++;
+	mh_int_t k = mh_strnu32_find_str(s->stacks, buf, len);
+	if (k != mh_end(s->stacks)) {
+		mh_strnu32_node(s->stacks, k)->val++;
+		return;
+	}
+	char *str = xmalloc(len);
+	memcpy(str, buf, len);
+	struct mh_strnu32_node_t node = {
+		.str = str,
+		.len = len,
+		.hash = mh_strn_hash(str, len),
+		.val = 1,
+	};
+	mh_strnu32_put(s->stacks, &node, NULL, NULL);
+}
+
+/** Aggregate the samples saved by the signal handler. */
+static void
+sampler_drain(struct sampler *s)
+{
+	uint64_t tail = s->tail;
+	__atomic_signal_fence(__ATOMIC_ACQUIRE);
+	for (; s->head != tail; s->head++)
+		sampler_account(s, &s->ring[s->head % SAMPLER_RING_SIZE]);
+	s->stat.lost = s->lost;
+}
+
+static void
+sampler_drain_cb(struct ev_loop *loop, struct ev_timer *watcher, int revents)
+{
+	(void)loop;
+	(void)revents;
+	sampler_drain(watcher->data);
+}
+
+/** Free all collapsed stacks. */
+static void
+sampler_clear(struct sampler *s)
+{
+	mh_int_t k;
+	mh_foreach(s->stacks, k)
+		free((char *)mh_strnu32_node(s->stacks, k)->str);
+	mh_strnu32_clear(s->stacks);
+}
+
+/** Set the period of the signal timer. */
+static int
+sampler_set_rate(struct sampler *s, int rate)
+{
+	struct itimerspec its;
+	its.it_interval.tv_sec = 0;
+	its.it_interval.tv_nsec = 1000000000L / rate;
+	its.it_value = its.it_interval;
+	if (timer_settime(s->timer, 0, &its, NULL) != 0) {
+		diag_set(SystemError, "timer_settime");
+		return -1;
+	}
+	return 0;
+}
+
+/** Install the SIGPROF handler unless it's used by somebody else. */
+static int
+sampler_install_handler(void)
+{
+	if (sampler_handler_is_installed)
+		return 0;
+	struct sigaction sa;
+	if (sigaction(SIGPROF, NULL, &sa) != 0) {
+		diag_set(SystemError, "sigaction");
+		return -1;
+	}
+	if (sa.sa_handler != SIG_DFL && sa.sa_handler != SIG_IGN) {
+		diag_set(IllegalParams, "SIGPROF is used by another profiler");
+		return -1;
+	}
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = sampler_signal_handler;
+	sa.sa_flags = SA_RESTART;
+	sigemptyset(&sa.sa_mask);
+	if (sigaction(SIGPROF, &sa, NULL) != 0) {
+		diag_set(SystemError, "sigaction");
+		return -1;
+	}
+	sampler_handler_is_installed = true;
+	return 0;
+}
+
+int
+sampler_enable(int rate)
+{
+	if (rate <= 0 || rate > SAMPLER_RATE_MAX) {
+		diag_set(IllegalParams, "rate must be in range [1, %d]",
+			 SAMPLER_RATE_MAX);
+		return -1;
+	}
+	if (sampler != NULL)
+		return sampler_set_rate(sampler, rate);
+#if defined(__linux__)
+	if (sampler_install_handler() != 0)
+		return -1;
+	struct sampler *s = xcalloc(1, sizeof(*s));
+	struct sigevent sev;
+	memset(&sev, 0, sizeof(sev));
+	sev.sigev_notify = SIGEV_THREAD_ID;
+	sev.sigev_signo = SIGPROF;
+	sev.sigev_notify_thread_id = syscall(SYS_gettid);
+	if (timer_create(CLOCK_THREAD_CPUTIME_ID, &sev, &s->timer) != 0) {
+		diag_set(SystemError, "timer_create");
+		free(s);
+		return -1;
+	}
+	/* Threads other than the main one block all signals. */
+	sigset_t set;
+	sigemptyset(&set);
+	sigaddset(&set, SIGPROF);
+	pthread_sigmask(SIG_UNBLOCK, &set, NULL);
+	s->stacks = mh_strnu32_new();
+	ev_timer_init(&s->drain_timer, sampler_drain_cb,
+		      SAMPLER_DRAIN_PERIOD, SAMPLER_DRAIN_PERIOD);
+	s->drain_timer.data = s;
+	ev_timer_start(loop(), &s->drain_timer);
+	sampler = s;
+	if (sampler_set_rate(s, rate) != 0) {
+		sampler_disable();
+		return -1;
+	}
+	return 0;
+#else /* !defined(__linux__) */
+	(void)sampler_install_handler;
+	(void)sampler_set_rate;
+	diag_set(IllegalParams,
+		 "sampling profiler is not supported on this platform");
+	return -1;
+#endif /* defined(__linux__) */
+}
+
+void
+sampler_disable(void)
+{
+	struct sampler *s = sampler;
+	if (s == NULL)
+		return;
+	/* Stop the signal handler first, a signal may be pending. */
+	sampler = NULL;
+	__atomic_signal_fence(__ATOMIC_SEQ_CST);
+	timer_delete(s->timer);
+	ev_timer_stop(loop(), &s->drain_timer);
+	sampler_clear(s);
+	mh_strnu32_delete(s->stacks);
+	free(s);
+}
+
+bool
+sampler_is_enabled(void)
+{
+	return sampler != NULL;
+}
+
+void
+sampler_stat(struct sampler_stat *stat)
+{
+	if (sampler == NULL) {
+		memset(stat, 0, sizeof(*stat));
+		return;
+	}
+	sampler_drain(sampler);
+	*stat = sampler->stat;
+}
+
+int
+sampler_foreach(sampler_stack_f cb, void *arg)
+{
+	struct sampler *s = sampler;
+	if (s == NULL)
+		return 0;
+	sampler_drain(s);
+	mh_int_t k;
+	mh_foreach(s->stacks, k) {
+		struct mh_strnu32_node_t *node = mh_strnu32_node(s->stacks, k);
+		int rc = cb(node->str, node->len, node->val, arg);
+		if (rc != 0)
+			return rc;
+	}
+	return 0;
+}
+
+void
+sampler_reset(void)
+{
+	struct sampler *s = sampler;
+	if (s == NULL)
+		return;
+	sampler_drain(s);
+	sampler_clear(s);
+	s->stat.samples = 0;
+	s->stat.lost = 0;
+	s->lost = 0;
+}
+
+#endif /* ENABLE_BACKTRACE */
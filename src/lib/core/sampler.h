@@ -0,0 +1,90 @@
+#pragma once
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2024, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "trivia/config.h"
+
+#ifdef ENABLE_BACKTRACE
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+/**
+ * Sampling profiler of a cord.
+ *
+ * While the profiler is enabled, the cord is interrupted with
+ * SIGPROF at the given rate per second of the CPU time consumed by
+ * the cord. The signal handler saves the C backtrace, the current
+ * fiber and the IPROTO request it serves (if any) to a ring buffer.
+ * The buffer is periodically drained from the cord event loop,
+ * and the samples are aggregated into collapsed stacks:
+ *
+ *   <fiber name>;<request type>;<outermost frame>;...;<innermost frame>
+ *
+ * The request type is omitted if the fiber doesn't serve a request.
+ * The format is understood by flame graph tools.
+ */
+
+enum {
+	/** Max sampling rate, samples per second of CPU time. */
+	SAMPLER_RATE_MAX = 1000,
+};
+
+/** Statistics of the sampling profiler of a cord. */
+struct sampler_stat {
+	/** Number of samples collected. */
+	uint64_t samples;
+	/** Number of samples lost because the ring buffer was full. */
+	uint64_t lost;
+};
+
+/**
+ * Enable the profiler of the current cord, or change its rate if
+ * it's already enabled. The collected samples are kept.
+ * Returns -1 and sets diag on error.
+ */
+int
+sampler_enable(int rate);
+
+/**
+ * Disable the profiler of the current cord and discard the samples.
+ */
+void
+sampler_disable(void);
+
+/** Return true if the profiler of the current cord is enabled. */
+bool
+sampler_is_enabled(void);
+
+/** Get the statistics of the profiler of the current cord. */
+void
+sampler_stat(struct sampler_stat *stat);
+
+/** Callback invoked for each collapsed stack by sampler_foreach(). */
+typedef int
+(*sampler_stack_f)(const char *stack, uint32_t len, uint64_t count,
+		   void *arg);
+
+/**
+ * Aggregate all pending samples of the current cord and call @a cb
+ * for each collected stack. Stops and returns the value of @a cb
+ * if it returns non-zero.
+ */
+int
+sampler_foreach(sampler_stack_f cb, void *arg);
+
+/** Discard the samples of the current cord, keep it running. */
+void
+sampler_reset(void);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
+
+#endif /* ENABLE_BACKTRACE */
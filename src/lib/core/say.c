@@ -33,6 +33,7 @@
 #include "errinj.h"
 #include "tt_static.h"
 #include "tt_strerror.h"
+#include "tweaks.h"
 
 #include <errno.h>
 #include <stdarg.h>
@@ -43,8 +44,11 @@
 #include <sys/types.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
 #include <syslog.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <sys/un.h>
 #include <arpa/inet.h>
 #include <coio_task.h>
@@ -93,6 +97,9 @@ say_format_boot(struct log *log, char *buf, int len, int level,
 		const char *module, const char *filename, int line,
 		const char *error, const char *format, va_list ap);
 
+static void
+say_async_stop(void);
+
 /*
  * Callbacks called before/after writing to stderr.
  */
@@ -802,8 +809,10 @@ say_set_background(void)
 void
 say_logger_free(void)
 {
-	if (say_logger_initialized())
+	if (say_logger_initialized()) {
+		say_async_stop();
 		log_destroy(&log_std);
+	}
 }
 
 /** {{{ Formatters */
@@ -1169,6 +1178,322 @@ write_to_syslog(struct log *log, int total)
 
 /** Loggers }}} */
 
+/** {{{ Asynchronous logging */
+
+/**
+ * If set, lines of the default log that go to a file or a pipe
+ * are not written by the thread that produces them. Instead, they
+ * are copied to a ring buffer of the producing thread, and all the
+ * ring buffers are drained by a dedicated logger thread, so a slow
+ * disk or a stuck pipe reader never blocks an event loop. If a ring
+ * buffer is full, new lines are dropped, and the logger thread
+ * reports the number of dropped lines to the log.
+ */
+static bool say_async = false;
+TWEAK_BOOL(say_async);
+
+enum {
+	/** Size of a per-thread ring buffer, must be a power of 2. */
+	SAY_ASYNC_RING_SIZE = 256 * 1024,
+	/** Max time between two passes of the logger thread, in ms. */
+	SAY_ASYNC_FLUSH_TIMEOUT = 10,
+};
+
+static_assert((SAY_ASYNC_RING_SIZE & (SAY_ASYNC_RING_SIZE - 1)) == 0,
+	      "SAY_ASYNC_RING_SIZE must be a power of 2");
+static_assert(SAY_ASYNC_RING_SIZE >= 2 * SAY_BUF_LEN_MAX,
+	      "SAY_ASYNC_RING_SIZE must fit a few log lines");
+
+/**
+ * A ring buffer of formatted log lines with a single producer,
+ * the thread that owns it, and a single consumer, the logger
+ * thread. The positions grow monotonically and are wrapped only
+ * on access to the buffer.
+ */
+struct say_ring {
+	/** Link in the list of all ring buffers. */
+	struct say_ring *next;
+	/** Position to write the next line to, set by the producer. */
+	uint64_t tail;
+	/** Position to read the next byte from, set by the consumer. */
+	uint64_t head;
+	/** Number of lines dropped because the buffer was full. */
+	uint64_t dropped;
+	/**
+	 * Set when the owner thread exits. An orphan buffer is
+	 * adopted by the next thread that needs a buffer.
+	 */
+	bool is_orphan;
+	char buf[SAY_ASYNC_RING_SIZE];
+};
+
+enum say_async_state {
+	/** The logger thread is not running. */
+	SAY_ASYNC_STOPPED,
+	/** The logger thread is being started. */
+	SAY_ASYNC_STARTING,
+	/** The logger thread is running. */
+	SAY_ASYNC_RUNNING,
+	/** The log is destroyed, the logger thread can't be started. */
+	SAY_ASYNC_SHUTDOWN,
+};
+
+static int say_async_state = SAY_ASYNC_STOPPED;
+
+/**
+ * List of all ring buffers. Buffers are only added to the head
+ * with a CAS and never removed.
+ */
+static struct say_ring *say_async_rings;
+
+/** Ring buffer of the current thread. */
+static __thread struct say_ring *say_ring;
+
+/** Key used to release a ring buffer when its owner exits. */
+static pthread_key_t say_ring_key;
+
+/** Set when say_ring_key is created. */
+static bool say_ring_key_is_created;
+
+/** Serializes consumers: the logger thread and fatal errors. */
+static pthread_mutex_t say_async_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static pthread_t say_async_thread;
+
+/** Pipe used by producers to wake the logger thread up. */
+static int say_async_pipe[2] = {-1, -1};
+
+static void
+say_ring_release(void *arg)
+{
+	struct say_ring *ring = arg;
+	pm_atomic_store(&ring->is_orphan, true);
+}
+
+/**
+ * Return the ring buffer of the current thread: an orphan one or
+ * a new one. Return NULL on memory allocation error.
+ */
+static struct say_ring *
+say_ring_get(void)
+{
+	if (say_ring != NULL)
+		return say_ring;
+	struct say_ring *ring = pm_atomic_load(&say_async_rings);
+	for (; ring != NULL; ring = ring->next) {
+		bool is_orphan = true;
+		if (pm_atomic_compare_exchange_strong(&ring->is_orphan,
+						      &is_orphan, false))
+			break;
+	}
+	if (ring == NULL) {
+		ring = calloc(1, sizeof(*ring));
+		if (ring == NULL)
+			return NULL;
+		ring->next = pm_atomic_load(&say_async_rings);
+		while (!pm_atomic_compare_exchange_weak(&say_async_rings,
+							&ring->next, ring))
+			;
+	}
+	(void)pthread_setspecific(say_ring_key, ring);
+	say_ring = ring;
+	return ring;
+}
+
+static void
+say_async_wakeup(void)
+{
+	char c = 0;
+	ssize_t r = write(say_async_pipe[1], &c, 1);
+	(void)r;
+}
+
+/**
+ * Write the pending lines of all ring buffers to the default log.
+ * Return the number of lines dropped since the previous call.
+ */
+static uint64_t
+say_async_flush(void)
+{
+	uint64_t dropped = 0;
+	tt_pthread_mutex_lock(&say_async_mutex);
+	struct say_ring *ring = pm_atomic_load(&say_async_rings);
+	for (; ring != NULL; ring = ring->next) {
+		dropped += pm_atomic_exchange(&ring->dropped, 0);
+		uint64_t head = ring->head;
+		uint64_t tail = pm_atomic_load(&ring->tail);
+		if (head == tail)
+			continue;
+		/* Write all the pending lines at once. */
+		size_t pos = head & (SAY_ASYNC_RING_SIZE - 1);
+		size_t len = tail - head;
+		struct iovec iov[2];
+		int iovcnt = 1;
+		iov[0].iov_base = ring->buf + pos;
+		iov[0].iov_len = MIN(len, SAY_ASYNC_RING_SIZE - pos);
+		if (iov[0].iov_len < len) {
+			iov[1].iov_base = ring->buf;
+			iov[1].iov_len = len - iov[0].iov_len;
+			iovcnt = 2;
+		}
+		ssize_t r = writev(log_std.fd, iov, iovcnt);
+		if (r >= 0)
+			head += r;
+		else if (errno != EAGAIN && errno != EWOULDBLOCK &&
+			 errno != EINTR)
+			/* The lines are lost, like on a synchronous write. */
+			head = tail;
+		pm_atomic_store(&ring->head, head);
+	}
+	tt_pthread_mutex_unlock(&say_async_mutex);
+	return dropped;
+}
+
+/** Logger thread function. */
+static void *
+say_async_f(void *arg)
+{
+	(void)arg;
+	cord_set_name("logger");
+	struct pollfd pfd = {.fd = say_async_pipe[0], .events = POLLIN};
+	while (pm_atomic_load(&say_async_state) != SAY_ASYNC_SHUTDOWN) {
+		if (poll(&pfd, 1, SAY_ASYNC_FLUSH_TIMEOUT) > 0) {
+			char buf[64];
+			while (read(say_async_pipe[0], buf, sizeof(buf)) > 0)
+				;
+		}
+		ERROR_INJECT_WHILE(ERRINJ_LOG_ASYNC_DELAY, {
+			usleep(1000);
+		});
+		uint64_t dropped = say_async_flush();
+		if (dropped > 0) {
+			say_warn("%llu log messages were dropped because "
+				 "the log buffer is full",
+				 (unsigned long long)dropped);
+		}
+	}
+	say_async_flush();
+	return NULL;
+}
+
+/**
+ * After fork() only the calling thread exists in the child, so the
+ * logger thread is started anew on the next write to the log.
+ */
+static void
+say_async_atfork_child(void)
+{
+	if (say_async_state == SAY_ASYNC_SHUTDOWN)
+		return;
+	pthread_mutex_init(&say_async_mutex, NULL);
+	say_async_state = SAY_ASYNC_STOPPED;
+}
+
+/**
+ * Start the logger thread if nobody else is starting it.
+ * Return 0 if the thread is running, -1 otherwise.
+ */
+static int
+say_async_start(void)
+{
+	int state = SAY_ASYNC_STOPPED;
+	if (!pm_atomic_compare_exchange_strong(&say_async_state, &state,
+					       SAY_ASYNC_STARTING))
+		return state == SAY_ASYNC_RUNNING ? 0 : -1;
+	if (!say_ring_key_is_created) {
+		if (pthread_key_create(&say_ring_key, say_ring_release) != 0)
+			goto fail;
+		say_ring_key_is_created = true;
+		tt_pthread_atfork(NULL, NULL, say_async_atfork_child);
+	}
+	if (say_async_pipe[0] < 0) {
+		if (pipe(say_async_pipe) != 0)
+			goto fail;
+		for (int i = 0; i < 2; i++) {
+			fcntl(say_async_pipe[i], F_SETFD, FD_CLOEXEC);
+			fcntl(say_async_pipe[i], F_SETFL, O_NONBLOCK);
+		}
+	}
+	if (pthread_create(&say_async_thread, NULL, say_async_f, NULL) != 0)
+		goto fail;
+	state = SAY_ASYNC_STARTING;
+	if (!pm_atomic_compare_exchange_strong(&say_async_state, &state,
+					       SAY_ASYNC_RUNNING)) {
+		/* The log was destroyed meanwhile. */
+		say_async_wakeup();
+		tt_pthread_join(say_async_thread, NULL);
+		return -1;
+	}
+	return 0;
+fail:
+	/*
+	 * Nothing can be logged here, the caller's line is in
+	 * say_buf. Just fall back to synchronous writes.
+	 */
+	say_async = false;
+	state = SAY_ASYNC_STARTING;
+	pm_atomic_compare_exchange_strong(&say_async_state, &state,
+					  SAY_ASYNC_STOPPED);
+	return -1;
+}
+
+/**
+ * Stop the logger thread and write all pending lines.
+ * After that the log is written synchronously.
+ */
+static void
+say_async_stop(void)
+{
+	int state = pm_atomic_exchange(&say_async_state, SAY_ASYNC_SHUTDOWN);
+	if (state == SAY_ASYNC_RUNNING) {
+		say_async_wakeup();
+		tt_pthread_join(say_async_thread, NULL);
+	}
+	say_async_flush();
+	for (int i = 0; i < 2; i++) {
+		if (say_async_pipe[i] >= 0)
+			close(say_async_pipe[i]);
+		say_async_pipe[i] = -1;
+	}
+}
+
+/**
+ * Copy a formatted line to the ring buffer of the current thread.
+ * Return -1 if the line must be written synchronously.
+ */
+static int
+say_async_write(const char *buf, int total)
+{
+	if (pm_atomic_load(&say_async_state) != SAY_ASYNC_RUNNING &&
+	    say_async_start() != 0)
+		return -1;
+	struct say_ring *ring = say_ring_get();
+	if (ring == NULL)
+		return -1;
+	total = MIN(total, SAY_BUF_LEN_MAX - 1);
+	uint64_t tail = ring->tail;
+	uint64_t used = tail - pm_atomic_load(&ring->head);
+	if (used + total > SAY_ASYNC_RING_SIZE) {
+		pm_atomic_fetch_add(&ring->dropped, 1);
+		return 0;
+	}
+	size_t pos = tail & (SAY_ASYNC_RING_SIZE - 1);
+	size_t len = MIN((size_t)total, SAY_ASYNC_RING_SIZE - pos);
+	memcpy(ring->buf + pos, buf, len);
+	memcpy(ring->buf, buf + len, total - len);
+	pm_atomic_store(&ring->tail, tail + total);
+	/*
+	 * The logger thread wakes up on timeout by itself. Don't
+	 * wait for it if the buffer is getting full.
+	 */
+	if (used < SAY_ASYNC_RING_SIZE / 2 &&
+	    used + total >= SAY_ASYNC_RING_SIZE / 2)
+		say_async_wakeup();
+	return 0;
+}
+
+/** Asynchronous logging }}} */
+
 /*
  * Init string parser(s)
  */
@@ -1372,6 +1697,16 @@ log_vsay(struct log *log, int level, bool check_level, const char *module,
 	switch (log->type) {
 	case SAY_LOGGER_FILE:
 	case SAY_LOGGER_PIPE:
+		if (log == &log_std && say_async) {
+			/*
+			 * The process is about to die, so write the
+			 * pending lines and the fatal one right away.
+			 */
+			if (level == S_FATAL)
+				(void)say_async_flush();
+			else if (say_async_write(say_buf, total) == 0)
+				break;
+		}
 		write_to_file(log, total);
 		break;
 	case SAY_LOGGER_STDERR:
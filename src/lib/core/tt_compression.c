@@ -11,4 +11,5 @@
 
 const char *compression_type_strs[] = {
         "none",
+        "zstd",
 };
@@ -21,6 +21,7 @@ extern "C" {
 
 enum compression_type {
         COMPRESSION_TYPE_NONE = 0,
+        COMPRESSION_TYPE_ZSTD,
         compression_type_MAX
 };
 
@@ -0,0 +1,103 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2024, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#include "tt_cpu_set.h"
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+#include "diag.h"
+#include "trivia/util.h"
+
+/**
+ * Parse a CPU number at the given position and advance the position.
+ * Returns -1 if there's no valid CPU number at the position.
+ */
+static int
+tt_cpu_set_parse_cpu(const char **pos)
+{
+	const char *p = *pos;
+	if (!isdigit((unsigned char)*p))
+		return -1;
+	char *end;
+	long cpu = strtol(p, &end, 10);
+	if (cpu >= TT_CPU_SET_SIZE)
+		return -1;
+	*pos = end;
+	return (int)cpu;
+}
+
+int
+tt_cpu_set_parse(struct tt_cpu_set *set, const char *str)
+{
+	memset(set, 0, sizeof(*set));
+	const char *p = str;
+	while (*p != '\0') {
+		int first = tt_cpu_set_parse_cpu(&p);
+		if (first < 0)
+			goto error;
+		int last = first;
+		if (*p == '-') {
+			p++;
+			last = tt_cpu_set_parse_cpu(&p);
+			if (last < first)
+				goto error;
+		}
+		for (int cpu = first; cpu <= last; cpu++)
+			set->bits[cpu / 64] |= 1ULL << (cpu % 64);
+		if (*p == ',' && p[1] != '\0')
+			p++;
+		else if (*p != '\0')
+			goto error;
+	}
+	if (p == str)
+		goto error;
+	return 0;
+error:
+	diag_set(IllegalParams, "invalid CPU list '%s': expected "
+		 "comma-separated CPU numbers or ranges less than %d, "
+		 "e.g. '0-3,8'", str, TT_CPU_SET_SIZE);
+	return -1;
+}
+
+int
+tt_cpu_set_bind_thread(const struct tt_cpu_set *set)
+{
+#if defined(__linux__)
+	cpu_set_t cpus;
+	CPU_ZERO(&cpus);
+	for (int cpu = 0; cpu < TT_CPU_SET_SIZE && cpu < CPU_SETSIZE; cpu++) {
+		if (tt_cpu_set_has(set, cpu))
+			CPU_SET(cpu, &cpus);
+	}
+	/* Zero pid stands for the calling thread. */
+	if (sched_setaffinity(0, sizeof(cpus), &cpus) != 0) {
+		diag_set(SystemError, "failed to set CPU affinity");
+		return -1;
+	}
+	return 0;
+#else
+	(void)set;
+	diag_set(IllegalParams, "CPU affinity is not supported "
+		 "on this platform");
+	return -1;
+#endif
+}
+
+int
+tt_cpu_set_bind_thread_str(const char *str)
+{
+	if (str == NULL)
+		return 0;
+	struct tt_cpu_set set;
+	if (tt_cpu_set_parse(&set, str) != 0)
+		return -1;
+	return tt_cpu_set_bind_thread(&set);
+}
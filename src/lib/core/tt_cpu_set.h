@@ -0,0 +1,59 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2024, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+/** Max number of CPUs that can be stored in a CPU set. */
+#define TT_CPU_SET_SIZE 1024
+
+/** A set of CPUs a thread may run on. */
+struct tt_cpu_set {
+	/** Bitmap of CPUs: bit i is set if CPU i is in the set. */
+	uint64_t bits[TT_CPU_SET_SIZE / 64];
+};
+
+/**
+ * Parse a CPU list in the format used by taskset(1) and cpuset(7),
+ * i.e. a comma-separated list of CPU numbers and ranges, for example
+ * "0-3,8,10-11". Returns 0 on success. On failure, returns -1 and
+ * sets IllegalParams diag.
+ */
+int
+tt_cpu_set_parse(struct tt_cpu_set *set, const char *str);
+
+/** Check if a CPU is in a set. */
+static inline bool
+tt_cpu_set_has(const struct tt_cpu_set *set, int cpu)
+{
+	return (set->bits[cpu / 64] & (1ULL << (cpu % 64))) != 0;
+}
+
+/**
+ * Bind the calling thread to the CPUs of a set. Memory allocated by
+ * the thread afterwards is placed on the NUMA nodes of these CPUs
+ * under the default first-touch policy. Returns 0 on success. On
+ * failure, returns -1 and sets diag.
+ */
+int
+tt_cpu_set_bind_thread(const struct tt_cpu_set *set);
+
+/**
+ * Parse a CPU list with tt_cpu_set_parse() and bind the calling
+ * thread to it with tt_cpu_set_bind_thread(). Does nothing if the
+ * list is NULL. Returns 0 on success, -1 on failure, diag is set.
+ */
+int
+tt_cpu_set_bind_thread_str(const char *str);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
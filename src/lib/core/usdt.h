@@ -0,0 +1,66 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2026, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#pragma once
+
+#include "trivia/config.h"
+
+/**
+ * Statically defined tracing probes (USDT) for tracing a running
+ * instance with bpftrace, SystemTap, perf, etc.
+ *
+ * The probes are compiled in only if Tarantool is configured with
+ * -DENABLE_USDT=ON. A probe is a single nop instruction plus a note in
+ * the ELF file describing where its arguments are located, so it costs
+ * next to nothing unless a tracer is attached to it. Probe arguments must
+ * be integers or pointers and must not have side effects, because they
+ * aren't evaluated at all if probes are compiled out.
+ *
+ * All probes belong to the "tarantool" provider, e.g.:
+ *
+ *   bpftrace -e 'usdt:/usr/bin/tarantool:tarantool:txn_commit { ... }'
+ *
+ * The following probes are defined:
+ *
+ * iproto_request_received(msg, type, sync)
+ *   An IPROTO request was decoded in an IPROTO thread.
+ * iproto_request_dispatched(msg, type, sync)
+ *   A request started being processed in the TX thread.
+ * iproto_request_replied(msg, type, sync)
+ *   The reply to a request was queued for sending in an IPROTO thread.
+ *   The msg pointer is the same for all three probes of a request.
+ * txn_begin(txn_id)
+ * txn_commit(txn_id, signature)
+ *   The transaction was committed; signature is its LSN sum.
+ * txn_rollback(txn_id, signature)
+ *   The transaction was rolled back; signature is the error code.
+ * wal_entry_submit(entry, n_rows, approx_len)
+ *   A journal entry was queued for writing to WAL (TX thread).
+ * wal_batch_written(batch, vclock_sum)
+ *   A batch of entries was written to the WAL file (WAL thread). In the
+ *   'fsync' WAL mode without sync pipelining the data is synced as well.
+ * wal_batch_synced(vclock_sum)
+ *   The WAL file was synced by the pipelined sync fiber (WAL thread).
+ * vinyl_dump_start(space_id, index_id)
+ * vinyl_dump_stop(space_id, index_id, is_ok)
+ * vinyl_compaction_start(space_id, index_id)
+ * vinyl_compaction_stop(space_id, index_id, is_ok)
+ * relay_row_sent(relay, lsn)
+ *   A single row was written to the replica socket.
+ * relay_tx_sent(relay, row_count)
+ *   A transaction was written to the replica socket. Transactions of
+ *   one row, and all rows if error injections slow down the relay, are
+ *   sent with relay_row_sent instead.
+ * applier_tx_applied(replica_id, lsn)
+ *   A replicated transaction was submitted to WAL by an applier.
+ * fiber_switch(caller_fid, callee_fid)
+ *   Control was transferred from one fiber to another.
+ */
+#if defined(ENABLE_USDT)
+#include <sys/sdt.h>
+#define USDT_PROBE(name, ...) STAP_PROBEV(tarantool, name, ##__VA_ARGS__)
+#else
+#define USDT_PROBE(name, ...) do {} while (0)
+#endif
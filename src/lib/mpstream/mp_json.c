@@ -0,0 +1,674 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2024, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#include "mp_json.h"
+
+#include <assert.h>
+#include <inttypes.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "diag.h"
+#include "msgpuck.h"
+#include "mpstream.h"
+#include "mp_datetime.h"
+#include "mp_decimal.h"
+#include "mp_extension_types.h"
+#include "mp_uuid.h"
+#include "trivia/util.h"
+
+/* {{{ JSON -> MsgPack */
+
+/**
+ * The document is parsed twice. The first pass validates it and
+ * computes the sizes of all arrays and maps, which must be known
+ * before their contents are encoded. The second pass encodes the
+ * document to the stream using the sizes collected by the first.
+ */
+struct mp_json_parser {
+	/** Beginning of the document, used to report error positions. */
+	const char *start;
+	/** Current position in the document. */
+	const char *pos;
+	/** End of the document. */
+	const char *end;
+	/** Stream to encode to or NULL on the validation pass. */
+	struct mpstream *stream;
+	/** Sizes of arrays and maps in the order they are opened. */
+	uint32_t *sizes;
+	/** Number of containers seen on the validation pass. */
+	uint32_t size_count;
+	/** Number of allocated entries in sizes. */
+	uint32_t size_capacity;
+	/** Index of the next container on the encoding pass. */
+	uint32_t next_size;
+	/** Buffer for unescaped strings and numbers. */
+	char *buf;
+	/** Size of the buffer. */
+	size_t buf_capacity;
+};
+
+static int
+mp_json_error(struct mp_json_parser *p, const char *pos, const char *what)
+{
+	diag_set(IllegalParams, "Failed to decode JSON at position %zu: %s",
+		 (size_t)(pos - p->start) + 1, what);
+	return -1;
+}
+
+static char *
+mp_json_buf_reserve(struct mp_json_parser *p, size_t size)
+{
+	if (size > p->buf_capacity) {
+		size_t capacity = MAX(p->buf_capacity * 2, (size_t)64);
+		while (capacity < size)
+			capacity *= 2;
+		p->buf = xrealloc(p->buf, capacity);
+		p->buf_capacity = capacity;
+	}
+	return p->buf;
+}
+
+static inline void
+mp_json_skip_ws(struct mp_json_parser *p)
+{
+	while (p->pos < p->end && (*p->pos == ' ' || *p->pos == '\t' ||
+				   *p->pos == '\n' || *p->pos == '\r'))
+		p->pos++;
+}
+
+/**
+ * On the validation pass, allocates an entry for the size of the
+ * container being opened and returns its index. On the encoding
+ * pass, returns the size of the container.
+ */
+static uint32_t
+mp_json_container_open(struct mp_json_parser *p)
+{
+	if (p->stream != NULL) {
+		assert(p->next_size < p->size_count);
+		return p->sizes[p->next_size++];
+	}
+	if (p->size_count == p->size_capacity) {
+		p->size_capacity = MAX(p->size_capacity * 2, 16u);
+		p->sizes = xrealloc(p->sizes,
+				    p->size_capacity * sizeof(*p->sizes));
+	}
+	p->sizes[p->size_count] = 0;
+	return p->size_count++;
+}
+
+static int
+mp_json_parse_hex4(const char *s, const char *end, uint32_t *code)
+{
+	if (end - s < 4)
+		return -1;
+	*code = 0;
+	for (int i = 0; i < 4; i++) {
+		char c = s[i];
+		uint32_t digit;
+		if (c >= '0' && c <= '9')
+			digit = c - '0';
+		else if (c >= 'a' && c <= 'f')
+			digit = c - 'a' + 10;
+		else if (c >= 'A' && c <= 'F')
+			digit = c - 'A' + 10;
+		else
+			return -1;
+		*code = *code << 4 | digit;
+	}
+	return 0;
+}
+
+/** Write @a code to @a out in UTF-8. Returns the number of bytes. */
+static int
+mp_json_encode_utf8(char *out, uint32_t code)
+{
+	if (code < 0x80) {
+		out[0] = code;
+		return 1;
+	}
+	if (code < 0x800) {
+		out[0] = 0xC0 | (code >> 6);
+		out[1] = 0x80 | (code & 0x3F);
+		return 2;
+	}
+	if (code < 0x10000) {
+		out[0] = 0xE0 | (code >> 12);
+		out[1] = 0x80 | ((code >> 6) & 0x3F);
+		out[2] = 0x80 | (code & 0x3F);
+		return 3;
+	}
+	out[0] = 0xF0 | (code >> 18);
+	out[1] = 0x80 | ((code >> 12) & 0x3F);
+	out[2] = 0x80 | ((code >> 6) & 0x3F);
+	out[3] = 0x80 | (code & 0x3F);
+	return 4;
+}
+
+/**
+ * Parse a string. If it has no escape sequences, the result points
+ * to the document, otherwise the string is unescaped to the parser
+ * buffer.
+ */
+static int
+mp_json_parse_string(struct mp_json_parser *p, const char **str,
+		     uint32_t *len)
+{
+	assert(*p->pos == '"');
+	const char *begin = ++p->pos;
+	bool has_escapes = false;
+	while (true) {
+		if (p->pos == p->end)
+			return mp_json_error(p, p->pos, "unterminated string");
+		unsigned char c = *p->pos;
+		if (c == '"')
+			break;
+		if (c < 0x20) {
+			return mp_json_error(p, p->pos,
+					     "control character in string");
+		}
+		if (c == '\\') {
+			has_escapes = true;
+			if (++p->pos == p->end)
+				continue;
+		}
+		p->pos++;
+	}
+	const char *string_end = p->pos++;
+	if (!has_escapes) {
+		*str = begin;
+		*len = string_end - begin;
+		return 0;
+	}
+	/* An unescaped string is never longer than the escaped one. */
+	char *out = mp_json_buf_reserve(p, string_end - begin);
+	*str = out;
+	const char *s = begin;
+	while (s < string_end) {
+		if (*s != '\\') {
+			*out++ = *s++;
+			continue;
+		}
+		const char *escape = s++;
+		uint32_t code, low;
+		switch (*s++) {
+		case '"': *out++ = '"'; break;
+		case '\\': *out++ = '\\'; break;
+		case '/': *out++ = '/'; break;
+		case 'b': *out++ = '\b'; break;
+		case 'f': *out++ = '\f'; break;
+		case 'n': *out++ = '\n'; break;
+		case 'r': *out++ = '\r'; break;
+		case 't': *out++ = '\t'; break;
+		case 'u':
+			if (mp_json_parse_hex4(s, string_end, &code) != 0)
+				goto invalid_unicode;
+			s += 4;
+			if (code >= 0xDC00 && code <= 0xDFFF)
+				goto invalid_unicode;
+			if (code >= 0xD800 && code <= 0xDBFF) {
+				/* A surrogate pair. */
+				if (string_end - s < 6 || s[0] != '\\' ||
+				    s[1] != 'u' ||
+				    mp_json_parse_hex4(s + 2, string_end,
+						       &low) != 0 ||
+				    low < 0xDC00 || low > 0xDFFF)
+					goto invalid_unicode;
+				s += 6;
+				code = 0x10000 + ((code - 0xD800) << 10) +
+				       (low - 0xDC00);
+			}
+			out += mp_json_encode_utf8(out, code);
+			break;
+		default:
+			return mp_json_error(p, escape,
+					     "invalid escape sequence");
+		}
+		continue;
+invalid_unicode:
+		return mp_json_error(p, escape, "invalid unicode escape");
+	}
+	*len = out - *str;
+	return 0;
+}
+
+static inline bool
+mp_json_is_digit(const char *s, const char *end)
+{
+	return s < end && *s >= '0' && *s <= '9';
+}
+
+static int
+mp_json_parse_number(struct mp_json_parser *p)
+{
+	const char *begin = p->pos;
+	const char *s = begin;
+	const char *end = p->end;
+	bool is_negative = *s == '-';
+	if (is_negative)
+		s++;
+	if (!mp_json_is_digit(s, end))
+		return mp_json_error(p, begin, "invalid number");
+	uint64_t value = 0;
+	bool is_integer = true;
+	bool is_overflow = false;
+	if (*s == '0') {
+		s++;
+	} else {
+		for (; mp_json_is_digit(s, end); s++) {
+			unsigned digit = *s - '0';
+			if (value > (UINT64_MAX - digit) / 10)
+				is_overflow = true;
+			else
+				value = value * 10 + digit;
+		}
+	}
+	if (s < end && *s == '.') {
+		is_integer = false;
+		if (!mp_json_is_digit(++s, end))
+			return mp_json_error(p, begin, "invalid number");
+		while (mp_json_is_digit(s, end))
+			s++;
+	}
+	if (s < end && (*s == 'e' || *s == 'E')) {
+		is_integer = false;
+		s++;
+		if (s < end && (*s == '+' || *s == '-'))
+			s++;
+		if (!mp_json_is_digit(s, end))
+			return mp_json_error(p, begin, "invalid number");
+		while (mp_json_is_digit(s, end))
+			s++;
+	}
+	p->pos = s;
+	if (is_integer && !is_overflow) {
+		if (!is_negative || value == 0) {
+			if (p->stream != NULL)
+				mpstream_encode_uint(p->stream, value);
+			return 0;
+		}
+		if (value <= (uint64_t)INT64_MAX + 1) {
+			if (p->stream != NULL) {
+				mpstream_encode_int(p->stream,
+						    (int64_t)(0 - value));
+			}
+			return 0;
+		}
+	}
+	/* The number is not NUL-terminated, so strtod needs a copy. */
+	size_t len = s - begin;
+	char *buf = mp_json_buf_reserve(p, len + 1);
+	memcpy(buf, begin, len);
+	buf[len] = '\0';
+	double num = fpconv_strtod(buf, NULL);
+	if (!isfinite(num))
+		return mp_json_error(p, begin, "number is out of range");
+	if (p->stream != NULL)
+		mpstream_encode_double(p->stream, num);
+	return 0;
+}
+
+static int
+mp_json_parse_literal(struct mp_json_parser *p, const char *literal)
+{
+	size_t len = strlen(literal);
+	if ((size_t)(p->end - p->pos) < len ||
+	    memcmp(p->pos, literal, len) != 0)
+		return mp_json_error(p, p->pos, "unexpected character");
+	p->pos += len;
+	return 0;
+}
+
+static int
+mp_json_parse_value(struct mp_json_parser *p, int depth);
+
+static int
+mp_json_parse_array(struct mp_json_parser *p, int depth)
+{
+	if (depth > MP_JSON_MAX_DEPTH)
+		return mp_json_error(p, p->pos, "too many nested containers");
+	p->pos++;
+	uint32_t size = mp_json_container_open(p);
+	if (p->stream != NULL)
+		mpstream_encode_array(p->stream, size);
+	uint32_t count = 0;
+	mp_json_skip_ws(p);
+	if (p->pos < p->end && *p->pos == ']') {
+		p->pos++;
+		goto done;
+	}
+	while (true) {
+		if (mp_json_parse_value(p, depth) != 0)
+			return -1;
+		count++;
+		mp_json_skip_ws(p);
+		if (p->pos == p->end)
+			return mp_json_error(p, p->pos, "unexpected end");
+		if (*p->pos == ']') {
+			p->pos++;
+			break;
+		}
+		if (*p->pos != ',')
+			return mp_json_error(p, p->pos, "expected ',' or ']'");
+		p->pos++;
+	}
+done:
+	if (p->stream == NULL)
+		p->sizes[size] = count;
+	return 0;
+}
+
+static int
+mp_json_parse_object(struct mp_json_parser *p, int depth)
+{
+	if (depth > MP_JSON_MAX_DEPTH)
+		return mp_json_error(p, p->pos, "too many nested containers");
+	p->pos++;
+	uint32_t size = mp_json_container_open(p);
+	if (p->stream != NULL)
+		mpstream_encode_map(p->stream, size);
+	uint32_t count = 0;
+	mp_json_skip_ws(p);
+	if (p->pos < p->end && *p->pos == '}') {
+		p->pos++;
+		goto done;
+	}
+	while (true) {
+		mp_json_skip_ws(p);
+		if (p->pos == p->end || *p->pos != '"')
+			return mp_json_error(p, p->pos, "expected key");
+		const char *key;
+		uint32_t key_len;
+		if (mp_json_parse_string(p, &key, &key_len) != 0)
+			return -1;
+		if (p->stream != NULL)
+			mpstream_encode_strn(p->stream, key, key_len);
+		mp_json_skip_ws(p);
+		if (p->pos == p->end || *p->pos != ':')
+			return mp_json_error(p, p->pos, "expected ':'");
+		p->pos++;
+		if (mp_json_parse_value(p, depth) != 0)
+			return -1;
+		count++;
+		mp_json_skip_ws(p);
+		if (p->pos == p->end)
+			return mp_json_error(p, p->pos, "unexpected end");
+		if (*p->pos == '}') {
+			p->pos++;
+			break;
+		}
+		if (*p->pos != ',')
+			return mp_json_error(p, p->pos, "expected ',' or '}'");
+		p->pos++;
+	}
+done:
+	if (p->stream == NULL)
+		p->sizes[size] = count;
+	return 0;
+}
+
+static int
+mp_json_parse_value(struct mp_json_parser *p, int depth)
+{
+	mp_json_skip_ws(p);
+	if (p->pos == p->end)
+		return mp_json_error(p, p->pos, "unexpected end");
+	switch (*p->pos) {
+	case '[':
+		return mp_json_parse_array(p, depth + 1);
+	case '{':
+		return mp_json_parse_object(p, depth + 1);
+	case '"': {
+		const char *str;
+		uint32_t len;
+		if (mp_json_parse_string(p, &str, &len) != 0)
+			return -1;
+		if (p->stream != NULL)
+			mpstream_encode_strn(p->stream, str, len);
+		return 0;
+	}
+	case 't':
+		if (mp_json_parse_literal(p, "true") != 0)
+			return -1;
+		if (p->stream != NULL)
+			mpstream_encode_bool(p->stream, true);
+		return 0;
+	case 'f':
+		if (mp_json_parse_literal(p, "false") != 0)
+			return -1;
+		if (p->stream != NULL)
+			mpstream_encode_bool(p->stream, false);
+		return 0;
+	case 'n':
+		if (mp_json_parse_literal(p, "null") != 0)
+			return -1;
+		if (p->stream != NULL)
+			mpstream_encode_nil(p->stream);
+		return 0;
+	case '-':
+	case '0': case '1': case '2': case '3': case '4':
+	case '5': case '6': case '7': case '8': case '9':
+		return mp_json_parse_number(p);
+	default:
+		return mp_json_error(p, p->pos, "unexpected character");
+	}
+}
+
+static int
+mp_json_parse_document(struct mp_json_parser *p)
+{
+	if (mp_json_parse_value(p, 0) != 0)
+		return -1;
+	mp_json_skip_ws(p);
+	if (p->pos != p->end)
+		return mp_json_error(p, p->pos, "unexpected trailing data");
+	return 0;
+}
+
+int
+mpstream_encode_json(struct mpstream *stream, const char *json, size_t len)
+{
+	struct mp_json_parser p;
+	memset(&p, 0, sizeof(p));
+	p.start = json;
+	p.pos = json;
+	p.end = json + len;
+	int rc = mp_json_parse_document(&p);
+	if (rc == 0) {
+		p.pos = json;
+		p.stream = stream;
+		rc = mp_json_parse_document(&p);
+		assert(rc == 0);
+		assert(p.next_size == p.size_count);
+	}
+	free(p.sizes);
+	free(p.buf);
+	return rc;
+}
+
+/* }}} JSON -> MsgPack */
+
+/* {{{ MsgPack -> JSON */
+
+static int
+mp_json_encode_error(const char *what)
+{
+	diag_set(IllegalParams, "Failed to encode JSON: %s", what);
+	return -1;
+}
+
+static void
+mp_json_write_string(struct mpstream *stream, const char *str, uint32_t len)
+{
+	const char *end = str + len;
+	const char *run = str;
+	mpstream_memcpy(stream, "\"", 1);
+	for (const char *s = str; s < end; s++) {
+		const char *escape = json_escape_char(*s);
+		if (escape == NULL)
+			continue;
+		mpstream_memcpy(stream, run, s - run);
+		mpstream_memcpy(stream, escape, strlen(escape));
+		run = s + 1;
+	}
+	mpstream_memcpy(stream, run, end - run);
+	mpstream_memcpy(stream, "\"", 1);
+}
+
+static int
+mp_json_write_ext(struct mpstream *stream, const char **data)
+{
+	char buf[128];
+	int8_t type;
+	uint32_t len = mp_decode_extl(data, &type);
+	int size;
+	switch (type) {
+	case MP_DECIMAL:
+		size = mp_snprint_decimal(buf, sizeof(buf), data, len);
+		if (size < 0 || size >= (int)sizeof(buf))
+			return mp_json_encode_error("invalid decimal");
+		mpstream_memcpy(stream, buf, size);
+		return 0;
+	case MP_UUID:
+		size = mp_snprint_uuid(buf, sizeof(buf), data, len);
+		if (size < 0 || size >= (int)sizeof(buf))
+			return mp_json_encode_error("invalid uuid");
+		break;
+	case MP_DATETIME:
+		size = mp_snprint_datetime(buf, sizeof(buf), data, len);
+		if (size < 0 || size >= (int)sizeof(buf))
+			return mp_json_encode_error("invalid datetime");
+		break;
+	default:
+		return mp_json_encode_error("unsupported extension type");
+	}
+	mp_json_write_string(stream, buf, size);
+	return 0;
+}
+
+/** JSON keys are strings, so integer keys are written quoted. */
+static int
+mp_json_write_key(struct mpstream *stream, const char **data)
+{
+	char buf[32];
+	const char *str;
+	uint32_t len;
+	switch (mp_typeof(**data)) {
+	case MP_STR:
+		str = mp_decode_str(data, &len);
+		mp_json_write_string(stream, str, len);
+		return 0;
+	case MP_UINT:
+		len = snprintf(buf, sizeof(buf), "\"%" PRIu64 "\"",
+			       mp_decode_uint(data));
+		break;
+	case MP_INT:
+		len = snprintf(buf, sizeof(buf), "\"%" PRId64 "\"",
+			       mp_decode_int(data));
+		break;
+	default:
+		return mp_json_encode_error(
+			"map keys must be strings or integers");
+	}
+	mpstream_memcpy(stream, buf, len);
+	return 0;
+}
+
+static int
+mp_json_write_value(struct mpstream *stream, const char **data, int depth)
+{
+	char buf[FPCONV_G_FMT_BUFSIZE];
+	const char *str;
+	uint32_t len, size;
+	double num;
+	switch (mp_typeof(**data)) {
+	case MP_NIL:
+		mp_decode_nil(data);
+		mpstream_memcpy(stream, "null", 4);
+		return 0;
+	case MP_BOOL:
+		if (mp_decode_bool(data))
+			mpstream_memcpy(stream, "true", 4);
+		else
+			mpstream_memcpy(stream, "false", 5);
+		return 0;
+	case MP_UINT:
+		len = snprintf(buf, sizeof(buf), "%" PRIu64,
+			       mp_decode_uint(data));
+		mpstream_memcpy(stream, buf, len);
+		return 0;
+	case MP_INT:
+		len = snprintf(buf, sizeof(buf), "%" PRId64,
+			       mp_decode_int(data));
+		mpstream_memcpy(stream, buf, len);
+		return 0;
+	case MP_FLOAT:
+		num = mp_decode_float(data);
+		goto number;
+	case MP_DOUBLE:
+		num = mp_decode_double(data);
+number:
+		if (!isfinite(num))
+			return mp_json_encode_error("number is not finite");
+		len = fpconv_g_fmt(buf, num, FPCONV_G_FMT_MAX_PRECISION);
+		mpstream_memcpy(stream, buf, len);
+		return 0;
+	case MP_STR:
+		str = mp_decode_str(data, &len);
+		mp_json_write_string(stream, str, len);
+		return 0;
+	case MP_BIN:
+		return mp_json_encode_error("binary strings are unsupported");
+	case MP_ARRAY:
+		if (++depth > MP_JSON_MAX_DEPTH)
+			goto too_deep;
+		size = mp_decode_array(data);
+		mpstream_memcpy(stream, "[", 1);
+		for (uint32_t i = 0; i < size; i++) {
+			if (i > 0)
+				mpstream_memcpy(stream, ",", 1);
+			if (mp_json_write_value(stream, data, depth) != 0)
+				return -1;
+		}
+		mpstream_memcpy(stream, "]", 1);
+		return 0;
+	case MP_MAP:
+		if (++depth > MP_JSON_MAX_DEPTH)
+			goto too_deep;
+		size = mp_decode_map(data);
+		mpstream_memcpy(stream, "{", 1);
+		for (uint32_t i = 0; i < size; i++) {
+			if (i > 0)
+				mpstream_memcpy(stream, ",", 1);
+			if (mp_json_write_key(stream, data) != 0)
+				return -1;
+			mpstream_memcpy(stream, ":", 1);
+			if (mp_json_write_value(stream, data, depth) != 0)
+				return -1;
+		}
+		mpstream_memcpy(stream, "}", 1);
+		return 0;
+	case MP_EXT:
+		return mp_json_write_ext(stream, data);
+	default:
+		unreachable();
+	}
+	return 0;
+too_deep:
+	return mp_json_encode_error("too many nested containers");
+}
+
+int
+mpstream_encode_mp_as_json(struct mpstream *stream, const char **data)
+{
+	return mp_json_write_value(stream, data, 0);
+}
+
+/* }}} MsgPack -> JSON */
@@ -0,0 +1,50 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2024, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#pragma once
+
+#include <stddef.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+struct mpstream;
+
+enum {
+	/** Max nesting level of a JSON document that can be decoded. */
+	MP_JSON_MAX_DEPTH = 128,
+};
+
+/**
+ * Decode a JSON document and encode it to @a stream as MsgPack
+ * without building any intermediate representation of it.
+ *
+ * Integers that fit in 64 bits are encoded as MP_UINT or MP_INT,
+ * other numbers as MP_DOUBLE. The document is validated before
+ * anything is written, so nothing is written to @a stream on error.
+ *
+ * Returns 0 on success. On failure returns -1 and sets diag.
+ */
+int
+mpstream_encode_json(struct mpstream *stream, const char *json, size_t len);
+
+/**
+ * Write the MsgPack value pointed to by @a data to @a stream as
+ * JSON text and advance @a data past it.
+ *
+ * Integer map keys are written as strings. Decimals are written as
+ * numbers, UUIDs and datetimes as strings. Binary strings, other
+ * extensions, NaN and infinities have no JSON representation and
+ * are rejected.
+ *
+ * Returns 0 on success. On failure returns -1 and sets diag.
+ */
+int
+mpstream_encode_mp_as_json(struct mpstream *stream, const char **data);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
@@ -39,6 +39,22 @@
 #include <assert.h>
 #include <string.h>
 
+/**
+ * Allocate a table of the given number of blocks. The table is
+ * aligned by the cache line size so that checking a value touches
+ * exactly one cache line.
+ */
+static struct bloom_block *
+bloom_alloc_table(uint32_t block_count)
+{
+	void *table;
+	size_t size = (block_count > 0 ? block_count : 1) *
+		      sizeof(struct bloom_block);
+	if (posix_memalign(&table, BLOOM_CACHE_LINE, size) != 0)
+		return NULL;
+	return table;
+}
+
 int
 bloom_create(struct bloom *bloom, uint32_t number_of_values,
 	     double false_positive_rate)
@@ -49,9 +65,10 @@ bloom_create(struct bloom *bloom, uint32_t number_of_values,
 	uint32_t block_bits = CHAR_BIT * sizeof(struct bloom_block);
 	uint32_t block_count = (bit_count + block_bits - 1) / block_bits;
 
-	bloom->table = calloc(block_count, sizeof(*bloom->table));
+	bloom->table = bloom_alloc_table(block_count);
 	if (bloom->table == NULL)
 		return -1;
+	memset(bloom->table, 0, block_count * sizeof(*bloom->table));
 
 	bloom->table_size = block_count;
 	bloom->hash_count = hash_count;
@@ -95,7 +112,7 @@ int
 bloom_load_table(struct bloom *bloom, const char *table)
 {
 	size_t size = bloom->table_size * sizeof(struct bloom_block);
-	bloom->table = malloc(size);
+	bloom->table = bloom_alloc_table(bloom->table_size);
 	if (bloom->table == NULL)
 		return -1;
 	memcpy(bloom->table, table, size);
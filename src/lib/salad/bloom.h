@@ -61,7 +61,8 @@ enum {
 typedef uint32_t bloom_hash_t;
 
 /**
- * Cache-line-size block of bloom filter
+ * Cache-line-size block of bloom filter. Tables of blocks are
+ * allocated aligned by BLOOM_CACHE_LINE.
  */
 struct bloom_block {
 	unsigned char bits[BLOOM_CACHE_LINE];
@@ -171,10 +171,26 @@
  * size_t bps_tree_approximate_count(tree, key);
  * bps_tree_elem_t *bps_tree_iterator_get_elem(tree, itr);
  * bps_tree_elem_t *bps_tree_view_iterator_get_elem(view, itr);
+ * bps_tree_elem_t *bps_tree_iterator_get_leaf_elems(tree, itr, count);
  * bool bps_tree_iterator_next(tree, itr);
  * bool bps_tree_view_iterator_next(view, itr);
  * bool bps_tree_iterator_prev(tree, itr);
  * bool bps_tree_view_iterator_prev(view, itr);
+ * // order statistics (see BPS_INNER_CARD):
+ * struct bps_tree_iterator
+ * bps_tree_lower_bound_get_offset(tree, key, exact, offset);
+ * struct bps_tree_iterator
+ * bps_tree_view_lower_bound_get_offset(view, key, exact, offset);
+ * struct bps_tree_iterator
+ * bps_tree_upper_bound_get_offset(tree, key, exact, offset);
+ * struct bps_tree_iterator
+ * bps_tree_view_upper_bound_get_offset(view, key, exact, offset);
+ * struct bps_tree_iterator
+ * bps_tree_lower_bound_elem_get_offset(tree, elem, exact, offset);
+ * struct bps_tree_iterator
+ * bps_tree_view_lower_bound_elem_get_offset(view, elem, exact, offset);
+ * struct bps_tree_iterator bps_tree_iterator_at(tree, offset);
+ * struct bps_tree_iterator bps_tree_view_iterator_at(view, offset);
  */
 /* }}} */
 
@@ -314,6 +330,40 @@
  * #define BPS_BLOCK_LINEAR_SEARCH
  */
 
+/**
+ * Optional search of elements by hints. If elements carry an
+ * unsigned 64-bit hint such that an element with a lesser hint is
+ * always less than an element with a greater hint, a search in a
+ * block can be narrowed with a branch-free binary search over the
+ * hints, without calling the comparators, which are usually
+ * expensive and can't be inlined. To turn it on, define
+ * the following macros:
+ *
+ * Hint of an element:
+ * #define BPS_TREE_ELEM_HINT(elem) (elem).hint
+ *
+ * Store the range of hints of elements equal to a key or an
+ * element in lo and hi and return true. Elements with a hint less
+ * than lo must be less than the key, elements with a hint greater
+ * than hi must be greater than the key. Return false if hints
+ * can't be used for the search.
+ * #define BPS_TREE_KEY_HINT_RANGE(key, arg, lo, hi) \
+ *	my_key_hint_range(key, arg, lo, hi)
+ * #define BPS_TREE_ELEM_HINT_RANGE(elem, arg, lo, hi) \
+ *	my_elem_hint_range(elem, arg, lo, hi)
+ */
+
+/**
+ * Optional order statistics. If enabled, inner blocks store the
+ * number of elements in each child subtree, so the offset of an
+ * element in the tree can be found and an iterator can be positioned
+ * to an element by its offset in O(log(N)) time. The price is more
+ * memory in inner blocks (i.e. a lower branching factor) and an
+ * update of the whole path to the root on each insertion and deletion.
+ * To turn it on,
+ * #define BPS_INNER_CARD
+ */
+
 /**
  * A switch that enables collection of executions of different
  * branches of code. Used only for debug purposes, I hope you
@@ -423,9 +473,23 @@ typedef uint32_t bps_tree_block_id_t;
 #define bps_tree_upper_bound_elem _api_name(upper_bound_elem)
 #define bps_tree_view_upper_bound_elem _api_name(view_upper_bound_elem)
 #define bps_tree_approximate_count _api_name(approximate_count)
+#define bps_tree_lower_bound_get_offset _api_name(lower_bound_get_offset)
+#define bps_tree_view_lower_bound_get_offset \
+	_api_name(view_lower_bound_get_offset)
+#define bps_tree_upper_bound_get_offset _api_name(upper_bound_get_offset)
+#define bps_tree_view_upper_bound_get_offset \
+	_api_name(view_upper_bound_get_offset)
+#define bps_tree_lower_bound_elem_get_offset \
+	_api_name(lower_bound_elem_get_offset)
+#define bps_tree_view_lower_bound_elem_get_offset \
+	_api_name(view_lower_bound_elem_get_offset)
+#define bps_tree_iterator_at_impl _bps_tree(iterator_at)
+#define bps_tree_iterator_at _api_name(iterator_at)
+#define bps_tree_view_iterator_at _api_name(view_iterator_at)
 #define bps_tree_iterator_get_elem_impl _bps_tree(iterator_get_elem)
 #define bps_tree_iterator_get_elem _api_name(iterator_get_elem)
 #define bps_tree_view_iterator_get_elem _api_name(view_iterator_get_elem)
+#define bps_tree_iterator_get_leaf_elems _api_name(iterator_get_leaf_elems)
 #define bps_tree_iterator_next_impl _bps_tree(iterator_next)
 #define bps_tree_iterator_next _api_name(iterator_next)
 #define bps_tree_view_iterator_next _api_name(view_iterator_next)
@@ -466,6 +530,12 @@ typedef uint32_t bps_tree_block_id_t;
 #define bps_tree_touch_leaf_path_max_elem _bps_tree(touch_leaf_path_max_elem)
 #define bps_tree_touch_path _bps_tree(touch_path_max_elem)
 #define bps_tree_process_replace _bps_tree(process_replace)
+#define bps_tree_update_path_card _bps_tree(update_path_card)
+#define bps_tree_inner_card _bps_tree(inner_card)
+#define bps_tree_update_leaf_cards _bps_tree(update_leaf_cards)
+#define bps_tree_update_inner_cards _bps_tree(update_inner_cards)
+#define bps_tree_move_children _bps_tree(move_children)
+#define bps_tree_set_child _bps_tree(set_child)
 #define bps_tree_debug_memmove _bps_tree(debug_memmove)
 #define bps_tree_insert_into_leaf _bps_tree(insert_into_leaf)
 #define bps_tree_insert_into_inner _bps_tree(insert_into_inner)
@@ -987,6 +1057,107 @@ bps_tree_view_upper_bound_elem(const struct bps_tree_view *view,
 static inline size_t
 bps_tree_approximate_count(const struct bps_tree *tree, bps_tree_key_t key);
 
+#ifdef BPS_INNER_CARD
+
+/**
+ * @brief Same as bps_tree_lower_bound, but also returns the offset of
+ * the found element, i.e. the number of elements that are less than
+ * the key.
+ * @param tree - pointer to a tree
+ * @param key - key that will be compared with elements
+ * @param exact - pointer to a bool value, that will be set to true if
+ *  and element pointed by the iterator is equal to the key, false otherwise
+ *  Pass NULL if you don't need that info.
+ * @param offset - the offset of the found element is returned here. It's
+ *  the tree size if the iterator is invalid.
+ * @return - Lower-bound iterator. Invalid if all elements are less than key.
+ */
+static inline struct bps_tree_iterator
+bps_tree_lower_bound_get_offset(const struct bps_tree *tree,
+				bps_tree_key_t key, bool *exact,
+				size_t *offset);
+
+/**
+ * @brief Same as bps_tree_lower_bound_get_offset, but for a tree view.
+ */
+static inline struct bps_tree_iterator
+bps_tree_view_lower_bound_get_offset(const struct bps_tree_view *view,
+				     bps_tree_key_t key, bool *exact,
+				     size_t *offset);
+
+/**
+ * @brief Same as bps_tree_upper_bound, but also returns the offset of
+ * the found element, i.e. the number of elements that are less than or
+ * equal to the key.
+ * @param tree - pointer to a tree
+ * @param key - key that will be compared with elements
+ * @param exact - pointer to a bool value, that will be set to true if
+ *  and element pointed by the (!)previous iterator is equal to the key,
+ *  false otherwise. Pass NULL if you don't need that info.
+ * @param offset - the offset of the found element is returned here. It's
+ *  the tree size if the iterator is invalid.
+ * @return - Upper-bound iterator. Invalid if all elements are less or equal
+ *  than the key.
+ */
+static inline struct bps_tree_iterator
+bps_tree_upper_bound_get_offset(const struct bps_tree *tree,
+				bps_tree_key_t key, bool *exact,
+				size_t *offset);
+
+/**
+ * @brief Same as bps_tree_upper_bound_get_offset, but for a tree view.
+ */
+static inline struct bps_tree_iterator
+bps_tree_view_upper_bound_get_offset(const struct bps_tree_view *view,
+				     bps_tree_key_t key, bool *exact,
+				     size_t *offset);
+
+/**
+ * @brief Same as bps_tree_lower_bound_elem, but also returns the offset
+ * of the found element, i.e. the number of elements that are less than
+ * the given one.
+ * @param tree - pointer to a tree
+ * @param key - the element that will be compared with tree elements
+ * @param exact - pointer to a bool value, that will be set to true if
+ *  and element pointed by the iterator is equal to the key, false otherwise
+ *  Pass NULL if you don't need that info.
+ * @param offset - the offset of the found element is returned here. It's
+ *  the tree size if the iterator is invalid.
+ * @return - Lower-bound iterator. Invalid if all elements are less than key.
+ */
+static inline struct bps_tree_iterator
+bps_tree_lower_bound_elem_get_offset(const struct bps_tree *tree,
+				     bps_tree_elem_t key, bool *exact,
+				     size_t *offset);
+
+/**
+ * @brief Same as bps_tree_lower_bound_elem_get_offset, but for a tree
+ * view.
+ */
+static inline struct bps_tree_iterator
+bps_tree_view_lower_bound_elem_get_offset(const struct bps_tree_view *view,
+					  bps_tree_elem_t key, bool *exact,
+					  size_t *offset);
+
+/**
+ * @brief Get an iterator to the element at the given offset, i.e. to the
+ * element that has exactly @a offset elements before it in the tree.
+ * @param tree - pointer to a tree
+ * @param offset - offset of the element
+ * @return - Iterator to the element. Invalid if the offset is greater
+ *  than or equal to the tree size.
+ */
+static inline struct bps_tree_iterator
+bps_tree_iterator_at(const struct bps_tree *tree, size_t offset);
+
+/**
+ * @brief Same as bps_tree_iterator_at, but for a tree view.
+ */
+static inline struct bps_tree_iterator
+bps_tree_view_iterator_at(const struct bps_tree_view *view, size_t offset);
+
+#endif /* BPS_INNER_CARD */
+
 /**
  * @brief Get a pointer to the element pointed by iterator.
  *  If iterator is detected as broken, it is invalidated and NULL returned.
@@ -998,6 +1169,22 @@ static inline bps_tree_elem_t *
 bps_tree_iterator_get_elem(const struct bps_tree *tree,
 		           struct bps_tree_iterator *itr);
 
+/**
+ * @brief Get a pointer to the element pointed by iterator and the number
+ *  of elements stored in the same leaf starting from it. The elements
+ *  follow each other in memory in the tree order, so they can be read
+ *  (for example, prefetched) without moving the iterator.
+ *  If iterator is detected as broken, it is invalidated and NULL returned.
+ * @param tree - pointer to a tree
+ * @param itr - pointer to tree iterator
+ * @param[out] count - number of elements in the leaf starting from the
+ *  returned one, at least 1
+ * @return - Pointer to the element. Null for invalid iterator
+ */
+static inline bps_tree_elem_t *
+bps_tree_iterator_get_leaf_elems(const struct bps_tree *tree,
+				 struct bps_tree_iterator *itr, size_t *count);
+
 /**
  * @brief Get a pointer to the element pointed by iterator.
  *  If iterator is detected as broken, it is invalidated and NULL returned.
@@ -1137,9 +1324,18 @@ enum bps_tree_max_sizes {
 		(BPS_TREE_BLOCK_SIZE - sizeof(struct bps_block)
 		 - 2 * sizeof(bps_tree_block_id_t) )
 		/ sizeof(bps_tree_elem_t),
+#ifndef BPS_INNER_CARD
 	BPS_TREE_MAX_COUNT_IN_INNER =
 		(BPS_TREE_BLOCK_SIZE - sizeof(struct bps_block))
 		/ (sizeof(bps_tree_elem_t) + sizeof(bps_tree_block_id_t)),
+#else
+	/* Reserve sizeof(size_t) for the alignment of child_cards. */
+	BPS_TREE_MAX_COUNT_IN_INNER =
+		(BPS_TREE_BLOCK_SIZE - sizeof(struct bps_block)
+		 - sizeof(size_t))
+		/ (sizeof(bps_tree_elem_t) + sizeof(bps_tree_block_id_t)
+		   + sizeof(size_t)),
+#endif
 	BPS_TREE_MAX_DEPTH = 16
 };
 
@@ -1183,6 +1379,10 @@ struct bps_inner {
 	struct bps_block header;
 	/* Ordered array of elements. Note -1 in size. See struct descr. */
 	bps_tree_elem_t elems[BPS_TREE_MAX_COUNT_IN_INNER - 1];
+#ifdef BPS_INNER_CARD
+	/* Count of elements in the corresponding child subtrees */
+	size_t child_cards[BPS_TREE_MAX_COUNT_IN_INNER];
+#endif
 	/* Corresponding child IDs */
 	bps_tree_block_id_t child_ids[BPS_TREE_MAX_COUNT_IN_INNER];
 };
@@ -1401,6 +1601,9 @@ bps_tree_build(struct bps_tree *t, bps_tree_elem_t *sorted_array,
 			}
 			parents[i]->child_ids[parents[i]->header.size] =
 				insert_id;
+#ifdef BPS_INNER_CARD
+			parents[i]->child_cards[parents[i]->header.size] = 0;
+#endif
 			if (new_id == (bps_tree_block_id_t)-1)
 				break;
 			if (i == depth - 2) {
@@ -1410,6 +1613,12 @@ bps_tree_build(struct bps_tree *t, bps_tree_elem_t *sorted_array,
 			}
 		}
 
+#ifdef BPS_INNER_CARD
+		for (bps_tree_block_id_t i = 0; i < depth - 1; i++) {
+			parents[i]->child_cards[parents[i]->header.size] +=
+				leaf->header.size;
+		}
+#endif
 		bps_tree_elem_t insert_value = current[leaf->header.size - 1];
 		for (bps_tree_block_id_t i = 0; i < depth - 1; i++) {
 			parents[i]->header.size++;
@@ -1583,6 +1792,56 @@ bps_tree_random(const struct bps_tree *t, size_t rnd)
 	return leaf->elems + pos;
 }
 
+#ifdef BPS_TREE_ELEM_HINT
+
+/**
+ * @brief Find the lowest element in sorted array that has a hint
+ * greater than (or equal to if the is_upper is false) the hint.
+ * The search is branch-free: it always takes log2(size) steps
+ * and the CPU doesn't mispredict the direction of each step.
+ * @param arr - array of elements
+ * @param size - size of the array
+ * @param hint - hint to find
+ * @param is_upper - true to skip elements with the hint
+ */
+static inline bps_tree_elem_t *
+bps_tree_hint_bound(bps_tree_elem_t *arr, size_t size, uint64_t hint,
+		    bool is_upper)
+{
+	while (size > 1) {
+		size_t half = size / 2;
+		uint64_t mid_hint = BPS_TREE_ELEM_HINT(arr[half]);
+		bool is_less = mid_hint < hint || (is_upper && mid_hint == hint);
+		arr += is_less ? half : 0;
+		size -= half;
+	}
+	if (size == 0)
+		return arr;
+	uint64_t last_hint = BPS_TREE_ELEM_HINT(*arr);
+	return arr + (last_hint < hint || (is_upper && last_hint == hint));
+}
+
+/**
+ * @brief Narrow a range of a sorted array down to the elements
+ * having hints in [lo, hi]. The elements outside the range are
+ * known to be not equal to the searched key.
+ * @param begin - pointer to the beginning of the range
+ * @param end - pointer to the end of the range
+ * @param lo - min hint of an element equal to the key
+ * @param hi - max hint of an element equal to the key
+ */
+static inline void
+bps_tree_narrow_by_hint(bps_tree_elem_t **begin, bps_tree_elem_t **end,
+			uint64_t lo, uint64_t hi)
+{
+	bps_tree_elem_t *new_begin =
+		bps_tree_hint_bound(*begin, *end - *begin, lo, false);
+	*end = bps_tree_hint_bound(new_begin, *end - new_begin, hi, true);
+	*begin = new_begin;
+}
+
+#endif /* BPS_TREE_ELEM_HINT */
+
 /**
  * @brief Find the lowest element in sorted array that is >= than the key
  * @param tree - pointer to a tree
@@ -1600,6 +1859,11 @@ bps_tree_find_ins_point_key(const struct bps_tree_common *tree,
 	bps_tree_elem_t *begin = arr;
 	bps_tree_elem_t *end = arr + size;
 	*exact = false;
+#ifdef BPS_TREE_KEY_HINT_RANGE
+	uint64_t hint_lo, hint_hi;
+	if (BPS_TREE_KEY_HINT_RANGE(key, tree->arg, &hint_lo, &hint_hi))
+		bps_tree_narrow_by_hint(&begin, &end, hint_lo, hint_hi);
+#endif
 #ifdef BPS_BLOCK_LINEAR_SEARCH
 	while (begin != end) {
 		int res = BPS_TREE_COMPARE_KEY(*begin, key, tree->arg);
@@ -1645,6 +1909,11 @@ bps_tree_find_ins_point_elem(const struct bps_tree_common *tree,
 	bps_tree_elem_t *begin = arr;
 	bps_tree_elem_t *end = arr + size;
 	*exact = false;
+#ifdef BPS_TREE_ELEM_HINT_RANGE
+	uint64_t hint_lo, hint_hi;
+	if (BPS_TREE_ELEM_HINT_RANGE(elem, tree->arg, &hint_lo, &hint_hi))
+		bps_tree_narrow_by_hint(&begin, &end, hint_lo, hint_hi);
+#endif
 #ifdef BPS_BLOCK_LINEAR_SEARCH
 	while (begin != end) {
 		int res = BPS_TREE_COMPARE(*begin, elem, tree->arg);
@@ -1691,6 +1960,11 @@ bps_tree_find_after_ins_point_key(const struct bps_tree_common *tree,
 	bps_tree_elem_t *begin = arr;
 	bps_tree_elem_t *end = arr + size;
 	*exact = false;
+#ifdef BPS_TREE_KEY_HINT_RANGE
+	uint64_t hint_lo, hint_hi;
+	if (BPS_TREE_KEY_HINT_RANGE(key, tree->arg, &hint_lo, &hint_hi))
+		bps_tree_narrow_by_hint(&begin, &end, hint_lo, hint_hi);
+#endif
 #ifdef BPS_BLOCK_LINEAR_SEARCH
 	while (begin != end) {
 		int res = BPS_TREE_COMPARE_KEY(*begin, key, tree->arg);
@@ -1736,6 +2010,11 @@ bps_tree_find_after_ins_point_elem(const struct bps_tree_common *tree,
 	bps_tree_elem_t *begin = arr;
 	bps_tree_elem_t *end = arr + size;
 	*exact = false;
+#ifdef BPS_TREE_ELEM_HINT_RANGE
+	uint64_t hint_lo, hint_hi;
+	if (BPS_TREE_ELEM_HINT_RANGE(elem, tree->arg, &hint_lo, &hint_hi))
+		bps_tree_narrow_by_hint(&begin, &end, hint_lo, hint_hi);
+#endif
 #ifdef BPS_BLOCK_LINEAR_SEARCH
 	while (begin != end) {
 		int res = BPS_TREE_COMPARE(*begin, elem, tree->arg);
@@ -1957,13 +2236,18 @@ bps_tree_view_last(const struct bps_tree_view *view)
  */
 static inline struct bps_tree_iterator
 bps_tree_lower_bound_impl(const struct bps_tree_common *tree,
-			  bps_tree_key_t key, bool *exact)
+			  bps_tree_key_t key, bool *exact,
+			  size_t *offset)
 {
 	struct bps_tree_iterator res;
 	bool local_result;
 	if (!exact)
 		exact = &local_result;
 	*exact = false;
+	size_t local_offset;
+	if (!offset)
+		offset = &local_offset;
+	*offset = 0;
 	if (tree->root_id == (bps_tree_block_id_t)(-1)) {
 		res.block_id = (bps_tree_block_id_t)(-1);
 		res.pos = 0;
@@ -1977,6 +2261,10 @@ bps_tree_lower_bound_impl(const struct bps_tree_common *tree,
 		pos = bps_tree_find_ins_point_key(tree, inner->elems,
 						  inner->header.size - 1,
 						  key, exact);
+#ifdef BPS_INNER_CARD
+		for (bps_tree_pos_t j = 0; j < pos; j++)
+			*offset += inner->child_cards[j];
+#endif
 		block_id = inner->child_ids[pos];
 		block = bps_tree_restore_block(tree, block_id);
 	}
@@ -1985,6 +2273,7 @@ bps_tree_lower_bound_impl(const struct bps_tree_common *tree,
 	bps_tree_pos_t pos;
 	pos = bps_tree_find_ins_point_key(tree, leaf->elems, leaf->header.size,
 					  key, exact);
+	*offset += pos;
 	if (pos >= leaf->header.size) {
 		res.block_id = leaf->next_id;
 		res.pos = 0;
@@ -1999,14 +2288,14 @@ static inline struct bps_tree_iterator
 bps_tree_lower_bound(const struct bps_tree *tree, bps_tree_key_t key,
 		     bool *exact)
 {
-	return bps_tree_lower_bound_impl(&tree->common, key, exact);
+	return bps_tree_lower_bound_impl(&tree->common, key, exact, NULL);
 }
 
 static inline struct bps_tree_iterator
 bps_tree_view_lower_bound(const struct bps_tree_view *view, bps_tree_key_t key,
 			  bool *exact)
 {
-	return bps_tree_lower_bound_impl(&view->common, key, exact);
+	return bps_tree_lower_bound_impl(&view->common, key, exact, NULL);
 }
 
 /**
@@ -2021,13 +2310,18 @@ bps_tree_view_lower_bound(const struct bps_tree_view *view, bps_tree_key_t key,
  */
 static inline struct bps_tree_iterator
 bps_tree_upper_bound_impl(const struct bps_tree_common *tree,
-			  bps_tree_key_t key, bool *exact)
+			  bps_tree_key_t key, bool *exact,
+			  size_t *offset)
 {
 	struct bps_tree_iterator res;
 	bool local_result;
 	if (!exact)
 		exact = &local_result;
 	*exact = false;
+	size_t local_offset;
+	if (!offset)
+		offset = &local_offset;
+	*offset = 0;
 	bool exact_test;
 	if (tree->root_id == (bps_tree_block_id_t)(-1)) {
 		res.block_id = (bps_tree_block_id_t)(-1);
@@ -2044,6 +2338,10 @@ bps_tree_upper_bound_impl(const struct bps_tree_common *tree,
 							key, &exact_test);
 		if (exact_test)
 			*exact = true;
+#ifdef BPS_INNER_CARD
+		for (bps_tree_pos_t j = 0; j < pos; j++)
+			*offset += inner->child_cards[j];
+#endif
 		block_id = inner->child_ids[pos];
 		block = bps_tree_restore_block(tree, block_id);
 	}
@@ -2055,6 +2353,7 @@ bps_tree_upper_bound_impl(const struct bps_tree_common *tree,
 						key, &exact_test);
 	if (exact_test)
 		*exact = true;
+	*offset += pos;
 	if (pos >= leaf->header.size) {
 		res.block_id = leaf->next_id;
 		res.pos = 0;
@@ -2069,14 +2368,14 @@ static inline struct bps_tree_iterator
 bps_tree_upper_bound(const struct bps_tree *tree, bps_tree_key_t key,
 		     bool *exact)
 {
-	return bps_tree_upper_bound_impl(&tree->common, key, exact);
+	return bps_tree_upper_bound_impl(&tree->common, key, exact, NULL);
 }
 
 static inline struct bps_tree_iterator
 bps_tree_view_upper_bound(const struct bps_tree_view *view, bps_tree_key_t key,
 			  bool *exact)
 {
-	return bps_tree_upper_bound_impl(&view->common, key, exact);
+	return bps_tree_upper_bound_impl(&view->common, key, exact, NULL);
 }
 
 /**
@@ -2091,13 +2390,18 @@ bps_tree_view_upper_bound(const struct bps_tree_view *view, bps_tree_key_t key,
  */
 static inline struct bps_tree_iterator
 bps_tree_lower_bound_elem_impl(const struct bps_tree_common *tree,
-			       bps_tree_elem_t key, bool *exact)
+			       bps_tree_elem_t key, bool *exact,
+			       size_t *offset)
 {
 	struct bps_tree_iterator res;
 	bool local_result;
 	if (!exact)
 		exact = &local_result;
 	*exact = false;
+	size_t local_offset;
+	if (!offset)
+		offset = &local_offset;
+	*offset = 0;
 	if (tree->root_id == (bps_tree_block_id_t)(-1)) {
 		res.block_id = (bps_tree_block_id_t)(-1);
 		res.pos = 0;
@@ -2111,6 +2415,10 @@ bps_tree_lower_bound_elem_impl(const struct bps_tree_common *tree,
 		pos = bps_tree_find_ins_point_elem(tree, inner->elems,
 						   inner->header.size - 1,
 						   key, exact);
+#ifdef BPS_INNER_CARD
+		for (bps_tree_pos_t j = 0; j < pos; j++)
+			*offset += inner->child_cards[j];
+#endif
 		block_id = inner->child_ids[pos];
 		block = bps_tree_restore_block(tree, block_id);
 	}
@@ -2119,6 +2427,7 @@ bps_tree_lower_bound_elem_impl(const struct bps_tree_common *tree,
 	bps_tree_pos_t pos;
 	pos = bps_tree_find_ins_point_elem(tree, leaf->elems, leaf->header.size,
 					   key, exact);
+	*offset += pos;
 	if (pos >= leaf->header.size) {
 		res.block_id = leaf->next_id;
 		res.pos = 0;
@@ -2133,14 +2442,14 @@ static inline struct bps_tree_iterator
 bps_tree_lower_bound_elem(const struct bps_tree *tree, bps_tree_elem_t key,
 			  bool *exact)
 {
-	return bps_tree_lower_bound_elem_impl(&tree->common, key, exact);
+	return bps_tree_lower_bound_elem_impl(&tree->common, key, exact, NULL);
 }
 
 static inline struct bps_tree_iterator
 bps_tree_view_lower_bound_elem(const struct bps_tree_view *view,
 			       bps_tree_elem_t key, bool *exact)
 {
-	return bps_tree_lower_bound_elem_impl(&view->common, key, exact);
+	return bps_tree_lower_bound_elem_impl(&view->common, key, exact, NULL);
 }
 
 /**
@@ -2297,6 +2606,109 @@ bps_tree_approximate_count(const struct bps_tree *t, bps_tree_key_t key)
 	return result;
 }
 
+#ifdef BPS_INNER_CARD
+
+static inline struct bps_tree_iterator
+bps_tree_lower_bound_get_offset(const struct bps_tree *tree,
+				bps_tree_key_t key, bool *exact,
+				size_t *offset)
+{
+	return bps_tree_lower_bound_impl(&tree->common, key, exact, offset);
+}
+
+static inline struct bps_tree_iterator
+bps_tree_view_lower_bound_get_offset(const struct bps_tree_view *view,
+				     bps_tree_key_t key, bool *exact,
+				     size_t *offset)
+{
+	return bps_tree_lower_bound_impl(&view->common, key, exact, offset);
+}
+
+static inline struct bps_tree_iterator
+bps_tree_upper_bound_get_offset(const struct bps_tree *tree,
+				bps_tree_key_t key, bool *exact,
+				size_t *offset)
+{
+	return bps_tree_upper_bound_impl(&tree->common, key, exact, offset);
+}
+
+static inline struct bps_tree_iterator
+bps_tree_view_upper_bound_get_offset(const struct bps_tree_view *view,
+				     bps_tree_key_t key, bool *exact,
+				     size_t *offset)
+{
+	return bps_tree_upper_bound_impl(&view->common, key, exact, offset);
+}
+
+static inline struct bps_tree_iterator
+bps_tree_lower_bound_elem_get_offset(const struct bps_tree *tree,
+				     bps_tree_elem_t key, bool *exact,
+				     size_t *offset)
+{
+	return bps_tree_lower_bound_elem_impl(&tree->common, key, exact,
+					      offset);
+}
+
+static inline struct bps_tree_iterator
+bps_tree_view_lower_bound_elem_get_offset(const struct bps_tree_view *view,
+					  bps_tree_elem_t key, bool *exact,
+					  size_t *offset)
+{
+	return bps_tree_lower_bound_elem_impl(&view->common, key, exact,
+					      offset);
+}
+
+/**
+ * @brief Get an iterator to the element at the given offset.
+ * Descends from the root choosing the child subtree by the cumulative
+ * counts of elements stored in inner blocks.
+ * @param tree - pointer to a tree
+ * @param offset - offset of the element
+ * @return - Iterator to the element. Invalid if the offset is greater
+ *  than or equal to the tree size.
+ */
+static inline struct bps_tree_iterator
+bps_tree_iterator_at_impl(const struct bps_tree_common *tree, size_t offset)
+{
+	struct bps_tree_iterator res;
+	if (offset >= tree->size) {
+		res.block_id = (bps_tree_block_id_t)(-1);
+		res.pos = 0;
+		return res;
+	}
+	struct bps_block *block = bps_tree_root(tree);
+	bps_tree_block_id_t block_id = tree->root_id;
+	for (bps_tree_block_id_t i = 0; i < tree->depth - 1; i++) {
+		struct bps_inner *inner = (struct bps_inner *)block;
+		bps_tree_pos_t pos = 0;
+		while (offset >= inner->child_cards[pos]) {
+			offset -= inner->child_cards[pos];
+			pos++;
+			assert(pos < inner->header.size);
+		}
+		block_id = inner->child_ids[pos];
+		block = bps_tree_restore_block(tree, block_id);
+	}
+	assert(offset < (size_t)block->size);
+	res.block_id = block_id;
+	res.pos = (bps_tree_pos_t)offset;
+	return res;
+}
+
+static inline struct bps_tree_iterator
+bps_tree_iterator_at(const struct bps_tree *tree, size_t offset)
+{
+	return bps_tree_iterator_at_impl(&tree->common, offset);
+}
+
+static inline struct bps_tree_iterator
+bps_tree_view_iterator_at(const struct bps_tree_view *view, size_t offset)
+{
+	return bps_tree_iterator_at_impl(&view->common, offset);
+}
+
+#endif /* BPS_INNER_CARD */
+
 /**
  * @brief Get a pointer to the element pointed by iterator.
  *  If iterator is detected as broken, it is invalidated and NULL returned.
@@ -2328,6 +2740,17 @@ bps_tree_view_iterator_get_elem(const struct bps_tree_view *view,
 	return bps_tree_iterator_get_elem_impl(&view->common, itr);
 }
 
+static inline bps_tree_elem_t *
+bps_tree_iterator_get_leaf_elems(const struct bps_tree *tree,
+				 struct bps_tree_iterator *itr, size_t *count)
+{
+	struct bps_leaf *leaf = bps_tree_get_leaf_safe(&tree->common, itr);
+	if (!leaf)
+		return 0;
+	*count = leaf->header.size - itr->pos;
+	return leaf->elems + itr->pos;
+}
+
 /**
  * @brief Increments an iterator, makes it point to the next element
  *  If the iterator is to last element, it will be invalidated
@@ -2785,6 +3208,16 @@ bps_tree_debug_memmove(void *dst_arg, void *src_arg, size_t num,
 				assert(src < ((char *)src_inner->elems) +
 				       (BPS_TREE_MAX_COUNT_IN_INNER - 1) *
 				       sizeof(bps_tree_elem_t));
+#ifdef BPS_INNER_CARD
+			} else if (dst >= ((char *)dst_inner->child_cards) &&
+				   dst < ((char *)dst_inner->child_cards) +
+				   BPS_TREE_MAX_COUNT_IN_INNER *
+				   sizeof(size_t)) {
+				assert(src >= (char *)src_inner->child_cards);
+				assert(src < ((char *)src_inner->child_cards) +
+				       BPS_TREE_MAX_COUNT_IN_INNER *
+				       sizeof(size_t));
+#endif
 			} else {
 				assert(dst >= ((char *)dst_inner->child_ids));
 				assert(dst < ((char *)dst_inner->child_ids) +
@@ -2805,6 +3238,15 @@ bps_tree_debug_memmove(void *dst_arg, void *src_arg, size_t num,
 					(BPS_TREE_MAX_COUNT_IN_INNER - 1) *
 					sizeof(bps_tree_elem_t)) {
 				/* nothing to do due to if condition */
+#ifdef BPS_INNER_CARD
+			} else if (dst >= (char *)dst_inner->child_cards
+					&& dst <= (char *)(dst_inner->child_cards
+					+ BPS_TREE_MAX_COUNT_IN_INNER)
+					&& src >= (char *)src_inner->child_cards
+					&& src <= (char *)(src_inner->child_cards
+					+ BPS_TREE_MAX_COUNT_IN_INNER)) {
+				/* nothing to do due to if condition */
+#endif
 			} else {
 				assert(dst >= ((char *)dst_inner->child_ids));
 				assert(dst <= ((char *)dst_inner->child_ids) +
@@ -2822,6 +3264,143 @@ bps_tree_debug_memmove(void *dst_arg, void *src_arg, size_t num,
 }
 #endif
 
+/**
+ * @brief Move children of inner blocks along with their cardinalities.
+ */
+static inline void
+bps_tree_move_children(struct bps_inner *dst, bps_tree_pos_t dst_pos,
+		       struct bps_inner *src, bps_tree_pos_t src_pos,
+		       bps_tree_pos_t num)
+{
+	BPS_TREE_DATAMOVE(dst->child_ids + dst_pos, src->child_ids + src_pos,
+			  num, dst, src);
+#ifdef BPS_INNER_CARD
+	BPS_TREE_DATAMOVE(dst->child_cards + dst_pos,
+			  src->child_cards + src_pos, num, dst, src);
+#endif
+}
+
+/**
+ * @brief Set a child of inner block along with its cardinality.
+ */
+static inline void
+bps_tree_set_child(struct bps_inner *inner, bps_tree_pos_t pos,
+		   bps_tree_block_id_t block_id, size_t card)
+{
+	inner->child_ids[pos] = block_id;
+#ifdef BPS_INNER_CARD
+	inner->child_cards[pos] = card;
+#else
+	(void)card;
+#endif
+}
+
+/**
+ * @brief Get the number of elements in the subtree of an inner block.
+ */
+static inline size_t
+bps_tree_inner_card(const struct bps_inner *inner)
+{
+	size_t card = 0;
+#ifdef BPS_INNER_CARD
+	for (bps_tree_pos_t i = 0; i < inner->header.size; i++)
+		card += inner->child_cards[i];
+#else
+	(void)inner;
+#endif
+	return card;
+}
+
+/**
+ * @brief Add delta to the cardinalities of all subtrees on the path
+ * to a leaf. Used before an element is inserted to or deleted from the
+ * leaf, the cardinalities of the leaf and its siblings are fixed up
+ * afterwards if elements are moved between them.
+ */
+static inline void
+bps_tree_update_path_card(struct bps_tree_common *tree,
+			  struct bps_leaf_path_elem *leaf_path_elem,
+			  int delta)
+{
+#ifdef BPS_INNER_CARD
+	for (struct bps_inner_path_elem *path = leaf_path_elem->parent;
+	     path; path = path->parent) {
+		path->block = (struct bps_inner *)
+			bps_tree_touch_block(tree, path->block_id);
+		path->block->child_cards[path->insertion_point] += delta;
+	}
+#else
+	(void)tree;
+	(void)leaf_path_elem;
+	(void)delta;
+#endif
+}
+
+/**
+ * @brief Set the cardinalities of a leaf and its siblings in their
+ * parent block after elements were moved between them. Siblings that
+ * were not collected (have no parent) are skipped. The parent block
+ * must be touched.
+ */
+static inline void
+bps_tree_update_leaf_cards(struct bps_leaf_path_elem *leaf_path_elem,
+			   struct bps_leaf_path_elem *left_ext,
+			   struct bps_leaf_path_elem *right_ext,
+			   struct bps_leaf_path_elem *left_left_ext,
+			   struct bps_leaf_path_elem *right_right_ext)
+{
+#ifdef BPS_INNER_CARD
+	struct bps_leaf_path_elem *elems[] = {
+		leaf_path_elem, left_ext, right_ext,
+		left_left_ext, right_right_ext,
+	};
+	for (size_t i = 0; i < sizeof(elems) / sizeof(elems[0]); i++) {
+		struct bps_leaf_path_elem *elem = elems[i];
+		if (elem->parent == NULL)
+			continue;
+		elem->parent->block->child_cards[elem->pos_in_parent] =
+			elem->block->header.size;
+	}
+#else
+	(void)leaf_path_elem;
+	(void)left_ext;
+	(void)right_ext;
+	(void)left_left_ext;
+	(void)right_right_ext;
+#endif
+}
+
+/**
+ * @brief Same as bps_tree_update_leaf_cards, but for inner blocks.
+ */
+static inline void
+bps_tree_update_inner_cards(struct bps_inner_path_elem *inner_path_elem,
+			    struct bps_inner_path_elem *left_ext,
+			    struct bps_inner_path_elem *right_ext,
+			    struct bps_inner_path_elem *left_left_ext,
+			    struct bps_inner_path_elem *right_right_ext)
+{
+#ifdef BPS_INNER_CARD
+	struct bps_inner_path_elem *elems[] = {
+		inner_path_elem, left_ext, right_ext,
+		left_left_ext, right_right_ext,
+	};
+	for (size_t i = 0; i < sizeof(elems) / sizeof(elems[0]); i++) {
+		struct bps_inner_path_elem *elem = elems[i];
+		if (elem->parent == NULL)
+			continue;
+		elem->parent->block->child_cards[elem->pos_in_parent] =
+			bps_tree_inner_card(elem->block);
+	}
+#else
+	(void)inner_path_elem;
+	(void)left_ext;
+	(void)right_ext;
+	(void)left_left_ext;
+	(void)right_right_ext;
+#endif
+}
+
 /**
  * @breif Insert an element into leaf block. There must be enough space.
  */
@@ -2860,7 +3439,7 @@ static inline void
 bps_tree_insert_into_inner(struct bps_tree_common *tree,
 			   struct bps_inner_path_elem *inner_path_elem,
 			   bps_tree_block_id_t block_id, bps_tree_pos_t pos,
-			   bps_tree_elem_t max_elem)
+			   bps_tree_elem_t max_elem, size_t card)
 {
 	/* exclusive behaviuor for debug checks */
 	if (tree->root_id != (bps_tree_block_id_t) -1)
@@ -2876,15 +3455,14 @@ bps_tree_insert_into_inner(struct bps_tree_common *tree,
 		BPS_TREE_DATAMOVE(inner->elems + pos + 1, inner->elems + pos,
 				  inner->header.size - pos - 1, inner, inner);
 		inner->elems[pos] = max_elem;
-		BPS_TREE_DATAMOVE(inner->child_ids + pos + 1,
-				  inner->child_ids + pos,
-				  inner->header.size - pos, inner, inner);
+		bps_tree_move_children(inner, pos + 1, inner, pos,
+				       inner->header.size - pos);
 	} else {
 		if (pos > 0)
 			inner->elems[pos - 1] = *inner_path_elem->max_elem_copy;
 		*inner_path_elem->max_elem_copy = max_elem;
 	}
-	inner->child_ids[pos] = block_id;
+	bps_tree_set_child(inner, pos, block_id, card);
 
 	inner->header.size++;
 }
@@ -2940,9 +3518,8 @@ bps_tree_delete_from_inner(struct bps_tree_common *tree,
 	if (pos < inner->header.size - 1) {
 		BPS_TREE_DATAMOVE(inner->elems + pos, inner->elems + pos + 1,
 				  inner->header.size - 2 - pos, inner, inner);
-		BPS_TREE_DATAMOVE(inner->child_ids + pos,
-				  inner->child_ids + pos + 1,
-				  inner->header.size - 1 - pos, inner, inner);
+		bps_tree_move_children(inner, pos, inner, pos + 1,
+				       inner->header.size - 1 - pos);
 	} else if (pos > 0) {
 		*inner_path_elem->max_elem_copy = inner->elems[pos - 1];
 	}
@@ -3012,10 +3589,8 @@ bps_tree_move_elems_to_right_inner(struct bps_tree_common *tree,
 	assert(a->header.size >= num);
 	assert(b->header.size + num <= BPS_TREE_MAX_COUNT_IN_INNER);
 
-	BPS_TREE_DATAMOVE(b->child_ids + num, b->child_ids,
-			  b->header.size, b, b);
-	BPS_TREE_DATAMOVE(b->child_ids, a->child_ids + a->header.size - num,
-			  num, b, a);
+	bps_tree_move_children(b, num, b, 0, b->header.size);
+	bps_tree_move_children(b, 0, a, a->header.size - num, num);
 
 	if (!move_to_empty)
 		BPS_TREE_DATAMOVE(b->elems + num, b->elems,
@@ -3092,10 +3667,8 @@ bps_tree_move_elems_to_left_inner(struct bps_tree_common *tree,
 	assert(b->header.size >= num);
 	assert(a->header.size + num <= BPS_TREE_MAX_COUNT_IN_INNER);
 
-	BPS_TREE_DATAMOVE(a->child_ids + a->header.size, b->child_ids,
-			  num, a, b);
-	BPS_TREE_DATAMOVE(b->child_ids, b->child_ids + num,
-			  b->header.size - num, b, b);
+	bps_tree_move_children(a, a->header.size, b, 0, num);
+	bps_tree_move_children(b, 0, b, num, b->header.size - num);
 
 	if (!move_to_empty)
 		a->elems[a->header.size - 1] =
@@ -3197,7 +3770,7 @@ bps_tree_insert_and_move_elems_to_right_inner(
 		struct bps_inner_path_elem *a_inner_path_elem,
 		struct bps_inner_path_elem *b_inner_path_elem,
 		bps_tree_pos_t num, bps_tree_block_id_t block_id,
-		bps_tree_pos_t pos, bps_tree_elem_t max_elem)
+		bps_tree_pos_t pos, bps_tree_elem_t max_elem, size_t card)
 {
 	/* exclusive behaviuor for debug checks */
 	if (tree->root_id != (bps_tree_block_id_t) -1) {
@@ -3218,8 +3791,7 @@ bps_tree_insert_and_move_elems_to_right_inner(
 	assert(pos >= 0);
 
 	if (!move_to_empty) {
-		BPS_TREE_DATAMOVE(b->child_ids + num, b->child_ids,
-				  b->header.size, b, b);
+		bps_tree_move_children(b, num, b, 0, b->header.size);
 		BPS_TREE_DATAMOVE(b->elems + num, b->elems,
 				  b->header.size - 1, b, b);
 	}
@@ -3227,12 +3799,9 @@ bps_tree_insert_and_move_elems_to_right_inner(
 	bps_tree_pos_t mid_part_size = a->header.size - pos;
 	if (mid_part_size > num) {
 		/* In fact insert to 'a' block, to the internal position */
-		BPS_TREE_DATAMOVE(b->child_ids,
-				  a->child_ids + a->header.size - num,
-				  num, b, a);
-		BPS_TREE_DATAMOVE(a->child_ids + pos + 1, a->child_ids + pos,
-				  mid_part_size - num, a, a);
-		a->child_ids[pos] = block_id;
+		bps_tree_move_children(b, 0, a, a->header.size - num, num);
+		bps_tree_move_children(a, pos + 1, a, pos, mid_part_size - num);
+		bps_tree_set_child(a, pos, block_id, card);
 
 		BPS_TREE_DATAMOVE(b->elems, a->elems + (a->header.size - num),
 				  num - 1, b, a);
@@ -3249,12 +3818,9 @@ bps_tree_insert_and_move_elems_to_right_inner(
 		a->elems[pos] = max_elem;
 	} else if (mid_part_size == num) {
 		/* In fact insert to 'a' block, to the last position */
-		BPS_TREE_DATAMOVE(b->child_ids,
-				  a->child_ids + a->header.size - num,
-				  num, b, a);
-		BPS_TREE_DATAMOVE(a->child_ids + pos + 1, a->child_ids + pos,
-				  mid_part_size - num, a, a);
-		a->child_ids[pos] = block_id;
+		bps_tree_move_children(b, 0, a, a->header.size - num, num);
+		bps_tree_move_children(a, pos + 1, a, pos, mid_part_size - num);
+		bps_tree_set_child(a, pos, block_id, card);
 
 		BPS_TREE_DATAMOVE(b->elems, a->elems + (a->header.size - num),
 				  num - 1, b, a);
@@ -3268,12 +3834,10 @@ bps_tree_insert_and_move_elems_to_right_inner(
 	} else {
 		/* In fact insert to 'b' block */
 		bps_tree_pos_t new_pos = num - mid_part_size - 1;/* Can be 0 */
-		BPS_TREE_DATAMOVE(b->child_ids,
-				  a->child_ids + a->header.size - num + 1,
-				  new_pos, b, a);
-		b->child_ids[new_pos] = block_id;
-		BPS_TREE_DATAMOVE(b->child_ids + new_pos + 1,
-				  a->child_ids + pos, mid_part_size, b, a);
+		bps_tree_move_children(b, 0, a, a->header.size - num + 1,
+				       new_pos);
+		bps_tree_set_child(b, new_pos, block_id, card);
+		bps_tree_move_children(b, new_pos + 1, a, pos, mid_part_size);
 
 		if (pos == a->header.size) {
 			/* +1 */
@@ -3402,7 +3966,7 @@ bps_tree_insert_and_move_elems_to_left_inner(
 		struct bps_inner_path_elem *a_inner_path_elem,
 		struct bps_inner_path_elem *b_inner_path_elem, bps_tree_pos_t num,
 		bps_tree_block_id_t block_id, bps_tree_pos_t pos,
-		bps_tree_elem_t max_elem)
+		bps_tree_elem_t max_elem, size_t card)
 {
 	/* exclusive behaviuor for debug checks */
 	if (tree->root_id != (bps_tree_block_id_t) -1) {
@@ -3425,14 +3989,11 @@ bps_tree_insert_and_move_elems_to_left_inner(
 	if (pos >= num) {
 		/* In fact insert to 'b' block */
 		bps_tree_pos_t new_pos = pos - num; /* Can be 0 */
-		BPS_TREE_DATAMOVE(a->child_ids + a->header.size, b->child_ids,
-				  num, a, b);
-		BPS_TREE_DATAMOVE(b->child_ids, b->child_ids + num,
-				  new_pos, b, b);
-		b->child_ids[new_pos] = block_id;
-		BPS_TREE_DATAMOVE(b->child_ids + new_pos + 1,
-				  b->child_ids + pos,
-				  b->header.size - pos, b, b);
+		bps_tree_move_children(a, a->header.size, b, 0, num);
+		bps_tree_move_children(b, 0, b, num, new_pos);
+		bps_tree_set_child(b, new_pos, block_id, card);
+		bps_tree_move_children(b, new_pos + 1, b, pos,
+				       b->header.size - pos);
 
 		if (!move_to_empty)
 			a->elems[a->header.size - 1] =
@@ -3466,14 +4027,12 @@ bps_tree_insert_and_move_elems_to_left_inner(
 	} else {
 		/* In fact insert to 'a' block */
 		bps_tree_pos_t new_pos = a->header.size + pos; /* Can be 0 */
-		BPS_TREE_DATAMOVE(a->child_ids + a->header.size,
-				  b->child_ids, pos, a, b);
-		a->child_ids[new_pos] = block_id;
-		BPS_TREE_DATAMOVE(a->child_ids + new_pos + 1,
-				  b->child_ids + pos, num - 1 - pos, a, b);
+		bps_tree_move_children(a, a->header.size, b, 0, pos);
+		bps_tree_set_child(a, new_pos, block_id, card);
+		bps_tree_move_children(a, new_pos + 1, b, pos, num - 1 - pos);
 		if (!move_all)
-			BPS_TREE_DATAMOVE(b->child_ids, b->child_ids + num - 1,
-					  b->header.size - num + 1, b, b);
+			bps_tree_move_children(b, 0, b, num - 1,
+					       b->header.size - num + 1);
 
 		if (!move_to_empty)
 			a->elems[a->header.size - 1] =
@@ -3711,7 +4270,7 @@ static int
 bps_tree_process_insert_inner(struct bps_tree_common *tree,
 			      struct bps_inner_path_elem *inner_path_elem,
 			      bps_tree_block_id_t block_id, bps_tree_pos_t pos,
-			      bps_tree_elem_t max_elem);
+			      bps_tree_elem_t max_elem, size_t card);
 
 /**
  * Basic inserted into leaf, dealing with spliting, merging and moving data
@@ -3755,6 +4314,9 @@ bps_tree_process_insert_leaf(struct bps_tree_common *tree,
 				bps_tree_insert_and_move_elems_to_left_leaf(tree,
 					&left_ext, leaf_path_elem,
 					move_count, new_elem);
+			bps_tree_update_leaf_cards(leaf_path_elem,
+					&left_ext, &right_ext, &left_left_ext,
+					&right_right_ext);
 			BPS_TREE_BRANCH_TRACE(tree, insert_leaf, 1 << 0x1);
 			*inserted_in_block = inserted_ext->block_id;
 			*inserted_in_pos = inserted_ext->insertion_point;
@@ -3766,6 +4328,9 @@ bps_tree_process_insert_leaf(struct bps_tree_common *tree,
 				bps_tree_insert_and_move_elems_to_right_leaf(tree,
 					leaf_path_elem, &right_ext,
 					move_count, new_elem);
+			bps_tree_update_leaf_cards(leaf_path_elem,
+					&left_ext, &right_ext, &left_left_ext,
+					&right_right_ext);
 			BPS_TREE_BRANCH_TRACE(tree, insert_leaf, 1 << 0x2);
 			*inserted_in_block = inserted_ext->block_id;
 			*inserted_in_pos = inserted_ext->insertion_point;
@@ -3779,6 +4344,9 @@ bps_tree_process_insert_leaf(struct bps_tree_common *tree,
 				bps_tree_insert_and_move_elems_to_left_leaf(tree,
 					&left_ext, leaf_path_elem,
 					move_count, new_elem);
+			bps_tree_update_leaf_cards(leaf_path_elem,
+					&left_ext, &right_ext, &left_left_ext,
+					&right_right_ext);
 			BPS_TREE_BRANCH_TRACE(tree, insert_leaf, 1 << 0x3);
 			*inserted_in_block = inserted_ext->block_id;
 			*inserted_in_pos = inserted_ext->insertion_point;
@@ -3798,6 +4366,9 @@ bps_tree_process_insert_leaf(struct bps_tree_common *tree,
 				bps_tree_insert_and_move_elems_to_left_leaf(tree,
 					&left_ext, leaf_path_elem,
 					move_count, new_elem);
+			bps_tree_update_leaf_cards(leaf_path_elem,
+					&left_ext, &right_ext, &left_left_ext,
+					&right_right_ext);
 			BPS_TREE_BRANCH_TRACE(tree, insert_leaf, 1 << 0x4);
 			*inserted_in_block = inserted_ext->block_id;
 			*inserted_in_pos = inserted_ext->insertion_point;
@@ -3811,6 +4382,9 @@ bps_tree_process_insert_leaf(struct bps_tree_common *tree,
 				bps_tree_insert_and_move_elems_to_right_leaf(tree,
 					leaf_path_elem, &right_ext,
 					move_count, new_elem);
+			bps_tree_update_leaf_cards(leaf_path_elem,
+					&left_ext, &right_ext, &left_left_ext,
+					&right_right_ext);
 			BPS_TREE_BRANCH_TRACE(tree, insert_leaf, 1 << 0x5);
 			*inserted_in_block = inserted_ext->block_id;
 			*inserted_in_pos = inserted_ext->insertion_point;
@@ -3830,6 +4404,9 @@ bps_tree_process_insert_leaf(struct bps_tree_common *tree,
 				bps_tree_insert_and_move_elems_to_right_leaf(tree,
 					leaf_path_elem, &right_ext,
 					move_count, new_elem);
+			bps_tree_update_leaf_cards(leaf_path_elem,
+					&left_ext, &right_ext, &left_left_ext,
+					&right_right_ext);
 			BPS_TREE_BRANCH_TRACE(tree, insert_leaf, 1 << 0x6);
 			*inserted_in_block = inserted_ext->block_id;
 			*inserted_in_pos = inserted_ext->insertion_point;
@@ -4081,8 +4658,10 @@ bps_tree_process_insert_leaf(struct bps_tree_common *tree,
 		struct bps_inner *new_root = bps_tree_create_inner(tree,
 				&new_root_id);
 		new_root->header.size = 2;
-		new_root->child_ids[0] = tree->root_id;
-		new_root->child_ids[1] = new_block_id;
+		bps_tree_set_child(new_root, 0, tree->root_id,
+				   leaf_path_elem->block->header.size);
+		bps_tree_set_child(new_root, 1, new_block_id,
+				   new_path_elem.block->header.size);
 		new_root->elems[0] = tree->max_elem;
 		tree->root_id = new_root_id;
 		tree->max_elem = new_max_elem;
@@ -4096,10 +4675,12 @@ bps_tree_process_insert_leaf(struct bps_tree_common *tree,
 	*inserted_in_block = inserted_ext->block_id;
 	*inserted_in_pos = inserted_ext->insertion_point;
 	assert(leaf_path_elem->parent);
+	bps_tree_update_leaf_cards(leaf_path_elem, &left_ext, &right_ext,
+				   &left_left_ext, &right_right_ext);
 	BPS_TREE_BRANCH_TRACE(tree, insert_leaf, 1 << 0xD);
 	return bps_tree_process_insert_inner(tree, leaf_path_elem->parent,
 			new_block_id, new_path_elem.pos_in_parent,
-			new_max_elem);
+			new_max_elem, new_path_elem.block->header.size);
 }
 
 /**
@@ -4110,11 +4691,12 @@ static inline int
 bps_tree_process_insert_inner(struct bps_tree_common *tree,
 			      struct bps_inner_path_elem *inner_path_elem,
 			      bps_tree_block_id_t block_id,
-			      bps_tree_pos_t pos, bps_tree_elem_t max_elem)
+			      bps_tree_pos_t pos, bps_tree_elem_t max_elem,
+			      size_t card)
 {
 	if (bps_tree_inner_free_size(inner_path_elem->block)) {
 		bps_tree_insert_into_inner(tree, inner_path_elem,
-					   block_id, pos, max_elem);
+					   block_id, pos, max_elem, card);
 		BPS_TREE_BRANCH_TRACE(tree, insert_inner, 1 << 0x0);
 		return 0;
 	}
@@ -4137,7 +4719,10 @@ bps_tree_process_insert_inner(struct bps_tree_common *tree,
 				bps_tree_inner_free_size(left_ext.block) / 2;
 			bps_tree_insert_and_move_elems_to_left_inner(tree,
 					&left_ext, inner_path_elem, move_count,
-					block_id, pos, max_elem);
+					block_id, pos, max_elem, card);
+			bps_tree_update_inner_cards(inner_path_elem,
+					&left_ext, &right_ext, &left_left_ext,
+					&right_right_ext);
 			BPS_TREE_BRANCH_TRACE(tree, insert_inner, 1 << 0x1);
 			return 0;
 		} else if (bps_tree_inner_free_size(right_ext.block) > 0) {
@@ -4145,7 +4730,11 @@ bps_tree_process_insert_inner(struct bps_tree_common *tree,
 				bps_tree_inner_free_size(right_ext.block) / 2;
 			bps_tree_insert_and_move_elems_to_right_inner(tree,
 					inner_path_elem, &right_ext,
-					move_count, block_id, pos, max_elem);
+					move_count, block_id, pos, max_elem,
+					card);
+			bps_tree_update_inner_cards(inner_path_elem,
+					&left_ext, &right_ext, &left_left_ext,
+					&right_right_ext);
 			BPS_TREE_BRANCH_TRACE(tree, insert_inner, 1 << 0x2);
 			return 0;
 		}
@@ -4155,7 +4744,11 @@ bps_tree_process_insert_inner(struct bps_tree_common *tree,
 				bps_tree_inner_free_size(left_ext.block) / 2;
 			bps_tree_insert_and_move_elems_to_left_inner(tree,
 					&left_ext, inner_path_elem,
-					move_count, block_id, pos, max_elem);
+					move_count, block_id, pos, max_elem,
+					card);
+			bps_tree_update_inner_cards(inner_path_elem,
+					&left_ext, &right_ext, &left_left_ext,
+					&right_right_ext);
 			BPS_TREE_BRANCH_TRACE(tree, insert_inner, 1 << 0x3);
 			return 0;
 		}
@@ -4171,7 +4764,10 @@ bps_tree_process_insert_inner(struct bps_tree_common *tree,
 			move_count = 1 + move_count / 2;
 			bps_tree_insert_and_move_elems_to_left_inner(tree,
 					&left_ext, inner_path_elem, move_count,
-					block_id, pos, max_elem);
+					block_id, pos, max_elem, card);
+			bps_tree_update_inner_cards(inner_path_elem,
+					&left_ext, &right_ext, &left_left_ext,
+					&right_right_ext);
 			BPS_TREE_BRANCH_TRACE(tree, insert_inner, 1 << 0x4);
 			return 0;
 		}
@@ -4181,7 +4777,11 @@ bps_tree_process_insert_inner(struct bps_tree_common *tree,
 				bps_tree_inner_free_size(right_ext.block) / 2;
 			bps_tree_insert_and_move_elems_to_right_inner(tree,
 					inner_path_elem, &right_ext,
-					move_count, block_id, pos, max_elem);
+					move_count, block_id, pos, max_elem,
+					card);
+			bps_tree_update_inner_cards(inner_path_elem,
+					&left_ext, &right_ext, &left_left_ext,
+					&right_right_ext);
 			BPS_TREE_BRANCH_TRACE(tree, insert_inner, 1 << 0x5);
 			return 0;
 		}
@@ -4197,7 +4797,11 @@ bps_tree_process_insert_inner(struct bps_tree_common *tree,
 			move_count = 1 + move_count / 2;
 			bps_tree_insert_and_move_elems_to_right_inner(tree,
 					inner_path_elem, &right_ext,
-					move_count, block_id, pos, max_elem);
+					move_count, block_id, pos, max_elem,
+					card);
+			bps_tree_update_inner_cards(inner_path_elem,
+					&left_ext, &right_ext, &left_left_ext,
+					&right_right_ext);
 			BPS_TREE_BRANCH_TRACE(tree, insert_inner, 1 << 0x6);
 			return 0;
 		}
@@ -4237,7 +4841,7 @@ bps_tree_process_insert_inner(struct bps_tree_common *tree,
 
 		bps_tree_insert_and_move_elems_to_right_inner(tree,
 				inner_path_elem, &new_path_elem,
-				mc1, block_id, pos, max_elem);
+				mc1, block_id, pos, max_elem, card);
 		bps_tree_move_elems_to_right_inner(tree,
 				&left_ext, inner_path_elem, mc2);
 		bps_tree_move_elems_to_left_inner(tree,
@@ -4272,7 +4876,7 @@ bps_tree_process_insert_inner(struct bps_tree_common *tree,
 
 		bps_tree_insert_and_move_elems_to_right_inner(tree,
 				inner_path_elem, &new_path_elem,
-				mc1, block_id, pos, max_elem);
+				mc1, block_id, pos, max_elem, card);
 		bps_tree_move_elems_to_right_inner(tree,
 				&left_ext, inner_path_elem, mc2);
 		bps_tree_move_elems_to_right_inner(tree,
@@ -4306,7 +4910,7 @@ bps_tree_process_insert_inner(struct bps_tree_common *tree,
 
 		bps_tree_insert_and_move_elems_to_right_inner(tree,
 				inner_path_elem, &new_path_elem,
-				mc1, block_id, pos, max_elem);
+				mc1, block_id, pos, max_elem, card);
 		bps_tree_move_elems_to_left_inner(tree,
 				&new_path_elem, &right_ext, mc2);
 		bps_tree_move_elems_to_left_inner(tree,
@@ -4338,7 +4942,7 @@ bps_tree_process_insert_inner(struct bps_tree_common *tree,
 
 		bps_tree_insert_and_move_elems_to_right_inner(tree,
 				inner_path_elem, &new_path_elem,
-				mc1, block_id, pos, max_elem);
+				mc1, block_id, pos, max_elem, card);
 		bps_tree_move_elems_to_right_inner(tree,
 				&left_ext, inner_path_elem, mc2);
 
@@ -4367,7 +4971,7 @@ bps_tree_process_insert_inner(struct bps_tree_common *tree,
 
 		bps_tree_insert_and_move_elems_to_right_inner(tree,
 				inner_path_elem, &new_path_elem,
-				mc1, block_id, pos, max_elem);
+				mc1, block_id, pos, max_elem, card);
 		bps_tree_move_elems_to_left_inner(tree,
 				&new_path_elem, &right_ext, mc2);
 
@@ -4395,14 +4999,16 @@ bps_tree_process_insert_inner(struct bps_tree_common *tree,
 
 		bps_tree_insert_and_move_elems_to_right_inner(tree,
 				inner_path_elem, &new_path_elem,
-				mc1, block_id, pos, max_elem);
+				mc1, block_id, pos, max_elem, card);
 
 		bps_tree_block_id_t new_root_id = (bps_tree_block_id_t)(-1);
 		struct bps_inner *new_root =
 			bps_tree_create_inner(tree, &new_root_id);
 		new_root->header.size = 2;
-		new_root->child_ids[0] = tree->root_id;
-		new_root->child_ids[1] = new_block_id;
+		bps_tree_set_child(new_root, 0, tree->root_id,
+				   bps_tree_inner_card(inner_path_elem->block));
+		bps_tree_set_child(new_root, 1, new_block_id,
+				   bps_tree_inner_card(new_path_elem.block));
 		new_root->elems[0] = tree->max_elem;
 		tree->root_id = new_root_id;
 		tree->max_elem = new_max_elem;
@@ -4411,10 +5017,12 @@ bps_tree_process_insert_inner(struct bps_tree_common *tree,
 		return 0;
 	}
 	assert(inner_path_elem->parent);
+	bps_tree_update_inner_cards(inner_path_elem, &left_ext, &right_ext,
+				    &left_left_ext, &right_right_ext);
 	BPS_TREE_BRANCH_TRACE(tree, insert_inner, 1 << 0xD);
 	return bps_tree_process_insert_inner(tree, inner_path_elem->parent,
 			new_block_id, new_path_elem.pos_in_parent,
-			new_max_elem);
+			new_max_elem, bps_tree_inner_card(new_path_elem.block));
 }
 
 /**
@@ -4461,6 +5069,9 @@ bps_tree_process_delete_leaf(struct bps_tree_common *tree,
 				bps_tree_leaf_overmin_size(left_ext.block) / 2;
 			bps_tree_move_elems_to_right_leaf(tree, &left_ext,
 					leaf_path_elem, move_count);
+			bps_tree_update_leaf_cards(leaf_path_elem,
+					&left_ext, &right_ext, &left_left_ext,
+					&right_right_ext);
 			BPS_TREE_BRANCH_TRACE(tree, delete_leaf, 1 << 0x1);
 			return;
 		} else if (bps_tree_leaf_overmin_size(right_ext.block) > 0) {
@@ -4468,6 +5079,9 @@ bps_tree_process_delete_leaf(struct bps_tree_common *tree,
 				bps_tree_leaf_overmin_size(right_ext.block) / 2;
 			bps_tree_move_elems_to_left_leaf(tree, leaf_path_elem,
 					&right_ext, move_count);
+			bps_tree_update_leaf_cards(leaf_path_elem,
+					&left_ext, &right_ext, &left_left_ext,
+					&right_right_ext);
 			BPS_TREE_BRANCH_TRACE(tree, delete_leaf, 1 << 0x2);
 			return;
 		}
@@ -4477,6 +5091,9 @@ bps_tree_process_delete_leaf(struct bps_tree_common *tree,
 				bps_tree_leaf_overmin_size(left_ext.block) / 2;
 			bps_tree_move_elems_to_right_leaf(tree, &left_ext,
 					leaf_path_elem, move_count);
+			bps_tree_update_leaf_cards(leaf_path_elem,
+					&left_ext, &right_ext, &left_left_ext,
+					&right_right_ext);
 			BPS_TREE_BRANCH_TRACE(tree, delete_leaf, 1 << 0x3);
 			return;
 		}
@@ -4492,6 +5109,9 @@ bps_tree_process_delete_leaf(struct bps_tree_common *tree,
 					leaf_path_elem, move_count1);
 			bps_tree_move_elems_to_right_leaf(tree, &left_left_ext,
 					&left_ext, move_count2);
+			bps_tree_update_leaf_cards(leaf_path_elem,
+					&left_ext, &right_ext, &left_left_ext,
+					&right_right_ext);
 			BPS_TREE_BRANCH_TRACE(tree, delete_leaf, 1 << 0x4);
 			return;
 		}
@@ -4502,6 +5122,9 @@ bps_tree_process_delete_leaf(struct bps_tree_common *tree,
 				/ 2;
 			bps_tree_move_elems_to_left_leaf(tree, leaf_path_elem,
 					&right_ext, move_count);
+			bps_tree_update_leaf_cards(leaf_path_elem,
+					&left_ext, &right_ext, &left_left_ext,
+					&right_right_ext);
 			BPS_TREE_BRANCH_TRACE(tree, delete_leaf, 1 << 0x5);
 			return;
 		}
@@ -4517,6 +5140,9 @@ bps_tree_process_delete_leaf(struct bps_tree_common *tree,
 					&right_ext, move_count1);
 			bps_tree_move_elems_to_left_leaf(tree, &right_ext,
 					&right_right_ext, move_count2);
+			bps_tree_update_leaf_cards(leaf_path_elem,
+					&left_ext, &right_ext, &left_left_ext,
+					&right_right_ext);
 			BPS_TREE_BRANCH_TRACE(tree, delete_leaf, 1 << 0x6);
 			return;
 		}
@@ -4588,6 +5214,8 @@ bps_tree_process_delete_leaf(struct bps_tree_common *tree,
 	}
 
 	assert(leaf_path_elem->block->header.size == 0);
+	bps_tree_update_leaf_cards(leaf_path_elem, &left_ext, &right_ext,
+				   &left_left_ext, &right_right_ext);
 
 	struct bps_leaf *leaf = (struct bps_leaf*)leaf_path_elem->block;
 	if (leaf->prev_id == (bps_tree_block_id_t)(-1)) {
@@ -4648,6 +5276,9 @@ bps_tree_process_delete_inner(struct bps_tree_common *tree,
 				/ 2;
 			bps_tree_move_elems_to_right_inner(tree, &left_ext,
 					inner_path_elem, move_count);
+			bps_tree_update_inner_cards(inner_path_elem,
+					&left_ext, &right_ext, &left_left_ext,
+					&right_right_ext);
 			BPS_TREE_BRANCH_TRACE(tree, delete_inner, 1 << 0x1);
 			return;
 		} else if (bps_tree_inner_overmin_size(right_ext.block) > 0) {
@@ -4657,6 +5288,9 @@ bps_tree_process_delete_inner(struct bps_tree_common *tree,
 			bps_tree_move_elems_to_left_inner(tree,
 					inner_path_elem, &right_ext,
 					move_count);
+			bps_tree_update_inner_cards(inner_path_elem,
+					&left_ext, &right_ext, &left_left_ext,
+					&right_right_ext);
 			BPS_TREE_BRANCH_TRACE(tree, delete_inner, 1 << 0x2);
 			return;
 		}
@@ -4667,6 +5301,9 @@ bps_tree_process_delete_inner(struct bps_tree_common *tree,
 				/ 2;
 			bps_tree_move_elems_to_right_inner(tree, &left_ext,
 					inner_path_elem, move_count);
+			bps_tree_update_inner_cards(inner_path_elem,
+					&left_ext, &right_ext, &left_left_ext,
+					&right_right_ext);
 			BPS_TREE_BRANCH_TRACE(tree, delete_inner, 1 << 0x3);
 			return;
 		}
@@ -4683,6 +5320,9 @@ bps_tree_process_delete_inner(struct bps_tree_common *tree,
 					inner_path_elem, move_count1);
 			bps_tree_move_elems_to_right_inner(tree,
 					&left_left_ext, &left_ext, move_count2);
+			bps_tree_update_inner_cards(inner_path_elem,
+					&left_ext, &right_ext, &left_left_ext,
+					&right_right_ext);
 			BPS_TREE_BRANCH_TRACE(tree, delete_inner, 1 << 0x4);
 			return;
 		}
@@ -4694,6 +5334,9 @@ bps_tree_process_delete_inner(struct bps_tree_common *tree,
 			bps_tree_move_elems_to_left_inner(tree,
 					inner_path_elem, &right_ext,
 					move_count);
+			bps_tree_update_inner_cards(inner_path_elem,
+					&left_ext, &right_ext, &left_left_ext,
+					&right_right_ext);
 			BPS_TREE_BRANCH_TRACE(tree, delete_inner, 1 << 0x5);
 			return;
 		}
@@ -4710,6 +5353,9 @@ bps_tree_process_delete_inner(struct bps_tree_common *tree,
 					&right_ext, move_count1);
 			bps_tree_move_elems_to_left_inner(tree, &right_ext,
 					&right_right_ext, move_count2);
+			bps_tree_update_inner_cards(inner_path_elem,
+					&left_ext, &right_ext, &left_left_ext,
+					&right_right_ext);
 			BPS_TREE_BRANCH_TRACE(tree, delete_inner, 1 << 0x6);
 			return;
 		}
@@ -4780,6 +5426,8 @@ bps_tree_process_delete_inner(struct bps_tree_common *tree,
 		return;
 	}
 	assert(inner_path_elem->block->header.size == 0);
+	bps_tree_update_inner_cards(inner_path_elem, &left_ext, &right_ext,
+				    &left_left_ext, &right_right_ext);
 
 	bps_tree_dispose_inner(tree, inner_path_elem->block,
 			inner_path_elem->block_id);
@@ -4830,9 +5478,13 @@ bps_tree_insert(struct bps_tree *t, bps_tree_elem_t new_elem,
 			bps_tree_pos_t pos = leaf_path_elem.insertion_point;
 			*successor = leaf->elems[pos];
 		}
-		return bps_tree_process_insert_leaf(tree, &leaf_path_elem,
-						    new_elem, &unused1,
-						    &unused2);
+		bps_tree_update_path_card(tree, &leaf_path_elem, 1);
+		int rc = bps_tree_process_insert_leaf(tree, &leaf_path_elem,
+						      new_elem, &unused1,
+						      &unused2);
+		if (rc != 0)
+			bps_tree_update_path_card(tree, &leaf_path_elem, -1);
+		return rc;
 	}
 }
 
@@ -4864,10 +5516,13 @@ bps_tree_insert_get_iterator(struct bps_tree *t, bps_tree_elem_t new_elem,
 					 replaced);
 		return 0;
 	} else {
+		bps_tree_update_path_card(tree, &leaf_path_elem, 1);
 		int rc = bps_tree_process_insert_leaf(tree, &leaf_path_elem,
 						      new_elem,
 						      &inserted_iterator->block_id,
 						      &inserted_iterator->pos);
+		if (rc != 0)
+			bps_tree_update_path_card(tree, &leaf_path_elem, -1);
 		return rc;
 	}
 }
@@ -4892,6 +5547,7 @@ bps_tree_delete(struct bps_tree *t, bps_tree_elem_t elem)
 	if (!exact)
 		return -1;
 
+	bps_tree_update_path_card(tree, &leaf_path_elem, -1);
 	bps_tree_process_delete_leaf(tree, &leaf_path_elem);
 	return 0;
 }
@@ -4926,6 +5582,7 @@ bps_tree_delete_value(struct bps_tree *t, bps_tree_elem_t elem,
 		return -1;
 	if (deleted_elem != NULL)
 		*deleted_elem = leaf->elems[leaf_path_elem.insertion_point];
+	bps_tree_update_path_card(tree, &leaf_path_elem, -1);
 	bps_tree_process_delete_leaf(tree, &leaf_path_elem);
 	return 0;
 }
@@ -5041,13 +5698,21 @@ bps_tree_debug_check_block(const struct bps_tree_common *tree,
 				result |= 0x4000000;
 		}
 
-		for (bps_tree_pos_t i = 0; i < block->size; i++)
+		for (bps_tree_pos_t i = 0; i < block->size; i++) {
+			size_t prev_count = *calc_count;
 			result |= bps_tree_debug_check_block(tree,
 				bps_tree_restore_block(tree,
 						       inner->child_ids[i]),
 				inner->child_ids[i], level - 1, calc_count,
 				expected_prev_id, expected_this_id,
 				check_fullness_next);
+#ifdef BPS_INNER_CARD
+			if (inner->child_cards[i] != *calc_count - prev_count)
+				result |= 0x8000000;
+#else
+			(void)prev_count;
+#endif
+		}
 		return result;
 	}
 }
@@ -5874,7 +6539,7 @@ bps_tree_debug_check_insert_into_inner(struct bps_tree_common *tree,
 
 			bps_tree_insert_into_inner(tree, &path_elem,
 				(bps_tree_block_id_t) j, (bps_tree_pos_t) j,
-				ins);
+				ins, 0);
 
 			for (unsigned int k = 0; k <= i; k++) {
 				if (bps_tree_debug_get_elem_inner(&path_elem, k)
@@ -6232,7 +6897,7 @@ bps_tree_debug_check_insert_and_move_to_right_inner(
 						tree, &a_path_elem,
 						&b_path_elem,
 						(bps_tree_pos_t) u, ikk,
-						(bps_tree_pos_t) k, ins);
+						(bps_tree_pos_t) k, ins, 0);
 
 					if (a.header.size
 						!= (bps_tree_pos_t) (i - u + 1)) {
@@ -6359,7 +7024,7 @@ bps_tree_debug_check_insert_and_move_to_left_inner(struct bps_tree_common *tree,
 						tree, &a_path_elem,
 						&b_path_elem,
 						(bps_tree_pos_t) u, ikk,
-						(bps_tree_pos_t) k, ins);
+						(bps_tree_pos_t) k, ins, 0);
 
 					if (a.header.size
 						!= (bps_tree_pos_t) (i + u)) {
@@ -6508,8 +7173,18 @@ bps_tree_debug_check_internal_functions(bool assertme)
 #undef bps_tree_upper_bound_elem
 #undef bps_tree_view_upper_bound_elem
 #undef bps_tree_approximate_count
+#undef bps_tree_lower_bound_get_offset
+#undef bps_tree_view_lower_bound_get_offset
+#undef bps_tree_upper_bound_get_offset
+#undef bps_tree_view_upper_bound_get_offset
+#undef bps_tree_lower_bound_elem_get_offset
+#undef bps_tree_view_lower_bound_elem_get_offset
+#undef bps_tree_iterator_at_impl
+#undef bps_tree_iterator_at
+#undef bps_tree_view_iterator_at
 #undef bps_tree_iterator_get_elem_impl
 #undef bps_tree_iterator_get_elem
+#undef bps_tree_iterator_get_leaf_elems
 #undef bps_tree_view_iterator_get_elem
 #undef bps_tree_iterator_next_impl
 #undef bps_tree_iterator_next
@@ -6550,6 +7225,12 @@ bps_tree_debug_check_internal_functions(bool assertme)
 #undef bps_tree_touch_leaf_path_max_elem
 #undef bps_tree_touch_path
 #undef bps_tree_process_replace
+#undef bps_tree_update_path_card
+#undef bps_tree_inner_card
+#undef bps_tree_update_leaf_cards
+#undef bps_tree_update_inner_cards
+#undef bps_tree_move_children
+#undef bps_tree_set_child
 #undef bps_tree_debug_memmove
 #undef bps_tree_insert_into_leaf
 #undef bps_tree_insert_into_inner
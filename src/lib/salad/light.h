@@ -640,6 +640,46 @@ LIGHT(view_find_key)(const struct LIGHT(view) *v, uint32_t hash,
 	return LIGHT(find_key_impl)(&v->common, hash, key);
 }
 
+/**
+ * @brief Prefetch the record a search for a given hash starts from
+ * into the CPU cache. Used for overlapping memory loads of several
+ * lookups done in a row.
+ * @param ht - pointer to a hash table struct
+ * @param hash - hash to prefetch
+ */
+static inline void
+LIGHT(prefetch)(const struct LIGHT(core) *ht, uint32_t hash)
+{
+	if (ht->common.count == 0)
+		return;
+	uint32_t slot = LIGHT(slot)(&ht->common, hash);
+	__builtin_prefetch(LIGHT(get_record)(&ht->common, slot));
+}
+
+/**
+ * @brief Get the value of the record a search for a given hash
+ * starts from if the record has the same hash. Doesn't call the
+ * comparison functions, so the value may differ from the one
+ * being searched. Used for prefetching values, see LIGHT(prefetch).
+ * @param ht - pointer to a hash table struct
+ * @param hash - hash to find
+ * @param[out] value - the value of the record
+ * @return true if the record has the given hash
+ */
+static inline bool
+LIGHT(peek)(const struct LIGHT(core) *ht, uint32_t hash,
+	    LIGHT_DATA_TYPE *value)
+{
+	if (ht->common.count == 0)
+		return false;
+	uint32_t slot = LIGHT(slot)(&ht->common, hash);
+	struct LIGHT(record) *record = LIGHT(get_record)(&ht->common, slot);
+	if (record->next == slot || record->hash != hash)
+		return false;
+	*value = record->value;
+	return true;
+}
+
 /**
  * @brief Replace a record with given hash and value
  * @param htab - pointer to a hash table struct
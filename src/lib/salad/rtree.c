@@ -29,6 +29,7 @@
  * SUCH DAMAGE.
  */
 #include "rtree.h"
+#include <stdlib.h>
 #include <string.h>
 #include <assert.h>
 #include <limits.h>
@@ -1126,6 +1127,270 @@ rtree_search(const struct rtree *tree, const struct rtree_rect *rect,
 	}
 }
 
+/*------------------------------------------------------------------------- */
+/* R-tree bulk loading */
+/*------------------------------------------------------------------------- */
+
+/* Sort key of a bulk loading entry */
+struct rtree_bulk_key {
+	/* Center of the entry rectangle along the sort axis */
+	coord_t center;
+	/* Position of the entry in the entry array */
+	size_t pos;
+};
+
+static int
+rtree_bulk_key_cmp(const void *a, const void *b)
+{
+	const struct rtree_bulk_key *k1 = (const struct rtree_bulk_key *)a;
+	const struct rtree_bulk_key *k2 = (const struct rtree_bulk_key *)b;
+	if (k1->center != k2->center)
+		return k1->center < k2->center ? -1 : 1;
+	return k1->pos < k2->pos ? -1 : k1->pos > k2->pos;
+}
+
+static struct rtree_page_branch *
+rtree_bulk_entry(const struct rtree *tree, char *entries, size_t pos)
+{
+	return (struct rtree_page_branch *)
+		(entries + pos * tree->page_branch_size);
+}
+
+/*
+ * Number of entries put to a page on bulk loading. Pages are not filled up
+ * to the limit so that following insertions don't split them immediately.
+ */
+static size_t
+rtree_bulk_page_fill(const struct rtree *tree)
+{
+	return tree->page_max_fill * 4 / 5;
+}
+
+/* Sort entries by centers of their rectangles along the given axis */
+static void
+rtree_bulk_sort_axis(const struct rtree *tree, char *entries, size_t count,
+		     struct rtree_bulk_key *keys, unsigned axis)
+{
+	for (size_t i = 0; i < count; i++) {
+		struct rtree_page_branch *b =
+			rtree_bulk_entry(tree, entries, i);
+		keys[i].center = (b->rect.coords[axis * 2] +
+				  b->rect.coords[axis * 2 + 1]) / 2;
+		keys[i].pos = i;
+	}
+	qsort(keys, count, sizeof(*keys), rtree_bulk_key_cmp);
+	/*
+	 * Apply the permutation in place: keys[i].pos is the position of the
+	 * entry that must be moved to position i. Moved entries are marked
+	 * with pos = SIZE_MAX.
+	 */
+	struct rtree_page_branch tmp;
+	for (size_t i = 0; i < count; i++) {
+		if (keys[i].pos == SIZE_MAX || keys[i].pos == i)
+			continue;
+		rtree_branch_copy(&tmp, rtree_bulk_entry(tree, entries, i),
+				  tree->dimension);
+		size_t j = i;
+		while (true) {
+			size_t k = keys[j].pos;
+			keys[j].pos = SIZE_MAX;
+			if (k == i) {
+				rtree_branch_copy(rtree_bulk_entry(tree,
+								   entries, j),
+						  &tmp, tree->dimension);
+				break;
+			}
+			rtree_branch_copy(rtree_bulk_entry(tree, entries, j),
+					  rtree_bulk_entry(tree, entries, k),
+					  tree->dimension);
+			j = k;
+		}
+	}
+}
+
+/*
+ * Sort-Tile-Recursive ordering: sort entries along the axis, cut them into
+ * slabs of whole pages and order each slab recursively along the next axis,
+ * so that consecutive entries are close to each other.
+ */
+static void
+rtree_bulk_sort(const struct rtree *tree, char *entries, size_t count,
+		struct rtree_bulk_key *keys, unsigned axis)
+{
+	rtree_bulk_sort_axis(tree, entries, count, keys, axis);
+	if (axis + 1 == tree->dimension)
+		return;
+	size_t fill = rtree_bulk_page_fill(tree);
+	size_t pages = (count + fill - 1) / fill;
+	/* Number of slabs is pages ^ (1 / number of remaining axes) */
+	unsigned rest = tree->dimension - axis;
+	size_t slabs = 1;
+	while (true) {
+		size_t power = 1;
+		for (unsigned i = 0; i < rest && power < pages; i++)
+			power *= slabs;
+		if (power >= pages)
+			break;
+		slabs++;
+	}
+	size_t slab_size = fill * ((pages + slabs - 1) / slabs);
+	for (size_t i = 0; i < count; i += slab_size) {
+		size_t n = count - i < slab_size ? count - i : slab_size;
+		rtree_bulk_sort(tree, entries + i * tree->page_branch_size, n,
+				keys, axis + 1);
+	}
+}
+
+void
+rtree_bulk_create(struct rtree_bulk *bulk)
+{
+	bulk->entries = NULL;
+	bulk->count = 0;
+	bulk->capacity = 0;
+}
+
+void
+rtree_bulk_destroy(struct rtree_bulk *bulk)
+{
+	free(bulk->entries);
+	rtree_bulk_create(bulk);
+}
+
+int
+rtree_bulk_reserve(const struct rtree *tree, struct rtree_bulk *bulk,
+		   size_t count)
+{
+	if (count <= bulk->capacity)
+		return 0;
+	char *entries = (char *)realloc(bulk->entries,
+					count * tree->page_branch_size);
+	if (entries == NULL)
+		return -1;
+	bulk->entries = entries;
+	bulk->capacity = count;
+	return 0;
+}
+
+int
+rtree_bulk_add(const struct rtree *tree, struct rtree_bulk *bulk,
+	       const struct rtree_rect *rect, record_t obj)
+{
+	if (bulk->count == bulk->capacity) {
+		size_t capacity = bulk->capacity + bulk->capacity / 2;
+		if (capacity < RTREE_MAXIMUM_BRANCHES_IN_PAGE)
+			capacity = RTREE_MAXIMUM_BRANCHES_IN_PAGE;
+		if (rtree_bulk_reserve(tree, bulk, capacity) != 0)
+			return -1;
+	}
+	struct rtree_page_branch *b =
+		rtree_bulk_entry(tree, bulk->entries, bulk->count++);
+	b->data.record = obj;
+	rtree_rect_copy(&b->rect, rect, tree->dimension);
+	return 0;
+}
+
+size_t
+rtree_bulk_page_count(const struct rtree *tree, size_t count)
+{
+	if (count == 0)
+		return 0;
+	size_t fill = rtree_bulk_page_fill(tree);
+	size_t pages = 1;
+	while (count > tree->page_max_fill) {
+		count = (count + fill - 1) / fill;
+		pages += count;
+	}
+	return pages;
+}
+
+/*
+ * Put entries to pages in the given order, page by page, and replace them
+ * with branches pointing to the new pages. Returns the number of pages.
+ */
+static size_t
+rtree_bulk_pack(struct rtree *tree, char *entries, size_t count)
+{
+	size_t fill = rtree_bulk_page_fill(tree);
+	size_t pages = (count + fill - 1) / fill;
+	/* Distribute entries evenly so that all pages are min filled. */
+	size_t pos = 0;
+	for (size_t i = 0; i < pages; i++) {
+		unsigned n = count / pages + (i < count % pages);
+		assert(n <= tree->page_max_fill);
+		struct rtree_page *page = rtree_page_alloc(tree);
+		tree->n_pages++;
+		page->n = n;
+		for (unsigned j = 0; j < n; j++) {
+			rtree_branch_copy(rtree_branch_get(tree, page, j),
+					  rtree_bulk_entry(tree, entries,
+							   pos + j),
+					  tree->dimension);
+		}
+		pos += n;
+		/*
+		 * The branch overwrites an entry that has already been put to
+		 * a page because every page takes at least one entry.
+		 */
+		struct rtree_page_branch *b =
+			rtree_bulk_entry(tree, entries, i);
+		rtree_page_cover(tree, page, &b->rect);
+		b->data.page = page;
+	}
+	assert(pos == count);
+	return pages;
+}
+
+/* Insert entries one by one, used if there's no memory for sorting */
+static void
+rtree_bulk_insert(struct rtree *tree, struct rtree_bulk *bulk)
+{
+	for (size_t i = 0; i < bulk->count; i++) {
+		struct rtree_page_branch *b =
+			rtree_bulk_entry(tree, bulk->entries, i);
+		rtree_insert(tree, &b->rect, b->data.record);
+	}
+}
+
+void
+rtree_bulk_load(struct rtree *tree, struct rtree_bulk *bulk)
+{
+	assert(tree->root == NULL);
+	size_t count = bulk->count;
+	struct rtree_bulk_key *keys = NULL;
+	if (count > tree->page_max_fill) {
+		keys = (struct rtree_bulk_key *)malloc(count * sizeof(*keys));
+		if (keys == NULL) {
+			rtree_bulk_insert(tree, bulk);
+			rtree_bulk_destroy(bulk);
+			return;
+		}
+	}
+	if (count == 0) {
+		rtree_bulk_destroy(bulk);
+		return;
+	}
+	char *entries = bulk->entries;
+	tree->height = 1;
+	while (count > tree->page_max_fill) {
+		rtree_bulk_sort(tree, entries, count, keys, 0);
+		count = rtree_bulk_pack(tree, entries, count);
+		tree->height++;
+	}
+	free(keys);
+	assert(tree->height <= RTREE_MAX_HEIGHT);
+	tree->root = rtree_page_alloc(tree);
+	tree->n_pages++;
+	tree->root->n = count;
+	for (unsigned i = 0; i < count; i++) {
+		rtree_branch_copy(rtree_branch_get(tree, tree->root, i),
+				  rtree_bulk_entry(tree, entries, i),
+				  tree->dimension);
+	}
+	tree->n_records = bulk->count;
+	tree->version++;
+	rtree_bulk_destroy(bulk);
+}
+
 void
 rtree_purge(struct rtree *tree)
 {
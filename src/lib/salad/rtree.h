@@ -150,6 +150,20 @@ struct rtree
 	enum rtree_distance_type distance_type;
 };
 
+/*
+ * Entries collected for bulk loading of a tree, see rtree_bulk_load().
+ * Entries are stored in the format of tree page branches.
+ */
+struct rtree_bulk
+{
+	/* Array of entries */
+	char *entries;
+	/* Number of entries */
+	size_t count;
+	/* Number of entries the array has room for */
+	size_t capacity;
+};
+
 /* Struct for iteration and retrieving rtree values */
 struct rtree_iterator
 {
@@ -298,6 +312,62 @@ rtree_used_size(const struct rtree *tree);
 unsigned
 rtree_number_of_records(const struct rtree *tree);
 
+/**
+ * @brief Initialize a bulk loading context
+ * @param bulk - pointer to a bulk loading context
+ */
+void
+rtree_bulk_create(struct rtree_bulk *bulk);
+
+/**
+ * @brief Free all entries of a bulk loading context
+ * @param bulk - pointer to a bulk loading context
+ */
+void
+rtree_bulk_destroy(struct rtree_bulk *bulk);
+
+/**
+ * @brief Make sure that a bulk loading context has room for entries
+ * @return 0 on success, -1 on memory allocation error
+ * @param tree - pointer to a tree the entries are collected for
+ * @param bulk - pointer to a bulk loading context
+ * @param count - number of entries
+ */
+int
+rtree_bulk_reserve(const struct rtree *tree, struct rtree_bulk *bulk,
+		   size_t count);
+
+/**
+ * @brief Add a record to a bulk loading context
+ * @return 0 on success, -1 on memory allocation error
+ * @param tree - pointer to a tree the entries are collected for
+ * @param bulk - pointer to a bulk loading context
+ * @param rect - rectangle of the record
+ * @param obj - record to add
+ */
+int
+rtree_bulk_add(const struct rtree *tree, struct rtree_bulk *bulk,
+	       const struct rtree_rect *rect, record_t obj);
+
+/**
+ * @brief Number of pages rtree_bulk_load() allocates for a number of records
+ * @param tree - pointer to a tree
+ * @param count - number of records
+ */
+size_t
+rtree_bulk_page_count(const struct rtree *tree, size_t count);
+
+/**
+ * @brief Build an empty tree from records collected in a bulk loading
+ * context using Sort-Tile-Recursive packing. It is much faster than
+ * inserting the records one by one and gives better clustered pages.
+ * The bulk loading context is emptied.
+ * @param tree - pointer to an empty tree
+ * @param bulk - pointer to a bulk loading context
+ */
+void
+rtree_bulk_load(struct rtree *tree, struct rtree_bulk *bulk);
+
 #if 0
 /**
  * @brief Print a tree to stdout. Debug function, thus disabled.
@@ -0,0 +1,156 @@
+#ifndef TARANTOOL_LIB_SALAD_WYHASH_H_INCLUDED
+#define TARANTOOL_LIB_SALAD_WYHASH_H_INCLUDED
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2024, Tarantool AUTHORS, please see AUTHORS file.
+ */
+
+/*
+ * A 64-bit hash function based on wyhash by Wang Yi (public domain,
+ * https://github.com/wangyi-fudan/wyhash).
+ *
+ * The hash consumes 48 bytes per round in three independent lanes, which
+ * keeps the multipliers of a modern CPU busy, and reads short inputs with
+ * a couple of overlapping loads instead of a byte-by-byte loop. Unlike
+ * PMurHash32 it has no incremental mode: to hash several values chain
+ * the calls by passing the previous result as the seed.
+ *
+ * The result depends on the host byte order so it must not be persisted.
+ */
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+enum {
+	/** Default seed. */
+	WYHASH_SEED = 0,
+};
+
+static const uint64_t wyhash_secret[4] = {
+	0xa0761d6478bd642fULL, 0xe7037ed1a0b428dbULL,
+	0x8ebc6af09c88c6e3ULL, 0x589965cc75374cc3ULL,
+};
+
+/** Computes the 128-bit product of *a and *b and stores it in them. */
+static inline void
+wyhash_mum(uint64_t *a, uint64_t *b)
+{
+#if defined(__SIZEOF_INT128__)
+	__uint128_t r = *a;
+	r *= *b;
+	*a = (uint64_t)r;
+	*b = (uint64_t)(r >> 64);
+#else
+	uint64_t ha = *a >> 32, hb = *b >> 32;
+	uint64_t la = (uint32_t)*a, lb = (uint32_t)*b;
+	uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+	uint64_t t = rl + (rm0 << 32);
+	uint64_t c = t < rl;
+	uint64_t lo = t + (rm1 << 32);
+	c += lo < t;
+	uint64_t hi = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+	*a = lo;
+	*b = hi;
+#endif
+}
+
+/** Folds the 128-bit product of a and b into 64 bits. */
+static inline uint64_t
+wyhash_mix(uint64_t a, uint64_t b)
+{
+	wyhash_mum(&a, &b);
+	return a ^ b;
+}
+
+static inline uint64_t
+wyhash_read8(const uint8_t *p)
+{
+	uint64_t v;
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+static inline uint64_t
+wyhash_read4(const uint8_t *p)
+{
+	uint32_t v;
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+/** Reads 1 to 3 bytes. */
+static inline uint64_t
+wyhash_read3(const uint8_t *p, size_t len)
+{
+	return ((uint64_t)p[0] << 16) | ((uint64_t)p[len >> 1] << 8) |
+	       p[len - 1];
+}
+
+/** Returns the hash of the given byte string. */
+static inline uint64_t
+wyhash(const void *data, size_t len, uint64_t seed)
+{
+	const uint8_t *p = (const uint8_t *)data;
+	const uint64_t *s = wyhash_secret;
+	seed ^= wyhash_mix(seed ^ s[0], s[1]);
+	uint64_t a, b;
+	if (len <= 16) {
+		if (len >= 4) {
+			size_t shift = (len >> 3) << 2;
+			a = (wyhash_read4(p) << 32) | wyhash_read4(p + shift);
+			b = (wyhash_read4(p + len - 4) << 32) |
+			    wyhash_read4(p + len - 4 - shift);
+		} else if (len > 0) {
+			a = wyhash_read3(p, len);
+			b = 0;
+		} else {
+			a = b = 0;
+		}
+	} else {
+		size_t i = len;
+		if (i > 48) {
+			uint64_t seed1 = seed, seed2 = seed;
+			do {
+				seed = wyhash_mix(wyhash_read8(p) ^ s[1],
+						  wyhash_read8(p + 8) ^ seed);
+				seed1 = wyhash_mix(wyhash_read8(p + 16) ^ s[2],
+						   wyhash_read8(p + 24) ^ seed1);
+				seed2 = wyhash_mix(wyhash_read8(p + 32) ^ s[3],
+						   wyhash_read8(p + 40) ^ seed2);
+				p += 48;
+				i -= 48;
+			} while (i > 48);
+			seed ^= seed1 ^ seed2;
+		}
+		while (i > 16) {
+			seed = wyhash_mix(wyhash_read8(p) ^ s[1],
+					  wyhash_read8(p + 8) ^ seed);
+			i -= 16;
+			p += 16;
+		}
+		a = wyhash_read8(p + i - 16);
+		b = wyhash_read8(p + i - 8);
+	}
+	a ^= s[1];
+	b ^= seed;
+	wyhash_mum(&a, &b);
+	return wyhash_mix(a ^ s[0] ^ len, b ^ s[1]);
+}
+
+/** Returns the hash of a 64-bit integer. */
+static inline uint64_t
+wyhash_u64(uint64_t val, uint64_t seed)
+{
+	return wyhash_mix(val ^ wyhash_secret[0], seed ^ wyhash_secret[1]);
+}
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif
+
+#endif /* TARANTOOL_LIB_SALAD_WYHASH_H_INCLUDED */
@@ -500,6 +500,12 @@ struct swim {
 	 * as long as the event TTD is non-zero.
 	 */
 	struct rlist dissemination_queue;
+	/**
+	 * Number of events from the head of the dissemination
+	 * queue encoded into the current round step packet. Only
+	 * they are accounted as sent when the step is complete.
+	 */
+	int round_step_event_count;
 	/**
 	 * Queue of updated, new, and dropped members to deliver
 	 * the events to triggers. Dropped members are also kept
@@ -1104,10 +1110,12 @@ swim_encode_failure_detection(struct swim *swim, struct swim_packet *packet,
 
 /**
  * Encode dissemination component.
+ * @param[out] event_count Number of encoded events.
  * @retval Number of key-values added to the packet's root map.
  */
 static int
-swim_encode_dissemination(struct swim *swim, struct swim_packet *packet)
+swim_encode_dissemination(struct swim *swim, struct swim_packet *packet,
+			  int *event_count)
 {
 	struct swim_diss_header_bin diss_header_bin;
 	struct swim_member_payload_bin payload_header;
@@ -1129,23 +1137,40 @@ swim_encode_dissemination(struct swim *swim, struct swim_packet *packet)
 	}
 	swim_diss_header_bin_create(&diss_header_bin, i);
 	memcpy(header, &diss_header_bin, sizeof(diss_header_bin));
+	*event_count = i;
 	return 1;
 }
 
-/** Encode SWIM components into a UDP packet. */
+/**
+ * Encode SWIM components into a UDP packet.
+ * @param[out] event_count Number of encoded dissemination events.
+ *             Can be NULL.
+ */
 static void
 swim_encode_msg(struct swim *swim, struct swim_packet *packet,
-		enum swim_fd_msg_type fd_type)
+		enum swim_fd_msg_type fd_type, int *event_count)
 {
+	int unused;
+	if (event_count == NULL)
+		event_count = &unused;
+	*event_count = 0;
 	char *header = swim_packet_alloc(packet, 1);
 	int map_size = 0;
 	map_size += swim_encode_src_uuid(swim, packet);
 	map_size += swim_encode_failure_detection(swim, packet, fd_type);
 	ERROR_INJECT(ERRINJ_SWIM_FD_ONLY, {
+		/*
+		 * Behave as if the events were sent and lost so
+		 * as their TTDs still go down.
+		 */
+		struct swim_member *m;
+		rlist_foreach_entry(m, &swim->dissemination_queue,
+				    in_dissemination_queue)
+			++*event_count;
 		mp_encode_map(header, map_size);
 		return;
 	});
-	map_size += swim_encode_dissemination(swim, packet);
+	map_size += swim_encode_dissemination(swim, packet, event_count);
 	map_size += swim_encode_anti_entropy(swim, packet);
 
 	assert(mp_sizeof_map(map_size) == 1 && map_size >= 2);
@@ -1153,33 +1178,36 @@ swim_encode_msg(struct swim *swim, struct swim_packet *packet,
 }
 
 /**
- * Decrement TTDs of all events. It is done after each round step.
- * Note, since we decrement TTD of all events, even those which
- * have not been actually encoded and sent, if there are more
- * events than can fit into a packet, the tail of the queue begins
- * reeking and rotting. The most recently added members could even
- * be deleted without being sent once. This is, however, very
- * unlikely, since even 1000 bytes can fit 37 events containing
- * ~27 bytes each, which means only happens upon a failure of 37
- * instances. In such a case event loss is the mildest problem to
- * deal with.
+ * Decrement TTDs of the first @a count events, which were sent in
+ * a round step. The events, still alive, are moved to the tail of
+ * the queue. It is done after each round step. When there are
+ * more events than can fit into a packet, the rotation lets the
+ * next packets carry the rest of the queue. Otherwise the tail of
+ * the queue would be starving, and would not be sent at all in a
+ * big cluster where many members change their status at once.
  */
 static void
-swim_decrease_event_ttd(struct swim *swim)
+swim_decrease_event_ttd(struct swim *swim, int count)
 {
 	struct swim_member *member, *tmp;
+	RLIST_HEAD(sent);
 	rlist_foreach_entry_safe(member, &swim->dissemination_queue,
-				 in_dissemination_queue,
-				 tmp) {
+				 in_dissemination_queue, tmp) {
+		if (count-- == 0)
+			break;
 		if (member->payload_ttd > 0)
 			--member->payload_ttd;
 		assert(member->status_ttd > 0);
-		if (--member->status_ttd == 0) {
-			rlist_del_entry(member, in_dissemination_queue);
-			if (member->status == MEMBER_LEFT)
-				swim_delete_member(swim, member);
+		if (--member->status_ttd > 0) {
+			rlist_move_tail_entry(&sent, member,
+					      in_dissemination_queue);
+			continue;
 		}
+		rlist_del_entry(member, in_dissemination_queue);
+		if (member->status == MEMBER_LEFT)
+			swim_delete_member(swim, member);
 	}
+	rlist_splice_tail(&swim->dissemination_queue, &sent);
 }
 
 /**
@@ -1219,7 +1247,8 @@ swim_begin_step(struct ev_loop *loop, struct ev_timer *t, int events)
 	}
 	struct swim_packet *packet = &swim->round_step_task.packet;
 	swim_packet_create(packet);
-	swim_encode_msg(swim, packet, SWIM_FD_MSG_PING);
+	swim_encode_msg(swim, packet, SWIM_FD_MSG_PING,
+			&swim->round_step_event_count);
 	struct swim_member *m =
 		rlist_first_entry(&swim->round_queue, struct swim_member,
 				  in_round_queue);
@@ -1260,7 +1289,8 @@ swim_complete_step(struct swim_task *task,
 			 * sections.
 			 */
 			swim_wait_ack(swim, m, false);
-			swim_decrease_event_ttd(swim);
+			swim_decrease_event_ttd(
+				swim, swim->round_step_event_count);
 		}
 	}
 }
@@ -1278,7 +1308,7 @@ swim_send_fd_msg(struct swim *swim, struct swim_task *task,
 	swim_packet_create(&task->packet);
 	if (proxy != NULL)
 		swim_task_set_proxy(task, proxy);
-	swim_encode_msg(swim, &task->packet, type);
+	swim_encode_msg(swim, &task->packet, type, NULL);
 	say_verbose("SWIM %d: schedule %s to %s", swim_fd(swim),
 		    swim_fd_msg_type_strs[type], swim_inaddr_str(dst));
 	swim_task_send(task, dst, &swim->scheduler);
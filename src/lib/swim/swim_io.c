@@ -47,6 +47,14 @@ enum {
 	 * round.
 	 */
 	TASKS_PER_SCHEDULER = 16,
+	/**
+	 * How many packets can be read from the socket during
+	 * one EV_READ event. In a big cluster packets arrive in
+	 * bursts, and reading them all at once saves a loop
+	 * iteration per packet. The limit is needed so as not to
+	 * starve the output and the timers under a flood.
+	 */
+	RECV_BATCH_SIZE = 16,
 };
 
 /**
@@ -667,7 +675,7 @@ swim_complete_recv(struct swim_scheduler *scheduler, const char *buf,
 }
 
 /**
- * On a new EV_READ event receive an encrypted packet from the
+ * On a new EV_READ event receive encrypted packets from the
  * network.
  */
 static void
@@ -682,25 +690,33 @@ swim_on_encrypted_input(struct ev_loop *loop, struct ev_io *io, int events)
 	char buf[UDP_PACKET_SIZE];
 	swim_begin_recv(scheduler, loop, io, events);
 
-	char *ibuf = static_alloc(UDP_PACKET_SIZE);
-	assert(ibuf != NULL);
-	ssize_t size = swim_do_recv(scheduler, ibuf, UDP_PACKET_SIZE);
-	if (size > 0) {
+	for (int i = 0; i < RECV_BATCH_SIZE; ++i) {
+		char *ibuf = static_alloc(UDP_PACKET_SIZE);
+		assert(ibuf != NULL);
+		ssize_t size = swim_do_recv(scheduler, ibuf, UDP_PACKET_SIZE);
+		if (size <= 0) {
+			swim_complete_recv(scheduler, buf, size);
+			return;
+		}
 		size = swim_decrypt(scheduler->codec, ibuf, size,
 				    buf, UDP_PACKET_SIZE);
+		swim_complete_recv(scheduler, buf, size);
 	}
-	swim_complete_recv(scheduler, buf, size);
 }
 
-/** On a new EV_READ event receive a packet from the network. */
+/** On a new EV_READ event receive packets from the network. */
 static void
 swim_on_plain_input(struct ev_loop *loop, struct ev_io *io, int events)
 {
 	struct swim_scheduler *scheduler = (struct swim_scheduler *) io->data;
 	char buf[UDP_PACKET_SIZE];
 	swim_begin_recv(scheduler, loop, io, events);
-	ssize_t size = swim_do_recv(scheduler, buf, UDP_PACKET_SIZE);
-	swim_complete_recv(scheduler, buf, size);
+	for (int i = 0; i < RECV_BATCH_SIZE; ++i) {
+		ssize_t size = swim_do_recv(scheduler, buf, UDP_PACKET_SIZE);
+		swim_complete_recv(scheduler, buf, size);
+		if (size <= 0)
+			return;
+	}
 }
 
 int
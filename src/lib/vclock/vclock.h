@@ -86,7 +86,8 @@ struct vclock_c {
 
 struct vclock_iterator
 {
-	struct bit_iterator it;
+	/** Components that haven't been visited yet. */
+	vclock_map_t map;
 	const struct vclock *vclock;
 };
 
@@ -94,17 +95,18 @@ static inline void
 vclock_iterator_init(struct vclock_iterator *it, const struct vclock *vclock)
 {
 	it->vclock = vclock;
-	bit_iterator_init(&it->it, &vclock->map, sizeof(vclock->map), true);
+	it->map = vclock->map;
 }
 
 static inline struct vclock_c
 vclock_iterator_next(struct vclock_iterator *it)
 {
-	struct vclock_c c = { 0, 0 };
-	size_t id = bit_iterator_next(&it->it);
-	c.id = id == SIZE_MAX ? (int) VCLOCK_MAX : id;
-	if (c.id < VCLOCK_MAX)
-		c.lsn = it->vclock->lsn[c.id];
+	struct vclock_c c = { VCLOCK_MAX, 0 };
+	if (it->map == 0)
+		return c;
+	c.id = bit_ctz_u32(it->map);
+	c.lsn = it->vclock->lsn[c.id];
+	it->map &= it->map - 1;
 	return c;
 }
 
@@ -298,14 +300,10 @@ vclock_compare_generic(const struct vclock *a, const struct vclock *b,
 {
 	bool le = true, ge = true;
 	vclock_map_t map = a->map | b->map;
-	struct bit_iterator it;
-	bit_iterator_init(&it, &map, sizeof(map), true);
-
-	size_t replica_id = bit_iterator_next(&it);
-	if (replica_id == 0 && ignore_zero)
-		replica_id = bit_iterator_next(&it);
-
-	for (; replica_id < VCLOCK_MAX; replica_id = bit_iterator_next(&it)) {
+	if (ignore_zero)
+		map &= ~(vclock_map_t)1;
+	for (; map != 0; map &= map - 1) {
+		uint32_t replica_id = bit_ctz_u32(map);
 		int64_t lsn_a = vclock_get(a, replica_id);
 		int64_t lsn_b = vclock_get(b, replica_id);
 		le = le && lsn_a <= lsn_b;
@@ -358,10 +356,8 @@ static inline int
 vclock_lex_compare(const struct vclock *a, const struct vclock *b)
 {
 	vclock_map_t map = a->map | b->map;
-	struct bit_iterator it;
-	bit_iterator_init(&it, &map, sizeof(map), true);
-	for(size_t replica_id = bit_iterator_next(&it); replica_id < VCLOCK_MAX;
-	    replica_id = bit_iterator_next(&it)) {
+	for (; map != 0; map &= map - 1) {
+		uint32_t replica_id = bit_ctz_u32(map);
 		int64_t lsn_a = vclock_get(a, replica_id);
 		int64_t lsn_b = vclock_get(b, replica_id);
 		if (lsn_a < lsn_b)
@@ -390,13 +386,10 @@ vclock_minmax(struct vclock *a, const struct vclock *b, int sign,
 	      bool ignore_zero)
 {
 	vclock_map_t map = a->map | b->map;
-	struct bit_iterator it;
-	bit_iterator_init(&it, &map, sizeof(map), true);
-	size_t replica_id = bit_iterator_next(&it);
-	if (replica_id == 0 && ignore_zero)
-		replica_id = bit_iterator_next(&it);
-
-	for( ; replica_id < VCLOCK_MAX; replica_id = bit_iterator_next(&it)) {
+	if (ignore_zero)
+		map &= ~(vclock_map_t)1;
+	for (; map != 0; map &= map - 1) {
+		uint32_t replica_id = bit_ctz_u32(map);
 		int64_t lsn_a = vclock_get(a, replica_id);
 		int64_t lsn_b = vclock_get(b, replica_id);
 		if (sign * lsn_a >= sign * lsn_b)
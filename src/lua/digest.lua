@@ -73,6 +73,33 @@ ffi.cdef[[
 
     void tnt_XXH32_copyState(XXH32_state_t* restrict dst_state, const XXH32_state_t* restrict src_state);
     void tnt_XXH64_copyState(XXH64_state_t* restrict dst_state, const XXH64_state_t* restrict src_state);
+
+    /* from third_party/xxHash/xxhash.h */
+    typedef struct XXH3_state_s XXH3_state_t;
+    typedef struct {
+        XXH64_hash_t low64;
+        XXH64_hash_t high64;
+    } XXH128_hash_t;
+    typedef struct {
+        unsigned char digest[16];
+    } XXH128_canonical_t;
+
+    XXH64_hash_t tnt_XXH3_64bits_withSeed(const void* input, size_t length, XXH64_hash_t seed);
+    XXH128_hash_t tnt_XXH3_128bits_withSeed(const void* input, size_t length, XXH64_hash_t seed);
+
+    XXH3_state_t* tnt_XXH3_createState(void);
+    XXH_errorcode tnt_XXH3_freeState(XXH3_state_t* statePtr);
+    void tnt_XXH3_copyState(XXH3_state_t* dst_state, const XXH3_state_t* src_state);
+
+    XXH_errorcode tnt_XXH3_64bits_reset_withSeed(XXH3_state_t* statePtr, XXH64_hash_t seed);
+    XXH_errorcode tnt_XXH3_64bits_update(XXH3_state_t* statePtr, const void* input, size_t length);
+    XXH64_hash_t tnt_XXH3_64bits_digest(const XXH3_state_t* statePtr);
+
+    XXH_errorcode tnt_XXH3_128bits_reset_withSeed(XXH3_state_t* statePtr, XXH64_hash_t seed);
+    XXH_errorcode tnt_XXH3_128bits_update(XXH3_state_t* statePtr, const void* input, size_t length);
+    XXH128_hash_t tnt_XXH3_128bits_digest(const XXH3_state_t* statePtr);
+
+    void tnt_XXH128_canonicalFromHash(XXH128_canonical_t* dst, XXH128_hash_t hash);
 ]]
 
 local builtin = ffi.C
@@ -368,4 +395,91 @@ for _, var in ipairs({'32', '64'}) do
     m['xxhash' .. var] = xxHash
 end
 
+-- XXH3 hashes. The 64-bit variant returns a number like xxhash64,
+-- the 128-bit one returns a 16-byte string in the canonical (big
+-- endian) representation of the hash.
+local xxh128_canonical = ffi.new('XXH128_canonical_t')
+
+local function xxh128_tostring(hash)
+    builtin.tnt_XXH128_canonicalFromHash(xxh128_canonical, hash)
+    return ffi.string(xxh128_canonical.digest, 16)
+end
+
+local function xxh64_result(hash)
+    return hash
+end
+
+for _, var in ipairs({'64', '128'}) do
+    local xxh3
+
+    local name = 'xxh3_' .. var
+    local xxh3_template = 'tnt_XXH3_%sbits_%s'
+    local update_fn_name = string.format(xxh3_template, var, 'update')
+    local digest_fn_name = string.format(xxh3_template, var, 'digest')
+    local reset_fn_name = string.format(xxh3_template, var,
+                                        'reset_withSeed')
+    local call_fn_name = string.format(xxh3_template, var, 'withSeed')
+    local convert = var == '64' and xxh64_result or xxh128_tostring
+
+    local function update(self, str)
+        if type(str) ~= 'string' then
+            local message = string.format("Usage %s:update(string)", name)
+            error(message, 2)
+        end
+        builtin[update_fn_name](self.value, str, #str)
+    end
+
+    local function result(self)
+        return convert(builtin[digest_fn_name](self.value))
+    end
+
+    local function clear(self, seed)
+        if seed == nil then
+            seed = self.default_seed
+        end
+        builtin[reset_fn_name](self.value, seed)
+    end
+
+    local function copy(self)
+        local copy = xxh3.new(self.default_seed)
+        builtin.tnt_XXH3_copyState(copy.value, self.value)
+        return copy
+    end
+
+    xxh3 = {
+        new = function(seed)
+            local state = builtin.tnt_XXH3_createState()
+            if state == nil then
+                error('Failed to allocate XXH3 state', 2)
+            end
+            local self = {
+                update = update,
+                result = result,
+                clear = clear,
+                copy = copy,
+                value = ffi.gc(state, builtin.tnt_XXH3_freeState),
+                default_seed = seed or 0,
+            }
+            self:clear(self.default_seed)
+            return self
+        end,
+    }
+
+    setmetatable(xxh3, {
+        __call = function(_, str, seed)
+            if type(str) ~= 'string' then
+                local message = string.format(
+                    "Usage digest.%s(string[, unsigned number])", name)
+                error(message, 2)
+            end
+            if seed == nil then
+                seed = 0
+            end
+            return convert(builtin[call_fn_name](str, #str, seed))
+        end,
+    })
+
+    m[name] = xxh3
+end
+
 return m
@@ -34,6 +34,7 @@
 #include "lua/utils.h"
 #include "lua/serializer.h"
 #include "lua/backtrace.h"
+#include "sampler.h"
 #include "tt_static.h"
 
 #include <lua.h>
@@ -389,8 +390,215 @@ lbox_fiber_leak_backtrace_disable(struct lua_State *L)
 	fiber_leak_backtrace_enable = false;
 	return 0;
 }
+
+/** Default rate of the sampling profiler, samples per second. */
+enum { LBOX_FIBER_PROFILER_RATE_DEFAULT = 100 };
+
+static int
+lbox_fiber_profiler_enable(struct lua_State *L)
+{
+	int rate = LBOX_FIBER_PROFILER_RATE_DEFAULT;
+	if (!lua_isnoneornil(L, 1)) {
+		if (lua_type(L, 1) != LUA_TNUMBER)
+			luaL_error(L, "fiber.profiler_enable(rate): rate "
+				      "must be a number");
+		rate = lua_tointeger(L, 1);
+	}
+	if (sampler_enable(rate) != 0)
+		luaT_error(L);
+	return 0;
+}
+
+static int
+lbox_fiber_profiler_disable(struct lua_State *L)
+{
+	(void)L;
+	sampler_disable();
+	return 0;
+}
+
+static int
+lbox_fiber_profiler_reset(struct lua_State *L)
+{
+	(void)L;
+	sampler_reset();
+	return 0;
+}
+
+static int
+lbox_fiber_profiler_stack(const char *stack, uint32_t len, uint64_t count,
+			  void *arg)
+{
+	struct lua_State *L = arg;
+	lua_pushlstring(L, stack, len);
+	luaL_pushuint64(L, count);
+	lua_settable(L, -3);
+	return 0;
+}
+
+/**
+ * Return the samples collected by the profiler of the current
+ * cord as a table of collapsed stacks with the number of samples.
+ */
+static int
+lbox_fiber_profiler(struct lua_State *L)
+{
+	if (!sampler_is_enabled()) {
+		luaL_error(L, "fiber.profiler() is disabled. Enable it with"
+			      " fiber.profiler_enable() first");
+	}
+	struct sampler_stat stat;
+	sampler_stat(&stat);
+	lua_newtable(L);
+	lua_pushliteral(L, "samples");
+	luaL_pushuint64(L, stat.samples);
+	lua_settable(L, -3);
+	lua_pushliteral(L, "lost");
+	luaL_pushuint64(L, stat.lost);
+	lua_settable(L, -3);
+	lua_pushliteral(L, "stacks");
+	lua_newtable(L);
+	sampler_foreach(lbox_fiber_profiler_stack, L);
+	lua_settable(L, -3);
+	return 1;
+}
 #endif /* ENABLE_BACKTRACE */
 
+/**
+ * Create the given number of fibers in advance so that the
+ * following fiber.new() calls don't allocate stacks.
+ */
+static int
+lbox_fiber_prewarm(struct lua_State *L)
+{
+	if (lua_type(L, 1) != LUA_TNUMBER || lua_tointeger(L, 1) < 0)
+		luaL_error(L, "fiber.prewarm(count): count must be "
+			      "a non-negative number");
+	int count = lua_tointeger(L, 1);
+	struct fiber_attr attr;
+	fiber_attr_create(&attr);
+	if (fiber_prewarm(&attr, count) != count)
+		luaT_error(L);
+	return 0;
+}
+
+/** Event loop statistics of a cord copied by lbox_fiber_cord_stat(). */
+struct lbox_cord_stat {
+	struct cord_stat_info info;
+	char name[FIBER_NAME_INLINE];
+};
+
+/** Context of lbox_fiber_cord_stat_cb(). */
+struct lbox_cord_stat_ctx {
+	struct lbox_cord_stat *stats;
+	int count;
+};
+
+static int
+lbox_fiber_cord_stat_cb(const struct cord_stat_info *info, void *arg)
+{
+	struct lbox_cord_stat_ctx *ctx = arg;
+	ctx->stats = xrealloc(ctx->stats,
+			      (ctx->count + 1) * sizeof(*ctx->stats));
+	struct lbox_cord_stat *stat = &ctx->stats[ctx->count++];
+	stat->info = *info;
+	strlcpy(stat->name, info->name, sizeof(stat->name));
+	stat->info.name = stat->name;
+	return 0;
+}
+
+/**
+ * Return an array with event loop statistics of all cords.
+ * The statistics are copied first, because the cord list is
+ * locked while it's traversed.
+ */
+static int
+lbox_fiber_cord_stat(struct lua_State *L)
+{
+	struct lbox_cord_stat_ctx ctx = {NULL, 0};
+	cord_stat_foreach(lbox_fiber_cord_stat_cb, &ctx);
+	lua_createtable(L, ctx.count, 0);
+	for (int i = 0; i < ctx.count; i++) {
+		struct cord_stat_info *info = &ctx.stats[i].info;
+		lua_createtable(L, 0, 6);
+		lua_pushstring(L, info->name);
+		lua_setfield(L, -2, "name");
+		lua_pushnumber(L, info->busy);
+		lua_setfield(L, -2, "busy");
+		lua_pushnumber(L, info->idle);
+		lua_setfield(L, -2, "idle");
+		lua_pushnumber(L, info->load);
+		lua_setfield(L, -2, "load");
+		luaL_pushuint64(L, info->csw);
+		lua_setfield(L, -2, "csw");
+		luaL_pushuint64(L, info->stalls);
+		lua_setfield(L, -2, "stalls");
+		lua_rawseti(L, -2, i + 1);
+	}
+	free(ctx.stats);
+	return 1;
+}
+
+enum { LBOX_FIBER_WATCHDOG_THRESHOLD_DEFAULT = 500 };
+
+static int
+lbox_fiber_watchdog_enable(struct lua_State *L)
+{
+	double threshold = LBOX_FIBER_WATCHDOG_THRESHOLD_DEFAULT / 1000.;
+	if (!lua_isnoneornil(L, 1)) {
+		if (lua_type(L, 1) != LUA_TNUMBER)
+			luaL_error(L, "fiber.watchdog_enable(threshold): "
+				      "threshold must be a number");
+		threshold = lua_tonumber(L, 1);
+	}
+	if (cord_watchdog_enable(threshold) != 0)
+		luaT_error(L);
+	return 0;
+}
+
+static int
+lbox_fiber_watchdog_disable(struct lua_State *L)
+{
+	(void)L;
+	cord_watchdog_disable();
+	return 0;
+}
+
+/**
+ * Return statistics of fiber creation in the current cord.
+ */
+static int
+lbox_fiber_stat(struct lua_State *L)
+{
+	struct cord *cord = cord();
+	int dead = 0, dead_custom = 0;
+	struct fiber *f;
+	rlist_foreach_entry(f, &cord->dead, link)
+		dead++;
+	rlist_foreach_entry(f, &cord->dead_custom, link)
+		dead_custom++;
+	lua_newtable(L);
+	lua_pushliteral(L, "created");
+	luaL_pushuint64(L, cord->create_stat.created);
+	lua_settable(L, -3);
+	lua_pushliteral(L, "reused");
+	luaL_pushuint64(L, cord->create_stat.reused);
+	lua_settable(L, -3);
+	lua_pushliteral(L, "create_time");
+	lua_pushnumber(L, cord->create_stat.create_time);
+	lua_settable(L, -3);
+	lua_pushliteral(L, "cached");
+	lua_pushinteger(L, dead);
+	lua_settable(L, -3);
+	lua_pushliteral(L, "cached_custom");
+	lua_pushinteger(L, dead_custom);
+	lua_settable(L, -3);
+	lua_pushliteral(L, "cached_custom_size");
+	luaL_pushuint64(L, cord->dead_custom_size);
+	lua_settable(L, -3);
+	return 1;
+}
+
 /**
  * Return fiber statistics.
  */
@@ -1007,7 +1215,16 @@ static const struct luaL_Reg fiberlib[] = {
 	{"parent_backtrace_disable", lbox_fiber_parent_backtrace_disable},
 	{"leak_backtrace_enable", lbox_fiber_leak_backtrace_enable},
 	{"leak_backtrace_disable", lbox_fiber_leak_backtrace_disable},
+	{"profiler", lbox_fiber_profiler},
+	{"profiler_enable", lbox_fiber_profiler_enable},
+	{"profiler_disable", lbox_fiber_profiler_disable},
+	{"profiler_reset", lbox_fiber_profiler_reset},
 #endif /* ENABLE_BACKTRACE */
+	{"prewarm", lbox_fiber_prewarm},
+	{"stat", lbox_fiber_stat},
+	{"cord_stat", lbox_fiber_cord_stat},
+	{"watchdog_enable", lbox_fiber_watchdog_enable},
+	{"watchdog_disable", lbox_fiber_watchdog_disable},
 	{"sleep", lbox_fiber_sleep},
 	{"yield", lbox_fiber_yield},
 	{"self", lbox_fiber_self},
@@ -364,6 +364,15 @@ luaT_httpc_request(lua_State *L)
 		httpc_set_accept_encoding(req, lua_tostring(L, -1));
 	lua_pop(L, 1);
 
+	lua_getfield(L, 5, "http_version");
+	if (!lua_isnil(L, -1)) {
+		if (httpc_set_http_version(req, lua_tostring(L, -1)) != 0) {
+			httpc_request_delete(req);
+			return luaT_error(L);
+		}
+	}
+	lua_pop(L, 1);
+
 	bool chunked = false;
 	lua_getfield(L, 5, "chunked");
 	if (!lua_isnil(L, -1) && lua_isboolean(L, -1))
@@ -494,11 +503,39 @@ luaT_httpc_new(lua_State *L)
 	long max_total_conns = luaL_checklong(L, 2);
 	if (httpc_env_create(ctx, max_conns, max_total_conns) != 0)
 		return luaT_error(L);
+	struct curl_env *curl_env = &ctx->curl_env;
+
+	if (lua_istable(L, 3)) {
+		lua_getfield(L, 3, "http2");
+		bool http2 = lua_toboolean(L, -1);
+		lua_pop(L, 1);
+		lua_getfield(L, 3, "max_concurrent_streams");
+		long max_streams = lua_tointeger(L, -1);
+		lua_pop(L, 1);
+		if (http2 &&
+		    curl_env_set_multiplexing(curl_env, max_streams) != 0)
+			goto error;
+		lua_getfield(L, 3, "max_host_connections");
+		long max_host_conns = lua_tointeger(L, -1);
+		lua_pop(L, 1);
+		if (max_host_conns > 0 &&
+		    curl_env_set_max_host_conns(curl_env, max_host_conns) != 0)
+			goto error;
+		lua_getfield(L, 3, "share_connections");
+		bool share_connections = lua_toboolean(L, -1);
+		lua_pop(L, 1);
+		if (share_connections && curl_env_set_shared(curl_env) != 0)
+			goto error;
+	}
 
 	luaL_getmetatable(L, DRIVER_LUA_UDATA_NAME);
 	lua_setmetatable(L, -2);
 
 	return 1;
+error:
+	httpc_env_finish(ctx);
+	httpc_env_destroy(ctx);
+	return luaT_error(L);
 }
 
 static int
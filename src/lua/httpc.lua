@@ -79,19 +79,44 @@ end
 --
 --  max_connections -  Maximum number of entries in the connection cache
 --  max_total_connections -  Maximum number of active connections
+--  max_host_connections - Maximum number of connections to a single host
+--  http2 - Multiplex requests to the same host over one HTTP/2
+--      connection when possible
+--  max_concurrent_streams - Maximum number of concurrent HTTP/2 streams
+--      per connection
+--  share_connections - Reuse keep-alive connections, DNS and TLS session
+--      caches of all clients created with this option
 --
 --  Returns:
 --  curl object or raise error()
 --
 
+local http_new_option_types = {
+    max_connections = 'number',
+    max_total_connections = 'number',
+    max_host_connections = 'number',
+    http2 = 'boolean',
+    max_concurrent_streams = 'number',
+    share_connections = 'boolean',
+}
+
 local http_new = function(opts)
 
     opts = opts or {}
 
+    for k, v in pairs(opts) do
+        local expected = http_new_option_types[k]
+        if expected ~= nil and type(v) ~= expected then
+            error(("http.client.new: option '%s' should be of type %s"):format(
+                  k, expected), 2)
+        end
+    end
+
     opts.max_connections = opts.max_connections or -1
     opts.max_total_connections = opts.max_total_connections or 0
 
-    local curl = driver.new(opts.max_connections, opts.max_total_connections)
+    local curl = driver.new(opts.max_connections, opts.max_total_connections,
+                            opts)
     return setmetatable({
         curl = curl,
         encoders = table.copy(encoders),
@@ -527,6 +552,9 @@ end
 --
 --      chunked - enables chunked io interface;
 --
+--      http_version - HTTP version to use: '1.0', '1.1', '2', '2tls' or
+--          '2-prior-knowledge';
+--
 --      params - a table with query parameters;
 --
 --  Returns:
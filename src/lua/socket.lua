@@ -16,6 +16,12 @@ local cord_ibuf_drop = buffer.internal.cord_ibuf_drop
 
 local format = string.format
 
+local ibuf_t = ffi.typeof('struct ibuf')
+local iovec_array_t = ffi.typeof('struct socket_iovec[?]')
+-- Max number of buffers passed to writev() at once, POSIX minimum
+-- of IOV_MAX.
+local IOV_MAX = 1024
+
 ffi.cdef[[
     struct gc_socket {
         const int fd;
@@ -29,6 +35,12 @@ ffi.cdef[[
                 socklen_t addrlen);
 
     ssize_t write(int fd, const char *octets, size_t len);
+    /* Same layout as struct iovec. */
+    struct socket_iovec {
+        const char *iov_base;
+        size_t iov_len;
+    };
+    ssize_t writev(int fd, const struct socket_iovec *iov, int iovcnt);
     ssize_t read(int fd, void *buf, size_t count);
     int listen(int fd, int backlog);
     int socket(int domain, int type, int protocol);
@@ -791,6 +803,81 @@ local function socket_write(self, octets, timeout)
     return nil
 end
 
+-- Returns the pointer and size of a writev() buffer: a string, the
+-- unread data of an ibuf or a {ptr, size} slice.
+local function writev_buf(buf)
+    if type(buf) == 'string' then
+        return buf, #buf
+    elseif ffi.istype(ibuf_t, buf) then
+        return buf.rpos, buf:size()
+    elseif type(buf) == 'table' and type(buf[1]) == 'cdata' and
+           type(buf[2]) == 'number' and buf[2] >= 0 then
+        return ffi.cast('const char *', buf[1]), buf[2]
+    end
+    error('Usage: socket:writev({data, ...}[, timeout]), where data is ' ..
+          'a string, an ibuf or a {ptr, size} table')
+end
+
+local function socket_writev(self, bufs, timeout)
+    local fd = check_socket(self)
+    if type(bufs) ~= 'table' then
+        error('Usage: socket:writev({data, ...}[, timeout])')
+    end
+    if timeout == nil then
+        timeout = TIMEOUT_INFINITY
+    end
+
+    local count = #bufs
+    local iov = ffi.new(iovec_array_t, count)
+    local total = 0
+    for i = 1, count do
+        local base, len = writev_buf(bufs[i])
+        iov[i - 1].iov_base = base
+        iov[i - 1].iov_len = len
+        total = total + len
+    end
+
+    local first = 0
+    local done = 0
+    local deadline = fiber.clock() + timeout
+    repeat
+        while true do
+            while first < count and iov[first].iov_len == 0 do
+                first = first + 1
+            end
+            self._errno = nil
+            if first == count then
+                return total
+            end
+            local res = ffi.C.writev(fd, iov + first,
+                                     math.min(count - first, IOV_MAX))
+            if res < 0 then
+                self._errno = boxerrno()
+                if not errno_is_transient[self._errno] then
+                    return nil
+                end
+                break
+            elseif res == 0 then
+                return done -- eof
+            end
+            res = tonumber(res)
+            done = done + res
+            -- Skip the written data.
+            while res > 0 do
+                local len = tonumber(iov[first].iov_len)
+                if res < len then
+                    iov[first].iov_base = iov[first].iov_base + res
+                    iov[first].iov_len = len - res
+                    break
+                end
+                res = res - len
+                first = first + 1
+            end
+        end
+    until not socket_writable(self, deadline - fiber.clock())
+    return nil
+end
+
 local function socket_send(self, octets, flags)
     local fd = check_socket(self)
     local iflags = get_iflags(internal.SEND_FLAGS, flags)
@@ -881,6 +968,38 @@ local function socket_recv(self, size, flags)
     return buf
 end
 
+local function socket_recv_into(self, ibuf, size, flags)
+    local fd = check_socket(self)
+    if not ffi.istype(ibuf_t, ibuf) then
+        error('Usage: socket:recv_into(ibuf[, size[, flags]])')
+    end
+    local iflags = get_iflags(internal.SEND_FLAGS, flags)
+    if iflags == nil then
+        self._errno = boxerrno.EINVAL
+        return nil
+    end
+
+    if size == nil and
+       self.itype ~= get_ivalue(internal.SO_TYPE, 'SOCK_DGRAM') then
+        size = buffer.READAHEAD
+    end
+    size = get_recv_size(self, size)
+    if size == nil then
+        return nil
+    end
+
+    self._errno = nil
+    local buf = ibuf:reserve(size)
+    local res = ffi.C.recv(fd, buf, size, iflags)
+    if res == -1 then
+        self._errno = boxerrno()
+        return nil
+    end
+    res = tonumber(res)
+    ibuf:alloc(math.min(res, size))
+    return res
+end
+
 local function socket_recvfrom(self, size, flags)
     local fd = check_socket(self)
     local iflags = get_iflags(internal.SEND_FLAGS, flags)
@@ -1313,8 +1432,10 @@ socket_mt   = {
         accept = socket_accept;
         read = socket_read;
         write = socket_write;
+        writev = socket_writev;
         send = socket_send;
         recv = socket_recv;
+        recv_into = socket_recv_into;
         recvfrom = socket_recvfrom;
         sendto = socket_sendto;
         name = socket_name;
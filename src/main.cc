@@ -53,6 +53,7 @@
 #include "fiber.h"
 #include "cbus.h"
 #include "coio_task.h"
+#include "coio_uring.h"
 #include <crc32.h>
 #include "memory.h"
 #include <say.h>
@@ -556,6 +557,7 @@ tarantool_free(void)
 
 	/* Shutdown worker pool. Waits until threads terminate. */
 	coio_shutdown();
+	coio_uring_disable();
 
 	box_lua_free();
 	box_free();
@@ -992,6 +994,7 @@ main(int argc, char **argv)
 	popen_init();
 	coio_init();
 	coio_enable();
+	coio_uring_enable();
 	signal_init();
 	cbus_init();
 	coll_init();
@@ -71,6 +71,11 @@
  * showing fiber call stack.
  */
 #cmakedefine ENABLE_BACKTRACE 1
+/*
+ * Defined if configured with ENABLE_USDT (statically defined
+ * tracing probes, see lib/core/usdt.h).
+ */
+#cmakedefine ENABLE_USDT 1
 /*
  * Defined if configured with ABORT_ON_LEAK.
  */
@@ -194,6 +199,10 @@
 #cmakedefine HAVE_FALLOCATE 1
 #cmakedefine HAVE_MREMAP 1
 #cmakedefine HAVE_SYNC_FILE_RANGE 1
+/*
+ * Defined if io_uring can be used for file I/O.
+ */
+#cmakedefine HAVE_IO_URING 1
 
 #cmakedefine HAVE_MSG_NOSIGNAL 1
 #cmakedefine HAVE_SO_NOSIGPIPE 1
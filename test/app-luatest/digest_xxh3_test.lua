@@ -0,0 +1,73 @@
+local digest = require('digest')
+local t = require('luatest')
+
+local g = t.group()
+
+local cases = {
+    {str = '', h64 = 3244421341483603138ULL,
+     h64_seed = 4075412128446734485ULL,
+     h128 = '99aa06d3014798d86001c324468d497f'},
+    {str = 'abc', h64 = 8696274497037089104ULL,
+     h64_seed = 6167986026487092235ULL,
+     h128 = '06b05ab6733a618578af5f94892f3950'},
+    {str = 'tarantool', h64 = 4639457369410017477ULL,
+     h64_seed = 15108492277440396060ULL,
+     h128 = '7016934bd6f1c5eeecea791b98fda7fd'},
+    {str = string.rep('x', 1000), h64 = 13881368916332952194ULL,
+     h128 = '50a1af5a5f2dcf01c0a4877b962cba82'},
+}
+
+g.test_xxh3 = function()
+    for _, case in ipairs(cases) do
+        t.assert_equals(digest.xxh3_64(case.str), case.h64)
+        t.assert_equals(digest.xxh3_64(case.str, 0), case.h64)
+        if case.h64_seed ~= nil then
+            t.assert_equals(digest.xxh3_64(case.str, 5), case.h64_seed)
+        end
+        t.assert_equals(string.hex(digest.xxh3_128(case.str)), case.h128)
+    end
+end
+
+g.test_xxh3_streaming = function()
+    for _, case in ipairs(cases) do
+        local h64 = digest.xxh3_64.new()
+        local h128 = digest.xxh3_128.new()
+        for i = 1, #case.str, 7 do
+            local chunk = case.str:sub(i, i + 6)
+            h64:update(chunk)
+            h128:update(chunk)
+        end
+        t.assert_equals(h64:result(), case.h64)
+        t.assert_equals(string.hex(h128:result()), case.h128)
+        -- A copy continues from the same state.
+        local copy = h64:copy()
+        copy:update('tail')
+        h64:update('tail')
+        t.assert_equals(copy:result(), h64:result())
+        -- Clearing resets the state.
+        h64:clear()
+        h64:update(case.str)
+        t.assert_equals(h64:result(), case.h64)
+        h128:clear()
+        h128:update(case.str)
+        t.assert_equals(string.hex(h128:result()), case.h128)
+    end
+    local h64 = digest.xxh3_64.new(5)
+    h64:update('abc')
+    t.assert_equals(h64:result(), 6167986026487092235ULL)
+    h64:clear(0)
+    h64:update('abc')
+    t.assert_equals(h64:result(), 8696274497037089104ULL)
+end
+
+g.test_xxh3_errors = function()
+    t.assert_error_msg_contains(
+        'Usage digest.xxh3_64(string[, unsigned number])',
+        digest.xxh3_64, 1)
+    t.assert_error_msg_contains(
+        'Usage digest.xxh3_128(string[, unsigned number])',
+        digest.xxh3_128)
+    local h = digest.xxh3_128.new()
+    t.assert_error_msg_contains('Usage xxh3_128:update(string)',
+                                h.update, h, {})
+end
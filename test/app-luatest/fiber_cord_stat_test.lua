@@ -0,0 +1,59 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.test_cord_stat = function(cg)
+    cg.server:exec(function()
+        local fiber = require('fiber')
+        local names = {}
+        for _, stat in ipairs(fiber.cord_stat()) do
+            names[stat.name] = true
+            t.assert_ge(stat.busy, 0)
+            t.assert_ge(stat.idle, 0)
+            t.assert_ge(stat.load, 0)
+            t.assert_le(stat.load, 1)
+            t.assert_equals(stat.stalls, 0)
+        end
+        t.assert(names.main)
+        t.assert(names.wal)
+        t.assert(names.iproto)
+    end)
+end
+
+g.test_watchdog = function(cg)
+    cg.server:exec(function()
+        local clock = require('clock')
+        local fiber = require('fiber')
+        t.assert_error_msg_contains('threshold must be positive',
+                                    fiber.watchdog_enable, 0)
+        fiber.watchdog_enable(0.05)
+        local f = fiber.new(function()
+            local deadline = clock.monotonic() + 0.3
+            while clock.monotonic() < deadline do end
+        end)
+        f:set_name('spinner')
+        f:set_joinable(true)
+        f:join()
+        fiber.sleep(0.01)
+        fiber.watchdog_disable()
+        local stalls = 0
+        for _, stat in ipairs(fiber.cord_stat()) do
+            if stat.name == 'main' then
+                stalls = stat.stalls
+            end
+        end
+        t.assert_equals(stalls, 1)
+    end)
+    t.assert(cg.server:grep_log("fiber 'spinner' %(%d+%) blocked the " ..
+                                "event loop of cord 'main'"))
+end
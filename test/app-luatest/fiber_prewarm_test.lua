@@ -0,0 +1,35 @@
+local fiber = require('fiber')
+local t = require('luatest')
+
+local g = t.group()
+
+g.test_prewarm = function()
+    local stat = fiber.stat()
+    t.assert_ge(stat.created, 1)
+    t.assert_ge(stat.create_time, 0)
+    fiber.prewarm(10)
+    local new_stat = fiber.stat()
+    t.assert_equals(new_stat.created, stat.created + 10)
+    t.assert_equals(new_stat.cached, stat.cached + 10)
+    -- New fibers are taken from the cache.
+    local fibers = {}
+    for i = 1, 10 do
+        fibers[i] = fiber.new(function() end)
+        fibers[i]:set_joinable(true)
+    end
+    stat = fiber.stat()
+    t.assert_equals(stat.created, new_stat.created)
+    t.assert_equals(stat.reused, new_stat.reused + 10)
+    t.assert_equals(stat.cached, new_stat.cached - 10)
+    for i = 1, 10 do
+        t.assert_equals({fibers[i]:join()}, {true})
+    end
+    t.assert_ge(fiber.stat().cached, new_stat.cached)
+end
+
+g.test_prewarm_invalid = function()
+    t.assert_error_msg_contains('count must be a non-negative number',
+                                fiber.prewarm, 'a')
+    t.assert_error_msg_contains('count must be a non-negative number',
+                                fiber.prewarm, -1)
+end
@@ -0,0 +1,107 @@
+local fiber = require('fiber')
+local net = require('net.box')
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    t.skip_if(fiber.profiler_enable == nil, 'no backtrace support')
+    t.skip_if(jit.os ~= 'Linux', 'supported only on Linux')
+    cg.server = server:new()
+    cg.server:start()
+    cg.server:exec(function()
+        -- Burns CPU for the given time.
+        rawset(_G, 'burn', function(timeout)
+            local clock = require('clock')
+            local deadline = clock.monotonic() + timeout
+            local x = 0
+            while clock.monotonic() < deadline do
+                for i = 1, 1000 do
+                    x = x + math.sin(i)
+                end
+            end
+            return x
+        end)
+    end)
+end)
+
+g.after_all(function(cg)
+    if cg.server ~= nil then
+        cg.server:drop()
+    end
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        require('fiber').profiler_disable()
+    end)
+end)
+
+-- Checks that samples are attributed to the running fiber.
+g.test_fiber = function(cg)
+    cg.server:exec(function()
+        local fiber = require('fiber')
+        t.assert_error_msg_contains('fiber.profiler() is disabled',
+                                    fiber.profiler)
+        fiber.profiler_enable(1000)
+        local f = fiber.new(_G.burn, 0.3)
+        f:name('burner')
+        f:set_joinable(true)
+        f:join()
+        local prof = fiber.profiler()
+        t.assert_gt(prof.samples, 0)
+        t.assert_equals(prof.lost, 0)
+        local burner = 0
+        local total = 0
+        for stack, count in pairs(prof.stacks) do
+            total = total + count
+            if stack:startswith('burner;') then
+                burner = burner + count
+            end
+        end
+        t.assert_equals(total, prof.samples)
+        t.assert_gt(burner, 0)
+        -- Reset discards the samples, the profiler keeps running.
+        fiber.profiler_reset()
+        prof = fiber.profiler()
+        t.assert_equals(prof.stacks, {})
+        t.assert_equals(prof.samples, 0)
+        fiber.profiler_disable()
+        t.assert_error_msg_contains('fiber.profiler() is disabled',
+                                    fiber.profiler)
+    end)
+end
+
+-- Checks that samples are attributed to the IPROTO request type.
+g.test_request = function(cg)
+    cg.server:exec(function()
+        require('fiber').profiler_enable(1000)
+    end)
+    local conn = net.connect(cg.server.net_box_uri)
+    conn:call('burn', {0.3})
+    conn:close()
+    cg.server:exec(function()
+        local found = false
+        for stack in pairs(require('fiber').profiler().stacks) do
+            if stack:find(';CALL;') then
+                found = true
+            end
+        end
+        t.assert(found)
+    end)
+end
+
+-- Checks the rate validation.
+g.test_invalid = function(cg)
+    cg.server:exec(function()
+        local fiber = require('fiber')
+        t.assert_error_msg_equals('rate must be in range [1, 1000]',
+                                  fiber.profiler_enable, 0)
+        t.assert_error_msg_equals('rate must be in range [1, 1000]',
+                                  fiber.profiler_enable, 1001)
+        t.assert_error_msg_contains('rate must be a number',
+                                    fiber.profiler_enable, 'fast')
+        t.assert_not(pcall(fiber.profiler))
+    end)
+end
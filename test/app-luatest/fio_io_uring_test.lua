@@ -0,0 +1,65 @@
+local fiber = require('fiber')
+local fio = require('fio')
+local tweaks = require('internal.tweaks')
+local t = require('luatest')
+
+local g = t.group(nil, t.helpers.matrix({use_io_uring = {true, false}}))
+
+g.before_each(function(cg)
+    cg.tmpdir = fio.tempdir()
+    tweaks.coio_use_io_uring = cg.params.use_io_uring
+end)
+
+g.after_each(function(cg)
+    tweaks.coio_use_io_uring = true
+    fio.rmtree(cg.tmpdir)
+end)
+
+-- Checks file operations that may be submitted to io_uring.
+g.test_file_io = function(cg)
+    local path = fio.pathjoin(cg.tmpdir, 'file')
+    local fh = fio.open(path, {'O_CREAT', 'O_RDWR'}, tonumber('644', 8))
+    t.assert(fh ~= nil)
+    t.assert(fh:write('hello world'))
+    t.assert(fh:pwrite('HELLO', 0))
+    t.assert(fh:fsync())
+    t.assert(fh:fdatasync())
+    t.assert_equals(fh:pread(100, 0), 'HELLO world')
+    t.assert_equals(fh:seek(6, 'SEEK_SET'), 6)
+    t.assert_equals(fh:read(100), 'world')
+    t.assert_equals(fh:read(100), '')
+    t.assert_equals(fh:stat().size, 11)
+    t.assert_equals(fio.stat(path).size, 11)
+    t.assert_equals(fio.stat(path).mode, fh:stat().mode)
+    t.assert_equals(fio.stat(path).inode, fh:stat().inode)
+    t.assert(fio.symlink(path, path .. '.link'))
+    t.assert(fio.lstat(path .. '.link'):is_link())
+    t.assert(fio.stat(path .. '.link'):is_reg())
+    t.assert(fh:close())
+    t.assert_equals(fio.stat(fio.pathjoin(cg.tmpdir, 'none')), nil)
+    local _, err = fio.open(fio.pathjoin(cg.tmpdir, 'none'), {'O_RDONLY'})
+    t.assert_str_contains(tostring(err), 'No such file or directory')
+end
+
+-- Checks that concurrent requests of many fibers complete.
+g.test_concurrent = function(cg)
+    local fibers = {}
+    for i = 1, 300 do
+        local f = fiber.new(function()
+            local path = fio.pathjoin(cg.tmpdir, tostring(i))
+            local fh = fio.open(path, {'O_CREAT', 'O_RDWR'},
+                                tonumber('644', 8))
+            fh:write(string.rep(tostring(i), 100))
+            local data = fh:pread(1000, 0)
+            fh:close()
+            return data
+        end)
+        f:set_joinable(true)
+        fibers[i] = f
+    end
+    for i, f in ipairs(fibers) do
+        local ok, data = f:join()
+        t.assert(ok)
+        t.assert_equals(data, string.rep(tostring(i), 100))
+    end
+end
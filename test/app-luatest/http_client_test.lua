@@ -333,6 +333,30 @@ g.test_errors = function()
                           "POST: exception on bad protocol - error")
 end
 
+g.test_http2_and_shared_connections = function(cg)
+    local url, opts = cg.url, cg.opts
+    local clients = {
+        client.new({http2 = true, max_concurrent_streams = 10}),
+        client.new({max_host_connections = 2}),
+        client.new({share_connections = true}),
+        client.new({share_connections = true, http2 = true}),
+    }
+    for _, http in ipairs(clients) do
+        for _ = 1, 3 do
+            local r = http:get(url, opts)
+            t.assert_equals(r.status, 200)
+            t.assert_equals(r.body, 'hello world')
+        end
+    end
+    for _, version in ipairs({'1.0', '1.1'}) do
+        local r = clients[1]:get(url, merge(opts, {http_version = version}))
+        t.assert_equals(r.status, 200)
+    end
+    t.assert_error_msg_contains('Unsupported HTTP version: 3',
+                                clients[1].get, clients[1], url,
+                                merge(opts, {http_version = '3'}))
+end
+
 -- gh-3679 Check that opts.headers values can be strings only.
 -- gh-4281 Check that opts.headers can be a table and opts.headers
 -- keys can be strings only.
@@ -311,3 +311,17 @@ g.test_unit_get_icase = function(_)
     t.assert_equals(get_icase(tbl, true), 'true')
     t.assert_equals(get_icase(tbl, 'XXXX'), nil)
 end
+
+g.test_unit_new_option_types = function(_)
+    for _, opt in ipairs({'max_connections', 'max_total_connections',
+                          'max_host_connections', 'max_concurrent_streams'}) do
+        t.assert_error_msg_contains(
+            ("option '%s' should be of type number"):format(opt),
+            httpc.new, {[opt] = 'x'})
+    end
+    for _, opt in ipairs({'http2', 'share_connections'}) do
+        t.assert_error_msg_contains(
+            ("option '%s' should be of type boolean"):format(opt),
+            httpc.new, {[opt] = 1})
+    end
+end
@@ -0,0 +1,46 @@
+local json = require('json')
+local t = require('luatest')
+
+local g = t.group()
+
+-- Checks strings with special characters at various offsets, including
+-- the ones crossing 16-byte blocks scanned at once by the decoder.
+g.test_string_offsets = function()
+    local specials = {
+        {'\\"', '"'},
+        {'\\\\', '\\'},
+        {'\\n', '\n'},
+        {'\\u0041', 'A'},
+        {'\\u00e9', 'é'},
+    }
+    for len = 0, 40 do
+        local plain = string.rep('x', len)
+        t.assert_equals(json.decode('"' .. plain .. '"'), plain)
+        t.assert_equals(json.decode('{"' .. plain .. '":1}'), {[plain] = 1})
+        for _, s in ipairs(specials) do
+            for pos = 0, len do
+                local encoded = plain:sub(1, pos) .. s[1] .. plain:sub(pos + 1)
+                local decoded = plain:sub(1, pos) .. s[2] .. plain:sub(pos + 1)
+                t.assert_equals(json.decode('"' .. encoded .. '"'), decoded)
+                t.assert_equals(json.decode('["' .. encoded .. '", "' ..
+                                            encoded .. '"]'),
+                                {decoded, decoded})
+            end
+        end
+    end
+end
+
+-- Checks that unterminated strings are rejected.
+g.test_string_errors = function()
+    for len = 0, 40 do
+        local plain = string.rep('x', len)
+        t.assert_error_msg_contains('unexpected end of string',
+                                    json.decode, '"' .. plain)
+        t.assert_error_msg_contains('unexpected end of string',
+                                    json.decode, '"' .. plain .. '\\n')
+        t.assert_error_msg_contains('unexpected end of string',
+                                    json.decode, '"' .. plain .. '\0"')
+        t.assert_error_msg_contains('invalid escape code',
+                                    json.decode, '"' .. plain .. '\\q"')
+    end
+end
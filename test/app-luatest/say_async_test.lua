@@ -0,0 +1,91 @@
+local fio = require('fio')
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.tmpdir = fio.tempdir()
+    cg.log = fio.pathjoin(cg.tmpdir, 'server.log')
+    cg.server = server:new({box_cfg = {log = cg.log}})
+    cg.server:start()
+    cg.server:exec(function()
+        require('internal.tweaks').say_async = true
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+    fio.rmtree(cg.tmpdir)
+end)
+
+local function count_lines(cg, pattern)
+    local count = 0
+    for line in io.lines(cg.log) do
+        if line:find(pattern) then
+            count = count + 1
+        end
+    end
+    return count
+end
+
+-- Checks that lines logged by many fibers and threads reach the log.
+g.test_write = function(cg)
+    cg.server:exec(function()
+        local fiber = require('fiber')
+        local log = require('log')
+        local fibers = {}
+        for i = 1, 10 do
+            fibers[i] = fiber.new(function()
+                for j = 1, 100 do
+                    log.info('async line %d %d', i, j)
+                    fiber.yield()
+                end
+            end)
+            fibers[i]:set_joinable(true)
+        end
+        for i = 1, 10 do
+            fibers[i]:join()
+        end
+        -- Lines from another thread.
+        box.snapshot()
+    end)
+    t.helpers.retrying({}, function()
+        t.assert_equals(count_lines(cg, 'async line %d+ %d+'), 1000)
+        t.assert_ge(count_lines(cg, 'saving snapshot'), 1)
+    end)
+    -- The order of lines of one fiber is preserved.
+    local last = 0
+    for line in io.lines(cg.log) do
+        local j = line:match('async line 1 (%d+)$')
+        if j ~= nil then
+            t.assert_equals(tonumber(j), last + 1)
+            last = last + 1
+        end
+    end
+end
+
+-- Checks that the number of dropped lines is reported.
+g.test_dropped = function(cg)
+    t.tarantool.skip_if_not_debug()
+    cg.server:exec(function()
+        local log = require('log')
+        box.error.injection.set('ERRINJ_LOG_ASYNC_DELAY', true)
+        for i = 1, 100 do
+            log.info('dropped line %d %s', i, string.rep('x', 10000))
+        end
+        box.error.injection.set('ERRINJ_LOG_ASYNC_DELAY', false)
+    end)
+    t.helpers.retrying({}, function()
+        local found = false
+        for line in io.lines(cg.log) do
+            local n = line:match('(%d+) log messages were dropped')
+            if n ~= nil then
+                t.assert_ge(tonumber(n) + count_lines(cg, 'dropped line'),
+                            100)
+                found = true
+            end
+        end
+        t.assert(found)
+    end)
+end
@@ -82,3 +82,82 @@ g.test_socketpair = function()
     t.assert(s1:close())
     t.assert(s2:close())
 end
+
+g.test_recv_into = function()
+    local buffer = require('buffer')
+    local ffi = require('ffi')
+    local s1, s2 = socket.socketpair('AF_UNIX', 'SOCK_STREAM', 0)
+    t.assert(s1:nonblock())
+    t.assert(s2:nonblock())
+    local ibuf = buffer.ibuf()
+    t.assert_error_msg_content_equals(
+        'Usage: socket:recv_into(ibuf[, size[, flags]])',
+        s2.recv_into, s2, 'foo')
+    t.assert_is(s2:recv_into(ibuf), nil)
+    t.assert_equals(s2:errno(), errno.EAGAIN)
+    t.assert_equals(s1:send('foo'), 3)
+    t.assert_equals(s1:send('bar'), 3)
+    t.assert_equals(s2:recv_into(ibuf, 2), 2)
+    t.assert_equals(s2:recv_into(ibuf), 4)
+    t.assert_equals(ffi.string(ibuf.rpos, ibuf:size()), 'foobar')
+    t.assert(s1:close())
+    t.assert_equals(s2:recv_into(ibuf), 0)
+    t.assert_equals(ibuf:size(), 6)
+    t.assert(s2:close())
+
+    s1, s2 = socket.socketpair('AF_UNIX', 'SOCK_DGRAM', 0)
+    t.assert(s2:nonblock())
+    ibuf:reset()
+    t.assert_equals(s1:send(string.rep('x', 100000)), 100000)
+    t.assert_equals(s2:recv_into(ibuf), 100000)
+    t.assert_equals(ffi.string(ibuf.rpos, ibuf:size()),
+                    string.rep('x', 100000))
+    t.assert(s1:close())
+    t.assert(s2:close())
+end
+
+g.test_writev = function()
+    local buffer = require('buffer')
+    local ffi = require('ffi')
+    local fiber = require('fiber')
+    local s1, s2 = socket.socketpair('AF_UNIX', 'SOCK_STREAM', 0)
+    t.assert(s1:nonblock())
+    t.assert(s2:nonblock())
+    local errmsg = 'Usage: socket:writev({data, ...}[, timeout])'
+    t.assert_error_msg_content_equals(errmsg, s1.writev, s1, 'foo')
+    t.assert_error_msg_contains(errmsg, s1.writev, s1, {1})
+    t.assert_equals(s1:writev({}), 0)
+    t.assert_equals(s1:writev({'', ''}), 0)
+
+    local ibuf = buffer.ibuf()
+    local p = ibuf:alloc(3)
+    p[0], p[1], p[2] = 98, 97, 114
+    local slice = ffi.new('char[4]', 'bazz')
+    t.assert_equals(s1:writev({'foo', ibuf, '', {slice, 3}}), 9)
+    t.assert_equals(s2:read(9), 'foobarbaz')
+    t.assert_equals(ibuf:size(), 3)
+
+    -- A write that doesn't fit in the socket buffer completes as the
+    -- other side reads the data.
+    local chunk = string.rep('x', 100000)
+    local bufs = {}
+    for i = 1, 2000 do
+        bufs[i] = i % 2 == 0 and chunk or 'y'
+    end
+    local expected = table.concat(bufs)
+    local reader = fiber.new(function()
+        return s2:read(#expected, 10)
+    end)
+    reader:set_joinable(true)
+    t.assert_equals(s1:writev(bufs, 10), #expected)
+    local ok, data = reader:join()
+    t.assert(ok)
+    t.assert_equals(#data, #expected)
+    t.assert(data == expected)
+
+    -- Timeout.
+    t.assert_is(s1:writev({chunk, chunk, chunk, chunk}, 0.01), nil)
+    t.assert_equals(s1:errno(), errno.ETIMEDOUT)
+    t.assert(s1:close())
+    t.assert(s2:close())
+end
@@ -2575,6 +2575,89 @@ test_tuple_validate_formatted(lua_State *L)
 	return 1;
 }
 
+/**
+ * Scan a space with box_iterator_next_batch() and decode a field of the
+ * fetched tuples with box_tuple_decode_column().
+ *
+ * Accepts a space id, a zero-based field number, a batch size and a
+ * column type name ('int64', 'uint64' or 'double').
+ *
+ * Returns the number of tuples, the sum of the decoded values and the
+ * number of tuples without the field. Raises an error on failure.
+ */
+static int
+iterator_next_batch(struct lua_State *L)
+{
+	uint32_t space_id = luaL_checkinteger(L, 1);
+	uint32_t fieldno = luaL_checkinteger(L, 2);
+	uint32_t batch_size = luaL_checkinteger(L, 3);
+	const char *type_name = luaL_checkstring(L, 4);
+	enum box_column_type type;
+	if (strcmp(type_name, "int64") == 0)
+		type = BOX_COLUMN_INT64;
+	else if (strcmp(type_name, "uint64") == 0)
+		type = BOX_COLUMN_UINT64;
+	else if (strcmp(type_name, "double") == 0)
+		type = BOX_COLUMN_DOUBLE;
+	else
+		return luaL_error(L, "unknown column type");
+
+	char key[8];
+	char *key_end = mp_encode_array(key, 0);
+	box_iterator_t *it = box_index_iterator(space_id, 0, ITER_ALL,
+						key, key_end);
+	if (it == NULL)
+		return luaT_error(L);
+	box_tuple_t **tuples = xmalloc(batch_size * sizeof(*tuples));
+	union {
+		int64_t i;
+		uint64_t u;
+		double d;
+	} *values = xmalloc(batch_size * sizeof(*values));
+	bool *nulls = xmalloc(batch_size * sizeof(*nulls));
+	uint32_t tuple_count = 0;
+	uint32_t null_count = 0;
+	double sum = 0;
+	int rc;
+	while (true) {
+		uint32_t count;
+		rc = box_iterator_next_batch(it, tuples, batch_size, &count);
+		if (rc != 0 || count == 0)
+			break;
+		fail_unless(count <= batch_size);
+		tuple_count += count;
+		rc = box_tuple_decode_column(tuples, count, fieldno, type,
+					     values, nulls);
+		for (uint32_t i = 0; i < count; i++) {
+			box_tuple_unref(tuples[i]);
+			if (rc != 0)
+				continue;
+			if (nulls[i]) {
+				null_count++;
+				continue;
+			}
+			if (type == BOX_COLUMN_INT64)
+				sum += values[i].i;
+			else if (type == BOX_COLUMN_UINT64)
+				sum += values[i].u;
+			else
+				sum += values[i].d;
+		}
+		if (rc != 0 || count < batch_size)
+			break;
+	}
+	box_iterator_free(it);
+	free(nulls);
+	free(values);
+	free(tuples);
+	if (rc != 0)
+		return luaT_error(L);
+	lua_pushinteger(L, tuple_count);
+	lua_pushnumber(L, sum);
+	lua_pushinteger(L, null_count);
+	return 3;
+}
+
 /**
  * Get a pointer to a tuple field pointed by a JSON path.
  *
@@ -3402,6 +3485,7 @@ luaopen_module_api(lua_State *L)
 		{"tuple_validate_fmt", test_tuple_validate_formatted},
 		{"test_key_def_dup", test_key_def_dup},
 		{"tuple_field_by_path", tuple_field_by_path},
+		{"iterator_next_batch", iterator_next_batch},
 		{"test_decimal", test_decimal},
 		{"decimal_mul", test_decimal_mul},
 		{"decimal_div", test_decimal_div},
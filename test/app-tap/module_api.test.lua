@@ -89,6 +89,50 @@ local function test_tuple_validate(test, module)
     test:ok(not module.tuple_validate_fmt(tuple4), "tuple 4 (fmt)")
 end
 
+local function test_iterator_next_batch(test, module)
+    test:plan(10)
+
+    local s = box.schema.space.create('test_batch')
+    s:create_index('pk')
+    for i = 1, 1000 do
+        if i % 10 == 0 then
+            s:insert({i})
+        elseif i % 10 == 5 then
+            s:insert({i, box.NULL})
+        else
+            s:insert({i, i})
+        end
+    end
+    -- Sum of 1..1000 without multiples of 5.
+    local sum = 500500 - 100500
+
+    for _, batch_size in ipairs({1, 7, 1000}) do
+        for _, type in ipairs({'int64', 'double'}) do
+            test:is_deeply({module.iterator_next_batch(s.id, 1, batch_size,
+                                                       type)},
+                           {1000, sum, 200},
+                           string.format('batch size %d, %s', batch_size,
+                                         type))
+        end
+    end
+    test:is_deeply({module.iterator_next_batch(s.id, 1, 2000, 'uint64')},
+                   {1000, sum, 200}, 'batch size 2000, uint64')
+
+    s:replace({1, -1})
+    test:is_deeply({module.iterator_next_batch(s.id, 1, 100, 'int64')},
+                   {1000, sum - 2, 200}, 'negative integer')
+    local ok, err = pcall(module.iterator_next_batch, s.id, 1, 100, 'uint64')
+    test:is_deeply({ok, tostring(err)},
+                   {false, 'Tuple field 2 type does not match one required ' ..
+                           'by operation: expected unsigned, got integer'},
+                   'invalid field type')
+
+    s:truncate()
+    test:is_deeply({module.iterator_next_batch(s.id, 1, 100, 'int64')},
+                   {0, 0, 0}, 'empty space')
+    s:drop()
+end
+
 local function test_iscallable(test, module)
     local ffi = require('ffi')
 
@@ -671,7 +715,7 @@ local function test_box_ibuf(test, module)
 end
 
 require('tap').test("module_api", function(test)
-    test:plan(50)
+    test:plan(51)
     local status, module = pcall(require, 'module_api')
     test:is(status, true, "module")
     test:ok(status, "module is loaded")
@@ -702,6 +746,7 @@ require('tap').test("module_api", function(test)
     test:test("buffers", test_buffers, module)
     test:test("tuple_validate", test_tuple_validate, module)
     test:test("tuple_field_by_path", test_tuple_field_by_path, module)
+    test:test("iterator_next_batch", test_iterator_next_batch, module)
     test:test("pushdecimal", test_pushdecimal, module)
     test:test("isdecimal", test_isdecimal, module)
     test:test("box_schema_version_matches", test_box_schema_version_matches, module)
@@ -0,0 +1,145 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.before_each(function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test', {format = {
+            {'id', 'unsigned'}, {'grp', 'string'}, {'v', 'integer'},
+            {'s', 'string', is_nullable = true},
+        }})
+        s:create_index('pk')
+        s:insert({1, 'a', 10, 'x'})
+        s:insert({2, 'a', 20, 'y'})
+        s:insert({3, 'b', 5})
+    end)
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        local aggregate_view = require('aggregate_view')
+        if box.space.view ~= nil then
+            aggregate_view.drop('view')
+        end
+        box.space.test:drop()
+    end)
+end)
+
+local function create_view()
+    local aggregate_view = require('aggregate_view')
+    return aggregate_view.create('view', {
+        source = 'test',
+        group_by = {'grp'},
+        aggregates = {
+            {name = 'sum_v', func = 'sum', field = 'v'},
+            {name = 'min_v', func = 'min', field = 'v'},
+            {name = 'max_s', func = 'max', field = 's'},
+        },
+    })
+end
+
+-- Checks that a view is filled on creation and follows the changes.
+g.test_maintain = function(cg)
+    cg.server:exec(create_view)
+    cg.server:exec(function()
+        local s = box.space.test
+        local view = box.space.view
+        t.assert_equals(view.type, 'temporary')
+        t.assert_equals(view:select(), {
+            {'a', 2, 30, 10, 'y'},
+            {'b', 1, 5, 5, box.NULL},
+        })
+        s:insert({4, 'b', 1, 'z'})
+        t.assert_equals(view:get('b'), {'b', 2, 6, 1, 'z'})
+        s:update(4, {{'=', 'grp', 'c'}})
+        t.assert_equals(view:get('b'), {'b', 1, 5, 5, box.NULL})
+        t.assert_equals(view:get('c'), {'c', 1, 1, 1, 'z'})
+        -- Removal of the minimum and maximum values.
+        s:delete(1)
+        t.assert_equals(view:get('a'), {'a', 1, 20, 20, 'y'})
+        s:replace({2, 'a', 7})
+        t.assert_equals(view:get('a'), {'a', 1, 7, 7, box.NULL})
+        s:delete(2)
+        t.assert_equals(view:get('a'), nil)
+        -- Rolled back changes are not visible.
+        box.begin()
+        s:insert({10, 'b', 100})
+        t.assert_equals(view:get('b'), {'b', 2, 105, 5, box.NULL})
+        box.rollback()
+        t.assert_equals(view:get('b'), {'b', 1, 5, 5, box.NULL})
+    end)
+end
+
+-- Checks that create() rebuilds an existing view.
+g.test_rebuild = function(cg)
+    cg.server:exec(create_view)
+    cg.server:exec(function()
+        local trigger = require('trigger')
+        local event = ('box.space[%d].on_replace'):format(box.space.test.id)
+        trigger.del(event, 'aggregate_view.view')
+        box.space.test:insert({4, 'c', 1})
+        t.assert_equals(box.space.view:get('c'), nil)
+    end)
+    cg.server:exec(create_view)
+    cg.server:exec(function()
+        t.assert_equals(box.space.view:select(), {
+            {'a', 2, 30, 10, 'y'},
+            {'b', 1, 5, 5, box.NULL},
+            {'c', 1, 1, 1, box.NULL},
+        })
+        box.space.test:delete(4)
+        t.assert_equals(box.space.view:get('c'), nil)
+    end)
+end
+
+-- Checks that drop() stops maintaining the view.
+g.test_drop = function(cg)
+    cg.server:exec(create_view)
+    cg.server:exec(function()
+        require('aggregate_view').drop('view')
+        t.assert_equals(box.space.view, nil)
+        box.space.test:insert({4, 'c', 1})
+    end)
+end
+
+-- Checks the options validation.
+g.test_invalid = function(cg)
+    cg.server:exec(function()
+        local aggregate_view = require('aggregate_view')
+        local function check(opts, msg)
+            t.assert_error_msg_equals(msg, aggregate_view.create, 'view', opts)
+        end
+        check({source = 'none', group_by = {'grp'}},
+              "Illegal parameters, space 'none' does not exist")
+        check({source = 'test', group_by = {}},
+              'Illegal parameters, group_by should be a non-empty table')
+        check({source = 'test', group_by = {'s'}},
+              "Illegal parameters, group_by: field 's' is nullable")
+        check({source = 'test', group_by = {'foo'}},
+              "Illegal parameters, group_by: field 'foo' is not found " ..
+              "in the format of space 'test'")
+        check({source = 'test', group_by = {'grp'},
+               aggregates = {{name = 'x', func = 'avg', field = 'v'}}},
+              "Illegal parameters, aggregates[1].func should be one of " ..
+              "'sum', 'min', 'max'")
+        check({source = 'test', group_by = {'grp'},
+               aggregates = {{name = 'x', func = 'sum', field = 's'}}},
+              "Illegal parameters, aggregates[1]: field 's' has " ..
+              "unsupported type")
+        local s = box.schema.space.create('vy', {engine = 'vinyl'})
+        check({source = 'vy', group_by = {1}},
+              "Illegal parameters, space 'vy' is not a memtx space")
+        s:drop()
+        t.assert_equals(box.space.view, nil)
+    end)
+end
@@ -0,0 +1,80 @@
+local net = require('net.box')
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+local CREDS_MISMATCH = 'User not found or supplied credentials are invalid'
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        for _, name in ipairs({'test', 'test2', 'role'}) do
+            if box.schema.user.exists(name) then
+                box.schema.user.drop(name)
+            end
+            if box.schema.role.exists(name) then
+                box.schema.role.drop(name)
+            end
+        end
+    end)
+end)
+
+local function connect(cg, user, password)
+    return net.connect(cg.server.net_box_uri, {
+        user = user, password = password, wait_connected = true,
+    })
+end
+
+-- Checks that authentication finds users created, renamed and dropped
+-- at runtime.
+g.test_user_lookup = function(cg)
+    cg.server:exec(function()
+        box.schema.user.create('test', {password = 'secret'})
+        box.schema.role.create('role')
+    end)
+    local conn = connect(cg, 'test', 'secret')
+    t.assert_equals(conn.error, nil)
+    conn:close()
+    -- Roles can't authenticate.
+    conn = connect(cg, 'role', '')
+    t.assert_str_contains(conn.error, CREDS_MISMATCH)
+    conn:close()
+
+    cg.server:exec(function()
+        local id = box.space._user.index.name:get('test').id
+        box.space._user:update(id, {{'=', 3, 'test2'}})
+    end)
+    conn = connect(cg, 'test', 'secret')
+    t.assert_str_contains(conn.error, CREDS_MISMATCH)
+    conn:close()
+    conn = connect(cg, 'test2', 'secret')
+    t.assert_equals(conn.error, nil)
+    conn:close()
+
+    -- A rolled back rename doesn't change the lookup.
+    cg.server:exec(function()
+        box.begin()
+        local id = box.space._user.index.name:get('test2').id
+        box.space._user:update(id, {{'=', 3, 'test'}})
+        box.rollback()
+    end)
+    conn = connect(cg, 'test2', 'secret')
+    t.assert_equals(conn.error, nil)
+    conn:close()
+
+    cg.server:exec(function()
+        box.schema.user.drop('test2')
+    end)
+    conn = connect(cg, 'test2', 'secret')
+    t.assert_str_contains(conn.error, CREDS_MISMATCH)
+    conn:close()
+end
@@ -0,0 +1,60 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new({
+        box_cfg = {checkpoint_interval = 0},
+    })
+    cg.server:start()
+    cg.server:exec(function()
+        local s = box.schema.space.create('test')
+        s:create_index('pk')
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.test_invalid_cfg = function(cg)
+    cg.server:exec(function()
+        t.assert_error_msg_content_equals(
+            "Incorrect value for option 'checkpoint_recovery_time': " ..
+            "value must be >= 0",
+            box.cfg, {checkpoint_recovery_time = -1})
+        t.assert_equals(box.cfg.checkpoint_recovery_time, 0)
+    end)
+end
+
+-- Checks that a checkpoint is triggered when the WAL written since the
+-- last checkpoint would take longer than checkpoint_recovery_time to
+-- replay.
+g.test_checkpoint_trigger = function(cg)
+    cg.server:exec(function()
+        local fiber = require('fiber')
+        local function checkpoint_count()
+            return #box.info.gc().checkpoints
+        end
+        box.cfg{checkpoint_count = 100}
+        box.snapshot()
+        local count = checkpoint_count()
+        local data = string.rep('x', 1000)
+        for i = 1, 200 do
+            box.space.test:replace({i, data})
+        end
+        fiber.sleep(0.1)
+        t.assert_equals(checkpoint_count(), count)
+        -- The WAL replay rate isn't measured on bootstrap, so the
+        -- default of 32 MB/s is assumed.
+        box.cfg{checkpoint_recovery_time = 0.001}
+        for i = 1, 200 do
+            box.space.test:replace({i, data})
+        end
+        t.helpers.retrying({}, function()
+            t.assert_ge(checkpoint_count(), count + 1)
+        end)
+        box.cfg{checkpoint_recovery_time = 0}
+    end)
+end
@@ -0,0 +1,129 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group('expire', t.helpers.matrix({engine = {'memtx', 'vinyl'}}))
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        if box.space.test ~= nil then
+            box.space.test:drop()
+        end
+        box.cfg({expiration_rate = 10000})
+    end)
+end)
+
+g.test_options = function(cg)
+    cg.server:exec(function(engine)
+        local format = {
+            {'id', 'unsigned'},
+            {'exp', 'number'},
+            {'name', 'string'},
+        }
+        t.assert_error_msg_content_equals(
+            "Illegal parameters, unknown expire_field 'foo'",
+            box.schema.space.create, 'test',
+            {engine = engine, format = format, expire_field = 'foo'})
+        t.assert_error_msg_content_equals(
+            "Failed to create space 'test': expire_field must be of type " ..
+            "unsigned, integer, number, double or datetime",
+            box.schema.space.create, 'test',
+            {engine = engine, format = format, expire_field = 'name'})
+        local s = box.schema.space.create('test', {
+            engine = engine, format = format, expire_field = 'exp',
+        })
+        t.assert_equals(s.expire_field, 2)
+        s:alter({expire_field = false})
+        t.assert_equals(s.expire_field, nil)
+        s:alter({expire_field = 2})
+        t.assert_equals(s.expire_field, 2)
+        t.assert_error_msg_content_equals(
+            "Incorrect value for option 'expiration_rate': " ..
+            "the value must be greater than or equal to 0",
+            box.cfg, {expiration_rate = -1})
+    end, {cg.params.engine})
+end
+
+g.test_expire = function(cg)
+    cg.server:exec(function(engine)
+        local datetime = require('datetime')
+        local fiber = require('fiber')
+        local now = fiber.time()
+        for _, type in ipairs({'unsigned', 'number', 'datetime'}) do
+            local s = box.schema.space.create('test', {
+                engine = engine,
+                format = {
+                    {'id', 'unsigned'},
+                    {'exp', type, is_nullable = true},
+                },
+                expire_field = 'exp',
+            })
+            s:create_index('pk')
+            s:create_index('exp', {parts = {'exp'}, unique = false})
+            local function exp(delay)
+                if type == 'datetime' then
+                    return datetime.new({timestamp = math.floor(now + delay)})
+                end
+                return math.floor(now + delay)
+            end
+            for i = 1, 100 do
+                s:insert({i, exp(-i)})
+            end
+            s:insert({101, exp(3600)})
+            s:insert({102, box.NULL})
+            t.helpers.retrying({timeout = 10}, function()
+                t.assert_equals(s:count(), 2, type)
+            end)
+            t.assert_not_equals(s:get(101), nil)
+            s:drop()
+        end
+    end, {cg.params.engine})
+end
+
+g.test_rate = function(cg)
+    cg.server:exec(function(engine)
+        local fiber = require('fiber')
+        box.cfg({expiration_rate = 0})
+        local s = box.schema.space.create('test', {
+            engine = engine,
+            format = {{'id', 'unsigned'}, {'exp', 'number'}},
+            expire_field = 2,
+        })
+        s:create_index('pk')
+        s:create_index('exp', {parts = {2, 'number'}, unique = false})
+        for i = 1, 50 do
+            s:insert({i, fiber.time() - 10})
+        end
+        -- Expiration is disabled.
+        fiber.sleep(1.5)
+        t.assert_equals(s:count(), 50)
+        box.cfg({expiration_rate = 10})
+        t.helpers.retrying({timeout = 20}, function()
+            t.assert_equals(s:count(), 0)
+        end)
+    end, {cg.params.engine})
+end
+
+g.test_no_index = function(cg)
+    cg.server:exec(function(engine)
+        local fiber = require('fiber')
+        local s = box.schema.space.create('test', {
+            engine = engine,
+            format = {{'id', 'unsigned'}, {'exp', 'number'}},
+            expire_field = 'exp',
+        })
+        s:create_index('pk')
+        s:insert({1, fiber.time() - 10})
+        -- Without an index on the expiration field tuples don't expire.
+        fiber.sleep(1.5)
+        t.assert_equals(s:count(), 1)
+    end, {cg.params.engine})
+end
@@ -0,0 +1,58 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new({
+        box_cfg = {
+            checkpoint_count = 1,
+            gc_io_rate_limit = 1,
+        },
+    })
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.test_cfg = function(cg)
+    cg.server:exec(function()
+        t.assert_equals(box.cfg.gc_io_rate_limit, 1)
+        t.assert_error_msg_contains(
+            "Incorrect value for option 'gc_io_rate_limit': " ..
+            "the value must be >= 0",
+            box.cfg, {gc_io_rate_limit = -1})
+        t.assert_equals(box.cfg.gc_io_rate_limit, 1)
+    end)
+end
+
+-- A throttled file disappears from the directory right away, only
+-- its disk space is freed in background.
+g.test_snapshot_gc = function(cg)
+    cg.server:exec(function()
+        local digest = require('digest')
+        local fio = require('fio')
+        local s = box.schema.space.create('test')
+        s:create_index('pk')
+        box.begin()
+        for i = 1, 1000 do
+            s:insert({i, digest.urandom(10 * 1024)})
+        end
+        box.commit()
+        box.snapshot()
+        local glob = fio.pathjoin(box.cfg.memtx_dir, '*.snap')
+        local snaps = fio.glob(glob)
+        t.assert_equals(#snaps, 1)
+        t.assert_gt(fio.stat(snaps[1]).size, 8 * 1024 * 1024)
+        s:insert({0})
+        box.snapshot()
+        t.helpers.retrying({}, function()
+            local new_snaps = fio.glob(glob)
+            t.assert_equals(#new_snaps, 1)
+            t.assert_not_equals(new_snaps[1], snaps[1])
+        end)
+        s:drop()
+    end)
+end
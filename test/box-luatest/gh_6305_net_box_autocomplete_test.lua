@@ -30,6 +30,7 @@ g.test_autocomplete = function()
     local r = tabcomplete('conn1:')
     t.assert_items_equals(r, {'conn1:',
                               'conn1:call(',
+                              'conn1:batch(',
                               'conn1:reload_schema(',
                               'conn1:on_disconnect(',
                               'conn1:on_shutdown(',
@@ -74,6 +75,9 @@ g.test_autocomplete = function()
                               'conn1.space.space1.index.primary:count(',
                               'conn1.space.space1.index.primary:min(',
                               'conn1.space.space1.index.primary:get(',
+                              'conn1.space.space1.index.primary:select_many(',
+                              'conn1.space.space1.index.primary:get_many(',
+                              'conn1.space.space1.index.primary:pairs(',
                               })
 
     -- sreams are pretty the same
@@ -103,6 +107,9 @@ g.test_autocomplete = function()
                               'stream1.space.space1.index.primary:count(',
                               'stream1.space.space1.index.primary:min(',
                               'stream1.space.space1.index.primary:get(',
+                              'stream1.space.space1.index.primary:select_many(',
+                              'stream1.space.space1.index.primary:get_many(',
+                              'stream1.space.space1.index.primary:pairs(',
                               })
 
     -- futures
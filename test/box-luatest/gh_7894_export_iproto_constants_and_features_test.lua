@@ -86,6 +86,12 @@ local reference_table = {
         INDEX_NAME = 0x5f,
         TUPLE_FORMATS = 0x60,
         IS_SYNC = 0x61,
+        COMPRESSION = 0x62,
+        WAIT_VCLOCK = 0x63,
+        FIELDS = 0x64,
+        FILTER = 0x65,
+        SPACE_FILTER = 0x66,
+        ARROW = 0x67,
     },
 
     -- `iproto_metadata_key` enumeration.
@@ -131,6 +137,8 @@ local reference_table = {
         BEGIN = 14,
         COMMIT = 15,
         ROLLBACK = 16,
+        SELECT_MANY = 17,
+        INSERT_ARROW = 18,
         RAFT = 30,
         RAFT_PROMOTE = 31,
         RAFT_DEMOTE = 32,
@@ -166,7 +174,7 @@ local reference_table = {
     },
 
     -- `IPROTO_CURRENT_VERSION` constant
-    protocol_version = 7,
+    protocol_version = 11,
 
     -- `feature_id` enumeration
     protocol_features = {
@@ -180,6 +188,7 @@ local reference_table = {
         dml_tuple_extension = true,
         call_ret_tuple_extension = true,
         call_arg_tuple_extension = true,
+        compression = true,
     },
     feature = {
         streams = 0,
@@ -192,6 +201,7 @@ local reference_table = {
         dml_tuple_extension = 7,
         call_ret_tuple_extension = 8,
         call_arg_tuple_extension = 9,
+        compression = 10,
     },
 }
 
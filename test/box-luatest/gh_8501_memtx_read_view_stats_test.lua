@@ -38,6 +38,7 @@ g.test_memtx_read_view_stats = function(cg)
         t.assert_gt(index_size, 0)
         t.assert_equals(stat2.index.read_view, 0)
         t.assert_equals(stat2.data.read_view, 0)
+        t.assert_equals(stat2.data.read_view_max, 0)
         t.assert_equals(stat2.data.garbage, 0)
 
         -- Start a snapshot to create a system read view.
@@ -56,6 +57,7 @@ g.test_memtx_read_view_stats = function(cg)
         t.assert_equals(stat4.index.read_view, index_size)
         t.assert_equals(stat4.data.total - stat3.data.total, data_size)
         t.assert_equals(stat4.data.read_view, data_size)
+        t.assert_equals(stat4.data.read_view_max, data_size)
         t.assert_equals(stat4.data.garbage, 0)
 
         -- Complete the snapshot.
@@ -66,11 +68,13 @@ g.test_memtx_read_view_stats = function(cg)
         t.assert_equals(stat5.index.read_view, 0)
         t.assert_equals(stat5.data.total - stat3.data.total, data_size)
         t.assert_equals(stat5.data.read_view, 0)
+        t.assert_equals(stat5.data.read_view_max, data_size)
         t.assert_equals(stat5.data.garbage, data_size)
 
-        -- Replace a tuple to collect garbage.
+        -- Replace a tuple to collect garbage and reset the max.
         s:replace({1})
         gc()
+        box.stat.reset()
         local stat6 = box.stat.memtx()
         t.assert_equals(stat6, stat2)
 
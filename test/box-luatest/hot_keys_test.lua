@@ -0,0 +1,83 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group('hot-keys', t.helpers.matrix({
+    engine = {'memtx', 'vinyl'},
+}))
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+    cg.server:exec(function(engine)
+        local s = box.schema.space.create('test', {engine = engine})
+        s:create_index('pk')
+        s:create_index('sk', {parts = {2, 'string'}})
+    end, {cg.params.engine})
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        box.stat.hot_keys_disable()
+        box.space.test:truncate()
+    end)
+end)
+
+g.test_disabled = function(cg)
+    cg.server:exec(function()
+        local s = box.space.test
+        s:replace({1, 'a'})
+        s:get(1)
+        t.assert_equals(s.index.pk:stat().hot_keys, nil)
+    end)
+end
+
+g.test_hot_keys = function(cg)
+    cg.server:exec(function()
+        local s = box.space.test
+        box.stat.hot_keys_enable(1)
+        for i = 1, 100 do
+            s:replace({i, 'k' .. i})
+        end
+        for _ = 1, 50 do
+            s:get(7)
+            s:get(3)
+            s:select({5})
+        end
+        for _ = 1, 20 do
+            s.index.sk:get('k42')
+            s:update(8, {{'=', 3, 'x'}})
+        end
+        local hot = s.index.pk:stat().hot_keys
+        t.assert_equals(#hot, 16)
+        t.assert_items_equals({hot[1].key[1], hot[2].key[1], hot[3].key[1]},
+                              {3, 5, 7})
+        t.assert_ge(hot[1].count, 51)
+        t.assert_equals(hot[4].key, {8})
+        t.assert_ge(hot[4].count, 21)
+        hot = s.index.sk:stat().hot_keys
+        t.assert_equals(hot, {{key = {'k42'}, count = 20}})
+        box.stat.reset()
+        t.assert_equals(s.index.pk:stat().hot_keys, nil)
+    end)
+end
+
+g.test_sampling = function(cg)
+    cg.server:exec(function()
+        local s = box.space.test
+        s:replace({1, 'a'})
+        box.stat.hot_keys_enable(10)
+        for _ = 1, 1000 do
+            s:get(1)
+        end
+        local hot = s.index.pk:stat().hot_keys
+        t.assert_equals(#hot, 1)
+        t.assert_equals(hot[1], {key = {1}, count = 1000})
+        t.assert_error_msg_contains(
+            'sample_interval must be a positive integer',
+            box.stat.hot_keys_enable, 0)
+    end)
+end
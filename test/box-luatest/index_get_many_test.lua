@@ -0,0 +1,69 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group(nil, t.helpers.matrix({engine = {'memtx', 'vinyl'}}))
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        if box.space.test ~= nil then
+            box.space.test:drop()
+        end
+    end)
+end)
+
+g.test_get_many = function(cg)
+    cg.server:exec(function(engine)
+        local s = box.schema.space.create('test', {engine = engine})
+        s:create_index('pk')
+        s:create_index('sk', {parts = {{2, 'string'}, {3, 'unsigned'}}})
+        for i = 1, 10 do
+            s:insert({i, 'x', i * 10})
+        end
+        t.assert_equals(s:get_many({}), {})
+        t.assert_equals(s:get_many({3, {1}, 100, 10}),
+                        {{3, 'x', 30}, {1, 'x', 10}, box.NULL, {10, 'x', 100}})
+        local res = s.index.sk:get_many({{'x', 20}, {'y', 20}, {'x', 50}})
+        t.assert_equals(#res, 3)
+        t.assert_equals(res[1], {2, 'x', 20})
+        t.assert_equals(res[2], box.NULL)
+        t.assert_equals(res[3], {5, 'x', 50})
+        -- The result is consistent with get() in a transaction.
+        box.begin()
+        s:replace({1, 'y', 1})
+        s:delete(2)
+        t.assert_equals(s:get_many({1, 2, 3}),
+                        {{1, 'y', 1}, box.NULL, {3, 'x', 30}})
+        box.rollback()
+        t.assert_equals(s:get_many({1, 2}), {{1, 'x', 10}, {2, 'x', 20}})
+    end, {cg.params.engine})
+end
+
+g.test_errors = function(cg)
+    cg.server:exec(function(engine)
+        local s = box.schema.space.create('test', {engine = engine})
+        s:create_index('pk')
+        s:create_index('sk', {parts = {2, 'unsigned'}, unique = false})
+        t.assert_error_msg_content_equals(
+            "Usage: index:get_many({key1, key2, ...})",
+            s.get_many, s, 1)
+        t.assert_error_msg_content_equals(
+            "Supplied key type of part 0 does not match index part type: " ..
+            "expected unsigned",
+            s.get_many, s, {1, 'x'})
+        t.assert_error_msg_content_equals(
+            "Invalid key part count in an exact match (expected 1, got 0)",
+            s.get_many, s, {1, {}})
+        t.assert_error_msg_content_equals(
+            "Get() doesn't support partial keys and non-unique indexes",
+            s.index.sk.get_many, s.index.sk, {1})
+    end, {cg.params.engine})
+end
@@ -0,0 +1,59 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.test_bootstrap = function(cg)
+    cg.server:exec(function()
+        local stat = box.info.recovery()
+        t.assert_equals(stat.time, 0)
+        t.assert_equals(stat.snapshot.rows, 0)
+        t.assert_equals(stat.wal.rows, 0)
+        t.assert_equals(stat.vinyl.lsm_count, 0)
+    end)
+end
+
+g.test_local_recovery = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('memtx')
+        s:create_index('pk')
+        s:create_index('sk', {parts = {2, 'unsigned'}})
+        local v = box.schema.space.create('vinyl', {engine = 'vinyl'})
+        v:create_index('pk')
+        for i = 1, 100 do
+            s:insert({i, i})
+        end
+        box.snapshot()
+        for i = 101, 200 do
+            s:insert({i, i})
+            v:insert({i})
+        end
+    end)
+    cg.server:restart()
+    cg.server:exec(function()
+        local stat = box.info.recovery()
+        t.assert_gt(stat.time, 0)
+        t.assert_ge(stat.snapshot.rows, 100)
+        t.assert_gt(stat.snapshot.time, 0)
+        t.assert_gt(stat.snapshot.rps, 0)
+        t.assert_ge(stat.wal.rows, 200)
+        t.assert_gt(stat.wal.bytes, 0)
+        t.assert_gt(stat.wal.time, 0)
+        t.assert_gt(stat.wal.rps, 0)
+        t.assert_ge(stat.memtx.pk_build_time, 0)
+        t.assert_gt(stat.memtx.sk_build_time, 0)
+        t.assert_ge(stat.vinyl.vylog_time, 0)
+        t.assert_ge(stat.vinyl.lsm_time, 0)
+        t.assert_equals(stat.vinyl.lsm_count, 1)
+        t.assert_le(stat.snapshot.time + stat.wal.time, stat.time)
+    end)
+end
@@ -0,0 +1,87 @@
+local fiber = require('fiber')
+local net = require('net.box')
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new({box_cfg = {net_batch_delay = 0.001}})
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+local function batch_size_stat(cg)
+    return cg.server:exec(function()
+        local stat = box.stat.net.BATCH_SIZE
+        t.assert_equals(box.stat.net().BATCH_SIZE, stat)
+        t.assert_equals(box.stat.net.thread[1].BATCH_SIZE, stat)
+        return stat
+    end)
+end
+
+-- Sends requests over many connections concurrently.
+local function send_requests(cg, conn_count, request_count)
+    local conns = {}
+    for i = 1, conn_count do
+        conns[i] = net.connect(cg.server.net_box_uri)
+    end
+    local fibers = {}
+    for i = 1, conn_count do
+        fibers[i] = fiber.new(function()
+            for _ = 1, request_count do
+                t.assert_equals(conns[i]:eval('return ...', {i}), i)
+            end
+        end)
+        fibers[i]:set_joinable(true)
+    end
+    for i = 1, conn_count do
+        t.assert((fibers[i]:join()))
+        conns[i]:close()
+    end
+end
+
+g.test_batch_delay = function(cg)
+    cg.server:exec(function()
+        box.stat.reset()
+    end)
+    local stat = batch_size_stat(cg)
+    t.assert_equals(stat.total, 0)
+    t.assert_equals(#stat.histogram, 11)
+
+    send_requests(cg, 20, 10)
+    stat = batch_size_stat(cg)
+    local total = 0
+    for _, count in ipairs(stat.histogram) do
+        total = total + count
+    end
+    t.assert_equals(total, stat.total)
+    -- Every connection is accounted in at least one batch.
+    t.assert_ge(total, 20)
+    -- Requests of different connections are sent in batches.
+    t.assert_lt(total, 20 * 10)
+
+    -- The delay can be disabled.
+    cg.server:exec(function()
+        box.cfg({net_batch_delay = 0})
+    end)
+    send_requests(cg, 5, 5)
+    t.assert_gt(batch_size_stat(cg).total, total)
+    cg.server:exec(function()
+        box.cfg({net_batch_delay = 0.001})
+    end)
+end
+
+g.test_invalid_cfg = function(cg)
+    cg.server:exec(function()
+        local msg = "Incorrect value for option 'net_batch_delay': " ..
+                    "must be greater than or equal to 0 and less than " ..
+                    "or equal to 0.1"
+        t.assert_error_msg_equals(msg, box.cfg, {net_batch_delay = -1})
+        t.assert_error_msg_equals(msg, box.cfg, {net_batch_delay = 1})
+        t.assert_equals(box.cfg.net_batch_delay, 0.001)
+    end)
+end
@@ -0,0 +1,88 @@
+local net = require('net.box')
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new({box_cfg = {net_msg_max_per_connection = 2}})
+    cg.server:start()
+    cg.server:exec(function()
+        local fiber = require('fiber')
+        local cond = fiber.cond()
+        rawset(_G, 'in_progress', 0)
+        rawset(_G, 'block', function()
+            _G.in_progress = _G.in_progress + 1
+            cond:wait()
+            _G.in_progress = _G.in_progress - 1
+        end)
+        rawset(_G, 'unblock', function()
+            cond:broadcast()
+        end)
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+local function in_progress(cg)
+    return cg.server:exec(function() return _G.in_progress end)
+end
+
+-- Checks that a connection can't have more requests in progress than
+-- the limit while other connections are served.
+g.test_connection_msg_max = function(cg)
+    local conn = net.connect(cg.server.net_box_uri)
+    local futures = {}
+    for i = 1, 5 do
+        futures[i] = conn:call('block', {}, {is_async = true})
+    end
+    t.helpers.retrying({}, function()
+        t.assert_equals(in_progress(cg), 2)
+    end)
+    -- Other connections are not affected.
+    local conn2 = net.connect(cg.server.net_box_uri)
+    t.assert_equals(conn2:eval('return 1 + 1'), 2)
+    t.assert_equals(in_progress(cg), 2)
+    -- The rest of the requests are processed once the first complete.
+    cg.server:exec(function() _G.unblock() end)
+    t.helpers.retrying({}, function()
+        t.assert_equals(in_progress(cg), 2)
+        t.assert(futures[1]:is_ready())
+        t.assert(futures[2]:is_ready())
+    end)
+    -- Disabling the limit resumes the connection.
+    cg.server:exec(function()
+        box.cfg({net_msg_max_per_connection = 0})
+    end)
+    t.helpers.retrying({}, function()
+        t.assert_equals(in_progress(cg), 3)
+    end)
+    cg.server:exec(function() _G.unblock() end)
+    for i = 1, 5 do
+        local _, err = futures[i]:wait_result(10)
+        t.assert_equals(err, nil)
+    end
+    t.assert_equals(in_progress(cg), 0)
+    cg.server:exec(function()
+        box.cfg({net_msg_max_per_connection = 2})
+    end)
+    conn:close()
+    conn2:close()
+end
+
+g.test_invalid_cfg = function(cg)
+    cg.server:exec(function()
+        local msg = "Incorrect value for option " ..
+                    "'net_msg_max_per_connection': " ..
+                    "must be greater than or equal to 0"
+        t.assert_error_msg_equals(msg, box.cfg,
+                                  {net_msg_max_per_connection = -1})
+        msg = "Incorrect value for option 'net_msg_max_per_connection': " ..
+              "should be of type number"
+        t.assert_error_msg_equals(msg, box.cfg,
+                                  {net_msg_max_per_connection = 'x'})
+        t.assert_equals(box.cfg.net_msg_max_per_connection, 2)
+    end)
+end
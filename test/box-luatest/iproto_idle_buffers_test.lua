@@ -0,0 +1,45 @@
+local net = require('net.box')
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+local function idle_count(cg)
+    return cg.server:exec(function()
+        local stat = box.stat.net().BUFFERS
+        t.assert_equals(box.stat.net.thread[1].BUFFERS.idle, stat.idle)
+        t.assert_gt(stat.memory, 0)
+        return stat.idle
+    end)
+end
+
+g.test_idle_buffers = function(cg)
+    local count = 10
+    local conns = {}
+    for i = 1, count do
+        conns[i] = net.connect(cg.server.net_box_uri)
+        t.assert(conns[i]:ping())
+    end
+    -- Buffers are released after the connections stay idle for a while.
+    t.helpers.retrying({timeout = 10}, function()
+        t.assert_ge(idle_count(cg), count)
+    end)
+    local before = idle_count(cg)
+    -- Released buffers are allocated again on the next request.
+    for i = 1, count do
+        t.assert_equals(conns[i]:eval('return ...', {i}), i)
+    end
+    t.assert_le(idle_count(cg), before - count)
+    for i = 1, count do
+        conns[i]:close()
+    end
+end
@@ -0,0 +1,117 @@
+local net = require('net.box')
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new({box_cfg = {iproto_read_view_staleness = 10}})
+    cg.server:start()
+    cg.server:exec(function()
+        local s = box.schema.space.create('test', {iproto_read_view = true})
+        s:create_index('pk')
+        s:create_index('sk', {parts = {2, 'unsigned'}, unique = false})
+        s:insert({1, 10})
+        s = box.schema.space.create('fresh')
+        s:create_index('pk')
+        s:insert({1, 10})
+        box.schema.user.create('reader', {password = 'secret'})
+        box.schema.user.grant('reader', 'read', 'space', 'test')
+        box.schema.user.create('stranger', {password = 'secret'})
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.before_each(function(cg)
+    cg.conn = net.connect(cg.server.net_box_uri)
+end)
+
+g.after_each(function(cg)
+    cg.conn:close()
+    cg.server:exec(function()
+        box.space.test:replace({1, 10})
+        box.space.fresh:replace({1, 10})
+    end)
+end)
+
+-- Makes the server reopen the read view and waits until it is used.
+local function refresh_read_view(cg, expected)
+    cg.server:exec(function()
+        box.cfg({iproto_read_view_staleness = 10})
+    end)
+    t.helpers.retrying({}, function()
+        t.assert_equals(cg.conn.space.test:get(1), expected)
+    end)
+end
+
+g.test_stale_read = function(cg)
+    refresh_read_view(cg, {1, 10})
+    cg.server:exec(function()
+        box.space.test:replace({1, 20})
+        box.space.fresh:replace({1, 20})
+    end)
+    local s = cg.conn.space.test
+    t.assert_equals(s:get(1), {1, 10})
+    t.assert_equals(s:select({}, {iterator = 'GE'}), {{1, 10}})
+    t.assert_equals(s.index.sk:select({10}), {{1, 10}})
+    t.assert_equals(s.index.sk:select({20}), {})
+    t.assert_equals(cg.conn.space.fresh:get(1), {1, 20})
+
+    -- Requests of streams are executed in the tx thread.
+    local stream = cg.conn:new_stream()
+    t.assert_equals(stream.space.test:get(1), {1, 20})
+
+    refresh_read_view(cg, {1, 20})
+end
+
+g.test_option = function(cg)
+    cg.server:exec(function()
+        t.assert_equals(box.space.test.iproto_read_view, true)
+        t.assert_equals(box.space.fresh.iproto_read_view, false)
+        box.space.test:alter({iproto_read_view = false})
+        t.assert_equals(box.space.test.iproto_read_view, false)
+        box.space.test:replace({1, 20})
+    end)
+    refresh_read_view(cg, {1, 20})
+    cg.server:exec(function()
+        box.space.test:alter({iproto_read_view = true})
+    end)
+end
+
+g.test_access = function(cg)
+    refresh_read_view(cg, {1, 10})
+    local conn = net.connect(cg.server.net_box_uri,
+                             {user = 'reader', password = 'secret'})
+    t.assert_equals(conn.space.test:get(1), {1, 10})
+    conn:close()
+    conn = net.connect(cg.server.net_box_uri,
+                       {user = 'stranger', password = 'secret'})
+    t.assert_error_msg_equals(
+        "Read access to space 'test' is denied for user 'stranger'",
+        conn.space.test.get, conn.space.test, 1)
+    conn:close()
+end
+
+g.test_errors = function(cg)
+    refresh_read_view(cg, {1, 10})
+    local s = cg.conn.space.test
+    t.assert_error_msg_equals(
+        "Supplied key type of part 0 does not match index part type: " ..
+        "expected unsigned", s.get, s, 'x')
+    t.assert_error_msg_contains(
+        "does not support requested iterator type",
+        s.select, s, {1}, {iterator = 'BITS_ALL_SET'})
+end
+
+g.test_invalid_cfg = function(cg)
+    cg.server:exec(function()
+        t.assert_error_msg_equals(
+            "Incorrect value for option 'iproto_read_view_staleness': " ..
+            "must be greater than or equal to 0",
+            box.cfg, {iproto_read_view_staleness = -1})
+        t.assert_equals(box.cfg.iproto_read_view_staleness, 10)
+    end)
+end
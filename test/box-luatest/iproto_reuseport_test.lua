@@ -0,0 +1,70 @@
+local net = require('net.box')
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    t.skip_if(jit.os ~= 'Linux', 'SO_REUSEPORT balancing is Linux-only')
+    cg.server = server:new({
+        box_cfg = {iproto_threads = 4, iproto_reuseport = true},
+    })
+    cg.server:start()
+    cg.uri = cg.server:exec(function()
+        box.cfg{listen = {box.cfg.listen, '127.0.0.1:0'}}
+        return box.info.listen[2]
+    end)
+end)
+
+g.after_all(function(cg)
+    if cg.server ~= nil then
+        cg.server:drop()
+    end
+end)
+
+local function check_connections(cg)
+    local COUNT = 40
+    local conns = {}
+    for i = 1, COUNT do
+        conns[i] = net.connect(cg.uri)
+        t.assert(conns[i]:ping())
+    end
+    -- Connections are spread among threads by the kernel.
+    cg.server:exec(function(COUNT)
+        local total = 0
+        local busy = 0
+        for i = 1, box.cfg.iproto_threads do
+            local count = box.stat.net.thread[i].CONNECTIONS.current
+            total = total + count
+            if count > 0 then
+                busy = busy + 1
+            end
+        end
+        t.assert_ge(total, COUNT)
+        t.assert_gt(busy, 1)
+    end, {COUNT})
+    for i = 1, COUNT do
+        conns[i]:close()
+    end
+end
+
+g.test_reuseport = function(cg)
+    check_connections(cg)
+    -- The UNIX socket is shared by all threads.
+    local conn = net.connect(cg.server.net_box_uri)
+    t.assert(conn:ping())
+    conn:close()
+    -- The thread sockets are recreated on reconfiguration.
+    cg.server:exec(function()
+        box.cfg{listen = box.cfg.listen}
+    end)
+    check_connections(cg)
+end
+
+g.test_static = function(cg)
+    cg.server:exec(function()
+        t.assert_error_msg_equals(
+            "Can't set option 'iproto_reuseport' dynamically",
+            box.cfg, {iproto_reuseport = false})
+    end)
+end
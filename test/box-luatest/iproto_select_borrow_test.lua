@@ -0,0 +1,57 @@
+local net = require('net.box')
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group('iproto-select-borrow', t.helpers.matrix({
+    mvcc = {false, true},
+}))
+
+g.before_all(function(cg)
+    cg.server = server:new({
+        box_cfg = {memtx_use_mvcc_engine = cg.params.mvcc},
+    })
+    cg.server:start()
+    cg.server:exec(function()
+        local s = box.schema.space.create('test')
+        s:create_index('pk')
+        for i = 1, 1000 do
+            s:insert({i, string.rep('x', i % 100)})
+        end
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+-- Tuples selected over iproto from a memtx space aren't referenced, check
+-- that concurrent writes don't break the result.
+g.test_select = function(cg)
+    local conn = net.connect(cg.server.net_box_uri)
+    local s = conn.space.test
+    local fibers = {}
+    for i = 1, 10 do
+        fibers[i] = require('fiber').new(function()
+            for j = 1, 100 do
+                local id = (i - 1) * 100 + j
+                s:replace({id, string.rep('y', j % 100)}, {is_async = true})
+            end
+        end)
+        fibers[i]:set_joinable(true)
+    end
+    for _ = 1, 10 do
+        local res = s:select({}, {limit = 1000})
+        t.assert_equals(#res, 1000)
+        for i, tuple in ipairs(res) do
+            t.assert_equals(tuple[1], i)
+            t.assert_equals(#tuple[2], i % 100)
+        end
+    end
+    for _, f in ipairs(fibers) do
+        f:join()
+    end
+    local res = s:select({500}, {iterator = 'ge', limit = 3,
+                                 fields = {1}})
+    t.assert_equals(res, {{500}, {501}, {502}})
+    conn:close()
+end
@@ -0,0 +1,147 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+    cg.server:exec(function()
+        local fio = require('fio')
+        rawset(_G, 'write_csv', function(text)
+            local dir = rawget(_G, 'csv_dir')
+            if dir == nil then
+                dir = fio.tempdir()
+                rawset(_G, 'csv_dir', dir)
+            end
+            local path = fio.pathjoin(dir, 'data.csv')
+            local f = fio.open(path, {'O_WRONLY', 'O_CREAT', 'O_TRUNC'},
+                               tonumber('644', 8))
+            f:write(text)
+            f:close()
+            return path
+        end)
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:exec(function()
+        require('fio').rmtree(rawget(_G, 'csv_dir'))
+    end)
+    cg.server:drop()
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        if box.space.test ~= nil then
+            box.space.test:drop()
+        end
+    end)
+end)
+
+-- Checks that values are converted according to the space format.
+g.test_types = function(cg)
+    cg.server:exec(function()
+        local varbinary = require('varbinary')
+        local s = box.schema.space.create('test', {format = {
+            {'id', 'unsigned'}, {'i', 'integer'}, {'n', 'number'},
+            {'d', 'double'}, {'b', 'boolean'}, {'s', 'string'},
+            {'v', 'varbinary'}, {'sc', 'scalar'},
+            {'o', 'string', is_nullable = true},
+        }})
+        s:create_index('pk')
+        local path = _G.write_csv(
+            'id,i,n,d,b,s,v,sc,o\n' ..
+            '1,-5,10,1.5,true,"a,b",bin,42,\n' ..
+            '\n' ..
+            '2,7,-0.25,3,FALSE,"say ""hi""",,str,x,extra\n')
+        t.assert_equals(s:load_csv(path, {skip_head_lines = 1}), 2)
+        t.assert_equals(s:select(), {
+            {1, -5, 10, 1.5, true, 'a,b', varbinary.new('bin'), 42,
+             box.NULL},
+            {2, 7, -0.25, 3, false, 'say "hi"', varbinary.new(''), 'str',
+             'x', 'extra'},
+        })
+        t.assert_equals(type(s:get(1)[8]), 'number')
+        t.assert_equals(type(s:get(2)[4]), 'number')
+    end)
+end
+
+-- Checks the delimiter, quote_char and mode options.
+g.test_options = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test')
+        s:create_index('pk', {parts = {1, 'unsigned'}})
+        local path = _G.write_csv("1;'a;b'\n2;c\n")
+        t.assert_equals(s:load_csv(path, {delimiter = ';',
+                                          quote_char = "'"}), 2)
+        t.assert_equals(s:select(), {{1, 'a;b'}, {2, 'c'}})
+        path = _G.write_csv('2,d\n3,e\n')
+        t.assert_error_msg_contains('Duplicate key exists', s.load_csv,
+                                    s, path)
+        t.assert_equals(s:load_csv(path, {mode = 'replace'}), 2)
+        t.assert_equals(s:select(), {{1, 'a;b'}, {2, 'd'}, {3, 'e'}})
+    end)
+end
+
+-- Checks that a file spanning many chunks is loaded completely.
+g.test_many_chunks = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test')
+        s:create_index('pk', {parts = {1, 'unsigned'}})
+        local lines = {}
+        for i = 1, 10000 do
+            lines[i] = string.format('%d,"value %d"', i, i)
+        end
+        local path = _G.write_csv(table.concat(lines, '\n'))
+        t.assert_equals(s:load_csv(path, {chunk_size = 100}), 10000)
+        t.assert_equals(s:count(), 10000)
+        t.assert_equals(s:get(1), {1, 'value 1'})
+        t.assert_equals(s:get(5000), {5000, 'value 5000'})
+        t.assert_equals(s:get(10000), {10000, 'value 10000'})
+    end)
+end
+
+-- Checks errors.
+g.test_errors = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test', {format = {
+            {'id', 'unsigned'}, {'d', 'decimal', is_nullable = true},
+        }})
+        s:create_index('pk')
+        t.assert_error_msg_equals(
+            "Failed to load CSV: field 2 has type 'decimal' " ..
+            "that is not supported",
+            s.load_csv, s, _G.write_csv('1\n'))
+        s:format({{'id', 'unsigned'}})
+
+        t.assert_error_msg_equals(
+            "Illegal parameters, Usage: space:load_csv(path[, opts])",
+            s.load_csv, s)
+        t.assert_error_msg_contains(
+            "Illegal parameters, options parameter 'mode' should be " ..
+            "of type string", s.load_csv, s, 'x', {mode = 1})
+        t.assert_error_msg_contains(
+            "mode must be 'insert' or 'replace'",
+            s.load_csv, s, 'x', {mode = 'upsert'})
+        t.assert_error_msg_contains(
+            "delimiter must be a single character",
+            s.load_csv, s, 'x', {delimiter = ',,'})
+        t.assert_error_msg_contains(
+            "failed to open", s.load_csv, s, '/no/such/file.csv')
+
+        -- Records preceding a bad one are loaded.
+        local path = _G.write_csv('1,a\n2,b\nthree,c\n4,d\n')
+        t.assert_error_msg_equals(
+            "Failed to load CSV at record 3: field 1: expected unsigned",
+            s.load_csv, s, path)
+        t.assert_equals(s:select(), {{1, 'a'}, {2, 'b'}})
+        s:truncate()
+
+        path = _G.write_csv('1,a\n2,"b\n')
+        t.assert_error_msg_equals(
+            "Failed to load CSV at record 2: invalid CSV",
+            s.load_csv, s, path)
+        t.assert_equals(s:select(), {{1, 'a'}})
+    end)
+end
@@ -0,0 +1,68 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        if box.space.test ~= nil then
+            box.space.test:drop()
+        end
+        if box.func.key ~= nil then
+            box.func.key:drop()
+        end
+    end)
+end)
+
+-- Secondary indexes are built from the primary index on recovery in
+-- batches. Checks that functional and multikey indexes built this way
+-- contain all the keys, including the tuples of an incomplete batch.
+g.test_recovery = function(cg)
+    cg.server:exec(function()
+        box.schema.func.create('key', {
+            body = [[function(tuple)
+                if tuple[1] % 3 == 0 then
+                    return {}
+                end
+                return {{tuple[1] * 2}, {tuple[1] * 2 + 1}}
+            end]],
+            is_deterministic = true,
+            is_sandboxed = true,
+            opts = {is_multikey = true},
+        })
+        local s = box.schema.space.create('test')
+        s:create_index('pk')
+        s:create_index('func', {func = 'key', parts = {{1, 'unsigned'}}})
+        s:create_index('mk', {
+            unique = false,
+            parts = {{'[2][*]', 'unsigned', is_nullable = true,
+                      exclude_null = true}},
+        })
+        for i = 1, 2500 do
+            s:insert({i, {i, box.NULL, i + 10000}})
+        end
+        box.snapshot()
+    end)
+    cg.server:restart()
+    cg.server:exec(function()
+        local s = box.space.test
+        -- 833 of the tuples have no keys in the functional index.
+        t.assert_equals(s.index.func:len(), (2500 - 833) * 2)
+        t.assert_equals(s.index.mk:len(), 5000)
+        for _, i in ipairs({1, 1024, 1025, 2048, 2500}) do
+            t.assert_equals(s.index.func:get(i * 2 + 1)[1], i)
+            t.assert_equals(s.index.mk:select(i + 10000), {s:get(i)})
+        end
+        t.assert_equals(s.index.func:get(2 * 3), nil)
+        t.assert_equals(s.index.mk:select(3), {s:get(3)})
+    end)
+end
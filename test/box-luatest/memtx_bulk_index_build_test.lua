@@ -0,0 +1,122 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group(nil, {
+    {memtx_use_mvcc_engine = true},
+    {memtx_use_mvcc_engine = false},
+})
+
+g.before_all(function(cg)
+    cg.server = server:new({
+        box_cfg = {
+            memtx_use_mvcc_engine = cg.params.memtx_use_mvcc_engine,
+        },
+    })
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        if box.space.test ~= nil then
+            box.space.test:drop()
+        end
+    end)
+end)
+
+-- Check that changes made while a non-unique index is being built make
+-- it to the index.
+g.test_concurrent_changes = function(cg)
+    cg.server:exec(function()
+        local fiber = require('fiber')
+        local s = box.schema.space.create('test')
+        s:create_index('pk')
+        local count = 5000
+        box.begin()
+        for i = 1, count do
+            s:insert({i, i % 100, {i % 7, i % 11}})
+        end
+        box.commit()
+        local done = false
+        local f = fiber.create(function()
+            local i = 0
+            while not done do
+                i = i + 1
+                local id = math.random(count + 1000)
+                local op = i % 4
+                if op == 0 then
+                    s:delete(id)
+                elseif op == 1 then
+                    s:replace({id, math.random(100), {i % 5}})
+                elseif op == 2 then
+                    box.begin()
+                    s:replace({id, 1000, {}})
+                    box.rollback()
+                else
+                    s:upsert({id, 0, {}}, {{'+', 2, 1}})
+                end
+                fiber.yield()
+            end
+        end)
+        f:set_joinable(true)
+        s:create_index('sk', {parts = {2, 'unsigned'}, unique = false})
+        s:create_index('mk', {parts = {{'[3][*]', 'unsigned'}},
+                              unique = false})
+        done = true
+        f:join()
+        local expected = s:select()
+        table.sort(expected, function(a, b)
+            if a[2] ~= b[2] then
+                return a[2] < b[2]
+            end
+            return a[1] < b[1]
+        end)
+        t.assert_equals(s.index.sk:select(), expected)
+        t.assert_equals(s.index.sk:len(), s:len())
+        local expected_mk = {}
+        for _, tuple in s:pairs() do
+            for _, v in ipairs(tuple[3]) do
+                expected_mk[v] = expected_mk[v] or {}
+                expected_mk[v][tuple[1]] = true
+            end
+        end
+        local actual_mk = {}
+        for _, tuple in s.index.mk:pairs() do
+            for _, v in ipairs(tuple[3]) do
+                actual_mk[v] = actual_mk[v] or {}
+                actual_mk[v][tuple[1]] = true
+            end
+        end
+        t.assert_equals(actual_mk, expected_mk)
+        local len = 0
+        for _, ids in pairs(expected_mk) do
+            for _ in pairs(ids) do
+                len = len + 1
+            end
+        end
+        t.assert_equals(s.index.mk:len(), len)
+    end)
+end
+
+g.test_errors = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test')
+        s:create_index('pk')
+        for i = 1, 100 do
+            s:insert({i, i})
+        end
+        s:insert({101, 'x'})
+        t.assert_error_msg_content_equals(
+            "Tuple field 2 type does not match one required by " ..
+            "operation: expected unsigned, got string",
+            s.create_index, s, 'sk', {parts = {2, 'unsigned'},
+                                      unique = false})
+        t.assert_equals(s.index.sk, nil)
+        s:delete(101)
+        s:create_index('sk', {parts = {2, 'unsigned'}, unique = false})
+        t.assert_equals(s.index.sk:len(), 100)
+    end)
+end
@@ -0,0 +1,60 @@
+local fio = require('fio')
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new({box_cfg = {checkpoint_count = 1}})
+    cg.server:start()
+    cg.server:exec(function()
+        local s = box.schema.space.create('test')
+        s:create_index('pk')
+        for i = 1, 1000 do
+            s:insert({i, string.rep('x', 1000)})
+        end
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+-- Makes a snapshot and returns its size.
+local function snapshot(cg, compression)
+    local signature = cg.server:exec(function(compression)
+        box.cfg({memtx_checkpoint_compression = compression})
+        box.space.test:replace({0, compression})
+        box.snapshot()
+        local checkpoints = box.info.gc().checkpoints
+        return checkpoints[#checkpoints].signature
+    end, {compression})
+    local path = fio.pathjoin(cg.server.workdir,
+                              string.format('%020d.snap', signature))
+    return fio.stat(path).size
+end
+
+g.test_uncompressed_snapshot = function(cg)
+    local compressed_size = snapshot(cg, true)
+    local uncompressed_size = snapshot(cg, false)
+    t.assert_lt(compressed_size, 1000 * 1000)
+    t.assert_gt(uncompressed_size, 1000 * 1000)
+
+    -- The uncompressed snapshot is recovered.
+    cg.server:restart()
+    cg.server:exec(function()
+        local s = box.space.test
+        t.assert_equals(s:count(), 1001)
+        t.assert_equals(s:get(0), {0, false})
+        t.assert_equals(s:get(1000), {1000, string.rep('x', 1000)})
+    end)
+end
+
+g.test_invalid_cfg = function(cg)
+    cg.server:exec(function()
+        t.assert_error_msg_equals(
+            "Incorrect value for option 'memtx_checkpoint_compression': " ..
+            "should be of type boolean",
+            box.cfg, {memtx_checkpoint_compression = 1})
+    end)
+end
@@ -0,0 +1,56 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new({box_cfg = {
+        checkpoint_count = 1,
+        memtx_checkpoint_direct_io = true,
+    }})
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.before_test('test_direct_io_snapshot', function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test')
+        s:create_index('pk')
+        -- Rows of different size, some bigger than a block.
+        for i = 1, 1000 do
+            s:insert({i, string.rep('x', i * 7)})
+        end
+    end)
+end)
+
+g.test_direct_io_snapshot = function(cg)
+    for _, compression in ipairs({false, true}) do
+        cg.server:exec(function(compression)
+            box.cfg({memtx_checkpoint_compression = compression})
+            box.space.test:replace({0, compression})
+            box.snapshot()
+        end, {compression})
+
+        -- The snapshot is recovered.
+        cg.server:restart()
+        cg.server:exec(function(compression)
+            local s = box.space.test
+            t.assert_equals(box.cfg.memtx_checkpoint_direct_io, true)
+            t.assert_equals(s:count(), 1001)
+            t.assert_equals(s:get(0), {0, compression})
+            t.assert_equals(s:get(1000), {1000, string.rep('x', 7000)})
+        end, {compression})
+    end
+end
+
+g.test_invalid_cfg = function(cg)
+    cg.server:exec(function()
+        t.assert_error_msg_equals(
+            "Incorrect value for option 'memtx_checkpoint_direct_io': " ..
+            "should be of type boolean",
+            box.cfg, {memtx_checkpoint_direct_io = 1})
+    end)
+end
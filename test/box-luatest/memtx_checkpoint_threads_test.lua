@@ -0,0 +1,212 @@
+local fio = require('fio')
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+local function snap_files(cg)
+    local files = fio.glob(fio.pathjoin(cg.server.workdir, '*.snap'))
+    table.sort(files)
+    for i, f in ipairs(files) do
+        files[i] = fio.basename(f)
+    end
+    return files
+end
+
+local function last_signature(cg)
+    return cg.server:exec(function()
+        local checkpoints = box.info.gc().checkpoints
+        return checkpoints[#checkpoints].signature
+    end)
+end
+
+local function fill_spaces(cg)
+    cg.server:exec(function()
+        for i = 1, 5 do
+            local s = box.schema.space.create('test' .. i)
+            s:create_index('pk')
+            s:create_index('sk', {parts = {2, 'unsigned'}})
+            box.begin()
+            for j = 1, i * 100 do
+                s:insert({j, j * 10, string.rep('x', i)})
+            end
+            box.commit()
+        end
+    end)
+end
+
+local function check_spaces(cg)
+    cg.server:exec(function()
+        for i = 1, 5 do
+            local s = box.space['test' .. i]
+            t.assert_equals(s:count(), i * 100)
+            t.assert_equals(s.index.sk:get(i * 1000), {i * 100, i * 1000,
+                                                       string.rep('x', i)})
+        end
+    end)
+end
+
+g.before_all(function(cg)
+    cg.server = server:new({
+        box_cfg = {
+            memtx_checkpoint_threads = 3,
+            checkpoint_count = 1,
+        },
+    })
+    cg.server:start()
+    fill_spaces(cg)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.test_partitioned_snapshot = function(cg)
+    cg.server:exec(function()
+        box.cfg({memtx_checkpoint_threads = 3})
+        box.space.test1:replace({1, 10, 'x'})
+        box.snapshot()
+    end)
+
+    -- User spaces are written to 3 partition files.
+    local name = string.format('%020d', last_signature(cg))
+    t.helpers.retrying({}, function()
+        t.assert_equals(snap_files(cg), {
+            name .. '.1.snap', name .. '.2.snap', name .. '.3.snap',
+            name .. '.snap',
+        })
+    end)
+
+    -- Partitions are included into backup.
+    local backup = cg.server:exec(function()
+        local files = box.backup.start()
+        box.backup.stop()
+        return files
+    end)
+    for _, f in ipairs(snap_files(cg)) do
+        t.assert_items_include(backup, {fio.pathjoin(cg.server.workdir, f)})
+    end
+
+    -- The data is recovered from partitions.
+    cg.server:restart()
+    check_spaces(cg)
+
+    -- Partitions of old snapshots are garbage collected.
+    cg.server:exec(function()
+        box.space.test1:replace({1, 1})
+        box.snapshot()
+    end)
+    name = string.format('%020d', last_signature(cg))
+    t.helpers.retrying({}, function()
+        t.assert_equals(snap_files(cg), {
+            name .. '.1.snap', name .. '.2.snap', name .. '.3.snap',
+            name .. '.snap',
+        })
+    end)
+
+    -- With a single thread, the snapshot isn't partitioned.
+    cg.server:exec(function()
+        box.cfg({memtx_checkpoint_threads = 1})
+        box.space.test1:replace({1, 10, 'x'})
+        box.snapshot()
+    end)
+    name = string.format('%020d', last_signature(cg))
+    t.helpers.retrying({}, function()
+        t.assert_equals(snap_files(cg), {name .. '.snap'})
+    end)
+    cg.server:restart()
+    check_spaces(cg)
+end
+
+g.test_missing_partition = function(cg)
+    cg.server:exec(function()
+        box.cfg({memtx_checkpoint_threads = 2})
+        box.space.test2:replace({1, 10, 'xx'})
+        box.snapshot()
+    end)
+    local name = string.format('%020d', last_signature(cg))
+    cg.server:stop()
+    local path = fio.pathjoin(cg.server.workdir, name .. '.2.snap')
+    local moved = path .. '.bak'
+    t.assert(fio.rename(path, moved))
+    cg.server:start({wait_until_ready = false})
+    local log = fio.pathjoin(cg.server.workdir, cg.server.alias .. '.log')
+    t.helpers.retrying({}, function()
+        t.assert(cg.server:grep_log(name .. '.2.snap', nil,
+                                    {filename = log}))
+        t.assert(cg.server:grep_log("can't initialize storage", nil,
+                                    {filename = log}))
+    end)
+    cg.server:stop()
+    t.assert(fio.rename(moved, path))
+    cg.server:start()
+    check_spaces(cg)
+end
+
+-- Checks that files of partitions that haven't changed since the last
+-- snapshot are reused.
+g.test_clean_partitions = function(cg)
+    local function partition_inodes()
+        local name = string.format('%020d', last_signature(cg))
+        local inodes = {}
+        for i = 1, 2 do
+            local path = fio.pathjoin(cg.server.workdir,
+                                      name .. '.' .. i .. '.snap')
+            inodes[i] = fio.stat(path).inode
+        end
+        return inodes
+    end
+    local function count_reused(old, new)
+        local count = 0
+        for i = 1, 2 do
+            if old[i] == new[i] then
+                count = count + 1
+            end
+        end
+        return count
+    end
+
+    cg.server:exec(function()
+        box.cfg({memtx_checkpoint_threads = 2})
+        box.space.test1:replace({1, 10, 'x'})
+        box.snapshot()
+    end)
+    local old = partition_inodes()
+
+    -- Only the partition storing the changed space is rewritten.
+    cg.server:exec(function()
+        box.space.test1:replace({1, 10, 'x'})
+        box.snapshot()
+    end)
+    local new = partition_inodes()
+    t.assert_equals(count_reused(old, new), 1)
+
+    -- A new space is placed to a partition, which is rewritten.
+    cg.server:exec(function()
+        local s = box.schema.space.create('test6')
+        s:create_index('pk')
+        s:insert({1})
+        box.snapshot()
+    end)
+    old = new
+    new = partition_inodes()
+    t.assert_equals(count_reused(old, new), 1)
+
+    -- Reused partitions are recovered.
+    cg.server:restart()
+    check_spaces(cg)
+    cg.server:exec(function()
+        t.assert_equals(box.space.test6:select(), {{1}})
+        box.space.test6:drop()
+    end)
+end
+
+g.test_invalid_cfg = function(cg)
+    cg.server:exec(function()
+        local msg = "Incorrect value for option 'memtx_checkpoint_threads': " ..
+                    "must be greater than 0 and less than or equal to 64"
+        t.assert_error_msg_equals(msg, box.cfg, {memtx_checkpoint_threads = 0})
+        t.assert_error_msg_equals(msg, box.cfg,
+                                  {memtx_checkpoint_threads = 65})
+    end)
+end
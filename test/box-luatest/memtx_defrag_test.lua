@@ -0,0 +1,72 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group('memtx-defrag', t.helpers.matrix({mvcc = {false, true}}))
+
+g.before_all(function(cg)
+    cg.server = server:new({
+        box_cfg = {memtx_use_mvcc_engine = cg.params.mvcc},
+    })
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        box.cfg{memtx_defrag_threshold = 0}
+        if box.space.test ~= nil then
+            box.space.test:drop()
+        end
+    end)
+end)
+
+g.test_defrag = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test')
+        s:create_index('pk')
+        s:create_index('sk', {parts = {2, 'unsigned'}, unique = false})
+        for i = 1, 100000 do
+            s:insert({i, i % 100, string.rep('x', 100)})
+        end
+        for i = 1, 100000 do
+            if i % 10 ~= 0 then
+                s:delete(i)
+            end
+        end
+        -- A tuple held by Lua mustn't be moved.
+        local held = s:get(10)
+
+        local function ratio()
+            local info = box.slab.info()
+            return info.items_used / info.items_size
+        end
+        local before = ratio()
+        box.cfg{memtx_defrag_threshold = 0.9}
+        t.helpers.retrying({timeout = 60}, function()
+            t.assert_gt(ratio(), before)
+        end)
+
+        t.assert_equals(held:totable(), {10, 10, string.rep('x', 100)})
+        t.assert_equals(s:count(), 10000)
+        t.assert_equals(s.index.sk:count(0), 1000)
+        for i = 10, 100000, 10 do
+            t.assert_equals(s:get(i):totable(),
+                            {i, i % 100, string.rep('x', 100)})
+        end
+    end)
+end
+
+g.test_cfg = function(cg)
+    cg.server:exec(function()
+        t.assert_equals(box.cfg.memtx_defrag_threshold, 0)
+        t.assert_error_msg_equals(
+            "Incorrect value for option 'memtx_defrag_threshold': " ..
+            "must be greater than or equal to 0 and less than or equal to 1",
+            box.cfg, {memtx_defrag_threshold = 2})
+        box.cfg{memtx_defrag_threshold = 0.5}
+        t.assert_equals(box.cfg.memtx_defrag_threshold, 0.5)
+    end)
+end
@@ -0,0 +1,97 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group('memtx-evict', t.helpers.matrix({mvcc = {false, true}}))
+
+g.before_all(function(cg)
+    cg.server = server:new({
+        box_cfg = {
+            memtx_memory = 64 * 1024 * 1024,
+            memtx_use_mvcc_engine = cg.params.mvcc,
+        },
+    })
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        box.cfg{memtx_evict_threshold = 0.9}
+        if box.space.test ~= nil then
+            box.space.test:drop()
+        end
+    end)
+end)
+
+g.test_evict = function(cg)
+    cg.server:exec(function()
+        local fiber = require('fiber')
+        local s = box.schema.space.create('test', {cache = true})
+        t.assert_equals(s.cache, true)
+        s:create_index('pk')
+        local payload = string.rep('x', 1000)
+        local hot = 100
+        for i = 1, hot do
+            s:insert({i, payload})
+        end
+        -- Insert about 3 times memtx_memory worth of data reading the hot
+        -- tuples in between. Insertions may fail until the eviction fiber
+        -- catches up.
+        local count = 200000
+        for i = hot + 1, count do
+            local ok, err
+            for _ = 1, 100 do
+                ok, err = pcall(s.insert, s, {i, payload})
+                if ok or err.code ~= box.error.MEMORY_ISSUE then
+                    break
+                end
+                fiber.sleep(0.01)
+            end
+            t.assert(ok, err)
+            if i % 1000 == 0 then
+                for j = 1, hot do
+                    s:get(j)
+                end
+                fiber.sleep(0)
+            end
+        end
+        t.assert_lt(s:len(), count)
+        local hot_left = 0
+        for j = 1, hot do
+            if s:get(j) ~= nil then
+                hot_left = hot_left + 1
+            end
+        end
+        t.assert_gt(hot_left, hot / 2)
+        -- The space remains consistent.
+        t.assert_equals(s:count(), #s:select({}, {limit = count}))
+    end)
+end
+
+g.test_not_cache = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test')
+        t.assert_equals(s.cache, false)
+        s:create_index('pk')
+        box.cfg{memtx_evict_threshold = 0.01}
+        s:insert({1})
+        require('fiber').sleep(0.5)
+        t.assert_equals(s:len(), 1)
+    end)
+end
+
+g.test_cfg = function(cg)
+    cg.server:exec(function()
+        t.assert_equals(box.cfg.memtx_evict_threshold, 0.9)
+        t.assert_error_msg_equals(
+            "Incorrect value for option 'memtx_evict_threshold': " ..
+            "must be greater than or equal to 0 and less than or equal to 1",
+            box.cfg, {memtx_evict_threshold = 2})
+        t.assert_error_msg_content_equals(
+            "Vinyl does not support cache mode",
+            box.schema.space.create, 'test', {engine = 'vinyl', cache = true})
+    end)
+end
@@ -0,0 +1,117 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        if box.space.test ~= nil then
+            box.space.test:drop()
+        end
+    end)
+end)
+
+g.test_invalid = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test')
+        t.assert_error_msg_content_equals(
+            "Wrong index options: hash_func must be one of " ..
+            "'murmur', 'wyhash' or 'xxh3'",
+            s.create_index, s, 'pk', {type = 'hash', hash_func = 'foo'})
+        t.assert_error_msg_content_equals(
+            "Can't create or modify index 'pk' in space 'test': " ..
+            "hash_func is only reasonable with memtx hash index",
+            s.create_index, s, 'pk', {type = 'tree', hash_func = 'wyhash'})
+        s:drop()
+        s = box.schema.space.create('test', {engine = 'vinyl'})
+        t.assert_error_msg_content_equals(
+            "Can't create or modify index 'pk' in space 'test': " ..
+            "hash_func is only reasonable with memtx hash index",
+            s.create_index, s, 'pk', {hash_func = 'murmur'})
+    end)
+end
+
+local function check_hash_func(cg, hash_func)
+    cg.server:exec(function(hash_func)
+        local ffi = require('ffi')
+        local s = box.schema.space.create('test')
+        s:create_index('pk', {type = 'hash', hash_func = hash_func})
+        s:create_index('i1', {
+            type = 'hash', hash_func = hash_func,
+            parts = {{2, 'integer'}, {3, 'unsigned'}},
+        })
+        s:create_index('i2', {
+            type = 'hash', hash_func = string.upper(hash_func),
+            parts = {{4, 'string'}, {5, 'number'}},
+        })
+        s:create_index('i3', {
+            type = 'hash', hash_func = hash_func,
+            parts = {{4, 'string', collation = 'unicode_ci'}, {6, 'double'}},
+        })
+        local str = string.rep('x', 100)
+        for i = 1, 100 do
+            s:insert({i, -i, i, str .. i, i + 0.5, i})
+        end
+        -- The same values are found regardless of their encoding.
+        for i = 1, 100 do
+            t.assert_equals(s:get(i)[1], i)
+            t.assert_equals(s.index.i1:get({-i, i})[1], i)
+            t.assert_equals(s.index.i1:get({-i, 1ULL * i})[1], i)
+            t.assert_equals(s.index.i2:get({str .. i, i + 0.5})[1], i)
+            t.assert_equals(s.index.i3:get(
+                {string.upper(str .. i), ffi.cast('double', i)})[1], i)
+        end
+        s:replace({1, 1, 1, 'a', 1, ffi.cast('double', 1)})
+        t.assert_equals(s.index.i2:get({'a', ffi.cast('double', 1)})[1], 1)
+        t.assert_equals(s.index.i3:get({'A', 1})[1], 1)
+        t.assert_equals(s.index.i1:get({-1, 1}), nil)
+        t.assert_equals(s:len(), 100)
+        -- Changing the hash function rebuilds the index.
+        s.index.i1:alter({hash_func = 'murmur'})
+        t.assert_equals(s.index.i1:get({-2, 2})[1], 2)
+        s.index.i1:alter({hash_func = hash_func})
+        t.assert_equals(s.index.i1:get({-2, 2})[1], 2)
+        local opts = box.space._index.index.name:get({s.id, 'i1'}).opts
+        t.assert_equals(opts.hash_func, hash_func)
+    end, {hash_func})
+end
+
+g.test_wyhash = function(cg)
+    check_hash_func(cg, 'wyhash')
+end
+
+g.test_xxh3 = function(cg)
+    check_hash_func(cg, 'xxh3')
+end
+
+g.test_recovery = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test')
+        s:create_index('pk', {type = 'hash', hash_func = 'wyhash',
+                              parts = {{1, 'string'}, {2, 'int32'}}})
+        for i = 1, 100 do
+            s:insert({'k' .. i, -i})
+        end
+        box.snapshot()
+        for i = 101, 200 do
+            s:insert({'k' .. i, -i})
+        end
+    end)
+    cg.server:restart()
+    cg.server:exec(function()
+        local s = box.space.test
+        for i = 1, 200 do
+            t.assert_equals(s:get({'k' .. i, -i}), {'k' .. i, -i})
+        end
+        s:drop()
+    end)
+end
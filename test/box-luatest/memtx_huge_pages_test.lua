@@ -0,0 +1,42 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new({box_cfg = {memtx_use_huge_pages = true}})
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.test_huge_pages = function(cg)
+    cg.server:exec(function()
+        t.assert_equals(box.cfg.memtx_use_huge_pages, true)
+        t.assert_error_msg_equals(
+            "Can't set option 'memtx_use_huge_pages' dynamically",
+            box.cfg, {memtx_use_huge_pages = false})
+
+        local s = box.schema.space.create('test')
+        s:create_index('pk')
+        for i = 1, 10000 do
+            s:insert({i, string.rep('x', 100)})
+        end
+        local info = box.slab.info()
+        t.assert_type(info.huge_pages_used, 'number')
+        t.assert_le(info.huge_pages_used, box.cfg.memtx_memory)
+        s:drop()
+    end)
+end)
+
+g.test_huge_pages_disabled = function()
+    local s = server:new()
+    s:start()
+    s:exec(function()
+        t.assert_equals(box.cfg.memtx_use_huge_pages, false)
+        t.assert_equals(box.slab.info().huge_pages_used, nil)
+    end)
+    s:drop()
+end
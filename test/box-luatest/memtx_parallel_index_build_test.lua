@@ -0,0 +1,64 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new({box_cfg = {memtx_sort_threads = 4}})
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+-- Checks that secondary indexes built on recovery in parallel are the same
+-- as the ones built on the fly.
+g.test_recovery = function(cg)
+    local row_count = 50000
+    cg.server:exec(function(row_count)
+        local s = box.schema.space.create('test')
+        s:create_index('pk')
+        s:create_index('hinted', {parts = {2, 'unsigned'}, unique = false})
+        s:create_index('unhinted', {parts = {2, 'unsigned'}, unique = false,
+                                    hint = false})
+        s:create_index('string', {parts = {3, 'string'}})
+        s:create_index('exclude_null', {
+            parts = {{4, 'unsigned', is_nullable = true,
+                      exclude_null = true}},
+        })
+        s:create_index('multikey', {parts = {{'[5][*]', 'unsigned'}},
+                                    unique = false})
+        box.begin()
+        for i = 1, row_count do
+            s:insert({i, row_count - i, 'str' .. i,
+                      i % 2 == 0 and i or box.NULL, {i, i + 1}})
+        end
+        box.commit()
+        box.snapshot()
+    end, {row_count})
+
+    local function dump()
+        return cg.server:exec(function()
+            local s = box.space.test
+            local res = {}
+            for _, idx in pairs(s.index) do
+                if type(_) == 'string' then
+                    local keys = {}
+                    for _, tuple in idx:pairs() do
+                        table.insert(keys, tuple[1])
+                    end
+                    res[idx.name] = keys
+                end
+            end
+            return res
+        end)
+    end
+
+    local before = dump()
+    t.assert_equals(#before.pk, row_count)
+    t.assert_equals(#before.exclude_null, row_count / 2)
+    t.assert_equals(#before.multikey, row_count * 2)
+    cg.server:restart()
+    t.assert_equals(dump(), before)
+end
@@ -0,0 +1,65 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        if box.space.test ~= nil then
+            box.space.test:drop()
+        end
+    end)
+end)
+
+-- Checks that tuples with the same field offsets share the field map.
+g.test_shared_field_map = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test')
+        s:create_index('pk')
+        s:create_index('sk', {parts = {3, 'string'}})
+        -- The first tuple field map becomes the shared map candidate.
+        t.assert_equals(s:insert({1, 'a', 'x'}):info().field_map_size, 4)
+        t.assert_equals(s:insert({2, 'b', 'y'}):info().field_map_size, 0)
+        t.assert_equals(s:insert({3, 'cc', 'z'}):info().field_map_size, 4)
+        t.assert_equals(s:insert({4, 'd', 'w'}):info().field_map_size, 0)
+        t.assert_equals(s.index.sk:select(), {
+            {4, 'd', 'w'}, {1, 'a', 'x'}, {2, 'b', 'y'}, {3, 'cc', 'z'},
+        })
+        t.assert_equals(s.index.sk:get('y'), {2, 'b', 'y'})
+        s:delete(2)
+        t.assert_equals(s.index.sk:get('w'), {4, 'd', 'w'})
+        t.assert_equals(s:update(4, {{'=', 2, 'dd'}}):info().field_map_size,
+                        4)
+        t.assert_equals(s.index.sk:get('w'), {4, 'dd', 'w'})
+    end)
+end
+
+-- Checks that tuples with extents and big tuples don't use the shared map.
+g.test_not_shared = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test')
+        s:create_index('pk')
+        s:create_index('sk', {parts = {{'[2][*]', 'unsigned'}},
+                              unique = false})
+        s:insert({1, {1, 2}})
+        t.assert_gt(s:insert({2, {1, 2}}):info().field_map_size, 0)
+        t.assert_equals(s.index.sk:select(2), {{1, {1, 2}}, {2, {1, 2}}})
+        s:drop()
+        s = box.schema.space.create('test')
+        s:create_index('pk')
+        s:create_index('sk', {parts = {3, 'unsigned'}})
+        local data = string.rep('x', 2000)
+        s:insert({1, data, 1})
+        t.assert_equals(s:insert({2, data, 2}):info().field_map_size, 4)
+        t.assert_equals(s.index.sk:get(2), {2, data, 2})
+    end)
+end
@@ -0,0 +1,133 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    t.tarantool.skip_if_enterprise()
+    cg.server = server:new()
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    if cg.server ~= nil then
+        cg.server:drop()
+    end
+end)
+
+g.before_each(function(cg)
+    cg.server:exec(function()
+        local format = {
+            {name = 'id', type = 'unsigned'},
+            {name = 'data', type = 'string', compression = 'zstd'},
+            {name = 'tail', type = 'any', is_nullable = true},
+        }
+        local s = box.schema.space.create('test', {format = format})
+        s:create_index('pk')
+        s = box.schema.space.create('plain')
+        s:create_index('pk')
+    end)
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        if box.space.test ~= nil then
+            box.space.test:drop()
+        end
+        if box.space.plain ~= nil then
+            box.space.plain:drop()
+        end
+    end)
+end)
+
+g.test_compression = function(cg)
+    cg.server:exec(function()
+        for i = 1, 100 do
+            local data = string.rep('value' .. i, 100)
+            box.space.test:insert({i, data})
+            box.space.plain:insert({i, data})
+        end
+        t.assert_lt(box.space.test:bsize(), box.space.plain:bsize() / 10)
+        for i = 1, 100 do
+            t.assert_equals(box.space.test:get(i),
+                            box.space.plain:get(i))
+        end
+        t.assert_equals(box.space.test:select(),
+                        box.space.plain:select())
+        t.assert_equals(box.space.test:pairs():totable(),
+                        box.space.plain:select())
+    end)
+end
+
+g.test_small_fields = function(cg)
+    cg.server:exec(function()
+        box.space.test:insert({1, 'x'})
+        box.space.plain:insert({1, 'x'})
+        t.assert_equals(box.space.test:bsize(), box.space.plain:bsize())
+        t.assert_equals(box.space.test:get(1), {1, 'x'})
+    end)
+end
+
+g.test_update = function(cg)
+    cg.server:exec(function()
+        local s = box.space.test
+        local data = string.rep('x', 1000)
+        s:insert({1, data})
+        t.assert_equals(s:update(1, {{'=', 3, 'tail'}}), {1, data, 'tail'})
+        t.assert_equals(s:update(1, {{'=', 2, 'y'}}), {1, 'y', 'tail'})
+        t.assert_equals(s:replace({1, data}), {1, data})
+        s:upsert({1, data}, {{'=', 3, data}})
+        s:upsert({2, data}, {{'=', 3, data}})
+        t.assert_equals(s:get(1), {1, data, data})
+        t.assert_equals(s:get(2), {2, data})
+        t.assert_equals(s:delete(1), {1, data, data})
+        t.assert_equals(s:select(), {{2, data}})
+    end)
+end
+
+g.test_triggers = function(cg)
+    cg.server:exec(function()
+        local s = box.space.test
+        local data = string.rep('x', 1000)
+        local log = {}
+        s:on_replace(function(old, new)
+            table.insert(log, {old, new})
+        end)
+        s:insert({1, data})
+        s:replace({1, data .. data})
+        t.assert_equals(log, {
+            {nil, {1, data}},
+            {{1, data}, {1, data .. data}},
+        })
+    end)
+end
+
+g.test_index = function(cg)
+    cg.server:exec(function()
+        t.assert_error_msg_content_equals(
+            "Indexed field does not support compression",
+            box.space.test.create_index, box.space.test, 'sk',
+            {parts = {'data'}})
+    end)
+end
+
+g.test_recovery = function(cg)
+    cg.server:exec(function()
+        for i = 1, 100 do
+            box.space.test:insert({i, string.rep('value' .. i, 100)})
+        end
+        box.snapshot()
+        for i = 101, 200 do
+            box.space.test:insert({i, string.rep('value' .. i, 100)})
+        end
+    end)
+    cg.server:restart()
+    cg.server:exec(function()
+        local s = box.space.test
+        t.assert_equals(s:count(), 200)
+        for i = 1, 200 do
+            t.assert_equals(s:get(i), {i, string.rep('value' .. i, 100)})
+        end
+        t.assert_lt(s:bsize(), 200 * 600 / 10)
+    end)
+end
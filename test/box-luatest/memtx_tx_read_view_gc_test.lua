@@ -0,0 +1,63 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new{box_cfg = {memtx_use_mvcc_engine = true}}
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.before_each(function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test')
+        s:create_index('pk')
+        box.internal.memtx_tx_gc(100)
+    end)
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        box.space.test:drop()
+    end)
+end)
+
+-- Checks that stories retained by a read view are collected as soon as
+-- the read view is closed.
+g.test_read_view_stories_gc = function(cg)
+    cg.server:exec(function()
+        local fiber = require('fiber')
+        local s = box.space.test
+        for i = 1, 100 do
+            s:replace({i, 0})
+        end
+        box.internal.memtx_tx_gc(1000)
+        local rv_started = fiber.channel(1)
+        local rv_done = fiber.channel(1)
+        local f = fiber.new(function()
+            box.begin()
+            s:get(1)
+            rv_started:put(true)
+            rv_done:get()
+            box.commit()
+        end)
+        f:set_joinable(true)
+        rv_started:get()
+        for i = 1, 100 do
+            s:replace({i, 1})
+        end
+        -- Let the crawler find the stories retained by the read view.
+        box.internal.memtx_tx_gc(1000)
+        local stat = box.stat.memtx.tx().mvcc.tuples
+        t.assert_ge(stat.read_view.stories.count, 100)
+        rv_done:put(true)
+        t.assert(f:join())
+        stat = box.stat.memtx.tx().mvcc.tuples
+        t.assert_equals(stat.read_view.stories.count, 0)
+        t.assert_equals(s:select({}, {limit = 1}), {{1, 1}})
+    end)
+end
@@ -0,0 +1,103 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.before_each(function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test', {format = {
+            {'id', 'unsigned'},
+            {'counter', 'unsigned'},
+            {'value', 'number'},
+            {'name', 'string'},
+            {'key', 'string'},
+            {'dbl', 'double'},
+        }})
+        s:create_index('pk')
+        s:create_index('sk', {parts = {'key'}})
+    end)
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        box.space.test:drop()
+    end)
+end)
+
+-- Checks updates that don't change field sizes.
+g.test_update = function(cg)
+    cg.server:exec(function()
+        local s = box.space.test
+        s:insert({1, 10, 1.5, 'abc', 'k1', 1.5, 'tail'})
+        t.assert_equals(s:update(1, {{'+', 'counter', 1}}),
+                        {1, 11, 1.5, 'abc', 'k1', 1.5, 'tail'})
+        t.assert_equals(s:update(1, {{'-', 2, 1}, {'+', 3, 1},
+                                     {'=', 'name', 'xyz'}}),
+                        {1, 10, 2.5, 'xyz', 'k1', 1.5, 'tail'})
+        t.assert_equals(s:update(1, {{'=', 7, 'TAIL'}, {'+', 'dbl', 1}}),
+                        {1, 10, 2.5, 'xyz', 'k1', 2.5, 'TAIL'})
+        t.assert_equals(s:update(1, {{'&', 2, 3}}),
+                        {1, 2, 2.5, 'xyz', 'k1', 2.5, 'TAIL'})
+        t.assert_equals(s.index.sk:get('k1'),
+                        {1, 2, 2.5, 'xyz', 'k1', 2.5, 'TAIL'})
+        -- Changing the field size.
+        t.assert_equals(s:update(1, {{'+', 2, 1000}, {'=', 4, 'a'}}),
+                        {1, 1002, 2.5, 'a', 'k1', 2.5, 'TAIL'})
+        -- Changing an indexed field.
+        t.assert_equals(s:update(1, {{'=', 'key', 'k2'}}),
+                        {1, 1002, 2.5, 'a', 'k2', 2.5, 'TAIL'})
+        t.assert_equals(s.index.sk:get('k1'), nil)
+        t.assert_equals(s.index.sk:get('k2'),
+                        {1, 1002, 2.5, 'a', 'k2', 2.5, 'TAIL'})
+    end)
+end
+
+-- Checks that errors are the same as without in-place updates.
+g.test_errors = function(cg)
+    cg.server:exec(function()
+        local s = box.space.test
+        s:insert({1, 10, 1.5, 'abc', 'k1', 1.5})
+        t.assert_error_msg_contains(
+            'type does not match one required by operation',
+            s.update, s, 1, {{'-', 2, 20}})
+        t.assert_error_msg_contains(
+            'type does not match one required by operation',
+            s.update, s, 1, {{'=', 2, 'a'}})
+        t.assert_error_msg_contains(
+            'expected a number', s.update, s, 1, {{'+', 'name', 1}})
+        t.assert_error_msg_contains(
+            'double update of the same field',
+            s.update, s, 1, {{'+', 2, 1}, {'+', 2, 1}})
+        t.assert_equals(s:get(1), {1, 10, 1.5, 'abc', 'k1', 1.5})
+    end)
+end
+
+-- Checks that in-place updates are rolled back and visible to triggers.
+g.test_rollback = function(cg)
+    cg.server:exec(function()
+        local s = box.space.test
+        s:insert({1, 10, 1.5, 'abc', 'k1', 1.5})
+        local log = {}
+        s:on_replace(function(old, new)
+            table.insert(log, {old[2], new[2]})
+        end)
+        local old = s:get(1)
+        box.begin()
+        s:update(1, {{'+', 2, 1}})
+        s:update(1, {{'+', 2, 1}})
+        t.assert_equals(s:get(1), {1, 12, 1.5, 'abc', 'k1', 1.5})
+        box.rollback()
+        t.assert_equals(s:get(1), {1, 10, 1.5, 'abc', 'k1', 1.5})
+        t.assert_equals(old, {1, 10, 1.5, 'abc', 'k1', 1.5})
+        t.assert_equals(log, {{10, 11}, {11, 12}})
+    end)
+end
@@ -0,0 +1,103 @@
+local fio = require('fio')
+local http_client = require('http.client')
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+    cg.socket = fio.pathjoin(cg.server.workdir, 'metrics.sock')
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        box.cfg({metrics_listen = box.NULL})
+        if box.space.test ~= nil then
+            box.space.test:drop()
+        end
+    end)
+end)
+
+-- Sends an HTTP GET request to the metrics endpoint.
+local function get(cg, path)
+    return http_client.new():get('http://localhost' .. path,
+                                 {unix_socket = cg.socket, timeout = 10})
+end
+
+-- Returns the value of the given sample or nil if it's missing.
+local function sample(body, name)
+    for line in body:gmatch('[^\n]+') do
+        local value = line:match('^' .. name:gsub('%p', '%%%0') .. ' (.+)$')
+        if value ~= nil then
+            return tonumber(value)
+        end
+    end
+end
+
+g.test_cfg = function(cg)
+    cg.server:exec(function()
+        t.assert_error_msg_contains(
+            "Incorrect value for option 'metrics_listen'",
+            box.cfg, {metrics_listen = 'localhost'})
+        t.assert_equals(box.cfg.metrics_listen, nil)
+    end)
+end
+
+g.test_metrics = function(cg)
+    cg.server:exec(function(socket)
+        box.cfg({metrics_listen = 'unix/:' .. socket})
+        local s = box.schema.space.create('test')
+        s:create_index('pk')
+        for i = 1, 10 do
+            s:insert({i, 'x'})
+        end
+    end, {cg.socket})
+    t.helpers.retrying({}, function()
+        local response = get(cg, '/metrics')
+        t.assert_equals(response.status, 200)
+        t.assert_str_contains(response.headers['content-type'],
+                              'text/plain')
+        local body = response.body
+        t.assert_str_contains(body, '# TYPE tnt_stats_op_total counter\n')
+        t.assert_ge(sample(body, 'tnt_stats_op_total{operation="insert"}'),
+                    10)
+        t.assert_ge(sample(body, 'tnt_net_connections_total'), 1)
+        t.assert_equals(sample(body, 'tnt_space_len{name="test"}'), 10)
+        t.assert_gt(sample(body, 'tnt_space_bsize{name="test"}'), 0)
+        t.assert_gt(sample(body, 'tnt_info_memory_data'), 0)
+        t.assert_ge(sample(body, 'tnt_info_lsn'), 10)
+        -- System spaces aren't reported.
+        t.assert_equals(sample(body, 'tnt_space_len{name="_space"}'), nil)
+    end)
+    t.assert_equals(get(cg, '/').status, 200)
+    t.assert_equals(get(cg, '/metrics?format=text').status, 200)
+    t.assert_equals(get(cg, '/foo').status, 404)
+    local response = http_client.new():post('http://localhost/metrics', '',
+                                            {unix_socket = cg.socket})
+    t.assert_equals(response.status, 405)
+end
+
+g.test_disable = function(cg)
+    cg.server:exec(function(socket)
+        box.cfg({metrics_listen = 'unix/:' .. socket})
+    end, {cg.socket})
+    t.helpers.retrying({}, function()
+        t.assert_equals(get(cg, '/metrics').status, 200)
+    end)
+    cg.server:exec(function()
+        box.cfg({metrics_listen = box.NULL})
+    end)
+    t.assert_not_equals(get(cg, '/metrics').status, 200)
+    cg.server:exec(function(socket)
+        box.cfg({metrics_listen = 'unix/:' .. socket})
+    end, {cg.socket})
+    t.helpers.retrying({}, function()
+        t.assert_equals(get(cg, '/metrics').status, 200)
+    end)
+end
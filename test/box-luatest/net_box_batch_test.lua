@@ -0,0 +1,73 @@
+local fiber = require('fiber')
+local net = require('net.box')
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+    cg.server:exec(function()
+        rawset(_G, 'echo', function(...) return ... end)
+        rawset(_G, 'fail', function(msg) error(msg) end)
+        rawset(_G, 'sleep', function(t) require('fiber').sleep(t) end)
+    end)
+    cg.conn = net.connect(cg.server.net_box_uri)
+end)
+
+g.after_all(function(cg)
+    cg.conn:close()
+    cg.server:drop()
+end)
+
+g.test_batch = function(cg)
+    local results, errors = cg.conn:batch({
+        {'echo', {1, 2}},
+        {'echo'},
+        {'fail', {'test error'}},
+        {'echo', {'a'}},
+    })
+    t.assert_equals(results, {[1] = {1, 2}, [2] = {}, [4] = {'a'}})
+    t.assert_equals(errors[1], nil)
+    t.assert_str_contains(tostring(errors[3]), 'test error')
+    results, errors = cg.conn:batch({})
+    t.assert_equals(results, {})
+    t.assert_equals(errors, nil)
+    t.assert_error_msg_contains('Usage: conn:batch',
+                                cg.conn.batch, cg.conn, 'echo')
+    t.assert_error_msg_contains('Usage: conn:batch',
+                                cg.conn.batch, cg.conn, {'echo'})
+    t.assert_error_msg_contains('Timeout exceeded',
+                                cg.conn.batch, cg.conn,
+                                {{'echo'}, {'sleep', {10}}}, {timeout = 0.01})
+end
+
+g.test_wait_all = function(cg)
+    local futures = {}
+    for i = 1, 100 do
+        futures[i] = cg.conn:call('echo', {i}, {is_async = true})
+    end
+    t.assert_equals(net.wait_all(futures), true)
+    for i, f in ipairs(futures) do
+        t.assert(f:is_ready())
+        t.assert_equals(f:result(), {i})
+    end
+    -- Ready futures are skipped.
+    t.assert_equals(net.wait_all(futures, 0), true)
+    -- Timeout.
+    local f = cg.conn:call('sleep', {0.1}, {is_async = true})
+    local ok, err = net.wait_all({f}, 0.01)
+    t.assert_equals(ok, nil)
+    t.assert_equals(err.type, 'TimedOut')
+    t.assert_equals(net.wait_all({f}), true)
+    -- The same future waited by two fibers.
+    f = cg.conn:call('sleep', {0.05}, {is_async = true})
+    local waiter = fiber.new(net.wait_all, {f})
+    waiter:set_joinable(true)
+    t.assert_equals(net.wait_all({f}), true)
+    t.assert_equals({waiter:join()}, {true, true})
+    t.assert_error_msg_contains('Usage: net.box.wait_all', net.wait_all)
+    t.assert_error_msg_contains('Usage: net.box.wait_all',
+                                net.wait_all, {}, -1)
+end
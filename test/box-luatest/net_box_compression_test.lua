@@ -0,0 +1,129 @@
+local fiber = require('fiber')
+local net = require('net.box')
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+    cg.server:exec(function()
+        local s = box.schema.space.create('test')
+        s:create_index('pk')
+        rawset(_G, 'echo', function(...) return ... end)
+        rawset(_G, 'push', function(...)
+            for _, v in ipairs({...}) do
+                box.session.push(v)
+            end
+            return true
+        end)
+        box.schema.func.create('echo')
+        box.schema.func.create('push')
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        box.space.test:truncate()
+    end)
+end)
+
+-- Checks requests sent over a compressed connection.
+g.test_requests = function(cg)
+    local conn = net.connect(cg.server.net_box_uri, {compression = 'zstd'})
+    t.assert_equals(conn.state, 'active')
+    t.assert(conn.peer_protocol_features.compression)
+    t.assert(conn:ping())
+    local s = conn.space.test
+    t.assert_equals(s:insert({1, 'a'}), {1, 'a'})
+    t.assert_equals(s:replace({2, 'b'}), {2, 'b'})
+    t.assert_equals(s:select(), {{1, 'a'}, {2, 'b'}})
+    t.assert_error_msg_contains('Duplicate key exists',
+                                s.insert, s, {1, 'a'})
+    -- Requests and responses bigger than the read-ahead buffer.
+    local data = string.rep('x', 4 * 1024 * 1024)
+    t.assert_equals(conn:call('echo', {data}), data)
+    for i = 3, 1000 do
+        s:insert({i, string.rep('y', i)})
+    end
+    local tuples = s:select({}, {iterator = 'ge', offset = 2})
+    t.assert_equals(#tuples, 998)
+    for _, tuple in ipairs(tuples) do
+        t.assert_equals(tuple[2], string.rep('y', tuple[1]))
+    end
+    -- Out-of-band messages.
+    local messages = {}
+    t.assert(conn:call('push', {1, 2, 3},
+                       {on_push = table.insert, on_push_ctx = messages}))
+    t.assert_equals(messages, {1, 2, 3})
+    conn:close()
+end
+
+-- Checks concurrent requests over a compressed connection.
+g.test_concurrent_requests = function(cg)
+    local conn = net.connect(cg.server.net_box_uri, {compression = 'zstd'})
+    local count = 100
+    local results = {}
+    local fibers = {}
+    for i = 1, count do
+        local f = fiber.new(function()
+            results[i] = conn:call('echo', {i, string.rep('z', i * 100)})
+        end)
+        f:set_joinable(true)
+        table.insert(fibers, f)
+    end
+    for _, f in ipairs(fibers) do
+        t.assert(f:join())
+    end
+    for i = 1, count do
+        t.assert_equals(results[i], {i, string.rep('z', i * 100)})
+    end
+    local futures = {}
+    for i = 1, count do
+        futures[i] = conn:call('echo', {i}, {is_async = true})
+    end
+    for i = 1, count do
+        t.assert_equals(futures[i]:wait_result(), {i})
+    end
+    conn:close()
+end
+
+-- Checks that the I/O thread isn't used for compressed connections.
+g.test_io_thread = function(cg)
+    local conn = net.connect(cg.server.net_box_uri,
+                             {compression = 'zstd', io_thread = true})
+    local data = string.rep('x', 1024 * 1024)
+    t.assert_equals(conn:call('echo', {data}), data)
+    conn:close()
+end
+
+-- Checks that a compressed connection is restored on reconnect.
+g.test_reconnect = function(cg)
+    local conn = net.connect(cg.server.net_box_uri, {
+        compression = 'zstd', reconnect_after = 0.01,
+    })
+    local s = conn.space.test
+    t.assert_equals(s:insert({1, 'a'}), {1, 'a'})
+    cg.server:restart()
+    t.assert(conn:wait_state('active', 60))
+    t.assert_equals(s:select(), {{1, 'a'}})
+    conn:close()
+end
+
+-- Checks the compression option values.
+g.test_option = function(cg)
+    local conn = net.connect(cg.server.net_box_uri, {compression = 'none'})
+    t.assert(conn:ping())
+    conn:close()
+    t.assert_error_msg_contains(
+        "parameter 'compression' should be of type string",
+        net.connect, cg.server.net_box_uri, {compression = true})
+    t.assert_error_msg_equals(
+        'Unknown compression: lz4',
+        net.connect, cg.server.net_box_uri, {compression = 'lz4'})
+end
@@ -0,0 +1,119 @@
+local fio = require('fio')
+local net = require('net.box')
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    t.tarantool.skip_if_enterprise()
+    cg.server = server:new()
+    cg.server:start()
+    cg.server:exec(function()
+        local format = {
+            {'id', 'unsigned'},
+            {'name', 'string', is_nullable = true},
+            {'score', 'number'},
+            {'flag', 'boolean'},
+            {'data', 'varbinary', is_nullable = true},
+        }
+        local s = box.schema.space.create('src', {format = format})
+        s:create_index('pk')
+        for i = 1, 10 do
+            s:insert({i, i % 2 == 0 and 'n' .. i or box.NULL, i / 2,
+                      i % 3 == 0, i % 4 == 0 and box.NULL or
+                      require('varbinary').new('b' .. i)})
+        end
+        s = box.schema.space.create('dst', {format = format})
+        s:create_index('pk')
+    end)
+    -- Use the read view export to make an Arrow stream with a few
+    -- record batches.
+    local path = fio.pathjoin(cg.server.workdir, 'src.arrows')
+    cg.server:exec(function(path)
+        local rv = box.read_view.open()
+        t.assert_equals(rv.space.src:export_arrow(path, {batch_size = 4}), 10)
+        rv:close()
+    end, {path})
+    local f = fio.open(path)
+    cg.data = f:read()
+    f:close()
+    cg.conn = net.connect(cg.server.net_box_uri)
+end)
+
+g.after_all(function(cg)
+    cg.conn:close()
+    cg.server:drop()
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        box.space.dst:truncate()
+    end)
+end)
+
+g.test_insert_arrow = function(cg)
+    local dst = cg.conn.space.dst
+    t.assert_equals(dst:insert_arrow(cg.data), 10)
+    cg.server:exec(function()
+        t.assert_equals(box.space.dst:select(), box.space.src:select())
+        box.space.dst:truncate()
+    end)
+    -- The space can be given by name.
+    t.assert_equals(cg.conn:_request('INSERT_ARROW', nil, nil, nil,
+                                     'dst', cg.data), 10)
+    cg.server:exec(function()
+        t.assert_equals(box.space.dst:select(), box.space.src:select())
+        box.space.dst:truncate()
+    end)
+    -- A stream without record batches inserts nothing.
+    local b1, b2, b3, b4 = cg.data:byte(5, 8)
+    local schema_len = 8 + b1 + b2 * 2^8 + b3 * 2^16 + b4 * 2^24
+    t.assert_equals(dst:insert_arrow(cg.data:sub(1, schema_len)), 0)
+end
+
+g.test_atomic = function(cg)
+    cg.server:exec(function()
+        box.space.dst:insert({7, 'x', 0, false})
+    end)
+    t.assert_error_msg_contains('Duplicate key exists',
+                                cg.conn.space.dst.insert_arrow,
+                                cg.conn.space.dst, cg.data)
+    cg.server:exec(function()
+        t.assert_equals(box.space.dst:select(), {{7, 'x', 0, false}})
+    end)
+end
+
+g.test_errors = function(cg)
+    local dst = cg.conn.space.dst
+    t.assert_error_msg_equals(
+        "Illegal parameters, Usage: space:insert_arrow(data[, opts])",
+        dst.insert_arrow, dst, {})
+    t.assert_error_msg_equals(
+        "Illegal parameters, invalid Arrow stream: truncated message",
+        dst.insert_arrow, dst, 'foo')
+    t.assert_error_msg_equals(
+        "Illegal parameters, invalid Arrow stream: missing schema",
+        dst.insert_arrow, dst, '')
+    t.assert_error_msg_equals(
+        "Illegal parameters, invalid Arrow stream: truncated message",
+        dst.insert_arrow, dst, cg.data:sub(1, #cg.data - 16))
+    t.assert_error_msg_equals(
+        "Illegal parameters, invalid Arrow stream: invalid message",
+        dst.insert_arrow, dst,
+        '\xff\xff\xff\xff\x08\x00\x00\x00' .. string.rep('\xff', 8))
+    t.assert_error_msg_equals(
+        "Space '12345' does not exist",
+        cg.conn._request, cg.conn, 'INSERT_ARROW', nil, nil, nil,
+        12345, cg.data)
+    cg.server:exec(function()
+        t.assert_equals(box.space.dst:count(), 0)
+    end)
+end
+
+g.test_iproto_type = function(cg)
+    cg.server:exec(function()
+        t.assert_equals(box.iproto.type.INSERT_ARROW, 18)
+        t.assert_equals(box.iproto.key.ARROW, 0x67)
+    end)
+end
@@ -0,0 +1,113 @@
+local fiber = require('fiber')
+local net = require('net.box')
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+    cg.server:exec(function()
+        local s = box.schema.space.create('test')
+        s:create_index('pk')
+        rawset(_G, 'echo', function(...) return ... end)
+        box.schema.func.create('echo')
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        box.space.test:truncate()
+    end)
+end)
+
+-- Checks requests sent over a connection served by the I/O thread.
+g.test_requests = function(cg)
+    local conn = net.connect(cg.server.net_box_uri, {io_thread = true})
+    t.assert_equals(conn.state, 'active')
+    t.assert(conn:ping())
+    local s = conn.space.test
+    t.assert_equals(s:insert({1, 'a'}), {1, 'a'})
+    t.assert_equals(s:replace({2, 'b'}), {2, 'b'})
+    t.assert_equals(s:select(), {{1, 'a'}, {2, 'b'}})
+    t.assert_equals(conn:call('echo', {1, 2, 3}), {1, 2, 3})
+    t.assert_error_msg_contains('Duplicate key exists',
+                                s.insert, s, {1, 'a'})
+    -- Responses bigger than the read-ahead buffer.
+    local data = string.rep('x', 1024 * 1024)
+    t.assert_equals(conn:call('echo', {data}), data)
+    -- Schema changes are picked up.
+    cg.server:exec(function()
+        box.schema.space.create('test2'):create_index('pk')
+    end)
+    conn:ping()
+    t.assert_not_equals(conn.space.test2, nil)
+    cg.server:exec(function()
+        box.space.test2:drop()
+    end)
+    conn:close()
+    local cords = {}
+    for _, c in ipairs(fiber.cord_stat()) do
+        cords[c.name] = true
+    end
+    t.assert(cords['net.box.io_1'])
+end
+
+-- Checks many concurrent requests over a few connections.
+g.test_concurrent = function(cg)
+    local conns = {}
+    for i = 1, 4 do
+        conns[i] = net.connect(cg.server.net_box_uri, {io_thread = true})
+    end
+    local fibers = {}
+    for i = 1, 100 do
+        local f = fiber.new(function()
+            local conn = conns[i % #conns + 1]
+            for j = 1, 10 do
+                local v = i * 100 + j
+                t.assert_equals(conn:call('echo', {v}), v)
+            end
+            return conn.space.test:insert({i})
+        end)
+        f:set_joinable(true)
+        fibers[i] = f
+    end
+    for i, f in ipairs(fibers) do
+        local ok, res = f:join()
+        t.assert(ok)
+        t.assert_equals(res, {i})
+    end
+    for _, conn in ipairs(conns) do
+        conn:close()
+    end
+    t.assert_equals(cg.server:exec(function()
+        return box.space.test:count()
+    end), 100)
+end
+
+-- Checks that the connection handles the peer shutdown and reconnects.
+g.test_reconnect = function(cg)
+    local conn = net.connect(cg.server.net_box_uri,
+                             {io_thread = true, reconnect_after = 0.1})
+    local fut = conn:eval([[
+        require('fiber').sleep(0.1)
+        return box.session.id()
+    ]], {}, {is_async = true})
+    cg.server:stop()
+    t.assert_type(fut:wait_result(), 'number')
+    t.assert_equals(conn.state, 'error_reconnect')
+    cg.server:start()
+    cg.server:exec(function()
+        rawset(_G, 'echo', function(...) return ... end)
+    end)
+    t.helpers.retrying({}, function()
+        t.assert(conn:ping())
+    end)
+    t.assert_equals(conn.space.test:select(), {})
+    conn:close()
+end
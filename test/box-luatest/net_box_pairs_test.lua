@@ -0,0 +1,101 @@
+local net = require('net.box')
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+    cg.server:exec(function()
+        local s = box.schema.space.create('test', {
+            format = {{'id', 'unsigned'}, {'group', 'unsigned'}},
+        })
+        s:create_index('pk')
+        s:create_index('group', {parts = {'group', 'id'}})
+        for i = 1, 100 do
+            s:insert({i, i % 3})
+        end
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.before_each(function(cg)
+    cg.conn = net.connect(cg.server.net_box_uri)
+end)
+
+g.after_each(function(cg)
+    cg.conn:close()
+end)
+
+local function collect(iter)
+    local res = {}
+    for _, tuple in iter do
+        table.insert(res, tuple:totable())
+    end
+    return res
+end
+
+-- Checks that index:pairs() returns the same tuples as index:select()
+-- regardless of the batch size.
+g.test_pairs = function(cg)
+    local s = cg.conn.space.test
+    local all = s:select()
+    t.assert_equals(#all, 100)
+    for _, batch_size in ipairs({1, 7, 50, 100, 1000}) do
+        local opts = {batch_size = batch_size}
+        t.assert_equals(collect(s:pairs(nil, opts)), all)
+        t.assert_equals(collect(s.index.pk:pairs({}, opts)), all)
+        t.assert_equals(collect(s.index.group:pairs({1}, opts)),
+                        s.index.group:select({1}))
+        t.assert_equals(collect(s.index.pk:pairs({90}, {
+            batch_size = batch_size, iterator = 'LT', offset = 5,
+            limit = 20,
+        })), s.index.pk:select({90}, {iterator = 'LT', offset = 5,
+                                       limit = 20}))
+        t.assert_equals(collect(s:pairs(nil, {
+            batch_size = batch_size, after = {50},
+        })), s:select(nil, {after = {50}}))
+    end
+    t.assert_equals(collect(s:pairs(nil, {limit = 0})), {})
+    t.assert_equals(collect(s:pairs({1000})), {})
+    t.assert_equals(s:pairs():map(function(tuple) return tuple.id end)
+                             :take(3):totable(), {1, 2, 3})
+    local tuple = s:pairs():nth(1)
+    t.assert_equals(tuple.group, 1)
+end
+
+-- Checks that the iterator works in a stream.
+g.test_pairs_stream = function(cg)
+    local stream = cg.conn:new_stream()
+    local s = stream.space.test
+    t.assert_equals(collect(s:pairs(nil, {batch_size = 10})), s:select())
+end
+
+-- Checks errors.
+g.test_pairs_errors = function(cg)
+    local s = cg.conn.space.test
+    t.assert_error_msg_equals(
+        "Illegal parameters, batch_size must be a positive number",
+        s.pairs, s, nil, {batch_size = 0})
+    t.assert_error_msg_contains(
+        "options parameter 'batch_size' should be of type number",
+        s.pairs, s, nil, {batch_size = 'x'})
+    t.assert_error_msg_contains(
+        "unexpected option 'is_async'",
+        s.pairs, s, nil, {is_async = true})
+    t.assert_error_msg_contains(
+        "Use space:pairs(...) instead of space.pairs(...)",
+        s.pairs)
+    local iter = s:pairs(nil, {batch_size = 10})
+    t.assert_equals(select(2, iter()).id, 1)
+    cg.conn:close()
+    local ok, err = pcall(function()
+        for _ in iter do end
+    end)
+    t.assert_not(ok)
+    t.assert_equals(err.code, box.error.NO_CONNECTION)
+end
@@ -0,0 +1,108 @@
+local net = require('net.box')
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+    cg.server:exec(function()
+        local s = box.schema.space.create('test', {
+            format = {{'id', 'unsigned'}, {'group', 'unsigned'}},
+        })
+        s:create_index('pk')
+        s:create_index('group', {parts = {'group'}, unique = false})
+        for i = 1, 10 do
+            s:insert({i, i % 3})
+        end
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.before_each(function(cg)
+    cg.conn = net.connect(cg.server.net_box_uri)
+end)
+
+g.after_each(function(cg)
+    cg.conn:close()
+end)
+
+g.test_get_many = function(cg)
+    local s = cg.conn.space.test
+    local res = s:get_many({1, {5}, 100, 10})
+    t.assert_equals(res, {{1, 1}, {5, 2}, box.NULL, {10, 1}})
+    t.assert_equals(res[1].group, 1)
+    t.assert_equals(s.index.pk:get_many({}), {})
+    t.assert_equals(s.index.group:get_many({0, 5}), {{3, 0}, box.NULL})
+end
+
+g.test_get_many_hash = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test_hash')
+        s:create_index('pk', {type = 'hash'})
+        for i = 1, 1000 do
+            s:insert({i, i * 10})
+        end
+    end)
+    cg.conn:reload_schema()
+    local s = cg.conn.space.test_hash
+    local keys, expected = {}, {}
+    for i = 1, 100 do
+        keys[i] = i * 11
+        expected[i] = i * 11 <= 1000 and {i * 11, i * 110} or box.NULL
+    end
+    t.assert_equals(s:get_many(keys), expected)
+    t.assert_equals(s:get_many({1, 5000, 2}), {{1, 10}, box.NULL, {2, 20}})
+    cg.server:exec(function()
+        box.space.test_hash:drop()
+    end)
+end
+
+g.test_select_many = function(cg)
+    local idx = cg.conn.space.test.index.group
+    t.assert_equals(idx:select_many({0, 3, 1}), {
+        {{3, 0}, {6, 0}, {9, 0}}, {}, {{1, 1}, {4, 1}, {7, 1}, {10, 1}},
+    })
+    t.assert_equals(idx:select_many({1, 2}, {limit = 2, offset = 1}), {
+        {{4, 1}, {7, 1}}, {{5, 2}, {8, 2}},
+    })
+    t.assert_equals(idx:select_many({1, 2}, {iterator = 'GT', limit = 1}), {
+        {{2, 2}}, {},
+    })
+    t.assert_equals(cg.conn.space.test:select_many({2, 20}), {{{2, 2}}, {}})
+
+    local raw = idx:select_many({1}, {limit = 1, return_raw = true})
+    t.assert_equals(raw:decode(), {{{1, 1}}})
+end
+
+g.test_stream = function(cg)
+    local stream = cg.conn:new_stream()
+    stream:begin()
+    stream.space.test:replace({100, 100})
+    t.assert_equals(stream.space.test:get_many({100, 1}), {{100, 100}, {1, 1}})
+    stream:rollback()
+end
+
+g.test_errors = function(cg)
+    local idx = cg.conn.space.test.index.pk
+    t.assert_error_msg_equals(
+        "Supplied key type of part 0 does not match index part type: " ..
+        "expected unsigned",
+        idx.get_many, idx, {1, 'x'})
+    t.assert_error_msg_equals(
+        "Illegal parameters, Usage: index:get_many({key, ...}[, opts])",
+        idx.get_many, idx, 1)
+    t.assert_error_msg_equals(
+        "index:select_many() does not support pagination",
+        idx.select_many, idx, {1}, {fetch_pos = true})
+end
+
+g.test_iproto_type = function(cg)
+    cg.server:exec(function()
+        t.assert_equals(box.iproto.type.SELECT_MANY, 17)
+    end)
+end
@@ -0,0 +1,73 @@
+local fiber = require('fiber')
+local net = require('net.box')
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new({box_cfg = {net_msg_max = 2}})
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+-- Sends yielding requests over many connections concurrently.
+local function send_requests(cg, conn_count, request_count)
+    local conns = {}
+    for i = 1, conn_count do
+        conns[i] = net.connect(cg.server.net_box_uri)
+    end
+    local fibers = {}
+    for i = 1, conn_count do
+        fibers[i] = fiber.new(function()
+            for _ = 1, request_count do
+                t.assert_equals(conns[i]:eval([[
+                    require('fiber').sleep(0.05)
+                    return ...
+                ]], {i}), i)
+            end
+        end)
+        fibers[i]:set_joinable(true)
+    end
+    for i = 1, conn_count do
+        t.assert((fibers[i]:join()))
+        conns[i]:close()
+    end
+end
+
+g.test_stat = function(cg)
+    cg.server:exec(function()
+        local stat = box.stat.net()
+        t.assert_equals(stat.MSG_MAX.current, 2)
+        t.assert_equals(box.stat.net.MSG_MAX, stat.MSG_MAX)
+        t.assert_equals(box.stat.net.thread[1].MSG_MAX, stat.MSG_MAX)
+        t.assert_equals(stat.TX_FIBERS.limit, 2 * 5)
+        t.assert_equals(stat.TX_FIBERS.current, 0)
+        t.assert_type(stat.TX_FIBERS.total, 'number')
+        t.assert_type(stat.TX_FIBERS.wait_time, 'number')
+        t.assert_type(stat.TX_FIBERS.size, 'number')
+        t.assert_equals(box.stat.net.TX_FIBERS.limit, 2 * 5)
+    end)
+end
+
+g.test_auto = function(cg)
+    cg.server:exec(function()
+        box.cfg({net_msg_max_auto = true})
+        box.stat.reset()
+    end)
+    send_requests(cg, 20, 30)
+    cg.server:exec(function()
+        local stat = box.stat.net.MSG_MAX
+        t.assert_gt(stat.total, 0)
+        t.assert_gt(stat.current, 2)
+        t.assert_le(stat.current, 16384)
+        t.assert_equals(box.stat.net.TX_FIBERS.limit, stat.current * 5)
+        -- The configured value is restored when disabled.
+        box.cfg({net_msg_max_auto = false})
+        t.assert_equals(box.stat.net.MSG_MAX.current, 2)
+        t.assert_equals(box.stat.net.TX_FIBERS.limit, 2 * 5)
+    end)
+end
@@ -0,0 +1,102 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group('precompiled_comparators', t.helpers.matrix({
+    engine = {'memtx', 'vinyl'},
+    types = {
+        'integer',
+        'number',
+        'int32,number',
+        'uint8,integer,string',
+        'number,string,int64',
+    },
+}))
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        if box.space.test ~= nil then
+            box.space.test:drop()
+        end
+    end)
+end)
+
+-- Checks that tuples and keys of all shapes covered by the pre-compiled
+-- comparators are ordered the same way as by the generic comparators.
+g.test_order = function(cg)
+    cg.server:exec(function(engine, types)
+        local parts = {}
+        for type in types:gmatch('[^,]+') do
+            table.insert(parts, {#parts + 1, type})
+        end
+        local decimal = require('decimal')
+        local values = {
+            integer = {-100, -1, 0, 1, 100},
+            int32 = {-100, -1, 0, 1, 100},
+            int64 = {-100, -1, 0, 1, 100},
+            uint8 = {0, 1, 100},
+            number = {-1.5, -1, decimal.new('-0.5'), 0, 0.5, 1, 2},
+            string = {'', 'a', 'ab', 'b'},
+        }
+        local s = box.schema.space.create('test', {engine = engine})
+        s:create_index('pk', {parts = parts})
+        -- The secondary index indexes a copy of the primary key fields
+        -- that don't start at the first field so it uses the generic
+        -- comparators.
+        local sk_parts = {}
+        for i, p in ipairs(parts) do
+            sk_parts[i] = {#parts + 1 + i, p[2]}
+        end
+        s:create_index('sk', {parts = sk_parts})
+        local keys = {{}}
+        for _, p in ipairs(parts) do
+            local next_keys = {}
+            for _, k in ipairs(keys) do
+                for _, v in ipairs(values[p[2]]) do
+                    local nk = table.copy(k)
+                    table.insert(nk, v)
+                    table.insert(next_keys, nk)
+                end
+            end
+            keys = next_keys
+        end
+        local n = #parts
+        for i, k in ipairs(keys) do
+            local tuple = table.copy(k)
+            tuple[n + 1] = i
+            for j = 1, n do
+                tuple[n + 1 + j] = k[j]
+            end
+            s:insert(tuple)
+        end
+        local function key_of(tuple, offset)
+            local k = {}
+            for j = 1, n do
+                k[j] = tuple[offset + j]
+            end
+            return k
+        end
+        local pk = s.index.pk:select({}, {fullscan = true})
+        local sk = s.index.sk:select({}, {fullscan = true})
+        t.assert_equals(#pk, #keys)
+        for i = 1, #pk do
+            t.assert_equals(key_of(pk[i], 0), key_of(sk[i], n + 1))
+            t.assert_equals(pk[i][n + 1], i)
+        end
+        -- Lookups by full and partial keys.
+        for i, k in ipairs(keys) do
+            t.assert_equals(s.index.pk:get(k)[n + 1], i)
+            t.assert_equals(s.index.pk:count({k[1]}),
+                            s.index.sk:count({k[1]}))
+            t.assert_equals(s.index.pk:count(k, {iterator = 'lt'}), i - 1)
+        end
+    end, {cg.params.engine, cg.params.types})
+end
@@ -4,19 +4,276 @@ local t = require('luatest')
 local g = t.group()
 
 g.before_all(function(cg)
+    t.tarantool.skip_if_enterprise()
     cg.server = server:new({alias = 'master'})
     cg.server:start()
+    cg.server:exec(function()
+        local s = box.schema.space.create('test', {
+            format = {{'id', 'unsigned'}, {'val', 'string'}},
+        })
+        s:create_index('pk')
+        s:create_index('sk', {parts = {'val'}, unique = false})
+        s:create_index('hash', {type = 'hash'})
+        for i = 1, 5 do
+            s:insert({i, 'v' .. (i % 2)})
+        end
+        box.schema.space.create('vinyl', {engine = 'vinyl'})
+        box.space.vinyl:create_index('pk')
+    end)
 end)
 
 g.after_all(function(cg)
-    cg.server:stop()
+    cg.server:drop()
 end)
 
-g.test_read_view = function(cg)
-    t.tarantool.skip_if_enterprise()
+g.after_each(function(cg)
+    cg.server:exec(function()
+        for _, rv in ipairs(box.read_view.list()) do
+            rv:close()
+        end
+    end)
+end)
+
+g.test_open = function(cg)
+    cg.server:exec(function()
+        t.assert_error_msg_content_equals(
+            "options parameter 'name' should be of type string",
+            box.read_view.open, {name = 1})
+        local rv = box.read_view.open({name = 'test'})
+        t.assert_equals(rv.name, 'test')
+        t.assert_equals(rv.is_system, false)
+        t.assert_equals(rv.status, 'open')
+        t.assert_equals(rv.vclock, box.info.vclock)
+        t.assert_equals(rv.signature, box.info.signature)
+        t.assert_is(box.read_view.list()[1], rv)
+        t.assert_equals(box.read_view.open().name, 'unknown')
+
+        -- Only memtx spaces are included.
+        t.assert_is(rv.space.test, rv.space[box.space.test.id])
+        t.assert_equals(rv.space.vinyl, nil)
+        t.assert_is(rv.space.test.index.pk, rv.space.test.index[0])
+        t.assert_equals(rv.space.test.index.hash.type, 'HASH')
+        t.assert_equals(rv.space.test.index.sk.unique, false)
+    end)
+end
+
+g.test_read = function(cg)
+    cg.server:exec(function()
+        local s = box.space.test
+        local rv = box.read_view.open()
+        s:replace({1, 'new'})
+        s:delete({2})
+        s:insert({6, 'v0'})
+        local rs = rv.space.test
+
+        t.assert_equals(rs:get(1), {1, 'v1'})
+        t.assert_equals(rs:get({2}).val, 'v0')
+        t.assert_equals(rs:get(6), nil)
+        t.assert_equals(rs:select(), {
+            {1, 'v1'}, {2, 'v0'}, {3, 'v1'}, {4, 'v0'}, {5, 'v1'},
+        })
+        t.assert_equals(rs:select(3, {iterator = 'le', limit = 2}),
+                        {{3, 'v1'}, {2, 'v0'}})
+        t.assert_equals(rs:select({}, {offset = 3}), {{4, 'v0'}, {5, 'v1'}})
+        t.assert_equals(rs.index.sk:select('v0'), {{2, 'v0'}, {4, 'v0'}})
+        t.assert_equals(#rs.index.hash:select(), 5)
+
+        local keys = {}
+        for _, tuple in rs.index.sk:pairs('v1', {iterator = 'eq'}) do
+            table.insert(keys, tuple.id)
+        end
+        t.assert_equals(keys, {1, 3, 5})
+        t.assert_equals(rs:pairs(4, 'gt'):totable(), {{5, 'v1'}})
+
+        t.assert_equals(s:select(), {
+            {1, 'new'}, {3, 'v1'}, {4, 'v0'}, {5, 'v1'}, {6, 'v0'},
+        })
+        s:replace({1, 'v1'})
+        s:replace({2, 'v0'})
+        s:delete({6})
+    end)
+end
+
+g.test_errors = function(cg)
     cg.server:exec(function()
+        local rv = box.read_view.open()
+        local rs = rv.space.test
         t.assert_error_msg_equals(
-            "Community edition does not support read view",
-            function() box.read_view.open() end)
+            "Use space:get(...) instead of space.get(...)", rs.get)
+        t.assert_error_msg_equals(
+            "Use index:select(...) instead of index.select(...)",
+            rs.index.pk.select)
+        t.assert_error_msg_content_equals(
+            "Get() doesn't support partial keys and non-unique indexes",
+            rs.index.sk.get, rs.index.sk, 'v0')
+        t.assert_error_msg_content_equals(
+            "HASH index read view does not support requested iterator type",
+            rs.index.hash.select, rs.index.hash, 1)
+        t.assert_error_msg_content_equals(
+            "TREE index read view does not support requested iterator type",
+            rs.select, rs, {}, {iterator = 'bits_all_set'})
+        t.assert_error_msg_content_equals(
+            "Read view does not support pagination",
+            rs.select, rs, {}, {fetch_pos = true})
+    end)
+end
+
+g.test_close = function(cg)
+    cg.server:exec(function()
+        local rv = box.read_view.open()
+        local rs = rv.space.test
+        local gen, param, state = rs:pairs()
+        t.assert_equals(select(2, gen(param, state)), {1, 'v1'})
+        rv:close()
+        t.assert_equals(rv.status, 'closed')
+        t.assert_equals(box.read_view.list(), {})
+        -- Iterators over a closed read view are exhausted.
+        t.assert_equals(gen(param, state), nil)
+        t.assert_error_msg_content_equals('read view is closed',
+                                          rs.select, rs)
+        t.assert_error_msg_content_equals('read view is closed',
+                                          rv.close, rv)
+    end)
+end
+
+g.test_gc = function(cg)
+    cg.server:exec(function()
+        local rv = box.read_view.open()
+        local gen, param, state = rv.space.test:pairs()
+        rv = nil -- luacheck: ignore
+        collectgarbage('collect')
+        -- The read view is pinned by the iterator.
+        t.assert_equals(#box.read_view.list(), 1)
+        t.assert_equals(select(2, gen(param, state)), {1, 'v1'})
+        gen, param, state = nil -- luacheck: ignore
+        collectgarbage('collect')
+        collectgarbage('collect')
+        t.assert_equals(box.read_view.list(), {})
+    end)
+end
+
+g.test_access = function(cg)
+    cg.server:exec(function()
+        box.schema.user.create('reader')
+        box.schema.user.grant('reader', 'read', 'space', '_space')
+        local ok, rv = pcall(box.session.su, 'reader', box.read_view.open)
+        box.schema.user.drop('reader')
+        t.assert(ok, rv)
+        t.assert_equals(rv.space.test, nil)
+        t.assert_not_equals(rv.space._space, nil)
+    end)
+end
+
+g.test_export_arrow = function(cg)
+    cg.server:exec(function()
+        local ffi = require('ffi')
+        local fio = require('fio')
+        local s = box.schema.space.create('arrow', {format = {
+            {'id', 'unsigned'},
+            {'name', 'string', is_nullable = true},
+            {'score', 'number'},
+            {'flag', 'boolean'},
+            {'data', 'any'},
+        }})
+        s:create_index('pk')
+        for i = 1, 5 do
+            s:insert({i, i % 2 == 0 and 'n' .. i or box.NULL, i / 2,
+                      i % 2 == 0, {i}})
+        end
+        box.schema.space.create('no_format')
+        box.space.no_format:create_index('pk')
+        local rv = box.read_view.open()
+        box.space.no_format:drop()
+        -- The changes made after the read view was opened aren't exported.
+        s:insert({6, 'n6', 3, true, {6}})
+        local path = fio.pathjoin(fio.cwd(), 'arrow.arrows')
+        t.assert_error_msg_content_equals(
+            'batch_size should be a positive integer',
+            rv.space.arrow.export_arrow, rv.space.arrow, path,
+            {batch_size = 0})
+        t.assert_error_msg_content_equals(
+            "space 'no_format' has no format",
+            rv.space.no_format.export_arrow, rv.space.no_format, path)
+        t.assert_not(fio.path.exists(path))
+        t.assert_equals(rv.space.arrow:export_arrow(path, {batch_size = 2}),
+                        5)
+        s:drop()
+
+        -- Parse the stream: see the Arrow IPC format and Flatbuffers spec.
+        local f = fio.open(path)
+        local data = f:read()
+        f:close()
+        local p = ffi.cast('const char *', data)
+        local function u8(pos)
+            return ffi.cast('const uint8_t *', p + pos)[0]
+        end
+        local function u32(pos)
+            return ffi.cast('const uint32_t *', p + pos)[0]
+        end
+        local function i32(pos)
+            return ffi.cast('const int32_t *', p + pos)[0]
+        end
+        local function i64(pos)
+            return tonumber(ffi.cast('const int64_t *', p + pos)[0])
+        end
+        local function field(tbl, id)
+            local vtable = tbl - i32(tbl)
+            if 4 + 2 * id >= ffi.cast('const uint16_t *', p + vtable)[0] then
+                return nil
+            end
+            local offset = ffi.cast('const uint16_t *', p + vtable)[2 + id]
+            return offset ~= 0 and tbl + offset or nil
+        end
+        local function deref(pos) return pos + u32(pos) end
+        local function str(pos)
+            return ffi.string(p + pos + 4, u32(pos))
+        end
+
+        local names = {}
+        local batches = {}
+        local pos = 0
+        while true do
+            t.assert_equals(u32(pos), 0xFFFFFFFF)
+            local meta_len = u32(pos + 4)
+            if meta_len == 0 then
+                break
+            end
+            local meta = pos + 8
+            local body = meta + meta_len
+            local msg = deref(meta)
+            t.assert_equals(ffi.cast('const uint16_t *',
+                                     p + field(msg, 0))[0], 4)
+            local header_type = u8(field(msg, 1))
+            local header = deref(field(msg, 2))
+            local body_len = i64(field(msg, 3))
+            if header_type == 1 then
+                local fields = deref(field(header, 1))
+                for i = 0, u32(fields) - 1 do
+                    local fld = deref(fields + 4 + 4 * i)
+                    table.insert(names, str(deref(field(fld, 0))))
+                end
+            else
+                t.assert_equals(header_type, 3)
+                local nodes = deref(field(header, 1))
+                local buffers = deref(field(header, 2))
+                -- The second buffer holds the values of the first column.
+                local ids = {}
+                for i = 0, i64(field(header, 0)) - 1 do
+                    local offset = i64(buffers + 4 + 16)
+                    table.insert(ids, i64(body + offset + 8 * i))
+                end
+                -- The null count of the second column.
+                table.insert(batches, {ids = ids,
+                                       nulls = i64(nodes + 4 + 16 + 8)})
+            end
+            pos = body + body_len
+        end
+        t.assert_equals(pos + 8, #data)
+        t.assert_equals(names, {'id', 'name', 'score', 'flag', 'data'})
+        t.assert_equals(batches, {
+            {ids = {1, 2}, nulls = 1},
+            {ids = {3, 4}, nulls = 1},
+            {ids = {5}, nulls = 1},
+        })
     end)
 end
@@ -0,0 +1,91 @@
+local net = require('net.box')
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group('select-fields', t.helpers.matrix({
+    engine = {'memtx', 'vinyl'},
+}))
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+    cg.server:exec(function(engine)
+        local s = box.schema.space.create('test', {
+            engine = engine,
+            format = {
+                {'id', 'unsigned'},
+                {'name', 'string'},
+                {'data', 'map'},
+            },
+        })
+        s:create_index('pk')
+        for i = 1, 5 do
+            s:insert({i, 'name' .. i, {a = i * 10, b = {c = i}}, 'extra'})
+        end
+    end, {cg.params.engine})
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.test_local = function(cg)
+    cg.server:exec(function()
+        local s = box.space.test
+        local expected = {
+            {1, 'name1', 10, 1, 'extra', box.NULL},
+            {2, 'name2', 20, 2, 'extra', box.NULL},
+        }
+        local fields = {'id', 2, 'data.a', '[3].b.c', 4, 10}
+        local res = s:select({2}, {iterator = 'le', fields = fields})
+        t.assert_equals(#res, 2)
+        t.assert_equals(res[1]:totable(), expected[2])
+        t.assert_equals(res[2]:totable(), expected[1])
+        -- Projected tuples don't have the space format.
+        t.assert_equals(res[1].id, nil)
+        res = s.index.pk:select({}, {limit = 2, fields = fields})
+        t.assert_equals(#res, 2)
+        t.assert_equals(res[1]:totable(), expected[1])
+        t.assert_equals(res[2]:totable(), expected[2])
+        t.assert_equals(
+            s:select({}, {fields = {'name'}, offset = 3}),
+            {{'name4'}, {'name5'}})
+        local pos
+        res, pos = s:select({}, {fields = {1}, limit = 2, fetch_pos = true})
+        t.assert_equals(res, {{1}, {2}})
+        res = s:select({}, {fields = {1}, limit = 2, after = pos})
+        t.assert_equals(res, {{3}, {4}})
+    end)
+end
+
+g.test_errors = function(cg)
+    cg.server:exec(function()
+        local s = box.space.test
+        local msg = "Illegal parameters, fields must be a non-empty array " ..
+                    "of field numbers and paths"
+        for _, fields in ipairs({{}, {0}, {1.5}, {true}, {{1}}, 'id'}) do
+            t.assert_error_msg_equals(msg, s.select, s, {},
+                                      {fields = fields})
+        end
+    end)
+end
+
+g.test_net_box = function(cg)
+    local conn = net.connect(cg.server.net_box_uri)
+    local s = conn.space.test
+    t.assert_equals(
+        s:select({3}, {fields = {'name', 'data.b.c', 1}}),
+        {{'name3', 3, 3}})
+    t.assert_equals(
+        s.index.pk:select({}, {fields = {1}, limit = 3}),
+        {{1}, {2}, {3}})
+    local res, pos = s:select({}, {fields = {'id'}, limit = 1,
+                                   fetch_pos = true})
+    t.assert_equals(res, {{1}})
+    t.assert_equals(s:select({}, {fields = {'id'}, limit = 1, after = pos}),
+                    {{2}})
+    local msg = "Illegal parameters, fields must be a non-empty array " ..
+                "of field numbers and paths"
+    t.assert_error_msg_equals(msg, s.select, s, {}, {fields = {}})
+    conn:close()
+end
@@ -0,0 +1,125 @@
+local net = require('net.box')
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group('select-filter', t.helpers.matrix({
+    engine = {'memtx', 'vinyl'},
+}))
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+    cg.server:exec(function(engine)
+        local s = box.schema.space.create('test', {
+            engine = engine,
+            format = {
+                {'id', 'unsigned'},
+                {'name', 'string'},
+                {'data', 'map'},
+            },
+        })
+        s:create_index('pk')
+        for i = 1, 10 do
+            s:insert({i, 'name' .. i % 3, {a = i * 10}, i % 2 == 0 or nil})
+        end
+    end, {cg.params.engine})
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.test_local = function(cg)
+    cg.server:exec(function()
+        local s = box.space.test
+        local function ids(res)
+            local result = {}
+            for _, tuple in ipairs(res) do
+                table.insert(result, tuple[1])
+            end
+            return result
+        end
+        local function check(filter, expected, opts)
+            opts = opts or {}
+            opts.filter = filter
+            t.assert_equals(ids(s:select({}, opts)), expected,
+                            require('json').encode(filter))
+        end
+        check({'==', 'name', 'name1'}, {1, 4, 7, 10})
+        check({'!=', 2, 'name1'}, {2, 3, 5, 6, 8, 9})
+        check({'<', 'data.a', 30}, {1, 2})
+        check({'<=', '[3].a', 30}, {1, 2, 3})
+        check({'>', 1, 8}, {9, 10})
+        check({'>=', 'id', 8.5}, {9, 10})
+        check({'in', 'id', {3, 5, 100}}, {3, 5})
+        check({'in', 'id', {}}, {})
+        check({'==', 4, true}, {2, 4, 6, 8, 10})
+        -- Missing fields are compared as nil.
+        check({'==', 4, box.NULL}, {1, 3, 5, 7, 9})
+        check({'==', 'data.b', box.NULL}, {1, 2, 3, 4, 5, 6, 7, 8, 9, 10})
+        -- Non-scalar fields don't match.
+        check({'!=', 'data', 1}, {})
+        check({'and', {'>', 'id', 2}, {'<', 'id', 6}}, {3, 4, 5})
+        check({'or', {'<', 'id', 2}, {'>', 'id', 9}}, {1, 10})
+        check({'not', {'<', 'id', 9}}, {9, 10})
+        check({'and', {'==', 'name', 'name0'},
+                      {'or', {'==', 'id', 3}, {'==', 'id', 9}}}, {3, 9})
+        -- The offset and the limit are applied to matching tuples.
+        check({'==', 'name', 'name1'}, {4, 7}, {offset = 1, limit = 2})
+        check({'>', 'id', 2}, {9, 8}, {iterator = 'lt', offset = 1,
+                                       limit = 2})
+        t.assert_equals(
+            s:select({}, {filter = {'>', 'id', 8}, fields = {'name'}}),
+            {{'name0'}, {'name1'}})
+        local res, pos = s:select({}, {filter = {'>', 'id', 4}, limit = 2,
+                                       fetch_pos = true})
+        t.assert_equals(ids(res), {5, 6})
+        res = s:select({}, {filter = {'>', 'id', 4}, limit = 2, after = pos})
+        t.assert_equals(ids(res), {7, 8})
+    end)
+end
+
+g.test_errors = function(cg)
+    cg.server:exec(function()
+        local s = box.space.test
+        local function check(filter, err)
+            t.assert_error_msg_equals(
+                "Illegal parameters, invalid filter: " .. err,
+                s.select, s, {}, {filter = filter})
+        end
+        check({}, "expression must start with an operation")
+        check({1, 2, 3}, "expression must start with an operation")
+        check({'~', 1, 1}, "unknown operation '~'")
+        check({'and'}, "operation 'and' takes at least one operand")
+        check({'not', {'==', 1, 1}, {'==', 1, 1}},
+              "operation 'not' takes one operand")
+        check({'and', 1}, "expression must be an array")
+        check({'==', 1}, "operation '==' takes a field and a scalar")
+        check({'==', 1, {1}}, "operation '==' takes a field and a scalar")
+        check({'==', true, 1}, "operation '==' takes a field and a scalar")
+        check({'in', 1, 1},
+              "operation 'in' takes a field and an array of scalars")
+        check({'in', 1, {{}}},
+              "operation 'in' takes a field and an array of scalars")
+        local expr = {'==', 1, 1}
+        for _ = 1, 40 do
+            expr = {'not', expr}
+        end
+        check(expr, "expression is too deep")
+    end)
+end
+
+g.test_net_box = function(cg)
+    local conn = net.connect(cg.server.net_box_uri)
+    local s = conn.space.test
+    t.assert_equals(
+        s:select({}, {filter = {'in', 'id', {2, 4}}, fields = {1}}),
+        {{2}, {4}})
+    local res = s.index.pk:select({}, {filter = {'>=', 1, 9}})
+    t.assert_equals(#res, 2)
+    t.assert_equals(res[1].id, 9)
+    t.assert_error_msg_equals(
+        "Illegal parameters, invalid filter: unknown operation 'x'",
+        s.select, s, {}, {filter = {'x'}})
+    conn:close()
+end
@@ -0,0 +1,92 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        if box.sequence.test ~= nil then
+            box.sequence.test:drop()
+        end
+    end)
+end)
+
+g.test_cache = function(cg)
+    cg.server:exec(function()
+        local seq = box.schema.sequence.create('test', {cache = 10})
+        local lsn = box.info.lsn
+        for i = 1, 25 do
+            t.assert_equals(seq:next(), i)
+            t.assert_equals(seq:current(), i)
+        end
+        -- Blocks 1..10, 11..20 and 21..30 are reserved.
+        t.assert_equals(box.info.lsn - lsn, 3)
+        t.assert_equals(box.space._sequence_data:get(seq.id)[2], 30)
+    end)
+    -- Reserved values are skipped after restart.
+    cg.server:restart()
+    cg.server:exec(function()
+        local seq = box.sequence.test
+        t.assert_equals(seq:current(), 30)
+        t.assert_equals(seq:next(), 31)
+    end)
+end
+
+g.test_bounds = function(cg)
+    cg.server:exec(function()
+        local seq = box.schema.sequence.create('test', {
+            cache = 10, min = -100, max = -90, start = -95, step = 3,
+        })
+        t.assert_equals(seq:next(), -95)
+        t.assert_equals(seq:next(), -92)
+        t.assert_equals(box.space._sequence_data:get(seq.id)[2], -92)
+        t.assert_error_msg_content_equals(
+            "Sequence 'test' has overflowed", seq.next, seq)
+    end)
+end
+
+g.test_invalidate = function(cg)
+    cg.server:exec(function()
+        local seq = box.schema.sequence.create('test', {cache = 10})
+        t.assert_equals(seq:next(), 1)
+        seq:set(100)
+        t.assert_equals(seq:next(), 101)
+        seq:reset()
+        t.assert_equals(seq:next(), 1)
+        seq:alter({step = 2})
+        t.assert_equals(seq:next(), 12)
+        t.assert_equals(box.space._sequence_data:get(seq.id)[2], 30)
+        -- Auto increment moves the sequence past the reserved block.
+        local s = box.schema.space.create('test_seq')
+        s:create_index('pk', {sequence = 'test'})
+        t.assert_equals(s:insert({box.NULL})[1], 32)
+        t.assert_equals(seq:next(), 34)
+        s:drop()
+    end)
+end
+
+g.test_txn = function(cg)
+    cg.server:exec(function()
+        local seq = box.schema.sequence.create('test', {cache = 10})
+        box.begin()
+        t.assert_equals(seq:next(), 1)
+        t.assert_equals(seq:next(), 2)
+        box.commit()
+        -- No values are reserved inside a transaction.
+        t.assert_equals(box.space._sequence_data:get(seq.id)[2], 2)
+        t.assert_equals(seq:next(), 3)
+        t.assert_equals(box.space._sequence_data:get(seq.id)[2], 12)
+        box.begin()
+        t.assert_equals(seq:next(), 4)
+        box.commit()
+    end)
+end
@@ -0,0 +1,145 @@
+local net = require('net.box')
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+    cg.server:exec(function()
+        local s = box.schema.space.create('test')
+        s:create_index('pk')
+        rawset(_G, 'sleep', function(timeout)
+            require('fiber').sleep(timeout)
+        end)
+        box.schema.func.create('sleep')
+    end)
+    cg.conn = net.connect(cg.server.net_box_uri)
+    cg.session_id = cg.conn:eval('return box.session.id()')
+end)
+
+g.after_all(function(cg)
+    cg.conn:close()
+    cg.server:drop()
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        box.stat.slow_requests_disable()
+        box.space.test:truncate()
+    end)
+end)
+
+-- Returns the slow requests sent over the test connection.
+local function slow_requests(cg)
+    return cg.server:exec(function(session_id)
+        local requests = {}
+        for _, req in ipairs(box.stat.slow_requests()) do
+            if req.session_id == session_id then
+                table.insert(requests, req)
+            end
+        end
+        return requests
+    end, {cg.session_id})
+end
+
+g.test_usage = function(cg)
+    cg.server:exec(function()
+        local errmsg = 'Usage: box.stat.slow_requests_enable(threshold' ..
+                       '[, sample_interval]), threshold must be a ' ..
+                       'non-negative number, sample_interval must be a ' ..
+                       'positive integer'
+        t.assert_error_msg_equals(errmsg, box.stat.slow_requests_enable)
+        t.assert_error_msg_equals(errmsg, box.stat.slow_requests_enable, -1)
+        t.assert_error_msg_equals(errmsg, box.stat.slow_requests_enable,
+                                  'foo')
+        t.assert_error_msg_equals(errmsg, box.stat.slow_requests_enable,
+                                  0, 0)
+    end)
+end
+
+g.test_disabled = function(cg)
+    t.assert(cg.conn:ping())
+    cg.conn:call('sleep', {0.01})
+    t.assert_equals(slow_requests(cg), {})
+end
+
+g.test_breakdown = function(cg)
+    cg.server:exec(function()
+        box.stat.slow_requests_enable(0)
+    end)
+    local s = cg.conn.space.test
+    for i = 1, 10 do
+        s:insert({i})
+    end
+    t.assert_equals(#s:select({3}, {iterator = 'ge'}), 8)
+    cg.conn:call('sleep', {0.1})
+    cg.conn:eval('return 1 + 1')
+    local requests = slow_requests(cg)
+    t.assert_equals(#requests, 13)
+    for _, req in ipairs(requests) do
+        t.assert_almost_equals(req.total,
+                               req.queue + req.tx + req.wal + req.limbo,
+                               1e-6)
+        t.assert_gt(req.time, 0)
+    end
+    local insert = requests[1]
+    t.assert_equals(insert.request, 'INSERT')
+    t.assert_equals(insert.space_id, s.id)
+    t.assert_gt(insert.wal, 0)
+    local select = requests[11]
+    t.assert_equals(select.request, 'SELECT')
+    t.assert_equals(select.space_id, s.id)
+    t.assert_equals(select.index_id, 0)
+    t.assert_equals(select.lookups, 1)
+    t.assert_equals(select.scanned, 8)
+    t.assert_equals(select.wal, 0)
+    local call = requests[12]
+    t.assert_equals(call.request, 'CALL')
+    t.assert_equals(call.func, 'sleep')
+    t.assert_ge(call.tx, 0.1)
+    local eval = requests[13]
+    t.assert_equals(eval.request, 'EVAL')
+    t.assert_equals(eval.func, 'return 1 + 1')
+    t.assert_equals(eval.space_id, nil)
+end
+
+g.test_threshold = function(cg)
+    cg.server:exec(function()
+        box.stat.slow_requests_enable(0.05)
+    end)
+    t.assert(cg.conn:ping())
+    cg.conn:call('sleep', {0.1})
+    local requests = slow_requests(cg)
+    t.assert_equals(#requests, 1)
+    t.assert_equals(requests[1].request, 'CALL')
+    t.assert_ge(requests[1].total, 0.1)
+end
+
+g.test_sample_interval = function(cg)
+    cg.server:exec(function()
+        box.stat.slow_requests_enable(0, 2)
+    end)
+    for _ = 1, 10 do
+        t.assert(cg.conn:ping())
+    end
+    t.assert_equals(#slow_requests(cg), 5)
+end
+
+g.test_ring = function(cg)
+    cg.server:exec(function()
+        box.stat.slow_requests_enable(0)
+    end)
+    for i = 1, 300 do
+        cg.conn:eval('return ' .. i)
+    end
+    local requests = slow_requests(cg)
+    t.assert_equals(#requests, 256)
+    t.assert_equals(requests[1].func, 'return 45')
+    t.assert_equals(requests[256].func, 'return 300')
+    cg.server:exec(function()
+        box.stat.reset()
+        t.assert_equals(box.stat.slow_requests(), {})
+    end)
+end
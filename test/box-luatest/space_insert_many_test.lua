@@ -0,0 +1,96 @@
+local msgpack = require('msgpack')
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group('space_insert_many', t.helpers.matrix({
+    engine = {'memtx', 'vinyl'},
+}))
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.before_each(function(cg)
+    cg.server:exec(function(engine)
+        local s = box.schema.space.create('test', {engine = engine})
+        s:create_index('pk')
+    end, {cg.params.engine})
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        box.space.test:drop()
+    end)
+end)
+
+g.test_insert_many = function(cg)
+    cg.server:exec(function()
+        local s = box.space.test
+        t.assert_equals(s:insert_many({}), 0)
+        t.assert_equals(s:insert_many({{1, 'a'}, box.tuple.new({2, 'b'})}), 2)
+        t.assert_equals(s:select(), {{1, 'a'}, {2, 'b'}})
+        local data = msgpack.encode({{3, 'c'}, {4, 'd'}, {5}})
+        t.assert_equals(s:insert_many(data), 3)
+        t.assert_equals(s:count(), 5)
+        t.assert_equals(s:replace_many({{1, 'x'}, {6, 'y'}}), 2)
+        t.assert_equals(s:select({}, {limit = 1}), {{1, 'x'}})
+        t.assert_equals(s:get(6), {6, 'y'})
+        local tuples = {}
+        for i = 1, 10000 do
+            tuples[i] = {100 + i, i}
+        end
+        t.assert_equals(s:insert_many(tuples), 10000)
+        t.assert_equals(s:count(), 10006)
+    end)
+end
+
+-- Checks that a failed batch doesn't insert anything.
+g.test_atomicity = function(cg)
+    cg.server:exec(function()
+        local s = box.space.test
+        s:insert({2})
+        t.assert_error_msg_contains('Duplicate key exists',
+                                    s.insert_many, s, {{1}, {2}, {3}})
+        t.assert_equals(s:select(), {{2}})
+        t.assert_error_msg_equals('Tuple/Key must be MsgPack array',
+                                  s.insert_many, s, {{1}, 3})
+        t.assert_equals(s:select(), {{2}})
+
+        -- Within a transaction only the batch is rolled back.
+        box.begin()
+        s:insert({10})
+        t.assert_equals(s:insert_many({{11}, {12}}), 2)
+        t.assert_error_msg_contains('Duplicate key exists',
+                                    s.insert_many, s, {{13}, {10}})
+        s:insert({14})
+        box.commit()
+        t.assert_equals(s:select(), {{2}, {10}, {11}, {12}, {14}})
+    end)
+end
+
+g.test_errors = function(cg)
+    cg.server:exec(function()
+        local s = box.space.test
+        t.assert_error_msg_equals('Usage space:insert_many(tuples)',
+                                  box.internal.insert_many, s.id)
+        t.assert_error_msg_equals(
+            'Use space:insert_many(...) instead of space.insert_many(...)',
+            s.insert_many)
+        t.assert_error_msg_equals(
+            'Illegal parameters, A tuple or a table expected, got number',
+            s.insert_many, s, 1)
+        t.assert_error_msg_equals(
+            'Illegal parameters, tuples must be a valid MsgPack array',
+            s.insert_many, s, '\x92\x01')
+        t.assert_error_msg_equals(
+            'Illegal parameters, tuples must be an array',
+            s.insert_many, s, msgpack.encode(1))
+        t.assert_error_msg_contains("Space '100500' does not exist",
+                                    box.internal.insert_many, 100500, {})
+    end)
+end
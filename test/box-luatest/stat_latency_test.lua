@@ -0,0 +1,53 @@
+local net = require('net.box')
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+    cg.server:exec(function()
+        box.schema.space.create('test'):create_index('pk')
+        rawset(_G, 'sleep', function(timeout)
+            require('fiber').sleep(timeout)
+        end)
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.test_latency = function(cg)
+    cg.server:exec(function()
+        box.stat.reset()
+        t.assert_equals(box.stat.latency(), {})
+    end)
+    local conn = net.connect(cg.server.net_box_uri)
+    for i = 1, 10 do
+        conn.space.test:insert({i})
+    end
+    conn.space.test:select()
+    conn:call('sleep', {0.1})
+    conn:close()
+    cg.server:exec(function()
+        local stat = box.stat.latency()
+        t.assert_equals(stat.INSERT.total, 10)
+        t.assert_equals(stat.SELECT.total, 1)
+        t.assert_equals(stat.CALL.total, 1)
+        for _, name in ipairs({'queue', 'tx', 'wal'}) do
+            local lat = stat.INSERT[name]
+            t.assert_type(lat.p50, 'number')
+            t.assert_le(lat.p50, lat.p99)
+            t.assert_le(lat.p99, lat.p999)
+        end
+        -- WAL writes are accounted separately from TX time.
+        t.assert_gt(stat.INSERT.wal.p50, 0)
+        t.assert_equals(stat.SELECT.wal.p999, stat.SELECT.wal.p50)
+        t.assert_ge(stat.CALL.tx.p50, 0.1)
+        t.assert_lt(stat.CALL.tx.p50, 0.1 * 1.25)
+        box.stat.reset()
+        t.assert_equals(box.stat.latency(), {})
+    end)
+end
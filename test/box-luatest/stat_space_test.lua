@@ -0,0 +1,66 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+    cg.server:exec(function()
+        local s = box.schema.space.create('test')
+        s:create_index('pk')
+        s:create_index('sk', {parts = {2, 'unsigned'}, unique = false})
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.test_disabled = function(cg)
+    cg.server:exec(function()
+        t.assert_error_msg_contains('box.stat.space() is disabled',
+                                    box.stat.space)
+    end)
+end
+
+g.test_space_stat = function(cg)
+    cg.server:exec(function()
+        local s = box.space.test
+        box.stat.space_enable()
+        t.assert_equals(box.stat.space(), {})
+        for i = 1, 10 do
+            s:insert({i, i % 2})
+        end
+        s:update(1, {{'=', 3, 'x'}})
+        s:delete(10)
+        s:get(1)
+        s:get(100)
+        s:select({}, {offset = 2, limit = 3})
+        s.index.sk:select({1})
+
+        local stat = box.stat.space().test
+        t.assert_equals(stat.write, 12)
+        t.assert_gt(stat.write_bytes, 0)
+        t.assert_equals(stat.select, 4)
+        t.assert_equals(stat.scanned, 1 + 5 + 5)
+        t.assert_equals(stat.returned, 1 + 3 + 5)
+        t.assert_type(stat.select_latency.p99, 'number')
+        t.assert_type(stat.write_latency.p99, 'number')
+        t.assert_equals(stat.index.pk.select, 3)
+        t.assert_equals(stat.index.pk.scanned, 6)
+        t.assert_equals(stat.index.sk.select, 1)
+        t.assert_equals(stat.index.sk.returned, 5)
+
+        box.stat.reset()
+        stat = box.stat.space().test
+        t.assert_equals(stat.select, 0)
+        t.assert_equals(stat.write, 0)
+
+        box.stat.space_disable()
+        s:get(1)
+        box.stat.space_enable()
+        t.assert_equals(box.stat.space(), {})
+        box.stat.space_disable()
+    end)
+end
@@ -0,0 +1,86 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group(nil, t.helpers.matrix({engine = {'memtx', 'vinyl'}}))
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.before_each(function(cg)
+    cg.server:exec(function(engine)
+        local s = box.schema.space.create('test', {
+            engine = engine,
+            format = {
+                {'id', 'unsigned'}, {'a', 'integer'}, {'b', 'unsigned'},
+            },
+        })
+        s:create_index('pk')
+        s:create_index('sk', {parts = {'a', 'b'}})
+        local values = {
+            -2^40, -2^40 + 1, -2^31 - 1, -2^31, -5, 0, 1,
+            2^31 - 2, 2^31 - 1, 2^31, 2^40, 2^40 + 1,
+        }
+        local id = 0
+        for _, a in ipairs(values) do
+            for _, b in ipairs({0, 1, 2^31, 2^40}) do
+                id = id + 1
+                s:insert({id, a, b})
+            end
+        end
+    end, {cg.params.engine})
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        box.space.test:drop()
+    end)
+end)
+
+local function check_order(cg)
+    cg.server:exec(function()
+        local sk = box.space.test.index.sk
+        local prev
+        for _, tuple in sk:pairs() do
+            if prev ~= nil then
+                t.assert(prev.a < tuple.a or
+                         (prev.a == tuple.a and prev.b < tuple.b),
+                         'tuples are sorted')
+            end
+            prev = tuple
+        end
+        t.assert_equals(sk:count(), 48)
+        for _, a in ipairs({-2^40, -2^31, 0, 2^31 - 1, 2^40}) do
+            local res = sk:select({a})
+            t.assert_equals(#res, 4)
+            for i, b in ipairs({0, 1, 2^31, 2^40}) do
+                t.assert_equals({res[i].a, res[i].b}, {a, b})
+            end
+            t.assert_equals(sk:get({a, 2^31}).b, 2^31)
+            t.assert_equals(sk:select({a, 0}, {iterator = 'GT'})[1].b, 1)
+            t.assert_equals(#sk:select({a}, {iterator = 'LT', limit = 1}),
+                            a == -2^40 and 0 or 1)
+            t.assert_equals(#sk:select({a, 2^31}, {iterator = 'LE',
+                                                   limit = 3}), 3)
+        end
+    end)
+end
+
+g.test_order = function(cg)
+    check_order(cg)
+end
+
+g.test_alter = function(cg)
+    cg.server:exec(function()
+        local format = box.space.test:format()
+        format[2].type = 'number'
+        box.space.test:format(format)
+        box.space.test.index.sk:alter({parts = {'a', 'number', 'b'}})
+    end)
+    check_order(cg)
+end
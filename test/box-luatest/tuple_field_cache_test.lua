@@ -0,0 +1,81 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+-- Checks that field access by number returns correct fields whatever
+-- the order of accesses is.
+g.test_field_access = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test')
+        s:create_index('pk', {parts = {3, 'unsigned'}})
+        local data = {}
+        for i = 1, 100 do
+            data[i] = i % 2 == 0 and i or {i, tostring(i)}
+        end
+        data[3] = 3
+        local t1 = s:insert(data)
+        local t2 = box.tuple.new(data)
+        -- Forward, backward and random access, switching tuples.
+        for i = 1, 100 do
+            t.assert_equals(t1[i], data[i])
+            t.assert_equals(t2[i], data[i])
+        end
+        for i = 100, 1, -1 do
+            t.assert_equals(t1[i], data[i])
+        end
+        for _ = 1, 1000 do
+            local i = math.random(1, 110)
+            local tuple = math.random(2) == 1 and t1 or t2
+            t.assert_equals(tuple[i], data[i])
+        end
+        t.assert_equals(t2[101], nil)
+        t.assert_equals(t2[50], data[50])
+        t.assert_equals(t2[1000], nil)
+        t.assert_equals({t2:next(99)}, {100, data[100]})
+        t.assert_equals(t2:next(100), nil)
+        s:drop()
+    end)
+end
+
+-- Checks that a tuple cached by field access is not freed.
+g.test_tuple_gc = function(cg)
+    cg.server:exec(function()
+        local tuple = box.tuple.new({1, 2, 3, 'abc'})
+        t.assert_equals(tuple[4], 'abc')
+        tuple = nil -- luacheck: ignore
+        collectgarbage()
+        collectgarbage()
+        tuple = box.tuple.new({4, 5, 6, 'def'})
+        t.assert_equals(tuple[4], 'def')
+        t.assert_equals(tuple[3], 6)
+    end)
+end
+
+g.test_totable = function(cg)
+    cg.server:exec(function()
+        local tuple = box.tuple.new({1, 2, box.NULL, 4, 5})
+        t.assert_equals(tuple:totable(), {1, 2, box.NULL, 4, 5})
+        t.assert_equals(#tuple:totable(), 5)
+        t.assert_equals(tuple:totable(2), {2, box.NULL, 4, 5})
+        t.assert_equals(tuple:totable(2, 4), {2, box.NULL, 4})
+        t.assert_equals(tuple:totable(4, 100), {4, 5})
+        t.assert_equals(tuple:totable(6), {})
+        t.assert_equals(tuple:totable(4, 3), {})
+        t.assert_equals({tuple:unpack(4)}, {4, 5})
+        t.assert_equals(box.tuple.new({}):totable(), {})
+        t.assert_error_msg_contains('invalid second argument',
+                                    tuple.totable, tuple, 0)
+        t.assert_error_msg_contains('invalid third argument',
+                                    tuple.totable, tuple, 1, 0)
+    end)
+end
@@ -0,0 +1,92 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group('tuple_format_fixed_offset', t.helpers.matrix({
+    engine = {'memtx', 'vinyl'},
+}))
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        if box.space.test ~= nil then
+            box.space.test:drop()
+        end
+    end)
+end)
+
+-- Checks access to fields following fixed-size indexed fields.
+g.test_indexed_prefix = function(cg)
+    cg.server:exec(function(engine)
+        local s = box.schema.space.create('test', {
+            engine = engine,
+            format = {
+                {'a', 'boolean'},
+                {'b', 'float64'},
+                {'c', 'float32'},
+                {'d', 'unsigned'},
+                {'e', 'string'},
+            },
+        })
+        s:create_index('pk', {parts = {'a', 'b', 'c', 'd'}})
+        s:create_index('sk', {parts = {'d'}})
+        s:create_index('tk', {parts = {'e'}, unique = false})
+        local ffi = require('ffi')
+        local function float(v)
+            return ffi.cast('float', v)
+        end
+        for i = 1, 10 do
+            s:insert({i % 2 == 0, i / 2, float(i), i, tostring(i % 3)})
+        end
+        t.assert_equals(s.index.sk:get(4), {true, 2, 4, 4, '1'})
+        t.assert_equals(s.index.pk:select({false, 2.5}),
+                        {{false, 2.5, 5, 5, '2'}})
+        t.assert_equals(s.index.tk:select('0', {fullscan = true}), {
+            {false, 1.5, 3, 3, '0'},
+            {true, 3, 6, 6, '0'},
+            {false, 4.5, 9, 9, '0'},
+        })
+        s.index.sk:update(4, {{'=', 'e', 'x'}})
+        s.index.sk:delete(5)
+        t.assert_equals(s.index.tk:select('x'), {{true, 2, 4, 4, 'x'}})
+        t.assert_equals(s.index.sk:select(4, {iterator = 'ge', limit = 2}),
+                        {{true, 2, 4, 4, 'x'}, {true, 3, 6, 6, '0'}})
+        t.assert_equals(s:count(), 9)
+    end, {cg.params.engine})
+end
+
+-- Checks that non-indexed fixed-size fields don't break access to
+-- the fields following them (Vinyl writes nil to non-indexed fields
+-- of surrogate statements).
+g.test_non_indexed_prefix = function(cg)
+    cg.server:exec(function(engine)
+        local s = box.schema.space.create('test', {
+            engine = engine,
+            format = {
+                {'a', 'float64'},
+                {'b', 'boolean'},
+                {'c', 'unsigned'},
+            },
+        })
+        s:create_index('pk', {parts = {'c'}})
+        s:create_index('sk', {parts = {'b', 'c'}})
+        for i = 1, 10 do
+            s:replace({i * 1.5, i % 2 == 0, i})
+        end
+        box.snapshot()
+        for i = 1, 10, 2 do
+            s:delete(i)
+        end
+        t.assert_equals(s.index.sk:select({false}), {})
+        t.assert_equals(s.index.sk:select({true}, {limit = 2}),
+                        {{3, true, 2}, {6, true, 4}})
+        t.assert_equals(s:count(), 5)
+    end, {cg.params.engine})
+end
@@ -0,0 +1,95 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.test_new_from_json = function(cg)
+    cg.server:exec(function()
+        local json = require('json')
+        local doc = '[1, -2, 1.5, "str", true, false, null, ' ..
+                    '{"a": [1, 2], "b": {}}, [], "\\u00e9\\ud83d\\ude00\\n"]'
+        local tuple = box.tuple.new_from_json(doc)
+        t.assert(box.tuple.is(tuple))
+        t.assert_equals(tuple:totable(), json.decode(doc))
+        t.assert_equals(tuple[10], 'é😀\n')
+        t.assert_equals(box.tuple.new_from_json(' [ ] '):totable(), {})
+        t.assert_equals(
+            box.tuple.new_from_json('[18446744073709551615, ' ..
+                                    '-9223372036854775808]'):totable(),
+            {18446744073709551615ULL, -9223372036854775808LL})
+
+        -- Format.
+        local format = {{'id', 'unsigned'}, {'name', 'string'}}
+        tuple = box.tuple.new_from_json('[1, "x"]', {format = format})
+        t.assert_equals(tuple.name, 'x')
+        t.assert_error_msg_contains(
+            "Tuple field 2 (name) type does not match one required",
+            box.tuple.new_from_json, '[1, 2]', {format = format})
+    end)
+end
+
+g.test_new_from_json_errors = function(cg)
+    cg.server:exec(function()
+        local errors = {
+            ['{"a": 1}'] = 'Tuple/Key must be MsgPack array',
+            ['1'] = 'Tuple/Key must be MsgPack array',
+            [''] = 'position 1: unexpected end',
+            ['[1,]'] = 'position 4: unexpected character',
+            ['[01]'] = "position 3: expected ',' or ']'",
+            ['[1] x'] = 'position 5: unexpected trailing data',
+            ['["abc]'] = 'unterminated string',
+            ['["\\x"]'] = 'invalid escape sequence',
+            ['["\\ud800"]'] = 'invalid unicode escape',
+            ['[1e400]'] = 'number is out of range',
+            [string.rep('[', 200)] = 'too many nested containers',
+        }
+        for doc, msg in pairs(errors) do
+            t.assert_error_msg_contains(msg, box.tuple.new_from_json, doc)
+        end
+        t.assert_error_msg_contains('Usage: box.tuple.new_from_json',
+                                    box.tuple.new_from_json, {})
+    end)
+end
+
+g.test_tojson = function(cg)
+    cg.server:exec(function()
+        local decimal = require('decimal')
+        local json = require('json')
+        local uuid = require('uuid')
+        local tuple = box.tuple.new({1, -2, 1.5, 'a"\n', true, box.NULL,
+                                     {x = {1, 2}},
+                                     setmetatable({[1] = 'a', [10] = 'b'},
+                                                  {__serialize = 'map'})})
+        local str = tuple:tojson()
+        t.assert_equals(json.decode(str), {
+            1, -2, 1.5, 'a"\n', true, json.NULL, {x = {1, 2}},
+            {['1'] = 'a', ['10'] = 'b'},
+        })
+        t.assert_equals(box.tuple.tojson(tuple), str)
+        t.assert_equals(box.tuple.new({}):tojson(), '[]')
+
+        local u = uuid.new()
+        tuple = box.tuple.new({decimal.new('1.25'), u})
+        t.assert_equals(tuple:tojson(),
+                        string.format('[1.25,"%s"]', u:str()))
+
+        -- Round trip.
+        local doc = '[1,"x",{"a":[true,false,null]},[]]'
+        t.assert_equals(box.tuple.new_from_json(doc):tojson(), doc)
+
+        t.assert_error_msg_contains('number is not finite',
+                                    box.tuple.tojson, box.tuple.new({0 / 0}))
+        t.assert_error_msg_contains(
+            'map keys must be strings or integers',
+            box.tuple.tojson, box.tuple.new({{[true] = 1}}))
+    end)
+end
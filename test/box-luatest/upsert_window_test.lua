@@ -0,0 +1,116 @@
+local net = require('net.box')
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        if box.space.test ~= nil then
+            box.space.test:drop()
+        end
+    end)
+end)
+
+g.test_merge = function(cg)
+    cg.server:exec(function()
+        local fiber = require('fiber')
+        local s = box.schema.space.create('test', {upsert_window = 0.5})
+        t.assert_equals(s.upsert_window, 0.5)
+        s:create_index('pk')
+        local lsn = box.info.lsn
+        for i = 1, 100 do
+            s:upsert({i % 2, 1, -1}, {{'+', 2, 1}, {'-', 3, 1}})
+        end
+        -- Buffered upserts aren't visible yet.
+        t.assert_equals(s:select(), {})
+        t.helpers.retrying({}, function()
+            t.assert_equals(s:select(), {{0, 50, -50}, {1, 50, -50}})
+        end)
+        -- Two keys, one WAL row each.
+        t.assert_equals(box.info.lsn - lsn, 2)
+        -- Upserts to an existing tuple.
+        s:upsert({1, 0, 0}, {{'+', 2, 10}})
+        s:upsert({1, 0, 0}, {{'+', 3, 5}, {'+', 2, 10}})
+        fiber.sleep(0)
+        t.assert_equals(s:get(1), {1, 50, -50})
+        t.helpers.retrying({}, function()
+            t.assert_equals(s:get(1), {1, 70, -45})
+        end)
+    end)
+end
+
+g.test_not_merged = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test', {upsert_window = 100})
+        s:create_index('pk')
+        s:upsert({1, 1}, {{'+', 2, 1}})
+        s:upsert({1, 1}, {{'+', 2, 1}})
+        t.assert_equals(s:get(1), nil)
+        -- An upsert that can't be merged is applied right away after the
+        -- buffered one.
+        s:upsert({1, 1}, {{'=', 2, 100}})
+        t.assert_equals(s:get(1), {1, 100})
+        -- Upserts within a transaction aren't buffered.
+        box.begin()
+        s:upsert({2, 1}, {{'+', 2, 1}})
+        box.commit()
+        t.assert_equals(s:get(2), {2, 1})
+        -- Operations on primary key fields aren't buffered.
+        s:upsert({3, 1}, {{'+', 1, 1}})
+        t.assert_equals(s:get(3), {3, 1})
+        -- The option can be disabled.
+        s:alter({upsert_window = 0})
+        t.assert_equals(s.upsert_window, 0)
+        s:upsert({4, 1}, {{'+', 2, 1}})
+        t.assert_equals(s:get(4), {4, 1})
+    end)
+end
+
+g.test_net_box = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test', {upsert_window = 0.1})
+        s:create_index('pk')
+    end)
+    local conn = net.connect(cg.server.net_box_uri)
+    for _ = 1, 10 do
+        conn.space.test:upsert({1, 1}, {{'+', 2, 1}})
+    end
+    t.helpers.retrying({}, function()
+        t.assert_equals(conn.space.test:get(1), {1, 10})
+    end)
+    conn:close()
+end
+
+g.test_errors = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test', {
+            upsert_window = 100,
+            format = {{'id', 'unsigned'}, {'value', 'unsigned'}},
+        })
+        s:create_index('pk')
+        -- The tuple is validated immediately.
+        t.assert_error_msg_content_equals(
+            "Tuple field 2 (value) type does not match one required by " ..
+            "operation: expected unsigned, got string",
+            s.upsert, s, {1, 'x'}, {{'+', 2, 1}})
+        s:drop()
+        t.assert_error_msg_content_equals(
+            "Failed to create space 'test': " ..
+            "upsert_window must be greater than or equal to 0",
+            box.schema.space.create, 'test', {upsert_window = -1})
+        t.assert_error_msg_content_equals(
+            "Vinyl does not support upsert_window",
+            box.schema.space.create, 'test',
+            {engine = 'vinyl', upsert_window = 1})
+    end)
+end
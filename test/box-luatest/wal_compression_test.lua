@@ -0,0 +1,73 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+    cg.server:exec(function()
+        box.schema.space.create('test')
+        box.space.test:create_index('pk')
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.test_compression = function(cg)
+    cg.server:exec(function()
+        local fio = require('fio')
+
+        -- Returns the number of bytes written to the current WAL file
+        -- by a transaction inserting compressible data.
+        local function write()
+            local files = fio.glob(fio.pathjoin(box.cfg.wal_dir, '*.xlog'))
+            table.sort(files)
+            local path = files[#files]
+            local size = fio.stat(path).size
+            box.atomic(function()
+                for _ = 1, 10 do
+                    box.space.test:auto_increment({string.rep('x', 1000)})
+                end
+            end)
+            return fio.stat(path).size - size
+        end
+
+        t.assert_equals(box.cfg.wal_compression, true)
+        t.assert_lt(write(), 1000)
+
+        box.cfg({wal_compression = false})
+        t.assert_gt(write(), 10000)
+
+        box.cfg({wal_compression = true})
+        t.assert_lt(write(), 1000)
+    end)
+
+    -- Both compressed and plain blocks are recovered.
+    cg.server:restart()
+    cg.server:exec(function()
+        t.assert_equals(box.space.test:count(), 30)
+    end)
+end
+
+g.test_cfg_at_startup = function()
+    local s = server:new({box_cfg = {wal_compression = false}})
+    s:start()
+    s:exec(function()
+        local fio = require('fio')
+        t.assert_equals(box.cfg.wal_compression, false)
+        local space = box.schema.space.create('test')
+        space:create_index('pk')
+        space:insert({1, string.rep('x', 10000)})
+        local files = fio.glob(fio.pathjoin(box.cfg.wal_dir, '*.xlog'))
+        table.sort(files)
+        t.assert_gt(fio.stat(files[#files]).size, 10000)
+    end)
+    s:restart()
+    s:exec(function()
+        t.assert_equals(box.space.test:get(1)[2], string.rep('x', 10000))
+    end)
+    s:drop()
+end
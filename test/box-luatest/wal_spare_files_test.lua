@@ -0,0 +1,66 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new({
+        box_cfg = {
+            wal_spare_files = 2,
+            wal_max_size = 4096,
+        },
+    })
+    cg.server:start()
+    cg.server:exec(function()
+        local s = box.schema.space.create('test')
+        s:create_index('pk')
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+local function spare_files(cg)
+    return cg.server:exec(function()
+        local fio = require('fio')
+        local files = fio.glob(fio.pathjoin(box.cfg.wal_dir,
+                                            'spare-*.xlog.inprogress'))
+        table.sort(files)
+        for i, path in ipairs(files) do
+            files[i] = fio.basename(path)
+        end
+        return files
+    end)
+end
+
+g.test_cfg = function(cg)
+    cg.server:exec(function()
+        t.assert_equals(box.cfg.wal_spare_files, 2)
+        t.assert_error_msg_contains(
+            "Can't set option 'wal_spare_files' dynamically",
+            box.cfg, {wal_spare_files = 1})
+    end)
+end
+
+g.test_rotate = function(cg)
+    local xlog_count = cg.server:exec(function()
+        local fio = require('fio')
+        local s = box.space.test
+        for i = 1, 200 do
+            s:insert({i, string.rep('x', 100)})
+        end
+        return #fio.glob(fio.pathjoin(box.cfg.wal_dir, '*.xlog'))
+    end)
+    t.assert_gt(xlog_count, 2)
+    t.helpers.retrying({}, function()
+        t.assert_equals(spare_files(cg), {
+            'spare-0.xlog.inprogress', 'spare-1.xlog.inprogress',
+        })
+    end)
+    -- WAL files created from spare ones are recovered fine.
+    cg.server:restart()
+    cg.server:exec(function()
+        t.assert_equals(box.space.test:len(), 200)
+    end)
+end
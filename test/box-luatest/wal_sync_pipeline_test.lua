@@ -0,0 +1,62 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new({
+        box_cfg = {
+            wal_mode = 'fsync',
+            wal_sync_pipeline = true,
+            wal_max_size = 4096,
+        },
+    })
+    cg.server:start()
+    cg.server:exec(function()
+        local s = box.schema.space.create('test')
+        s:create_index('pk')
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.test_concurrent_writes = function(cg)
+    cg.server:exec(function()
+        local fiber = require('fiber')
+        t.assert_equals(box.cfg.wal_sync_pipeline, true)
+        local s = box.space.test
+        local fibers = {}
+        for i = 1, 20 do
+            fibers[i] = fiber.new(function()
+                for j = 1, 50 do
+                    s:insert({i * 1000 + j})
+                end
+            end)
+            fibers[i]:set_joinable(true)
+        end
+        for i = 1, 20 do
+            t.assert((fibers[i]:join()))
+        end
+        t.assert_equals(s:count(), 20 * 50)
+        box.snapshot()
+        for i = 1, 100 do
+            s:replace({i, 'after snapshot'})
+        end
+    end)
+    cg.server:restart()
+    cg.server:exec(function()
+        local s = box.space.test
+        t.assert_equals(s:count(), 20 * 50 + 100)
+        t.assert_equals(s:get(100), {100, 'after snapshot'})
+    end)
+end
+
+g.test_nondynamic = function(cg)
+    cg.server:exec(function()
+        t.assert_error_msg_contains(
+            "Can't set option 'wal_sync_pipeline' dynamically",
+            box.cfg, {wal_sync_pipeline = false})
+    end)
+end
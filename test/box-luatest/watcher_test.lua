@@ -311,3 +311,58 @@ g.test_watcher_gc = function(cg)
         t.helpers.retrying({}, function() t.assert_equals(count, 2) end)
     end)
 end
+
+-- Notifications about frequent updates are coalesced with
+-- box.cfg.watch_notify_interval.
+g.test_notify_interval = function(cg)
+    cg.server:exec(function()
+        local clock = require('clock')
+        local fiber = require('fiber')
+        t.assert_error_msg_equals(
+            "Incorrect value for option 'watch_notify_interval': " ..
+            "the value must be greater than or equal to 0",
+            box.cfg, {watch_notify_interval = -1})
+        local interval = 0.5
+        box.cfg{watch_notify_interval = interval}
+        local values = {}
+        box.broadcast('baz', 0)
+        local w = box.watch('baz', function(_, v)
+            table.insert(values, v)
+        end)
+        t.helpers.retrying({}, function()
+            t.assert_equals(values, {0})
+        end)
+        -- The first update is delivered immediately, intermediate values
+        -- are skipped.
+        local start = clock.monotonic()
+        for i = 1, 10 do
+            box.broadcast('baz', i)
+        end
+        t.helpers.retrying({}, function()
+            t.assert_equals(values, {0, 10})
+        end)
+        -- The next updates are delayed till the interval expires.
+        box.broadcast('baz', 11)
+        box.broadcast('baz', 12)
+        fiber.sleep(0.1)
+        t.assert_equals(values, {0, 10})
+        t.helpers.retrying({}, function()
+            t.assert_equals(values, {0, 10, 12})
+        end)
+        t.assert_ge(clock.monotonic() - start, interval)
+        -- Disabling the limit releases a delayed notification.
+        box.broadcast('baz', 13)
+        box.cfg{watch_notify_interval = 0}
+        t.helpers.retrying({}, function()
+            t.assert_equals(values, {0, 10, 12, 13})
+        end)
+        w:unregister()
+    end)
+end
+
+g.after_test('test_notify_interval', function(cg)
+    cg.server:exec(function()
+        box.cfg{watch_notify_interval = 0}
+        box.broadcast('baz')
+    end)
+end)
@@ -6,7 +6,7 @@ local socket = require('socket')
 local fio = require('fio')
 local uuid = require('uuid')
 local msgpack = require('msgpack')
-test:plan(111)
+test:plan(121)
 
 --------------------------------------------------------------------------------
 -- Invalid values
@@ -53,6 +53,16 @@ invalid('memtx_sort_threads', 'all')
 invalid('memtx_sort_threads', -1)
 invalid('memtx_sort_threads', 0)
 invalid('memtx_sort_threads', 257)
+invalid('memtx_checkpoint_threads', 0)
+invalid('memtx_checkpoint_threads', 65)
+invalid('tx_cpus', '')
+invalid('iproto_cpus', '3-1')
+invalid('wal_cpus', 'all')
+invalid('relay_cpus', '1024')
+invalid('memtx_defrag_threshold', -0.1)
+invalid('memtx_defrag_threshold', 1.5)
+invalid('memtx_evict_threshold', -0.1)
+invalid('memtx_evict_threshold', 1.5)
 
 local function invalid_combinations(name, val)
     local status, result = pcall(box.cfg, val)
@@ -394,3 +394,63 @@ g.test_join_anonymous_replica_to_all_ro_replicaset = function(g)
         end)
     end)
 end
+
+-- Verify that anonymous replicas form a fan-out tree if
+-- `replication.anon_fanout` is set.
+g.test_anon_fanout = function(g)
+    -- One master, five anonymous replicas, at most two downstreams
+    -- per anonymous replica.
+    local builder = cbuilder.new()
+        :set_replicaset_option('replication.anon_fanout', 2)
+        :add_instance('instance-001', {
+            database = {
+                mode = 'rw',
+            },
+        })
+    for i = 2, 6 do
+        builder:add_instance(('instance-%03d'):format(i), {
+            replication = {
+                anon = true,
+            },
+        })
+    end
+    local config = builder:config()
+
+    local replicaset = replicaset.new(g, config)
+    replicaset:start()
+
+    local function upstream(name)
+        return {
+            login = 'replicator',
+            password = 'secret',
+            uri = ('unix/:./%s.iproto'):format(name),
+        }
+    end
+    local exp = {
+        ['instance-002'] = {upstream('instance-001')},
+        ['instance-003'] = {upstream('instance-001')},
+        ['instance-004'] = {upstream('instance-002')},
+        ['instance-005'] = {upstream('instance-002')},
+        ['instance-006'] = {upstream('instance-003')},
+    }
+    for name, replication in pairs(exp) do
+        replicaset[name]:exec(function(replication)
+            t.assert_equals(box.info.id, 0)
+            t.assert_equals(box.cfg.replication, replication)
+        end, {replication})
+    end
+
+    -- Verify that the data reaches the leaves of the tree.
+    replicaset['instance-001']:exec(function()
+        box.schema.space.create('test'):create_index('pk')
+        box.space.test:insert({1})
+    end)
+    for name in pairs(exp) do
+        t.helpers.retrying({timeout = 60}, function()
+            replicaset[name]:exec(function()
+                t.assert_not_equals(box.space.test, nil)
+                t.assert_equals(box.space.test:get(1), {1})
+            end)
+        end)
+    end
+end
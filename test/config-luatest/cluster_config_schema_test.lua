@@ -177,22 +177,35 @@ g.test_defaults = function()
             by = {
                 interval = 3600,
                 wal_size = 1000000000000000000,
+                recovery_time = 0,
             },
             count = 2,
             snap_io_rate_limit = box.NULL,
+            gc_io_rate_limit = box.NULL,
+            threads = 1,
+            compression = true,
+            direct_io = false,
         },
         iproto = {
             advertise = {
                 client = box.NULL,
             },
             threads = 1,
+            cpus = box.NULL,
+            reuseport = false,
             net_msg_max = 768,
+            net_msg_max_auto = false,
+            net_msg_max_per_connection = 0,
+            net_batch_delay = 0,
+            read_view_staleness = 0,
+            watch_notify_interval = 0,
             readahead = 16320,
         },
         process = {
             strip_core = true,
             coredump = false,
             background = false,
+            tx_cpus = box.NULL,
             title = 'tarantool - {{ instance_name }}',
             username = box.NULL,
             work_dir = box.NULL,
@@ -202,6 +215,7 @@ g.test_defaults = function()
             dir = 'var/lib/{{ instance_name }}',
             max_tuple_size = 1048576,
             bloom_fpr = 0.05,
+            page_cache = 0,
             page_size = 8192,
             range_size = box.NULL,
             run_count_per_level = 2,
@@ -209,6 +223,7 @@ g.test_defaults = function()
             read_threads = 1,
             write_threads = 4,
             cache = 134217728,
+            compression_dict = false,
             defer_deletes = false,
             memory = 134217728,
             timeout = 60,
@@ -221,18 +236,23 @@ g.test_defaults = function()
             txn_timeout = 3153600000,
             txn_isolation = 'best-effort',
             use_mvcc_engine = false,
+            expiration_rate = 10000,
         },
         replication = {
             failover = 'off',
             anon = false,
+            anon_fanout = box.NULL,
             threads = 1,
+            relay_cpus = box.NULL,
             timeout = 1,
             synchro_timeout = 5,
+            synchro_confirm_delay = 0,
             connect_timeout = 30,
             sync_timeout = 0,
             sync_lag = 10,
             synchro_quorum = 'N / 2 + 1',
             skip_conflict = false,
+            apply_fibers = 1,
             election_mode = box.NULL,
             election_timeout = 5,
             election_fencing_mode = 'soft',
@@ -241,10 +261,16 @@ g.test_defaults = function()
         wal = {
             dir = 'var/lib/{{ instance_name }}',
             mode = 'write',
+            cpus = box.NULL,
+            sync_pipeline = false,
+            relay_before_sync = false,
+            spare_files = 0,
             max_size = 268435456,
             dir_rescan_delay = 2,
             queue_max_size = 16777216,
             cleanup_delay = 14400,
+            compression = true,
+            relay_buffer_size = 0,
             retention_period = is_enterprise and 0 or nil,
         },
         console = {
@@ -259,6 +285,10 @@ g.test_defaults = function()
             min_tuple_size = 16,
             max_tuple_size = 1048576,
             sort_threads = box.NULL,
+            join_threads = 1,
+            use_huge_pages = false,
+            defrag_threshold = 0,
+            evict_threshold = 0.9,
         },
         config = {
             reload = 'auto',
@@ -169,6 +169,7 @@ g.test_process = function()
             strip_core = true,
             coredump = true,
             background = true,
+            tx_cpus = '0',
             title = 'one',
             username = 'two',
             work_dir = 'three',
@@ -182,6 +183,7 @@ g.test_process = function()
         strip_core = true,
         coredump = false,
         background = false,
+        tx_cpus = box.NULL,
         title = 'tarantool - {{ instance_name }}',
         username = box.NULL,
         work_dir = box.NULL,
@@ -423,7 +425,14 @@ g.test_iproto = function()
                 },
             },
             threads = 1,
+            cpus = '0-3',
+            reuseport = true,
             net_msg_max = 1,
+            net_msg_max_auto = true,
+            net_msg_max_per_connection = 16,
+            net_batch_delay = 0.001,
+            read_view_staleness = 0.1,
+            watch_notify_interval = 0.5,
             readahead = 1,
         },
     }
@@ -435,7 +444,14 @@ g.test_iproto = function()
             client = box.NULL,
         },
         threads = 1,
+        cpus = box.NULL,
+        reuseport = false,
         net_msg_max = 768,
+        net_msg_max_auto = false,
+        net_msg_max_per_connection = 0,
+        net_batch_delay = 0,
+        read_view_staleness = 0,
+        watch_notify_interval = 0,
         readahead = 16320,
     }
     local res = instance_config:apply_default({}).iproto
@@ -490,7 +506,14 @@ g.test_iproto_enterprise = function()
                 },
             },
             threads = 1,
+            cpus = '0-3',
+            reuseport = true,
             net_msg_max = 1,
+            net_msg_max_auto = true,
+            net_msg_max_per_connection = 16,
+            net_batch_delay = 0.001,
+            read_view_staleness = 0.1,
+            watch_notify_interval = 0.5,
             readahead = 1,
         },
     }
@@ -502,7 +525,14 @@ g.test_iproto_enterprise = function()
             client = box.NULL,
         },
         threads = 1,
+        cpus = box.NULL,
+        reuseport = false,
         net_msg_max = 768,
+        net_msg_max_auto = false,
+        net_msg_max_per_connection = 0,
+        net_batch_delay = 0,
+        read_view_staleness = 0,
+        watch_notify_interval = 0,
         readahead = 16320,
     }
     local res = instance_config:apply_default({}).iproto
@@ -873,6 +903,7 @@ g.test_database = function()
             txn_timeout = 1,
             txn_isolation = 'best-effort',
             use_mvcc_engine = true,
+            expiration_rate = 100,
         },
     }
     instance_config:validate(iconfig)
@@ -919,6 +950,7 @@ g.test_database = function()
         txn_timeout = 3153600000,
         txn_isolation = 'best-effort',
         use_mvcc_engine = false,
+        expiration_rate = 10000,
     }
     local res = instance_config:apply_default({}).database
     t.assert_equals(res, exp)
@@ -950,6 +982,10 @@ g.test_memtx = function()
             min_tuple_size = 1,
             max_tuple_size = 1,
             sort_threads = 1,
+            join_threads = 1,
+            use_huge_pages = true,
+            defrag_threshold = 0.5,
+            evict_threshold = 0.8,
         },
     }
     instance_config:validate(iconfig)
@@ -963,6 +999,10 @@ g.test_memtx = function()
         min_tuple_size = 16,
         max_tuple_size = 1048576,
         sort_threads = box.NULL,
+        join_threads = 1,
+        use_huge_pages = false,
+        defrag_threshold = 0,
+        evict_threshold = 0.9,
     }
     local res = instance_config:apply_default({}).memtx
     t.assert_equals(res, exp)
@@ -974,6 +1014,7 @@ g.test_vinyl = function()
             dir = 'one',
             max_tuple_size = 1,
             bloom_fpr = 0.1,
+            page_cache = 12,
             page_size = 123,
             range_size = 321,
             run_count_per_level = 11,
@@ -981,6 +1022,7 @@ g.test_vinyl = function()
             read_threads = 7,
             write_threads = 9,
             cache = 10,
+            compression_dict = true,
             defer_deletes = true,
             memory = 11,
             timeout = 5.5,
@@ -993,6 +1035,7 @@ g.test_vinyl = function()
         dir = 'var/lib/{{ instance_name }}',
         max_tuple_size = 1048576,
         bloom_fpr = 0.05,
+        page_cache = 0,
         page_size = 8192,
         range_size = box.NULL,
         run_count_per_level = 2,
@@ -1000,6 +1043,7 @@ g.test_vinyl = function()
         read_threads = 1,
         write_threads = 4,
         cache = 134217728,
+        compression_dict = false,
         defer_deletes = false,
         memory = 134217728,
         timeout = 60,
@@ -1014,10 +1058,16 @@ g.test_wal = function()
         wal = {
             dir = 'one',
             mode = 'none',
+            cpus = '4',
+            sync_pipeline = true,
+            relay_before_sync = true,
+            spare_files = 2,
             max_size = 1,
             dir_rescan_delay = 1,
             queue_max_size = 1,
             cleanup_delay = 1,
+            compression = false,
+            relay_buffer_size = 1,
         },
     }
     instance_config:validate(iconfig)
@@ -1026,10 +1076,16 @@ g.test_wal = function()
     local exp = {
         dir = 'var/lib/{{ instance_name }}',
         mode = 'write',
+        cpus = box.NULL,
+        sync_pipeline = false,
+        relay_before_sync = false,
+        spare_files = 0,
         max_size = 268435456,
         dir_rescan_delay = 2,
         queue_max_size = 16777216,
         cleanup_delay = 14400,
+        compression = true,
+        relay_buffer_size = 0,
     }
     local res = instance_config:apply_default({}).wal
     t.assert_equals(res, exp)
@@ -1041,10 +1097,16 @@ g.test_wal_enterprise = function()
         wal = {
             dir = 'one',
             mode = 'none',
+            cpus = '4',
+            sync_pipeline = true,
+            relay_before_sync = true,
+            spare_files = 2,
             max_size = 1,
             dir_rescan_delay = 1,
             queue_max_size = 1,
             cleanup_delay = 1,
+            compression = false,
+            relay_buffer_size = 1,
             retention_period = 1,
             ext = {
                 old = true,
@@ -1064,10 +1126,16 @@ g.test_wal_enterprise = function()
     local exp = {
         dir = 'var/lib/{{ instance_name }}',
         mode = 'write',
+        cpus = box.NULL,
+        sync_pipeline = false,
+        relay_before_sync = false,
+        spare_files = 0,
         max_size = 268435456,
         dir_rescan_delay = 2,
         queue_max_size = 16777216,
         cleanup_delay = 14400,
+        compression = true,
+        relay_buffer_size = 0,
         retention_period = 0,
     }
     local res = instance_config:apply_default({}).wal
@@ -1081,9 +1149,14 @@ g.test_snapshot = function()
             by = {
                 interval = 1,
                 wal_size = 1,
+                recovery_time = 1,
             },
             count = 1,
             snap_io_rate_limit = 1,
+            gc_io_rate_limit = 1,
+            threads = 1,
+            compression = false,
+            direct_io = true,
         },
     }
     instance_config:validate(iconfig)
@@ -1094,9 +1167,14 @@ g.test_snapshot = function()
         by = {
             interval = 3600,
             wal_size = 1000000000000000000,
+            recovery_time = 0,
         },
         count = 2,
         snap_io_rate_limit = box.NULL,
+        gc_io_rate_limit = box.NULL,
+        threads = 1,
+        compression = true,
+        direct_io = false,
     }
     local res = instance_config:apply_default({}).snapshot
     t.assert_equals(res, exp)
@@ -1108,14 +1186,18 @@ g.test_replication = function()
             failover = 'off',
             peers = {'one', 'two'},
             anon = true,
+            anon_fanout = 2,
             threads = 1,
+            relay_cpus = '5-7',
             timeout = 1,
             synchro_timeout = 1,
+            synchro_confirm_delay = 1,
             connect_timeout = 1,
             sync_timeout = 1,
             sync_lag = 1,
             synchro_quorum = 1,
             skip_conflict = true,
+            apply_fibers = 4,
             election_mode = 'off',
             election_timeout = 1,
             election_fencing_mode = 'off',
@@ -1129,14 +1211,18 @@ g.test_replication = function()
     local exp = {
         failover = 'off',
         anon = false,
+        anon_fanout = box.NULL,
         threads = 1,
+        relay_cpus = box.NULL,
         timeout = 1,
         synchro_timeout = 5,
+        synchro_confirm_delay = 0,
         connect_timeout = 30,
         sync_timeout = 0,
         sync_lag = 10,
         synchro_quorum = 'N / 2 + 1',
         skip_conflict = false,
+        apply_fibers = 1,
         election_mode = box.NULL,
         election_timeout = 5,
         election_fencing_mode = 'soft',
@@ -0,0 +1,112 @@
+local t = require('luatest')
+local server = require('luatest.server')
+local replica_set = require('luatest.replica_set')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.replica_set = replica_set:new({})
+    cg.master = cg.replica_set:build_and_add_server({alias = 'master'})
+    cg.replica = cg.replica_set:build_and_add_server({
+        alias = 'replica',
+        box_cfg = {
+            replication = server.build_listen_uri('master',
+                                                  cg.replica_set.id),
+            replication_apply_fibers = 8,
+        },
+    })
+    cg.replica_set:start()
+    cg.master:exec(function()
+        for _, engine in ipairs({'memtx', 'vinyl'}) do
+            local s = box.schema.space.create(engine, {engine = engine})
+            s:create_index('pk')
+            s:create_index('sk', {parts = {2, 'unsigned'}, unique = false})
+            local u = box.schema.space.create(engine .. '_unique',
+                                              {engine = engine})
+            u:create_index('pk')
+            u:create_index('sk', {parts = {2, 'unsigned'}})
+        end
+    end)
+    cg.replica:wait_for_vclock_of(cg.master)
+end)
+
+g.after_all(function(cg)
+    cg.replica_set:drop()
+end)
+
+local function space_data(server)
+    return server:exec(function()
+        local data = {}
+        for _, name in ipairs({'memtx', 'vinyl', 'memtx_unique',
+                               'vinyl_unique'}) do
+            data[name] = box.space[name]:select({}, {fullscan = true})
+        end
+        return data
+    end)
+end
+
+g.test_parallel_apply = function(cg)
+    cg.master:exec(function()
+        local fiber = require('fiber')
+        local fibers = {}
+        for f = 1, 10 do
+            fibers[f] = fiber.new(function()
+                for i = 1, 100 do
+                    local key = (f * i) % 20
+                    for _, name in ipairs({'memtx', 'vinyl'}) do
+                        box.space[name]:replace({key, i})
+                        box.space[name]:upsert({key + 100, 1},
+                                               {{'+', 2, 1}})
+                        -- Rows with the same secondary key and
+                        -- different primary keys.
+                        local u = box.space[name .. '_unique']
+                        u:delete({(key + 1) % 20})
+                        u:replace({key, key})
+                    end
+                    if i % 10 == 0 then
+                        box.begin()
+                        box.space.vinyl:delete({key})
+                        box.space.memtx:replace({key, f})
+                        box.commit()
+                    end
+                end
+            end)
+            fibers[f]:set_joinable(true)
+        end
+        for f = 1, 10 do
+            fibers[f]:join()
+        end
+    end)
+    cg.replica:wait_for_vclock_of(cg.master)
+    t.assert_equals(space_data(cg.replica), space_data(cg.master))
+    cg.replica:assert_follows_upstream(cg.master:get_instance_id())
+end
+
+g.test_serial_apply = function(cg)
+    cg.replica:exec(function()
+        box.cfg({replication_apply_fibers = 1})
+    end)
+    cg.master:exec(function()
+        for i = 1, 100 do
+            box.space.vinyl:replace({i % 10, i})
+        end
+    end)
+    cg.replica:wait_for_vclock_of(cg.master)
+    t.assert_equals(space_data(cg.replica), space_data(cg.master))
+    cg.replica:exec(function()
+        box.cfg({replication_apply_fibers = 8})
+    end)
+end
+
+g.test_invalid_cfg = function(cg)
+    cg.replica:exec(function()
+        local msg = "Incorrect value for option " ..
+                    "'replication_apply_fibers': must be greater than 0, " ..
+                    "less than or equal to 64"
+        t.assert_error_msg_equals(msg, box.cfg,
+                                  {replication_apply_fibers = 0})
+        t.assert_error_msg_equals(msg, box.cfg,
+                                  {replication_apply_fibers = 65})
+        t.assert_equals(box.cfg.replication_apply_fibers, 8)
+    end)
+end
@@ -0,0 +1,124 @@
+local t = require('luatest')
+local cluster = require('luatest.replica_set')
+local server = require('luatest.server')
+
+local g = t.group('election_leader_lease')
+
+g.before_all(function(cg)
+    cg.cluster = cluster:new({})
+    cg.box_cfg = {
+        election_mode = 'manual',
+        election_fencing_mode = 'strict',
+        election_timeout = 0.1,
+        replication = {
+            server.build_listen_uri('server_1', cg.cluster.id),
+            server.build_listen_uri('server_2', cg.cluster.id),
+            server.build_listen_uri('server_3', cg.cluster.id),
+        },
+        replication_synchro_quorum = 2,
+        replication_timeout = 0.1,
+        memtx_use_mvcc_engine = true,
+    }
+    cg.server_1 = cg.cluster:build_and_add_server({
+        alias = 'server_1', box_cfg = cg.box_cfg,
+    })
+    cg.box_cfg.read_only = true
+    cg.server_2 = cg.cluster:build_and_add_server({
+        alias = 'server_2', box_cfg = cg.box_cfg,
+    })
+    cg.server_3 = cg.cluster:build_and_add_server({
+        alias = 'server_3', box_cfg = cg.box_cfg,
+    })
+    cg.box_cfg.read_only = nil
+    cg.cluster:start()
+    cg.cluster:wait_for_fullmesh()
+    cg.server_1:exec(function()
+        box.ctl.promote()
+        box.ctl.wait_rw()
+        box.schema.space.create('sync', {is_sync = true})
+        box.space.sync:create_index('pk')
+    end)
+    cg.server_2:wait_for_vclock_of(cg.server_1)
+    cg.server_3:wait_for_vclock_of(cg.server_1)
+end)
+
+g.after_all(function(cg)
+    cg.cluster:drop()
+end)
+
+local function wait_lease(server)
+    t.helpers.retrying({}, function()
+        t.assert_gt(server:exec(function()
+            return box.info.election.lease
+        end), 0)
+    end)
+end
+
+-- Checks that the leader gets a lease renewed by heartbeats.
+g.test_lease = function(cg)
+    wait_lease(cg.server_1)
+    cg.server_1:exec(function()
+        local fiber = require('fiber')
+        local lease = box.info.election.lease
+        t.assert_le(lease, box.cfg.replication_timeout * 3)
+        fiber.sleep(box.cfg.replication_timeout * 2)
+        t.assert_gt(box.info.election.lease, 0)
+    end)
+    for _, s in ipairs({cg.server_2, cg.server_3}) do
+        s:exec(function()
+            t.assert_equals(box.info.election.state, 'follower')
+            t.assert_equals(box.info.election.lease, 0)
+        end)
+    end
+end
+
+-- Checks that linearizable reads on the leader holding a lease don't poll
+-- the replicas.
+g.test_linearizable_read = function(cg)
+    t.tarantool.skip_if_not_debug()
+    wait_lease(cg.server_1)
+    cg.server_1:exec(function()
+        box.space.sync:replace({1})
+        box.error.injection.set('ERRINJ_RELAY_FROM_TX_DELAY', true)
+        local ok, err = pcall(function()
+            box.begin({txn_isolation = 'linearizable', timeout = 0.01})
+            local tuple = box.space.sync:get(1)
+            box.commit()
+            return tuple
+        end)
+        box.error.injection.set('ERRINJ_RELAY_FROM_TX_DELAY', false)
+        t.assert(ok, err)
+        t.assert_equals(err, {1})
+    end)
+end
+
+-- Checks that the lease is lost with the quorum and the leader resigns.
+g.test_lease_loss = function(cg)
+    wait_lease(cg.server_1)
+    cg.server_2:stop()
+    cg.server_3:stop()
+    cg.server_1:exec(function()
+        t.helpers.retrying({}, function()
+            t.assert_equals(box.info.election.lease, 0)
+            t.assert_not_equals(box.info.election.state, 'leader')
+        end)
+    end)
+    cg.server_2:start()
+    cg.server_3:start()
+    cg.server_1:exec(function()
+        box.ctl.promote()
+        box.ctl.wait_rw()
+    end)
+    wait_lease(cg.server_1)
+end
+
+-- Checks that there's no lease without strict fencing.
+g.test_no_strict_fencing = function(cg)
+    wait_lease(cg.server_1)
+    cg.server_1:exec(function()
+        box.cfg({election_fencing_mode = 'soft'})
+        t.assert_equals(box.info.election.lease, 0)
+        box.cfg({election_fencing_mode = 'strict'})
+    end)
+    wait_lease(cg.server_1)
+end
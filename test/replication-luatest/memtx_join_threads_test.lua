@@ -0,0 +1,75 @@
+local t = require('luatest')
+local server = require('luatest.server')
+local replica_set = require('luatest.replica_set')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.replica_set = replica_set:new({})
+    cg.master = cg.replica_set:build_and_add_server({
+        alias = 'master',
+        box_cfg = {memtx_join_threads = 3},
+    })
+    cg.master:start()
+    cg.master:exec(function()
+        box.schema.space.create('temp', {type = 'temporary'})
+        box.space.temp:create_index('pk')
+        box.space.temp:insert({1})
+        for i = 1, 5 do
+            local s = box.schema.space.create('test' .. i)
+            s:create_index('pk')
+            s:create_index('sk', {parts = {2, 'string'}, unique = false})
+            box.begin()
+            for j = 1, i * 1000 do
+                s:insert({j, string.rep('x', j % 100)})
+            end
+            box.commit()
+        end
+        -- A tuple bigger than a join chunk.
+        box.space.test1:replace({1, string.rep('y', 1024 * 1024)})
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.replica_set:drop()
+end)
+
+local function space_data(server)
+    return server:exec(function()
+        local data = {}
+        for i = 1, 5 do
+            local s = box.space['test' .. i]
+            data[i] = {s:select({}, {fullscan = true}), s.index.sk:count()}
+        end
+        return data
+    end)
+end
+
+g.test_join = function(cg)
+    cg.replica = cg.replica_set:build_and_add_server({
+        alias = 'replica',
+        box_cfg = {
+            replication = cg.master.net_box_uri,
+        },
+    })
+    cg.replica:start()
+    cg.replica:wait_for_vclock_of(cg.master)
+    t.assert_equals(space_data(cg.replica), space_data(cg.master))
+    cg.replica:exec(function()
+        t.assert_equals(box.space.temp:count(), 0)
+    end)
+    cg.replica:drop()
+end
+
+g.test_invalid_cfg = function(cg)
+    cg.master:exec(function()
+        local msg = "Incorrect value for option 'memtx_join_threads': " ..
+                    "must be greater than 0 and less than or equal to 64"
+        t.assert_error_msg_equals(msg, box.cfg, {memtx_join_threads = 0})
+        t.assert_error_msg_equals(msg, box.cfg, {memtx_join_threads = 65})
+        t.assert_equals(box.cfg.memtx_join_threads, 3)
+        box.cfg({memtx_join_threads = 1})
+        t.assert_equals(box.cfg.memtx_join_threads, 1)
+        box.cfg({memtx_join_threads = 3})
+    end)
+end
@@ -0,0 +1,58 @@
+local t = require('luatest')
+local server = require('luatest.server')
+local replica_set = require('luatest.replica_set')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.replica_set = replica_set:new({})
+    cg.master = cg.replica_set:build_and_add_server({alias = 'master'})
+    cg.replica = cg.replica_set:build_and_add_server({
+        alias = 'replica',
+        box_cfg = {
+            replication = server.build_listen_uri('master',
+                                                  cg.replica_set.id),
+        },
+    })
+    cg.replica_set:start()
+    cg.master:exec(function()
+        local s = box.schema.space.create('test')
+        s:create_index('pk')
+        local l = box.schema.space.create('loc', {is_local = true})
+        l:create_index('pk')
+    end)
+    cg.replica:wait_for_vclock_of(cg.master)
+end)
+
+g.after_all(function(cg)
+    cg.replica_set:drop()
+end)
+
+g.test_catch_up = function(cg)
+    cg.replica:stop()
+    -- Multi-statement transactions are read from the xlog by the relay
+    -- when the replica reconnects.
+    cg.master:exec(function()
+        for i = 1, 100 do
+            box.begin()
+            for j = 1, 10 do
+                local id = i * 100 + j
+                box.space.test:insert({id, string.rep('x', id % 1000)})
+                if j % 3 == 0 then
+                    box.space.loc:insert({id})
+                end
+            end
+            box.commit()
+        end
+    end)
+    cg.replica:start()
+    cg.replica:wait_for_vclock_of(cg.master)
+    local data = cg.master:exec(function()
+        return box.space.test:select()
+    end)
+    cg.replica:exec(function(data)
+        t.assert_equals(box.space.test:select(), data)
+        t.assert_equals(box.space.loc:count(), 0)
+        t.assert_equals(box.info.replication[1].upstream.status, 'follow')
+    end, {data})
+end
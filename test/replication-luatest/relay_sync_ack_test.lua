@@ -0,0 +1,66 @@
+local t = require('luatest')
+local server = require('luatest.server')
+local replica_set = require('luatest.replica_set')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    t.tarantool.skip_if_not_debug()
+    cg.replica_set = replica_set:new({})
+    cg.master = cg.replica_set:build_and_add_server({
+        alias = 'master',
+        box_cfg = {
+            replication_synchro_quorum = 2,
+            replication_synchro_timeout = 120,
+        },
+    })
+    cg.replica = cg.replica_set:build_and_add_server({
+        alias = 'replica',
+        box_cfg = {
+            replication = server.build_listen_uri('master',
+                                                  cg.replica_set.id),
+        },
+    })
+    cg.replica_set:start()
+    cg.master:exec(function()
+        box.schema.space.create('sync', {is_sync = true})
+        box.space.sync:create_index('pk')
+        box.schema.space.create('async')
+        box.space.async:create_index('pk')
+        box.ctl.promote()
+    end)
+    cg.replica:wait_for_vclock_of(cg.master)
+end)
+
+g.after_all(function(cg)
+    cg.replica_set:drop()
+end)
+
+-- A synchronous transaction is confirmed as soon as the replica acks it,
+-- even if the relay is still busy sending the rows written after it.
+g.test_ack_during_backlog = function(cg)
+    local elapsed = cg.master:exec(function()
+        local clock = require('clock')
+        local fiber = require('fiber')
+        box.error.injection.set('ERRINJ_RELAY_TIMEOUT', 0.5)
+        local start = clock.monotonic()
+        local f = fiber.new(box.space.sync.insert, box.space.sync, {1})
+        f:set_joinable(true)
+        for i = 1, 10 do
+            fiber.new(box.space.async.insert, box.space.async, {i})
+        end
+        local ok = f:join()
+        local elapsed = clock.monotonic() - start
+        box.error.injection.set('ERRINJ_RELAY_TIMEOUT', 0)
+        t.assert(ok)
+        return elapsed
+    end)
+    -- The relay needs 5 seconds to send the rows following the
+    -- synchronous one.
+    t.assert_lt(elapsed, 3)
+    cg.replica:wait_for_vclock_of(cg.master)
+    cg.replica:exec(function()
+        t.assert_equals(box.space.sync:get(1), {1})
+        t.assert_equals(box.space.async:count(), 10)
+    end)
+end
@@ -0,0 +1,64 @@
+local t = require('luatest')
+local server = require('luatest.server')
+local replica_set = require('luatest.replica_set')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.replica_set = replica_set:new({})
+    cg.master = cg.replica_set:build_and_add_server({alias = 'master'})
+    cg.replica = cg.replica_set:build_and_add_server({
+        alias = 'replica',
+        box_cfg = {
+            replication = {
+                uri = server.build_listen_uri('master', cg.replica_set.id),
+                params = {compression = 'zstd'},
+            },
+        },
+    })
+    cg.replica_set:start()
+    cg.master:exec(function()
+        local s = box.schema.space.create('test')
+        s:create_index('pk')
+    end)
+    cg.replica:wait_for_vclock_of(cg.master)
+end)
+
+g.after_all(function(cg)
+    cg.replica_set:drop()
+end)
+
+g.test_compressed_stream = function(cg)
+    t.assert(cg.master:grep_log('subscribed replica .* with compression'))
+    t.assert(cg.replica:grep_log('subscribed with compression'))
+    cg.master:exec(function()
+        local data = string.rep('x', 1000)
+        for i = 1, 1000 do
+            box.space.test:insert({i, data})
+        end
+    end)
+    cg.replica:wait_for_vclock_of(cg.master)
+    cg.replica:exec(function()
+        t.assert_equals(box.space.test:count(), 1000)
+        t.assert_equals(box.space.test:get(1000)[2], string.rep('x', 1000))
+    end)
+    -- Acks are received by the master through the compressed stream too.
+    cg.master:exec(function(id)
+        t.helpers.retrying({}, function()
+            local vclock = box.info.replication[id].downstream.vclock
+            t.assert_equals(vclock[box.info.id], box.info.lsn)
+        end)
+    end, {cg.replica:get_instance_id()})
+    cg.replica:assert_follows_upstream(cg.master:get_instance_id())
+end
+
+g.test_invalid_cfg = function(cg)
+    cg.replica:exec(function(uri)
+        t.assert_error_msg_equals(
+            "Incorrect value for option 'replication': " ..
+            "invalid compression: lz4",
+            box.cfg, {replication = {
+                uri = uri, params = {compression = 'lz4'},
+            }})
+    end, {cg.master.net_box_uri})
+end
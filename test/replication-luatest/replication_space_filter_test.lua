@@ -0,0 +1,70 @@
+local t = require('luatest')
+local server = require('luatest.server')
+local replica_set = require('luatest.replica_set')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.replica_set = replica_set:new({})
+    cg.master = cg.replica_set:build_and_add_server({alias = 'master'})
+    cg.replica = cg.replica_set:build_and_add_server({
+        alias = 'replica',
+        box_cfg = {
+            replication = {
+                uri = server.build_listen_uri('master', cg.replica_set.id),
+                params = {space = {600, 602}},
+            },
+        },
+    })
+    cg.replica_set:start()
+    cg.master:exec(function()
+        for _, id in ipairs({600, 601, 602}) do
+            local s = box.schema.space.create('test' .. id, {id = id})
+            s:create_index('pk')
+        end
+    end)
+    cg.replica:wait_for_vclock_of(cg.master)
+end)
+
+g.after_all(function(cg)
+    cg.replica_set:drop()
+end)
+
+g.test_space_filter = function(cg)
+    t.assert(cg.master:grep_log('relaying rows of user spaces'))
+    cg.master:exec(function()
+        box.begin()
+        for i = 1, 100 do
+            for _, id in ipairs({600, 601, 602}) do
+                box.space['test' .. id]:insert({i})
+            end
+        end
+        box.commit()
+        box.space.test601:replace({1, 'x'})
+        box.space.test600:update({1}, {{'=', 2, 'y'}})
+        box.space.test601:delete({2})
+        box.space.test602:delete({2})
+    end)
+    cg.replica:wait_for_vclock_of(cg.master)
+    cg.replica:exec(function()
+        -- Schema changes are always relayed.
+        t.assert_not_equals(box.space.test601, nil)
+        t.assert_equals(box.space.test600:count(), 100)
+        t.assert_equals(box.space.test600:get(1), {1, 'y'})
+        t.assert_equals(box.space.test601:count(), 0)
+        t.assert_equals(box.space.test602:count(), 99)
+        t.assert_equals(box.space.test602:get(2), nil)
+    end)
+    cg.replica:assert_follows_upstream(cg.master:get_instance_id())
+end
+
+g.test_invalid_cfg = function(cg)
+    cg.replica:exec(function(uri)
+        t.assert_error_msg_equals(
+            "Incorrect value for option 'replication': " ..
+            "invalid space id: foo",
+            box.cfg, {replication = {
+                uri = uri, params = {space = {600, 'foo'}},
+            }})
+    end, {cg.master.net_box_uri})
+end
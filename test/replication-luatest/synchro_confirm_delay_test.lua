@@ -0,0 +1,83 @@
+local fio = require('fio')
+local server = require('luatest.server')
+local t = require('luatest')
+local xlog = require('xlog')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new({
+        box_cfg = {
+            replication_synchro_quorum = 1,
+            replication_synchro_timeout = 120,
+        },
+    })
+    cg.server:start()
+    cg.server:exec(function()
+        box.ctl.promote()
+        box.schema.space.create('sync', {is_sync = true})
+        box.space.sync:create_index('pk')
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+-- Runs concurrent synchronous transactions and returns the number of
+-- CONFIRM entries written for them.
+local function count_confirms(cg, txn_count)
+    cg.server:exec(function()
+        box.snapshot()
+    end)
+    cg.server:exec(function(txn_count)
+        local fiber = require('fiber')
+        box.space.sync:truncate()
+        local fibers = {}
+        for i = 1, txn_count do
+            fibers[i] = fiber.new(box.space.sync.insert, box.space.sync, {i})
+            fibers[i]:set_joinable(true)
+        end
+        for i = 1, txn_count do
+            t.assert((fibers[i]:join()))
+        end
+        t.assert_equals(box.space.sync:count(), txn_count)
+        t.assert_equals(box.info.synchro.queue.len, 0)
+    end, {txn_count})
+    local wal_dir = cg.server:exec(function()
+        return box.cfg.wal_dir
+    end)
+    local files = fio.glob(fio.pathjoin(cg.server.workdir, wal_dir, '*.xlog'))
+    table.sort(files)
+    local count = 0
+    for _, row in xlog.pairs(files[#files]) do
+        if tostring(row.HEADER.type):find('CONFIRM') ~= nil then
+            count = count + 1
+        end
+    end
+    return count
+end
+
+g.test_confirm_delay = function(cg)
+    cg.server:exec(function()
+        box.cfg({replication_synchro_confirm_delay = 0.1})
+    end)
+    -- All the transactions gather the quorum during the delay so they
+    -- are confirmed by a few CONFIRM entries.
+    t.assert_lt(count_confirms(cg, 50), 5)
+    cg.server:exec(function()
+        box.cfg({replication_synchro_confirm_delay = 0})
+    end)
+    t.assert_ge(count_confirms(cg, 5), 1)
+end
+
+g.test_invalid_cfg = function(cg)
+    cg.server:exec(function()
+        local msg = "Incorrect value for option " ..
+                    "'replication_synchro_confirm_delay': " ..
+                    "the value must be greater than or equal to zero"
+        t.assert_error_msg_equals(msg, box.cfg,
+                                  {replication_synchro_confirm_delay = -1})
+        t.assert_equals(box.cfg.replication_synchro_confirm_delay, 0)
+    end)
+end
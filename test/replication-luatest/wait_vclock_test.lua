@@ -0,0 +1,113 @@
+local fiber = require('fiber')
+local net = require('net.box')
+local server = require('luatest.server')
+local replica_set = require('luatest.replica_set')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.replica_set = replica_set:new({})
+    cg.box_cfg = {
+        replication = {
+            server.build_listen_uri('master', cg.replica_set.id),
+        },
+        replication_timeout = 0.1,
+    }
+    cg.master = cg.replica_set:build_and_add_server({
+        alias = 'master',
+        box_cfg = cg.box_cfg,
+    })
+    cg.box_cfg.read_only = true
+    cg.replica = cg.replica_set:build_and_add_server({
+        alias = 'replica',
+        box_cfg = cg.box_cfg,
+    })
+    cg.replica_set:start()
+    cg.master:exec(function()
+        box.schema.space.create('test')
+        box.space.test:create_index('pk')
+    end)
+    cg.replica:wait_for_vclock_of(cg.master)
+end)
+
+g.after_all(function(cg)
+    cg.replica_set:drop()
+end)
+
+local function pause_replication(cg)
+    cg.replica:exec(function()
+        box.cfg({replication = {}})
+    end)
+end
+
+local function resume_replication(cg)
+    cg.replica:exec(function(replication)
+        box.cfg({replication = replication})
+    end, {cg.box_cfg.replication})
+end
+
+g.after_each(function(cg)
+    resume_replication(cg)
+    cg.replica:wait_for_vclock_of(cg.master)
+    cg.master:exec(function()
+        box.space.test:truncate()
+    end)
+    cg.replica:wait_for_vclock_of(cg.master)
+end)
+
+-- Checks that a read waits until the replica reaches the requested vclock.
+g.test_net_box_wait_vclock = function(cg)
+    pause_replication(cg)
+    cg.master:exec(function()
+        box.space.test:insert({1})
+    end)
+    local vclock = cg.master:get_vclock()
+    local conn = net.connect(cg.replica.net_box_uri)
+    local space = conn.space.test
+    t.assert_equals(space:select(), {})
+    t.assert_error_msg_contains('Timeout exceeded', space.select, space, {},
+                                {wait_vclock = vclock, timeout = 0.1})
+    local f = fiber.new(function()
+        return space:select({}, {wait_vclock = vclock})
+    end)
+    f:set_joinable(true)
+    fiber.sleep(0.1)
+    t.assert_equals(f:status(), 'suspended')
+    resume_replication(cg)
+    local ok, res = f:join()
+    t.assert(ok, res)
+    t.assert_equals(res, {{1}})
+    t.assert_equals(space:get(1, {wait_vclock = vclock}), {1})
+    -- A vclock that is already reached doesn't block.
+    t.assert_equals(space:select({}, {wait_vclock = {}}), {{1}})
+    t.assert_error_msg_contains(
+        'wait_vclock must be a table of numbers indexed by replica id',
+        space.select, space, {}, {wait_vclock = {'a'}})
+    conn:close()
+end
+
+g.test_box_ctl_wait_vclock = function(cg)
+    pause_replication(cg)
+    cg.master:exec(function()
+        box.space.test:insert({1})
+    end)
+    local vclock = cg.master:get_vclock()
+    cg.replica:exec(function(vclock)
+        t.assert_error_msg_equals('Timeout exceeded', box.ctl.wait_vclock,
+                                  vclock, 0.01)
+        box.ctl.wait_vclock({}, 0)
+        t.assert_error_msg_equals(
+            'Usage: box.ctl.wait_vclock(vclock[, timeout])',
+            box.ctl.wait_vclock)
+        t.assert_error_msg_equals(
+            'Illegal parameters, vclock must be a table of non-negative ' ..
+            'integers indexed by replica id',
+            box.ctl.wait_vclock, {[1] = -1})
+    end, {vclock})
+    resume_replication(cg)
+    cg.replica:exec(function(vclock)
+        box.ctl.wait_vclock(vclock)
+        t.assert_equals(box.space.test:select(), {{1}})
+    end, {vclock})
+end
@@ -0,0 +1,74 @@
+local t = require('luatest')
+local server = require('luatest.server')
+local replica_set = require('luatest.replica_set')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.replica_set = replica_set:new({})
+    cg.master = cg.replica_set:build_and_add_server({
+        alias = 'master',
+        box_cfg = {
+            wal_mode = 'fsync',
+            wal_sync_pipeline = true,
+            wal_relay_before_sync = true,
+            replication_synchro_quorum = 2,
+            replication_synchro_timeout = 120,
+        },
+    })
+    cg.replica = cg.replica_set:build_and_add_server({
+        alias = 'replica',
+        box_cfg = {
+            replication = server.build_listen_uri('master',
+                                                  cg.replica_set.id),
+        },
+    })
+    cg.replica_set:start()
+    cg.master:exec(function()
+        box.schema.space.create('sync', {is_sync = true})
+        box.space.sync:create_index('pk')
+        box.schema.space.create('async')
+        box.space.async:create_index('pk')
+        box.ctl.promote()
+    end)
+    cg.replica:wait_for_vclock_of(cg.master)
+end)
+
+g.after_all(function(cg)
+    cg.replica_set:drop()
+end)
+
+g.test_cfg = function(cg)
+    cg.master:exec(function()
+        t.assert_equals(box.cfg.wal_relay_before_sync, true)
+        t.assert_error_msg_contains(
+            "Can't set option 'wal_relay_before_sync' dynamically",
+            box.cfg, {wal_relay_before_sync = false})
+    end)
+end
+
+g.test_replication = function(cg)
+    cg.master:exec(function()
+        local fiber = require('fiber')
+        local fibers = {}
+        for i = 1, 20 do
+            local space = i % 2 == 0 and box.space.sync or box.space.async
+            fibers[i] = fiber.new(function()
+                for j = 1, 10 do
+                    space:insert({i * 100 + j})
+                end
+            end)
+            fibers[i]:set_joinable(true)
+        end
+        for i = 1, 20 do
+            t.assert((fibers[i]:join()))
+        end
+        t.assert_equals(box.space.sync:count(), 100)
+        t.assert_equals(box.space.async:count(), 100)
+    end)
+    cg.replica:wait_for_vclock_of(cg.master)
+    cg.replica:exec(function()
+        t.assert_equals(box.space.sync:count(), 100)
+        t.assert_equals(box.space.async:count(), 100)
+    end)
+end
@@ -0,0 +1,97 @@
+local fio = require('fio')
+local t = require('luatest')
+local server = require('luatest.server')
+local replica_set = require('luatest.replica_set')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.replica_set = replica_set:new({})
+    cg.master = cg.replica_set:build_and_add_server({
+        alias = 'master',
+        box_cfg = {
+            checkpoint_count = 1,
+            wal_relay_buffer_size = 1024 * 1024,
+        },
+    })
+    cg.replica = cg.replica_set:build_and_add_server({
+        alias = 'replica',
+        box_cfg = {
+            replication = server.build_listen_uri('master',
+                                                  cg.replica_set.id),
+        },
+    })
+    cg.replica_set:start()
+    cg.master:exec(function()
+        local s = box.schema.space.create('test')
+        s:create_index('pk')
+    end)
+    cg.replica:wait_for_vclock_of(cg.master)
+end)
+
+g.after_all(function(cg)
+    cg.replica_set:drop()
+end)
+
+-- Inserts rows on the master and checks that they are replicated.
+local function replicate(cg, from, to)
+    cg.master:exec(function(from, to)
+        for i = from, to do
+            box.space.test:insert({i})
+        end
+    end, {from, to})
+    cg.replica:wait_for_vclock_of(cg.master)
+    cg.replica:exec(function(from, to)
+        t.assert_equals(box.space.test:count(), to)
+        t.assert_equals(box.space.test:get(from), {from})
+    end, {from, to})
+end
+
+g.test_buffered_relay = function(cg)
+    replicate(cg, 1, 100)
+    -- Rotate the WAL and make the old files garbage.
+    local signature = cg.master:exec(function()
+        box.snapshot()
+        return box.info.signature
+    end)
+    replicate(cg, 101, 200)
+
+    -- The new WAL file isn't read by the relay.
+    local name = string.format('%020d%%.xlog', signature)
+    t.assert_not(cg.master:grep_log('recover from .*' .. name))
+
+    -- The old WAL files are collected once the replica receives
+    -- the rows from the buffer.
+    local glob = fio.pathjoin(cg.master.workdir, '*.xlog')
+    t.helpers.retrying({}, function()
+        t.assert_equals(#fio.glob(glob), 1)
+    end)
+end
+
+g.test_fallback = function(cg)
+    -- The buffer is disabled.
+    cg.master:exec(function()
+        box.cfg({wal_relay_buffer_size = 0})
+    end)
+    replicate(cg, 201, 300)
+
+    -- The buffer is too small to store rows.
+    cg.master:exec(function()
+        box.cfg({wal_relay_buffer_size = 1})
+    end)
+    replicate(cg, 301, 400)
+
+    cg.master:exec(function()
+        box.cfg({wal_relay_buffer_size = 1024 * 1024})
+    end)
+    replicate(cg, 401, 500)
+end
+
+g.test_invalid_cfg = function(cg)
+    cg.master:exec(function()
+        t.assert_error_msg_equals(
+            "Incorrect value for option 'wal_relay_buffer_size': " ..
+            "the value must be >= 0",
+            box.cfg, {wal_relay_buffer_size = -1})
+    end)
+end
@@ -0,0 +1,100 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.before_each(function(cg)
+    cg.server:exec(function()
+        box.execute([[CREATE TABLE t (id INT PRIMARY KEY, a INT, b INT,
+                                      c INT);]])
+        box.execute([[CREATE INDEX ia ON t(a);]])
+        box.execute([[CREATE INDEX ib ON t(b);]])
+        box.execute([[CREATE INDEX ic ON t(c);]])
+        -- Column a is skewed: almost all rows have a = 1. Column b is
+        -- unique. Column c is almost always NULL.
+        box.begin()
+        for i = 1, 1000 do
+            box.space.T:insert({i, i <= 990 and 1 or i, i,
+                                i <= 990 and box.NULL or i})
+        end
+        box.commit()
+    end)
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        box.execute([[DROP TABLE IF EXISTS t;]])
+    end)
+end)
+
+g.test_errors = function(cg)
+    cg.server:exec(function()
+        local _, err = box.execute([[ANALYZE no_such_table;]])
+        t.assert_equals(err.message, "Space 'NO_SUCH_TABLE' does not exist")
+        box.execute([[CREATE VIEW v AS SELECT * FROM t;]])
+        _, err = box.execute([[ANALYZE v;]])
+        t.assert_equals(err.message, "Failed to execute SQL statement: " ..
+                        "can not analyze space 'V' because space is a view")
+        box.execute([[DROP VIEW v;]])
+        -- Analyzing all spaces skips the ones that can't be read.
+        box.schema.user.create('test_user')
+        box.schema.user.grant('test_user', 'execute', 'sql')
+        box.session.su('test_user', function()
+            t.assert_equals(box.execute([[ANALYZE;]]), {row_count = 0})
+            _, err = box.execute([[ANALYZE t;]])
+            t.assert_equals(err.message, "Read access to space 'T' " ..
+                            "is denied for user 'test_user'")
+        end)
+        box.schema.user.drop('test_user')
+    end)
+end
+
+g.test_skewed_data = function(cg)
+    cg.server:exec(function()
+        local function index_used(sql)
+            local plan = box.execute('EXPLAIN QUERY PLAN ' .. sql).rows
+            return plan[1][4]:match('INDEX (%w+)')
+        end
+        local sql1 = [[SELECT id FROM t WHERE a = 1 AND b = 5;]]
+        local sql2 = [[SELECT id FROM t WHERE a >= 1 AND b > 995;]]
+        local sql3 = [[SELECT id FROM t WHERE a = 1000 AND b > 0;]]
+        local sql4 = [[SELECT id FROM t WHERE c IS NULL AND a = 995;]]
+        box.execute([[ANALYZE t;]])
+        t.assert_equals(index_used(sql1), 'IB')
+        t.assert_equals(index_used(sql2), 'IB')
+        t.assert_equals(index_used(sql3), 'IA')
+        t.assert_equals(index_used(sql4), 'IA')
+        t.assert_equals(box.execute(sql1).rows, {{5}})
+        t.assert_equals(box.execute(sql2).rows,
+                        {{996}, {997}, {998}, {999}, {1000}})
+        t.assert_equals(box.execute(sql3).rows, {{1000}})
+        t.assert_equals(box.execute(sql4).rows, {})
+    end)
+end
+
+-- Checks that ANALYZE within a transaction and ANALYZE of all spaces
+-- collect the same statistics.
+g.test_analyze_all = function(cg)
+    cg.server:exec(function()
+        local sql = [[SELECT id FROM t WHERE a = 1 AND b = 5;]]
+        local plan = box.execute('EXPLAIN QUERY PLAN ' .. sql).rows
+        box.begin()
+        box.execute([[ANALYZE;]])
+        box.commit()
+        local analyzed = box.execute('EXPLAIN QUERY PLAN ' .. sql).rows
+        t.assert_str_contains(analyzed[1][4], 'INDEX IB')
+        -- The statistics are dropped with the index.
+        box.execute([[TRUNCATE TABLE t;]])
+        t.assert_equals(box.execute('EXPLAIN QUERY PLAN ' .. sql).rows,
+                        plan)
+    end)
+end
@@ -0,0 +1,68 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+    cg.server:exec(function()
+        box.execute([[SET SESSION "sql_seq_scan" = true;]])
+        box.execute([[CREATE TABLE t1 (id INT PRIMARY KEY, a INT);]])
+        box.execute([[CREATE TABLE t2 (id INT PRIMARY KEY, a INT);]])
+        box.begin()
+        for i = 1, 10000 do
+            box.space.T1:insert({i, i % 100})
+            box.space.T2:insert({i, i % 1000})
+        end
+        box.commit()
+        rawset(_G, 'check_join', function()
+            local sql = [[SELECT COUNT(*), SUM(t1.id), SUM(t2.id)
+                          FROM t1, t2 WHERE t1.a = t2.a;]]
+            local plan = box.execute('EXPLAIN QUERY PLAN ' .. sql).rows
+            local is_automatic = false
+            for _, row in ipairs(plan) do
+                if row[4]:find('AUTOMATIC') then
+                    is_automatic = true
+                end
+            end
+            t.assert(is_automatic)
+            -- Every row of t1 matches 10 rows of t2 and every row of t2
+            -- with a < 100 matches 100 rows of t1.
+            local sum2 = 0
+            for _, tuple in box.space.T2:pairs() do
+                if tuple[2] < 100 then
+                    sum2 = sum2 + tuple[1] * 100
+                end
+            end
+            t.assert_equals(box.execute(sql).rows,
+                            {{100000, 10 * 10000 * 10001 / 2, sum2}})
+        end)
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+-- Checks that an automatic index built in one go (outside a transaction)
+-- and one filled tuple by tuple (within a transaction) give the same
+-- results, including duplicate keys.
+g.test_join = function(cg)
+    cg.server:exec(function()
+        _G.check_join()
+        box.begin()
+        _G.check_join()
+        box.commit()
+    end)
+end
+
+-- Checks that the automatic index is probed for each row of the outer loop.
+g.test_join_order = function(cg)
+    cg.server:exec(function()
+        local res = box.execute([[SELECT t1.id, t2.id FROM t1, t2
+                                  WHERE t1.a = t2.a AND t1.id < 3
+                                  ORDER BY t1.id, t2.id LIMIT 3;]])
+        t.assert_equals(res.rows, {{1, 1}, {1, 1001}, {1, 2001}})
+    end)
+end
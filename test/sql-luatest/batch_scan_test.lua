@@ -0,0 +1,91 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group(nil, t.helpers.matrix{mvcc = {false, true}})
+
+g.before_all(function(cg)
+    cg.server = server:new{box_cfg = {memtx_use_mvcc_engine = cg.params.mvcc}}
+    cg.server:start()
+    cg.server:exec(function()
+        box.execute([[SET SESSION "sql_seq_scan" = true;]])
+        box.execute([[CREATE TABLE t (id INT PRIMARY KEY, a INT);]])
+        box.execute([[CREATE INDEX t_a ON t (a);]])
+        box.begin()
+        for i = 1, 1000 do
+            box.space.T:insert({i, i % 10})
+        end
+        box.commit()
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+-- Checks scans and aggregates that span many tuple batches.
+g.test_scan = function(cg)
+    cg.server:exec(function()
+        local sql = [[SELECT COUNT(*), SUM(id), MIN(a), MAX(a) FROM t;]]
+        t.assert_equals(box.execute(sql).rows, {{1000, 500500, 0, 9}})
+        sql = [[SELECT a, COUNT(*), SUM(id) FROM t GROUP BY a;]]
+        local rows = box.execute(sql).rows
+        t.assert_equals(#rows, 10)
+        for i, row in ipairs(rows) do
+            t.assert_equals(row[1], i - 1)
+            t.assert_equals(row[2], 100)
+        end
+        sql = [[SELECT id FROM t ORDER BY id DESC LIMIT 3 OFFSET 30;]]
+        t.assert_equals(box.execute(sql).rows, {{970}, {969}, {968}})
+        sql = [[SELECT COUNT(*) FROM t WHERE id > 31 AND id <= 97;]]
+        t.assert_equals(box.execute(sql).rows, {{66}})
+        sql = [[SELECT COUNT(*) FROM t INDEXED BY t_a WHERE a = 3;]]
+        t.assert_equals(box.execute(sql).rows, {{100}})
+    end)
+end
+
+-- Checks that the inner loop of a join is repositioned correctly.
+g.test_join = function(cg)
+    cg.server:exec(function()
+        local sql = [[SELECT COUNT(*) FROM t AS t1, t AS t2
+                      WHERE t2.id > t1.id AND t2.id <= t1.id + 40;]]
+        -- The last 40 rows of t1 have less than 40 matches.
+        t.assert_equals(box.execute(sql).rows, {{960 * 40 + 40 * 39 / 2}})
+    end)
+end
+
+-- Checks that statements modifying the table see their own changes.
+g.test_dml = function(cg)
+    cg.server:exec(function()
+        box.begin()
+        box.execute([[UPDATE t SET a = a + 10;]])
+        box.execute([[INSERT INTO t SELECT id + 1000, a FROM t;]])
+        local sql = [[SELECT COUNT(*), MIN(a), MAX(a) FROM t;]]
+        t.assert_equals(box.execute(sql).rows, {{2000, 10, 19}})
+        box.rollback()
+    end)
+end
+
+-- Checks that a scan survives yields and concurrent changes.
+g.test_yield = function(cg)
+    cg.server:exec(function()
+        local fiber = require('fiber')
+        box.schema.func.create('SLEEP', {
+            language = 'LUA', returns = 'integer',
+            param_list = {'integer'}, exports = {'LUA', 'SQL'},
+            body = [[function(x) require('fiber').sleep(0) return x end]],
+        })
+        local f = fiber.new(function()
+            for i = 1, 1000, 2 do
+                box.space.T:replace({i, 100})
+                fiber.sleep(0)
+            end
+        end)
+        f:set_joinable(true)
+        local res = box.execute([[SELECT COUNT(SLEEP(id)) FROM t;]])
+        t.assert_equals(res.rows, {{1000}})
+        t.assert(f:join())
+        t.assert_equals(box.execute([[SELECT COUNT(*) FROM t
+                                      WHERE a = 100;]]).rows, {{500}})
+        box.schema.func.drop('SLEEP')
+    end)
+end
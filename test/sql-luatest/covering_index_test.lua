@@ -0,0 +1,112 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+    cg.server:exec(function()
+        box.execute([[SET SESSION "sql_seq_scan" = true;]])
+        -- Returns the number of primary key lookups done by the statement.
+        rawset(_G, 'pk_lookups', function(sql)
+            local pk = box.space.T.index[0]
+            local lookup = pk:stat().lookup
+            local res, err = box.execute(sql)
+            t.assert_equals(err, nil)
+            return pk:stat().lookup - lookup, res.rows
+        end)
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.before_each(function(cg)
+    cg.server:exec(function()
+        box.execute([[CREATE TABLE t (id INT PRIMARY KEY, a INT, b INT,
+                                      c INT) WITH ENGINE = 'vinyl';]])
+        box.execute([[CREATE INDEX t_ab ON t (a, b);]])
+        for i = 1, 10 do
+            box.space.T:insert({i, i % 3, i, i * 10})
+        end
+    end)
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        box.execute([[DROP TABLE IF EXISTS t;]])
+    end)
+end)
+
+-- Checks that a covering index scan doesn't look up the primary index.
+g.test_covering = function(cg)
+    cg.server:exec(function()
+        box.snapshot()
+        local sql = [[SELECT id, b FROM t INDEXED BY t_ab WHERE a = 1;]]
+        local lookups, rows = _G.pk_lookups(sql)
+        t.assert_equals(lookups, 0)
+        t.assert_equals(rows, {{1, 1}, {4, 4}, {7, 7}, {10, 10}})
+        sql = [[SELECT COUNT(*) FROM t INDEXED BY t_ab WHERE a > 0;]]
+        lookups, rows = _G.pk_lookups(sql)
+        t.assert_equals(lookups, 0)
+        t.assert_equals(rows, {{7}})
+        sql = [[SELECT id, c FROM t INDEXED BY t_ab WHERE a = 1;]]
+        lookups, rows = _G.pk_lookups(sql)
+        t.assert_equals(lookups, 4)
+        t.assert_equals(rows, {{1, 10}, {4, 40}, {7, 70}, {10, 100}})
+    end)
+end
+
+-- Checks that a covering index scan sees changes not dumped to disk.
+g.test_changes = function(cg)
+    cg.server:exec(function()
+        box.snapshot()
+        box.execute([[DELETE FROM t WHERE id = 4;]])
+        box.execute([[UPDATE t SET c = 0 WHERE id = 7;]])
+        box.execute([[UPDATE t SET b = 0 WHERE id = 10;]])
+        box.execute([[INSERT INTO t VALUES (11, 1, 11, 110);]])
+        local sql = [[SELECT id, b FROM t INDEXED BY t_ab WHERE a = 1;]]
+        local lookups, rows = _G.pk_lookups(sql)
+        t.assert_equals(lookups, 0)
+        t.assert_equals(rows, {{10, 0}, {1, 1}, {7, 7}, {11, 11}})
+        box.begin()
+        box.execute([[DELETE FROM t WHERE id = 1;]])
+        box.execute([[INSERT INTO t VALUES (12, 1, 12, 120);]])
+        rows = box.execute(sql).rows
+        t.assert_equals(rows, {{10, 0}, {7, 7}, {11, 11}, {12, 12}})
+        box.rollback()
+        t.assert_equals(box.execute(sql).rows,
+                        {{10, 0}, {1, 1}, {7, 7}, {11, 11}})
+    end)
+end
+
+-- Checks that the primary index is looked up if DELETEs are deferred,
+-- because the secondary index may contain stale tuples then.
+g.test_defer_deletes = function(cg)
+    cg.server:exec(function()
+        box.space.T:alter({defer_deletes = true})
+        box.snapshot()
+        box.execute([[DELETE FROM t WHERE id = 4;]])
+        local sql = [[SELECT id, b FROM t INDEXED BY t_ab WHERE a = 1;]]
+        local lookups, rows = _G.pk_lookups(sql)
+        t.assert_equals(lookups, 4)
+        t.assert_equals(rows, {{1, 1}, {7, 7}, {10, 10}})
+    end)
+end
+
+-- Checks that data change statements don't use covering indexes.
+g.test_dml = function(cg)
+    cg.server:exec(function()
+        box.snapshot()
+        box.execute([[CREATE TABLE t2 (id INT PRIMARY KEY, b INT, c INT)
+                      WITH ENGINE = 'vinyl';]])
+        box.execute([[INSERT INTO t2 SELECT id, b, a FROM t INDEXED BY t_ab
+                      WHERE a = 2;]])
+        local sql = [[SELECT * FROM t2;]]
+        t.assert_equals(box.execute(sql).rows,
+                        {{2, 2, 2}, {5, 5, 2}, {8, 8, 2}})
+        box.execute([[DROP TABLE t2;]])
+    end)
+end
@@ -0,0 +1,93 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+    cg.server:exec(function()
+        box.execute([[SET SESSION "sql_seq_scan" = true;]])
+        box.execute([[CREATE TABLE t (id INT PRIMARY KEY, a INT);]])
+        for i = 1, 10 do
+            box.space.T:insert({i, i % 3})
+        end
+        -- Returns the total count of the given opcode.
+        rawset(_G, 'opcode_count', function(res, opcode)
+            local count = 0
+            for _, row in ipairs(res.rows) do
+                if row[2] == opcode then
+                    count = count + row[9]
+                end
+            end
+            return count
+        end)
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+-- Checks that EXPLAIN ANALYZE lists opcodes with their statistics.
+g.test_select = function(cg)
+    cg.server:exec(function()
+        local res = box.execute([[EXPLAIN ANALYZE SELECT id FROM t
+                                  WHERE a = 1;]])
+        local names = {}
+        for _, col in ipairs(res.metadata) do
+            table.insert(names, col.name)
+        end
+        t.assert_equals(names, {'addr', 'opcode', 'p1', 'p2', 'p3', 'p4',
+                                'p5', 'comment', 'count', 'time'})
+        local plain = box.execute([[EXPLAIN SELECT id FROM t WHERE a = 1;]])
+        t.assert_equals(#res.rows, #plain.rows)
+        t.assert_equals(_G.opcode_count(res, 'Init'), 1)
+        t.assert_equals(_G.opcode_count(res, 'Next'), 10)
+        t.assert_equals(_G.opcode_count(res, 'ResultRow'), 4)
+        local time = 0
+        for _, row in ipairs(res.rows) do
+            t.assert_ge(row[10], 0)
+            time = time + row[10]
+        end
+        t.assert_gt(time, 0)
+    end)
+end
+
+-- Checks that EXPLAIN ANALYZE executes data change statements.
+g.test_dml = function(cg)
+    cg.server:exec(function()
+        box.begin()
+        local res = box.execute([[EXPLAIN ANALYZE UPDATE t SET a = 5
+                                  WHERE a = 0;]])
+        t.assert_equals(_G.opcode_count(res, 'Halt'), 1)
+        t.assert_equals(box.execute([[SELECT COUNT(*) FROM t
+                                      WHERE a = 5;]]).rows, {{3}})
+        box.rollback()
+    end)
+end
+
+-- Checks that errors of the statement are returned.
+g.test_error = function(cg)
+    cg.server:exec(function()
+        local _, err = box.execute([[EXPLAIN ANALYZE INSERT INTO t
+                                     VALUES (1, 1);]])
+        t.assert_str_contains(err.message, 'Duplicate key exists')
+        box.execute([[SET SESSION "sql_seq_scan" = false;]])
+        _, err = box.execute([[EXPLAIN ANALYZE SELECT * FROM t;]])
+        t.assert_equals(err.message, "Scanning is not allowed for 'T'")
+        t.assert(box.execute([[EXPLAIN SELECT * FROM t;]]) ~= nil)
+        box.execute([[SET SESSION "sql_seq_scan" = true;]])
+    end)
+end
+
+-- Checks that a prepared EXPLAIN ANALYZE collects statistics anew.
+g.test_prepared = function(cg)
+    cg.server:exec(function()
+        local stmt = box.prepare([[EXPLAIN ANALYZE SELECT id FROM t
+                                   WHERE id > ?;]])
+        t.assert_equals(_G.opcode_count(stmt:execute({5}), 'ResultRow'), 5)
+        t.assert_equals(_G.opcode_count(stmt:execute({8}), 'ResultRow'), 2)
+        stmt:unprepare()
+    end)
+end
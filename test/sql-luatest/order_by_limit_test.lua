@@ -0,0 +1,72 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+    cg.server:exec(function()
+        box.execute([[SET SESSION "sql_seq_scan" = true;]])
+        box.execute([[CREATE TABLE t (id INT PRIMARY KEY, a INT, b INT,
+                                      c STRING);]])
+        box.execute([[CREATE INDEX t_a ON t(a);]])
+        math.randomseed(os.time())
+        for i = 1, 1000 do
+            box.space.T:insert({i, math.random(10), math.random(100),
+                                tostring(math.random(1000))})
+        end
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+-- Checks that ORDER BY with LIMIT returns the same rows as the full sort
+-- for any combination of sorting directions.
+g.test_order_by_limit = function(cg)
+    cg.server:exec(function()
+        local orders = {
+            'a ASC, b DESC, id',
+            'a DESC, b ASC, id DESC',
+            'b DESC, c ASC, id',
+            'c DESC, a ASC, b DESC, id ASC',
+            'a, b, c DESC, id DESC',
+        }
+        for _, order in ipairs(orders) do
+            local sql = 'SELECT * FROM t ORDER BY ' .. order
+            local all = box.execute(sql).rows
+            for _, limit in ipairs({1, 7, 100}) do
+                for _, offset in ipairs({0, 3, 995}) do
+                    local rows = box.execute(sql .. ' LIMIT ? OFFSET ?',
+                                             {limit, offset}).rows
+                    local expected = {}
+                    for i = offset + 1, math.min(offset + limit, #all) do
+                        table.insert(expected, all[i])
+                    end
+                    t.assert_equals(rows, expected, sql)
+                end
+            end
+        end
+    end)
+end
+
+-- Checks that ORDER BY with mixed directions and LIMIT doesn't sort all
+-- the rows.
+g.test_no_sorter = function(cg)
+    cg.server:exec(function()
+        local function opcodes(sql)
+            local res = {}
+            for _, row in ipairs(box.execute('EXPLAIN ' .. sql).rows) do
+                res[row[2]] = true
+            end
+            return res
+        end
+        local ops = opcodes('SELECT * FROM t ORDER BY a, b DESC LIMIT 5')
+        t.assert_not(ops.SorterOpen)
+        t.assert(ops.OpenTEphemeral)
+        ops = opcodes('SELECT * FROM t ORDER BY a, b DESC')
+        t.assert(ops.SorterOpen)
+    end)
+end
@@ -0,0 +1,102 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+    cg.server:exec(function()
+        box.execute([[SET SESSION "sql_seq_scan" = true;]])
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        box.execute([[DROP TABLE IF EXISTS t;]])
+    end)
+end)
+
+-- Checks ORDER BY on integers, including ones that don't fit in INT64.
+g.test_integer = function(cg)
+    cg.server:exec(function()
+        box.execute([[CREATE TABLE t (id INT PRIMARY KEY, v INTEGER);]])
+        local values = {-9223372036854775808LL, -1, 0, 1, 2^53,
+                        9223372036854775807ULL, 9223372036854775808ULL,
+                        18446744073709551615ULL}
+        for _ = 1, 500 do
+            table.insert(values, math.random(-1e9, 1e9))
+        end
+        for i, v in ipairs(values) do
+            box.space.T:insert({i, v})
+        end
+        box.space.T:insert({#values + 1, nil})
+        local rows = box.execute([[SELECT v FROM t ORDER BY v;]]).rows
+        t.assert_equals(rows[1], {box.NULL})
+        t.assert(rows[2][1] == -9223372036854775808LL)
+        t.assert_equals(rows[#rows], {18446744073709551615ULL})
+        for i = 3, #rows do
+            t.assert(rows[i - 1][1] <= rows[i][1])
+        end
+        rows = box.execute([[SELECT v FROM t ORDER BY v DESC;]]).rows
+        t.assert_equals(rows[1], {18446744073709551615ULL})
+        t.assert_equals(rows[#rows], {box.NULL})
+        for i = 2, #rows - 1 do
+            t.assert(rows[i - 1][1] >= rows[i][1])
+        end
+    end)
+end
+
+-- Checks ORDER BY on strings sharing long prefixes and containing zeros.
+g.test_string = function(cg)
+    cg.server:exec(function()
+        box.execute([[CREATE TABLE t (id INT PRIMARY KEY, v STRING);]])
+        local chars = {'a', 'b', '\0'}
+        local values = {}
+        for i = 1, 1000 do
+            local s = ''
+            for _ = 1, math.random(0, 12) do
+                s = s .. chars[math.random(#chars)]
+            end
+            values[i] = s
+            box.space.T:insert({i, s})
+        end
+        table.sort(values)
+        local rows = box.execute([[SELECT v FROM t ORDER BY v;]]).rows
+        for i, row in ipairs(rows) do
+            t.assert_equals(row[1], values[i])
+        end
+        rows = box.execute([[SELECT v FROM t ORDER BY v DESC;]]).rows
+        for i, row in ipairs(rows) do
+            t.assert_equals(row[1], values[#values - i + 1])
+        end
+    end)
+end
+
+-- Checks that strings with a collation are not sorted bytewise.
+g.test_collation = function(cg)
+    cg.server:exec(function()
+        box.execute([[CREATE TABLE t (id INT PRIMARY KEY,
+                                      v STRING COLLATE "unicode_ci");]])
+        box.execute([[INSERT INTO t VALUES (1, 'B'), (2, 'a'), (3, 'C');]])
+        local rows = box.execute([[SELECT v FROM t ORDER BY v;]]).rows
+        t.assert_equals(rows, {{'a'}, {'B'}, {'C'}})
+    end)
+end
+
+-- Checks ORDER BY on a column of mixed types.
+g.test_scalar = function(cg)
+    cg.server:exec(function()
+        box.execute([[CREATE TABLE t (id INT PRIMARY KEY, v SCALAR);]])
+        box.execute([[INSERT INTO t VALUES (1, 'b'), (2, 2), (3, 1.5),
+                      (4, -1), (5, 'a'), (6, TRUE),
+                      (7, 18446744073709551615);]])
+        local rows = box.execute([[SELECT v FROM t ORDER BY v;]]).rows
+        t.assert_equals(rows, {{true}, {-1}, {1.5}, {2},
+                               {18446744073709551615ULL}, {'a'}, {'b'}})
+    end)
+end
@@ -0,0 +1,111 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+    cg.server:exec(function()
+        box.execute([[SET SESSION "sql_seq_scan" = true;]])
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.before_each(function(cg)
+    cg.server:exec(function()
+        box.execute([[CREATE TABLE t (id INT PRIMARY KEY, a INT);]])
+        box.execute([[INSERT INTO t VALUES (1, 10), (2, 20), (3, 30);]])
+    end)
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        box.execute([[DROP TABLE IF EXISTS t;]])
+        require('internal.tweaks').sql_stmt_reuse_count_max = 64
+    end)
+end)
+
+-- Checks that a statement executed several times with different
+-- parameters gives the right results.
+g.test_bind = function(cg)
+    cg.server:exec(function()
+        local sql = [[SELECT a FROM t WHERE id = ?;]]
+        for _ = 1, 3 do
+            for i = 1, 3 do
+                t.assert_equals(box.execute(sql, {i}).rows, {{i * 10}})
+            end
+            t.assert_equals(box.execute(sql, {4}).rows, {})
+        end
+        sql = [[INSERT INTO t VALUES (?, ?);]]
+        t.assert_equals(box.execute(sql, {4, 40}).row_count, 1)
+        local _, err = box.execute(sql, {4, 40})
+        t.assert_str_contains(err.message, 'Duplicate key exists')
+        t.assert_equals(box.execute(sql, {5, 50}).row_count, 1)
+        sql = [[SELECT COUNT(*) FROM t;]]
+        t.assert_equals(box.execute(sql).rows, {{5}})
+        t.assert_equals(box.execute(sql).rows, {{5}})
+    end)
+end
+
+-- Checks that a statement is recompiled after a schema change.
+g.test_schema_change = function(cg)
+    cg.server:exec(function()
+        local sql = [[SELECT * FROM t WHERE id = 1;]]
+        t.assert_equals(box.execute(sql).rows, {{1, 10}})
+        box.execute([[ALTER TABLE t ADD COLUMN b INT;]])
+        box.execute([[UPDATE t SET b = 100 WHERE id = 1;]])
+        local res = box.execute(sql)
+        t.assert_equals(res.rows, {{1, 10, 100}})
+        t.assert_equals(#res.metadata, 3)
+    end)
+end
+
+-- Checks that a statement is recompiled after a session setting change.
+g.test_session_settings = function(cg)
+    cg.server:exec(function()
+        local sql = [[SELECT a FROM t WHERE id = 1;]]
+        t.assert_equals(box.execute(sql).metadata[1].name, 'A')
+        box.execute([[SET SESSION "sql_full_column_names" = true;]])
+        t.assert_equals(box.execute(sql).metadata[1].name, 'T.A')
+        box.execute([[SET SESSION "sql_full_column_names" = false;]])
+        t.assert_equals(box.execute(sql).metadata[1].name, 'A')
+    end)
+end
+
+-- Checks that the same statement may be executed recursively.
+g.test_recursion = function(cg)
+    cg.server:exec(function()
+        local sql = [[SELECT COUNT(*) FROM t WHERE a > F(id);]]
+        box.schema.func.create('F', {
+            language = 'LUA', returns = 'integer',
+            param_list = {'integer'}, exports = {'LUA', 'SQL'},
+            body = string.format([[function(x)
+                if rawget(_G, 'in_f') then
+                    return 0
+                end
+                rawset(_G, 'in_f', true)
+                local n = box.execute(%q).rows[1][1]
+                rawset(_G, 'in_f', nil)
+                return n * 10 - 15
+            end]], sql),
+        })
+        -- The nested execution counts all 3 rows, so F() returns 15.
+        t.assert_equals(box.execute(sql).rows, {{2}})
+        t.assert_equals(box.execute(sql).rows, {{2}})
+        box.schema.func.drop('F')
+    end)
+end
+
+-- Checks that no statements are kept if reuse is disabled.
+g.test_disabled = function(cg)
+    cg.server:exec(function()
+        require('internal.tweaks').sql_stmt_reuse_count_max = 0
+        local sql = [[SELECT a FROM t WHERE id = ?;]]
+        t.assert_equals(box.execute(sql, {1}).rows, {{10}})
+        t.assert_equals(box.execute(sql, {2}).rows, {{20}})
+    end)
+end
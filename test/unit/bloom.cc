@@ -96,9 +96,34 @@ store_load_test()
 	cout << "fp_rate_too_big = " << fp_rate_too_big << endl;
 }
 
+void
+alignment_test()
+{
+	cout << "*** " << __func__ << " ***" << endl;
+	uint32_t misaligned_count = 0;
+	for (uint32_t count = 1; count <= 1000; count *= 10) {
+		struct bloom bloom;
+		bloom_create(&bloom, count, 0.05);
+		if ((uintptr_t)bloom.table % BLOOM_CACHE_LINE != 0)
+			misaligned_count++;
+		struct bloom test = bloom;
+		char *buf = (char *)malloc(bloom_store_size(&bloom) + 1);
+		/* Make the source buffer misaligned on purpose. */
+		bloom_store(&bloom, buf + 1);
+		bloom_load_table(&test, buf + 1);
+		free(buf);
+		if ((uintptr_t)test.table % BLOOM_CACHE_LINE != 0)
+			misaligned_count++;
+		bloom_destroy(&test);
+		bloom_destroy(&bloom);
+	}
+	cout << "misaligned_count = " << misaligned_count << endl;
+}
+
 int
 main(void)
 {
 	simple_test();
 	store_load_test();
+	alignment_test();
 }
@@ -115,6 +115,67 @@ static int compare_key(const elem_t &a, long b)
 #define bps_tree_key_t uint32_t
 #define bps_tree_arg_t int
 #include "salad/bps_tree.h"
+#undef BPS_TREE_NAME
+#undef BPS_TREE_BLOCK_SIZE
+#undef BPS_TREE_EXTENT_SIZE
+#undef BPS_TREE_COMPARE
+#undef BPS_TREE_COMPARE_KEY
+#undef BPS_TREE_IS_IDENTICAL
+#undef bps_tree_elem_t
+#undef bps_tree_key_t
+#undef bps_tree_arg_t
+
+/* tree with search by hints, hint is value divided by 8 */
+struct hinted_elem {
+	long value;
+	uint64_t hint;
+};
+
+static bool
+hinted_range(long value, uint64_t *lo, uint64_t *hi)
+{
+	*lo = *hi = value / 8;
+	return true;
+}
+
+#define BPS_TREE_NAME hinted
+#define BPS_TREE_BLOCK_SIZE 128 /* value is to low specially for tests */
+#define BPS_TREE_EXTENT_SIZE 2048 /* value is to low specially for tests */
+#define BPS_TREE_IS_IDENTICAL(a, b) ((a).value == (b).value)
+#define BPS_TREE_COMPARE(a, b, arg) compare((a).value, (b).value)
+#define BPS_TREE_COMPARE_KEY(a, b, arg) compare((a).value, b)
+#define BPS_TREE_ELEM_HINT(a) (a).hint
+#define BPS_TREE_KEY_HINT_RANGE(a, arg, lo, hi) hinted_range(a, lo, hi)
+#define BPS_TREE_ELEM_HINT_RANGE(a, arg, lo, hi) hinted_range((a).value, lo, hi)
+#define bps_tree_elem_t struct hinted_elem
+#define bps_tree_key_t long
+#define bps_tree_arg_t int
+#include "salad/bps_tree.h"
+#undef BPS_TREE_NAME
+#undef BPS_TREE_BLOCK_SIZE
+#undef BPS_TREE_EXTENT_SIZE
+#undef BPS_TREE_IS_IDENTICAL
+#undef BPS_TREE_COMPARE
+#undef BPS_TREE_COMPARE_KEY
+#undef BPS_TREE_ELEM_HINT
+#undef BPS_TREE_KEY_HINT_RANGE
+#undef BPS_TREE_ELEM_HINT_RANGE
+#undef bps_tree_elem_t
+#undef bps_tree_key_t
+#undef bps_tree_arg_t
+
+/* tree with order statistics */
+#define BPS_TREE_NAME card
+#define BPS_TREE_BLOCK_SIZE 128 /* value is to low specially for tests */
+#define BPS_TREE_EXTENT_SIZE 2048 /* value is to low specially for tests */
+#define BPS_TREE_IS_IDENTICAL(a, b) (a == b)
+#define BPS_TREE_COMPARE(a, b, arg) compare(a, b)
+#define BPS_TREE_COMPARE_KEY(a, b, arg) compare(a, b)
+#define BPS_INNER_CARD
+#define bps_tree_elem_t type_t
+#define bps_tree_key_t type_t
+#define bps_tree_arg_t int
+#include "salad/bps_tree.h"
 
 #define bps_insert_and_check(tree_name, tree, elem, replaced) \
 {\
@@ -925,6 +986,151 @@ insert_successor_test()
 	footer();
 }
 
+static void
+hinted_search_test()
+{
+	header();
+	srand(0);
+
+	test tree;
+	test_create(&tree, 0, extent_alloc, extent_free, &extents_count, NULL);
+	hinted hinted_tree;
+	hinted_create(&hinted_tree, 0, extent_alloc, extent_free,
+		      &extents_count, NULL);
+
+	const long limit = 2000;
+	for (long i = 0; i < limit; i++) {
+		long v = rand() % (limit * 2);
+		struct hinted_elem elem = {v, (uint64_t)v / 8};
+		test_insert(&tree, v, NULL, NULL);
+		hinted_insert(&hinted_tree, elem, NULL, NULL);
+	}
+	fail_unless(test_size(&tree) == hinted_size(&hinted_tree));
+
+	for (long v = -1; v <= limit * 2; v++) {
+		bool exact, hinted_exact;
+		test_iterator itr = test_lower_bound(&tree, v, &exact);
+		hinted_iterator hinted_itr =
+			hinted_lower_bound(&hinted_tree, v, &hinted_exact);
+		fail_unless(exact == hinted_exact);
+		if (test_iterator_is_invalid(&itr)) {
+			fail_unless(hinted_iterator_is_invalid(&hinted_itr));
+		} else {
+			fail_unless(*test_iterator_get_elem(&tree, &itr) ==
+				    hinted_iterator_get_elem(&hinted_tree,
+							     &hinted_itr)->value);
+		}
+
+		itr = test_upper_bound(&tree, v, &exact);
+		hinted_itr = hinted_upper_bound(&hinted_tree, v, &hinted_exact);
+		fail_unless(exact == hinted_exact);
+		if (test_iterator_is_invalid(&itr)) {
+			fail_unless(hinted_iterator_is_invalid(&hinted_itr));
+		} else {
+			fail_unless(*test_iterator_get_elem(&tree, &itr) ==
+				    hinted_iterator_get_elem(&hinted_tree,
+							     &hinted_itr)->value);
+		}
+
+		bool found = test_find(&tree, v) != NULL;
+		struct hinted_elem elem = {v, (uint64_t)v / 8};
+		fail_unless(found == (hinted_find(&hinted_tree, v) != NULL));
+		if (found) {
+			fail_unless(hinted_delete(&hinted_tree, elem) == 0);
+			fail_unless(hinted_find(&hinted_tree, v) == NULL);
+		}
+	}
+	fail_unless(hinted_size(&hinted_tree) == 0);
+
+	test_destroy(&tree);
+	hinted_destroy(&hinted_tree);
+
+	footer();
+}
+
+/**
+ * Check offsets of elements and positioning by offset in a tree with
+ * order statistics against a plain array of flags.
+ */
+static void
+offset_test()
+{
+	header();
+	srand(0);
+
+	const type_t limit = 3000;
+	bool *present = (bool *)calloc(limit, sizeof(*present));
+	card tree;
+	card_create(&tree, 0, extent_alloc, extent_free, &extents_count, NULL);
+
+	for (long i = 0; i < limit * 4; i++) {
+		type_t v = rand() % limit;
+		/* More insertions first, then more deletions. */
+		bool insert = rand() % limit * 4 > i;
+		if (insert && !present[v]) {
+			fail_unless(card_insert(&tree, v, NULL, NULL) == 0);
+			present[v] = true;
+		} else if (!insert && present[v]) {
+			fail_unless(card_delete(&tree, v) == 0);
+			present[v] = false;
+		}
+		if (i % 100 != 0)
+			continue;
+		if (card_debug_check(&tree))
+			fail("debug check nonzero", "true");
+
+		size_t count = 0;
+		for (type_t k = 0; k < limit; k++) {
+			bool exact;
+			size_t offset;
+			card_lower_bound_get_offset(&tree, k, &exact, &offset);
+			fail_unless(exact == present[k]);
+			fail_unless(offset == count);
+			card_lower_bound_elem_get_offset(&tree, k, &exact,
+							 &offset);
+			fail_unless(offset == count);
+			if (present[k]) {
+				card_iterator itr = card_iterator_at(&tree,
+								     count);
+				fail_unless(*card_iterator_get_elem(&tree,
+								    &itr) == k);
+				count++;
+			}
+			card_upper_bound_get_offset(&tree, k, &exact, &offset);
+			fail_unless(offset == count);
+		}
+		fail_unless(count == card_size(&tree));
+		card_iterator itr = card_iterator_at(&tree, count);
+		fail_unless(card_iterator_is_invalid(&itr));
+	}
+	card_destroy(&tree);
+
+	type_t *arr = (type_t *)calloc(limit, sizeof(*arr));
+	for (type_t i = 0; i < limit; i++)
+		arr[i] = i * 2;
+	const size_t sizes[] = {1, 10, 100, (size_t)limit};
+	for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+		card_create(&tree, 0, extent_alloc, extent_free,
+			    &extents_count, NULL);
+		card_build(&tree, arr, sizes[i]);
+		if (card_debug_check(&tree))
+			fail("debug check nonzero", "true");
+		for (size_t j = 0; j < sizes[i]; j++) {
+			size_t offset;
+			card_lower_bound_get_offset(&tree, arr[j] + 1, NULL,
+						    &offset);
+			fail_unless(offset == j + 1);
+			card_iterator itr = card_iterator_at(&tree, j);
+			fail_unless(*card_iterator_get_elem(&tree, &itr) ==
+				    arr[j]);
+		}
+		card_destroy(&tree);
+	}
+
+	free(arr);
+	free(present);
+	footer();
+}
 
 int
 main(void)
@@ -942,4 +1148,6 @@ main(void)
 	insert_get_iterator();
 	delete_value_check();
 	insert_successor_test();
+	hinted_search_test();
+	offset_test();
 }
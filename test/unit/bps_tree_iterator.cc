@@ -544,6 +544,52 @@ iterator_freeze_check()
 	footer();
 }
 
+static void
+iterator_leaf_elems_check()
+{
+	header();
+
+	struct test tree;
+	test_create(&tree, 0, extent_alloc, extent_free,
+		    &total_extents_allocated, NULL);
+	const long count = 1000;
+	for (long i = 0; i < count; i++) {
+		elem_t e;
+		e.first = i;
+		e.second = 0;
+		test_insert(&tree, e, 0, 0);
+	}
+	struct test_iterator iterator = test_invalid_iterator();
+	size_t leaf_count = 0;
+	if (test_iterator_get_leaf_elems(&tree, &iterator, &leaf_count) != 0)
+		fail("invalid iterator elems", "true");
+	iterator = test_first(&tree);
+	long visited = 0;
+	elem_t *elems;
+	while ((elems = test_iterator_get_leaf_elems(&tree, &iterator,
+						     &leaf_count)) != 0) {
+		if (elems != test_iterator_get_elem(&tree, &iterator))
+			fail("leaf elems start", "true");
+		if (leaf_count == 0 || visited + (long)leaf_count > count)
+			fail("leaf elems count", "true");
+		for (size_t i = 0; i < leaf_count; i++) {
+			if (elems[i].first != visited + (long)i)
+				fail("leaf elems order", "true");
+		}
+		test_iterator_next(&tree, &iterator);
+		visited++;
+	}
+	if (visited != count)
+		fail("leaf elems visited", "true");
+	/* An iterator positioned past the end of a leaf moves on. */
+	iterator = test_upper_bound(&tree, count / 2, NULL);
+	elems = test_iterator_get_leaf_elems(&tree, &iterator, &leaf_count);
+	if (elems == 0 || elems->first != count / 2 + 1)
+		fail("leaf elems after upper bound", "true");
+	test_destroy(&tree);
+
+	footer();
+}
 
 int
 main(void)
@@ -552,6 +598,7 @@ main(void)
 	iterator_check();
 	iterator_invalidate_check();
 	iterator_freeze_check();
+	iterator_leaf_elems_check();
 	if (total_extents_allocated) {
 		fail("memory leak", "true");
 	}
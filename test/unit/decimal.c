@@ -6,6 +6,7 @@
 #include <string.h>
 #include <inttypes.h>
 #include <float.h> /* DBL_DIG */
+#include "trivia/util.h"
 
 #define UNIT_TAP_COMPATIBLE 1
 #include "unit.h"
@@ -295,6 +296,57 @@ test_mp_decimal(void)
 	return check_plan();
 }
 
+static int
+test_int64(void)
+{
+	const char *fit[] = {
+		"0", "-0", "1", "-1", "0.5", "-0.50", "123.456", "-1e10",
+		"1e20", "999999999999999999", "-999999999999999.999",
+		"0.000000000000000000000000000001",
+	};
+	const char *no_fit[] = {
+		"1234567891234567890", "-0.1234567891234567890",
+		"99999999999999999999999999999999999999",
+	};
+	int fit_count = lengthof(fit);
+	plan(fit_count * fit_count + 2 * fit_count + (int)lengthof(no_fit));
+
+	decimal_t dec[lengthof(fit)];
+	int64_t coef[lengthof(fit)];
+	int32_t scale[lengthof(fit)];
+	for (int i = 0; i < fit_count; i++) {
+		decimal_from_string(&dec[i], fit[i]);
+		uint32_t len = decimal_len(&dec[i]);
+		decimal_pack(buf, &dec[i]);
+		ok(decimal_unpack_int64(buf, len, &coef[i], &scale[i]),
+		   "decimal_unpack_int64(%s)", fit[i]);
+		int64_t num, expected;
+		bool is_int64 = decimal_to_int64(&dec[i], &expected) != NULL;
+		ok(decimal_int64_to_int64(coef[i], scale[i], &num) == is_int64 &&
+		   (!is_int64 || num == expected),
+		   "decimal_int64_to_int64(%s)", fit[i]);
+	}
+	for (int i = 0; i < fit_count; i++) {
+		for (int j = 0; j < fit_count; j++) {
+			is(decimal_compare_int64(coef[i], scale[i],
+						 coef[j], scale[j]),
+			   decimal_compare(&dec[i], &dec[j]),
+			   "decimal_compare_int64(%s, %s)", fit[i], fit[j]);
+		}
+	}
+	for (int i = 0; i < (int)lengthof(no_fit); i++) {
+		decimal_t d;
+		decimal_from_string(&d, no_fit[i]);
+		uint32_t len = decimal_len(&d);
+		decimal_pack(buf, &d);
+		int64_t c;
+		int32_t s;
+		ok(!decimal_unpack_int64(buf, len, &c, &s),
+		   "decimal_unpack_int64(%s) fails", no_fit[i]);
+	}
+	return check_plan();
+}
+
 static int
 test_to_int(void)
 {
@@ -410,7 +462,7 @@ test_mp_print(void)
 int
 main(void)
 {
-	plan(312);
+	plan(313);
 
 	dectest(314, 271, uint64, uint64_t);
 	dectest(65535, 23456, uint64, uint64_t);
@@ -471,6 +523,7 @@ main(void)
 	dectest_op1_fail(sqrt, -10);
 
 	test_to_int();
+	test_int64();
 
 	test_pack_unpack();
 
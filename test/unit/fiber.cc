@@ -752,6 +752,8 @@ int main()
 	memory_init();
 	fiber_init(fiber_cxx_invoke);
 	fiber_attr_create(&default_attr);
+	/* Custom stack fibers are expected to be deleted on death. */
+	fiber_custom_stack_cache_size = 0;
 	struct fiber *main = fiber_new_system_xc("main", main_f);
 	fiber_wakeup(main);
 	ev_run(loop(), 0);
@@ -35,9 +35,9 @@ main_f(va_list ap)
 
 	header();
 #ifdef NDEBUG
-	plan(1);
+	plan(4);
 #else
-	plan(11);
+	plan(14);
 #endif
 
 	/*
@@ -137,6 +137,37 @@ main_f(va_list ap)
 	ok(fiber_count_total() == fiber_count, "fiber is deleted");
 #endif /* ifndef NDEBUG */
 
+	/*
+	 * Check that fibers with a custom stack size are cached and
+	 * reused.
+	 */
+	fiber_custom_stack_cache_size = 4 * default_attr.stack_size;
+	fiber_attr_delete(fiber_attr);
+	fiber_attr = fiber_attr_new();
+	fiber_attr_setstacksize(fiber_attr, default_attr.stack_size * 2);
+	fiber = fiber_new_ex("test_cache", fiber_attr, noop_f);
+	fiber_set_joinable(fiber, true);
+	fiber_start(fiber);
+	fiber_join(fiber);
+	cord_collect_garbage(cord());
+	ok(fiber_count_total() == fiber_count + 1, "custom stack is cached");
+
+	uint64_t reused = cord()->create_stat.reused;
+	fiber = fiber_new_ex("test_cache", fiber_attr, noop_f);
+	ok(fiber != NULL && cord()->create_stat.reused == reused + 1,
+	   "custom stack is reused");
+	fiber_set_joinable(fiber, true);
+	fiber_start(fiber);
+	fiber_join(fiber);
+
+	/*
+	 * Check fiber prewarming.
+	 */
+	int count = fiber_count_total();
+	ok(fiber_prewarm(fiber_attr, 2) == 2 &&
+	   fiber_count_total() == count + 2, "fibers are prewarmed");
+	fiber_custom_stack_cache_size = 0;
+
 	fiber_attr_delete(fiber_attr);
 	ev_break(loop(), EVBREAK_ALL);
 
@@ -149,6 +180,8 @@ int main()
 	memory_init();
 	fiber_init(fiber_c_invoke);
 	fiber_attr_create(&default_attr);
+	/* Custom stack fibers are expected to be deleted on death. */
+	fiber_custom_stack_cache_size = 0;
 	struct fiber *f = fiber_new("main", main_f);
 	fiber_wakeup(f);
 	ev_run(loop(), 0);
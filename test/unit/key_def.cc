@@ -1367,6 +1367,108 @@ test_tuple_compare_sequential_no_optional_parts_unique(bool ascending_key,
 	check_plan();
 }
 
+static int
+test_sign(int rc)
+{
+	return rc > 0 ? 1 : rc < 0 ? -1 : 0;
+}
+
+static void
+test_packed_hint(void)
+{
+	plan(5);
+	header();
+
+	struct key_def *key_def = test_key_def_new(
+		"[{%s%u%s%s}{%s%u%s%s}]",
+		"field", 0, "type", "integer",
+		"field", 1, "type", "unsigned");
+	is(key_def->hint_part_count, 2, "integer parts are packed in a hint");
+
+	struct key_def *str_def = test_key_def_new(
+		"[{%s%u%s%s}{%s%u%s%s}]",
+		"field", 0, "type", "unsigned",
+		"field", 1, "type", "string");
+	is(str_def->hint_part_count, 1, "string part is not packed in a hint");
+	key_def_delete(str_def);
+
+	/* Sorted in ascending order, including values that don't fit. */
+	const long long values[][2] = {
+		{-(1LL << 40), 7},
+		{-(1LL << 40) + 1, 3},
+		{-(1LL << 31), 1LL << 40},
+		{-5, 100},
+		{-5, 1LL << 40},
+		{0, 0},
+		{0, 1},
+		{1, 0},
+		{(1LL << 31) - 2, 9},
+		{(1LL << 31) - 1, 0},
+		{1LL << 40, 5},
+		{(1LL << 40) + 1, 0},
+	};
+	const int count = lengthof(values);
+	struct tuple *tuples[count];
+	char *keys[count];
+	char *prefixes[count];
+	for (int i = 0; i < count; i++) {
+		tuples[i] = test_tuple_new("[%lld%lld]",
+					   values[i][0], values[i][1]);
+		keys[i] = test_key_new("[%lld%lld]",
+				       values[i][0], values[i][1]);
+		prefixes[i] = test_key_new("[%lld]", values[i][0]);
+	}
+
+	bool tuple_ok = true;
+	bool tuple_key_ok = true;
+	bool key_ok = true;
+	for (int i = 0; i < count; i++) {
+		hint_t hint = tuple_hint(tuples[i], key_def);
+		for (int j = 0; j < count; j++) {
+			int rc = tuple_compare(tuples[i], hint, tuples[j],
+					       tuple_hint(tuples[j], key_def),
+					       key_def);
+			if (test_sign(rc) != test_sign(i - j))
+				tuple_ok = false;
+			for (uint32_t n = 1; n <= 2; n++) {
+				const char *key = n == 1 ? prefixes[j] :
+							   keys[j];
+				mp_decode_array(&key);
+				hint_t kh = key_hint(key, n, key_def);
+				int rc_hint = tuple_compare_with_key(
+					tuples[i], hint, key, n, kh, key_def);
+				rc = tuple_compare_with_key(
+					tuples[i], HINT_NONE, key, n,
+					HINT_NONE, key_def);
+				if (test_sign(rc_hint) != test_sign(rc))
+					tuple_key_ok = false;
+				const char *key_a = keys[i];
+				mp_decode_array(&key_a);
+				rc_hint = key_compare(
+					key_a, 2, key_hint(key_a, 2, key_def),
+					key, n, kh, key_def);
+				rc = key_compare(key_a, 2, HINT_NONE,
+						 key, n, HINT_NONE, key_def);
+				if (test_sign(rc_hint) != test_sign(rc))
+					key_ok = false;
+			}
+		}
+	}
+	ok(tuple_ok, "tuple_compare with packed hints");
+	ok(tuple_key_ok, "tuple_compare_with_key with packed hints");
+	ok(key_ok, "key_compare with packed hints");
+
+	for (int i = 0; i < count; i++) {
+		tuple_delete(tuples[i]);
+		free(keys[i]);
+		free(prefixes[i]);
+	}
+	key_def_delete(key_def);
+
+	footer();
+	check_plan();
+}
+
 static void
 test_key_def_find_by_fieldno(void)
 {
@@ -1398,7 +1500,7 @@ test_key_def_find_by_fieldno(void)
 static int
 test_main(void)
 {
-	plan(51);
+	plan(52);
 	header();
 
 	test_func_compare();
@@ -1451,6 +1553,7 @@ test_main(void)
 	test_key_compare_singlepart(true, false);
 	test_key_compare_singlepart(false, true);
 	test_key_compare_singlepart(false, false);
+	test_packed_hint();
 	test_key_def_find_by_fieldno();
 
 	footer();
@@ -327,6 +327,42 @@ iterator_freeze_check()
 	footer();
 }
 
+static void
+peek_test()
+{
+	header();
+
+	struct matras_stats stats;
+	matras_stats_create(&stats);
+	stats.extent_count = extents_count;
+
+	struct light_core ht;
+	light_create(&ht, 0, light_extent_size, my_light_alloc, my_light_free,
+		     &extents_count, &stats);
+	hash_value_t val;
+	light_prefetch(&ht, hash(1));
+	if (light_peek(&ht, hash(1), &val))
+		fail("peek in empty table failed!", "true");
+	const hash_value_t count = 1000;
+	for (hash_value_t i = 0; i < count; i++)
+		light_insert(&ht, hash(i * 2), i * 2);
+	for (hash_value_t i = 0; i < 2 * count; i++) {
+		light_prefetch(&ht, hash(i));
+		/*
+		 * Peek looks only at the first record of the chain so it
+		 * may miss a value, but it must never return a value with
+		 * a different hash.
+		 */
+		if (light_peek(&ht, hash(i), &val) && hash(val) != hash(i))
+			fail("peek returned wrong value!", "true");
+		if (i % 2 != 0 && light_peek(&ht, hash(i), &val))
+			fail("peek found a missing value!", "true");
+	}
+	light_destroy(&ht);
+
+	footer();
+}
+
 int
 main(int, const char**)
 {
@@ -335,6 +371,7 @@ main(int, const char**)
 	collision_test();
 	iterator_test();
 	iterator_freeze_check();
+	peek_test();
 	if (extents_count != 0)
 		fail("memory leak!", "true");
 }
@@ -8,6 +8,7 @@
 #include "box/key_def.h"       /* key_def_new(),
 				  key_def_delete() */
 #include "box/merger.h"        /* merger_*() */
+#include "msgpuck.h"           /* mp_encode_*() */
 
 /* {{{ Array merge source */
 
@@ -25,6 +26,10 @@ merge_source_array_destroy(struct merge_source *base);
 static int
 merge_source_array_next(struct merge_source *base, struct tuple_format *format,
 			struct tuple **out);
+static int
+merge_source_array_next_batch(struct merge_source *base,
+			      struct tuple_format *format, struct tuple **out,
+			      uint32_t size, uint32_t *count);
 
 /* Non-virtual methods */
 
@@ -63,6 +68,48 @@ merge_source_array_new(bool even)
 	return &source->base;
 }
 
+/**
+ * Create an array source of tuples [value] for the given values.
+ * If batch is set, the source returns up to 3 tuples per
+ * next_batch() call.
+ */
+static struct merge_source *
+merge_source_array_new_values(const uint32_t *values, uint32_t value_count,
+			      bool batch)
+{
+	static struct merge_source_vtab merge_source_array_vtab = {
+		.destroy = merge_source_array_destroy,
+		.next = merge_source_array_next,
+	};
+	static struct merge_source_vtab merge_source_array_batch_vtab = {
+		.destroy = merge_source_array_destroy,
+		.next = merge_source_array_next,
+		.next_batch = merge_source_array_next_batch,
+	};
+
+	struct merge_source_array *source = malloc(
+		sizeof(struct merge_source_array));
+	assert(source != NULL);
+
+	merge_source_create(&source->base, batch ?
+			    &merge_source_array_batch_vtab :
+			    &merge_source_array_vtab);
+
+	source->tuples = malloc(sizeof(struct tuple *) * (value_count + 1));
+	assert(source->tuples != NULL);
+	for (uint32_t i = 0; i < value_count; ++i) {
+		char data[16];
+		char *end = mp_encode_array(data, 1);
+		end = mp_encode_uint(end, values[i]);
+		source->tuples[i] = tuple_new(tuple_format_runtime, data, end);
+		tuple_ref(source->tuples[i]);
+	}
+	source->tuple_count = value_count;
+	source->cur = 0;
+
+	return &source->base;
+}
+
 /* Virtual methods */
 
 static void
@@ -106,6 +153,26 @@ merge_source_array_next(struct merge_source *base, struct tuple_format *format,
 	return 0;
 }
 
+static int
+merge_source_array_next_batch(struct merge_source *base,
+			      struct tuple_format *format, struct tuple **out,
+			      uint32_t size, uint32_t *count)
+{
+	*count = 0;
+	if (size > 3)
+		size = 3;
+	while (*count < size) {
+		struct tuple *tuple;
+		int rc = merge_source_array_next(base, format, &tuple);
+		(void) rc;
+		assert(rc == 0);
+		if (tuple == NULL)
+			break;
+		out[(*count)++] = tuple;
+	}
+	return 0;
+}
+
 /* }}} */
 
 static struct key_part_def key_part_unsigned = {
@@ -246,10 +313,72 @@ test_merger(struct tuple_format *format)
 	return check_plan();
 }
 
+/**
+ * Merge many sources of different lengths, some of them empty,
+ * some of them returning tuples in batches.
+ */
+int
+test_merger_many_sources(bool reverse)
+{
+	plan(2);
+	header();
+
+	enum { source_count = 37, value_count = 1000 };
+	struct merge_source *sources[source_count];
+	uint32_t *values = malloc(sizeof(uint32_t) * value_count);
+	assert(values != NULL);
+	uint32_t exp_count = 0;
+	for (uint32_t i = 0; i < source_count; ++i) {
+		uint32_t count = 0;
+		/* Source i holds values v such that v % 37 == i. */
+		for (uint32_t j = 0; j < value_count; ++j) {
+			uint32_t v = reverse ? value_count - 1 - j : j;
+			if (v % source_count == i && i % 5 != 0)
+				values[count++] = v;
+		}
+		sources[i] = merge_source_array_new_values(values, count,
+							   i % 2 == 0);
+		exp_count += count;
+	}
+	free(values);
+
+	struct key_def *key_def = key_def_new(&key_part_unsigned, 1, 0);
+	struct merge_source *merger = merger_new(key_def, sources, source_count,
+						 reverse);
+	key_def_delete(key_def);
+
+	uint32_t count = 0;
+	bool is_sorted = true;
+	uint64_t prev = reverse ? UINT64_MAX : 0;
+	struct tuple *tuple = NULL;
+	while (merge_source_next(merger, NULL, &tuple) == 0 &&
+	       tuple != NULL) {
+		const char *data = tuple_data(tuple);
+		mp_decode_array(&data);
+		uint64_t v = mp_decode_uint(&data);
+		if (count > 0 && (reverse ? v >= prev : v <= prev))
+			is_sorted = false;
+		prev = v;
+		++count;
+		tuple_unref(tuple);
+	}
+	is(count, exp_count, "merger returns all tuples (%s)",
+	   reverse ? "descending" : "ascending");
+	ok(is_sorted, "merger returns tuples in order (%s)",
+	   reverse ? "descending" : "ascending");
+
+	merge_source_unref(merger);
+	for (uint32_t i = 0; i < source_count; ++i)
+		merge_source_unref(sources[i]);
+
+	footer();
+	return check_plan();
+}
+
 int
 test_basic()
 {
-	plan(4);
+	plan(6);
 	header();
 
 	struct key_def *key_def = key_def_new(&key_part_integer, 1, 0);
@@ -260,6 +389,8 @@ test_basic()
 	test_array_source(format);
 	test_merger(NULL);
 	test_merger(format);
+	test_merger_many_sources(false);
+	test_merger_many_sources(true);
 
 	key_def_delete(key_def);
 	tuple_format_unref(format);
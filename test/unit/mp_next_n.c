@@ -0,0 +1,112 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2023, Tarantool AUTHORS, please see AUTHORS file.
+ */
+
+#define UNIT_TAP_COMPATIBLE 1
+#include "unit.h"
+#include "mp_util.h"
+#include "msgpuck.h"
+#include "trivia/util.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+enum {
+	VALUE_COUNT = 200,
+	MP_NEXT_N_TEST_ALIGNMENTS = 16,
+};
+
+/**
+ * Checks that mp_next_n() skips the same data as mp_next() called in
+ * a loop for every start value, every count and every alignment.
+ */
+static bool
+check_buf(const char *buf, const char *end, uint32_t value_count)
+{
+	const char *start = buf;
+	for (uint32_t i = 0; i < value_count; i++) {
+		for (uint32_t count = 0; count <= value_count - i; count++) {
+			const char *expected = start;
+			for (uint32_t k = 0; k < count; k++)
+				mp_next(&expected);
+			const char *actual = start;
+			mp_next_n(&actual, count);
+			if (actual != expected || actual > end)
+				return false;
+		}
+		mp_next(&start);
+	}
+	return true;
+}
+
+static void
+test_mp_next_n(const char *name, int (*gen)(int))
+{
+	header();
+	plan(MP_NEXT_N_TEST_ALIGNMENTS);
+	char storage[VALUE_COUNT * 16 + 64];
+	for (int align = 0; align < MP_NEXT_N_TEST_ALIGNMENTS; align++) {
+		char *buf = storage + align;
+		char *end = buf;
+		for (int i = 0; i < VALUE_COUNT; i++) {
+			switch (gen(i)) {
+			case 0:
+				end = mp_encode_uint(end, i % 128);
+				break;
+			case 1:
+				end = mp_encode_int(end, -(i % 32) - 1);
+				break;
+			case 2:
+				end = mp_encode_nil(end);
+				break;
+			case 3:
+				end = mp_encode_bool(end, i % 2 == 0);
+				break;
+			case 4:
+				end = mp_encode_uint(end, 1000 + i);
+				break;
+			case 5:
+				end = mp_encode_str0(end, "abc");
+				break;
+			default:
+				end = mp_encode_double(end, i);
+				break;
+			}
+		}
+		ok(check_buf(buf, end, VALUE_COUNT), "%s, alignment %d",
+		   name, align);
+	}
+	check_plan();
+	footer();
+}
+
+static int
+gen_single_byte(int i)
+{
+	return i % 4;
+}
+
+static int
+gen_multi_byte(int i)
+{
+	return 4 + i % 3;
+}
+
+static int
+gen_mixed(int i)
+{
+	/* Runs of single-byte values of different length. */
+	return (i * 7) % 11 < 8 ? i % 4 : 4 + i % 3;
+}
+
+int
+main(void)
+{
+	plan(3);
+	test_mp_next_n("single-byte values", gen_single_byte);
+	test_mp_next_n("multi-byte values", gen_multi_byte);
+	test_mp_next_n("mixed values", gen_mixed);
+	return check_plan();
+}
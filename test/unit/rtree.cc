@@ -299,12 +299,79 @@ neighbor_test()
 	footer();
 }
 
+static void
+bulk_load_test()
+{
+	header();
+
+	const size_t rounds = 10000;
+	struct rtree_rect *arr = (struct rtree_rect *)
+		malloc(rounds * sizeof(*arr));
+	for (size_t i = 0; i < rounds; i++) {
+		coord_t x = (i * 7919) % rounds;
+		coord_t y = (i * 104729) % rounds;
+		rtree_set2d(&arr[i], x, y, x + 0.5, y + 0.5);
+	}
+
+	for (size_t count = 0; count <= rounds; count = count * 3 + 1) {
+		struct rtree tree;
+		rtree_init(&tree, 2, RTREE_EUCLID, extent_size,
+			   extent_alloc, extent_free, &page_count, NULL);
+		struct rtree_bulk bulk;
+		rtree_bulk_create(&bulk);
+		for (size_t i = 0; i < count; i++) {
+			if (rtree_bulk_add(&tree, &bulk, &arr[i],
+					   (record_t)(i + 1)) != 0)
+				fail("bulk add", "true");
+		}
+		size_t pages = rtree_bulk_page_count(&tree, count);
+		rtree_bulk_load(&tree, &bulk);
+		if (bulk.count != 0)
+			fail("bulk is empty", "false");
+		if (rtree_number_of_records(&tree) != count)
+			fail("Tree count mismatch", "true");
+		if (rtree_used_size(&tree) != pages * tree.page_size)
+			fail("Page count mismatch", "true");
+
+		struct rtree_iterator iterator;
+		rtree_iterator_init(&iterator);
+		for (size_t i = 0; i < count; i++) {
+			record_t rec = (record_t)(i + 1);
+			if (!rtree_search(&tree, &arr[i], SOP_EQUALS,
+					  &iterator))
+				fail("element in tree", "false");
+			if (rtree_iterator_next(&iterator) != rec)
+				fail("right search result", "true");
+			if (rtree_iterator_next(&iterator) != NULL)
+				fail("single search result", "true");
+		}
+		/* The tree must stay valid for modifications. */
+		for (size_t i = 0; i < count; i += 2) {
+			if (!rtree_remove(&tree, &arr[i], (record_t)(i + 1)))
+				fail("delete element in tree", "false");
+		}
+		for (size_t i = 0; i < count; i += 2)
+			rtree_insert(&tree, &arr[i], (record_t)(i + 1));
+		for (size_t i = 0; i < count; i++) {
+			if (!rtree_remove(&tree, &arr[i], (record_t)(i + 1)))
+				fail("delete element in tree", "false");
+		}
+		if (rtree_number_of_records(&tree) != 0)
+			fail("Tree count mismatch", "true");
+		rtree_iterator_destroy(&iterator);
+		rtree_destroy(&tree);
+	}
+	free(arr);
+
+	footer();
+}
 
 int
 main(void)
 {
 	simple_check();
 	neighbor_test();
+	bulk_load_test();
 	if (page_count != 0) {
 		fail("memory leak!", "true");
 	}
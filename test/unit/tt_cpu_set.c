@@ -0,0 +1,94 @@
+#include "tt_cpu_set.h"
+
+#include "diag.h"
+#include "fiber.h"
+#include "memory.h"
+#include "trivia/util.h"
+
+#define UNIT_TAP_COMPATIBLE 1
+#include "unit.h"
+
+/** Return the number of CPUs in a set. */
+static int
+cpu_count(const struct tt_cpu_set *set)
+{
+	int count = 0;
+	for (int cpu = 0; cpu < TT_CPU_SET_SIZE; cpu++)
+		count += tt_cpu_set_has(set, cpu);
+	return count;
+}
+
+static void
+test_parse_valid(void)
+{
+	plan(10);
+	header();
+
+	struct tt_cpu_set set;
+	is(tt_cpu_set_parse(&set, "3"), 0, "single CPU");
+	ok(cpu_count(&set) == 1 && tt_cpu_set_has(&set, 3), "single CPU set");
+
+	is(tt_cpu_set_parse(&set, "0-3,8,10-11"), 0, "list");
+	ok(cpu_count(&set) == 7 && tt_cpu_set_has(&set, 0) &&
+	   tt_cpu_set_has(&set, 3) && !tt_cpu_set_has(&set, 4) &&
+	   tt_cpu_set_has(&set, 8) && !tt_cpu_set_has(&set, 9) &&
+	   tt_cpu_set_has(&set, 11), "list set");
+
+	is(tt_cpu_set_parse(&set, "5-5"), 0, "range of one CPU");
+	ok(cpu_count(&set) == 1 && tt_cpu_set_has(&set, 5),
+	   "range of one CPU set");
+
+	is(tt_cpu_set_parse(&set, "63-64"), 0, "range crossing a word");
+	ok(cpu_count(&set) == 2 && tt_cpu_set_has(&set, 63) &&
+	   tt_cpu_set_has(&set, 64), "range crossing a word set");
+
+	is(tt_cpu_set_parse(&set, "1023"), 0, "max CPU");
+	ok(cpu_count(&set) == 1 && tt_cpu_set_has(&set, 1023), "max CPU set");
+
+	footer();
+	check_plan();
+}
+
+static void
+test_parse_invalid(void)
+{
+	const char *invalid[] = {
+		"", ",", "1,", ",1", "a", "1-", "-1", "3-1", "1--2",
+		"1 2", "1024", "0-1024", "99999999999999999999",
+	};
+	plan(lengthof(invalid));
+	header();
+
+	for (size_t i = 0; i < lengthof(invalid); i++) {
+		struct tt_cpu_set set;
+		is(tt_cpu_set_parse(&set, invalid[i]), -1,
+		   "invalid list '%s'", invalid[i]);
+	}
+
+	footer();
+	check_plan();
+}
+
+static int
+test_main(void)
+{
+	plan(2);
+	header();
+
+	test_parse_valid();
+	test_parse_invalid();
+
+	footer();
+	return check_plan();
+}
+
+int
+main(void)
+{
+	memory_init();
+	fiber_init(fiber_c_invoke);
+	int rc = test_main();
+	fiber_free();
+	memory_free();
+	return rc;
+}
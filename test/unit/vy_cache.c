@@ -348,15 +348,87 @@ test_iterator_skip_prepared(void)
 	check_plan();
 }
 
+static void
+test_hot_nodes(void)
+{
+	header();
+	plan(4);
+	struct vy_cache cache;
+	uint32_t fields[] = { 0 };
+	uint32_t types[] = { FIELD_TYPE_UNSIGNED };
+	struct key_def *key_def;
+	struct tuple_format *format;
+	create_test_cache(fields, types, lengthof(fields), &cache, &key_def,
+			  &format);
+
+	const struct vy_stmt_template chain[] = {
+		STMT_TEMPLATE(1, REPLACE, 1),
+		STMT_TEMPLATE(2, REPLACE, 2),
+		STMT_TEMPLATE(3, REPLACE, 3),
+		STMT_TEMPLATE(4, REPLACE, 4),
+		STMT_TEMPLATE(5, REPLACE, 5),
+		STMT_TEMPLATE(6, REPLACE, 6),
+		STMT_TEMPLATE(7, REPLACE, 7),
+		STMT_TEMPLATE(8, REPLACE, 8),
+		STMT_TEMPLATE(9, REPLACE, 9),
+		STMT_TEMPLATE(10, REPLACE, 10),
+	};
+	vy_cache_insert_templates_chain(&cache, format, chain,
+					lengthof(chain), &key_template,
+					ITER_GE);
+	is(vy_cache_tree_size(&cache.cache_tree), 10,
+	   "cache is filled with 10 statements");
+
+	/* Read the oldest statements so they become hot. */
+	struct vy_entry keys[3];
+	for (int i = 0; i < 3; i++) {
+		const struct vy_stmt_template key_templ =
+			STMT_TEMPLATE(0, SELECT, i + 1);
+		keys[i] = vy_new_simple_stmt(format, key_def, &key_templ);
+		vy_cache_get(&cache, keys[i]);
+	}
+
+	/*
+	 * Halve the quota. Nodes that haven't been read must be
+	 * evicted first though they are newer.
+	 */
+	size_t quota = cache_env.mem_quota;
+	cache_env.mem_quota = cache_env.mem_used / 2;
+	const struct vy_stmt_template to_write =
+		STMT_TEMPLATE(11, REPLACE, 100);
+	vy_cache_on_write_template(&cache, format, &to_write);
+	cache_env.mem_quota = quota;
+	is(vy_cache_tree_size(&cache.cache_tree), 5,
+	   "half of statements are evicted");
+	bool all_found = true;
+	for (int i = 0; i < 3; i++) {
+		if (vy_cache_get(&cache, keys[i]).stmt == NULL)
+			all_found = false;
+		tuple_unref(keys[i].stmt);
+	}
+	ok(all_found, "hot statements are not evicted");
+	const struct vy_stmt_template key_templ =
+		STMT_TEMPLATE(0, SELECT, 4);
+	struct vy_entry key = vy_new_simple_stmt(format, key_def, &key_templ);
+	ok(vy_cache_get(&cache, key).stmt == NULL,
+	   "the oldest cold statement is evicted");
+	tuple_unref(key.stmt);
+
+	destroy_test_cache(&cache, key_def, format);
+	check_plan();
+	footer();
+}
+
 int
 main(void)
 {
 	vy_iterator_C_test_init(1LLU * 1024LLU * 1024LLU * 1024LLU);
 
-	plan(2);
+	plan(3);
 
 	test_basic();
 	test_iterator_skip_prepared();
+	test_hot_nodes();
 
 	vy_iterator_C_test_finish();
 	return check_plan();
@@ -25,7 +25,8 @@ enum {
  * Create a temporary directory, initialize it as xdir, and create a new xlog.
  */
 static void
-create_xlog(struct xlog *xlog, char *dirname)
+create_xlog_with_opts(struct xlog *xlog, char *dirname,
+		      const struct xlog_opts *opts)
 {
 	fail_if(mkdtemp(dirname) == NULL);
 
@@ -35,11 +36,17 @@ create_xlog(struct xlog *xlog, char *dirname)
 	memset(&tt_uuid, 1, sizeof(tt_uuid));
 	memset(&vclock, 0, sizeof(vclock));
 
-	xdir_create(&xdir, dirname, XLOG, &tt_uuid, &xlog_opts_default);
+	xdir_create(&xdir, dirname, XLOG, &tt_uuid, opts);
 
 	fail_if(xdir_create_xlog(&xdir, xlog, &vclock) < 0);
 }
 
+static void
+create_xlog(struct xlog *xlog, char *dirname)
+{
+	create_xlog_with_opts(xlog, dirname, &xlog_opts_default);
+}
+
 /**
  * Write a tuple to the xlog.
  */
@@ -145,15 +152,204 @@ test_dynamic_sized_ibuf(void)
 	footer();
 }
 
+/**
+ * Test that a mapped cursor reads the same rows as a regular one and that
+ * rows of uncompressed transactions point directly to the file mapping.
+ */
+static void
+test_mapped_cursor(bool no_compression)
+{
+	header();
+	plan(4);
+	struct xlog xlog;
+	struct xlog_opts opts = xlog_opts_default;
+	opts.no_compression = no_compression;
+	char dirname[] = "./xlog.XXXXXX";
+	char filename[PATH_MAX];
+	create_xlog_with_opts(&xlog, dirname, &opts);
+	strlcpy(filename, xlog.filename, sizeof(filename));
+
+	/* Write about 20 MB of data so that some of it is released. */
+	const int row_count = 20 * 1024;
+	for (int i = 0; i < row_count; i++)
+		write_1k(&xlog);
+	fail_if(xlog_close(&xlog) != 0);
+
+	struct xlog_cursor cursor, mapped;
+	fail_if(xlog_cursor_open(&cursor, filename) < 0);
+	fail_if(xlog_cursor_openmap(&mapped, filename) < 0);
+
+	int rc, mapped_rc;
+	int count = 0;
+	bool rows_equal = true;
+	bool rows_in_map = true;
+	struct xrow_header row, mapped_row;
+	while ((rc = xlog_cursor_next(&cursor, &row, false)) == 0) {
+		mapped_rc = xlog_cursor_next(&mapped, &mapped_row, false);
+		if (mapped_rc != 0 || row.lsn != mapped_row.lsn ||
+		    row.body[0].iov_len != mapped_row.body[0].iov_len ||
+		    memcmp(row.body[0].iov_base, mapped_row.body[0].iov_base,
+			   row.body[0].iov_len) != 0) {
+			rows_equal = false;
+			break;
+		}
+		const char *body = (const char *)mapped_row.body[0].iov_base;
+		if (body < mapped.map || body >= mapped.map + mapped.map_size)
+			rows_in_map = false;
+		count++;
+	}
+	mapped_rc = xlog_cursor_next(&mapped, &mapped_row, false);
+
+	ok(rows_equal && count == row_count, "mapped cursor read all rows");
+	ok(rc == 1 && mapped_rc == 1 && xlog_cursor_is_eof(&mapped),
+	   "mapped cursor reached EOF");
+	is(rows_in_map, no_compression, "rows %s the mapping",
+	   no_compression ? "point to" : "don't point to");
+	ok(mapped.map_released > 0, "consumed data was released");
+
+	xlog_cursor_close(&mapped, false);
+	xlog_cursor_close(&cursor, false);
+	unlink(filename);
+	rmdir(dirname);
+
+	check_plan();
+	footer();
+}
+
+/**
+ * Test that compression settings may be changed on an open xlog and that
+ * the resulting file, which has both plain and compressed blocks written
+ * with different levels, is read correctly.
+ */
+static void
+test_compression_switch(void)
+{
+	header();
+	plan(2);
+	struct xlog xlog;
+	struct xlog_opts opts = xlog_opts_default;
+	opts.no_compression = true;
+	char dirname[] = "./xlog.XXXXXX";
+	char filename[PATH_MAX];
+	create_xlog_with_opts(&xlog, dirname, &opts);
+	strlcpy(filename, xlog.filename, sizeof(filename));
+	ok(xlog.zctx == NULL, "no compression context");
+
+	const int levels[] = {0, 1, XLOG_COMPRESSION_LEVEL_DEFAULT, 5};
+	const int rows_per_level = 256;
+	for (size_t i = 0; i < lengthof(levels); i++) {
+		xlog.opts.no_compression = levels[i] == 0;
+		xlog.opts.compression_level = levels[i];
+		for (int j = 0; j < rows_per_level; j++)
+			write_1k(&xlog);
+		fail_if(xlog_flush(&xlog) < 0);
+	}
+	fail_if(xlog_close(&xlog) != 0);
+
+	struct xlog_cursor cursor;
+	fail_if(xlog_cursor_open(&cursor, filename) < 0);
+	int rc;
+	int count = 0;
+	struct xrow_header row;
+	while ((rc = xlog_cursor_next(&cursor, &row, false)) == 0)
+		count++;
+	ok(rc == 1 && count == rows_per_level * (int)lengthof(levels),
+	   "all rows read");
+
+	xlog_cursor_close(&cursor, false);
+	unlink(filename);
+	rmdir(dirname);
+
+	check_plan();
+	footer();
+}
+
+/**
+ * Reads the first row from an xlog file, seeking to the given vclock
+ * first, and returns its LSN. Returns the number of rows read till EOF
+ * in @a count.
+ */
+static int64_t
+read_from_vclock(const char *filename, const struct vclock *vclock,
+		 int *count)
+{
+	struct xlog_cursor cursor;
+	fail_if(xlog_cursor_open(&cursor, filename) < 0);
+	xlog_cursor_seek_vclock(&cursor, vclock);
+	int64_t lsn = -1;
+	struct xrow_header row;
+	*count = 0;
+	while (xlog_cursor_next(&cursor, &row, false) == 0) {
+		if (lsn < 0)
+			lsn = row.lsn;
+		++*count;
+	}
+	fail_if(!xlog_cursor_is_eof(&cursor));
+	xlog_cursor_close(&cursor, false);
+	return lsn;
+}
+
+/**
+ * Test that a cursor skips the rows preceding the given vclock using
+ * the seek index written along with the xlog file.
+ */
+static void
+test_seek_index(void)
+{
+	header();
+	plan(4);
+	struct xlog xlog;
+	struct xlog_opts opts = xlog_opts_default;
+	opts.build_index = true;
+	char dirname[] = "./xlog.XXXXXX";
+	char filename[PATH_MAX];
+	char index_filename[PATH_MAX];
+	create_xlog_with_opts(&xlog, dirname, &opts);
+	strlcpy(filename, xlog.filename, sizeof(filename));
+	snprintf(index_filename, sizeof(index_filename), "%s.index",
+		 filename);
+	ok(access(index_filename, F_OK) == 0, "index file is created");
+
+	/* Write about 20 MB of data so that the index has a few entries. */
+	const int row_count = 20 * 1024;
+	for (int i = 0; i < row_count; i++)
+		write_1k(&xlog);
+	fail_if(xlog_close(&xlog) != 0);
+
+	int count;
+	struct vclock vclock;
+	vclock_create(&vclock);
+	int64_t first_lsn = read_from_vclock(filename, &vclock, &count);
+	is(count, row_count, "all rows are read without seeking");
+
+	int64_t target_lsn = first_lsn + row_count * 3 / 4;
+	vclock_follow(&vclock, 0, target_lsn);
+	int64_t lsn = read_from_vclock(filename, &vclock, &count);
+	ok(lsn > first_lsn && lsn <= target_lsn + 1,
+	   "cursor seeks to a row preceding the vclock");
+	is(count, first_lsn + row_count - lsn, "rows after the seek are read");
+
+	unlink(index_filename);
+	unlink(filename);
+	rmdir(dirname);
+
+	check_plan();
+	footer();
+}
+
 int
 main(void)
 {
-	plan(1);
+	plan(5);
 	crc32_init();
 	memory_init();
 	random_init();
 
 	test_dynamic_sized_ibuf();
+	test_mapped_cursor(false);
+	test_mapped_cursor(true);
+	test_compression_switch();
+	test_seek_index();
 
 	random_free();
 	memory_free();
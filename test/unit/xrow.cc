@@ -276,6 +276,65 @@ test_xrow_header_encode_decode()
 	footer();
 }
 
+static void
+test_xrow_header_decode_invalid(void)
+{
+	header();
+	plan(8);
+
+	char buf[64];
+	char *p = mp_encode_map(buf, 3);
+	p = mp_encode_uint(p, IPROTO_REQUEST_TYPE);
+	p = mp_encode_uint(p, IPROTO_SELECT);
+	p = mp_encode_uint(p, IPROTO_SYNC);
+	p = mp_encode_uint(p, 100500);
+	/* Unknown key. */
+	p = mp_encode_uint(p, 200);
+	p = mp_encode_array(p, 2);
+	p = mp_encode_str0(p, "foo");
+	p = mp_encode_double(p, 1.5);
+	const char *end = p;
+
+	struct xrow_header row;
+	const char *pos = buf;
+	is(xrow_header_decode(&row, &pos, end, true), 0, "valid header");
+	is(row.type, IPROTO_SELECT, "decoded type");
+	is(row.sync, 100500, "decoded sync");
+	ok(row.header == buf && row.header_end == end, "header bounds");
+
+	/* Every truncation must be detected. */
+	int fail_count = 0;
+	for (const char *e = buf; e < end; e++) {
+		pos = buf;
+		if (xrow_header_decode(&row, &pos, e, false) == 0)
+			fail_count++;
+	}
+	is(fail_count, 0, "truncated header");
+
+	/* Non-integer key. */
+	p = mp_encode_map(buf, 1);
+	p = mp_encode_str0(p, "x");
+	p = mp_encode_uint(p, 1);
+	pos = buf;
+	is(xrow_header_decode(&row, &pos, p, true), -1, "string key");
+
+	/* Known key of wrong type. */
+	p = mp_encode_map(buf, 1);
+	p = mp_encode_uint(p, IPROTO_SYNC);
+	p = mp_encode_str0(p, "x");
+	pos = buf;
+	is(xrow_header_decode(&row, &pos, p, true), -1, "bad sync type");
+
+	/* Not a map. */
+	p = mp_encode_array(buf, 0);
+	pos = buf;
+	is(xrow_header_decode(&row, &pos, p, true), -1, "not a map");
+
+	diag_destroy(diag_get());
+	check_plan();
+	footer();
+}
+
 void
 test_request_str()
 {
@@ -792,19 +851,108 @@ test_xrow_decode_error_gh_9136(void)
 	footer();
 }
 
+static void
+test_xrow_subscribe_compression(void)
+{
+	header();
+	plan(4);
+
+	struct subscribe_request req;
+	memset(&req, 0, sizeof(req));
+	vclock_create(&req.vclock);
+	struct xrow_header row;
+	xrow_encode_subscribe(&row, &req);
+	struct subscribe_request decoded_req;
+	xrow_decode_subscribe(&row, &decoded_req);
+	ok(!decoded_req.is_compressed, "uncompressed subscribe request");
+
+	req.is_compressed = true;
+	xrow_encode_subscribe(&row, &req);
+	xrow_decode_subscribe(&row, &decoded_req);
+	ok(decoded_req.is_compressed, "compressed subscribe request");
+
+	struct subscribe_response rsp;
+	memset(&rsp, 0, sizeof(rsp));
+	vclock_create(&rsp.vclock);
+	struct subscribe_response decoded_rsp;
+	xrow_encode_subscribe_response(&row, &rsp);
+	xrow_decode_subscribe_response(&row, &decoded_rsp);
+	ok(!decoded_rsp.is_compressed, "uncompressed subscribe response");
+
+	rsp.is_compressed = true;
+	xrow_encode_subscribe_response(&row, &rsp);
+	xrow_decode_subscribe_response(&row, &decoded_rsp);
+	ok(decoded_rsp.is_compressed, "compressed subscribe response");
+
+	fiber_gc();
+	check_plan();
+	footer();
+}
+
+static void
+test_xrow_subscribe_space_filter(void)
+{
+	header();
+	plan(7);
+
+	struct subscribe_request req;
+	memset(&req, 0, sizeof(req));
+	vclock_create(&req.vclock);
+	struct xrow_header row;
+	xrow_encode_subscribe(&row, &req);
+	struct subscribe_request decoded_req;
+	is(xrow_decode_subscribe(&row, &decoded_req), 0, "decode");
+	ok(decoded_req.space_filter == NULL, "no space filter");
+
+	char filter[16];
+	char *end = mp_encode_array(filter, 2);
+	end = mp_encode_uint(end, 512);
+	end = mp_encode_uint(end, 1000);
+	req.space_filter = filter;
+	req.space_filter_end = end;
+	xrow_encode_subscribe(&row, &req);
+	is(xrow_decode_subscribe(&row, &decoded_req), 0, "decode");
+	ok(decoded_req.space_filter_end - decoded_req.space_filter ==
+	   end - filter && memcmp(decoded_req.space_filter, filter,
+				  end - filter) == 0, "space filter");
+
+	struct subscribe_response rsp;
+	memset(&rsp, 0, sizeof(rsp));
+	vclock_create(&rsp.vclock);
+	rsp.space_filter = filter;
+	rsp.space_filter_end = end;
+	struct subscribe_response decoded_rsp;
+	xrow_encode_subscribe_response(&row, &rsp);
+	xrow_decode_subscribe_response(&row, &decoded_rsp);
+	ok(decoded_rsp.space_filter != NULL, "space filter in response");
+
+	end = mp_encode_array(filter, 1);
+	end = mp_encode_str0(end, "test");
+	req.space_filter_end = end;
+	xrow_encode_subscribe(&row, &req);
+	is(xrow_decode_subscribe(&row, &decoded_req), -1, "invalid filter");
+	ok(!diag_is_empty(diag_get()), "diag is set");
+	diag_clear(diag_get());
+
+	fiber_gc();
+	check_plan();
+	footer();
+}
+
 int
 main(void)
 {
 	memory_init();
 	fiber_init(fiber_c_invoke);
 	header();
-	plan(13);
+	plan(16);
 
 	random_init();
 
 	test_iproto_constants();
 	test_greeting();
 	test_xrow_header_encode_decode();
+	test_xrow_header_decode_invalid();
 	test_request_str();
 	test_xrow_fields();
 	test_xrow_encode_dml();
@@ -816,6 +964,8 @@ main(void)
 	test_xrow_decode_error_gh_9098();
 	test_xrow_decode_error_gh_9136();
 	test_xrow_decode_synchro_types();
+	test_xrow_subscribe_compression();
+	test_xrow_subscribe_space_filter();
 
 	random_free();
 	fiber_free();
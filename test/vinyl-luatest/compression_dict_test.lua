@@ -0,0 +1,57 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.test_compression_dict = function(cg)
+    cg.server:exec(function()
+        t.assert_equals(box.cfg.vinyl_compression_dict, false)
+
+        -- Fills a space with small similar tuples, then compacts it
+        -- and returns its compressed size on disk.
+        local function compact(name)
+            local s = box.schema.space.create(name, {engine = 'vinyl'})
+            s:create_index('pk')
+            box.begin()
+            for i = 1, 20000 do
+                s:insert({i, 'user' .. i, 'user' .. i .. '@example.com',
+                          i % 10 == 0 and 'active' or 'inactive', i * 7})
+            end
+            box.commit()
+            box.snapshot()
+            s.index.pk:compact()
+            t.helpers.retrying({}, function()
+                t.assert_covers(s.index.pk:stat(), {
+                    run_count = 1,
+                    disk = {compaction = {count = 1}},
+                })
+            end)
+            return s.index.pk:stat().disk.bytes_compressed
+        end
+
+        local plain_size = compact('plain')
+        box.cfg({vinyl_compression_dict = true})
+        local dict_size = compact('dict')
+        t.assert_lt(dict_size, plain_size)
+    end)
+
+    cg.server:restart()
+    cg.server:exec(function()
+        for _, name in ipairs({'plain', 'dict'}) do
+            local s = box.space[name]
+            t.assert_equals(s:count(), 20000)
+            t.assert_equals(s:get(12345),
+                            {12345, 'user12345', 'user12345@example.com',
+                             'inactive', 12345 * 7})
+        end
+    end)
+end
@@ -0,0 +1,67 @@
+local net = require('net.box')
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.before_each(function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test', {engine = 'vinyl'})
+        s:create_index('pk')
+        s:create_index('sk', {parts = {2, 'unsigned'}, unique = false})
+        for i = 1, 100 do
+            s:insert({i, i % 10})
+        end
+        box.snapshot()
+        box.stat.reset()
+    end)
+    cg.conn = net.connect(cg.server.net_box_uri)
+end)
+
+g.after_each(function(cg)
+    cg.conn:close()
+    cg.server:exec(function()
+        box.space.test:drop()
+    end)
+end)
+
+g.test_get_many = function(cg)
+    local keys = {}
+    local expected = {}
+    for i = 1, 50 do
+        keys[i] = i * 3
+        expected[i] = i * 3 <= 100 and {i * 3, i * 3 % 10} or box.NULL
+    end
+    t.assert_equals(cg.conn.space.test:get_many(keys), expected)
+    cg.server:exec(function()
+        -- The keys were looked up in advance so the gets hit the cache.
+        local stat = box.space.test.index.pk:stat()
+        t.assert_equals(stat.cache.get.rows, 33)
+        t.assert_equals(stat.get.rows, 33)
+    end)
+end
+
+g.test_invalid_keys = function(cg)
+    local s = cg.conn.space.test
+    t.assert_error_msg_equals(
+        "Supplied key type of part 0 does not match index part type: " ..
+        "expected unsigned",
+        s.get_many, s, {1, 'x', 2})
+    t.assert_equals(s:get_many({1, 1000, 2}),
+                    {{1, 1}, box.NULL, {2, 2}})
+end
+
+g.test_non_unique = function(cg)
+    local idx = cg.conn.space.test.index.sk
+    local res = idx:select_many({1, 2}, {limit = 2})
+    t.assert_equals(res, {{{1, 1}, {11, 1}}, {{2, 2}, {12, 2}}})
+end
@@ -0,0 +1,82 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new({
+        box_cfg = {
+            vinyl_cache = 0,
+            vinyl_page_cache = 1024 * 1024,
+            vinyl_page_size = 1024,
+        },
+    })
+    cg.server:start()
+    cg.server:exec(function()
+        local s = box.schema.space.create('test', {engine = 'vinyl'})
+        s:create_index('pk')
+        for i = 1, 2000 do
+            s:insert({i, string.rep('x', 100)})
+        end
+        box.snapshot()
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.before_each(function(cg)
+    cg.server:exec(function()
+        box.cfg({vinyl_page_cache = 0})
+        box.cfg({vinyl_page_cache = 1024 * 1024})
+        box.stat.reset()
+    end)
+end)
+
+g.test_point_lookup = function(cg)
+    cg.server:exec(function()
+        local pk = box.space.test.index.pk
+        t.assert_equals(pk:get({1000})[1], 1000)
+        t.assert_equals(pk:stat().disk.iterator.read.pages, 1)
+        t.assert_equals(box.stat.vinyl().page_cache.pages, 1)
+        t.assert_equals(box.stat.vinyl().page_cache.miss, 1)
+        for _ = 1, 10 do
+            t.assert_equals(pk:get({1000})[1], 1000)
+        end
+        -- The page isn't read from disk again.
+        t.assert_equals(pk:stat().disk.iterator.read.pages, 1)
+        t.assert_equals(box.stat.vinyl().page_cache.hit, 10)
+        t.assert_gt(box.stat.vinyl().page_cache.memory, 1024)
+    end)
+end
+
+g.test_scan = function(cg)
+    cg.server:exec(function()
+        local pk = box.space.test.index.pk
+        t.assert_equals(#pk:select({}, {iterator = 'GE'}), 2000)
+        t.assert_gt(pk:stat().disk.pages, 10)
+        -- Pages read by a scan aren't cached.
+        t.assert_lt(box.stat.vinyl().page_cache.pages,
+                    pk:stat().disk.pages / 2)
+    end)
+end
+
+g.test_quota = function(cg)
+    cg.server:exec(function()
+        local pk = box.space.test.index.pk
+        for i = 1, 2000, 5 do
+            t.assert_equals(pk:get({i})[1], i)
+        end
+        t.assert_equals(box.stat.vinyl().page_cache.pages,
+                        pk:stat().disk.pages)
+        box.cfg({vinyl_page_cache = 10 * 1024})
+        local stat = box.stat.vinyl().page_cache
+        t.assert_le(stat.memory, 10 * 1024)
+        t.assert_lt(stat.pages, pk:stat().disk.pages)
+        box.cfg({vinyl_page_cache = 0})
+        stat = box.stat.vinyl().page_cache
+        t.assert_equals(stat.memory, 0)
+        t.assert_equals(stat.pages, 0)
+    end)
+end
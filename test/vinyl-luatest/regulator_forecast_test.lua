@@ -0,0 +1,45 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.test_time_to_throttle = function(cg)
+    cg.server:exec(function()
+        local fiber = require('fiber')
+        local st = box.stat.vinyl().regulator
+        -- Nothing is written so the limit is never hit.
+        t.assert_equals(st.time_to_throttle, math.huge)
+
+        local s = box.schema.space.create('test', {engine = 'vinyl'})
+        s:create_index('pk')
+        local f = fiber.new(function()
+            local i = 0
+            while true do
+                box.begin()
+                for _ = 1, 100 do
+                    i = i + 1
+                    s:replace({i, string.rep('x', 1000)})
+                end
+                box.commit()
+                fiber.sleep(0.01)
+            end
+        end)
+        t.helpers.retrying({timeout = 10}, function()
+            st = box.stat.vinyl().regulator
+            t.assert_gt(st.write_rate, 0)
+            t.assert_lt(st.time_to_throttle, math.huge)
+        end)
+        t.assert_ge(st.time_to_throttle, 0)
+        f:cancel()
+        s:drop()
+    end)
+end
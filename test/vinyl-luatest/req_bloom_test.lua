@@ -0,0 +1,42 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new({box_cfg = {vinyl_cache = 0}})
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.test_req_bloom = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test', {engine = 'vinyl'})
+        local pk = s:create_index('pk', {
+            parts = {{1, 'unsigned'}, {2, 'unsigned'}},
+            run_count_per_level = 10,
+        })
+        -- Each run stores rows of one tenant.
+        for tenant = 1, 3 do
+            for ts = 1, 10 do
+                s:insert({tenant, ts})
+            end
+            box.snapshot()
+        end
+        t.assert_equals(pk:stat().run_count, 3)
+        box.stat.reset()
+        local res = pk:select({2}, {iterator = 'REQ'})
+        t.assert_equals(#res, 10)
+        for i, tuple in ipairs(res) do
+            t.assert_equals(tuple, {2, 11 - i})
+        end
+        -- Runs that don't store the tenant are skipped.
+        t.assert_equals(pk:stat().disk.iterator.bloom.hit, 2)
+        t.assert_equals(pk:select({4}, {iterator = 'REQ'}), {})
+        t.assert_equals(pk:stat().disk.iterator.bloom.hit, 5)
+        s:drop()
+    end)
+end
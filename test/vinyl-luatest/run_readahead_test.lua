@@ -0,0 +1,76 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new({
+        box_cfg = {
+            vinyl_cache = 0,
+            vinyl_page_size = 1024,
+        },
+    })
+    cg.server:start()
+    cg.server:exec(function()
+        local s = box.schema.space.create('test', {engine = 'vinyl'})
+        s:create_index('pk')
+        for i = 1, 2000 do
+            s:insert({i, string.rep('x', 100)})
+        end
+        box.snapshot()
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.before_each(function(cg)
+    cg.server:exec(function()
+        box.stat.reset()
+    end)
+end)
+
+g.test_forward_scan = function(cg)
+    cg.server:exec(function()
+        local pk = box.space.test.index.pk
+        local res = pk:select({}, {iterator = 'GE'})
+        t.assert_equals(#res, 2000)
+        for i, tuple in ipairs(res) do
+            t.assert_equals(tuple[1], i)
+        end
+        -- Every page is read exactly once.
+        t.assert_equals(pk:stat().disk.iterator.read.pages,
+                        pk:stat().disk.pages)
+    end)
+end
+
+g.test_backward_scan = function(cg)
+    cg.server:exec(function()
+        local pk = box.space.test.index.pk
+        local res = pk:select({1500}, {iterator = 'LE'})
+        t.assert_equals(#res, 1500)
+        for i, tuple in ipairs(res) do
+            t.assert_equals(tuple[1], 1501 - i)
+        end
+    end)
+end
+
+g.test_interrupted_scan = function(cg)
+    cg.server:exec(function()
+        local pk = box.space.test.index.pk
+        for _ = 1, 10 do
+            local count = 0
+            for _, tuple in pk:pairs({100}, {iterator = 'GT'}) do
+                count = count + 1
+                t.assert_equals(tuple[1], 100 + count)
+                if count == 300 then
+                    break
+                end
+            end
+            t.assert_equals(count, 300)
+        end
+        collectgarbage()
+        t.assert_equals(pk:get({1000})[1], 1000)
+    end)
+end
@@ -0,0 +1,69 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new({
+        box_cfg = {
+            vinyl_write_threads = 4,
+            vinyl_run_count_per_level = 100,
+        },
+    })
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        if box.space.test ~= nil then
+            box.space.test:drop()
+        end
+    end)
+end)
+
+g.test_split_for_compaction = function(cg)
+    cg.server:exec(function()
+        local fiber = require('fiber')
+        local s = box.schema.space.create('test', {engine = 'vinyl'})
+        local pk = s:create_index('pk', {
+            range_size = 64 * 1024,
+            page_size = 1024,
+        })
+        local function write_and_compact(gen)
+            for i = 1, 550 do
+                s:replace({i, gen, string.rep('x', 100)})
+            end
+            box.snapshot()
+            pk:compact()
+            t.helpers.retrying({}, function()
+                t.assert_equals(pk:stat().disk.compaction.queue.bytes, 0)
+                t.assert_equals(pk:stat().run_count, pk:stat().range_count)
+            end)
+            fiber.sleep(0)
+        end
+        -- The range hasn't been compacted yet so it isn't split.
+        for i = 1, 2 do
+            for j = 1, 550 do
+                s:replace({j, i, string.rep('x', 100)})
+            end
+            box.snapshot()
+        end
+        pk:compact()
+        t.helpers.retrying({}, function()
+            t.assert_equals(pk:stat().run_count, 1)
+        end)
+        t.assert_equals(pk:stat().range_count, 1)
+        -- The range isn't big enough to be split in two, but it is
+        -- split for compaction, because there are idle workers.
+        write_and_compact(3)
+        t.assert_ge(pk:stat().range_count, 2)
+        t.assert_equals(s:count(), 550)
+        for _, tuple in s:pairs() do
+            t.assert_equals(tuple[2], 3)
+        end
+    end)
+end
@@ -56,6 +56,14 @@
 #include "cord_buf.h"
 #include "tt_uuid.h" /* tt_uuid_to_string(), UUID_STR_LEN */
 
+#if defined(__SSE2__)
+# include <emmintrin.h>
+# define JSON_SCAN_SSE2 1
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+# include <arm_neon.h>
+# define JSON_SCAN_NEON 1
+#endif
+
 typedef enum {
     T_OBJ_BEGIN,
     T_OBJ_END,
@@ -104,6 +112,7 @@ static char escape2char[256];  /* Decoding */
 
 typedef struct {
     const char *data;
+    const char *data_end;
     const char *ptr;
     strbuf_t *tmp;    /* Temporary storage for strings */
     struct luaL_serializer *cfg;
@@ -594,6 +603,60 @@ static void json_set_token_error(json_token_t *token, json_parse_t *json,
     token->value.string = errtype;
 }
 
+#if defined(JSON_SCAN_SSE2) || defined(JSON_SCAN_NEON)
+
+/* Size of a block of string characters checked at once. */
+enum { JSON_SCAN_BLOCK_SIZE = 16 };
+
+/* Returns a bit mask of '"', '\\' and '\0' characters in the 16-byte
+ * block starting at @a p. The lowest bit corresponds to the first byte. */
+static inline uint32_t json_special_char_mask(const char *p)
+{
+#if defined(JSON_SCAN_SSE2)
+    __m128i bytes = _mm_loadu_si128((const __m128i *)p);
+    __m128i quote = _mm_cmpeq_epi8(bytes, _mm_set1_epi8('"'));
+    __m128i bslash = _mm_cmpeq_epi8(bytes, _mm_set1_epi8('\\'));
+    __m128i zero = _mm_cmpeq_epi8(bytes, _mm_setzero_si128());
+    return (uint32_t)_mm_movemask_epi8(
+        _mm_or_si128(_mm_or_si128(quote, bslash), zero));
+#else /* defined(JSON_SCAN_NEON) */
+    uint8x16_t bytes = vld1q_u8((const uint8_t *)p);
+    uint8x16_t special = vorrq_u8(
+        vorrq_u8(vceqq_u8(bytes, vdupq_n_u8('"')),
+                 vceqq_u8(bytes, vdupq_n_u8('\\'))),
+        vceqzq_u8(bytes));
+    /* Emulate movemask: keep one bit per byte and add them up. */
+    static const uint8_t bits[JSON_SCAN_BLOCK_SIZE] = {
+        1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128,
+    };
+    uint8x16_t masked = vandq_u8(special, vld1q_u8(bits));
+    uint32_t lo = vaddv_u8(vget_low_u8(masked));
+    uint32_t hi = vaddv_u8(vget_high_u8(masked));
+    return lo | (hi << 8);
+#endif
+}
+
+#endif /* defined(JSON_SCAN_SSE2) || defined(JSON_SCAN_NEON) */
+
+/* Returns a pointer to the first '"', '\\' or '\0' character at or after
+ * @a p. The string must be terminated with '\0' at @a end. */
+static inline const char *json_skip_plain_chars(const char *p,
+                                                const char *end)
+{
+#if defined(JSON_SCAN_SSE2) || defined(JSON_SCAN_NEON)
+    while (end - p >= JSON_SCAN_BLOCK_SIZE) {
+        uint32_t mask = json_special_char_mask(p);
+        if (mask != 0)
+            return p + __builtin_ctz(mask);
+        p += JSON_SCAN_BLOCK_SIZE;
+    }
+#endif
+    (void)end;
+    while (*p != '"' && *p != '\\' && *p != '\0')
+        p++;
+    return p;
+}
+
 static void json_next_string_token(json_parse_t *json, json_token_t *token)
 {
     char ch;
@@ -604,6 +667,16 @@ static void json_next_string_token(json_parse_t *json, json_token_t *token)
     /* Skip " */
     json->ptr++;
 
+    /* Fast path: a string without escapes is passed as is. */
+    const char *run_end = json_skip_plain_chars(json->ptr, json->data_end);
+    if (*run_end == '"') {
+        token->type = T_STRING;
+        token->value.string = json->ptr;
+        token->string_len = run_end - json->ptr;
+        json->ptr = run_end + 1;
+        return;
+    }
+
     /* json->tmp is the temporary strbuf used to accumulate the
      * decoded string value.
      * json->tmp is sized to handle JSON containing only a string value.
@@ -611,6 +684,13 @@ static void json_next_string_token(json_parse_t *json, json_token_t *token)
     strbuf_reset(json->tmp);
 
     while ((ch = *json->ptr) != '"') {
+        /* Copy characters that need no translation at once. */
+        if (run_end > json->ptr) {
+            strbuf_append_mem_unsafe(json->tmp, json->ptr,
+                                     run_end - json->ptr);
+            json->ptr = run_end;
+            continue;
+        }
         if (!ch) {
             /* Premature end of the string */
             json_set_token_error(token, json, "unexpected end of string");
@@ -644,6 +724,7 @@ static void json_next_string_token(json_parse_t *json, json_token_t *token)
          * Unicode escapes are handled above */
         strbuf_append_char_unsafe(json->tmp, ch);
         json->ptr++;
+        run_end = json_skip_plain_chars(json->ptr, json->data_end);
     }
     json->ptr++;    /* Eat final quote (") */
 
@@ -1071,6 +1152,7 @@ static int json_decode(lua_State *l)
 
     json.data = luaL_checklstring(l, 1, &json_len);
     json.current_depth = 0;
+    json.data_end = json.data + json_len;
     json.ptr = json.data;
     json.line_count = 1;
     json.cur_line_ptr = json.data;